@@ -0,0 +1,99 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the compile time spent in the region analysis of deep loop nests.
+see README.md for the usage of this script.
+
+It schedules a conv2d with multi-level tiling, which gives more than ten loop
+levels, and times the passes that evaluate the accessed regions of the buffers:
+InferBound, the lowering and the shared memory synchronization.
+"""
+import argparse
+import timeit
+
+import numpy as np
+
+import tvm
+from tvm import te, topi
+
+
+def tiled_conv2d(batch, in_channel, out_channel, size, kernel):
+    """A conv2d schedule tiled the way the GPU templates tile it."""
+    data = te.placeholder((batch, in_channel, size, size), name="data")
+    weight = te.placeholder((out_channel, in_channel, kernel, kernel), name="weight")
+    conv = topi.nn.conv2d_nchw(data, weight, 1, kernel // 2, 1)
+    s = te.create_schedule(conv.op)
+    pad = conv.op.input_tensors[0]
+    s[pad].compute_inline()
+    data_shared = s.cache_read(pad, "shared", [conv])
+    weight_shared = s.cache_read(weight, "shared", [conv])
+    data_local = s.cache_read(data_shared, "local", [conv])
+    weight_local = s.cache_read(weight_shared, "local", [conv])
+    out_local = s.cache_write(conv, "local")
+
+    def tile(axis, factors):
+        axes = []
+        for factor in factors:
+            axis, inner = s[conv].split(axis, factor=factor)
+            axes.append(inner)
+        return [axis] + axes[::-1]
+
+    n, f, y, x = s[conv].op.axis
+    bf, vf, tf, fi = tile(f, [2, 8, 2])
+    by, vy, ty, yi = tile(y, [2, 4, 2])
+    bx, vx, tx, xi = tile(x, [2, 4, 2])
+    s[conv].reorder(n, bf, by, bx, vf, vy, vx, tf, ty, tx, fi, yi, xi)
+    s[conv].bind(bf, te.thread_axis("blockIdx.z"))
+    s[conv].bind(by, te.thread_axis("blockIdx.y"))
+    s[conv].bind(bx, te.thread_axis("blockIdx.x"))
+    s[conv].bind(vf, te.thread_axis("vthread"))
+    s[conv].bind(vy, te.thread_axis("vthread"))
+    s[conv].bind(vx, te.thread_axis("vthread"))
+    s[conv].bind(tf, te.thread_axis("threadIdx.z"))
+    s[conv].bind(ty, te.thread_axis("threadIdx.y"))
+    s[conv].bind(tx, te.thread_axis("threadIdx.x"))
+    s[out_local].compute_at(s[conv], tx)
+
+    rc, ry, rx = s[out_local].op.reduce_axis
+    rco, rci = s[out_local].split(rc, factor=4)
+    rcm, rci = s[out_local].split(rci, factor=2)
+    ryo, ryi = s[out_local].split(ry, factor=1)
+    rxo, rxi = s[out_local].split(rx, factor=1)
+    s[out_local].reorder(rco, ryo, rxo, rcm, ryi, rxi, rci, *s[out_local].op.axis)
+    for load in [data_shared, weight_shared]:
+        s[load].compute_at(s[out_local], rxo)
+    for load in [data_local, weight_local]:
+        s[load].compute_at(s[out_local], rxi)
+    return s, [data, weight, conv]
+
+
+def benchmark(name, func, repeat):
+    times = np.array(timeit.repeat(func, number=1, repeat=repeat)) * 1000
+    print("%-20s %-19s (%s)" % (name, "%.2f ms" % np.mean(times), "%.2f ms" % np.std(times)))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=56, help="The height and width of the input")
+    parser.add_argument("--channel", type=int, default=64, help="The number of channels")
+    parser.add_argument("--repeat", type=int, default=10)
+    args = parser.parse_args()
+
+    sch, tensors = tiled_conv2d(1, args.channel, args.channel, args.size, 3)
+    benchmark("InferBound", lambda: tvm.te.schedule.InferBound(sch.normalize()), args.repeat)
+    benchmark("lower", lambda: tvm.lower(sch, tensors), args.repeat)
+    mod = tvm.lower(sch, tensors)
+    benchmark("ThreadSync", lambda: tvm.tir.transform.ThreadSync("shared")(mod), args.repeat)
@@ -0,0 +1,448 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file latency_bench.cc
+ * \brief End to end latency, throughput, cold start and memory benchmark of
+ *  a model compiled for the graph runtime or the relay VM.
+ *
+ *  The model is loaded and run through the runtime API only, the same way a
+ *  deployed application does, and the results are written as JSON.
+ *  See latency_bench.py for how the artifacts are prepared.
+ */
+#include <dlpack/dlpack.h>
+#include <sys/resource.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/vm/memory_manager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using tvm::runtime::Module;
+using tvm::runtime::NDArray;
+using tvm::runtime::PackedFunc;
+using Clock = std::chrono::steady_clock;
+
+/*! \brief An input of the model, as given by --input name:shape:dtype. */
+struct InputSpec {
+  std::string name;
+  std::vector<int64_t> shape;
+  DLDataType dtype;
+};
+
+struct Options {
+  std::string executor = "graph";
+  std::string lib;
+  std::string graph;
+  std::string params;
+  std::string code;
+  std::string output;
+  std::vector<InputSpec> inputs;
+  TVMContext ctx{kDLCPU, 0};
+  int warmup = 10;
+  int repeat = 100;
+  std::vector<int> clients{1};
+  double duration_s = 5;
+};
+
+void Usage() {
+  std::cerr
+      << "usage: latency_bench --executor graph|vm --lib LIB [options]\n"
+      << "  --graph FILE        graph json of the graph runtime\n"
+      << "  --params FILE       saved parameters of the graph runtime\n"
+      << "  --code FILE         bytecode of the VM executable\n"
+      << "  --input SPEC        name:d0,d1,...:dtype, repeated for each input; the VM\n"
+      << "                      takes them in the order of the parameters of main\n"
+      << "  --device DEV[:ID]   cpu, cuda, opencl, vulkan, metal or rocm (default cpu)\n"
+      << "  --warmup N          runs before the latency is measured (default 10)\n"
+      << "  --repeat N          runs whose latency is measured (default 100)\n"
+      << "  --clients N,M,...   concurrent clients of the throughput runs (default 1)\n"
+      << "  --duration-s S      length of each throughput run (default 5)\n"
+      << "  --output FILE       write the JSON result to FILE instead of stdout\n";
+  std::exit(1);
+}
+
+std::vector<std::string> Split(const std::string& str, char delim) {
+  std::vector<std::string> parts;
+  std::istringstream is(str);
+  std::string part;
+  while (std::getline(is, part, delim)) parts.push_back(part);
+  return parts;
+}
+
+InputSpec ParseInput(const std::string& spec) {
+  std::vector<std::string> parts = Split(spec, ':');
+  CHECK(parts.size() == 2 || parts.size() == 3) << "Invalid input " << spec;
+  InputSpec input;
+  input.name = parts[0];
+  for (const std::string& dim : Split(parts[1], ',')) {
+    input.shape.push_back(std::stoll(dim));
+  }
+  input.dtype = tvm::runtime::String2DLDataType(parts.size() == 3 ? parts[2] : "float32");
+  return input;
+}
+
+TVMContext ParseDevice(const std::string& spec) {
+  std::vector<std::string> parts = Split(spec, ':');
+  TVMContext ctx;
+  const std::string& name = parts[0];
+  if (name == "cpu" || name == "llvm") {
+    ctx.device_type = kDLCPU;
+  } else if (name == "cuda" || name == "gpu") {
+    ctx.device_type = kDLGPU;
+  } else if (name == "opencl") {
+    ctx.device_type = kDLOpenCL;
+  } else if (name == "vulkan") {
+    ctx.device_type = kDLVulkan;
+  } else if (name == "metal") {
+    ctx.device_type = kDLMetal;
+  } else if (name == "rocm") {
+    ctx.device_type = kDLROCM;
+  } else {
+    LOG(FATAL) << "Unknown device " << name;
+  }
+  ctx.device_id = parts.size() > 1 ? std::stoi(parts[1]) : 0;
+  return ctx;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") Usage();
+    if (i + 1 >= argc) Usage();
+    std::string value = argv[++i];
+    if (arg == "--executor") {
+      opts.executor = value;
+    } else if (arg == "--lib") {
+      opts.lib = value;
+    } else if (arg == "--graph") {
+      opts.graph = value;
+    } else if (arg == "--params") {
+      opts.params = value;
+    } else if (arg == "--code") {
+      opts.code = value;
+    } else if (arg == "--input") {
+      opts.inputs.push_back(ParseInput(value));
+    } else if (arg == "--device") {
+      opts.ctx = ParseDevice(value);
+    } else if (arg == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (arg == "--repeat") {
+      opts.repeat = std::stoi(value);
+    } else if (arg == "--clients") {
+      opts.clients.clear();
+      for (const std::string& n : Split(value, ',')) opts.clients.push_back(std::stoi(n));
+    } else if (arg == "--duration-s") {
+      opts.duration_s = std::stod(value);
+    } else if (arg == "--output") {
+      opts.output = value;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n";
+      Usage();
+    }
+  }
+  if (opts.lib.empty() || opts.repeat <= 0) Usage();
+  if (opts.executor == "graph") {
+    if (opts.graph.empty()) Usage();
+  } else if (opts.executor == "vm") {
+    if (opts.code.empty()) Usage();
+  } else {
+    Usage();
+  }
+  return opts;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream is(path, std::ios::binary);
+  CHECK(is) << "Cannot open " << path;
+  return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+/*! \brief Fill the tensor with random data, the timing does not depend on the values. */
+NDArray RandomInput(const InputSpec& spec, TVMContext ctx) {
+  NDArray cpu = NDArray::Empty(spec.shape, spec.dtype, {kDLCPU, 0});
+  std::mt19937 rng(42);
+  size_t nbytes = tvm::runtime::GetDataSize(*cpu.operator->());
+  auto* data = static_cast<uint8_t*>(cpu->data);
+  if (spec.dtype.code == kDLFloat && spec.dtype.bits == 32) {
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    auto* fdata = reinterpret_cast<float*>(data);
+    for (size_t i = 0; i < nbytes / sizeof(float); ++i) fdata[i] = dist(rng);
+  } else {
+    for (size_t i = 0; i < nbytes; ++i) data[i] = static_cast<uint8_t>(rng() & 0x7f);
+  }
+  if (ctx.device_type == kDLCPU) return cpu;
+  NDArray dev = NDArray::Empty(spec.shape, spec.dtype, ctx);
+  dev.CopyFrom(cpu);
+  return dev;
+}
+
+/*! \brief One instance of the model, each client of the throughput runs owns one. */
+class Runner {
+ public:
+  virtual ~Runner() {}
+  /*! \brief Run the model once and wait for the device to finish. */
+  void Run() {
+    RunAsync();
+    TVMSynchronize(ctx_.device_type, ctx_.device_id, nullptr);
+  }
+
+ protected:
+  explicit Runner(TVMContext ctx) : ctx_(ctx) {}
+  virtual void RunAsync() = 0;
+
+  TVMContext ctx_;
+};
+
+class GraphRunner : public Runner {
+ public:
+  GraphRunner(const Options& opts, Module lib, const std::string& graph,
+              const std::string& params, const std::vector<NDArray>& inputs)
+      : Runner(opts.ctx) {
+    const PackedFunc* create = tvm::runtime::Registry::Get("tvm.graph_runtime.create");
+    CHECK(create != nullptr) << "The runtime is built without the graph runtime";
+    module_ = (*create)(graph, lib, static_cast<int>(ctx_.device_type), ctx_.device_id);
+    if (!params.empty()) {
+      TVMByteArray arr{params.data(), params.size()};
+      module_.GetFunction("load_params")(arr);
+    }
+    PackedFunc set_input = module_.GetFunction("set_input");
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      set_input(opts.inputs[i].name, inputs[i]);
+    }
+    run_ = module_.GetFunction("run");
+  }
+
+ protected:
+  void RunAsync() final { run_(); }
+
+ private:
+  Module module_;
+  PackedFunc run_;
+};
+
+class VMRunner : public Runner {
+ public:
+  VMRunner(const Options& opts, Module lib, const std::string& code,
+           const std::vector<NDArray>& inputs)
+      : Runner(opts.ctx) {
+    const PackedFunc* load = tvm::runtime::Registry::Get("runtime.Load_Executable");
+    const PackedFunc* create = tvm::runtime::Registry::Get("runtime._VirtualMachine");
+    CHECK(load != nullptr && create != nullptr) << "The runtime is built without the VM";
+    TVMByteArray arr{code.data(), code.size()};
+    Module exec = (*load)(arr, lib);
+    module_ = (*create)(exec);
+    // Use the pooled allocator, as a serving application would.
+    module_.GetFunction("init")(static_cast<int>(ctx_.device_type), ctx_.device_id,
+                                static_cast<int>(tvm::runtime::vm::kPooled));
+    std::vector<TVMValue> values(inputs.size() + 1);
+    std::vector<int> codes(inputs.size() + 1);
+    tvm::runtime::TVMArgsSetter setter(values.data(), codes.data());
+    setter(0, "main");
+    for (size_t i = 0; i < inputs.size(); ++i) setter(i + 1, inputs[i]);
+    tvm::runtime::TVMRetValue rv;
+    module_.GetFunction("set_input")
+        .CallPacked(tvm::runtime::TVMArgs(values.data(), codes.data(), values.size()), &rv);
+    invoke_ = module_.GetFunction("invoke");
+  }
+
+ protected:
+  void RunAsync() final { invoke_("main"); }
+
+ private:
+  Module module_;
+  PackedFunc invoke_;
+};
+
+double Seconds(Clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+/*! \brief The p-th percentile of the sorted samples, by the nearest rank. */
+double Percentile(const std::vector<double>& sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+/*! \brief Peak resident memory of the process in bytes. */
+int64_t PeakRSS() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+class Benchmark {
+ public:
+  explicit Benchmark(const Options& opts) : opts_(opts) {}
+
+  std::string RunAll() {
+    std::ostringstream os;
+    os.precision(6);
+    os << std::fixed;
+    os << "{\n  \"executor\": \"" << opts_.executor << "\",\n";
+    os << "  \"device\": [" << opts_.ctx.device_type << ", " << opts_.ctx.device_id << "],\n";
+
+    // Cold start covers everything a freshly started process does before its
+    // first result: loading the library and the artifacts, creating the
+    // executor, and the first run, which includes the lazy initialization.
+    Clock::time_point start = Clock::now();
+    lib_ = Module::LoadFromFile(opts_.lib);
+    if (opts_.executor == "graph") {
+      graph_ = ReadFile(opts_.graph);
+      if (!opts_.params.empty()) params_ = ReadFile(opts_.params);
+    } else {
+      code_ = ReadFile(opts_.code);
+    }
+    for (const InputSpec& spec : opts_.inputs) inputs_.push_back(RandomInput(spec, opts_.ctx));
+    std::unique_ptr<Runner> runner = CreateRunner();
+    Clock::time_point created = Clock::now();
+    runner->Run();
+    Clock::time_point first = Clock::now();
+    os << "  \"cold_start_ms\": {\"load\": " << Seconds(created - start) * 1e3
+       << ", \"first_run\": " << Seconds(first - created) * 1e3
+       << ", \"total\": " << Seconds(first - start) * 1e3 << "},\n";
+
+    for (int i = 0; i < opts_.warmup; ++i) runner->Run();
+    std::vector<double> samples(opts_.repeat);
+    for (int i = 0; i < opts_.repeat; ++i) {
+      Clock::time_point begin = Clock::now();
+      runner->Run();
+      samples[i] = Seconds(Clock::now() - begin) * 1e3;
+    }
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (double s : samples) mean += s;
+    mean /= samples.size();
+    os << "  \"latency_ms\": {\"repeat\": " << opts_.repeat << ", \"mean\": " << mean
+       << ", \"min\": " << samples.front() << ", \"p50\": " << Percentile(samples, 50)
+       << ", \"p90\": " << Percentile(samples, 90) << ", \"p99\": " << Percentile(samples, 99)
+       << ", \"max\": " << samples.back() << "},\n";
+    runner.reset();
+
+    os << "  \"throughput\": [";
+    for (size_t i = 0; i < opts_.clients.size(); ++i) {
+      os << (i == 0 ? "\n" : ",\n") << "    " << Throughput(opts_.clients[i]);
+    }
+    os << "\n  ],\n";
+    os << "  \"peak_rss_bytes\": " << PeakRSS() << "\n}\n";
+    return os.str();
+  }
+
+ private:
+  std::unique_ptr<Runner> CreateRunner() {
+    if (opts_.executor == "graph") {
+      return std::unique_ptr<Runner>(new GraphRunner(opts_, lib_, graph_, params_, inputs_));
+    }
+    return std::unique_ptr<Runner>(new VMRunner(opts_, lib_, code_, inputs_));
+  }
+
+  /*!
+   * \brief Run the model back to back from num_clients threads, each with its
+   *  own executor, for the configured duration.
+   * \return The JSON record of the run.
+   */
+  std::string Throughput(int num_clients) {
+    std::vector<std::unique_ptr<Runner>> runners;
+    for (int i = 0; i < num_clients; ++i) {
+      runners.push_back(CreateRunner());
+      runners.back()->Run();
+    }
+    std::vector<std::vector<double>> latencies(num_clients);
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    Clock::duration duration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts_.duration_s));
+    Clock::time_point deadline;
+    for (int i = 0; i < num_clients; ++i) {
+      threads.emplace_back([&, i]() {
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        while (Clock::now() < deadline) {
+          Clock::time_point begin = Clock::now();
+          runners[i]->Run();
+          latencies[i].push_back(Seconds(Clock::now() - begin) * 1e3);
+        }
+      });
+    }
+    Clock::time_point start = Clock::now();
+    deadline = start + duration;
+    go.store(true, std::memory_order_release);
+    for (std::thread& t : threads) t.join();
+    double elapsed = Seconds(Clock::now() - start);
+
+    std::vector<double> all;
+    for (const std::vector<double>& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    std::ostringstream os;
+    os.precision(6);
+    os << std::fixed;
+    os << "{\"clients\": " << num_clients << ", \"runs\": " << all.size()
+       << ", \"runs_per_s\": " << all.size() / elapsed;
+    if (!all.empty()) {
+      os << ", \"p50_ms\": " << Percentile(all, 50) << ", \"p90_ms\": " << Percentile(all, 90)
+         << ", \"p99_ms\": " << Percentile(all, 99);
+    }
+    os << "}";
+    return os.str();
+  }
+
+  const Options& opts_;
+  Module lib_;
+  std::string graph_;
+  std::string params_;
+  std::string code_;
+  std::vector<NDArray> inputs_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = ParseOptions(argc, argv);
+  std::string result = Benchmark(opts).RunAll();
+  if (opts.output.empty()) {
+    std::cout << result;
+  } else {
+    std::ofstream os(opts.output);
+    CHECK(os) << "Cannot write " << opts.output;
+    os << result;
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""End to end latency benchmark of ImageNet models.
+
+Compiles a network for the graph runtime or the relay VM, then measures it
+with the latency_bench driver, which reports p50/p90/p99 latency, the
+throughput under concurrent clients, the cold start time and the peak memory
+as JSON. Build the driver with `make` first; see README.md for the usage.
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+import tvm
+from tvm import relay
+from tvm.contrib import util as tvm_util
+
+from util import get_network
+
+
+def export(network, target, executor, dtype, batch_size, workdir):
+    """Compile the network and save the artifacts the driver loads.
+
+    Returns
+    -------
+    args: list of str
+        The driver arguments naming the artifacts and the input.
+    """
+    net, params, input_shape, _ = get_network(network, batch_size=batch_size, dtype=dtype)
+    lib_path = os.path.join(workdir, "deploy_lib.so")
+    args = ["--executor", executor, "--lib", lib_path]
+    with tvm.transform.PassContext(opt_level=3):
+        if executor == "graph":
+            graph, lib, params = relay.build(net, target=target, params=params)
+            with open(os.path.join(workdir, "deploy_graph.json"), "w") as fo:
+                fo.write(graph)
+            with open(os.path.join(workdir, "deploy_param.params"), "wb") as fo:
+                fo.write(relay.save_param_dict(params))
+            args += ["--graph", os.path.join(workdir, "deploy_graph.json"),
+                     "--params", os.path.join(workdir, "deploy_param.params")]
+        else:
+            exe = relay.vm.compile(net, target=target, params=params)
+            code, lib = exe.save()
+            with open(os.path.join(workdir, "deploy_code.ro"), "wb") as fo:
+                fo.write(code)
+            args += ["--code", os.path.join(workdir, "deploy_code.ro")]
+    lib.export_library(lib_path)
+    args += ["--input", "data:%s:%s" % (",".join(str(x) for x in input_shape), dtype)]
+    return args
+
+
+def benchmark(network, target, device):
+    workdir = tvm_util.tempdir()
+    cmd = [args.driver] + export(network, target, args.executor, args.dtype,
+                                 args.batch_size, workdir.temp_dir)
+    cmd += ["--device", device,
+            "--warmup", str(args.warmup),
+            "--repeat", str(args.repeat),
+            "--clients", args.clients,
+            "--duration-s", str(args.duration_s)]
+    out = subprocess.run(cmd, stdout=subprocess.PIPE, check=True).stdout
+    result = json.loads(out.decode())
+    result["network"] = network
+    result["target"] = str(target)
+    return result
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--network", type=str, choices=
+                        ['resnet-18', 'resnet-34', 'resnet-50',
+                         'vgg-16', 'vgg-19', 'densenet-121', 'inception_v3',
+                         'mobilenet', 'squeezenet_v1.0', 'squeezenet_v1.1'],
+                        help='The name of neural network')
+    parser.add_argument("--executor", type=str, choices=['graph', 'vm'], default='graph',
+                        help="The executor the network is compiled for")
+    parser.add_argument("--target", type=str, default='llvm',
+                        help="The tvm compilation target")
+    parser.add_argument("--device", type=str, default='cpu',
+                        help="The device of the driver, e.g. cpu, cuda or cuda:1")
+    parser.add_argument("--dtype", type=str, default='float32')
+    parser.add_argument("--batch-size", type=int, default=1)
+    parser.add_argument("--warmup", type=int, default=10)
+    parser.add_argument("--repeat", type=int, default=200)
+    parser.add_argument("--clients", type=str, default='1,2,4',
+                        help="Comma separated numbers of concurrent clients to measure")
+    parser.add_argument("--duration-s", type=float, default=5,
+                        help="The length of each throughput measurement")
+    parser.add_argument("--driver", type=str,
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                             "build", "latency_bench"),
+                        help="The path of the latency_bench driver")
+    parser.add_argument("--output", type=str, help="Write the JSON results to this file")
+    args = parser.parse_args()
+
+    if args.network is None:
+        networks = ['resnet-50', 'mobilenet']
+    else:
+        networks = [args.network]
+
+    target = tvm.target.create(args.target)
+
+    results = []
+    for network in networks:
+        result = benchmark(network, target, args.device)
+        results.append(result)
+        lat = result["latency_ms"]
+        print("%-20s p50 %.2f ms  p90 %.2f ms  p99 %.2f ms  cold start %.2f ms"
+              % (network, lat["p50"], lat["p90"], lat["p99"], result["cold_start_ms"]["total"]),
+              file=sys.stderr)
+
+    if args.output:
+        with open(args.output, "w") as fo:
+            json.dump(results, fo, indent=2)
+    else:
+        print(json.dumps(results, indent=2))
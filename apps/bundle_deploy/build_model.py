@@ -21,6 +21,7 @@ import os
 from tvm import relay
 import tvm
 from tvm import te
+from tvm.relay.backend import aot_codegen
 import logging
 import json
 
@@ -29,6 +30,16 @@ RUNTIMES = {
     'c++': '{name}_cpp.{ext}',
 }
 
+def build_aot(mod, params, name, build_dir):
+    """Build the operators and the C executor, with the params linked in."""
+    with tvm.transform.PassContext(opt_level=3, config={'tir.disable_vectorize': True}):
+        source, lib = aot_codegen.build(mod, 'llvm --runtime=c --system-lib', params=params)
+    if not os.path.isdir(build_dir):
+        os.makedirs(build_dir)
+    lib.save(os.path.join(build_dir, f'{name}_aot.o'))
+    with open(os.path.join(build_dir, f'{name}_aot_executor.c'), 'w') as f_executor:
+        f_executor.write(source)
+
 def build_module(opts):
     dshape = (1, 3, 224, 224)
     from mxnet.gluon.model_zoo.vision import get_model
@@ -37,6 +48,7 @@ def build_module(opts):
     mod, params = relay.frontend.from_mxnet(block, shape_dict)
     func = mod["main"]
     func = relay.Function(func.params, relay.nn.softmax(func.body), None, func.type_params, func.attrs)
+    build_aot(tvm.IRModule.from_expr(func), params, 'model', os.path.abspath(opts.out_dir))
 
     for runtime_name, file_format_str in RUNTIMES.items():
         with tvm.transform.PassContext(opt_level=3, config={'tir.disable_vectorize': True}):
@@ -63,6 +75,7 @@ def build_test_module(opts):
     x_data = np.random.rand(10, 5).astype('float32')
     y_data = np.random.rand(1, 5).astype('float32')
     params = {"y": y_data}
+    build_aot(tvm.IRModule.from_expr(func), params, 'test_model', os.path.abspath(opts.out_dir))
 
     for runtime_name, file_format_str in RUNTIMES.items():
         with tvm.transform.PassContext(opt_level=3, config={'tir.disable_vectorize': True}):
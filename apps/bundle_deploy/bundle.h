@@ -33,4 +33,14 @@ TVM_DLL void tvm_runtime_run(void* runtime);
 
 TVM_DLL void tvm_runtime_get_output(void* runtime, int32_t index, DLTensor* tensor);
 
+/*
+ * The ahead-of-time bundle, whose storage plan, operator calls and params are fixed at link
+ * time, so it has no create or destroy step. The functions return 0 on success.
+ */
+TVM_DLL int32_t tvm_runtime_aot_set_input(const char* name, const DLTensor* tensor);
+
+TVM_DLL int32_t tvm_runtime_aot_run(void);
+
+TVM_DLL int32_t tvm_runtime_aot_get_output(int32_t index, DLTensor* tensor);
+
 #endif /* TVM_APPS_BUNDLE_DEPLOY_BUNDLE_H_ */
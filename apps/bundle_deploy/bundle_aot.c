@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tvm/runtime/crt/platform.h>
+
+#include "bundle.h"
+
+/* Defined by the executor generated by relay.backend.aot_codegen. */
+extern const char* tvm_aot_input_names[];
+int32_t tvm_aot_run(void);
+DLTensor* tvm_aot_get_input(int32_t index);
+DLTensor* tvm_aot_get_output(int32_t index);
+int32_t tvm_aot_num_outputs(void);
+
+static size_t TensorBytes(const DLTensor* tensor) {
+  size_t size = (tensor->dtype.bits * tensor->dtype.lanes + 7) / 8;
+  for (int i = 0; i < tensor->ndim; ++i) {
+    size *= tensor->shape[i];
+  }
+  return size;
+}
+
+TVM_DLL int32_t tvm_runtime_aot_set_input(const char* name, const DLTensor* tensor) {
+  // The linked params are read-only and not listed among the inputs.
+  for (int32_t i = 0; tvm_aot_input_names[i] != NULL; ++i) {
+    if (strcmp(tvm_aot_input_names[i], name) != 0) continue;
+    DLTensor* input = tvm_aot_get_input(i);
+    if (TensorBytes(tensor) != TensorBytes(input)) {
+      fprintf(stderr, "input %s has %zu bytes, expected %zu\n", name, TensorBytes(tensor),
+              TensorBytes(input));
+      return -1;
+    }
+    memcpy(input->data, (const char*)tensor->data + tensor->byte_offset, TensorBytes(input));
+    return 0;
+  }
+  fprintf(stderr, "no input named %s\n", name);
+  return -1;
+}
+
+TVM_DLL int32_t tvm_runtime_aot_run(void) { return tvm_aot_run(); }
+
+TVM_DLL int32_t tvm_runtime_aot_get_output(int32_t index, DLTensor* tensor) {
+  if (index < 0 || index >= tvm_aot_num_outputs()) {
+    fprintf(stderr, "no output %d\n", index);
+    return -1;
+  }
+  DLTensor* output = tvm_aot_get_output(index);
+  if (TensorBytes(tensor) != TensorBytes(output)) {
+    fprintf(stderr, "output %d has %zu bytes, given %zu\n", index, TensorBytes(output),
+            TensorBytes(tensor));
+    return -1;
+  }
+  memcpy((char*)tensor->data + tensor->byte_offset, output->data, TensorBytes(output));
+  return 0;
+}
+
+void __attribute__((noreturn)) TVMPlatformAbort(int error_code) {
+  fprintf(stderr, "TVMPlatformAbort: %d\n", error_code);
+  exit(-1);
+}
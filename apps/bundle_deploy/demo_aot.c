@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <tvm/runtime/c_runtime_api.h>
+
+#include "bundle.h"
+
+#define OUTPUT_LEN 1000
+
+int main(int argc, char** argv) {
+  assert(argc == 2 && "Usage: demo_aot <cat.bin>");
+
+  struct timeval t0, t1, t2, t3;
+
+  float input_storage[1 * 3 * 224 * 224];
+  FILE* fp = fopen(argv[1], "rb");
+  (void)fread(input_storage, 3 * 224 * 224, 4, fp);
+  fclose(fp);
+
+  DLTensor input;
+  input.data = input_storage;
+  DLContext ctx = {kDLCPU, 0};
+  input.ctx = ctx;
+  input.ndim = 4;
+  DLDataType dtype = {kDLFloat, 32, 1};
+  input.dtype = dtype;
+  int64_t shape[4] = {1, 3, 224, 224};
+  input.shape = shape;
+  input.strides = NULL;
+  input.byte_offset = 0;
+
+  // There is nothing to create: the graph and the params are linked in.
+  gettimeofday(&t0, 0);
+  if (tvm_runtime_aot_set_input("data", &input) != 0) {
+    fprintf(stderr, "tvm_runtime_aot_set_input failed\n");
+    return -1;
+  }
+  gettimeofday(&t1, 0);
+
+  if (tvm_runtime_aot_run() != 0) {
+    fprintf(stderr, "tvm_runtime_aot_run failed\n");
+    return -1;
+  }
+  gettimeofday(&t2, 0);
+
+  float output_storage[OUTPUT_LEN];
+  DLTensor output;
+  output.data = output_storage;
+  DLContext out_ctx = {kDLCPU, 0};
+  output.ctx = out_ctx;
+  output.ndim = 2;
+  DLDataType out_dtype = {kDLFloat, 32, 1};
+  output.dtype = out_dtype;
+  int64_t out_shape[2] = {1, OUTPUT_LEN};
+  output.shape = out_shape;
+  output.strides = NULL;
+  output.byte_offset = 0;
+
+  if (tvm_runtime_aot_get_output(0, &output) != 0) {
+    fprintf(stderr, "tvm_runtime_aot_get_output failed\n");
+    return -1;
+  }
+  gettimeofday(&t3, 0);
+
+  float max_iter = -FLT_MAX;
+  int32_t max_index = -1;
+  for (int i = 0; i < OUTPUT_LEN; ++i) {
+    if (output_storage[i] > max_iter) {
+      max_iter = output_storage[i];
+      max_index = i;
+    }
+  }
+
+  printf("The maximum position in output vector is: %d, with max-value %f.\n", max_index, max_iter);
+  printf("timing: %.2f ms (set_input), %.2f ms (run), %.2f ms (get_output)\n",
+         (t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_usec - t0.tv_usec) / 1000.f,
+         (t2.tv_sec - t1.tv_sec) * 1000 + (t2.tv_usec - t1.tv_usec) / 1000.f,
+         (t3.tv_sec - t2.tv_sec) * 1000 + (t3.tv_usec - t2.tv_usec) / 1000.f);
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tvm/runtime/c_runtime_api.h>
+
+#include "bundle.h"
+
+int main(int argc, char** argv) {
+  assert(argc == 3 && "Usage: test_aot <data.bin> <output.bin>");
+
+  float input_storage[10 * 5];
+  FILE* fp = fopen(argv[1], "rb");
+  fread(input_storage, 10 * 5, 4, fp);
+  fclose(fp);
+
+  float result_storage[10 * 5];
+  fp = fopen(argv[2], "rb");
+  fread(result_storage, 10 * 5, 4, fp);
+  fclose(fp);
+
+  DLTensor input;
+  input.data = input_storage;
+  DLContext ctx = {kDLCPU, 0};
+  input.ctx = ctx;
+  input.ndim = 2;
+  DLDataType dtype = {kDLFloat, 32, 1};
+  input.dtype = dtype;
+  int64_t shape[2] = {10, 5};
+  input.shape = shape;
+  input.strides = NULL;
+  input.byte_offset = 0;
+
+  float output_storage[10 * 5];
+  DLTensor output;
+  output.data = output_storage;
+  DLContext out_ctx = {kDLCPU, 0};
+  output.ctx = out_ctx;
+  output.ndim = 2;
+  DLDataType out_dtype = {kDLFloat, 32, 1};
+  output.dtype = out_dtype;
+  int64_t out_shape[2] = {10, 5};
+  output.shape = out_shape;
+  output.strides = NULL;
+  output.byte_offset = 0;
+
+  // The param y is linked in, only x is set.
+  if (tvm_runtime_aot_set_input("x", &input) != 0) {
+    fprintf(stderr, "tvm_runtime_aot_set_input failed\n");
+    return -1;
+  }
+  if (tvm_runtime_aot_run() != 0) {
+    fprintf(stderr, "tvm_runtime_aot_run failed\n");
+    return -1;
+  }
+  if (tvm_runtime_aot_get_output(0, &output) != 0) {
+    fprintf(stderr, "tvm_runtime_aot_get_output failed\n");
+    return -1;
+  }
+
+  for (int i = 0; i < 10 * 5; ++i) {
+    assert(fabs(output_storage[i] - result_storage[i]) < 1e-5f);
+    if (fabs(output_storage[i] - result_storage[i]) >= 1e-5f) {
+      printf("got %f, expected %f\n", output_storage[i], result_storage[i]);
+    }
+  }
+
+  return 0;
+}
@@ -113,6 +113,9 @@ set(USE_GRAPH_RUNTIME ON)
 # Whether enable additional graph debug functions
 set(USE_GRAPH_RUNTIME_DEBUG OFF)
 
+# Whether enable the graph runtime which replays CUDA Graphs, requires CUDA 10.1
+set(USE_GRAPH_RUNTIME_CUDA_GRAPH OFF)
+
 # Whether enable additional vm profiler functions
 set(USE_VM_PROFILER OFF)
 
@@ -248,6 +251,15 @@ set(USE_TF_TVMDSOOP OFF)
 # Whether to use STL's std::unordered_map or TVM's POD compatible Map
 set(USE_FALLBACK_STL_MAP OFF)
 
+# Whether make_object allocates from a size-segregated, thread-caching pool
+# instead of new/delete, which speeds up the compilation of large models
+set(USE_OBJECT_POOL_ALLOCATOR OFF)
+
+# Whether to compile the trace points of the runtime hot paths (operators,
+# allocations, copies, thread pool launches). Tracing stays off until enabled
+# with tvm.runtime.trace.enable() or TVM_RUNTIME_TRACE=1 in the environment.
+set(USE_RUNTIME_TRACE ON)
+
 # Whether to use hexagon device
 set(USE_HEXAGON_DEVICE OFF)
 set(USE_HEXAGON_SDK /path/to/sdk)
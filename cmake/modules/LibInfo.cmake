@@ -44,6 +44,7 @@ function(add_lib_info src_file)
     TVM_INFO_USE_STACKVM_RUNTIME="${USE_STACKVM_RUNTIME}"
     TVM_INFO_USE_GRAPH_RUNTIME="${USE_GRAPH_RUNTIME}"
     TVM_INFO_USE_GRAPH_RUNTIME_DEBUG="${USE_GRAPH_RUNTIME_DEBUG}"
+    TVM_INFO_USE_GRAPH_RUNTIME_CUDA_GRAPH="${USE_GRAPH_RUNTIME_CUDA_GRAPH}"
     TVM_INFO_USE_OPENMP="${USE_OPENMP}"
     TVM_INFO_USE_RELAY_DEBUG="${USE_RELAY_DEBUG}"
     TVM_INFO_USE_RTTI="${USE_RTTI}"
@@ -53,6 +54,8 @@ function(add_lib_info src_file)
     TVM_INFO_HIDE_PRIVATE_SYMBOLS="${HIDE_PRIVATE_SYMBOLS}"
     TVM_INFO_USE_TF_TVMDSOOP="${USE_TF_TVMDSOOP}"
     TVM_INFO_USE_FALLBACK_STL_MAP="${USE_FALLBACK_STL_MAP}"
+    TVM_INFO_USE_OBJECT_POOL_ALLOCATOR="${USE_OBJECT_POOL_ALLOCATOR}"
+    TVM_INFO_USE_RUNTIME_TRACE="${USE_RUNTIME_TRACE}"
     TVM_INFO_USE_BLAS="${USE_BLAS}"
     TVM_INFO_USE_MKL="${USE_MKL}"
     TVM_INFO_USE_MKLDNN="${USE_MKLDNN}"
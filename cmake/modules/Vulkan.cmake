@@ -25,6 +25,8 @@ tvm_option(USE_VULKAN_DEDICATED_ALLOCATION "Use Vulkan dedicated allocations" ON
 IF USE_VULKAN)
 tvm_option(USE_VULKAN_VALIDATION "Enable Vulkan API validation layers" OFF
   IF USE_VULKAN)
+tvm_option(USE_VULKAN_TIMELINE_SEMAPHORE "Use Vulkan timeline semaphores for async submission
+(KHR_timeline_semaphore extension)" ON IF USE_VULKAN)
 
 if(Vulkan_FOUND)
   # always set the includedir
@@ -56,4 +58,8 @@ if(USE_VULKAN)
     message(STATUS "Build with Vulkan API validation")
     add_definitions(-DUSE_VULKAN_VALIDATION=1)
   endif()
+  if(USE_VULKAN_TIMELINE_SEMAPHORE)
+    message(STATUS "Build with Vulkan timeline semaphores")
+    add_definitions(-DUSE_VULKAN_TIMELINE_SEMAPHORE=1)
+  endif()
 endif(USE_VULKAN)
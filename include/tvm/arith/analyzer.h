@@ -26,6 +26,8 @@
 
 #include <tvm/arith/int_set.h>
 #include <tvm/ir/expr.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/support/with.h>
 
 #include <limits>
@@ -163,6 +165,8 @@ class ConstIntBoundAnalyzer {
   class Impl;
   /*! \brief Internal impl */
   Impl* impl_;
+  /*! \brief The parent analyzer, which holds the memoized results */
+  Analyzer* parent_;
 };
 
 /*!
@@ -244,6 +248,8 @@ class ModularSetAnalyzer {
   class Impl;
   /*! \brief Internal impl */
   Impl* impl_;
+  /*! \brief The parent analyzer, which holds the memoized results */
+  Analyzer* parent_;
 };
 
 /*!
@@ -278,6 +284,8 @@ class RewriteSimplifier {
   class Impl;
   /*! \brief Internal impl */
   Impl* impl_;
+  /*! \brief The parent analyzer, which holds the memoized results */
+  Analyzer* parent_;
 };
 
 /*!
@@ -309,6 +317,8 @@ class CanonicalSimplifier {
   class Impl;
   /*! \brief Internal impl */
   Impl* impl_;
+  /*! \brief The parent analyzer, which holds the memoized results */
+  Analyzer* parent_;
 };
 
 /*!
@@ -383,6 +393,11 @@ class IntSetAnalyzer {
  * NOTE for sub-analyzer developers:
  * If the analyzer uses memoization, we need to clear the internal
  * cache when information about a Var has been overridden.
+ *
+ * When EnableMemo is set, the results of const_int_bound, modular_set,
+ * rewrite_simplify and canonical_simplify are memoized by the structure
+ * of the expression. The memo is cleared when a variable is bound or
+ * updated, and each constraint scope has its own memo.
  */
 class TVM_DLL Analyzer {
  public:
@@ -481,6 +496,42 @@ class TVM_DLL Analyzer {
    * \note Analyzer will call into sub-analyzers to get the result.
    */
   PrimExpr Simplify(const PrimExpr& expr, int steps = 2);
+  /*!
+   * \brief Enable or disable the memoization of the results of the sub-analyzers.
+   *
+   *  Lowering queries the same sub-expressions many times between two
+   *  bindings, which the memo answers without running the analysis again.
+   *  The tir.Simplify pass enables it when the "arith.memoize" option of its
+   *  PassContext is set.
+   *
+   * \param enable Whether to memoize.
+   */
+  void EnableMemo(bool enable = true);
+
+ private:
+  friend class ConstIntBoundAnalyzer;
+  friend class ModularSetAnalyzer;
+  friend class RewriteSimplifier;
+  friend class CanonicalSimplifier;
+  friend class ConstraintContext;
+  template <typename T>
+  using MemoMap = std::unordered_map<PrimExpr, T, StructuralHash, StructuralEqual>;
+  /*! \brief The memoized results under one constraint scope. */
+  struct MemoScope {
+    MemoMap<ConstIntBound> const_int_bound;
+    MemoMap<ModularSet> modular_set;
+    MemoMap<PrimExpr> rewrite_simplify;
+    MemoMap<PrimExpr> canonical_simplify;
+  };
+  /*!
+   * \brief Get the memo of the current scope for the results of expr.
+   * \return nullptr when memoization is disabled or expr is a leaf.
+   */
+  MemoScope* GetMemo(const PrimExpr& expr);
+  /*! \brief Clear the memo of all the scopes, called when a variable is bound or updated. */
+  void ClearMemo();
+  /*! \brief The memo of each constraint scope, empty when memoization is disabled. */
+  std::vector<MemoScope> memo_;
 };
 
 }  // namespace arith
@@ -36,6 +36,8 @@ using tir::IterVar;
 using tir::Var;
 using tir::VarNode;
 
+class Analyzer;
+
 //-----------------------------------------------
 // Integer set data structure.
 //
@@ -203,6 +205,75 @@ using ExprIntSetMap = std::unordered_map<PrimExpr, IntSet, ObjectPtrHash, Object
 ExprIntSetMap EvalSetForEachSubExpr(PrimExpr e,
                                     const std::unordered_map<const VarNode*, IntSet>& dom_map);
 
+/*!
+ * \brief Evaluate the integer sets of many expressions against the same domain map.
+ *
+ *  Calling EvalSet once per access converts the domain map and creates an
+ *  analyzer on every call, and relaxes the domain of every variable again.
+ *  This evaluator converts the domain map once, shares one analyzer and caches
+ *  the relaxed interval of each variable, so it is meant for evaluating all the
+ *  accesses of a buffer under one loop nest.
+ *
+ * \note The cache assumes that the domain map and the bindings of the
+ *  analyzer do not change during the lifetime of the evaluator.
+ */
+class RegionEvaluator {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param dom_map The domain of each variable.
+   * \param analyzer The analyzer to simplify the bounds with,
+   *        a new one is created if it is nullptr.
+   */
+  TVM_DLL explicit RegionEvaluator(const Map<Var, IntSet>& dom_map, Analyzer* analyzer = nullptr);
+  /*!
+   * \brief Constructor.
+   * \param dom_map The domain of each variable.
+   * \param analyzer The analyzer to simplify the bounds with,
+   *        a new one is created if it is nullptr.
+   */
+  TVM_DLL explicit RegionEvaluator(const std::unordered_map<const VarNode*, IntSet>& dom_map,
+                                   Analyzer* analyzer = nullptr);
+  TVM_DLL ~RegionEvaluator();
+  /*!
+   * \brief Evaluate the set of an expression.
+   * \param e The expression to be evaluated.
+   * \return An integer set that can cover all the possible values of e.
+   */
+  TVM_DLL IntSet Eval(const PrimExpr& e);
+  /*!
+   * \brief Evaluate the set covered by a range.
+   * \param r The range to be evaluated.
+   * \return An integer set that can cover all the possible values.
+   */
+  TVM_DLL IntSet Eval(const Range& r);
+  /*!
+   * \brief Relax the bounds of a set.
+   * \param s The set to be evaluated.
+   * \return An integer set that can cover all the possible values.
+   */
+  TVM_DLL IntSet Eval(const IntSet& s);
+  /*!
+   * \brief Evaluate the set of each index of an access.
+   * \param indices The indices of the access.
+   * \return The set of each index.
+   */
+  TVM_DLL Array<IntSet> Eval(const Array<PrimExpr>& indices);
+  /*!
+   * \brief Evaluate the set of each dimension of a region.
+   * \param region The region to be evaluated.
+   * \return The set of each dimension.
+   */
+  TVM_DLL Array<IntSet> Eval(const Array<Range>& region);
+
+ private:
+  class Impl;
+  Impl* impl_;
+  // The evaluator is not copyable.
+  RegionEvaluator(const RegionEvaluator&) = delete;
+  RegionEvaluator& operator=(const RegionEvaluator&) = delete;
+};
+
 /*!
  * \brief Create an union set of all sets
  * \param sets The sets to be unioned
@@ -50,6 +50,11 @@ class TuningOptionsNode : public Object {
   ProgramRunner runner;
   /*! \brief MeasureCallback functions to be called after each measure batch */
   Optional<Array<MeasureCallback>> measure_callbacks;
+  /*!
+   * \brief The number of built batches that may wait for the runner. A positive value builds the
+   * next batches while the current one is measured, 0 builds and runs every batch in turn.
+   */
+  int measure_pipeline_depth;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("num_measure_trials", &num_measure_trials);
@@ -59,6 +64,7 @@ class TuningOptionsNode : public Object {
     v->Visit("builder", &builder);
     v->Visit("runner", &runner);
     v->Visit("measure_callbacks", &measure_callbacks);
+    v->Visit("measure_pipeline_depth", &measure_pipeline_depth);
   }
 
   static constexpr const char* _type_key = "auto_scheduler.TuningOptions";
@@ -81,10 +87,11 @@ class TuningOptions : public ObjectRef {
    * \param builder ProgramBuilder which builds the program.
    * \param runner ProgramRunner which runs the program and measure time costs.
    * \param measure_callbacks MeasureCallback functions to be called after each measure batch.
+   * \param measure_pipeline_depth The number of built batches that may wait for the runner.
    */
   TuningOptions(int num_measure_trials, int early_stopping, int num_measures_per_round, int verbose,
                 ProgramBuilder builder, ProgramRunner runner,
-                Optional<Array<MeasureCallback>> measure_callbacks);
+                Optional<Array<MeasureCallback>> measure_callbacks, int measure_pipeline_depth = 0);
 
   TVM_DEFINE_OBJECT_REF_METHODS(TuningOptions, ObjectRef, TuningOptionsNode);
 };
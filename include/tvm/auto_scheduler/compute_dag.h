@@ -37,7 +37,9 @@
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/te/schedule.h>
+#include <tvm/te/schedule_pass.h>
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -181,6 +183,11 @@ class ComputeDAGNode : public Object {
   State init_state;
   /*! \brief The static read-write access analyzer */
   AccessAnalyzer access_analyzer;
+  /*!
+   * \brief The bound inference results of the states replayed from this DAG. The states of a
+   * search share most of their trailing stages, whose bounds are reused from this cache.
+   */
+  std::shared_ptr<te::InferBoundCache> infer_bound_cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("tensors", &tensors);
@@ -30,6 +30,8 @@
 #include <tvm/node/node.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <random>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -154,6 +156,115 @@ class PythonBasedModel : public CostModel {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PythonBasedModel, CostModel, PythonBasedModelNode);
 };
 
+/*! \brief A node of a regression tree in GBDTModel */
+struct GBDTTreeNode {
+  /*! \brief The feature to split on, -1 for a leaf. */
+  int feature;
+  /*! \brief Samples with a feature value less than this go to the left child. */
+  float threshold;
+  /*! \brief The index of the left child in the tree, the right child follows it. */
+  int left;
+  /*! \brief The output of a leaf. */
+  float value;
+};
+
+/*!
+ * \brief A gradient boosted decision tree model trained and evaluated in C++.
+ * Like the XGBModel in python, it predicts a score for every BufferStore statement from its
+ * per-store features and sums them up as the score of a state. It is trained with the pack-sum
+ * square error against the normalized throughputs, but without crossing the FFI or holding the
+ * GIL, so that feature extraction, training and prediction all run on multiple threads.
+ */
+class GBDTModelNode : public CostModelNode {
+ public:
+  /*! \brief The number of trees added to the ensemble by every update. */
+  int num_trees_per_update;
+  /*! \brief The ensemble is retrained from scratch when it would grow beyond this many trees. */
+  int max_num_trees;
+  /*! \brief The maximum depth of a tree. */
+  int max_depth;
+  /*! \brief The shrinkage of every tree. */
+  float learning_rate;
+  /*! \brief The L2 regularization on the leaf values. */
+  float reg_lambda;
+  /*! \brief The minimum sum of hessians in a child of a split. */
+  float min_child_weight;
+  /*! \brief The number of bins the features are quantized to when searching splits, at most 256. */
+  int max_bins;
+  /*! \brief Predict random scores until more samples than this are measured. -1 to disable. */
+  int num_warmup_sample;
+  /*! \brief The maximum number of extracted buffers for one statement. */
+  int max_n_bufs;
+
+  void Update(const Array<MeasureInput>& inputs, const Array<MeasureResult>& results) final;
+
+  void Predict(const SearchTask& task, const Array<State>& states,
+               std::vector<float>* scores) final;
+
+  void PredictStages(const SearchTask& task, const Array<State>& states,
+                     std::vector<float>* state_scores,
+                     std::vector<std::vector<float>>* stage_scores) final;
+
+  /*!
+   * \brief Save the trees to a file.
+   * \param file_name The name of the file.
+   */
+  void Save(const std::string& file_name) const;
+
+  /*!
+   * \brief Load the trees from a file, and use them for prediction right away.
+   * \param file_name The name of the file.
+   */
+  void Load(const std::string& file_name);
+
+  static constexpr const char* _type_key = "auto_scheduler.GBDTModel";
+  TVM_DECLARE_FINAL_OBJECT_INFO(GBDTModelNode, CostModelNode);
+
+ private:
+  /*!
+   * \brief Predict the per-store scores of states.
+   * \param task The search task of states
+   * \param states The input states
+   * \param store_scores The predicted scores for all stores in every state, empty for the states
+   * that fail to be lowered.
+   * \return Whether the predictions come from the trees rather than random.
+   */
+  bool PredictStores(const SearchTask& task, const Array<State>& states,
+                     std::vector<std::vector<float>>* store_scores);
+
+  /*! \brief The measured inputs and results, the training set. */
+  Array<MeasureInput> inputs_;
+  Array<MeasureResult> results_;
+  /*! \brief The features extracted from inputs_. */
+  std::vector<std::vector<float>> features_;
+  /*! \brief The trees of the ensemble. */
+  std::vector<std::vector<GBDTTreeNode>> trees_;
+  /*! \brief The random generator of warm-up predictions. */
+  std::mt19937 rand_gen_;
+
+  friend class GBDTModel;
+};
+
+/*!
+ * \brief Managed reference to GBDTModelNode.
+ * \sa GBDTModelNode
+ */
+class GBDTModel : public CostModel {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param num_trees_per_update The number of trees added to the ensemble by every update.
+   * \param max_depth The maximum depth of a tree.
+   * \param learning_rate The shrinkage of every tree.
+   * \param num_warmup_sample Predict random scores until more samples than this are measured.
+   * \param seed The random seed.
+   */
+  GBDTModel(int num_trees_per_update, int max_depth, float learning_rate, int num_warmup_sample,
+            int seed);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(GBDTModel, CostModel, GBDTModelNode);
+};
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
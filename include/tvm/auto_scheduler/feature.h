@@ -83,6 +83,12 @@ void GetPerStoreFeaturesFromStates(const Array<State>& states, const std::vector
                                    int skip_first_n_feature_extraction, int max_n_bufs,
                                    std::vector<std::vector<float> >* features);
 
+/*!
+ * \brief Drop all the per-store features cached by GetPerStoreFeaturesFromStates.
+ * The features of a state are cached by its workload, target and transform steps.
+ */
+void ClearPerStoreFeatureCache();
+
 /*!
  * \brief Get per-store features from a log file
  * \param filename The name of log file
@@ -302,6 +302,14 @@ class State : public ObjectRef {
    * \return The new iterator after parallel.
    */
   TVM_DLL Iterator parallel(int stage_id, const Iterator& it);
+  /*!
+   * \brief The schedule primitive corresponding to `te::Stage::tensorize`. The tensor intrinsic
+   * is the one named by the `SearchPolicyKey::tensorize_intrin` attribute of the stage's op.
+   * \param stage_id The index of the stage to be tensorized.
+   * \param it The outermost iterator of the tensorized region.
+   * \return The new iterator after tensorize.
+   */
+  TVM_DLL Iterator tensorize(int stage_id, const Iterator& it);
   /*!
    * \brief The schedule primitive corresponding to `te::Stage::unroll`.
    * \param stage_id The index of the stage to be unrolled.
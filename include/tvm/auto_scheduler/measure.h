@@ -41,9 +41,11 @@
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/auto_scheduler/search_task.h>
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace tvm {
 namespace auto_scheduler {
@@ -276,6 +278,19 @@ class ProgramRunnerNode : public Object {
   int min_repeat_ms;
   /*! \brief The cool down interval between two measurements. */
   double cooldown_interval;
+  /*!
+   * \brief The maximum number of repeats in the adaptive measurement mode. The mode is enabled when
+   * this is larger than `repeat`. Repeats are then added `repeat` at a time until the confidence
+   * interval of the mean is tight enough, and the leading warmup outliers are discarded.
+   */
+  int max_repeat;
+  /*! \brief The relative half width of the 95% confidence interval that stops the repeats. */
+  double confidence_tolerance;
+  /*!
+   * \brief Stop repeating a candidate once its cost is surely larger than this ratio times the best
+   * cost measured for the same workload. 0 disables the early abort.
+   */
+  double slow_abort_ratio;
 
   /*!
    * \brief Run measurement and return results.
@@ -358,8 +373,14 @@ class LocalRunner : public ProgramRunner {
    * \param repeat The number of times to repeat the measurement.
    * \param min_repeat_ms The minimum duration of one repeat in milliseconds.
    * \param cooldown_interval The cool down interval between two measurements.
+   * \param max_repeat The maximum number of repeats in the adaptive measurement mode.
+   * \param confidence_tolerance The relative half width of the confidence interval that stops the
+   * adaptive repeats.
+   * \param slow_abort_ratio The ratio to the best cost beyond which a candidate stops repeating.
    */
-  LocalRunner(int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval);
+  LocalRunner(int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval,
+              int max_repeat = 0, double confidence_tolerance = 0.02,
+              double slow_abort_ratio = 0.0);
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(LocalRunner, ProgramRunner, LocalRunnerNode);
 };
@@ -408,9 +429,14 @@ class RPCRunner : public ProgramRunner {
    * \param repeat The number of times to repeat the measurement.
    * \param min_repeat_ms The minimum duration of one repeat in milliseconds.
    * \param cooldown_interval The cool down interval between two measurements.
+   * \param max_repeat The maximum number of repeats in the adaptive measurement mode.
+   * \param confidence_tolerance The relative half width of the confidence interval that stops the
+   * adaptive repeats.
+   * \param slow_abort_ratio The ratio to the best cost beyond which a candidate stops repeating.
    */
   RPCRunner(const String& key, const String& host, int port, int priority, int n_parallel,
-            int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval);
+            int timeout, int number, int repeat, int min_repeat_ms, double cooldown_interval,
+            int max_repeat = 0, double confidence_tolerance = 0.02, double slow_abort_ratio = 0.0);
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RPCRunner, ProgramRunner, RPCRunnerNode);
 };
@@ -440,6 +466,13 @@ class ProgramMeasurerNode : public Object {
   int verbose;
   /*! \brief The number of max continuous error. */
   int max_continous_error;
+  /*!
+   * \brief The number of built batches that may wait for the runner. With a positive depth, the
+   * next batches are built on another thread while the runner measures the current one. 0 builds
+   * and runs every batch in turn. Overlapping only pays off when the runner measures on other
+   * machines, a local build competes with a local measurement for the CPU.
+   */
+  int pipeline_depth;
 
   /*! \brief Reset book keeping variables */
   void Reset();
@@ -470,6 +503,17 @@ class ProgramMeasurerNode : public Object {
 
   static constexpr const char* _type_key = "auto_scheduler.ProgramMeasurer";
   TVM_DECLARE_FINAL_OBJECT_INFO(ProgramMeasurerNode, Object);
+
+ private:
+  /*!
+   * \brief Build the batches on another thread and run them on this one as they are built.
+   * \param input_batches The batches of MeasureInputs.
+   * \param process_batch The function to process the results of a batch, in the batch order.
+   */
+  void PipelinedMeasure(
+      const std::vector<Array<MeasureInput>>& input_batches,
+      const std::function<void(const Array<MeasureInput>&, const Array<MeasureResult>&)>&
+          process_batch);
 };
 
 /*!
@@ -486,10 +530,12 @@ class ProgramMeasurer : public ObjectRef {
    * \param verbose Verbosity level. 0 for silent, 1 to output information during program
    * measuring.
    * \param max_continous_error The number of allowed maximum continuous error.
+   * \param pipeline_depth The number of built batches that may wait for the runner, 0 to build
+   * and run every batch in turn.
    */
   ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
                   Optional<Array<MeasureCallback>> callbacks, int verbose,
-                  int max_continous_error = -1);
+                  int max_continous_error = -1, int pipeline_depth = 0);
 
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(ProgramMeasurer, ObjectRef, ProgramMeasurerNode);
 };
@@ -28,10 +28,16 @@
 #include <tvm/auto_scheduler/measure.h>
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <utility>
 
 namespace tvm {
+
+namespace runtime {
+class MappedFile;
+}  // namespace runtime
+
 namespace auto_scheduler {
 
 /*! \brief Callback for logging the input and results of measurements to file */
@@ -130,6 +136,70 @@ void WriteMeasureRecords(std::ostream* os, const Array<MeasureInput>& inputs,
 void ReadMeasureRecord(const std::string& str, MeasureInputNode* inp, MeasureResultNode* res,
                        std::string* log_version);
 
+/*!
+ * \brief Convert a json log file to the indexed binary format read by IndexedRecordReader.
+ * The records are grouped by workload key and sorted by their mean cost in the index, the
+ * failed measurements last. The records themselves are kept as json lines.
+ * \param json_filename The name of the json log file.
+ * \param indexed_filename The name of the indexed file to write.
+ */
+void ConvertRecordsToIndexed(const std::string& json_filename,
+                             const std::string& indexed_filename);
+
+/*!
+ * \brief Check whether a file is in the indexed binary format.
+ * \param filename The name of the file.
+ */
+bool IsIndexedRecordFile(const std::string& filename);
+
+/*!
+ * \brief Log reader of the indexed binary format. The file is memory-mapped and the records of a
+ * workload are looked up in its index, so only the records that are returned are parsed.
+ */
+class IndexedRecordReaderNode : public Object {
+ public:
+  /*! \brief The name of input file. */
+  String filename;
+
+  /*!
+   * \brief Read the best records of a workload.
+   * \param workload_key The workload key.
+   * \param k The maximum number of records. -1 means all the successful records.
+   * \param target_kind Only read the records of this target kind, empty for all targets.
+   * \return The MeasureInputs and MeasureResults of the successful measurements, from the
+   * lowest mean cost.
+   */
+  std::pair<Array<MeasureInput>, Array<MeasureResult>> ReadTopK(
+      const std::string& workload_key, int k, const std::string& target_kind = "") const;
+
+  /*! \brief Get the workload keys in the file. */
+  Array<String> WorkloadKeys() const;
+
+  static constexpr const char* _type_key = "auto_scheduler.IndexedRecordReader";
+  TVM_DECLARE_FINAL_OBJECT_INFO(IndexedRecordReaderNode, Object);
+
+ private:
+  /*! \brief The mapped file. */
+  std::shared_ptr<runtime::MappedFile> file_;
+
+  friend class IndexedRecordReader;
+};
+
+/*!
+ * \brief Managed reference to IndexedRecordReaderNode.
+ * \sa IndexedRecordReaderNode
+ */
+class IndexedRecordReader : public ObjectRef {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param filename The name of input file
+   */
+  explicit IndexedRecordReader(String filename);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(IndexedRecordReader, ObjectRef, IndexedRecordReaderNode);
+};
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
@@ -62,16 +62,17 @@
 #ifndef TVM_AUTO_SCHEDULER_SEARCH_POLICY_H_
 #define TVM_AUTO_SCHEDULER_SEARCH_POLICY_H_
 
+#include <tvm/auto_scheduler/measure.h>
 #include <tvm/auto_scheduler/search_task.h>
 #include <tvm/node/node.h>
 
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace tvm {
 namespace auto_scheduler {
 
-class ProgramMeasurer;
 class SearchPolicyNode;
 
 /*!
@@ -138,6 +139,11 @@ struct SearchPolicyKey {
   /*! \brief The specified iterators are indices of const tensors in "fake reduction". */
   static constexpr const char* simplify_const_tensor_indices =
       "auto_scheduler_simplify_const_tensor_indices";
+  /*!
+   * \brief The name of a global function that returns a te.TensorIntrin. The stage is split and
+   * tensorized with it when its body matches the intrinsic.
+   */
+  static constexpr const char* tensorize_intrin = "auto_scheduler_tensorize_intrin";
 };
 
 /*!
@@ -170,6 +176,16 @@ class SearchPolicyNode : public Object {
   virtual State Search(int num_measure_trials, int early_stopping, int num_measures_per_round,
                        ProgramMeasurer measurer) = 0;
 
+  /*!
+   * \brief Continue the search with one more search round. This lets a task scheduler interleave
+   * the search of several tasks that share one measurer.
+   * \param num_measure The number of programs to be measured in this round.
+   * \param measurer A ProgramMeasurer to build and measure programs.
+   * \return The measured inputs and their results. Empty if no new candidate was found.
+   */
+  virtual std::pair<Array<MeasureInput>, Array<MeasureResult>> ContinueSearchOneRound(
+      int num_measure, ProgramMeasurer measurer) = 0;
+
   /*!
    * \brief Preload measured states from a log file to resume the state of the search policy.
    * \param log_file The name of the record log file.
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/auto_scheduler/task_scheduler.h
+ * \brief The task scheduler that allocates the measurement trials among several search tasks.
+ *
+ * A network is usually partitioned into many search tasks with very different contributions to
+ * the end-to-end latency. Instead of tuning them one after another, the scheduler runs one search
+ * round at a time and always picks the task whose next round is expected to reduce the weighted
+ * total latency the most. The expectation is the gradient of the objective estimated from the
+ * latency history of each task. All tasks share one ProgramMeasurer, and their search policies may
+ * share one cost model.
+ */
+
+#ifndef TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
+#define TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
+
+#include <tvm/auto_scheduler/auto_schedule.h>
+#include <tvm/auto_scheduler/search_policy.h>
+
+#include <random>
+#include <vector>
+
+namespace tvm {
+namespace auto_scheduler {
+
+/*! \brief The gradient based task scheduler. */
+class TaskSchedulerNode : public Object {
+ public:
+  /*! \brief The search tasks. */
+  Array<SearchTask> tasks;
+  /*! \brief The search policy of each task. */
+  Array<SearchPolicy> search_policies;
+  /*! \brief The weight of each task in the objective, usually the number of its occurrences. */
+  Array<FloatImm> task_weights;
+  /*! \brief The best latency of each task in seconds, updated during the tuning. */
+  Array<FloatImm> best_costs;
+  /*! \brief The number of search rounds already spent on each task. */
+  Array<Integer> task_cts;
+  /*! \brief The weight of the backward gradient against the forward gradient. */
+  double alpha;
+  /*! \brief The number of search rounds used to compute the backward gradient. */
+  int backward_window_size;
+  /*! \brief The probability to pick a random task instead of the one with the best gradient. */
+  double eps_random;
+  /*! \brief Verbosity level. 0 for silent, 1 to output information during the tuning. */
+  int verbose;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("tasks", &tasks);
+    v->Visit("search_policies", &search_policies);
+    v->Visit("task_weights", &task_weights);
+    v->Visit("best_costs", &best_costs);
+    v->Visit("task_cts", &task_cts);
+    v->Visit("alpha", &alpha);
+    v->Visit("backward_window_size", &backward_window_size);
+    v->Visit("eps_random", &eps_random);
+    v->Visit("verbose", &verbose);
+  }
+
+  /*!
+   * \brief Tune all the tasks.
+   * \param tuning_options The tuning options. `num_measure_trials` is the total number of trials
+   * of all tasks, `early_stopping` applies to every task separately.
+   */
+  void Tune(const TuningOptions& tuning_options);
+
+  /*! \brief The random generator for the eps-greedy task selection. */
+  std::mt19937 rand_gen;
+
+  static constexpr const char* _type_key = "auto_scheduler.TaskScheduler";
+  TVM_DECLARE_FINAL_OBJECT_INFO(TaskSchedulerNode, Object);
+
+ private:
+  /*!
+   * \brief Run one search round of a task and update its latency history.
+   * \param task_id The index of the task.
+   * \param num_measure The number of programs to measure.
+   * \param measurer The shared measurer.
+   * \return The number of measured programs.
+   */
+  int TuneTaskOneRound(int task_id, int num_measure, const ProgramMeasurer& measurer);
+
+  /*! \return The index of the task to tune in the next round, -1 if all tasks are done. */
+  int PickNextTask();
+
+  /*! \brief The best latency of each task after each of its search rounds. */
+  std::vector<std::vector<double>> cost_histories_;
+  /*! \brief Whether a task stopped early or ran out of candidates. */
+  std::vector<bool> dead_tasks_;
+  /*! \brief The number of measured programs of each task. */
+  std::vector<int> measure_cts_;
+  /*! \brief The number of measured programs of each task when its best latency was found. */
+  std::vector<int> best_measure_cts_;
+  /*! \brief The early stopping setting of the current tuning, applied to every task. */
+  int early_stopping_;
+};
+
+/*!
+ * \brief Managed reference to TaskSchedulerNode.
+ * \sa TaskSchedulerNode
+ */
+class TaskScheduler : public ObjectRef {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param tasks The search tasks.
+   * \param search_policies The search policy of each task.
+   * \param task_weights The weight of each task in the objective. Every task weights 1 if empty.
+   * \param alpha The weight of the backward gradient against the forward gradient.
+   * \param backward_window_size The number of search rounds used to compute the backward
+   * gradient.
+   * \param eps_random The probability to pick a random task.
+   * \param seed The random seed of the task selection.
+   * \param verbose Verbosity level. 0 for silent, 1 to output information during the tuning.
+   */
+  TaskScheduler(Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                Array<FloatImm> task_weights, double alpha, int backward_window_size,
+                double eps_random, int seed, int verbose);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(TaskScheduler, ObjectRef, TaskSchedulerNode);
+};
+
+}  // namespace auto_scheduler
+}  // namespace tvm
+
+#endif  // TVM_AUTO_SCHEDULER_TASK_SCHEDULER_H_
@@ -77,6 +77,52 @@ class PassInfo;
 using TraceFunc =
     runtime::TypedPackedFunc<void(const IRModule& ir_module, const PassInfo& ctx, bool is_before)>;
 
+/*!
+ * \brief Measurements of a single pass invocation, recorded when the
+ *  "ir.profile_passes" config of the PassContext is set.
+ * \sa PassProfile
+ */
+class PassProfileNode : public Object {
+ public:
+  /*! \brief The name of the pass. */
+  String name;
+  /*! \brief The nesting depth of the pass, 0 for a pass invoked directly. */
+  int depth{0};
+  /*! \brief Wall time of the pass including the passes nested in it, in milliseconds. */
+  double time_ms{0};
+  /*! \brief Wall time of the pass excluding the passes nested in it, in milliseconds. */
+  double self_time_ms{0};
+  /*! \brief Number of IR nodes reachable from the module before the pass. */
+  int64_t nodes_before{0};
+  /*! \brief Number of IR nodes reachable from the module after the pass. */
+  int64_t nodes_after{0};
+  /*! \brief Change of the resident set size of the process, in kilobytes. */
+  int64_t rss_delta_kb{0};
+
+  void VisitAttrs(AttrVisitor* v) {
+    v->Visit("name", &name);
+    v->Visit("depth", &depth);
+    v->Visit("time_ms", &time_ms);
+    v->Visit("self_time_ms", &self_time_ms);
+    v->Visit("nodes_before", &nodes_before);
+    v->Visit("nodes_after", &nodes_after);
+    v->Visit("rss_delta_kb", &rss_delta_kb);
+  }
+
+  static constexpr const char* _type_key = "transform.PassProfile";
+  static constexpr bool _type_has_method_sequal_reduce = false;
+  TVM_DECLARE_FINAL_OBJECT_INFO(PassProfileNode, Object);
+};
+
+/*!
+ * \brief Managed reference class for PassProfileNode
+ * \sa PassProfileNode
+ */
+class PassProfile : public ObjectRef {
+ public:
+  TVM_DEFINE_OBJECT_REF_METHODS(PassProfile, ObjectRef, PassProfileNode);
+};
+
 /*!
  * \brief PassContextNode contains the information that a pass can rely on,
  * such as analysis results.
@@ -102,6 +148,12 @@ class PassContextNode : public Object {
   /*! \brief Pass specific configurations. */
   Map<String, ObjectRef> config;
 
+  /*!
+   * \brief Profiles of the passes run in this context, in the order they finished.
+   *  Only recorded when the "ir.profile_passes" config is set.
+   */
+  mutable Array<PassProfile> pass_profiles;
+
   PassContextNode() = default;
 
   /*!
@@ -139,6 +191,7 @@ class PassContextNode : public Object {
     v->Visit("required_pass", &required_pass);
     v->Visit("disabled_pass", &disabled_pass);
     v->Visit("config", &config);
+    v->Visit("pass_profiles", &pass_profiles);
   }
 
   static constexpr const char* _type_key = "transform.PassContext";
@@ -199,6 +252,25 @@ class PassContext : public ObjectRef {
    */
   TVM_DLL void Trace(const IRModule& module, const PassInfo& info, bool is_before) const;
 
+  /*!
+   * \brief Record the profile of a pass when "ir.profile_passes" is set.
+   *
+   *  Trace calls this for every pass. Passes that do not trace themselves,
+   *  such as Sequential, call it directly so nested passes are attributed
+   *  to their parent.
+   *
+   * \param module The IRModule the pass runs on.
+   * \param info The pass information.
+   * \param is_before Indicated whether the pass is about to start or has finished.
+   */
+  TVM_DLL void Profile(const IRModule& module, const PassInfo& info, bool is_before) const;
+
+  /*!
+   * \brief Summarize the recorded pass profiles.
+   * \return A table of the passes ranked by their self time.
+   */
+  TVM_DLL String ProfileReport() const;
+
   /*!
    * \brief Register a valid configuration option and its ValueType for validation.
    *
@@ -136,6 +136,14 @@ class MapNode : public Object {
    * \return The object created
    */
   static ObjectPtr<MapNode> Empty() { return make_object<MapNode>(); }
+  /*!
+   * \brief The empty container shared by all default-constructed Maps
+   * \return The object shared
+   */
+  static ObjectPtr<MapNode> SharedEmpty() {
+    static ObjectPtr<MapNode>* inst = new ObjectPtr<MapNode>(Empty());
+    return *inst;
+  }
 
  protected:
   /*!
@@ -293,6 +301,12 @@ class MapNode : public Object {
    * \return The object created
    */
   static inline ObjectPtr<MapNode> Empty();
+  /*!
+   * \brief The empty container shared by all default-constructed Maps.
+   *  It has no slots, so the first insertion always switches to a new container.
+   * \return The object shared
+   */
+  static inline ObjectPtr<MapNode> SharedEmpty();
 
  protected:
   /*!
@@ -1184,6 +1198,12 @@ inline void MapNode::erase(const MapNode::iterator& position) {
 
 inline ObjectPtr<MapNode> MapNode::Empty() { return SmallMapNode::Empty(); }
 
+inline ObjectPtr<MapNode> MapNode::SharedEmpty() {
+  // intentionally leaked to stay valid during static destruction
+  static ObjectPtr<MapNode>* inst = new ObjectPtr<MapNode>(SmallMapNode::Empty(0));
+  return *inst;
+}
+
 inline ObjectPtr<MapNode> MapNode::CopyFrom(MapNode* from) {
   if (from->slots_ <= SmallMapNode::kMaxSize) {
     return SmallMapNode::CopyFrom(static_cast<SmallMapNode*>(from));
@@ -1258,7 +1278,7 @@ class Map : public ObjectRef {
   /*!
    * \brief default constructor
    */
-  Map() { data_ = MapNode::Empty(); }
+  Map() { data_ = MapNode::SharedEmpty(); }
   /*!
    * \brief move constructor
    * \param other source
@@ -1371,7 +1391,8 @@ class Map : public ObjectRef {
     if (data_.get() == nullptr) {
       data_ = MapNode::Empty();
     } else if (!data_.unique()) {
-      data_ = MapNode::CopyFrom(GetMapNode());
+      MapNode* from = GetMapNode();
+      data_ = from->size() == 0 ? MapNode::Empty() : MapNode::CopyFrom(from);
     }
     return GetMapNode();
   }
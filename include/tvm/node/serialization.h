@@ -27,7 +27,9 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/object.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace tvm {
 /*!
@@ -47,5 +49,71 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief Load the nodes of a graph saved by SaveJSON on demand.
+ *
+ *  Only the structure of the graph is parsed when the loader is constructed.
+ *  A node, together with the nodes and tensors it depends on, is created the
+ *  first time it is requested, so the tensors of the nodes that are never
+ *  requested are never decoded. Nodes are identified by their index in the
+ *  saved graph. The loader is not thread safe.
+ */
+class TVM_DLL LazyJSONLoader {
+ public:
+  /*!
+   * \brief Parse the structure of a graph saved by SaveJSON.
+   * \param json_str The json string to load from.
+   */
+  explicit LazyJSONLoader(const std::string& json_str);
+  ~LazyJSONLoader();
+  /*! \return The index of the root node. */
+  size_t root() const;
+  /*!
+   * \param node The index of the node.
+   * \return The type key of the node, empty for None.
+   */
+  const std::string& TypeKey(size_t node) const;
+  /*!
+   * \param node The index of the node.
+   * \return The keys of a Map with string keys, empty for any other node.
+   */
+  const std::vector<std::string>& Keys(size_t node) const;
+  /*!
+   * \param node The index of the node.
+   * \return The indices of the elements of an Array, of the values of a Map
+   *  with string keys, or of the alternating keys and values of any other Map.
+   */
+  const std::vector<size_t>& Children(size_t node) const;
+  /*!
+   * \brief Get a node, creating it when it is first requested.
+   * \param node The index of the node.
+   * \return The node.
+   */
+  runtime::ObjectRef Get(size_t node);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/*!
+ * \brief save the node as well as all the node it depends on in a compact
+ *  binary format, with interned strings and raw tensor data.
+ *  It is much faster to save and load than json, but can only be loaded by a
+ *  version of TVM whose objects have the same fields.
+ *
+ * \param node The node to save.
+ * \return the binary representation of the node.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load tvm Node object saved by SaveBinary.
+ * \param bytes The binary representation of the node.
+ *
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& bytes);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
@@ -26,9 +26,11 @@
 #include <tvm/node/container.h>
 #include <tvm/node/functor.h>
 #include <tvm/runtime/data_type.h>
+#include <tvm/support/with.h>
 
 #include <functional>
 #include <string>
+#include <unordered_map>
 
 namespace tvm {
 
@@ -84,6 +86,77 @@ class StructuralHash : public BaseValueHash {
   TVM_DLL size_t operator()(const ObjectRef& key) const;
 };
 
+/*!
+ * \brief Memo table of structural hash values.
+ *
+ *  While a memo is in scope, StructuralHash of an object that was already
+ *  hashed within the scope returns the recorded value in O(1) instead of
+ *  revisiting the whole DAG. This is meant for passes that repeatedly use
+ *  the same large expressions as hash-map keys.
+ *
+ *  Only root-level results are recorded: the hash of a graph node depends on
+ *  the order it is visited in, so a sub-tree hash can not be reused inside
+ *  a different parent. The table holds a reference to each hashed object,
+ *  so copy-on-write keeps the recorded objects unchanged. Types that are
+ *  mutated in place (IRModule, te.Schedule, te.Stage) are never recorded.
+ */
+class StructuralHashMemoNode : public Object {
+ public:
+  /*!
+   * \brief Compute the hash of key, reusing the recorded value if present.
+   * \param key The object to be hashed.
+   * \param map_free_vars Whether to map free variables by their occurence number.
+   * \return The hash value.
+   */
+  TVM_DLL size_t Hash(const ObjectRef& key, bool map_free_vars) const;
+
+  static constexpr const char* _type_key = "StructuralHashMemo";
+  TVM_DECLARE_FINAL_OBJECT_INFO(StructuralHashMemoNode, Object);
+
+ private:
+  /*! \brief The recorded hash values, indexed by map_free_vars. */
+  mutable std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual> table_[2];
+};
+
+/*!
+ * \brief Managed reference to StructuralHashMemoNode.
+ *
+ * \code
+ *
+ *  {
+ *    With<StructuralHashMemo> memo;
+ *    // repeated StructuralHash of the same objects are O(1) here.
+ *  }
+ *
+ * \endcode
+ * \sa StructuralHashMemoNode
+ */
+class StructuralHashMemo : public ObjectRef {
+ public:
+  /*! \brief Construct an empty memo table. */
+  TVM_DLL StructuralHashMemo();
+  explicit StructuralHashMemo(ObjectPtr<Object> n) : ObjectRef(n) {}
+  /*! \return The innermost memo in scope on this thread, if any. */
+  TVM_DLL static Optional<StructuralHashMemo> Current();
+
+  const StructuralHashMemoNode* operator->() const {
+    return static_cast<const StructuralHashMemoNode*>(get());
+  }
+  using ContainerType = StructuralHashMemoNode;
+
+  // Internal entry points for the FFI.
+  class Internal;
+
+ private:
+  // enable with syntax.
+  friend class Internal;
+  friend class With<StructuralHashMemo>;
+  /*! \brief Push the memo to the thread-local scope stack. */
+  TVM_DLL void EnterWithScope();
+  /*! \brief Pop the memo from the thread-local scope stack. */
+  TVM_DLL void ExitWithScope();
+};
+
 /*!
  * \brief A Reducer class to reduce the structural hash value.
  *
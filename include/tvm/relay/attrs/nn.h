@@ -931,6 +931,44 @@ struct DenseAttrs : public tvm::AttrsNode<DenseAttrs> {
   }
 };
 
+/*! \brief Attributes for dense_pack operator */
+struct DensePackAttrs : public tvm::AttrsNode<DensePackAttrs> {
+  IndexExpr units;
+  DataType out_dtype;
+  std::string weight_layout;
+
+  TVM_DECLARE_ATTRS(DensePackAttrs, "relay.attrs.DensePackAttrs") {
+    TVM_ATTR_FIELD(units).describe("Number of hidden units of the dense transformation.");
+
+    // use 0 bits to indicate none.
+    TVM_ATTR_FIELD(out_dtype)
+        .set_default(NullValue<DataType>())
+        .describe("Output data type, set to explicit type under mixed precision setting");
+    TVM_ATTR_FIELD(weight_layout)
+        .set_default("NK")
+        .describe("Dimension ordering of weight. Packed layouts, such as NK8n, are possible.");
+  }
+};
+
+/*! \brief Attributes for dense operator fused with a bias add and an activation */
+struct DenseBiasActAttrs : public tvm::AttrsNode<DenseBiasActAttrs> {
+  IndexExpr units;
+  DataType out_dtype;
+  std::string activation;
+
+  TVM_DECLARE_ATTRS(DenseBiasActAttrs, "relay.attrs.DenseBiasActAttrs") {
+    TVM_ATTR_FIELD(units).describe("Number of hidden units of the dense transformation.");
+
+    // use 0 bits to indicate none.
+    TVM_ATTR_FIELD(out_dtype)
+        .set_default(NullValue<DataType>())
+        .describe("Output data type, set to explicit type under mixed precision setting");
+    TVM_ATTR_FIELD(activation)
+        .set_default("none")
+        .describe("Activation applied after the bias add, one of none, relu and gelu.");
+  }
+};
+
 /*! \brief Attributes for sparse_dense operator */
 struct SparseDenseAttrs : public tvm::AttrsNode<SparseDenseAttrs> {
   TVM_DECLARE_ATTRS(SparseDenseAttrs, "relay.attrs.SparseDenseAttrs") {}
@@ -941,6 +979,22 @@ struct SparseTransposeAttrs : public tvm::AttrsNode<SparseTransposeAttrs> {
   TVM_DECLARE_ATTRS(SparseTransposeAttrs, "relay.attrs.SparseTransposeAttrs") {}
 };
 
+/*! \brief Attributes for multi_adam_update operator */
+struct MultiAdamUpdateAttrs : public tvm::AttrsNode<MultiAdamUpdateAttrs> {
+  double beta1;
+  double beta2;
+  double epsilon;
+
+  TVM_DECLARE_ATTRS(MultiAdamUpdateAttrs, "relay.attrs.MultiAdamUpdateAttrs") {
+    TVM_ATTR_FIELD(beta1).set_default(0.9).describe(
+        "Decay rate of the moving average of the gradients.");
+    TVM_ATTR_FIELD(beta2).set_default(0.999).describe(
+        "Decay rate of the moving average of the squared gradients.");
+    TVM_ATTR_FIELD(epsilon).set_default(1e-8).describe(
+        "Added to the square root of the second moment to avoid dividing by zero.");
+  }
+};
+
 /*! \brief Attributes for FIFO buffer operator */
 struct FIFOBufferAttrs : public tvm::AttrsNode<FIFOBufferAttrs> {
   int axis;
@@ -106,6 +106,33 @@ TVM_DLL Pass FoldConstant();
  */
 TVM_DLL Pass FuseOps(int fuse_opt_level = -1);
 
+/*!
+ * \brief Reorder the calls of dataflow functions to lower their peak memory.
+ *
+ * Among the calls whose inputs are ready, the one that grows the live bytes
+ * least is run first. The order is made explicit with a chain of lets, so the
+ * graph memory planner follows it. A function is left unchanged when the new
+ * order does not lower its estimated peak.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass ReorderForPeakMemory();
+
+/*!
+ * \brief Recompute cheap activations instead of keeping them alive.
+ *
+ * While the estimated peak memory of a function exceeds the budget, the
+ * largest value alive at the peak that one injective call can recompute is
+ * recomputed right before its first use after the peak. This trades compute
+ * for memory in training graphs, whose backward part reads the activations
+ * of the forward part.
+ *
+ * \param memory_budget The budget in bytes, recompute as much as possible when it is 0.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass Rematerialize(int64_t memory_budget = 0);
+
 /*!
  * \brief Rewrite the annotated program.
  *
@@ -116,6 +143,23 @@ TVM_DLL Pass FuseOps(int fuse_opt_level = -1);
  */
 TVM_DLL Pass RewriteAnnotatedOps(int fallback_device);
 
+/*!
+ * \brief Annotate the operators with the devices minimizing the estimated latency.
+ *
+ * The operators already annotated with on_device stay on their device. The
+ * annotations are consumed by RewriteAnnotatedOps, which inserts the copies.
+ *
+ * \param device_types The candidate device types.
+ * \param op_cost The cost of an operator on a device, (Call, int) -> double,
+ *        negative when the device does not support the operator.
+ * \param transfer_cost The cost of a copy, (int64 bytes, int src, int dst) -> double.
+ * \param fallback_device The device preferred when the costs are equal.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass AutoDevicePlacement(Array<Integer> device_types, runtime::PackedFunc op_cost,
+                                 runtime::PackedFunc transfer_cost, int fallback_device);
+
 /*!
  * \brief Turn an expression to Basic Block Normal Form.
  *
@@ -208,6 +252,33 @@ TVM_DLL Pass SimplifyInference();
  */
 TVM_DLL Pass FastMath();
 
+/*!
+ * \brief Run the float32 parts of the program in float16 or bfloat16.
+ *
+ * Compute bound operators (allow list) take their inputs and produce their output in
+ * the mixed type. Cheap operators (follow list) stay in the mixed type when one of their
+ * inputs is, and operators that need float32 range or accumulation such as softmax and
+ * reductions (deny list) get their inputs cast back to float32. Injective operators
+ * follow and other operators are denied unless a list says otherwise. The redundant
+ * casts are folded as in CanonicalizeCast.
+ *
+ * On CPUs, bfloat16 kernels are lowered by the BF16Legalize TIR pass, which keeps the
+ * tensors in bfloat16 and computes in float32.
+ *
+ * \param mixed_precision_type The mixed type, float16 or bfloat16.
+ * \param allow_ops The operators added to the allow list.
+ * \param follow_ops The operators added to the follow list.
+ * \param deny_ops The operators added to the deny list.
+ * \param accumulation_type The out_dtype of the convolutions, dense and batch_matmul,
+ *  float32 or the mixed type. Their result is cast to the mixed type.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass ToMixedPrecision(DataType mixed_precision_type = DataType::Float(16),
+                              Array<String> allow_ops = {}, Array<String> follow_ops = {},
+                              Array<String> deny_ops = {},
+                              DataType accumulation_type = DataType::Float(32));
+
 /*!
  * \brief Infer the type of an expression.
  *
@@ -215,6 +286,10 @@ TVM_DLL Pass FastMath();
  * type information filled in, as well as it's checked type field
  * populated with the result type.
  *
+ * Functions that are fully typed since an earlier inference are kept as is,
+ * unless the type of a global function they call changes. Set the
+ * "relay.incremental_type_infer" config to false to check every function.
+ *
  * \return The pass.
  */
 TVM_DLL Pass InferType();
@@ -230,10 +305,19 @@ TVM_DLL Pass InferType();
  */
 TVM_DLL Pass EliminateCommonSubexpr(runtime::PackedFunc fskip = nullptr);
 
+/*!
+ * \brief Merge the constants which hold identical tensors, so that a tensor shared
+ * by several parts of a model is stored once.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass DeduplicateConstants();
+
 /*!
  * \brief Combine parallel 2d convolutions into a single convolution if the
  * number of branches of this conv2d operator is not less than
- * `min_num_branch`.
+ * `min_num_branch`. Branches may differ in their output channels, and in their
+ * kernel sizes when the windows are centered the same way.
  *
  * \param min_num_branches The minimun number of branches.
  *
@@ -325,6 +409,24 @@ TVM_DLL Pass AlterOpLayout();
  */
 TVM_DLL Pass ConvertLayout(const Map<String, Array<String>>& desired_layouts);
 
+/*!
+ * \brief Choose the layouts of all the calls together, instead of op by op.
+ *
+ * Every call to an op with candidates either keeps its layouts or is converted to one of the
+ * candidates, the way ConvertLayout converts it. The assignment is chosen by dynamic programming
+ * over the dataflow graph to minimize the cost of the ops plus the cost of the layout transforms
+ * between them, which avoids transforming back and forth between neighbouring ops.
+ *
+ * \param candidates Specify mapping of op_name to an array of candidate desired layouts,
+ *                   each in the format taken by ConvertLayout.
+ * \param op_cost Optional function (call, desired_layouts) -> cost of the call in those
+ *                layouts, desired_layouts is empty for the original layouts. Zero if not given.
+ * \param transform_cost The cost of a layout transform per byte of the transformed tensor.
+ * \return The pass.
+ */
+TVM_DLL Pass PlanLayout(const Map<String, Array<Array<String>>>& candidates,
+                        runtime::PackedFunc op_cost, double transform_cost);
+
 /*!
  * \brief Legalizes an expr with another expression.
  * \param legalize_map_attr_name The Op's attr name which corresponds to the legalize rule function.
@@ -340,6 +442,8 @@ TVM_DLL Pass Legalize(const String& legalize_map_attr_name = "FTVMLegalize");
 /*!
  * \brief Canonicalize cast expressions to make operator fusion more efficient.
  *
+ * Casts back to the source type of a lossless upcast are folded away.
+ *
  * \return The pass.
  */
 TVM_DLL Pass CanonicalizeCast();
@@ -393,6 +497,23 @@ TVM_DLL Pass RemoveUnusedFunctions(Array<runtime::String> entry_functions);
  */
 TVM_DLL Pass SimplifyExpr();
 
+/*!
+ * \brief Fuse 2D dense with the bias add and relu or gelu that follow it into
+ * nn.contrib_dense_bias_act, for libraries that apply them in the GEMM epilogue.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass FuseDenseEpilogue();
+
+/*!
+ * \brief Fuse the SGD and Adam updates of the parameters of a training step into
+ * nn.multi_sgd_update and nn.multi_adam_update, which update all the parameters
+ * sharing a learning rate in one kernel. Expects the graph normal form.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass FuseOptimizerUpdates();
+
 }  // namespace transform
 
 /*!
@@ -462,6 +583,21 @@ TVM_DLL Expr ForwardRewrite(const Expr& expr, const FForwardRewrite& rewrite_fun
  */
 TVM_DLL Expr RewriteAnnotatedOps(const Expr& expr, int fallback_device);
 
+/*!
+ * \brief Annotate the operators with the devices minimizing the estimated latency.
+ *
+ * \param expr The expression, in graph normal form.
+ * \param device_types The candidate device types.
+ * \param op_cost The cost of an operator on a device, negative when unsupported.
+ * \param transfer_cost The cost of copying a number of bytes between two devices.
+ * \param fallback_device The device preferred when the costs are equal.
+ *
+ * \return The annotated expression.
+ */
+TVM_DLL Expr AutoDevicePlacement(const Expr& expr, const Array<Integer>& device_types,
+                                 const runtime::PackedFunc& op_cost,
+                                 const runtime::PackedFunc& transfer_cost, int fallback_device);
+
 /*!
  * \brief Turn an expression into continuation passing style(CPS).
  *
@@ -127,6 +127,11 @@ typedef int (*FTVMParallelLambda)(int task_id, TVMParallelGroupEnv* penv, void*
  * \param num_task Number of tasks to launch, can be 0, means launch
  *           with all available threads.
  *
+ * \note The function can be called from inside a running parallel task,
+ *       the nested job then runs on the calling thread and the workers
+ *       that are idle at the time of the call. Nested jobs cannot use
+ *       TVMBackendParallelBarrier.
+ *
  * \return 0 when no error is thrown, -1 when failure happens
  */
 TVM_DLL int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task);
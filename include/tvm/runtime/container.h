@@ -525,6 +525,16 @@ class ArrayNode : public Object, public InplaceArrayBase<ArrayNode, ObjectRef> {
   /*! \brief Expansion factor of the Array */
   static constexpr int64_t kIncFactor = 2;
 
+  /*!
+   * \brief The empty ArrayNode shared by all default-constructed Arrays.
+   *  It has no capacity, so the first mutation always switches to a new container.
+   */
+  static ObjectPtr<ArrayNode> SharedEmpty() {
+    // intentionally leaked to stay valid during static destruction
+    static ObjectPtr<ArrayNode>* inst = new ObjectPtr<ArrayNode>(Empty(0));
+    return *inst;
+  }
+
   // CRTP parent class
   friend InplaceArrayBase<ArrayNode, ObjectRef>;
 
@@ -562,7 +572,7 @@ class Array : public ObjectRef {
   /*!
    * \brief default constructor
    */
-  Array() { data_ = ArrayNode::Empty(); }
+  Array() { data_ = ArrayNode::SharedEmpty(); }
 
   /*!
    * \brief move constructor
@@ -967,7 +977,7 @@ class Array : public ObjectRef {
    */
   ArrayNode* CopyOnWrite(int64_t reserve_extra) {
     ArrayNode* p = GetArrayNode();
-    if (p == nullptr) {
+    if (p == nullptr || p->capacity_ == 0) {
       // necessary to get around the constexpr address issue before c++17
       const int64_t kInitSize = ArrayNode::kInitSize;
       return SwitchContainer(std::max(kInitSize, reserve_extra));
@@ -1086,6 +1096,23 @@ class ADT : public ObjectRef {
     data_ = std::move(ptr);
   }
 
+  /*!
+   * \brief construct an ADT object reference with an object allocator.
+   * \param alloc The allocator of the ADT object.
+   * \param tag The tag of the ADT object.
+   * \param begin The begin iterator to the start of the fields array.
+   * \param end The end iterator to the end of the fields array.
+   * \return The constructed ADT object reference.
+   */
+  template <typename Derived, typename Iterator>
+  ADT(ObjAllocatorBase<Derived>* alloc, int32_t tag, Iterator begin, Iterator end) {
+    size_t num_elems = std::distance(begin, end);
+    auto ptr = alloc->template make_inplace_array<ADTObj, ObjectRef>(num_elems);
+    ptr->tag = tag;
+    ptr->Init(begin, end);
+    data_ = std::move(ptr);
+  }
+
   /*!
    * \brief construct an ADT object reference.
    * \param tag The tag of the ADT object.
@@ -42,16 +42,28 @@ typedef struct TVMOpParam {
   uint32_t flatten_data;
 } TVMOpParam;
 
+#ifndef TVM_CRT_GRAPH_ARENA_ALIGNMENT
+/*!
+ * \brief Alignment of the tensor arena, of each storage id placed in it, and of the tensors
+ *  bound with the zero-copy functions; generated operators assume it.
+ */
+#define TVM_CRT_GRAPH_ARENA_ALIGNMENT 64
+#endif
+
 // Graph attribute
 typedef struct TVMGraphRuntimeGraphAttr {
   uint32_t storage_num_not_alloctaed;
   uint32_t* storage_id;
   uint32_t* device_index;
   char* dltype;  // "int8", "int16", "float32"
+  DLDataType* dltype_value;  // decoded dtypes, set instead of dltype by the binary loader
   uint32_t dltype_count;
   int64_t* shape;
   uint32_t* ndim;
   uint32_t shape_count;
+  uint32_t* storage_offset;  // arena offset of each storage id, planned offline
+  uint32_t storage_offset_count;
+  uint32_t arena_bytes;
 } TVMGraphRuntimeGraphAttr;
 
 typedef struct TVMGraphRuntime TVMGraphRuntime;
@@ -67,6 +79,42 @@ typedef struct TVMGraphRuntime TVMGraphRuntime;
 TVMGraphRuntime* TVMGraphRuntime_Create(const char* sym_json, const struct TVMModule* m,
                                         const TVMContext* ctxs);
 
+/*!
+ * \brief Allocate a new GraphRuntime whose intermediate tensors live in a caller-owned arena.
+ *
+ * Each storage id is placed at the offset recorded in the graph's "storage_offset" attribute
+ * (emitted when building with "relay.backend.static_arena"); graphs without a plan are laid
+ * out back to back. The arena must outlive the runtime and be
+ * TVM_CRT_GRAPH_ARENA_ALIGNMENT-byte aligned.
+ *
+ * \param sym_json JSON-encoded graph.
+ * \param m TVM Module that exposes the functions to call.
+ * \param ctxs runtime execution context.
+ * \param arena Base of the tensor arena.
+ * \param arena_size Size of the arena in bytes; at least the graph's "arena_bytes".
+ */
+TVMGraphRuntime* TVMGraphRuntime_CreateWithArena(const char* sym_json, const struct TVMModule* m,
+                                                 const TVMContext* ctxs, void* arena,
+                                                 uint32_t arena_size);
+
+/*!
+ * \brief Allocate a new GraphRuntime from a graph in the binary graph format.
+ *
+ * Every read of the graph is checked against blob_size.
+ *
+ * \param blob The graph in the binary graph format.
+ * \param blob_size Size of the graph in bytes.
+ * \param m TVM Module that exposes the functions to call.
+ * \param ctxs runtime execution context.
+ * \param arena Base of the tensor arena, as in TVMGraphRuntime_CreateWithArena, or NULL to
+ *  allocate the intermediate tensors with vmalloc.
+ * \param arena_size Size of the arena in bytes.
+ */
+TVMGraphRuntime* TVMGraphRuntime_CreateFromBinary(const char* blob, uint32_t blob_size,
+                                                  const struct TVMModule* m,
+                                                  const TVMContext* ctxs, void* arena,
+                                                  uint32_t arena_size);
+
 int TVMGraphRuntime_GetInputIndex(TVMGraphRuntime* runtime, const char* name);
 
 /*!
@@ -77,6 +125,34 @@ int TVMGraphRuntime_GetInputIndex(TVMGraphRuntime* runtime, const char* name);
  */
 void TVMGraphRuntime_SetInput(TVMGraphRuntime* runtime, const char* name, DLTensor* data_in);
 
+/*!
+ * \brief Bind an input of the graph to caller-owned memory instead of copying it.
+ *
+ * The tensor must match the input's shape, dtype and context, be compact and be
+ * TVM_CRT_GRAPH_ARENA_ALIGNMENT-byte aligned. It stays bound until the input is set again.
+ *
+ * \param runtime The graph runtime.
+ * \param name The name of the input.
+ * \param data_ref The caller-owned tensor, which must outlive every run that reads it.
+ * \return 0 on success, -1 if the tensor does not match the input.
+ */
+int TVMGraphRuntime_SetInputZeroCopy(TVMGraphRuntime* runtime, const char* name,
+                                     DLTensor* data_ref);
+
+/*!
+ * \brief Bind an output of the graph to caller-owned memory, so that Run writes it in place.
+ *
+ * The tensor must satisfy the same requirements as TVMGraphRuntime_SetInputZeroCopy.
+ * TVMGraphRuntime_GetOutput skips the copy when given the bound tensor.
+ *
+ * \param runtime The graph runtime.
+ * \param index The output index.
+ * \param data_ref The caller-owned tensor, which must outlive every run that writes it.
+ * \return 0 on success, -1 if the tensor does not match the output.
+ */
+int TVMGraphRuntime_SetOutputZeroCopy(TVMGraphRuntime* runtime, const int32_t index,
+                                      DLTensor* data_ref);
+
 /*!
  * \brief Return NDArray for given output index.
  * \param runtime The graph runtime.
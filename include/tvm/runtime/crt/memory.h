@@ -55,6 +55,27 @@ void* vrealloc(void* ptr, size_t size);
  */
 void vfree(void* ptr);
 
+/*! \brief Occupancy and fragmentation of the virtual memory pool. */
+typedef struct VirtualMemoryStats {
+  /*! \brief Bytes held by live allocations, after rounding to the allocation granularity. */
+  size_t used_bytes;
+  /*! \brief Bytes available in free blocks. */
+  size_t free_bytes;
+  /*! \brief Size of the largest free block, a bound on the largest allocation that can succeed. */
+  size_t largest_free_block;
+  /*! \brief Number of live allocations. */
+  size_t num_used_blocks;
+  /*! \brief Number of free blocks; more of them for the same free bytes is more fragmented. */
+  size_t num_free_blocks;
+} VirtualMemoryStats;
+
+/*!
+ * \brief Report the occupancy and fragmentation of the memory pool.
+ * \param stats Filled with the statistics.
+ * \return 0 on success, -1 when the configured allocator does not keep statistics.
+ */
+int vstats(VirtualMemoryStats* stats);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
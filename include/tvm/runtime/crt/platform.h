@@ -25,6 +25,8 @@
 #ifndef TVM_RUNTIME_CRT_PLATFORM_H_
 #define TVM_RUNTIME_CRT_PLATFORM_H_
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -37,6 +39,16 @@ extern "C" {
  */
 void __attribute__((noreturn)) TVMPlatformAbort(int code);
 
+/*! \brief Read a free-running cycle counter, such as DWT->CYCCNT on Cortex-M.
+ *
+ * Only called when the CRT is built with TVM_CRT_GRAPH_RUNTIME_PROFILE, so other platforms
+ * need not provide it. The counter may wrap around; the runtime only subtracts readings taken
+ * around a single operator.
+ *
+ * \return The current value of the counter.
+ */
+uint32_t TVMPlatformCycleCount(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -25,10 +25,23 @@
 
 #include <tvm/runtime/object.h>
 
+#include <cstdint>
 #include <cstdlib>
+#include <string>
 #include <type_traits>
 #include <utility>
 
+/*!
+ * \brief Whether make_object allocates from the pooled object allocator
+ *  instead of new/delete. Set by the USE_OBJECT_POOL_ALLOCATOR build option.
+ *
+ *  Each object records its deleter, so objects created by code built with and
+ *  without the pool can be mixed freely.
+ */
+#ifndef TVM_OBJECT_POOL_ALLOCATOR
+#define TVM_OBJECT_POOL_ALLOCATOR 0
+#endif
+
 namespace tvm {
 namespace runtime {
 /*!
@@ -45,10 +58,10 @@ inline ObjectPtr<T> make_object(Args&&... args);
 // The current design allows swapping the
 // allocator pattern when necessary.
 //
-// Possible future allocator optimizations:
-// - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
-// - Thread-local object pools: one pool per size and alignment requirement.
-// - Can specialize by type of object to give the specific allocator to each object.
+// Available allocators:
+// - SimpleObjAllocator: new/delete.
+// - PoolObjAllocator: size-segregated free lists cached per thread, and
+//   arenas for the temporary objects of a scope (see ObjectArenaScope).
 
 /*!
  * \brief Base class of object allocators that implements make.
@@ -191,15 +204,155 @@ class SimpleObjAllocator : public ObjAllocatorBase<SimpleObjAllocator> {
   };
 };
 
+/*!
+ * \brief Allocator that carves objects out of large chunks, with a free list
+ *  per 16-byte size class.
+ *
+ *  Each thread caches free slots of every size class and exchanges them with a
+ *  shared pool in batches, so allocating and freeing small objects usually
+ *  takes no lock. Objects can be freed on any thread. The chunks are kept for
+ *  the lifetime of the process and reused for later objects.
+ *
+ *  Objects larger than the biggest size class are allocated with new. Objects
+ *  created while an ObjectArenaScope is active on the thread are bump allocated
+ *  from the arena of the scope instead.
+ */
+class PoolObjAllocator : public ObjAllocatorBase<PoolObjAllocator> {
+ public:
+  /*! \brief The alignment of the pooled objects. */
+  static constexpr size_t kAlignment = 16;
+
+  template <typename T>
+  class Handler {
+   public:
+    static_assert(alignof(T) <= kAlignment, "object alignment constraint");
+
+    template <typename... Args>
+    static T* New(PoolObjAllocator*, Args&&... args) {
+      void* data = Allocate(sizeof(T), T::RuntimeTypeIndex());
+      new (data) T(std::forward<Args>(args)...);
+      return static_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      T* tptr = static_cast<T*>(objptr);
+      uint32_t type_index = tptr->type_index();
+      tptr->T::~T();
+      Free(tptr, type_index);
+    }
+  };
+
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) <= kAlignment, "object alignment constraint");
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+
+    template <typename... Args>
+    static ArrayType* New(PoolObjAllocator*, size_t num_elems, Args&&... args) {
+      void* data =
+          Allocate(sizeof(ArrayType) + num_elems * sizeof(ElemType), ArrayType::RuntimeTypeIndex());
+      new (data) ArrayType(std::forward<Args>(args)...);
+      return static_cast<ArrayType*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      uint32_t type_index = tptr->type_index();
+      tptr->ArrayType::~ArrayType();
+      Free(tptr, type_index);
+    }
+  };
+
+  /*!
+   * \brief Allocate the storage of an object.
+   * \param size The size of the object.
+   * \param type_index The type index of the object, used by the statistics.
+   * \return The storage, aligned to kAlignment.
+   */
+  TVM_DLL static void* Allocate(size_t size, uint32_t type_index);
+  /*!
+   * \brief Free the storage of a destroyed object.
+   * \param ptr The storage returned by Allocate.
+   * \param type_index The type index of the object, used by the statistics.
+   */
+  TVM_DLL static void Free(void* ptr, uint32_t type_index);
+  /*!
+   * \brief Enable or disable the per-type statistics, disabled by default.
+   *  Enabling them resets the counters.
+   * \param enable Whether to collect the statistics.
+   */
+  TVM_DLL static void EnableStats(bool enable);
+  /*!
+   * \brief Report the statistics as JSON: the bytes reserved by the pool, and
+   *  the allocations, frees and allocated bytes of each type since the
+   *  statistics were enabled.
+   * \return The statistics.
+   */
+  TVM_DLL static std::string GetStats();
+};
+
+/*!
+ * \brief Make the objects created by the pooled allocator on this thread come
+ *  from an arena while the scope is alive.
+ *
+ *  Arena allocation is a pointer bump, and the memory of the arena is released
+ *  at once when the scope has ended and all its objects are freed. It suits the
+ *  many short-lived objects of a pass. Objects may outlive the scope, e.g. the
+ *  result of the pass, but they keep the whole arena alive, so the scope should
+ *  not wrap code whose results are a small part of what it allocates.
+ *
+ *  Scopes can be nested, the innermost one is used. Without the pooled
+ *  allocator the scope has no effect.
+ *
+ * \code
+ *
+ *  {
+ *    ObjectArenaScope arena;
+ *    func = RunPass(func);
+ *  }
+ *
+ * \endcode
+ */
+class ObjectArenaScope {
+ public:
+  TVM_DLL ObjectArenaScope();
+  TVM_DLL ~ObjectArenaScope();
+  ObjectArenaScope(const ObjectArenaScope&) = delete;
+  ObjectArenaScope& operator=(const ObjectArenaScope&) = delete;
+
+ private:
+  /*! \brief The arena of this scope. */
+  void* arena_;
+  /*! \brief The arena of the enclosing scope. */
+  void* prev_;
+};
+
+#if TVM_OBJECT_POOL_ALLOCATOR
+/*! \brief The allocator used by make_object. */
+using DefaultObjAllocator = PoolObjAllocator;
+#else
+/*! \brief The allocator used by make_object. */
+using DefaultObjAllocator = SimpleObjAllocator;
+#endif
+
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args) {
-  return SimpleObjAllocator().make_object<T>(std::forward<Args>(args)...);
+  return DefaultObjAllocator().make_object<T>(std::forward<Args>(args)...);
 }
 
 template <typename ArrayType, typename ElemType, typename... Args>
 inline ObjectPtr<ArrayType> make_inplace_array_object(size_t num_elems, Args&&... args) {
-  return SimpleObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
-                                                                      std::forward<Args>(args)...);
+  return DefaultObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
+                                                                       std::forward<Args>(args)...);
 }
 
 }  // namespace runtime
@@ -27,6 +27,7 @@
 #define TVM_RUNTIME_MODULE_H_
 
 #include <dmlc/io.h>
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
@@ -60,6 +61,16 @@ class Module : public ObjectRef {
    * \note Implemented in packed_func.cc
    */
   inline PackedFunc GetFunction(const std::string& name, bool query_imports = false);
+  /*!
+   * \brief Get the address of a compiled function that can be called without
+   *  going through a PackedFunc.
+   *
+   * \param name The name of the function.
+   * \param query_imports Whether also query dependency modules.
+   * \return The address, nullptr when no module has it.
+   * \sa ModuleNode::GetPackedCFunc
+   */
+  inline TVMBackendPackedCFunc GetPackedCFunc(const std::string& name, bool query_imports = false);
   // The following functions requires link with runtime.
   /*!
    * \brief Import another module into this module.
@@ -136,6 +147,19 @@ class TVM_DLL ModuleNode : public Object {
    */
   virtual PackedFunc GetFunction(const std::string& name,
                                  const ObjectPtr<Object>& sptr_to_self) = 0;
+  /*!
+   * \brief Get the address of a compiled function, when the module has one.
+   *
+   *  Calling the address directly skips the PackedFunc wrapping it, which
+   *  matters to executors calling small kernels many times with arguments they
+   *  set up once. It behaves like the function returned by GetFunction.
+   *
+   * \param name the name of the function.
+   * \return The address, nullptr when it is not available.
+   *
+   * \note The address is only valid while the module is alive.
+   */
+  virtual TVMBackendPackedCFunc GetPackedCFunc(const std::string& name) { return nullptr; }
   /*!
    * \brief Save the module to file.
    * \param file_name The file to be saved to.
@@ -166,6 +190,14 @@ class TVM_DLL ModuleNode : public Object {
    * \note Implemented in packed_func.cc
    */
   PackedFunc GetFunction(const std::string& name, bool query_imports = false);
+  /*!
+   * \brief Get the address of a compiled function from current module by name.
+   *
+   * \param name The name of the function.
+   * \param query_imports Whether also query dependency modules.
+   * \return The address, nullptr when no module has it.
+   */
+  TVMBackendPackedCFunc GetPackedCFunc(const std::string& name, bool query_imports);
   /*!
    * \brief Import another module into this module.
    * \param other The module to be imported.
@@ -218,6 +250,8 @@ constexpr const char* tvm_module_ctx = "__tvm_module_ctx";
 constexpr const char* tvm_dev_mblob = "__tvm_dev_mblob";
 /*! \brief Number of bytes of device module blob. */
 constexpr const char* tvm_dev_mblob_nbytes = "__tvm_dev_mblob_nbytes";
+/*! \brief Global variable to store the params section of the device module blob. */
+constexpr const char* tvm_dev_mparams = "__tvm_dev_mparams";
 /*! \brief global function to set device */
 constexpr const char* tvm_set_device = "__tvm_set_device";
 /*! \brief Auxiliary counter to global barrier. */
@@ -226,12 +260,25 @@ constexpr const char* tvm_global_barrier_state = "__tvm_global_barrier_state";
 constexpr const char* tvm_prepare_global_barrier = "__tvm_prepare_global_barrier";
 /*! \brief Placeholder for the module's entry function. */
 constexpr const char* tvm_module_main = "__tvm_main__";
+/*!
+ * \brief Comma separated ISA levels a library has variants of its functions for,
+ *  best first. The variant of a function for an ISA is named name + "__" + ISA.
+ */
+constexpr const char* tvm_isa_variants = "__tvm_isa_variants";
+/*! \brief The counters of the branches and loops of a PGO instrumented library. */
+constexpr const char* tvm_pgo_counters = "__tvm_pgo_counters";
+/*! \brief The newline terminated keys of the counted sites, two counters each. */
+constexpr const char* tvm_pgo_sites = "__tvm_pgo_sites";
 }  // namespace symbol
 
 // implementations of inline functions.
 
 inline void Module::Import(Module other) { return (*this)->Import(other); }
 
+inline TVMBackendPackedCFunc Module::GetPackedCFunc(const std::string& name, bool query_imports) {
+  return (*this)->GetPackedCFunc(name, query_imports);
+}
+
 inline ModuleNode* Module::operator->() { return static_cast<ModuleNode*>(get_mutable()); }
 
 inline const ModuleNode* Module::operator->() const {
@@ -122,9 +122,22 @@ class NDArray : public ObjectRef {
    * \brief Create a NDArray that shares the data memory with the current one.
    * \param shape The shape of the new array.
    * \param dtype The data type of the new array.
-   * \note The memory size of new array must be smaller than the current one.
+   * \param relative_byte_offset The offset of the view from the start of the current array.
+   * \note The memory of the new array must lie within the current one.
    */
-  TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype);
+  TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype,
+                             int64_t relative_byte_offset = 0);
+  /*!
+   * \brief Create a strided NDArray that shares the data memory with the current one,
+   *  e.g. a slice of it.
+   * \param shape The shape of the new array.
+   * \param strides The strides of the new array in elements, must be non-negative.
+   * \param relative_byte_offset The offset of the view from the start of the current array.
+   * \note The memory of the new array must lie within the current one. Compact strides are
+   *  dropped, so a view which is compact can be passed to the compiled kernels.
+   */
+  TVM_DLL NDArray CreateStridedView(std::vector<int64_t> shape, std::vector<int64_t> strides,
+                                    int64_t relative_byte_offset = 0);
   /*!
    * \brief Create a reference view of NDArray that
    *  represents as DLManagedTensor.
@@ -236,6 +249,10 @@ class NDArray::ContainerBase {
    *  can be used used for shape data.
    */
   std::vector<int64_t> shape_;
+  /*!
+   * \brief The strides container of strided views.
+   */
+  std::vector<int64_t> strides_;
 };
 
 /*!
@@ -322,6 +339,19 @@ inline bool IsContiguous(const DLTensor& arr) {
   return true;
 }
 
+/*!
+ * \brief check if the data pointer of the arrays on a context is an address,
+ *  so a byte offset can be folded into it.
+ * \param ctx The context.
+ * \return The check result.
+ * \note The compiled kernels expect a zero byte_offset, views fold their offset
+ *  into the data pointer on these contexts.
+ */
+inline bool IsAddressableContext(const DLContext& ctx) {
+  return ctx.device_type == kDLCPU || ctx.device_type == kDLCPUPinned ||
+         ctx.device_type == kDLGPU || ctx.device_type == kDLROCM;
+}
+
 inline bool NDArray::IsContiguous() const {
   return ::tvm::runtime::IsContiguous(get_mutable()->dl_tensor);
 }
@@ -387,9 +417,36 @@ inline Object* TVMArrayHandleToObjectHandle(TVMArrayHandle handle) {
 
 /*! \brief Magic number for NDArray file */
 constexpr uint64_t kTVMNDArrayMagic = 0xDD5E40F096B4A13F;
+/*!
+ * \brief The reserved field of a tensor record whose payload is in the params section
+ *  of the library it is loaded from, the record ending with the index of the payload.
+ */
+constexpr uint64_t kTVMNDArraySectionRecord = 1;
+
+/*!
+ * \brief Move the payload of a tensor being saved to the params section written on this
+ *  thread, see ParamsSectionWriter.
+ * \param tensor The tensor being saved.
+ * \return The index of the payload in the section, -1 when no section is written.
+ */
+TVM_DLL int64_t ParamsSectionAdd(const DLTensor* tensor);
+
+/*!
+ * \brief View a payload of the params section read on this thread in place,
+ *  see ParamsSectionReader.
+ * \param index The index of the payload in the section.
+ * \param dtype The data type of the tensor.
+ * \param shape The shape of the tensor.
+ * \param nbytes The size of the payload.
+ * \return A CPU NDArray viewing the payload, which keeps the library loaded.
+ */
+TVM_DLL NDArray ParamsSectionView(uint64_t index, DLDataType dtype, std::vector<int64_t> shape,
+                                  int64_t nbytes);
 
 inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
-  uint64_t header = kTVMNDArrayMagic, reserved = 0;
+  int64_t section_index = ParamsSectionAdd(tensor);
+  uint64_t header = kTVMNDArrayMagic;
+  uint64_t reserved = section_index < 0 ? 0 : kTVMNDArraySectionRecord;
   strm->Write(header);
   strm->Write(reserved);
   // Always save data as CPU context
@@ -416,6 +473,10 @@ inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
   }
   int64_t data_byte_size = type_bytes * num_elems;
   strm->Write(data_byte_size);
+  if (section_index >= 0) {
+    strm->Write(static_cast<uint64_t>(section_index));
+    return true;
+  }
 
   if (DMLC_IO_NO_ENDIAN_SWAP && tensor->ctx.device_type == kDLCPU && tensor->strides == nullptr &&
       tensor->byte_offset == 0) {
@@ -453,15 +514,21 @@ inline bool NDArray::Load(dmlc::Stream* strm) {
   if (ndim != 0) {
     CHECK(strm->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
   }
-  NDArray ret = NDArray::Empty(shape, dtype, ctx);
   int64_t num_elems = 1;
-  int elem_bytes = (ret->dtype.bits + 7) / 8;
-  for (int i = 0; i < ret->ndim; ++i) {
-    num_elems *= ret->shape[i];
+  int elem_bytes = (dtype.bits + 7) / 8;
+  for (int i = 0; i < ndim; ++i) {
+    num_elems *= shape[i];
   }
   int64_t data_byte_size;
   CHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
   CHECK(data_byte_size == num_elems * elem_bytes) << "Invalid DLTensor file format";
+  if (reserved == kTVMNDArraySectionRecord) {
+    uint64_t index;
+    CHECK(strm->Read(&index)) << "Invalid DLTensor file format";
+    *this = ParamsSectionView(index, dtype, std::move(shape), data_byte_size);
+    return true;
+  }
+  NDArray ret = NDArray::Empty(shape, dtype, ctx);
   auto read_ret = strm->Read(ret->data, data_byte_size);
   // Only check non-empty data
   if (ndim > 0 && shape[0] != 0) {
@@ -26,6 +26,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -80,6 +81,17 @@ class ThreadGroup {
    */
   int Configure(AffinityMode mode, int nthreads, bool exclude_worker0);
 
+  /*!
+   * \brief configure the CPU id affinity with an explicit set of cores
+   *
+   * \param cpus The ids of the cores the workers are bound to, one core per worker.
+   * \param exclude_worker0 Whether to use the main thread as a worker.
+   *        The affinity of the main thread is left untouched.
+   *
+   * \return The number of workers to use.
+   */
+  int Configure(const std::vector<unsigned int>& cpus, bool exclude_worker0);
+
  private:
   Impl* impl_;
 };
@@ -94,6 +106,56 @@ void Yield();
  */
 int MaxConcurrency();
 
+/*!
+ * \brief The number of threads a parallel launch from the calling thread runs on.
+ *
+ *  External libraries called from TVM kernels (NNPACK, BLAS, DNNL, ...) size
+ *  their own parallelism by it, so that runtime.config_threadpool is the single
+ *  place configuring the threads of a model.
+ *
+ * \return The number of workers used by the thread pool of the calling thread.
+ */
+int NumThreads();
+
+/*!
+ * \return The ids of the online NUMA nodes, empty when the topology is unknown.
+ */
+std::vector<int> NumaNodes();
+
+/*!
+ * \brief Get the cores of a NUMA node, one hardware thread per physical core.
+ * \param node The id of the NUMA node.
+ * \return The ids of the cores, empty when the topology is unknown.
+ */
+std::vector<unsigned int> NumaNodeCpus(int node);
+
+/*!
+ * \brief Bind the parallel launches of the calling thread to a named
+ *  thread pool partition, created by runtime.config_threadpool_partition.
+ *
+ * \param name The name of the partition, empty to use the default pool of the thread.
+ * \return The name of the partition previously bound to the thread.
+ */
+std::string BindThreadPoolPartition(const std::string& name);
+
+/*!
+ * \brief RAII helper binding the calling thread to a thread pool partition
+ *  during its lifetime. An empty name keeps the current binding.
+ */
+class ThreadPoolPartitionScope {
+ public:
+  explicit ThreadPoolPartitionScope(const std::string& name) : active_(!name.empty()) {
+    if (active_) prev_ = BindThreadPoolPartition(name);
+  }
+  ~ThreadPoolPartitionScope() {
+    if (active_) BindThreadPoolPartition(prev_);
+  }
+
+ private:
+  bool active_;
+  std::string prev_;
+};
+
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
@@ -66,6 +66,7 @@ enum class Opcode {
   AllocStorage = 16U,
   ShapeOf = 17U,
   ReshapeTensor = 18U,
+  AllocStorageTensor = 19U,
 };
 
 /*! \brief A single virtual machine instruction.
@@ -197,6 +198,22 @@ struct Instruction {
       /*! \brief The hint of the dtype. */
       DLDataType dtype_hint;
     } alloc_storage;
+    struct /* AllocStorageTensor Operands */ {
+      /*! \brief The size of the storage allocation. */
+      RegName allocation_size;
+      /*! \brief The alignment of the storage allocation. */
+      Index alignment;
+      /*! \brief The hint of the storage dtype. */
+      DLDataType dtype_hint;
+      /*! \brief The register holding the offset of the tensor in the storage. */
+      RegName offset;
+      /*! \brief The number of dimensions. */
+      uint32_t ndim;
+      /*! \brief The shape of tensor. */
+      int64_t* shape;
+      /*! \brief The datatype of tensor to be allocated. */
+      DLDataType dtype;
+    } alloc_storage_tensor;
     struct /* ShapeOf Operands */ {
       RegName tensor;
     } shape_of;
@@ -346,6 +363,24 @@ struct Instruction {
    */
   static Instruction AllocStorage(RegName size, Index alignment, DLDataType dtype_hint,
                                   RegName dst);
+  /*!
+   * \brief Allocate a storage block holding a single tensor of constant shape.
+   *
+   * The superinstruction for an AllocStorage whose storage is only used by the
+   * AllocTensor that follows it.
+   *
+   * \param size The size of the storage allocation.
+   * \param alignment The storage allocation's alignment.
+   * \param dtype_hint The data type hint for the allocator.
+   * \param offset The register holding the offset of the tensor in the storage.
+   * \param shape The shape of the tensor.
+   * \param dtype The dtype of the tensor.
+   * \param dst The destination register of the tensor.
+   * \return The alloc storage tensor instruction.
+   */
+  static Instruction AllocStorageTensor(RegName size, Index alignment, DLDataType dtype_hint,
+                                        RegName offset, const std::vector<int64_t>& shape,
+                                        DLDataType dtype, RegName dst);
   /*!
    * \brief Get the shape of an input tensor.
    * \param tensor The input tensor.
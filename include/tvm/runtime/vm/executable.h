@@ -29,12 +29,19 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/vm/bytecode.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
+
+class MappedFile;
+
 namespace vm {
 
 struct VMFunction;
@@ -81,6 +88,19 @@ class Executable : public ModuleNode {
    */
   static runtime::Module Load(const std::string& code, const runtime::Module lib);
 
+  /*!
+   * \brief Load a saved VM executable from a file.
+   *
+   * The file is memory-mapped and the constants are views into the mapping,
+   * so their data is only read in when the VM first loads them.
+   *
+   * \param path The path of the saved bytecode.
+   * \param lib The compiled runtime library.
+   *
+   * \return exe The constructed executable.
+   */
+  static runtime::Module LoadFromFile(const std::string& path, const runtime::Module lib);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -144,6 +164,26 @@ class Executable : public ModuleNode {
    */
   std::string GetFunctionParameterName(std::string func, uint32_t index) const;
 
+  /*!
+   * \brief Get the primitive functions of the executable, indexed like primitive_map.
+   *  They are looked up in `lib` by the first virtual machine loading the executable.
+   *
+   * \return The resolved packed functions.
+   * \note Thread-safe, all the virtual machines running the executable share them.
+   */
+  const std::vector<PackedFunc>& GetPackedFuncs() const;
+
+  /*!
+   * \brief Get a constant on a context, copied there on first use.
+   * \param const_index The index of the constant.
+   * \param ctx The context.
+   * \param copied Set to whether this call made the copy, when not nullptr.
+   * \return The constant on the context.
+   * \note Thread-safe, all the virtual machines running the executable on the
+   *  context share the copy.
+   */
+  ObjectRef GetConstant(Index const_index, const TVMContext& ctx, bool* copied = nullptr) const;
+
   virtual ~Executable() {}
 
   const char* type_key() const final { return "VMExecutable"; }
@@ -201,9 +241,16 @@ class Executable : public ModuleNode {
   /*!
    * \brief Load the constant pool.
    *
+   * \param strm The input stream, positioned relative to the start of the executable.
+   */
+  void LoadConstantSection(dmlc::SeekStream* strm);
+
+  /*!
+   * \brief Load all the sections of a saved executable.
+   *
    * \param strm The input stream.
    */
-  void LoadConstantSection(dmlc::Stream* strm);
+  void LoadSections(dmlc::SeekStream* strm);
 
   /*!
    * \brief Load primitive op names.
@@ -221,6 +268,16 @@ class Executable : public ModuleNode {
 
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief Guards the state shared by the virtual machines running the executable. */
+  mutable std::mutex mutex_;
+  /*! \brief Whether packed_funcs_ has been resolved. */
+  mutable bool packed_funcs_resolved_{false};
+  /*! \brief The resolved primitive functions. */
+  mutable std::vector<PackedFunc> packed_funcs_;
+  /*! \brief The copies of the constants, per (device type, device id). */
+  mutable std::map<std::pair<int, int>, std::vector<ObjectRef>> device_constants_;
+  /*! \brief The file being loaded, when the executable is loaded from a mapped file. */
+  std::shared_ptr<MappedFile> mapped_file_;
 };
 
 }  // namespace vm
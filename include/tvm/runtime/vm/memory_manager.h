@@ -67,6 +67,8 @@ struct Buffer {
 enum AllocatorType {
   kNaive = 1,
   kPooled,
+  kSizeClass,
+  kStreamOrdered,
 };
 
 class Allocator {
@@ -97,6 +99,8 @@ class Allocator {
    *  \return The amount of memory currently allocated.
    */
   virtual size_t UsedMemory() const = 0;
+  /*! \brief Return the memory cached by the allocator to the device. */
+  virtual void Trim() {}
 
  private:
   AllocatorType type_;
@@ -41,8 +41,15 @@
 
 namespace tvm {
 namespace runtime {
+
+class Timeline;
+class PinnedStaging;
+
 namespace vm {
 
+struct VMStats;
+class VMObjectPool;
+
 /*!
  * \brief An object representing a vm closure.
  */
@@ -113,18 +120,22 @@ struct VMFrame {
   /*! \brief A pointer into the caller function's instructions. */
   const Instruction* code;
 
-  /*! \brief Statically allocated space for objects */
-  std::vector<ObjectRef> register_file;
+  /*! \brief The offset of the frame's registers in the VM register stack. */
+  Index register_base;
+  /*! \brief The number of registers of the frame. */
+  Index register_file_size;
 
   /*! \brief Register in caller's frame to put return value */
   RegName caller_return_register;
 
-  VMFrame(Index pc, Index func_index, Index args, const Instruction* code, Index register_file_size)
+  VMFrame(Index pc, Index func_index, Index args, const Instruction* code, Index register_base,
+          Index register_file_size)
       : pc(pc),
         func_index(func_index),
         args(args),
         code(code),
-        register_file(register_file_size),
+        register_base(register_base),
+        register_file_size(register_file_size),
         caller_return_register(0) {}
 };
 
@@ -160,11 +171,12 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   virtual PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self);
 
-  virtual ~VirtualMachine() {}
+  virtual ~VirtualMachine();
 
   const char* type_key() const final { return "VirtualMachine"; }
 
-  VirtualMachine() : frames_(), func_index_(0), code_(nullptr), pc_(0), exec_(nullptr) {}
+  VirtualMachine()
+      : frames_(), registers_(nullptr), func_index_(0), code_(nullptr), pc_(0), exec_(nullptr) {}
 
   /*!
    * \brief load the executable for the virtual machine.
@@ -173,8 +185,25 @@ class VirtualMachine : public runtime::ModuleNode {
   virtual void LoadExecutable(const Executable* exec);
 
  protected:
-  /*! \brief Push a call frame on to the call stack. */
-  void PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func);
+  /*!
+   * \brief Push a call frame on to the call stack.
+   *
+   * The registers of the frame are a window of the register stack right above
+   * the caller's, the stack only grows when a call goes deeper than before.
+   * The callee becomes the current function.
+   */
+  void PushFrame(Index arg_count, Index ret_pc, Index func_index);
+
+  /*!
+   * \brief Call a function of the executable from the current frame.
+   * \param func_index The index of the callee.
+   * \param free_vars The captured variables passed ahead of the arguments, for closures.
+   * \param num_args The number of arguments.
+   * \param arg_registers The caller's registers holding the arguments.
+   * \param dst The caller's register receiving the result.
+   */
+  void InvokeLocal(Index func_index, const std::vector<ObjectRef>* free_vars,
+                   Index num_args, const RegName* arg_registers, RegName dst);
 
   /*!
    * \brief Pop a frame off the call stack.
@@ -241,6 +270,57 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   void Init(const std::vector<TVMContext>& contexts, const std::vector<AllocatorType>& alloc_types);
 
+  /*!
+   * \brief Allocate the storage of an allocating instruction.
+   *
+   * When the static memory plan is enabled the storage recorded for \p instr is
+   * replayed once nothing but the plan refers to it.
+   *
+   * \param instr The AllocStorage or AllocStorageTensor instruction, which keys the plan.
+   * \param size The size of the allocation in bytes.
+   * \param alignment The alignment of the allocation.
+   * \param dtype_hint The data type hint for the allocator.
+   * \return The allocated storage.
+   */
+  Storage AllocateStorage(const Instruction& instr, int64_t size, Index alignment,
+                          DLDataType dtype_hint);
+
+  /*!
+   * \brief Queue the kernels and copies of the VM on a stream of each device,
+   *  instead of running them on the default one.
+   * \param async Whether to enable the asynchronous mode.
+   */
+  void SetAsyncExecution(bool async);
+
+  /*!
+   * \brief Get the stream the VM queues work on for a context.
+   * \param ctx The context.
+   * \return The stream, nullptr for the default stream.
+   */
+  TVMStreamHandle GetStream(const TVMContext& ctx) const;
+
+  /*!
+   * \brief Copy an object to a context on the stream of the VM.
+   *
+   * A copy to the host waits for the work queued before it, a copy to a
+   * device is queued after it.
+   *
+   * \param src The object to copy, returned as is when it is already on the context.
+   * \param ctx The destination context.
+   * \return The copied object.
+   */
+  ObjectRef CopyTo(const ObjectRef& src, const TVMContext& ctx) const;
+
+  /*!
+   * \brief Build the memoization key of a shape function call from its inputs.
+   * \param num_inputs The number of inputs, leading the arguments.
+   * \param args The arguments of the call.
+   * \param key The key, made of the dtype, shape and data of every input.
+   * \return Whether the call can be memoized, i.e. all the inputs are small host tensors.
+   */
+  bool GetShapeFuncKey(Index num_inputs, const std::vector<ObjectRef>& args,
+                       std::string* key) const;
+
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
 
@@ -252,13 +332,17 @@ class VirtualMachine : public runtime::ModuleNode {
    *
    * This does not begin execution of the VM.
    */
-  void InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args);
+  void InvokeGlobal(Index func_index, const std::vector<ObjectRef>& args);
 
  protected:
-  /*! \brief The virtual machine's packed function table. */
-  std::vector<PackedFunc> packed_funcs_;
+  /*! \brief The virtual machine's packed function table, owned by the executable. */
+  const std::vector<PackedFunc>* packed_funcs_{nullptr};
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames_;
+  /*! \brief The registers of all the frames on the call stack, kept across invocations. */
+  std::vector<ObjectRef> register_stack_;
+  /*! \brief The registers of the current frame, points into register_stack_. */
+  ObjectRef* registers_;
   /*! \brief The fuction table index of the current function. */
   Index func_index_;
   /*! \brief The current pointer to the code section. */
@@ -280,6 +364,49 @@ class VirtualMachine : public runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<ObjectRef> const_pool_;
+  /*! \brief The thread pool partition the VM runs on, empty for the pool of the calling thread. */
+  std::string thread_pool_partition_;
+  /*! \brief The pinned buffers the inputs are uploaded through, null when not staging. */
+  std::shared_ptr<PinnedStaging> pinned_staging_;
+  /*!
+   * \brief Whether to keep the storage allocated by each AllocStorage instruction
+   *  and reuse it in the later invocations, once no object lives in it anymore.
+   */
+  bool static_memory_plan_{false};
+  /*!
+   * \brief The storage recorded for each AllocStorage or AllocStorageTensor instruction,
+   *  with its requested size.
+   */
+  std::unordered_map<const Instruction*, std::pair<int64_t, Storage>> memory_plan_;
+  /*!
+   * \brief Whether the constants are shared through the WeightRegistry with the other
+   *  virtual machines running the same executable on the same device.
+   */
+  bool share_constants_{false};
+  /*! \brief The timeline recording allocations and data copies, nullptr when not tracing. */
+  Timeline* timeline_{nullptr};
+  /*! \brief The counters of the instructions, allocations and copies, nullptr if not profiling. */
+  VMStats* stats_{nullptr};
+  /*!
+   * \brief The address of each packed function compiled in a library, called
+   *  without its PackedFunc wrapper, nullptr for the others. Indexed like packed_funcs_.
+   */
+  std::vector<TVMBackendPackedCFunc> packed_cfuncs_;
+  /*! \brief Whether each packed function is a shape function, indexed like packed_funcs_. */
+  std::vector<bool> is_shape_func_;
+  /*! \brief The name of each packed function, for the trace. Indexed like packed_funcs_. */
+  std::vector<std::string> packed_names_;
+  /*! \brief The maximum number of results memoized per shape function, 0 when disabled. */
+  size_t shape_func_cache_size_{0};
+  /*! \brief The memoized outputs of the shape functions, per packed index and input key. */
+  std::unordered_map<Index, std::unordered_map<std::string, std::vector<NDArray>>>
+      shape_func_cache_;
+  /*! \brief Whether the kernels and copies are queued on the streams of the VM. */
+  bool async_execution_{false};
+  /*! \brief The stream of each context in ctxs_ in asynchronous mode, nullptr for the host. */
+  std::vector<TVMStreamHandle> streams_;
+  /*! \brief The allocator of the ADTs and closures created by the VM. */
+  VMObjectPool* object_pool_{nullptr};
 };
 
 }  // namespace vm
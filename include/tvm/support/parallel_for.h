@@ -59,13 +59,37 @@ TVM_DLL std::vector<std::vector<int>> rr_partitioner(int begin, int end, int ste
  * \param end The end index of this parallel loop(exclusive).
  * \param f The task function to be excuted. Assert to take an int index as input with no output.
  * \param step The traversal step to the index.
- * \param partitioner A partition function to split tasks to different threads. Use Round-robin
- * partitioner by default.
- * \note 1. Currently do not support nested parallel_for; 2. The order of execution in each thread
- * is not guaranteed, the for loop task should be thread independent and thread safe.
+ * \param partitioner A partition function to split tasks to different threads, each partition
+ * runs as one task. By default the iterations are scheduled dynamically, see parallel_for_dynamic.
+ * \note The order of execution in each thread is not guaranteed, the for loop task should be
+ * thread independent and thread safe. The first exception thrown by f is rethrown.
  */
 TVM_DLL void parallel_for(int begin, int end, const std::function<void(int)>& f, int step = 1,
-                          const PartitionerFuncType partitioner = rr_partitioner);
+                          const PartitionerFuncType partitioner = nullptr);
+
+/*!
+ * \brief Run the iterations of a loop on the persistent compiler thread pool.
+ *
+ *  Every participating thread owns a contiguous block of the iterations, takes chunks
+ *  from it that shrink as it drains, and steals from the others once its own block is
+ *  empty. The calling thread participates, so a call nested in a parallel loop runs
+ *  with the workers idle at the time, or alone when all of them are busy.
+ * \param begin The start index of this parallel loop(inclusive).
+ * \param end The end index of this parallel loop(exclusive).
+ * \param num_threads The maximum number of threads running the loop, including the caller.
+ *  The pool size bounds it, see NumCompilerThreads.
+ * \param f The task function, taking the index of the thread running it, in
+ *  [0, num_threads), and the iteration. No two threads of the loop share an index,
+ *  so it can select per-thread scratch data.
+ */
+TVM_DLL void parallel_for_dynamic(int begin, int end, int num_threads,
+                                  const std::function<void(int thread_id, int index)>& f);
+
+/*!
+ * \return The number of threads of the compiler thread pool, including the caller,
+ *  the hardware concurrency by default or TVM_NUM_COMPILER_THREADS.
+ */
+TVM_DLL int NumCompilerThreads();
 
 }  // namespace support
 }  // namespace tvm
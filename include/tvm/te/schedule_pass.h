@@ -31,6 +31,12 @@
 #include <tvm/te/schedule.h>
 #include <tvm/tir/function.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace tvm {
 namespace te {
 
@@ -51,6 +57,33 @@ void AutoInlineElemWise(Schedule sch);
  */
 TVM_DLL void AutoInlineInjective(Schedule sch);
 
+/*!
+ * \brief Check whether a compute operation can be tensorized with an intrinsic once its trailing
+ *  axes are split by the extents of the intrinsic's axes.
+ *
+ *  Like tensorize, the trailing spatial and reduce axes of \p op are matched to the axes of the
+ *  intrinsic in order, and the leading axes stay outside of the tensorized region. The extents of
+ *  the matched axes must be constant multiples of the intrinsic's extents.
+ *
+ * \param op The compute operation.
+ * \param intrin The tensor intrinsic.
+ * \return Whether the body of \p op matches the intrinsic.
+ */
+TVM_DLL bool MatchTensorIntrin(const Operation& op, const TensorIntrin& intrin);
+
+/*!
+ * \brief Tensorize a stage with an intrinsic, splitting and reordering its loops as needed.
+ *
+ *  The axes matched by MatchTensorIntrin are split by the intrinsic's extents, the inner parts
+ *  are moved to the innermost positions and tensorized. The stage must not be transformed yet.
+ *
+ * \param sch The schedule.
+ * \param op The operation to tensorize.
+ * \param intrin The tensor intrinsic.
+ * \return Whether the stage was tensorized.
+ */
+TVM_DLL bool AutoTensorize(Schedule sch, const Operation& op, const TensorIntrin& intrin);
+
 /*!
  * \brief Infer the bound of all iteration variables relates to the schedule.
  *
@@ -59,6 +92,73 @@ TVM_DLL void AutoInlineInjective(Schedule sch);
  */
 Map<IterVar, Range> InferBound(const Schedule& sch);
 
+/*!
+ * \brief Bound inference results of stage suffixes, shared by the InferBound calls on
+ *  schedules that are replayed from the same compute declaration.
+ *
+ *  InferBound visits the stages from the last one to the first, and the bounds of a stage only
+ *  depend on the stages visited before it. Two schedules whose trailing stages are structurally
+ *  equal therefore get the same bounds for these stages, which is the common case when a
+ *  schedule search only changes the split factors of a few producer stages.
+ *
+ *  The cache is thread safe.
+ */
+class InferBoundCache {
+ public:
+  /*! \brief The bounds one stage contributes, keyed by the slot of the iter var in the stage. */
+  using StageBounds = std::vector<std::pair<int, Range>>;
+
+  /*!
+   * \brief Constructor.
+   * \param max_entries The number of stage entries to keep before the cache is flushed.
+   */
+  explicit InferBoundCache(size_t max_entries = 16384) : max_entries_(max_entries) {}
+
+  /*!
+   * \brief Look up the bounds of the first stage of a suffix.
+   * \param key The structural key of the suffix.
+   * \param bounds Filled with the cached bounds.
+   * \return Whether the key is in the cache.
+   */
+  bool Lookup(const std::string& key, StageBounds* bounds);
+
+  /*!
+   * \brief Record the bounds of the first stage of a suffix.
+   * \param key The structural key of the suffix.
+   * \param bounds The bounds to be recorded.
+   */
+  void Insert(const std::string& key, StageBounds bounds);
+
+  /*!
+   * \brief Get the variable that stands for an iter var in cached bounds.
+   * \param rank The position of the stage, counted from the last stage.
+   * \param slot The slot of the iter var in the stage.
+   * \param dtype The data type of the iter var.
+   * \return The variable, which is the same for all calls with the same arguments.
+   */
+  Var SlotVar(int rank, int slot, DataType dtype);
+
+ private:
+  /*! \brief The mutex that protects the members below. */
+  std::mutex mutex_;
+  /*! \brief The number of stage entries to keep. */
+  size_t max_entries_;
+  /*! \brief The cached bounds of each suffix. */
+  std::unordered_map<std::string, StageBounds> entries_;
+  /*! \brief The slot variables. */
+  std::unordered_map<std::string, Var> slot_vars_;
+};
+
+/*!
+ * \brief Infer the bound of all iteration variables relates to the schedule, reusing the
+ *  bounds of the trailing stages that were inferred for a structurally equal suffix before.
+ *
+ * \param sch The root schedule to infer all the bounds.
+ * \param cache The cache of earlier results, nullptr to infer all bounds from scratch.
+ * \return the result bound of the iteration Variable
+ */
+Map<IterVar, Range> InferBound(const Schedule& sch, InferBoundCache* cache);
+
 /*!
  * \brief Verify if there is any argument bound to compact buffer.
  *
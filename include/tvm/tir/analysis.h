@@ -141,6 +141,35 @@ TVM_DLL bool VerifyMemory(const PrimFunc& func);
  */
 TVM_DLL bool VerifyGPUCode(const PrimFunc& func, Map<String, PrimExpr> constraints);
 
+/*!
+ * \brief Statically estimate the work and the memory traffic of a function.
+ *
+ *  The operations and the bytes of the loads and stores are weighted by the trip
+ *  count of their loops and threads. No cache reuse is modelled, so the bytes of a
+ *  scope are the traffic seen by that memory level.
+ *
+ * \param func The function to be analyzed.
+ * \return A map with keys
+ *
+ *        "flops": The number of float operations.
+ *        "int_ops": The number of integer operations, mostly index computation.
+ *        "bytes.<scope>": The bytes loaded and stored in the storage scope, e.g.
+ *                         "bytes.global", "bytes.shared" or "bytes.local".
+ *        "arithmetic_intensity": flops per byte of global memory traffic,
+ *                                0 when the function does not touch global memory.
+ */
+TVM_DLL Map<String, PrimExpr> EstimateRoofline(const PrimFunc& func);
+
+/*!
+ * \brief Get the fraction of the global memory accesses under threadIdx.x
+ *  that are coalesced, that is, where consecutive threads access the same or
+ *  consecutive elements.
+ *
+ * \param func The function to be analyzed.
+ * \return The ratio of coalesced accesses, 1 when there is no such access.
+ */
+TVM_DLL double GlobalCoalescingRatio(const PrimFunc& func);
+
 // Pass variants of verification analysis
 // directly throws RuntimeError when verification fails.
 namespace transform {
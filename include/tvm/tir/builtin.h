@@ -549,6 +549,100 @@ TVM_DLL const Op& vectorlow();
  */
 TVM_DLL const Op& vectorcombine();
 
+/*!
+ * \brief Commit the asynchronous copies issued since the last commit as one group.
+ *
+ *  void ptx_commit_group() {
+ *    cp.async.commit_group;
+ *  }
+ */
+TVM_DLL const Op& ptx_commit_group();
+
+/*!
+ * \brief Wait until at most n groups of asynchronous copies are pending.
+ *
+ *  void ptx_wait_group(int n) {
+ *    cp.async.wait_group n;
+ *  }
+ */
+TVM_DLL const Op& ptx_wait_group();
+
+/*!
+ * \brief Warp-level matrix multiply-accumulate on tensor cores, C += A * B.
+ *
+ *  void ptx_mma(StringImm shape, StringImm a_layout, StringImm b_layout,
+ *               StringImm a_dtype, StringImm b_dtype, StringImm c_dtype,
+ *               Var multiplicand_a, Expr a_index,
+ *               Var multiplicand_b, Expr b_index,
+ *               Var accumulator, Expr c_index) {
+ *    // Each thread of the warp holds its elements of the fragments in registers,
+ *    // at the given index of local buffers, in the layout PTX defines for the shape.
+ *    mma.sync.aligned.shape.a_layout.b_layout.c_dtype.a_dtype.b_dtype.c_dtype
+ *        accumulator[c_index:], multiplicand_a[a_index:], multiplicand_b[b_index:],
+ *        accumulator[c_index:];
+ *  }
+ */
+TVM_DLL const Op& ptx_mma();
+
+/*!
+ * \brief Load 8x8 matrices of 16-bit elements from shared memory into the registers of a warp.
+ *
+ *  void ptx_ldmatrix(Bool trans, IntImm num, StringImm type,
+ *                    Var local_ptr, Expr local_index,
+ *                    Var smem_ptr, Expr smem_index) {
+ *    // num is 1, 2 or 4, thread i gives the address of row i % 8 of matrix i / 8.
+ *    ldmatrix.sync.aligned.m8n8.num.trans.shared.type
+ *        local_ptr[local_index:], smem_ptr[smem_index];
+ *  }
+ */
+TVM_DLL const Op& ptx_ldmatrix();
+
+/*!
+ * \brief Read a texel of a 2D image, the RGBA channels of a texture buffer.
+ *
+ *  Type texture2d_load(Var image, Expr x, Expr y) {
+ *    // x indexes the columns and y the rows of the image,
+ *    // the texel holds the 4 elements image[y, x, 0:4].
+ *    return read_image(image, sampler, (int2)(x, y));
+ *  }
+ */
+TVM_DLL const Op& texture2d_load();
+
+/*!
+ * \brief Write a texel of a 2D image, the RGBA channels of a texture buffer.
+ *
+ *  void texture2d_store(Var image, Expr x, Expr y, Expr value) {
+ *    write_image(image, (int2)(x, y), value);
+ *  }
+ */
+TVM_DLL const Op& texture2d_store();
+
+/*!
+ * \brief Dot product of two vectors of 4 8-bit integers, accumulated in 32 bits.
+ *
+ *  int32 dp4a(int8x4 a, int8x4 b, int32 c) {
+ *    return c + a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+ *  }
+ *
+ *  The loop vectorizer produces it for the int8 reductions over 4 elements,
+ *  CUDA lowers it to __dp4a and the other targets to the scalar products.
+ */
+TVM_DLL const Op& dp4a();
+
+/*!
+ * \brief Matrix fused multiply add of a wavefront on the AMD CDNA GPUs.
+ *
+ *  float32x16 mfma(float16x4 a, float16x4 b, float32x16 c) {
+ *    // Every lane passes its fragments of the 32xK tile a, the Kx32 tile b
+ *    // and the 32x32 accumulator tile c, and gets back its fragment of
+ *    // c + a * b. The lane layout is the one of the LLVM AMDGPU intrinsics.
+ *  }
+ *
+ *  The instruction is picked from the operand types: float16x4, bfloat16x2,
+ *  bfloat16x4 accumulated in float32x16, and int8x4 accumulated in int32x16.
+ */
+TVM_DLL const Op& mfma();
+
 /*! \brief The kind of structure field info used in intrinsic */
 enum TVMStructFieldKind : int {
   // array head address
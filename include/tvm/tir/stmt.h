@@ -887,6 +887,11 @@ constexpr const char* device_context_type = "device_context_type";
 constexpr const char* loop_scope = "loop_scope";
 /*! \brief Mark of reduce scope */
 constexpr const char* reduce_scope = "reduce_scope";
+/*!
+ * \brief Mark of a serial loop left to the vectorizer of the backend,
+ *  which may use scalable vectors and predicated tails.
+ */
+constexpr const char* scalable_vectorize_scope = "scalable_vectorize_scope";
 /*! \brief Mark region is guarded by the pragma extension */
 constexpr const char* pragma_scope_prefix = "pragma_";
 /*! \brief Import C source or file into the final code gen module */
@@ -908,6 +913,11 @@ constexpr const char* double_buffer_scope = "double_buffer_scope";
  * \brief Marks region used by double buffer write
  */
 constexpr const char* double_buffer_write = "double_buffer_write";
+/*!
+ * \brief Mark the stores in its body as asynchronous copies, which are only
+ *  visible after a ptx_wait_group.
+ */
+constexpr const char* async_scope = "async_scope";
 /*! \brief Mark of scan update scope */
 constexpr const char* scan_update_scope = "scan_update_scope";
 /*! \brief Mark of scan init scope */
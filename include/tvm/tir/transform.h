@@ -254,6 +254,25 @@ TVM_DLL Pass SplitHostDevice();
  */
 TVM_DLL Pass SkipAssert();
 
+/*!
+ * \brief Lower the accesses of the texture buffers, the parameters in the
+ *  "global.texture" scope of shape [height, width, 4], to texel reads and writes.
+ *
+ * \note The channel axis of the accesses must be vectorized.
+ * \return The pass.
+ */
+TVM_DLL Pass LowerTextureAccess();
+
+/*!
+ * \brief Stage the global loads and stores of a thread block that are coalesced
+ *  along threadIdx.y instead of threadIdx.x through padded shared memory tiles.
+ *
+ * \note Run this pass before ThreadSync("shared"), which inserts the barriers.
+ * \return The pass.
+ * \sa tvm::tir::GlobalCoalescingRatio
+ */
+TVM_DLL Pass CoalesceGlobalAccess();
+
 /*!
  * \brief Insert sync between parallel read/write of shared buffers.
  *
@@ -314,6 +333,9 @@ TVM_DLL Pass CombineContextCall();
 /*!
  * \brief Narrow down PrimExpr datatype in stmt to target_bits.
  *
+ *  Each var and index expression is narrowed when its own range fits, the
+ *  expressions that do not fit are computed in their original datatype.
+ *
  * \param target_bits The target bits
  *
  * \note Run this pass after storage flatten.
@@ -346,6 +368,15 @@ TVM_DLL Pass PointerValueTypeRewrite();
  */
 TVM_DLL Pass HoistIfThenElse();
 
+/*!
+ * \brief Version loops on the conditions in their body: unswitch the
+ *  loop-invariant conditions, and split loops with linear boundary conditions,
+ *  such as padding, into an interior and a boundary version.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass LoopUnswitching();
+
 }  // namespace transform
 }  // namespace tir
 }  // namespace tvm
@@ -113,6 +113,76 @@ inline Tensor softmax(const Tensor& x, int axis = -1, std::string name = "tensor
       name, tag, attrs);
 }
 
+/*!
+ * \brief Softmax activation computed with one reduction over the input.
+ *
+ * The running maximum and the sum of exponentials rescaled to it are reduced together, so the
+ * input is read once to reduce and once to normalize, and no exp tensor is materialized.
+ *
+ * \param x The input tensor. Can be any dimension
+ * \param axis The channel axis along which softmax is performed
+ * \param name The name of the operation
+ * \param tag The tag to mark the operation
+ *
+ * \return A Tensor whose op member is the softmax operation
+ */
+inline Tensor online_softmax(const Tensor& x, int axis = -1, std::string name = "tensor",
+                             std::string tag = "online_softmax_output") {
+  auto input_shape = x->shape;
+  auto ndim = input_shape.size();
+  if (axis < 0) {
+    axis = ndim + axis;
+  }
+  CHECK_LT(axis, ndim) << "axis parameter should be less than input dim";
+
+  auto k = tvm::te::reduce_axis(Range(0, input_shape[axis]), "k");
+  auto reduced_shape = MakeReduceTargetShape({axis}, x, false, false);
+
+  tvm::Map<String, ObjectRef> attrs;
+  attrs.Set("axis", Integer(axis));
+
+  auto fcombine = [](Array<Var> lhs, Array<Var> rhs) {
+    PrimExpr max_elem = tvm::max(lhs[0], rhs[0]);
+    Array<PrimExpr> result;
+    result.push_back(max_elem);
+    result.push_back(lhs[1] * tvm::exp(lhs[0] - max_elem) + rhs[1] * tvm::exp(rhs[0] - max_elem));
+    return result;
+  };
+  auto fidentity = [](std::vector<DataType> types) {
+    Array<PrimExpr> result;
+    // The lowest finite value rather than -inf, so that two identities combine to zero.
+    result.push_back(tvm::min_value(types[0]));
+    result.push_back(tvm::tir::make_zero(types[1]));
+    return result;
+  };
+  auto reducer = MakeCommReducer(fcombine, fidentity, "online_softmax");
+
+  auto max_expsum = tvm::te::compute(reduced_shape, [&](const Array<Var>& indices) {
+    Array<PrimExpr> eval_range;
+    int arg_counter = 0;
+    for (size_t i = 0; i < ndim; ++i) {
+      if (static_cast<int>(i) == axis)
+        eval_range.push_back(k);
+      else
+        eval_range.push_back(indices[arg_counter++]);
+    }
+    return reducer({x(eval_range), tvm::tir::make_const(x->dtype, 1)}, {k}, nullptr);
+  });
+  Tensor max_elem = max_expsum[0];
+  Tensor expsum = max_expsum[1];
+
+  return tvm::te::compute(
+      input_shape,
+      [&](const Array<Var>& indices) {
+        Array<PrimExpr> non_reduce_indices;
+        for (size_t i = 0; i < ndim; ++i) {
+          if (static_cast<int>(i) != axis) non_reduce_indices.push_back(indices[i]);
+        }
+        return tvm::exp(x(indices) - max_elem(non_reduce_indices)) / expsum(non_reduce_indices);
+      },
+      name, tag, attrs);
+}
+
 /*!
  * \brief Log softmax activation
  *
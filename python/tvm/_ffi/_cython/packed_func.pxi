@@ -23,7 +23,7 @@ from ..base import string_types, py2cerror
 from ..runtime_ctypes import DataType, TVMContext, TVMByteArray, ObjectRValueRef
 
 
-cdef void tvm_callback_finalize(void* fhandle):
+cdef void tvm_callback_finalize(void* fhandle) with gil:
     local_pyfunc = <object>(fhandle)
     Py_DECREF(local_pyfunc)
 
@@ -238,12 +238,17 @@ cdef inline int FuncCall3(void* chandle,
                           int* ret_tcode) except -1:
     cdef TVMValue[3] values
     cdef int[3] tcodes
+    cdef int ret
     nargs = len(args)
     temp_args = []
     for i in range(nargs):
         make_arg(args[i], &values[i], &tcodes[i], temp_args)
-    CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
-                     nargs, ret_val, ret_tcode))
+    # Release the GIL so that packed functions running python callbacks
+    # on worker threads (e.g. parallel lowering) can make progress.
+    with nogil:
+        ret = TVMFuncCall(chandle, &values[0], &tcodes[0],
+                          nargs, ret_val, ret_tcode)
+    CALL(ret)
     return 0
 
 cdef inline int FuncCall(void* chandle,
@@ -258,13 +263,16 @@ cdef inline int FuncCall(void* chandle,
 
     cdef vector[TVMValue] values
     cdef vector[int] tcodes
+    cdef int ret
     values.resize(max(nargs, 1))
     tcodes.resize(max(nargs, 1))
     temp_args = []
     for i in range(nargs):
         make_arg(args[i], &values[i], &tcodes[i], temp_args)
-    CALL(TVMFuncCall(chandle, &values[0], &tcodes[0],
-                     nargs, ret_val, ret_tcode))
+    with nogil:
+        ret = TVMFuncCall(chandle, &values[0], &tcodes[0],
+                          nargs, ret_val, ret_tcode)
+    CALL(ret)
     return 0
 
 
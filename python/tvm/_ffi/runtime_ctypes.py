@@ -262,6 +262,12 @@ class TVMContext(ctypes.Structure):
         return json.loads(self._GetDeviceAttr(
             self.device_type, self.device_id, 8))
 
+    @property
+    def api_version(self):
+        """Return the version of the SDK the device runtime is compiled with."""
+        return self._GetDeviceAttr(
+            self.device_type, self.device_id, 11)
+
     def sync(self):
         """Synchronize until jobs finished at the context."""
         check_call(_LIB.TVMSynchronize(self.device_type, self.device_id, None))
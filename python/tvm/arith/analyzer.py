@@ -88,6 +88,7 @@ class Analyzer:
         self._canonical_simplify = _mod("canonical_simplify")
         self._int_set = _mod("int_set")
         self._enter_constraint_context = _mod("enter_constraint_context")
+        self._enable_memo = _mod("enable_memo")
 
     def const_int_bound(self, expr):
         """Find constant integer bound for expr.
@@ -187,6 +188,20 @@ class Analyzer:
         """
         return self._int_set(expr, dom_map)
 
+    def enable_memo(self, enable=True):
+        """Memoize the results of const_int_bound, modular_set and the
+        simplifiers by the structure of the expression.
+
+        The memo is cleared when a variable is bound or updated, and each
+        constraint scope has its own memo.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to memoize.
+        """
+        self._enable_memo(enable)
+
     def bind(self, var, expr):
         """Bind a variable to the expression.
 
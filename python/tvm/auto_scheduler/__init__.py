@@ -24,15 +24,19 @@ from . import loop_state
 from . import utils
 from . import workload_registry
 from . import feature
+from . import task_scheduler
+from . import distributed
 
 # Shortcut
 from .auto_schedule import SearchTask, TuningOptions, HardwareParams, \
     auto_schedule
 from .compute_dag import ComputeDAG
-from .cost_model import RandomModel, XGBModel
+from .cost_model import RandomModel, GBDTModel, XGBModel
 from .measure import MeasureInput, MeasureResult, LocalBuilder, LocalRunner, RPCRunner, \
     LocalRPCMeasureContext
-from .measure_record import RecordToFile, RecordReader, load_best, \
-    load_records, save_records
+from .measure_record import RecordToFile, RecordReader, IndexedRecordReader, load_best, \
+    load_records, save_records, convert_records_to_indexed
 from .search_policy import EmptyPolicy, SketchPolicy, PreloadMeasuredStates
+from .task_scheduler import TaskScheduler
+from .distributed import DistributedSearch
 from .workload_registry import register_workload, make_workload_key
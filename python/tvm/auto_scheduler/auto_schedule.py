@@ -108,9 +108,15 @@ class TuningOptions(Object):
       Callback functions called after each measurement.
       Candidates:
         - auto_scheduler.RecordToFile
+    measure_pipeline_depth: int = 0
+      The number of built batches that may wait for the runner. A positive value builds the next
+      batches while the current one is being measured, which hides the build time when the
+      programs are measured on other machines (e.g. with RPCRunner). Keep it 0 when measuring
+      on the machine that builds, as the builds would disturb the measurements.
     """
     def __init__(self, num_measure_trials=0, early_stopping=None, num_measures_per_round=64,
-                 verbose=1, builder='local', runner='local', measure_callbacks=None):
+                 verbose=1, builder='local', runner='local', measure_callbacks=None,
+                 measure_pipeline_depth=0):
         if isinstance(builder, str):
             if builder == 'local':
                 builder = LocalBuilder()
@@ -131,7 +137,8 @@ class TuningOptions(Object):
 
         self.__init_handle_by_constructor__(
             _ffi_api.TuningOptions, num_measure_trials, early_stopping or -1,
-            num_measures_per_round, verbose, builder, runner, measure_callbacks)
+            num_measures_per_round, verbose, builder, runner, measure_callbacks,
+            measure_pipeline_depth)
 
 
 def auto_schedule(task, search_policy=None, tuning_options=TuningOptions()):
@@ -22,6 +22,84 @@ import numpy as np
 import tvm._ffi
 from tvm.runtime import Object
 from .. import _ffi_api
+from ..feature import get_per_store_features_from_states
+from ..measure_record import RecordReader
+
+
+def workload_signature(task):
+    """Describe the computation of a task by the per-store features of its naive schedule.
+
+    Parameters
+    ----------
+    task : SearchTask
+        The search task
+
+    Returns
+    -------
+    signature : Optional[np.ndarray]
+        The log-scaled features averaged over the stores, None if the features are unavailable
+    """
+    features = get_per_store_features_from_states([task.compute_dag.init_state], task)[0]
+    features = np.asarray(features, dtype=np.float64)
+    if features.ndim != 2 or features.shape[0] == 0:
+        return None
+    return np.log1p(np.abs(features)).mean(axis=0)
+
+
+def select_similar_records(file_name, tasks, num_similar_workloads=5,
+                           max_records_per_workload=None):
+    """Select the records of the workloads most similar to the tasks from a log file.
+
+    Workloads are compared by the cosine distance of their signatures, see `workload_signature`,
+    and only the records on the same target kind as a task are candidates for it.
+
+    Parameters
+    ----------
+    file_name : str
+        The log file of historical records
+    tasks : List[SearchTask]
+        The new tasks
+    num_similar_workloads : int = 5
+        The number of most similar workloads selected for each task
+    max_records_per_workload : Optional[int]
+        Only keep the last records of each selected workload
+
+    Returns
+    -------
+    inputs : List[MeasureInput]
+        The selected measurement inputs
+    results : List[MeasureResult]
+        The selected measurement results
+    """
+    inputs, results = RecordReader(file_name).read_lines()
+
+    groups = {}
+    for i, inp in enumerate(inputs):
+        groups.setdefault((inp.task.workload_key, inp.task.target.kind.name), []).append(i)
+    signatures = {key: workload_signature(inputs[indices[0]].task)
+                  for key, indices in groups.items()}
+
+    selected = set()
+    for task in tasks:
+        signature = workload_signature(task)
+        if signature is None:
+            continue
+        distances = []
+        for key, other in signatures.items():
+            if key[1] != task.target.kind.name or other is None or other.shape != signature.shape:
+                continue
+            norm = np.linalg.norm(signature) * np.linalg.norm(other)
+            distance = 1 - np.dot(signature, other) / norm if norm > 0 else 1
+            distances.append((distance, key))
+        distances.sort()
+        selected.update(key for _, key in distances[:num_similar_workloads])
+
+    indices = []
+    for key in selected:
+        indices.extend(groups[key][-max_records_per_workload:] if max_records_per_workload
+                       else groups[key])
+    indices.sort()
+    return [inputs[i] for i in indices], [results[i] for i in indices]
 
 
 @tvm._ffi.register_object("auto_scheduler.CostModel")
@@ -64,6 +142,122 @@ class RandomModel(CostModel):
         return [x.value for x in _ffi_api.CostModelPredict(self, search_task, states)]
 
 
+@tvm._ffi.register_object("auto_scheduler.GBDTModel")
+class GBDTModel(CostModel):
+    """A gradient boosted decision tree model trained and evaluated in C++.
+
+    Like :any:`XGBModel`, it predicts a score for every stage from its per-store features and
+    sums them up as the score of a program. It is trained with the same pack-sum square error
+    against the normalized throughputs. Feature extraction, training and prediction all run on
+    multiple threads without calling back into python.
+
+    Parameters
+    ----------
+    num_trees_per_update : int = 50
+        The number of trees added to the ensemble by every update. The ensemble keeps
+        boosting on top of its trees, and is retrained from scratch once it grows too large.
+    max_depth : int = 8
+        The maximum depth of a tree.
+    learning_rate : float = 0.2
+        The shrinkage of every tree.
+    num_warmup_sample : int = 100
+        Predict random scores until more samples than this are measured.
+    seed : Optional[int]
+        The random seed.
+    """
+    def __init__(self, num_trees_per_update=50, max_depth=8, learning_rate=0.2,
+                 num_warmup_sample=100, seed=None):
+        self.__init_handle_by_constructor__(_ffi_api.GBDTModel, num_trees_per_update, max_depth,
+                                            learning_rate, num_warmup_sample,
+                                            43 if seed is None else seed)
+
+    def update(self, inputs, results):
+        """Update the cost model according to new measurement results (training data).
+
+        Parameters
+        ----------
+        inputs : List[MeasureInput]
+            The measurement inputs
+        results : List[MeasureResult]
+            The measurement results
+        """
+        _ffi_api.CostModelUpdate(self, inputs, results)
+
+    def predict(self, search_task, states):
+        """Predict the scores of states
+
+        Parameters
+        ----------
+        search_task : SearchTask
+            The search task of states
+        statse : List[State]
+            The input states
+
+        Returns
+        -------
+        scores: List[float]
+            The predicted scores for all states
+        """
+        return [x.value for x in _ffi_api.CostModelPredict(self, search_task, states)]
+
+    def update_from_file(self, file_name, n_lines=None):
+        """Load measure records from a log file to update the cost model.
+        This function can be used to pre-train the cost model with history log files.
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        n_lines: Optional[int]
+            Only load first n lines of the log file
+        """
+        inputs, results = RecordReader(file_name).read_lines(n_lines)
+        self.update(inputs, results)
+
+    def update_from_history(self, file_name, tasks, num_similar_workloads=5,
+                            max_records_per_workload=None):
+        """Bootstrap the model with the historical records of the workloads most similar to the
+        new tasks on the same target, see `select_similar_records`. The model is trained on the
+        relative performance of the schedules of every workload, so it transfers across workloads
+        and new tasks can skip the random warmup.
+
+        Parameters
+        ----------
+        file_name : str
+            The log file of historical records
+        tasks : List[SearchTask]
+            The new tasks
+        num_similar_workloads : int = 5
+            The number of most similar workloads selected for each task
+        max_records_per_workload : Optional[int]
+            Only use the last records of each selected workload
+        """
+        inputs, results = select_similar_records(file_name, tasks, num_similar_workloads,
+                                                 max_records_per_workload)
+        if inputs:
+            self.update(inputs, results)
+
+    def save(self, file_name: str):
+        """Save the model to a file
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        """
+        _ffi_api.GBDTModelSave(self, file_name)
+
+    def load(self, file_name: str):
+        """Load the model from a file. The loaded model predicts without warming up.
+
+        Parameters
+        ----------
+        file_name: str
+            The filename
+        """
+        _ffi_api.GBDTModelLoad(self, file_name)
+
+
 @tvm._ffi.register_func("auto_scheduler.cost_model.random_fill_float")
 def random_fill_float(size, return_ptr):
     """Fills a c++ float array with random numbers in [0, 1]
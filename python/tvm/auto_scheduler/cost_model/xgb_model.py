@@ -28,7 +28,7 @@ from xgboost.callback import _fmt_metric
 from xgboost.training import aggcv
 
 from tvm.autotvm.tuner.metric import max_curve
-from .cost_model import PythonBasedModel
+from .cost_model import PythonBasedModel, select_similar_records
 from ..feature import get_per_store_features_from_measure_pairs, get_per_store_features_from_states
 from ..measure_record import RecordReader
 
@@ -264,6 +264,29 @@ class XGBModel(PythonBasedModel):
         logger.info("XGBModel: Loaded %s measurement records from %s", len(inputs), file_name)
         self.update(inputs, results)
 
+    def update_from_history(self, file_name, tasks, num_similar_workloads=5,
+                            max_records_per_workload=None):
+        """Bootstrap the model with the historical records of the workloads most similar to the
+        new tasks on the same target. See `GBDTModel.update_from_history`.
+
+        Parameters
+        ----------
+        file_name : str
+            The log file of historical records
+        tasks : List[SearchTask]
+            The new tasks
+        num_similar_workloads : int = 5
+            The number of most similar workloads selected for each task
+        max_records_per_workload : Optional[int]
+            Only use the last records of each selected workload
+        """
+        inputs, results = select_similar_records(file_name, tasks, num_similar_workloads,
+                                                 max_records_per_workload)
+        logger.info("XGBModel: Selected %s similar measurement records from %s",
+                    len(inputs), file_name)
+        if inputs:
+            self.update(inputs, results)
+
     def save(self, file_name: str):
         """Save the model to a file
 
@@ -0,0 +1,260 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+Distributed schedule search over several nodes.
+
+The sketch policy runs its evolutionary search and trains its cost model in a single process,
+only the measurement can be sent to other devices by RPCRunner. This module spreads the search
+itself over a cluster. Every node runs a search worker, an RPC server registered to a tracker:
+
+.. code-block:: bash
+
+    python -m tvm.exec.auto_scheduler_worker --tracker=HOST:PORT --import=my_workloads
+
+:any:`DistributedSearch` is the coordinator. It tunes in rounds, and in every round it sends
+search shards to the workers. A shard is a task, a number of trials and a seed, together with all
+the records measured so far for that task. The worker preloads these records as measured states,
+trains a fresh cost model on them, searches with its own seed so that the shards of a task explore
+different populations, measures the new candidates on its node and returns the new records. The
+coordinator merges them into one log file, so the next round of every shard starts from all the
+measurements and best states found by the others.
+"""
+
+import json
+import os
+import random
+import tempfile
+import threading
+
+import tvm._ffi
+
+from .auto_schedule import SearchTask, TuningOptions, HardwareParams, auto_schedule
+from .compute_dag import ComputeDAG
+from .cost_model import GBDTModel
+from .measure import LocalBuilder, LocalRunner
+from .measure_record import RecordToFile, load_best
+from .search_policy import SketchPolicy, PreloadMeasuredStates
+from .utils import request_remote
+
+
+def _record_workload_key(line):
+    """ Get the workload key of a record line in the log file. """
+    return json.loads(line)["i"][0][0]
+
+
+@tvm._ffi.register_func("auto_scheduler.distributed.search_shard")
+def search_shard(shard_json):
+    """ Run a search shard on this worker. This is called by the coordinator through RPC.
+
+    Parameters
+    ----------
+    shard_json : str
+        The shard encoded in JSON, see `DistributedSearch._make_shard`.
+
+    Returns
+    -------
+    records : str
+        The new measured records, in the format of the log file.
+    """
+    shard = json.loads(shard_json)
+    hardware_params = HardwareParams(*shard["hardware_params"]) \
+        if shard["hardware_params"] is not None else None
+    workload_key = shard["workload_key"]
+    task = SearchTask(ComputeDAG(workload_key), workload_key, tvm.target.create(shard["target"]),
+                      tvm.target.create(shard["target_host"]) if shard["target_host"] else None,
+                      hardware_params)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        shared_log = os.path.join(tmp_dir, "shared.json")
+        new_log = os.path.join(tmp_dir, "new.json")
+        with open(shared_log, "w") as fout:
+            fout.write(shard["records"])
+        open(new_log, "w").close()
+
+        cost_model = GBDTModel(seed=shard["seed"])
+        if shard["records"]:
+            cost_model.update_from_file(shared_log)
+        search_policy = SketchPolicy(task, cost_model, params=shard["search_policy_params"],
+                                     seed=shard["seed"], verbose=shard["verbose"],
+                                     init_search_callbacks=[PreloadMeasuredStates(shared_log)])
+        tuning_options = TuningOptions(
+            num_measure_trials=shard["num_measure_trials"],
+            num_measures_per_round=shard["num_measures_per_round"], verbose=shard["verbose"],
+            builder=LocalBuilder(), runner=LocalRunner(**shard["runner"]),
+            measure_callbacks=[RecordToFile(new_log)])
+        auto_schedule(task, search_policy, tuning_options)
+
+        with open(new_log) as fin:
+            return fin.read()
+
+
+class DistributedSearch:
+    """ The coordinator of a distributed schedule search.
+
+    Parameters
+    ----------
+    tracker_host : str
+        The host address of the RPC tracker the workers are registered to.
+    tracker_port : int
+        The port of the RPC tracker.
+    key : str = "auto_scheduler_worker"
+        The key the workers are registered with.
+    num_workers : int = 1
+        The number of shards to run at the same time, usually the number of workers.
+    priority : int = 1
+        The priority of the worker requests, larger is more prior.
+    shard_timeout : int = 0
+        The timeout of a shard in seconds, 0 for no timeout.
+    runner_options : Optional[Dict[str, Any]]
+        The keyword arguments of the LocalRunner used by the workers to measure programs.
+    search_policy_params : Optional[Dict[str, Any]]
+        The parameters of the SketchPolicy of the workers.
+    seed : Optional[int]
+        The random seed of the shards.
+    verbose : int = 1
+        Verbosity level. 0 for silent, 1 to output information during the search.
+    """
+    def __init__(self, tracker_host, tracker_port, key="auto_scheduler_worker", num_workers=1,
+                 priority=1, shard_timeout=0, runner_options=None, search_policy_params=None,
+                 seed=None, verbose=1):
+        self.tracker_host = tracker_host
+        self.tracker_port = tracker_port
+        self.key = key
+        self.num_workers = num_workers
+        self.priority = priority
+        self.shard_timeout = shard_timeout
+        self.runner_options = runner_options or {}
+        self.search_policy_params = search_policy_params
+        self.rand_gen = random.Random(seed)
+        self.verbose = verbose
+
+    def tune(self, tasks, log_file, num_measure_trials, num_trials_per_shard=64,
+             num_measures_per_round=16):
+        """ Tune the tasks on the workers.
+
+        The records of all the shards are appended to `log_file`, and the search resumes from the
+        records already in it.
+
+        Parameters
+        ----------
+        tasks : List[SearchTask]
+            The search tasks. The workers create them from their workload keys, so the workload
+            functions must be registered on the workers, e.g. by the `--import` option.
+        log_file : str
+            The log file to store the records of all the shards.
+        num_measure_trials : int
+            The number of measurement trials of every task.
+        num_trials_per_shard : int = 64
+            The number of trials of a shard. The records are exchanged after every shard.
+        num_measures_per_round : int = 16
+            The number of programs measured at each search round of a shard.
+
+        Returns
+        -------
+        best : Dict[str, Tuple[MeasureInput, MeasureResult]]
+            The best record of every task, by workload key.
+        """
+        remaining = {task.workload_key: num_measure_trials for task in tasks}
+        if not os.path.exists(log_file):
+            open(log_file, "a").close()
+
+        while True:
+            records = self._load_records(log_file)
+            shards = []
+            pending = [task for task in tasks if remaining[task.workload_key] > 0]
+            # Spread the workers over the tasks, several shards of a task explore different
+            # populations with different seeds
+            while pending and len(shards) < self.num_workers:
+                for task in list(pending):
+                    if len(shards) >= self.num_workers:
+                        break
+                    # A search with less than two trials measures nothing
+                    num_trials = max(2, min(num_trials_per_shard, remaining[task.workload_key]))
+                    remaining[task.workload_key] -= num_trials
+                    if remaining[task.workload_key] <= 0:
+                        pending.remove(task)
+                    shards.append((task, self._make_shard(
+                        task, records.get(task.workload_key, ""), num_trials,
+                        num_measures_per_round)))
+            if not shards:
+                break
+
+            results = [None] * len(shards)
+            def run_shard(index):
+                results[index] = self._run_shard(shards[index][1])
+
+            threads = [threading.Thread(target=run_shard, args=(i,)) for i in range(len(shards))]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+
+            with open(log_file, "a") as fout:
+                for (task, _), new_records in zip(shards, results):
+                    if new_records is None:
+                        continue
+                    fout.write(new_records)
+                    if not new_records:
+                        # The search space of this task is exhausted
+                        remaining[task.workload_key] = 0
+            if self.verbose >= 1:
+                print("Distributed search: %d shards done, %d trials left" %
+                      (len(shards), sum(remaining.values())))
+
+        return {task.workload_key: load_best(log_file, task.workload_key) for task in tasks}
+
+    @staticmethod
+    def _load_records(log_file):
+        """ Group the record lines of the log file by workload key. """
+        records = {}
+        with open(log_file) as fin:
+            for line in fin:
+                if line.strip() and not line.startswith("#"):
+                    key = _record_workload_key(line)
+                    records[key] = records.get(key, "") + line
+        return records
+
+    def _make_shard(self, task, records, num_measure_trials, num_measures_per_round):
+        hardware_params = task.hardware_params
+        return json.dumps({
+            "workload_key": task.workload_key,
+            "target": str(task.target),
+            "target_host": str(task.target_host) if task.target_host is not None else None,
+            "hardware_params": [hardware_params.num_cores, hardware_params.vector_unit_bytes,
+                                hardware_params.cache_line_bytes]
+                               if hardware_params is not None else None,
+            "records": records,
+            "num_measure_trials": num_measure_trials,
+            "num_measures_per_round": num_measures_per_round,
+            "seed": self.rand_gen.randint(1, 1 << 30),
+            "runner": self.runner_options,
+            "search_policy_params": self.search_policy_params,
+            "verbose": self.verbose,
+        })
+
+    def _run_shard(self, shard):
+        """ Run a shard on a free worker, return the new records or None on failure. """
+        try:
+            remote = request_remote(self.key, self.tracker_host, self.tracker_port,
+                                    self.priority, self.shard_timeout)
+            return remote.get_function("auto_scheduler.distributed.search_shard")(shard)
+        # pylint: disable=broad-except
+        except Exception as err:
+            if self.verbose >= 1:
+                print("Distributed search: a shard failed: %s" % err)
+            return None
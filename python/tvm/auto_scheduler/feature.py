@@ -234,6 +234,15 @@ def get_per_store_features_from_states(states: List[Union[State, StateObject]],
     return unpack_feature(byte_arr)[0]
 
 
+def clear_per_store_feature_cache():
+    """Drop all the cached per-store features.
+
+    The features extracted from states are cached by their compute declaration, target and
+    transform steps, so that identical states in later search rounds are not extracted again.
+    """
+    _ffi_api.ClearPerStoreFeatureCache()
+
+
 def get_per_store_feature_names(max_n_bufs: Optional[int] = None) -> List[str]:
     """Get the name of every element in the feature vector. Use this for debug and inspection.
 
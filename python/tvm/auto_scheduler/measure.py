@@ -38,6 +38,8 @@ import traceback
 import tempfile
 import multiprocessing
 
+import numpy as np
+
 import tvm._ffi
 from tvm.runtime import Object, module, ndarray
 from tvm.driver import build_module
@@ -188,6 +190,9 @@ class LocalBuilder(ProgramBuilder):
         Number of threads used to build in parallel.
     build_func : str = 'default'
         The name of registered build function.
+
+    The programs are built with the "tir.InjectPrefetch" option of the PassContext
+    the tuning runs in, with the cache line size of the task's hardware parameters.
     """
 
     def __init__(self,
@@ -227,6 +232,16 @@ class LocalRunner(ProgramRunner):
         will be automatically increased.
     cooldown_interval : float = 0.0
         The cool down interval between two measurements.
+    max_repeat : int = 0
+        The maximum number of repeats in the adaptive measurement mode, which is enabled when
+        this is larger than `repeat`. The code is then measured `repeat` times at a time until
+        the 95% confidence interval of the mean cost is within `confidence_tolerance`, or
+        `max_repeat` repeats are done. Leading warmup outliers are discarded.
+    confidence_tolerance : float = 0.02
+        The relative half width of the confidence interval that stops the adaptive repeats.
+    slow_abort_ratio : float = 0.0
+        In the adaptive mode, stop repeating a program once its cost is surely larger than this
+        ratio times the best cost measured for the same workload. 0 disables the early abort.
     """
 
     def __init__(self,
@@ -234,9 +249,13 @@ class LocalRunner(ProgramRunner):
                  number=3,
                  repeat=1,
                  min_repeat_ms=0,
-                 cooldown_interval=0.0):
+                 cooldown_interval=0.0,
+                 max_repeat=0,
+                 confidence_tolerance=0.02,
+                 slow_abort_ratio=0.0):
         self.__init_handle_by_constructor__(
-            _ffi_api.LocalRunner, timeout, number, repeat, min_repeat_ms, cooldown_interval)
+            _ffi_api.LocalRunner, timeout, number, repeat, min_repeat_ms, cooldown_interval,
+            max_repeat, confidence_tolerance, slow_abort_ratio)
 
 
 @tvm._ffi.register_object("auto_scheduler.RPCRunner")
@@ -280,14 +299,26 @@ class RPCRunner(ProgramRunner):
         will be automatically increased.
     cooldown_interval : float = 0.0
         The cool down interval between two measurements.
+    max_repeat : int = 0
+        The maximum number of repeats in the adaptive measurement mode, which is enabled when
+        this is larger than `repeat`. The code is then measured `repeat` times at a time until
+        the 95% confidence interval of the mean cost is within `confidence_tolerance`, or
+        `max_repeat` repeats are done. Leading warmup outliers are discarded.
+    confidence_tolerance : float = 0.02
+        The relative half width of the confidence interval that stops the adaptive repeats.
+    slow_abort_ratio : float = 0.0
+        In the adaptive mode, stop repeating a program once its cost is surely larger than this
+        ratio times the best cost measured for the same workload. 0 disables the early abort.
     """
 
     def __init__(self, key, host, port,
                  priority=1, n_parallel=1, timeout=10, number=3, repeat=1,
-                 min_repeat_ms=0, cooldown_interval=0.0):
+                 min_repeat_ms=0, cooldown_interval=0.0, max_repeat=0,
+                 confidence_tolerance=0.02, slow_abort_ratio=0.0):
         self.__init_handle_by_constructor__(
             _ffi_api.RPCRunner, key, host, port, priority, n_parallel, timeout,
-            number, repeat, min_repeat_ms, cooldown_interval)
+            number, repeat, min_repeat_ms, cooldown_interval, max_repeat,
+            confidence_tolerance, slow_abort_ratio)
 
         if check_remote(key, host, port, priority, timeout):
             print("Get devices for measurement successfully!")
@@ -331,10 +362,21 @@ class LocalRPCMeasureContext:
         will be automatically increased.
     cooldown_interval : float = 0.0
         The cool down interval between two measurements.
+    max_repeat : int = 0
+        The maximum number of repeats in the adaptive measurement mode, which is enabled when
+        this is larger than `repeat`. The code is then measured `repeat` times at a time until
+        the 95% confidence interval of the mean cost is within `confidence_tolerance`, or
+        `max_repeat` repeats are done. Leading warmup outliers are discarded.
+    confidence_tolerance : float = 0.02
+        The relative half width of the confidence interval that stops the adaptive repeats.
+    slow_abort_ratio : float = 0.0
+        In the adaptive mode, stop repeating a program once its cost is surely larger than this
+        ratio times the best cost measured for the same workload. 0 disables the early abort.
     """
 
     def __init__(self, priority=1, n_parallel=1, timeout=10, number=3, repeat=1,
-                 min_repeat_ms=0, cooldown_interval=0.0):
+                 min_repeat_ms=0, cooldown_interval=0.0, max_repeat=0,
+                 confidence_tolerance=0.02, slow_abort_ratio=0.0):
         ctx = tvm.context("cuda", 0)
         if ctx.exist:
             cuda_arch = "sm_" + "".join(ctx.compute_version.split('.'))
@@ -347,7 +389,8 @@ class LocalRPCMeasureContext:
                              tracker_addr=(self.tracker.host, self.tracker.port))
         self.runner = RPCRunner(device_key, host, self.tracker.port, priority,
                                 n_parallel, timeout, number, repeat,
-                                min_repeat_ms, cooldown_interval)
+                                min_repeat_ms, cooldown_interval, max_repeat,
+                                confidence_tolerance, slow_abort_ratio)
         # Wait for the processes to start
         time.sleep(0.5)
 
@@ -400,7 +443,7 @@ def local_build_worker(index):
     # This can avoid expensive serialization of TVM IR when using multiprocessing.Pool
     if not GLOBAL_BUILD_ARGUMENTS:
         raise ValueError("GLOBAL_BUILD_ARGUMENTS not found")
-    measure_inputs, build_func, timeout, verbose = GLOBAL_BUILD_ARGUMENTS
+    measure_inputs, build_func, timeout, verbose, prefetch_config = GLOBAL_BUILD_ARGUMENTS
     assert isinstance(build_func, str)
 
     if build_func == 'default':
@@ -434,7 +477,14 @@ def local_build_worker(index):
 
             try:
                 # TODO(merrymercy): Port the unroll pass.
-                with transform.PassContext():
+                config = {}
+                if prefetch_config is not None:
+                    config["tir.InjectPrefetch"] = {
+                        "auto_prefetch": prefetch_config.auto_prefetch,
+                        "cache_line_bytes": task.hardware_params.cache_line_bytes,
+                        "prefetch_latency": prefetch_config.prefetch_latency,
+                    }
+                with transform.PassContext(config=config):
                     func = build_module.build(
                         sch, args, target=task.target, target_host=task.target_host)
                 func.export_library(filename, build_func)
@@ -489,7 +539,9 @@ def local_builder_build(inputs, timeout, n_parallel, build_func='default', verbo
     # This can avoid expensive serialization of TVM IR when using multiprocessing.Pool
     global GLOBAL_BUILD_ARGUMENTS
 
-    GLOBAL_BUILD_ARGUMENTS = (inputs, build_func, timeout, verbose)
+    # The prefetch knobs of the caller's PassContext apply to the measured programs.
+    prefetch_config = transform.PassContext.current().config.get("tir.InjectPrefetch", None)
+    GLOBAL_BUILD_ARGUMENTS = (inputs, build_func, timeout, verbose, prefetch_config)
 
     pool = NoDaemonPool(n_parallel)
     tuple_res = pool.map(local_build_worker, range(len(inputs)))
@@ -504,10 +556,114 @@ def local_builder_build(inputs, timeout, n_parallel, build_func='default', verbo
     return results
 
 
+# The 97.5% quantiles of the Student's t-distribution with 1 to 30 degrees of freedom
+T_QUANTILE_975 = (12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042)
+
+# The best mean cost measured by the runners of this process, used by the adaptive measurement
+# to abort slow programs. The keys are (workload_key, target, device key).
+BEST_COSTS = {}
+
+
+def discard_warmup_outliers(costs):
+    """ Drop the leading costs that are far above the median, caused by cold caches or clocks.
+
+    Parameters
+    ----------
+    costs : List[float]
+        The measured costs in the order they were measured.
+
+    Returns
+    -------
+    costs : List[float]
+        The costs without the leading outliers. At least two costs are kept.
+    """
+    if len(costs) < 3:
+        return costs
+    median = np.median(costs)
+    # The median absolute deviation, scaled to estimate the standard deviation
+    deviation = 1.4826 * np.median(np.abs(np.array(costs) - median))
+    bound = median + 3 * max(deviation, 1e-3 * median)
+    start = 0
+    while start < len(costs) - 2 and costs[start] > bound:
+        start += 1
+    return costs[start:]
+
+
+def mean_confidence_interval(costs):
+    """ Compute the mean of the costs and the half width of its 95% confidence interval.
+
+    Parameters
+    ----------
+    costs : List[float]
+        The measured costs, at least two of them.
+
+    Returns
+    -------
+    mean, half_width : Tuple[float, float]
+    """
+    n = len(costs)
+    t_quantile = T_QUANTILE_975[min(n - 1, len(T_QUANTILE_975)) - 1] if n <= 31 else 1.960
+    return np.mean(costs), t_quantile * np.std(costs, ddof=1) / np.sqrt(n)
+
+
+def adaptive_time_costs(time_f, args, repeat, max_repeat, confidence_tolerance,
+                        slow_abort_ratio, best_cost):
+    """ Measure a program `repeat` times at a time until its mean cost is known precisely
+    enough, it is surely slower than the best one, or `max_repeat` repeats are done.
+
+    Parameters
+    ----------
+    time_f : Callable
+        The time evaluator of the program, which measures `repeat` costs per call.
+    args : List[NDArray]
+        The arguments of the program.
+    repeat : int
+        The number of costs measured by every call of `time_f`.
+    max_repeat : int
+        The maximum number of costs to measure.
+    confidence_tolerance : float
+        The relative half width of the confidence interval that stops the measurement.
+    slow_abort_ratio : float
+        Stop once the cost is surely larger than this ratio times `best_cost`. 0 to disable.
+    best_cost : Optional[float]
+        The best cost measured for the same workload.
+
+    Returns
+    -------
+    costs : List[float]
+        The measured costs without the warmup outliers.
+    """
+    costs = []
+    while len(costs) < max_repeat:
+        costs.extend(time_f(*args).results)
+        kept = discard_warmup_outliers(costs)
+        if len(kept) < 2:
+            continue
+        mean, half_width = mean_confidence_interval(kept)
+        if half_width <= confidence_tolerance * mean:
+            break
+        if slow_abort_ratio > 0 and best_cost is not None and \
+                mean - half_width > slow_abort_ratio * best_cost:
+            break
+    return tuple(discard_warmup_outliers(costs))
+
+
+def update_best_costs(key_prefix, inputs, results):
+    """ Record the best mean costs of the successful measurements for the early abort. """
+    for inp, res in zip(inputs, results):
+        if res.error_no == MeasureErrorNo.NO_ERROR:
+            key = (inp.task.workload_key, str(inp.task.target), key_prefix)
+            cost = np.mean([v.value for v in res.costs])
+            if key not in BEST_COSTS or cost < BEST_COSTS[key]:
+                BEST_COSTS[key] = cost
+
+
 @tvm._ffi.register_func("auto_scheduler.local_runner.run")
 def local_run(inputs, build_results,
               timeout=10, number=3, repeat=1, min_repeat_ms=0, cooldown_interval=0,
-              verbose=1):
+              verbose=1, max_repeat=0, confidence_tolerance=0.02, slow_abort_ratio=0.0):
     """
     Run function of LocalRunner to test the performance of the input BuildResults.
 
@@ -540,6 +696,16 @@ def local_run(inputs, build_results,
         The cool down interval between two measurements.
     verbose: int = 1
         Verbosity level. 0 for silent, 1 to output information during program measuring.
+    max_repeat : int = 0
+        The maximum number of repeats in the adaptive measurement mode, which is enabled when
+        this is larger than `repeat`. The code is then measured `repeat` times at a time until
+        the 95% confidence interval of the mean cost is within `confidence_tolerance`, or
+        `max_repeat` repeats are done. Leading warmup outliers are discarded.
+    confidence_tolerance : float = 0.02
+        The relative half width of the confidence interval that stops the adaptive repeats.
+    slow_abort_ratio : float = 0.0
+        In the adaptive mode, stop repeating a program once its cost is surely larger than this
+        ratio times the best cost measured for the same workload. 0 disables the early abort.
 
     Returns
     -------
@@ -548,7 +714,7 @@ def local_run(inputs, build_results,
     """
     max_float = 1e10  # We use 1e10 instead of sys.float_info.max for better readability in log
 
-    def timed_func(inp, build_res):
+    def timed_func(inp, build_res, best_cost):
         tic = time.time()
         error_no = 0
         error_msg = None
@@ -570,7 +736,12 @@ def local_run(inputs, build_results,
                 args = [ndarray.empty(get_const_tuple(x.shape), x.dtype, ctx) for x in
                         build_res.args]
                 ctx.sync()
-                costs = time_f(*args).results
+                if max_repeat > repeat:
+                    costs = adaptive_time_costs(time_f, args, repeat, max_repeat,
+                                                confidence_tolerance, slow_abort_ratio,
+                                                best_cost)
+                else:
+                    costs = time_f(*args).results
             # pylint: disable=broad-except
             except Exception:
                 costs = (max_float,)
@@ -596,8 +767,9 @@ def local_run(inputs, build_results,
             res = (max_float,), build_res.error_no, build_res.error_msg, build_res.time_cost, \
                 time.time()
         else:
+            best_cost = BEST_COSTS.get((inp.task.workload_key, str(inp.task.target), None))
             res = call_func_with_timeout(
-                timeout, timed_func, args=(inp, build_res))
+                timeout, timed_func, args=(inp, build_res, best_cost))
             if isinstance(res, TimeoutError):
                 if verbose >= 1:
                     print("*T", end="")  # Run timeout
@@ -608,6 +780,9 @@ def local_run(inputs, build_results,
     if verbose >= 1:
         print("")
 
+    if max_repeat > repeat:
+        update_best_costs(None, inputs, measure_results)
+
     return measure_results
 
 
@@ -626,7 +801,8 @@ def rpc_run_worker(index):
     """
     global GLOBAL_RUN_ARGUMENTS
     inputs, build_results, key, host, port, priority, timeout, number, \
-        repeat, min_repeat_ms, cooldown_interval, verbose = GLOBAL_RUN_ARGUMENTS
+        repeat, min_repeat_ms, cooldown_interval, verbose, max_repeat, confidence_tolerance, \
+        slow_abort_ratio = GLOBAL_RUN_ARGUMENTS
 
     max_float = 1e10  # We use 1e10 instead of sys.float_info.max for better readability in log
     inp = inputs[index]
@@ -662,11 +838,22 @@ def rpc_run_worker(index):
                         build_res.args]
                 ctx.sync()
 
-                costs = time_f(*args).results
-                # clean up remote files
-                remote.remove(build_res.filename)
-                remote.remove(os.path.splitext(build_res.filename)[0] + '.so')
-                remote.remove('')
+                if max_repeat > repeat:
+                    best_cost = BEST_COSTS.get((inp.task.workload_key, str(inp.task.target),
+                                                key))
+                    costs = adaptive_time_costs(time_f, args, repeat, max_repeat,
+                                                confidence_tolerance, slow_abort_ratio,
+                                                best_cost)
+                else:
+                    costs = time_f(*args).results
+                # clean up remote files, pipelining the requests instead of
+                # waiting for each of them in turn
+                remove = remote.get_function("tvm.rpc.server.remove")
+                waits = [remote.submit(remove, path) for path in
+                         (build_res.filename,
+                          os.path.splitext(build_res.filename)[0] + '.so', '')]
+                for wait in waits:
+                    wait()
             # pylint: disable=broad-except
             except Exception:
                 costs = (max_float,)
@@ -698,7 +885,8 @@ def rpc_run_worker(index):
 @tvm._ffi.register_func("auto_scheduler.rpc_runner.run")
 def rpc_runner_run(inputs, build_results, key, host, port,
                    priority=1, n_parallel=1, timeout=10, number=3, repeat=1, min_repeat_ms=0,
-                   cooldown_interval=0.0, verbose=1):
+                   cooldown_interval=0.0, verbose=1, max_repeat=0, confidence_tolerance=0.02,
+                   slow_abort_ratio=0.0):
     """ Run function of RPCRunner to test the performance of the input BuildResults.
 
     Parameters
@@ -740,6 +928,16 @@ def rpc_runner_run(inputs, build_results, key, host, port,
         The cool down interval between two measurements.
     verbose: int = 1
         Verbosity level. 0 for silent, 1 to output information during program measuring.
+    max_repeat : int = 0
+        The maximum number of repeats in the adaptive measurement mode, which is enabled when
+        this is larger than `repeat`. The code is then measured `repeat` times at a time until
+        the 95% confidence interval of the mean cost is within `confidence_tolerance`, or
+        `max_repeat` repeats are done. Leading warmup outliers are discarded.
+    confidence_tolerance : float = 0.02
+        The relative half width of the confidence interval that stops the adaptive repeats.
+    slow_abort_ratio : float = 0.0
+        In the adaptive mode, stop repeating a program once its cost is surely larger than this
+        ratio times the best cost measured for the same workload. 0 disables the early abort.
 
     Returns
     -------
@@ -748,7 +946,8 @@ def rpc_runner_run(inputs, build_results, key, host, port,
     """
     global GLOBAL_RUN_ARGUMENTS
     GLOBAL_RUN_ARGUMENTS = (inputs, build_results, key, host, port, priority, timeout, number,
-                            repeat, min_repeat_ms, cooldown_interval, verbose)
+                            repeat, min_repeat_ms, cooldown_interval, verbose, max_repeat,
+                            confidence_tolerance, slow_abort_ratio)
 
     assert len(inputs) == len(build_results), \
         "Measure input size should be equal to build results"
@@ -765,4 +964,7 @@ def rpc_runner_run(inputs, build_results, key, host, port,
     if verbose >= 1:
         print("")
 
+    if max_repeat > repeat:
+        update_best_costs(key, inputs, results)
+
     return results
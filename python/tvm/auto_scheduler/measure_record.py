@@ -81,6 +81,88 @@ class RecordReader(Object):
             yield ret[0], ret[1]  # (input, result)
 
 
+@tvm._ffi.register_object("auto_scheduler.IndexedRecordReader")
+class IndexedRecordReader(Object):
+    """
+    Reader of the indexed binary log file made by :any:`convert_records_to_indexed`.
+
+    The file is memory-mapped, and the records of a workload are looked up in its index,
+    so reading the best records does not scan or parse the whole log.
+
+    Parameters
+    ----------
+    filename : str
+        File name for this reader to load log from.
+    """
+    def __init__(self, filename):
+        self.__init_handle_by_constructor__(_ffi_api.IndexedRecordReader, filename)
+
+    def top_k(self, workload_key, k=1, target=None):
+        """ Read the best records of a workload.
+
+        Parameters
+        ----------
+        workload_key : str
+            The workload key of the compute declaration.
+        k : Optional[int] = 1
+            The maximum number of records. None to read all the successful records.
+        target : Optional[tvm.target.Target]
+            Only read the records of the same target kind. None for all targets.
+
+        Returns
+        -------
+        inputs : List[MeasureInput]
+            The MeasureInputs of the successful measurements, from the lowest mean cost.
+        results : List[MeasureResult]
+            The corresponding MeasureResults.
+        """
+        inputs, results = _ffi_api.IndexedRecordReaderReadTopK(
+            self, workload_key, -1 if k is None else k, target.kind.name if target else "")
+        return inputs, results
+
+    def workload_keys(self):
+        """ Get the workload keys in the log file.
+
+        Returns
+        -------
+        keys : List[str]
+            The workload keys.
+        """
+        return list(_ffi_api.IndexedRecordReaderWorkloadKeys(self))
+
+
+def convert_records_to_indexed(json_filename, indexed_filename):
+    """
+    Convert a json log file to the indexed binary format read by :any:`IndexedRecordReader`.
+    The records are grouped by workload key and sorted by their mean cost in the index.
+
+    Parameters
+    ----------
+    json_filename : str
+        File name of the json log.
+    indexed_filename : str
+        File name to write the indexed log to.
+    """
+    _ffi_api.ConvertRecordsToIndexed(json_filename, indexed_filename)
+
+
+def is_indexed_record_file(filename):
+    """
+    Check whether a log file is in the indexed binary format.
+
+    Parameters
+    ----------
+    filename : str
+        File name of the log.
+
+    Returns
+    -------
+    ret : bool
+        Whether the file is an indexed log.
+    """
+    return bool(_ffi_api.IsIndexedRecordFile(filename))
+
+
 def load_records(filename):
     """
     Load measurement records from a file.
@@ -119,7 +201,8 @@ def load_best(filename, workload_key=None, target=None):
     Parameters
     ----------
     filename : str
-        File name to load log from.
+        File name to load log from. An indexed log made by `convert_records_to_indexed` is
+        looked up without scanning the file.
     workload_key : Optional[str]
         The workload key of the compute declaration.
         With `None`, this retuns the best measure pair of all workloads.
@@ -134,11 +217,24 @@ def load_best(filename, workload_key=None, target=None):
     result : MeasureResult
         The best State's MeasureResult from this log fine.
     """
-    log_reader = RecordReader(filename)
     best_cost = 1e30
     best_inp = None
     best_res = None
 
+    if is_indexed_record_file(filename):
+        indexed_reader = IndexedRecordReader(filename)
+        keys = [workload_key] if workload_key else indexed_reader.workload_keys()
+        for key in keys:
+            inputs, results = indexed_reader.top_k(key, 1, target)
+            if inputs:
+                cost = np.mean([v.value for v in results[0].costs])
+                if cost < best_cost:
+                    best_cost = cost
+                    best_inp = inputs[0]
+                    best_res = results[0]
+        return best_inp, best_res
+
+    log_reader = RecordReader(filename)
     for inp, res in log_reader:
         if res.error_no != MeasureErrorNo.NO_ERROR:
             continue
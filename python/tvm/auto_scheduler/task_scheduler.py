@@ -0,0 +1,86 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+The task scheduler that allocates the measurement trials among several search tasks.
+
+A network is usually partitioned into many search tasks with very different contributions to its
+end-to-end latency. Instead of tuning them one after another, the task scheduler runs one search
+round at a time and always picks the task whose next round is expected to reduce the weighted
+total latency the most. All the tasks share one measurer, and by default their search policies
+share one cost model, so what is learned on one task helps the others.
+"""
+
+import random
+
+import tvm._ffi
+from tvm.runtime import Object
+
+from .auto_schedule import TuningOptions
+from .cost_model import GBDTModel
+from .search_policy import SketchPolicy
+from . import _ffi_api
+
+
+@tvm._ffi.register_object("auto_scheduler.TaskScheduler")
+class TaskScheduler(Object):
+    """ The gradient based task scheduler.
+
+    Parameters
+    ----------
+    tasks : List[SearchTask]
+        The search tasks.
+    task_weights : Optional[List[float]]
+        The weight of each task in the objective, usually the number of times the task appears in
+        the network. Every task weights 1 if not given.
+    search_policies : Optional[List[SearchPolicy]]
+        The search policy of each task. If not given, every task uses a SketchPolicy and all of
+        them share one GBDTModel.
+    alpha : float = 0.2
+        The weight of the backward gradient, the latency improvement over the last rounds of a
+        task, against the forward gradient, the expected improvement of its next round.
+    backward_window_size : int = 3
+        The number of search rounds used to compute the backward gradient.
+    eps_random : float = 0.05
+        The probability to pick a random task instead of the one with the best gradient.
+    seed : Optional[int]
+        The random seed of the task selection.
+    verbose : int = 1
+        Verbosity level. 0 for silent, 1 to output information during the tuning.
+    """
+    def __init__(self, tasks, task_weights=None, search_policies=None, alpha=0.2,
+                 backward_window_size=3, eps_random=0.05, seed=None, verbose=1):
+        if search_policies is None:
+            cost_model = GBDTModel()
+            search_policies = [SketchPolicy(task, cost_model, verbose=verbose) for task in tasks]
+        task_weights = [float(w) for w in task_weights] if task_weights is not None else []
+
+        self.__init_handle_by_constructor__(
+            _ffi_api.TaskScheduler, tasks, search_policies, task_weights, alpha,
+            backward_window_size, eps_random, seed or random.randint(1, 1 << 30), verbose)
+
+    def tune(self, tuning_options=TuningOptions()):
+        """ Tune all the tasks.
+
+        Parameters
+        ----------
+        tuning_options : TuningOptions
+            Tuning and measurement options. `num_measure_trials` is the total number of trials of
+            all tasks, `early_stopping` applies to every task separately. Save the measured
+            records with `measure_callbacks` to apply the best schedules afterwards.
+        """
+        _ffi_api.TaskSchedulerTune(self, tuning_options)
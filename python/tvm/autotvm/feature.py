@@ -59,11 +59,24 @@ try:
         "autotvm.feature.GetItervarFeature")
     _get_itervar_feature_flatten = tvm._ffi.get_global_func(
         "autotvm.feature.GetItervarFeatureFlatten")
+    _get_itervar_feature_flatten_batch = tvm._ffi.get_global_func(
+        "autotvm.feature.GetItervarFeatureFlattenBatch")
+    _get_buffer_curve_sample_flatten_batch = tvm._ffi.get_global_func(
+        "autotvm.feature.GetCurveSampleFeatureFlattenBatch")
 except ValueError as e:
     def raise_error(*args, **kwargs):  # pylint: disable=unused-argument
         raise RuntimeError("Cannot load autotvm c++ API")
     _get_buffer_curve_sample_flatten = _get_itervar_feature = _get_itervar_feature_flatten = \
-        raise_error
+        _get_itervar_feature_flatten_batch = _get_buffer_curve_sample_flatten_batch = raise_error
+
+
+def _unpack_feature_matrix(byte_arr):
+    """Unpack the feature matrix returned by the batch extraction APIs"""
+    n_rows, n_cols = struct.unpack('2i', byte_arr[:8])
+    if n_rows * n_cols == 0:
+        return np.zeros((n_rows, n_cols), dtype=np.float32)
+    return np.frombuffer(byte_arr, dtype=np.float32, offset=8).reshape(n_rows, n_cols)
+
 
 def get_itervar_feature(sch, args, take_log=False):
     """get features of iter vars
@@ -206,3 +219,44 @@ def get_buffer_curve_sample_flatten(sch, args, sample_n=30):
     feas = _get_buffer_curve_sample_flatten(stmt, sample_n, False)
     feas = struct.unpack('%df' % (len(feas)//4), feas)
     return feas
+
+
+def get_itervar_feature_flatten_batch(stmts, take_log=True):
+    """get flatten features of iter vars for a batch of lowered statements.
+    The statements are processed in parallel in C++, which avoids a python process pool.
+
+    Parameters
+    ----------
+    stmts: List[tvm.tir.Stmt]
+        the statements lowered by `ana_lower`
+    take_log: bool
+        whether take log of numerical statics
+
+    Returns
+    -------
+    features: np.ndarray
+        two-dimensional matrix with one row per statement,
+        shorter rows are padded with zeros
+    """
+    return _unpack_feature_matrix(_get_itervar_feature_flatten_batch(stmts, take_log))
+
+
+def get_buffer_curve_sample_flatten_batch(stmts, sample_n=30):
+    """
+    Get flatten curve sample feature (relation feature) for a batch of lowered statements.
+    The statements are processed in parallel in C++, which avoids a python process pool.
+
+    Parameters
+    ----------
+    stmts: List[tvm.tir.Stmt]
+        the statements lowered by `ana_lower`
+    sample_n: int
+        number of sample points along one dimension
+
+    Returns
+    -------
+    features: np.ndarray
+        two-dimensional matrix with one row per statement,
+        shorter rows are padded with zeros
+    """
+    return _unpack_feature_matrix(_get_buffer_curve_sample_flatten_batch(stmts, sample_n))
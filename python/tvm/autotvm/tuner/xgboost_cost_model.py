@@ -68,9 +68,13 @@ class XGBoostCostModel(CostModel):
         If is not none, the cost model will print training log every `log_interval` iterations.
     upper_model: XGBoostCostModel, optional
         The upper model used in transfer learning
+    batch_extract: bool, optional
+        If is True, the 'itervar' and 'curve' features of the configs are lowered in this
+        process and extracted together by one parallel C++ call, instead of sending every
+        config to a process pool. This saves the pickling overhead when lowering is cheap.
     """
     def __init__(self, task, feature_type, loss_type, num_threads=None, log_interval=25,
-                 upper_model=None):
+                 upper_model=None, batch_extract=False):
         super(XGBoostCostModel, self).__init__()
 
         if xgb is None:
@@ -86,6 +90,7 @@ class XGBoostCostModel(CostModel):
         self.loss_type = loss_type
         self.num_threads = num_threads
         self.log_interval = log_interval
+        self.batch_extract = batch_extract and feature_type in ('itervar', 'curve')
 
         if loss_type == 'reg':
             self.xgb_params = {
@@ -292,7 +297,7 @@ class XGBoostCostModel(CostModel):
 
     def spawn_base_model(self):
         return XGBoostCostModel(self.task, self.fea_type, self.loss_type,
-                                self.num_threads, self.log_interval, self)
+                                self.num_threads, self.log_interval, self, self.batch_extract)
 
     def _get_feature(self, indexes):
         """get features for indexes, run extraction if we do not have cache for them"""
@@ -306,8 +311,12 @@ class XGBoostCostModel(CostModel):
         need_extract = [x for x in indexes if x not in fea_cache]
 
         if need_extract:
-            pool = self._get_pool()
-            feas = pool.map(self.feature_extract_func, need_extract)
+            if self.batch_extract:
+                feas = _extract_feature_index_batch(self.task, self.target, self.space,
+                                                    need_extract, self.fea_type)
+            else:
+                pool = self._get_pool()
+                feas = pool.map(self.feature_extract_func, need_extract)
             for i, fea in zip(need_extract, feas):
                 fea_cache[i] = fea
 
@@ -361,6 +370,38 @@ def _extract_itervar_feature_log(arg):
     except Exception:  # pylint: disable=broad-except
         return None
 
+def _extract_feature_index_batch(task, target, space, indexes, feature_type):
+    """extract iteration var or sampled curve features for indexes in space.
+    Lower all the configs in this process, then extract their features in parallel in C++"""
+    stmts, others, valid = [], [], []
+    for index in indexes:
+        try:
+            config = space.get(index)
+            with target:
+                sch, args = task.instantiate(config)
+            stmts.append(feature.ana_lower(sch, args, simple_mode=True))
+            others.append(list(config.get_other_option().values()))
+            valid.append(True)
+        except Exception:  # pylint: disable=broad-except
+            valid.append(False)
+
+    if not stmts:
+        return [None] * len(indexes)
+    if feature_type == 'itervar':
+        feas = feature.get_itervar_feature_flatten_batch(stmts, take_log=True)
+    else:
+        feas = feature.get_buffer_curve_sample_flatten_batch(stmts, sample_n=20)
+
+    ret = []
+    row = 0
+    for is_valid in valid:
+        if is_valid:
+            ret.append(np.concatenate((feas[row], others[row])))
+            row += 1
+        else:
+            ret.append(None)
+    return ret
+
 def _extract_knob_feature_index(index):
     """extract knob feature for an index in extract_space"""
     try:
@@ -67,15 +67,21 @@ class XGBTuner(ModelBasedTuner):
         The verbose level.
         If is 0, output nothing.
         Otherwise, output debug information every `verbose` iterations.
+
+    batch_extract: bool, optional
+        If is True, extract the 'itervar' and 'curve' features of a batch of configs with one
+        parallel C++ call instead of a process pool. See XGBoostCostModel.
     """
     def __init__(self, task, plan_size=64,
                  feature_type='itervar', loss_type='rank', num_threads=None,
-                 optimizer='sa', diversity_filter_ratio=None, log_interval=50):
+                 optimizer='sa', diversity_filter_ratio=None, log_interval=50,
+                 batch_extract=False):
         cost_model = XGBoostCostModel(task,
                                       feature_type=feature_type,
                                       loss_type=loss_type,
                                       num_threads=num_threads,
-                                      log_interval=log_interval // 2)
+                                      log_interval=log_interval // 2,
+                                      batch_extract=batch_extract)
         if optimizer == 'sa':
             optimizer = SimulatedAnnealingOptimizer(task, log_interval=log_interval)
         else:
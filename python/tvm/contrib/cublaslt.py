@@ -18,6 +18,9 @@
 import tvm
 from tvm import te
 
+# Activations of the dense epilogue, as numbered by the runtime.
+_ACTIVATIONS = {"none": 0, "relu": 1, "gelu": 2}
+
 
 def matmul(lhs, rhs, transa=False, transb=False, n=0, m=0, dtype=None):
     """Create an extern op that compute matrix mult of A and rhs with cuBLAS
@@ -48,3 +51,70 @@ def matmul(lhs, rhs, transa=False, transb=False, n=0, m=0, dtype=None):
         lambda ins, outs: tvm.tir.call_packed(
             "tvm.contrib.cublaslt.matmul",
             ins[0], ins[1], outs[0], transa, transb), dtype=dtype, name="C")
+
+
+def is_available():
+    """Whether TVM is built with cuBLASLt.
+
+    Returns
+    -------
+    available : bool
+        Whether "tvm.contrib.cublaslt.dense" is registered.
+    """
+    return tvm.get_global_func("tvm.contrib.cublaslt.dense", True) is not None
+
+
+def supports_epilogue(activation, has_bias=True):
+    """Whether the cuBLASLt runtime can fuse the activation and bias into dense.
+
+    Parameters
+    ----------
+    activation : str
+        The activation, one of "none", "relu" and "gelu".
+    has_bias : bool
+        Whether a bias is added before the activation.
+
+    Returns
+    -------
+    supported : bool
+        False as well when TVM is built without cuBLASLt.
+    """
+    func = tvm.get_global_func("tvm.contrib.cublaslt.supports_epilogue", True)
+    return func is not None and bool(func(_ACTIVATIONS[activation], has_bias))
+
+
+def dense(data, weight, bias=None, activation="none", dtype=None):
+    """Create an extern op that computes dense with cuBLASLt, fusing the bias add
+    and activation into the GEMM epilogue.
+
+    float16 and float32 inputs produce the same type. int8 inputs produce int32
+    and run on tensor cores, without an epilogue.
+
+    Parameters
+    ----------
+    data : Tensor
+        2-D with shape [batch, in_dim]
+    weight : Tensor
+        2-D with shape [out_dim, in_dim]
+    bias : Tensor, optional
+        1-D with shape [out_dim]
+    activation : str
+        The activation after the bias add, one of "none", "relu" and "gelu".
+    dtype : str, optional
+        The output type
+
+    Returns
+    -------
+    C : Tensor
+        2-D with shape [batch, out_dim]
+    """
+    batch = data.shape[0]
+    out_dim = weight.shape[0]
+    if dtype is None:
+        dtype = "int32" if data.dtype == "int8" else data.dtype
+    inputs = [data, weight] if bias is None else [data, weight, bias]
+    return te.extern(
+        (batch, out_dim), inputs,
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.cublaslt.dense",
+            ins[0], ins[1], outs[0], _ACTIVATIONS[activation], *ins[2:]), dtype=dtype, name="C")
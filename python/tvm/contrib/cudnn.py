@@ -331,7 +331,10 @@ def conv_forward(x,
         2: CUDNN_TENSOR_NCHW_VECT_C
     algo: int
         Forward algorithm, get index from ```algo_to_index``` function
-        if algo == -1, the best algo will be chosen by CUDNN
+        if algo == -1, the best algo will be chosen by CUDNN at runtime, once per
+        input shape. The search only considers algorithms whose workspace fits in
+        TVM_CUDNN_WORKSPACE_LIMIT bytes, and its results are kept in the file
+        named by TVM_CUDNN_ALGO_CACHE when that environment variable is set.
     conv_dtype: str
         convolution type
     groups: int
@@ -357,23 +360,11 @@ def conv_forward(x,
                                x.dtype,
                                conv_dtype,
                                groups)
-    if algo == -1:
+    if algo == -1 and tensor_format == 1 and conv_dtype == "int32":
         # For now if we try to call `cudnnFindConvolutionForwardAlgorithm` when
         # using INT8 data type, CuDNN will crash down.
         # On the other hand, CuDNN only support IMPLICIT_PRECOMP_GEMM at NHWC format
-        if tensor_format == 1 and conv_dtype == "int32":
-            algo = 1
-        else:
-            algo = conv_find_algo(tensor_format,
-                                  pad,
-                                  stride,
-                                  dilation,
-                                  list(x.shape),
-                                  list(w.shape),
-                                  oshape,
-                                  x.dtype,
-                                  conv_dtype,
-                                  groups)
+        algo = 1
 
     if dims == 4:
         return te.extern(
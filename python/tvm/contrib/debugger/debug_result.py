@@ -24,6 +24,10 @@ import tvm
 
 GRAPH_DUMP_FILE_NAME = '_tvmdbg_graph_dump.json'
 CHROME_TRACE_FILE_NAME = "_tvmdbg_execution_trace.json"
+COUNTERS_FILE_NAME = "_tvmdbg_counters.json"
+TIMELINE_FILE_NAME = "_tvmdbg_timeline.json"
+# Bytes moved from memory by each cache miss, used to estimate the bandwidth.
+CACHE_LINE_BYTES = 64
 
 ChromeTraceEvent = collections.namedtuple(
     'ChromeTraceEvent',
@@ -53,6 +57,7 @@ class DebugResult(object):
         self._dump_path = dump_path
         self._output_tensor_list = []
         self._time_list = []
+        self._counter_list = []
         json_obj = self._parse_graph(graph_json)
         # dump the json information
         self._dump_graph_json(json_obj)
@@ -192,6 +197,40 @@ class DebugResult(object):
         with open(os.path.join(self._dump_path, CHROME_TRACE_FILE_NAME), "w") as trace_f:
             json.dump(result, trace_f)
 
+    def dump_timeline(self, timeline):
+        """Dump the timeline of a run, with the storage allocations, the stream
+        of each node and the data copies, in the Chrome trace.json format.
+
+        Parameters
+        ----------
+        timeline : str
+            The timeline returned by the debug runtime.
+        """
+        with open(os.path.join(self._dump_path, TIMELINE_FILE_NAME), "w") as timeline_f:
+            timeline_f.write(timeline)
+
+    def dump_counters(self):
+        """Dump the per node hardware counters next to their timings in json format.
+
+        The memory bandwidth is estimated from the cache misses. The static roofline
+        estimate of the node is added when the graph carries it.
+        """
+        result = []
+        for node, time, counters in zip(self._nodes_list, self._time_list, self._counter_list):
+            entry = {"name": node['name'], "op": node['op'], "time_us": time[0] * 1e6}
+            entry.update(counters)
+            for key in ["flops", "bytes.global", "arithmetic_intensity"]:
+                if key in node.get('attrs', {}):
+                    entry[key] = float(node['attrs'][key])
+            if "flops" in entry and time[0] > 0:
+                entry["gflops"] = entry["flops"] / time[0] / 1e9
+            if "cache_misses" in counters and time[0] > 0:
+                entry["memory_bandwidth_gbps"] = \
+                    counters["cache_misses"] * CACHE_LINE_BYTES / time[0] / 1e9
+            result.append(entry)
+        with open(os.path.join(self._dump_path, COUNTERS_FILE_NAME), "w") as counters_f:
+            json.dump(result, counters_f, indent=4)
+
     def _dump_graph_json(self, graph):
         """Dump json formatted graph.
 
@@ -205,10 +244,40 @@ class DebugResult(object):
         with open(os.path.join(self._dump_path, graph_dump_file_name), 'w') as outfile:
             json.dump(graph, outfile, indent=4, sort_keys=False)
 
+    @staticmethod
+    def _get_roofline(node, time):
+        """Get the achieved GFLOP/s and the arithmetic intensity of a node from the
+        static roofline estimate the graph codegen stores in its attributes.
+
+        Parameters
+        ----------
+        node : dict
+            The graph node.
+
+        time : float
+            The measured time of the node in seconds.
+
+        Returns
+        -------
+        gflops : float or str
+            The achieved GFLOP/s, "-" when the node has no estimate.
+
+        intensity : float or str
+            The flops per byte of global memory traffic, "-" when the node has no estimate.
+        """
+        attrs = node.get('attrs', {})
+        if "flops" not in attrs or "arithmetic_intensity" not in attrs:
+            return "-", "-"
+        flops = float(attrs["flops"])
+        gflops = round(flops / time / 1e9, 3) if time > 0 else "-"
+        return gflops, round(float(attrs["arithmetic_intensity"]), 3)
+
     def get_debug_result(self, sort_by_time=True):
         """Return the debugger result"""
-        header = ["Node Name", "Ops", "Time(us)", "Time(%)", "Shape", "Inputs", "Outputs"]
-        lines = ["---------", "---", "--------", "-------", "-----", "------", "-------"]
+        header = ["Node Name", "Ops", "Time(us)", "Time(%)", "Shape", "Inputs", "Outputs",
+                  "GFLOP/s", "Flops/Byte"]
+        lines = ["---------", "---", "--------", "-------", "-----", "------", "-------",
+                 "-------", "----------"]
         eid = 0
         data = []
         total_time = sum(time[0] for time in self._time_list)
@@ -225,7 +294,9 @@ class DebugResult(object):
                 time_percent = round(((time[0] / total_time) * 100), 3)
                 inputs = str(node['attrs']['num_inputs'])
                 outputs = str(node['attrs']['num_outputs'])
-                node_data = [name, op, time_us, time_percent, shape, inputs, outputs]
+                gflops, intensity = self._get_roofline(node, time[0])
+                node_data = [name, op, time_us, time_percent, shape, inputs, outputs,
+                             gflops, intensity]
                 data.append(node_data)
                 eid += 1
 
@@ -234,7 +305,7 @@ class DebugResult(object):
             data = sorted(data, key=lambda x: x[2], reverse=True)
             # Insert a row for total time at the end.
             rounded_total_time = round(total_time * 1000000, 3)
-            data.append(["Total_time", "-", rounded_total_time, "-", "-", "-", "-", "-"])
+            data.append(["Total_time", "-", rounded_total_time, "-", "-", "-", "-", "-", "-"])
 
         fmt = ""
         for i, _ in enumerate(header):
@@ -101,6 +101,10 @@ class GraphModuleDebug(graph_runtime.GraphModule):
         self._dump_path = None
         self._get_output_by_layer = module["get_output_by_layer"]
         self._run_individual = module["run_individual"]
+        self._run_individual_counters = module["run_individual_counters"]
+        self._run_timeline = module["run_timeline"]
+        self.collect_counters = False
+        self.collect_timeline = False
         graph_runtime.GraphModule.__init__(self, module)
         self._create_debug_env(graph_json_str, ctx)
 
@@ -179,6 +183,8 @@ class GraphModuleDebug(graph_runtime.GraphModule):
         self.debug_datum._time_list = [
             [float(t) * 1e-6] for t in self.run_individual(10, 1, 1)
         ]
+        if self.collect_counters:
+            self.debug_datum._counter_list = self.run_individual_counters(10)
         for i, node in enumerate(self.debug_datum.get_graph_nodes()):
             num_outputs = self.debug_datum.get_graph_node_output_num(node)
             for j in range(num_outputs):
@@ -230,10 +236,15 @@ class GraphModuleDebug(graph_runtime.GraphModule):
 
         # Step 1. Execute the graph
         self._run_debug()
+        self._launched_inputs, self._pending_inputs = self._pending_inputs, []
         # Step 2. Dump the output tensors to the dump folder
         self.debug_datum.dump_output_tensor()
         # Step 3. Dump the Chrome trace to the dump folder
         self.debug_datum.dump_chrome_trace()
+        if self.collect_timeline:
+            self.debug_datum.dump_timeline(self.run_timeline())
+        if self.collect_counters:
+            self.debug_datum.dump_counters()
         # Step 4. Display the collected information
         self.debug_datum.display_debug_result()
 
@@ -241,6 +252,39 @@ class GraphModuleDebug(graph_runtime.GraphModule):
         ret = self._run_individual(number, repeat, min_repeat_ms)
         return ret.strip(",").split(",") if ret else []
 
+    def run_individual_counters(self, number):
+        """Collect the hardware performance counters of each node.
+
+        Counters are read with perf_event on Linux for nodes running on the CPU.
+
+        Parameters
+        ----------
+        number : int
+            The number of runs each node's counts are averaged over.
+
+        Returns
+        -------
+        counters : list of dict of str to float
+            The counters of each node, empty if they are not available.
+        """
+        ret = self._run_individual_counters(number)
+        if not ret:
+            return []
+        lines = ret.strip().split("\n")
+        names = lines[0].split(",")
+        return [dict(zip(names, [float(v) for v in line.split(",")])) for line in lines[1:]]
+
+    def run_timeline(self):
+        """Run the graph once and record the timeline of its nodes.
+
+        Returns
+        -------
+        timeline : str
+            The storage allocations, nodes and data copies of the run, with the
+            device and stream of each, in the Chrome trace event JSON format.
+        """
+        return self._run_timeline()
+
     def exit(self):
         """Exits the dump folder and all its contents"""
         self._remove_dump_root()
@@ -0,0 +1,97 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Dynamic batching of single-sample requests for graph runtimes and VMs."""
+import tvm._ffi
+from tvm.contrib import graph_runtime
+from tvm.runtime import vm as _vm
+
+
+def create(executor, max_batch, timeout_ms=1.0, input_names=None, func_name="main"):
+    """Create a dynamic batcher around an executor built for a batch of max_batch.
+
+    Requests from concurrent callers are collected until max_batch of them
+    arrived or the oldest one waited timeout_ms, then run as one batch. The
+    inputs of the requests are copied into pre-allocated buffers along the
+    first axis and the rows of the outputs are scattered back.
+
+    Parameters
+    ----------
+    executor : GraphModule or VirtualMachine or tvm.runtime.Module
+        The executor, built with a batch of max_batch along the first axis
+        of its batched inputs and outputs.
+
+    max_batch : int
+        The number of requests run together.
+
+    timeout_ms : float
+        How long the oldest request waits for others to join its batch.
+
+    input_names : list of str, optional
+        The batched inputs of a graph runtime, in request order.
+        Params and other inputs keep the value set on the executor.
+
+    func_name : str
+        The function run by a VM, whose arguments are all batched.
+
+    Returns
+    -------
+    batcher : DynamicBatcher
+        The batcher, whose infer can be called from several threads.
+    """
+    if isinstance(executor, (graph_runtime.GraphModule, _vm.VirtualMachine)):
+        module = executor.module
+    else:
+        module = executor
+    names = list(input_names) if module.type_key == "GraphRuntime" else [func_name]
+    fcreate = tvm._ffi.get_global_func("tvm.dynamic_batcher.create")
+    return DynamicBatcher(fcreate(module, max_batch, int(timeout_ms * 1000), *names))
+
+
+class DynamicBatcher(object):
+    """Wrapper of the dynamic batcher module.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The internal dynamic batcher module.
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._infer = module["infer"]
+        self.max_batch = module["get_max_batch"]()
+
+    def infer(self, *inputs):
+        """Run a request in the next batch, blocking until it is done.
+
+        Parameters
+        ----------
+        inputs : list of NDArray or numpy.ndarray
+            The inputs of the request, each with a batch of one.
+
+        Returns
+        -------
+        outputs : list of NDArray
+            The outputs of the request, each with a batch of one.
+        """
+        inputs = [x if isinstance(x, tvm.nd.NDArray) else tvm.nd.array(x) for x in inputs]
+        return list(self._infer(*inputs))
+
+    @property
+    def num_batches(self):
+        """The number of batches run so far."""
+        return self.module["get_num_batches"]()
@@ -24,7 +24,8 @@ from tvm._ffi.libinfo import find_lib_path
 def create_tvmjs_wasm(output,
                       objects,
                       options=None,
-                      cc="emcc"):
+                      cc="emcc",
+                      num_threads=0):
     """Create wasm that is supposed to run with the tvmjs.
 
     Parameters
@@ -40,14 +41,23 @@ def create_tvmjs_wasm(output,
 
     cc : str, optional
         The compile string.
+
+    num_threads : int, optional
+        The number of threads of a runtime built with WASM_THREADS=1,
+        0 for the single threaded runtime.
     """
     cmd = [cc]
     cmd += ["-O3"]
 
     cmd += ["-std=c++14"]
     cmd += ["-s", "ERROR_ON_UNDEFINED_SYMBOLS=0"]
-    cmd += ["-s", "STANDALONE_WASM=1"]
     cmd += ["-s", "ALLOW_MEMORY_GROWTH=1"]
+    if num_threads:
+        # emscripten does not support pthreads in standalone wasm.
+        cmd += ["-pthread", "-s", "USE_PTHREADS=1"]
+        cmd += ["-s", "PTHREAD_POOL_SIZE=%d" % num_threads]
+    else:
+        cmd += ["-s", "STANDALONE_WASM=1"]
 
 
     objects = [objects] if isinstance(objects, str) else objects
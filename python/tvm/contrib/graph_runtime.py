@@ -29,8 +29,9 @@ def create(graph_json_str, libmod, ctx):
 
     Parameters
     ----------
-    graph_json_str : str
-        The graph to be deployed in json format output by json graph.
+    graph_json_str : str or bytes
+        The graph to be deployed in json format output by json graph,
+        or in the binary graph format.
         The graph can contain operator(tvm_op) that points to the name
         of PackedFunc in the libmod.
 
@@ -48,7 +49,7 @@ def create(graph_json_str, libmod, ctx):
     graph_module : GraphModule
         Runtime graph module that can be used to execute the graph.
     """
-    assert isinstance(graph_json_str, string_types)
+    assert isinstance(graph_json_str, string_types + (bytes, bytearray))
 
     ctx, num_rpc_ctx, device_type_id = get_device_ctx(libmod, ctx)
 
@@ -136,6 +137,8 @@ class GraphModule(object):
         self._get_num_inputs = module["get_num_inputs"]
         self._load_params = module["load_params"]
         self._share_params = module["share_params"]
+        self._pending_inputs = []
+        self._launched_inputs = []
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -151,11 +154,13 @@ class GraphModule(object):
         params : dict of str to NDArray
            Additional arguments
         """
+        # Set through the runtime, which gives a shared param a private copy
+        # and stages the input of the next asynchronous run.
         if key is not None:
             v = self._get_input(key)
             if v is None:
                 raise RuntimeError("Could not find '%s' in graph's inputs" % key)
-            v.copyfrom(value)
+            self._set_input(key, self._as_input(value))
 
         if params:
             # upload big arrays first to avoid memory issue in rpc mode
@@ -167,7 +172,15 @@ class GraphModule(object):
                 # params from set_input
                 val = self._get_input(k)
                 if val:
-                    self._get_input(k).copyfrom(params[k])
+                    self._set_input(k, self._as_input(params[k]))
+
+    def _as_input(self, value):
+        """Convert an input value to an NDArray, kept alive through the run it is
+        launched with, since an asynchronous upload may still read it."""
+        if not isinstance(value, tvm.nd.NDArray):
+            value = tvm.nd.array(value)
+        self._pending_inputs.append(value)
+        return value
 
     def run(self, **input_dict):
         """Run forward execution of the graph
@@ -180,6 +193,74 @@ class GraphModule(object):
         if input_dict:
             self.set_input(**input_dict)
         self._run()
+        self._launched_inputs, self._pending_inputs = self._pending_inputs, []
+
+    def run_async(self, **input_dict):
+        """Launch the graph and return without waiting for it to finish.
+
+        The graph runs on a stream of each CUDA and ROCm device. Inputs set after the
+        launch are uploaded while it computes, and must stay alive until the
+        next run is launched. Other devices finish before this returns.
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+
+        Returns
+        -------
+        wait : Function
+            The completion handle, blocking until the run finished when called.
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        wait = self.module["run_async"]()
+        self._launched_inputs, self._pending_inputs = self._pending_inputs, []
+        return wait
+
+    def set_thread_pool_partition(self, name):
+        """Run the graph on a named thread pool partition.
+
+        Parameters
+        ----------
+        name : str
+            The name of a partition created with runtime.config_threadpool_partition,
+            empty to run on the thread pool of the calling thread.
+        """
+        self.module["set_thread_pool_partition"](name)
+
+    def set_num_streams(self, num_streams):
+        """Run independent branches of the graph concurrently on CUDA or ROCm streams.
+
+        Parameters
+        ----------
+        num_streams : int
+            The number of streams per device, 1 to use the default stream only.
+        """
+        self.module["set_num_streams"](num_streams)
+
+    def set_overlap_copies(self, overlap=True):
+        """Overlap the copies between the host and CUDA or ROCm devices of a heterogeneous
+        graph with the compute, by issuing them early on a copy stream of the device.
+
+        Parameters
+        ----------
+        overlap : bool
+            Whether to overlap the copies.
+        """
+        self.module["set_overlap_copies"](overlap)
+
+    def set_pinned_staging(self, enable=True):
+        """Stage the inputs set from host memory, and the outputs copied to host
+        memory, through reusable pinned host buffers, so the copies to and from
+        GPU devices run at the full bandwidth.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to stage the copies.
+        """
+        self.module["set_pinned_staging"](enable)
 
     def get_num_outputs(self):
         """Get the number of outputs from the graph
@@ -259,6 +340,40 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_from_file(self, path):
+        """Load parameters from a file written with tvm.relay.save_param_dict.
+
+        Files saved with ``mapped=True`` are memory-mapped: params on CPU
+        become zero-copy views into the file, params on other devices are
+        copied from it in chunks.
+
+        Parameters
+        ----------
+        path : str
+            The path of the parameter file on the machine running the module.
+        """
+        self.module["load_params_from_file"](path)
+
+    def set_lazy_params(self, enable=True):
+        """Defer uploading params loaded from now on until the first op reading them runs.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to materialize params on demand.
+        """
+        self.module["set_lazy_params"](enable)
+
+    def prefetch_params(self, names=None):
+        """Upload deferred params ahead of their first use.
+
+        Parameters
+        ----------
+        names : list of str, optional
+            The params to upload, all deferred params if not given.
+        """
+        self.module["prefetch_params"](*(names or []))
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphRuntime instance.
 
@@ -281,3 +396,98 @@ class GraphModule(object):
             The key to the module.
         """
         return self.module[key]
+
+
+class MultiShapeGraphModule(object):
+    """Wrapper of the multi-shape graph runtime module, created by the factory
+    built with relay.build_multi_shape.
+
+    Each run executes the specialization built for the shapes of its inputs.
+    The specializations share one storage pool, so the outputs of a run are
+    only valid until a run with other input shapes.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The internal multi-shape graph runtime module.
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._set_input = module["set_input"]
+        self._run = module["run"]
+        self._get_output = module["get_output"]
+        self._get_num_outputs = module["get_num_outputs"]
+
+    def set_input(self, key=None, value=None, **params):
+        """Set inputs of the next runs, copied into the selected specialization
+        when it runs.
+
+        Parameters
+        ----------
+        key : str
+           The input name
+
+        value : the input value.
+           The input value
+
+        params : dict of str to NDArray
+           Additional inputs
+        """
+        if key is not None:
+            params[key] = value
+        for k, v in params.items():
+            if not isinstance(v, tvm.runtime.NDArray):
+                v = tvm.nd.array(v)
+            self._set_input(k, v)
+
+    def run(self, **input_dict):
+        """Run the specialization matching the shapes of the inputs
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        self._run()
+        self._launched_inputs, self._pending_inputs = self._pending_inputs, []
+
+    def get_output(self, index):
+        """Get index-th output of the last run
+
+        Parameters
+        ----------
+        index : int
+            The output index
+        """
+        return self._get_output(index)
+
+    def get_num_outputs(self):
+        """Get the number of outputs from the graph
+
+        Returns
+        -------
+        count : int
+            The number of outputs.
+        """
+        return self._get_num_outputs()
+
+    def get_active_specialization(self):
+        """Get the index of the specialization of the last run, -1 before the first run."""
+        return self.module["get_active_specialization"]()
+
+    def get_storage_bytes(self):
+        """Get the bytes of the storage pool shared by the specializations."""
+        return self.module["get_storage_bytes"]()
+
+    def __getitem__(self, key):
+        """Get internal module function
+
+        Parameters
+        ----------
+        key : str
+            The key to the module.
+        """
+        return self.module[key]
@@ -26,7 +26,7 @@ def is_available():
     """
     return _initialize() == 0
 
-def fully_connected_inference(lhs, rhs, nthreads=1):
+def fully_connected_inference(lhs, rhs, nthreads=0):
     """Create an extern op that compute fully connected of 1D tensor lhs and
     2D tensor rhs with nnpack.
 
@@ -36,6 +36,9 @@ def fully_connected_inference(lhs, rhs, nthreads=1):
         lhs 1D array input[input_channels] of FP32 elements
     rhs : Tensor
         lhs 2D matrix kernel[output_channels][input_channels] of FP32 elements
+    nthreads : int
+        The number of threads NNPACK runs on, 0 to use as many as the TVM
+        thread pool of the calling thread.
 
     Returns
     -------
@@ -66,7 +69,7 @@ class ConvolutionTransformStrategy:
 
 
 def convolution_inference(
-        data, kernel, bias, padding, stride, nthreads=1,
+        data, kernel, bias, padding, stride, nthreads=0,
         algorithm=ConvolutionAlgorithm.AUTO):
     """Create an extern op to do inference convolution of 4D tensor data and
     4D tensor kernel and 1D tensor bias with nnpack.
@@ -88,6 +91,9 @@ def convolution_inference(
     stride : list
         stride A 2-dim list of [stride_height, stride_width], which indicates
         the stride.
+    nthreads : int
+        The number of threads NNPACK runs on, 0 to use as many as the TVM
+        thread pool of the calling thread.
 
     Returns
     -------
@@ -118,7 +124,7 @@ def convolution_inference(
             stride[0], stride[1], nthreads, algorithm), name="C")
 
 def convolution_inference_without_weight_transform(
-        data, transformed_kernel, bias, padding, stride, nthreads=1,
+        data, transformed_kernel, bias, padding, stride, nthreads=0,
         algorithm=ConvolutionAlgorithm.AUTO):
     """Create an extern op to do inference convolution of 4D tensor data and
     4D pre-transformed tensor kernel and 1D tensor bias with nnpack.
@@ -140,6 +146,9 @@ def convolution_inference_without_weight_transform(
     stride : list
         stride A 2-dim list of [stride_height, stride_width], which indicates
         the stride.
+    nthreads : int
+        The number of threads NNPACK runs on, 0 to use as many as the TVM
+        thread pool of the calling thread.
 
     Returns
     -------
@@ -171,7 +180,7 @@ def convolution_inference_without_weight_transform(
             stride[0], stride[1], nthreads, algorithm), name="C", dtype='float32')
 
 def convolution_inference_weight_transform(
-        kernel, nthreads=1,
+        kernel, nthreads=0,
         algorithm=ConvolutionAlgorithm.AUTO,
         dtype='float32'):
     """Create an extern op to do inference convolution of 3D tensor data and
@@ -182,6 +191,9 @@ def convolution_inference_weight_transform(
     kernel : Tensor
         kernel 4D tensor kernel[output_channels][input_channels][kernel_height]
         [kernel_width] of FP32 elements.
+    nthreads : int
+        The number of threads NNPACK runs on, 0 to use as many as the TVM
+        thread pool of the calling thread.
 
     Returns
     -------
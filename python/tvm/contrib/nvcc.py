@@ -242,13 +242,15 @@ def have_fp16(compute_version):
 def have_int8(compute_version):
     """Either int8 support is provided in the compute capability or not
 
+    The int8 dot products (__dp4a) start with compute capability 6.1.
+
     Parameters
     ----------
     compute_version : str
         compute capability of a GPU (e.g. "6.1")
     """
-    major, _ = parse_compute_version(compute_version)
-    if major >= 6:
+    major, minor = parse_compute_version(compute_version)
+    if (major, minor) >= (6, 1):
         return True
 
     return False
@@ -262,7 +264,7 @@ def have_tensorcore(compute_version):
         compute capability of a GPU (e.g. "7.0")
     """
     major, _ = parse_compute_version(compute_version)
-    if major == 7:
+    if major >= 7:
         return True
 
     return False
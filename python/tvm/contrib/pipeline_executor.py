@@ -0,0 +1,128 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Pipeline executor running the stages of a partitioned graph concurrently."""
+import json
+
+import tvm._ffi
+from tvm.contrib import graph_runtime
+
+
+def create(stages, bindings, num_inputs, outputs=None, max_in_flight=None):
+    """Create a pipeline executor from graph modules of consecutive stages.
+
+    Every stage runs on its own thread, typically on its own device, so up to
+    max_in_flight micro-batches are processed at the same time. Values passed
+    between stages are copied to the context of the consuming stage.
+
+    Parameters
+    ----------
+    stages : list of GraphModule or tvm.runtime.Module
+        The graph runtime of each stage, in execution order.
+
+    bindings : list of dict of str to (int, int)
+        For each stage, maps its input names to their source: (-1, i) is the
+        i-th pipeline input, (s, i) is the i-th output of the earlier stage s.
+
+    num_inputs : int
+        The number of pipeline inputs.
+
+    outputs : list of (int, int), optional
+        The (stage, output index) pairs returned for each micro-batch,
+        all outputs of the last stage by default.
+
+    max_in_flight : int, optional
+        The number of micro-batches in the pipeline, twice the number of
+        stages by default.
+
+    Returns
+    -------
+    pipeline_module : PipelineModule
+        Runtime pipeline module that can be used to execute micro-batches.
+    """
+    modules = [s.module if isinstance(s, graph_runtime.GraphModule) else s for s in stages]
+    config = {
+        "stages": [{name: list(src) for name, src in b.items()} for b in bindings],
+        "num_inputs": num_inputs,
+        "outputs": [list(out) for out in outputs or []],
+        "max_in_flight": max_in_flight or 2 * len(stages),
+    }
+    fcreate = tvm._ffi.get_global_func("tvm.pipeline_runtime.create")
+    return PipelineModule(fcreate(json.dumps(config), *modules), config["max_in_flight"])
+
+
+class PipelineModule(object):
+    """Wrapper of the pipeline runtime module.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The internal pipeline runtime module.
+
+    max_in_flight : int
+        The number of micro-batches the pipeline holds.
+    """
+
+    def __init__(self, module, max_in_flight):
+        self.module = module
+        self.max_in_flight = max_in_flight
+        self._enqueue = module["enqueue"]
+        self._dequeue = module["dequeue"]
+
+    def enqueue(self, *inputs):
+        """Push a micro-batch, blocking while the pipeline is full.
+
+        Parameters
+        ----------
+        inputs : list of NDArray
+            The pipeline inputs of the micro-batch.
+        """
+        self._enqueue(*inputs)
+
+    def dequeue(self):
+        """Wait for the oldest micro-batch in the pipeline.
+
+        Returns
+        -------
+        outputs : list of NDArray
+            The pipeline outputs of the micro-batch.
+        """
+        return list(self._dequeue())
+
+    def run(self, batches):
+        """Run micro-batches through the pipeline, keeping it full.
+
+        Parameters
+        ----------
+        batches : list of list of NDArray
+            The pipeline inputs of each micro-batch.
+
+        Returns
+        -------
+        outputs : list of list of NDArray
+            The pipeline outputs of each micro-batch, in order.
+        """
+        results = []
+        in_flight = 0
+        for inputs in batches:
+            if in_flight == self.max_in_flight:
+                results.append(self.dequeue())
+                in_flight -= 1
+            self.enqueue(*inputs)
+            in_flight += 1
+        for _ in range(in_flight):
+            results.append(self.dequeue())
+        return results
@@ -94,4 +94,62 @@ def normal(loc, scale, size):
         "tvm.contrib.random.normal", float(loc), float(scale), outs[0]), dtype='float32')
 
 
+def philox_uniform(low, high, size, seed=0, offset=0):
+    """Draw samples from a uniform distribution with a counter-based generator.
+
+    Element i of the output is a function of seed and offset + i only, so the
+    result does not depend on the number of threads that fill it, and two
+    calls with disjoint [offset, offset + size) ranges draw independent streams.
+
+    Parameters
+    ----------
+    low : float
+        Lower boundary of the output interval.
+    high : float
+        Upper boundary of the output interval.
+    size : tuple of ints
+        Output shape.
+    seed : int
+        Key of the generator.
+    offset : int
+        Counter of the first element.
+
+    Returns
+    -------
+    out : Tensor
+        A tensor with specified size and dtype.
+    """
+    return te.extern(size, [], lambda ins, outs: tvm.tir.call_packed(
+        "tvm.contrib.random.philox_uniform", int(seed), int(offset),
+        float(low), float(high), outs[0]), dtype='float32')
+
+
+def philox_normal(loc, scale, size, seed=0, offset=0):
+    """Draw samples from a normal distribution with a counter-based generator.
+
+    See philox_uniform for how seed and offset select the samples.
+
+    Parameters
+    ----------
+    loc : float
+        loc of the distribution.
+    scale : float
+        Standard deviation of the distribution.
+    size : tuple of ints
+        Output shape.
+    seed : int
+        Key of the generator.
+    offset : int
+        Counter of the first element.
+
+    Returns
+    ------
+    out : Tensor
+        A tensor with specified size and dtype
+    """
+    return te.extern(size, [], lambda ins, outs: tvm.tir.call_packed(
+        "tvm.contrib.random.philox_normal", int(seed), int(offset),
+        float(loc), float(scale), outs[0]), dtype='float32')
+
+
 tvm._ffi._init_api("tvm.contrib.random")
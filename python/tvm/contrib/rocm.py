@@ -141,3 +141,14 @@ def callback_rocm_bitcode_path(rocdl_dir="/opt/rocm/lib/"):
     ]
     paths = [join(rocdl_dir, bitcode) for bitcode in bitcode_files]
     return tvm.runtime.convert([path for path in paths if exists(path)])
+
+
+def have_matrixcore(gfx_arch):
+    """Whether the GPU has the matrix cores of the CDNA architecture (mfma)
+
+    Parameters
+    ----------
+    gfx_arch : str
+        The gfx architecture of the GPU, e.g. "gfx908"
+    """
+    return gfx_arch in ("gfx908", "gfx90a") or gfx_arch.startswith("gfx94")
@@ -18,7 +18,7 @@
 import tvm._ffi
 from ..rpc import base as rpc_base
 
-def create(tflite_model_bytes, ctx, runtime_target='cpu'):
+def create(tflite_model_bytes, ctx, runtime_target='cpu', num_threads=0, max_interpreters=1):
     """Create a runtime executor module given a tflite model and context.
     Parameters
     ----------
@@ -29,6 +29,12 @@ def create(tflite_model_bytes, ctx, runtime_target='cpu'):
         is only one TVMContext.
     runtime_target: str
         Execution target of TFLite runtime: either `cpu` or `edge_tpu`.
+    num_threads : int
+        The number of intra-op threads of each interpreter, 0 for the
+        default of the target.
+    max_interpreters : int
+        The maximum number of interpreters serving concurrent calls to
+        `run` from different threads.
     Returns
     -------
     tflite_runtime : TFLiteModule
@@ -46,7 +52,8 @@ def create(tflite_model_bytes, ctx, runtime_target='cpu'):
     else:
         fcreate = tvm._ffi.get_global_func(runtime_func)
 
-    return TFLiteModule(fcreate(bytearray(tflite_model_bytes), ctx))
+    return TFLiteModule(fcreate(bytearray(tflite_model_bytes), ctx, num_threads,
+                                max_interpreters))
 
 
 class TFLiteModule(object):
@@ -72,6 +79,8 @@ class TFLiteModule(object):
         self._set_input = module["set_input"]
         self._invoke = module["invoke"]
         self._get_output = module["get_output"]
+        self._run = module["run"]
+        self._set_num_threads = module["set_num_threads"]
 
     def set_input(self, index, value):
         """Set inputs to the module via kwargs
@@ -108,3 +117,29 @@ class TFLiteModule(object):
             The output index
         """
         return self._get_output(index)
+
+    def run(self, inputs, outputs):
+        """Run the whole model in one call. Unlike set_input, invoke and
+        get_output, run can be called from several threads at once, each
+        call using an interpreter of the pool. Suitably aligned CPU inputs
+        are read in place.
+
+        Parameters
+        ----------
+        inputs : list of NDArray
+            The inputs of the model, in order.
+
+        outputs : list of NDArray
+            The arrays receiving the outputs of the model, in order.
+        """
+        self._run(*inputs, *outputs)
+
+    def set_num_threads(self, num_threads):
+        """Set the number of intra-op threads of the interpreters
+
+        Parameters
+        ----------
+        num_threads : int
+            The number of threads, 0 for the default of the target.
+        """
+        self._set_num_threads(num_threads)
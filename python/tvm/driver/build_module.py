@@ -182,6 +182,7 @@ def lower(sch,
         tvm.tir.transform.NarrowDataType(32),
         tvm.tir.transform.Simplify(),
         tvm.tir.transform.HoistIfThenElse(),
+        tvm.tir.transform.LoopUnswitching(),
     ]
     pass_list += lower_phase1
 
@@ -254,7 +255,9 @@ def _build_for_device(input_mod, target, target_host):
 
     if PassContext.current().config.get("tir.detect_global_barrier", False):
         opt_mixed += [tvm.tir.transform.ThreadSync("global")]
-    opt_mixed += [tvm.tir.transform.ThreadSync("shared"),
+    opt_mixed += [tvm.tir.transform.LowerTextureAccess(),
+                  tvm.tir.transform.CoalesceGlobalAccess(),
+                  tvm.tir.transform.ThreadSync("shared"),
                   tvm.tir.transform.ThreadSync("warp"),
                   tvm.tir.transform.InferFragment(),
                   tvm.tir.transform.LowerThreadAllreduce(),
@@ -263,15 +266,20 @@ def _build_for_device(input_mod, target, target_host):
     mod_mixed = tvm.transform.Sequential(opt_mixed)(mod_mixed)
 
     # device optimizations
-    opt_device = tvm.transform.Sequential(
-        [tvm.tir.transform.Filter(
+    opt_device = [
+        tvm.tir.transform.Filter(
             lambda f: "calling_conv" in f.attrs and
             f.attrs["calling_conv"].value == CallingConv.DEVICE_KERNEL_LAUNCH),
-         tvm.tir.transform.LowerWarpMemory(),
-         tvm.tir.transform.Simplify(),
-         tvm.tir.transform.LowerDeviceStorageAccessInfo(),
-         tvm.tir.transform.LowerIntrin()])
-    mod_dev = opt_device(mod_mixed)
+        tvm.tir.transform.LowerWarpMemory(),
+        tvm.tir.transform.Simplify()]
+    # keep the same criterion as SplitDevHostFuncs in src/driver/driver_api.cc.
+    if target.kind.name in ("cuda", "rocm"):
+        # 32-bit index arithmetic saves registers and instructions on these GPUs,
+        # narrow the indices introduced by the lowering after phase 1 as well.
+        opt_device += [tvm.tir.transform.NarrowDataType(32)]
+    opt_device += [tvm.tir.transform.LowerDeviceStorageAccessInfo(),
+                   tvm.tir.transform.LowerIntrin()]
+    mod_dev = tvm.transform.Sequential(opt_device)(mod_mixed)
 
     # host optimizations
     opt_host = tvm.transform.Sequential(
@@ -0,0 +1,76 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Start a search worker of tvm.auto_scheduler.DistributedSearch
+
+The worker is an RPC server registered to a tracker. It runs the search shards sent by the
+coordinator, and builds and measures their programs on this node. The workloads are created from
+their keys, so the modules registering them must be imported with --import.
+"""
+import argparse
+import importlib
+import logging
+
+from tvm import rpc
+# Register the search shard function before the server forks its session processes
+from tvm import auto_scheduler  # pylint: disable=unused-import
+
+
+def main(args):
+    """Main function
+
+    Parameters
+    ----------
+    args : argparse.Namespace
+        parsed args from command-line invocation
+    """
+    for module_name in args.imports:
+        importlib.import_module(module_name)
+
+    url, port = args.tracker.rsplit(":", 1)
+    server = rpc.Server(args.host,
+                        args.port,
+                        args.port_end,
+                        key=args.key,
+                        tracker_addr=(url, int(port)),
+                        custom_addr=args.custom_addr,
+                        silent=args.silent)
+    server.proc.join()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--host', type=str, default="0.0.0.0",
+                        help='the hostname of the server')
+    parser.add_argument('--port', type=int, default=9090,
+                        help='The port of the RPC')
+    parser.add_argument('--port-end', type=int, default=9199,
+                        help='The end search port of the RPC')
+    parser.add_argument('--tracker', type=str, required=True,
+                        help=("The address of RPC tracker in host:port format. "
+                              "e.g. (10.77.1.234:9190)"))
+    parser.add_argument('--key', type=str, default="auto_scheduler_worker",
+                        help="The key the coordinator requests the workers with.")
+    parser.add_argument('--import', dest='imports', type=str, action='append', default=[],
+                        help="A python module registering the workloads, can be repeated.")
+    parser.add_argument('--silent', action='store_true',
+                        help="Whether run in silent mode.")
+    parser.add_argument('--custom-addr', type=str,
+                        help="Custom IP Address to Report to RPC Tracker")
+    args = parser.parse_args()
+    logging.basicConfig(level=logging.INFO)
+    main(args)
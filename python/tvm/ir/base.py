@@ -151,6 +151,41 @@ def save_json(node):
     return tvm.runtime._ffi_node_api.SaveJSON(node)
 
 
+def save_binary(node):
+    """Save tvm object in a compact binary format.
+
+    It is much faster to save and load than json, but it can only be loaded
+    by a version of TVM whose objects have the same fields.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    data : bytearray
+        The saved bytes.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
+def load_binary(data):
+    """Load tvm object saved by save_binary.
+
+    Parameters
+    ----------
+    data : bytes or bytearray
+        The saved bytes.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(bytearray(data))
+
+
 def structural_equal(lhs, rhs, map_free_vars=False):
     """Check structural equality of lhs and rhs.
 
@@ -273,3 +308,29 @@ def structural_hash(node, map_free_vars=False):
     structrual_equal
     """
     return tvm.runtime._ffi_node_api.StructuralHash(node, map_free_vars)
+
+
+@tvm._ffi.register_object("StructuralHashMemo")
+class StructuralHashMemo(Object):
+    """Memo table of structural hash values.
+
+    Within the scope, structural_hash of an object that was already hashed
+    in the scope returns the recorded value without revisiting the object.
+
+    Examples
+    --------
+    .. code-block:: python
+
+        with tvm.ir.StructuralHashMemo():
+            # repeated hashing of func is O(1) after the first call
+            tvm.ir.structural_hash(func)
+    """
+    def __init__(self):
+        self.__init_handle_by_constructor__(tvm.runtime._ffi_node_api.StructuralHashMemo)
+
+    def __enter__(self):
+        tvm.runtime._ffi_node_api.EnterStructuralHashMemo(self)
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        tvm.runtime._ffi_node_api.ExitStructuralHashMemo(self)
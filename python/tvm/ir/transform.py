@@ -100,6 +100,26 @@ class PassContext(tvm.runtime.Object):
         """Return the current pass context."""
         return _ffi_transform_api.GetCurrentPassContext()
 
+    def profile_report(self):
+        """Summarize the passes run in this context, ranked by self time.
+
+        The profiles are only recorded when the context is created with
+        ``config={"ir.profile_passes": True}``. Each profile records the wall
+        time, the IR node count before and after and the resident memory
+        change of one pass invocation, see :py:attr:`pass_profiles`.
+
+        Returns
+        -------
+        report : str
+            The table of the profiled passes.
+        """
+        return _ffi_transform_api.PassContextProfileReport(self)
+
+
+@tvm._ffi.register_object("transform.PassProfile")
+class PassProfile(tvm.runtime.Object):
+    """The measurements of one pass invocation, see PassContext.profile_report."""
+
 
 @tvm._ffi.register_object("transform.Pass")
 class Pass(tvm.runtime.Object):
@@ -21,3 +21,4 @@ from .base import DEVICE_SECTIONS
 from .base import Session, create_micro_mod, cross_compiler, LibType
 from .base import get_micro_host_driven_dir, get_micro_device_dir
 from . import device
+from .graph_profile import get_node_cycles
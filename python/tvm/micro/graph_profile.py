@@ -0,0 +1,61 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Reads the per-node cycle counts recorded by the CRT graph runtime."""
+
+import json
+import struct
+
+
+def get_node_cycles(session, graph_json, reset=False):
+    """Fetch the cycles spent in each operator of a graph running on the CRT.
+
+    The CRT must be built with TVM_CRT_GRAPH_RUNTIME_PROFILE and the platform must provide
+    TVMPlatformCycleCount. Counts are summed over all runs since the last reset.
+
+    Parameters
+    ----------
+    session : tvm.rpc.RPCSession
+        The session to the device running the graph.
+
+    graph_json : str
+        The graph the device runs, used to name the nodes.
+
+    reset : bool
+        Whether to clear the counts after reading them.
+
+    Returns
+    -------
+    num_runs : int
+        The number of runs the counts cover.
+
+    node_cycles : list of (str, int)
+        The name and cycle count of each operator node, most expensive first.
+    """
+    data = bytes(session.get_function("tvm.crt.node_cycles")())
+    if reset:
+        session.get_function("tvm.crt.reset_node_cycles")()
+    # Devices are assumed to be little-endian.
+    values = struct.unpack("<%dQ" % (len(data) // 8), data)
+    num_runs, cycles = values[0], values[1:]
+    nodes = json.loads(graph_json)["nodes"]
+    node_cycles = [
+        (nodes[nid]["name"], cycles[nid])
+        for nid in range(min(len(nodes), len(cycles)))
+        if nodes[nid]["op"] == "tvm_op"
+    ]
+    node_cycles.sort(key=lambda item: item[1], reverse=True)
+    return num_runs, node_cycles
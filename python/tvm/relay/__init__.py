@@ -32,7 +32,7 @@ from . import scope_builder
 
 from . import transform
 from . import analysis
-from .build_module import build, create_executor, optimize
+from .build_module import build, build_multi_shape, create_executor, optimize
 from .transform import build_config
 from . import debug
 from . import param_dict
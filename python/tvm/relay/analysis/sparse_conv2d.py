@@ -0,0 +1,110 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""
+This file contains helper functions for convert conv2d model
+to block sparse model
+"""
+import numpy as np
+import scipy.sparse as sp
+import tvm
+from . import _ffi_api
+from .sparse_dense import SparseAnalysisResult, select_bsr_block_size
+
+
+def _search_conv2d_op_weight(expr):
+    """Search name and kernel layout of weight in all ```nn.conv2d``` operator
+       that can be converted to sparse
+
+    Parameters
+    ----------
+    expr : relay.Expr
+        Expr will be searched
+
+    Returns
+    -------
+    ret : Map[String, String]
+        name of weight to its kernel layout in all qualified ``nn.conv2d``` operator
+    """
+    return _ffi_api.search_conv2d_op_weight(expr)
+
+
+def process_params(expr, params, block_size, sparsity_threshold, index_cost=4):
+    """Convert the pruned conv2d weights to one BSR matrix per tap of the kernel
+
+    The taps whose weights are all zero are dropped. A weight is only
+    converted when the estimated cost of its BSR matrices, see
+    ```select_bsr_block_size```, is lower than the cost of the dense weight.
+
+    Parameters
+    ----------
+    expr : Relay.Expr
+        Expr of the network
+    params : Dict[String, tvm.nd.array]
+        parameters of the network
+    block_size : Optional[Tuple(int, int)]
+        Blocksize in BSR matrix, selected per weight if None
+    sparsity_threshold : float
+        Minimal sparsity requirement for converting to sparse operation
+    index_cost : float
+        The cost of a BSR index relative to an element of the weight
+
+    Returns
+    -------
+    ret : Namedtuple[weight_name: Array[String], weight_shape: Array[Array[IntImm]]]
+        return names of qualified conv2d weight and the shapes of its taps in BSR format
+    """
+    memo = SparseAnalysisResult(weight_name=[], weight_shape=[])
+    weights = _search_conv2d_op_weight(expr)
+    for name, kernel_layout in weights.items():
+        name, kernel_layout = str(name), str(kernel_layout)
+        if name not in params or sorted(kernel_layout) != sorted("OIHW"):
+            continue
+        w_np = params[name].asnumpy()
+        sparsity = 1.0 - (np.count_nonzero(w_np) / w_np.size)
+        if sparsity < sparsity_threshold:
+            continue
+        w_oihw = w_np.transpose([kernel_layout.index(axis) for axis in "OIHW"])
+        taps = [(row, col, w_oihw[:, :, row, col])
+                for row in range(w_oihw.shape[2]) for col in range(w_oihw.shape[3])
+                if np.any(w_oihw[:, :, row, col])]
+        if not taps:
+            continue
+        candidates = [tuple(block_size)] if block_size else None
+        weight_block_size, cost = select_bsr_block_size(
+            [tap[2] for tap in taps], candidates, index_cost)
+        if weight_block_size is None or cost >= w_np.size:
+            continue
+        # remove dense weight
+        del params[name]
+        memo.weight_name.append(name)
+        weight_shape = [len(taps)]
+        for row, col, matrix in taps:
+            sparse_weight = sp.bsr_matrix(matrix, blocksize=weight_block_size)
+            prefix = "%s.%d.%d" % (name, row, col)
+            weight_shape += [row, col]
+            weight_shape += (list(sparse_weight.data.shape) +
+                             list(sparse_weight.indices.shape) +
+                             list(sparse_weight.indptr.shape))
+            params[prefix + ".data"] = tvm.nd.array(sparse_weight.data)
+            params[prefix + ".indices"] = tvm.nd.array(sparse_weight.indices)
+            params[prefix + ".indptr"] = tvm.nd.array(sparse_weight.indptr)
+        memo.weight_shape.append(weight_shape)
+    ret = SparseAnalysisResult(
+        weight_name=tvm.runtime.convert(memo.weight_name),
+        weight_shape=tvm.runtime.convert(memo.weight_shape)
+    )
+    return ret
@@ -50,6 +50,51 @@ def _search_dense_op_weight(expr):
     return _ffi_api.search_dense_op_weight(expr)
 
 
+def select_bsr_block_size(matrices, candidates=None, index_cost=4):
+    """Select the BSR block size that minimizes the estimated work of a layer.
+
+    Every stored block costs its elements, including the zeros it pads,
+    plus ``index_cost`` for its column index. Large blocks need fewer
+    indices but store more zeros, so the best size follows the pattern
+    left by pruning.
+
+    Parameters
+    ----------
+    matrices : numpy.ndarray or List[numpy.ndarray]
+        The 2-D weight matrices of the layer, all of the same shape
+    candidates : Optional[List[Tuple(int, int)]]
+        The block sizes to consider, powers of 2 up to 32 by default.
+        Sizes that do not divide the matrix shape are skipped.
+    index_cost : float
+        The cost of an index relative to an element of the matrix
+
+    Returns
+    -------
+    ret : Tuple(Tuple(int, int), float)
+        The block size and its estimated cost, which can be compared with the
+        number of elements of the dense matrices. (None, None) if no candidate
+        divides the matrix shape.
+    """
+    if not isinstance(matrices, (list, tuple)):
+        matrices = [matrices]
+    rows, cols = matrices[0].shape
+    if candidates is None:
+        sizes = [1, 2, 4, 8, 16, 32]
+        candidates = [(r, c) for r in sizes for c in sizes]
+    best_size, best_cost = None, None
+    for bs_r, bs_c in candidates:
+        if rows % bs_r or cols % bs_c:
+            continue
+        num_blocks = 0
+        for matrix in matrices:
+            blocks = matrix.reshape(rows // bs_r, bs_r, cols // bs_c, bs_c)
+            num_blocks += np.count_nonzero(np.any(blocks != 0, axis=(1, 3)))
+        cost = num_blocks * (bs_r * bs_c + index_cost)
+        if best_cost is None or cost < best_cost:
+            best_size, best_cost = (bs_r, bs_c), cost
+    return best_size, best_cost
+
+
 def process_params(expr, params, block_size, sparsity_threshold):
     """[summary]
 
@@ -59,8 +104,9 @@ def process_params(expr, params, block_size, sparsity_threshold):
         Expr of the network
     params : Dict[String, tvm.nd.array]
         parameters of the network
-    block_size : Tuple(int, int)
-        Blocksize in BSR matrix
+    block_size : Optional[Tuple(int, int)]
+        Blocksize in BSR matrix, selected per weight by
+        ```select_bsr_block_size``` if None
     sparsity_threshold : float
         Minimal sparsity requirement for converting to sparse operation
 
@@ -76,7 +122,8 @@ def process_params(expr, params, block_size, sparsity_threshold):
         w_np = params[name].asnumpy()
         sparsity = 1.0 - (np.count_nonzero(w_np) / w_np.size)
         if sparsity >= sparsity_threshold:
-            sparse_weight = sp.bsr_matrix(w_np, blocksize=block_size)
+            weight_block_size = block_size or select_bsr_block_size(w_np)[0]
+            sparse_weight = sp.bsr_matrix(w_np, blocksize=weight_block_size)
             # remove dense weight
             del params[name]
             memo.weight_name.append(name)
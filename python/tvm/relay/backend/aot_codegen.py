@@ -0,0 +1,107 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""
+Ahead-of-time executor codegen.
+
+The graph produced by the graph runtime codegen is rendered as C source: every
+tensor becomes a static DLTensor inside one statically planned arena and the
+generated ``<prefix>_run()`` calls the fused operators directly, so the target
+needs neither a JSON parser nor a function registry.
+"""
+from tvm.relay import _build_module
+from .graph_runtime_codegen import GraphRuntimeCodegen
+
+
+class AOTCodegen(GraphRuntimeCodegen):
+    """The compiler from Relay to a C ahead-of-time executor."""
+
+    def __init__(self, mod, target):
+        # pylint: disable=super-init-not-called
+        self._mod = _build_module._AOTCodegen()
+        self._init = self._mod["init"]
+        self._codegen = self._mod["codegen"]
+        self._get_graph_json = self._mod["get_graph_json"]
+        self._get_graph_binary = self._mod["get_graph_binary"]
+        self._list_params_name = self._mod["list_params_name"]
+        self._get_param_by_name = self._mod["get_param_by_name"]
+        self._get_irmodule = self._mod["get_irmodule"]
+        self._get_source = self._mod["get_source"]
+        self._setup(mod, target)
+
+    def get_source(self, prefix="tvm_aot", params=None):
+        """Render the last compiled graph as a C executor.
+
+        Parameters
+        ----------
+        prefix : str
+            Prefix of every symbol defined by the generated source.
+
+        params : Optional[Dict[str, tvm.nd.NDArray]]
+            Params to link into the source as constant arrays, which the
+            input tensors of the same name then point to. They are left out
+            of the inputs of the executor, so they cannot be overwritten.
+
+        Returns
+        -------
+        source : str
+            C source defining ``<prefix>_run``, ``<prefix>_get_input``,
+            ``<prefix>_get_output`` and ``<prefix>_input_names``. Link it
+            against the module built from the lowered functions.
+        """
+        return self._get_source(prefix, params or {})
+
+
+def build(mod, target, params=None, prefix="tvm_aot"):
+    """Build a Relay module into a C executor with its params linked in.
+
+    The executor and the returned library together form a self-contained
+    program: the storage plan, the operator calls and the params are all
+    fixed at link time.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module to build.
+
+    target : str or tvm.target.Target
+        The CPU target. It should be built with ``--system-lib`` so the
+        operators call the backend API directly rather than through
+        pointers filled in by a module loader.
+
+    params : Optional[Dict[str, tvm.nd.NDArray]]
+        Params bound to the inputs of the same name.
+
+    prefix : str
+        Prefix of every symbol defined by the generated source.
+
+    Returns
+    -------
+    source : str
+        The C executor.
+
+    lib : tvm.runtime.Module
+        The operators, to be saved as an object file.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm.driver import build_module as driver
+    from tvm.relay import build_module
+
+    opt_mod, _ = build_module.optimize(mod, target, params)
+    grc = AOTCodegen(None, target)
+    _, lowered, linked_params = grc.codegen(opt_mod["main"])
+    lib = driver.build(lowered, target=target)
+    return grc.get_source(prefix, linked_params), lib
@@ -18,6 +18,7 @@
 """Backend code generation engine."""
 from __future__ import absolute_import
 
+import hashlib
 import logging
 import numpy as np
 import tvm
@@ -291,6 +292,34 @@ def lower_call(call, inputs, target):
     return LoweredOutput(outputs, best_impl)
 
 
+@tvm._ffi.register_func("relay.backend.compile_cache_fingerprint")
+def compile_cache_fingerprint():
+    """Fingerprint the schedule configs of the autotvm dispatch context,
+    which the persistent compile cache has to take into account."""
+    entries = []
+    ctx = autotvm.task.DispatchContext.current
+    while ctx is not None:
+        tables = [getattr(ctx, name, {}) for name in
+                  ("_best_user_defined", "best_by_model", "best_by_targetkey")]
+        sizes = tuple(len(table) for table in tables)
+        # hashing a big tuning log for every lowered function is slow,
+        # remember the digest until the context is updated.
+        cached = getattr(ctx, "_compile_cache_fingerprint", None)
+        if cached is None or cached[0] != sizes:
+            lines = [type(ctx).__name__]
+            for table in tables:
+                for key in sorted(table, key=str):
+                    val = table[key]
+                    cfg = val[0].config if isinstance(val, tuple) else val
+                    lines.append("%s:%s" % (key, cfg))
+            digest = hashlib.sha1("\n".join(lines).encode()).hexdigest()
+            cached = (sizes, digest)
+            ctx._compile_cache_fingerprint = cached
+        entries.append(cached[1])
+        ctx = ctx._old_ctx
+    return ",".join(entries)
+
+
 @tvm._ffi.register_object("relay.CompileEngine")
 class CompileEngine(Object):
     """CompileEngine to get lowered code.
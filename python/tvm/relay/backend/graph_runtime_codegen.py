@@ -46,6 +46,7 @@ class GraphRuntimeCodegen(object):
         self._init = self._mod["init"]
         self._codegen = self._mod["codegen"]
         self._get_graph_json = self._mod["get_graph_json"]
+        self._get_graph_binary = self._mod["get_graph_binary"]
         self._list_params_name = self._mod["list_params_name"]
         self._get_param_by_name = self._mod["get_param_by_name"]
         self._get_irmodule = self._mod["get_irmodule"]
@@ -90,3 +91,14 @@ class GraphRuntimeCodegen(object):
             arr.copyto(param)
             params[key] = param
         return graph_json, lowered_func, params
+
+    def get_graph_binary(self):
+        """Return the last compiled graph in the binary graph format.
+
+        Returns
+        -------
+        graph_binary : bytearray
+            The graph, loadable by the graph runtime and the C runtime
+            without JSON parsing.
+        """
+        return self._get_graph_binary()
@@ -67,6 +67,18 @@ class GraphRuntimeFactoryModule(object):
     def get_lib(self):
         return self.lib
 
+    def set_share_params(self, enable=True):
+        """Make the runtimes created from now on share the device copy of
+        their params through a process-wide registry, instead of uploading
+        them for each. A runtime setting a param gets a private copy first.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to share the params.
+        """
+        self.module["set_share_params"](enable)
+
     def __getitem__(self, item):
         return self.module.__getitem__(item)
 
@@ -85,3 +97,49 @@ class GraphRuntimeFactoryModule(object):
         obj = objs[self.iter_cnt]
         self.iter_cnt += 1
         return obj
+
+
+class MultiShapeGraphRuntimeFactoryModule(object):
+    """Factory module of the multi-shape graph runtime, built by relay.build_multi_shape.
+
+    Parameters
+    ----------
+    graph_jsons : list of str
+        The graph of each specialization.
+    libmod : tvm.Module
+        The module of the functions of all the specializations
+    libmod_name: str
+        The name of module
+    params : list of dict of str to NDArray
+        The parameters of each specialization, the same array when shared.
+    """
+
+    def __init__(self, graph_jsons, libmod, libmod_name, params):
+        assert len(graph_jsons) == len(params)
+        fcreate = get_global_func("tvm.multi_shape_graph_runtime_factory.create")
+        args = list(graph_jsons)
+        for spec_params in params:
+            args.append(len(spec_params))
+            for k, v in spec_params.items():
+                args.append(k)
+                args.append(v)
+        self.module = fcreate(libmod_name, libmod, len(graph_jsons), *args)
+        self.graph_jsons = graph_jsons
+        self.lib = libmod
+        self.libmod_name = libmod_name
+        self.params = params
+
+    def export_library(self, file_name, fcompile=None, addons=None, **kwargs):
+        return self.module.export_library(file_name, fcompile, addons, **kwargs)
+
+    def get_params(self):
+        return self.params
+
+    def get_json(self):
+        return self.graph_jsons
+
+    def get_lib(self):
+        return self.lib
+
+    def __getitem__(self, item):
+        return self.module.__getitem__(item)
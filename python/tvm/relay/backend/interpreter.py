@@ -66,6 +66,15 @@ def _arg_to_ast(mod, arg):
         return const(arg)
 
 
+def clear_cache():
+    """Drop the primitive functions compiled by the interpreters.
+
+    They are shared by all the interpreters and kept when the compile
+    engine is cleared, clear them e.g. after changing the schedules.
+    """
+    _backend.ClearInterpreterCache()
+
+
 class Executor(object):
     """An abstract interface for executing Relay programs."""
 
@@ -70,6 +70,7 @@ class BuildModule(object):
     def __init__(self):
         self.mod = _build_module._BuildModule()
         self._get_graph_json = self.mod["get_graph_json"]
+        self._get_graph_binary = self.mod["get_graph_binary"]
         self._get_module = self.mod["get_module"]
         self._build = self.mod["build"]
         self._optimize = self.mod["optimize"]
@@ -169,6 +170,10 @@ class BuildModule(object):
         """Return the json file of the built program."""
         return self._get_graph_json()
 
+    def get_graph_binary(self):
+        """Return the graph of the built program in the binary graph format."""
+        return self._get_graph_binary()
+
     def get_module(self):
         """Return the built module."""
         return self._get_module()
@@ -257,6 +262,88 @@ def build(mod, target=None, target_host=None, params=None, mod_name='default'):
         return mod
 
 
+def _specialize_input_shapes(mod, shapes):
+    """Get a copy of the module whose main function takes inputs of the given shapes."""
+    func = mod["main"]
+    new_params = []
+    binds = {}
+    for param in func.params:
+        name = param.name_hint
+        if name not in shapes:
+            new_params.append(param)
+            continue
+        new_param = _expr.var(name, shape=shapes[name], dtype=param.type_annotation.dtype)
+        new_params.append(new_param)
+        binds[param] = new_param
+    spec = IRModule(dict(mod.functions), dict(mod.type_definitions))
+    spec["main"] = _function.Function(new_params, _expr.bind(func.body, binds), attrs=func.attrs)
+    return spec
+
+
+def build_multi_shape(mod, input_shapes, target=None, target_host=None, params=None,
+                      mod_name="default"):
+    """Build a Relay module for several sets of input shapes, into one module
+    running the specialization matching the shapes of the inputs of each run.
+
+    The specializations share their params, when the build gives them equal
+    values, and a single storage pool sized for the largest of their memory plans.
+
+    Parameters
+    ----------
+    mod : :py:class:`~tvm.IRModule`
+        The IR module to build, its main function is specialized for each set of shapes.
+
+    input_shapes : list of dict of str to tuple of int
+        The shapes of the inputs of each specialization, the inputs not listed keep
+        the shape of the main function.
+
+    target : str, :any:`tvm.target.Target`, or dict of str(i.e. device/context
+    name) to str/tvm.target.Target, optional
+        The build target, see build.
+
+    target_host : str or :any:`tvm.target.Target`, optional
+        Host compilation target, if target is device.
+
+    params : dict of str to NDArray
+        Input parameters to the graph that do not change
+        during inference time. Used for constant folding.
+
+    mod_name: Optional[str]
+        The module name we will build
+
+    Returns
+    -------
+    factory : MultiShapeGraphRuntimeFactoryModule
+        The factory of the multi-shape graph runtime,
+        see tvm.contrib.graph_runtime.MultiShapeGraphModule.
+    """
+    if not input_shapes:
+        raise ValueError("input_shapes should list at least one set of shapes")
+    graph_jsons = []
+    libs = []
+    spec_params = []
+    # The equal params of the specializations are passed as the same array, so they are
+    # uploaded and saved once.
+    unique_params = {}
+    for shapes in input_shapes:
+        spec = _specialize_input_shapes(mod, shapes)
+        factory = build(spec, target, target_host, params, mod_name)
+        graph_jsons.append(factory.get_json())
+        libs.append(factory.get_lib())
+        spec_param = {}
+        for name, value in factory.get_params().items():
+            data = value.asnumpy()
+            key = (data.shape, data.dtype.str, data.tobytes())
+            spec_param[name] = unique_params.setdefault(key, _nd.array(data))
+        spec_params.append(spec_param)
+    # The function names are unique across the builds of a process.
+    lib = libs[0]
+    for other in libs[1:]:
+        lib.import_module(other)
+    return _graph_runtime_factory.MultiShapeGraphRuntimeFactoryModule(
+        graph_jsons, lib, mod_name, spec_params)
+
+
 def optimize(mod, target=None, params=None):
     """Helper function that optimizes a Relay module.
 
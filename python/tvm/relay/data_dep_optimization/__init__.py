@@ -18,4 +18,5 @@
 """Optimizations involves changing of paramters"""
 
 from . import bsr_dense
+from . import bsr_conv2d
 from . import simplify_fc_transpose
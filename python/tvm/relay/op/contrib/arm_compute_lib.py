@@ -38,7 +38,7 @@ def is_arm_compute_runtime_enabled():
     return False
 
 
-def partition_for_arm_compute_lib(mod, params=None):
+def partition_for_arm_compute_lib(mod, params=None, merge_regions=False):
     """Partition the graph greedily offloading supported
     operators to Arm Compute Library.
 
@@ -48,6 +48,11 @@ def partition_for_arm_compute_lib(mod, params=None):
         The module to run passes on.
     params : Optional[Dict[str, NDArray]]
         Constant input parameters.
+    merge_regions : bool
+        Whether to merge adjacent supported operators into a single
+        function. The runtime then shares the memory of the intermediate
+        tensors across the layers of the function, which lowers peak
+        memory at the cost of fewer, larger partitions.
 
     Returns
     -------
@@ -56,9 +61,12 @@ def partition_for_arm_compute_lib(mod, params=None):
     if params:
         mod['main'] = bind_params_by_name(mod['main'], params)
 
-    seq = tvm.transform.Sequential([transform.MergeComposite(arm_compute_lib_pattern_table()),
-                                    transform.AnnotateTarget('arm_compute_lib'),
-                                    transform.PartitionGraph()])
+    passes = [transform.MergeComposite(arm_compute_lib_pattern_table()),
+              transform.AnnotateTarget('arm_compute_lib')]
+    if merge_regions:
+        passes.append(transform.MergeCompilerRegions())
+    passes.append(transform.PartitionGraph())
+    seq = tvm.transform.Sequential(passes)
 
     return seq(mod)
 
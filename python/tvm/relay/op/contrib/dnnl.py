@@ -67,21 +67,57 @@ _register_external_op_helper("subtract")
 _register_external_op_helper("multiply")
 
 
-def make_pattern(with_bias=True):
+def make_pattern(with_bias=True, with_sum=False, op_name="nn.conv2d", with_relu=True):
+    """Create a pattern of conv2d or dense followed by post-ops that DNNL fuses.
+
+    Parameters
+    ----------
+    with_bias : bool
+        Whether the op is followed by a bias add.
+
+    with_sum : bool
+        Whether the result is then added to another tensor, such as a residual.
+
+    op_name : str
+        The op at the root of the pattern, nn.conv2d or nn.dense.
+
+    with_relu : bool
+        Whether the pattern ends with a ReLU.
+
+    Returns
+    -------
+    pattern : tvm.relay.dataflow_pattern.DFPattern
+        The created pattern.
+    """
     data = wildcard()
     weight = wildcard()
     bias = wildcard()
-    conv = is_op('nn.conv2d')(data, weight)
+    out = is_op(op_name)(data, weight)
     if with_bias:
-        conv_out = is_op('add')(conv, bias)
-    else:
-        conv_out = conv
-    return is_op('nn.relu')(conv_out)
+        out = is_op('add')(out, bias)
+    if with_sum:
+        out = is_op('add')(out, wildcard())
+    if with_relu:
+        out = is_op('nn.relu')(out)
+    return out
 
 
 @register_pattern_table("dnnl")
 def pattern_table():
+    # Longer patterns come first, so they take precedence over their prefixes.
+    conv2d_bias_sum_relu_pat = ("dnnl.conv2d_bias_sum_relu",
+                                make_pattern(with_bias=True, with_sum=True))
     conv2d_bias_relu_pat = ("dnnl.conv2d_bias_relu", make_pattern(with_bias=True))
     conv2d_relu_pat = ("dnnl.conv2d_relu", make_pattern(with_bias=False))
-    dnnl_patterns = [conv2d_bias_relu_pat, conv2d_relu_pat]
+    conv2d_bias_pat = ("dnnl.conv2d_bias", make_pattern(with_bias=True, with_relu=False))
+    dense_bias_relu_pat = ("dnnl.dense_bias_relu",
+                           make_pattern(with_bias=True, op_name="nn.dense"))
+    dense_relu_pat = ("dnnl.dense_relu", make_pattern(with_bias=False, op_name="nn.dense"))
+    dense_bias_pat = ("dnnl.dense_bias",
+                      make_pattern(with_bias=True, op_name="nn.dense", with_relu=False))
+    if not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True):
+        # The C source codegen only implements the conv2d + relu fusions.
+        return [conv2d_bias_relu_pat, conv2d_relu_pat]
+    dnnl_patterns = [conv2d_bias_sum_relu_pat, conv2d_bias_relu_pat, conv2d_relu_pat,
+                     conv2d_bias_pat, dense_bias_relu_pat, dense_relu_pat, dense_bias_pat]
     return dnnl_patterns
@@ -38,7 +38,7 @@ def compute_resize(attrs, inputs, out_type):
     out_dtype = attrs.out_dtype
     return [topi.image.resize(inputs[0], size, layout, method, coord_trans, out_dtype)]
 
-reg.register_injective_schedule("image.resize")
+reg.register_schedule("image.resize", strategy.schedule_resize)
 
 
 @reg.register_compute("image.resize3d")
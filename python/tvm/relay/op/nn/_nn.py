@@ -48,6 +48,21 @@ reg.register_pattern("nn.log_softmax", OpPattern.OPAQUE)
 reg.register_strategy("nn.dense", strategy.dense_strategy)
 reg.register_pattern("nn.dense", reg.OpPattern.OUT_ELEMWISE_FUSABLE)
 
+@reg.register_alter_op_layout("nn.dense")
+def alter_op_layout_dense(attrs, inputs, tinfos, out_type):
+    """Alternate the layout of dense"""
+    return topi.nn.dense_alter_layout(attrs, inputs, tinfos, out_type)
+
+
+# dense_pack
+reg.register_strategy("nn.contrib_dense_pack", strategy.dense_pack_strategy)
+reg.register_pattern("nn.contrib_dense_pack", reg.OpPattern.OUT_ELEMWISE_FUSABLE)
+
+
+# dense_bias_act
+reg.register_strategy("nn.contrib_dense_bias_act", strategy.dense_bias_act_strategy)
+reg.register_pattern("nn.contrib_dense_bias_act", reg.OpPattern.OUT_ELEMWISE_FUSABLE)
+
 
 # fifo_buffer
 @reg.register_compute('nn.fifo_buffer')
@@ -83,6 +98,30 @@ reg.register_schedule("nn.sparse_transpose", strategy.schedule_sparse_transpose)
 reg.register_pattern("nn.sparse_transpose", reg.OpPattern.OUT_ELEMWISE_FUSABLE)
 
 
+# multi_sgd_update
+@reg.register_compute("nn.multi_sgd_update")
+def compute_multi_sgd_update(attrs, inputs, out_type):
+    """Compute definition of multi_sgd_update"""
+    n = (len(inputs) - 1) // 2
+    return topi.nn.multi_sgd_update(inputs[:n], inputs[n:2 * n], inputs[-1])
+
+reg.register_schedule("nn.multi_sgd_update", strategy.schedule_multi_update)
+reg.register_pattern("nn.multi_sgd_update", OpPattern.OPAQUE)
+
+
+# multi_adam_update
+@reg.register_compute("nn.multi_adam_update")
+def compute_multi_adam_update(attrs, inputs, out_type):
+    """Compute definition of multi_adam_update"""
+    n = (len(inputs) - 1) // 4
+    return topi.nn.multi_adam_update(inputs[:n], inputs[n:2 * n], inputs[2 * n:3 * n],
+                                     inputs[3 * n:4 * n], inputs[-1], attrs.beta1,
+                                     attrs.beta2, attrs.epsilon)
+
+reg.register_schedule("nn.multi_adam_update", strategy.schedule_multi_update)
+reg.register_pattern("nn.multi_adam_update", OpPattern.OPAQUE)
+
+
 # conv1d
 reg.register_strategy("nn.conv1d", strategy.conv1d_strategy)
 reg.register_pattern("nn.conv1d", OpPattern.OUT_ELEMWISE_FUSABLE)
@@ -1312,6 +1312,78 @@ def dense(data, weight, units=None, out_dtype=""):
     return _make.dense(data, weight, units, out_dtype)
 
 
+def contrib_dense_pack(data, weight, units=None, out_dtype="", weight_layout="NK"):
+    """Dense operator with a pre-packed weight.
+    Applies a linear transformation
+
+    .. math::
+
+    `Y = X * W`
+
+    Parameters
+    ----------
+    data : tvm.relay.Expr
+        The input data to the operator, of shape `(batch, input_dim)`.
+
+    weight : tvm.relay.Expr
+        The packed weight, of shape `(units // pack_weight_tile, input_dim, pack_weight_tile)`,
+        or blocked along input_dim for the int8 dot product, of shape
+        `(units // pack_weight_tile, input_dim // pack_input_tile, pack_weight_tile,
+        pack_input_tile)`.
+
+    units : int, optional
+        Number of hidden units of the dense transformation.
+
+    out_dtype : str, optional
+        Specifies the output data type for mixed precision dense.
+
+    weight_layout : str, optional
+        The layout of the packed weight, such as "NK8n" or "NK16n4k".
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The computed result.
+    """
+    return _make.contrib_dense_pack(data, weight, units, out_dtype, weight_layout)
+
+
+def contrib_dense_bias_act(data, weight, bias, units=None, out_dtype="", activation="none"):
+    """Dense operator fused with a bias add and an activation.
+    Applies a linear transformation
+
+    .. math::
+
+    `Y = act(X * W^T + b)`
+
+    Parameters
+    ----------
+    data : tvm.relay.Expr
+        The input data to the operator, of shape `(batch, input_dim)`.
+
+    weight : tvm.relay.Expr
+        The weight, of shape `(units, input_dim)`.
+
+    bias : tvm.relay.Expr
+        The bias, of shape `(units,)`.
+
+    units : int, optional
+        Number of hidden units of the dense transformation.
+
+    out_dtype : str, optional
+        Specifies the output data type for mixed precision dense.
+
+    activation : str, optional
+        The activation after the bias add, one of "none", "relu" and "gelu".
+
+    Returns
+    -------
+    result : tvm.relay.Expr
+        The computed result.
+    """
+    return _make.contrib_dense_bias_act(data, weight, bias, units, out_dtype, activation)
+
+
 def fifo_buffer(data, buffer, axis):
     """FIFO buffer to enable computation reuse in CNNs with sliding indow input
 
@@ -1987,6 +2059,84 @@ def sparse_transpose(x):
     return expr.TupleWrapper(
         _make.sparse_transpose(x.data, x.indices, x.indptr), 3)
 
+def multi_sgd_update(weights, grads, lr):
+    r"""Update all the weights with a step of stochastic gradient descent
+    in one kernel, reading and writing every tensor once.
+
+    .. math::
+
+        w' = w - lr * g
+
+    Parameters
+    ----------
+    weights : List[relay.Expr]
+        The weights.
+
+    grads : List[relay.Expr]
+        The gradients of the weights, of the same shapes.
+
+    lr : relay.Expr
+        The learning rate, a scalar.
+
+    Returns
+    -------
+    result : relay.Tuple
+        The updated weights.
+    """
+    return expr.TupleWrapper(
+        _make.multi_sgd_update(expr.Tuple(list(weights)), expr.Tuple(list(grads)), lr),
+        len(weights))
+
+
+def multi_adam_update(weights, grads, means, variances, lr, beta1=0.9, beta2=0.999,
+                      epsilon=1e-8):
+    r"""Update all the weights with a step of Adam in one kernel, reading and
+    writing every tensor once.
+
+    .. math::
+
+        m' = beta1 * m + (1 - beta1) * g
+        v' = beta2 * v + (1 - beta2) * g * g
+        w' = w - lr * m' / (\sqrt{v'} + epsilon)
+
+    The bias correction of the moments is left to the learning rate.
+
+    Parameters
+    ----------
+    weights : List[relay.Expr]
+        The weights.
+
+    grads : List[relay.Expr]
+        The gradients of the weights, of the same shapes.
+
+    means : List[relay.Expr]
+        The moving averages of the gradients.
+
+    variances : List[relay.Expr]
+        The moving averages of the squared gradients.
+
+    lr : relay.Expr
+        The learning rate, a scalar.
+
+    beta1 : float, optional
+        Decay rate of the means.
+
+    beta2 : float, optional
+        Decay rate of the variances.
+
+    epsilon : float, optional
+        Added to the square root of the variances.
+
+    Returns
+    -------
+    result : relay.Tuple
+        The updated weights, then the updated means, then the updated variances.
+    """
+    tuples = [expr.Tuple(list(t)) for t in (weights, grads, means, variances)]
+    return expr.TupleWrapper(
+        _make.multi_adam_update(*tuples, lr, beta1, beta2, epsilon), 3 * len(weights))
+
+
 def contrib_conv2d_winograd_without_weight_transform(data,
                                                      weight,
                                                      tile_size,
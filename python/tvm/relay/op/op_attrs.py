@@ -69,6 +69,16 @@ class DenseAttrs(Attrs):
     """Attributes for nn.dense"""
 
 
+@tvm._ffi.register_object("relay.attrs.DensePackAttrs")
+class DensePackAttrs(Attrs):
+    """Attributes for nn.contrib_dense_pack"""
+
+
+@tvm._ffi.register_object("relay.attrs.DenseBiasActAttrs")
+class DenseBiasActAttrs(Attrs):
+    """Attributes for nn.contrib_dense_bias_act"""
+
+
 @tvm._ffi.register_object("relay.attrs.SoftmaxAttrs")
 class SoftmaxAttrs(Attrs):
     """Attributes for nn.softmax"""
@@ -495,6 +505,11 @@ class SimulatedQuantizeAttrs(Attrs):
     """Attributes used in simulated_quantize operators"""
 
 
+@tvm._ffi.register_object("relay.attrs.MultiAdamUpdateAttrs")
+class MultiAdamUpdateAttrs(Attrs):
+    """Attributes used in multi_adam_update operators"""
+
+
 @tvm._ffi.register_object("relay.attrs.SparseDenseAttrs")
 class SparseDenseAttrs(Attrs):
     """Attributes used in sparse_dense operators"""
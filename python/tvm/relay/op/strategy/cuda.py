@@ -19,11 +19,21 @@
 from tvm import topi
 import tvm
 from tvm.te import SpecializedCondition
-from tvm.contrib import nvcc
+from tvm.contrib import cublaslt, nvcc
 from .generic import *
 from .. import op as _op
 from .... import get_global_func
 
+def _have_dp4a(target):
+    """Whether the GPU of the target has the int8 dot products of the int8 schedules"""
+    if target.mcpu.startswith("sm_"):
+        arch = target.mcpu[len("sm_"):]
+        return nvcc.have_int8("%s.%s" % (arch[:-1], arch[-1]))
+    if tvm.gpu(0).exist:
+        return nvcc.have_int8(tvm.gpu(0).compute_version)
+    # Cross compiling for an unknown GPU, keep the int8 schedules.
+    return True
+
 @schedule_injective.register(["cuda", "gpu"])
 def schedule_injective_cuda(attrs, outs, target):
     """schedule injective ops for cuda"""
@@ -68,6 +78,12 @@ def softmax_strategy_cuda(attrs, inputs, out_type, target):
         wrap_compute_softmax(topi.nn.softmax),
         wrap_topi_schedule(topi.cuda.schedule_softmax),
         name="softmax.cuda")
+    # Reads the input twice instead of three times, at the cost of computing exp twice
+    strategy.add_implementation(
+        wrap_compute_softmax(topi.nn.online_softmax),
+        wrap_topi_schedule(topi.cuda.schedule_softmax),
+        name="softmax.online.cuda",
+        plevel=5)
     if target.kind.name == "cuda" and "cudnn" in target.libs:
         strategy.add_implementation(
             wrap_compute_softmax(topi.cuda.softmax_cudnn),
@@ -105,8 +121,9 @@ def conv2d_strategy_cuda(attrs, inputs, out_type, target):
     if groups == 1:
         if layout == "NCHW":
             assert kernel_layout == "OIHW"
-            if data.dtype in ('int8', 'uint8') and kernel.dtype in ('int8', 'uint8'):
-                assert data.dtype == kernel.dtype
+            if data.dtype in ('int8', 'uint8') and data.dtype == kernel.dtype and \
+                    get_const_tuple(data.shape)[1] % 4 == 0 and \
+                    get_const_tuple(kernel.shape)[0] % 4 == 0 and _have_dp4a(target):
                 strategy.add_implementation(
                     wrap_compute_conv2d(topi.cuda.conv2d_nchw_int8),
                     wrap_topi_schedule(topi.cuda.schedule_conv2d_nchw_int8),
@@ -461,7 +478,9 @@ def dense_strategy_cuda(attrs, inputs, out_type, target):
     data, weights = inputs
     b, i = get_const_tuple(data.shape)
     o, _ = get_const_tuple(weights.shape)
-    if out_type.dtype == "int8":
+    # The int8 dense of qnn.dense has int32 outputs.
+    if data.dtype in ("int8", "uint8") and data.dtype == weights.dtype and i % 4 == 0 and \
+            _have_dp4a(target):
         strategy.add_implementation(
             wrap_compute_dense(topi.cuda.dense_int8),
             wrap_topi_schedule(topi.cuda.schedule_dense_int8),
@@ -495,6 +514,23 @@ def dense_strategy_cuda(attrs, inputs, out_type, target):
             plevel=25)
     return strategy
 
+@dense_bias_act_strategy.register(["cuda", "gpu"])
+def dense_bias_act_strategy_cuda(attrs, inputs, out_type, target):
+    """dense_bias_act cuda strategy"""
+    strategy = _op.OpStrategy()
+    strategy.add_implementation(
+        wrap_compute_dense_bias_act(topi.cuda.dense_bias_act),
+        wrap_topi_schedule(topi.cuda.schedule_dense_small_batch),
+        name="dense_bias_act.cuda",
+        plevel=10)
+    if target.kind.name == "cuda" and "cublas" in target.libs and cublaslt.is_available():
+        strategy.add_implementation(
+            wrap_compute_dense_bias_act(topi.cuda.dense_bias_act_cublaslt),
+            wrap_topi_schedule(topi.cuda.schedule_dense_bias_act_cublaslt),
+            name="dense_bias_act_cublaslt.cuda",
+            plevel=25)
+    return strategy
+
 @batch_matmul_strategy.register(["cuda", "gpu"])
 def batch_matmul_strategy_cuda(attrs, inputs, out_type, target):
     """batch_matmul cuda strategy"""
@@ -522,6 +558,11 @@ def sparse_dense_strategy_cuda(attrs, inputs, out_type, target):
         wrap_topi_schedule(topi.cuda.schedule_sparse_dense),
         name="sparse_dense.cuda",
         plevel=10)
+    strategy.add_implementation(
+        wrap_compute_sparse_dense(topi.cuda.sparse_dense_binned),
+        wrap_topi_schedule(topi.cuda.schedule_sparse_dense_binned),
+        name="sparse_dense_binned.cuda",
+        plevel=15)
     return strategy
 
 
@@ -592,6 +633,11 @@ def nms_strategy_cuda(attrs, inputs, out_type, target):
         wrap_compute_nms(topi.cuda.non_max_suppression),
         wrap_topi_schedule(topi.cuda.schedule_nms),
         name="nms.cuda")
+    strategy.add_implementation(
+        wrap_compute_nms(topi.cuda.non_max_suppression_bitmask),
+        wrap_topi_schedule(topi.cuda.schedule_nms),
+        name="nms_bitmask.cuda",
+        plevel=15)
     return strategy
 
 @roi_align_strategy.register(["cuda", "gpu"])
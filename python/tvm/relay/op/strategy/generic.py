@@ -85,6 +85,13 @@ def schedule_concatenate(attrs, outs, target):
     with target:
         return topi.generic.schedule_injective(outs)
 
+# resize
+@generic_func
+def schedule_resize(attrs, outs, target):
+    """Schedule resize op"""
+    # Targets without a resize specific schedule use their injective one.
+    return schedule_injective(attrs, outs, target)
+
 # pool
 @generic_func
 def schedule_pool(attrs, outs, target):
@@ -589,6 +596,35 @@ def dense_strategy(attrs, inputs, out_type, target):
                                 name="dense.generic")
     return strategy
 
+@override_native_generic_func("dense_pack_strategy")
+def dense_pack_strategy(attrs, inputs, out_type, target):
+    """dense_pack generic strategy"""
+    logger.warning("dense_pack is not optimized for this platform.")
+    strategy = _op.OpStrategy()
+    strategy.add_implementation(wrap_compute_dense(topi.nn.dense_pack),
+                                wrap_topi_schedule(topi.generic.schedule_dense),
+                                name="dense_pack.generic")
+    return strategy
+
+def wrap_compute_dense_bias_act(topi_compute):
+    """wrap dense_bias_act topi compute"""
+    def _compute_dense_bias_act(attrs, inputs, out_type):
+        """Compute definition of dense_bias_act"""
+        out_dtype = attrs.out_dtype
+        out_dtype = inputs[0].dtype if out_dtype == "" else out_dtype
+        return [topi_compute(inputs[0], inputs[1], inputs[2], attrs.activation, out_dtype)]
+    return _compute_dense_bias_act
+
+@override_native_generic_func("dense_bias_act_strategy")
+def dense_bias_act_strategy(attrs, inputs, out_type, target):
+    """dense_bias_act generic strategy"""
+    logger.warning("dense_bias_act is not optimized for this platform.")
+    strategy = _op.OpStrategy()
+    strategy.add_implementation(wrap_compute_dense_bias_act(topi.nn.dense_bias_act),
+                                wrap_topi_schedule(topi.generic.schedule_dense),
+                                name="dense_bias_act.generic")
+    return strategy
+
 # batch_matmul
 def wrap_compute_batch_matmul(topi_compute):
     """wrap batch_matmul topi compute"""
@@ -630,6 +666,13 @@ def schedule_sparse_transpose(attrs, outs, target):
     with target:
         return topi.generic.schedule_sparse_transpose(outs)
 
+# multi_sgd_update and multi_adam_update
+@generic_func
+def schedule_multi_update(attrs, outs, target):
+    """schedule the multi-tensor optimizer updates"""
+    with target:
+        return topi.generic.schedule_extern(outs)
+
 # argsort
 def wrap_compute_argsort(topi_compute):
     """Wrap argsort topi compute"""
@@ -17,6 +17,7 @@
 """Definition of ROCm operator strategy."""
 # pylint: disable=invalid-name,unused-argument,unused-wildcard-import,wildcard-import
 from tvm import topi
+from tvm.contrib import rocm
 from .generic import *
 from .. import op as _op
 
@@ -134,4 +135,17 @@ def dense_strategy_rocm(attrs, inputs, out_type, target):
             wrap_topi_schedule(topi.rocm.schedule_dense_rocblas),
             name="dense_rocblas.rocm",
             plevel=15)
+    data, weights = inputs
+    mfma = topi.rocm.tensor_intrin
+    if target.kind.name == "rocm" and rocm.have_matrixcore(target.mcpu) and \
+            data.dtype in mfma.MFMA_K and data.dtype == weights.dtype and \
+            out_type.dtype == mfma.mfma_accumulator(data.dtype):
+        batch, in_dim = get_const_tuple(data.shape)
+        out_dim, _ = get_const_tuple(weights.shape)
+        if batch % 32 == 0 and out_dim % 32 == 0 and in_dim % mfma.MFMA_K[data.dtype] == 0:
+            strategy.add_implementation(
+                wrap_compute_dense(topi.rocm.dense_mfma),
+                wrap_topi_schedule(topi.rocm.schedule_dense_mfma),
+                name="dense_mfma.rocm",
+                plevel=12)
     return strategy
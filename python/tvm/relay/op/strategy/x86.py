@@ -19,6 +19,7 @@
 import logging
 
 import re
+import tvm
 from tvm import topi
 from tvm.te import SpecializedCondition
 from .generic import *
@@ -47,6 +48,12 @@ def schedule_concatenate_cpu(attrs, outs, target):
     with target:
         return topi.x86.schedule_concatenate(outs)
 
+@schedule_resize.register("cpu")
+def schedule_resize_cpu(attrs, outs, target):
+    """schedule resize op for x86"""
+    with target:
+        return topi.x86.schedule_resize(outs)
+
 @schedule_pool.register("cpu")
 def schedule_pool_cpu(attrs, outs, target):
     """schedule pooling ops for x86"""
@@ -57,7 +64,7 @@ def schedule_pool_cpu(attrs, outs, target):
 def schedule_adaptive_pool_cpu(attrs, outs, target):
     """schedule adaptive pooling ops for x86"""
     with target:
-        return topi.x86.schedule_adaptive_pool(outs)
+        return topi.x86.schedule_adaptive_pool(outs, attrs.layout)
 
 @softmax_strategy.register("cpu")
 def softmax_strategy_cpu(attrs, inputs, out_type, target):
@@ -67,6 +74,12 @@ def softmax_strategy_cpu(attrs, inputs, out_type, target):
         wrap_compute_softmax(topi.nn.softmax),
         wrap_topi_schedule(topi.x86.schedule_softmax),
         name="softmax.x86")
+    # Reads the input twice instead of three times, at the cost of computing exp twice
+    strategy.add_implementation(
+        wrap_compute_softmax(topi.nn.online_softmax),
+        wrap_topi_schedule(topi.x86.schedule_softmax),
+        name="softmax.online.x86",
+        plevel=5)
     return strategy
 
 @schedule_log_softmax.register("cpu")
@@ -293,6 +306,29 @@ def dense_strategy_cpu(attrs, inputs, out_type, target):
                 name="dense_mkldnn.x86",
                 plevel=15,
             )
+    n, k = inputs[1].shape
+    is_dot_block = isinstance(n, tvm.tir.IntImm) and isinstance(k, tvm.tir.IntImm) and \
+        k.value % 4 == 0
+    if is_dot_block and n.value % 16 == 0 and u8s8s32 and \
+            topi.x86.is_int8_hw_support(dtype, inputs[1].dtype):
+        strategy.add_implementation(wrap_compute_dense(topi.x86.dense_vnni),
+                                    wrap_topi_schedule(topi.x86.schedule_dense_vnni),
+                                    name="dense_vnni.x86",
+                                    plevel=12)
+    if isinstance(n, tvm.tir.IntImm) and isinstance(k, tvm.tir.IntImm) and \
+            n.value % 16 == 0 and k.value % 2 == 0 and out_type.dtype == "float32" and \
+            topi.x86.is_bf16_hw_support(dtype, inputs[1].dtype):
+        strategy.add_implementation(wrap_compute_dense(topi.x86.dense_bf16),
+                                    wrap_topi_schedule(topi.x86.schedule_dense_bf16),
+                                    name="dense_bf16.x86",
+                                    plevel=12)
+    if is_dot_block and n.value % 4 == 0 and "arm_cpu" in target.keys and \
+            (dtype, out_type.dtype) in [("int8", "int32"), ("uint8", "uint32")] and \
+            topi.arm_cpu.is_int8_dot_support(dtype, inputs[1].dtype):
+        strategy.add_implementation(wrap_compute_dense(topi.arm_cpu.dense_dotprod),
+                                    wrap_topi_schedule(topi.arm_cpu.schedule_dense_dotprod),
+                                    name="dense_dotprod.arm_cpu",
+                                    plevel=12)
     with SpecializedCondition(m >= 16):
         # this implementation may not be well-optimized, so use plevel=8 for now.
         strategy.add_implementation(wrap_compute_dense(topi.x86.dense_pack),
@@ -301,6 +337,26 @@ def dense_strategy_cpu(attrs, inputs, out_type, target):
                                     plevel=5)
     return strategy
 
+@dense_pack_strategy.register("cpu")
+def dense_pack_strategy_cpu(attrs, inputs, out_type, target):
+    """dense_pack x86 strategy"""
+    strategy = _op.OpStrategy()
+    if len(inputs[1].shape) == 4:
+        # The weight is blocked for the int8 dot product, see dense_alter_op.py.
+        if "arm_cpu" in target.keys:
+            strategy.add_implementation(wrap_compute_dense(topi.arm_cpu.dense_dotprod),
+                                        wrap_topi_schedule(topi.arm_cpu.schedule_dense_dotprod),
+                                        name="dense_dotprod.arm_cpu")
+        else:
+            strategy.add_implementation(wrap_compute_dense(topi.x86.dense_vnni),
+                                        wrap_topi_schedule(topi.x86.schedule_dense_vnni),
+                                        name="dense_vnni.x86")
+        return strategy
+    strategy.add_implementation(wrap_compute_dense(topi.x86.dense_pack),
+                                wrap_topi_schedule(topi.x86.schedule_dense_pack),
+                                name="dense_pack.x86")
+    return strategy
+
 @batch_matmul_strategy.register("cpu")
 def batch_matmul_strategy_cpu(attrs, inputs, out_type, target):
     """batch_matmul x86 strategy"""
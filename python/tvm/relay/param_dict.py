@@ -21,9 +21,10 @@ import tvm._ffi
 
 
 _save_param_dict = tvm._ffi.get_global_func("tvm.relay._save_param_dict")
+_save_param_dict_mapped = tvm._ffi.get_global_func("tvm.relay._save_param_dict_mapped")
 _load_param_dict = tvm._ffi.get_global_func("tvm.relay._load_param_dict")
 
-def save_param_dict(params):
+def save_param_dict(params, mapped=False):
     """Save parameter dictionary to binary bytes.
 
     The result binary bytes can be loaded by the
@@ -34,6 +35,10 @@ def save_param_dict(params):
     params : dict of str to NDArray
         The parameter dictionary.
 
+    mapped : bool
+        Whether to use the page aligned format which GraphModule can
+        memory-map with API "load_params_from_file" instead of copying.
+
     Returns
     -------
     param_bytes: bytearray
@@ -56,6 +61,8 @@ def save_param_dict(params):
     for k, v in params.items():
         args.append(k)
         args.append(tvm.nd.array(v))
+    if mapped:
+        return _save_param_dict_mapped(*args)
     return _save_param_dict(*args)
 
 
@@ -20,6 +20,7 @@ import numpy as np
 
 import tvm
 from tvm import relay
+from tvm.topi.x86.util import target_has_avx512
 from .. import op as reg
 
 #################################################
@@ -228,8 +229,7 @@ def helper_change_dtypes_to_be_same(attrs, inputs, types, relay_op):
 
 def is_fast_int8_on_intel():
     """ Checks whether the hardware has support for fast Int8 arithmetic operations. """
-    target = tvm.target.Target.current(allow_none=False)
-    return target.mcpu in {'skylake-avx512', 'cascadelake'}
+    return target_has_avx512()
 
 def is_fast_int8_on_arm():
     """ Checks whether the hardware has support for fast Int8 arithmetic operations. """
@@ -111,7 +111,7 @@ def register_annotate_function(op_name, frewrite=None, level=10):
     return _register(frewrite) if frewrite is not None else _register
 
 
-def attach_simulated_quantize(data, kind, sign=True, rounding="round"):
+def attach_simulated_quantize(data, kind, sign=True, rounding="round", axis=-1):
     """Attach a simulated quantize operation after input data expr.
 
     Parameters
@@ -121,14 +121,18 @@ def attach_simulated_quantize(data, kind, sign=True, rounding="round"):
 
     kind: QAnnotateKind
         the kind of annotation field.
+
+    axis: int, optional
+        The channel axis to give a scale per channel, -1 for a single scale.
     """
     quantize_op = _op.get("relay.op.annotation.simulated_quantize")
     if isinstance(data, _expr.Call) and data.op == quantize_op:
-        if data.attrs.kind == kind and data.attrs.sign == sign and data.attrs.rounding == rounding:
+        if data.attrs.kind == kind and data.attrs.sign == sign and \
+                data.attrs.rounding == rounding and data.attrs.axis == axis:
             return data
 
     qctx = quantize_context()
-    key = tuple([data, kind, sign, rounding])
+    key = tuple([data, kind, sign, rounding, axis])
     if key in qctx.qnode_map:
         return qctx.qnode_map[key]
 
@@ -136,7 +140,7 @@ def attach_simulated_quantize(data, kind, sign=True, rounding="round"):
     clip_min = _expr.var("clip_min")
     clip_max = _expr.var("clip_max")
     qnode = _quantize.simulated_quantize(
-        data, dom_scale, clip_min, clip_max, kind, sign, rounding)
+        data, dom_scale, clip_min, clip_max, kind, sign, rounding, axis)
     qctx.qnode_map[key] = qnode
     return qnode
 
@@ -144,6 +148,13 @@ tvm._ffi.register_func(
     "relay.quantize.attach_simulated_quantize", attach_simulated_quantize)
 
 
+def _weight_channel_axis(layout):
+    """The output channel axis of a weight layout to quantize per channel, or -1"""
+    if not current_qconfig().weight_per_channel or 'O' not in layout or 'o' in layout:
+        return -1
+    return layout.index('O')
+
+
 @register_annotate_function("nn.contrib_conv2d_NCHWc")
 def conv2d_nchwc_rewrite(ref_call, new_args, ctx):
     warnings.warn("NCHWc layout Conv2D detected, please use a lower "
@@ -166,7 +177,8 @@ def conv2d_rewrite(ref_call, new_args, ctx):
         lhs_expr = attach_simulated_quantize(lhs_expr, QAnnotateKind.INPUT)
 
     assert rhs_kind is None
-    rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.WEIGHT)
+    axis = _weight_channel_axis(str(ref_call.attrs.kernel_layout))
+    rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.WEIGHT, axis=axis)
 
     expr = _forward_op(ref_call, [lhs_expr, rhs_expr])
 
@@ -191,7 +203,8 @@ def dense_rewrite(ref_call, new_args, ctx):
         lhs_expr = attach_simulated_quantize(lhs_expr, QAnnotateKind.INPUT)
 
     assert rhs_kind is None
-    rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.WEIGHT)
+    axis = _weight_channel_axis("OI")
+    rhs_expr = attach_simulated_quantize(rhs_expr, QAnnotateKind.WEIGHT, axis=axis)
 
     expr = _forward_op(ref_call, [lhs_expr, rhs_expr])
 
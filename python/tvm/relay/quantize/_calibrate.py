@@ -17,7 +17,6 @@
 """Find scales for quantization on the dataset."""
 from __future__ import absolute_import
 import logging
-import multiprocessing as mp
 import numpy as np
 import tvm
 import tvm.driver
@@ -30,7 +29,6 @@ from .. import expr as _expr
 from .. import analysis as _analysis
 from .. import build_module as _build_module
 from ...contrib import graph_runtime
-from .kl_divergence import _find_scale_by_kl
 
 
 def _get_profile_runtime(mod):
@@ -91,15 +89,24 @@ def collect_stats(mod, dataset, chunk_by=-1):
         yield [np.concatenate(output).reshape(-1) for output in outputs]
 
 
-def _kl_scale(mod, dataset):
-    cfg = quantize.current_qconfig()
-    chunk_by = cfg.calibrate_chunk_by
-    scales = []
-    for samples in collect_stats(mod, dataset, chunk_by):
-        logging.info("finding threshold with kl for calibration...")
-        with mp.Pool() as pool:
-            scales += list(pool.map(_find_scale_by_kl, samples))
+def _streaming_calibrator(mod, dataset, num_bins=8001):
+    """Run the profile graph on the calibration dataset and fold the input of every
+    simulated_quantize op into a streaming histogram, batch by batch, so that only the
+    histograms stay in memory."""
+    logging.info("collecting histograms for calibration...")
+    runtime = _get_profile_runtime(mod)
+    num_outputs = runtime.get_num_outputs()
+    calibrator = _quantize.CreateStreamingCalibrator(num_bins)
+    for batch in dataset:
+        runtime.set_input(**batch)
+        runtime.run()
+        outputs = [runtime.get_output(i) for i in range(num_outputs)]
+        _quantize.StreamingCalibratorUpdate(calibrator, *outputs)
+    return calibrator
 
+
+def _scale_by_order(scales):
+    """Hand out the scales in the order of the profiled simulated_quantize ops"""
     def func(_):
         scale = scales[func.scale_idx]
         func.scale_idx += 1
@@ -109,6 +116,22 @@ def _kl_scale(mod, dataset):
     return func
 
 
+def _kl_scale(mod, dataset, num_quantized_bins=255):
+    calibrator = _streaming_calibrator(mod, dataset)
+    logging.info("finding threshold with kl for calibration...")
+    thresholds = _quantize.StreamingCalibratorKLThresholds(calibrator, num_quantized_bins)
+    return _scale_by_order([t.value for t in thresholds])
+
+
+def _percentile_scale(mod, dataset):
+    cfg = quantize.current_qconfig()
+    calibrator = _streaming_calibrator(mod, dataset)
+    logging.info("finding threshold with percentile for calibration...")
+    thresholds = _quantize.StreamingCalibratorPercentileThresholds(
+        calibrator, cfg.calibrate_percentile)
+    return _scale_by_order([t.value for t in thresholds])
+
+
 def _set_params(mod, input_scale_func, weight_scale_func):
     quantize_op = _op.get("relay.op.annotation.simulated_quantize")
     cfg = quantize.current_qconfig()
@@ -131,6 +154,8 @@ def _set_params(mod, input_scale_func, weight_scale_func):
                 scale = input_scale_func(expr)
 
             def _make_const(val):
+                if np.ndim(val) > 0:
+                    return _expr.const(np.asarray(val, 'float32'))
                 return _expr.const(val, 'float32')
 
             valid_range = 2**valid_bit
@@ -149,19 +174,33 @@ def _set_params(mod, input_scale_func, weight_scale_func):
 
 
 # weight scale functions
-def _power2_scale(sq_call):  # pylint: disable=unused-argument
-    """calculate weight scale with nearest mode-2 scale"""
+def _abs_max(sq_call):
+    """maximum absolute value of the weight, per channel when the simulated
+    quantize has a channel axis, keeping the reduced dims for broadcasting"""
     var = sq_call.args[0]
     assert isinstance(var, _expr.Constant)
-    val = np.amax(np.abs(var.data.asnumpy()))
+    data = np.abs(var.data.asnumpy())
+    axis = sq_call.attrs.axis
+    if axis < 0:
+        return np.amax(data)
+    reduce_axes = tuple(i for i in range(data.ndim) if i != axis)
+    return np.amax(data, axis=reduce_axes, keepdims=True)
+
+
+def _power2_scale(sq_call):  # pylint: disable=unused-argument
+    """calculate weight scale with nearest mode-2 scale"""
+    val = _abs_max(sq_call)
+    if np.ndim(val) > 0:
+        safe_val = np.where(val > 0, val, 1.0)
+        return np.where(val > 0, 2**np.ceil(np.log2(safe_val)), 1.0).astype('float32')
     return 2**np.math.ceil(np.math.log(val, 2)) if val > 0 else 1.0
 
 
 def _max_scale(sq_call):
     """calculate weight scale with maximum absolute value"""
-    var = sq_call.args[0]
-    assert isinstance(var, _expr.Constant)
-    val = np.amax(np.abs(var.data.asnumpy()))
+    val = _abs_max(sq_call)
+    if np.ndim(val) > 0:
+        return np.where(val > 0, val, 1.0).astype('float32')
     return val
 
 
@@ -192,6 +231,8 @@ def calibrate(dataset=None):
 
         if cfg.calibrate_mode == 'kl_divergence':
             input_scale_func = _kl_scale(mod, dataset)
+        elif cfg.calibrate_mode == 'percentile':
+            input_scale_func = _percentile_scale(mod, dataset)
         elif cfg.calibrate_mode == 'global_scale':
             input_scale_func = _global_scale
         else:
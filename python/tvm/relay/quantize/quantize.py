@@ -79,6 +79,7 @@ class QConfig(Object):
         "calibrate_mode": "global_scale",
         "global_scale": 8.0,
         "weight_scale": "power2",
+        "weight_per_channel": False,
         "skip_dense_layer": True,
         "skip_conv_layers": [0],
         "do_simulation": False,
@@ -86,6 +87,7 @@ class QConfig(Object):
         "debug_enabled_ops": None,
         "rounding": "UPWARD",
         "calibrate_chunk_by": -1,
+        "calibrate_percentile": 0.9999,
         "partition_conversions": "disabled",
     }
 
@@ -147,9 +149,16 @@ def qconfig(**kwargs):
         Number of bit for every kind of annotate field.
 
     calibrate_mode: str
-        The calibration mode. 'global_scale' or 'kl_divergence'.
+        The calibration mode. 'global_scale', 'kl_divergence' or 'percentile'.
         global_scale: use global scale
         kl_divergence: find scales by kl divergence on the dataset.
+        percentile: find scales covering calibrate_percentile of the absolute values
+        on the dataset.
+        Both dataset modes stream the batches into per-tensor histograms, so the
+        activations of the whole dataset are never kept in memory.
+
+    calibrate_percentile: float
+        The fraction of absolute values covered by the scale in 'percentile' mode.
 
     global_scale: float
         The global scale for calibration.
@@ -160,6 +169,11 @@ def qconfig(**kwargs):
         of two.
         max: Find the maximum of the absolute value of the tensor
 
+    weight_per_channel: boolean
+        Whether to give the weights of conv2d and dense one scale per output channel
+        instead of a single scale for the whole tensor. The per-channel accumulators
+        are requantized axis-wise back to a per-tensor scale.
+
     skip_dense_layer: boolean
         Whether to skip all nn.dense layer type. By default are skipped.
 
@@ -20,10 +20,11 @@ A pass for manifesting explicit memory allocations.
 """
 from typing import Optional, Dict, List, Tuple
 from collections import defaultdict
+import itertools
 import attr
 
 from ..expr_functor import ExprMutator
-from .. import op, expr
+from .. import op, expr, analysis
 from ..function import Function
 from ... import register_func, ir, cpu
 from ..._ffi.runtime_ctypes import TVMContext
@@ -55,13 +56,20 @@ class Region:
     dtype: Optional[str]
     ctx: TVMContext
     offsets: Dict[expr.Var, Tuple[expr.Expr, expr.Expr]]
+    # The size of the region in bytes while every allocation in it has a
+    # constant size, None once a dynamically sized allocation is added.
+    static_size: Optional[int]
+    # The (offset, size) of each live constant sized allocation.
+    slots: Dict[expr.Var, Tuple[int, int]]
+    # The (offset, size) of dead slots which can be reused, sorted by offset.
+    free_slots: List[Tuple[int, int]]
 
     @staticmethod
     def empty(region_no):
         zero = expr.const(0, dtype="int64")
         assert len(zero.data.shape) == 0
         region_var = expr.var(f"region{region_no}")
-        return Region(region_var, zero, None, None, None, {})
+        return Region(region_var, zero, None, None, None, {}, 0, {}, [])
 
     def grow(
             self, old_storage: expr.Var,
@@ -95,9 +103,68 @@ class Region:
 
         # Record the offset at which we allocate the storage.
         offset_var: expr.RelayExpr = expr.var(f"offset{len(self.offsets)}")
-        self.offsets[old_storage] = (offset_var, self.size)
 
-        self.size = self.size + new_size
+        nbytes = self.static_bytes(size)
+        if nbytes is not None and self.static_size is not None:
+            offset = self.take_slot(nbytes)
+            self.slots[old_storage] = (offset, nbytes)
+            self.offsets[old_storage] = (offset_var, expr.const(offset, "int64"))
+            self.size = expr.const(self.static_size, "int64")
+        else:
+            # Once the layout depends on a dynamic size we can no longer
+            # reason about slot reuse, so fall back to plain packing.
+            self.static_size = None
+            self.free_slots = []
+            self.offsets[old_storage] = (offset_var, self.size)
+            self.size = self.size + new_size
+
+    def static_bytes(self, size: expr.Expr) -> Optional[int]:
+        """The aligned size in bytes of a constant sized allocation, otherwise None."""
+        if not isinstance(size, expr.Constant) or not isinstance(self.alignment, expr.Constant):
+            return None
+        nbytes = int(size.data.asnumpy().item())
+        align = int(self.alignment.data.asnumpy().item())
+        return (nbytes + align - 1) // align * align
+
+    def take_slot(self, nbytes: int) -> int:
+        """Find an offset for a constant sized allocation, reusing dead slots if possible."""
+        best = None
+        for i, (offset, size) in enumerate(self.free_slots):
+            if size >= nbytes and (best is None or size < self.free_slots[best][1]):
+                best = i
+
+        if best is not None:
+            offset, size = self.free_slots.pop(best)
+            if size > nbytes:
+                self.free_slots.insert(best, (offset + nbytes, size - nbytes))
+            return offset
+
+        # A dead slot at the end of the region can be extended in place.
+        if self.free_slots:
+            offset, size = self.free_slots[-1]
+            if offset + size == self.static_size:
+                self.free_slots.pop()
+                self.static_size = offset + nbytes
+                return offset
+
+        offset = self.static_size
+        self.static_size += nbytes
+        return offset
+
+    def release(self, old_storage: expr.Var) -> None:
+        """Mark the slot of a dead storage as reusable by later allocations."""
+        if self.static_size is None or old_storage not in self.slots:
+            return
+
+        offset, size = self.slots.pop(old_storage)
+        free_slots = sorted(self.free_slots + [(offset, size)])
+        merged: List[Tuple[int, int]] = []
+        for offset, size in free_slots:
+            if merged and merged[-1][0] + merged[-1][1] == offset:
+                merged[-1] = (merged[-1][0], merged[-1][1] + size)
+            else:
+                merged.append((offset, size))
+        self.free_slots = merged
 
     def offset_for(self, alloc: expr.Expr) -> expr.Expr:
         return self.offsets.get(alloc, [None])[0]
@@ -151,6 +218,45 @@ def iterative_let(let, each_binding, kont):
 
 
 
+def storage_liveness(let):
+    """
+    Compute when each storage allocated in a let chain dies.
+
+    Returns a map from binding position to the storages whose last use
+    is the binding just before it. A storage is used by every binding
+    which mentions it, directly or through a value which may alias it
+    such as a tensor allocated from it. Storages reachable from the body
+    of the chain escape the scope and are never reported dead.
+    """
+    non_aliasing = [op.op.get(name) for name in
+                    ("vm.invoke_tvm_op", "vm.shape_func", "vm.shape_of")]
+    alloc_storage = op.op.get("memory.alloc_storage")
+
+    bindings = []
+    while isinstance(let, expr.Let):
+        bindings.append((let.var, let.value))
+        let = let.body
+
+    end = len(bindings)
+    last_use = {var: end for var in analysis.free_vars(let)}
+    for pos in reversed(range(end)):
+        var, value = bindings[pos]
+        if isinstance(value, expr.Call) and value.op in non_aliasing:
+            use_end = pos
+        else:
+            use_end = max(pos, last_use.get(var, pos))
+        for free_var in analysis.free_vars(value):
+            last_use[free_var] = max(last_use.get(free_var, pos), use_end)
+
+    dead = defaultdict(list)
+    for pos, (var, value) in enumerate(bindings):
+        if isinstance(value, expr.Call) and value.op == alloc_storage:
+            var_end = last_use.get(var, pos)
+            if var_end < end:
+                dead[var_end + 1].append(var)
+    return dead
+
+
 def mk_let(bindings, body):
     for var, value in reversed(bindings):
         assert var
@@ -169,13 +275,13 @@ class StorageCoalesce(ExprMutator):
     """
     A pass for coalescing allocations into region/arena allocations.
 
-    After this pass each allocation comes from the same backing storage,
-    but will never overlap even in time, i.e. the allocations are just
-    packed into a contiguous block of memory.
+    After this pass each allocation comes from the same backing storage.
+    Liveness is computed over each let chain, and when an early tensor
+    dies a later constant sized allocation will reuse its slot, i.e. the
+    allocations overlap in space whenever their lifetimes are disjoint.
 
-    A secondary part of memory planning will perform liveness analysis to
-    overlap these in time, i.e when an early tensor dies we will attempt
-    to reuse its slot.
+    Each branch of an if is planned in its own region, so allocations in
+    the two branches never contribute to each other's size.
     """
 
     def __init__(self):
@@ -209,6 +315,13 @@ class StorageCoalesce(ExprMutator):
 
         raise Exception("could not find offset in any valid region")
 
+    def release_storage(self, old_storage):
+        for dtype_region in reversed(self.regions):
+            for region in dtype_region.values():
+                if old_storage in region.offsets:
+                    region.release(old_storage)
+                    return
+
     def visit_function(self, fn):
         """Transform the function body to use region allocation scheme."""
         func = fn
@@ -255,7 +368,13 @@ class StorageCoalesce(ExprMutator):
 
     def visit_let(self, let):
         dynamic_regions = []
+        dead = storage_liveness(let)
+        positions = itertools.count()
+
         def _each_binding(lhs, rhs):
+            for old_storage in dead.get(next(positions), []):
+                self.release_storage(old_storage)
+
             if isinstance(rhs, expr.Call) and rhs.op == op.op.get(
                     "memory.alloc_storage"
             ):
@@ -265,9 +384,12 @@ class StorageCoalesce(ExprMutator):
             ):
                 return self.process_alloc_tensor(lhs, rhs)
             else:
-                return lhs, rhs
+                return lhs, self.visit(rhs)
+
+        def _kont(bindings, body):
+            return self.mk_let(dynamic_regions)(bindings, self.visit(body))
 
-        result = iterative_let(let, _each_binding, self.mk_let(dynamic_regions))
+        result = iterative_let(let, _each_binding, _kont)
         assert result
         return result
 
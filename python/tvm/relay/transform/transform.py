@@ -18,6 +18,7 @@
 """
 Relay pass transformation infrastructure.
 """
+import collections
 import types
 import inspect
 import functools
@@ -190,6 +191,53 @@ def FastMath():
     return _ffi_api.FastMath()
 
 
+def ToMixedPrecision(mixed_precision_type="float16", allow_ops=None, follow_ops=None,
+                     deny_ops=None, accumulation_type="float32"):
+    """Run the float32 parts of the program in float16 or bfloat16.
+
+    Compute bound operators (allow list) such as conv2d and dense take their
+    inputs and produce their output in the mixed type, the accumulating ones
+    (convolutions, dense and batch_matmul) accumulate in accumulation_type
+    before their output is cast to the mixed type. Cheap operators
+    (follow list) stay in the mixed type when one of their inputs is, and
+    operators that need float32 range or accumulation such as softmax and
+    reductions (deny list) get their inputs cast back to float32. Injective
+    operators follow and other operators are denied unless a list says
+    otherwise. The function signature keeps its float32 types, run
+    FoldConstant after binding the parameters to store constant weights in
+    the mixed type.
+
+    On CPUs, bfloat16 kernels are lowered by the BF16Legalize TIR pass, which
+    keeps the tensors in bfloat16 and computes in float32.
+
+    Parameters
+    ----------
+    mixed_precision_type : str
+        The mixed type, float16 or bfloat16.
+
+    allow_ops : Optional[List[str]]
+        The operators added to the allow list.
+
+    follow_ops : Optional[List[str]]
+        The operators added to the follow list.
+
+    deny_ops : Optional[List[str]]
+        The operators added to the deny list.
+
+    accumulation_type : str
+        The out_dtype of the convolutions, dense and batch_matmul, float32 or
+        the mixed type. batch_matmul has no out_dtype, so it stays in float32
+        when accumulation_type is float32.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that converts the program to mixed precision.
+    """
+    return _ffi_api.ToMixedPrecision(mixed_precision_type, allow_ops or [], follow_ops or [],
+                                     deny_ops or [], accumulation_type)
+
+
 def CanonicalizeOps():
     """Canonicalize special operators to basic operators.
     This can simplify followed analysis, e.g. expanding bias_add to
@@ -260,9 +308,51 @@ def FuseOps(fuse_opt_level=-1):
     return _ffi_api.FuseOps(fuse_opt_level)
 
 
+def ReorderForPeakMemory():
+    """Reorder the calls of dataflow functions to lower their peak memory.
+
+    Among the calls whose inputs are ready, the one that grows the live
+    bytes least is run first. The order is made explicit with a chain of
+    lets, which the graph memory planner follows. A function is left
+    unchanged when the new order does not lower its estimated peak.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that reorders the calls.
+    """
+    return _ffi_api.ReorderForPeakMemory()
+
+
+def Rematerialize(memory_budget=0):
+    """Recompute cheap activations instead of keeping them alive.
+
+    While the estimated peak memory of a function exceeds the budget, the
+    largest value alive at the peak that one injective call can recompute
+    is recomputed right before its first use after the peak. This trades
+    compute for memory in training graphs, whose backward part reads the
+    activations of the forward part.
+
+    Parameters
+    ----------
+    memory_budget : int
+        The budget in bytes, recompute as much as possible when it is 0.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that rematerializes the activations.
+    """
+    return _ffi_api.Rematerialize(memory_budget)
+
+
 def CombineParallelConv2D(min_num_branches=3):
     """Combine multiple conv2d operators into one.
 
+    The branches may differ in their output channels, and in their kernel
+    sizes when the windows are centered the same way, e.g. a 1x1 conv2d and
+    a 3x3 conv2d with padding 1. Smaller kernels are padded with zeros.
+
     Parameters
     ----------
     min_num_branches : int
@@ -414,6 +504,38 @@ def ConvertLayout(desired_layouts):
     return _ffi_api.ConvertLayout(desired_layouts)
 
 
+def PlanLayout(candidates, op_cost=None, transform_cost=1.0):
+    """Choose the layouts of all the calls together, instead of op by op.
+
+    Every call to an op with candidates either keeps its layouts or is
+    converted to one of the candidates, the way ConvertLayout converts it.
+    The assignment is chosen by dynamic programming over the dataflow graph
+    to minimize the cost of the ops plus the cost of the layout transforms
+    between them, which avoids transforming back and forth between
+    neighbouring ops.
+
+    Parameters
+    ----------
+    candidates : map of op_name to list of list of layouts
+        Specify a mapping of operator names to candidate desired layouts, each in the
+        format taken by ConvertLayout. For example:
+        {"nn.conv2d": [["NHWC", "HWIO"], ["NCHW", "OIHW"]]}.
+
+    op_cost : Optional[Callable[[tvm.relay.Call, List[str]], float]]
+        The cost of a call in the desired layouts, which are empty for its original
+        layouts. All layouts cost the same when not given.
+
+    transform_cost : float
+        The cost of a layout transform per byte of the transformed tensor.
+
+    Returns
+    -------
+    pass: FunctionPass
+      The pass.
+    """
+    return _ffi_api.PlanLayout(candidates, op_cost, transform_cost)
+
+
 def Legalize(legalize_map_attr_name="FTVMLegalize"):
     """Legalizes an expression with another expression.
     This pass can be used to replace an expr with another expr for target
@@ -481,6 +603,28 @@ def MergeCompilerRegions():
     return _ffi_api.MergeCompilerRegions()
 
 
+def PruneCompilerRegions(region_cost):
+    """Annotate the compiler regions which are not faster on their compiler
+    than on TVM with the "default" compiler, so PartitionGraph does not
+    offload them. Run it after MergeCompilerRegions, on the largest regions.
+
+    Parameters
+    ----------
+    region_cost : Callable[[tvm.relay.Function, str], float]
+        The cost of a region, as a function from its inputs to its outputs, on
+        a compiler, or on TVM when the compiler is "default". The cost of
+        offloading includes the launch of the region and the moves of its
+        inputs and outputs. It can be estimated, or measured by building the
+        function for both.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that prunes the unprofitable compiler regions.
+    """
+    return _ffi_api.PruneCompilerRegions(region_cost)
+
+
 def RewriteAnnotatedOps(fallback_device):
     """Rewrite the annotated program where annotation operators, e.g.
     `on_deivce`, mark which device an expression should be scheduled to.
@@ -502,6 +646,54 @@ def RewriteAnnotatedOps(fallback_device):
     return _ffi_api.RewriteDeviceAnnotation(fallback_device)
 
 
+def _device_type(device):
+    if isinstance(device, int):
+        return device
+    if isinstance(device, str):
+        return _nd.context(device).device_type
+    return device.device_type
+
+
+def AutoDevicePlacement(devices, op_cost, transfer_cost=None, fallback_device=None):
+    """Annotate the operators with the devices minimizing the estimated
+    end-to-end latency, for a heterogeneous build.
+
+    The latency is the sum of the cost of every operator on its device and of
+    every copy between two devices. The operators already annotated with
+    `on_device` stay on their device. The annotations are turned into device
+    copies by RewriteAnnotatedOps when building for several targets.
+
+    Parameters
+    ----------
+    devices : List[Union[TVMContext, str, int]]
+        The candidate devices.
+
+    op_cost : Callable[[tvm.relay.Call, int], float]
+        The cost of an operator call on a device type, e.g. the latency of its
+        best schedule in the tuning logs. A negative cost means the device
+        does not support the operator.
+
+    transfer_cost : Optional[Callable[[int, int, int], float]]
+        The cost of copying a number of bytes from a device type to another.
+        Defaults to 10us plus 10GB/s, in seconds.
+
+    fallback_device : Optional[Union[TVMContext, str, int]]
+        The device preferred when the costs are equal, the first device by default.
+
+    Returns
+    -------
+    ret: tvm.transform.Pass
+        The registered pass that annotates the operators with `on_device`.
+    """
+    device_types = [_device_type(dev) for dev in devices]
+    if fallback_device is None:
+        fallback_device = device_types[0]
+    if transfer_cost is None:
+        transfer_cost = lambda nbytes, src, dst: 1e-5 + nbytes / 1e10
+    return _ffi_api.AutoDevicePlacement(device_types, op_cost, transfer_cost,
+                                        _device_type(fallback_device))
+
+
 def ToANormalForm():
     """Turn Graph Normal Form expression into A Normal Form Expression.
     The scope of the root expression is the global scope.
@@ -607,6 +799,18 @@ def EliminateCommonSubexpr(fskip=None):
     return _ffi_api.EliminateCommonSubexpr(fskip)
 
 
+def DeduplicateConstants():
+    """Merge the constants which hold identical tensors into one constant, e.g.
+    the tied or repeated weights of a model after its parameters are bound.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that deduplicates constants.
+    """
+    return _ffi_api.DeduplicateConstants()
+
+
 def PartialEvaluate():
     """Evaluate the static fragment of the code.
 
@@ -617,6 +821,13 @@ def PartialEvaluate():
     expression is provided. Otherwise, it will rely on the pass manager to
     carry out transformation.
 
+    Calls of closed, monomorphic global functions are memoized by their static
+    arguments: after the first call is expanded in place, the next calls with
+    the same static arguments share a global function specialized for them.
+    The ``relay.PartialEval.memoize`` config turns this off. The
+    ``relay.PartialEval.max_specializations`` config bounds the number of
+    function bodies specialized, the remaining calls are kept as they are.
+
     Returns
     -------
     ret: tvm.transform.Pass
@@ -628,6 +839,7 @@ def PartialEvaluate():
 def CanonicalizeCast():
     """
     Canonicalize cast expressions to make operator fusion more efficient.
+    Casts back to the source type of a lossless upcast are folded away.
 
     Returns
     -------
@@ -693,6 +905,34 @@ def DynamicToStatic():
     return _ffi_api.DynamicToStatic()
 
 
+def SpecializeDynamicShapes(shape_profile):
+    """Add a static fast path for the common shapes of the dynamic inputs.
+
+    The function checks the shapes of the profiled inputs at run time. When
+    they match, it runs a copy of its body where the inputs have static
+    shapes, which DynamicToStatic turns into static operators. Otherwise it
+    runs the original dynamic body.
+
+    Parameters
+    ----------
+    shape_profile : Dict[str, Union[List[int], List[List[int]]]]
+        Map from an input name to its common shape, or to the shapes observed
+        when profiling the model, in which case the most frequent one is used.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that specializes the dynamic shapes.
+    """
+    shapes = {}
+    for name, shape in shape_profile.items():
+        shape = list(shape)
+        if shape and isinstance(shape[0], (list, tuple)):
+            shape = collections.Counter(tuple(s) for s in shape).most_common(1)[0][0]
+        shapes[name] = [int(dim) for dim in shape]
+    return _ffi_api.SpecializeDynamicShapes(shapes)
+
+
 def Inline():
     """Perform inlining on the given Relay IR module. The global functions that
     are marked as `inline` should be always inlined. A cost model will be
@@ -967,6 +1207,29 @@ def DenseToSparse(weight_name, weight_shape):
     return _ffi_api.DenseToSparse(weight_name, weight_shape)
 
 
+def Conv2dToSparse(weight_name, weight_shape):
+    """
+    Rewrite qualified ```nn.conv2d operation``` to one ```nn.sparse_dense``` per
+    tap of the kernel with non-zero weights
+    This pass is used in ```data_dep_optimization.bsr_conv2d```
+    Parameters of this pass is generated by ```analysis.sparse_conv2d.process_params```
+
+    Parameters
+    ----------
+    weight_name: Array[String]
+      Names of weights which qualified sparse contrains
+
+    weight_shape: Array[Array[IntImm]]
+      The number of taps, then the row, column and BSR shape of each tap.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered Conv2dToSparse pass.
+    """
+    return _ffi_api.Conv2dToSparse(weight_name, weight_shape)
+
+
 def SimplifyFCTranspose(target_weight_name):
     """
     Rewrite ```y = nn.dense(x, transpose(w, [1, 0]))``` to ```y = nn.dense(x, wt)```
@@ -996,3 +1259,40 @@ def SimplifyExpr():
         The registered SimplifyExpr pass.
     """
     return _ffi_api.SimplifyExpr()
+
+
+def FuseDenseEpilogue():
+    """
+    Fuse 2D dense with the bias add and relu or gelu that follow it into
+    nn.contrib_dense_bias_act, so libraries that apply them in the GEMM
+    epilogue, such as cuBLASLt, are offloaded the whole chain.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered FuseDenseEpilogue pass.
+    """
+    return _ffi_api.FuseDenseEpilogue()
+
+
+def FuseOptimizerUpdates():
+    """
+    Fuse the SGD and Adam updates of the parameters of a training step into
+    nn.multi_sgd_update and nn.multi_adam_update, which update all the
+    parameters sharing a learning rate in one kernel. The updates matched are
+    w - lr * g for SGD, and for Adam
+
+    .. code-block:: python
+
+        m1 = beta1 * m + (1 - beta1) * g
+        v1 = beta2 * v + (1 - beta2) * g * g
+        w1 = w - lr * m1 / (sqrt(v1) + epsilon)
+
+    with the weights and moments being variables. Expects the graph normal form.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered FuseOptimizerUpdates pass.
+    """
+    return _ffi_api.FuseOptimizerUpdates()
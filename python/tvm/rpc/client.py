@@ -71,6 +71,57 @@ class RPCSession(object):
         """
         return self._sess.get_function(name)
 
+    def submit(self, func, *args):
+        """Call a remote function without waiting for its return.
+
+        The request is sent right away. The remote serves the requests of
+        a session in order, so several calls can be in flight at the same
+        time, e.g. the next module can be uploaded while the current one is
+        being measured.
+
+        Parameters
+        ----------
+        func : Function
+            The remote function, e.g. from get_function or a remote module.
+
+        args : list
+            The arguments of the function.
+
+        Returns
+        -------
+        wait : Function
+            Function that waits for the call and returns its return value,
+            or raises the error raised by the remote.
+
+        Note
+        ----
+        Any other request made through the session, including a synchronous
+        call, also waits for the calls submitted before it.
+        """
+        return _ffi_api.SubmitCall(func, *args)
+
+    def set_payload_options(self, compress=True, cache=True):
+        """Set how the large copies to the remote send their data.
+
+        Parameters
+        ----------
+        compress : bool, optional
+            Whether to compress the data with lz4, when it shrinks enough.
+
+        cache : bool, optional
+            Whether to skip sending data the remote already has in its
+            payload cache, e.g. the same weights uploaded by an earlier
+            session. The remote enables its cache by setting the environment
+            variable TVM_RPC_PAYLOAD_CACHE_DIR.
+
+        Returns
+        -------
+        enabled : str
+            The features enabled after negotiating with the remote,
+            separated by commas.
+        """
+        return _ffi_api.SetPayloadOptions(self._sess, compress, cache)
+
     def context(self, dev_type, dev_id=0):
         """Construct a remote context.
 
@@ -206,8 +257,12 @@ class LocalSession(RPCSession):
         RPCSession.__init__(self, _ffi_api.LocalSession())
 
 
+# The capacity in bytes of each ring of a shared memory popen session.
+SHM_RING_CAPACITY = 4 << 20
+
+
 @tvm._ffi.register_func("rpc.PopenSession")
-def _popen_session(binary):
+def _popen_session(binary, shared_memory=False):
     temp = util.tempdir()
 
     if isinstance(binary, (bytes, bytearray)):
@@ -223,7 +278,10 @@ def _popen_session(binary):
         if not os.access(path_exec, os.X_OK):
             raise RuntimeError(f"{path_exec} is not executable.")
 
-    sess = _ffi_api.CreatePipeClient(path_exec)
+    if shared_memory:
+        sess = _ffi_api.CreateShmClient(SHM_RING_CAPACITY, path_exec)
+    else:
+        sess = _ffi_api.CreatePipeClient(path_exec)
     return sess
 
 
@@ -234,9 +292,14 @@ class PopenSession(RPCSession):
     ----------
     binary : List[Union[str, bytes]]
         The binary to be executed.
+
+    shared_memory : bool, optional
+        Whether to communicate over rings in shared memory instead of pipes,
+        which saves the copies of the data through the kernel.
+        The binary must be a minrpc popen server.
     """
-    def __init__(self, binary):
-        RPCSession.__init__(self, _popen_session(binary))
+    def __init__(self, binary, shared_memory=False):
+        RPCSession.__init__(self, _popen_session(binary, shared_memory))
 
 
 class TrackerSession(object):
@@ -224,6 +224,41 @@ class Module(object):
         except NameError:
             raise NameError("time_evaluate is only supported when RPC is enabled")
 
+    def save_pgo_profile(self, file_name, reset=False):
+        """Save the profile of the branches and loops counted by the module and
+        its imports, built with the "codegen.llvm.pgo_instrument" config.
+
+        Rebuilding with the "tir.pgo_profile" config set to the file weights the
+        branches of the kernels and keeps the loops which never ran from growing.
+
+        Parameters
+        ----------
+        file_name : str
+            The name of the JSON profile.
+
+        reset : bool, optional
+            Whether to zero the counters once saved.
+        """
+        import json
+        profile = {}
+        visited, stack = set([self]), [self]
+        while stack:
+            module = stack.pop()
+            if module.type_key in ("llvm", "library"):
+                fprofile = module.get_function("__tvm_pgo_profile")
+                text = fprofile(reset)
+                for key, counters in (json.loads(text) if text else {}).items():
+                    old = profile.get(key, [0, 0])
+                    profile[key] = [old[0] + counters[0], old[1] + counters[1]]
+            for m in module.imported_modules:
+                if m not in visited:
+                    visited.add(m)
+                    stack.append(m)
+        if not profile:
+            raise ValueError("The module is not built with the codegen.llvm.pgo_instrument config")
+        with open(file_name, "w") as f:
+            json.dump(profile, f)
+
     def _collect_dso_modules(self):
         """Helper function to collect dso modules, then return it."""
         visited, stack, dso_modules = set(), [], []
@@ -247,6 +282,7 @@ class Module(object):
                        file_name,
                        fcompile=None,
                        addons=None,
+                       params_section=False,
                        **kwargs):
         """Export the module and its imported device code one library.
 
@@ -263,6 +299,14 @@ class Module(object):
             If fcompile has attribute object_format, will compile host library
             to that format. Otherwise, will use default format "o".
 
+        addons : list of str, optional
+            Additional files to link into the library.
+
+        params_section : bool, optional
+            Whether to store the params and constants of the imported modules
+            in a page aligned read-only section of the library, which the loaded
+            modules use in place instead of copying them. Requires LLVM.
+
         kwargs : dict, optional
             Additional arguments passed to fcompile
         """
@@ -300,9 +344,14 @@ class Module(object):
                     assert module.type_key == "c"
                     object_format = "cc"
                     has_c_module = True
-            path_obj = temp.relpath("lib" + str(index) + "." + object_format)
-            module.save(path_obj)
-            files.append(path_obj)
+            if module.type_key == "llvm" and object_format == "o":
+                # a module generated on several threads is emitted to one object per part.
+                save_parts = module.get_function("_save_object_parts")
+                files += [str(path) for path in save_parts(temp.relpath("lib" + str(index)))]
+            else:
+                path_obj = temp.relpath("lib" + str(index) + "." + object_format)
+                module.save(path_obj)
+                files.append(path_obj)
             is_system_lib = (module.type_key == "llvm" and
                              module.get_function("__tvm_is_system_module")())
             llvm_target_triple = (module.type_key == "llvm" and
@@ -322,10 +371,13 @@ class Module(object):
         if self.imported_modules:
             if enabled("llvm") and llvm_target_triple:
                 path_obj = temp.relpath("devc." + object_format)
-                m = _ffi_api.ModulePackImportsToLLVM(self, is_system_lib, llvm_target_triple)
+                m = _ffi_api.ModulePackImportsToLLVM(self, is_system_lib, llvm_target_triple,
+                                                     params_section)
                 m.save(path_obj)
                 files.append(path_obj)
             else:
+                if params_section:
+                    raise ValueError("params_section requires LLVM to pack the imported modules")
                 path_cc = temp.relpath("devc.cc")
                 with open(path_cc, "w") as f:
                     f.write(_ffi_api.ModulePackImportsToC(self, is_system_lib))
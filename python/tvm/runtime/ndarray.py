@@ -23,6 +23,7 @@ import tvm._ffi
 from tvm._ffi.base import _LIB, check_call, c_array, string_types, _FFI_MODE
 from tvm._ffi.runtime_ctypes import DataType, TVMContext, TVMArray, TVMArrayHandle
 from tvm._ffi.runtime_ctypes import DataTypeCode, tvm_shape_index_t
+from . import _ffi_api
 
 try:
     # pylint: disable=wrong-import-position
@@ -189,6 +190,45 @@ class NDArray(NDArrayBase):
             return self._copyto(res)
         raise ValueError("Unsupported target type %s" % str(type(target)))
 
+    def view(self, shape, dtype=None, byte_offset=0, strides=None):
+        """Create a view sharing the memory of this array, e.g. a part of a batch.
+
+        Parameters
+        ----------
+        shape : tuple of int
+            The shape of the view.
+
+        dtype : str, optional
+            The data type of the view, defaults to the one of this array.
+            Strided views keep the data type.
+
+        byte_offset : int
+            The offset of the view from the start of this array.
+
+        strides : tuple of int, optional
+            The strides of the view in elements, a compact view if not given.
+
+        Returns
+        -------
+        view : NDArray
+            The view, which keeps this array alive.
+
+        Note
+        ----
+        A compact view can be passed to the compiled functions and set as a zero-copy
+        input, a strided view is copied by copyto, asnumpy and set_input.
+        """
+        shape = [int(x) for x in shape]
+        if strides is None:
+            dtype = self.dtype if dtype is None else dtype
+            return _ffi_api.NDArrayCreateView(self, dtype, byte_offset, *shape)
+        if dtype is not None and dtype != self.dtype:
+            raise ValueError("A strided view should keep the data type of the array")
+        if len(strides) != len(shape):
+            raise ValueError("The view needs one stride per dimension")
+        strides = [int(x) for x in strides]
+        return _ffi_api.NDArrayCreateStridedView(self, byte_offset, len(shape), *shape, *strides)
+
 
 def context(dev_type, dev_id=0):
     """Construct a TVM context with given device type and id.
@@ -279,6 +319,33 @@ def empty(shape, dtype="float32", ctx=context(1, 0)):
     return _make_array(handle, False, False)
 
 
+def empty_texture(height, width, dtype="float32", ctx=context(4, 0)):
+    """Create an empty array of shape (height, width, 4) backed by an OpenCL
+    2D image of RGBA texels, the data of a buffer in the "global.texture" scope.
+
+    Parameters
+    ----------
+    height : int
+        The height of the image in texels.
+
+    width : int
+        The width of the image in texels.
+
+    dtype : str
+        The data type of the channels, float32, float16, int32 or uint32.
+
+    ctx : TVMContext
+        The OpenCL context of the array.
+
+    Returns
+    -------
+    arr : tvm.nd.NDArray
+        The array, which can only be copied from and to as a whole.
+    """
+    falloc = tvm._ffi.get_global_func("device_api.opencl.alloc_texture")
+    return falloc(height, width, dtype, ctx.device_id)
+
+
 def from_dlpack(dltensor):
     """Produce an array from a DLPack tensor without memory copy.
     Retreives the underlying DLPack tensor's pointer to create an array from the
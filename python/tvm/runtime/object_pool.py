@@ -0,0 +1,51 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Statistics of the pooled object allocator."""
+import json
+
+from . import _ffi_api
+
+
+def enabled():
+    """Whether objects are allocated from the pool, see USE_OBJECT_POOL_ALLOCATOR."""
+    return bool(_ffi_api.ObjectPoolEnabled())
+
+
+def enable_stats(enable=True):
+    """Enable or disable the per-type statistics of the pool.
+
+    Enabling them resets the counters.
+
+    Parameters
+    ----------
+    enable : bool
+        Whether to collect the statistics.
+    """
+    _ffi_api.ObjectPoolEnableStats(enable)
+
+
+def get_stats():
+    """Get the statistics of the pool.
+
+    Returns
+    -------
+    stats : dict
+        "pool_bytes" and "arena_bytes" are the bytes held by the pool and the
+        live arenas. "types" maps each type key to the number of allocations,
+        frees and allocated bytes since the statistics were enabled.
+    """
+    return json.loads(_ffi_api.ObjectPoolStats())
@@ -20,6 +20,8 @@ The Relay Virtual Machine profiler.
 
 Provides extra APIs for profiling vm execution.
 """
+import json
+
 from tvm.runtime import _ffi_api
 from . import vm
 
@@ -38,11 +40,12 @@ class VirtualMachineProfiler(vm.VirtualMachine):
         self._init = self.module["init"]
         self._invoke = self.module["invoke"]
         self._get_stat = self.module["get_stat"]
+        self._get_timeline = self.module["get_timeline"]
         self._set_input = self.module["set_input"]
         self._reset = self.module["reset"]
         self._setup_ctx(ctx, memory_cfg)
 
-    def get_stat(self, sort_by_time=True):
+    def get_stat(self, sort_by_time=True, fmt="table"):
         """Get the statistics of executed ops.
 
         Parameters
@@ -52,11 +55,39 @@ class VirtualMachineProfiler(vm.VirtualMachine):
            the descending order. It is printed in the random order if this
            field is not set.
 
+        fmt: Optional[str]
+           "table" for the printable table of the packed functions, "json" for
+           all the statistics: the packed functions, the time and count of each
+           opcode, the allocations of each AllocStorage instruction, the peak
+           memory of each device and the volume of the host/device copies.
+
         Returns
         -------
-            The execution statistics in string.
+            The execution statistics in string, or as a dict for "json".
         """
+        if fmt == "json":
+            return json.loads(self._get_stat(sort_by_time, "json"))
         return self._get_stat(sort_by_time)
 
+    def get_timeline(self, path=None):
+        """Get the timeline of the packed function calls, storage allocations
+        and constant copies recorded since the last reset.
+
+        Parameters
+        ----------
+        path: Optional[str]
+           If set, the timeline is also written to this file.
+
+        Returns
+        -------
+            The timeline in the Chrome trace event JSON format, which can be
+            loaded in chrome://tracing or https://ui.perfetto.dev.
+        """
+        timeline = self._get_timeline()
+        if path is not None:
+            with open(path, "w") as f:
+                f.write(timeline)
+        return timeline
+
     def reset(self):
         self._reset()
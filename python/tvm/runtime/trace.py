@@ -0,0 +1,63 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Low overhead tracing of the runtime hot paths.
+
+Every thread keeps its most recent events (operators of the graph runtime
+and the VM, allocations, copies, thread pool launches and tasks) in a ring
+of its own. The trace points are compiled with USE_RUNTIME_TRACE, and
+record nothing until tracing is enabled.
+"""
+import json
+
+from . import _ffi_api
+
+
+def enabled():
+    """Whether the events are being recorded."""
+    return bool(_ffi_api.TraceEnabled())
+
+
+def enable(enable=True):
+    """Start or stop recording the events, the recorded events are kept.
+
+    Tracing can also be enabled at startup with TVM_RUNTIME_TRACE=1
+    in the environment.
+
+    Parameters
+    ----------
+    enable : bool
+        Whether to record the events.
+    """
+    _ffi_api.TraceEnable(enable)
+
+
+def dump(clear=True):
+    """Collect the events recorded by all the threads.
+
+    Parameters
+    ----------
+    clear : bool
+        Whether the returned events are skipped by the next dump.
+
+    Returns
+    -------
+    trace : dict
+        The events in the Chrome trace event format, with one trace thread
+        per runtime thread. Save it with json.dump to load it in
+        chrome://tracing or https://ui.perfetto.dev.
+    """
+    return json.loads(_ffi_api.TraceDump(clear))
@@ -166,6 +166,32 @@ class Executable(object):
 
         return Executable(_ffi_api.Load_Executable(bytecode, lib))
 
+    @staticmethod
+    def load_exec_file(path, lib):
+        """Construct an executable from a saved bytecode file.
+
+        The file is memory-mapped and the constants are read from it on first
+        use, so loading does not copy the weights.
+
+        Parameters
+        ----------
+        path : str
+            The path of the file holding the saved Relay VM bytecode.
+
+        lib : :py:class:`~tvm.runtime.Module`
+            The runtime module that contains the generated code.
+
+        Returns
+        -------
+        exec: Executable
+            An executable constructed using the provided artifacts.
+        """
+        if lib is not None and not isinstance(lib, tvm.runtime.Module):
+            raise TypeError("lib is expected to be the type of tvm.runtime.Module" +
+                            ", but received {}".format(type(lib)))
+
+        return Executable(_ffi_api.Load_ExecutableFile(path, lib))
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -284,7 +310,11 @@ class VirtualMachine(object):
 
     memory_cfg : str or Dict[tvm.runtime.TVMContext, str], optional
         Config the type of memory allocator. The allocator type can be ["naive",
-        "pooled"]. If memory_cfg is None, all contexts will use pooled allocator
+        "pooled", "size_class", "stream_ordered"]. The stream_ordered allocator
+        allocates from the memory pool of the device in the order of the current
+        stream, e.g. cudaMallocAsync, it requires CUDA 11.2. The contexts without
+        such a pool, e.g. the CPU, fall back to the pooled allocator. If memory_cfg
+        is None, all contexts will use pooled allocator
         by default. If memory_cfg is string, all contexts will use the specified
         allocator type. If memory_cfg is a dict, each context uses the allocator
         type specified in the dict, or pooled allocator if not specified in the
@@ -293,6 +323,8 @@ class VirtualMachine(object):
 
     NAIVE_ALLOCATOR = 1
     POOLED_ALLOCATOR = 2
+    SIZE_CLASS_ALLOCATOR = 3
+    STREAM_ORDERED_ALLOCATOR = 4
 
     def __init__(self, exe, ctx, memory_cfg=None):
         if not isinstance(exe, Executable):
@@ -313,9 +345,13 @@ class VirtualMachine(object):
         if memory_cfg is None:
             memory_cfg = {}
         elif isinstance(memory_cfg, str):
-            assert memory_cfg in ["naive", "pooled"]
+            assert memory_cfg in ["naive", "pooled", "size_class", "stream_ordered"]
             if memory_cfg == "naive":
                 default_alloc_type = VirtualMachine.NAIVE_ALLOCATOR
+            elif memory_cfg == "size_class":
+                default_alloc_type = VirtualMachine.SIZE_CLASS_ALLOCATOR
+            elif memory_cfg == "stream_ordered":
+                default_alloc_type = VirtualMachine.STREAM_ORDERED_ALLOCATOR
             memory_cfg = {}
         elif not isinstance(memory_cfg, dict):
             raise TypeError("memory_cfg is expected be string or dictionary, " +
@@ -363,6 +399,83 @@ class VirtualMachine(object):
         cargs = convert(args)
         self._set_input(func_name, *cargs)
 
+    def set_static_memory_plan(self, enable=True):
+        """Keep the storage allocated by each allocation of the first invocation,
+        and reuse it in the later invocations instead of calling the allocator.
+
+        The storage of an allocation is reused once none of the objects it backs
+        is alive anymore, e.g. the outputs of the previous invocation are released.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to reuse the storage across invocations.
+        """
+        self.module["set_static_memory_plan"](enable)
+
+    def set_share_constants(self, enable=True):
+        """Share the device copy of the constants with the other virtual machines
+        running the same executable on the same device, instead of uploading them
+        for each. Constants are read-only, so sharing them never changes results.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to share the constants.
+        """
+        self.module["set_share_constants"](enable)
+
+    def set_shape_func_cache(self, max_entries=64):
+        """Memoize the results of the shape functions, keyed by their input shapes.
+
+        Models seeing a few recurring input shapes then skip the shape
+        computation in the steady state.
+
+        Parameters
+        ----------
+        max_entries : int
+            The maximum number of results kept per shape function, 0 disables
+            the cache.
+        """
+        self.module["set_shape_func_cache"](max_entries)
+
+    def set_async_execution(self, enable=True):
+        """Queue the kernels and copies on a stream of each device owned by the VM.
+
+        Only the instructions reading a value on the host, such as ``If`` or the
+        size of a dynamic allocation, wait for the stream. The results are ready
+        when ``run`` or ``invoke`` returns.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to execute asynchronously.
+        """
+        self.module["set_async_execution"](enable)
+
+    def set_pinned_staging(self, enable=True):
+        """Upload the inputs set from host memory through reusable pinned host
+        buffers, so the copies to GPU devices run at the full bandwidth and are
+        queued on the stream of the device in asynchronous execution.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to stage the uploads.
+        """
+        self.module["set_pinned_staging"](enable)
+
+    def set_thread_pool_partition(self, name):
+        """Run the functions of the VM on a named thread pool partition.
+
+        Parameters
+        ----------
+        name : str
+            The name of a partition created with runtime.config_threadpool_partition,
+            empty to run on the thread pool of the calling thread.
+        """
+        self.module["set_thread_pool_partition"](name)
+
     def invoke(self, func_name, *args, **kwargs):
         """Invoke a function.
 
@@ -385,6 +385,14 @@ def create(target):
         mfloat-abi : str (optional)
             An llvm setting that is one of 'hard' or 'soft' indicating whether to use
             hardware or software floating-point operations.
+        jit : str (optional)
+            The llvm JIT that runs the module in process, 'mcjit' (default) compiles the
+            whole module when it is first used, 'orc' compiles each function when it is
+            first called and needs LLVM 13 or later.
+        isa-variants : str (optional)
+            Comma separated x86 ISA levels, 'avx512' and 'avx2', to generate a variant of
+            each function for, best first. The best variant the CPU supports is called at
+            runtime, the function built for the target itself otherwise.
 
     Returns
     -------
@@ -106,3 +106,44 @@ def verify_gpu_code(func, constraints):
         The result of verification.
     """
     return _ffi_api.verify_gpu_code(func, constraints)
+
+
+def estimate_roofline(func):
+    """Statically estimate the operations and memory traffic of func.
+
+    The operations and the bytes of the loads and stores are weighted by the
+    trip count of their loops and threads. Loops with a non-constant extent
+    count once and no cache reuse is modelled, so the result tells whether the
+    function is compute or memory bound rather than predicting its run time.
+
+    Parameters
+    ----------
+    func: tvm.tir.PrimFunc
+        The function to be analyzed.
+
+    Returns
+    -------
+    result : Dict[str, float]
+        "flops" and "int_ops" are the float and integer operations,
+        "bytes.<scope>" the bytes moved in each storage scope and
+        "arithmetic_intensity" the flops per byte of global memory traffic.
+    """
+    return {str(k): v.value for k, v in _ffi_api.estimate_roofline(func).items()}
+
+
+def global_coalescing_ratio(func):
+    """Get the fraction of the global memory accesses under threadIdx.x of
+    func that are coalesced, that is, where consecutive threads access the
+    same or consecutive elements.
+
+    Parameters
+    ----------
+    func: tvm.tir.PrimFunc
+        The function to be analyzed.
+
+    Returns
+    -------
+    result : float
+        The ratio of coalesced accesses, 1 when there is no such access.
+    """
+    return _ffi_api.global_coalescing_ratio(func)
@@ -63,6 +63,12 @@ def Filter(fcond):
 def InjectPrefetch():
     """Inject prefetch instructions into stmt.
 
+    Besides the prefetches requested by the schedule, the pass prefetches the
+    strided reads of the input buffers in innermost loops when auto_prefetch is
+    set in the "tir.InjectPrefetch" option of the PassContext. The prefetch
+    distance covers prefetch_latency (default 200) cycles at the estimated cost
+    of one iteration, rounded up to cache_line_bytes (default 64).
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -139,7 +145,15 @@ def LiftAttrScope(attr_key):
 
 
 def LoopPartition():
-    """Inject virtual thread loops.
+    """Partition loops on the likely conditions in their body.
+
+    The "tir.LoopPartition" option of the PassContext bounds the cost of the
+    partitions: a loop is only partitioned when its interior range holds at least
+    min_interior_ratio of its iterations (0 by default), and the partitions may add
+    up to max_versions versions of loop bodies to a function (-1, no limit, by
+    default). The global function "tir.transform.LoopPartitionStats" returns the
+    number of partitions performed and skipped, and resets them if its argument
+    is true.
 
     Returns
     -------
@@ -158,6 +172,12 @@ def VectorizeLoop(enable_vectorize=True):
         Whether vectorization is enabled.
         Will lower to scalar loop when it is turned off.
 
+    Note
+    ----
+    With the pass config "tir.scalable_vectorize", the loops are kept as serial
+    loops marked for the LLVM loop vectorizer instead, which uses scalable vectors
+    with predicated tails on targets that have them, e.g. AArch64 with +sve.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -180,6 +200,12 @@ def InjectVirtualThread():
 def InjectDoubleBuffer():
     """Inject double buffer statements.
 
+    The pass is configured by the "tir.InjectDoubleBuffer" option of the
+    PassContext: split_loop unrolls the loop, num_stages (default 2) sets the
+    number of copies of the buffer, so the fetch runs num_stages - 1 iterations
+    ahead, and use_async_copy fetches into shared memory with asynchronous
+    copies (cp.async on CUDA sm_80 and later).
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -195,6 +221,11 @@ def StorageRewrite():
     Trying to share space between allocations to make
     a static allocation plan when possible.
 
+    With merge_arena set in the "tir.StorageRewrite" option of the
+    PassContext, the constant size global and shared buffers of each scope
+    are packed into one arena, where buffers of any dtype whose lifetimes do
+    not overlap share memory.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -208,6 +239,11 @@ def UnrollLoop():
 
     This pass also automatically attach pragma unroll tag to loops which meets the standard.
 
+    A loop annotated with pragma unroll_and_jam, or found by the heuristic when
+    auto_unroll_and_jam of the "tir.UnrollLoop" option is larger than 1, is
+    unrolled and the copies of its inner loop are fused into one loop, when this
+    does not reorder dependent accesses.
+
     Returns
     -------
     fpass : tvm.transform.Pass
@@ -373,6 +409,42 @@ def SkipAssert():
     return _ffi_api.SkipAssert()
 
 
+def LowerTextureAccess():
+    """Lower the accesses of the texture buffers, the parameters in the
+    "global.texture" scope of shape [height, width, 4], to texture2d_load and
+    texture2d_store of the RGBA texels of a 2D image.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+
+    Note
+    ----
+    The channel axis of the accesses must be vectorized, so that each of
+    them reads or writes a whole texel.
+    """
+    return _ffi_api.LowerTextureAccess()
+
+
+def CoalesceGlobalAccess():
+    """Stage the global loads and stores of a thread block that are coalesced
+    along threadIdx.y instead of threadIdx.x, like those of a transpose,
+    through shared memory tiles padded against bank conflicts.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+
+    Note
+    ----
+    Run this pass before ThreadSync("shared"), which inserts the barriers.
+    Use tvm.tir.analysis.global_coalescing_ratio to check the result.
+    """
+    return _ffi_api.CoalesceGlobalAccess()
+
+
 def ThreadSync(storage_scope):
     """ Insert sync between parallel read/write of shared buffers.
 
@@ -473,6 +545,9 @@ def CombineContextCall():
 def NarrowDataType(target_bits):
     """Narrow down PrimExpr datatype in stmt to target_bits.
 
+    Each var and index expression is narrowed when its own range fits,
+    the expressions that do not fit are computed in their original datatype.
+
     Parameters
     ----------
     target_bits : int
@@ -508,3 +583,21 @@ def HoistIfThenElse():
         The result pass
     """
     return _ffi_api.HoistIfThenElse()
+
+
+def LoopUnswitching():
+    """Version loops on the conditions in their body.
+
+    Loop-invariant conditions are unswitched out of the outermost loop possible.
+    Loops whose conditions are linear in the loop variables, such as padding
+    conditions, are split into an interior version without the conditions and a
+    boundary version. The versions are limited by max_growth, the number of
+    statements they may add to a function, of the "tir.LoopUnswitching" option
+    of the PassContext. It is 0 by default, which disables the pass.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.LoopUnswitching()
@@ -40,6 +40,7 @@ from .sort import *
 from .scatter import *
 from .scatter_add import *
 from .argwhere import *
+from .scan import *
 from . import generic
 from . import nn
 from . import x86
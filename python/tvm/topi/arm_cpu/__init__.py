@@ -21,6 +21,7 @@ from .conv2d import *
 from .depthwise_conv2d import *
 from .conv2d_transpose import *
 from .conv2d_int8 import *
+from .dense import *
 from . import conv2d_alter_op
 from .bitserial_conv2d import *
 from .bitserial_dense import *
@@ -0,0 +1,69 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name,unused-argument
+"""Dense int8 schedule on ARM"""
+import tvm
+from tvm import autotvm
+from .. import nn
+from ..generic import dense as dense_generic
+from .tensor_intrin import dot_int8_int8_int32
+
+
+def is_int8_dot_support(data_dtype, kernel_dtype):
+    """
+    Checks to ensure that we can use the ARMv8.2 sdot/udot instructions
+    1) The datatypes are both int8 or both uint8.
+    2) Target is AArch64 with the dot product extension.
+    """
+    is_dtype_support = data_dtype == kernel_dtype and data_dtype in ("int8", "uint8")
+    target = tvm.target.Target.current(allow_none=False)
+    is_target_support = "aarch64" in target.attrs.get("mtriple", "") and \
+        "+dotprod" in target.mattr
+    return is_dtype_support and is_target_support
+
+
+@autotvm.register_topi_compute("dense_dotprod.arm_cpu")
+def dense_dotprod(cfg, data, weight, bias=None, out_dtype=None):
+    """Compute int8 dense with the weight packed for the ARMv8.2 dot product"""
+    if out_dtype is None:
+        out_dtype = "uint32" if data.dtype == "uint8" else "int32"
+    assert out_dtype == ("uint32" if data.dtype == "uint8" else "int32"), \
+        "the dot product accumulates int8 into int32 and uint8 into uint32"
+    return nn.dense_int8_packed(data, weight, bias, out_dtype,
+                                int32_lanes=4, num_int8_elements=4)
+
+
+@autotvm.register_topi_schedule("dense_dotprod.arm_cpu")
+def schedule_dense_dotprod(cfg, outs):
+    """Create the schedule for dense_dotprod, tensorized with sdot/udot"""
+    outs = [outs] if isinstance(outs, tvm.te.tensor.Tensor) else outs
+    data_dtype = _find_dense_data(outs[0].op).dtype
+    dtype = "uint" if data_dtype == "uint8" else "int"
+    return dense_generic.schedule_dense_int8_packed(
+        outs, dot_int8_int8_int32(int32_lanes=4, dtype=dtype))
+
+
+def _find_dense_data(op):
+    """Find the data tensor of the dense_int8_packed feeding op"""
+    if "dense_int8_packed" in op.tag:
+        return op.input_tensors[0].op.input_tensors[0]
+    for tensor in op.input_tensors:
+        if isinstance(tensor.op, tvm.te.ComputeOp):
+            data = _find_dense_data(tensor.op)
+            if data is not None:
+                return data
+    return None
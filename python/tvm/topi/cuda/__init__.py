@@ -44,7 +44,7 @@ from .nn import schedule_lrn
 from .batch_matmul import *
 from .vision import *
 from .ssd import *
-from .nms import get_valid_counts, non_max_suppression
+from .nms import get_valid_counts, non_max_suppression, non_max_suppression_bitmask
 from .rcnn import *
 from .sort import *
 from .conv2d_nhwc_tensorcore import *
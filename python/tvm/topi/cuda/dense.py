@@ -20,7 +20,7 @@ import logging
 from tvm import te
 import tvm.autotvm as autotvm
 from tvm.autotvm.task.space import SplitEntity
-from tvm.contrib import cublas
+from tvm.contrib import cublas, cublaslt
 from .tensor_intrin import dp4a
 from .. import nn
 from .. import tag
@@ -56,6 +56,33 @@ def schedule_dense_cublas(_, outs):
     return generic.schedule_extern(outs)
 
 
+@autotvm.register_topi_compute("dense_bias_act_cublaslt.cuda")
+def dense_bias_act_cublaslt(cfg, data, weight, bias, activation="none", out_dtype=None):
+    """Dense with a bias add and an activation on CUDA with cuBLASLt"""
+    if out_dtype is None:
+        out_dtype = data.dtype
+    assert out_dtype == data.dtype, "Mixed precision not supported."
+    batch, in_dim = get_const_tuple(data.shape)
+    out_dim, _ = get_const_tuple(weight.shape)
+    cfg.add_flop(batch * in_dim * out_dim * 2)
+    if cublaslt.supports_epilogue(activation):
+        return cublaslt.dense(data, weight, bias, activation)
+    # Older cuBLASLt lacks this epilogue, so it runs as a separate kernel.
+    return nn.dense_epilogue(cublaslt.dense(data, weight), bias, activation)
+
+
+@autotvm.register_topi_schedule("dense_bias_act_cublaslt.cuda")
+def schedule_dense_bias_act_cublaslt(_, outs):
+    """Schedule dense_bias_act using cuBLASLt"""
+    return generic.schedule_extern(outs)
+
+
+@autotvm.register_topi_compute("dense_bias_act.cuda")
+def dense_bias_act(cfg, data, weight, bias, activation="none", out_dtype=None):
+    """Dense with a bias add and an activation on CUDA"""
+    return nn.dense_bias_act(data, weight, bias, activation, out_dtype)
+
+
 @autotvm.register_topi_compute("dense_small_batch.cuda")
 def dense_small_batch(cfg, data, weight, bias=None, out_dtype=None):
     """Dense operator on CUDA"""
@@ -259,8 +286,6 @@ def schedule_dense_int8(cfg, outs):
     return s
 
 
-_dp4a = dp4a('shared', 'shared', 'local')
-
 def _schedule_dense_int8(cfg, s, output):
     data, weight = s[output].op.input_tensors
 
@@ -296,7 +321,7 @@ def _schedule_dense_int8(cfg, s, output):
     ko = CC.op.reduce_axis[0]
     ko, ki = s[CC].split(ko, factor=4)
     ko, kt = cfg['tile_k'].apply(s, CC, ko)
-    s[CC].tensorize(ki, _dp4a)
+    s[CC].tensorize(ki, dp4a('shared', 'shared', 'local', data.dtype))
     by, vy, ty, yi = cfg['tile_y'].apply(s, output, n)
     bx, vx, tx, xi = cfg['tile_x'].apply(s, output, x)
 
@@ -470,3 +470,350 @@ def non_max_suppression(data, valid_count, indices, max_output_size=-1,
         return box_indices
 
     return out
+
+
+# Number of boxes covered by one word of the suppression bitmask.
+_NMS_BITMASK_BITS = 32
+
+
+def _box_iou(box_a, box_b):
+    """Calculate IoU of two boxes given as [left, top, right, bottom] expressions."""
+    w = tvm.te.max(0.0, tvm.te.min(box_a[2], box_b[2]) - tvm.te.max(box_a[0], box_b[0]))
+    h = tvm.te.max(0.0, tvm.te.min(box_a[3], box_b[3]) - tvm.te.max(box_a[1], box_b[1]))
+    i = w * h
+    u = (box_a[2] - box_a[0]) * (box_a[3] - box_a[1]) + \
+        (box_b[2] - box_b[0]) * (box_b[3] - box_b[1]) - i
+    return tvm.tir.Select(u <= 0.0, 0.0, i / u)
+
+
+def nms_bitmask_ir(data, sorted_index, valid_count, out, box_indices, mask, removed,
+                   max_output_size, iou_threshold, force_suppress,
+                   top_k, coord_start, id_index, score_index):
+    """Low level IR routing of bitmask based non-maximum suppression.
+
+    The boxes are first reordered by score. A second kernel then computes the
+    pairwise IoU matrix block by block, one thread per row box against a block of
+    _NMS_BITMASK_BITS column boxes staged in shared memory, and packs the
+    suppression decisions into bitmask words. A final kernel walks the boxes in
+    score order and ORs the bitmask rows of the kept boxes together, so the
+    sequential part only touches one word per block of boxes.
+
+    Parameters
+    ----------
+    data : Buffer
+        Buffer of output boxes with class and score.
+
+    sorted_index : Buffer
+        Buffer of output box indexes sorted by score.
+
+    valid_count : Buffer
+        Buffer of number of valid output boxes.
+
+    out : Buffer
+        Output buffer.
+
+    box_indices : Buffer
+        Output buffer of the indices of the kept boxes in data.
+
+    mask : Buffer
+        Scratch buffer of shape [batch_size, num_anchors, num_words] holding
+        the bits of the boxes each box suppresses.
+
+    removed : Buffer
+        Scratch buffer of shape [batch_size, num_words] holding the bits of
+        the suppressed boxes.
+
+    max_output_size : int or Buffer
+        Max number of output valid boxes for each instance.
+        By default all valid boxes are returned.
+
+    iou_threshold : float
+        Overlapping(IoU) threshold to suppress object with smaller score.
+
+    force_suppress : boolean
+        Whether to suppress all detections regardless of class_id.
+
+    top_k : int
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    coord_start : int
+        Start index of the consecutive 4 coordinates.
+
+    id_index : int
+        index of the class categories, -1 to disable.
+
+    score_index : optional, int
+        Index of the scores/confidence of boxes.
+
+    Returns
+    -------
+    stmt : Stmt
+        The result IR statement.
+    """
+    batch_size = data.shape[0]
+    num_anchors = data.shape[1]
+    box_data_length = data.shape[2]
+    num_bits = _NMS_BITMASK_BITS
+    num_words = (num_anchors + num_bits - 1) // num_bits
+
+    ib = tvm.tir.ir_builder.create()
+
+    data = ib.buffer_ptr(data)
+    sorted_index = ib.buffer_ptr(sorted_index)
+    valid_count = ib.buffer_ptr(valid_count)
+    out = ib.buffer_ptr(out)
+    box_indices = ib.buffer_ptr(box_indices)
+    mask = ib.buffer_ptr(mask)
+    removed = ib.buffer_ptr(removed)
+
+    max_threads = int(tvm.target.Target.current(allow_none=False).max_num_threads)
+    do_nms = iou_threshold > 0
+    if isinstance(max_output_size, int):
+        max_output_size = tvm.tir.const(max_output_size, dtype="int32")
+    elif isinstance(max_output_size, tvm.tir.Buffer):
+        max_output_size = ib.buffer_ptr(max_output_size)[0]
+
+    def num_keep(i):
+        if top_k > 0:
+            return if_then_else(top_k < valid_count[i], top_k, valid_count[i])
+        return valid_count[i]
+
+    def is_valid_box(offset):
+        cond = out[offset + score_index] > 0
+        if id_index >= 0:
+            cond = tvm.tir.all(cond, out[offset + id_index] >= 0)
+        return cond
+
+    # Reorder the boxes by score, and set entries that do not take part to -1.
+    with ib.new_scope():
+        tx = te.thread_axis("threadIdx.x")
+        bx = te.thread_axis("blockIdx.x")
+        by = te.thread_axis("blockIdx.y")
+        ib.scope_attr(tx, "thread_extent", max_threads)
+        ib.scope_attr(bx, "thread_extent", (num_anchors + max_threads - 1) // max_threads)
+        ib.scope_attr(by, "thread_extent", batch_size)
+        i = by
+        j = bx * max_threads + tx
+        base_idx = i * num_anchors * box_data_length
+        with ib.if_scope(j < num_anchors):
+            with ib.if_scope(j < (num_keep(i) if do_nms else valid_count[i])):
+                # Without nms the boxes keep their order.
+                src = sorted_index[i * num_anchors + j] if do_nms else j
+                with ib.for_range(0, box_data_length) as k:
+                    out[base_idx + j * box_data_length + k] = \
+                        data[base_idx + src * box_data_length + k]
+                box_indices[i * num_anchors + j] = src
+            with ib.else_scope():
+                with ib.for_range(0, box_data_length) as k:
+                    out[base_idx + j * box_data_length + k] = -1.0
+                box_indices[i * num_anchors + j] = -1
+
+    if not do_nms:
+        return ib.get()
+
+    # Compute the suppression bitmask, one word per (row box, block of column boxes).
+    with ib.new_scope():
+        tx = te.thread_axis("threadIdx.x")
+        bx = te.thread_axis("blockIdx.x")
+        by = te.thread_axis("blockIdx.y")
+        bz = te.thread_axis("blockIdx.z")
+        ib.scope_attr(tx, "thread_extent", num_bits)
+        ib.scope_attr(bx, "thread_extent", num_words)
+        ib.scope_attr(by, "thread_extent", num_words)
+        ib.scope_attr(bz, "thread_extent", batch_size)
+        i = bz
+        col_start = bx * num_bits
+        row = by * num_bits + tx
+        base_idx = i * num_anchors * box_data_length
+        nkeep = num_keep(i)
+
+        # Stage the column block: 4 coordinates, a validity flag and the class id.
+        col_boxes = ib.allocate(data.dtype, (num_bits * 6,), name="col_boxes", scope="shared")
+        col = col_start + tx
+        one = tvm.tir.const(1, data.dtype)
+        zero = tvm.tir.const(0, data.dtype)
+        with ib.if_scope(col < nkeep):
+            offset_col = base_idx + col * box_data_length
+            for c in range(4):
+                col_boxes[tx * 6 + c] = out[offset_col + coord_start + c]
+            col_boxes[tx * 6 + 4] = tvm.tir.Select(is_valid_box(offset_col), one, zero)
+            col_boxes[tx * 6 + 5] = out[offset_col + id_index] if id_index >= 0 else zero
+        with ib.else_scope():
+            col_boxes[tx * 6 + 4] = zero
+        ib.emit(tvm.tir.Call(None, 'tir.tvm_storage_sync', tvm.runtime.convert(['shared'])))
+
+        word = ib.allocate("uint32", (1,), name="word", scope="local")
+        word[0] = tvm.tir.const(0, "uint32")
+        with ib.if_scope(row < nkeep):
+            offset_row = base_idx + row * box_data_length
+            row_box = [out[offset_row + coord_start + c] for c in range(4)]
+            with ib.if_scope(is_valid_box(offset_row)):
+                with ib.for_range(0, num_bits) as k:
+                    col_box = [col_boxes[k * 6 + c] for c in range(4)]
+                    cond = tvm.tir.all(col_start + k > row, col_boxes[k * 6 + 4] > 0)
+                    if id_index >= 0 and not force_suppress:
+                        cond = tvm.tir.all(cond, col_boxes[k * 6 + 5] == out[offset_row + id_index])
+                    overlap = _box_iou(row_box, col_box) >= iou_threshold
+                    with ib.if_scope(tvm.tir.all(cond, overlap)):
+                        word[0] = word[0] | (tvm.tir.const(1, "uint32") << k.astype("uint32"))
+        with ib.if_scope(row < num_anchors):
+            mask[(i * num_anchors + row) * num_words + bx] = word[0]
+
+    # Walk the boxes in score order, keeping a box unless a kept box suppressed it.
+    with ib.new_scope():
+        tx = te.thread_axis("threadIdx.x")
+        bx = te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", max_threads)
+        ib.scope_attr(bx, "thread_extent", batch_size)
+        i = bx
+        base_idx = i * num_anchors * box_data_length
+        num_iters = (num_words + max_threads - 1) // max_threads
+
+        with ib.for_range(0, num_iters) as r:
+            w = r * max_threads + tx
+            with ib.if_scope(w < num_words):
+                removed[i * num_words + w] = tvm.tir.const(0, "uint32")
+        ib.emit(tvm.tir.Call(None, 'tir.tvm_storage_sync', tvm.runtime.convert(['shared'])))
+
+        # Every thread tracks the same count, as they all see the same bitmask.
+        num_kept = ib.allocate("int32", (1,), name="num_kept", scope="local")
+        num_kept[0] = 0
+        with ib.for_range(0, num_keep(i)) as j:
+            offset_j = base_idx + j * box_data_length
+            with ib.if_scope(is_valid_box(offset_j)):
+                is_removed = (removed[i * num_words + j // num_bits] >>
+                              (j % num_bits).astype("uint32")) & tvm.tir.const(1, "uint32")
+                # Only thread 0 writes to out, and only for a box that is dropped, where
+                # the other threads have nothing to do.
+                with ib.if_scope(is_removed == tvm.tir.const(0, "uint32")):
+                    with ib.if_scope(tvm.tir.all(max_output_size > 0,
+                                                 num_kept[0] >= max_output_size)):
+                        with ib.if_scope(tx == 0):
+                            with ib.for_range(0, box_data_length) as k:
+                                out[offset_j + k] = -1.0
+                            box_indices[i * num_anchors + j] = -1
+                    with ib.else_scope():
+                        num_kept[0] += 1
+                        with ib.for_range(0, num_iters) as r:
+                            w = r * max_threads + tx
+                            with ib.if_scope(w < num_words):
+                                removed[i * num_words + w] = removed[i * num_words + w] | \
+                                    mask[(i * num_anchors + j) * num_words + w]
+                with ib.else_scope():
+                    with ib.if_scope(tx == 0):
+                        out[offset_j + score_index] = -1.0
+                        if id_index >= 0:
+                            out[offset_j + id_index] = -1.0
+                        box_indices[i * num_anchors + j] = -1
+            ib.emit(tvm.tir.Call(None, 'tir.tvm_storage_sync', tvm.runtime.convert(['shared'])))
+
+    return ib.get()
+
+
+def non_max_suppression_bitmask(data, valid_count, indices, max_output_size=-1,
+                                iou_threshold=0.5, force_suppress=False, top_k=-1,
+                                coord_start=2, score_index=1, id_index=0,
+                                return_indices=True, invalid_to_bottom=False):
+    """Non-maximum suppression operator for object detection, computing the
+    suppression decisions in parallel as a bitmask.
+
+    It has the same interface and output as :py:func:`non_max_suppression`. The
+    boxes of each batch are suppressed independently, and boxes of different
+    classes only suppress each other when force_suppress is set.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+        The last dimension should be in format of
+        [class_id, score, box_left, box_top, box_right, box_bottom].
+        It could be the second output out_tensor of get_valid_counts.
+
+    valid_count : tvm.te.Tensor
+        1-D tensor for valid number of boxes. It could be the output
+        valid_count of get_valid_counts.
+
+    indices : tvm.te.Tensor
+        2-D tensor with shape [batch_size, num_anchors], represents
+        the index of box in original data.
+
+    max_output_size : optional, int or tvm.te.Tensor
+        Max number of output valid boxes for each instance.
+        By default all valid boxes are returned.
+
+    iou_threshold : optional, float
+        Non-maximum suppression threshold.
+
+    force_suppress : optional, boolean
+        Whether to suppress all detections regardless of class_id.
+
+    top_k : optional, int
+        Keep maximum top k detections before nms, -1 for no limit.
+
+    coord_start : required, int
+        Start index of the consecutive 4 coordinates.
+
+    score_index : optional, int
+        Index of the scores/confidence of boxes.
+
+    id_index : optional, int
+        index of the class categories, -1 to disable.
+
+    return_indices : boolean
+        Whether to return box indices in input data.
+
+    invalid_to_bottom : optional, boolean
+        Whether to move all valid bounding boxes to the top.
+
+    Returns
+    -------
+    out : tvm.te.Tensor
+        3-D tensor with shape [batch_size, num_anchors, elem_length].
+    """
+    batch_size = data.shape[0]
+    num_anchors = data.shape[1]
+    num_words = (num_anchors + _NMS_BITMASK_BITS - 1) // _NMS_BITMASK_BITS
+
+    valid_count_dtype = "int32"
+    valid_count_buf = tvm.tir.decl_buffer(valid_count.shape, valid_count_dtype,
+                                          "valid_count_buf", data_alignment=4)
+    score_axis = score_index
+    score_shape = (batch_size, num_anchors)
+    score_tensor = te.compute(
+        score_shape, lambda i, j: data[i, j, score_axis], tag=tag.ELEMWISE)
+    if tvm.get_global_func("tvm.contrib.thrust.sort_nms", allow_missing=True):
+        sort_tensor = argsort_thrust(
+            score_tensor, valid_count=None, axis=1, is_ascend=False, dtype=valid_count_dtype)
+    else:
+        sort_tensor = argsort(
+            score_tensor, valid_count=None, axis=1, is_ascend=False, dtype=valid_count_dtype)
+
+    sort_tensor_buf = tvm.tir.decl_buffer(sort_tensor.shape, sort_tensor.dtype,
+                                          "sort_tensor_buf", data_alignment=8)
+
+    data_buf = tvm.tir.decl_buffer(
+        data.shape, data.dtype, "data_buf", data_alignment=8)
+
+    inputs = [data, sort_tensor, valid_count]
+    in_buffers = [data_buf, sort_tensor_buf, valid_count_buf]
+    if isinstance(max_output_size, te.Tensor):
+        inputs.append(max_output_size)
+        in_buffers.append(tvm.tir.decl_buffer(max_output_size.shape, max_output_size.dtype,
+                                              "max_output_size_buf", data_alignment=4))
+
+    out, box_indices, _, _ = \
+        te.extern([data.shape, score_shape, (batch_size, num_anchors, num_words),
+                   (batch_size, num_words)],
+                  inputs,
+                  lambda ins, outs: nms_bitmask_ir(
+            ins[0], ins[1], ins[2], outs[0], outs[1], outs[2], outs[3],
+            ins[3] if len(ins) > 3 else max_output_size, iou_threshold, force_suppress,
+            top_k, coord_start, id_index, score_index),
+            dtype=[data.dtype, "int32", "uint32", "uint32"],
+            in_buffers=in_buffers,
+            name="nms_bitmask",
+            tag="nms")
+    if return_indices:
+        return box_indices
+
+    return out
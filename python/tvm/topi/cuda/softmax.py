@@ -46,13 +46,19 @@ def schedule_softmax(outs):
         expsum = softmax.op.input_tensors[1]
         exp = softmax.op.input_tensors[0]
         max_elem = s[exp].op.input_tensors[1]
+    elif op_tag == 'online_softmax_output':
+        exp = None
+        # max_elem and expsum are the two outputs of one reduction
+        reduction = [t.op for t in softmax.op.input_tensors if t.op.num_outputs == 2][0]
+        max_elem, expsum = reduction.output(0), reduction.output(1)
     elif op_tag == 'log_softmax_output':
         exp = None
         max_elem = softmax.op.input_tensors[1]
         expsum = softmax.op.input_tensors[2]
     else:
-        raise ValueError('Tag is expected to be softmax_output or log_softmax_output. \
-                         Got {0}'.format(op_tag))
+        raise ValueError('Tag is expected to be softmax_output, online_softmax_output or \
+                         log_softmax_output. Got {0}'.format(op_tag))
+    online = max_elem.op == expsum.op
 
     # The nvptx and rocm backends only supports 32-bits warp shuffle
     # instructions.
@@ -67,7 +73,7 @@ def schedule_softmax(outs):
         return True
 
     if len(softmax.shape) > 2:
-        ops = [max_elem.op, expsum.op, softmax.op]
+        ops = [max_elem.op, softmax.op] if online else [max_elem.op, expsum.op, softmax.op]
         if exp is not None:
             ops.append(exp.op)
 
@@ -87,11 +93,13 @@ def schedule_softmax(outs):
         s[softmax].bind(xo, thread_x)
         s[softmax].bind(softmax.op.axis[0], block_x)
 
-        # (3) expsum
+        # (3) expsum, along with max_elem for online softmax
         k = expsum.op.reduce_axis[0]
         ko, _ = s[expsum].split(k, nparts=num_thread)
         s[expsum].bind(ko, thread_x)
         s[expsum].compute_at(s[softmax], xo)
+        if online:
+            return s
 
         # (2) exp
         if exp is not None:
@@ -121,10 +129,13 @@ def schedule_softmax(outs):
         if exp is not None:
             s[exp].bind(exp.op.axis[0], block_x)
 
-        s[max_elem].bind(max_elem.op.axis[0], block_x)
+        if not online:
+            s[max_elem].bind(max_elem.op.axis[0], block_x)
         k = expsum.op.reduce_axis[0]
         ko, ki = s[expsum].split(k, factor=num_thread)
         EF = s.rfactor(expsum, ki)
+        if online:
+            EF = EF[0]
         s[expsum].bind(s[expsum].op.axis[0], block_x)
         s[expsum].bind(s[expsum].op.reduce_axis[0], thread_x)
         s[EF].compute_at(s[expsum], s[expsum].op.reduce_axis[0])
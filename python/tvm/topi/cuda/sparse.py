@@ -16,11 +16,16 @@
 # under the License.
 
 """Sparse operators"""
+import tvm
 from tvm import te
 from tvm import autotvm
 from tvm.autotvm.task.space import SplitEntity
-from ..util import traverse_inline
-from .. import nn
+from ..util import traverse_inline, get_const_tuple
+from .. import nn, tag
+from .injective import schedule_injective_from_existing
+
+# The shared memory a thread block uses to stage the rows of the dense operand.
+_MAX_SHARED_BYTES = 48 * 1024
 
 
 @autotvm.register_topi_compute("sparse_dense.cuda")
@@ -96,3 +101,186 @@ def schedule_sparse_dense(cfg, outs):
 
     traverse_inline(s, outs[0].op, _callback)
     return s
+
+
+@autotvm.register_topi_compute("sparse_dense_binned.cuda")
+def sparse_dense_binned(cfg, data, weight_data, weight_indices, weight_indptr):
+    """
+    Computes sparse-dense matrix multiplication of `data` and
+    `(weight_data, weight_indices, weight_indptr).T`, balancing the rows of
+    the weight across the warps.
+
+    The (block) rows of the weight are split into bins holding about the
+    same number of nonzeros, every bin computed by a warp, so the rows with
+    many nonzeros do not leave the other warps idle. The rows of `data` used
+    by a thread block are staged in shared memory when they fit.
+
+    Parameters
+    ----------
+    cfg: ConfigEntity
+        The config for this template
+
+    data : tvm.te.Tensor
+        2-D with shape [M, K]
+
+    weight_data : tvm.te.Tensor
+        1-D with shape [nnz] (CSR) or
+        3-D with shape [num_blocks, bs_r, bs_c] (BSR)
+
+    weight_indices : tvm.te.Tensor
+        1-D with shape [nnz] (CSR) or
+        1-D with shape [num_blocks] (BSR)
+
+    weight_indptr : tvm.te.Tensor
+        1-D with shape [N + 1] (CSR) or
+        1-D with shape [(N + 1) // bs_r] (BSR)
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [M, N]
+    """
+    if len(weight_data.shape) == 1:
+        bs_r, bs_c = 1, 1
+    else:
+        _, bs_r, bs_c = get_const_tuple(weight_data.shape)
+    m, k = get_const_tuple(data.shape)
+    num_rows = get_const_tuple(weight_indptr.shape)[0] - 1
+    num_blocks = get_const_tuple(weight_indices.shape)[0]
+    cfg.add_flop(2 * m * num_blocks * bs_r * bs_c)
+    cfg.define_knob("blocks_per_bin", [16, 4, 8, 32, 64])
+    cfg.define_knob("warps", [4, 2, 8])
+    return te.extern(
+        [(m, num_rows * bs_r)], [data, weight_data, weight_indices, weight_indptr],
+        lambda ins, outs: _sparse_dense_binned_ir(ins[0], ins[1], ins[2], ins[3], outs[0],
+                                                  bs_r, bs_c, cfg["blocks_per_bin"].val,
+                                                  cfg["warps"].val),
+        dtype=[data.dtype], name="sparse_dense_binned", tag="sparse_dense_binned")
+
+
+@autotvm.register_topi_schedule("sparse_dense_binned.cuda")
+def schedule_sparse_dense_binned(cfg, outs):
+    """Create schedule for the binned sparse dense, the injective epilogue"""
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    s = te.create_schedule([x.op for x in outs])
+    scheduled_ops = []
+
+    def traverse(op):
+        if tag.is_injective(op.tag):
+            schedule_injective_from_existing(s, op.output(0))
+        for tensor in op.input_tensors:
+            if tensor.op.input_tensors and tensor.op not in scheduled_ops:
+                traverse(tensor.op)
+        scheduled_ops.append(op)
+    for out in outs:
+        traverse(out.op)
+    return s
+
+
+def _ceil_div(a, b):
+    return (a + b - 1) // b
+
+
+def _bin_start(ib, indptr, bin_id, num_bins, num_blocks, num_rows, name):
+    """The first row of a bin, the first row starting at or after the share
+    of nonzeros of the bins before it"""
+    share = (bin_id * num_blocks) // num_bins
+    lo = ib.allocate("int32", (1,), name=name + "_lo", scope="local")
+    hi = ib.allocate("int32", (1,), name=name + "_hi", scope="local")
+    lo[0] = 0
+    hi[0] = num_rows
+    with ib.for_range(0, num_rows.bit_length() + 1, name=name + "_step"):
+        with ib.if_scope(lo[0] < hi[0]):
+            mid = (lo[0] + hi[0]) // 2
+            with ib.if_scope(indptr[mid] < share.astype(indptr.dtype)):
+                lo[0] = mid + 1
+            with ib.else_scope():
+                hi[0] = mid
+    return lo[0]
+
+
+def _sparse_dense_binned_ir(data, w_data, w_indices, w_indptr, out, bs_r, bs_c,
+                            blocks_per_bin, warps):
+    """define ir for the binned sparse dense"""
+    # pylint: disable=too-many-locals
+    m, k = get_const_tuple(data.shape)
+    num_rows = get_const_tuple(w_indptr.shape)[0] - 1
+    num_blocks = get_const_tuple(w_indices.shape)[0]
+    n = num_rows * bs_r
+    warp_size = int(tvm.target.Target.current(allow_none=False).thread_warp_size)
+    nthreads = warp_size * warps
+    num_bins = max(1, min(num_rows, _ceil_div(num_blocks, blocks_per_bin)))
+
+    # A thread block computes m_tile rows of the output, enough for every lane
+    # of a warp to compute an output of a block row.
+    row_bytes = k * tvm.runtime.DataType(data.dtype).bits // 8
+    m_tile = min(m, _ceil_div(warp_size, bs_r))
+    stage = row_bytes <= _MAX_SHARED_BYTES
+    if stage:
+        m_tile = min(m_tile, _MAX_SHARED_BYTES // row_bytes)
+    lanes = _ceil_div(m_tile * bs_r, warp_size)
+
+    ib = tvm.tir.ir_builder.create()
+    data_ptr = ib.buffer_ptr(data)
+    w_data_ptr = ib.buffer_ptr(w_data)
+    w_indices_ptr = ib.buffer_ptr(w_indices)
+    w_indptr_ptr = ib.buffer_ptr(w_indptr)
+    out_ptr = ib.buffer_ptr(out)
+
+    bx = te.thread_axis("blockIdx.x")
+    by = te.thread_axis("blockIdx.y")
+    tx = te.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", _ceil_div(num_bins, warps))
+    ib.scope_attr(by, "thread_extent", _ceil_div(m, m_tile))
+    ib.scope_attr(tx, "thread_extent", nthreads)
+    m_start = by * m_tile
+
+    if stage:
+        data_s = ib.allocate(data.dtype, (m_tile * k,), name="data_s", scope="shared")
+        with ib.for_range(0, _ceil_div(m_tile * k, nthreads), name="i") as i:
+            idx = i * nthreads + tx
+            with ib.if_scope(tvm.tir.all(idx < m_tile * k, m_start * k + idx < m * k)):
+                data_s[idx] = data_ptr[m_start * k + idx]
+        ib.emit(tvm.tir.Call(None, 'tir.tvm_storage_sync', tvm.runtime.convert(['shared'])))
+
+    def _dense(mi, col):
+        if stage:
+            return data_s[mi * k + col]
+        return data_ptr[(m_start + mi) * k + col]
+
+    bin_id = bx * warps + tx // warp_size
+    lane = tx % warp_size
+    with ib.if_scope(bin_id < num_bins):
+        row_begin = _bin_start(ib, w_indptr_ptr, bin_id, num_bins, num_blocks, num_rows,
+                               "row_begin")
+        # The last bin also takes the trailing empty rows.
+        row_end = tvm.tir.if_then_else(
+            bin_id + 1 == num_bins, num_rows,
+            _bin_start(ib, w_indptr_ptr, bin_id + 1, num_bins, num_blocks, num_rows, "row_end"))
+        acc = ib.allocate(out.dtype, (lanes,), name="acc", scope="local")
+
+        # Lane l of the warp computes the outputs p = l * warp_size + lane of the
+        # m_tile x bs_r outputs of a block row.
+        def _valid(p):
+            return tvm.tir.all(p < m_tile * bs_r, m_start + p // bs_r < m)
+
+        with ib.for_range(0, row_end - row_begin, name="row") as row_i:
+            row = row_begin + row_i
+            with ib.for_range(0, lanes, name="l", for_type="unroll") as l:
+                acc[l] = tvm.tir.const(0, out.dtype)
+            block_begin = w_indptr_ptr[row]
+            with ib.for_range(0, w_indptr_ptr[row + 1] - block_begin, name="b") as b_i:
+                block = block_begin + b_i
+                col = w_indices_ptr[block] * bs_c
+                with ib.for_range(0, lanes, name="l", for_type="unroll") as l:
+                    p = l * warp_size + lane
+                    with ib.if_scope(_valid(p)):
+                        with ib.for_range(0, bs_c, name="c") as c:
+                            acc[l] += w_data_ptr[(block * bs_r + p % bs_r) * bs_c + c] * \
+                                _dense(p // bs_r, col + c)
+            with ib.for_range(0, lanes, name="l", for_type="unroll") as l:
+                p = l * warp_size + lane
+                with ib.if_scope(_valid(p)):
+                    out_ptr[(m_start + p // bs_r) * n + row * bs_r + p % bs_r] = acc[l]
+
+    return ib.get()
@@ -20,7 +20,7 @@ import tvm
 from tvm import te
 
 
-def dp4a(x_scope='local', y_scope='local', z_scope='local'):
+def dp4a(x_scope='local', y_scope='local', z_scope='local', dtype='int8'):
     """
     Int8 dot product reduced by every 4 elements using __dp4a
 
@@ -32,6 +32,8 @@ def dp4a(x_scope='local', y_scope='local', z_scope='local'):
         The storage scope of buffer for rhs
     z_scope : str, optional
         The storage scope of buffer for result
+    dtype : str, optional
+        The data type of both operands, int8 or uint8
 
     Returns
     -------
@@ -40,8 +42,9 @@ def dp4a(x_scope='local', y_scope='local', z_scope='local'):
     """
 
     n = 4  # dp4a requires operands packed by 4
-    x = te.placeholder((n,), name='x', dtype='int8')
-    y = te.placeholder((n,), name='y', dtype='int8')
+    assert dtype in ('int8', 'uint8')
+    x = te.placeholder((n,), name='x', dtype=dtype)
+    y = te.placeholder((n,), name='y', dtype=dtype)
 
     k = te.reduce_axis((0, n), name='rc')
 
@@ -58,11 +61,11 @@ def dp4a(x_scope='local', y_scope='local', z_scope='local'):
 
             ib = tvm.tir.ir_builder.create()
 
-            vec_x = xx.vload(0, dtype='int8x4')
-            vec_y = yy.vload(0, dtype='int8x4')
+            vec_x = xx.vload(0, dtype=dtype + 'x4')
+            vec_y = yy.vload(0, dtype=dtype + 'x4')
             prev_z = 0 if index == 0 else zz.vload(0)
 
-            new_z = tvm.tir.call_pure_extern('int32', '__dp4a', vec_x, vec_y, prev_z)
+            new_z = tvm.tir.call_intrin('int32', 'tir.dp4a', vec_x, vec_y, prev_z)
             ib.emit(zz.vstore(0, new_z))
 
             return ib.get()
@@ -0,0 +1,75 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, unused-variable
+"""Generic dense schedules"""
+from tvm import te
+from ..util import traverse_inline
+
+
+def schedule_dense_int8_packed(outs, intrin):
+    """Schedule the output of nn.dense_int8_packed, tensorizing the inner-most
+    int32_lanes x num_int8_elements block with the int8 dot product intrinsic.
+
+    Parameters
+    ----------
+    outs : Array of Tensor
+        The computation graph description of dense_int8_packed
+        in the format of an array of tensors.
+
+    intrin : TensorIntrin
+        The int8 dot product intrinsic, matching the block of the packed weight.
+
+    Returns
+    -------
+    sch : Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    s = te.create_schedule([x.op for x in outs])
+
+    def _callback(op):
+        if "dense_int8_packed" not in op.tag:
+            return
+        blocked = op.input_tensors[0]
+        packed_weight = blocked.op.input_tensors[1]
+
+        m, no, ni = s[blocked].op.axis
+        ko, ki = s[blocked].op.reduce_axis
+        s[blocked].reorder(m, no, ko, ni, ki)
+        s[blocked].tensorize(ni, intrin)
+        s[blocked].parallel(s[blocked].fuse(m, no))
+
+        # The weight is already packed when the graph pre-packs it at compile time.
+        if isinstance(packed_weight.op, te.tensor.ComputeOp) and \
+                packed_weight.name == "packed_weight":
+            no, ko, ni, ki = s[packed_weight].op.axis
+            s[packed_weight].parallel(s[packed_weight].fuse(no, ko))
+            s[packed_weight].vectorize(s[packed_weight].fuse(ni, ki))
+
+        out = outs[0]
+        if op not in s.outputs:
+            s[op].compute_inline()
+        if len(s[out].op.axis) == 2:
+            y, x = s[out].op.axis
+            xo, xi = s[out].split(x, factor=int(blocked.shape[2]))
+            s[out].parallel(y)
+            s[out].vectorize(xi)
+        else:
+            s[out].parallel(s[out].fuse(*s[out].op.axis))
+
+    traverse_inline(s, outs[0].op, _callback)
+    return s
@@ -490,6 +490,42 @@ def resize_bicubic(indices, data, image_height, image_width,
     return _cast_output(value, data.dtype, out_dtype=out_dtype)
 
 
+def _bilinear_axis_table(in_size, out_size, coordinate_transformation_mode, name):
+    """Compute the source indices and interpolation weight of bilinear resize
+    along one axis, as tables indexed by the output coordinate.
+
+    The tables are tagged injective, so generic schedules inline them back into
+    the resize. Schedules that keep them compute the index arithmetic once per
+    output row or column instead of once per output element.
+    """
+    if coordinate_transformation_mode == "align_corners":
+        scale = (in_size - 1).astype('float') / (out_size - 1)
+    elif coordinate_transformation_mode in ["asymmetric", "half_pixel"]:
+        scale = in_size.astype('float') / out_size
+    else:
+        raise ValueError("Unsupported coordinate_transformation_mode: {}".format(
+            coordinate_transformation_mode))
+
+    def _in_coord(i):
+        if coordinate_transformation_mode == "half_pixel":
+            return scale * (i + 0.5) - 0.5
+        return scale * i
+
+    def _clamp(index):
+        return tvm.te.max(tvm.te.min(index, in_size - 1), 0)
+
+    lower = te.compute((out_size,),
+                       lambda i: _clamp(te.floor(_in_coord(i)).astype('int32')),
+                       name=name + "_lower", tag=tag.INJECTIVE)
+    upper = te.compute((out_size,),
+                       lambda i: _clamp(te.ceil(_in_coord(i)).astype('int32')),
+                       name=name + "_upper", tag=tag.INJECTIVE)
+    weight = te.compute((out_size,),
+                        lambda i: _in_coord(i) - te.floor(_in_coord(i)).astype('int32'),
+                        name=name + "_weight", tag=tag.INJECTIVE)
+    return lower, upper, weight
+
+
 def resize(data, size, layout="NCHW", method="bilinear",
            coordinate_transformation_mode="half_pixel", out_dtype=None, output_shape=None):
     """Perform resize operation on the data.
@@ -568,6 +604,23 @@ def resize(data, size, layout="NCHW", method="bilinear",
                                coordinate_transformation_mode,
                                out_dtype=out_dtype)
 
+    def _bilinear_from_tables(*indices):
+        n, c, y, x, cc, inum, ic = get_2d_indices(indices, layout=layout)
+        y_lower, y_upper, y_lerp = y_table
+        x_lower, x_upper, x_lerp = x_table
+
+        def _pixel(y_index, x_index):
+            return get_2d_pixel(data, layout, None, in_h, in_w,
+                                n, c, y_index, x_index, cc, inum, ic)
+
+        def _lerp(A, B, t):
+            return A * (1.0 - t) + B * t
+
+        top = _lerp(_pixel(y_lower[y], x_lower[x]), _pixel(y_lower[y], x_upper[x]), x_lerp[x])
+        bottom = _lerp(_pixel(y_upper[y], x_lower[x]), _pixel(y_upper[y], x_upper[x]), x_lerp[x])
+        value = _lerp(top, bottom, y_lerp[y])
+        return value.astype(out_dtype if out_dtype else data.dtype)
+
     def _bicubic(*indices):
         return resize_bicubic(indices, data, in_h, in_w,
                               size[0], size[1], layout,
@@ -578,8 +631,14 @@ def resize(data, size, layout="NCHW", method="bilinear",
     # Determine which interpolation method to use then run it.
     if method == "nearest_neighbor":
         compute_func = _nearest_neighbor
-    elif method == "bilinear":
+    elif method == "bilinear" and isinstance(size, te.Tensor):
         compute_func = _bilinear
+    elif method == "bilinear":
+        y_table = _bilinear_axis_table(in_h, size[0], coordinate_transformation_mode,
+                                       "resize_table_y")
+        x_table = _bilinear_axis_table(in_w, size[1], coordinate_transformation_mode,
+                                       "resize_table_x")
+        compute_func = _bilinear_from_tables
     elif method == "bicubic":
         compute_func = _bicubic
     else:
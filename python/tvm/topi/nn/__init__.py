@@ -42,6 +42,7 @@ from .bitserial_conv2d import *
 from .bitserial_dense import *
 from .batch_matmul import *
 from .sparse import *
+from .optimizer import *
 from .pad import *
 from .fifo_buffer import *
 from .depth_to_space import *
@@ -15,8 +15,10 @@
 # specific language governing permissions and limitations
 # under the License.
 """TVM operator fully connected compute."""
+import tvm
 from tvm import te
 from .. import tag
+from ..util import get_const_tuple
 
 def dense(data, weight, bias=None, out_dtype=None):
     """The default implementation of dense in topi.
@@ -58,3 +60,208 @@ def dense(data, weight, bias=None, out_dtype=None):
                             lambda i, j: matmul[i, j] + bias[j].astype(out_dtype), \
                             tag=tag.BROADCAST)
     return matmul
+
+
+def dense_pack(data, weight, bias=None, out_dtype=None):
+    """The default implementation of dense with a pre-packed weight in topi.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        2-D with shape [batch, in_dim]
+
+    weight : tvm.te.Tensor
+        3-D with shape [out_dim // pack_weight_tile, in_dim, pack_weight_tile]
+
+    bias : tvm.te.Tensor, optional
+        1-D with shape [out_dim]
+
+    out_dtype : str
+        The output type. This is used for mixed precision.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+    """
+    assert len(data.shape) == 2 and len(weight.shape) == 3, \
+        "only support 2-dim data and 3-dim packed weight"
+    if out_dtype is None:
+        out_dtype = data.dtype
+    batch, in_dim = get_const_tuple(data.shape)
+    n_outer, _, packw_bn = get_const_tuple(weight.shape)
+    out_dim = n_outer * packw_bn
+
+    idxdiv = tvm.tir.indexdiv
+    idxmod = tvm.tir.indexmod
+    k = te.reduce_axis((0, in_dim), name='k')
+    matmul = te.compute((batch, out_dim),
+                        lambda i, j: te.sum(
+                            data[i, k].astype(out_dtype) *
+                            weight[idxdiv(j, packw_bn), k, idxmod(j, packw_bn)].astype(out_dtype),
+                            axis=k),
+                        name='T_dense_pack', tag='dense_pack')
+    if bias is not None:
+        matmul = te.compute((batch, out_dim),
+                            lambda i, j: matmul[i, j] + bias[j].astype(out_dtype),
+                            tag=tag.BROADCAST)
+    return matmul
+
+
+def dense_bias_act(data, weight, bias, activation="none", out_dtype=None):
+    """Dense followed by a bias add and an activation, computed as one epilogue stage.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        2-D with shape [batch, in_dim]
+
+    weight : tvm.te.Tensor
+        2-D with shape [out_dim, in_dim]
+
+    bias : tvm.te.Tensor
+        1-D with shape [out_dim]
+
+    activation : str
+        The activation after the bias add, one of "none", "relu" and "gelu".
+
+    out_dtype : str
+        The output type. This is used for mixed precision.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+    """
+    if out_dtype is None:
+        out_dtype = data.dtype
+    matmul = dense(data, weight, None, out_dtype)
+    return dense_epilogue(matmul, bias, activation)
+
+
+def dense_epilogue(matmul, bias, activation="none"):
+    """Apply the bias add and activation of dense_bias_act to a dense result.
+
+    Parameters
+    ----------
+    matmul : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+
+    bias : tvm.te.Tensor
+        1-D with shape [out_dim]
+
+    activation : str
+        The activation after the bias add, one of "none", "relu" and "gelu".
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+    """
+    out_dtype = matmul.dtype
+
+    def _epilogue(i, j):
+        val = matmul[i, j] + bias[j].astype(out_dtype)
+        if activation == "relu":
+            return te.max(val, tvm.tir.const(0, out_dtype))
+        if activation == "gelu":
+            half = tvm.tir.const(0.5, out_dtype)
+            return val * (half + te.erf(val * tvm.tir.const(0.5 ** 0.5, out_dtype)) * half)
+        assert activation == "none", "Unsupported activation %s" % activation
+        return val
+
+    return te.compute(matmul.shape, _epilogue, name="T_dense_epilogue", tag=tag.BROADCAST)
+
+
+@tvm.target.generic_func
+def dense_alter_layout(attrs, inputs, tinfos, out_type):
+    """Change dense layout.
+
+    Parameters
+    ----------
+    attrs : tvm.ir.Attrs
+        Attributes of current dense op
+    inputs : tvm.relay.Expr
+        Grouped input symbols
+    tinfos : list
+        Input shape and dtype
+    out_type: type
+        The output type
+
+    Note
+    ----
+    Unlike other TOPI functions, this function operates on both graph level and operator level.
+    """
+    # not to change by default
+    return None
+
+
+def dense_int8_packed(data, weight, bias=None, out_dtype="int32",
+                      int32_lanes=16, num_int8_elements=4):
+    """Compute int8 dense in the layout of the int8 dot product intrinsics.
+    The weight is packed into [out_dim // int32_lanes, in_dim // num_int8_elements,
+    int32_lanes, num_int8_elements] blocks, so the inner-most loops take data[num_int8_elements]
+    and a kernel[int32_lanes, num_int8_elements] block to produce output[int32_lanes].
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        2-D with shape [batch, in_dim]
+
+    weight : tvm.te.Tensor
+        2-D with shape [out_dim, in_dim], or 4-D when it is already packed, with shape
+        [out_dim // int32_lanes, in_dim // num_int8_elements, int32_lanes, num_int8_elements]
+
+    bias : tvm.te.Tensor, optional
+        1-D with shape [out_dim]
+
+    out_dtype : str
+        The output type, int32 or uint32.
+
+    int32_lanes : int
+        How many int32/uint32 the intrinsic produces, out_dim must be a multiple of it.
+
+    num_int8_elements : int
+        How many int8/uint8 the intrinsic reduces, in_dim must be a multiple of it.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+    """
+    assert len(data.shape) == 2 and len(weight.shape) in (2, 4), \
+        "only support 2-dim dense"
+    batch, in_dim = get_const_tuple(data.shape)
+    if len(weight.shape) == 4:
+        # The graph packed the weight at compile time.
+        n_outer, _, lanes, elements = get_const_tuple(weight.shape)
+        assert (lanes, elements) == (int32_lanes, num_int8_elements), \
+            "the weight is packed for another int8 dot product block"
+        out_dim = n_outer * int32_lanes
+        packed_weight = weight
+    else:
+        out_dim, _ = get_const_tuple(weight.shape)
+        assert out_dim % int32_lanes == 0 and in_dim % num_int8_elements == 0, \
+            "dense shape is not a multiple of the int8 dot product block"
+        packed_weight = te.compute(
+            (out_dim // int32_lanes, in_dim // num_int8_elements, int32_lanes, num_int8_elements),
+            lambda no, ko, ni, ki: weight[no * int32_lanes + ni, ko * num_int8_elements + ki],
+            name="packed_weight")
+    ko = te.reduce_axis((0, in_dim // num_int8_elements), name="ko")
+    ki = te.reduce_axis((0, num_int8_elements), name="ki")
+    blocked = te.compute(
+        (batch, out_dim // int32_lanes, int32_lanes),
+        lambda m, no, ni: te.sum(
+            data[m, ko * num_int8_elements + ki].astype(out_dtype) *
+            packed_weight[no, ko, ni, ki].astype(out_dtype), axis=[ko, ki]),
+        name="T_dense_int8_block")
+    idxdiv = tvm.tir.indexdiv
+    idxmod = tvm.tir.indexmod
+    matmul = te.compute((batch, out_dim),
+                        lambda i, j: blocked[i, idxdiv(j, int32_lanes), idxmod(j, int32_lanes)],
+                        name="T_dense", tag="dense_int8_packed")
+    if bias is not None:
+        matmul = te.compute((batch, out_dim),
+                            lambda i, j: matmul[i, j] + bias[j].astype(out_dtype),
+                            tag=tag.BROADCAST)
+    return matmul
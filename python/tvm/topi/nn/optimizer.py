@@ -0,0 +1,153 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Multi-tensor optimizer update operators"""
+import tvm
+from tvm import te
+
+from ..util import get_const_tuple, get_const_int, prod
+
+
+def multi_sgd_update(weights, grads, lr):
+    """Update all the weights with a step of stochastic gradient descent,
+    w - lr * g, in one kernel reading and writing every tensor once.
+
+    Parameters
+    ----------
+    weights : list of tvm.te.Tensor
+        The weights.
+
+    grads : list of tvm.te.Tensor
+        The gradients of the weights, of the same shapes.
+
+    lr : tvm.te.Tensor
+        0-D, the learning rate.
+
+    Returns
+    -------
+    output : list of tvm.te.Tensor
+        The updated weights.
+    """
+    def _update(values, lr):
+        w, g = values
+        return [w - lr.astype(w.dtype) * g]
+    return _multi_update([weights, grads], lr, 1, _update, "multi_sgd_update")
+
+
+def multi_adam_update(weights, grads, means, variances, lr, beta1, beta2, epsilon):
+    """Update all the weights with a step of Adam in one kernel reading and
+    writing every tensor once.
+
+    Parameters
+    ----------
+    weights : list of tvm.te.Tensor
+        The weights.
+
+    grads : list of tvm.te.Tensor
+        The gradients of the weights, of the same shapes.
+
+    means : list of tvm.te.Tensor
+        The moving averages of the gradients.
+
+    variances : list of tvm.te.Tensor
+        The moving averages of the squared gradients.
+
+    lr : tvm.te.Tensor
+        0-D, the learning rate, bias correction included.
+
+    beta1 : float
+        Decay rate of the means.
+
+    beta2 : float
+        Decay rate of the variances.
+
+    epsilon : float
+        Added to the square root of the variances.
+
+    Returns
+    -------
+    output : list of tvm.te.Tensor
+        The updated weights, then the updated means, then the updated variances.
+    """
+    def _update(values, lr):
+        w, g, m, v = values
+        dtype = w.dtype
+        m = tvm.tir.const(beta1, dtype) * m + tvm.tir.const(1 - beta1, dtype) * g
+        v = tvm.tir.const(beta2, dtype) * v + tvm.tir.const(1 - beta2, dtype) * g * g
+        step = m / (te.sqrt(v) + tvm.tir.const(epsilon, dtype))
+        return [w - lr.astype(dtype) * step, m, v]
+    return _multi_update([weights, grads, means, variances], lr, 3, _update,
+                         "multi_adam_update")
+
+
+def _multi_update(inputs, lr, num_outputs, update, name):
+    """Apply update to the elements of every tensor.
+
+    inputs holds the lists of tensors of every kind, update maps the values of
+    an element in all the kinds and the learning rate to the values of the
+    num_outputs outputs. The outputs are the tensors of the first kind, repeated
+    num_outputs times.
+    """
+    tensors = inputs[0]
+    for kind in inputs[1:]:
+        assert len(kind) == len(tensors)
+        for a, b in zip(tensors, kind):
+            assert get_const_tuple(a.shape) == get_const_tuple(b.shape)
+    shapes = [t.shape for t in tensors] * num_outputs
+    dtypes = [t.dtype for t in tensors] * num_outputs
+    flat_inputs = [t for kind in inputs for t in kind]
+    return te.extern(shapes, flat_inputs + [lr],
+                     lambda ins, outs: _multi_update_ir(ins, outs, len(inputs), num_outputs,
+                                                        update),
+                     dtype=dtypes, name=name, tag=name)
+
+
+def _multi_update_ir(ins, outs, num_kinds, num_outputs, update):
+    """define ir for the multi-tensor updates"""
+    ib = tvm.tir.ir_builder.create()
+    n = len(outs) // num_outputs
+    in_ptrs = [ib.buffer_ptr(buf) for buf in ins[:-1]]
+    out_ptrs = [ib.buffer_ptr(buf) for buf in outs]
+    lr = ib.buffer_ptr(ins[-1])[0]
+    sizes = [get_const_int(prod(get_const_tuple(buf.shape))) for buf in outs[:n]]
+
+    def _update_element(j, i):
+        values = update([in_ptrs[k * n + j][i] for k in range(num_kinds)], lr)
+        for o, value in enumerate(values):
+            out_ptrs[o * n + j][i] = value
+
+    target = tvm.target.Target.current(allow_none=True)
+    if target is None or "gpu" not in target.keys:
+        for j in range(n):
+            with ib.for_range(0, sizes[j], name="i", for_type="parallel") as i:
+                _update_element(j, i)
+        return ib.get()
+
+    # A single kernel, the threads past the elements of a tensor update the next.
+    total = sum(sizes)
+    nthreads = int(target.max_num_threads)
+    bx = te.thread_axis("blockIdx.x")
+    tx = te.thread_axis("threadIdx.x")
+    ib.scope_attr(bx, "thread_extent", (total + nthreads - 1) // nthreads)
+    ib.scope_attr(tx, "thread_extent", nthreads)
+    tid = bx * nthreads + tx
+    offset = 0
+    for j in range(n):
+        with ib.if_scope(tvm.tir.all(tid >= offset, tid < offset + sizes[j])):
+            _update_element(j, tid - offset)
+        offset += sizes[j]
+    return ib.get()
@@ -77,6 +77,59 @@ def softmax(x, axis=-1):
     return te.compute(shape, lambda *indices: _normalize(exp, expsum, *indices),
                       name='T_softmax_norm', attrs={"axis" : axis})
 
+def _online_softmax_combine(x, y):
+    max_elem = tvm.te.max(x[0], y[0])
+    return max_elem, x[1] * te.exp(x[0] - max_elem) + y[1] * te.exp(y[0] - max_elem)
+
+def _online_softmax_identity(max_dtype, sum_dtype):
+    # The lowest finite value rather than -inf, so that two identities combine to zero
+    return tvm.te.min_value(max_dtype), tvm.tir.const(0, sum_dtype)
+
+@tvm.te.tag_scope(tag='online_softmax_output')
+def online_softmax(x, axis=-1):
+    """Perform softmax activation on the data with a single reduction.
+
+    The running maximum and the sum of exponentials rescaled to it are reduced
+    together, so the input is read once to reduce and once to normalize, and no
+    exp tensor is materialized.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        can be any dimension
+
+    axis : int
+        channel axis
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        output shape is the same as input
+    """
+    shape = x.shape
+    if axis < 0:
+        axis = len(shape) + axis
+    if axis >= len(shape):
+        ValueError("axis parameter should be less than input dim")
+
+    k = te.reduce_axis((0, shape[axis]), name='k')
+    reducer = te.comm_reducer(_online_softmax_combine, _online_softmax_identity,
+                              name='online_softmax')
+
+    def _compute_max_expsum(*indices):
+        eval_range = indices[:axis] + (k,) + indices[axis:]
+        return reducer((x[eval_range], tvm.tir.const(1, x.dtype)), axis=k)
+
+    def _normalize(max_elem, expsum, *indices):
+        non_reduce_indices = tuple([var for (i, var) in enumerate(indices) if i != axis])
+        return te.exp(x[indices] - max_elem[non_reduce_indices]) / expsum[non_reduce_indices]
+
+    reduced_shape = tuple([dim for (i, dim) in enumerate(shape) if i != axis])
+    max_elem, expsum = te.compute(reduced_shape, _compute_max_expsum,
+                                  name='T_softmax_maxelem_expsum')
+    return te.compute(shape, lambda *indices: _normalize(max_elem, expsum, *indices),
+                      name='T_softmax_norm', attrs={"axis" : axis})
+
 @tvm.te.tag_scope(tag='log_softmax_output')
 def log_softmax(x):
     """Perform log softmax activation on the data
@@ -21,7 +21,8 @@ from tvm import autotvm
 from tvm.contrib import rocblas
 from .. import generic, nn
 from .. import tag
-from ..util import traverse_inline
+from ..util import traverse_inline, get_const_tuple
+from .tensor_intrin import mfma, mfma_accumulator, MFMA_K
 
 @autotvm.register_topi_compute('dense.rocm')
 def dense(cfg, data, weight, bias=None, out_dtype=None):
@@ -141,3 +142,107 @@ def dense_rocblas(cfg, data, weight, bias=None, out_dtype=None):
 def schedule_dense_rocblas(_, outs):
     """Schedule for dense operator with rocm cblas"""
     return generic.schedule_extern(outs)
+
+
+@autotvm.register_topi_compute('dense_mfma.rocm')
+def dense_mfma(cfg, data, weight, bias=None, out_dtype=None):
+    """Dense operator on the matrix cores of CDNA GPUs.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        2-D with shape [batch, in_dim], float16, bfloat16 or int8
+
+    weight : tvm.te.Tensor
+        2-D with shape [out_dim, in_dim]
+
+    bias : tvm.te.Tensor, optional
+        1-D with shape [out_dim]
+
+    out_dtype : str
+        The output type, the accumulator type of the mfma instructions.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [batch, out_dim]
+    """
+    if out_dtype is None:
+        out_dtype = mfma_accumulator(data.dtype)
+    assert data.dtype == weight.dtype, "Mixed precision not supported."
+    assert out_dtype == mfma_accumulator(data.dtype), \
+        "mfma of %s accumulates in %s" % (data.dtype, mfma_accumulator(data.dtype))
+    batch, in_dim = get_const_tuple(data.shape)
+    out_dim, _ = get_const_tuple(weight.shape)
+    assert batch % 32 == 0 and out_dim % 32 == 0 and in_dim % MFMA_K[data.dtype] == 0, \
+        "dense_mfma requires the tiles of the mfma instructions to divide the shapes"
+    cfg.add_flop(batch * in_dim * out_dim * 2)
+    return nn.dense(data, weight, bias, out_dtype)
+
+
+@autotvm.register_topi_schedule('dense_mfma.rocm')
+def schedule_dense_mfma(cfg, outs):
+    """Schedule for dense operator on the matrix cores of CDNA GPUs.
+
+    Every block is a wavefront computing a 32x32 tile of the output.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+        The computation graph description of dense
+        in the format of an array of tensors.
+
+    Returns
+    -------
+    s: Schedule
+        The computation schedule for dense.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    s = te.create_schedule([x.op for x in outs])
+
+    def _callback(op):
+        if op.tag == 'dense':
+            _schedule_dense_mfma(cfg, s, op.output(0), outs[0])
+
+    traverse_inline(s, outs[0].op, _callback)
+    return s
+
+
+def _schedule_dense_mfma(cfg, s, Dense, out):
+    data, weight = s[Dense].op.input_tensors
+    in_dim = get_const_tuple(data.shape)[1]
+    k_size = MFMA_K[data.dtype]
+    cfg.define_knob("k_steps", [1, 2, 4])
+    k_steps = cfg["k_steps"].val if in_dim % (k_size * cfg["k_steps"].val) == 0 else 1
+
+    DenseS = s.cache_write(Dense, 'shared')
+    DataS = s.cache_read(data, 'shared', [DenseS])
+    WeightS = s.cache_read(weight, 'shared', [DenseS])
+    if Dense.op in s.outputs:
+        Out = Dense
+    else:
+        Out = out.op.output(0)
+        s[Dense].compute_inline()
+
+    thread_x = te.thread_axis("threadIdx.x")
+    i, j = s[Out].op.axis
+    bi, ii = s[Out].split(i, factor=32)
+    bj, jj = s[Out].split(j, factor=32)
+    s[Out].reorder(bi, bj, ii, jj)
+    s[Out].bind(bi, te.thread_axis("blockIdx.y"))
+    s[Out].bind(bj, te.thread_axis("blockIdx.x"))
+    _, tx = s[Out].split(s[Out].fuse(ii, jj), factor=64)
+    s[Out].bind(tx, thread_x)
+
+    # The tile is computed by all the lanes of the wavefront together.
+    s[DenseS].compute_at(s[Out], bj)
+    ci, cj = s[DenseS].op.axis
+    ko, ki = s[DenseS].split(s[DenseS].op.reduce_axis[0], factor=k_size * k_steps)
+    kio, kii = s[DenseS].split(ki, factor=k_size)
+    s[DenseS].reorder(ko, kio, ci, cj, kii)
+    s[DenseS].tensorize(ci, mfma(data.dtype))
+
+    for load in [DataS, WeightS]:
+        s[load].compute_at(s[DenseS], ko)
+        _, tx = s[load].split(s[load].fuse(*s[load].op.axis), factor=64)
+        s[load].bind(tx, thread_x)
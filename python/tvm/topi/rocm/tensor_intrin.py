@@ -0,0 +1,120 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Tensor intrinsics on ROCm."""
+import tvm
+from tvm import te
+
+# The reduction length of the 32x32 mfma instructions for every input type.
+MFMA_K = {'float16': 8, 'bfloat16': 4, 'int8': 8}
+
+
+def mfma_accumulator(in_dtype):
+    """The accumulator type of the mfma instructions for the given input type"""
+    return 'int32' if in_dtype == 'int8' else 'float32'
+
+
+def _lane_id():
+    """The lane of the thread in its wavefront of 64"""
+    lo = tvm.tir.call_pure_extern('int32', 'llvm.amdgcn.mbcnt.lo', -1, 0)
+    return tvm.tir.call_pure_extern('int32', 'llvm.amdgcn.mbcnt.hi', -1, lo)
+
+
+def mfma(in_dtype, a_scope='shared', b_scope='shared', c_scope='shared'):
+    """
+    Matrix multiply of 32x32 tiles using the matrix cores of CDNA GPUs
+
+    It computes c[i, j] += a[i, k] * b[j, k] over the 32xK tiles a and b, K being
+    MFMA_K[in_dtype]. The 64 lanes of a wavefront compute the tile together, so
+    the tensorized loops must not be bound to threadIdx and the threadIdx.x
+    extent must be a multiple of 64.
+
+    Parameters
+    ----------
+    in_dtype : str
+        The data type of a and b, float16, bfloat16 or int8
+    a_scope : str, optional
+        The storage scope of buffer for lhs
+    b_scope : str, optional
+        The storage scope of buffer for rhs
+    c_scope : str, optional
+        The storage scope of buffer for result
+
+    Returns
+    -------
+    intrin : TensorIntrin
+        The mfma TensorIntrin that can be used in tensorizing schedule.
+    """
+    assert in_dtype in MFMA_K, "mfma does not support %s" % in_dtype
+    k_size = MFMA_K[in_dtype]
+    out_dtype = mfma_accumulator(in_dtype)
+    # Every lane holds k_size / 2 elements of a row of a and b, and 16 elements of c.
+    k_lanes = k_size // 2
+
+    a = te.placeholder((32, k_size), name='a', dtype=in_dtype)
+    b = te.placeholder((32, k_size), name='b', dtype=in_dtype)
+    k = te.reduce_axis((0, k_size), name='k')
+    c = te.compute((32, 32), lambda i, j: te.sum(
+        a[i, k].astype(out_dtype) * b[j, k].astype(out_dtype), axis=[k]), name='c')
+
+    def _intrin_func(ins, outs):
+        aa, bb = ins
+        cc = outs[0]
+        lane = _lane_id()
+        row = lane % 32
+        half = lane // 32
+
+        def _operand(buf):
+            # elements [half * k_lanes, (half + 1) * k_lanes) of the row of the lane
+            index = buf.elem_offset + row * buf.strides[0] + half * k_lanes
+            return tvm.tir.Load('%sx%d' % (in_dtype, k_lanes), buf.data,
+                                tvm.tir.Ramp(index, 1, k_lanes))
+
+        def _acc_index(v):
+            # rows 8 * v + 4 * half + [0, 4) of the column of the lane
+            return tvm.tir.Ramp(cc.elem_offset + (8 * v + 4 * half) * cc.strides[0] + row,
+                                cc.strides[0], 4)
+
+        def _store(value):
+            ib = tvm.tir.ir_builder.create()
+            acc = te.var('acc', value.dtype)
+            ib.emit(lambda body: tvm.tir.LetStmt(acc, value, body))
+            for v in range(4):
+                part = tvm.tir.Shuffle([acc], list(range(4 * v, 4 * v + 4)))
+                ib.emit(tvm.tir.Store(cc.data, part, _acc_index(v)))
+            return ib.get()
+
+        def _instr(index):
+            if index == 1:
+                return _store(tvm.tir.Broadcast(tvm.tir.const(0, out_dtype), 16))
+            if index == 0:
+                prev = tvm.tir.Broadcast(tvm.tir.const(0, out_dtype), 16)
+            else:
+                prev = tvm.tir.Shuffle(
+                    [tvm.tir.Load(out_dtype + 'x4', cc.data, _acc_index(v)) for v in range(4)],
+                    list(range(16)))
+            return _store(tvm.tir.call_intrin(out_dtype + 'x16', 'tir.mfma',
+                                              _operand(aa), _operand(bb), prev))
+
+        return _instr(0), _instr(1), _instr(2) # body, reset, update
+
+    scopes = {a: a_scope, b: b_scope, c: c_scope}
+    binds = {t: tvm.tir.decl_buffer(t.shape, t.dtype, t.op.name, scope=scopes[t],
+                                    strides=[te.var('%s_stride' % t.op.name), 1],
+                                    offset_factor=1) for t in [a, b, c]}
+
+    return te.decl_tensor_intrin(c.op, _intrin_func, binds=binds)
@@ -0,0 +1,128 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Scan operators"""
+from tvm import te
+from tvm.tir import indexdiv, indexmod
+
+
+def blocked_scan(data, fcombine, num_blocks=1, name="blocked_scan", tag="blocked_scan"):
+    """Inclusive scan of data along its first axis.
+
+    te.scan runs the whole scan axis as one sequential loop. When fcombine is associative, the
+    axis can be cut into num_blocks blocks instead: every block is scanned on its own, the last
+    values of the blocks are scanned, and the result of the preceding blocks is combined into
+    every element of a block. The first and last steps are data parallel across blocks, only the
+    scan over the num_blocks block values is sequential.
+
+    The block scan is the te.scan named `name + ".local"`, whose update stage has the block
+    index as axis 1. Parallelize that axis, and the first axis of the output, to spread the
+    scan over CPU threads or GPU blocks, see topi.x86.schedule_blocked_scan.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        The input tensor, scanned along its first axis.
+
+    fcombine : function(PrimExpr, PrimExpr) -> PrimExpr
+        The combiner, e.g. lambda x, y: x + y. It must be associative when num_blocks > 1.
+
+    num_blocks : int, optional
+        The number of blocks. 1 lowers to a plain sequential te.scan.
+
+    name : str, optional
+        The name hint of the output tensor.
+
+    tag : str, optional
+        The tag of the output tensor.
+
+    Returns
+    -------
+    out : tvm.te.Tensor
+        The scan result, of the same shape as data.
+    """
+    length = data.shape[0]
+    if num_blocks == 1:
+        state = te.placeholder(data.shape, data.dtype, name=name + ".state")
+        init = te.compute((1,) + tuple(data.shape[1:]), lambda *i: data(*i), name=name + ".init")
+        update = te.compute(
+            data.shape,
+            lambda *i: fcombine(state(i[0] - 1, *i[1:]), data(*i)),
+            name=name + ".update",
+        )
+        return te.scan(init, update, state, [data], name=name, tag=tag)
+
+    rest = tuple(data.shape[1:])
+    block_len = indexdiv(length + num_blocks - 1, num_blocks)
+
+    # The tail of the last block reads the last element again, its results are never used.
+    def load(t, i):
+        return data(te.min(t, length - 1), *i)
+
+    # Scan every block, the block index is the spatial axis 1 of the scan.
+    local_shape = (block_len, num_blocks) + rest
+    local_state = te.placeholder(local_shape, data.dtype, name=name + ".local_state")
+    local_init = te.compute(
+        (1, num_blocks) + rest, lambda *i: load(i[1] * block_len, i[2:]), name=name + ".local_init"
+    )
+    local_update = te.compute(
+        local_shape,
+        lambda *i: fcombine(
+            local_state(i[0] - 1, *i[1:]), load(i[1] * block_len + i[0], i[2:])
+        ),
+        name=name + ".local_update",
+    )
+    local = te.scan(local_init, local_update, local_state, [data], name=name + ".local")
+
+    # Scan the last values of the blocks.
+    carry_state = te.placeholder((num_blocks,) + rest, data.dtype, name=name + ".carry_state")
+    carry_init = te.compute(
+        (1,) + rest, lambda *i: local(block_len - 1, 0, *i[1:]), name=name + ".carry_init"
+    )
+    carry_update = te.compute(
+        (num_blocks,) + rest,
+        lambda *i: fcombine(carry_state(i[0] - 1, *i[1:]), local(block_len - 1, *i)),
+        name=name + ".carry_update",
+    )
+    carry = te.scan(carry_init, carry_update, carry_state, [local], name=name + ".carry")
+
+    def _compute(*i):
+        block = indexdiv(i[0], block_len)
+        value = local(indexmod(i[0], block_len), block, *i[1:])
+        return te.if_then_else(
+            block == 0, value, fcombine(carry(te.max(block - 1, 0), *i[1:]), value)
+        )
+
+    return te.compute(data.shape, _compute, name=name, tag=tag)
+
+
+def cumsum(data, num_blocks=1):
+    """Cumulative sum of data along its first axis.
+
+    Parameters
+    ----------
+    data : tvm.te.Tensor
+        The input tensor.
+
+    num_blocks : int, optional
+        The number of blocks the scan is split into, see blocked_scan.
+
+    Returns
+    -------
+    out : tvm.te.Tensor
+        The cumulative sum, of the same shape as data.
+    """
+    return blocked_scan(data, lambda x, y: x + y, num_blocks, name="cumsum")
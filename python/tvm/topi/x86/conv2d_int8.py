@@ -30,6 +30,7 @@ from ..nn.depthwise_conv2d import _get_workload as _get_depthwise_conv2d_workloa
 from ..util import get_const_tuple, traverse_inline
 from .. import nn
 from . import conv2d_avx_1x1, conv2d_avx_common
+from .util import target_has_avx512
 
 def _get_default_config_int8(cfg, data, kernel, strides, padding, out_dtype, is_depthwise=False,
                              layout='NCHW'):
@@ -67,10 +68,7 @@ def is_int8_hw_support(data_dtype, kernel_dtype):
     is_llvm_support = llvm_version >= 8
 
     # 3) Check target
-    mcpu = tvm.target.Target.current().mcpu
-    is_target_support = False
-    if mcpu in ('skylake-avx512', 'cascadelake'):
-        is_target_support = True
+    is_target_support = target_has_avx512()
 
     return is_dtype_support and is_llvm_support and is_target_support
 
@@ -25,8 +25,10 @@ from tvm.contrib import cblas
 from tvm.contrib import mkl
 from tvm.contrib import mkldnn
 
-from .util import get_fp32_len
-from .. import generic, tag
+from .util import get_fp32_len, target_has_avx512_bf16
+from .tensor_intrin import dot_16x1x16_uint8_int8_int32, dot_16x1x16_bf16_bf16_fp32
+from .. import generic, tag, nn
+from ..generic import dense as dense_generic
 from ..util import traverse_inline, get_const_tuple
 
 def _schedule_dense_pack_template(cfg, s, C):
@@ -53,9 +55,11 @@ def _schedule_dense_pack_template(cfg, s, C):
     s[CC].unroll(y)
     s[CC].unroll(ki)
 
-    z, y, x = s[packedB].op.axis
-    s[packedB].reorder(z, x, y)
-    s[packedB].parallel(z)
+    # The weight is already packed when the graph pre-packs it at compile time.
+    if isinstance(packedB.op, te.tensor.ComputeOp) and packedB.name == "packed_weight":
+        z, y, x = s[packedB].op.axis
+        s[packedB].reorder(z, x, y)
+        s[packedB].parallel(z)
     return s
 
 
@@ -180,11 +184,16 @@ def schedule_dense_nopack(cfg, outs):
 
 @autotvm.register_topi_compute("dense_pack.x86")
 def dense_pack(cfg, data, weight, bias=None, out_dtype=None):
-    """Compute dense with packing"""
+    """Compute dense with packing. The weight can also be given pre-packed,
+    with shape [out_dim // pack_weight_tile, in_dim, pack_weight_tile]."""
     if out_dtype is None:
         out_dtype = data.dtype
     M, K = get_const_tuple(data.shape) # batch, in_dim
-    N, _ = get_const_tuple(weight.shape) # out_dim
+    if len(weight.shape) == 3:
+        N, _, packw_bn = get_const_tuple(weight.shape) # out_dim
+        N = N * packw_bn
+    else:
+        N, _ = get_const_tuple(weight.shape) # out_dim
     # create tuning space
     cfg.define_split("tile_y", M, num_outputs=3)
     cfg.define_split("tile_x", N, num_outputs=3)
@@ -192,10 +201,13 @@ def dense_pack(cfg, data, weight, bias=None, out_dtype=None):
     if cfg.is_fallback:
         _default_dense_pack_config(cfg, M, N, K)
 
-    packw_bn = cfg["tile_x"].size[-1]
-    packw_shape = (N // packw_bn, K, packw_bn)
-    packw = te.compute(packw_shape,
-                       lambda z, y, x: weight[z * packw_bn + x, y], name="packed_weight")
+    if len(weight.shape) == 3:
+        packw = weight
+    else:
+        packw_bn = cfg["tile_x"].size[-1]
+        packw_shape = (N // packw_bn, K, packw_bn)
+        packw = te.compute(packw_shape,
+                           lambda z, y, x: weight[z * packw_bn + x, y], name="packed_weight")
 
     idxdiv = tvm.tir.indexdiv
     idxmod = tvm.tir.indexmod
@@ -275,3 +287,34 @@ def dense_mkldnn(cfg, data, weight, bias=None, out_dtype=None):
 def schedule_dense_mkldnn(_, outs):
     """Create schedule for dense_mkldnn"""
     return generic.schedule_extern(outs)
+
+@autotvm.register_topi_compute("dense_vnni.x86")
+def dense_vnni(cfg, data, weight, bias=None, out_dtype=None):  # pylint: disable=unused-argument
+    """Compute uint8 x int8 dense with the weight packed for the AVX512 int8 dot product"""
+    return nn.dense_int8_packed(data, weight, bias, out_dtype or "int32",
+                                int32_lanes=16, num_int8_elements=4)
+
+@autotvm.register_topi_schedule("dense_vnni.x86")
+def schedule_dense_vnni(cfg, outs):  # pylint: disable=unused-argument
+    """Create the schedule for dense_vnni, tensorized with vpdpbusd on Cascade Lake"""
+    return dense_generic.schedule_dense_int8_packed(outs, dot_16x1x16_uint8_int8_int32())
+
+
+def is_bf16_hw_support(data_dtype, kernel_dtype):
+    """Checks whether dense can use the AVX512 BF16 dot product: the operands are bfloat16,
+    the target has AVX512 BF16 and LLVM takes the pairs of bfloat16 as int32 lanes, which
+    holds from LLVM 11 until LLVM 15 introduced the bfloat vector operands."""
+    llvm_version = tvm.target.codegen.llvm_version_major()
+    return data_dtype == kernel_dtype == "bfloat16" and 11 <= llvm_version < 15 and \
+        target_has_avx512_bf16()
+
+@autotvm.register_topi_compute("dense_bf16.x86")
+def dense_bf16(cfg, data, weight, bias=None, out_dtype=None):  # pylint: disable=unused-argument
+    """Compute bfloat16 dense with the weight packed for the AVX512 BF16 dot product"""
+    return nn.dense_int8_packed(data, weight, bias, out_dtype or "float32",
+                                int32_lanes=16, num_int8_elements=2)
+
+@autotvm.register_topi_schedule("dense_bf16.x86")
+def schedule_dense_bf16(cfg, outs):  # pylint: disable=unused-argument
+    """Create the schedule for dense_bf16, tensorized with vdpbf16ps"""
+    return dense_generic.schedule_dense_int8_packed(outs, dot_16x1x16_bf16_bf16_fp32())
@@ -0,0 +1,84 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name,unused-variable,unused-argument,no-member
+"""Dense alter op functions for x86"""
+
+import tvm
+from tvm import te
+from tvm import relay
+from tvm import autotvm
+from .dense import _default_dense_pack_config
+from ..util import get_const_tuple
+from ..nn import dense_alter_layout
+
+# The int32 lanes and int8 elements of the weight block of each int8 dot product kernel.
+_INT8_DOT_BLOCKS = {
+    "dense_vnni.x86": (16, 4),
+    "dense_dotprod.arm_cpu": (4, 4),
+}
+
+
+@dense_alter_layout.register("cpu")
+def _alter_dense_layout(attrs, inputs, tinfos, out_type):
+    """Rewrite dense into contrib_dense_pack so that the weight is packed by a
+    separate layout_transform, which FoldConstant evaluates at compile time
+    when the weight is a constant."""
+    target = tvm.target.Target.current(allow_none=False)
+    dispatch_ctx = autotvm.task.DispatchContext.current
+    data_tensor, weight_tensor = tinfos
+    out_dtype = out_type.dtype
+    if len(data_tensor.shape) != 2:
+        return None
+    M, K = get_const_tuple(data_tensor.shape)
+    N, _ = get_const_tuple(weight_tensor.shape)
+    if not all(isinstance(x, int) for x in (M, N, K)):
+        return None
+
+    _, outs = relay.backend.compile_engine.select_implementation(
+        relay.op.get("nn.dense"), attrs, tinfos, out_type, target)
+    workload = autotvm.task.get_workload(outs)
+    if workload is not None and workload[0] in _INT8_DOT_BLOCKS:
+        # The int8 dot product kernels block both dimensions of the weight.
+        lanes, elements = _INT8_DOT_BLOCKS[workload[0]]
+        weight_layout = "NK%dn%dk" % (lanes, elements)
+        new_weight = te.placeholder((N // lanes, K // elements, lanes, elements),
+                                    dtype=weight_tensor.dtype)
+        new_workload = autotvm.task.args_to_workload(
+            [data_tensor, new_weight, None, out_dtype], workload[0])
+        dispatch_ctx.update(target, new_workload, dispatch_ctx.query(target, workload))
+        weight_transform = relay.layout_transform(inputs[1], "NK", weight_layout)
+        return relay.nn.contrib_dense_pack(inputs[0], weight_transform, None, out_dtype,
+                                           weight_layout)
+    if workload is None or workload[0] != "dense_pack.x86":
+        # Only dense_pack and the int8 dot product kernels benefit from a packed weight.
+        return None
+
+    cfg = dispatch_ctx.query(target, workload)
+    if cfg.is_fallback:
+        _default_dense_pack_config(cfg, M, N, K)
+    packw_bn = cfg["tile_x"].size[-1]
+    weight_layout = "NK%dn" % packw_bn
+
+    new_weight = te.placeholder((N // packw_bn, K, packw_bn), dtype=weight_tensor.dtype)
+    # Relay dense doesn't have bias.
+    new_workload = autotvm.task.args_to_workload(
+        [data_tensor, new_weight, None, out_dtype], "dense_pack.x86")
+    dispatch_ctx.update(target, new_workload, cfg)
+
+    weight_transform = relay.layout_transform(inputs[1], "NK", weight_layout)
+    return relay.nn.contrib_dense_pack(inputs[0], weight_transform, None, out_dtype,
+                                       weight_layout)
@@ -17,6 +17,7 @@
 # pylint: disable=invalid-name
 """x86 declaration and schedules."""
 from tvm import te
+from .. import tag
 from ..util import is_empty_shape
 
 def schedule_injective_from_existing(sch, out):
@@ -118,5 +119,36 @@ def schedule_concatenate(outs):
         s[x].parallel(s[x].op.axis[0])
     return s
 
+def schedule_resize(outs):
+    """X86 schedule for resize op.
+
+    The per-axis index and weight tables of bilinear resize are kept as
+    separate stages, so the output loop only gathers and interpolates,
+    vectorized along the innermost axis.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of resize in the format
+          of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    x = outs[0]
+    s = te.create_schedule([x.op for x in outs])
+    for stage in s.stages:
+        op = stage.op
+        if isinstance(op, te.tensor.ComputeOp) and tag.is_injective(op.tag) and \
+                op not in s.outputs and not op.name.startswith("resize_table"):
+            stage.compute_inline()
+
+    if not is_empty_shape(x.shape):
+        schedule_injective_from_existing(s, x)
+    return s
+
 schedule_elemwise = schedule_injective
 schedule_broadcast = schedule_injective
@@ -42,14 +42,20 @@ def schedule_softmax(outs):
         expsum = softmax.op.input_tensors[1]
         max_elem = s[exp].op.input_tensors[1]
         axis = int(softmax.op.attrs['axis'])
+    elif op_tag == 'online_softmax_output':
+        exp = None
+        # max_elem and expsum are the two outputs of one reduction
+        reduction = [t.op for t in softmax.op.input_tensors if t.op.num_outputs == 2][0]
+        max_elem, expsum = reduction.output(0), reduction.output(1)
+        axis = int(softmax.op.attrs['axis'])
     elif op_tag == 'log_softmax_output':
         exp = None
         max_elem = softmax.op.input_tensors[1]
         expsum = softmax.op.input_tensors[2]
         axis = 1
     else:
-        raise ValueError('Tag is expected to be softmax_output or log_softmax_output. \
-                         Got {0}'.format(op_tag))
+        raise ValueError('Tag is expected to be softmax_output, online_softmax_output or \
+                         log_softmax_output. Got {0}'.format(op_tag))
 
     # only parallelize outer dimensions up to axis
     outer_axes = [s[softmax].op.axis[i] for i in range(0, axis)]
@@ -58,7 +64,8 @@ def schedule_softmax(outs):
 
     # move computations with the same outer dimensions under the same root
     s[max_elem].compute_at(s[softmax], fused_outer_axes)
-    s[expsum].compute_at(s[softmax], fused_outer_axes)
+    if expsum.op != max_elem.op:
+        s[expsum].compute_at(s[softmax], fused_outer_axes)
 
     if exp is not None:
         s[exp].compute_at(s[softmax], fused_outer_axes)
@@ -16,6 +16,7 @@
 # under the License.
 # pylint: disable=invalid-name, unused-variable
 """Schedule for pooling operators"""
+import tvm
 from tvm import te
 from .. import tag
 
@@ -115,7 +116,38 @@ def schedule_pool(outs, layout):
     return s
 
 
-def schedule_adaptive_pool(outs):
+def _vectorize_inner(sch, axis, inner_length, vectorize_limit=64):
+    """Vectorize axis, splitting it to a constant factor when it is too long."""
+    if inner_length <= vectorize_limit:
+        sch.vectorize(axis)
+        return
+    for factor in range(vectorize_limit, 1, -1):
+        if inner_length % factor == 0:
+            _, inner = sch.split(axis, factor)
+            sch.vectorize(inner)
+            return
+
+
+def _adaptive_pool_sch(sch, oshape, do_vectorize):
+    """Parallelize the outer axes of an adaptive pool, and when the innermost axis
+    is a channel axis, move the pooling windows outside of it and vectorize it.
+    The window bounds only depend on the output position, so they stay out of
+    the vectorized loop."""
+    num_parallel_axis = 3 if len(sch.op.axis) >= 5 else 2
+    if len(sch.op.axis) < 3:
+        sch.parallel(sch.op.axis[0])
+        return
+    fused = sch.fuse(*sch.op.axis[:num_parallel_axis])
+    sch.parallel(fused)
+    inner_length = oshape[-1]
+    if not do_vectorize or not isinstance(inner_length, tvm.tir.IntImm):
+        return
+    c = sch.op.axis[-1]
+    sch.reorder(fused, *sch.op.axis[num_parallel_axis:-1], *sch.op.reduce_axis, c)
+    _vectorize_inner(sch, c, inner_length.value)
+
+
+def schedule_adaptive_pool(outs, layout=None):
     """Schedule for adaptive pool
 
     Parameters
@@ -124,6 +156,9 @@ def schedule_adaptive_pool(outs):
           The computation graph description of adaptive pool
           in the format of an array of tensors.
 
+    layout: str, optional
+        Data layout. The channel axis is vectorized when it is the innermost one.
+
     Returns
     -------
     sch: Schedule
@@ -132,6 +167,7 @@ def schedule_adaptive_pool(outs):
     outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
     s = te.create_schedule([x.op for x in outs])
     scheduled_ops = []
+    do_vectorize = layout is not None and layout[-1] not in "HWDhwd"
 
     def traverse(OP):
         """Internal traverse function"""
@@ -148,9 +184,11 @@ def schedule_adaptive_pool(outs):
                 output = outs[0]
                 output_fused = s[output].fuse(output.op.axis[0], output.op.axis[1])
                 s[output].parallel(output_fused)
+                if do_vectorize and isinstance(output.shape[-1], tvm.tir.IntImm):
+                    _vectorize_inner(s[output], output.op.axis[-1], output.shape[-1].value)
 
             Pool = OP.output(0)
-            _parallel_sch(s[Pool], outs[0].shape)
+            _adaptive_pool_sch(s[Pool], outs[0].shape, do_vectorize)
         else:
             raise RuntimeError("Unsupported operator: %s" % OP.tag)
 
@@ -22,6 +22,19 @@ from .injective import schedule_injective_from_existing
 from .. import tag
 from ..util import get_const_tuple
 
+# Reductions with fewer outputs than this are split across threads with rfactor,
+# provided that every thread gets at least _RFACTOR_MIN_PART_SIZE elements to reduce.
+_RFACTOR_MAX_OUTPUT_SIZE = 16
+_RFACTOR_NPARTS = 64
+_RFACTOR_MIN_PART_SIZE = 256
+
+def _schedule_reduce_rfactor(sch, out):
+    """Reduce in parallel partial sums over slices of the reduction axes, then combine them."""
+    fused_k = sch[out].fuse(*sch[out].op.reduce_axis)
+    ko, _ = sch[out].split(fused_k, nparts=_RFACTOR_NPARTS)
+    partial = sch.rfactor(out, ko)
+    sch[partial].parallel(sch[partial].op.axis[0])
+
 def _schedule_reduce(sch, op, is_idx_reduce=False):
     if is_idx_reduce:
         real_out = op.output(0)
@@ -37,6 +50,20 @@ def _schedule_reduce(sch, op, is_idx_reduce=False):
             const_shape = False
             break
 
+    if const_shape and not is_idx_reduce:
+        out_size = 1
+        for d in out_shape:
+            out_size *= d
+        reduce_extents = get_const_tuple([k.dom.extent for k in out.op.reduce_axis])
+        reduce_size = 1
+        for d in reduce_extents:
+            reduce_size = reduce_size * d if isinstance(d, int) else 0
+        # Too few outputs to keep the cores busy: split the reduction itself
+        if out_size < _RFACTOR_MAX_OUTPUT_SIZE and \
+                reduce_size >= _RFACTOR_NPARTS * _RFACTOR_MIN_PART_SIZE:
+            _schedule_reduce_rfactor(sch, out)
+            return
+
     if const_shape:
         naxes = len(sch[out].op.axis)
         parallelism = 1
@@ -0,0 +1,46 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Scan schedules for x86"""
+from tvm import te
+
+
+def schedule_blocked_scan(outs):
+    """x86 schedule for topi.blocked_scan, which runs the blocks on parallel threads.
+
+    Parameters
+    ----------
+    outs: Array of Tensor
+          The computation graph description of blocked_scan in the format
+          of an array of tensors.
+
+    Returns
+    -------
+    sch: Schedule
+        The computation schedule for the op.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    s = te.create_schedule([x.op for x in outs])
+    for out in outs:
+        if not isinstance(out.op, te.ComputeOp):
+            # A single block is a sequential te.scan
+            continue
+        s[out].parallel(out.op.axis[0])
+        for tensor in out.op.input_tensors:
+            if isinstance(tensor.op, te.ScanOp) and tensor.op.name.endswith(".local"):
+                for stage in (tensor.op.init[0], tensor.op.update[0]):
+                    s[stage].parallel(stage.op.axis[1])
+    return s
@@ -19,18 +19,16 @@
 import tvm
 from tvm import te
 import tvm.target.codegen
+from .util import target_has_avx512, target_has_vnni
 
 
 def dot_16x1x16_uint8_int8_int32():
     """Dispatch the most optimized intrin depending on the target"""
-    mcpu = tvm.target.Target.current().mcpu
-
-    assert mcpu in ("skylake-avx512", "cascadelake"), \
+    if target_has_vnni():
+        return dot_16x1x16_uint8_int8_int32_cascadelake()
+    assert target_has_avx512(), \
         "An old Intel machine that does not have fast Int8 support."
-    if mcpu == "skylake-avx512":
-        return dot_16x1x16_uint8_int8_int32_skylake()
-    # cascadelake
-    return dot_16x1x16_uint8_int8_int32_cascadelake()
+    return dot_16x1x16_uint8_int8_int32_skylake()
 
 
 def dot_16x1x16_uint8_int8_int32_skylake():
@@ -300,3 +298,80 @@ def dot_16x1x16_uint8_int8_int32_cascadelake():
     return te.decl_tensor_intrin(
         C.op, _intrin_func, binds={data:a_buffer, kernel:b_buffer},
         default_buffer_params=buffer_params)
+
+
+def dot_16x1x16_bf16_bf16_fp32():
+    """
+    BF16 dot product by every 2 elements using the AVX512 BF16 instruction vdpbf16ps
+    of Cooper Lake and Sapphire Rapids. This function takes two arrays of bfloat16
+    -- data[2] and kernel[16][2] -- and computes a dot product of data[2] with every
+    2 elements of kernels, resulting in output[16] of float32 datatype.
+    The pseudo code is as follows.
+    .. code-block:: c
+        void dot_16x1x16_bf16_bf16_fp32(bf16 data[2], bf16 kernel[16][2],
+                float output[16]){
+            for (int i = 0; i < 16; i++){
+                output[i] = 0;
+                for (int k = 0; k < 2; k++){
+                    output[i] += data[k] * kernel[i][k]
+                }
+            }
+        }
+
+    The pair of data is broadcasted to an AVX512 vector register, and the
+    instruction accumulates into the output register directly.
+
+    Returns
+    -------
+    intrin : TensorIntrin
+        The BF16 TensorIntrin that can be used in tensorizing schedule
+    """
+    fp32_lanes = 16 # 16 float32 lanes in AVX512
+    num_bf16_elements = 2 # 2 bfloat16 elements in a 32-bit lane
+    data = te.placeholder((num_bf16_elements,), dtype='bfloat16', name='data')
+    kernel = te.placeholder((fp32_lanes, num_bf16_elements), dtype='bfloat16', name='kernel')
+    k = te.reduce_axis((0, num_bf16_elements), name='k')
+    C = te.compute((fp32_lanes,),
+                   lambda i: te.sum(data[k].astype('float32') *
+                                    kernel[i, k].astype('float32'),
+                                    axis=k),
+                   name="C")
+
+    a_buffer = tvm.tir.decl_buffer(data.shape, dtype='bfloat16', name="a_buffer",
+                                   offset_factor=1,
+                                   strides=[1])
+    b_buffer = tvm.tir.decl_buffer(kernel.shape, dtype='bfloat16', name="b_buffer",
+                                   offset_factor=1,
+                                   strides=[te.var('ldw'), 1])
+
+    def _intrin_func(ins, outs):
+        def _instr(index):
+            ib = tvm.tir.ir_builder.create()
+            if index == 1:
+                ib.emit(outs[0].vstore(0, tvm.tir.const(0, 'float32x16')))
+                return ib.get()
+
+            a_bf16 = ins[0].vload([0], "bfloat16x2")
+            vec_ai32 = tvm.tir.call_intrin('int32', 'tir.reinterpret', a_bf16).astype('int32x16')
+            vec_b = ins[1].vload([0, 0], "bfloat16x32")
+            vec_bi32 = tvm.tir.call_intrin('int32x16', 'tir.reinterpret', vec_b)
+            if index == 0:
+                acc = tvm.tir.const(0, 'float32x16')
+            else:
+                acc = outs[0].vload([0], 'float32x16')
+            # The pairs of bfloat16 are passed as int32 lanes.
+            dot = tvm.tir.call_llvm_pure_intrin(
+                'float32x16',
+                'llvm.x86.avx512bf16.dpbf16ps.512',
+                tvm.tir.const(0, 'uint32'),
+                acc, vec_ai32, vec_bi32)
+            ib.emit(outs[0].vstore(0, dot))
+            return ib.get()
+
+        # body, reset, update
+        return _instr(0), _instr(1), _instr(2)
+
+    buffer_params = {"offset_factor" : 1}
+    return te.decl_tensor_intrin(
+        C.op, _intrin_func, binds={data:a_buffer, kernel:b_buffer},
+        default_buffer_params=buffer_params)
@@ -18,9 +18,36 @@
 import tvm
 
 
+# The CPUs with each of the AVX512 extensions, the later ones include the former ones.
+_AVX512_CPUS = ('skylake-avx512', 'cascadelake', 'cooperlake', 'icelake-client',
+                'icelake-server', 'tigerlake', 'sapphirerapids')
+_AVX512_VNNI_CPUS = ('cascadelake', 'cooperlake', 'icelake-client', 'icelake-server',
+                     'tigerlake', 'sapphirerapids')
+_AVX512_BF16_CPUS = ('cooperlake', 'sapphirerapids')
+
+
+def _target_has(cpus, feature):
+    target = tvm.target.Target.current(allow_none=False)
+    return target.mcpu in cpus or "+" + feature in target.mattr
+
+
+def target_has_avx512():
+    """Whether the current target has AVX512 (F, CD, BW, DQ and VL)."""
+    return _target_has(_AVX512_CPUS, "avx512bw")
+
+
+def target_has_vnni():
+    """Whether the current target has the AVX512 VNNI int8 dot product."""
+    return _target_has(_AVX512_VNNI_CPUS, "avx512vnni")
+
+
+def target_has_avx512_bf16():
+    """Whether the current target has the AVX512 BF16 dot product."""
+    return _target_has(_AVX512_BF16_CPUS, "avx512bf16")
+
+
 def get_fp32_len():
-    mcpu = tvm.target.Target.current().mcpu
     fp32_vec_len = 8
-    if mcpu in ('skylake-avx512', 'cascadelake'):
+    if target_has_avx512():
         fp32_vec_len = 16
     return fp32_vec_len
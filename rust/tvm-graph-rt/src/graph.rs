@@ -21,6 +21,9 @@ use std::{
     cmp, collections::HashMap, convert::TryFrom, error::Error, iter::FromIterator, mem, str,
 };
 
+#[cfg(not(any(target_arch = "wasm32", target_env = "sgx")))]
+use std::{fs::File, io, path::Path};
+
 use itertools::izip;
 use nom::{
     character::complete::{alpha1, digit1},
@@ -41,6 +44,8 @@ use crate::{errors::*, Module, Storage, Tensor};
 const _NDARRAY_MAGIC: u64 = 0xDD5E_40F0_96B4_A13F;
 // @see `kTVMNDArrayListMagic` in `graph_runtime.h`
 const _NDARRAY_LIST_MAGIC: u64 = 0xF7E5_8D4F_0504_9CB7;
+// @see `kAllocAlignment` in `device_api.h`, the alignment the compiled functions assume.
+const STORAGE_ALIGN: usize = 64;
 
 /// A TVM computation graph.
 ///
@@ -152,14 +157,12 @@ impl<'a> TryFrom<&'a str> for Graph {
 ///
 /// let syslib = SystemLibModule::default(); // a provider of TVM functions
 ///
-/// let mut params_bytes = Vec::new();
-/// fs::File::open("graph.params").unwrap().read_to_end(&mut params_bytes).unwrap();
-/// let params = tvm::runtime::load_param_dict(&params_bytes).unwrap();
+/// let param_file = ParamFile::open("graph.params").unwrap();
+/// let params = param_file.params().unwrap();
 ///
 /// let graph = Graph::try_from(&fs::read_to_string("graph.json").unwrap()).unwrap();
 ///
-/// let mut exec = GraphExecutor::new(graph, &syslib).unwrap();
-/// exec.load_params(params);
+/// let mut exec = GraphExecutor::with_params(graph, &syslib, params).unwrap();
 ///
 /// let x = Array::from_vec(vec![1f32, 2., 3., 4.]);
 /// exec.set_input("data", x.into());
@@ -178,12 +181,27 @@ unsafe impl<'m, 't> Send for GraphExecutor<'m, 't> {}
 
 impl<'m, 't> GraphExecutor<'m, 't> {
     pub fn new<M: 'm + Module>(graph: Graph, lib: &'m M) -> Result<Self, Box<dyn Error>> {
-        let tensors = Self::setup_storages(&graph)?;
-        Ok(GraphExecutor {
+        Self::with_params(graph, lib, HashMap::new())
+    }
+
+    /// Creates an executor with its params loaded.
+    ///
+    /// The params which are aligned and do not share their storage with other entries are used
+    /// in place rather than copied, e.g. those of a `ParamFile`, which then must outlive the
+    /// executor.
+    pub fn with_params<M: 'm + Module>(
+        graph: Graph,
+        lib: &'m M,
+        mut params: HashMap<String, Tensor<'t>>,
+    ) -> Result<Self, Box<dyn Error>> {
+        let tensors = Self::setup_storages(&graph, &mut params)?;
+        let mut exec = GraphExecutor {
             op_execs: Self::setup_op_execs(&graph, lib, &tensors)?,
             tensors,
             graph,
-        })
+        };
+        exec.load_params(params);
+        Ok(exec)
     }
 
     /// Runs the computation graph.
@@ -194,7 +212,16 @@ impl<'m, 't> GraphExecutor<'m, 't> {
     }
 
     /// Allocates `Storages` for each `storage_id` and returns `Tensor`s to hold each output.
-    fn setup_storages<'a>(graph: &'a Graph) -> Result<Vec<Tensor<'t>>, Box<dyn Error>> {
+    /// The entries sharing a `storage_id` are views of the same `Storage`. The params which
+    /// can be used in place are taken from `params` and get no `Storage`.
+    fn setup_storages<'a>(
+        graph: &'a Graph,
+        params: &mut HashMap<String, Tensor<'t>>,
+    ) -> Result<Vec<Tensor<'t>>, Box<dyn Error>> {
+        let node_row_ptr = graph
+            .node_row_ptr
+            .as_ref()
+            .ok_or(GraphFormatError::MissingField("node_row_ptr"))?;
         let storage_ids = graph.get_attr::<(String, Vec<usize>)>("storage_id")?.1;
         let shapes = graph.get_attr::<(String, Vec<Vec<i64>>)>("shape")?.1;
         let dtypes = graph
@@ -210,24 +237,61 @@ impl<'m, 't> GraphExecutor<'m, 't> {
             })
             .collect::<Result<Vec<DataType>, GraphFormatError>>()?;
 
-        let align = dtypes.iter().map(|dtype| dtype.bits() as usize).max();
-        let mut storage_num_bytes = vec![0usize; *storage_ids.iter().max().unwrap_or(&1) + 1];
+        let num_storages = *storage_ids.iter().max().unwrap_or(&1) + 1;
+
+        let mut storage_num_entries = vec![0usize; num_storages];
+        for &storage_id in storage_ids.iter() {
+            storage_num_entries[storage_id] += 1;
+        }
+        // The compiled functions assume aligned data, the other params are copied.
+        let mut bound_params: HashMap<usize, Tensor<'t>> = HashMap::new();
+        for &nid in graph.arg_nodes.iter() {
+            let idx = node_row_ptr[nid];
+            let name = &graph.nodes[nid].name;
+            let in_place = params.get(name).map_or(false, |param| {
+                storage_num_entries[storage_ids[idx]] == 1
+                    && param.dtype == dtypes[idx]
+                    && param.shape == shapes[idx]
+                    && param.is_contiguous()
+                    && param.byte_offset == 0
+                    && param.data.as_ptr() as usize % STORAGE_ALIGN == 0
+            });
+            if in_place {
+                bound_params.insert(idx, params.remove(name).unwrap());
+            }
+        }
+
+        let mut storage_num_bytes = vec![None; num_storages];
         for (i, &storage_id) in storage_ids.iter().enumerate() {
+            if bound_params.contains_key(&i) {
+                continue;
+            }
             let dtype_size = (dtypes[i].bits() * dtypes[i].lanes()) >> 3;
             let nbytes = dtype_size * shapes[i].iter().product::<i64>() as usize;
-            storage_num_bytes[storage_id] = cmp::max(nbytes, storage_num_bytes[storage_id]);
+            storage_num_bytes[storage_id] =
+                Some(cmp::max(nbytes, storage_num_bytes[storage_id].unwrap_or(0)));
         }
 
-        let mut storages: Vec<Storage> = storage_num_bytes
+        let mut storages: Vec<Option<Storage<'t>>> = storage_num_bytes
             .into_iter()
-            .map(|nbytes| Storage::new(nbytes, align))
-            .collect::<Result<Vec<Storage>, std::alloc::LayoutErr>>()?;
+            .map(|nbytes| {
+                nbytes
+                    .map(|nbytes| Storage::new(nbytes, Some(STORAGE_ALIGN)))
+                    .transpose()
+            })
+            .collect::<Result<Vec<Option<Storage>>, std::alloc::LayoutErr>>()?;
 
         let tensors = izip!(storage_ids, shapes, dtypes)
-            .map(|(storage_id, shape, dtype)| {
-                let storage = storages[storage_id].view();
+            .enumerate()
+            .map(|(i, (storage_id, shape, dtype))| {
+                if let Some(param) = bound_params.remove(&i) {
+                    return param;
+                }
+                // The first entry of a storage owns it, the others are views.
+                let owner = storages[storage_id].as_mut().unwrap();
+                let storage = owner.view();
                 Tensor {
-                    data: mem::replace(&mut storages[storage_id], storage),
+                    data: mem::replace(owner, storage),
                     ctx: Context::default(),
                     dtype,
                     size: shape.iter().product::<i64>() as usize,
@@ -471,7 +535,7 @@ named! {
     )
 }
 
-/// Loads a param dict saved using `relay.save_param_dict`.
+/// Loads a param dict saved using `relay.save_param_dict`. The tensors are views of `bytes`.
 pub fn load_param_dict(bytes: &[u8]) -> Result<HashMap<String, Tensor>, GraphFormatError> {
     if let Ok((remaining_bytes, param_dict)) = parse_param_dict(bytes) {
         if remaining_bytes.is_empty() {
@@ -484,6 +548,35 @@ pub fn load_param_dict(bytes: &[u8]) -> Result<HashMap<String, Tensor>, GraphFor
     }
 }
 
+/// A params file saved using `relay.save_param_dict`, mapped into memory rather than read.
+///
+/// The mapping is private, writes to the tensors are not carried to the file.
+///
+/// # Examples
+///
+/// ```norun
+/// let param_file = ParamFile::open("graph.params").unwrap();
+/// let exec = GraphExecutor::with_params(graph, &syslib, param_file.params().unwrap()).unwrap();
+/// ```
+#[cfg(not(any(target_arch = "wasm32", target_env = "sgx")))]
+pub struct ParamFile {
+    mmap: memmap2::MmapMut,
+}
+
+#[cfg(not(any(target_arch = "wasm32", target_env = "sgx")))]
+impl ParamFile {
+    pub fn open<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        let file = File::open(path)?;
+        let mmap = unsafe { memmap2::MmapOptions::new().map_copy(&file)? };
+        Ok(ParamFile { mmap })
+    }
+
+    /// Returns the params, which are views of the mapped file.
+    pub fn params(&self) -> Result<HashMap<String, Tensor>, GraphFormatError> {
+        load_param_dict(&self.mmap)
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
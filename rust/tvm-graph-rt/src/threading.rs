@@ -18,151 +18,159 @@
  */
 
 use std::{
+    cell::Cell,
     os::raw::{c_int, c_void},
     sync::{
-        atomic::{AtomicUsize, Ordering},
-        Arc, Barrier,
+        atomic::{AtomicBool, AtomicUsize, Ordering},
+        Arc, Barrier, Mutex,
     },
-    thread::{self, JoinHandle},
+    thread,
 };
 
 #[cfg(not(target_arch = "wasm32"))]
 use std::env;
 
-use crossbeam_channel::{bounded, Receiver, Sender};
+use crossbeam_channel::{unbounded, Receiver, Sender};
+use lazy_static::lazy_static;
 use tvm_sys::ffi::TVMParallelGroupEnv;
 
 pub(crate) type FTVMParallelLambda =
     extern "C" fn(task_id: usize, penv: *const TVMParallelGroupEnv, cdata: *const c_void) -> i32;
 
-/// Holds a parallel job request made by a TVM library function.
+/// Number of times a launcher polls the pending tasks before yielding its thread.
+const SPIN_COUNT: usize = 1 << 10;
+
+/// A parallel job request made by a TVM library function, split into `num_tasks` tasks.
+///
+/// The threads taking part in the job claim its tasks from a shared counter, so the idle
+/// threads steal the tasks not yet started rather than waiting on a preassigned one.
 struct Job {
     cb: FTVMParallelLambda,
     cdata: *const c_void,
-    req_num_tasks: usize,
-    pending: Arc<AtomicUsize>,
+    num_tasks: usize,
+    next_task: AtomicUsize,
+    pending: AtomicUsize,
+    failed: AtomicBool,
+    /// The barrier of `TVMBackendParallelBarrier`, the `sync_handle` of the tasks.
+    barrier: Barrier,
 }
+unsafe impl Send for Job {}
+unsafe impl Sync for Job {}
 
-impl Job {
-    /// Splits this job into a number of `Task`s which can be scheduled.
-    fn tasks(&self, num_workers: usize) -> Vec<Task> {
-        let num_tasks = if self.req_num_tasks == 0 {
-            num_workers
-        } else {
-            self.req_num_tasks.min(num_workers)
-        };
-        self.pending.store(num_tasks, Ordering::SeqCst);
-
-        let barrier = Arc::new(Barrier::new(num_tasks));
-
-        (0..num_tasks)
-            .map(move |i| Task {
-                id: i,
-                flambda: self.cb,
-                penv: TVMParallelGroupEnv {
-                    sync_handle: &Arc::clone(&barrier) as *const _ as *mut c_void,
-                    num_task: num_tasks as i32,
-                },
-                cdata: self.cdata,
-                pending: Arc::clone(&self.pending),
-            })
-            .collect()
-    }
+thread_local!(static IN_PARALLEL_TASK: Cell<bool> = Cell::new(false));
 
-    /// Waits for all tasks in this `Job` to be completed.
-    fn wait(&self) {
-        while self.pending.load(Ordering::Acquire) > 0 {
-            thread::yield_now();
+impl Job {
+    fn new(cb: FTVMParallelLambda, cdata: *const c_void, num_tasks: usize) -> Self {
+        Job {
+            cb,
+            cdata,
+            num_tasks,
+            next_task: AtomicUsize::new(0),
+            pending: AtomicUsize::new(num_tasks),
+            failed: AtomicBool::new(false),
+            barrier: Barrier::new(num_tasks),
         }
     }
-}
-
-/// A chunk of work requested by a TVM function.
-struct Task {
-    id: usize,
-    flambda: FTVMParallelLambda,
-    penv: TVMParallelGroupEnv,
-    cdata: *const c_void,
-    pending: Arc<AtomicUsize>,
-}
-unsafe impl Send for Task {}
-unsafe impl Sync for Task {}
 
-impl Task {
-    fn run(self) -> i32 {
-        let status = (self.flambda)(self.id, &self.penv as *const _, self.cdata);
-        self.pending.fetch_sub(1, Ordering::AcqRel);
-        status
+    /// Runs the tasks of this `Job` until none is left to claim.
+    fn run_tasks(&self) {
+        let penv = TVMParallelGroupEnv {
+            sync_handle: &self.barrier as *const Barrier as *mut c_void,
+            num_task: self.num_tasks as i32,
+        };
+        IN_PARALLEL_TASK.with(|in_task| in_task.set(true));
+        loop {
+            let task_id = self.next_task.fetch_add(1, Ordering::Relaxed);
+            if task_id >= self.num_tasks {
+                break;
+            }
+            if (self.cb)(task_id, &penv as *const _, self.cdata) != 0 {
+                self.failed.store(true, Ordering::Relaxed);
+            }
+            self.pending.fetch_sub(1, Ordering::Release);
+        }
+        IN_PARALLEL_TASK.with(|in_task| in_task.set(false));
     }
-}
-
-#[derive(Default)]
-struct Threads {
-    #[allow(unused)]
-    handles: Vec<JoinHandle<()>>,
-    queues: Vec<Sender<Task>>,
-}
 
-impl<'a> Threads {
-    fn launch<F: Sync + Send + FnOnce(Receiver<Task>) + 'static + Copy>(
-        num_threads: usize,
-        cb: F,
-    ) -> Self {
-        let (handles, queues) = (0..num_threads)
-            .map(|_| {
-                let (p, c) = bounded(2);
-                let handle = thread::spawn(move || cb(c.into()));
-                (handle, p)
-            })
-            .unzip();
-        Threads { handles, queues }
+    /// Waits for all tasks in this `Job` to be completed, returns whether they all succeeded.
+    fn wait(&self) -> bool {
+        let mut spins = 0;
+        while self.pending.load(Ordering::Acquire) > 0 {
+            if spins < SPIN_COUNT {
+                spins += 1;
+                std::sync::atomic::spin_loop_hint();
+            } else {
+                thread::yield_now();
+            }
+        }
+        !self.failed.load(Ordering::Relaxed)
     }
 }
 
+/// The process wide pool of workers, which run the parallel jobs with the launching thread.
 struct ThreadPool {
     num_workers: usize,
-    #[allow(unused)]
-    threads: Threads,
+    queues: Vec<Sender<Arc<Job>>>,
+    /// Held for the duration of a job. The tasks of a job may wait on each other at its
+    /// barrier, so the workers serve one job at a time.
+    launch: Mutex<()>,
 }
 
-thread_local!(static THREAD_POOL: ThreadPool = ThreadPool::new());
+lazy_static! {
+    static ref THREAD_POOL: ThreadPool = ThreadPool::new();
+}
 
 impl ThreadPool {
     fn new() -> Self {
-        let num_workers = max_concurrency();
+        let num_workers = max_concurrency().saturating_sub(1);
+        let queues = (0..num_workers)
+            .map(|_| {
+                let (sender, receiver) = unbounded();
+                thread::spawn(move || ThreadPool::run_worker(receiver));
+                sender
+            })
+            .collect();
         ThreadPool {
             num_workers,
-            threads: Threads::launch(num_workers, ThreadPool::run_worker),
+            queues,
+            launch: Mutex::new(()),
         }
     }
 
-    fn launch(&self, job: Job) {
-        let mut tasks = job.tasks(self.num_workers + 1);
-
-        for (i, task) in tasks.split_off(1).into_iter().enumerate() {
-            self.threads.queues[i].send(task).expect("should send");
+    fn launch(&self, cb: FTVMParallelLambda, cdata: *const c_void, req_num_tasks: usize) -> bool {
+        // A job launched while the pool is busy, e.g. from another executor, runs serially.
+        let _guard = match self.launch.try_lock() {
+            Ok(guard) => guard,
+            Err(_) => return run_serial(cb, cdata),
+        };
+        let max_tasks = self.num_workers + 1;
+        let num_tasks = if req_num_tasks == 0 {
+            max_tasks
+        } else {
+            req_num_tasks.min(max_tasks)
+        };
+        let job = Arc::new(Job::new(cb, cdata, num_tasks));
+        for queue in self.queues.iter().take(num_tasks - 1) {
+            queue.send(Arc::clone(&job)).expect("should send");
         }
-
-        tasks.pop().unwrap().run();
-        job.wait();
+        job.run_tasks();
+        job.wait()
     }
 
-    fn run_worker(queue: Receiver<Task>) {
-        loop {
-            let task = match queue.recv() {
-                Ok(v) => v,
-                Err(_) => break,
-            };
-            let result = task.run();
-            if result == <i32>::min_value() {
-                break;
-            } else if result != 0 {
-                panic!("Error running task.");
-            }
+    fn run_worker(queue: Receiver<Arc<Job>>) {
+        for job in queue.iter() {
+            job.run_tasks();
         }
     }
 }
 
+/// Runs a parallel job as a single task on the calling thread.
+fn run_serial(cb: FTVMParallelLambda, cdata: *const c_void) -> bool {
+    let job = Job::new(cb, cdata, 1);
+    job.run_tasks();
+    job.wait()
+}
+
 #[cfg(not(target_arch = "wasm32"))]
 fn max_concurrency() -> usize {
     if let Ok(threads_str) = env::var("TVM_NUM_THREADS").or_else(|_| env::var("OMP_NUM_THREADS")) {
@@ -184,23 +192,17 @@ pub extern "C" fn TVMBackendParallelLaunch(
     cdata: *const c_void,
     num_task: usize,
 ) -> c_int {
-    if max_concurrency() < 2 {
-        let penv = TVMParallelGroupEnv {
-            sync_handle: std::ptr::null_mut(),
-            num_task: 1,
-        };
-        cb(0, &penv as *const _, cdata);
+    let nested = IN_PARALLEL_TASK.with(|in_task| in_task.get());
+    let succeeded = if nested || max_concurrency() < 2 {
+        run_serial(cb, cdata)
     } else {
-        THREAD_POOL.with(|pool| {
-            pool.launch(Job {
-                cb,
-                cdata,
-                req_num_tasks: num_task,
-                pending: Arc::new(AtomicUsize::new(0)),
-            });
-        });
+        THREAD_POOL.launch(cb, cdata, num_task)
+    };
+    if succeeded {
+        0
+    } else {
+        -1
     }
-    0
 }
 
 // @see issue 988 for information on why this function is used.
@@ -208,15 +210,14 @@ pub extern "C" fn TVMBackendParallelLaunch(
 pub unsafe extern "C" fn TVMBackendParallelBarrier(
     _task_id: usize,
     penv: *const TVMParallelGroupEnv,
-) {
-    let barrier: &Arc<Barrier> = &*((*penv).sync_handle as *const Arc<Barrier>);
+) -> c_int {
+    let barrier: &Barrier = &*((*penv).sync_handle as *const Barrier);
     barrier.wait();
+    0
 }
 
 #[cfg(test)]
 mod tests {
-    use std::{ptr, thread, time::Duration};
-
     use super::*;
 
     #[test]
@@ -233,31 +234,30 @@ mod tests {
         penv: *const TVMParallelGroupEnv,
         cdata: *const c_void,
     ) -> i32 {
-        if cdata.is_null() {
-            return 0;
-        }
         unsafe {
-            let &(ref counter, ref task_ids_sum) = &*(cdata as *const (AtomicUsize, AtomicUsize));
-            thread::sleep(Duration::from_millis(50 * task_id as u64));
+            let &(ref counter, ref task_ids_sum, ref num_task) =
+                &*(cdata as *const (AtomicUsize, AtomicUsize, AtomicUsize));
             counter.fetch_add(1, Ordering::SeqCst);
             task_ids_sum.fetch_add(task_id, Ordering::SeqCst);
-            assert_eq!((*penv).num_task, 3);
+            num_task.store((*penv).num_task as usize, Ordering::SeqCst);
+            TVMBackendParallelBarrier(task_id, penv);
         }
         0
     }
 
-    // #[test]
-    // fn test_parallel_launch() {
-    //     TVMBackendParallelLaunch(flambda, ptr::null(), 6);
-    //     let counter = AtomicUsize::new(0);
-    //     let task_ids_sum = AtomicUsize::new(0);
-    //     let cdata = (counter, task_ids_sum);
-    //     let num_tasks = 3;
-    //     TVMBackendParallelLaunch(flambda, &cdata as *const _ as *const c_void, num_tasks);
-    //     assert_eq!(cdata.0.load(Ordering::SeqCst), num_tasks);
-    //     assert_eq!(
-    //         cdata.1.load(Ordering::SeqCst),
-    //         (0..num_tasks).sum::<usize>()
-    //     );
-    // }
+    #[test]
+    fn test_parallel_launch() {
+        for _ in 0..10 {
+            let cdata = (AtomicUsize::new(0), AtomicUsize::new(0), AtomicUsize::new(0));
+            let status = TVMBackendParallelLaunch(flambda, &cdata as *const _ as *const c_void, 3);
+            assert_eq!(status, 0);
+            let num_tasks = cdata.2.load(Ordering::SeqCst);
+            assert!(num_tasks >= 1 && num_tasks <= 3);
+            assert_eq!(cdata.0.load(Ordering::SeqCst), num_tasks);
+            assert_eq!(
+                cdata.1.load(Ordering::SeqCst),
+                (0..num_tasks).sum::<usize>()
+            );
+        }
+    }
 }
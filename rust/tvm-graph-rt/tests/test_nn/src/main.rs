@@ -17,10 +17,10 @@
  * under the License.
  */
 
-use std::{collections::HashMap, convert::TryFrom, fs, io::Read};
+use std::{convert::TryFrom, fs};
 
 use ndarray::{s, Array};
-use tvm_graph_rt::{Graph, GraphExecutor, SystemLibModule, Tensor};
+use tvm_graph_rt::{Graph, GraphExecutor, ParamFile, SystemLibModule};
 
 const BATCH_SIZE: usize = 4;
 const IN_DIM: usize = 8;
@@ -44,22 +44,13 @@ macro_rules! check_sum {
 fn main() {
     let syslib = SystemLibModule::default();
 
-    let mut params_bytes = Vec::new();
-    fs::File::open(concat!(env!("OUT_DIR"), "/test_nn/graph.params"))
-        .unwrap()
-        .read_to_end(&mut params_bytes)
-        .unwrap();
-    let params = tvm_graph_rt::load_param_dict(&params_bytes)
-        .unwrap()
-        .into_iter()
-        .map(|(k, v)| (k, v.to_owned()))
-        .collect::<HashMap<String, Tensor<'static>>>();
+    let param_file = ParamFile::open(concat!(env!("OUT_DIR"), "/test_nn/graph.params")).unwrap();
+    let params = param_file.params().unwrap();
 
     let graph = Graph::try_from(
         &fs::read_to_string(concat!(env!("OUT_DIR"), "/test_nn/graph.json")).unwrap(),
     )
     .unwrap();
-    let mut exec = GraphExecutor::new(graph, &syslib).unwrap();
 
     let x = Array::from_shape_vec(
         (BATCH_SIZE, IN_DIM),
@@ -84,7 +75,7 @@ fn main() {
     let expected_o0 = &left + 1f32;
     let expected_o1 = &right - 1f32;
 
-    exec.load_params(params);
+    let mut exec = GraphExecutor::with_params(graph, &syslib, params).unwrap();
     exec.set_input("data", (&x).into());
 
     check_sum!(exec, data, x);
@@ -35,6 +35,37 @@ Analyzer::Analyzer()
       canonical_simplify(this),
       int_set(this) {}
 
+void Analyzer::EnableMemo(bool enable) {
+  if (!enable) {
+    memo_.clear();
+  } else if (memo_.empty()) {
+    memo_.emplace_back();
+  }
+}
+
+Analyzer::MemoScope* Analyzer::GetMemo(const PrimExpr& expr) {
+  // Leaves are cheaper to analyze than to hash.
+  if (memo_.empty() || expr.as<tir::VarNode>() || expr.as<IntImmNode>() ||
+      expr.as<FloatImmNode>()) {
+    return nullptr;
+  }
+  // Bound the memory of a long running analyzer.
+  constexpr size_t kMaxMemoSize = 1 << 16;
+  MemoScope* memo = &memo_.back();
+  if (memo->const_int_bound.size() + memo->modular_set.size() + memo->rewrite_simplify.size() +
+          memo->canonical_simplify.size() >
+      kMaxMemoSize) {
+    *memo = MemoScope();
+  }
+  return memo;
+}
+
+void Analyzer::ClearMemo() {
+  for (MemoScope& memo : memo_) {
+    memo = MemoScope();
+  }
+}
+
 void Analyzer::Bind(const Var& var, const PrimExpr& expr, bool allow_override) {
   PrimExpr new_expr = expr;
   new_expr = this->canonical_simplify(new_expr);
@@ -69,8 +100,19 @@ void ConstraintContext::EnterWithScope() {
   auto f0 = analyzer_->const_int_bound.EnterConstraint(constraint_);
   auto f1 = analyzer_->modular_set.EnterConstraint(constraint_);
   auto f2 = analyzer_->rewrite_simplify.EnterConstraint(constraint_);
+  // The results under the constraint are memoized in a scope of their own.
+  size_t depth = analyzer_->memo_.size();
+  if (depth != 0) {
+    analyzer_->memo_.emplace_back();
+  }
+  Analyzer* analyzer = analyzer_;
   // recovery function.
-  exit_ = [f0, f1, f2]() {
+  exit_ = [f0, f1, f2, depth, analyzer]() {
+    if (depth != 0 && analyzer->memo_.size() > depth) {
+      analyzer->memo_.resize(depth);
+    } else {
+      analyzer->ClearMemo();
+    }
     if (f2 != nullptr) f2();
     if (f1 != nullptr) f1();
     if (f0 != nullptr) f0();
@@ -169,6 +211,8 @@ TVM_REGISTER_GLOBAL("arith.CreateAnalyzer").set_body([](TVMArgs args, TVMRetValu
           self->Bind(args[0], args[1].operator PrimExpr());
         }
       });
+    } else if (name == "enable_memo") {
+      return PackedFunc([self](TVMArgs args, TVMRetValue* ret) { self->EnableMemo(args[0]); });
     } else if (name == "enter_constraint_context") {
       return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
         // can't use make_shared due to noexcept(false) decl in destructor,
@@ -25,6 +25,10 @@
 #include <tvm/tir/analysis.h>
 #include <tvm/tir/op.h>
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "const_fold.h"
 #include "pattern_match.h"
 #include "rewrite_simplify.h"
@@ -235,30 +239,43 @@ class SumExprNode : public CanonicalExprNode {
     for (; start < args.size(); ++start) {
       if (args[start]->IndexEqual(other)) break;
     }
-    for (size_t j = start; j < args.size(); ++j) {
+    AddToSegment(std::move(other), scale, start);
+  }
+
+  void AddToSelf(const SumExpr& other, int64_t scale);
+
+  static constexpr const char* _type_key = "arith.SumExpr";
+  TVM_DECLARE_FINAL_OBJECT_INFO(SumExprNode, CanonicalExprNode);
+
+ private:
+  /*!
+   * \brief self += other * scale, where other goes to the segment starting at pos.
+   * \param other The expression to be added.
+   * \param scale The additional scale on value.
+   * \param pos The position to start the search from, either the first entry of
+   *        the segment of other, a later entry of it whose lower_factor is not
+   *        smaller than the one of other, or args.size() if there is no such segment.
+   * \return The position of the entry other was added to.
+   */
+  size_t AddToSegment(SplitExpr other, int64_t scale, size_t pos) {
+    for (size_t j = pos; j < args.size(); ++j) {
       if (!args[j]->IndexEqual(other) || other->lower_factor > args[j]->lower_factor) {
         other.CopyOnWrite()->scale *= scale;
         this->args.insert(this->args.begin() + j, other);
-        return;
+        return j;
       }
       if (other->lower_factor == args[j]->lower_factor &&
           other->upper_factor == args[j]->upper_factor &&
           other->DivModeCompatibleTo(args[j]->div_mode)) {
         args[j].CopyOnWrite()->scale += other->scale * scale;
-        return;
+        return j;
       }
     }
     // Insert other in the end.
     other.CopyOnWrite()->scale *= scale;
     this->args.emplace_back(std::move(other));
+    return args.size() - 1;
   }
-
-  void AddToSelf(const SumExpr& other, int64_t scale);
-
-  static constexpr const char* _type_key = "arith.SumExpr";
-  TVM_DECLARE_FINAL_OBJECT_INFO(SumExprNode, CanonicalExprNode);
-
- private:
   /*!
    * \brief Simplify the args by merging SplitExprs
    * \param args The original list of arguments.
@@ -391,10 +408,27 @@ class SumExpr : public PrimExpr {
 };
 
 void SumExprNode::AddToSelf(const SumExpr& other, int64_t scale) {
-  // NOTE: it is rare to have a balanced long expression,
-  // linear scan is fine for our case.
-  for (size_t i = 0; i < other->args.size(); ++i) {
-    this->AddToSelf(other->args[i], scale);
+  // The segments of other are sorted the same way as the ones of self,
+  // so each segment is looked up once and its entries are merged in a
+  // single forward pass instead of searching self again for every entry.
+  size_t i = 0;
+  while (i < other->args.size()) {
+    const SplitExpr& head = other->args[i];
+    size_t start = 0;
+    for (; start < args.size(); ++start) {
+      if (args[start]->IndexEqual(head)) break;
+    }
+    size_t pos = start;
+    for (; i < other->args.size() && other->args[i]->IndexEqual(head); ++i) {
+      const SplitExpr& arg = other->args[i];
+      if (arg->scale == 0) continue;
+      // step back over the entries with the same lower_factor that
+      // the previous entry did not merge with.
+      while (pos > start && args[pos - 1]->lower_factor <= arg->lower_factor) {
+        --pos;
+      }
+      pos = this->AddToSegment(arg, scale, pos);
+    }
   }
   this->AddToSelf(other->base * scale);
 }
@@ -408,7 +442,10 @@ class CanonicalSimplifier::Impl : public RewriteSimplifier::Impl {
   explicit Impl(Analyzer* parent) : Rewriter(parent) {}
 
   PrimExpr CanonicalSimplify(PrimExpr expr) {
+    ++depth_;
     expr = operator()(expr);
+    // the normal forms only live for the duration of a top level call.
+    if (--depth_ == 0) normal_forms_.clear();
     return expr;
   }
 
@@ -459,16 +496,64 @@ class CanonicalSimplifier::Impl : public RewriteSimplifier::Impl {
                               SumExpr* out_non_divisible);
   /*!
    * \brief Normalize expr to normal expr.
+   *
+   *  The normal forms are hash-consed: a canonical expression with the same
+   *  terms as one normalized before returns the same object. The indices built
+   *  from them are then equal by address, which keeps IndexEqual from deep
+   *  comparing the same large index again at every level of nested splits.
+   *
    * \param expr The input expression.
    * \return Normalized expr.
    */
   PrimExpr Normalize(PrimExpr expr) {
-    if (const auto* op = expr.as<CanonicalExprNode>()) {
-      return op->Normalize();
+    const auto* op = expr.as<CanonicalExprNode>();
+    if (op == nullptr) return expr;
+    std::vector<int64_t> key = TermKey(op);
+    auto it = normal_forms_.find(key);
+    if (it != normal_forms_.end()) return it->second.second;
+    PrimExpr res = op->Normalize();
+    if (normal_forms_.size() >= kMaxNormalForms) normal_forms_.clear();
+    normal_forms_.emplace(std::move(key), std::make_pair(std::move(expr), res));
+    return res;
+  }
+  /*!
+   * \brief Get the hash-consing key of a canonical expression.
+   *
+   *  The indices are compared by address, so the key is shallow. This is
+   *  exact as long as the indices themselves are hash-consed, otherwise
+   *  the same normal form is only computed twice.
+   */
+  static std::vector<int64_t> TermKey(const CanonicalExprNode* op) {
+    std::vector<int64_t> key{op->dtype.code(), op->dtype.bits(), op->dtype.lanes()};
+    auto add_split = [&key](const SplitExprNode* split) {
+      key.push_back(reinterpret_cast<intptr_t>(split->index.get()));
+      key.push_back(split->lower_factor);
+      key.push_back(split->upper_factor);
+      key.push_back(split->scale);
+      key.push_back(split->div_mode);
+    };
+    if (op->IsInstance<SplitExprNode>()) {
+      add_split(static_cast<const SplitExprNode*>(op));
     } else {
-      return expr;
+      CHECK(op->IsInstance<SumExprNode>());
+      const auto* sum = static_cast<const SumExprNode*>(op);
+      key.push_back(sum->base);
+      for (const SplitExpr& arg : sum->args) {
+        add_split(arg.get());
+      }
     }
+    return key;
   }
+  /*! \brief Hash of the keys returned by TermKey. */
+  struct TermKeyHash {
+    size_t operator()(const std::vector<int64_t>& key) const {
+      size_t hash = key.size();
+      for (int64_t value : key) {
+        hash ^= std::hash<int64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      }
+      return hash;
+    }
+  };
   /*!
    * \brief Create a SplitExpr from expr.
    * \param expr The input expr.
@@ -481,9 +566,7 @@ class CanonicalSimplifier::Impl : public RewriteSimplifier::Impl {
     if (const auto* op = expr.as<SumExprNode>()) {
       if (op->base == 0 && op->args.size() == 1) return op->args[0];
     }
-    if (const auto* op = expr.as<CanonicalExprNode>()) {
-      expr = op->Normalize();
-    }
+    expr = Normalize(std::move(expr));
     ObjectPtr<SplitExprNode> n = make_object<SplitExprNode>();
     n->dtype = expr.dtype();
     n->index = std::move(expr);
@@ -533,6 +616,14 @@ class CanonicalSimplifier::Impl : public RewriteSimplifier::Impl {
   }
   // Simplify the combiner used in reduce.
   PrimExpr SimplifyReduceCombiner(const ReduceNode* op);
+  // The maximum number of normal forms kept at a time.
+  static constexpr size_t kMaxNormalForms = 1 << 16;
+  // The nesting depth of CanonicalSimplify calls.
+  int depth_{0};
+  // The hash-consed normal forms, each entry keeps the canonical
+  // expression alive so that the addresses in its key stay valid.
+  std::unordered_map<std::vector<int64_t>, std::pair<PrimExpr, PrimExpr>, TermKeyHash>
+      normal_forms_;
 };
 
 PrimExpr CanonicalSimplifier::Impl::VisitExpr_(const AddNode* op) {
@@ -1064,14 +1155,24 @@ PrimExpr CanonicalSimplifier::Impl::VisitExpr_(const ReduceNode* op) {
 }
 
 PrimExpr CanonicalSimplifier::operator()(const PrimExpr& expr) {
-  return impl_->CanonicalSimplify(expr);
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    auto it = memo->canonical_simplify.find(expr);
+    if (it != memo->canonical_simplify.end()) return it->second;
+  }
+  PrimExpr res = impl_->CanonicalSimplify(expr);
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    memo->canonical_simplify[expr] = res;
+  }
+  return res;
 }
 
 void CanonicalSimplifier::Update(const Var& var, const PrimExpr& info, bool override) {
+  parent_->ClearMemo();
   impl_->Update(var, info, override);
 }
 
-CanonicalSimplifier::CanonicalSimplifier(Analyzer* parent) : impl_(new Impl(parent)) {}
+CanonicalSimplifier::CanonicalSimplifier(Analyzer* parent)
+    : impl_(new Impl(parent)), parent_(parent) {}
 
 CanonicalSimplifier::~CanonicalSimplifier() { delete impl_; }
 
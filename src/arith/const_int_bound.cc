@@ -586,8 +586,16 @@ class ConstIntBoundAnalyzer::Impl
 };
 
 ConstIntBound ConstIntBoundAnalyzer::operator()(const PrimExpr& expr) {
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    auto it = memo->const_int_bound.find(expr);
+    if (it != memo->const_int_bound.end()) return it->second;
+  }
   Entry ret = impl_->VisitExpr(expr);
-  return ConstIntBound(ret.min_value, ret.max_value);
+  ConstIntBound bound(ret.min_value, ret.max_value);
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    memo->const_int_bound[expr] = bound;
+  }
+  return bound;
 }
 
 ConstIntBound ConstIntBoundAnalyzer::operator()(const PrimExpr& expr, BoundMapType* bound) {
@@ -598,10 +606,12 @@ ConstIntBound ConstIntBoundAnalyzer::operator()(const PrimExpr& expr, BoundMapTy
 }
 
 void ConstIntBoundAnalyzer::Update(const Var& var, const ConstIntBound& info, bool allow_override) {
+  parent_->ClearMemo();
   impl_->Update(var, info, allow_override);
 }
 
 void ConstIntBoundAnalyzer::Bind(const Var& var, const Range& range, bool allow_override) {
+  parent_->ClearMemo();
   impl_->Bind(var, range, allow_override);
 }
 
@@ -609,7 +619,8 @@ std::function<void()> ConstIntBoundAnalyzer::EnterConstraint(const PrimExpr& con
   return impl_->EnterConstraint(constraint);
 }
 
-ConstIntBoundAnalyzer::ConstIntBoundAnalyzer(Analyzer* parent) : impl_(new Impl()) {}
+ConstIntBoundAnalyzer::ConstIntBoundAnalyzer(Analyzer* parent)
+    : impl_(new Impl()), parent_(parent) {}
 
 ConstIntBoundAnalyzer::~ConstIntBoundAnalyzer() { delete impl_; }
 
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "interval_set.h"
 #include "pattern_match.h"
@@ -338,12 +339,16 @@ IntervalSet ToIntervalSet(IntSet set) {
 
 using namespace tir;
 
+// The relaxed interval of each variable, indexed by the recursion depth.
+using VarIntervalCache = std::vector<std::unordered_map<const VarNode*, IntervalSet>>;
+
 // Simplified version of int set evaluator that operates on IntervalSet
 // We might use better set analysis in the future to replace the intervalset.
 class IntervalSetEvaluator : public ExprFunctor<IntervalSet(const PrimExpr&)> {
  public:
-  IntervalSetEvaluator(Analyzer* analyzer, const Map<Var, IntSet>& dom_map, bool eval_vec = false)
-      : analyzer_(analyzer), dom_map_(dom_map), eval_vec_(eval_vec) {}
+  IntervalSetEvaluator(Analyzer* analyzer, const Map<Var, IntSet>& dom_map, bool eval_vec = false,
+                       VarIntervalCache* var_cache = nullptr)
+      : analyzer_(analyzer), dom_map_(dom_map), eval_vec_(eval_vec), var_cache_(var_cache) {}
 
   IntervalSet Eval(const PrimExpr& val) { return this->VisitExpr(val); }
   // evaluate and relax the set
@@ -371,7 +376,18 @@ class IntervalSetEvaluator : public ExprFunctor<IntervalSet(const PrimExpr&)> {
       }
       // recursively evaluate mapped result
       // in case the domain contains variables to be relaxed.
-      return Eval(res);
+      if (var_cache_ == nullptr) return Eval(res);
+      // The relaxed domain only depends on the recursion depth it is
+      // evaluated at, so it is cached per depth across the expressions.
+      if (var_cache_->size() <= static_cast<size_t>(recur_depth_)) {
+        var_cache_->resize(recur_depth_ + 1);
+      }
+      auto cit = (*var_cache_)[recur_depth_].find(op);
+      if (cit != (*var_cache_)[recur_depth_].end()) return cit->second;
+      int depth = recur_depth_;
+      IntervalSet relaxed = Eval(res);
+      (*var_cache_)[depth].emplace(op, relaxed);
+      return relaxed;
     } else {
       return IntervalSet::SinglePoint(var);
     }
@@ -469,6 +485,8 @@ class IntervalSetEvaluator : public ExprFunctor<IntervalSet(const PrimExpr&)> {
   Analyzer* analyzer_;
   const Map<Var, IntSet>& dom_map_;
   bool eval_vec_{false};
+  // the relaxed domain of the variables, shared by the evaluations of a RegionEvaluator
+  VarIntervalCache* var_cache_;
 };
 
 class IntSetAnalyzer::Impl {
@@ -694,6 +712,70 @@ IntSet EvalSet(IntSet s, const std::unordered_map<const VarNode*, IntSet>& dom_m
   return IntervalSet(vmin, vmax);
 }
 
+class RegionEvaluator::Impl {
+ public:
+  Impl(Map<Var, IntSet> dom_map, Analyzer* analyzer)
+      : dom_map_(std::move(dom_map)),
+        analyzer_(analyzer != nullptr ? analyzer : &own_analyzer_),
+        evaluator_(analyzer_, dom_map_, false, &var_cache_) {}
+
+  IntSet Eval(const PrimExpr& e) { return evaluator_.Eval(e); }
+
+  IntSet Eval(const Range& r) {
+    // Simplifying first can give tighter bounds if r->min and r->extent share variables
+    PrimExpr sum = r->min + r->extent - 1;
+    return evaluator_.Eval(IntervalSet(r->min, analyzer_->Simplify(sum)));
+  }
+
+  IntSet Eval(const IntSet& s) {
+    const IntervalSetNode* s_int = s.as<IntervalSetNode>();
+    CHECK(s_int != nullptr);
+    PrimExpr vmax =
+        s_int->HasUpperBound() ? evaluator_.Eval(s_int->max_value).max() : s_int->max_value;
+    PrimExpr vmin =
+        s_int->HasLowerBound() ? evaluator_.Eval(s_int->min_value).min() : s_int->min_value;
+    return IntervalSet(vmin, vmax);
+  }
+
+ private:
+  Map<Var, IntSet> dom_map_;
+  Analyzer own_analyzer_;
+  Analyzer* analyzer_;
+  VarIntervalCache var_cache_;
+  IntervalSetEvaluator evaluator_;
+};
+
+RegionEvaluator::RegionEvaluator(const Map<Var, IntSet>& dom_map, Analyzer* analyzer)
+    : impl_(new Impl(dom_map, analyzer)) {}
+
+RegionEvaluator::RegionEvaluator(const std::unordered_map<const VarNode*, IntSet>& dom_map,
+                                 Analyzer* analyzer)
+    : impl_(new Impl(ConvertDomMap(dom_map), analyzer)) {}
+
+RegionEvaluator::~RegionEvaluator() { delete impl_; }
+
+IntSet RegionEvaluator::Eval(const PrimExpr& e) { return impl_->Eval(e); }
+
+IntSet RegionEvaluator::Eval(const Range& r) { return impl_->Eval(r); }
+
+IntSet RegionEvaluator::Eval(const IntSet& s) { return impl_->Eval(s); }
+
+Array<IntSet> RegionEvaluator::Eval(const Array<PrimExpr>& indices) {
+  Array<IntSet> ret;
+  for (const PrimExpr& index : indices) {
+    ret.push_back(impl_->Eval(index));
+  }
+  return ret;
+}
+
+Array<IntSet> RegionEvaluator::Eval(const Array<Range>& region) {
+  Array<IntSet> ret;
+  for (const Range& r : region) {
+    ret.push_back(impl_->Eval(r));
+  }
+  return ret;
+}
+
 class SubExprIntervalSetEvaluator : public IntervalSetEvaluator {
  public:
   explicit SubExprIntervalSetEvaluator(Analyzer* analyzer, const Map<Var, IntSet>& dom_map)
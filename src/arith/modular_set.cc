@@ -324,11 +324,20 @@ class ModularSetAnalyzer::Impl : public ExprFunctor<ModularSetAnalyzer::Entry(co
 };
 
 ModularSet ModularSetAnalyzer::operator()(const PrimExpr& expr) {
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    auto it = memo->modular_set.find(expr);
+    if (it != memo->modular_set.end()) return it->second;
+  }
   Entry ret = impl_->VisitExpr(expr);
-  return ModularSet(ret.coeff, ret.base);
+  ModularSet result(ret.coeff, ret.base);
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    memo->modular_set[expr] = result;
+  }
+  return result;
 }
 
 void ModularSetAnalyzer::Update(const Var& var, const ModularSet& info, bool allow_override) {
+  parent_->ClearMemo();
   impl_->Update(var, info, allow_override);
 }
 
@@ -336,7 +345,8 @@ std::function<void()> ModularSetAnalyzer::EnterConstraint(const PrimExpr& constr
   return impl_->EnterConstraint(constraint);
 }
 
-ModularSetAnalyzer::ModularSetAnalyzer(Analyzer* parent) : impl_(new Impl(parent)) {}
+ModularSetAnalyzer::ModularSetAnalyzer(Analyzer* parent)
+    : impl_(new Impl(parent)), parent_(parent) {}
 
 ModularSetAnalyzer::~ModularSetAnalyzer() { delete impl_; }
 
@@ -1590,18 +1590,26 @@ PrimExpr RewriteSimplifier::Impl::VisitExpr_(const LetNode* op) {
 }
 
 PrimExpr RewriteSimplifier::operator()(const PrimExpr& expr) {
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    auto it = memo->rewrite_simplify.find(expr);
+    if (it != memo->rewrite_simplify.end()) return it->second;
+  }
   // Run simplification in post order
   PrimExpr res = expr;
   int max_iter = 2;
   for (int i = 0; i < max_iter; ++i) {
     PrimExpr new_expr = impl_->operator()(res);
-    if (new_expr.same_as(res)) return res;
+    if (new_expr.same_as(res)) break;
     res = new_expr;
   }
+  if (Analyzer::MemoScope* memo = parent_->GetMemo(expr)) {
+    memo->rewrite_simplify[expr] = res;
+  }
   return res;
 }
 
 void RewriteSimplifier::Update(const Var& var, const PrimExpr& info, bool allow_override) {
+  parent_->ClearMemo();
   impl_->Update(var, info, allow_override);
 }
 
@@ -1609,7 +1617,8 @@ std::function<void()> RewriteSimplifier::EnterConstraint(const PrimExpr& constra
   return impl_->EnterConstraint(constraint);
 }
 
-RewriteSimplifier::RewriteSimplifier(Analyzer* parent) : impl_(new Impl(parent)) {}
+RewriteSimplifier::RewriteSimplifier(Analyzer* parent)
+    : impl_(new Impl(parent)), parent_(parent) {}
 
 RewriteSimplifier::~RewriteSimplifier() { delete impl_; }
 
@@ -27,6 +27,7 @@
 #include <tvm/auto_scheduler/search_policy.h>
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule.h>
 #include <tvm/te/schedule_pass.h>
@@ -662,6 +663,7 @@ ComputeDAG::ComputeDAG(Array<te::Tensor> tensors) {
   node->ops = node->access_analyzer->ops_topo_order;
   node->flop_ct = FlopEstimator().EstimateFlop(node->ops);
   node->init_state = State(node->ops);
+  node->infer_bound_cache = std::make_shared<te::InferBoundCache>();
   data_ = std::move(node);
 }
 
@@ -776,7 +778,7 @@ State ComputeDAG::InferBound(const State& state) const {
   std::tie(sch, tensors) = ApplySteps(pstate->transform_steps, &stages, &stage_to_axes);
   sch = sch.normalize();
   // Get bound information from TVM schedule
-  Map<IterVar, Range> bounds = te::InferBound(sch);
+  Map<IterVar, Range> bounds = te::InferBound(sch, operator->()->infer_bound_cache.get());
 
   // Update the state bound information
   for (size_t i = 0; i < pstate->stages.size(); ++i) {
@@ -811,18 +813,22 @@ State ComputeDAG::InferBound(const State& state) const {
 }
 
 Array<State> ComputeDAG::InferBound(const Array<State>& states) const {
-  Array<State> out_states;
-  // TODO(jcf94, merrymercy): Use parallel_for to run this in parallel
-  for (const auto& state : states) {
-    State out_state;
+  if (states.empty()) {
+    return states;
+  }
+  std::vector<State> out_states(states.size(), State());
+
+  support::parallel_for(0, states.size(), [this, &states, &out_states](int i) {
     try {
-      out_state = this->InferBound(state);
+      out_states[i] = this->InferBound(states[i]);
     } catch (dmlc::Error& e) {
-      LOG(WARNING) << "InferBound fails on the state:\n" << state << "\n" << e.what() << std::endl;
+      LOG(WARNING) << "InferBound fails on the state:\n"
+                   << states[i] << "\n"
+                   << e.what() << std::endl;
     }
-    out_states.push_back(std::move(out_state));
-  }
-  return out_states;
+  });
+
+  return Array<State>(out_states.begin(), out_states.end());
 }
 
 ComputeDAG ComputeDAG::ReplayAndGetDAG(const Array<Step>& transform_steps) const {
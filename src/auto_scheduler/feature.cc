@@ -22,11 +22,13 @@
  * \brief Feature extraction for the cost model
  */
 
+#include <dmlc/json.h>
 #include <tvm/arith/analyzer.h>
 #include <tvm/auto_scheduler/feature.h>
 #include <tvm/auto_scheduler/measure.h>
 #include <tvm/auto_scheduler/measure_record.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule_pass.h>
 #include <tvm/tir/analysis.h>
@@ -36,7 +38,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <mutex>
 #include <numeric>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -1258,8 +1264,103 @@ void GetPerStoreFeatureName(int max_n_bufs, std::vector<std::string>* ret) {
   // section total : 3
 }
 
+/*!
+ * \brief The cache of extracted per-store features. The key is made of the compute declaration,
+ * the target, the hardware params, the pass context and the serialized transform steps of a
+ * state, so identical states that come back in later search rounds are not lowered and
+ * extracted again.
+ */
+class PerStoreFeatureCache {
+ public:
+  static PerStoreFeatureCache* Global() {
+    static PerStoreFeatureCache inst;
+    return &inst;
+  }
+
+  static std::string GetKey(const SearchTask& task, const State& state, int max_n_bufs) {
+    // The workload key alone is not enough, tasks created by hand may share one
+    std::ostringstream dag;
+    dag << task->compute_dag;
+    std::ostringstream os;
+    os << task->workload_key << "\n"
+       << std::hash<std::string>()(dag.str()) << "\n"
+       << task->target->str() << "\n"
+       << max_n_bufs << "\n";
+    // The hardware params and the pass context change the lowering and the extracted features
+    if (task->hardware_params.defined()) {
+      const HardwareParamsNode* hw = task->hardware_params.get();
+      os << hw->num_cores << ' ' << hw->vector_unit_bytes << ' ' << hw->cache_line_bytes << ' '
+         << hw->max_shared_memory_per_block << ' ' << hw->max_registers_per_block << ' '
+         << hw->max_threads_per_block << ' ' << hw->max_vthread_extent << ' '
+         << hw->warp_size << "\n";
+    }
+    tvm::transform::PassContext pass_ctx = tvm::transform::PassContext::Current();
+    os << pass_ctx->opt_level << ' ' << pass_ctx->required_pass << ' ' << pass_ctx->disabled_pass;
+    // Map iterates in hash order, sort the configs to keep the key stable
+    std::map<std::string, std::string> configs;
+    for (const auto& kv : pass_ctx->config) {
+      std::ostringstream value;
+      value << kv.second;
+      configs[kv.first] = value.str();
+    }
+    for (const auto& kv : configs) {
+      os << ' ' << kv.first << '=' << kv.second;
+    }
+    os << "\n";
+    dmlc::JSONWriter writer(&os);
+    writer.BeginArray(false);
+    for (const auto& step : state->transform_steps) {
+      writer.WriteArraySeperator();
+      writer.BeginArray(false);
+      step->WriteToRecord(&writer);
+      writer.EndArray();
+    }
+    writer.EndArray();
+    return os.str();
+  }
+
+  bool Lookup(const std::string& key, std::vector<float>* feature) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = features_.find(key);
+    if (it == features_.end()) {
+      return false;
+    }
+    *feature = it->second;
+    return true;
+  }
+
+  void Insert(const std::string& key, const std::vector<float>& feature) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Start over rather than track the usage of every entry, the states of the current
+    // search rounds are extracted and cached again quickly.
+    if (features_.size() >= kMaxEntries) {
+      features_.clear();
+    }
+    features_[key] = feature;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    features_.clear();
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 16384;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<float>> features_;
+};
+
+void ClearPerStoreFeatureCache() { PerStoreFeatureCache::Global()->Clear(); }
+
 void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, int max_n_bufs,
                                    std::vector<float>* feature, std::atomic<int>* error_ct) {
+  PerStoreFeatureCache* cache = PerStoreFeatureCache::Global();
+  std::string key = PerStoreFeatureCache::GetKey(task, state, max_n_bufs);
+  if (cache->Lookup(key, feature)) {
+    return;
+  }
+
   te::Schedule sch;
   Array<te::Tensor> tensors;
 
@@ -1324,6 +1425,7 @@ void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, i
     const auto& prim_func = (*it).second.as<PrimFuncNode>();
     GetPerStoreFeature(prim_func->body, task->hardware_params->cache_line_bytes, max_n_bufs,
                        feature);
+    cache->Insert(key, *feature);
   } catch (dmlc::Error& e) {
     (*error_ct)++;
   }
@@ -1337,8 +1439,15 @@ void GetPerStoreFeaturesFromStates(const Array<State>& states, const SearchTask&
 
   std::atomic<int> error_ct(0);
 
-  for (size_t i = skip_first_n_feature_extraction; i < states.size(); ++i) {
-    GetPerStoreFeaturesWorkerFunc(task, states[i], max_n_bufs, &(*features)[i], &error_ct);
+  if (skip_first_n_feature_extraction < static_cast<int>(states.size())) {
+    // The pass context is thread local, let the workers lower with the one of the caller
+    auto pass_ctx = tvm::transform::PassContext::Current();
+    support::parallel_for(skip_first_n_feature_extraction, states.size(),
+                          [&task, &states, max_n_bufs, &features, &error_ct, &pass_ctx](int i) {
+                            With<tvm::transform::PassContext> scope(pass_ctx);
+                            GetPerStoreFeaturesWorkerFunc(task, states[i], max_n_bufs,
+                                                          &(*features)[i], &error_ct);
+                          });
   }
 
   if (error_ct > 0) {
@@ -1355,8 +1464,15 @@ void GetPerStoreFeaturesFromStates(const Array<State>& states, const std::vector
 
   std::atomic<int> error_ct(0);
 
-  for (size_t i = skip_first_n_feature_extraction; i < states.size(); ++i) {
-    GetPerStoreFeaturesWorkerFunc(tasks[i], states[i], max_n_bufs, &(*features)[i], &error_ct);
+  if (skip_first_n_feature_extraction < static_cast<int>(states.size())) {
+    // The pass context is thread local, let the workers lower with the one of the caller
+    auto pass_ctx = tvm::transform::PassContext::Current();
+    support::parallel_for(skip_first_n_feature_extraction, states.size(),
+                          [&tasks, &states, max_n_bufs, &features, &error_ct, &pass_ctx](int i) {
+                            With<tvm::transform::PassContext> scope(pass_ctx);
+                            GetPerStoreFeaturesWorkerFunc(tasks[i], states[i], max_n_bufs,
+                                                          &(*features)[i], &error_ct);
+                          });
   }
 
   if (error_ct > 0) {
@@ -1641,5 +1757,8 @@ TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeatureNames")
       *ret = arr;
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.ClearPerStoreFeatureCache")
+    .set_body_typed(ClearPerStoreFeatureCache);
+
 }  // namespace auto_scheduler
 }  // namespace tvm
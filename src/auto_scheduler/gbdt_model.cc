@@ -0,0 +1,518 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/gbdt_model.cc
+ * \brief A gradient boosted decision tree cost model trained on per-store features.
+ */
+
+#include <tvm/auto_scheduler/cost_model.h>
+#include <tvm/auto_scheduler/feature.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace auto_scheduler {
+
+TVM_REGISTER_OBJECT_TYPE(GBDTModelNode);
+
+// The magic string at the beginning of a saved model
+static const char* kGBDTModelMagic = "tvm.auto_scheduler.GBDTModel";
+static const int kGBDTModelVersion = 1;
+// Splits gaining less than this are not worth a node
+static const double kMinSplitGain = 1e-6;
+
+/*! \brief The per-store feature rows of a batch of states, the input of the trees. */
+struct StoreRows {
+  /*! \brief The length of a row. */
+  int num_features = 0;
+  /*! \brief The features of all rows in row-major. */
+  std::vector<float> values;
+  /*! \brief The index of the state of every row. */
+  std::vector<int> state_ids;
+  /*! \brief The index of the first row of every state, followed by the number of rows. */
+  std::vector<int> state_offsets;
+
+  int NumRows() const { return static_cast<int>(state_ids.size()); }
+  const float* Row(int i) const { return values.data() + static_cast<size_t>(i) * num_features; }
+};
+
+/*!
+ * \brief Unpack the per-store features of states into rows.
+ * \param features The features of every state, in the format of GetPerStoreFeature. The
+ * features of states that fail to be lowered are empty and get no rows.
+ * \param num_features The length of the feature vector of one store.
+ */
+StoreRows FlattenStoreFeatures(const std::vector<std::vector<float>>& features, int num_features) {
+  StoreRows rows;
+  rows.num_features = num_features;
+  rows.state_offsets.reserve(features.size() + 1);
+  rows.state_offsets.push_back(0);
+  for (size_t i = 0; i < features.size(); ++i) {
+    const std::vector<float>& fea = features[i];
+    if (!fea.empty()) {
+      int n_stores = static_cast<int>(fea[0]);
+      CHECK_EQ(fea.size(), 1 + static_cast<size_t>(n_stores) * num_features)
+          << "The feature vector does not match max_n_bufs of the model";
+      rows.values.insert(rows.values.end(), fea.begin() + 1, fea.end());
+      rows.state_ids.insert(rows.state_ids.end(), n_stores, static_cast<int>(i));
+    }
+    rows.state_offsets.push_back(rows.NumRows());
+  }
+  return rows;
+}
+
+/*! \brief Get the output of a tree on a feature row. */
+inline float PredictTree(const std::vector<GBDTTreeNode>& tree, const float* row) {
+  int i = 0;
+  while (tree[i].feature >= 0) {
+    i = row[tree[i].feature] < tree[i].threshold ? tree[i].left : tree[i].left + 1;
+  }
+  return tree[i].value;
+}
+
+/*! \brief The features quantized to bins, to search splits with histograms. */
+struct QuantizedRows {
+  /*! \brief The cut points of every feature, bin b holds cuts[b - 1] <= x < cuts[b]. */
+  std::vector<std::vector<float>> cuts;
+  /*! \brief The bin of every row, column-major so that a feature is scanned contiguously. */
+  std::vector<uint8_t> bins;
+
+  uint8_t Bin(int feature, int row, int num_rows) const {
+    return bins[static_cast<size_t>(feature) * num_rows + row];
+  }
+};
+
+QuantizedRows QuantizeStoreRows(const StoreRows& rows, int max_bins) {
+  int n_rows = rows.NumRows();
+  int n_features = rows.num_features;
+  QuantizedRows ret;
+  ret.cuts.resize(n_features);
+  ret.bins.resize(static_cast<size_t>(n_features) * n_rows);
+
+  support::parallel_for(0, n_features, [&rows, &ret, n_rows, n_features, max_bins](int f) {
+    std::vector<float> column(n_rows);
+    for (int r = 0; r < n_rows; ++r) {
+      column[r] = rows.Row(r)[f];
+    }
+    std::vector<float> distinct = column;
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    // Cut in the middle of adjacent distinct values, at quantiles if there are too many of them
+    std::vector<float>& cuts = ret.cuts[f];
+    int n_distinct = static_cast<int>(distinct.size());
+    int n_bins = std::min(n_distinct, max_bins);
+    for (int b = 1; b < n_bins; ++b) {
+      int i = static_cast<int>(static_cast<int64_t>(b) * n_distinct / n_bins);
+      float cut = distinct[i - 1] + (distinct[i] - distinct[i - 1]) / 2;
+      // The middle may round to the lower value, which would put it in the upper bin
+      cuts.push_back(cut > distinct[i - 1] ? cut : distinct[i]);
+    }
+
+    uint8_t* bins = ret.bins.data() + static_cast<size_t>(f) * n_rows;
+    for (int r = 0; r < n_rows; ++r) {
+      bins[r] = static_cast<uint8_t>(std::upper_bound(cuts.begin(), cuts.end(), column[r]) -
+                                     cuts.begin());
+    }
+  });
+  return ret;
+}
+
+/*! \brief The best split of a node on one feature. */
+struct SplitCandidate {
+  double gain = 0;
+  /*! \brief Rows in this bin and below go to the left child. -1 for no valid split. */
+  int bin = -1;
+};
+
+/*!
+ * \brief Add trees to an ensemble by gradient boosting on the pack-sum square error,
+ * loss = sum_i w_i * (sum_{r in state i} pred_r - y_i)^2 / 2. The trees are grown level by level
+ * and the histograms of all nodes of a level are built in parallel over the features.
+ * \param model The model holding the hyper parameters.
+ * \param rows The training rows.
+ * \param labels The label of every state.
+ * \param weights The weight of every state.
+ * \param num_trees The number of trees to add.
+ * \param trees The ensemble.
+ */
+void BoostTrees(const GBDTModelNode& model, const StoreRows& rows,
+                const std::vector<float>& labels, const std::vector<float>& weights,
+                int num_trees, std::vector<std::vector<GBDTTreeNode>>* trees) {
+  int n_rows = rows.NumRows();
+  int n_states = static_cast<int>(labels.size());
+  int n_features = rows.num_features;
+  if (n_rows == 0) {
+    return;
+  }
+  double lambda = model.reg_lambda;
+  QuantizedRows quantized = QuantizeStoreRows(rows, std::min(std::max(model.max_bins, 2), 256));
+
+  // The current prediction of every row
+  std::vector<float> row_preds(n_rows, 0.0f);
+  support::parallel_for(0, n_rows, [&rows, &row_preds, trees](int r) {
+    for (const auto& tree : *trees) {
+      row_preds[r] += PredictTree(tree, rows.Row(r));
+    }
+  });
+
+  std::vector<double> state_preds(n_states);
+  std::vector<double> grads(n_rows), hessians(n_rows);
+  std::vector<int> row_node(n_rows);
+  for (int t = 0; t < num_trees; ++t) {
+    std::fill(state_preds.begin(), state_preds.end(), 0.0);
+    for (int r = 0; r < n_rows; ++r) {
+      state_preds[rows.state_ids[r]] += row_preds[r];
+    }
+    for (int r = 0; r < n_rows; ++r) {
+      int s = rows.state_ids[r];
+      grads[r] = weights[s] * (state_preds[s] - labels[s]);
+      hessians[r] = weights[s];
+    }
+
+    std::vector<GBDTTreeNode> tree(1, GBDTTreeNode{-1, 0.0f, -1, 0.0f});
+    std::fill(row_node.begin(), row_node.end(), 0);
+    std::vector<int> open_nodes = {0};
+    for (int depth = 0; !open_nodes.empty(); ++depth) {
+      int n_open = static_cast<int>(open_nodes.size());
+      std::vector<int> slot_of(tree.size(), -1);
+      for (int k = 0; k < n_open; ++k) {
+        slot_of[open_nodes[k]] = k;
+      }
+      std::vector<double> node_grad(n_open, 0.0), node_hessian(n_open, 0.0);
+      for (int r = 0; r < n_rows; ++r) {
+        int k = slot_of[row_node[r]];
+        if (k >= 0) {
+          node_grad[k] += grads[r];
+          node_hessian[k] += hessians[r];
+        }
+      }
+
+      // Search the best split of every open node on every feature
+      std::vector<SplitCandidate> candidates;
+      if (depth < model.max_depth) {
+        candidates.resize(static_cast<size_t>(n_open) * n_features);
+        support::parallel_for(0, n_features, [&](int f) {
+          int n_bins = static_cast<int>(quantized.cuts[f].size()) + 1;
+          if (n_bins == 1) {
+            return;
+          }
+          std::vector<double> hist_grad(static_cast<size_t>(n_open) * n_bins, 0.0);
+          std::vector<double> hist_hessian(static_cast<size_t>(n_open) * n_bins, 0.0);
+          for (int r = 0; r < n_rows; ++r) {
+            int k = slot_of[row_node[r]];
+            if (k >= 0) {
+              int b = quantized.Bin(f, r, n_rows);
+              hist_grad[k * n_bins + b] += grads[r];
+              hist_hessian[k * n_bins + b] += hessians[r];
+            }
+          }
+          for (int k = 0; k < n_open; ++k) {
+            double g = node_grad[k], h = node_hessian[k];
+            double parent_score = g * g / (h + lambda);
+            double left_g = 0, left_h = 0;
+            SplitCandidate& best = candidates[static_cast<size_t>(k) * n_features + f];
+            for (int b = 0; b + 1 < n_bins; ++b) {
+              left_g += hist_grad[k * n_bins + b];
+              left_h += hist_hessian[k * n_bins + b];
+              double right_g = g - left_g, right_h = h - left_h;
+              if (left_h < model.min_child_weight || right_h < model.min_child_weight) {
+                continue;
+              }
+              double gain = left_g * left_g / (left_h + lambda) +
+                            right_g * right_g / (right_h + lambda) - parent_score;
+              if (gain > best.gain) {
+                best.gain = gain;
+                best.bin = b;
+              }
+            }
+          }
+        });
+      }
+
+      // Split the nodes with a worthy split, and make the others leaves
+      std::vector<int> split_feature(n_open, -1), split_bin(n_open, -1);
+      std::vector<int> next_open_nodes;
+      for (int k = 0; k < n_open; ++k) {
+        int node = open_nodes[k];
+        double best_gain = kMinSplitGain;
+        for (int f = 0; f < n_features && !candidates.empty(); ++f) {
+          const SplitCandidate& c = candidates[static_cast<size_t>(k) * n_features + f];
+          if (c.bin >= 0 && c.gain > best_gain) {
+            best_gain = c.gain;
+            split_feature[k] = f;
+            split_bin[k] = c.bin;
+          }
+        }
+        if (split_feature[k] >= 0) {
+          int left = static_cast<int>(tree.size());
+          float threshold = quantized.cuts[split_feature[k]][split_bin[k]];
+          tree[node] = GBDTTreeNode{split_feature[k], threshold, left, 0.0f};
+          tree.push_back(GBDTTreeNode{-1, 0.0f, -1, 0.0f});
+          tree.push_back(GBDTTreeNode{-1, 0.0f, -1, 0.0f});
+          next_open_nodes.push_back(left);
+          next_open_nodes.push_back(left + 1);
+        } else {
+          tree[node].value = static_cast<float>(-model.learning_rate * node_grad[k] /
+                                                (node_hessian[k] + lambda));
+        }
+      }
+
+      for (int r = 0; r < n_rows; ++r) {
+        int k = slot_of[row_node[r]];
+        if (k >= 0 && split_feature[k] >= 0) {
+          int left = tree[row_node[r]].left;
+          bool go_left = quantized.Bin(split_feature[k], r, n_rows) <= split_bin[k];
+          row_node[r] = go_left ? left : left + 1;
+        }
+      }
+      open_nodes = std::move(next_open_nodes);
+    }
+
+    for (int r = 0; r < n_rows; ++r) {
+      row_preds[r] += tree[row_node[r]].value;
+    }
+    trees->push_back(std::move(tree));
+  }
+}
+
+GBDTModel::GBDTModel(int num_trees_per_update, int max_depth, float learning_rate,
+                     int num_warmup_sample, int seed) {
+  auto node = make_object<GBDTModelNode>();
+  node->num_trees_per_update = num_trees_per_update;
+  node->max_num_trees = 1000;
+  node->max_depth = max_depth;
+  node->learning_rate = learning_rate;
+  node->reg_lambda = 1.0f;
+  node->min_child_weight = 0.0f;
+  node->max_bins = 256;
+  node->num_warmup_sample = num_warmup_sample;
+  node->max_n_bufs = 5;
+  node->rand_gen_ = std::mt19937(seed);
+  data_ = std::move(node);
+}
+
+void GBDTModelNode::Update(const Array<MeasureInput>& inputs,
+                           const Array<MeasureResult>& results) {
+  if (inputs.empty()) {
+    return;
+  }
+  CHECK_EQ(inputs.size(), results.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs_.push_back(inputs[i]);
+    results_.push_back(results[i]);
+  }
+
+  // Only extract the new inputs, the throughputs of all of them are normalized again as the
+  // best cost of a task may have improved
+  size_t n_cached = features_.size();
+  std::vector<std::vector<float>> features;
+  std::vector<float> normalized_throughputs;
+  std::vector<int> task_ids;
+  GetPerStoreFeaturesFromMeasurePairs(inputs_, results_, n_cached, max_n_bufs, &features,
+                                      &normalized_throughputs, &task_ids);
+  for (size_t i = 0; i < n_cached; ++i) {
+    features[i] = std::move(features_[i]);
+  }
+  features_ = std::move(features);
+
+  std::vector<std::string> feature_names;
+  GetPerStoreFeatureName(max_n_bufs, &feature_names);
+  StoreRows rows = FlattenStoreFeatures(features_, static_cast<int>(feature_names.size()));
+
+  // Boost on top of the current trees, as most of the training set has been fitted already
+  if (trees_.size() + num_trees_per_update > static_cast<size_t>(max_num_trees)) {
+    trees_.clear();
+  }
+  // Like XGBModel, weight the states by their throughputs to fit the fast programs better
+  BoostTrees(*this, rows, normalized_throughputs, normalized_throughputs, num_trees_per_update,
+             &trees_);
+}
+
+bool GBDTModelNode::PredictStores(const SearchTask& task, const Array<State>& states,
+                                  std::vector<std::vector<float>>* store_scores) {
+  std::vector<std::vector<float>> features;
+  GetPerStoreFeaturesFromStates(states, task, 0, max_n_bufs, &features);
+  std::vector<std::string> feature_names;
+  GetPerStoreFeatureName(max_n_bufs, &feature_names);
+  StoreRows rows = FlattenStoreFeatures(features, static_cast<int>(feature_names.size()));
+
+  store_scores->assign(states.size(), std::vector<float>());
+  bool use_trees = !trees_.empty() && static_cast<int>(inputs_.size()) > num_warmup_sample;
+  if (!use_trees) {
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (size_t i = 0; i < states.size(); ++i) {
+      int n_stores = rows.state_offsets[i + 1] - rows.state_offsets[i];
+      if (n_stores > 0) {
+        (*store_scores)[i].push_back(dist(rand_gen_));
+      }
+    }
+    return false;
+  }
+
+  if (!states.empty()) {
+    support::parallel_for(0, states.size(), [this, &rows, store_scores](int i) {
+      std::vector<float>& scores = (*store_scores)[i];
+      for (int r = rows.state_offsets[i]; r < rows.state_offsets[i + 1]; ++r) {
+        float score = 0.0f;
+        for (const auto& tree : trees_) {
+          score += PredictTree(tree, rows.Row(r));
+        }
+        scores.push_back(score);
+      }
+    });
+  }
+  return true;
+}
+
+void GBDTModelNode::Predict(const SearchTask& task, const Array<State>& states,
+                            std::vector<float>* scores) {
+  std::vector<std::vector<float>> store_scores;
+  PredictStores(task, states, &store_scores);
+
+  scores->resize(states.size());
+  for (size_t i = 0; i < states.size(); ++i) {
+    if (store_scores[i].empty()) {
+      // Predict -inf for invalid states that failed to be lowered
+      (*scores)[i] = -std::numeric_limits<float>::infinity();
+    } else {
+      float sum = 0.0f;
+      for (float x : store_scores[i]) {
+        sum += x;
+      }
+      (*scores)[i] = sum;
+    }
+  }
+}
+
+void GBDTModelNode::PredictStages(const SearchTask& task, const Array<State>& states,
+                                  std::vector<float>* state_scores,
+                                  std::vector<std::vector<float>>* stage_scores) {
+  std::vector<std::vector<float>> store_scores;
+  bool use_trees = PredictStores(task, states, &store_scores);
+
+  state_scores->clear();
+  stage_scores->clear();
+  for (size_t i = 0; i < states.size(); ++i) {
+    const std::vector<float>& scores = store_scores[i];
+    if (scores.empty()) {
+      // Predict -inf for invalid states that failed to be lowered
+      state_scores->push_back(-std::numeric_limits<float>::infinity());
+      stage_scores->push_back({});
+      continue;
+    }
+    float sum = 0.0f;
+    for (float x : scores) {
+      sum += x;
+    }
+    state_scores->push_back(sum);
+
+    // Every stage that is neither a placeholder nor inlined has a store. Give no breakdown
+    // for random predictions, or if the stores do not map to the stages one to one.
+    std::vector<float> breakdown;
+    size_t offset = 0;
+    for (const Stage& stage : states[i]->stages) {
+      if (stage->op_type == StageKind::kPlaceholder ||
+          stage->compute_at == ComputeAtKind::kInlined) {
+        breakdown.push_back(0);
+      } else if (offset < scores.size()) {
+        breakdown.push_back(scores[offset++]);
+      } else {
+        offset = scores.size() + 1;
+        break;
+      }
+    }
+    if (!use_trees || offset != scores.size()) {
+      breakdown.clear();
+    }
+    stage_scores->push_back(std::move(breakdown));
+  }
+}
+
+void GBDTModelNode::Save(const std::string& file_name) const {
+  std::ofstream ofs(file_name);
+  CHECK(ofs.is_open()) << "Cannot open " << file_name;
+  ofs << std::setprecision(std::numeric_limits<float>::max_digits10);
+  ofs << kGBDTModelMagic << " " << kGBDTModelVersion << "\n";
+  ofs << max_n_bufs << " " << trees_.size() << "\n";
+  for (const auto& tree : trees_) {
+    ofs << tree.size() << "\n";
+    for (const auto& node : tree) {
+      ofs << node.feature << " " << node.threshold << " " << node.left << " " << node.value
+          << "\n";
+    }
+  }
+  CHECK(ofs.good()) << "Failed to write " << file_name;
+}
+
+void GBDTModelNode::Load(const std::string& file_name) {
+  std::ifstream ifs(file_name);
+  CHECK(ifs.is_open()) << "Cannot open " << file_name;
+  std::string magic;
+  int version = 0;
+  ifs >> magic >> version;
+  CHECK(ifs.good() && magic == kGBDTModelMagic && version == kGBDTModelVersion)
+      << file_name << " is not a saved GBDTModel";
+
+  size_t n_trees = 0;
+  ifs >> max_n_bufs >> n_trees;
+  std::vector<std::vector<GBDTTreeNode>> trees(n_trees);
+  for (auto& tree : trees) {
+    size_t n_nodes = 0;
+    ifs >> n_nodes;
+    CHECK(ifs.good() && n_nodes > 0) << "Corrupted GBDTModel file " << file_name;
+    tree.resize(n_nodes);
+    for (auto& node : tree) {
+      ifs >> node.feature >> node.threshold >> node.left >> node.value;
+      CHECK(!ifs.fail()) << "Corrupted GBDTModel file " << file_name;
+      CHECK(node.feature < 0 || (node.left > 0 && static_cast<size_t>(node.left) + 1 < n_nodes))
+          << "Corrupted GBDTModel file " << file_name;
+    }
+  }
+  trees_ = std::move(trees);
+  // Like XGBModel, a loaded model predicts from the start
+  num_warmup_sample = -1;
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModel")
+    .set_body_typed([](int num_trees_per_update, int max_depth, double learning_rate,
+                       int num_warmup_sample, int seed) {
+      return GBDTModel(num_trees_per_update, max_depth, static_cast<float>(learning_rate),
+                       num_warmup_sample, seed);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModelSave")
+    .set_body_typed([](GBDTModel model, String file_name) { model->Save(file_name); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.GBDTModelLoad")
+    .set_body_typed([](GBDTModel model, String file_name) { model->Load(file_name); });
+
+}  // namespace auto_scheduler
+}  // namespace tvm
@@ -23,9 +23,16 @@
  */
 
 #include <tvm/auto_scheduler/measure.h>
+#include <tvm/ir/transform.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "utils.h"
 
@@ -123,21 +130,26 @@ Array<BuildResult> LocalBuilderNode::Build(const Array<MeasureInput>& inputs, in
 
 /********** LocalRunner **********/
 LocalRunner::LocalRunner(int timeout, int number, int repeat, int min_repeat_ms,
-                         double cooldown_interval) {
+                         double cooldown_interval, int max_repeat, double confidence_tolerance,
+                         double slow_abort_ratio) {
   ObjectPtr<LocalRunnerNode> node = make_object<LocalRunnerNode>();
   node->timeout = timeout;
   node->number = number;
   node->repeat = repeat;
   node->min_repeat_ms = min_repeat_ms;
   node->cooldown_interval = cooldown_interval;
+  node->max_repeat = max_repeat;
+  node->confidence_tolerance = confidence_tolerance;
+  node->slow_abort_ratio = slow_abort_ratio;
   data_ = std::move(node);
 }
 
 Array<MeasureResult> LocalRunnerNode::Run(const Array<MeasureInput>& inputs,
                                           const Array<BuildResult>& build_results, int verbose) {
   if (const auto* f = runtime::Registry::Get("auto_scheduler.local_runner.run")) {
-    Array<MeasureResult> results = (*f)(inputs, build_results, timeout, number, repeat,
-                                        min_repeat_ms, cooldown_interval, verbose);
+    Array<MeasureResult> results =
+        (*f)(inputs, build_results, timeout, number, repeat, min_repeat_ms, cooldown_interval,
+             verbose, max_repeat, confidence_tolerance, slow_abort_ratio);
     return results;
   }
   LOG(FATAL) << "auto_scheduler.local_runner.run is not registered. "
@@ -149,7 +161,8 @@ Array<MeasureResult> LocalRunnerNode::Run(const Array<MeasureInput>& inputs,
 /********** RPCRunner **********/
 RPCRunner::RPCRunner(const String& key, const String& host, int port, int priority, int n_parallel,
                      int timeout, int number, int repeat, int min_repeat_ms,
-                     double cooldown_interval) {
+                     double cooldown_interval, int max_repeat, double confidence_tolerance,
+                     double slow_abort_ratio) {
   auto node = make_object<RPCRunnerNode>();
   node->key = key;
   node->host = host;
@@ -161,6 +174,9 @@ RPCRunner::RPCRunner(const String& key, const String& host, int port, int priori
   node->repeat = repeat;
   node->min_repeat_ms = min_repeat_ms;
   node->cooldown_interval = cooldown_interval;
+  node->max_repeat = max_repeat;
+  node->confidence_tolerance = confidence_tolerance;
+  node->slow_abort_ratio = slow_abort_ratio;
   data_ = std::move(node);
 }
 
@@ -169,7 +185,8 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
   if (const auto* f = runtime::Registry::Get("auto_scheduler.rpc_runner.run")) {
     Array<MeasureResult> results =
         (*f)(inputs, build_results, key, host, port, priority, n_parallel, timeout, number, repeat,
-             min_repeat_ms, cooldown_interval, verbose);
+             min_repeat_ms, cooldown_interval, verbose, max_repeat, confidence_tolerance,
+             slow_abort_ratio);
     return results;
   } else {
     LOG(FATAL) << "auto_scheduler.rpc_runner.run is not registered. "
@@ -182,7 +199,7 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
 /********** ProgramMeasurer **********/
 ProgramMeasurer::ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
                                  Optional<Array<MeasureCallback>> callbacks, int verbose,
-                                 int max_continous_error) {
+                                 int max_continous_error, int pipeline_depth) {
   auto node = make_object<ProgramMeasurerNode>();
   node->builder = std::move(builder);
   node->runner = std::move(runner);
@@ -191,6 +208,7 @@ ProgramMeasurer::ProgramMeasurer(ProgramBuilder builder, ProgramRunner runner,
   node->max_continous_error = max_continous_error < 0
                                   ? ProgramMeasurerNode::DEFAULT_MAX_CONTINOUS_ERROR
                                   : max_continous_error;
+  node->pipeline_depth = pipeline_depth;
   data_ = std::move(node);
 }
 
@@ -215,14 +233,14 @@ void ProgramMeasurerNode::Measure(const SearchTask& task, const SearchPolicy& po
   StdCout(verbose) << "Get " << inputs.size() << " programs for measure. (This may take a while)"
                    << std::endl;
 
+  std::vector<Array<MeasureInput>> input_batches;
   for (size_t i = 0; i < inputs.size(); i += batch_size) {
-    Array<MeasureInput> input_batch(inputs.begin() + i,
-                                    inputs.begin() + std::min(i + batch_size, inputs.size()));
-    Array<MeasureResult> result_batch;
-
-    // build and run
-    SilentMeasure(task, input_batch, &result_batch);
+    input_batches.emplace_back(inputs.begin() + i,
+                               inputs.begin() + std::min(i + batch_size, inputs.size()));
+  }
 
+  auto process_batch = [this, &task, &policy, results](const Array<MeasureInput>& input_batch,
+                                                       const Array<MeasureResult>& result_batch) {
     // update current best state according to the new measure result
     for (size_t j = 0; j < input_batch.size(); ++j) {
       double flops;
@@ -264,7 +282,92 @@ void ProgramMeasurerNode::Measure(const SearchTask& task, const SearchPolicy& po
     if (error_ct > max_continous_error) {
       LOG(FATAL) << "Too many errors happened during tuning";
     }
+  };
+
+  if (pipeline_depth > 0 && input_batches.size() > 1) {
+    PipelinedMeasure(input_batches, process_batch);
+    return;
+  }
+  for (const auto& input_batch : input_batches) {
+    Array<MeasureResult> result_batch;
+
+    // build and run
+    SilentMeasure(task, input_batch, &result_batch);
+
+    process_batch(input_batch, result_batch);
+  }
+}
+
+void ProgramMeasurerNode::PipelinedMeasure(
+    const std::vector<Array<MeasureInput>>& input_batches,
+    const std::function<void(const Array<MeasureInput>&, const Array<MeasureResult>&)>&
+        process_batch) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  // The build results waiting for the runner, at most pipeline_depth of them
+  std::deque<Array<BuildResult>> built_batches;
+  std::exception_ptr build_error;
+  bool stop = false;
+
+  // The pass context is thread local, let the builder use the one of the caller
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  std::thread build_thread([&]() {
+    With<tvm::transform::PassContext> scope(pass_ctx);
+    for (const auto& input_batch : input_batches) {
+      Array<BuildResult> build_results;
+      try {
+        build_results = builder->Build(input_batch, verbose);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        build_error = std::current_exception();
+        cv.notify_all();
+        return;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&]() {
+        return stop || static_cast<int>(built_batches.size()) < pipeline_depth;
+      });
+      if (stop) {
+        return;
+      }
+      built_batches.push_back(std::move(build_results));
+      cv.notify_all();
+    }
+  });
+
+  // Stop and join the builder on every exit, including the errors raised by the runner or
+  // by the book keeping of the results
+  auto stop_build_thread = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    build_thread.join();
+  };
+
+  try {
+    for (const auto& input_batch : input_batches) {
+      Array<BuildResult> build_results;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return !built_batches.empty() || build_error; });
+        if (built_batches.empty()) {
+          std::rethrow_exception(build_error);
+        }
+        build_results = std::move(built_batches.front());
+        built_batches.pop_front();
+        cv.notify_all();
+      }
+      // Run this batch while the builder works on the next ones
+      Array<MeasureResult> result_batch = runner->Run(input_batch, build_results, verbose);
+      process_batch(input_batch, result_batch);
+    }
+  } catch (...) {
+    stop_build_thread();
+    throw;
   }
+  stop_build_thread();
 }
 
 void ProgramMeasurerNode::SilentMeasure(const SearchTask& task, const Array<MeasureInput>& inputs,
@@ -356,16 +459,20 @@ TVM_REGISTER_GLOBAL("auto_scheduler.LocalBuilder")
 
 TVM_REGISTER_GLOBAL("auto_scheduler.LocalRunner")
     .set_body_typed([](int timeout, int number, int repeat, int min_repeat_ms,
-                       double cooldown_interval) {
-      return LocalRunner(timeout, number, repeat, min_repeat_ms, cooldown_interval);
+                       double cooldown_interval, int max_repeat, double confidence_tolerance,
+                       double slow_abort_ratio) {
+      return LocalRunner(timeout, number, repeat, min_repeat_ms, cooldown_interval, max_repeat,
+                         confidence_tolerance, slow_abort_ratio);
     });
 
 TVM_REGISTER_GLOBAL("auto_scheduler.RPCRunner")
     .set_body_typed([](const String& key, const String& host, int port, int priority,
                        int n_parallel, int timeout, int number, int repeat, int min_repeat_ms,
-                       double cooldown_interval) {
+                       double cooldown_interval, int max_repeat, double confidence_tolerance,
+                       double slow_abort_ratio) {
       return RPCRunner(key, host, port, priority, n_parallel, timeout, number, repeat,
-                       min_repeat_ms, cooldown_interval);
+                       min_repeat_ms, cooldown_interval, max_repeat, confidence_tolerance,
+                       slow_abort_ratio);
     });
 
 }  // namespace auto_scheduler
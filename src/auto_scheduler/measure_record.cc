@@ -28,12 +28,17 @@
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <map>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "../runtime/mapped_file.h"
 #include "utils.h"
 
 // Json serialization handler for MeasureInput, MeasureResult
@@ -215,6 +220,7 @@ namespace auto_scheduler {
 
 TVM_REGISTER_OBJECT_TYPE(RecordToFileNode);
 TVM_REGISTER_OBJECT_TYPE(RecordReaderNode);
+TVM_REGISTER_OBJECT_TYPE(IndexedRecordReaderNode);
 
 const std::string AUTO_SCHEDULER_LOG_VERSION = "v0.2";  // NOLINT(*)
 
@@ -311,6 +317,250 @@ std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordReaderNode::ReadLines
   return std::make_pair(inputs, results);
 }
 
+/*
+ * The indexed binary log format. All sections start at 8-byte aligned offsets, and all offsets
+ * inside a section are relative to the start of that section.
+ * {
+ *   IndexedRecordHeader header;
+ *   char    records[];                 // the json lines of all records, in the input order
+ *   char    strings[];                 // the workload keys and target kinds
+ *   IndexedRecordKey   keys[num_keys]; // sorted by workload key
+ *   IndexedRecordEntry entries[];      // the entries of a key sorted by cost, failures last
+ * }
+ */
+static const char kIndexedRecordMagic[8] = {'T', 'V', 'M', 'A', 'S', 'I', 'D', 'X'};
+static const uint32_t kIndexedRecordVersion = 1;
+
+struct IndexedRecordHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_keys;
+  uint64_t num_records;
+  uint64_t records_offset;
+  uint64_t strings_offset;
+  uint64_t keys_offset;
+  uint64_t entries_offset;
+};
+
+struct IndexedRecordKey {
+  uint64_t name_offset;
+  uint64_t name_length;
+  uint64_t first_entry;
+  uint64_t num_entries;
+};
+
+struct IndexedRecordEntry {
+  double cost;
+  int32_t error_no;
+  uint32_t record_length;
+  uint64_t record_offset;
+  uint64_t target_kind_offset;
+  uint64_t target_kind_length;
+};
+
+static_assert(sizeof(IndexedRecordHeader) == 56, "Unexpected padding in IndexedRecordHeader");
+static_assert(sizeof(IndexedRecordKey) == 32, "Unexpected padding in IndexedRecordKey");
+static_assert(sizeof(IndexedRecordEntry) == 40, "Unexpected padding in IndexedRecordEntry");
+
+// Pad a file being written to an 8-byte boundary and return the new offset.
+static uint64_t AlignIndexedRecordFile(std::ofstream* ofs, uint64_t offset) {
+  static const char zeros[8] = {0};
+  uint64_t aligned = (offset + 7) / 8 * 8;
+  ofs->write(zeros, aligned - offset);
+  return aligned;
+}
+
+void ConvertRecordsToIndexed(const std::string& json_filename,
+                             const std::string& indexed_filename) {
+  std::ifstream ifs(json_filename);
+  CHECK(ifs.is_open()) << "Cannot open " << json_filename;
+  std::ofstream ofs(indexed_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  CHECK(ofs.is_open()) << "Cannot open " << indexed_filename;
+
+  IndexedRecordHeader header;
+  std::memset(&header, 0, sizeof(header));
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  // Stream the records to the file and only keep their entries in memory
+  std::map<std::string, std::vector<IndexedRecordEntry>> entries_by_key;
+  std::map<std::string, uint64_t> string_offsets;
+  std::string strings;
+  auto intern = [&string_offsets, &strings](const std::string& str) {
+    auto it = string_offsets.find(str);
+    if (it != string_offsets.end()) {
+      return it->second;
+    }
+    uint64_t offset = strings.size();
+    strings += str;
+    string_offsets[str] = offset;
+    return offset;
+  };
+
+  header.records_offset = sizeof(header);
+  uint64_t records_size = 0;
+  std::string line, log_version;
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#' || line[0] == ' ') {
+      continue;
+    }
+    ReadMeasureRecord(line, inp.get(), res.get(), &log_version);
+    line += "\n";
+    CHECK_LE(line.size(), std::numeric_limits<uint32_t>::max());
+
+    IndexedRecordEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.error_no = res->error_no;
+    entry.cost = res->error_no == static_cast<int>(MeasureErrorNO::kNoError)
+                     ? FloatArrayMean(res->costs)
+                     : std::numeric_limits<double>::infinity();
+    entry.record_offset = records_size;
+    entry.record_length = static_cast<uint32_t>(line.size());
+    const std::string& target_kind = inp->task->target->kind->name;
+    entry.target_kind_offset = intern(target_kind);
+    entry.target_kind_length = target_kind.size();
+    entries_by_key[inp->task->workload_key].push_back(entry);
+
+    ofs.write(line.data(), line.size());
+    records_size += line.size();
+    header.num_records++;
+  }
+
+  // The keys are sorted by the map, the entries are sorted by cost
+  std::vector<IndexedRecordKey> keys;
+  std::vector<IndexedRecordEntry> entries;
+  for (auto& kv : entries_by_key) {
+    std::stable_sort(kv.second.begin(), kv.second.end(),
+                     [](const IndexedRecordEntry& a, const IndexedRecordEntry& b) {
+                       return a.cost < b.cost;
+                     });
+    IndexedRecordKey key;
+    key.name_offset = intern(kv.first);
+    key.name_length = kv.first.size();
+    key.first_entry = entries.size();
+    key.num_entries = kv.second.size();
+    keys.push_back(key);
+    entries.insert(entries.end(), kv.second.begin(), kv.second.end());
+  }
+  header.num_keys = static_cast<uint32_t>(keys.size());
+
+  uint64_t offset = AlignIndexedRecordFile(&ofs, header.records_offset + records_size);
+  header.strings_offset = offset;
+  ofs.write(strings.data(), strings.size());
+  offset = AlignIndexedRecordFile(&ofs, offset + strings.size());
+  header.keys_offset = offset;
+  ofs.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(IndexedRecordKey));
+  offset += keys.size() * sizeof(IndexedRecordKey);
+  header.entries_offset = offset;
+  ofs.write(reinterpret_cast<const char*>(entries.data()),
+            entries.size() * sizeof(IndexedRecordEntry));
+
+  // Only mark the file as indexed once everything else is written
+  std::memcpy(header.magic, kIndexedRecordMagic, sizeof(header.magic));
+  header.version = kIndexedRecordVersion;
+  ofs.seekp(0);
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  CHECK(ofs.good()) << "Failed to write " << indexed_filename;
+}
+
+bool IsIndexedRecordFile(const std::string& filename) {
+  std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+  char magic[sizeof(kIndexedRecordMagic)];
+  if (!ifs.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return std::memcmp(magic, kIndexedRecordMagic, sizeof(magic)) == 0;
+}
+
+// Get the header of a mapped indexed file, after checking that its sections are in bounds.
+static const IndexedRecordHeader* GetIndexedRecordHeader(const runtime::MappedFile& file,
+                                                         const std::string& filename) {
+  CHECK_GE(file.size(), sizeof(IndexedRecordHeader)) << filename << " is not an indexed log";
+  const auto* header = reinterpret_cast<const IndexedRecordHeader*>(file.data());
+  CHECK(std::memcmp(header->magic, kIndexedRecordMagic, sizeof(header->magic)) == 0)
+      << filename << " is not an indexed log";
+  CHECK_EQ(header->version, kIndexedRecordVersion)
+      << filename << " is in an unsupported version of the indexed log format";
+  CHECK(header->records_offset <= header->strings_offset &&
+        header->strings_offset <= header->keys_offset &&
+        header->keys_offset + header->num_keys * sizeof(IndexedRecordKey) ==
+            header->entries_offset &&
+        header->entries_offset + header->num_records * sizeof(IndexedRecordEntry) ==
+            file.size())
+      << filename << " is a corrupted indexed log";
+  return header;
+}
+
+IndexedRecordReader::IndexedRecordReader(String filename) {
+  auto node = make_object<IndexedRecordReaderNode>();
+  node->filename = filename;
+  node->file_ = std::make_shared<runtime::MappedFile>(filename);
+  GetIndexedRecordHeader(*node->file_, filename);
+  data_ = std::move(node);
+}
+
+std::pair<Array<MeasureInput>, Array<MeasureResult>> IndexedRecordReaderNode::ReadTopK(
+    const std::string& workload_key, int k, const std::string& target_kind) const {
+  const char* data = file_->data();
+  const auto* header = reinterpret_cast<const IndexedRecordHeader*>(data);
+  const char* records = data + header->records_offset;
+  const char* strings = data + header->strings_offset;
+  const auto* keys = reinterpret_cast<const IndexedRecordKey*>(data + header->keys_offset);
+  const auto* entries = reinterpret_cast<const IndexedRecordEntry*>(data + header->entries_offset);
+  auto name_of = [strings](const IndexedRecordKey& key) {
+    return std::string(strings + key.name_offset, key.name_length);
+  };
+
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  const IndexedRecordKey* key = std::lower_bound(
+      keys, keys + header->num_keys, workload_key,
+      [&name_of](const IndexedRecordKey& a, const std::string& b) { return name_of(a) < b; });
+  if (key == keys + header->num_keys || name_of(*key) != workload_key) {
+    return std::make_pair(inputs, results);
+  }
+
+  std::string log_version;
+  for (uint64_t i = 0; i < key->num_entries; ++i) {
+    if (k >= 0 && static_cast<int>(inputs.size()) >= k) {
+      break;
+    }
+    const IndexedRecordEntry& entry = entries[key->first_entry + i];
+    if (entry.error_no != static_cast<int>(MeasureErrorNO::kNoError)) {
+      // The failures are sorted after all successful records
+      break;
+    }
+    if (!target_kind.empty() &&
+        target_kind.compare(0, std::string::npos, strings + entry.target_kind_offset,
+                            entry.target_kind_length) != 0) {
+      continue;
+    }
+    CHECK_LE(header->records_offset + entry.record_offset + entry.record_length,
+             header->strings_offset)
+        << filename << " is a corrupted indexed log";
+    auto inp = make_object<MeasureInputNode>();
+    auto res = make_object<MeasureResultNode>();
+    ReadMeasureRecord(std::string(records + entry.record_offset, entry.record_length), inp.get(),
+                      res.get(), &log_version);
+    inputs.push_back(MeasureInput(inp));
+    results.push_back(MeasureResult(res));
+  }
+  return std::make_pair(inputs, results);
+}
+
+Array<String> IndexedRecordReaderNode::WorkloadKeys() const {
+  const char* data = file_->data();
+  const auto* header = reinterpret_cast<const IndexedRecordHeader*>(data);
+  const auto* keys = reinterpret_cast<const IndexedRecordKey*>(data + header->keys_offset);
+  Array<String> ret;
+  for (uint32_t i = 0; i < header->num_keys; ++i) {
+    const char* name = data + header->strings_offset + keys[i].name_offset;
+    ret.push_back(String(std::string(name, keys[i].name_length)));
+  }
+  return ret;
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.RecordToFile").set_body_typed([](const String& filename) {
   return RecordToFile(filename);
 });
@@ -340,5 +590,28 @@ TVM_REGISTER_GLOBAL("auto_scheduler.SaveRecords")
       std::ofstream ofs(filename, std::ofstream::app);
       WriteMeasureRecords(&ofs, in, res);
     });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ConvertRecordsToIndexed")
+    .set_body_typed([](String json_filename, String indexed_filename) {
+      ConvertRecordsToIndexed(json_filename, indexed_filename);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.IsIndexedRecordFile").set_body_typed([](String filename) {
+  return IsIndexedRecordFile(filename);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.IndexedRecordReader").set_body_typed([](String filename) {
+  return IndexedRecordReader(filename);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.IndexedRecordReaderReadTopK")
+    .set_body_typed([](IndexedRecordReader reader, String workload_key, int k,
+                       String target_kind) {
+      const auto& res = reader->ReadTopK(workload_key, k, target_kind);
+      return Array<ObjectRef>{res.first, res.second};
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.IndexedRecordReaderWorkloadKeys")
+    .set_body_typed([](IndexedRecordReader reader) { return reader->WorkloadKeys(); });
 }  // namespace auto_scheduler
 }  // namespace tvm
@@ -27,6 +27,7 @@
 #include "sketch_policy.h"
 
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 
 #include <algorithm>
 #include <iomanip>
@@ -47,6 +48,7 @@ namespace auto_scheduler {
 
 static RuleSkipStage rule_skip_stage;
 static RuleAlwaysInline rule_always_inline;
+static RuleTensorize rule_tensorize;
 static RuleMultiLevelTiling rule_multi_level_tiling;
 static RuleMultiLevelTilingWithFusion rule_multi_level_tiling_with_fusion;
 static RuleAddCacheRead rule_add_cache_read_stage;
@@ -95,6 +97,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel schedule_cost_model,
     // The default sketch rules for CPU policy
     node->sketch_rules.push_back(&rule_always_inline);
     node->sketch_rules.push_back(&rule_simplify_compute_with_const_tensor);
+    node->sketch_rules.push_back(&rule_tensorize);
     node->sketch_rules.push_back(&rule_add_rfactor);
     node->sketch_rules.push_back(&rule_add_cache_write_stage);
     node->sketch_rules.push_back(&rule_multi_level_tiling_with_fusion);
@@ -105,6 +108,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel schedule_cost_model,
     node->sketch_rules.push_back(&rule_always_inline);
     node->sketch_rules.push_back(&rule_special_compute_location_gpu);
     node->sketch_rules.push_back(&rule_simplify_compute_with_const_tensor);
+    node->sketch_rules.push_back(&rule_tensorize);
     node->sketch_rules.push_back(&rule_cross_thread_reduction);
     node->sketch_rules.push_back(&rule_add_cache_write_stage);
     node->sketch_rules.push_back(&rule_multi_level_tiling_with_fusion);
@@ -210,6 +214,48 @@ State SketchPolicyNode::Search(int n_trials, int early_stopping, int num_measure
   }
 }
 
+std::pair<Array<MeasureInput>, Array<MeasureResult>> SketchPolicyNode::ContinueSearchOneRound(
+    int num_measure, ProgramMeasurer measurer) {
+  num_measure_per_iter_ = num_measure;
+
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  int num_random =
+      static_cast<int>(GetDoubleParam(params, SketchParamKey::eps_greedy) * num_measure);
+
+  // Search one round to get promising states
+  PrintTitle("Search", verbose);
+  Array<State> random_states;
+  Array<State> best_states = SearchOneRound(num_random, &random_states);
+
+  // Infer bound. This is necessary for computing the correct ToStr() for redundancy check
+  best_states = search_task->compute_dag.InferBound(best_states);
+  random_states = search_task->compute_dag.InferBound(random_states);
+
+  // Pick `num_measure` states to measure, check hash to remove already measured state
+  // Also pick some random states to do eps-greedy
+  inputs = PickStatesWithEpsGreedy(best_states, random_states, num_measure);
+  if (inputs.empty()) {
+    return std::make_pair(std::move(inputs), std::move(results));
+  }
+
+  // Measure candidate states
+  PrintTitle("Measure", verbose);
+  measurer->Measure(search_task, GetRef<SearchPolicy>(this), inputs, &results);
+
+  // Update measured states throughputs. These states will join the EvolutionarySearch in later
+  // search rounds.
+  for (const auto& res : results) {
+    measured_states_throughputs_.push_back(1.0 / FloatArrayMean(res->costs));
+  }
+
+  // Retrain the cost model, which may be shared with the policies of other tasks
+  PrintTitle("Train cost model", verbose);
+  schedule_cost_model->Update(inputs, results);
+
+  return std::make_pair(std::move(inputs), std::move(results));
+}
+
 Array<State> SketchPolicyNode::SearchOneRound(int num_random_states, Array<State>* random_states) {
   // Temporal object to be used if the input pointer is nullptr
   Array<State> temp_random_states;
@@ -326,26 +372,42 @@ Array<State> SketchPolicyNode::SampleInitPopulation(const Array<State>& sketches
   Array<State> out_states;
   auto tic_begin = std::chrono::high_resolution_clock::now();
 
-  // TODO(jcf94, merrymercy): Use parallel_for to run this loop in parallel
   while (static_cast<int>(out_states.size()) < out_size && fail_ct < static_cast<int>(out_size)) {
-    // Random choose a starting sketch
-    // TODO(jcf94, merrymercy): Maybe choose sketches in different possibility for they may have
-    // different potential on generating state with better performance
-    State tmp_s = sketches[(rand_gen)() % sketches.size()];
-
-    // Derivation rule based enumeration
-    bool valid = true;
-    for (const auto& rule : init_rules) {
-      if (rule->Apply(this, &tmp_s) == InitPopulationRule::ResultKind::kInvalid) {
-        valid = false;
-        break;
-      }
+    // Sample a batch of the missing states in parallel. Every sample draws from its own random
+    // generator, seeded from the policy's in sample order, so the result for a given seed does
+    // not depend on the number of threads or on how the samples are scheduled on them.
+    int batch_size = out_size - static_cast<int>(out_states.size());
+    std::vector<std::mt19937> rand_gens;
+    rand_gens.reserve(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      rand_gens.push_back(std::mt19937(rand_gen()));
     }
 
-    if (valid) {
-      out_states.push_back(std::move(tmp_s));
-    } else {
-      fail_ct++;
+    std::vector<State> batch_states(batch_size, State());
+    support::parallel_for(0, batch_size, [this, &sketches, &rand_gens, &batch_states](int index) {
+      std::mt19937* sample_rand_gen = &rand_gens[index];
+      // Random choose a starting sketch
+      // TODO(jcf94, merrymercy): Maybe choose sketches in different possibility for they may have
+      // different potential on generating state with better performance
+      State tmp_s = sketches[(*sample_rand_gen)() % sketches.size()];
+
+      // Derivation rule based enumeration
+      for (const auto& rule : init_rules) {
+        if (rule->Apply(this, &tmp_s, sample_rand_gen) ==
+            InitPopulationRule::ResultKind::kInvalid) {
+          return;
+        }
+      }
+      batch_states[index] = std::move(tmp_s);
+    });
+
+    // Collect the valid states in sample order
+    for (auto& state : batch_states) {
+      if (state.defined()) {
+        out_states.push_back(std::move(state));
+      } else {
+        fail_ct++;
+      }
     }
   }
 
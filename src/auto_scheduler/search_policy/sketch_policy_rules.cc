@@ -24,6 +24,9 @@
 
 #include "sketch_policy_rules.h"
 
+#include <tvm/runtime/registry.h>
+#include <tvm/te/schedule_pass.h>
+
 #include <set>
 #include <string>
 #include <utility>
@@ -74,6 +77,75 @@ std::vector<std::pair<State, int>> RuleAlwaysInline::Apply(const SketchPolicyNod
   return {std::make_pair(std::move(tmp_s), stage_id - 1)};
 }
 
+/********** RuleTensorize **********/
+
+/*! \brief Get the tensor intrinsic attached to the op of a stage, or NullOpt. */
+static Optional<te::TensorIntrin> GetAttachedTensorIntrin(const Stage& stage) {
+  if (!stage->op->attrs.count(SearchPolicyKey::tensorize_intrin)) {
+    return NullOpt;
+  }
+  const auto* f =
+      runtime::Registry::Get(GetStringParam(stage->op->attrs, SearchPolicyKey::tensorize_intrin));
+  if (f == nullptr) {
+    return NullOpt;
+  }
+  te::TensorIntrin intrin = (*f)();
+  return intrin;
+}
+
+SketchGenerationRule::ConditionKind RuleTensorize::MeetCondition(const SketchPolicyNode& policy,
+                                                                 const State& state,
+                                                                 int stage_id) const {
+  const Stage& stage = state->stages[stage_id];
+  Optional<te::TensorIntrin> intrin = GetAttachedTensorIntrin(stage);
+  return intrin && stage->op->IsInstance<te::ComputeOpNode>() && !IsTiled(stage) &&
+                 te::MatchTensorIntrin(stage->op, intrin.value())
+             ? ConditionKind::kApplyAndSkipRest
+             : ConditionKind::kSkip;
+}
+
+std::vector<std::pair<State, int>> RuleTensorize::Apply(const SketchPolicyNode& policy,
+                                                        const State& state, int stage_id) const {
+  const Stage& stage = state->stages[stage_id];
+  te::TensorIntrin intrin = GetAttachedTensorIntrin(stage).value();
+  const auto* intrin_compute = intrin->op.as<te::ComputeOpNode>();
+  size_t num_space = 0;
+  for (const auto& iter : stage->iters) {
+    num_space += iter->iter_kind == IteratorKind::kSpatial;
+  }
+  size_t space_start = num_space - intrin_compute->axis.size();
+  size_t reduce_start = stage->iters.size() - intrin_compute->reduce_axis.size();
+
+  State tmp_s = state;
+  Array<Iterator> outer_space_iters, outer_reduce_iters, inner_iters;
+  for (size_t i = 0; i < stage->iters.size(); ++i) {
+    const Iterator& iter = stage->iters[i];
+    bool is_space = i < num_space;
+    if (i < space_start || (!is_space && i < reduce_start)) {
+      (is_space ? outer_space_iters : outer_reduce_iters).push_back(iter);
+      continue;
+    }
+    const te::IterVar& intrin_iv = is_space ? intrin_compute->axis[i - space_start]
+                                            : intrin_compute->reduce_axis[i - reduce_start];
+    int64_t length = *as_const_int(intrin_iv->dom->extent);
+    if (GetExtent(iter) == length) {
+      inner_iters.push_back(iter);
+    } else {
+      Array<Iterator> split_res = tmp_s.split(stage_id, iter, {Integer(length)});
+      (is_space ? outer_space_iters : outer_reduce_iters).push_back(split_res[0]);
+      inner_iters.push_back(split_res[1]);
+    }
+  }
+
+  Array<Iterator> new_order = outer_space_iters;
+  new_order.insert(new_order.end(), outer_reduce_iters.begin(), outer_reduce_iters.end());
+  new_order.insert(new_order.end(), inner_iters.begin(), inner_iters.end());
+  tmp_s.reorder(stage_id, new_order);
+  tmp_s.tensorize(stage_id, inner_iters[0]);
+
+  return {std::make_pair(tmp_s, stage_id - 1)};
+}
+
 /********** RuleMultiLevelTiling **********/
 
 SketchGenerationRule::ConditionKind RuleMultiLevelTiling::MeetCondition(
@@ -437,7 +509,7 @@ std::vector<std::pair<State, int>> RuleSpecialComputeLocationGPU::Apply(
 /********** Init Population **********/
 
 InitPopulationRule::ResultKind InitFillTileSize::Apply(SketchPolicyNode* policy,
-                                                       State* state) const {
+                                                       State* state, std::mt19937* rand_gen) const {
   StateNode* pstate = state->CopyOnWrite();
   // Scan the transformation history and randomly fill tiles size for all SplitStep
   for (size_t step_id = 0; step_id < (*state)->transform_steps.size(); ++step_id) {
@@ -458,7 +530,7 @@ InitPopulationRule::ResultKind InitFillTileSize::Apply(SketchPolicyNode* policy,
       const auto& candidate_lens = policy->split_memo.GetFactorizationSchemes(
           extent, ps->lengths.size(),
           GetIntParam(policy->params, SketchParamKey::max_innermost_split_factor));
-      const auto& candidate_lengths = candidate_lens[(policy->rand_gen)() % candidate_lens.size()];
+      const auto& candidate_lengths = candidate_lens[(*rand_gen)() % candidate_lens.size()];
 
       pstate->transform_steps.Set(
           step_id,
@@ -473,7 +545,8 @@ InitPopulationRule::ResultKind InitFillTileSize::Apply(SketchPolicyNode* policy,
 }
 
 InitPopulationRule::ResultKind InitChangeComputeLocation::Apply(SketchPolicyNode* policy,
-                                                                State* state) const {
+                                                                State* state,
+                                                                std::mt19937* rand_gen) const {
   if (GetIntParam(policy->params, SketchParamKey::disable_change_compute_location)) {
     return ResultKind::kValid;
   }
@@ -565,7 +638,7 @@ InitPopulationRule::ResultKind InitChangeComputeLocation::Apply(SketchPolicyNode
       }
     }
 
-    int choice = (policy->rand_gen)() % (candidates.size() + 2);
+    int choice = (*rand_gen)() % (candidates.size() + 2);
 
     if (choice == 0) {
       if (!HasReduceIter(stage)) {
@@ -588,7 +661,8 @@ InitPopulationRule::ResultKind InitChangeComputeLocation::Apply(SketchPolicyNode
   return ResultKind::kValid;
 }
 
-InitPopulationRule::ResultKind InitParallel::Apply(SketchPolicyNode* policy, State* state) const {
+InitPopulationRule::ResultKind InitParallel::Apply(SketchPolicyNode* policy,
+                                                   State* state, std::mt19937* rand_gen) const {
   std::function<void(const SketchPolicyNode&, State*, int stage_id, int iter_offset)>
       annotate_parallel;
   annotate_parallel = [&annotate_parallel](const SketchPolicyNode& policy, State* state,
@@ -652,7 +726,8 @@ InitPopulationRule::ResultKind InitParallel::Apply(SketchPolicyNode* policy, Sta
   return ResultKind::kValid;
 }
 
-InitPopulationRule::ResultKind InitUnroll::Apply(SketchPolicyNode* policy, State* state) const {
+InitPopulationRule::ResultKind InitUnroll::Apply(SketchPolicyNode* policy,
+                                                 State* state, std::mt19937* rand_gen) const {
   std::vector<int> auto_unroll_configs = IsGPUTask(policy->search_task)
                                              ? std::vector<int>({0, 16, 64, 512, 1024})
                                              : std::vector<int>({0, 16, 64, 512});
@@ -694,7 +769,7 @@ InitPopulationRule::ResultKind InitUnroll::Apply(SketchPolicyNode* policy, State
 
     if (HasReduceIter(stage)) {
       // Use auto unroll for multi level tiled stage
-      int value = auto_unroll_configs[(policy->rand_gen)() % auto_unroll_configs.size()];
+      int value = auto_unroll_configs[(*rand_gen)() % auto_unroll_configs.size()];
       state->pragma(stage_id, (*state)->stages[stage_id]->iters[0],
                     std::string("auto_unroll_max_step") + "$" + std::to_string(value));
     }
@@ -704,7 +779,8 @@ InitPopulationRule::ResultKind InitUnroll::Apply(SketchPolicyNode* policy, State
 }
 
 InitPopulationRule::ResultKind InitVectorization::Apply(SketchPolicyNode* policy,
-                                                        State* state) const {
+                                                        State* state,
+                                                        std::mt19937* rand_gen) const {
   for (size_t stage_id = 0; stage_id < (*state)->stages.size(); ++stage_id) {
     const Stage& stage = (*state)->stages[stage_id];
     // Skip the inlined stage and placeholder stage
@@ -712,6 +788,11 @@ InitPopulationRule::ResultKind InitVectorization::Apply(SketchPolicyNode* policy
       continue;
     }
 
+    // Skip the tensorized stage, whose inner loops belong to the tensor intrinsic
+    if (HasTensorizedIterator(stage)) {
+      continue;
+    }
+
     // Try to fuse and vectorize the space iterators in the inner most tile
     int64_t cum_length_prod = 1;
 
@@ -748,7 +829,7 @@ InitPopulationRule::ResultKind InitVectorization::Apply(SketchPolicyNode* policy
 
     if (num_fusible > 1) {
       // Select a random range to fuse
-      num_fusible = 1 + (policy->rand_gen)() % (num_fusible - 1);
+      num_fusible = 1 + (*rand_gen)() % (num_fusible - 1);
     }
 
     if (num_fusible == 1) {
@@ -762,7 +843,8 @@ InitPopulationRule::ResultKind InitVectorization::Apply(SketchPolicyNode* policy
   return ResultKind::kValid;
 }
 
-InitPopulationRule::ResultKind InitThreadBind::Apply(SketchPolicyNode* policy, State* state) const {
+InitPopulationRule::ResultKind InitThreadBind::Apply(SketchPolicyNode* policy,
+                                                     State* state, std::mt19937* rand_gen) const {
   std::set<int> multi_level_tiling_root_set;
   for (size_t stage_id = 0; stage_id < (*state)->stages.size(); ++stage_id) {
     if (NeedsMultilevelTiling(policy->search_task, *state, stage_id)) {
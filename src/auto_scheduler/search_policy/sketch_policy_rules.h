@@ -27,6 +27,7 @@
 
 #include <tvm/auto_scheduler/loop_state.h>
 
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -92,6 +93,10 @@ DEFINE_SKETCH_GENERATION_RULE(RuleSkipStage);
  */
 DEFINE_SKETCH_GENERATION_RULE(RuleAlwaysInline);
 
+/*! \brief The rule that splits a stage by the extents of the tensor intrinsic attached to its op
+ * and tensorizes the inner loops. */
+DEFINE_SKETCH_GENERATION_RULE(RuleTensorize);
+
 /*! \brief The rule that performs multi-level tiling. */
 DEFINE_SKETCH_GENERATION_RULE(RuleMultiLevelTiling);
 
@@ -130,17 +135,20 @@ class InitPopulationRule {
   /*!
    * \brief Apply function of this rule.
    * \param policy The SketchPolicyNode of this rule, some member may get changed during the
-   * rule applying. (e.g. random number generator)
+   * rule applying. (e.g. the split factorization memo)
    * \param state The state to apply this rule, update inplace.
+   * \param rand_gen The random number generator of this sample. Rules may be applied to several
+   * states in parallel, so each of them draws from its own generator rather than the policy's.
    * \return The result of this rule, indicate if there's any valid state generated.
    */
-  virtual ResultKind Apply(SketchPolicyNode* policy, State* state) const = 0;
+  virtual ResultKind Apply(SketchPolicyNode* policy, State* state,
+                           std::mt19937* rand_gen) const = 0;
 };
 
-#define DEFINE_INIT_POPULATION_RULE(rule_name)                            \
-  class rule_name : public InitPopulationRule {                           \
-   public:                                                                \
-    ResultKind Apply(SketchPolicyNode* policy, State* state) const final; \
+#define DEFINE_INIT_POPULATION_RULE(rule_name)                                                   \
+  class rule_name : public InitPopulationRule {                                                  \
+   public:                                                                                       \
+    ResultKind Apply(SketchPolicyNode* policy, State* state, std::mt19937* rand_gen) const final; \
   };
 
 /*! \brief The rule that fills the incomplete SplitSteps. */
@@ -272,6 +272,7 @@ State FollowTiling(const State& state, int stage_id, const std::vector<int>& spl
 
 const Array<Array<Integer>>& SplitFactorizationMemo::GetFactorizationSchemes(
     int extent, int n_lengths, int max_innermost_factor) {
+  std::lock_guard<std::mutex> lock(mutex_);
   QueryKey key = std::make_tuple(extent, n_lengths, max_innermost_factor);
   auto it = memory_.find(key);
   if (it != memory_.end()) {
@@ -293,7 +294,7 @@ void SplitFactorizationMemo::DfsEnumerate(int now, int remaining_lenght, int max
       results_->push_back(tmp_stack_);
     }
   } else {
-    for (const auto& f : GetFactors(remaining_lenght)) {
+    for (const auto& f : GetFactorsUnlocked(remaining_lenght)) {
       tmp_stack_.Set(now, Integer(f));
       DfsEnumerate(now + 1, remaining_lenght / f, max_innermost_factor);
     }
@@ -301,6 +302,11 @@ void SplitFactorizationMemo::DfsEnumerate(int now, int remaining_lenght, int max
 }
 
 const std::vector<int>& SplitFactorizationMemo::GetFactors(int n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return GetFactorsUnlocked(n);
+}
+
+const std::vector<int>& SplitFactorizationMemo::GetFactorsUnlocked(int n) {
   auto it = factor_memory_.find(n);
   if (it != factor_memory_.end()) {
     return it->second;
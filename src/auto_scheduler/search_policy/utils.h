@@ -32,6 +32,7 @@
 #include <tvm/te/operation.h>
 
 #include <algorithm>
+#include <mutex>
 #include <set>
 #include <string>
 #include <tuple>
@@ -479,6 +480,16 @@ inline bool IsTiled(const Stage& stage) {
   return stage->iters.size() != op->axis.size() + op->reduce_axis.size();
 }
 
+/*! \brief Return whether the stage has an iterator annotated with tensorize. */
+inline bool HasTensorizedIterator(const Stage& stage) {
+  for (const auto& iter : stage->iters) {
+    if (iter->annotation == IteratorAnnotation::kTensorize) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /*! \brief Extract primitive iterators from a nested fused or splitted iterator's name. */
 inline void ExtractOriginalIterators(const std::string& name, std::set<std::string>* rets) {
   size_t last_pos = 0;
@@ -630,12 +641,17 @@ class SplitFactorizationMemo {
  public:
   using QueryKey = std::tuple<int, int, int>;
 
+  // These are thread-safe, the init population rules query them from several threads.
+  // The returned references stay valid as the memorized results are never erased.
   const Array<Array<Integer>>& GetFactorizationSchemes(int extent, int n_lengths,
                                                        int max_innermost_factor);
   const std::vector<int>& GetFactors(int n);
 
  private:
   void DfsEnumerate(int now, int remaining_lenght, int max_innermost_factor);
+  const std::vector<int>& GetFactorsUnlocked(int n);
+
+  std::mutex mutex_;
 
   std::unordered_map<QueryKey, Array<Array<Integer>>> memory_;
 
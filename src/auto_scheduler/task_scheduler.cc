@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/task_scheduler.cc
+ * \brief The gradient based task scheduler.
+ */
+
+#include <tvm/auto_scheduler/task_scheduler.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <utility>
+
+#include "utils.h"
+
+namespace tvm {
+namespace auto_scheduler {
+
+/*! \brief The latency of a task without any valid measured program. */
+static constexpr double kMaxTaskCost = 1e10;
+
+TVM_REGISTER_NODE_TYPE(TaskSchedulerNode);
+
+TaskScheduler::TaskScheduler(Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                             Array<FloatImm> task_weights, double alpha, int backward_window_size,
+                             double eps_random, int seed, int verbose) {
+  CHECK_EQ(tasks.size(), search_policies.size())
+      << "Every task should have exactly one search policy.";
+  if (task_weights.empty()) {
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      task_weights.push_back(FloatImm(DataType::Float(64), 1.0));
+    }
+  }
+  CHECK_EQ(tasks.size(), task_weights.size()) << "Every task should have exactly one weight.";
+  CHECK_GT(backward_window_size, 0);
+
+  auto node = make_object<TaskSchedulerNode>();
+  node->tasks = std::move(tasks);
+  node->search_policies = std::move(search_policies);
+  node->task_weights = std::move(task_weights);
+  node->alpha = alpha;
+  node->backward_window_size = backward_window_size;
+  node->eps_random = eps_random;
+  node->verbose = verbose;
+  node->rand_gen = std::mt19937(seed);
+  data_ = std::move(node);
+}
+
+void TaskSchedulerNode::Tune(const TuningOptions& tuning_options) {
+  int num_tasks = tasks.size();
+  if (num_tasks == 0 || tuning_options->num_measure_trials <= 0) {
+    return;
+  }
+
+  // All the tasks share one measurer, which tracks the best state of each workload key
+  ProgramMeasurer measurer(tuning_options->builder, tuning_options->runner,
+                           tuning_options->measure_callbacks, verbose, -1,
+                           tuning_options->measure_pipeline_depth);
+  measurer->Reset();
+
+  early_stopping_ = tuning_options->early_stopping < 0 ? std::numeric_limits<int>::max() >> 1
+                                                        : tuning_options->early_stopping;
+  cost_histories_.assign(num_tasks, std::vector<double>());
+  dead_tasks_.assign(num_tasks, false);
+  measure_cts_.assign(num_tasks, 0);
+  best_measure_cts_.assign(num_tasks, 0);
+  best_costs = Array<FloatImm>(num_tasks, FloatImm(DataType::Float(64), kMaxTaskCost));
+  task_cts = Array<Integer>(num_tasks, Integer(0));
+
+  int num_measure_trials = tuning_options->num_measure_trials;
+  int num_measures_per_round = std::max(
+      1, std::min(tuning_options->num_measures_per_round, num_measure_trials / num_tasks));
+
+  int ct = 0;
+  // Warm up with one round of every task, so that all of them have a latency to start with
+  for (int i = 0; i < num_tasks && ct < num_measure_trials; ++i) {
+    ct += TuneTaskOneRound(i, std::min(num_measures_per_round, num_measure_trials - ct), measurer);
+  }
+
+  while (ct < num_measure_trials) {
+    int task_id = PickNextTask();
+    if (task_id < 0) {
+      StdCout(verbose) << "All tasks stopped early or ran out of candidates." << std::endl;
+      break;
+    }
+    ct += TuneTaskOneRound(task_id, std::min(num_measures_per_round, num_measure_trials - ct),
+                           measurer);
+  }
+}
+
+int TaskSchedulerNode::TuneTaskOneRound(int task_id, int num_measure,
+                                        const ProgramMeasurer& measurer) {
+  const SearchTask& task = tasks[task_id];
+  int num_measured = search_policies[task_id]->ContinueSearchOneRound(num_measure, measurer)
+                         .first.size();
+  measure_cts_[task_id] += num_measured;
+  task_cts.Set(task_id, Integer(task_cts[task_id]->value + 1));
+
+  double best_cost = kMaxTaskCost;
+  auto it = measurer->best_flops.find(task->workload_key);
+  if (it != measurer->best_flops.end() && it->second > 0) {
+    best_cost = task->compute_dag->flop_ct / it->second;
+  }
+  if (best_cost < best_costs[task_id]->value) {
+    best_measure_cts_[task_id] = measure_cts_[task_id];
+  }
+  best_costs.Set(task_id, FloatImm(DataType::Float(64), best_cost));
+  cost_histories_[task_id].push_back(best_cost);
+
+  if (num_measured == 0) {
+    StdCout(verbose) << "Task " << task_id << " has no more candidates to measure." << std::endl;
+    dead_tasks_[task_id] = true;
+  } else if (measure_cts_[task_id] - best_measure_cts_[task_id] > early_stopping_) {
+    StdCout(verbose) << "Task " << task_id << " stops early since no performance improvement in "
+                     << "the last " << early_stopping_ << " measure steps." << std::endl;
+    dead_tasks_[task_id] = true;
+  }
+
+  double total_cost = 0.0;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    total_cost += task_weights[i]->value * best_costs[i]->value;
+  }
+  StdCout(verbose) << std::fixed << std::setprecision(4) << "Task " << task_id
+                   << "\tRounds: " << task_cts[task_id]->value
+                   << "\tBest latency (ms): " << best_cost * 1e3
+                   << "\tWeighted total latency (ms): " << total_cost * 1e3 << std::endl;
+  return num_measured;
+}
+
+int TaskSchedulerNode::PickNextTask() {
+  std::vector<int> alive_tasks;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (!dead_tasks_[i]) {
+      alive_tasks.push_back(i);
+    }
+  }
+  if (alive_tasks.empty()) {
+    return -1;
+  }
+
+  std::uniform_real_distribution<double> dis(0.0, 1.0);
+  if (dis(rand_gen) < eps_random) {
+    return alive_tasks[rand_gen() % alive_tasks.size()];
+  }
+
+  // The objective is the weighted sum of the task latencies, so its gradient with respect to the
+  // latency of a task is the task weight. Multiply it by the estimated latency change of one more
+  // round, a mix of the improvement over the last rounds and an optimistic guess that the next
+  // round improves as much as an average round so far.
+  int best_task = -1;
+  double best_gradient = std::numeric_limits<double>::max();
+  double worst_gradient = std::numeric_limits<double>::lowest();
+  for (int i : alive_tasks) {
+    const std::vector<double>& history = cost_histories_[i];
+    int rounds = history.size();
+    double cost = history.back();
+
+    double backward_gradient = 0.0;
+    if (rounds > backward_window_size) {
+      backward_gradient =
+          (cost - history[rounds - 1 - backward_window_size]) / backward_window_size;
+    }
+    double forward_gradient = -cost / rounds;
+    double gradient = task_weights[i]->value *
+                      (alpha * backward_gradient + (1 - alpha) * forward_gradient);
+
+    if (gradient < best_gradient) {
+      best_gradient = gradient;
+      best_task = i;
+    }
+    worst_gradient = std::max(worst_gradient, gradient);
+  }
+
+  // No task looks better than the others, e.g. no task has a valid program yet
+  if (best_gradient == worst_gradient) {
+    return alive_tasks[rand_gen() % alive_tasks.size()];
+  }
+  return best_task;
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskScheduler")
+    .set_body_typed([](Array<SearchTask> tasks, Array<SearchPolicy> search_policies,
+                       Array<FloatImm> task_weights, double alpha, int backward_window_size,
+                       double eps_random, int seed, int verbose) {
+      return TaskScheduler(tasks, search_policies, task_weights, alpha, backward_window_size,
+                           eps_random, seed, verbose);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TaskSchedulerTune")
+    .set_body_typed([](TaskScheduler task_scheduler, TuningOptions tuning_options) {
+      task_scheduler->Tune(tuning_options);
+    });
+
+}  // namespace auto_scheduler
+}  // namespace tvm
@@ -25,6 +25,7 @@
 
 #include <tvm/auto_scheduler/compute_dag.h>
 #include <tvm/auto_scheduler/loop_state.h>
+#include <tvm/auto_scheduler/search_policy.h>
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
@@ -304,6 +305,21 @@ void AnnotationStepNode::WriteToRecord(dmlc::JSONWriter* writer) const {
   writer->WriteArrayItem(static_cast<int>(annotation));
 }
 
+/*!
+ * \brief Get the tensor intrinsic named by the tensorize_intrin attribute of an operation.
+ * \param op The operation.
+ * \return The name of the global function and the tensor intrinsic it returns.
+ */
+static std::pair<String, te::TensorIntrin> GetTensorizeIntrin(const te::Operation& op) {
+  auto it = op->attrs.find(SearchPolicyKey::tensorize_intrin);
+  CHECK(it != op->attrs.end()) << "Stage " << op->name << " has no tensor intrinsic attached";
+  String name = Downcast<String>((*it).second);
+  const auto* f = runtime::Registry::Get(name);
+  CHECK(f != nullptr) << "Cannot find the tensor intrinsic function " << name;
+  te::TensorIntrin intrin = (*f)();
+  return std::make_pair(name, intrin);
+}
+
 Iterator AnnotationStepNode::ApplyToState(State* state) const {
   const Stage& stage = (*state)->stages[stage_id];
   Iterator it = stage->iters[iter_id];
@@ -341,6 +357,9 @@ void AnnotationStepNode::ApplyToSchedule(Array<te::Stage>* stages,
       stage.bind(axes[iter_id],
                  te::thread_axis(Range(), IteratorAnnotationString[static_cast<int>(annotation)]));
       break;
+    case IteratorAnnotation::kTensorize:
+      stage.tensorize(axes[iter_id], GetTensorizeIntrin(stage->op).second);
+      break;
     case IteratorAnnotation::kNone:
       break;
     default:
@@ -377,6 +396,9 @@ String AnnotationStepNode::PrintAsPythonAPI(Array<te::Stage>* stages,
     case IteratorAnnotation::kThreadZ:
       ss << "bind(";
       break;
+    case IteratorAnnotation::kTensorize:
+      ss << "tensorize(";
+      break;
     case IteratorAnnotation::kNone:
       break;
     default:
@@ -395,6 +417,9 @@ String AnnotationStepNode::PrintAsPythonAPI(Array<te::Stage>* stages,
       ss << ", tvm.thread_axis(\"" << IteratorAnnotationString[static_cast<int>(annotation)]
          << "\")";
       break;
+    case IteratorAnnotation::kTensorize:
+      ss << ", tvm.get_global_func(\"" << GetTensorizeIntrin(stage->op).first << "\")()";
+      break;
     default:
       break;
   }
@@ -24,9 +24,14 @@
 
 #include "touch_extractor.h"
 
+#include <tvm/support/parallel_for.h>
+
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <set>
+#include <string>
 #include <unordered_map>
 
 namespace tvm {
@@ -480,6 +485,36 @@ void GetCurveSampleFeatureFlatten(Stmt stmt, int sample_n, std::vector<float>* r
   }
 }
 
+/*!
+ * \brief Extract the features of several statements in parallel and pack them into one matrix.
+ * \param stmts The statements to be extracted
+ * \param extract The function extracting the flatten feature of one statement
+ * \return Two int32, the number of rows and columns, followed by the row-major float matrix.
+ *         Each row is the feature of one statement, zero-padded to the longest feature.
+ */
+std::string GetFeatureFlattenBatch(const Array<Stmt>& stmts,
+                                   std::function<void(const Stmt&, std::vector<float>*)> extract) {
+  std::vector<std::vector<float> > rows(stmts.size());
+  if (!stmts.empty()) {
+    support::parallel_for(0, stmts.size(), [&](int i) { extract(stmts[i], &rows[i]); });
+  }
+
+  size_t n_cols = 0;
+  for (const auto& row : rows) {
+    n_cols = std::max(n_cols, row.size());
+  }
+  int32_t shape[2] = {static_cast<int32_t>(rows.size()), static_cast<int32_t>(n_cols)};
+  std::string buffer(sizeof(shape) + sizeof(float) * rows.size() * n_cols, '\0');
+  std::memcpy(&buffer[0], shape, sizeof(shape));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (!rows[i].empty()) {
+      std::memcpy(&buffer[sizeof(shape) + sizeof(float) * i * n_cols], rows[i].data(),
+                  sizeof(float) * rows[i].size());
+    }
+  }
+  return buffer;
+}
+
 // register API for front end
 TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeature")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
@@ -520,5 +555,37 @@ TVM_REGISTER_GLOBAL("autotvm.feature.GetCurveSampleFeatureFlatten")
       *ret = arr;
     });
 
+TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeatureFlattenBatch")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      Array<Stmt> stmts = args[0];
+      bool take_log = args[1];
+
+      std::string buffer =
+          GetFeatureFlattenBatch(stmts, [take_log](const Stmt& stmt, std::vector<float>* row) {
+            GetItervarFeatureFlatten(stmt, take_log, row);
+          });
+
+      TVMByteArray arr;
+      arr.size = buffer.size();
+      arr.data = buffer.data();
+      *ret = arr;
+    });
+
+TVM_REGISTER_GLOBAL("autotvm.feature.GetCurveSampleFeatureFlattenBatch")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      Array<Stmt> stmts = args[0];
+      int sample_n = args[1];
+
+      std::string buffer =
+          GetFeatureFlattenBatch(stmts, [sample_n](const Stmt& stmt, std::vector<float>* row) {
+            GetCurveSampleFeatureFlatten(stmt, sample_n, row);
+          });
+
+      TVMByteArray arr;
+      arr.size = buffer.size();
+      arr.data = buffer.data();
+      *ret = arr;
+    });
+
 }  // namespace autotvm
 }  // namespace tvm
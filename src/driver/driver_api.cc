@@ -26,6 +26,7 @@
 #include <tvm/ir/transform.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/target/codegen.h>
 #include <tvm/te/operation.h>
 #include <tvm/tir/analysis.h>
@@ -34,6 +35,9 @@
 #include <algorithm>
 #include <mutex>
 #include <stack>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 
@@ -165,6 +169,7 @@ IRModule lower(te::Schedule sch, const Array<te::Tensor>& args, const std::strin
   pass_list.push_back(tir::transform::BF16Legalize());
   pass_list.push_back(tir::transform::NarrowDataType(32));
   pass_list.push_back(tir::transform::Simplify());
+  pass_list.push_back(tir::transform::LoopUnswitching());
   pass_list.push_back(tir::transform::LoopPartition());
   pass_list.push_back(tir::transform::VectorizeLoop(!disable_vectorize));
   pass_list.push_back(tir::transform::InjectVirtualThread());
@@ -193,6 +198,8 @@ std::pair<IRModule, IRModule> SplitDevHostFuncs(IRModule mod_mixed, const Target
   if (pass_ctx->GetConfig<Bool>("tir.detect_global_barrier", Bool(false)).value()) {
     mixed_pass_list.push_back(tir::transform::ThreadSync("global"));
   }
+  mixed_pass_list.push_back(tir::transform::LowerTextureAccess());
+  mixed_pass_list.push_back(tir::transform::CoalesceGlobalAccess());
   mixed_pass_list.push_back(tir::transform::ThreadSync("shared"));
   mixed_pass_list.push_back(tir::transform::ThreadSync("warp"));
   mixed_pass_list.push_back(tir::transform::InferFragment());
@@ -217,7 +224,7 @@ std::pair<IRModule, IRModule> SplitDevHostFuncs(IRModule mod_mixed, const Target
   auto mhost = opt_host(mod_mixed);
 
   // device pipeline
-  auto device_pass_list = {
+  Array<tvm::transform::Pass> device_pass_list = {
       Filter([](const tir::PrimFunc& f) {
         return f->GetAttr<Integer>(tvm::attr::kCallingConv, Integer(CallingConv::kDefault)) ==
                CallingConv::kDeviceKernelLaunch;
@@ -225,9 +232,15 @@ std::pair<IRModule, IRModule> SplitDevHostFuncs(IRModule mod_mixed, const Target
       BindTarget(target),
       tir::transform::LowerWarpMemory(),
       tir::transform::Simplify(),
-      tir::transform::LowerIntrin(),
-      tir::transform::LowerDeviceStorageAccessInfo(),
   };
+  // Keep the same criterion as _build_for_device in python/tvm/driver/build_module.py.
+  if (target->kind->name == "cuda" || target->kind->name == "rocm") {
+    // 32-bit index arithmetic saves registers and instructions on these GPUs,
+    // narrow the indices introduced by the lowering after phase 1 as well.
+    device_pass_list.push_back(tir::transform::NarrowDataType(32));
+  }
+  device_pass_list.push_back(tir::transform::LowerIntrin());
+  device_pass_list.push_back(tir::transform::LowerDeviceStorageAccessInfo());
   auto opt_device = transform::Sequential(device_pass_list);
   auto mdevice = opt_device(mod_mixed);
 
@@ -248,9 +261,35 @@ std::pair<IRModule, IRModule> SplitDevHostFuncs(IRModule mod_mixed, const Target
   return {mhost, mdevice};
 }
 
+/*!
+ * \brief Split the functions of mod into at most num_parts modules.
+ *  Functions are ordered by name so the split does not depend on hash order.
+ * \param mod The module to be split.
+ * \param num_parts The maximum number of parts.
+ * \return The parts, each holding a consecutive range of functions.
+ */
+std::vector<IRModule> PartitionFuncs(const IRModule& mod, int num_parts) {
+  std::vector<std::pair<GlobalVar, BaseFunc>> funcs(mod->functions.begin(), mod->functions.end());
+  std::sort(funcs.begin(), funcs.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first->name_hint < rhs.first->name_hint;
+  });
+  size_t part_size = (funcs.size() + num_parts - 1) / num_parts;
+  std::vector<IRModule> parts;
+  for (size_t begin = 0; begin < funcs.size(); begin += part_size) {
+    Map<GlobalVar, BaseFunc> part;
+    for (size_t i = begin; i < std::min(begin + part_size, funcs.size()); ++i) {
+      part.Set(funcs[i].first, funcs[i].second);
+    }
+    parts.push_back(IRModule(part));
+  }
+  return parts;
+}
+
 // Build for heterogeneous execution.
 runtime::Module build(const Map<Target, IRModule>& inputs, const Target& target_host) {
   auto pass_ctx = transform::PassContext::Current();
+  int num_threads =
+      pass_ctx->GetConfig<Integer>("relay.backend.num_build_threads", Integer(1)).value();
 
   std::vector<runtime::Module> device_modules;
   Target target_host_val = target_host;
@@ -268,6 +307,8 @@ runtime::Module build(const Map<Target, IRModule>& inputs, const Target& target_
   }
 
   IRModule mhost_all = IRModule(Map<GlobalVar, BaseFunc>());
+  // The codegen jobs, device modules first and the host module(s) last.
+  std::vector<std::pair<IRModule, Target>> jobs;
 
   for (const auto& it : inputs) {
     auto pair = SplitDevHostFuncs(it.second, it.first, target_host_val, pass_ctx);
@@ -276,11 +317,42 @@ runtime::Module build(const Map<Target, IRModule>& inputs, const Target& target_
 
     mhost_all->Update(mhost);
     if (mdevice->functions.size() != 0) {
-      device_modules.push_back(codegen::Build(mdevice, it.first));
+      jobs.emplace_back(mdevice, it.first);
     }
   }
+  size_t num_device_jobs = jobs.size();
+
+  // Host functions fetch device kernels through the imports of their own
+  // module, so the host code can only be split when there is no device code.
+  // A system library registers one module, so it is not split either.
+  if (num_threads > 1 && num_device_jobs == 0 && target_host_val->kind->name == "llvm" &&
+      !target_host_val->GetAttr<Bool>("system-lib").value_or(Bool(false)) &&
+      mhost_all->functions.size() > 1) {
+    for (const auto& part : PartitionFuncs(mhost_all, num_threads)) {
+      jobs.emplace_back(part, target_host_val);
+    }
+  } else {
+    jobs.emplace_back(mhost_all, target_host_val);
+  }
+
+  std::vector<runtime::Module> modules(jobs.size());
+  auto build_job = [&](int i) {
+    // The pass context is thread local, hand the caller's one to the workers.
+    With<transform::PassContext> pass_ctx_scope(pass_ctx);
+    modules[i] = codegen::Build(jobs[i].first, jobs[i].second);
+  };
+  int num_jobs = static_cast<int>(jobs.size());
+  if (num_threads <= 1 || num_jobs <= 1) {
+    for (int i = 0; i < num_jobs; ++i) build_job(i);
+  } else {
+    support::parallel_for_dynamic(0, num_jobs, num_threads, [&](int, int i) { build_job(i); });
+  }
 
-  runtime::Module mhost = codegen::Build(mhost_all, target_host_val);
+  runtime::Module mhost = modules[num_device_jobs];
+  for (size_t i = num_device_jobs + 1; i < modules.size(); ++i) {
+    mhost.Import(modules[i]);
+  }
+  device_modules.assign(modules.begin(), modules.begin() + num_device_jobs);
   // Import all modules
   for (const auto& it : device_modules) {
     if (it.operator->()) {
@@ -28,8 +28,19 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
 #include <stack>
 #include <unordered_set>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 
 #include "../runtime/object_internal.h"
 
@@ -142,9 +153,174 @@ PassContext PassContext::Create() { return PassContext(make_object<PassContextNo
 
 void PassContext::Trace(const IRModule& module, const PassInfo& info, bool is_before) const {
   auto pass_ctx_node = this->operator->();
+  // keep the trace callback out of the measured time.
+  if (!is_before) this->Profile(module, info, is_before);
   if (pass_ctx_node->trace_func != nullptr) {
     pass_ctx_node->trace_func(module, info, is_before);
   }
+  if (is_before) this->Profile(module, info, is_before);
+}
+
+TVM_REGISTER_PASS_CONFIG_OPTION("ir.profile_passes", Bool);
+
+/*! \brief A pass that has started but not yet finished on the current thread. */
+struct PassProfileFrame {
+  /*! \brief The context the pass runs in. */
+  const PassContextNode* context;
+  /*! \brief The name of the pass. */
+  String name;
+  /*! \brief The start time of the pass. */
+  std::chrono::high_resolution_clock::time_point start;
+  /*! \brief Wall time spent in the passes nested in this one. */
+  double child_time_ms{0};
+  /*! \brief IR node count before the pass. */
+  int64_t nodes_before{0};
+  /*! \brief Resident set size before the pass. */
+  int64_t rss_before_kb{0};
+};
+
+struct PassProfileThreadLocalEntry {
+  /*! \brief The passes in progress, innermost last. */
+  std::vector<PassProfileFrame> frames;
+};
+
+typedef dmlc::ThreadLocalStore<PassProfileThreadLocalEntry> PassProfileThreadLocalStore;
+
+/*! \brief Count the distinct IR nodes reachable from the module. */
+class IRNodeCounter : public AttrVisitor {
+ public:
+  int64_t Count(const IRModule& module) {
+    Visit(module.get());
+    return static_cast<int64_t>(visited_.size());
+  }
+
+  void Visit(const char* key, double* value) final {}
+  void Visit(const char* key, int64_t* value) final {}
+  void Visit(const char* key, uint64_t* value) final {}
+  void Visit(const char* key, int* value) final {}
+  void Visit(const char* key, bool* value) final {}
+  void Visit(const char* key, std::string* value) final {}
+  void Visit(const char* key, void** value) final {}
+  void Visit(const char* key, DataType* value) final {}
+  void Visit(const char* key, runtime::NDArray* value) final {}
+  void Visit(const char* key, ObjectRef* value) final { Visit(value->get()); }
+
+ private:
+  void Visit(const Object* node) {
+    if (node == nullptr || !visited_.insert(node).second) return;
+    if (node->IsInstance<ArrayNode>()) {
+      for (const ObjectRef& elem : *static_cast<const ArrayNode*>(node)) {
+        Visit(elem.get());
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      for (const auto& kv : *static_cast<const MapNode*>(node)) {
+        Visit(kv.first.get());
+        Visit(kv.second.get());
+      }
+    } else if (!reflection_->GetReprBytes(node, nullptr)) {
+      reflection_->VisitAttrs(const_cast<Object*>(node), this);
+    }
+  }
+
+  std::unordered_set<const Object*> visited_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+};
+
+/*! \return The resident set size of the process in kilobytes, 0 when it is unknown. */
+static int64_t CurrentRSSKB() {
+#if defined(__linux__)
+  std::ifstream fin("/proc/self/statm");
+  int64_t size = 0, resident = 0;
+  if (fin >> size >> resident) {
+    return resident * static_cast<int64_t>(sysconf(_SC_PAGESIZE)) / 1024;
+  }
+#endif
+  return 0;
+}
+
+void PassContext::Profile(const IRModule& module, const PassInfo& info, bool is_before) const {
+  using Clock = std::chrono::high_resolution_clock;
+  const PassContextNode* node = this->operator->();
+  if (!node->GetConfig<Bool>("ir.profile_passes", Bool(false)).value()) return;
+  std::vector<PassProfileFrame>* frames = &PassProfileThreadLocalStore::Get()->frames;
+
+  if (is_before) {
+    PassProfileFrame frame;
+    frame.context = node;
+    frame.name = info->name;
+    frame.nodes_before = IRNodeCounter().Count(module);
+    frame.rss_before_kb = CurrentRSSKB();
+    frame.start = Clock::now();
+    frames->push_back(frame);
+    return;
+  }
+  Clock::time_point end = Clock::now();
+  // Frames above the match belong to passes that exited with an error, drop them.
+  auto it = std::find_if(frames->rbegin(), frames->rend(), [&](const PassProfileFrame& frame) {
+    return frame.context == node && frame.name == info->name;
+  });
+  if (it == frames->rend()) return;
+  PassProfileFrame frame = *it;
+  frames->erase(std::next(it).base(), frames->end());
+
+  auto profile = make_object<PassProfileNode>();
+  profile->name = frame.name;
+  profile->time_ms = std::chrono::duration<double, std::milli>(end - frame.start).count();
+  profile->self_time_ms = profile->time_ms - frame.child_time_ms;
+  profile->nodes_before = frame.nodes_before;
+  profile->nodes_after = IRNodeCounter().Count(module);
+  profile->rss_delta_kb = CurrentRSSKB() - frame.rss_before_kb;
+  for (auto parent = frames->rbegin(); parent != frames->rend(); ++parent) {
+    if (parent->context != node) continue;
+    if (profile->depth++ == 0) parent->child_time_ms += profile->time_ms;
+  }
+  // Worker threads may run passes in the same context concurrently.
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  node->pass_profiles.push_back(PassProfile(profile));
+}
+
+String PassContext::ProfileReport() const {
+  struct Summary {
+    std::string name;
+    int calls{0};
+    double time_ms{0};
+    double self_time_ms{0};
+    int64_t nodes_before{0};
+    int64_t nodes_after{0};
+    int64_t rss_delta_kb{0};
+  };
+  std::map<std::string, Summary> summary;
+  for (const PassProfile& profile : this->operator->()->pass_profiles) {
+    Summary& entry = summary[profile->name];
+    entry.name = profile->name;
+    // the first call is the reference point of the node counts.
+    if (entry.calls++ == 0) entry.nodes_before = profile->nodes_before;
+    entry.time_ms += profile->time_ms;
+    entry.self_time_ms += profile->self_time_ms;
+    entry.nodes_after = profile->nodes_after;
+    entry.rss_delta_kb += profile->rss_delta_kb;
+  }
+  std::vector<Summary> ranked;
+  for (const auto& kv : summary) ranked.push_back(kv.second);
+  std::stable_sort(ranked.begin(), ranked.end(), [](const Summary& lhs, const Summary& rhs) {
+    return lhs.self_time_ms > rhs.self_time_ms;
+  });
+
+  std::ostringstream os;
+  os << std::setw(4) << "Rank" << std::setw(12) << "Self(ms)" << std::setw(12) << "Total(ms)"
+     << std::setw(7) << "Calls" << std::setw(12) << "Nodes" << std::setw(12) << "Nodes(+/-)"
+     << std::setw(12) << "RSS(KB)"
+     << "  Pass\n";
+  os << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < ranked.size(); ++i) {
+    const Summary& entry = ranked[i];
+    os << std::setw(4) << i + 1 << std::setw(12) << entry.self_time_ms << std::setw(12)
+       << entry.time_ms << std::setw(7) << entry.calls << std::setw(12) << entry.nodes_after
+       << std::setw(12) << std::showpos << entry.nodes_after - entry.nodes_before
+       << std::setw(12) << entry.rss_delta_kb << std::noshowpos << "  " << entry.name << "\n";
+  }
+  return os.str();
 }
 
 class ModulePass;
@@ -362,6 +538,7 @@ Pass GetPass(const String& pass_name) {
 // a Sequential without the consideration of their orders. The phase
 // ordering problem needs to be handled in the future.
 IRModule SequentialNode::operator()(IRModule mod, const PassContext& pass_ctx) const {
+  pass_ctx.Profile(mod, pass_info, true);
   for (const Pass& pass : passes) {
     CHECK(pass.defined()) << "Found undefined pass for optimization.";
     const PassInfo& pass_info = pass->Info();
@@ -372,6 +549,7 @@ IRModule SequentialNode::operator()(IRModule mod, const PassContext& pass_ctx) c
     }
     mod = pass(std::move(mod), pass_ctx);
   }
+  pass_ctx.Profile(mod, pass_info, false);
   return mod;
 }
 
@@ -496,6 +674,11 @@ class PassContext::Internal {
   static void ExitScope(PassContext pass_ctx) { pass_ctx.ExitWithScope(); }
 };
 
+TVM_REGISTER_NODE_TYPE(PassProfileNode);
+
+TVM_REGISTER_GLOBAL("transform.PassContextProfileReport")
+    .set_body_typed([](PassContext pass_ctx) { return pass_ctx.ProfileReport(); });
+
 TVM_REGISTER_GLOBAL("transform.GetCurrentPassContext").set_body_typed(PassContext::Current);
 
 TVM_REGISTER_GLOBAL("transform.EnterPassContext").set_body_typed(PassContext::Internal::EnterScope);
@@ -32,8 +32,11 @@
 #include <tvm/runtime/registry.h>
 
 #include <cctype>
+#include <cstring>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../runtime/object_internal.h"
 #include "../support/base64.h"
@@ -283,6 +286,8 @@ class JSONAttrGetter : public AttrVisitor {
 class FieldDependencyFinder : public AttrVisitor {
  public:
   JSONNode* jnode_;
+  // When set, the indices of the tensors the node refers to are appended to it.
+  std::vector<size_t>* tensors_{nullptr};
   ReflectionVTable* reflection_ = ReflectionVTable::Global();
 
   std::string GetValue(const char* key) const {
@@ -308,7 +313,13 @@ class FieldDependencyFinder : public AttrVisitor {
   void Visit(const char* key, std::string* value) final {}
   void Visit(const char* key, void** value) final {}
   void Visit(const char* key, DataType* value) final {}
-  void Visit(const char* key, runtime::NDArray* value) final {}
+  void Visit(const char* key, runtime::NDArray* value) final {
+    if (tensors_ != nullptr) {
+      size_t index;
+      ParseValue(key, &index);
+      tensors_->push_back(index);
+    }
+  }
   void Visit(const char* key, ObjectRef* value) final {
     size_t index;
     ParseValue(key, &index);
@@ -535,6 +546,16 @@ std::string SaveJSON(const ObjectRef& n) {
   return os.str();
 }
 
+// Decode a tensor stored in the b64ndarrays of a json graph.
+static runtime::NDArray LoadB64NDArray(const std::string& blob) {
+  dmlc::MemoryStringStream mstrm(const_cast<std::string*>(&blob));
+  support::Base64InStream b64strm(&mstrm);
+  b64strm.InitPosition();
+  runtime::NDArray temp;
+  CHECK(temp.Load(&b64strm));
+  return temp;
+}
+
 ObjectRef LoadJSON(std::string json_str) {
   ReflectionVTable* reflection = ReflectionVTable::Global();
   JSONGraph jgraph;
@@ -549,12 +570,7 @@ ObjectRef LoadJSON(std::string json_str) {
   {
     // load in tensors
     for (const std::string& blob : jgraph.b64ndarrays) {
-      dmlc::MemoryStringStream mstrm(const_cast<std::string*>(&blob));
-      support::Base64InStream b64strm(&mstrm);
-      b64strm.InitPosition();
-      runtime::NDArray temp;
-      CHECK(temp.Load(&b64strm));
-      tensors.emplace_back(std::move(temp));
+      tensors.emplace_back(LoadB64NDArray(blob));
     }
   }
   // Pass 1: create all non-container objects
@@ -586,7 +602,595 @@ ObjectRef LoadJSON(std::string json_str) {
   return ObjectRef(nodes.at(jgraph.root));
 }
 
+class LazyJSONLoader::Impl {
+ public:
+  JSONGraph graph;
+  std::vector<ObjectPtr<Object>> nodes;
+  std::vector<runtime::NDArray> tensors;
+  // The load state of each node.
+  enum State : uint8_t { kNew, kCreated, kLoaded };
+  std::vector<State> state;
+
+  ObjectRef Get(size_t index) {
+    CHECK_LT(index, graph.nodes.size());
+    ReflectionVTable* reflection = ReflectionVTable::Global();
+    JSONAttrSetter setter;
+    setter.node_list_ = &nodes;
+    setter.tensor_list_ = &tensors;
+    // Create the nodes depth first, and set each of them once all its children are set.
+    std::vector<size_t> stack{index};
+    while (!stack.empty()) {
+      size_t i = stack.back();
+      JSONNode* jnode = &graph.nodes[i];
+      if (state[i] == kLoaded) {
+        stack.pop_back();
+      } else if (state[i] == kNew) {
+        if (jnode->type_key.length() != 0) {
+          nodes[i] = reflection->CreateInitObject(jnode->type_key, jnode->repr_bytes);
+        }
+        std::vector<size_t> tensor_fields;
+        FieldDependencyFinder dep_finder;
+        dep_finder.tensors_ = &tensor_fields;
+        dep_finder.Find(nodes[i].get(), jnode);
+        for (size_t t : tensor_fields) {
+          CHECK_LT(t, tensors.size());
+          if (!tensors[t].defined()) {
+            tensors[t] = LoadB64NDArray(graph.b64ndarrays[t]);
+            // The blob is no longer needed once decoded.
+            std::string().swap(graph.b64ndarrays[t]);
+          }
+        }
+        state[i] = kCreated;
+        for (const std::vector<size_t>* children : {&jnode->data, &jnode->fields}) {
+          for (size_t child : *children) {
+            CHECK_LT(child, graph.nodes.size());
+            CHECK_NE(state[child], kCreated) << "Cyclic reference detected in JSON file";
+            if (state[child] == kNew) {
+              stack.push_back(child);
+            }
+          }
+        }
+      } else {
+        setter.Set(&nodes[i], jnode);
+        state[i] = kLoaded;
+        stack.pop_back();
+      }
+    }
+    return ObjectRef(nodes[index]);
+  }
+};
+
+LazyJSONLoader::LazyJSONLoader(const std::string& json_str) : impl_(new Impl()) {
+  {
+    std::istringstream is(json_str);
+    dmlc::JSONReader reader(&is);
+    impl_->graph.Load(&reader);
+  }
+  CHECK_LT(impl_->graph.root, impl_->graph.nodes.size());
+  impl_->nodes.resize(impl_->graph.nodes.size());
+  impl_->tensors.resize(impl_->graph.b64ndarrays.size());
+  impl_->state.resize(impl_->graph.nodes.size(), Impl::kNew);
+}
+
+LazyJSONLoader::~LazyJSONLoader() {}
+
+size_t LazyJSONLoader::root() const { return impl_->graph.root; }
+
+const std::string& LazyJSONLoader::TypeKey(size_t node) const {
+  return impl_->graph.nodes.at(node).type_key;
+}
+
+const std::vector<std::string>& LazyJSONLoader::Keys(size_t node) const {
+  return impl_->graph.nodes.at(node).keys;
+}
+
+const std::vector<size_t>& LazyJSONLoader::Children(size_t node) const {
+  return impl_->graph.nodes.at(node).data;
+}
+
+ObjectRef LazyJSONLoader::Get(size_t node) { return impl_->Get(node); }
+
+// Binary format of a node graph.
+//
+// The nodes are numbered after their children, so each node only refers to
+// nodes already loaded and the graph is read back in a single pass. Strings,
+// including the type and field keys, are interned, and tensors are stored as
+// raw bytes.
+//
+//   uint64      : kTVMNodeBinaryMagic
+//   string      : TVM version
+//   varuint     : number of strings, followed by the strings
+//   varuint     : number of types, followed by for each type:
+//                   varuint : string index of the type key
+//                   uint8   : BinaryNodeKind
+//                   varuint : number of fields, followed by their key string index
+//   varuint     : number of tensors, followed by the tensors saved by SaveDLTensor
+//   varuint     : number of nodes, index 0 being None
+//   varuint     : index of the root
+//   [
+//     varuint   : type index
+//     ...       : repr bytes, container items or fields, depending on the kind
+//   ] * (number of nodes - 1)
+constexpr uint64_t kTVMNodeBinaryMagic = 0xF7E58D4F0049A574;
+
+/*! \brief How the content of a node is stored. */
+enum class BinaryNodeKind : uint8_t {
+  /*! \brief The fields visited by VisitAttrs. */
+  kFields = 0,
+  /*! \brief The repr bytes. */
+  kReprBytes = 1,
+  /*! \brief The indices of the items. */
+  kArray = 2,
+  /*! \brief The indices of the keys and values. */
+  kMap = 3,
+  /*! \brief The string indices of the keys and the indices of the values. */
+  kStrMap = 4,
+};
+
+/*! \brief Append only buffer with LEB128 integers. */
+class BinaryWriter {
+ public:
+  std::string data;
+
+  void WriteVarUInt(uint64_t value) {
+    while (value >= 0x80) {
+      data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    data.push_back(static_cast<char>(value));
+  }
+  void WriteVarInt(int64_t value) {
+    // zigzag encoding keeps small negative values short.
+    WriteVarUInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+  void WriteRaw(const void* ptr, size_t size) {
+    data.append(static_cast<const char*>(ptr), size);
+  }
+  void WriteString(const std::string& value) {
+    WriteVarUInt(value.size());
+    data.append(value);
+  }
+};
+
+/*! \brief Reader of the buffers written by BinaryWriter. */
+class BinaryReader {
+ public:
+  BinaryReader(const char* begin, const char* end) : ptr_(begin), end_(end) {}
+
+  uint64_t ReadVarUInt() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      CHECK(ptr_ < end_ && shift < 64) << "Corrupted binary node graph";
+      uint8_t byte = static_cast<uint8_t>(*ptr_++);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+  }
+  int64_t ReadVarInt() {
+    uint64_t value = ReadVarUInt();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+  /*! \brief Read an index smaller than bound. */
+  size_t ReadIndex(size_t bound) {
+    uint64_t value = ReadVarUInt();
+    CHECK_LT(value, bound) << "Corrupted binary node graph";
+    return static_cast<size_t>(value);
+  }
+  const char* ReadRaw(size_t size) {
+    CHECK_LE(size, static_cast<size_t>(end_ - ptr_)) << "Corrupted binary node graph";
+    const char* data = ptr_;
+    ptr_ += size;
+    return data;
+  }
+  template <typename T>
+  T ReadPOD() {
+    T value;
+    std::memcpy(&value, ReadRaw(sizeof(T)), sizeof(T));
+    return value;
+  }
+  std::string ReadString() {
+    size_t size = static_cast<size_t>(ReadVarUInt());
+    return std::string(ReadRaw(size), size);
+  }
+
+ private:
+  const char* ptr_;
+  const char* end_;
+};
+
+/*! \brief Interned strings of a binary node graph. */
+class StringTable {
+ public:
+  std::vector<std::string> strings;
+
+  size_t Intern(const std::string& value) {
+    auto it = index_.find(value);
+    if (it != index_.end()) return it->second;
+    index_[value] = strings.size();
+    strings.push_back(value);
+    return strings.size() - 1;
+  }
+
+ private:
+  std::unordered_map<std::string, size_t> index_;
+};
+
+// Index the nodes after their children.
+class BinaryNodeIndexer : public AttrVisitor {
+ public:
+  std::unordered_map<Object*, size_t> node_index_{{nullptr, 0}};
+  std::vector<Object*> node_list_{nullptr};
+  std::unordered_map<DLTensor*, size_t> tensor_index_;
+  std::vector<DLTensor*> tensor_list_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+
+  void Visit(const char* key, double* value) final {}
+  void Visit(const char* key, int64_t* value) final {}
+  void Visit(const char* key, uint64_t* value) final {}
+  void Visit(const char* key, int* value) final {}
+  void Visit(const char* key, bool* value) final {}
+  void Visit(const char* key, std::string* value) final {}
+  void Visit(const char* key, void** value) final {}
+  void Visit(const char* key, DataType* value) final {}
+
+  void Visit(const char* key, runtime::NDArray* value) final {
+    DLTensor* ptr = const_cast<DLTensor*>((*value).operator->());
+    if (tensor_index_.count(ptr)) return;
+    tensor_index_[ptr] = tensor_list_.size();
+    tensor_list_.push_back(ptr);
+  }
+
+  void Visit(const char* key, ObjectRef* value) final {
+    MakeIndex(const_cast<Object*>(value->get()));
+  }
+
+  void MakeIndex(Object* node) {
+    if (node == nullptr) return;
+    // Mark the node as visited, its index is known once its children are indexed.
+    if (!node_index_.emplace(node, 0).second) return;
+
+    if (node->IsInstance<ArrayNode>()) {
+      ArrayNode* n = static_cast<ArrayNode*>(node);
+      for (const auto& sp : *n) {
+        MakeIndex(const_cast<Object*>(sp.get()));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      MapNode* n = static_cast<MapNode*>(node);
+      for (const auto& kv : *n) {
+        if (!kv.first->IsInstance<StringObj>()) {
+          MakeIndex(const_cast<Object*>(kv.first.get()));
+        }
+        MakeIndex(const_cast<Object*>(kv.second.get()));
+      }
+    } else if (!reflection_->GetReprBytes(node, nullptr)) {
+      reflection_->VisitAttrs(node, this);
+    }
+    node_index_[node] = node_list_.size();
+    node_list_.push_back(node);
+  }
+};
+
+// Collect the field keys of a type.
+class FieldKeyCollector : public AttrVisitor {
+ public:
+  std::vector<std::string> keys;
+
+  void Visit(const char* key, double* value) final { keys.push_back(key); }
+  void Visit(const char* key, int64_t* value) final { keys.push_back(key); }
+  void Visit(const char* key, uint64_t* value) final { keys.push_back(key); }
+  void Visit(const char* key, int* value) final { keys.push_back(key); }
+  void Visit(const char* key, bool* value) final { keys.push_back(key); }
+  void Visit(const char* key, std::string* value) final { keys.push_back(key); }
+  void Visit(const char* key, void** value) final { keys.push_back(key); }
+  void Visit(const char* key, DataType* value) final { keys.push_back(key); }
+  void Visit(const char* key, runtime::NDArray* value) final { keys.push_back(key); }
+  void Visit(const char* key, ObjectRef* value) final { keys.push_back(key); }
+};
+
+/*! \brief A type of a binary node graph. */
+struct BinaryNodeType {
+  size_t type_key;
+  BinaryNodeKind kind;
+  std::vector<size_t> field_keys;
+};
+
+// Write the nodes of a graph.
+class BinaryAttrGetter : public AttrVisitor {
+ public:
+  const std::unordered_map<Object*, size_t>* node_index_;
+  const std::unordered_map<DLTensor*, size_t>* tensor_index_;
+  StringTable* strings_;
+  BinaryWriter* writer_;
+  std::unordered_map<uint64_t, size_t> type_index_;
+  std::vector<BinaryNodeType> types_;
+  ReflectionVTable* reflection_ = ReflectionVTable::Global();
+
+  void Visit(const char* key, double* value) final { writer_->WriteRaw(value, sizeof(double)); }
+  void Visit(const char* key, int64_t* value) final { writer_->WriteVarInt(*value); }
+  void Visit(const char* key, uint64_t* value) final { writer_->WriteVarUInt(*value); }
+  void Visit(const char* key, int* value) final { writer_->WriteVarInt(*value); }
+  void Visit(const char* key, bool* value) final { writer_->WriteVarUInt(*value); }
+  void Visit(const char* key, std::string* value) final {
+    writer_->WriteVarUInt(strings_->Intern(*value));
+  }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to serialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    DLDataType dtype = *value;
+    writer_->WriteRaw(&dtype, sizeof(dtype));
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    writer_->WriteVarUInt(tensor_index_->at(const_cast<DLTensor*>((*value).operator->())));
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    writer_->WriteVarUInt(node_index_->at(const_cast<Object*>(value->get())));
+  }
+
+  void Write(Object* node) {
+    std::string repr_bytes;
+    bool has_repr = reflection_->GetReprBytes(node, &repr_bytes);
+    bool is_str_map = false;
+    if (node->IsInstance<MapNode>()) {
+      MapNode* n = static_cast<MapNode*>(node);
+      is_str_map = std::all_of(n->begin(), n->end(), [](const auto& v) {
+        return v.first->template IsInstance<StringObj>();
+      });
+    }
+    writer_->WriteVarUInt(GetType(node, has_repr, is_str_map));
+    if (has_repr) {
+      writer_->WriteVarUInt(strings_->Intern(repr_bytes));
+    } else if (node->IsInstance<ArrayNode>()) {
+      ArrayNode* n = static_cast<ArrayNode*>(node);
+      writer_->WriteVarUInt(n->size());
+      for (const auto& sp : *n) {
+        writer_->WriteVarUInt(node_index_->at(const_cast<Object*>(sp.get())));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      MapNode* n = static_cast<MapNode*>(node);
+      writer_->WriteVarUInt(n->size());
+      for (const auto& kv : *n) {
+        if (is_str_map) {
+          writer_->WriteVarUInt(strings_->Intern(Downcast<String>(kv.first)));
+        } else {
+          writer_->WriteVarUInt(node_index_->at(const_cast<Object*>(kv.first.get())));
+        }
+        writer_->WriteVarUInt(node_index_->at(const_cast<Object*>(kv.second.get())));
+      }
+    } else {
+      reflection_->VisitAttrs(node, this);
+    }
+  }
+
+ private:
+  size_t GetType(Object* node, bool has_repr, bool is_str_map) {
+    // Maps of strings and of objects are stored differently.
+    uint64_t key = (static_cast<uint64_t>(node->type_index()) << 1) | is_str_map;
+    auto it = type_index_.find(key);
+    if (it != type_index_.end()) return it->second;
+    BinaryNodeType type;
+    type.type_key = strings_->Intern(node->GetTypeKey());
+    if (has_repr) {
+      type.kind = BinaryNodeKind::kReprBytes;
+    } else if (node->IsInstance<ArrayNode>()) {
+      type.kind = BinaryNodeKind::kArray;
+    } else if (node->IsInstance<MapNode>()) {
+      type.kind = is_str_map ? BinaryNodeKind::kStrMap : BinaryNodeKind::kMap;
+    } else {
+      type.kind = BinaryNodeKind::kFields;
+      FieldKeyCollector collector;
+      reflection_->VisitAttrs(node, &collector);
+      for (const std::string& field_key : collector.keys) {
+        type.field_keys.push_back(strings_->Intern(field_key));
+      }
+    }
+    type_index_[key] = types_.size();
+    types_.push_back(type);
+    return types_.size() - 1;
+  }
+};
+
+// Set the fields of a node, checking the field keys of each type once.
+class BinaryAttrSetter : public AttrVisitor {
+ public:
+  const std::vector<ObjectPtr<Object>>* node_list_;
+  const std::vector<runtime::NDArray>* tensor_list_;
+  const std::vector<std::string>* strings_;
+  BinaryReader* reader_;
+  /*! \brief The field keys to check, nullptr once the type was checked. */
+  const std::vector<size_t>* field_keys_;
+  size_t field_{0};
+
+  void CheckKey(const char* key) {
+    if (field_keys_ == nullptr) return;
+    CHECK(field_ < field_keys_->size() && strings_->at(field_keys_->at(field_++)) == key)
+        << "Binary node graph: the fields do not match this version of TVM at field " << key;
+  }
+  void Visit(const char* key, double* value) final {
+    CheckKey(key);
+    *value = reader_->ReadPOD<double>();
+  }
+  void Visit(const char* key, int64_t* value) final {
+    CheckKey(key);
+    *value = reader_->ReadVarInt();
+  }
+  void Visit(const char* key, uint64_t* value) final {
+    CheckKey(key);
+    *value = reader_->ReadVarUInt();
+  }
+  void Visit(const char* key, int* value) final {
+    CheckKey(key);
+    *value = static_cast<int>(reader_->ReadVarInt());
+  }
+  void Visit(const char* key, bool* value) final {
+    CheckKey(key);
+    *value = reader_->ReadVarUInt() != 0;
+  }
+  void Visit(const char* key, std::string* value) final {
+    CheckKey(key);
+    *value = strings_->at(reader_->ReadIndex(strings_->size()));
+  }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to deserialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    CheckKey(key);
+    *value = DataType(reader_->ReadPOD<DLDataType>());
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    CheckKey(key);
+    *value = tensor_list_->at(reader_->ReadIndex(tensor_list_->size()));
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    CheckKey(key);
+    *value = ObjectRef(node_list_->at(reader_->ReadIndex(node_list_->size())));
+  }
+};
+
+std::string SaveBinary(const ObjectRef& n) {
+  BinaryNodeIndexer indexer;
+  indexer.MakeIndex(const_cast<Object*>(n.get()));
+  StringTable strings;
+  BinaryWriter body;
+  BinaryAttrGetter getter;
+  getter.node_index_ = &indexer.node_index_;
+  getter.tensor_index_ = &indexer.tensor_index_;
+  getter.strings_ = &strings;
+  getter.writer_ = &body;
+  for (size_t i = 1; i < indexer.node_list_.size(); ++i) {
+    getter.Write(indexer.node_list_[i]);
+  }
+
+  BinaryWriter writer;
+  writer.WriteRaw(&kTVMNodeBinaryMagic, sizeof(kTVMNodeBinaryMagic));
+  writer.WriteString(TVM_VERSION);
+  writer.WriteVarUInt(strings.strings.size());
+  for (const std::string& str : strings.strings) {
+    writer.WriteString(str);
+  }
+  writer.WriteVarUInt(getter.types_.size());
+  for (const BinaryNodeType& type : getter.types_) {
+    writer.WriteVarUInt(type.type_key);
+    writer.WriteRaw(&type.kind, sizeof(type.kind));
+    writer.WriteVarUInt(type.field_keys.size());
+    for (size_t key : type.field_keys) {
+      writer.WriteVarUInt(key);
+    }
+  }
+  writer.WriteVarUInt(indexer.tensor_list_.size());
+  for (DLTensor* tensor : indexer.tensor_list_) {
+    std::string blob;
+    dmlc::MemoryStringStream mstrm(&blob);
+    runtime::SaveDLTensor(&mstrm, tensor);
+    writer.WriteString(blob);
+  }
+  writer.WriteVarUInt(indexer.node_list_.size());
+  writer.WriteVarUInt(indexer.node_index_.at(const_cast<Object*>(n.get())));
+  writer.data.append(body.data);
+  return std::move(writer.data);
+}
+
+ObjectRef LoadBinary(const std::string& bytes) {
+  ReflectionVTable* reflection = ReflectionVTable::Global();
+  BinaryReader reader(bytes.data(), bytes.data() + bytes.size());
+  CHECK(bytes.size() >= sizeof(uint64_t) && reader.ReadPOD<uint64_t>() == kTVMNodeBinaryMagic)
+      << "Not a binary node graph";
+  reader.ReadString();
+  std::vector<std::string> strings(reader.ReadVarUInt());
+  for (std::string& str : strings) {
+    str = reader.ReadString();
+  }
+  std::vector<BinaryNodeType> types(reader.ReadVarUInt());
+  for (BinaryNodeType& type : types) {
+    type.type_key = reader.ReadIndex(strings.size());
+    type.kind = reader.ReadPOD<BinaryNodeKind>();
+    type.field_keys.resize(reader.ReadVarUInt());
+    for (size_t& key : type.field_keys) {
+      key = reader.ReadIndex(strings.size());
+    }
+  }
+  std::vector<runtime::NDArray> tensors(reader.ReadVarUInt());
+  for (runtime::NDArray& tensor : tensors) {
+    size_t size = reader.ReadVarUInt();
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(reader.ReadRaw(size)), size);
+    CHECK(tensor.Load(&strm));
+  }
+  std::vector<ObjectPtr<Object>> nodes(reader.ReadVarUInt());
+  CHECK(!nodes.empty()) << "Corrupted binary node graph";
+  size_t root = reader.ReadIndex(nodes.size());
+  std::vector<bool> checked(types.size(), false);
+  BinaryAttrSetter setter;
+  setter.node_list_ = &nodes;
+  setter.tensor_list_ = &tensors;
+  setter.strings_ = &strings;
+  setter.reader_ = &reader;
+  // The children of a node come before it, so a single pass builds the graph.
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    size_t type_id = reader.ReadIndex(types.size());
+    const BinaryNodeType& type = types[type_id];
+    const std::string& type_key = strings[type.type_key];
+    switch (type.kind) {
+      case BinaryNodeKind::kReprBytes: {
+        const std::string& repr_bytes = strings[reader.ReadIndex(strings.size())];
+        nodes[i] = reflection->CreateInitObject(type_key, repr_bytes);
+        break;
+      }
+      case BinaryNodeKind::kArray: {
+        std::vector<ObjectRef> container(reader.ReadVarUInt());
+        for (ObjectRef& item : container) {
+          item = ObjectRef(nodes[reader.ReadIndex(i)]);
+        }
+        Array<ObjectRef> array(container);
+        nodes[i] = runtime::ObjectInternal::MoveObjectPtr(&array);
+        break;
+      }
+      case BinaryNodeKind::kMap:
+      case BinaryNodeKind::kStrMap: {
+        std::unordered_map<ObjectRef, ObjectRef, ObjectHash, ObjectEqual> container;
+        size_t size = reader.ReadVarUInt();
+        for (size_t k = 0; k < size; ++k) {
+          ObjectRef key = type.kind == BinaryNodeKind::kStrMap
+                              ? String(strings[reader.ReadIndex(strings.size())])
+                              : ObjectRef(nodes[reader.ReadIndex(i)]);
+          container[key] = ObjectRef(nodes[reader.ReadIndex(i)]);
+        }
+        Map<ObjectRef, ObjectRef> map(container);
+        nodes[i] = runtime::ObjectInternal::MoveObjectPtr(&map);
+        break;
+      }
+      case BinaryNodeKind::kFields: {
+        nodes[i] = reflection->CreateInitObject(type_key);
+        setter.field_keys_ = checked[type_id] ? nullptr : &type.field_keys;
+        setter.field_ = 0;
+        reflection->VisitAttrs(nodes[i].get(), &setter);
+        if (!checked[type_id]) {
+          CHECK_EQ(setter.field_, type.field_keys.size())
+              << "Binary node graph: the fields of " << type_key
+              << " do not match this version of TVM";
+          checked[type_id] = true;
+        }
+        break;
+      }
+      default:
+        LOG(FATAL) << "Corrupted binary node graph";
+    }
+  }
+  return ObjectRef(nodes[root]);
+}
+
 TVM_REGISTER_GLOBAL("node.SaveJSON").set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON").set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string bytes = SaveBinary(args[0]);
+  TVMByteArray arr;
+  arr.data = bytes.data();
+  arr.size = bytes.size();
+  *rv = arr;
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary").set_body_typed([](std::string bytes) {
+  return LoadBinary(bytes);
+});
 }  // namespace tvm
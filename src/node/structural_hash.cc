@@ -23,10 +23,14 @@
 #include <tvm/node/node.h>
 #include <tvm/node/reflection.h>
 #include <tvm/node/structural_hash.h>
+#include <dmlc/thread_local.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <stack>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace tvm {
 
@@ -258,14 +262,83 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
   std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual> hash_memo_;
 };
 
+/*! \brief Thread local stack of StructuralHashMemo scopes. */
+struct StructuralHashMemoThreadLocalEntry {
+  std::stack<StructuralHashMemo> memo_stack;
+};
+
+using StructuralHashMemoThreadLocalStore =
+    dmlc::ThreadLocalStore<StructuralHashMemoThreadLocalEntry>;
+
+// Hash through the memo in scope, if any.
+static size_t MemoizedStructuralHash(const ObjectRef& object, bool map_free_vars) {
+  auto* entry = StructuralHashMemoThreadLocalStore::Get();
+  if (entry->memo_stack.empty()) {
+    return VarCountingSHashHandler().Hash(object, map_free_vars);
+  }
+  return entry->memo_stack.top()->Hash(object, map_free_vars);
+}
+
+size_t StructuralHashMemoNode::Hash(const ObjectRef& key, bool map_free_vars) const {
+  // Objects of these types are updated in place, a recorded value could go stale.
+  static const std::unordered_set<std::string> mutable_types = {"IRModule", "Schedule", "Stage"};
+  if (!key.defined() || mutable_types.count(key->GetTypeKey())) {
+    return VarCountingSHashHandler().Hash(key, map_free_vars);
+  }
+  auto& table = table_[map_free_vars ? 1 : 0];
+  auto it = table.find(key);
+  if (it != table.end()) return it->second;
+  size_t hashed_value = VarCountingSHashHandler().Hash(key, map_free_vars);
+  table.emplace(key, hashed_value);
+  return hashed_value;
+}
+
+StructuralHashMemo::StructuralHashMemo() { data_ = make_object<StructuralHashMemoNode>(); }
+
+Optional<StructuralHashMemo> StructuralHashMemo::Current() {
+  auto* entry = StructuralHashMemoThreadLocalStore::Get();
+  if (entry->memo_stack.empty()) return NullOpt;
+  return entry->memo_stack.top();
+}
+
+void StructuralHashMemo::EnterWithScope() {
+  StructuralHashMemoThreadLocalStore::Get()->memo_stack.push(*this);
+}
+
+void StructuralHashMemo::ExitWithScope() {
+  auto* entry = StructuralHashMemoThreadLocalStore::Get();
+  CHECK(!entry->memo_stack.empty());
+  CHECK(entry->memo_stack.top().same_as(*this));
+  entry->memo_stack.pop();
+}
+
+class StructuralHashMemo::Internal {
+ public:
+  static void EnterScope(StructuralHashMemo memo) { memo.EnterWithScope(); }
+
+  static void ExitScope(StructuralHashMemo memo) { memo.ExitWithScope(); }
+};
+
+TVM_REGISTER_OBJECT_TYPE(StructuralHashMemoNode);
+
+TVM_REGISTER_GLOBAL("node.StructuralHashMemo").set_body_typed([]() {
+  return StructuralHashMemo();
+});
+
+TVM_REGISTER_GLOBAL("node.EnterStructuralHashMemo")
+    .set_body_typed(StructuralHashMemo::Internal::EnterScope);
+
+TVM_REGISTER_GLOBAL("node.ExitStructuralHashMemo")
+    .set_body_typed(StructuralHashMemo::Internal::ExitScope);
+
 TVM_REGISTER_GLOBAL("node.StructuralHash")
     .set_body_typed([](const ObjectRef& object, bool map_free_vars) -> int64_t {
-      size_t hashed_value = VarCountingSHashHandler().Hash(object, map_free_vars);
+      size_t hashed_value = MemoizedStructuralHash(object, map_free_vars);
       return static_cast<int64_t>(hashed_value);
     });
 
 size_t StructuralHash::operator()(const ObjectRef& object) const {
-  return VarCountingSHashHandler().Hash(object, false);
+  return MemoizedStructuralHash(object, false);
 }
 
 }  // namespace tvm
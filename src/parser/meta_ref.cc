@@ -63,6 +63,48 @@ Expr MetaRef(std::string type_key, uint64_t node_index) {
   return Call(op, {}, Attrs(attrs), {});
 }
 
+LazyMetaTable::LazyMetaTable(const std::string& json) {
+  if (json.size() != 0) {
+    loader_ = std::make_shared<LazyJSONLoader>(json);
+    CHECK_EQ(loader_->TypeKey(loader_->root()), MapNode::_type_key)
+        << "the metadata section must be a map";
+  }
+}
+
+int64_t LazyMetaTable::FindEntry(const std::string& type_key) const {
+  if (loader_ == nullptr) {
+    return -1;
+  }
+  size_t root = loader_->root();
+  const std::vector<std::string>& keys = loader_->Keys(root);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] == type_key) {
+      size_t entry = loader_->Children(root)[i];
+      CHECK_EQ(loader_->TypeKey(entry), ArrayNode::_type_key)
+          << "the metadata entry for `" << type_key << "` must be an array";
+      return entry;
+    }
+  }
+  return -1;
+}
+
+bool LazyMetaTable::Find(const std::string& type_key, size_t* num_nodes) const {
+  int64_t entry = FindEntry(type_key);
+  if (entry < 0) {
+    return false;
+  }
+  *num_nodes = loader_->Children(entry).size();
+  return true;
+}
+
+ObjectRef LazyMetaTable::Get(const std::string& type_key, size_t index) {
+  int64_t entry = FindEntry(type_key);
+  CHECK_GE(entry, 0) << "no entry in the meta table for `" << type_key << "`";
+  const std::vector<size_t>& nodes = loader_->Children(entry);
+  CHECK_LT(index, nodes.size());
+  return loader_->Get(nodes[index]);
+}
+
 struct MetaRefExpander : public ExprMutator {
   MetaTable table;
 
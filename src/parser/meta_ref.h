@@ -26,9 +26,11 @@
 #define TVM_PARSER_META_REF_H_
 
 #include <tvm/ir/attrs.h>
+#include <tvm/node/serialization.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/function.h>
 
+#include <memory>
 #include <string>
 
 namespace tvm {
@@ -76,6 +78,41 @@ struct MetaRefAttrs : public tvm::AttrsNode<MetaRefAttrs> {
  */
 Expr MetaRef(std::string type_key, uint64_t node_index);
 
+/*!
+ * \brief The metadata section of a program, whose nodes are loaded when they are referenced.
+ *
+ * Large constants are stored in the metadata section, loading it eagerly decodes all of
+ * them whether or not the program refers to them.
+ */
+class LazyMetaTable {
+ public:
+  LazyMetaTable() = default;
+  /*!
+   * \param json The metadata section as saved by SaveJSON, empty when there is none.
+   */
+  explicit LazyMetaTable(const std::string& json);
+  /*!
+   * \brief Find the nodes of a type in the table.
+   * \param type_key The type key of the nodes.
+   * \param num_nodes Set to the number of nodes of the type.
+   * \return Whether the table has an entry for the type.
+   */
+  bool Find(const std::string& type_key, size_t* num_nodes) const;
+  /*!
+   * \brief Get the node `meta[type_key][index]`, loading it if it was not yet.
+   * \param type_key The type key of the node.
+   * \param index The index into the nodes of the type.
+   * \return The node.
+   */
+  ObjectRef Get(const std::string& type_key, size_t index);
+
+ private:
+  /*! \return The index of the Array for type_key in the saved graph, -1 when there is none. */
+  int64_t FindEntry(const std::string& type_key) const;
+
+  std::shared_ptr<LazyJSONLoader> loader_;
+};
+
 relay::Function ExpandMetaRefs(const MetaTable& meta_table, const relay::Function& func);
 IRModule ExpandMetaRefs(const MetaTable& meta_table, const IRModule& mod);
 
@@ -237,7 +237,7 @@ class Parser {
   int pos;
 
   /*! \brief The token stream for the parser. */
-  std::vector<Token> tokens;
+  TokenStream tokens;
 
   /*! \brief The configured operator table. */
   OperatorTable op_table;
@@ -263,25 +263,28 @@ class Parser {
   /*! \brief The set of expression scopes used for lexical scope. */
   ScopeStack<Var> expr_scopes;
 
-  /*! \brief The metadata section. */
-  MetaTable meta_table;
+  /*! \brief The metadata section, loaded when it is first referenced. */
+  LazyMetaTable meta_table;
 
-  Parser(DiagnosticContext* ctx, const SourceName& source_name, std::vector<Token> tokens,
-         OperatorTable op_table, Source source, MetaTable table)
+  /*! \brief Whether the metadata section was loaded. */
+  bool meta_table_loaded;
+
+  Parser(DiagnosticContext* ctx, const SourceName& source_name, const std::string& source,
+         OperatorTable op_table)
       : diag_ctx(ctx),
         source_name(source_name),
         pos(0),
-        tokens(tokens),
+        tokens(ctx, source_name, source),
         op_table(op_table),
         ignore_whitespace(true),
-        meta_table(table) {}
+        meta_table_loaded(false) {}
 
   /*! \brief Examine the next token in the stream, the current parser is configured to be
    * whitespace insensitive so we will skip all whitespace or comment tokens. */
   Token Peek() {
     // For now we ignore all whitespace tokens and comments.
     // We can tweak this behavior later to enable white space sensitivity in the parser.
-    while (pos < static_cast<int64_t>(tokens.size()) && ignore_whitespace &&
+    while (ignore_whitespace && tokens.Has(pos) &&
            (tokens.at(pos)->token_type == TokenType::kWhitespace ||
             tokens.at(pos)->token_type == TokenType::kNewline ||
             tokens.at(pos)->token_type == TokenType::kLineComment ||
@@ -289,7 +292,7 @@ class Parser {
       pos++;
     }
 
-    if (pos < static_cast<int64_t>(tokens.size())) {
+    if (tokens.Has(pos)) {
       return Token(this->tokens.at(pos));
     } else {
       return Token::Null();
@@ -327,6 +330,8 @@ class Parser {
                                 << Pretty(Peek()->token_type));
     }
     pos++;
+    // Only lookahead backtracks, and never past a consumed token.
+    tokens.Release(pos);
   }
 
   /*! Match a token in the stream, this will first invoke Peek, ignoring tokens such
@@ -516,17 +521,26 @@ class Parser {
     return Bracket(TokenType::kLCurly, TokenType::kRCurly, parser);
   }
 
+  /*! \brief Get the metadata section, reading ahead to it when it is first referenced. */
+  LazyMetaTable* GetMetaTable() {
+    if (!meta_table_loaded) {
+      meta_table = LazyMetaTable(tokens.Metadata());
+      meta_table_loaded = true;
+    }
+    return &meta_table;
+  }
+
   ObjectRef ParseMetaRef() {
     auto meta_ref = Match(TokenType::kMetaReference);
     Call ref = Downcast<Call>(meta_ref->data);
     auto attrs = ref->attrs.as<MetaRefAttrs>();
     auto type_key = attrs->node_type_key;
     auto index = attrs->node_index;
-    auto it = this->meta_table.find(type_key);
-    if (it != this->meta_table.end()) {
-      auto nodes = (*it).second;
-      if (index < nodes.size()) {
-        return nodes[index];
+    LazyMetaTable* table = GetMetaTable();
+    size_t num_nodes;
+    if (table->Find(type_key, &num_nodes)) {
+      if (index < num_nodes) {
+        return table->Get(type_key, index);
       } else {
         this->diag_ctx->Emit(Diagnostic::Error(meta_ref->span)
                              << "the node index `" << index << "` is out of bounds for `"
@@ -610,10 +624,8 @@ class Parser {
   IRModule ParseModule() {
     // Parse the semver header at the top of the module.
     this->version = ParseSemVer();
-    // Parse the definitions.
+    // Parse the definitions, the metadata section at the end is picked out by the tokenizer.
     auto defs = ParseDefinitions();
-    // Parse the metadata section at the end.
-    auto metadata = ParseMetadata();
 
     Match(TokenType::kEndOfFile);
     Map<tvm::GlobalVar, BaseFunc> funcs;
@@ -768,8 +780,7 @@ class Parser {
 
   std::string HackTokensAsString(int n) {
     std::stringstream key;
-    n = std::min(static_cast<int>(tokens.size() - pos), n);
-    for (int i = 0; i < n; i++) {
+    for (int i = 0; i < n && tokens.Has(pos + i); i++) {
       key << ToString(tokens.at(pos + i)->token_type);
     }
     return key.str();
@@ -1600,7 +1611,7 @@ class Parser {
   R ConsumeWhitespace(std::function<R()> func) {
     auto old = this->ignore_whitespace;
     this->ignore_whitespace = true;
-    while (tokens[pos]->token_type == TokenType::kWhitespace) {
+    while (tokens.at(pos)->token_type == TokenType::kWhitespace) {
       pos++;
     }
     auto res = func();
@@ -1608,19 +1619,10 @@ class Parser {
     return res;
   }
 
-  Map<String, Array<ObjectRef>> ParseMetadata() {
-    if (Peek()->token_type == TokenType::kMetadata) {
-      return Match(TokenType::kMetadata).ToMetadata();
-    } else {
-      return Map<String, Array<ObjectRef>>();
-    }
-  }
-
   /*! \brief A helper for debugging the parser, displays the next N tokens in the token stream. */
   void DisplayNextN(int n) {
     std::cout << "remaining tokens: " << std::endl;
-    auto bound = std::min(pos + n, static_cast<int>(tokens.size()));
-    for (int i = 0; i < bound - pos; i++) {
+    for (int i = 0; i < n && tokens.Has(pos + i); i++) {
       std::cout << tokens[pos + i] << std::endl;
     }
   }
@@ -1647,10 +1649,7 @@ IRModule ParseModule(std::string file_name, std::string file_content) {
   SourceName src_name = SourceName::Get(file_name);
   Source src(src_name, file_content);
   DiagnosticContext ctx(src);
-  auto tokens_and_table = Tokenize(&ctx, src_name, file_content);
-  auto tokens = tokens_and_table.first;
-  auto meta_data_table = tokens_and_table.second;
-  Parser parser(&ctx, src_name, tokens, DefaultOpTable(), src, meta_data_table.ToMetadata());
+  Parser parser(&ctx, src_name, file_content, DefaultOpTable());
   auto mod = parser.ParseModule();
   // NB(@jroesch): it is very important that we render any errors before we procede
   // if there were any errors which allow the parser to procede we must render them
@@ -1664,10 +1663,7 @@ Expr ParseExpr(std::string file_name, std::string file_content) {
   SourceName src_name = SourceName::Get(file_name);
   Source src(src_name, file_content);
   DiagnosticContext ctx(src);
-  auto tokens_and_table = Tokenize(&ctx, src_name, file_content);
-  auto tokens = tokens_and_table.first;
-  auto meta_data_table = tokens_and_table.second;
-  Parser parser(&ctx, src_name, tokens, DefaultOpTable(), src, meta_data_table.ToMetadata());
+  Parser parser(&ctx, src_name, file_content, DefaultOpTable());
   parser.ParseSemVer(false);
   parser.PushScope();
   auto expr = parser.ParseExpr();
@@ -359,7 +359,6 @@ class Token : public ObjectRef {
   static Token Null();
   int64_t ToNumber() const;
   std::string ToString() const;
-  Map<String, Array<ObjectRef>> ToMetadata() const;
   TVM_DEFINE_OBJECT_REF_METHODS(Token, ObjectRef, TokenNode);
 };
 
@@ -377,15 +376,6 @@ int64_t Token::ToNumber() const { return Downcast<tvm::Integer>(this->operator->
 
 std::string Token::ToString() const { return Downcast<tvm::String>(this->operator->()->data); }
 
-Map<String, Array<ObjectRef>> Token::ToMetadata() const {
-  ObjectRef data = this->operator->()->data;
-  if (data.defined()) {
-    return Downcast<Map<String, Array<ObjectRef>>>(data);
-  } else {
-    return Map<String, Array<ObjectRef>>({});
-  }
-}
-
 }  // namespace parser
 }  // namespace tvm
 #endif  // TVM_PARSER_TOKEN_H_
@@ -28,6 +28,8 @@
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/object.h>
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
 #include <string>
 #include <unordered_map>
@@ -82,7 +84,6 @@ struct Tokenizer {
   int line;
   char next_char;
   const std::string& source;
-  std::vector<Token> tokens;
 
   char Next() {
     char c = this->source.at(this->pos);
@@ -98,6 +99,20 @@ struct Tokenizer {
 
   bool More() { return this->pos < this->source.size(); }
 
+  /*! \brief Consume the rest of the source at once and return it. */
+  std::string TakeRest() {
+    std::string rest = this->source.substr(this->pos);
+    size_t last_newline = rest.rfind('\n');
+    if (last_newline == std::string::npos) {
+      this->col += rest.size();
+    } else {
+      this->line += std::count(rest.begin(), rest.end(), '\n');
+      this->col = rest.size() - last_newline;
+    }
+    this->pos = this->source.size();
+    return rest;
+  }
+
   char Peek() {
     CHECK(pos < this->source.size());
     return this->source.at(this->pos);
@@ -260,14 +275,11 @@ struct Tokenizer {
       rtrim(attribute);
 
       // Metadata can only appear at the bottom of a file and goes to EOF.
+      // It is kept as raw json, the nodes in it are loaded when they are referenced.
       if (attribute == "metadata") {
-        std::stringstream metadata;
-        while (More()) {
-          metadata << Next();
-        }
-        ObjectRef metadata_map = tvm::LoadJSON(metadata.str());
+        auto metadata = tvm::String(TakeRest());
         auto span = SpanFrom(line, column);
-        return Token(span, TokenType::kMetadata, metadata_map);
+        return Token(span, TokenType::kMetadata, metadata);
       }
       if (attribute.rfind("version", 0) == 0) {
         std::string version = attribute.substr(attribute.find("=") + 1);
@@ -515,16 +527,6 @@ struct Tokenizer {
     }
   }
 
-  void Tokenize() {
-    DLOG(INFO) << "tvm::parser::Tokenize";
-    while (this->More()) {
-      auto token = TokenizeOnce();
-      CHECK(token.defined());
-      this->tokens.push_back(token);
-    }
-    this->tokens.push_back(NewToken(TokenType::kEndOfFile));
-  }
-
   explicit Tokenizer(DiagnosticContext* ctx, const SourceName& source_name,
                      const std::string& source)
       : diag_ctx(ctx),
@@ -532,100 +534,149 @@ struct Tokenizer {
         pos(0),
         col(1),
         line(1),
-        source(source),
-        tokens() {}
+        source(source) {}
 };
 
-std::vector<Token> Condense(const std::vector<Token>& tokens, Token* table) {
-  std::vector<Token> out;
-  bool found_metadata = false;
+/*!
+ * \brief The condensed token stream of a source, tokenized as the parser reads it.
+ *
+ * Tokens are addressed by their absolute position in the stream. The tokens the
+ * parser has consumed are released, so only the tokens between the parser and its
+ * furthest lookahead are kept. The metadata section is picked out of the stream.
+ */
+class TokenStream {
+ public:
+  TokenStream(DiagnosticContext* ctx, const SourceName& source_name, const std::string& source)
+      : tokenizer_(ctx, source_name, source) {}
+
+  /*! \return Whether there is a token at position i, tokenizing up to it if needed. */
+  bool Has(int64_t i) {
+    CHECK_GE(i, base_) << "the token at " << i << " was already released";
+    while (i - base_ >= static_cast<int64_t>(buffer_.size()) && !done_) {
+      Advance();
+    }
+    return i - base_ < static_cast<int64_t>(buffer_.size());
+  }
+
+  /*! \return The token at position i. */
+  const Token& at(int64_t i) {
+    CHECK(Has(i)) << "token " << i << " is past the end of the stream";
+    return buffer_[i - base_];
+  }
+
+  const Token& operator[](int64_t i) { return at(i); }
+
+  /*! \brief Release the tokens before position i, they must not be accessed again. */
+  void Release(int64_t i) {
+    while (base_ < i && !buffer_.empty()) {
+      buffer_.pop_front();
+      ++base_;
+    }
+  }
+
+  /*!
+   * \brief Get the metadata section, it goes to the end of the source so the rest of the
+   *  source is tokenized first.
+   * \return The raw metadata section, empty if there is none.
+   */
+  std::string Metadata() {
+    while (!done_) {
+      Advance();
+    }
+    if (!metadata_.defined()) {
+      return "";
+    }
+    return Downcast<tvm::String>(metadata_->data);
+  }
 
-  for (size_t i = 0; i < tokens.size(); i++) {
-    auto current = tokens.at(i);
+ private:
+  /*! \brief Get the next token from the tokenizer. */
+  Token NextRaw() {
+    if (lookahead_.defined()) {
+      Token token = lookahead_;
+      lookahead_ = Token();
+      return token;
+    }
+    if (tokenizer_.More()) {
+      auto token = tokenizer_.TokenizeOnce();
+      CHECK(token.defined());
+      return token;
+    }
+    return tokenizer_.NewToken(TokenType::kEndOfFile);
+  }
+
+  /*! \brief Condense the next tokens into the buffer. */
+  void Advance() {
+    Token current = NextRaw();
     switch (current->token_type) {
+      case TokenType::kEndOfFile: {
+        buffer_.push_back(current);
+        done_ = true;
+        return;
+      }
       case TokenType::kMetadata: {
-        if (!found_metadata) {
-          found_metadata = true;
-          *table = current;
-        } else {
+        if (metadata_.defined()) {
           LOG(FATAL) << "duplicate metadata section";
         }
-        continue;
+        metadata_ = current;
+        return;
       }
       case TokenType::kPercent: {
-        auto next = tokens.at(i + 1);
+        auto next = NextRaw();
         if (next->token_type == TokenType::kIdentifier) {
-          // Match this token.
-          i += 1;
           // TODO(@jroesch): merge spans
-          auto tok = Token(current->span, TokenType::kLocal, next->data);
-          CHECK(tok.defined());
-          out.push_back(tok);
+          buffer_.push_back(Token(current->span, TokenType::kLocal, next->data));
         } else if (next->token_type == TokenType::kInteger) {
-          i += 1;
-          auto tok = Token(current->span, TokenType::kGraph, next->data);
-          CHECK(tok.defined());
-          out.push_back(tok);
+          buffer_.push_back(Token(current->span, TokenType::kGraph, next->data));
         } else {
-          CHECK(current.defined());
-          out.push_back(current);
+          buffer_.push_back(current);
+          lookahead_ = next;
         }
-        continue;
+        return;
       }
       case TokenType::kAt: {
-        auto next = tokens.at(i + 1);
+        auto next = NextRaw();
         if (next->token_type == TokenType::kIdentifier) {
-          // Match this token.
-          i += 1;
           // TODO(@jroesch): merge spans
-          auto tok = Token(current->span, TokenType::kGlobal, next->data);
-          CHECK(tok.defined());
-          out.push_back(tok);
+          buffer_.push_back(Token(current->span, TokenType::kGlobal, next->data));
         } else {
-          CHECK(current.defined());
-          out.push_back(current);
+          buffer_.push_back(current);
+          lookahead_ = next;
         }
-        continue;
+        return;
       }
       case TokenType::kIdentifier: {
         std::string str = Downcast<tvm::String>(current->data);
-        Token tok;
         // TODO(@jroesch): merge spans
         if (str == "True") {
-          auto data = tvm::Integer(1);
-          tok = Token(current->span, TokenType::kBoolean, data);
+          buffer_.push_back(Token(current->span, TokenType::kBoolean, tvm::Integer(1)));
         } else if (str == "False") {
-          auto data = tvm::Integer(0);
-          tok = Token(current->span, TokenType::kBoolean, data);
+          buffer_.push_back(Token(current->span, TokenType::kBoolean, tvm::Integer(0)));
         } else if (str == "_") {
-          tok = Token(current->span, TokenType::kUnderscore);
+          buffer_.push_back(Token(current->span, TokenType::kUnderscore));
         } else {
-          tok = current;
+          buffer_.push_back(current);
         }
-        out.push_back(tok);
-        continue;
+        return;
       }
       default: {
-        out.push_back(current);
-        continue;
+        buffer_.push_back(current);
+        return;
       }
     }
   }
 
-  return out;
-}
-
-std::pair<std::vector<Token>, Token> Tokenize(DiagnosticContext* ctx, const SourceName& source_name,
-                                              const std::string& source) {
-  auto tokenizer = Tokenizer(ctx, source_name, source);
-  tokenizer.Tokenize();
-  Token meta_table(Span(), TokenType::kUnknown, ObjectRef());
-  auto tokens = Condense(tokenizer.tokens, &meta_table);
-  for (auto token : tokens) {
-    CHECK(token.defined());
-  }
-  return {tokens, meta_table};
-}
+  Tokenizer tokenizer_;
+  /*! \brief A token read from the tokenizer but not condensed yet. */
+  Token lookahead_;
+  /*! \brief The metadata section. */
+  Token metadata_;
+  /*! \brief The tokens from position base_ on. */
+  std::deque<Token> buffer_;
+  int64_t base_{0};
+  /*! \brief Whether the end of file token was reached. */
+  bool done_{false};
+};
 
 }  // namespace parser
 }  // namespace tvm
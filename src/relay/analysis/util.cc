@@ -488,5 +488,23 @@ bool IsDataDependant(const CallNode* call) {
 
   return tshape_data_dependant[op];
 }
+
+int64_t ValueBytes(const Type& type) {
+  if (const auto* tensor_type = type.as<TensorTypeNode>()) {
+    int64_t bytes = (tensor_type->dtype.bits() * tensor_type->dtype.lanes() + 7) / 8;
+    for (const PrimExpr& dim : tensor_type->shape) {
+      const auto* value = dim.as<IntImmNode>();
+      if (value == nullptr) return 0;
+      bytes *= value->value;
+    }
+    return bytes;
+  }
+  int64_t bytes = 0;
+  if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+    for (const Type& field : tuple_type->fields) bytes += ValueBytes(field);
+  }
+  return bytes;
+}
+
 }  // namespace relay
 }  // namespace tvm
@@ -0,0 +1,443 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/aot_codegen.cc
+ * \brief Ahead-of-time executor codegen.
+ *
+ * Instead of shipping the graph JSON to an interpreter, the graph produced by the
+ * graph runtime codegen is rendered as C source: every intermediate tensor becomes a
+ * static DLTensor pointing into one statically planned arena, and the run function
+ * calls the fused operators directly in topological order. The params can be linked in as
+ * constant arrays, so nothing is parsed, allocated or copied before the first run.
+ */
+#include <dmlc/json.h>
+#include <tvm/ir/transform.h>
+#include <tvm/relay/function.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+namespace backend {
+
+/*! \brief The subset of the graph JSON the AOT executor needs. */
+struct AOTGraph {
+  struct Node {
+    std::string op_type;
+    std::string name;
+    std::unordered_map<std::string, std::string> attrs;
+    std::vector<std::vector<uint32_t>> inputs;
+
+    void Load(dmlc::JSONReader* reader) {
+      reader->BeginObject();
+      std::string key;
+      while (reader->NextObjectItem(&key)) {
+        if (key == "op") {
+          reader->Read(&op_type);
+        } else if (key == "name") {
+          reader->Read(&name);
+        } else if (key == "inputs") {
+          reader->Read(&inputs);
+        } else if (key == "attr" || key == "attrs") {
+          reader->Read(&attrs);
+        } else {
+          LOG(FATAL) << "do not support key " << key;
+        }
+      }
+    }
+  };
+
+  std::vector<Node> nodes;
+  std::vector<uint32_t> arg_nodes;
+  std::vector<uint32_t> node_row_ptr;
+  std::vector<std::vector<uint32_t>> heads;
+  std::vector<size_t> storage_id;
+  std::vector<size_t> storage_offset;
+  std::vector<std::string> dltype;
+  std::vector<std::vector<int64_t>> shape;
+  size_t arena_bytes{0};
+
+  void LoadAttrs(dmlc::JSONReader* reader) {
+    reader->BeginObject();
+    std::string key, type;
+    while (reader->NextObjectItem(&key)) {
+      reader->BeginArray();
+      CHECK(reader->NextArrayItem());
+      reader->Read(&type);
+      CHECK(reader->NextArrayItem());
+      if (key == "storage_id") {
+        reader->Read(&storage_id);
+      } else if (key == "storage_offset") {
+        reader->Read(&storage_offset);
+      } else if (key == "dltype") {
+        reader->Read(&dltype);
+      } else if (key == "shape") {
+        reader->Read(&shape);
+      } else if (key == "arena_bytes") {
+        reader->Read(&arena_bytes);
+      } else if (key == "device_index") {
+        std::vector<int> device_index;
+        reader->Read(&device_index);
+        for (int dev : device_index) {
+          CHECK_EQ(dev, device_index[0]) << "AOT executor does not support heterogeneous graphs";
+        }
+      } else if (type == "list_int") {
+        std::vector<int> temp;
+        reader->Read(&temp);
+      } else if (type == "size_t") {
+        size_t temp;
+        reader->Read(&temp);
+      } else {
+        LOG(FATAL) << "cannot skip graph attr " << key;
+      }
+      CHECK(!reader->NextArrayItem());
+    }
+  }
+
+  void Load(dmlc::JSONReader* reader) {
+    reader->BeginObject();
+    std::string key;
+    while (reader->NextObjectItem(&key)) {
+      if (key == "nodes") {
+        reader->Read(&nodes);
+      } else if (key == "arg_nodes") {
+        reader->Read(&arg_nodes);
+      } else if (key == "node_row_ptr") {
+        reader->Read(&node_row_ptr);
+      } else if (key == "heads") {
+        reader->Read(&heads);
+      } else if (key == "attrs") {
+        LoadAttrs(reader);
+      } else if (key == "metadata") {
+        break;
+      } else {
+        LOG(FATAL) << "key " << key << " is not supported";
+      }
+    }
+  }
+
+  uint32_t entry_id(const std::vector<uint32_t>& ref) const {
+    CHECK_GE(ref.size(), 2U) << "invalid node entry";
+    return node_row_ptr[ref[0]] + ref[1];
+  }
+};
+
+/*!
+ * \brief Render a graph JSON as a self-contained C executor.
+ *
+ * The generated translation unit defines, with every symbol prefixed by \p prefix:
+ *  - `int32_t <prefix>_run(void)` which invokes each fused operator in order;
+ *  - `DLTensor* <prefix>_get_input(int32_t)`, `DLTensor* <prefix>_get_output(int32_t)`
+ *    and the matching `<prefix>_num_inputs` / `<prefix>_num_outputs` counters;
+ *  - `const char* <prefix>_input_names[]`, so params can be bound by name.
+ * Inputs (including params) live in the arena like any other tensor; callers either copy
+ * into `<prefix>_get_input(i)->data` or repoint it at their own buffer. The params given to
+ * the generator are instead emitted as constant arrays the tensors point to, and are left
+ * out of the inputs so they cannot be written.
+ */
+class AOTSourceGenerator {
+ public:
+  AOTSourceGenerator(const std::string& graph_json, const std::string& prefix,
+                     const Map<String, runtime::NDArray>& params)
+      : prefix_(prefix) {
+    std::istringstream is(graph_json);
+    dmlc::JSONReader reader(&is);
+    graph_.Load(&reader);
+    PlanOffsets();
+    for (uint32_t nid : graph_.arg_nodes) {
+      auto it = params.find(graph_.nodes[nid].name);
+      if (it == params.end()) continue;
+      uint32_t eid = graph_.node_row_ptr[nid];
+      const runtime::NDArray& param = (*it).second;
+      CHECK_EQ(param->ctx.device_type, kDLCPU) << "linked params must be on the CPU";
+      CHECK_EQ(runtime::GetDataSize(*param.operator->()), EntryBytes(eid))
+          << "param " << graph_.nodes[nid].name << " does not match its graph input";
+      linked_params_[graph_.storage_id[eid]] = param;
+    }
+  }
+
+  std::string Generate() {
+    std::ostringstream os;
+    os << "// AOT executor generated by relay.backend.aot_codegen\n"
+       << "#include <tvm/runtime/c_backend_api.h>\n"
+       << "#include <tvm/runtime/c_runtime_api.h>\n\n"
+       << "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+    EmitDeclarations(os);
+    EmitParams(os);
+    EmitTensors(os);
+    EmitAccessors(os);
+    EmitRun(os);
+    os << "#ifdef __cplusplus\n}  // extern \"C\"\n#endif\n";
+    return os.str();
+  }
+
+ private:
+  /*! \brief Use the offline arena plan when present, otherwise lay storage out back to back. */
+  void PlanOffsets() {
+    size_t num_storage = 0;
+    for (size_t sid : graph_.storage_id) {
+      num_storage = std::max(num_storage, sid + 1);
+    }
+    if (graph_.storage_offset.size() == num_storage) {
+      offsets_ = graph_.storage_offset;
+      arena_bytes_ = graph_.arena_bytes;
+      return;
+    }
+    std::vector<size_t> bytes(num_storage, 0);
+    for (size_t eid = 0; eid < graph_.storage_id.size(); ++eid) {
+      size_t sid = graph_.storage_id[eid];
+      bytes[sid] = std::max(bytes[sid], EntryBytes(eid));
+    }
+    offsets_.resize(num_storage);
+    for (size_t sid = 0; sid < num_storage; ++sid) {
+      offsets_[sid] = arena_bytes_;
+      arena_bytes_ += (bytes[sid] + runtime::kAllocAlignment - 1) / runtime::kAllocAlignment *
+                      runtime::kAllocAlignment;
+    }
+  }
+
+  size_t EntryBytes(size_t eid) const {
+    DLDataType t = runtime::String2DLDataType(graph_.dltype[eid]);
+    size_t size = 1;
+    for (int64_t dim : graph_.shape[eid]) {
+      size *= static_cast<size_t>(dim);
+    }
+    return (t.bits * t.lanes + 7U) / 8U * size;
+  }
+
+  bool IsCall(const AOTGraph::Node& node) const {
+    if (node.op_type == "null") return false;
+    CHECK_EQ(node.op_type, "tvm_op") << "Can only take tvm_op as op";
+    const std::string& func_name = node.attrs.at("func_name");
+    CHECK_NE(func_name, "__copy") << "AOT executor does not support device copies";
+    auto flatten = node.attrs.find("flatten_data");
+    CHECK(flatten == node.attrs.end() || flatten->second == "0")
+        << "AOT executor does not support flatten_data";
+    return func_name != "__nop";
+  }
+
+  void EmitDeclarations(std::ostream& os) {
+    std::vector<std::string> declared;
+    for (const auto& node : graph_.nodes) {
+      if (!IsCall(node)) continue;
+      const std::string& func_name = node.attrs.at("func_name");
+      if (std::find(declared.begin(), declared.end(), func_name) != declared.end()) continue;
+      declared.push_back(func_name);
+      os << "TVM_DLL int32_t " << func_name
+         << "(TVMValue* args, int* type_codes, int num_args, TVMValue* out_ret_value,\n"
+         << "    int* out_ret_tcode, void* resource_handle);\n";
+    }
+    os << "\n";
+  }
+
+  /*!
+   * \brief Emit the linked params as read-only arrays.
+   *
+   * Params are never written and their storage ids are not shared, so the tensors point
+   * straight into the arrays. The arena keeps the range planned for them, which is never
+   * touched and so never paged in.
+   */
+  void EmitParams(std::ostream& os) {
+    static const char* hex = "0123456789abcdef";
+    std::vector<size_t> sids;
+    for (const auto& kv : linked_params_) sids.push_back(kv.first);
+    std::sort(sids.begin(), sids.end());
+    for (size_t sid : sids) {
+      const runtime::NDArray& param = linked_params_.at(sid);
+      size_t nbytes = runtime::GetDataSize(*param.operator->());
+      const uint8_t* data = static_cast<const uint8_t*>(param->data) + param->byte_offset;
+      os << "static const uint8_t " << prefix_ << "_param_" << sid << "["
+         << std::max<size_t>(nbytes, 1) << "] __attribute__((aligned("
+         << runtime::kAllocAlignment << "))) = {";
+      for (size_t i = 0; i < nbytes; ++i) {
+        if (i % 16 == 0) os << "\n   ";
+        os << " 0x" << hex[data[i] >> 4] << hex[data[i] & 15] << ",";
+      }
+      os << "\n};\n";
+    }
+    if (!sids.empty()) os << "\n";
+  }
+
+  void EmitTensors(std::ostream& os) {
+    size_t num_entries = graph_.storage_id.size();
+    os << "static uint8_t " << prefix_ << "_arena[" << std::max<size_t>(arena_bytes_, 1)
+       << "] __attribute__((aligned(" << runtime::kAllocAlignment << ")));\n\n";
+    for (size_t eid = 0; eid < num_entries; ++eid) {
+      os << "static int64_t " << prefix_ << "_shape_" << eid << "[] = {";
+      const auto& shape = graph_.shape[eid];
+      for (size_t i = 0; i < shape.size(); ++i) {
+        os << (i ? ", " : "") << shape[i];
+      }
+      os << (shape.empty() ? "1" : "") << "};\n";
+    }
+    os << "\nstatic DLTensor " << prefix_ << "_entry[" << num_entries << "] = {\n";
+    for (size_t eid = 0; eid < num_entries; ++eid) {
+      DLDataType t = runtime::String2DLDataType(graph_.dltype[eid]);
+      size_t sid = graph_.storage_id[eid];
+      if (linked_params_.count(sid)) {
+        os << "    {(void*)" << prefix_ << "_param_" << sid;
+      } else {
+        os << "    {" << prefix_ << "_arena + " << offsets_[sid];
+      }
+      os << ", {kDLCPU, 0}, " << graph_.shape[eid].size() << ", {" << static_cast<int>(t.code)
+         << ", " << static_cast<int>(t.bits) << ", " << t.lanes << "}, " << prefix_ << "_shape_"
+         << eid << ", NULL, 0},\n";
+    }
+    os << "};\n\n";
+  }
+
+  void EmitAccessors(std::ostream& os) {
+    std::vector<uint32_t> inputs;
+    for (uint32_t nid : graph_.arg_nodes) {
+      if (!linked_params_.count(graph_.storage_id[graph_.node_row_ptr[nid]])) {
+        inputs.push_back(nid);
+      }
+    }
+    os << "const char* " << prefix_ << "_input_names[] = {";
+    for (uint32_t nid : inputs) {
+      os << "\"" << graph_.nodes[nid].name << "\", ";
+    }
+    os << "NULL};\n\n";
+    os << "static const int32_t " << prefix_ << "_input_eids[] = {";
+    for (uint32_t nid : inputs) {
+      os << graph_.node_row_ptr[nid] << ", ";
+    }
+    os << "0};\n";
+    os << "static const int32_t " << prefix_ << "_output_eids[] = {";
+    for (const auto& ref : graph_.heads) {
+      os << graph_.entry_id(ref) << ", ";
+    }
+    os << "0};\n\n";
+    os << "int32_t " << prefix_ << "_num_inputs(void) { return " << inputs.size() << "; }\n";
+    os << "int32_t " << prefix_ << "_num_outputs(void) { return " << graph_.heads.size()
+       << "; }\n\n";
+    os << "DLTensor* " << prefix_ << "_get_input(int32_t index) {\n"
+       << "  return &" << prefix_ << "_entry[" << prefix_ << "_input_eids[index]];\n}\n\n";
+    os << "DLTensor* " << prefix_ << "_get_output(int32_t index) {\n"
+       << "  return &" << prefix_ << "_entry[" << prefix_ << "_output_eids[index]];\n}\n\n";
+  }
+
+  void EmitRun(std::ostream& os) {
+    size_t max_args = 1;
+    for (size_t nid = 0; nid < graph_.nodes.size(); ++nid) {
+      max_args = std::max<size_t>(max_args, graph_.nodes[nid].inputs.size() +
+                                                graph_.node_row_ptr[nid + 1] -
+                                                graph_.node_row_ptr[nid]);
+    }
+    os << "int32_t " << prefix_ << "_run(void) {\n"
+       << "  TVMValue values[" << max_args << "];\n"
+       << "  int type_codes[" << max_args << "];\n"
+       << "  TVMValue ret_value;\n"
+       << "  int ret_type_code;\n";
+    for (size_t nid = 0; nid < graph_.nodes.size(); ++nid) {
+      const auto& node = graph_.nodes[nid];
+      if (!IsCall(node)) continue;
+      std::vector<uint32_t> args;
+      for (const auto& ref : node.inputs) {
+        args.push_back(graph_.entry_id(ref));
+      }
+      for (uint32_t eid = graph_.node_row_ptr[nid]; eid < graph_.node_row_ptr[nid + 1]; ++eid) {
+        args.push_back(eid);
+      }
+      os << "  // " << node.name << "\n";
+      for (size_t i = 0; i < args.size(); ++i) {
+        os << "  values[" << i << "].v_handle = &" << prefix_ << "_entry[" << args[i] << "];\n"
+           << "  type_codes[" << i << "] = kTVMDLTensorHandle;\n";
+      }
+      os << "  if (" << node.attrs.at("func_name") << "(values, type_codes, " << args.size()
+         << ", &ret_value, &ret_type_code, NULL) != 0) {\n"
+         << "    return -1;\n  }\n";
+    }
+    os << "  return 0;\n}\n\n";
+  }
+
+  AOTGraph graph_;
+  std::string prefix_;
+  std::vector<size_t> offsets_;
+  size_t arena_bytes_{0};
+  /*! \brief The params linked into the source, by storage id. */
+  std::unordered_map<size_t, runtime::NDArray> linked_params_;
+};
+
+/*!
+ * \brief Codegen module for the AOT executor.
+ *
+ * Drives the graph runtime codegen with the static arena plan enabled and exposes the
+ * same interface, plus "get_source" which renders the lowered graph as C.
+ */
+class AOTCodegenModule : public runtime::ModuleNode {
+ public:
+  AOTCodegenModule() {
+    const auto* pf = runtime::Registry::Get("relay.build_module._GraphRuntimeCodegen");
+    CHECK(pf != nullptr) << "graph runtime codegen is not registered";
+    graph_codegen_ = (*pf)();
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "codegen") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        Function func = args[0];
+        transform::PassContext current = transform::PassContext::Current();
+        transform::PassContext pass_ctx = transform::PassContext::Create();
+        pass_ctx->opt_level = current->opt_level;
+        pass_ctx->required_pass = current->required_pass;
+        pass_ctx->disabled_pass = current->disabled_pass;
+        pass_ctx->trace_func = current->trace_func;
+        pass_ctx->config = current->config;
+        pass_ctx->config.Set("relay.backend.static_arena", Bool(true));
+        // The C runtime has no byte offset per entry.
+        pass_ctx->config.Set("relay.backend.inplace_concat", Bool(false));
+        With<transform::PassContext> scope(pass_ctx);
+        graph_codegen_.GetFunction("codegen")(func);
+      });
+    } else if (name == "get_source") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::string prefix = "tvm_aot";
+        if (args.num_args > 0) prefix = args[0].operator std::string();
+        Map<String, runtime::NDArray> params;
+        if (args.num_args > 1) params = args[1];
+        std::string graph_json = graph_codegen_.GetFunction("get_graph_json")();
+        *rv = AOTSourceGenerator(graph_json, prefix, params).Generate();
+      });
+    }
+    return graph_codegen_.GetFunction(name);
+  }
+
+  const char* type_key() const final { return "RelayAOTCodegenModule"; }
+
+ private:
+  runtime::Module graph_codegen_;
+};
+
+TVM_REGISTER_GLOBAL("relay.build_module._AOTCodegen").set_body_typed([]() {
+  return runtime::Module(make_object<AOTCodegenModule>());
+});
+
+}  // namespace backend
+}  // namespace relay
+}  // namespace tvm
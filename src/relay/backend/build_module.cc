@@ -28,7 +28,11 @@
 #include <tvm/relay/transform.h>
 #include <tvm/runtime/device_api.h>
 
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
 
 #include "../../target/source/codegen_source_base.h"
 #include "compile_engine.h"
@@ -47,10 +51,96 @@ using namespace tvm::relay::transform;
  */
 struct BuildOutput {
   std::string graph_json;
+  std::string graph_binary;
   runtime::Module mod;
   std::unordered_map<std::string, tvm::runtime::NDArray> params;
 };
 
+/*!
+ * \brief Replace the constants the graph runtime codegen turns into params by
+ *  variables, so functions that only differ in their weights compare equal.
+ *  Constants inside primitive functions are compiled into the kernels and kept.
+ */
+class ParamConstantAbstractor : public ExprMutator {
+ public:
+  Expr VisitExpr_(const ConstantNode* op) final {
+    Var var("p" + std::to_string(vars.size()), op->tensor_type());
+    vars.push_back(var);
+    constants.push_back(GetRef<Constant>(op));
+    return std::move(var);
+  }
+
+  Expr VisitExpr_(const FunctionNode* op) final {
+    if (op->HasNonzeroAttr(attr::kPrimitive)) return GetRef<Expr>(op);
+    return ExprMutator::VisitExpr_(op);
+  }
+
+  /*! \brief The variables replacing the constants. */
+  Array<Var> vars;
+  /*! \brief The replaced constants, in the order of vars. */
+  std::vector<Constant> constants;
+};
+
+/*!
+ * \brief A previous build that can be reused when only the weights change.
+ */
+struct IncrementalBuildEntry {
+  /*! \brief The optimized main function with its params abstracted. */
+  Function structure;
+  /*! \brief The param name of each abstracted constant, empty when not a param. */
+  std::vector<std::string> param_names;
+  std::string graph_json;
+  std::string graph_binary;
+  runtime::Module mod;
+};
+
+/*!
+ * \brief The builds kept for the "relay.backend.incremental_build" config.
+ *  Each entry holds a compiled library, so only the most recently used are kept.
+ */
+struct IncrementalBuildCache {
+  /*! \brief The number of builds kept. */
+  static constexpr size_t kMaxEntries = 8;
+
+  std::mutex mutex;
+  std::unordered_map<size_t, IncrementalBuildEntry> entries;
+  /*! \brief The keys of the entries, the most recently used first. */
+  std::list<size_t> lru;
+
+  static IncrementalBuildCache* Global() {
+    static IncrementalBuildCache* inst = new IncrementalBuildCache();
+    return inst;
+  }
+
+  /*!
+   * \brief Find a build and mark it as the most recently used, with mutex held.
+   * \param key The key of the build.
+   * \return The build, nullptr when not kept.
+   */
+  const IncrementalBuildEntry* Find(size_t key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) return nullptr;
+    lru.remove(key);
+    lru.push_front(key);
+    return &it->second;
+  }
+
+  /*!
+   * \brief Keep a build, evicting the least recently used past kMaxEntries, with mutex held.
+   * \param key The key of the build.
+   * \param entry The build.
+   */
+  void Put(size_t key, IncrementalBuildEntry entry) {
+    lru.remove(key);
+    lru.push_front(key);
+    entries[key] = std::move(entry);
+    while (lru.size() > kMaxEntries) {
+      entries.erase(lru.back());
+      lru.pop_back();
+    }
+  }
+};
+
 /*!
  * \brief GraphCodegen module wrapper
  *
@@ -69,6 +159,8 @@ struct GraphCodegen {
 
   std::string GetJSON() { return CallFunc<std::string>("get_graph_json", nullptr); }
 
+  std::string GetBinary() { return CallFunc<std::string>("get_graph_binary", nullptr); }
+
   Array<tvm::runtime::Module> GetExternalModules() {
     return CallFunc<Array<tvm::runtime::Module>>("get_external_modules", nullptr);
   }
@@ -119,6 +211,13 @@ class RelayBuildModule : public runtime::ModuleNode {
     if (name == "get_graph_json") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetGraphJSON(); });
+    } else if (name == "get_graph_binary") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        TVMByteArray arr;
+        arr.data = ret_.graph_binary.c_str();
+        arr.size = ret_.graph_binary.length();
+        *rv = arr;
+      });
     } else if (name == "get_module") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetModule(); });
@@ -142,11 +241,13 @@ class RelayBuildModule : public runtime::ModuleNode {
       });
     } else if (name == "get_irmodule") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-        *rv = this->graph_codegen_->GetIRModule();
+        // An incremental build reuses the library and lowers nothing.
+        *rv = this->graph_codegen_ ? this->graph_codegen_->GetIRModule() : Map<String, IRModule>();
       });
     } else if (name == "get_external_modules") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-        *rv = this->graph_codegen_->GetExternalModules();
+        *rv = this->graph_codegen_ ? this->graph_codegen_->GetExternalModules()
+                                   : Array<tvm::runtime::Module>();
       });
     } else if (name == "optimize") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
@@ -278,6 +379,7 @@ class RelayBuildModule : public runtime::ModuleNode {
         }
       }
     });
+    pass_seqs.push_back(transform::DeduplicateConstants());
     pass_seqs.push_back(transform::EliminateCommonSubexpr(fskip));
     pass_seqs.push_back(transform::SimplifyExpr());
     pass_seqs.push_back(transform::CombineParallelConv2D(3));
@@ -288,6 +390,14 @@ class RelayBuildModule : public runtime::ModuleNode {
     pass_seqs.push_back(transform::CanonicalizeCast());
     pass_seqs.push_back(transform::CanonicalizeOps());
 
+    // Offload dense epilogues to cuBLASLt when the model is built against cuBLAS.
+    if (targets.size() == 1) {
+      Target target = (*targets.begin()).second;
+      if (target->kind->name == "cuda" && target->GetLibs().count("cublas")) {
+        pass_seqs.push_back(transform::FuseDenseEpilogue());
+      }
+    }
+
     // Alter layout transformation is only applied to homogeneous execution yet.
     if (targets.size() == 1) {
       pass_seqs.push_back(transform::AlterOpLayout());
@@ -327,6 +437,21 @@ class RelayBuildModule : public runtime::ModuleNode {
     // inline functions. However, this should be very unlikely for accelerators
     // and vendor-provided libraries. So we don't handle for now.
     relay_module = transform::Inline()(relay_module);
+    // Lower the peak memory of the plan, the device planning does not follow lets.
+    if (targets.size() == 1 &&
+        pass_ctx->GetConfig<Bool>("relay.backend.reorder_for_memory", Bool(false)).value()) {
+      relay_module = transform::InferType()(relay_module);
+      relay_module = transform::ReorderForPeakMemory()(relay_module);
+      relay_module = transform::InferType()(relay_module);
+    }
+    // Recompute cheap activations of training graphs to fit the memory budget.
+    Integer remat_budget =
+        pass_ctx->GetConfig<Integer>("relay.backend.remat_budget", Integer(0)).value();
+    if (targets.size() == 1 && remat_budget->value > 0) {
+      relay_module = transform::InferType()(relay_module);
+      relay_module = transform::Rematerialize(remat_budget->value)(relay_module);
+      relay_module = transform::InferType()(relay_module);
+    }
     CHECK(relay_module.defined());
 
     return relay_module;
@@ -425,12 +550,27 @@ class RelayBuildModule : public runtime::ModuleNode {
     // Get the updated function.
     auto func = Downcast<Function>(relay_module->Lookup("main"));
 
+    bool incremental = transform::PassContext::Current()
+                           ->GetConfig<Bool>("relay.backend.incremental_build", Bool(false))
+                           .value();
+    ParamConstantAbstractor abstractor;
+    Function structure;
+    size_t build_key = 0;
+    if (incremental) {
+      Expr abstracted = abstractor(func);
+      structure = Function(abstractor.vars, abstracted, Type(), {});
+      build_key = dmlc::HashCombine(tvm::StructuralHash()(structure),
+                                    std::hash<std::string>()(BuildEnvironment()));
+      if (ReuseBuild(build_key, structure, abstractor.constants)) return;
+    }
+
     // Generate code for the updated function.
     graph_codegen_ = std::unique_ptr<GraphCodegen>(new GraphCodegen());
     graph_codegen_->Init(nullptr, targets_);
     graph_codegen_->Codegen(func);
 
     ret_.graph_json = graph_codegen_->GetJSON();
+    ret_.graph_binary = graph_codegen_->GetBinary();
     ret_.params = graph_codegen_->GetParams();
 
     auto lowered_funcs = graph_codegen_->GetIRModule();
@@ -463,9 +603,97 @@ class RelayBuildModule : public runtime::ModuleNode {
     // matter whether there are external modules or not.
     if (!ext_mods.empty()) {
       ret_.mod = tvm::codegen::CreateMetadataModule(ret_.params, ret_.mod, ext_mods);
+    } else if (incremental) {
+      SaveBuild(build_key, structure, abstractor.constants);
     }
   }
 
+  /*!
+   * \brief Describe everything besides the optimized function the generated
+   *  code depends on.
+   * \return The description.
+   */
+  std::string BuildEnvironment() {
+    auto pass_ctx = transform::PassContext::Current();
+    std::ostringstream os;
+    // Map iterates in hash order, sort the targets to keep the description stable.
+    std::map<int64_t, std::string> targets;
+    for (const auto& kv : targets_) {
+      targets[kv.first->value] = kv.second->str();
+    }
+    for (const auto& kv : targets) {
+      os << kv.first << '=' << kv.second << ';';
+    }
+    if (target_host_.defined()) {
+      os << "host=" << target_host_->str() << ';';
+    }
+    os << pass_ctx->opt_level << ';' << pass_ctx->config << ';';
+    // Tuning logs change the schedules, see the persistent compile cache.
+    if (const auto* f = runtime::Registry::Get("relay.backend.compile_cache_fingerprint")) {
+      std::string dispatch_fingerprint = (*f)();
+      os << dispatch_fingerprint;
+    }
+    return os.str();
+  }
+
+  /*!
+   * \brief Fill the build output from a previous build of the same structure.
+   * \param build_key The key of the build.
+   * \param structure The optimized main function with its params abstracted.
+   * \param constants The abstracted constants.
+   * \return Whether a previous build was reused.
+   */
+  bool ReuseBuild(size_t build_key, const Function& structure,
+                  const std::vector<Constant>& constants) {
+    auto* cache = IncrementalBuildCache::Global();
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    const IncrementalBuildEntry* found = cache->Find(build_key);
+    if (found == nullptr) return false;
+    const IncrementalBuildEntry& entry = *found;
+    if (!tvm::StructuralEqual()(entry.structure, structure)) return false;
+    ret_.graph_json = entry.graph_json;
+    ret_.graph_binary = entry.graph_binary;
+    ret_.mod = entry.mod;
+    graph_codegen_.reset();
+    ret_.params.clear();
+    for (size_t i = 0; i < constants.size(); ++i) {
+      if (!entry.param_names[i].empty()) {
+        ret_.params[entry.param_names[i]] = constants[i]->data;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Keep the current build output for later builds of the same structure.
+   * \param build_key The key of the build.
+   * \param structure The optimized main function with its params abstracted.
+   * \param constants The abstracted constants.
+   */
+  void SaveBuild(size_t build_key, const Function& structure,
+                 const std::vector<Constant>& constants) {
+    std::unordered_map<const Object*, std::string> param_names;
+    for (const auto& kv : ret_.params) {
+      param_names[kv.second.get()] = kv.first;
+    }
+    if (param_names.size() != ret_.params.size()) return;
+    IncrementalBuildEntry entry;
+    entry.structure = structure;
+    for (const auto& constant : constants) {
+      auto it = param_names.find(constant->data.get());
+      entry.param_names.push_back(it != param_names.end() ? it->second : std::string());
+      if (it != param_names.end()) param_names.erase(it);
+    }
+    // Only reusable when every param comes from an abstracted constant.
+    if (!param_names.empty()) return;
+    entry.graph_json = ret_.graph_json;
+    entry.graph_binary = ret_.graph_binary;
+    entry.mod = ret_.mod;
+    auto* cache = IncrementalBuildCache::Global();
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    cache->Put(build_key, std::move(entry));
+  }
+
  private:
   Target GetTargetHost() {
     Target target_host = target_host_;
@@ -511,6 +739,10 @@ TVM_REGISTER_GLOBAL("relay.build_module.BindParamsByName")
       *rv = relay::backend::BindParamsByName(args[0], params_);
     });
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.incremental_build", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.reorder_for_memory", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.remat_budget", Integer);
+
 }  // namespace backend
 }  // namespace relay
 }  // namespace tvm
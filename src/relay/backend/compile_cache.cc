@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/compile_cache.cc
+ * \brief Persistent on-disk cache of the functions lowered by the compile engine.
+ */
+#include "compile_cache.h"
+
+#include <tvm/ir/transform.h>
+#include <tvm/node/serialization.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/te/operation.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace tvm {
+namespace relay {
+
+namespace {
+/*! \brief Replace tensors by placeholders of the same signature. */
+Array<te::Tensor> Placeholders(const Array<te::Tensor>& tensors) {
+  Array<te::Tensor> ret;
+  for (const auto& tensor : tensors) {
+    ret.push_back(te::placeholder(tensor->shape, tensor->dtype, tensor->op->name));
+  }
+  return ret;
+}
+}  // namespace
+
+PersistentCompileCache::PersistentCompileCache() {
+  auto pass_ctx = transform::PassContext::Current();
+  dir_ = pass_ctx->GetConfig<String>("relay.backend.compile_cache_dir", String("")).value();
+  if (dir_.empty()) return;
+
+  std::ostringstream os;
+  os << TVM_VERSION;
+  // Map iterates in hash order, sort the configs to keep the fingerprint stable.
+  // The relay.backend configs only steer the build, not the lowered code.
+  std::map<std::string, std::string> configs;
+  for (const auto& kv : pass_ctx->config) {
+    std::string name = kv.first;
+    if (name.compare(0, 14, "relay.backend.") == 0) continue;
+    std::ostringstream value;
+    value << kv.second;
+    configs[name] = value.str();
+  }
+  for (const auto& kv : configs) {
+    os << ';' << kv.first << '=' << kv.second;
+  }
+  if (const auto* f = runtime::Registry::Get("relay.backend.compile_cache_fingerprint")) {
+    std::string dispatch_fingerprint = (*f)();
+    os << ';' << dispatch_fingerprint;
+  }
+  fingerprint_ = os.str();
+}
+
+std::string PersistentCompileCache::EntryPath(const CCacheKey& key) const {
+  size_t hash = dmlc::HashCombine(key->Hash(), std::hash<std::string>()(fingerprint_));
+  std::ostringstream os;
+  os << dir_ << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".json";
+  return os.str();
+}
+
+CachedFunc PersistentCompileCache::Load(const CCacheKey& key) const {
+  std::string path = EntryPath(key);
+  std::ifstream fs(path, std::ios::in);
+  if (!fs) return CachedFunc();
+  std::stringstream data;
+  data << fs.rdbuf();
+  try {
+    auto entry = Downcast<Map<String, ObjectRef>>(LoadJSON(data.str()));
+    if (std::string(Downcast<String>(entry.at("fingerprint"))) != fingerprint_ ||
+        std::string(Downcast<String>(entry.at("target"))) != key->target->str() ||
+        !tvm::StructuralEqual()(entry.at("source_func"), key->source_func)) {
+      return CachedFunc();
+    }
+    auto cfunc = Downcast<CachedFunc>(entry.at("cached_func"));
+    auto cache_node = make_object<CachedFuncNode>(*(cfunc.operator->()));
+    cache_node->target = key->target;
+    return CachedFunc(cache_node);
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Ignoring unreadable compile cache entry " << path << ": " << e.what();
+    return CachedFunc();
+  }
+}
+
+void PersistentCompileCache::Save(const CCacheKey& key, const CachedFunc& cfunc) const {
+  // The schedule is only needed for lowering, keep the tensor signatures only.
+  auto cache_node = make_object<CachedFuncNode>(*(cfunc.operator->()));
+  cache_node->target = Target();
+  cache_node->schedule = te::Schedule();
+  cache_node->inputs = Placeholders(cfunc->inputs);
+  cache_node->outputs = Placeholders(cfunc->outputs);
+  Map<String, ObjectRef> entry = {{"source_func", key->source_func},
+                                  {"target", String(key->target->str())},
+                                  {"fingerprint", String(fingerprint_)},
+                                  {"cached_func", CachedFunc(cache_node)}};
+
+  // Write a private file first so that concurrent builds never read a partial entry.
+  std::string path = EntryPath(key);
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp" << std::random_device()();
+  {
+    std::ofstream fs(tmp_path.str(), std::ios::out);
+    if (!fs) {
+      LOG(WARNING) << "Cannot write compile cache entry " << tmp_path.str();
+      return;
+    }
+    fs << SaveJSON(entry);
+  }
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.str().c_str());
+  }
+}
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.compile_cache_dir", String);
+
+}  // namespace relay
+}  // namespace tvm
@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/compile_cache.h
+ * \brief Persistent on-disk cache of the functions lowered by the compile engine.
+ */
+#ifndef TVM_RELAY_BACKEND_COMPILE_CACHE_H_
+#define TVM_RELAY_BACKEND_COMPILE_CACHE_H_
+
+#include <string>
+
+#include "compile_engine.h"
+
+namespace tvm {
+namespace relay {
+
+/*!
+ * \brief Persistent cache of lowered functions, stored as one json file per
+ *  entry in the directory given by the "relay.backend.compile_cache_dir" config.
+ *
+ *  Entries are addressed by the hash of the CCacheKey combined with a
+ *  fingerprint of everything else lowering depends on: the TVM version, the
+ *  tir pass configs and the schedule configs of the autotvm dispatch context.
+ *  The source function and the fingerprint are stored in the entry and
+ *  compared on load, so a hash collision falls back to lowering.
+ */
+class PersistentCompileCache {
+ public:
+  /*! \brief Create the cache configured by the current pass context. */
+  PersistentCompileCache();
+  /*! \return Whether the cache is enabled. */
+  bool enabled() const { return !dir_.empty(); }
+  /*!
+   * \brief Load the lowered function of key.
+   * \param key The key to the cached function.
+   * \return The function, undefined on a miss. The schedule of a loaded
+   *  function is not defined and its inputs and outputs are placeholders.
+   */
+  CachedFunc Load(const CCacheKey& key) const;
+  /*!
+   * \brief Store the lowered function of key.
+   * \param key The key to the cached function.
+   * \param cfunc The lowered function.
+   */
+  void Save(const CCacheKey& key, const CachedFunc& cfunc) const;
+
+ private:
+  /*! \return The path of the entry of key. */
+  std::string EntryPath(const CCacheKey& key) const;
+  /*! \brief The cache directory, empty when the cache is disabled. */
+  std::string dir_;
+  /*! \brief The fingerprint of the lowering environment. */
+  std::string fingerprint_;
+};
+
+}  // namespace relay
+}  // namespace tvm
+#endif  // TVM_RELAY_BACKEND_COMPILE_CACHE_H_
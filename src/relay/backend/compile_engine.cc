@@ -33,6 +33,7 @@
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule.h>
 #include <tvm/te/schedule_pass.h>
@@ -42,10 +43,12 @@
 #include <limits>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "../transforms/pass_util.h"
+#include "compile_cache.h"
 #include "utils.h"
 
 namespace tvm {
@@ -551,6 +554,53 @@ class CompileEngineImpl : public CompileEngineNode {
   // Lower the function.
   CachedFunc Lower(const CCacheKey& key) { return LowerInternal(key)->cached_func; }
 
+  Array<CachedFunc> LowerBatch(const Array<CCacheKey>& keys, int num_threads) final {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CCacheValue> values;
+    std::unordered_set<const CCacheValueNode*> scheduled;
+    // Schedule serially in key order: strategies may call back into python,
+    // and the unique names must not depend on thread timing.
+    std::vector<size_t> pending;
+    std::vector<ObjectPtr<CachedFuncNode>> pending_nodes;
+    PersistentCompileCache disk_cache;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      CCacheValue value = GetCacheEntry(keys[i]);
+      values.push_back(value);
+      if (value->cached_func.defined() || !scheduled.insert(value.operator->()).second) continue;
+      if (LoadFromDiskCache(disk_cache, keys[i], value)) continue;
+      auto cache_node = ScheduleEntry(keys[i], value);
+      if (cache_node != nullptr) {
+        pending.push_back(i);
+        pending_nodes.push_back(cache_node);
+      }
+    }
+    // The pass context is thread local, hand the caller's one to the workers.
+    auto pass_ctx = transform::PassContext::Current();
+    auto lower = [&](int i) {
+      With<transform::PassContext> pass_ctx_scope(pass_ctx);
+      With<Target> target_scope(keys[pending[i]]->target);
+      LowerSchedule(keys[pending[i]], pending_nodes[i].get());
+    };
+    int num_pending = static_cast<int>(pending.size());
+    if (num_threads <= 1 || num_pending <= 1) {
+      for (int i = 0; i < num_pending; ++i) lower(i);
+    } else {
+      support::parallel_for(0, num_pending, lower, 1,
+                            [num_threads](int begin, int end, int step, int) {
+                              return support::rr_partitioner(begin, end, step, num_threads);
+                            });
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+      values[pending[i]]->cached_func = CachedFunc(pending_nodes[i]);
+      if (disk_cache.enabled()) disk_cache.Save(keys[pending[i]], values[pending[i]]->cached_func);
+    }
+    Array<CachedFunc> ret;
+    for (const auto& value : values) {
+      ret.push_back(value->cached_func);
+    }
+    return ret;
+  }
+
   // For now, build one module per function.
   PackedFunc JIT(const CCacheKey& key) final {
     CCacheValue value = LowerInternal(key);
@@ -642,17 +692,81 @@ class CompileEngineImpl : public CompileEngineNode {
   // implement lowered func
   CCacheValue LowerInternal(const CCacheKey& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    CCacheValue value;
+    CCacheValue value = GetCacheEntry(key);
+    if (value->cached_func.defined()) return value;
+    PersistentCompileCache disk_cache;
+    if (LoadFromDiskCache(disk_cache, key, value)) return value;
+    auto cache_node = ScheduleEntry(key, value);
+    if (cache_node != nullptr) {
+      // Enforce use the target.
+      With<Target> target_scope(key->target);
+      LowerSchedule(key, cache_node.get());
+      value->cached_func = CachedFunc(cache_node);
+      if (disk_cache.enabled()) disk_cache.Save(key, value->cached_func);
+    }
+    return value;
+  }
+  /*!
+   * \brief Populate value from the persistent cache.
+   * \param disk_cache The persistent cache.
+   * \param key The key to the cached function.
+   * \param value The cache entry of key.
+   * \return Whether the function of key was found.
+   */
+  bool LoadFromDiskCache(const PersistentCompileCache& disk_cache, const CCacheKey& key,
+                         CCacheValue value) {
+    if (!disk_cache.enabled() || key->source_func->GetAttr<String>(attr::kCompiler).defined()) {
+      return false;
+    }
+    CachedFunc cfunc = disk_cache.Load(key);
+    if (!cfunc.defined()) return false;
+    // The name was unique in the process that stored the entry, not necessarily in this one.
+    std::string func_name = GetUniqueName(cfunc->func_name);
+    if (func_name != cfunc->func_name) {
+      auto cache_node = make_object<CachedFuncNode>(*(cfunc.operator->()));
+      cache_node->func_name = func_name;
+      cache_node->funcs = IRModule();
+      for (const auto& kv : cfunc->funcs->functions) {
+        if (kv.first->name_hint != cfunc->func_name) {
+          cache_node->funcs->Add(kv.first, kv.second);
+        } else if (const auto* prim_func = kv.second.as<tir::PrimFuncNode>()) {
+          auto renamed = WithAttr(GetRef<tir::PrimFunc>(prim_func), tvm::attr::kGlobalSymbol,
+                                  runtime::String(func_name));
+          cache_node->funcs->Add(GlobalVar(func_name), renamed);
+        } else {
+          return false;
+        }
+      }
+      cfunc = CachedFunc(cache_node);
+    }
+    value->cached_func = cfunc;
+    return true;
+  }
+  /*!
+   * \brief Find the cache entry of key, creating an empty one when missing.
+   * \param key The key to the cached function.
+   * \return The cache entry.
+   */
+  CCacheValue GetCacheEntry(const CCacheKey& key) {
     auto it = cache_.find(key);
     if (it != cache_.end()) {
       it->second->use_count += 1;
-      if (it->second->cached_func.defined()) return it->second;
-      value = it->second;
-    } else {
-      value = CCacheValue(make_object<CCacheValueNode>());
-      value->use_count = 0;
-      cache_[key] = value;
+      return it->second;
     }
+    CCacheValue value = CCacheValue(make_object<CCacheValueNode>());
+    value->use_count = 0;
+    cache_[key] = value;
+    return value;
+  }
+  /*!
+   * \brief Create the schedule of key and assign its unique function name.
+   * \param key The key to the cached function.
+   * \param value The cache entry of key.
+   * \return The scheduled function that still has to be lowered, or nullptr
+   *  when no lowering is needed and value has been populated directly.
+   */
+  ObjectPtr<CachedFuncNode> ScheduleEntry(const CCacheKey& key, CCacheValue value) {
+    CHECK(!value->cached_func.defined());
     // No need to lower external functions for now. We will invoke the external
     // codegen tool once and lower all functions together.
     if (key->source_func->GetAttr<String>(attr::kCompiler).defined()) {
@@ -663,12 +777,11 @@ class CompileEngineImpl : public CompileEngineNode {
       cache_node->target = tvm::target::ext_dev();
       cache_node->funcs->Add(GlobalVar(cache_node->func_name), key->source_func);
       value->cached_func = CachedFunc(cache_node);
-      return value;
+      return nullptr;
     }
     // Enforce use the target.
     With<Target> target_scope(key->target);
 
-    CHECK(!value->cached_func.defined());
     auto cfunc = CreateSchedule(key->source_func, key->target);
     auto cache_node = make_object<CachedFuncNode>(*(cfunc.operator->()));
 
@@ -677,11 +790,20 @@ class CompileEngineImpl : public CompileEngineNode {
     if (const CallNode* call_node = body.as<CallNode>()) {
       if (call_node->attrs.as<DeviceCopyAttrs>()) {
         value->cached_func = CachedFunc(cache_node);
-        return value;
+        return nullptr;
       }
     }
 
     cache_node->func_name = GetUniqueName(cache_node->func_name);
+    return cache_node;
+  }
+  /*!
+   * \brief Lower the schedule of a function produced by ScheduleEntry.
+   *  Only touches cache_node, so different functions can be lowered concurrently.
+   * \param key The key to the cached function.
+   * \param cache_node The scheduled function, its funcs field is populated.
+   */
+  void LowerSchedule(const CCacheKey& key, CachedFuncNode* cache_node) {
     // NOTE: array will copy on write.
     Array<te::Tensor> all_args = cache_node->inputs;
     for (te::Tensor arg : cache_node->outputs) {
@@ -689,16 +811,15 @@ class CompileEngineImpl : public CompileEngineNode {
     }
     // lower the function
     if (const auto* f = runtime::Registry::Get("relay.backend.lower")) {
-      cache_node->funcs = (*f)(cfunc->schedule, all_args, cache_node->func_name, key->source_func);
+      cache_node->funcs =
+          (*f)(cache_node->schedule, all_args, cache_node->func_name, key->source_func);
     } else {
       using tvm::transform::PassContext;
       With<PassContext> fresh_pass_ctx_scope(PassContext::Create());
 
       std::unordered_map<te::Tensor, tir::Buffer> binds;
-      cache_node->funcs = tvm::lower(cfunc->schedule, all_args, cache_node->func_name, binds);
+      cache_node->funcs = tvm::lower(cache_node->schedule, all_args, cache_node->func_name, binds);
     }
-    value->cached_func = CachedFunc(cache_node);
-    return value;
   }
   // implement lowered shape func
   CCacheValue LowerShapeFuncInternal(const CCacheKey& key) {
@@ -810,5 +931,7 @@ TVM_REGISTER_GLOBAL("relay.backend._CompileEngineJIT")
 TVM_REGISTER_GLOBAL("relay.backend._CompileEngineListItems").set_body_typed([](CompileEngine self) {
   return static_cast<CompileEngineImpl*>(self.operator->())->ListItems();
 });
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.num_build_threads", Integer);
 }  // namespace relay
 }  // namespace tvm
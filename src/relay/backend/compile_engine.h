@@ -202,6 +202,18 @@ class CompileEngineNode : public Object {
    * \return The result.
    */
   virtual CachedFunc Lower(const CCacheKey& key) = 0;
+  /*!
+   * \brief Lower a batch of keys, running the TIR lowering of the
+   *  independent functions on a pool of worker threads.
+   *
+   *  Scheduling and name assignment happen in the order of keys, so the
+   *  result is identical to calling Lower on each key in turn.
+   *
+   * \param keys The keys to the cached functions.
+   * \param num_threads The number of worker threads, lowers serially when <= 1.
+   * \return The lowered functions, one per key.
+   */
+  virtual Array<CachedFunc> LowerBatch(const Array<CCacheKey>& keys, int num_threads) = 0;
   /*!
    * \brief Just in time compile to get a PackedFunc.
    * \param key The key to the cached function.
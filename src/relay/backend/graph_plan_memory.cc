@@ -22,11 +22,20 @@
  * \brief Memory index assignment pass for executing
  *   the program in the graph runtime.
  */
+#include <tvm/ir/transform.h>
 #include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/transform.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "../../support/arena.h"
 
 namespace tvm {
@@ -48,6 +57,133 @@ struct StorageToken {
   int64_t storage_id{-1};
 };
 
+/*!
+ * \brief Get the function called, if it is a primitive function compiled by TVM.
+ * \param call The call.
+ * \return The function, or nullptr.
+ */
+const FunctionNode* GetPrimitiveFunction(const CallNode* call) {
+  const auto* func = call->op.as<FunctionNode>();
+  if (func == nullptr || !func->HasNonzeroAttr(attr::kPrimitive) ||
+      func->GetAttr<String>(attr::kCompiler).defined()) {
+    return nullptr;
+  }
+  return func;
+}
+
+/*!
+ * \brief Get the number of bytes of a tensor type with a static shape.
+ * \param ttype The tensor type.
+ * \return The number of bytes, or -1 if the shape is not static.
+ */
+int64_t GetStaticBytes(const TensorTypeNode* ttype) {
+  int64_t size = (ttype->dtype.bits() * ttype->dtype.lanes() + 7) / 8;
+  for (IndexExpr dim : ttype->shape) {
+    const int64_t* pval = tir::as_const_int(dim);
+    if (pval == nullptr) return -1;
+    size *= *pval;
+  }
+  return size;
+}
+
+/*!
+ * \brief Whether a call only changes the shape of its argument, such as a fused reshape, so
+ *  its output can share the storage of the argument.
+ *
+ *  The argument must be computed by another call, as the graph runtime can rebind the
+ *  storage of the inputs and params.
+ *
+ * \param call The call.
+ * \return Whether the call is a view of its argument.
+ */
+bool IsStorageView(const CallNode* call) {
+  static const std::vector<Op> view_ops = {Op::Get("reshape"), Op::Get("squeeze"),
+                                           Op::Get("expand_dims"),
+                                           Op::Get("contrib_reverse_reshape"),
+                                           Op::Get("nn.batch_flatten")};
+  const FunctionNode* func = GetPrimitiveFunction(call);
+  if (func == nullptr || func->params.size() != 1 || call->args.size() != 1) return false;
+  Expr arg = call->args[0];
+  if (const auto* get = arg.as<TupleGetItemNode>()) arg = get->tuple;
+  if (!arg.as<CallNode>() || !call->args[0]->checked_type().as<TensorTypeNode>()) return false;
+  Expr body = func->body;
+  while (const auto* inner = body.as<CallNode>()) {
+    if (inner->args.size() != 1 ||
+        std::find(view_ops.begin(), view_ops.end(), inner->op) == view_ops.end()) {
+      return false;
+    }
+    body = inner->args[0];
+  }
+  return body.same_as(func->params[0]);
+}
+
+/*! \brief The concatenation a call writes its output into. */
+struct ConcatSlice {
+  /*! \brief The call to the concatenation. */
+  const CallNode* concat;
+  /*! \brief The byte offset of the output of the call in the concatenation. */
+  int64_t offset;
+};
+
+/*!
+ * \brief Find the calls which can write their output directly into the output of the
+ *  concatenation which consumes it.
+ *
+ *  A fused concatenation qualifies when the dimensions before its axis are 1, so every input
+ *  is a contiguous slice of the output. An input qualifies when it is the tensor output of a
+ *  call that is used once by the concatenation, and its slice is aligned for the kernels. The
+ *  nested concatenations and the views are left alone, as their storage is already shared.
+ *
+ * \param func The function to plan.
+ * \return The slice of each qualifying call.
+ */
+std::unordered_map<const CallNode*, ConcatSlice> FindConcatSlices(const Function& func) {
+  static const Op& concat_op = Op::Get("concatenate");
+  std::unordered_map<const CallNode*, ConcatSlice> slices;
+  std::unordered_set<const CallNode*> sliced_concats;
+  PostOrderVisit(func->body, [&](const Expr& expr) {
+    const auto* call = expr.as<CallNode>();
+    if (call == nullptr) return;
+    const FunctionNode* prim_func = GetPrimitiveFunction(call);
+    if (prim_func == nullptr) return;
+    const auto* body = prim_func->body.as<CallNode>();
+    if (body == nullptr || body->op != concat_op || body->args.size() != 1) return;
+    const auto* fields = body->args[0].as<TupleNode>();
+    if (fields == nullptr || fields->fields.size() != prim_func->params.size() ||
+        call->args.size() != prim_func->params.size()) {
+      return;
+    }
+    for (size_t i = 0; i < fields->fields.size(); ++i) {
+      if (!fields->fields[i].same_as(prim_func->params[i])) return;
+    }
+    const auto* ttype = call->checked_type().as<TensorTypeNode>();
+    if (ttype == nullptr || GetStaticBytes(ttype) < 0) return;
+    int ndim = static_cast<int>(ttype->shape.size());
+    int axis = body->attrs.as<ConcatenateAttrs>()->axis;
+    axis = axis < 0 ? axis + ndim : axis;
+    for (int i = 0; i < axis; ++i) {
+      const int64_t* pval = tir::as_const_int(ttype->shape[i]);
+      if (pval == nullptr || *pval != 1) return;
+    }
+    int64_t offset = 0;
+    for (const Expr& arg : call->args) {
+      const auto* arg_type = arg->checked_type().as<TensorTypeNode>();
+      if (arg_type == nullptr) return;
+      int64_t bytes = GetStaticBytes(arg_type);
+      const auto* producer = arg.as<CallNode>();
+      if (producer != nullptr && offset % runtime::kAllocAlignment == 0 &&
+          !slices.count(producer) && !sliced_concats.count(producer) &&
+          std::count(call->args.begin(), call->args.end(), arg) == 1 &&
+          !IsStorageView(producer) && producer->checked_type().as<TensorTypeNode>()) {
+        slices[producer] = {call, offset};
+        sliced_concats.insert(call);
+      }
+      offset += bytes;
+    }
+  });
+  return slices;
+}
+
 class StorageAllocaBaseVisitor : public ExprVisitor {
  public:
   // run the visitor on a function.
@@ -196,13 +332,45 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     return total;
   }
 
+  /*!
+   * \return The number of bytes allocated on each device type, the
+   *  unannotated storage is reported under device type 0.
+   */
+  Map<Integer, Integer> DeviceAllocBytes() const {
+    std::map<int, int64_t> bytes;
+    for (const auto* p : data_) {
+      bytes[p->device_type] += static_cast<int64_t>(p->max_bytes);
+    }
+    Map<Integer, Integer> result;
+    for (const auto& kv : bytes) {
+      result.Set(Integer(kv.first), Integer(IntImm(DataType::Int(64), kv.second)));
+    }
+    return result;
+  }
+
   // Run storage allocation for a function.
   Map<Expr, Array<IntegerArray> > Plan(const Function& func) {
     prototype_ = StorageAllocaInit(&arena_).GetInitTokenMap(func);
+    if (transform::PassContext::Current()
+            ->GetConfig<Bool>("relay.backend.inplace_concat", Bool(false))
+            .value()) {
+      concat_slices_ = FindConcatSlices(func);
+      // A slice must live on the device of its concatenation.
+      for (auto it = concat_slices_.begin(); it != concat_slices_.end();) {
+        if (prototype_.at(it->first)[0]->device_type !=
+            prototype_.at(it->second.concat)[0]->device_type) {
+          it = concat_slices_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
     this->Run(func);
 
     // The value of smap contains two integer arrays where the first array
     // contains the planned storage ids and the second holds the device types.
+    // The outputs stored at an offset of their storage, in a concatenation,
+    // have a third array with the byte offsets.
     Map<Expr, Array<IntegerArray> > smap;
     int num_annotated_nodes = 0;
     int num_nodes = 0;
@@ -218,7 +386,13 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
         storage_ids.push_back(tok->storage_id);
         device_types.push_back(tok->device_type);
       }
-      smap.Set(GetRef<Expr>(kv.first), Array<IntegerArray>({storage_ids, device_types}));
+      auto offset = offsets_.find(kv.first);
+      if (offset != offsets_.end()) {
+        smap.Set(GetRef<Expr>(kv.first),
+                 Array<IntegerArray>({storage_ids, device_types, {Integer(offset->second)}}));
+      } else {
+        smap.Set(GetRef<Expr>(kv.first), Array<IntegerArray>({storage_ids, device_types}));
+      }
     }
     // Either all or none of the nodes should be annotated.
     if (num_annotated_nodes != 0 && num_annotated_nodes != num_nodes) {
@@ -261,7 +435,23 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
       }
     }
     // create token for the call node.
-    CreateToken(op, true);
+    auto slice = concat_slices_.find(op);
+    if (IsStorageView(op) && args.size() == 1) {
+      // The view shares the token of its argument, which stays alive for the uses of both.
+      args[0]->ref_counter += prototype_.at(op)[0]->ref_counter;
+      token_map_[op] = {args[0]};
+      auto offset = offsets_.find(op->args[0].get());
+      if (offset != offsets_.end()) {
+        offsets_[op] = offset->second;
+      }
+    } else if (slice != concat_slices_.end()) {
+      token_map_[op] = {GetConcatToken(slice->second.concat)};
+      offsets_[op] = slice->second.offset;
+    } else if (concat_tokens_.count(op)) {
+      token_map_[op] = {concat_tokens_.at(op)};
+    } else {
+      CreateToken(op, true);
+    }
     // check if there is orphaned output that can be released immediately.
     for (StorageToken* tok : token_map_.at(op)) {
       CheckForRelease(tok);
@@ -351,6 +541,25 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     data_.push_back(prototype);
     return prototype;
   }
+  /*!
+   * \brief Get the token of a concatenation, requested by the first of its slices.
+   * \param concat The concatenation.
+   * \return The token shared by the concatenation and its slices, which stays alive for the
+   *  uses of all of them.
+   */
+  StorageToken* GetConcatToken(const CallNode* concat) {
+    auto it = concat_tokens_.find(concat);
+    if (it != concat_tokens_.end()) return it->second;
+    StorageToken* tok = Request(prototype_.at(concat)[0]);
+    for (const Expr& arg : concat->args) {
+      auto slice = concat_slices_.find(arg.as<CallNode>());
+      if (slice != concat_slices_.end() && slice->second.concat == concat) {
+        tok->ref_counter += prototype_.at(slice->first)[0]->ref_counter;
+      }
+    }
+    concat_tokens_[concat] = tok;
+    return tok;
+  }
   /*!
    * \brief Check if we can release token.
    * \tok The token to be released.
@@ -374,6 +583,12 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   std::vector<StorageToken*> data_;
   /*! \brief internal prototype token map */
   std::unordered_map<const ExprNode*, std::vector<StorageToken*> > prototype_;
+  /*! \brief The calls writing their output into a concatenation */
+  std::unordered_map<const CallNode*, ConcatSlice> concat_slices_;
+  /*! \brief The tokens of the concatenations with slices */
+  std::unordered_map<const CallNode*, StorageToken*> concat_tokens_;
+  /*! \brief The byte offset of the outputs not stored at the start of their storage */
+  std::unordered_map<const ExprNode*, int64_t> offsets_;
 };
 
 Map<Expr, Array<IntegerArray> > GraphPlanMemory(const Function& func) {
@@ -382,5 +597,13 @@ Map<Expr, Array<IntegerArray> > GraphPlanMemory(const Function& func) {
 
 TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemory").set_body_typed(GraphPlanMemory);
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.inplace_concat", Bool);
+
+TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemoryBytes").set_body_typed([](const Function& func) {
+  StorageAllocator allocator;
+  allocator.Plan(func);
+  return allocator.DeviceAllocBytes();
+});
+
 }  // namespace relay
 }  // namespace tvm
@@ -24,11 +24,18 @@
 
 #include <dmlc/any.h>
 #include <dmlc/json.h>
+#include <dmlc/memory_io.h>
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/data_type.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/tir/analysis.h>
 
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -51,9 +58,15 @@ using GraphInputObjectPtr = std::shared_ptr<GraphInputNode>;
 using GraphOpObjectPtr = std::shared_ptr<GraphOpNode>;
 using TargetsMap = std::unordered_map<int, Target>;
 
+/*! \brief Magic number of the binary graph format, see GraphRuntimeCodegen::GetBinary. */
+constexpr uint64_t kTVMGraphBinaryMagic = 0xF7E58D4F05049CB9;
+/*! \brief Version of the binary graph format. */
+constexpr uint32_t kTVMGraphBinaryVersion = 1;
+
 /*! \brief Lowered outputs */
 struct LoweredOutput {
   std::string graph_json;
+  std::string graph_binary;
   Map<String, IRModule> lowered_funcs;
   Array<tvm::runtime::Module> external_mods;
   std::unordered_map<std::string, tvm::runtime::NDArray> params;
@@ -82,6 +95,10 @@ class GraphNodeRef {
 
   inline void Load(dmlc::JSONReader* reader) { LOG(FATAL) << "Not implemented."; }
 
+  int ident() const { return ident_; }
+  int index() const { return index_; }
+  int version() const { return version_; }
+
  protected:
   int ident_;
   int index_{0};
@@ -140,7 +157,7 @@ class GraphOpNode : public GraphNode {
     attrs_ = nd_attrs;
     op_name_ = op_name;
     inputs_ = inputs;
-    op_attrs_ = attrs_;
+    op_attrs_ = attrs;
     num_outputs_ = num_outputs;
     op_attrs_["func_name"] = op_name_;
     op_attrs_["flatten_data"] = std::string("0");
@@ -181,6 +198,50 @@ class GraphOpNode : public GraphNode {
   const std::string op_type_name_{"tvm_op"};
 };
 
+/*!
+ * \brief Collect the calls to primitive functions in the order
+ *  GraphRuntimeCodegen lowers them: a call before its arguments.
+ */
+class PrimitiveCallCollector : public ExprVisitor {
+ public:
+  // Visit the dataflow nodes with an explicit stack, in pre-order as the recursion would, as the
+  // recursion overflows the call stack on deep graphs.
+  void VisitExpr(const Expr& expr) final {
+    std::vector<Expr> stack{expr};
+    while (!stack.empty()) {
+      Expr node = stack.back();
+      stack.pop_back();
+      auto it = visit_counter_.find(node.get());
+      if (it != visit_counter_.end()) {
+        ++it->second;
+        continue;
+      }
+      if (const auto* call = node.as<CallNode>()) {
+        visit_counter_[call] = 1;
+        if (call->op.as<FunctionNode>()) {
+          calls.push_back(call);
+        }
+        for (auto arg = call->args.rbegin(); arg != call->args.rend(); ++arg) {
+          stack.push_back(*arg);
+        }
+      } else if (const auto* tuple = node.as<TupleNode>()) {
+        visit_counter_[tuple] = 1;
+        for (auto field = tuple->fields.rbegin(); field != tuple->fields.rend(); ++field) {
+          stack.push_back(*field);
+        }
+      } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+        visit_counter_[tuple_get] = 1;
+        stack.push_back(tuple_get->tuple);
+      } else {
+        ExprVisitor::VisitExpr(node);
+      }
+    }
+  }
+
+  /*! \brief The collected calls. */
+  std::vector<const CallNode*> calls;
+};
+
 /*! \brief Code generator for graph runtime */
 class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<GraphNodeRef>> {
  public:
@@ -197,12 +258,19 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       auto node_ptr = GraphInputNode::make_node_ptr(param->name_hint(), GraphAttrs());
       var_map_[param.get()] = AddNode(node_ptr, param);
     }
+    int num_threads = transform::PassContext::Current()
+                          ->GetConfig<Integer>("relay.backend.num_build_threads", Integer(1))
+                          .value();
+    if (num_threads > 1) {
+      LowerPrimitiveCalls(func->body, num_threads);
+    }
     heads_ = VisitExpr(func->body);
     std::ostringstream os;
     dmlc::JSONWriter writer(&os);
     GetJSON(&writer);
     LoweredOutput ret;
     ret.graph_json = os.str();
+    ret.graph_binary = GetBinary();
     ret.params = params_;
 
     for (auto& kv : lowered_funcs_) {
@@ -245,7 +313,7 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
     size_t count = storage_device_map_.count(expr);
     CHECK_GT(count, 0) << "Expr is not existing in storage plan";
     auto storage_device_info = storage_device_map_[expr];
-    CHECK_EQ(storage_device_info.size(), 2);
+    CHECK(storage_device_info.size() == 2 || storage_device_info.size() == 3);
     // storage
     std::vector<int64_t> storage_info;
     for (auto& v : storage_device_info[0]) {
@@ -266,6 +334,14 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
     if (num_unknown_devices == 0) {
       node->attrs_["device_index"] = device_types;
     }
+    // byte offset in the storage, when planned in a concatenation
+    if (storage_device_info.size() == 3) {
+      std::vector<int64_t> offsets;
+      for (auto& v : storage_device_info[2]) {
+        offsets.push_back(v->value);
+      }
+      node->attrs_["entry_offset"] = std::move(offsets);
+    }
     auto node_id = nodes_.size();
     nodes_.push_back(node);
     // Tuple return value, flatten as tuple
@@ -329,7 +405,8 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
   }
 
   std::vector<GraphNodeRef> GraphAddCallNode(const CallNode* op, const std::string& op_name,
-                                             const std::string& func_name) {
+                                             const std::string& func_name,
+                                             const GraphAttrs& op_attrs = GraphAttrs()) {
     std::vector<GraphNodeRef> inputs;
     for (auto arg : op->args) {
       auto res = VisitExpr(arg);
@@ -337,11 +414,76 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
         inputs.push_back(nr);
       }
     }
-    auto node = GraphOpNode::make_node_ptr(op_name, GraphAttrs(), func_name, inputs, GraphAttrs());
+    auto node = GraphOpNode::make_node_ptr(op_name, GraphAttrs(), func_name, inputs, op_attrs);
     return AddNode(node, GetRef<Expr>(op));
   }
 
+  // Translate the dataflow nodes with an explicit stack, as the recursion overflows the call stack
+  // on deep graphs. A call is lowered before its arguments are visited, and added to the graph
+  // after them, as the recursion would, so the graph is the same.
+  std::vector<GraphNodeRef> VisitExpr(const Expr& expr) override {
+    auto it = memo_.find(expr);
+    if (it != memo_.end()) return it->second;
+    struct Frame {
+      Expr node;
+      bool expanded;
+      CallNodeInfo info;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({expr, false, {}});
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      Expr node = frame.node;
+      if (memo_.count(node)) {
+        stack.pop_back();
+      } else if (frame.expanded) {
+        CallNodeInfo info = std::move(frame.info);
+        stack.pop_back();
+        if (const auto* call = node.as<CallNode>()) {
+          memo_[node] = GraphAddCallNode(call, info.op_name, info.func_name, info.attrs);
+        } else {
+          MemoizedExprTranslator::VisitExpr(node);
+        }
+      } else if (const auto* call = node.as<CallNode>()) {
+        frame.expanded = true;
+        frame.info = LowerCallNode(call);
+        for (auto arg = call->args.rbegin(); arg != call->args.rend(); ++arg) {
+          stack.push_back({*arg, false, {}});
+        }
+      } else if (const auto* tuple = node.as<TupleNode>()) {
+        frame.expanded = true;
+        for (auto field = tuple->fields.rbegin(); field != tuple->fields.rend(); ++field) {
+          stack.push_back({*field, false, {}});
+        }
+      } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+        frame.expanded = true;
+        stack.push_back({tuple_get->tuple, false, {}});
+      } else {
+        stack.pop_back();
+        MemoizedExprTranslator::VisitExpr(node);
+      }
+    }
+    return memo_.at(expr);
+  }
+
   std::vector<GraphNodeRef> VisitExpr_(const CallNode* op) override {
+    CallNodeInfo info = LowerCallNode(op);
+    return GraphAddCallNode(op, info.op_name, info.func_name, info.attrs);
+  }
+
+  /*! \brief The graph node of a call, known before its arguments are visited. */
+  struct CallNodeInfo {
+    std::string op_name;
+    std::string func_name;
+    GraphAttrs attrs;
+  };
+
+  /*!
+   * \brief Lower the function called.
+   * \param op The call to a primitive function.
+   * \return The graph node of the call.
+   */
+  CallNodeInfo LowerCallNode(const CallNode* op) {
     Expr expr = GetRef<Expr>(op);
     Function func;
     if (op->op.as<OpNode>()) {
@@ -358,15 +500,17 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       LOG(FATAL) << "TVM only support calls to primitive functions "
                  << "(i.e functions composed of fusable operator invocations)";
     }
+    if (IsPlannedInPlace(op)) {
+      return {_GetUniqueName("__nop"), "__nop", GraphAttrs()};
+    }
 
     auto pf0 = GetPackedFunc("relay.backend._make_CCacheKey");
-    auto pf1 = GetPackedFunc("relay.backend._CompileEngineLower");
     Target target;
     // Handle external function
     if (func->GetAttr<String>(attr::kCompiler).defined()) {
       target = tvm::target::ext_dev();
       CCacheKey key = (*pf0)(func, target);
-      CachedFunc ext_func = (*pf1)(compile_engine_, key);
+      CachedFunc ext_func = LowerCall(op, key);
       CHECK(ext_func.defined()) << "External function is not defined.";
 
       // Step into the functions that are handled by external codegen to
@@ -376,9 +520,72 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       ConstantUpdater const_visit(symobl, &params_);
       const_visit(func);
 
-      return GraphAddCallNode(op, ext_func->func_name, ext_func->func_name);
+      return {ext_func->func_name, ext_func->func_name, GraphAttrs()};
     }
 
+    target = GetCallTarget(expr);
+    CCacheKey key = (*pf0)(func, target);
+    CachedFunc lowered_func = LowerCall(op, key);
+    if (!lowered_funcs_.count(target->str())) {
+      lowered_funcs_[target->str()] = IRModule();
+    }
+    lowered_funcs_[target->str()]->Update(lowered_func->funcs);
+    return {_GetUniqueName(lowered_func->func_name), lowered_func->func_name,
+            RooflineAttrs(lowered_func)};
+  }
+
+  /*!
+   * \brief Whether the memory plan stores a call in the storage of all its arguments, as a
+   *  view or a concatenation of them, so the call has nothing left to compute.
+   * \param op The call.
+   * \return Whether the call can be skipped.
+   */
+  bool IsPlannedInPlace(const CallNode* op) {
+    IntegerArray storage_ids = storage_device_map_[GetRef<Expr>(op)][0];
+    if (storage_ids.size() != 1 || op->args.empty()) return false;
+    for (const Expr& arg : op->args) {
+      for (const auto& sid : storage_device_map_[arg][0]) {
+        if (sid->value != storage_ids[0]->value) return false;
+      }
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Get the static roofline estimate of a lowered function as node attributes,
+   *  so that the debug runtime can report it next to the measured time.
+   * \param lowered_func The lowered function.
+   * \return The flops, global memory bytes and arithmetic intensity of the function.
+   */
+  GraphAttrs RooflineAttrs(const CachedFunc& lowered_func) {
+    GraphAttrs attrs;
+    if (!lowered_func->funcs->ContainGlobalVar(lowered_func->func_name)) {
+      return attrs;
+    }
+    BaseFunc base_func = lowered_func->funcs->Lookup(lowered_func->func_name);
+    const auto* func = base_func.as<tir::PrimFuncNode>();
+    if (func == nullptr) {
+      return attrs;
+    }
+    Map<String, PrimExpr> roofline = tir::EstimateRoofline(GetRef<tir::PrimFunc>(func));
+    for (const char* key : {"flops", "bytes.global", "arithmetic_intensity"}) {
+      if (!roofline.count(key)) continue;
+      if (const auto* value = roofline.at(key).as<FloatImmNode>()) {
+        std::ostringstream os;
+        os << value->value;
+        attrs[key] = os.str();
+      }
+    }
+    return attrs;
+  }
+
+  /*!
+   * \brief Get the target a primitive call is compiled for.
+   * \param expr The call expression.
+   * \return The target.
+   */
+  Target GetCallTarget(const Expr& expr) {
+    Target target;
     CHECK_GE(storage_device_map_.count(expr), 0);
     auto& device_type = storage_device_map_[expr][1];
     auto call_dev_type = device_type[0]->value;
@@ -400,13 +607,46 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       }
       target = targets_[call_dev_type];
     }
-    CCacheKey key = (*pf0)(func, target);
-    CachedFunc lowered_func = (*pf1)(compile_engine_, key);
-    if (!lowered_funcs_.count(target->str())) {
-      lowered_funcs_[target->str()] = IRModule();
+    return target;
+  }
+
+  /*!
+   * \brief Lower all primitive calls in body ahead of the graph traversal,
+   *  running the TIR lowering on num_threads workers.
+   * \param body The body of the main function.
+   * \param num_threads The number of worker threads.
+   */
+  void LowerPrimitiveCalls(const Expr& body, int num_threads) {
+    PrimitiveCallCollector collector;
+    collector(body);
+    std::vector<const CallNode*> calls;
+    Array<CCacheKey> keys;
+    for (const CallNode* call : collector.calls) {
+      Function func = Downcast<Function>(call->op);
+      if (!func->HasNonzeroAttr(attr::kPrimitive)) continue;
+      Target target = func->GetAttr<String>(attr::kCompiler).defined()
+                          ? tvm::target::ext_dev()
+                          : GetCallTarget(GetRef<Expr>(call));
+      calls.push_back(call);
+      keys.push_back(CCacheKey(func, target));
+    }
+    Array<CachedFunc> lowered = compile_engine_->LowerBatch(keys, num_threads);
+    for (size_t i = 0; i < calls.size(); ++i) {
+      prelowered_[calls[i]] = lowered[i];
     }
-    lowered_funcs_[target->str()]->Update(lowered_func->funcs);
-    return GraphAddCallNode(op, _GetUniqueName(lowered_func->func_name), lowered_func->func_name);
+  }
+
+  /*!
+   * \brief Get the lowered function of a primitive call.
+   * \param op The call node.
+   * \param key The compile engine key of the call.
+   * \return The lowered function.
+   */
+  CachedFunc LowerCall(const CallNode* op, const CCacheKey& key) {
+    auto it = prelowered_.find(op);
+    if (it != prelowered_.end()) return it->second;
+    auto pf1 = GetPackedFunc("relay.backend._CompileEngineLower");
+    return (*pf1)(compile_engine_, key);
   }
 
   std::vector<GraphNodeRef> VisitExpr_(const LetNode* op) override {
@@ -461,19 +701,156 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
    * \param writer json writer
    */
   void GetJSON(dmlc::JSONWriter* writer) {
-    std::vector<size_t> arg_nodes;
-    for (size_t i = 0; i < nodes_.size(); ++i) {
-      auto node = nodes_[i];
-      if (node->Type() == kGraphInputNode) {
-        arg_nodes.push_back(i);
+    FlatAttrs flat = FlattenAttrs();
+    writer->BeginObject();
+    writer->WriteObjectKeyValue("nodes", nodes_);
+    writer->WriteObjectKeyValue("arg_nodes", flat.arg_nodes);
+    writer->WriteObjectKeyValue("heads", heads_);
+    std::unordered_map<std::string, std::vector<dmlc::any>> attrs;
+    attrs["shape"].emplace_back(std::string("list_shape"));
+    attrs["shape"].emplace_back(flat.shapes);
+    attrs["storage_id"].emplace_back(std::string("list_int"));
+    attrs["storage_id"].emplace_back(flat.storage_ids);
+    if (flat.device_types.size()) {
+      attrs["device_index"].emplace_back(std::string("list_int"));
+      attrs["device_index"].emplace_back(flat.device_types);
+    }
+    attrs["dltype"].emplace_back(std::string("list_str"));
+    attrs["dltype"].emplace_back(flat.dltypes);
+    if (flat.entry_offsets.size()) {
+      attrs["entry_offset"].emplace_back(std::string("list_int"));
+      attrs["entry_offset"].emplace_back(flat.entry_offsets);
+    }
+    if (flat.storage_offsets.size()) {
+      attrs["storage_offset"].emplace_back(std::string("list_int"));
+      attrs["storage_offset"].emplace_back(flat.storage_offsets);
+      attrs["arena_bytes"].emplace_back(std::string("size_t"));
+      attrs["arena_bytes"].emplace_back(static_cast<int64_t>(flat.arena_bytes));
+    }
+    writer->WriteObjectKeyValue("attrs", attrs);
+    writer->WriteObjectKeyValue("node_row_ptr", flat.node_row_ptr);
+    writer->EndObject();
+  }
+
+  /*!
+   * \brief Serialize the graph in the binary graph format.
+   *
+   * All fields are little endian and unpadded, in this order:
+   *  - uint64 kTVMGraphBinaryMagic, uint32 version, uint32 number of nodes;
+   *  - per node: op type, name and func_name as (uint32 length, bytes), uint32 num_inputs,
+   *    num_outputs and flatten_data, then uint32 input count and (node_id, index, version)
+   *    uint32 triples;
+   *  - uint32 count + uint32 arg_nodes, uint32 count + uint32 node_row_ptr, uint32 count +
+   *    heads as uint32 triples;
+   *  - uint32 number of entries, uint32 storage_id per entry, uint32 count (0 or number of
+   *    entries) + uint32 device_index, DLDataType per entry, uint32 ndim per entry and the
+   *    int64 dims of all shapes back to back;
+   *  - uint32 count + uint32 storage_offset and uint64 arena_bytes (0 count when unplanned).
+   *
+   * The format has no byte offset per entry, so the graphs with entries planned in a
+   * concatenation are only serialized as JSON.
+   *
+   * \return The serialized graph, empty if the graph cannot be serialized.
+   */
+  std::string GetBinary() {
+    FlatAttrs flat = FlattenAttrs();
+    if (flat.entry_offsets.size()) {
+      return std::string();
+    }
+    std::string bytes;
+    dmlc::MemoryStringStream strm(&bytes);
+    auto write_u32 = [&](size_t v) {
+      uint32_t u = static_cast<uint32_t>(v);
+      strm.Write(&u, sizeof(u));
+    };
+    auto write_str = [&](const std::string& str) {
+      write_u32(str.size());
+      strm.Write(str.data(), str.size());
+    };
+    auto write_ref = [&](const GraphNodeRef& ref) {
+      write_u32(ref.ident());
+      write_u32(ref.index());
+      write_u32(ref.version());
+    };
+    uint64_t magic = kTVMGraphBinaryMagic;
+    strm.Write(&magic, sizeof(magic));
+    write_u32(kTVMGraphBinaryVersion);
+    write_u32(nodes_.size());
+    for (const auto& node : nodes_) {
+      if (node->Type() == kGraphOpNode) {
+        auto* op_node = static_cast<GraphOpNode*>(node.get());
+        write_str("tvm_op");
+        write_str(op_node->name_);
+        write_str(op_node->op_name_);
+        write_u32(op_node->inputs_.size());
+        write_u32(op_node->num_outputs_);
+        write_u32(0);
+        write_u32(op_node->inputs_.size());
+        for (const auto& ref : op_node->inputs_) {
+          write_ref(ref);
+        }
+      } else {
+        write_str("null");
+        write_str(node->name_);
+        write_str("");
+        for (int i = 0; i < 4; ++i) {
+          write_u32(0);
+        }
       }
     }
-    size_t num_entry = 0;
+    write_u32(flat.arg_nodes.size());
+    for (size_t nid : flat.arg_nodes) write_u32(nid);
+    write_u32(flat.node_row_ptr.size());
+    for (size_t eid : flat.node_row_ptr) write_u32(eid);
+    write_u32(heads_.size());
+    for (const auto& ref : heads_) write_ref(ref);
+    write_u32(flat.storage_ids.size());
+    for (size_t sid : flat.storage_ids) write_u32(sid);
+    write_u32(flat.device_types.size());
+    for (size_t dev : flat.device_types) write_u32(dev);
+    for (const auto& dtype : flat.dltypes) {
+      DLDataType t = runtime::String2DLDataType(dtype);
+      strm.Write(&t, sizeof(t));
+    }
+    for (const auto& shape : flat.shapes) write_u32(shape.size());
+    for (const auto& shape : flat.shapes) {
+      strm.Write(shape.data(), sizeof(int64_t) * shape.size());
+    }
+    write_u32(flat.storage_offsets.size());
+    for (size_t offset : flat.storage_offsets) {
+      CHECK_LE(offset, std::numeric_limits<uint32_t>::max())
+          << "storage offset " << offset << " does not fit the binary graph format";
+      write_u32(offset);
+    }
+    uint64_t arena_bytes = flat.arena_bytes;
+    strm.Write(&arena_bytes, sizeof(arena_bytes));
+    return bytes;
+  }
+
+  /*! \brief Per-entry graph attributes, flattened in node order. */
+  struct FlatAttrs {
+    std::vector<size_t> arg_nodes;
     ShapeVector shapes;
     std::vector<size_t> storage_ids;
     std::vector<size_t> device_types;
     std::vector<std::string> dltypes;
     std::vector<size_t> node_row_ptr{0};
+    /*! \brief Byte offset of each entry in its storage, empty unless an entry has one. */
+    std::vector<size_t> entry_offsets;
+    /*! \brief Arena offset of each storage id, empty unless the static arena is enabled. */
+    std::vector<size_t> storage_offsets;
+    size_t arena_bytes{0};
+  };
+
+  FlatAttrs FlattenAttrs() {
+    FlatAttrs flat;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      auto node = nodes_[i];
+      if (node->Type() == kGraphInputNode) {
+        flat.arg_nodes.push_back(i);
+      }
+    }
+    size_t num_entry = 0;
     for (auto node : nodes_) {
       const auto& shape_vec = dmlc::get<ShapeVector>(node->attrs_["shape"]);
       const auto& storage_id = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_id"]);
@@ -482,33 +859,120 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
       CHECK_EQ(node->num_outputs_, shape_vec.size());
       num_entry += node->num_outputs_;
 
-      shapes.insert(shapes.end(), shape_vec.begin(), shape_vec.end());
-      dltypes.insert(dltypes.end(), dtype_vec.begin(), dtype_vec.end());
-      storage_ids.insert(storage_ids.end(), storage_id.begin(), storage_id.end());
+      flat.shapes.insert(flat.shapes.end(), shape_vec.begin(), shape_vec.end());
+      flat.dltypes.insert(flat.dltypes.end(), dtype_vec.begin(), dtype_vec.end());
+      flat.storage_ids.insert(flat.storage_ids.end(), storage_id.begin(), storage_id.end());
+      if (node->attrs_.count("entry_offset")) {
+        const auto& offsets = dmlc::get<std::vector<int64_t>>(node->attrs_["entry_offset"]);
+        flat.entry_offsets.resize(num_entry - node->num_outputs_, 0);
+        flat.entry_offsets.insert(flat.entry_offsets.end(), offsets.begin(), offsets.end());
+      }
       if (node->attrs_.count("device_index")) {
         const auto& dev_types = dmlc::get<std::vector<int64_t>>(node->attrs_["device_index"]);
-        device_types.insert(device_types.end(), dev_types.begin(), dev_types.end());
+        flat.device_types.insert(flat.device_types.end(), dev_types.begin(), dev_types.end());
       }
-      node_row_ptr.push_back(num_entry);
+      flat.node_row_ptr.push_back(num_entry);
     }
-    writer->BeginObject();
-    writer->WriteObjectKeyValue("nodes", nodes_);
-    writer->WriteObjectKeyValue("arg_nodes", arg_nodes);
-    writer->WriteObjectKeyValue("heads", heads_);
-    std::unordered_map<std::string, std::vector<dmlc::any>> attrs;
-    attrs["shape"].emplace_back(std::string("list_shape"));
-    attrs["shape"].emplace_back(shapes);
-    attrs["storage_id"].emplace_back(std::string("list_int"));
-    attrs["storage_id"].emplace_back(storage_ids);
-    if (device_types.size()) {
-      attrs["device_index"].emplace_back(std::string("list_int"));
-      attrs["device_index"].emplace_back(device_types);
+    if (flat.entry_offsets.size()) {
+      flat.entry_offsets.resize(num_entry, 0);
     }
-    attrs["dltype"].emplace_back(std::string("list_str"));
-    attrs["dltype"].emplace_back(dltypes);
-    writer->WriteObjectKeyValue("attrs", attrs);
-    writer->WriteObjectKeyValue("node_row_ptr", node_row_ptr);
-    writer->EndObject();
+    const auto& device_types = flat.device_types;
+    bool single_device = std::all_of(device_types.begin(), device_types.end(),
+                                     [&](size_t t) { return t == device_types[0]; });
+    auto pass_ctx = transform::PassContext::Current();
+    if (single_device && pass_ctx->GetConfig<Bool>("relay.backend.static_arena", Bool(false))
+                             .value()) {
+      flat.arena_bytes = PlanArena(flat.shapes, flat.storage_ids, flat.dltypes,
+                                   flat.node_row_ptr, &flat.storage_offsets);
+    }
+    return flat;
+  }
+
+  /*!
+   * \brief Place every storage id in a single arena.
+   *
+   * A storage id is live from the first node that writes it to the last node that reads it;
+   * graph inputs and outputs are live for the whole run. Storage ids are placed greedily,
+   * largest first, at the lowest aligned offset that does not collide with an already placed
+   * storage id whose live range overlaps.
+   *
+   * \param shapes Shape of each data entry.
+   * \param storage_ids Storage id of each data entry.
+   * \param dltypes Data type of each data entry.
+   * \param node_row_ptr Index of the first data entry of each node.
+   * \param offsets Filled with the byte offset of each storage id.
+   * \return The arena size in bytes.
+   */
+  size_t PlanArena(const ShapeVector& shapes, const std::vector<size_t>& storage_ids,
+                   const std::vector<std::string>& dltypes,
+                   const std::vector<size_t>& node_row_ptr, std::vector<size_t>* offsets) {
+    size_t num_storage = 0;
+    for (size_t sid : storage_ids) {
+      num_storage = std::max(num_storage, sid + 1);
+    }
+    const int num_nodes = static_cast<int>(nodes_.size());
+    std::vector<size_t> bytes(num_storage, 0);
+    std::vector<int> begin(num_storage, num_nodes), end(num_storage, -1);
+    auto touch = [&](size_t eid, int nid) {
+      size_t sid = storage_ids[eid];
+      begin[sid] = std::min(begin[sid], nid);
+      end[sid] = std::max(end[sid], nid);
+    };
+    for (int nid = 0; nid < num_nodes; ++nid) {
+      for (size_t eid = node_row_ptr[nid]; eid < node_row_ptr[nid + 1]; ++eid) {
+        DLDataType t = runtime::String2DLDataType(dltypes[eid]);
+        size_t size = 1;
+        for (int64_t dim : shapes[eid]) {
+          size *= static_cast<size_t>(dim);
+        }
+        size_t sid = storage_ids[eid];
+        bytes[sid] = std::max(bytes[sid], (t.bits * t.lanes + 7U) / 8U * size);
+        touch(eid, nid);
+        if (nodes_[nid]->Type() == kGraphInputNode) {
+          touch(eid, 0);
+          touch(eid, num_nodes);
+        }
+      }
+      if (nodes_[nid]->Type() == kGraphOpNode) {
+        for (const auto& ref : static_cast<GraphOpNode*>(nodes_[nid].get())->inputs_) {
+          touch(node_row_ptr[ref.ident()] + ref.index(), nid);
+        }
+      }
+    }
+    for (const auto& ref : heads_) {
+      touch(node_row_ptr[ref.ident()] + ref.index(), num_nodes);
+    }
+
+    std::vector<size_t> order(num_storage);
+    for (size_t i = 0; i < num_storage; ++i) {
+      order[i] = i;
+      bytes[i] = (bytes[i] + runtime::kAllocAlignment - 1) / runtime::kAllocAlignment *
+                 runtime::kAllocAlignment;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return bytes[a] > bytes[b]; });
+    offsets->assign(num_storage, 0);
+    std::vector<size_t> placed;
+    size_t arena_bytes = 0;
+    for (size_t sid : order) {
+      std::vector<size_t> conflicts;
+      for (size_t other : placed) {
+        if (begin[other] <= end[sid] && begin[sid] <= end[other]) {
+          conflicts.push_back(other);
+        }
+      }
+      std::sort(conflicts.begin(), conflicts.end(),
+                [&](size_t a, size_t b) { return (*offsets)[a] < (*offsets)[b]; });
+      size_t offset = 0;
+      for (size_t other : conflicts) {
+        if (offset + bytes[sid] <= (*offsets)[other]) break;
+        offset = std::max(offset, (*offsets)[other] + bytes[other]);
+      }
+      (*offsets)[sid] = offset;
+      placed.push_back(sid);
+      arena_bytes = std::max(arena_bytes, offset + bytes[sid]);
+    }
+    return arena_bytes;
   }
 
   /*!
@@ -548,6 +1012,8 @@ class GraphRuntimeCodegen : public backend::MemoizedExprTranslator<std::vector<G
   std::unordered_map<std::string, size_t> name_map_;
   /*! \brief compile engine */
   CompileEngine compile_engine_;
+  /*! \brief primitive calls lowered ahead of the traversal */
+  std::unordered_map<const CallNode*, CachedFunc> prelowered_;
 };
 
 class GraphRuntimeCodegenModule : public runtime::ModuleNode {
@@ -577,6 +1043,13 @@ class GraphRuntimeCodegenModule : public runtime::ModuleNode {
     } else if (name == "get_graph_json") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->output_.graph_json; });
+    } else if (name == "get_graph_binary") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        TVMByteArray arr;
+        arr.data = this->output_.graph_binary.c_str();
+        arr.size = this->output_.graph_binary.length();
+        *rv = arr;
+      });
     } else if (name == "list_params_name") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         Array<runtime::String> ret;
@@ -616,6 +1089,8 @@ runtime::Module CreateGraphCodegenMod() {
   return runtime::Module(ptr);
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.static_arena", Bool);
+
 TVM_REGISTER_GLOBAL("relay.build_module._GraphRuntimeCodegen")
     .set_body([](TVMArgs args, TVMRetValue* rv) { *rv = CreateGraphCodegenMod(); });
 
@@ -683,6 +1158,8 @@ struct Handler<std::vector<dmlc::any>> {
         writer->WriteArrayItem(dmlc::get<std::string>(v));
       } else if (SameType<int>(v)) {
         writer->WriteArrayItem(dmlc::get<int>(v));
+      } else if (SameType<int64_t>(v)) {
+        writer->WriteArrayItem(dmlc::get<int64_t>(v));
       } else if (SameType<std::vector<size_t>>(v)) {
         writer->WriteArrayItem(dmlc::get<std::vector<size_t>>(v));
       } else if (SameType<std::vector<std::vector<int64_t>>>(v)) {
@@ -32,6 +32,13 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/object.h>
 
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "compile_engine.h"
 
 namespace tvm {
@@ -202,6 +209,80 @@ InterpreterState::InterpreterState(Expr current_expr, InterpreterState::Stack st
   data_ = std::move(n);
 }
 
+/*!
+ * \brief The primitive functions compiled for the interpreters, shared by all of them.
+ *
+ *  The functions are keyed by their target, the pass context they are lowered in, and
+ *  their structure, which includes the shapes of their parameters. Unlike the cache of
+ *  the compile engine, which relay.build clears after every build, the entries are kept
+ *  until ClearInterpreterCache, so FoldConstant and the debug executor do not recompile
+ *  the same operators build after build.
+ */
+class InterpreterFuncCache {
+ public:
+  static InterpreterFuncCache* Global() {
+    static InterpreterFuncCache* inst = new InterpreterFuncCache();
+    return inst;
+  }
+
+  /*!
+   * \brief Get the key of the functions lowered for target in the current pass context.
+   *  The lowering depends on its opt_level, required and disabled passes and configs.
+   */
+  static std::string ContextKey(const Target& target) {
+    transform::PassContext pass_ctx = transform::PassContext::Current();
+    std::ostringstream os;
+    os << target->str() << ';' << pass_ctx->opt_level << ';' << pass_ctx->required_pass << ';'
+       << pass_ctx->disabled_pass;
+    // Map iterates in hash order, sort the configs to keep the key stable.
+    std::map<std::string, std::string> configs;
+    for (const auto& kv : pass_ctx->config) {
+      std::ostringstream value;
+      value << kv.second;
+      configs[kv.first] = value.str();
+    }
+    for (const auto& kv : configs) {
+      os << ';' << kv.first << '=' << kv.second;
+    }
+    return os.str();
+  }
+
+  PackedFunc Get(CompileEngine engine, const Function& func, const Target& target,
+                 const std::string& context_key) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& funcs = funcs_[context_key];
+      auto it = funcs.find(func);
+      if (it != funcs.end()) return it->second;
+    }
+    // Compile outside of the lock, the engine serializes the compilations itself.
+    PackedFunc packed_func = engine->JIT(CCacheKey(func, target));
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& funcs = funcs_[context_key];
+    if (funcs.size() >= kMaxFuncsPerTarget) funcs.clear();
+    funcs.emplace(func, packed_func);
+    return packed_func;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    funcs_.clear();
+  }
+
+ private:
+  /*! \brief The entries of a target and context are dropped all at once past this size. */
+  static constexpr size_t kMaxFuncsPerTarget = 4096;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string,
+                     std::unordered_map<Function, PackedFunc, StructuralHash, StructuralEqual>>
+      funcs_;
+};
+
+void ClearInterpreterCache() { InterpreterFuncCache::Global()->Clear(); }
+
+TVM_REGISTER_GLOBAL("relay.backend.ClearInterpreterCache").set_body_typed(ClearInterpreterCache);
+
 // NOTE: the current interpreter assumes A-normal form.
 // which is better for execution.
 //
@@ -213,7 +294,11 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
                     PatternFunctor<bool(const Pattern& p, const ObjectRef& v)> {
  public:
   Interpreter(IRModule mod, DLContext context, Target target)
-      : mod_(mod), context_(context), target_(target), debug_op_(Op::Get("debug")) {
+      : mod_(mod),
+        context_(context),
+        target_(target),
+        cache_key_(InterpreterFuncCache::ContextKey(target)),
+        debug_op_(Op::Get("debug")) {
     engine_ = CompileEngine::Global();
   }
 
@@ -397,6 +482,41 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
     return out_shapes;
   }
 
+  /*! \brief The state kept across the calls of a primitive function. */
+  struct PrimitiveCall {
+    /*! \brief The function, which keeps the key of the call alive. */
+    Function func;
+    PackedFunc packed_func;
+    /*! \brief The arguments of the last call, reused to avoid reallocating them. */
+    std::vector<TVMValue> values;
+    std::vector<int> codes;
+    /*! \brief The outputs of the last call, reused once nothing else refers to them. */
+    std::vector<NDArray> outputs;
+  };
+
+  PrimitiveCall& GetPrimitiveCall(const Function& func) {
+    auto it = prim_calls_.find(func.get());
+    if (it != prim_calls_.end()) return it->second;
+    PrimitiveCall& call = prim_calls_[func.get()];
+    call.func = func;
+    call.packed_func = InterpreterFuncCache::Global()->Get(engine_, func, target_, cache_key_);
+    return call;
+  }
+
+  NDArray AllocOutput(PrimitiveCall* call, size_t i, const std::vector<int64_t>& shape,
+                      DLDataType dtype) {
+    if (call->outputs.size() <= i) call->outputs.resize(i + 1);
+    NDArray& out = call->outputs[i];
+    // The previous output can be overwritten when the call holds its only reference.
+    if (out.defined() && out.unique() && out->ctx.device_type == context_.device_type &&
+        out->ctx.device_id == context_.device_id && TypeEqual(out->dtype, dtype) &&
+        out.Shape() == shape) {
+      return out;
+    }
+    out = NDArray::Empty(shape, dtype, context_);
+    return out;
+  }
+
   ObjectRef InvokePrimitiveOp(const Function& func, const Array<ObjectRef>& args) {
     const auto* call_node = func->body.as<CallNode>();
 
@@ -431,8 +551,11 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
       CHECK(func->body->checked_type().as<TensorTypeNode>()) << func->body->checked_type();
       arg_len += 1;
     }
-    std::vector<TVMValue> values(arg_len);
-    std::vector<int> codes(arg_len);
+    PrimitiveCall& call = GetPrimitiveCall(func);
+    std::vector<TVMValue>& values = call.values;
+    std::vector<int>& codes = call.codes;
+    values.resize(arg_len);
+    codes.resize(arg_len);
     TVMArgsSetter setter(values.data(), codes.data());
 
     auto fset_input = [&](size_t i, ObjectRef val) {
@@ -470,7 +593,7 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
         shape.push_back(ivalue[0]);
       }
       DLDataType dtype = rtype->dtype;
-      NDArray nd_array = NDArray::Empty(shape, dtype, context_);
+      NDArray nd_array = AllocOutput(&call, i, shape, dtype);
       setter(num_inputs + i, nd_array);
       return nd_array;
     };
@@ -484,7 +607,7 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
       out_shapes = ComputeDynamicShape(func, args);
     }
 
-    PackedFunc packed_func = engine_->JIT(CCacheKey(func, target_));
+    const PackedFunc& packed_func = call.packed_func;
     TVMRetValue rv;
     if (const TupleTypeNode* rtype = func->body->checked_type().as<TupleTypeNode>()) {
       CHECK(!is_dyn || out_shapes.size() == rtype->fields.size());
@@ -707,12 +830,16 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
   DLContext context_;
   // Target parameter being used by the interpreter.
   Target target_;
+  // The key of the functions compiled for target_ in the pass context of the interpreter.
+  std::string cache_key_;
   // Object stack.
   Stack stack_;
   // Backend compile engine.
   CompileEngine engine_;
   // Cache ops that need to be frequently used later to reduce lookup overhead.
   const Op& debug_op_;
+  // The compiled primitive functions and their buffers, by function.
+  std::unordered_map<const FunctionNode*, PrimitiveCall> prim_calls_;
 };
 
 TypedPackedFunc<ObjectRef(Expr)> CreateInterpreter(IRModule mod, DLContext context, Target target) {
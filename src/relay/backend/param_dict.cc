@@ -68,6 +68,74 @@ TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict").set_body([](TVMArgs args, TVMR
   *rv = arr;
 });
 
+TVM_REGISTER_GLOBAL("tvm.relay._save_param_dict_mapped")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      CHECK_EQ(args.size() % 2, 0u);
+      CHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Mapped parameters require a little endian host";
+      size_t num_params = args.size() / 2;
+      std::vector<std::string> names;
+      names.reserve(num_params);
+      std::vector<DLTensor*> arrays;
+      arrays.reserve(num_params);
+      for (size_t i = 0; i < num_params * 2; i += 2) {
+        names.emplace_back(args[i].operator String());
+        arrays.emplace_back(args[i + 1].operator DLTensor*());
+      }
+      std::vector<uint64_t> nbytes(num_params);
+      for (size_t i = 0; i < num_params; ++i) {
+        nbytes[i] = GetDataSize(*arrays[i]);
+      }
+      // The header is written twice: once to measure it, then with the real offsets.
+      auto write_header = [&](dmlc::Stream* fo, const std::vector<uint64_t>& offsets) {
+        uint64_t header = kTVMMappedNDArrayListMagic, alignment = kMappedParamsAlignment;
+        fo->Write(header);
+        fo->Write(alignment);
+        fo->Write(names);
+        uint64_t sz = static_cast<uint64_t>(num_params);
+        fo->Write(sz);
+        for (size_t i = 0; i < num_params; ++i) {
+          fo->Write(arrays[i]->dtype);
+          fo->Write(arrays[i]->ndim);
+          fo->WriteArray(arrays[i]->shape, arrays[i]->ndim);
+          fo->Write(offsets[i]);
+          fo->Write(nbytes[i]);
+        }
+      };
+      auto align = [](uint64_t offset) {
+        return (offset + kMappedParamsAlignment - 1) / kMappedParamsAlignment *
+               kMappedParamsAlignment;
+      };
+      std::string bytes;
+      std::vector<uint64_t> offsets(num_params, 0);
+      {
+        dmlc::MemoryStringStream strm(&bytes);
+        write_header(&strm, offsets);
+      }
+      uint64_t offset = align(bytes.size());
+      for (size_t i = 0; i < num_params; ++i) {
+        offsets[i] = offset;
+        offset = align(offset + nbytes[i]);
+      }
+      bytes.clear();
+      {
+        dmlc::MemoryStringStream strm(&bytes);
+        write_header(&strm, offsets);
+      }
+      bytes.resize(offset, '\0');
+      for (size_t i = 0; i < num_params; ++i) {
+        DLTensor dst = *arrays[i];
+        dst.data = &bytes[offsets[i]];
+        dst.ctx = TVMContext{kDLCPU, 0};
+        dst.strides = nullptr;
+        dst.byte_offset = 0;
+        NDArray::CopyFromTo(arrays[i], &dst);
+      }
+      TVMByteArray arr;
+      arr.data = bytes.c_str();
+      arr.size = bytes.length();
+      *rv = arr;
+    });
+
 TVM_REGISTER_GLOBAL("tvm.relay._load_param_dict").set_body([](TVMArgs args, TVMRetValue* rv) {
   std::string bytes = args[0];
   std::vector<std::string> names;
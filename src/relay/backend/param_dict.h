@@ -36,6 +36,10 @@ namespace relay {
 
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
+/*! \brief Magic number for the memory-mappable NDArray list file  */
+constexpr uint64_t kTVMMappedNDArrayListMagic = 0xF7E58D4F05049CB8;
+/*! \brief Alignment of each tensor payload in the memory-mappable file  */
+constexpr uint64_t kMappedParamsAlignment = 4096;
 
 /*!
  * \brief Wrapper node for naming `NDArray`s.
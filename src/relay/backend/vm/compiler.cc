@@ -55,6 +55,7 @@ namespace transform {
 
 Pass LambdaLift();
 Pass InlinePrimitives();
+Pass SpecializeShapeBuckets(Array<Integer> buckets);
 
 Pass ManifestAlloc(Target target_host) {
   auto f = tvm::runtime::Registry::Get("relay.transform.ManifestAlloc");
@@ -283,6 +284,7 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
       case Opcode::Invoke:
       case Opcode::AllocClosure:
       case Opcode::AllocStorage:
+      case Opcode::AllocStorageTensor:
       case Opcode::ShapeOf:
       case Opcode::ReshapeTensor:
       case Opcode::Move:
@@ -847,12 +849,16 @@ void VMCompiler::Lower(IRModule mod, const TargetsMap& targets, const tvm::Targe
   // the global state.
   exec_->functions.resize(context_.module->functions.size());
 
+  bool fuse_bytecode =
+      transform::PassContext::Current()->GetConfig<Bool>("relay.vm.fuse_bytecode", Bool(true))
+          .value();
   for (auto named_func : context_.module->functions) {
     auto gvar = named_func.first;
     if (auto* n = named_func.second.as<FunctionNode>()) {
       auto func = GetRef<Function>(n);
       VMFunctionCompiler func_compiler(&context_, targets_, target_host_);
-      auto vm_func = func_compiler.Compile(gvar, func);
+      auto compiled = func_compiler.Compile(gvar, func);
+      auto vm_func = fuse_bytecode ? FuseBytecode(compiled) : compiled;
 
       size_t func_index = context_.global_map.at(gvar);
       CHECK(func_index < exec_->functions.size());
@@ -956,6 +962,7 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const TargetsMap& targe
     }
     *rv = false;
   });
+  pass_seqs.push_back(transform::DeduplicateConstants());
   pass_seqs.push_back(transform::EliminateCommonSubexpr(fskip));
   pass_seqs.push_back(transform::SimplifyExpr());
   pass_seqs.push_back(transform::InlinePrimitives());
@@ -978,6 +985,18 @@ IRModule VMCompiler::OptimizeModule(const IRModule& mod, const TargetsMap& targe
   pass_seqs.push_back(transform::FoldConstant());
 
   pass_seqs.push_back(transform::FuseOps());
+
+  // Specialize the dynamic fused functions for the configured extents, then
+  // fuse the operators of the dispatch.
+  Array<Integer> shape_buckets =
+      transform::PassContext::Current()
+          ->GetConfig<Array<Integer>>("relay.vm.shape_buckets", Array<Integer>())
+          .value();
+  if (!shape_buckets.empty()) {
+    pass_seqs.push_back(transform::SpecializeShapeBuckets(shape_buckets));
+    pass_seqs.push_back(transform::FuseOps());
+  }
+
   pass_seqs.push_back(transform::ToANormalForm());
   pass_seqs.push_back(transform::LambdaLift());
   pass_seqs.push_back(transform::InlinePrimitives());
@@ -1066,6 +1085,9 @@ runtime::Module CreateVMCompiler() {
   return runtime::Module(exec);
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.vm.fuse_bytecode", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.vm.shape_buckets", Array<Integer>);
+
 TVM_REGISTER_GLOBAL("relay._vm._VMCompiler").set_body([](TVMArgs args, TVMRetValue* rv) {
   *rv = CreateVMCompiler();
 });
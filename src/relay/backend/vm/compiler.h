@@ -130,6 +130,18 @@ class VMCompiler : public runtime::ModuleNode {
   std::unordered_map<std::string, runtime::NDArray> params_;
 };
 
+/*!
+ * \brief Rewrite the bytecode of a lowered function into fewer instructions.
+ *
+ * Storage allocations feeding a single tensor allocation are fused into
+ * AllocStorageTensor, and moves out of single-use temporaries are folded
+ * into the instruction producing the value.
+ *
+ * \param func The lowered function.
+ * \return The function with its instructions rewritten.
+ */
+VMFunction FuseBytecode(const VMFunction& func);
+
 }  // namespace vm
 }  // namespace relay
 }  // namespace tvm
@@ -0,0 +1,275 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/relay/backend/vm/fuse_bytecode.cc
+ * \brief Fuse common instruction sequences of a lowered VM function into
+ *  superinstructions and fold away redundant register moves.
+ */
+
+#include <tvm/runtime/vm/bytecode.h>
+#include <tvm/runtime/vm/vm.h>
+#include <tvm/support/logging.h>
+
+#include <unordered_set>
+#include <vector>
+
+#include "compiler.h"
+
+namespace tvm {
+namespace relay {
+namespace vm {
+
+/*! \brief Call \p f on every register \p instr reads. */
+template <typename F>
+void ForEachReadRegister(const Instruction& instr, F f) {
+  switch (instr.op) {
+    case Opcode::Move:
+      f(instr.from);
+      break;
+    case Opcode::Ret:
+      f(instr.result);
+      break;
+    case Opcode::Invoke:
+      for (Index i = 0; i < instr.num_args; ++i) f(instr.invoke_args_registers[i]);
+      break;
+    case Opcode::InvokeClosure:
+      f(instr.closure);
+      for (Index i = 0; i < instr.num_closure_args; ++i) f(instr.closure_args[i]);
+      break;
+    case Opcode::InvokePacked:
+      for (Index i = 0; i < instr.arity; ++i) f(instr.packed_args[i]);
+      break;
+    case Opcode::AllocTensor:
+      f(instr.alloc_tensor.storage);
+      f(instr.alloc_tensor.offset);
+      break;
+    case Opcode::AllocTensorReg:
+      f(instr.alloc_tensor_reg.storage);
+      f(instr.alloc_tensor_reg.offset);
+      f(instr.alloc_tensor_reg.shape_register);
+      break;
+    case Opcode::AllocADT:
+      for (Index i = 0; i < instr.num_fields; ++i) f(instr.datatype_fields[i]);
+      break;
+    case Opcode::AllocClosure:
+      for (Index i = 0; i < instr.num_freevar; ++i) f(instr.free_vars[i]);
+      break;
+    case Opcode::GetField:
+      f(instr.object);
+      break;
+    case Opcode::If:
+      f(instr.if_op.test);
+      f(instr.if_op.target);
+      break;
+    case Opcode::GetTag:
+      f(instr.get_tag.object);
+      break;
+    case Opcode::AllocStorage:
+      f(instr.alloc_storage.allocation_size);
+      break;
+    case Opcode::AllocStorageTensor:
+      f(instr.alloc_storage_tensor.allocation_size);
+      f(instr.alloc_storage_tensor.offset);
+      break;
+    case Opcode::ShapeOf:
+      f(instr.shape_of.tensor);
+      break;
+    case Opcode::ReshapeTensor:
+      f(instr.reshape_tensor.tensor);
+      f(instr.reshape_tensor.newshape);
+      break;
+    case Opcode::LoadConst:
+    case Opcode::LoadConsti:
+    case Opcode::Goto:
+    case Opcode::Fatal:
+      break;
+  }
+}
+
+/*! \brief Whether \p instr writes its result to instr.dst. */
+bool WritesDst(const Instruction& instr) {
+  switch (instr.op) {
+    case Opcode::InvokePacked:
+    case Opcode::If:
+    case Opcode::Ret:
+    case Opcode::Goto:
+    case Opcode::Fatal:
+      return false;
+    default:
+      return true;
+  }
+}
+
+/*! \brief Per-function facts the rewrites below rely on. */
+struct BytecodeInfo {
+  /*! \brief The number of instructions reading each register. */
+  std::vector<int> reads;
+  /*! \brief The number of instructions writing each register. */
+  std::vector<int> writes;
+  /*! \brief The program counters some jump lands on. */
+  std::unordered_set<Index> jump_targets;
+
+  explicit BytecodeInfo(const VMFunction& func)
+      : reads(func.register_file_size, 0), writes(func.register_file_size, 0) {
+    const auto& code = func.instructions;
+    for (Index pc = 0; pc < static_cast<Index>(code.size()); ++pc) {
+      const auto& instr = code[pc];
+      ForEachReadRegister(instr, [this](RegName reg) { reads[reg]++; });
+      if (WritesDst(instr)) writes[instr.dst]++;
+      if (instr.op == Opcode::Goto) {
+        jump_targets.insert(pc + instr.pc_offset);
+      } else if (instr.op == Opcode::If) {
+        jump_targets.insert(pc + instr.if_op.true_offset);
+        jump_targets.insert(pc + instr.if_op.false_offset);
+      }
+    }
+  }
+};
+
+/*!
+ * \brief Accumulates a rewritten instruction stream and relinks the jumps of
+ *  the original stream onto it.
+ */
+class BytecodeBuilder {
+ public:
+  explicit BytecodeBuilder(const std::vector<Instruction>& code)
+      : code_(code), new_pc_(code.size() + 1, -1) {}
+
+  /*! \brief Start the output for original instruction \p pc. */
+  void Map(Index pc) { new_pc_[pc] = out_.size(); }
+
+  /*! \brief Append \p instr, which stands for original instruction \p pc. */
+  void Emit(const Instruction& instr, Index pc) {
+    origin_.push_back(pc);
+    out_.push_back(instr);
+  }
+
+  std::vector<Instruction> Finish() {
+    // Instructions that were folded away map onto the next emitted one.
+    new_pc_[code_.size()] = out_.size();
+    for (Index pc = code_.size() - 1; pc >= 0; --pc) {
+      if (new_pc_[pc] < 0) new_pc_[pc] = new_pc_[pc + 1];
+    }
+    for (size_t i = 0; i < out_.size(); ++i) {
+      Index pc = origin_[i];
+      Index npc = static_cast<Index>(i);
+      auto& instr = out_[i];
+      if (instr.op == Opcode::Goto) {
+        instr.pc_offset = new_pc_[pc + instr.pc_offset] - npc;
+      } else if (instr.op == Opcode::If) {
+        instr.if_op.true_offset = new_pc_[pc + instr.if_op.true_offset] - npc;
+        instr.if_op.false_offset = new_pc_[pc + instr.if_op.false_offset] - npc;
+      }
+    }
+    return std::move(out_);
+  }
+
+ private:
+  const std::vector<Instruction>& code_;
+  std::vector<Index> new_pc_;
+  std::vector<Index> origin_;
+  std::vector<Instruction> out_;
+};
+
+/*!
+ * \brief Fuse `AllocStorage $s; [LoadConst(i) $o;] AllocTensor $s $o` into
+ *  `[LoadConst(i) $o;] AllocStorageTensor`, when the storage is not used elsewhere.
+ */
+std::vector<Instruction> FuseAllocStorageTensor(const VMFunction& func) {
+  const auto& code = func.instructions;
+  BytecodeInfo info(func);
+  BytecodeBuilder builder(code);
+  Index n = code.size();
+  for (Index pc = 0; pc < n; ++pc) {
+    const auto& instr = code[pc];
+    builder.Map(pc);
+    if (instr.op == Opcode::AllocStorage && info.writes[instr.dst] == 1 &&
+        info.reads[instr.dst] == 1) {
+      RegName storage = instr.dst;
+      Index next = pc + 1;
+      // The offset is usually materialized right before the tensor allocation.
+      bool has_offset =
+          next < n &&
+          (code[next].op == Opcode::LoadConst || code[next].op == Opcode::LoadConsti) &&
+          code[next].dst != instr.alloc_storage.allocation_size && code[next].dst != storage &&
+          !info.jump_targets.count(next);
+      Index tensor_pc = has_offset ? next + 1 : next;
+      if (tensor_pc < n && !info.jump_targets.count(tensor_pc) &&
+          code[tensor_pc].op == Opcode::AllocTensor &&
+          code[tensor_pc].alloc_tensor.storage == storage) {
+        const auto& alloc = code[tensor_pc].alloc_tensor;
+        if (has_offset) {
+          builder.Map(next);
+          builder.Emit(code[next], next);
+        }
+        builder.Map(tensor_pc);
+        std::vector<int64_t> shape(alloc.shape, alloc.shape + alloc.ndim);
+        builder.Emit(Instruction::AllocStorageTensor(
+                         instr.alloc_storage.allocation_size, instr.alloc_storage.alignment,
+                         instr.alloc_storage.dtype_hint, alloc.offset, shape, alloc.dtype,
+                         code[tensor_pc].dst),
+                     tensor_pc);
+        pc = tensor_pc;
+        continue;
+      }
+    }
+    builder.Emit(instr, pc);
+  }
+  return builder.Finish();
+}
+
+/*!
+ * \brief Fold `X $r; Move $r $d` into `X $d` when $r is a temporary only the move reads.
+ */
+std::vector<Instruction> FoldMoves(const VMFunction& func) {
+  const auto& code = func.instructions;
+  BytecodeInfo info(func);
+  BytecodeBuilder builder(code);
+  Index num_params = func.params.size();
+  Index n = code.size();
+  for (Index pc = 0; pc < n; ++pc) {
+    const auto& instr = code[pc];
+    builder.Map(pc);
+    Index next = pc + 1;
+    // Calls write their destination when the callee returns, keep them as is.
+    if (next < n && WritesDst(instr) && instr.op != Opcode::Invoke &&
+        instr.op != Opcode::InvokeClosure && code[next].op == Opcode::Move &&
+        code[next].from == instr.dst && instr.dst >= num_params &&
+        info.writes[instr.dst] == 1 && info.reads[instr.dst] == 1 &&
+        !info.jump_targets.count(next)) {
+      Instruction folded(instr);
+      folded.dst = code[next].dst;
+      builder.Emit(folded, pc);
+      pc = next;
+      continue;
+    }
+    builder.Emit(instr, pc);
+  }
+  return builder.Finish();
+}
+
+VMFunction FuseBytecode(const VMFunction& func) {
+  VMFunction fused(func.name, func.params, FuseAllocStorageTensor(func), func.register_file_size);
+  return VMFunction(func.name, func.params, FoldMoves(fused), func.register_file_size);
+}
+
+}  // namespace vm
+}  // namespace relay
+}  // namespace tvm
@@ -0,0 +1,344 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/backend/vm/shape_buckets.cc
+ * \brief Specialize the dynamic fused functions for a list of extents.
+ */
+
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/attrs/reduce.h>
+#include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+#include <tvm/support/logging.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../op/make_op.h"
+#include "../../transforms/pattern_util.h"
+
+namespace tvm {
+namespace relay {
+namespace dyn {
+Expr MakePad(Expr data, Expr pad_width, Expr pad_value, String pad_mode);
+}  // namespace dyn
+
+namespace vm {
+
+/* The fused functions with a single dynamic axis whose operators compute each
+ * row along the axis from the same row of their inputs, such as elementwise
+ * operators, dense or conv2d over the batch axis, are specialized for each
+ * extent of a list of buckets.
+ *
+ * fn(%x: Tensor[(?, 16)]) { ... }(%a)
+ *
+ * becomes, for the buckets 8 and 32:
+ *
+ * let %d = take(shape_of(%a), 0);
+ * if (%d <= 8) {
+ *   fn(%x: Tensor[(8, 16)]) { ... }(%a padded to 8 rows)[:%d]
+ * } else if (%d <= 32) {
+ *   fn(%x: Tensor[(32, 16)]) { ... }(%a padded to 32 rows)[:%d]
+ * } else {
+ *   fn(%x: Tensor[(?, 16)]) { ... }(%a)
+ * }
+ *
+ * The rows of the padding are computed independently of the others, the
+ * result drops them.
+ */
+class ShapeBucketSpecializer : public ExprMutator {
+ public:
+  explicit ShapeBucketSpecializer(std::vector<int64_t> buckets) : buckets_(std::move(buckets)) {}
+
+  Expr VisitExpr_(const CallNode* call_node) final {
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(call_node));
+    const auto* func = call->op.as<FunctionNode>();
+    if (func == nullptr || !func->HasNonzeroAttr(attr::kPrimitive)) return std::move(call);
+    int axis = -1;
+    std::vector<bool> dynamic;
+    if (!IsBucketable(GetRef<Function>(func), &axis, &dynamic)) return std::move(call);
+    return Dispatch(call, GetRef<Function>(func), axis, dynamic);
+  }
+
+ private:
+  /*!
+   * \brief Check whether a fused function can be padded along its dynamic axis.
+   * \param func The fused function.
+   * \param axis The dynamic axis of the result.
+   * \param dynamic Whether each parameter is dynamic along the axis, the other
+   *  ones are static.
+   */
+  static bool IsBucketable(const Function& func, int* axis, std::vector<bool>* dynamic) {
+    *axis = DynamicAxis(func->body->checked_type());
+    if (*axis < 0) return false;
+    bool rowwise = true;
+    PostOrderVisit(func->body, [&rowwise, axis](const Expr& e) {
+      if (const auto* call = e.as<CallNode>()) {
+        rowwise &= IsRowwise(call, *axis);
+      } else if (!e.as<VarNode>() && !e.as<ConstantNode>() && !e.as<OpNode>()) {
+        rowwise = false;
+      }
+    });
+    if (!rowwise) return false;
+
+    dynamic->clear();
+    bool any_dynamic = false;
+    for (const auto& param : func->params) {
+      int param_axis = DynamicAxis(param->checked_type());
+      if (param_axis == kNotBucketable || (param_axis >= 0 && param_axis != *axis)) return false;
+      dynamic->push_back(param_axis >= 0);
+      any_dynamic |= param_axis >= 0;
+    }
+    return any_dynamic;
+  }
+
+  /*! \brief DynamicAxis of a type that is not a tensor or has several dynamic axes. */
+  static constexpr int kNotBucketable = -2;
+
+  /*! \brief The only dynamic axis of a tensor type, -1 when it is static. */
+  static int DynamicAxis(const Type& type) {
+    const auto* ttype = type.as<TensorTypeNode>();
+    if (ttype == nullptr) return kNotBucketable;
+    int axis = -1;
+    for (size_t i = 0; i < ttype->shape.size(); ++i) {
+      if (tir::as_const_int(ttype->shape[i])) continue;
+      if (axis >= 0) return kNotBucketable;
+      axis = static_cast<int>(i);
+    }
+    return axis;
+  }
+
+  /*!
+   * \brief Check whether each row of the result of a call along the dynamic axis
+   *  only reads the same row of its dynamic arguments, so the padded rows stay
+   *  out of the others. The dynamic tensors must keep the axis at the same index.
+   */
+  static bool IsRowwise(const CallNode* call, int axis) {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr) return false;
+    int out_axis = DynamicAxis(call->checked_type());
+    if (out_axis == kNotBucketable) return false;
+    std::vector<int> arg_axes;
+    for (const auto& arg : call->args) {
+      arg_axes.push_back(DynamicAxis(arg->checked_type()));
+      if (arg_axes.back() == kNotBucketable) return false;
+    }
+    if (out_axis < 0) {
+      // Only static values are computed, such as folded weights.
+      return std::all_of(arg_axes.begin(), arg_axes.end(), [](int a) { return a < 0; });
+    }
+    if (out_axis != axis) return false;
+    for (int arg_axis : arg_axes) {
+      if (arg_axis >= 0 && arg_axis != axis) return false;
+    }
+    int rank = static_cast<int>(call->checked_type().as<TensorTypeNode>()->shape.size());
+
+    OpPatternKind pattern = static_cast<OpPatternKind>(fpattern.get(GetRef<Op>(op), kOpaque));
+    if (pattern <= kBroadcast) {
+      // The static arguments must broadcast along the axis.
+      for (size_t i = 0; i < call->args.size(); ++i) {
+        const auto* ttype = call->args[i]->checked_type().as<TensorTypeNode>();
+        int arg_axis = axis - (rank - static_cast<int>(ttype->shape.size()));
+        if (arg_axes[i] >= 0) {
+          if (arg_axis != axis) return false;
+        } else if (arg_axis >= 0 && *tir::as_const_int(ttype->shape[arg_axis]) != 1) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (pattern == kCommReduce) {
+      // Reductions over the axes after the dynamic one only.
+      const auto* attrs = call->attrs.as<ReduceAttrs>();
+      if (attrs == nullptr || !attrs->axis.defined() || attrs->exclude) return false;
+      int in_rank = static_cast<int>(
+          call->args[0]->checked_type().as<TensorTypeNode>()->shape.size());
+      for (const auto& reduced : attrs->axis) {
+        int64_t i = reduced->value < 0 ? reduced->value + in_rank : reduced->value;
+        if (i <= axis) return false;
+      }
+      return true;
+    }
+    // Operators that reduce over other axes than their batch axes.
+    static const Op& dense = Op::Get("nn.dense");
+    static const Op& batch_matmul = Op::Get("nn.batch_matmul");
+    static const Op& conv2d = Op::Get("nn.conv2d");
+    if (call->op == dense) {
+      // Every axis of the data but the last one.
+      return arg_axes[0] >= 0 && axis < rank - 1 && arg_axes[1] < 0;
+    }
+    if (call->op == batch_matmul) {
+      // The batch axis of both operands or the rows of the first one.
+      if (axis == 0) return arg_axes[0] >= 0 && arg_axes[1] >= 0;
+      return axis == 1 && arg_axes[0] >= 0 && arg_axes[1] < 0;
+    }
+    if (call->op == conv2d) {
+      // The batch axis of the data.
+      const auto* attrs = call->attrs.as<Conv2DAttrs>();
+      std::string out_layout = attrs->out_layout.empty() ? attrs->data_layout : attrs->out_layout;
+      return arg_axes[0] >= 0 && arg_axes[1] < 0 &&
+             attrs->data_layout.find('N') == static_cast<size_t>(axis) &&
+             out_layout.find('N') == static_cast<size_t>(axis);
+    }
+    return false;
+  }
+
+  Expr Dispatch(const Call& call, const Function& func, int axis,
+                const std::vector<bool>& dynamic) {
+    // The arguments are bound once and read by every branch.
+    std::vector<std::pair<Var, Expr>> bindings;
+    Array<Expr> args;
+    for (size_t i = 0; i < call->args.size(); ++i) {
+      Var arg("bucket_arg", func->params[i]->checked_type());
+      bindings.emplace_back(arg, call->args[i]);
+      args.push_back(arg);
+    }
+    size_t first = std::find(dynamic.begin(), dynamic.end(), true) - dynamic.begin();
+    Var extent("bucket_extent", TensorType({}, DataType::Int(64)));
+    bindings.emplace_back(extent, Extent(args[first], axis));
+    // Arguments broadcast along the axis at run time take the generic function.
+    Expr same_extent;
+    for (size_t i = first + 1; i < args.size(); ++i) {
+      if (!dynamic[i]) continue;
+      Expr equal = Call(Op::Get("equal"), {Extent(args[i], axis), extent});
+      same_extent =
+          same_extent.defined() ? Call(Op::Get("logical_and"), {same_extent, equal}) : equal;
+    }
+
+    Expr result = Call(func, args, call->attrs, call->type_args);
+    for (auto it = buckets_.rbegin(); it != buckets_.rend(); ++it) {
+      Expr fits =
+          Call(Op::Get("less_equal"), {extent, MakeConstantScalar(DataType::Int(64), *it)});
+      if (same_extent.defined()) fits = Call(Op::Get("logical_and"), {fits, same_extent});
+      result = If(fits, Specialize(func, args, extent, axis, dynamic, *it), result);
+    }
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      result = Let(it->first, it->second, result);
+    }
+    return result;
+  }
+
+  /*! \brief Call the static specialization of a function for a bucket. */
+  static Expr Specialize(const Function& func, const Array<Expr>& args, const Expr& extent,
+                         int axis, const std::vector<bool>& dynamic, int64_t bucket) {
+    Array<Var> params;
+    Array<Expr> padded_args;
+    tvm::Map<Var, Expr> binds;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      const Var& param = func->params[i];
+      const auto* ttype = param->checked_type().as<TensorTypeNode>();
+      if (!dynamic[i]) {
+        Var new_param(param->name_hint(), param->checked_type());
+        params.push_back(new_param);
+        binds.Set(param, new_param);
+        padded_args.push_back(args[i]);
+        continue;
+      }
+      Array<IndexExpr> shape;
+      Array<Integer> newshape;
+      std::vector<int64_t> pad_mask;
+      for (size_t j = 0; j < ttype->shape.size(); ++j) {
+        int64_t dim = static_cast<int>(j) == axis ? bucket : *tir::as_const_int(ttype->shape[j]);
+        shape.push_back(Integer(dim));
+        newshape.push_back(dim);
+        pad_mask.push_back(0);
+        pad_mask.push_back(static_cast<int>(j) == axis);
+      }
+      Var new_param(param->name_hint(), TensorType(shape, ttype->dtype));
+      params.push_back(new_param);
+      binds.Set(param, new_param);
+      // Pad the axis after the last row up to the bucket, the reshape makes the extent static.
+      int64_t rank = static_cast<int64_t>(shape.size());
+      Expr pad = Subtract(MakeConstantScalar(DataType::Int(64), bucket), extent);
+      Expr pad_width = Multiply(MakeConstantTensor(DataType::Int(64), {rank, 2}, pad_mask), pad);
+      Expr padded =
+          dyn::MakePad(args[i], pad_width, MakeConstantScalar(ttype->dtype, 0), "constant");
+      padded_args.push_back(MakeReshape(padded, newshape));
+    }
+    Function specialized(params, Bind(func->body, binds), Type(), {}, func->attrs);
+    Expr out = Call(specialized, padded_args);
+
+    // Drop the padding, the result keeps its static axes.
+    const auto* ret_type = func->body->checked_type().as<TensorTypeNode>();
+    int64_t rank = static_cast<int64_t>(ret_type->shape.size());
+    Array<Integer> newshape;
+    std::vector<int64_t> begin(rank, 0), strides(rank, 1), end(rank, 0), end_mask(rank, 0);
+    for (int64_t j = 0; j < rank; ++j) {
+      newshape.push_back(j == axis ? -1 : *tir::as_const_int(ret_type->shape[j]));
+      if (j == axis) {
+        end_mask[j] = 1;
+      } else {
+        end[j] = *tir::as_const_int(ret_type->shape[j]);
+      }
+    }
+    Expr end_expr = Add(MakeConstantTensor(DataType::Int(64), {rank}, end),
+                        Multiply(MakeConstantTensor(DataType::Int(64), {rank}, end_mask), extent));
+    out = MakeStridedSlice(out, MakeConstantTensor(DataType::Int(64), {rank}, begin), end_expr,
+                           MakeConstantTensor(DataType::Int(64), {rank}, strides), "end");
+    return MakeReshape(out, newshape);
+  }
+
+  static Expr ShapeOf(const Expr& e) {
+    auto attrs = make_object<ShapeOfAttrs>();
+    attrs->dtype = DataType::Int(64);
+    return Call(Op::Get("shape_of"), {e}, Attrs(attrs), {});
+  }
+
+  /*! \brief The extent of a tensor along an axis, as an int64 scalar. */
+  static Expr Extent(const Expr& e, int axis) {
+    return MakeTake(ShapeOf(e), MakeConstantScalar(DataType::Int(32), axis), Integer(0), "clip");
+  }
+
+  /*! \brief The extents to specialize for, in increasing order. */
+  std::vector<int64_t> buckets_;
+};
+
+}  // namespace vm
+
+namespace transform {
+
+Pass SpecializeShapeBuckets(Array<Integer> buckets) {
+  std::vector<int64_t> extents;
+  for (const auto& bucket : buckets) {
+    CHECK_GT(bucket->value, 0) << "The shape buckets must be positive";
+    extents.push_back(bucket->value);
+  }
+  std::sort(extents.begin(), extents.end());
+  extents.erase(std::unique(extents.begin(), extents.end()), extents.end());
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(relay::vm::ShapeBucketSpecializer(extents).Mutate(f));
+      };
+  return CreateFunctionPass(pass_func, 1, "SpecializeShapeBuckets", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.SpecializeShapeBuckets")
+    .set_body_typed(SpecializeShapeBuckets);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
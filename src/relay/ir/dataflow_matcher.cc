@@ -28,6 +28,7 @@
 #include <tvm/relay/transform.h>
 
 #include <stack>
+#include <unordered_set>
 
 #include "indexed_graph.h"
 
@@ -464,6 +465,81 @@ bool MatchPattern(DFPattern pattern, Expr expr) {
 
 TVM_REGISTER_GLOBAL("relay.dataflow_pattern.match").set_body_typed(MatchPattern);
 
+/*!
+ * \brief PatternRootFilter indexes the operators the root of a pattern can match
+ *
+ * Most nodes of a graph cannot be the root of a match, e.g. only the calls of nn.relu can be the
+ * root of a conv2d + bias_add + relu pattern. The filter rejects the nodes whose kind or operator
+ * the root of the pattern cannot match, without running the matcher on them.
+ */
+class PatternRootFilter {
+ public:
+  explicit PatternRootFilter(const DFPattern& pattern) { any_ = !Collect(pattern); }
+
+  /*! \brief Whether the pattern may match the expression, false when it cannot. */
+  bool MayMatch(const Expr& expr) const {
+    if (any_) return true;
+    if (const auto* call_node = expr.as<CallNode>()) {
+      return any_call_ || ops_.count(call_node->op.get()) != 0;
+    }
+    if (expr.as<TupleNode>()) return tuple_;
+    if (expr.as<TupleGetItemNode>()) return tuple_get_item_;
+    return false;
+  }
+
+ private:
+  /*! \brief Collect the kinds of expressions the pattern matches, false when it matches any. */
+  bool Collect(const DFPattern& pattern) {
+    if (const auto* alt = pattern.as<AltPatternNode>()) {
+      return Collect(alt->left) && Collect(alt->right);
+    } else if (const auto* attr = pattern.as<AttrPatternNode>()) {
+      return Collect(attr->pattern);
+    } else if (const auto* type = pattern.as<TypePatternNode>()) {
+      return Collect(type->pattern);
+    } else if (const auto* shape = pattern.as<ShapePatternNode>()) {
+      return Collect(shape->pattern);
+    } else if (const auto* dtype = pattern.as<DataTypePatternNode>()) {
+      return Collect(dtype->pattern);
+    } else if (const auto* dominator = pattern.as<DominatorPatternNode>()) {
+      return Collect(dominator->child);
+    } else if (const auto* call = pattern.as<CallPatternNode>()) {
+      if (!CollectOps(call->op)) any_call_ = true;
+      return true;
+    } else if (pattern.as<TuplePatternNode>()) {
+      tuple_ = true;
+      return true;
+    } else if (pattern.as<TupleGetItemPatternNode>()) {
+      tuple_get_item_ = true;
+      return true;
+    }
+    return false;
+  }
+
+  /*! \brief Collect the operators matched by the op of a call pattern, false when it is not one. */
+  bool CollectOps(const DFPattern& pattern) {
+    if (const auto* alt = pattern.as<AltPatternNode>()) {
+      return CollectOps(alt->left) && CollectOps(alt->right);
+    } else if (const auto* attr = pattern.as<AttrPatternNode>()) {
+      return CollectOps(attr->pattern);
+    } else if (const auto* expr_pattern = pattern.as<ExprPatternNode>()) {
+      if (const auto* op_node = expr_pattern->expr.as<OpNode>()) {
+        // The matcher associates divide and multiply, their calls match each other's patterns.
+        if (op_node->name == "divide" || op_node->name == "multiply") return false;
+        ops_.insert(op_node);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool any_{false};
+  bool any_call_{false};
+  bool tuple_{false};
+  bool tuple_get_item_{false};
+  /*! \brief The operators of the calls matched, the operators are never freed. */
+  std::unordered_set<const Object*> ops_;
+};
+
 /*!
  * \brief PatternGrouper does pre-rewriting pattern matching and analysis
  *
@@ -489,13 +565,27 @@ class PatternGrouper {
   const std::unordered_map<Expr, int, ObjectPtrHash, ObjectPtrEqual>& GetGIDAssignments() {
     return gid_assignments_;
   }
-  /*! \brief Group expressions that match the pattern */
-  const std::unordered_map<int, Group>& GroupMatches(const DFPattern& pattern, const Expr& pre) {
+  /*!
+   * \brief Group expressions that match the pattern
+   * \param pattern The pattern.
+   * \param pre The expression.
+   * \param unmatched When given, the expressions known not to match the pattern, which are skipped,
+   *        and to which the expressions which do not match are added.
+   */
+  const std::unordered_map<int, Group>& GroupMatches(
+      const DFPattern& pattern, const Expr& pre,
+      std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual>* unmatched = nullptr) {
     groups_.clear();
     gid_assignments_.clear();
 
     pattern_ = pattern;
     pattern_graph_ = CreateIndexedGraph(pattern_);
+    // A dominator pattern depends on the consumers of the expressions, which can change while the
+    // expressions stay the same. The other patterns only depend on the expression itself.
+    unmatched_ = unmatched;
+    for (const auto& node : pattern_graph_.topological_order_) {
+      if (node->ref_.as<DominatorPatternNode>()) unmatched_ = nullptr;
+    }
     auto matcher = DFPatternMatcher(pre);
     matcher_ = &matcher;
     this->VisitExprs();
@@ -512,6 +602,7 @@ class PatternGrouper {
    * traversal.
    */
   void VisitExprs() {
+    PatternRootFilter filter(pattern_);
     std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual> pre_partitioned;
     for (size_t i = matcher_->expr_graph_.topological_order_.size(); i != 0; --i) {
       size_t index = i - 1;
@@ -524,8 +615,13 @@ class PatternGrouper {
                            [&pre_partitioned](const Expr& expr) { pre_partitioned.insert(expr); });
           }
         }
-        if (pre_partitioned.count(current) == 0 && matcher_->Match(pattern_, current)) {
-          CreateGroup(current);
+        if (pre_partitioned.count(current) == 0 && filter.MayMatch(current) &&
+            (unmatched_ == nullptr || unmatched_->count(current) == 0)) {
+          if (matcher_->Match(pattern_, current)) {
+            CreateGroup(current);
+          } else if (unmatched_ != nullptr) {
+            unmatched_->insert(current);
+          }
         }
       }
     }
@@ -725,6 +821,7 @@ class PatternGrouper {
   std::unordered_map<int, Group> groups_;
   std::unordered_map<Expr, int, ObjectPtrHash, ObjectPtrEqual> gid_assignments_;
   DFPatternMatcher* matcher_ = nullptr;
+  std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual>* unmatched_ = nullptr;
   IndexedGraph<DFPattern> pattern_graph_;
   int gid_ = 0;
   int graph_number_ = 0;
@@ -766,21 +863,30 @@ class PatternRewriter : protected MixedModeMutator {
     bool equal = true;
     static auto* structural_equal = runtime::Registry::Get("node.StructuralEqual");
     CHECK(structural_equal) << "node.StructuralEqual is not registered.";
+    // The expressions each callback's pattern did not match, the later passes only match the
+    // expressions created by the rewrites.
+    std::vector<std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual>> unmatched(
+        callbacks.size());
     do {
       last = post;
-      for (auto callback : callbacks) {
-        callback_ = callback;
+      for (size_t i = 0; i < callbacks.size(); ++i) {
+        callback_ = callbacks[i];
         if (callback_->require_type) {
           post = InferTypeWithModule(post, mod_);
         }
         auto grouper = PatternGrouper();
-        groups_ = grouper.GroupMatches(callback_->pattern, post);
+        // Inferring the types recreates the expressions, nothing is known about them.
+        groups_ = grouper.GroupMatches(callback_->pattern, post,
+                                       callback_->require_type ? nullptr : &unmatched[i]);
         gid_assignments_ = grouper.GetGIDAssignments();
-        memo_.clear();
-        post = this->VisitExpr(post);
+        if (!groups_.empty()) {
+          memo_.clear();
+          post = this->VisitExpr(post);
+        }
         count++;
       }
-      equal = (*structural_equal)(last, post, false, true);
+      equal = post.same_as(last) ||
+              static_cast<bool>((*structural_equal)(last, post, false, true));
     } while (!equal && count < 100);
     if (count >= 100) {
       LOG(FATAL) << "Observed 100 rewrite passes, possible conflicting passes?";
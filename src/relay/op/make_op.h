@@ -46,12 +46,20 @@ Expr MakeConcatenate(Expr data, int axis);
 
 Expr MakeDense(Expr data, Expr weight, IndexExpr units, DataType out_dtype);
 
+Expr MakeDenseBiasAct(Expr data, Expr weight, Expr bias, IndexExpr units, DataType out_dtype,
+                      String activation);
+
 Expr MakeExpandDims(Expr data, int axis, int num_newaxis);
 
 Expr MakeFull(Expr fill_value, Array<Integer> shape, DataType dtype);
 
 Expr MakeLayoutTransform(Expr data, String src_layout, String dst_layout);
 
+Expr MakeMultiAdamUpdate(Expr weights, Expr grads, Expr means, Expr variances, Expr lr,
+                         double beta1, double beta2, double epsilon);
+
+Expr MakeMultiSGDUpdate(Expr weights, Expr grads, Expr lr);
+
 Expr MakeOnes(Array<Integer> shape, DataType dtype);
 
 Expr MakePad(Expr data, Array<Array<Integer>> pad_width, double pad_value, String pad_mode);
@@ -70,10 +78,14 @@ Expr MakeStack(Expr data, int axis);
 
 Expr MakeStridedSlice(Expr data, Expr begin, Expr end, Expr strides, String slice_mode);
 
+Expr MakeTake(Expr data, Expr indices, Integer axis, String mode);
+
 Expr MakeTile(Expr data, Array<Integer> reps);
 
 Expr MakeTopK(Expr data, int k, int axis, String ret_type, bool is_ascend, DataType dtype);
 
+Expr MakeTranspose(Expr data, Array<Integer> axes);
+
 Expr MakeUpSampling(Expr data, double scale_h, double scale_w, String layout, String method,
                     bool align_corners);
 
@@ -169,6 +169,17 @@ Expr MakeDense(Expr data, Expr weight, IndexExpr units, DataType out_dtype) {
 
 TVM_REGISTER_GLOBAL("relay.op.nn._make.dense").set_body_typed(MakeDense);
 
+// Only 2D dense takes part in layout rewriting; data of other ranks keeps an undefined layout.
+Array<Array<Layout>> DenseInferCorrectLayout(const Attrs& attrs,
+                                             const Array<Layout>& new_in_layouts,
+                                             const Array<Layout>& old_in_layouts,
+                                             const Array<tvm::relay::Type>& old_in_types) {
+  const auto* data = old_in_types[0].as<TensorTypeNode>();
+  Layout data_layout =
+      (data != nullptr && data->shape.size() == 2) ? Layout("NC") : Layout::Undef();
+  return Array<Array<Layout>>{{data_layout, Layout("NK")}, {data_layout}};
+}
+
 RELAY_REGISTER_OP("nn.dense")
     .describe(R"code(Applies a linear transformation: :math:`Y = XW^T`.
 
@@ -182,7 +193,143 @@ RELAY_REGISTER_OP("nn.dense")
     .add_argument("data", "nD Tensor", "Input data.")
     .add_argument("weight", "2D Tensor", "Weight matrix.")
     .set_support_level(1)
-    .add_type_rel("Dense", DenseRel<DenseAttrs>);
+    .add_type_rel("Dense", DenseRel<DenseAttrs>)
+    .set_attr<FInferCorrectLayout>("FInferCorrectLayout", DenseInferCorrectLayout);
+
+// relay.nn.contrib_dense_pack
+TVM_REGISTER_NODE_TYPE(DensePackAttrs);
+
+bool DensePackRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                  const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 3);
+  const auto* data = types[0].as<TensorTypeNode>();
+  const auto* weight = types[1].as<TensorTypeNode>();
+  if (data == nullptr || weight == nullptr) return false;
+
+  const DensePackAttrs* param = attrs.as<DensePackAttrs>();
+  CHECK(param != nullptr);
+
+  CHECK_EQ(data->shape.size(), 2) << "Only 2D data is supported";
+  // The int8 dot product layouts also block the input dimension, such as NK16n4k.
+  CHECK(weight->shape.size() == 3 || weight->shape.size() == 4)
+      << "Weight is not packed, shape=" << weight->shape;
+  PrimExpr in_dim = weight->shape.size() == 3 ? weight->shape[1]
+                                               : weight->shape[1] * weight->shape[3];
+  CHECK(reporter->AssertEQ(data->shape[1], in_dim))
+      << "DensePackRel: input dimension doesn't match,"
+      << " data shape=" << data->shape << ", weight shape=" << weight->shape;
+
+  Array<tvm::PrimExpr> oshape = data->shape;
+  oshape.Set(1, weight->shape[0] * weight->shape[2]);
+
+  DataType out_dtype = param->out_dtype;
+  if (out_dtype.bits() == 0) {
+    out_dtype = data->dtype;
+  }
+  reporter->Assign(types[2], TensorType(oshape, out_dtype));
+  return true;
+}
+
+Array<Array<Layout>> DensePackInferCorrectLayout(const Attrs& attrs,
+                                                 const Array<Layout>& new_in_layouts,
+                                                 const Array<Layout>& old_in_layouts,
+                                                 const Array<tvm::relay::Type>& old_in_types) {
+  const auto* params = attrs.as<DensePackAttrs>();
+  CHECK(params);
+  return Array<Array<Layout>>{{Layout("NC"), Layout(params->weight_layout)}, {Layout("NC")}};
+}
+
+// Positional relay function to create dense_pack operator used by frontend FFI.
+Expr MakeDensePack(Expr data, Expr weight, IndexExpr units, DataType out_dtype,
+                   String weight_layout) {
+  auto attrs = make_object<DensePackAttrs>();
+  attrs->units = units;
+  attrs->out_dtype = out_dtype;
+  attrs->weight_layout = weight_layout;
+  static const Op& op = Op::Get("nn.contrib_dense_pack");
+  return Call(op, {data, weight}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.contrib_dense_pack").set_body_typed(MakeDensePack);
+
+RELAY_REGISTER_OP("nn.contrib_dense_pack")
+    .describe(R"code(Applies a linear transformation with a pre-packed weight: :math:`Y = XW^T`.
+
+- **data**: `(batch, input_dim)`
+- **weight**: `(units // pack_weight_tile, input_dim, pack_weight_tile)`, or
+  `(units // pack_weight_tile, input_dim // pack_input_tile, pack_weight_tile, pack_input_tile)`
+- **out**: `(batch, units)`.
+
+)code" TVM_ADD_FILELINE)
+    .set_attrs_type<DensePackAttrs>()
+    .set_num_inputs(2)
+    .add_argument("data", "2D Tensor", "Input data.")
+    .add_argument("weight", "3D or 4D Tensor", "Packed weight matrix.")
+    .set_support_level(10)
+    .add_type_rel("DensePack", DensePackRel)
+    .set_attr<FInferCorrectLayout>("FInferCorrectLayout", DensePackInferCorrectLayout);
+
+// relay.nn.contrib_dense_bias_act
+TVM_REGISTER_NODE_TYPE(DenseBiasActAttrs);
+
+bool DenseBiasActRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                     const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), 4);
+  const auto* data = types[0].as<TensorTypeNode>();
+  const auto* weight = types[1].as<TensorTypeNode>();
+  if (data == nullptr || weight == nullptr) return false;
+
+  const DenseBiasActAttrs* param = attrs.as<DenseBiasActAttrs>();
+  CHECK(param != nullptr);
+  CHECK(param->activation == "none" || param->activation == "relu" ||
+        param->activation == "gelu")
+      << "Unsupported activation " << param->activation;
+
+  CHECK_EQ(data->shape.size(), 2) << "Only 2D data is supported";
+  CHECK_EQ(weight->shape.size(), 2) << "Only 2D weight is supported";
+  CHECK(reporter->AssertEQ(data->shape[1], weight->shape[1]))
+      << "DenseBiasActRel: input dimension doesn't match,"
+      << " data shape=" << data->shape << ", weight shape=" << weight->shape;
+
+  DataType out_dtype = param->out_dtype;
+  if (out_dtype.bits() == 0) {
+    out_dtype = data->dtype;
+  }
+  reporter->Assign(types[2], TensorType({weight->shape[0]}, out_dtype));
+  reporter->Assign(types[3], TensorType({data->shape[0], weight->shape[0]}, out_dtype));
+  return true;
+}
+
+// Positional relay function to create dense_bias_act operator used by frontend FFI.
+Expr MakeDenseBiasAct(Expr data, Expr weight, Expr bias, IndexExpr units, DataType out_dtype,
+                      String activation) {
+  auto attrs = make_object<DenseBiasActAttrs>();
+  attrs->units = units;
+  attrs->out_dtype = out_dtype;
+  attrs->activation = activation;
+  static const Op& op = Op::Get("nn.contrib_dense_bias_act");
+  return Call(op, {data, weight, bias}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.contrib_dense_bias_act").set_body_typed(MakeDenseBiasAct);
+
+RELAY_REGISTER_OP("nn.contrib_dense_bias_act")
+    .describe(R"code(Applies a linear transformation followed by a bias add and an activation:
+:math:`Y = act(XW^T + b)`.
+
+- **data**: `(batch, input_dim)`
+- **weight**: `(units, input_dim)`
+- **bias**: `(units,)`
+- **out**: `(batch, units)`.
+
+)code" TVM_ADD_FILELINE)
+    .set_attrs_type<DenseBiasActAttrs>()
+    .set_num_inputs(3)
+    .add_argument("data", "2D Tensor", "Input data.")
+    .add_argument("weight", "2D Tensor", "Weight matrix.")
+    .add_argument("bias", "1D Tensor", "Bias vector.")
+    .set_support_level(10)
+    .add_type_rel("DenseBiasAct", DenseBiasActRel);
 
 // relay.leaky_relu
 TVM_REGISTER_NODE_TYPE(LeakyReluAttrs);
@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file optimizer.cc
+ * \brief Property def of the multi-tensor optimizer update operators.
+ */
+
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/op.h>
+
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+/*!
+ * \brief The type relation of the multi-tensor updates: num_tuples tuples of
+ *   tensors matching the weights, the first of them, and a scalar learning rate.
+ *   The output is num_outputs tuples of tensors matching the weights, flattened.
+ */
+bool MultiUpdateRel(const Array<Type>& types, int num_tuples, int num_outputs,
+                    const TypeReporter& reporter) {
+  CHECK_EQ(types.size(), static_cast<size_t>(num_tuples + 2));
+  const auto* weights = types[0].as<TupleTypeNode>();
+  if (weights == nullptr) return false;
+  for (int t = 1; t < num_tuples; ++t) {
+    const auto* tensors = types[t].as<TupleTypeNode>();
+    if (tensors == nullptr) return false;
+    CHECK_EQ(tensors->fields.size(), weights->fields.size())
+        << "Every weight must have one tensor of each kind, but got " << weights->fields.size()
+        << " weights and " << tensors->fields.size() << " tensors";
+    for (size_t i = 0; i < weights->fields.size(); ++i) {
+      reporter->Assign(tensors->fields[i], weights->fields[i]);
+    }
+  }
+  const auto* lr = types[num_tuples].as<TensorTypeNode>();
+  if (lr == nullptr) return false;
+  CHECK_EQ(lr->shape.size(), 0) << "The learning rate must be a scalar";
+
+  Array<Type> fields;
+  for (int o = 0; o < num_outputs; ++o) {
+    for (const Type& field : weights->fields) fields.push_back(field);
+  }
+  reporter->Assign(types[num_tuples + 1], TupleType(fields));
+  return true;
+}
+
+// relay.nn.multi_sgd_update
+bool MultiSGDUpdateRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                       const TypeReporter& reporter) {
+  return MultiUpdateRel(types, 2, 1, reporter);
+}
+
+Expr MakeMultiSGDUpdate(Expr weights, Expr grads, Expr lr) {
+  static const Op& op = Op::Get("nn.multi_sgd_update");
+  return Call(op, {weights, grads, lr}, Attrs(), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.multi_sgd_update").set_body_typed(MakeMultiSGDUpdate);
+
+RELAY_REGISTER_OP("nn.multi_sgd_update")
+    .describe(R"code(Update every weight with a step of stochastic gradient descent,
+:math:`w - lr * g`, all in one kernel.
+
+- **weights**: Tuple of the weights.
+- **grads**: Tuple of their gradients.
+- **lr**: The learning rate, a scalar.
+- **out**: Tuple of the updated weights.
+
+)code" TVM_ADD_FILELINE)
+    .set_num_inputs(3)
+    .add_argument("weights", "Tuple", "The weights.")
+    .add_argument("grads", "Tuple", "The gradients of the weights.")
+    .add_argument("lr", "Tensor", "The learning rate.")
+    .set_support_level(10)
+    .add_type_rel("MultiSGDUpdate", MultiSGDUpdateRel);
+
+// relay.nn.multi_adam_update
+TVM_REGISTER_NODE_TYPE(MultiAdamUpdateAttrs);
+
+bool MultiAdamUpdateRel(const Array<Type>& types, int num_inputs, const Attrs& attrs,
+                        const TypeReporter& reporter) {
+  return MultiUpdateRel(types, 4, 3, reporter);
+}
+
+Expr MakeMultiAdamUpdate(Expr weights, Expr grads, Expr means, Expr variances, Expr lr,
+                         double beta1, double beta2, double epsilon) {
+  auto attrs = make_object<MultiAdamUpdateAttrs>();
+  attrs->beta1 = beta1;
+  attrs->beta2 = beta2;
+  attrs->epsilon = epsilon;
+  static const Op& op = Op::Get("nn.multi_adam_update");
+  return Call(op, {weights, grads, means, variances, lr}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relay.op.nn._make.multi_adam_update").set_body_typed(MakeMultiAdamUpdate);
+
+RELAY_REGISTER_OP("nn.multi_adam_update")
+    .describe(R"code(Update every weight with a step of Adam, all in one kernel.
+
+.. math::
+
+    m' = beta1 * m + (1 - beta1) * g
+    v' = beta2 * v + (1 - beta2) * g * g
+    w' = w - lr * m' / (sqrt(v') + epsilon)
+
+The bias correction of the moments is left to the learning rate.
+
+- **weights**: Tuple of the weights.
+- **grads**: Tuple of their gradients.
+- **means**: Tuple of the moving averages of the gradients.
+- **variances**: Tuple of the moving averages of the squared gradients.
+- **lr**: The learning rate, a scalar.
+- **out**: Tuple of the updated weights, then the updated means, then the
+  updated variances.
+
+)code" TVM_ADD_FILELINE)
+    .set_attrs_type<MultiAdamUpdateAttrs>()
+    .set_num_inputs(5)
+    .add_argument("weights", "Tuple", "The weights.")
+    .add_argument("grads", "Tuple", "The gradients of the weights.")
+    .add_argument("means", "Tuple", "The first moments.")
+    .add_argument("variances", "Tuple", "The second moments.")
+    .add_argument("lr", "Tensor", "The learning rate.")
+    .set_support_level(10)
+    .add_type_rel("MultiAdamUpdate", MultiAdamUpdateRel);
+
+}  // namespace relay
+}  // namespace tvm
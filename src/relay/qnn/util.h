@@ -99,8 +99,10 @@ Expr RequantizeLower(const Expr& input_tensor, const Expr& input_scale,
 static inline Expr Requantize(const Expr& data, const Array<IndexExpr>& input_shape,
                               const Expr& input_scale, const Expr& input_zero_point,
                               const Expr& output_scale, const Expr& output_zero_point,
-                              const DataType& out_dtype, const std::string& rounding = "UPWARD") {
+                              const DataType& out_dtype, const std::string& rounding = "UPWARD",
+                              int axis = -1) {
   auto attrs = make_object<RequantizeAttrs>();
+  attrs->axis = axis;
   attrs->rounding = std::move(rounding);
   attrs->out_dtype = std::move(out_dtype);
   return RequantizeLower(data, input_scale, input_zero_point, output_scale, output_zero_point,
@@ -26,7 +26,9 @@
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/op.h>
+#include <tvm/support/parallel_for.h>
 
+#include <cmath>
 #include <numeric>
 
 #include "./quantize.h"
@@ -79,7 +81,8 @@ static float ComputeEntropy(float* p, float* q, size_t size) {
   return ret;
 }
 
-float MinimizeKL(const std::vector<int>& hist, const std::vector<float>& hist_edges, int num_bins,
+template <typename T>
+float MinimizeKL(const std::vector<T>& hist, const std::vector<float>& hist_edges, int num_bins,
                  int num_quantized_bins) {
   const int zero_bin_idx = num_bins / 2;
   const int num_half_quantized_bins = num_quantized_bins / 2;
@@ -91,7 +94,7 @@ float MinimizeKL(const std::vector<int>& hist, const std::vector<float>& hist_ed
     const int p_bin_idx_stop = zero_bin_idx + i + 1;
     thresholds[i - num_half_quantized_bins] = hist_edges[p_bin_idx_stop];
 
-    std::vector<int> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
+    std::vector<T> sliced_nd_hist(p_bin_idx_stop - p_bin_idx_start);
     std::vector<float> p(sliced_nd_hist.size());
     p[0] = 0;
     p.back() = 0;
@@ -111,11 +114,11 @@ float MinimizeKL(const std::vector<int>& hist, const std::vector<float>& hist_ed
       const int start = j * num_merged_bins;
       const int stop = (j + 1) * num_merged_bins;
       quantized_bins[j] =
-          std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, 0);
+          std::accumulate(sliced_nd_hist.begin() + start, sliced_nd_hist.begin() + stop, T(0));
     }
     quantized_bins.back() += std::accumulate(
         sliced_nd_hist.begin() + static_cast<int>(num_quantized_bins * num_merged_bins),
-        sliced_nd_hist.end(), 0);
+        sliced_nd_hist.end(), T(0));
     // expand quantized_bins into p.size bins
     std::vector<float> q(sliced_nd_hist.size(), 0);
     for (int j = 0; j < num_quantized_bins; j++) {
@@ -143,6 +146,179 @@ float MinimizeKL(const std::vector<int>& hist, const std::vector<float>& hist_ed
   return thresholds[min_divergence_idx];
 }
 
+/*!
+ * \brief Symmetric histogram of a tensor over [-range, range], updated batch by batch.
+ *
+ * The range starts at the absolute maximum of the first batch. A later batch exceeding it
+ * doubles the range as often as needed and merges the old bins into the wider ones, so no
+ * activation has to be kept around.
+ */
+class StreamingHistogram {
+ public:
+  explicit StreamingHistogram(int num_bins) : hist_(num_bins, 0) {}
+
+  void Update(const float* data, int64_t size) {
+    float max_abs = 0.f;
+    for (int64_t i = 0; i < size; ++i) {
+      max_abs = std::max(max_abs, std::abs(data[i]));
+    }
+    if (range_ == 0.f) {
+      if (max_abs == 0.f) {
+        // nothing to bin against yet, the zeros land in the center bin once a range is known
+        num_zeros_ += size;
+        return;
+      }
+      range_ = max_abs;
+      hist_[num_bins() / 2] += num_zeros_;
+    } else if (max_abs > range_) {
+      Widen(static_cast<int>(std::ceil(std::log2(max_abs / range_))));
+    }
+    const double inv_width = num_bins() / (2.0 * range_);
+    for (int64_t i = 0; i < size; ++i) {
+      hist_[BinIndex((data[i] + range_) * inv_width)] += 1;
+    }
+  }
+
+  /*! \return The bin edges, num_bins + 1 of them. */
+  std::vector<float> Edges() const {
+    std::vector<float> edges(num_bins() + 1);
+    for (int i = 0; i <= num_bins(); ++i) {
+      edges[i] = -range_ + 2.0 * range_ * i / num_bins();
+    }
+    return edges;
+  }
+
+  /*! \return The smallest threshold covering a `percentile` fraction of the absolute values. */
+  float Percentile(double percentile) const {
+    int64_t total = std::accumulate(hist_.begin(), hist_.end(), int64_t(0));
+    const int center = num_bins() / 2;
+    int64_t covered = hist_[center];
+    int i = 0;
+    while (center + i + 1 < num_bins() && covered < percentile * total) {
+      ++i;
+      covered += hist_[center - i] + hist_[center + i];
+    }
+    return Edges()[center + i + 1];
+  }
+
+  const std::vector<int64_t>& hist() const { return hist_; }
+  int num_bins() const { return static_cast<int>(hist_.size()); }
+  float range() const { return range_; }
+
+ private:
+  int BinIndex(double pos) const {
+    return std::min(std::max(static_cast<int>(pos), 0), num_bins() - 1);
+  }
+
+  /*! \brief Grow the range by 2^log2_factor, moving every bin by the position of its center. */
+  void Widen(int log2_factor) {
+    const double factor = std::ldexp(1.0, log2_factor);
+    std::vector<int64_t> widened(hist_.size(), 0);
+    for (int i = 0; i < num_bins(); ++i) {
+      // the center of bin i is at (i + 0.5) / num_bins of the old range, measured from -range
+      double pos = (i + 0.5 + (factor - 1) * num_bins() / 2.0) / factor;
+      widened[BinIndex(pos)] += hist_[i];
+    }
+    hist_ = std::move(widened);
+    range_ *= factor;
+  }
+
+  std::vector<int64_t> hist_;
+  float range_{0.f};
+  int64_t num_zeros_{0};
+};
+
+/*!
+ * \brief Calibrator keeping one streaming histogram per profiled tensor.
+ */
+class StreamingCalibratorNode : public Object {
+ public:
+  /*! \brief The number of histogram bins of each tensor. */
+  int num_bins;
+  /*! \brief The histogram of each tensor, created on the first update. */
+  std::vector<StreamingHistogram> hists;
+
+  void VisitAttrs(tvm::AttrVisitor* v) { v->Visit("num_bins", &num_bins); }
+
+  /*! \brief Fold one batch of profiled tensors into the histograms, in parallel over tensors. */
+  void Update(const std::vector<runtime::NDArray>& tensors) {
+    if (hists.empty()) {
+      hists.resize(tensors.size(), StreamingHistogram(num_bins));
+    }
+    CHECK_EQ(hists.size(), tensors.size()) << "the number of profiled tensors changed";
+    std::vector<runtime::NDArray> host_tensors;
+    for (const auto& tensor : tensors) {
+      CHECK(tensor.DataType() == DataType::Float(32)) << "can only calibrate float32 tensors";
+      host_tensors.push_back(tensor->ctx.device_type == kDLCPU
+                                 ? tensor
+                                 : tensor.CopyTo(DLContext{kDLCPU, 0}));
+    }
+    support::parallel_for(0, static_cast<int>(host_tensors.size()), [&](int i) {
+      const DLTensor* t = host_tensors[i].operator->();
+      hists[i].Update(static_cast<const float*>(t->data) + t->byte_offset / sizeof(float),
+                      runtime::GetDataSize(*t) / sizeof(float));
+    });
+  }
+
+  static constexpr const char* _type_key = "relay.quantize.StreamingCalibrator";
+  TVM_DECLARE_FINAL_OBJECT_INFO(StreamingCalibratorNode, Object);
+};
+
+class StreamingCalibrator : public ObjectRef {
+ public:
+  explicit StreamingCalibrator(int num_bins) {
+    CHECK_GT(num_bins, 0);
+    auto n = make_object<StreamingCalibratorNode>();
+    n->num_bins = num_bins;
+    data_ = std::move(n);
+  }
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(StreamingCalibrator, ObjectRef, StreamingCalibratorNode);
+};
+
+TVM_REGISTER_NODE_TYPE(StreamingCalibratorNode);
+
+TVM_REGISTER_GLOBAL("relay._quantize.CreateStreamingCalibrator").set_body_typed([](int num_bins) {
+  return StreamingCalibrator(num_bins);
+});
+
+TVM_REGISTER_GLOBAL("relay._quantize.StreamingCalibratorUpdate")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      StreamingCalibrator calibrator = args[0];
+      std::vector<runtime::NDArray> tensors;
+      for (int i = 1; i < args.num_args; ++i) {
+        tensors.push_back(args[i]);
+      }
+      calibrator->Update(tensors);
+    });
+
+TVM_REGISTER_GLOBAL("relay._quantize.StreamingCalibratorKLThresholds")
+    .set_body_typed([](StreamingCalibrator calibrator, int num_quantized_bins) {
+      std::vector<float> thresholds(calibrator->hists.size());
+      support::parallel_for(0, static_cast<int>(thresholds.size()), [&](int i) {
+        const StreamingHistogram& hist = calibrator->hists[i];
+        thresholds[i] = hist.range() == 0.f ? 0.f
+                                            : MinimizeKL(hist.hist(), hist.Edges(),
+                                                         hist.num_bins(), num_quantized_bins);
+      });
+      Array<FloatImm> ret;
+      for (float t : thresholds) {
+        ret.push_back(FloatImm(DataType::Float(32), t));
+      }
+      return ret;
+    });
+
+TVM_REGISTER_GLOBAL("relay._quantize.StreamingCalibratorPercentileThresholds")
+    .set_body_typed([](StreamingCalibrator calibrator, double percentile) {
+      CHECK(percentile > 0 && percentile <= 1) << "percentile must be in (0, 1]";
+      Array<FloatImm> thresholds;
+      for (const auto& hist : calibrator->hists) {
+        float t = hist.range() == 0.f ? 0.f : hist.Percentile(percentile);
+        thresholds.push_back(FloatImm(DataType::Float(32), t));
+      }
+      return thresholds;
+    });
+
 class StatsCollector : private ExprMutator {
  public:
   StatsCollector() : simulated_quantize_op_(Op::Get("relay.op.annotation.simulated_quantize")) {}
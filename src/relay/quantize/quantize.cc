@@ -47,7 +47,17 @@ bool SimulatedQuantizeRel(const Array<Type>& types, int num_inputs, const Attrs&
   CHECK(data != nullptr);
   CHECK_NE(data->shape.size(), 0) << "Input shape cannot be empty";
 
-  reporter->Assign(types[1], TensorType({}, DataType::Float(32)));  // dom_scale
+  if (param->axis >= 0) {
+    // per-channel dom_scale, broadcastable against data along the channel axis
+    CHECK_LT(param->axis, static_cast<int>(data->shape.size()));
+    Array<IndexExpr> scale_shape;
+    for (size_t i = 0; i < data->shape.size(); ++i) {
+      scale_shape.push_back(static_cast<int>(i) == param->axis ? data->shape[i] : IndexExpr(1));
+    }
+    reporter->Assign(types[1], TensorType(scale_shape, DataType::Float(32)));  // dom_scale
+  } else {
+    reporter->Assign(types[1], TensorType({}, DataType::Float(32)));  // dom_scale
+  }
   reporter->Assign(types[2], TensorType({}, DataType::Float(32)));  // clip_min
   reporter->Assign(types[3], TensorType({}, DataType::Float(32)));  // clip_max
   reporter->Assign(types[4], types[0]);                             // output
@@ -58,7 +68,9 @@ RELAY_REGISTER_OP("relay.op.annotation.simulated_quantize")
     .describe(R"code(simulated quantize op)code" TVM_ADD_FILELINE)
     .set_num_inputs(4)
     .add_argument("data", "Tensor", "The input data.")
-    .add_argument("dom_scale", "Tensor", "The domain scale of input data. It should be a scalar")
+    .add_argument("dom_scale", "Tensor",
+                  "The domain scale of input data. It should be a scalar, or a per-channel "
+                  "tensor when axis is set")
     .add_argument("clip_min", "Tensor", "lower bound. It should be a scalar")
     .add_argument("clip_max", "Tensor", "upper bound. It should be a scalar")
     .set_attrs_type<SimulatedQuantizeAttrs>()
@@ -67,11 +79,12 @@ RELAY_REGISTER_OP("relay.op.annotation.simulated_quantize")
 
 TVM_REGISTER_GLOBAL("relay._quantize.simulated_quantize")
     .set_body_typed([](Expr data, Expr dom_scale, Expr clip_min, Expr clip_max, int kind, bool sign,
-                       String rounding) {
+                       String rounding, int axis) {
       auto attrs = make_object<SimulatedQuantizeAttrs>();
       attrs->kind = kind;
       attrs->sign = sign;
       attrs->rounding = rounding;
+      attrs->axis = axis;
       static const Op& op = Op::Get("relay.op.annotation.simulated_quantize");
       return Call(op, {data, dom_scale, clip_min, clip_max}, Attrs(attrs), {});
     });
@@ -121,6 +134,7 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
       p->stream << "calibrate_mode=" << op->calibrate_mode << ", ";
       p->stream << "global_scale=" << op->global_scale << ", ";
       p->stream << "weight_scale=" << op->weight_scale << ", ";
+      p->stream << "weight_per_channel=" << op->weight_per_channel << ", ";
       p->stream << "skip_conv_layers==" << op->skip_conv_layers << ", ";
       p->stream << "do_simulation==" << op->do_simulation << ", ";
       p->stream << "round_for_shift==" << op->round_for_shift << ", ";
@@ -43,12 +43,15 @@ struct SimulatedQuantizeAttrs : public tvm::AttrsNode<SimulatedQuantizeAttrs> {
   int kind;
   bool sign;
   std::string rounding;
+  int axis;
 
   TVM_DECLARE_ATTRS(SimulatedQuantizeAttrs, "relay.attrs.SimulatedQuantizeAttrs") {
     TVM_ATTR_FIELD(kind).describe("kind of field, hint for nbit/dtype configuration.");
     TVM_ATTR_FIELD(sign).set_default(true).describe("whether to use signed data type.");
     TVM_ATTR_FIELD(rounding).set_default("round").describe(
         "rounding mode. Can be 'floor', 'ceil', 'round'");
+    TVM_ATTR_FIELD(axis).set_default(-1).describe(
+        "The channel axis of a per-channel dom_scale, -1 for a single per-tensor scale.");
   }
 };
 
@@ -67,6 +70,7 @@ class QConfigNode : public Object {
   std::string calibrate_mode = "global_scale";
   double global_scale = 8.0;
   std::string weight_scale = "power2";
+  bool weight_per_channel = false;
   bool skip_dense_layer = true;
   Array<Expr> skip_conv_layers = Array<Expr>(ObjectPtr<Object>(nullptr));
   bool do_simulation = false;
@@ -74,6 +78,7 @@ class QConfigNode : public Object {
   Array<Expr> debug_enabled_ops = Array<Expr>(ObjectPtr<Object>(nullptr));
   std::string rounding = "UPWARD";
   int calibrate_chunk_by = -1;
+  double calibrate_percentile = 0.9999;
   std::string partition_conversions = "disabled";
 
   void VisitAttrs(AttrVisitor* v) {
@@ -86,6 +91,7 @@ class QConfigNode : public Object {
     v->Visit("calibrate_mode", &calibrate_mode);
     v->Visit("global_scale", &global_scale);
     v->Visit("weight_scale", &weight_scale);
+    v->Visit("weight_per_channel", &weight_per_channel);
     v->Visit("skip_dense_layer", &skip_dense_layer);
     v->Visit("skip_conv_layers", &skip_conv_layers);
     v->Visit("do_simulation", &do_simulation);
@@ -93,6 +99,7 @@ class QConfigNode : public Object {
     v->Visit("debug_enabled_ops", &debug_enabled_ops);
     v->Visit("rounding", &rounding);
     v->Visit("calibrate_chunk_by", &calibrate_chunk_by);
+    v->Visit("calibrate_percentile", &calibrate_percentile);
     v->Visit("partition_conversions", &partition_conversions);
   }
 
@@ -28,6 +28,9 @@
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/annotation.h>
 #include <tvm/relay/transform.h>
+#include <tvm/tir/data_layout.h>
+
+#include <algorithm>
 
 #include "../qnn/util.h"
 #include "../transforms/pattern_util.h"
@@ -125,6 +128,49 @@ inline Expr MulAndDiv(Expr data, float s1, float s2, DataType dtype,
   }
 }
 
+/* \brief whether dom_scale holds one scale per channel rather than a scalar */
+inline bool IsPerChannelScale(const Expr& dom_scale) { return !IsConstScalar(dom_scale); }
+
+/* \brief the axis of a rank `ndim` tensor along which the per-channel dom_scale varies */
+int PerChannelAxis(const Expr& dom_scale, size_t ndim) {
+  const auto* n = dom_scale.as<ConstantNode>();
+  CHECK(n) << "dom_scale must be a constant";
+  auto shape = n->data.Shape();
+  CHECK_LE(shape.size(), ndim);
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (shape[i] != 1) return static_cast<int>(ndim - shape.size() + i);
+  }
+  LOG(FATAL) << "per-channel dom_scale must vary along one axis";
+  return -1;
+}
+
+/* \brief the smallest scale held by a scalar or per-channel dom_scale */
+float MinScale(const Expr& dom_scale) {
+  if (!IsPerChannelScale(dom_scale)) return GetScalarFromConstant<float>(dom_scale);
+  std::vector<float> scales = qnn::GetFloatVectorFromConstant(dom_scale);
+  return *std::min_element(scales.begin(), scales.end());
+}
+
+/* \brief calculate `data * idom_scale / odom_scale` channel-wise with an axis-wise requantize */
+Expr RequantizePerChannel(Expr data, const Expr& idom_scale, float odom_scale, DataType dtype,
+                          const Array<IndexExpr>& data_shape) {
+  const QConfig& cfg = QConfig::Current();
+  Expr zero_point = MakeConstantScalar(DataType::Int(32), 0);
+  int axis = PerChannelAxis(idom_scale, data_shape.size());
+  return qnn::Requantize(data, data_shape, idom_scale, zero_point,
+                         MakeConstantScalar(DataType::Float(32), odom_scale), zero_point, dtype,
+                         cfg->rounding, axis);
+}
+
+/* \brief move a per-channel expr onto its smallest scale, for ops that need a scalar one */
+Expr ToPerTensorScale(const Expr& arg, const Array<IndexExpr>& data_shape) {
+  const auto* n = arg.as<QRealizeIntExprNode>();
+  if (n == nullptr || !IsPerChannelScale(n->dom_scale)) return arg;
+  float s = MinScale(n->dom_scale);
+  Expr data = RequantizePerChannel(n->data, n->dom_scale, s, n->dtype, data_shape);
+  return QRealizeIntExpr(data, MakeConstantScalar(DataType::Float(32), s), n->dtype);
+}
+
 Expr QuantizeRealize(const Call& ref_call, const Array<Expr>& new_args, const ObjectRef& ctx) {
   const QConfig& cfg = QConfig::Current();
   // do not handle data type cast
@@ -135,15 +181,34 @@ Expr QuantizeRealize(const Call& ref_call, const Array<Expr>& new_args, const Ob
   Expr clip_min = new_args[2];
   Expr clip_max = new_args[3];
 
-  float dom_scale_imm = GetScalarFromConstant<float>(dom_scale);
   float clip_min_imm = GetScalarFromConstant<float>(clip_min);
   float clip_max_imm = GetScalarFromConstant<float>(clip_max);
 
+  if (param->axis >= 0) {
+    // per-channel scale, only used for weights, which are quantized from real
+    CHECK(!new_args[0]->IsInstance<TempExprNode>());
+    Expr scaled_data = Divide(new_args[0], dom_scale);
+    Expr round_data = Clip(Round(scaled_data), clip_min_imm, clip_max_imm);
+    std::vector<float> scales = qnn::GetFloatVectorFromConstant(dom_scale);
+    if (scales.size() == 1) {
+      dom_scale = MakeConstantScalar(DataType::Float(32), scales[0]);
+    }
+    return QRealizeIntExpr(round_data, dom_scale, DataType::Float(32));
+  }
+
+  float dom_scale_imm = GetScalarFromConstant<float>(dom_scale);
+
   // x * idom_scale = y * odom_scale
   // => y = x * idom_scale / odom_scale
   if (const auto* n = new_args[0].as<QRealizeIntExprNode>()) {
     // int32->int8
     Expr data = n->data;
+    if (IsPerChannelScale(n->dom_scale)) {
+      data = RequantizePerChannel(data, n->dom_scale, dom_scale_imm, n->dtype,
+                                  ref_call->type_as<TensorTypeNode>()->shape);
+      data = Clip(data, clip_min_imm, clip_max_imm);
+      return QRealizeIntExpr(data, dom_scale, n->dtype);
+    }
     float idom_scale_imm = GetScalarFromConstant<float>(n->dom_scale);
     float odom_scale_imm = GetScalarFromConstant<float>(dom_scale);
     if (idom_scale_imm == odom_scale_imm) {
@@ -203,6 +268,15 @@ Expr FoldConstantOpt(const Expr& expr) {
 RELAY_REGISTER_OP("relay.op.annotation.simulated_quantize")
     .set_attr<FForwardRewrite>("FQRealizeRewrite", QuantizeRealize);
 
+/* \brief reshape a per-channel weight scale to broadcast along `axis` of a rank `ndim` output */
+Expr ScaleOnAxis(const Expr& dom_scale, int axis, size_t ndim) {
+  Array<Integer> newshape = {-1};
+  for (size_t i = axis + 1; i < ndim; ++i) {
+    newshape.push_back(1);
+  }
+  return FoldConstantOpt(Reshape(dom_scale, newshape));
+}
+
 Expr Conv2dRealize(const Call& ref_call, const Array<Expr>& new_args, const ObjectRef& ctx) {
   const QConfig& cfg = QConfig::Current();
   CHECK_EQ(new_args.size(), 2);
@@ -226,8 +300,17 @@ Expr Conv2dRealize(const Call& ref_call, const Array<Expr>& new_args, const Obje
   DataType out_dtype = cfg->dtype_activation;
   attrs->out_dtype = out_dtype;
 
+  Expr rscale = rhs->dom_scale;
+  if (IsPerChannelScale(rscale)) {
+    // the per-output-channel weight scale lands on the channel axis of the output
+    Layout out_layout(attrs->out_layout.empty() ? attrs->data_layout : attrs->out_layout);
+    CHECK(!out_layout.Contains(LayoutAxis::Get('c')))
+        << "per-channel weight scale does not support layout " << out_layout.name();
+    rscale = ScaleOnAxis(rscale, out_layout.IndexOf(LayoutAxis::Get('C')), out_layout.ndim());
+  }
+
   Expr ret = Call(ref_call->op, {ldata, rdata}, Attrs(attrs), ref_call->type_args);
-  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
+  Expr mul = Multiply(lhs->dom_scale, rscale);
   Expr dom_scale = FoldConstantOpt(mul);
   return QRealizeIntExpr(ret, dom_scale, out_dtype);
 }
@@ -255,8 +338,15 @@ Expr DenseRealize(const Call& ref_call, const Array<Expr>& new_args, const Objec
   DataType out_dtype = cfg->dtype_activation;
   attrs->out_dtype = out_dtype;
 
+  Expr rscale = rhs->dom_scale;
+  if (IsPerChannelScale(rscale)) {
+    // the per-unit weight scale lands on the last axis of the output
+    size_t ndim = ref_call->type_as<TensorTypeNode>()->shape.size();
+    rscale = ScaleOnAxis(rscale, ndim - 1, ndim);
+  }
+
   Expr ret = Call(ref_call->op, {ldata, rdata}, Attrs(attrs), ref_call->type_args);
-  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
+  Expr mul = Multiply(lhs->dom_scale, rscale);
   Expr dom_scale = FoldConstantOpt(mul);
   return QRealizeIntExpr(ret, dom_scale, out_dtype);
 }
@@ -297,8 +387,8 @@ float ChooseDomScale(const std::vector<const QRealizeIntExprNode*>& nptrs) {
     // x = a * s1, y = b * s2
     // x + y = (a * s1 / s2 + b) * s2, if s1 > s2
     //       = (a + b * s2 / s1) * s1, if s2 > s1
-    float s1 = GetScalarFromConstant<float>(nptrs[0]->dom_scale);
-    float s2 = GetScalarFromConstant<float>(nptrs[1]->dom_scale);
+    float s1 = MinScale(nptrs[0]->dom_scale);
+    float s2 = MinScale(nptrs[1]->dom_scale);
     return s1 > s2 ? s2 : s1;
   } else {
     const QConfig& cfg = QConfig::Current();
@@ -347,8 +437,13 @@ Array<Expr> UnifyDTypeScale(const Array<Expr>& ref_args, const Array<Expr>& args
   float s = ChooseDomScale(nptrs);
   Expr dom_scale = MakeConstantScalar(DataType::Float(32), s);
   for (size_t i = 0; i < ret.size(); ++i) {
-    float cur_s = GetScalarFromConstant<float>(nptrs[i]->dom_scale);
-    ret.Set(i, MulAndDiv(ret[i], cur_s, s, dtype, ref_args[i]->type_as<TensorTypeNode>()->shape));
+    const Array<IndexExpr>& shape = ref_args[i]->type_as<TensorTypeNode>()->shape;
+    if (IsPerChannelScale(nptrs[i]->dom_scale)) {
+      ret.Set(i, RequantizePerChannel(ret[i], nptrs[i]->dom_scale, s, dtype, shape));
+    } else {
+      float cur_s = GetScalarFromConstant<float>(nptrs[i]->dom_scale);
+      ret.Set(i, MulAndDiv(ret[i], cur_s, s, dtype, shape));
+    }
   }
 
   *dtype_ptr = dtype;
@@ -374,7 +469,8 @@ RELAY_REGISTER_OP("add").set_attr<FForwardRewrite>("FQRealizeRewrite", AddRealiz
 
 Expr ClipRealize(const Call& ref_call, const Array<Expr>& new_args, const ObjectRef& ctx) {
   CHECK_EQ(new_args.size(), 1);
-  if (const auto* n = new_args[0].as<QRealizeIntExprNode>()) {
+  Expr arg = ToPerTensorScale(new_args[0], ref_call->args[0]->type_as<TensorTypeNode>()->shape);
+  if (const auto* n = arg.as<QRealizeIntExprNode>()) {
     const auto ref_attrs = ref_call->attrs.as<ClipAttrs>();
     auto attrs = make_object<ClipAttrs>();
     double dom_scale = GetScalarFromConstant<float>(n->dom_scale);
@@ -428,12 +524,21 @@ Expr IdentityRealize(const Call& ref_call, const Array<Expr>& new_args, const Ob
   return Expr(nullptr);
 }
 
+/* \brief forward an operator which may move the channel axis, on a per-tensor scale */
+Expr PerTensorIdentityRealize(const Call& ref_call, const Array<Expr>& new_args,
+                              const ObjectRef& ctx) {
+  CHECK_EQ(new_args.size(), 1);
+  Expr arg = ToPerTensorScale(new_args[0], ref_call->args[0]->type_as<TensorTypeNode>()->shape);
+  return IdentityRealize(ref_call, {arg}, ctx);
+}
+
 RELAY_REGISTER_OP("nn.relu").set_attr<FForwardRewrite>("FQRealizeRewrite", IdentityRealize);
 
-RELAY_REGISTER_OP("strided_slice").set_attr<FForwardRewrite>("FQRealizeRewrite", IdentityRealize);
+RELAY_REGISTER_OP("strided_slice")
+    .set_attr<FForwardRewrite>("FQRealizeRewrite", PerTensorIdentityRealize);
 
 RELAY_REGISTER_OP("nn.batch_flatten")
-    .set_attr<FForwardRewrite>("FQRealizeRewrite", IdentityRealize);
+    .set_attr<FForwardRewrite>("FQRealizeRewrite", PerTensorIdentityRealize);
 
 RELAY_REGISTER_OP("annotation.stop_fusion")
     .set_attr<FForwardRewrite>("FQRealizeRewrite", IdentityRealize);
@@ -61,6 +61,10 @@ namespace relay {
 //   (%3, 4)
 // }
 // \endcode
+//
+// It also folds a cast back to the source type of a lossless upcast, for example
+// cast(cast(%x: float16, float32), float16) becomes %x. ToMixedPrecision leaves such
+// round trips at the borders of the mixed precision regions.
 class CastCanonicalizer : public ExprMutator {
  public:
   CastCanonicalizer() : cast_op_(Op::Get("cast")) {}
@@ -68,6 +72,19 @@ class CastCanonicalizer : public ExprMutator {
   Expr VisitExpr_(const CallNode* call) {
     static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
 
+    if (call->op == cast_op_) {
+      if (const CallNode* inner = call->args[0].as<CallNode>()) {
+        if (inner->op == cast_op_) {
+          const auto* from_type = inner->args[0]->type_as<TensorTypeNode>();
+          DataType wide = inner->attrs.as<CastAttrs>()->dtype;
+          if (call->attrs.as<CastAttrs>()->dtype == from_type->dtype &&
+              IsLosslessCast(from_type->dtype, wide)) {
+            return this->VisitExpr(inner->args[0]);
+          }
+        }
+      }
+    }
+
     if (const OpNode* opnode = call->op.as<OpNode>()) {
       auto pattern = fpattern[GetRef<Op>(opnode)];
       if (pattern <= kBroadcast) {
@@ -98,6 +115,12 @@ class CastCanonicalizer : public ExprMutator {
   // reduce lookup overhead.
   const Op& cast_op_;
 
+  static bool IsLosslessCast(DataType from, DataType to) {
+    if (from.lanes() != to.lanes()) return false;
+    if (from.code() == to.code()) return from.bits() <= to.bits();
+    return from.is_bfloat16() && to.is_float() && to.bits() >= 32;
+  }
+
   Expr GetNewCallArg(const Expr& e) {
     // if e is a upcast and ref count > 1, create an copy; otherwise call the default visitor
     Expr new_expr = this->VisitExpr(e);
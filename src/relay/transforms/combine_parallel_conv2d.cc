@@ -28,6 +28,11 @@
  * of the original weights. Elemwise and broadcast ops following conv2d are also
  * combined if possible.
  *
+ * Convolutions with different kernel sizes are combined too when their windows
+ * are centered the same way, e.g. a 1x1 convolution without padding and a 3x3
+ * convolution with padding 1. The smaller kernels are padded with zeros to the
+ * largest kernel size, and the padding of the data grows accordingly.
+ *
  * This prevents launching multiple kernels in networks with multiple
  * convolution branches, such as Inception block.
  */
@@ -39,8 +44,11 @@
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/relay/transform.h>
 
+#include <algorithm>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "./combine_parallel_op.h"
 #include "./expr_subst.h"
@@ -49,6 +57,45 @@
 namespace tvm {
 namespace relay {
 
+/*! \brief The constant padding, kernel size and dilation of a conv2d. */
+struct Conv2DWindow {
+  /*! \brief The padding (top, left, bottom, right). */
+  int64_t padding[4];
+  /*! \brief The kernel (height, width). */
+  int64_t kernel[2];
+  /*! \brief The dilation (height, width). */
+  int64_t dilation[2];
+};
+
+/*! \return false if the window of the conv2d is not constant. */
+static bool GetConv2DWindow(const CallNode* conv2d, Conv2DWindow* window) {
+  const auto* attrs = conv2d->attrs.as<Conv2DAttrs>();
+  const auto* tweight = conv2d->args[1]->type_as<TensorTypeNode>();
+  const auto shape = tir::BijectiveLayout(Layout(attrs->kernel_layout), Layout("OIHW"))
+                         .ForwardShape(tweight->shape);
+  size_t num_padding = attrs->padding.size();
+  if ((num_padding != 1 && num_padding != 2 && num_padding != 4) || attrs->dilation.size() != 2) {
+    return false;
+  }
+  std::vector<const int64_t*> values;
+  for (size_t i = 0; i < 4; ++i) {
+    values.push_back(tir::as_const_int(attrs->padding[i % num_padding]));
+  }
+  values.push_back(tir::as_const_int(shape[2]));
+  values.push_back(tir::as_const_int(shape[3]));
+  values.push_back(tir::as_const_int(attrs->dilation[0]));
+  values.push_back(tir::as_const_int(attrs->dilation[1]));
+  for (const int64_t* value : values) {
+    if (value == nullptr) return false;
+  }
+  for (size_t i = 0; i < 4; ++i) window->padding[i] = *values[i];
+  for (size_t i = 0; i < 2; ++i) {
+    window->kernel[i] = *values[4 + i];
+    window->dilation[i] = *values[6 + i];
+  }
+  return true;
+}
+
 class ParallelConv2DCombiner : public ParallelOpCombiner {
  public:
   explicit ParallelConv2DCombiner(uint64_t min_num_branches)
@@ -71,31 +118,81 @@ class ParallelConv2DCombiner : public ParallelOpCombiner {
     const auto shape_b =
         tir::BijectiveLayout(Layout(attrs_b->kernel_layout), kOIHW).ForwardShape(tweight_b->shape);
 
-    return eq(attrs_a->strides, attrs_b->strides) && eq(attrs_a->padding, attrs_b->padding) &&
-           eq(attrs_a->dilation, attrs_b->dilation) && eq(attrs_a->groups, attrs_b->groups) &&
+    bool same_window = eq(attrs_a->padding, attrs_b->padding) && eq(shape_a[2], shape_b[2]) &&
+                       eq(shape_a[3], shape_b[3]);
+    return eq(attrs_a->strides, attrs_b->strides) && eq(attrs_a->dilation, attrs_b->dilation) &&
+           eq(attrs_a->groups, attrs_b->groups) &&
            eq(attrs_a->data_layout, attrs_b->data_layout) &&
            eq(attrs_a->kernel_layout, attrs_b->kernel_layout) &&
            eq(attrs_a->out_dtype, attrs_b->out_dtype) &&
-           eq(attrs_a->out_layout, attrs_b->out_layout) && eq(shape_a[2], shape_b[2]) &&
-           eq(shape_a[3], shape_b[3]);
+           eq(attrs_a->out_layout, attrs_b->out_layout) &&
+           (same_window || CanPadKernels(a, b));
+  }
+
+  /*!
+   * \brief Whether the kernels of both convolutions can be padded to the same size, i.e. the
+   *  windows have the same center when the data padding grows by the kernel padding.
+   */
+  bool CanPadKernels(const CallNode* a, const CallNode* b) {
+    Conv2DWindow window_a, window_b;
+    if (!GetConv2DWindow(a, &window_a) || !GetConv2DWindow(b, &window_b)) return false;
+    // A kernel is padded on its H and W axes, which cannot be split.
+    Layout kernel_layout(a->attrs.as<Conv2DAttrs>()->kernel_layout);
+    if (kernel_layout.Contains(LayoutAxis::Get('h')) ||
+        kernel_layout.Contains(LayoutAxis::Get('w'))) {
+      return false;
+    }
+    for (size_t i = 0; i < 2; ++i) {
+      if ((window_a.kernel[i] - window_b.kernel[i]) % 2 != 0) return false;
+      int64_t extent_a = window_a.kernel[i] * window_a.dilation[i];
+      int64_t extent_b = window_b.kernel[i] * window_b.dilation[i];
+      if (2 * window_a.padding[i] - extent_a != 2 * window_b.padding[i] - extent_b ||
+          2 * window_a.padding[i + 2] - extent_a != 2 * window_b.padding[i + 2] - extent_b) {
+        return false;
+      }
+    }
+    return true;
   }
 
   Call MakeCombinedOp(const Group& branches) {
     const Op& conv2d = Op::Get("nn.conv2d");
     Expr data = branches[0][0]->args[0];
-    Expr new_weight;
-    IndexExpr new_channels;
-    std::tie(new_weight, new_channels) = TransformWeight(branches);
-
     const CallNode* group_root = branches[0][0];
     const auto* attrs = group_root->attrs.as<Conv2DAttrs>();
     CHECK(attrs);
+    // the largest kernel, all branches have the same kernel size when it is not constant.
+    Conv2DWindow window;
+    std::vector<int64_t> kernel;
+    if (GetConv2DWindow(group_root, &window)) {
+      kernel.assign(window.kernel, window.kernel + 2);
+      for (const auto& branch : branches) {
+        Conv2DWindow branch_window;
+        CHECK(GetConv2DWindow(branch[0], &branch_window));
+        for (size_t i = 0; i < 2; ++i) kernel[i] = std::max(kernel[i], branch_window.kernel[i]);
+      }
+    }
+    Expr new_weight;
+    IndexExpr new_channels;
+    std::tie(new_weight, new_channels) = TransformWeight(branches, kernel);
+
     const auto new_attrs = make_object<Conv2DAttrs>();
     new_attrs->strides = attrs->strides;
     new_attrs->padding = attrs->padding;
     new_attrs->dilation = attrs->dilation;
     new_attrs->groups = attrs->groups;
     new_attrs->kernel_size = attrs->kernel_size;
+    if (!kernel.empty() && (kernel[0] != window.kernel[0] || kernel[1] != window.kernel[1])) {
+      Array<IndexExpr> padding;
+      for (size_t i = 0; i < 4; ++i) {
+        int64_t grow = (kernel[i % 2] - window.kernel[i % 2]) / 2 * window.dilation[i % 2];
+        padding.push_back(tir::make_const(DataType::Int(32), window.padding[i] + grow));
+      }
+      new_attrs->padding = padding;
+      if (attrs->kernel_size.defined()) {
+        new_attrs->kernel_size = {tir::make_const(DataType::Int(32), kernel[0]),
+                                  tir::make_const(DataType::Int(32), kernel[1])};
+      }
+    }
     new_attrs->data_layout = attrs->data_layout;
     new_attrs->kernel_layout = attrs->kernel_layout;
     new_attrs->out_layout = attrs->out_layout;
@@ -194,17 +291,36 @@ class ParallelConv2DCombiner : public ParallelOpCombiner {
   /* \brief index of channel dimension */
   size_t channel_pos_;
 
-  std::tuple<Expr, IndexExpr> TransformWeight(const Group& branches) {
+  std::tuple<Expr, IndexExpr> TransformWeight(const Group& branches,
+                                              const std::vector<int64_t>& kernel) {
     int64_t num_filters = 0;  // number of filters of the transformed weight
     Array<Expr> weights;
     for (const auto& branch : branches) {
       auto conv2d = branch[0];
-      weights.push_back(conv2d->args[1]);
+      Expr weight = conv2d->args[1];
+      Conv2DWindow window;
+      if (!kernel.empty() && GetConv2DWindow(conv2d, &window) &&
+          (window.kernel[0] != kernel[0] || window.kernel[1] != kernel[1])) {
+        // pad the kernel with zeros on both sides to the largest kernel size.
+        // one pad width per axis of the layout, e.g. 5 for "OIHW16o".
+        Layout kernel_layout(conv2d->attrs.as<Conv2DAttrs>()->kernel_layout);
+        Array<Array<Integer>> pad_width;
+        for (size_t i = 0; i < kernel_layout.ndim(); ++i) {
+          const LayoutAxis& axis = kernel_layout[i];
+          int64_t pad = 0;
+          if (axis == LayoutAxis::Get('H')) pad = (kernel[0] - window.kernel[0]) / 2;
+          if (axis == LayoutAxis::Get('W')) pad = (kernel[1] - window.kernel[1]) / 2;
+          pad_width.push_back({Integer(pad), Integer(pad)});
+        }
+        weight = MakePad(weight, pad_width, 0.0, "constant");
+      }
+      weights.push_back(weight);
       auto channels = GetConv2DSuperChannelsDim(conv2d);
       num_filters += channels;
     }
-    auto index = branches[0][0]->attrs.as<Conv2DAttrs>()->kernel_layout.find('O');
-    CHECK_NE(index, std::string::npos);
+    Layout kernel_layout(branches[0][0]->attrs.as<Conv2DAttrs>()->kernel_layout);
+    int32_t index = kernel_layout.IndexOf(LayoutAxis::Get('O'));
+    CHECK_NE(index, -1);
     return std::make_tuple(MakeConcatenate(Tuple(weights), index),
                            tir::make_const(DataType::Int(32), num_filters));
   }
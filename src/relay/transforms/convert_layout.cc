@@ -25,10 +25,12 @@
  */
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/expr_functor.h>
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/relay/transform.h>
 #include <tvm/te/operation.h>
 
+#include <algorithm>
 #include <functional>
 #include <string>
 #include <tuple>
@@ -36,6 +38,7 @@
 #include <utility>
 #include <vector>
 
+#include "pass_util.h"
 #include "pattern_util.h"
 #include "transform_layout.h"
 
@@ -58,8 +61,20 @@ class ConvertTransformMemorizerNode : public TransformMemorizerNode {
   explicit ConvertTransformMemorizerNode(Map<String, Array<String>> desired_layouts)
       : desired_layouts_(std::move(desired_layouts)) {}
 
+  /*!
+   * \brief Initializes the desired layouts of individual calls.
+   * \param call_layouts Specify mapping of an original call to its desired layouts, the calls
+   *                     which are not in the mapping keep their layouts.
+   */
+  explicit ConvertTransformMemorizerNode(Map<Expr, Array<String>> call_layouts)
+      : call_layouts_(std::move(call_layouts)), per_call_(true) {}
+
   /*! \brief A mapping of op_name to array of desired layouts for each input. */
   Map<String, Array<String>> desired_layouts_;
+  /*! \brief A mapping of call to array of desired layouts, used instead of desired_layouts_. */
+  Map<Expr, Array<String>> call_layouts_;
+  /*! \brief Whether the desired layouts are given per call. */
+  bool per_call_{false};
 };
 
 /*!
@@ -87,18 +102,25 @@ class ConvertTransformMemorizer : public TransformMemorizer {
 
     Expr new_e;
     bool modified = false;
-    if (fconvert_layout.count(op)) {
+    bool per_call = operator->()->per_call_;
+    if (fconvert_layout.count(op) &&
+        (!per_call || operator->()->call_layouts_.count(ref_call))) {
       tvm::Array<tvm::te::Tensor> tinfos;
       for (auto expr : ref_call->args) {
         auto ttype = expr->type_as<TensorTypeNode>();
         tinfos.push_back(tvm::te::placeholder(ttype->shape, ttype->dtype));
       }
 
-      auto desired_layouts = operator->()->desired_layouts_;
-      if (desired_layouts.find(op->name) == desired_layouts.end()) {
-        LOG(FATAL) << "Desired layout(s) not specified for op: " << op->name;
+      Array<String> op_desired_layouts;
+      if (per_call) {
+        op_desired_layouts = operator->()->call_layouts_.at(ref_call);
+      } else {
+        auto desired_layouts = operator->()->desired_layouts_;
+        if (desired_layouts.find(op->name) == desired_layouts.end()) {
+          LOG(FATAL) << "Desired layout(s) not specified for op: " << op->name;
+        }
+        op_desired_layouts = desired_layouts.at(op->name);
       }
-      Array<String> op_desired_layouts = desired_layouts.at(op->name);
       Expr altered_value =
           fconvert_layout[op](ref_call->attrs, new_args, tinfos, op_desired_layouts);
       if (altered_value.defined()) {
@@ -131,6 +153,255 @@ Expr ConvertLayout(const Expr& expr, const Map<String, Array<String>>& desired_l
   return ForwardRewrite(expr, LayoutRewriter<ConvertTransformMemorizer>, fcontext);
 }
 
+/*!
+ * \brief Plan the layouts of all the calls of a function together.
+ *
+ *  Each call to an op with layout candidates either keeps its layouts or
+ *  takes one of the candidates. An assignment costs the ops in their layouts,
+ *  given by op_cost, plus the bytes moved by the layout transforms that
+ *  ConvertLayout inserts for it. The layouts the other calls propagate are
+ *  inferred the same way ConvertLayout does. The assignment is found by
+ *  dynamic programming over the calls in post order, keeping the cheapest
+ *  way to produce each output layout of each call. This is exact when the
+ *  dataflow graph is a tree, a shared value takes the layout asked for by its
+ *  last consumer.
+ */
+class LayoutPlanner : private ExprVisitor {
+ public:
+  LayoutPlanner(Map<String, Array<Array<String>>> candidates, PackedFunc op_cost,
+                double transform_cost)
+      : candidates_(std::move(candidates)),
+        op_cost_(std::move(op_cost)),
+        transform_cost_(transform_cost) {}
+
+  /*! \return The desired layouts of the calls which should change their layouts. */
+  Map<Expr, Array<String>> Plan(const Function& func) {
+    VisitExpr(func->body);
+    std::unordered_map<const CallNode*, size_t> chosen;
+    // the outputs of the function are transformed back to their original layouts.
+    std::vector<Expr> outputs;
+    if (const auto* tuple = func->body.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) outputs.push_back(field);
+    } else {
+      outputs.push_back(func->body);
+    }
+    for (const Expr& output : outputs) {
+      const auto* call = output.as<CallNode>();
+      if (call == nullptr || !info_.count(call) || chosen.count(call)) continue;
+      const CallInfo& info = info_.at(call);
+      double best_cost = 0;
+      for (size_t s = 0; s < info.states.size(); ++s) {
+        double cost = info.states[s].cost + TransformCost(info.states[s].layout, info.old_out,
+                                                          ValueBytes(call->checked_type()));
+        if (s == 0 || cost < best_cost) {
+          chosen[call] = s;
+          best_cost = cost;
+        }
+      }
+    }
+    Map<Expr, Array<String>> call_layouts;
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+      const CallInfo& info = info_.at(*it);
+      if (!chosen.count(*it)) chosen[*it] = Cheapest(info);
+      const State& state = info.states[chosen.at(*it)];
+      if (!state.layouts.empty()) call_layouts.Set(GetRef<Expr>(*it), state.layouts);
+      for (size_t i = 0; i < info.inputs.size(); ++i) {
+        if (info.inputs[i] != nullptr && !chosen.count(info.inputs[i])) {
+          chosen[info.inputs[i]] = state.input_states[i];
+        }
+      }
+    }
+    return call_layouts;
+  }
+
+ private:
+  /*! \brief The cheapest way to produce a call in one output layout. */
+  struct State {
+    Layout layout;
+    double cost;
+    /*! \brief The desired layouts of the call, empty to keep its layouts. */
+    Array<String> layouts;
+    /*! \brief The state of each input, for the inputs produced by planned calls. */
+    std::vector<size_t> input_states;
+  };
+
+  struct CallInfo {
+    /*! \brief The call producing each (flattened) input, nullptr if it is not planned. */
+    std::vector<const CallNode*> inputs;
+    Layout old_out;
+    std::vector<State> states;
+  };
+
+  double TransformCost(const Layout& from, const Layout& to, int64_t bytes) const {
+    if (!from.defined() || !to.defined() || from.Equals(to)) return 0;
+    return transform_cost_ * static_cast<double>(bytes);
+  }
+
+  static size_t Cheapest(const CallInfo& info) {
+    size_t best = 0;
+    for (size_t s = 1; s < info.states.size(); ++s) {
+      if (info.states[s].cost < info.states[best].cost) best = s;
+    }
+    return best;
+  }
+
+  /*! \brief The cheapest state of an input to be read in the required layout. */
+  std::pair<size_t, double> CheapestFor(const CallInfo& input, const Layout& required,
+                                        int64_t bytes) const {
+    std::pair<size_t, double> best(0, 0);
+    for (size_t s = 0; s < input.states.size(); ++s) {
+      double cost = input.states[s].cost + TransformCost(input.states[s].layout, required, bytes);
+      if (s == 0 || cost < best.second) best = {s, cost};
+    }
+    return best;
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    static auto fconvert_layout = Op::GetAttrMap<FTVMConvertOpLayout>("FTVMConvertOpLayout");
+    ExprVisitor::VisitExpr_(call);
+    CallInfo info;
+    std::vector<Expr> flat_args;
+    for (const Expr& arg : call->args) {
+      if (const auto* tuple = arg.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) flat_args.push_back(field);
+      } else {
+        flat_args.push_back(arg);
+      }
+    }
+    Array<Layout> producer_layouts;
+    std::vector<int64_t> bytes;
+    for (const Expr& arg : flat_args) {
+      const auto* producer = arg.as<CallNode>();
+      if (producer != nullptr && !info_.count(producer)) producer = nullptr;
+      info.inputs.push_back(producer);
+      producer_layouts.push_back(producer ? info_.at(producer).old_out : Layout::Undef());
+      bytes.push_back(ValueBytes(arg->checked_type()));
+    }
+    Array<Type> types;
+    for (const Expr& arg : call->args) types.push_back(arg->checked_type());
+    Array<Layout> old_in, old_out;
+    bool success = false;
+    std::tie(old_in, old_out, success) =
+        InferCorrectLayouts(GetRef<Call>(call), Array<Layout>(nullptr), producer_layouts, types);
+    if (success && old_out.size() == 1 && old_in.size() == flat_args.size()) {
+      info.old_out = old_out[0];
+      std::vector<Array<String>> choices = {Array<String>()};
+      const auto* op = call->op.as<OpNode>();
+      if (op != nullptr && candidates_.count(op->name) && fconvert_layout.count(GetRef<Op>(op))) {
+        for (const Array<String>& layouts : candidates_.at(op->name)) choices.push_back(layouts);
+      }
+      for (const Array<String>& layouts : choices) {
+        AddStates(call, layouts, flat_args, old_in, types, bytes, &info);
+      }
+    }
+    if (info.states.empty()) {
+      // ConvertLayout transforms the inputs of the call back to their original layouts.
+      State state{Layout::Undef(), 0, Array<String>(), std::vector<size_t>(flat_args.size(), 0)};
+      for (size_t i = 0; i < flat_args.size(); ++i) {
+        if (info.inputs[i] == nullptr) continue;
+        auto best = CheapestFor(info_.at(info.inputs[i]), producer_layouts[i], bytes[i]);
+        state.input_states[i] = best.first;
+        state.cost += best.second;
+      }
+      info.old_out = Layout::Undef();
+      info.states.push_back(state);
+    }
+    order_.push_back(call);
+    info_[call] = std::move(info);
+  }
+
+  /*! \brief Add the states of the call in the desired layouts, one per state of its lead input. */
+  void AddStates(const CallNode* call, const Array<String>& layouts,
+                 const std::vector<Expr>& flat_args, const Array<Layout>& old_in,
+                 const Array<Type>& types, const std::vector<int64_t>& bytes, CallInfo* info) {
+    static auto fconvert_layout = Op::GetAttrMap<FTVMConvertOpLayout>("FTVMConvertOpLayout");
+    Call new_call = GetRef<Call>(call);
+    double op_cost = 0;
+    if (!layouts.empty()) {
+      Array<te::Tensor> tinfos;
+      for (const Expr& arg : call->args) {
+        const auto* ttype = arg->checked_type().as<TensorTypeNode>();
+        if (ttype == nullptr) return;
+        tinfos.push_back(te::placeholder(ttype->shape, ttype->dtype));
+      }
+      Expr converted = fconvert_layout[Downcast<Op>(call->op)](call->attrs, call->args, tinfos,
+                                                              layouts);
+      if (!converted.defined() || !converted.as<CallNode>()) return;
+      new_call = Downcast<Call>(converted);
+    }
+    if (op_cost_ != nullptr) op_cost = op_cost_(GetRef<Call>(call), layouts);
+
+    size_t num_inputs = flat_args.size();
+    size_t lead = num_inputs;
+    for (size_t i = 0; i < num_inputs; ++i) {
+      if (info->inputs[i] != nullptr) {
+        lead = i;
+        break;
+      }
+    }
+    size_t num_lead_states = lead < num_inputs ? info_.at(info->inputs[lead]).states.size() : 1;
+    for (size_t lead_state = 0; lead_state < num_lead_states; ++lead_state) {
+      // the layouts the inputs arrive in, the other inputs take their cheapest state.
+      Array<Layout> new_in;
+      std::vector<size_t> input_states(num_inputs, 0);
+      for (size_t i = 0; i < num_inputs; ++i) {
+        Layout layout;
+        if (info->inputs[i] != nullptr) {
+          const CallInfo& input = info_.at(info->inputs[i]);
+          input_states[i] = i == lead ? lead_state : Cheapest(input);
+          layout = input.states[input_states[i]].layout;
+        }
+        new_in.push_back(layout.defined() ? layout : old_in[i]);
+      }
+      Array<Layout> required, new_out;
+      bool success = false;
+      std::tie(required, new_out, success) = InferCorrectLayouts(new_call, new_in, old_in, types);
+      if (!success || new_out.size() != 1 || required.size() != num_inputs) continue;
+      double cost = op_cost;
+      for (size_t i = 0; i < num_inputs; ++i) {
+        if (info->inputs[i] == nullptr || i == lead) {
+          if (info->inputs[i] != nullptr) {
+            cost += info_.at(info->inputs[i]).states[lead_state].cost;
+          }
+          cost += TransformCost(new_in[i], required[i], bytes[i]);
+        } else {
+          auto best = CheapestFor(info_.at(info->inputs[i]), required[i], bytes[i]);
+          input_states[i] = best.first;
+          cost += best.second;
+        }
+      }
+      auto it = std::find_if(info->states.begin(), info->states.end(),
+                             [&](const State& state) { return state.layout.Equals(new_out[0]); });
+      if (it == info->states.end()) {
+        info->states.push_back({new_out[0], cost, layouts, input_states});
+      } else if (cost < it->cost) {
+        *it = {new_out[0], cost, layouts, input_states};
+      }
+    }
+  }
+
+  // Primitive and nested functions are not planned.
+  void VisitExpr_(const FunctionNode* op) final {}
+
+  Map<String, Array<Array<String>>> candidates_;
+  PackedFunc op_cost_;
+  double transform_cost_;
+  std::unordered_map<const CallNode*, CallInfo> info_;
+  std::vector<const CallNode*> order_;
+};
+
+Expr PlanLayout(const Function& func, const Map<String, Array<Array<String>>>& candidates,
+                const PackedFunc& op_cost, double transform_cost) {
+  Map<Expr, Array<String>> call_layouts =
+      LayoutPlanner(candidates, op_cost, transform_cost).Plan(func);
+  if (call_layouts.empty()) return func;
+  ConvertTransformMemorizer transformMemorizer(
+      make_object<ConvertTransformMemorizerNode>(call_layouts));
+  auto fcontext = [&](const Call& call) -> ObjectRef { return transformMemorizer; };
+
+  return ForwardRewrite(func, LayoutRewriter<ConvertTransformMemorizer>, fcontext);
+}
+
 }  // namespace convert_op_layout
 
 namespace transform {
@@ -145,6 +416,18 @@ Pass ConvertLayout(const Map<String, Array<String>>& desired_layouts) {
 
 TVM_REGISTER_GLOBAL("relay._transform.ConvertLayout").set_body_typed(ConvertLayout);
 
+Pass PlanLayout(const Map<String, Array<Array<String>>>& candidates, PackedFunc op_cost,
+                double transform_cost) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(
+            relay::convert_op_layout::PlanLayout(f, candidates, op_cost, transform_cost));
+      };
+  return CreateFunctionPass(pass_func, 3, "PlanLayout", {"InferType", "CanonicalizeOps"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.PlanLayout").set_body_typed(PlanLayout);
+
 }  // namespace transform
 
 }  // namespace relay
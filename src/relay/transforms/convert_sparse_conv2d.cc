@@ -0,0 +1,236 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ *
+ * \file convert_sparse_conv2d.cc
+ *
+ * \brief Mutate conv2d operator to sparse dense operators
+ *
+ *  A conv2d is the sum over the taps of its kernel of a 1x1 convolution of
+ *  the shifted input, and a 1x1 convolution in NHWC is a dense over the
+ *  channels. So a conv2d with a pruned weight becomes one nn.sparse_dense
+ *  per tap that has non-zero weights, the all-zero taps are skipped.
+ */
+#include <tvm/ir/expr.h>
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pattern_util.h"
+
+namespace tvm {
+namespace relay {
+
+// Search conv2d op weight name and kernel layout from Expr
+class Conv2dOpWeightVisitor : private ExprVisitor {
+ public:
+  Conv2dOpWeightVisitor() : conv2d_op_(Op::Get("nn.conv2d")) {}
+
+  Map<String, String> Search(const Expr& expr) {
+    VisitExpr(expr);
+    return memo_;
+  }
+
+ private:
+  void VisitExpr_(const CallNode* n) final {
+    if (n->op == conv2d_op_) {
+      const auto* attrs = n->attrs.as<Conv2DAttrs>();
+      const auto weight = n->args[1].as<VarNode>();
+      if (weight && attrs->groups == 1 &&
+          (attrs->data_layout == "NCHW" || attrs->data_layout == "NHWC") &&
+          (attrs->out_layout == "" || attrs->out_layout == attrs->data_layout)) {
+        memo_.Set(weight->name_hint(), attrs->kernel_layout);
+      }
+    }
+    for (const auto& arg : n->args) {
+      VisitExpr(arg);
+    }
+  }
+  // Cache op
+  const Op& conv2d_op_;
+
+  Map<String, String> memo_;
+};  // Conv2dOpWeightVisitor
+
+Map<String, String> SearchConv2dOpWeight(const Expr& e) {
+  return Conv2dOpWeightVisitor().Search(e);
+}
+
+TVM_REGISTER_GLOBAL("relay.analysis.search_conv2d_op_weight").set_body_typed(SearchConv2dOpWeight);
+
+// Mutate ```nn.conv2d``` to ```nn.sparse_dense``` over the taps of the kernel
+class Conv2dToSparseDenseMutator : public ExprRewriter {
+ public:
+  /*! \brief The BSR weight of one tap of the kernel. */
+  struct SparseTap {
+    int row;
+    int col;
+    std::vector<int> data_shape;
+    int indices_size;
+    int indptr_size;
+  };
+
+  Conv2dToSparseDenseMutator(const Array<ObjectRef>& weight_name,
+                             const Array<Array<PrimExpr> >& weight_shape)
+      : conv2d_op_(Op::Get("nn.conv2d")), sparse_dense_op_(Op::Get("nn.sparse_dense")) {
+    CHECK_EQ(weight_name.size(), weight_shape.size());
+    for (size_t i = 0; i < weight_name.size(); ++i) {
+      CHECK(weight_name[i]->IsInstance<runtime::StringObj>());
+      std::string k = weight_name[i].as<runtime::StringObj>()->data;
+      // [num_taps, (row, col, data0, data1, data2, indices, indptr) per tap]
+      const auto& ws = weight_shape[i];
+      std::vector<int> v(ws.size());
+      for (size_t j = 0; j < ws.size(); ++j) {
+        v[j] = ws[j].as<IntImmNode>()->value;
+      }
+      CHECK(!v.empty() && v.size() == static_cast<size_t>(1 + 7 * v[0]))
+          << "Unexpected sparse conv2d weight shape for " << k;
+      std::vector<SparseTap> taps;
+      for (int t = 0; t < v[0]; ++t) {
+        const int* tap = &v[1 + 7 * t];
+        taps.push_back({tap[0], tap[1], {tap[2], tap[3], tap[4]}, tap[5], tap[6]});
+      }
+      target_weights_.emplace(k, taps);
+    }
+  }
+
+  Expr Rewrite_(const CallNode* pre, const Expr& post) override {
+    if (pre->op != conv2d_op_) return post;
+    const auto weight = pre->args[1].as<VarNode>();
+    if (!weight || !target_weights_.count(weight->name_hint())) return post;
+    const auto& prefix = weight->name_hint();
+    const auto* attrs = pre->attrs.as<Conv2DAttrs>();
+    CHECK(attrs);
+    bool nchw = attrs->data_layout == "NCHW";
+    // constant shapes and window in NHWC
+    std::vector<int64_t> in_shape, out_shape, padding, strides, dilation;
+    auto to_ints = [](const Array<IndexExpr>& values, std::vector<int64_t>* result) {
+      for (const auto& value : values) {
+        const auto* imm = value.as<IntImmNode>();
+        if (imm == nullptr) return false;
+        result->push_back(imm->value);
+      }
+      return true;
+    };
+    if (!to_ints(pre->args[0]->type_as<TensorTypeNode>()->shape, &in_shape) ||
+        !to_ints(pre->type_as<TensorTypeNode>()->shape, &out_shape) ||
+        !to_ints(attrs->padding, &padding) || !to_ints(attrs->strides, &strides) ||
+        !to_ints(attrs->dilation, &dilation) || padding.size() != 4) {
+      return post;
+    }
+    if (nchw) {
+      in_shape = {in_shape[0], in_shape[2], in_shape[3], in_shape[1]};
+      out_shape = {out_shape[0], out_shape[2], out_shape[3], out_shape[1]};
+    }
+    int64_t batch = in_shape[0], in_channels = in_shape[3];
+    int64_t out_h = out_shape[1], out_w = out_shape[2], out_channels = out_shape[3];
+
+    Expr data = post.as<CallNode>()->args[0];
+    if (nchw) data = MakeTranspose(data, {0, 2, 3, 1});
+    if (padding[0] || padding[1] || padding[2] || padding[3]) {
+      Array<Array<Integer> > pad_width = {{0, 0},
+                                          {Integer(padding[0]), Integer(padding[2])},
+                                          {Integer(padding[1]), Integer(padding[3])},
+                                          {0, 0}};
+      data = MakePad(data, pad_width, 0.0, "constant");
+    }
+    int64_t padded_h = in_shape[1] + padding[0] + padding[2];
+    int64_t padded_w = in_shape[2] + padding[1] + padding[3];
+    Expr result;
+    for (const SparseTap& tap : target_weights_.at(prefix)) {
+      Expr x = data;
+      int64_t begin_h = tap.row * dilation[0], begin_w = tap.col * dilation[1];
+      int64_t end_h = begin_h + (out_h - 1) * strides[0] + 1;
+      int64_t end_w = begin_w + (out_w - 1) * strides[1] + 1;
+      if (begin_h != 0 || begin_w != 0 || end_h != padded_h || end_w != padded_w ||
+          strides[0] != 1 || strides[1] != 1) {
+        std::vector<int64_t> shape = {4};
+        std::vector<int64_t> begin = {0, begin_h, begin_w, 0};
+        std::vector<int64_t> end = {batch, end_h, end_w, in_channels};
+        std::vector<int64_t> slice_strides = {1, strides[0], strides[1], 1};
+        x = MakeStridedSlice(x, MakeConstantTensor(DataType::Int(64), shape, begin),
+                             MakeConstantTensor(DataType::Int(64), shape, end),
+                             MakeConstantTensor(DataType::Int(64), shape, slice_strides), "end");
+      }
+      x = MakeReshape(x, {Integer(batch * out_h * out_w), Integer(in_channels)});
+      std::string tap_prefix =
+          prefix + "." + std::to_string(tap.row) + "." + std::to_string(tap.col);
+      auto ws_data_type = relay::TensorType(
+          {tap.data_shape.at(0), tap.data_shape.at(1), tap.data_shape.at(2)}, DataType::Float(32));
+      auto ws_indices_type = relay::TensorType({tap.indices_size}, DataType::Int(32));
+      auto ws_indptr_type = relay::TensorType({tap.indptr_size}, DataType::Int(32));
+      Var weight_data(tap_prefix + ".data", ws_data_type);
+      Var weight_indices(tap_prefix + ".indices", ws_indices_type);
+      Var weight_indptr(tap_prefix + ".indptr", ws_indptr_type);
+      Expr y = Call(sparse_dense_op_, {x, weight_data, weight_indices, weight_indptr});
+      result = result.defined() ? Add(result, y) : y;
+    }
+    if (!result.defined()) return post;
+    result = MakeReshape(result, {Integer(batch), Integer(out_h), Integer(out_w),
+                                  Integer(out_channels)});
+    if (nchw) result = MakeTranspose(result, {0, 3, 1, 2});
+    return result;
+  }
+
+ private:
+  // Cached op
+  const Op& conv2d_op_;
+  const Op& sparse_dense_op_;
+  std::unordered_map<std::string, std::vector<SparseTap> > target_weights_;
+};  // class Conv2dToSparseDenseMutator
+
+Expr Conv2dToSparse(const Expr& e, const Array<ObjectRef>& weight_name,
+                    const Array<Array<PrimExpr> >& weight_shape) {
+  auto rewriter = Conv2dToSparseDenseMutator(weight_name, weight_shape);
+  return PostOrderRewrite(e, &rewriter);
+}
+
+namespace transform {
+
+Pass Conv2dToSparse(const Array<ObjectRef>& weight_name,
+                    const Array<Array<PrimExpr> >& weight_shape) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        // Remove FreeVar warnings
+        auto f0 = Downcast<Function>(Conv2dToSparse(f, weight_name, weight_shape));
+        Array<Var> sparse_params = FreeVars(f0);
+        auto f1 = Function(sparse_params, f0->body, f0->ret_type, f0->type_params, f0->attrs);
+        Array<Var> params = FreeVars(f1);
+        for (const auto& var : sparse_params) {
+          params.push_back(var);
+        }
+        return Function(params, f1->body, f1->ret_type, f1->type_params, f1->attrs);
+      };
+  return CreateFunctionPass(pass_func, 4, "Conv2dToSparse", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.Conv2dToSparse").set_body_typed(Conv2dToSparse);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ *
+ * \file deduplicate_constants.cc
+ * \brief Merge the constants of a module which hold identical tensors.
+ *
+ * Models with tied or repeated weights often carry several copies of the same
+ * tensor. The copies are replaced by a single constant node, so that the backends,
+ * which allocate one parameter per constant node, keep one copy of the data, and
+ * EliminateCommonSubexpr can merge the operators that read it.
+ */
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <unordered_map>
+
+namespace tvm {
+namespace relay {
+
+class ConstantDeduplicator : public ExprMutator {
+ public:
+  Expr VisitExpr_(const ConstantNode* op) final {
+    Constant constant = GetRef<Constant>(op);
+    // The structural hash reads the tensor contents, which needs them on the host.
+    if (op->data->ctx.device_type != kDLCPU) {
+      return constant;
+    }
+    auto it = constants_.find(constant);
+    if (it != constants_.end()) {
+      return it->second;
+    }
+    constants_[constant] = constant;
+    return constant;
+  }
+
+ private:
+  std::unordered_map<Constant, Constant, StructuralHash, StructuralEqual> constants_;
+};
+
+IRModule DeduplicateConstants(IRModule mod) {
+  // The constants are shared across the functions of the module.
+  ConstantDeduplicator dedup;
+  tvm::Map<GlobalVar, Function> updates;
+  for (const auto& it : mod->functions) {
+    if (const auto* n = it.second.as<FunctionNode>()) {
+      if (n->GetAttr<String>(attr::kCompiler).defined()) continue;
+      updates.Set(it.first, Downcast<Function>(dedup.Mutate(GetRef<Function>(n))));
+    }
+  }
+  // Copy the module unless the caller hands over its only reference.
+  IRModuleNode* mod_ptr = mod.CopyOnWrite();
+  for (auto pair : updates) {
+    mod_ptr->Add(pair.first, pair.second, true);
+  }
+  return mod;
+}
+
+namespace transform {
+
+Pass DeduplicateConstants() {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) { return relay::DeduplicateConstants(m); };
+  return CreateModulePass(pass_func, 1, "DeduplicateConstants", {});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.DeduplicateConstants").set_body_typed(DeduplicateConstants);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
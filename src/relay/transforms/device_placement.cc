@@ -0,0 +1,364 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file device_placement.cc
+ * \brief Place the operators of a program on the devices of a heterogeneous
+ * build so that the estimated end-to-end latency is minimal.
+ *
+ * The operators run one after the other, so the latency of the program is the
+ * sum of the cost of every operator on its device and of every copy between
+ * two devices. The placement is computed in two steps:
+ *  1. A dynamic programming over the dataflow graph in topological order gives,
+ *     for every operator and device, the cost of the operator and its inputs,
+ *     from which the devices are assigned from the outputs backwards. This is
+ *     exact when the graph is a tree.
+ *  2. Every operator is then moved to the device minimizing the cost of the
+ *     operator and of its incoming and outgoing copies, until no move helps,
+ *     which accounts for the values used by several operators.
+ *
+ * The operators are annotated with on_device, RewriteAnnotatedOps then inserts
+ * the copies between the operators placed on different devices. The existing
+ * on_device annotations are kept.
+ */
+#include <tvm/relay/attrs/annotation.h>
+#include <tvm/relay/attrs/device_copy.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+#include <tvm/tir/op.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+namespace {
+
+constexpr double kInfCost = std::numeric_limits<double>::infinity();
+
+/*! \brief A value flowing from an operator to another. */
+struct PlacementEdge {
+  size_t src;
+  size_t dst;
+  /*! \brief The size of the value in bytes. */
+  int64_t bytes;
+};
+
+/*! \brief An operator or a tuple of the dataflow graph. */
+struct PlacementNode {
+  const ExprNode* expr;
+  /*! \brief The device type the node is annotated with, -1 when it is free. */
+  int pinned{-1};
+  std::vector<size_t> inputs;
+  std::vector<size_t> outputs;
+};
+
+int64_t ValueBytes(const Type& type) {
+  if (const auto* tt = type.as<TensorTypeNode>()) {
+    int64_t size = (tt->dtype.bits() * tt->dtype.lanes() + 7) / 8;
+    for (const auto& dim : tt->shape) {
+      // The dynamic dimensions are counted as one.
+      if (const auto* value = tir::as_const_int(dim)) size *= *value;
+    }
+    return size;
+  }
+  int64_t size = 0;
+  if (const auto* tuple = type.as<TupleTypeNode>()) {
+    for (const auto& field : tuple->fields) size += ValueBytes(field);
+  }
+  return size;
+}
+
+/*!
+ * \brief The dataflow graph of the operators of a function body, in post order,
+ * hence in topological order.
+ */
+class PlacementGraph : private ExprVisitor {
+ public:
+  static PlacementGraph Create(const Expr& body) {
+    PlacementGraph graph;
+    graph.VisitExpr(body);
+    return graph;
+  }
+
+  std::vector<PlacementNode> nodes;
+  std::vector<PlacementEdge> edges;
+  /*! \brief Whether the body already contains device copies. */
+  bool has_device_copy{false};
+
+  /*! \return The index of the node producing an expression, -1 when it is not placed. */
+  int Find(const ExprNode* expr) const {
+    auto it = index_.find(expr);
+    return it == index_.end() ? -1 : static_cast<int>(it->second);
+  }
+
+ private:
+  void VisitExpr_(const FunctionNode* op) final {
+    // The operators of the closures, fused or external functions are not placed.
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    ExprVisitor::VisitExpr_(call);
+    static const Op& on_device_op = Op::Get("on_device");
+    static const Op& device_copy_op = Op::Get("device_copy");
+    if (call->op == on_device_op) {
+      int src = Find(call->args[0].get());
+      if (src >= 0) {
+        nodes[src].pinned = call->attrs.as<OnDeviceAttrs>()->device_type;
+        index_[call] = src;
+      }
+    } else if (call->op == device_copy_op) {
+      has_device_copy = true;
+    } else if (call->op.as<OpNode>()) {
+      AddNode(call, call->args);
+    }
+  }
+
+  void VisitExpr_(const TupleNode* tuple) final {
+    ExprVisitor::VisitExpr_(tuple);
+    AddNode(tuple, tuple->fields);
+  }
+
+  void VisitExpr_(const TupleGetItemNode* op) final {
+    ExprVisitor::VisitExpr_(op);
+    // The fields of a tuple are on the device of the tuple.
+    int src = Find(op->tuple.get());
+    if (src >= 0) index_[op] = src;
+  }
+
+  void AddNode(const ExprNode* expr, const Array<Expr>& args) {
+    size_t dst = nodes.size();
+    nodes.push_back(PlacementNode());
+    nodes[dst].expr = expr;
+    index_[expr] = dst;
+    for (const auto& arg : args) {
+      int src = Find(arg.get());
+      if (src < 0) continue;
+      int64_t bytes = arg->checked_type_.defined() ? ValueBytes(arg->checked_type()) : 0;
+      nodes[src].outputs.push_back(edges.size());
+      nodes[dst].inputs.push_back(edges.size());
+      edges.push_back({static_cast<size_t>(src), dst, bytes});
+    }
+  }
+
+  std::unordered_map<const ExprNode*, size_t> index_;
+};
+
+/*! \brief Wrap the placed nodes with on_device. */
+class PlacementAnnotator : public ExprMutator {
+ public:
+  explicit PlacementAnnotator(std::unordered_map<const ExprNode*, int> devices)
+      : devices_(std::move(devices)) {}
+
+  Expr VisitExpr_(const CallNode* call) final {
+    return Annotate(call, ExprMutator::VisitExpr_(call));
+  }
+
+  Expr VisitExpr_(const TupleNode* tuple) final {
+    return Annotate(tuple, ExprMutator::VisitExpr_(tuple));
+  }
+
+ private:
+  Expr Annotate(const ExprNode* old_expr, const Expr& new_expr) {
+    auto it = devices_.find(old_expr);
+    if (it == devices_.end()) return new_expr;
+    auto attrs = make_object<OnDeviceAttrs>();
+    attrs->device_type = it->second;
+    static const Op& op = Op::Get("on_device");
+    return Call(op, {new_expr}, Attrs(attrs), {});
+  }
+
+  std::unordered_map<const ExprNode*, int> devices_;
+};
+
+class DevicePlacer {
+ public:
+  DevicePlacer(const Array<Integer>& device_types, PackedFunc op_cost, PackedFunc transfer_cost,
+               int fallback_device)
+      : op_cost_(op_cost), transfer_cost_(transfer_cost) {
+    // The fallback device comes first, it wins the ties.
+    devices_.push_back(fallback_device);
+    for (const auto& device : device_types) {
+      if (device->value != fallback_device) devices_.push_back(device->value);
+    }
+  }
+
+  Expr Place(const Expr& body) {
+    PlacementGraph graph = PlacementGraph::Create(body);
+    // The program is already rewritten, the annotations cannot be changed anymore.
+    if (graph.has_device_copy || graph.nodes.empty()) return body;
+    EstimateCosts(graph);
+    std::vector<size_t> placement = Assign(graph);
+    Refine(graph, &placement);
+
+    std::unordered_map<const ExprNode*, int> devices;
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+      if (graph.nodes[i].pinned < 0) devices[graph.nodes[i].expr] = devices_[placement[i]];
+    }
+    return PlacementAnnotator(devices)(body);
+  }
+
+ private:
+  size_t NumDevices() const { return devices_.size(); }
+
+  void EstimateCosts(const PlacementGraph& graph) {
+    size_t num_devices = NumDevices();
+    op_costs_.assign(graph.nodes.size(), std::vector<double>(num_devices, 0.0));
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+      const PlacementNode& node = graph.nodes[i];
+      bool supported = false;
+      for (size_t d = 0; d < num_devices; ++d) {
+        double cost = 0.0;
+        if (node.pinned >= 0 && node.pinned != devices_[d]) {
+          cost = kInfCost;
+        } else if (node.expr->IsInstance<CallNode>()) {
+          // Negative costs mark the operators a device does not support.
+          cost = op_cost_(GetRef<Call>(static_cast<const CallNode*>(node.expr)), devices_[d]);
+          if (!(cost >= 0.0)) cost = kInfCost;
+        }
+        op_costs_[i][d] = cost;
+        supported |= cost != kInfCost;
+      }
+      CHECK(supported) << "None of the devices can run " << GetRef<Expr>(node.expr);
+    }
+    transfer_costs_.assign(graph.edges.size(),
+                           std::vector<double>(num_devices * num_devices, 0.0));
+    for (size_t e = 0; e < graph.edges.size(); ++e) {
+      for (size_t src = 0; src < num_devices; ++src) {
+        for (size_t dst = 0; dst < num_devices; ++dst) {
+          if (src == dst) continue;
+          double cost = transfer_cost_(graph.edges[e].bytes, devices_[src], devices_[dst]);
+          transfer_costs_[e][src * num_devices + dst] = cost;
+        }
+      }
+    }
+  }
+
+  double TransferCost(size_t edge, size_t src, size_t dst) const {
+    return transfer_costs_[edge][src * NumDevices() + dst];
+  }
+
+  std::vector<size_t> Assign(const PlacementGraph& graph) const {
+    size_t num_nodes = graph.nodes.size();
+    size_t num_devices = NumDevices();
+    // best[i][d]: the cost of node i on device d and of all its inputs.
+    std::vector<std::vector<double>> best(num_nodes, std::vector<double>(num_devices));
+    for (size_t i = 0; i < num_nodes; ++i) {
+      for (size_t d = 0; d < num_devices; ++d) {
+        double cost = op_costs_[i][d];
+        for (size_t e : graph.nodes[i].inputs) {
+          size_t src = graph.edges[e].src;
+          double input_cost = kInfCost;
+          for (size_t s = 0; s < num_devices; ++s) {
+            input_cost = std::min(input_cost, best[src][s] + TransferCost(e, s, d));
+          }
+          cost += input_cost;
+        }
+        best[i][d] = cost;
+      }
+    }
+    // The consumers of a node come after it, they are placed first.
+    std::vector<size_t> placement(num_nodes, 0);
+    for (size_t i = num_nodes; i-- > 0;) {
+      double min_cost = kInfCost;
+      for (size_t d = 0; d < num_devices; ++d) {
+        double cost = best[i][d];
+        for (size_t e : graph.nodes[i].outputs) {
+          cost += TransferCost(e, d, placement[graph.edges[e].dst]);
+        }
+        if (cost < min_cost) {
+          min_cost = cost;
+          placement[i] = d;
+        }
+      }
+    }
+    return placement;
+  }
+
+  void Refine(const PlacementGraph& graph, std::vector<size_t>* placement) const {
+    // Every move lowers the total cost, the rounds only bound the time spent.
+    constexpr int kMaxRounds = 16;
+    std::vector<size_t>& dev = *placement;
+    for (int round = 0; round < kMaxRounds; ++round) {
+      bool changed = false;
+      for (size_t i = 0; i < graph.nodes.size(); ++i) {
+        const PlacementNode& node = graph.nodes[i];
+        auto local_cost = [&](size_t d) {
+          double cost = op_costs_[i][d];
+          for (size_t e : node.inputs) cost += TransferCost(e, dev[graph.edges[e].src], d);
+          for (size_t e : node.outputs) cost += TransferCost(e, d, dev[graph.edges[e].dst]);
+          return cost;
+        };
+        double min_cost = local_cost(dev[i]);
+        for (size_t d = 0; d < NumDevices(); ++d) {
+          double cost = local_cost(d);
+          if (cost < min_cost) {
+            min_cost = cost;
+            dev[i] = d;
+            changed = true;
+          }
+        }
+      }
+      if (!changed) break;
+    }
+  }
+
+  std::vector<int> devices_;
+  runtime::TypedPackedFunc<double(Call, int)> op_cost_;
+  runtime::TypedPackedFunc<double(int64_t, int, int)> transfer_cost_;
+  std::vector<std::vector<double>> op_costs_;
+  /*! \brief The cost of each edge, by source and destination device. */
+  std::vector<std::vector<double>> transfer_costs_;
+};
+
+}  // namespace
+
+Expr AutoDevicePlacement(const Expr& expr, const Array<Integer>& device_types,
+                         const PackedFunc& op_cost, const PackedFunc& transfer_cost,
+                         int fallback_device) {
+  return DevicePlacer(device_types, op_cost, transfer_cost, fallback_device).Place(expr);
+}
+
+namespace transform {
+
+Pass AutoDevicePlacement(Array<Integer> device_types, PackedFunc op_cost, PackedFunc transfer_cost,
+                         int fallback_device) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        if (f->HasNonzeroAttr(attr::kPrimitive) || f->GetAttr<String>(attr::kCompiler)) {
+          return f;
+        }
+        Expr body = relay::AutoDevicePlacement(f->body, device_types, op_cost, transfer_cost,
+                                               fallback_device);
+        if (body.same_as(f->body)) return f;
+        return Function(f->params, body, f->ret_type, f->type_params, f->attrs, f->span);
+      };
+  return CreateFunctionPass(pass_func, 1, "AutoDevicePlacement", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.AutoDevicePlacement").set_body_typed(AutoDevicePlacement);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -24,13 +24,22 @@
  */
 #include <tvm/relay/attrs/algorithm.h>
 #include <tvm/relay/attrs/image.h>
+#include <tvm/relay/attrs/transform.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/transform.h>
 
+#include <utility>
+#include <vector>
+
+#include "../op/make_op.h"
+#include "pass_util.h"
 #include "pattern_util.h"
 
 namespace tvm {
 namespace relay {
+namespace dyn {
+Expr MakeReshape(Expr data, Expr newshape);
+}  // namespace dyn
 
 class DynamicToStaticMutator : public MixedModeMutator {
  public:
@@ -181,17 +190,12 @@ class DynamicToStaticMutator : public MixedModeMutator {
       op_map_;
 };
 
-Expr DynamicToStatic(Function f, IRModule m) {
-  Expr pre = f;
-  Expr expr = f;
+Expr DynamicToStatic(IRModule m, GlobalVar gv) {
+  Expr pre = m->Lookup(gv);
+  Expr expr = pre;
   auto fold_const = transform::FoldConstant();
   auto infer_type = transform::InferType();
   DynamicToStaticMutator mutator;
-  Map<BaseFunc, GlobalVar> vars;
-  for (auto kv : m->functions) {
-    vars.Set(kv.second, kv.first);
-  }
-  const auto gv = vars[f];
   int i = 0;
   do {
     pre = expr;
@@ -205,6 +209,123 @@ Expr DynamicToStatic(Function f, IRModule m) {
   return expr;
 }
 
+Expr DynamicToStatic(Function f, IRModule m) {
+  Map<BaseFunc, GlobalVar> vars;
+  for (auto kv : m->functions) {
+    vars.Set(kv.second, kv.first);
+  }
+  return DynamicToStatic(m, vars[f]);
+}
+
+/* A function is specialized for the profiled shapes of its dynamic parameters.
+ *
+ * fn (%x: Tensor[(?, 4)]) { body }
+ *
+ * becomes, for the shape (8, 4) of %x:
+ *
+ * fn (%x: Tensor[(?, 4)]) {
+ *   let %shape_guard = equal(take(shape_of(%x), 0), 8);
+ *   if (%shape_guard) {
+ *     let %x: Tensor[(8, 4)] = reshape(%x, newshape=[8, 4]);
+ *     dyn.reshape(stop_fusion(static body), shape_of(..) * cast(%shape_guard, int64))
+ *   } else {
+ *     body
+ *   }
+ * }
+ *
+ * The static branch goes through DynamicToStatic, so the shapes computed from
+ * the specialized parameters fold and its dynamic operators become static.
+ * Its result gets a dynamic type again, otherwise unifying the branches would
+ * make the fallback static too. The new shape reads the guard, so constant
+ * folding cannot make the result static later on.
+ */
+class ShapeSpecializer {
+ public:
+  ShapeSpecializer(IRModule mod, Map<String, Array<Integer>> shapes)
+      : mod_(std::move(mod)), shapes_(std::move(shapes)) {}
+
+  Function Specialize(const Function& func) {
+    Expr guard;
+    Array<Var> static_params;
+    std::vector<Expr> static_args;
+    tvm::Map<Var, Expr> binds;
+    for (const Var& param : func->params) {
+      auto it = shapes_.find(param->name_hint());
+      const auto* ttype = param->checked_type().as<TensorTypeNode>();
+      if (it == shapes_.end() || ttype == nullptr || !IsDynamic(param->checked_type())) {
+        static_params.push_back(param);
+        static_args.push_back(param);
+        continue;
+      }
+      Array<Integer> shape = (*it).second;
+      CHECK_EQ(shape.size(), ttype->shape.size())
+          << "The profiled shape of " << param->name_hint() << " has the wrong rank";
+      Array<IndexExpr> static_shape;
+      for (size_t i = 0; i < shape.size(); ++i) {
+        if (const int64_t* dim = tir::as_const_int(ttype->shape[i])) {
+          CHECK_EQ(*dim, shape[i]->value)
+              << "The profiled shape of " << param->name_hint() << " conflicts with its type";
+        } else {
+          Expr extent = MakeConstantScalar(DataType::Int(64), shape[i]->value);
+          Expr equal = Call(Op::Get("equal"), {Extent(param, i), extent});
+          guard = guard.defined() ? Call(Op::Get("logical_and"), {guard, equal}) : equal;
+        }
+        static_shape.push_back(Integer(shape[i]->value));
+      }
+      Var static_param(param->name_hint(), TensorType(static_shape, ttype->dtype));
+      static_params.push_back(static_param);
+      static_args.push_back(MakeReshape(param, shape));
+      binds.Set(param, static_param);
+    }
+    if (!guard.defined()) return func;
+
+    GlobalVar gv("specialized_shapes");
+    mod_->Add(gv, Function(static_params, Bind(func->body, binds), Type(), func->type_params));
+    Function static_func = Downcast<Function>(DynamicToStatic(mod_, gv));
+
+    Var guard_var("shape_guard", TensorType::Scalar(DataType::Bool()));
+    Expr fast_path = EraseStaticShape(static_func->body, func->body->checked_type(), guard_var);
+    for (size_t i = static_args.size(); i > 0; --i) {
+      if (!static_func->params[i - 1].same_as(static_args[i - 1])) {
+        fast_path = Let(static_func->params[i - 1], static_args[i - 1], fast_path);
+      }
+    }
+    Expr body = Let(guard_var, guard, If(guard_var, fast_path, func->body));
+    return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+  }
+
+ private:
+  /*! \brief Give the dynamic parts of type back to the static value e. */
+  static Expr EraseStaticShape(const Expr& e, const Type& type, const Var& guard) {
+    if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+      Array<Expr> fields;
+      for (size_t i = 0; i < tuple_type->fields.size(); ++i) {
+        fields.push_back(EraseStaticShape(TupleGetItem(e, i), tuple_type->fields[i], guard));
+      }
+      return Tuple(fields);
+    }
+    if (!type.as<TensorTypeNode>() || !IsDynamic(type)) return e;
+    // Keep the static kernel out of the fused reshape, which the VM runs without a copy.
+    Expr value = StopFusion(e);
+    Expr newshape = Multiply(ShapeOf(value), Cast(guard, DataType::Int(64)));
+    return dyn::MakeReshape(value, newshape);
+  }
+
+  static Expr ShapeOf(const Expr& e) {
+    auto attrs = make_object<ShapeOfAttrs>();
+    attrs->dtype = DataType::Int(64);
+    return Call(Op::Get("shape_of"), {e}, Attrs(attrs), {});
+  }
+
+  /*! \brief The extent of a tensor along an axis, as an int64 scalar. */
+  static Expr Extent(const Expr& e, int axis) {
+    return MakeTake(ShapeOf(e), MakeConstantScalar(DataType::Int(32), axis), Integer(0), "clip");
+  }
+
+  IRModule mod_;
+  Map<String, Array<Integer>> shapes_;
+};
+
 namespace transform {
 
 Pass ConvertDynamicToStatic() {
@@ -219,6 +340,18 @@ TVM_REGISTER_GLOBAL("relay._transform.DynamicToStatic").set_body_typed([]() {
   return ConvertDynamicToStatic();
 });
 
+Pass SpecializeDynamicShapes(Map<String, Array<Integer>> shapes) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        IRModule mod(m->functions, m->type_definitions);
+        return ShapeSpecializer(mod, shapes).Specialize(f);
+      };
+  return CreateFunctionPass(pass_func, 1, "SpecializeDynamicShapes", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.SpecializeDynamicShapes")
+    .set_body_typed(SpecializeDynamicShapes);
+
 }  // namespace transform
 }  // namespace relay
 }  // namespace tvm
@@ -30,6 +30,14 @@
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/object.h>
+#include <tvm/tir/data_layout.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "pattern_util.h"
 
@@ -73,6 +81,297 @@ bool ConstantCheck(const Expr& e) { return ConstantChecker().Check(e); }
 
 TVM_REGISTER_GLOBAL("relay.analysis.check_constant").set_body_typed(ConstantCheck);
 
+/*!
+ * \brief Evaluate common layout and elementwise ops on constant tensors
+ *  directly, instead of building and JIT compiling a module for each call.
+ */
+class NativeConstEvaluator {
+ public:
+  /*!
+   * \brief Evaluate a call whose arguments are all constants.
+   * \param call The call.
+   * \param type The checked type of the call.
+   * \return The result, undefined when the call is not supported natively.
+   */
+  runtime::NDArray Eval(const CallNode* call, const Type& type) const {
+    static const std::unordered_set<std::string> reshape_ops{
+        "reshape", "reshape_like", "contrib_reverse_reshape", "squeeze", "expand_dims",
+        "nn.batch_flatten", "copy"};
+    static const std::unordered_set<std::string> float_binary_ops{"add", "subtract", "multiply",
+                                                                  "divide"};
+    const OpNode* op = call->op.as<OpNode>();
+    std::vector<int64_t> out_shape;
+    DataType out_dtype;
+    if (op == nullptr || !GetStaticType(type, &out_shape, &out_dtype)) {
+      return runtime::NDArray();
+    }
+    std::vector<runtime::NDArray> args;
+    for (const auto& arg : call->args) {
+      const auto* constant = arg.as<ConstantNode>();
+      if (constant == nullptr || !IsCompact(constant->data)) return runtime::NDArray();
+      args.push_back(constant->data);
+    }
+    const runtime::NDArray& data = args[0];
+    DataType dtype = data.DataType();
+
+    if (reshape_ops.count(op->name)) {
+      if (Size(out_shape) != Size(data.Shape())) return runtime::NDArray();
+      return Gather(data, out_shape, Strides(out_shape));
+    } else if (op->name == "transpose") {
+      const auto* param = call->attrs.as<TransposeAttrs>();
+      int ndim = static_cast<int>(data->ndim);
+      std::vector<int64_t> in_strides = Strides(data.Shape());
+      std::vector<int64_t> strides;
+      for (int i = 0; i < ndim; ++i) {
+        int axis = param->axes.defined() && param->axes.size() != 0
+                       ? static_cast<int>(param->axes[i]->value)
+                       : ndim - 1 - i;
+        if (axis < 0) axis += ndim;
+        strides.push_back(in_strides[axis]);
+      }
+      return Gather(data, out_shape, strides);
+    } else if (op->name == "layout_transform") {
+      const auto* param = call->attrs.as<LayoutTransformAttrs>();
+      return LayoutTransform(data, param->src_layout, param->dst_layout, out_shape);
+    } else if (op->name == "cast") {
+      if (!IsSupported(dtype) || !IsSupported(out_dtype)) return runtime::NDArray();
+      runtime::NDArray out = runtime::NDArray::Empty(out_shape, out_dtype, data->ctx);
+      int64_t size = Size(out_shape);
+      DispatchDType(dtype, [&](auto src_tag) {
+        using SrcType = decltype(src_tag);
+        DispatchDType(out_dtype, [&](auto dst_tag) {
+          using DstType = decltype(dst_tag);
+          const SrcType* src = Data<SrcType>(data);
+          DstType* dst = Data<DstType>(out);
+          for (int64_t i = 0; i < size; ++i) dst[i] = static_cast<DstType>(src[i]);
+        });
+      });
+      return out;
+    } else if (op->name == "negative") {
+      if (!dtype.is_float() || !IsSupported(dtype)) return runtime::NDArray();
+      return Elementwise(args, out_shape, [](auto a, auto) { return -a; });
+    } else if (float_binary_ops.count(op->name) || op->name == "maximum" ||
+               op->name == "minimum") {
+      CHECK_EQ(args.size(), 2U);
+      if (!IsSupported(dtype) || args[1].DataType() != dtype) return runtime::NDArray();
+      if (op->name == "maximum") {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a > b ? a : b; });
+      } else if (op->name == "minimum") {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a < b ? a : b; });
+      }
+      // Integer arithmetic is left to the compiled ops, which define the overflow behavior.
+      if (!dtype.is_float()) return runtime::NDArray();
+      if (op->name == "add") {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a + b; });
+      } else if (op->name == "subtract") {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a - b; });
+      } else if (op->name == "multiply") {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a * b; });
+      } else {
+        return Elementwise(args, out_shape, [](auto a, auto b) { return a / b; });
+      }
+    }
+    return runtime::NDArray();
+  }
+
+ private:
+  static bool GetStaticType(const Type& type, std::vector<int64_t>* shape, DataType* dtype) {
+    const auto* tensor_type = type.as<TensorTypeNode>();
+    if (tensor_type == nullptr) return false;
+    for (const auto& dim : tensor_type->shape) {
+      const auto* value = dim.as<IntImmNode>();
+      if (value == nullptr) return false;
+      shape->push_back(value->value);
+    }
+    *dtype = tensor_type->dtype;
+    return dtype->lanes() == 1 && dtype->bits() % 8 == 0;
+  }
+
+  static bool IsCompact(const runtime::NDArray& array) {
+    return array->ctx.device_type == kDLCPU && array->strides == nullptr &&
+           array.DataType().lanes() == 1 && array.DataType().bits() % 8 == 0;
+  }
+
+  static bool IsSupported(DataType dtype) {
+    return (dtype.is_float() && (dtype.bits() == 32 || dtype.bits() == 64)) ||
+           (dtype.is_int() && (dtype.bits() == 8 || dtype.bits() == 32 || dtype.bits() == 64)) ||
+           (dtype.is_uint() && dtype.bits() == 8);
+  }
+
+  template <typename F>
+  static void DispatchDType(DataType dtype, F f) {
+    if (dtype.is_float()) {
+      dtype.bits() == 32 ? f(float()) : f(double());
+    } else if (dtype.is_uint()) {
+      f(uint8_t());
+    } else if (dtype.bits() == 8) {
+      f(int8_t());
+    } else {
+      dtype.bits() == 32 ? f(int32_t()) : f(int64_t());
+    }
+  }
+
+  template <typename T>
+  static T* Data(const runtime::NDArray& array) {
+    return reinterpret_cast<T*>(static_cast<char*>(array->data) + array->byte_offset);
+  }
+
+  static int64_t Size(const std::vector<int64_t>& shape) {
+    int64_t size = 1;
+    for (int64_t dim : shape) size *= dim;
+    return size;
+  }
+
+  static std::vector<int64_t> Strides(const std::vector<int64_t>& shape) {
+    std::vector<int64_t> strides(shape.size(), 1);
+    for (int i = static_cast<int>(shape.size()) - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * shape[i + 1];
+    }
+    return strides;
+  }
+
+  /*!
+   * \brief Visit the elements of shape in row major order, passing the offset
+   *  of each element into every input described by its element strides.
+   */
+  template <typename F>
+  static void ForEachIndex(const std::vector<int64_t>& shape,
+                           const std::vector<std::vector<int64_t>>& strides, F f) {
+    int64_t size = Size(shape);
+    int ndim = static_cast<int>(shape.size());
+    std::vector<int64_t> index(ndim, 0);
+    std::vector<int64_t> offsets(strides.size(), 0);
+    for (int64_t i = 0; i < size; ++i) {
+      f(i, offsets);
+      for (int d = ndim - 1; d >= 0; --d) {
+        for (size_t k = 0; k < strides.size(); ++k) offsets[k] += strides[k][d];
+        if (++index[d] < shape[d]) break;
+        for (size_t k = 0; k < strides.size(); ++k) offsets[k] -= strides[k][d] * shape[d];
+        index[d] = 0;
+      }
+    }
+  }
+
+  /*! \brief Copy the elements of data found at the given strides into a tensor of out_shape. */
+  static runtime::NDArray Gather(const runtime::NDArray& data,
+                                 const std::vector<int64_t>& out_shape,
+                                 const std::vector<int64_t>& strides) {
+    runtime::NDArray out = runtime::NDArray::Empty(out_shape, data.DataType(), data->ctx);
+    size_t elem_bytes = data.DataType().bits() / 8;
+    const char* src = Data<char>(data);
+    char* dst = Data<char>(out);
+    ForEachIndex(out_shape, {strides}, [&](int64_t i, const std::vector<int64_t>& offsets) {
+      std::memcpy(dst + i * elem_bytes, src + offsets[0] * elem_bytes, elem_bytes);
+    });
+    return out;
+  }
+
+  /*! \brief Apply f on the broadcast elements of args. */
+  template <typename F>
+  static runtime::NDArray Elementwise(const std::vector<runtime::NDArray>& args,
+                                      const std::vector<int64_t>& out_shape, F f) {
+    DataType dtype = args[0].DataType();
+    runtime::NDArray out = runtime::NDArray::Empty(out_shape, dtype, args[0]->ctx);
+    std::vector<std::vector<int64_t>> strides;
+    for (const auto& arg : args) {
+      std::vector<int64_t> shape = arg.Shape();
+      if (shape.size() > out_shape.size()) return runtime::NDArray();
+      shape.insert(shape.begin(), out_shape.size() - shape.size(), 1);
+      std::vector<int64_t> arg_strides = Strides(shape);
+      for (size_t d = 0; d < shape.size(); ++d) {
+        if (shape[d] == 1) {
+          arg_strides[d] = 0;
+        } else if (shape[d] != out_shape[d]) {
+          return runtime::NDArray();
+        }
+      }
+      strides.push_back(arg_strides);
+    }
+    DispatchDType(dtype, [&](auto tag) {
+      using T = decltype(tag);
+      const T* lhs = Data<T>(args[0]);
+      const T* rhs = Data<T>(args.back());
+      T* dst = Data<T>(out);
+      ForEachIndex(out_shape, strides, [&](int64_t i, const std::vector<int64_t>& offsets) {
+        dst[i] = static_cast<T>(f(lhs[offsets[0]], rhs[offsets.back()]));
+      });
+    });
+    return out;
+  }
+
+  /*!
+   * \brief Transform between layouts where each primal axis is split on at
+   *  most one side, or by the same factor on both, as a reshape followed by a
+   *  transpose over the split axes.
+   */
+  static runtime::NDArray LayoutTransform(const runtime::NDArray& data,
+                                          const std::string& src_name,
+                                          const std::string& dst_name,
+                                          const std::vector<int64_t>& out_shape) {
+    tir::Layout src(src_name), dst(dst_name);
+    if (!src.defined() || !dst.defined() || src.ndim_primal() != dst.ndim_primal()) {
+      return runtime::NDArray();
+    }
+    std::vector<int64_t> in_shape = data.Shape();
+    if (in_shape.size() != src.ndim()) return runtime::NDArray();
+    // The extent and split factor of every primal axis.
+    std::unordered_map<std::string, int64_t> extents, factors;
+    for (size_t i = 0; i < src.ndim(); ++i) {
+      const auto& axis = src[i];
+      if (!axis.IsPrimal()) continue;
+      int32_t src_factor = src.FactorOf(axis);
+      int32_t dst_factor = dst.FactorOf(axis);
+      if (!dst.Contains(axis) || (src_factor > 0 && dst_factor > 0 && src_factor != dst_factor)) {
+        return runtime::NDArray();
+      }
+      int64_t extent = in_shape[i] * (src_factor > 0 ? src_factor : 1);
+      int64_t factor = std::max(src_factor, dst_factor);
+      if (factor > 0 && extent % factor != 0) return runtime::NDArray();
+      extents[axis.name()] = extent;
+      factors[axis.name()] = factor;
+    }
+    // Expand a layout into the finest axes: outer and inner part of a split
+    // primal axis, or the whole axis.
+    auto expand = [&](const tir::Layout& layout, std::vector<std::string>* names,
+                      std::vector<int64_t>* shape) {
+      for (size_t i = 0; i < layout.ndim(); ++i) {
+        const auto& axis = layout[i];
+        std::string primal = axis.ToPrimal().name();
+        int64_t factor = factors[primal];
+        bool split = layout.FactorOf(axis) > 0;
+        if (!axis.IsPrimal()) {
+          names->push_back(primal + ".inner");
+          shape->push_back(factor);
+        } else if (factor > 0) {
+          names->push_back(primal + ".outer");
+          shape->push_back(extents[primal] / factor);
+          if (!split) {
+            names->push_back(primal + ".inner");
+            shape->push_back(factor);
+          }
+        } else {
+          names->push_back(primal);
+          shape->push_back(extents[primal]);
+        }
+      }
+    };
+    std::vector<std::string> src_axes, dst_axes;
+    std::vector<int64_t> src_shape, dst_shape;
+    expand(src, &src_axes, &src_shape);
+    expand(dst, &dst_axes, &dst_shape);
+    if (Size(dst_shape) != Size(out_shape)) return runtime::NDArray();
+    std::vector<int64_t> src_strides = Strides(src_shape);
+    std::vector<int64_t> strides;
+    for (const auto& name : dst_axes) {
+      auto it = std::find(src_axes.begin(), src_axes.end(), name);
+      if (it == src_axes.end()) return runtime::NDArray();
+      strides.push_back(src_strides[it - src_axes.begin()]);
+    }
+    runtime::NDArray out = Gather(data, dst_shape, strides);
+    return out.CreateView(out_shape, out.DataType());
+  }
+};
+
 // TODO(tvm-team) consider combine dead-code with constant folder.
 // or make a more powerful partial evaluator.
 class ConstantFolder : public ExprMutator {
@@ -90,7 +389,7 @@ class ConstantFolder : public ExprMutator {
 
   Expr VisitExpr_(const LetNode* op) final {
     Expr value = this->Mutate(op->value);
-    if (value.as<ConstantNode>()) {
+    if (value.as<ConstantNode>() || pending_.count(value)) {
       memo_[op->var] = value;
       return this->Mutate(op->body);
     } else {
@@ -110,6 +409,7 @@ class ConstantFolder : public ExprMutator {
     std::unordered_set<std::string> skip_list{"zeros_like", "ones_like", "full_like", "full"};
 
     auto origin_args = call->args;
+    Type origin_type = call->checked_type_;
     Expr res = ExprMutator::VisitExpr_(call);
     call = res.as<CallNode>();
     // We don't constant fold function with zero arguments.
@@ -140,12 +440,12 @@ class ConstantFolder : public ExprMutator {
 
     bool all_const_args = true;
     for (Expr arg : call->args) {
-      if (!checker_.Check(arg)) {
+      if (!IsFoldable(arg)) {
         all_const_args = false;
       }
     }
     if (all_const_args) {
-      return ConstEvaluate(res);
+      return Fold(res, origin_type);
     } else {
       return res;
     }
@@ -157,11 +457,80 @@ class ConstantFolder : public ExprMutator {
     if (const auto* tuple = op->tuple.as<TupleNode>()) {
       return tuple->fields[op->index];
     } else {
+      if (pending_.count(op->tuple)) pending_.insert(res);
       return res;
     }
   }
 
+  /*!
+   * \brief Evaluate the deferred subexpressions of expr together.
+   * \param expr The folded expression.
+   * \return expr with the deferred subexpressions replaced by their values.
+   */
+  Expr EvaluatePending(const Expr& expr) {
+    if (pending_.empty()) return expr;
+    // Only the outermost deferred subexpressions need a value.
+    class RootCollector : public ExprVisitor {
+     public:
+      explicit RootCollector(const ExprSet& pending) : pending_(pending) {}
+      void VisitExpr(const Expr& expr) final {
+        if (pending_.count(expr)) {
+          if (visited_.insert(expr).second) roots.push_back(expr);
+        } else {
+          ExprVisitor::VisitExpr(expr);
+        }
+      }
+      Array<Expr> roots;
+
+     private:
+      const ExprSet& pending_;
+      ExprSet visited_;
+    } collector(pending_);
+    collector(expr);
+    if (collector.roots.empty()) return expr;
+
+    class Substituter : public ExprMutator {
+     public:
+      Substituter(const Array<Expr>& roots, const Tuple& values) {
+        for (size_t i = 0; i < roots.size(); ++i) memo_[roots[i]] = values->fields[i];
+      }
+    };
+    auto values = Downcast<Tuple>(ConstEvaluate(Tuple(collector.roots)));
+    return Substituter(collector.roots, values).Mutate(expr);
+  }
+
  private:
+  using ExprSet = std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual>;
+
+  // Whether expr is a constant, or will be one once the deferred
+  // subexpressions are evaluated.
+  bool IsFoldable(const Expr& expr) {
+    if (checker_.Check(expr) || pending_.count(expr)) return true;
+    if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        if (!IsFoldable(field)) return false;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Fold a call whose arguments are all foldable: evaluate it natively when
+  // possible, otherwise defer it to the batched evaluation in EvaluatePending,
+  // which compiles and runs all deferred subexpressions as one module.
+  Expr Fold(const Expr& expr, const Type& type) {
+    if (type.defined()) {
+      runtime::NDArray value = native_.Eval(expr.as<CallNode>(), type);
+      if (value.defined()) return ObjectToExpr(value);
+    }
+    pending_.insert(expr);
+    return expr;
+  }
+
+  // Natively evaluated ops
+  NativeConstEvaluator native_;
+  // The subexpressions deferred to EvaluatePending
+  ExprSet pending_;
   // Internal constant checker
   ConstantChecker checker_;
   // Module
@@ -326,7 +695,8 @@ class ConstantFolder : public ExprMutator {
     auto cast_attrs = make_object<CastAttrs>();
     cast_attrs->dtype = dtype;
     Expr ret = Call(cast_op_, {value}, Attrs(cast_attrs), {});
-    return ConstEvaluate(ret);
+    const auto* constant = value.as<ConstantNode>();
+    return Fold(ret, constant ? TensorType(constant->tensor_type()->shape, dtype) : Type());
   }
 
   Optional<tvm::Array<IndexExpr>> GetConstantShape(const Expr& input) {
@@ -344,7 +714,8 @@ class ConstantFolder : public ExprMutator {
 };
 
 Expr FoldConstant(const Expr& expr, const IRModule& mod) {
-  return ConstantFolder(mod).Mutate(expr);
+  ConstantFolder folder(mod);
+  return folder.EvaluatePending(folder.Mutate(expr));
 }
 
 namespace transform {
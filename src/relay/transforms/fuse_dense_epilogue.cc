@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/fuse_dense_epilogue.cc
+ * \brief Fuse a 2D dense with the bias add and activation that follow it into a
+ *   single nn.contrib_dense_bias_act, so that libraries which apply them in the
+ *   GEMM epilogue, such as cuBLASLt, can be offloaded the whole chain.
+ */
+
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/dataflow_matcher.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/transform.h>
+
+#include <cmath>
+
+#include "../op/make_op.h"
+
+namespace tvm {
+namespace relay {
+
+/*! \brief Whether expr is a float scalar constant close to value. */
+static bool IsFloatScalar(const Expr& expr, double value) {
+  const auto* n = expr.as<ConstantNode>();
+  if (n == nullptr || !n->is_scalar()) return false;
+  DataType dtype = n->data.DataType();
+  double v;
+  if (dtype == DataType::Float(32)) {
+    v = static_cast<float*>(n->data->data)[0];
+  } else if (dtype == DataType::Float(64)) {
+    v = static_cast<double*>(n->data->data)[0];
+  } else {
+    return false;
+  }
+  return std::abs(v - value) < 1e-4;
+}
+
+/*!
+ * \brief DenseEpilogue matches add(dense(x, w), b) with a 1D bias, optionally
+ *   followed by relu or by the erf form of gelu the frontends emit:
+ *   y * (0.5 + erf(y * sqrt(0.5)) * 0.5).
+ */
+class DenseEpilogue {
+ public:
+  explicit DenseEpilogue(const std::string& activation) : activation_(activation) {
+    data_ = WildcardPattern(make_object<WildcardPatternNode>());
+    weight_ = WildcardPattern(make_object<WildcardPatternNode>());
+    bias_ = WildcardPattern(make_object<WildcardPatternNode>());
+    dense_ = CallPattern(ExprPattern(Op::Get("nn.dense")), {data_, weight_}, Attrs{}, {});
+    auto add = ExprPattern(Op::Get("add"));
+    auto multiply = ExprPattern(Op::Get("multiply"));
+    auto y = CallPattern(add, {dense_, bias_}, Attrs{}, {});
+    if (activation == "relu") {
+      pattern_ = CallPattern(ExprPattern(Op::Get("nn.relu")), {y}, Attrs{}, {});
+    } else if (activation == "gelu") {
+      sqrt_half_ = ConstantPattern(make_object<ConstantPatternNode>());
+      half0_ = ConstantPattern(make_object<ConstantPatternNode>());
+      half1_ = ConstantPattern(make_object<ConstantPatternNode>());
+      auto erf = CallPattern(ExprPattern(Op::Get("erf")),
+                             {CallPattern(multiply, {y, sqrt_half_}, Attrs{}, {})}, Attrs{}, {});
+      auto cdf = CallPattern(add, {half0_, CallPattern(multiply, {erf, half1_}, Attrs{}, {})},
+                             Attrs{}, {});
+      pattern_ = CallPattern(multiply, {y, cdf}, Attrs{}, {});
+    } else {
+      pattern_ = y;
+    }
+  }
+
+  Expr callback(const Expr& pre, const Expr& post, const Map<DFPattern, Array<Expr>>& node_map) {
+    const auto* dense = node_map[dense_][0].as<CallNode>();
+    const auto* attrs = dense->attrs.as<DenseAttrs>();
+    const auto* data_type = node_map[data_][0]->checked_type().as<TensorTypeNode>();
+    const auto* bias_type = node_map[bias_][0]->checked_type().as<TensorTypeNode>();
+    const auto* out_type = pre->checked_type().as<TensorTypeNode>();
+    if (data_type == nullptr || bias_type == nullptr || out_type == nullptr) return post;
+    // The epilogue only exists for float16 and float32 GEMMs on 2D data and a bias
+    // that broadcasts along the units.
+    DataType dtype = data_type->dtype;
+    if (!(dtype == DataType::Float(16) || dtype == DataType::Float(32))) return post;
+    if (data_type->shape.size() != 2) return post;
+    if (bias_type->shape.size() != 1 || out_type->dtype != data_type->dtype) return post;
+    const auto* units = bias_type->shape[0].as<IntImmNode>();
+    const auto* out_units = out_type->shape[1].as<IntImmNode>();
+    if (units == nullptr || out_units == nullptr || units->value != out_units->value) return post;
+    if (activation_ == "gelu" &&
+        !(IsFloatScalar(node_map[sqrt_half_][0], std::sqrt(0.5)) &&
+          IsFloatScalar(node_map[half0_][0], 0.5) && IsFloatScalar(node_map[half1_][0], 0.5))) {
+      return post;
+    }
+    return MakeDenseBiasAct(node_map[data_][0], node_map[weight_][0], node_map[bias_][0],
+                            attrs->units, attrs->out_dtype, activation_);
+  }
+
+  DFPattern pattern() const { return pattern_; }
+
+ private:
+  /*! \brief Activation fused after the bias add */
+  std::string activation_;
+  /*! \brief Pattern inputs */
+  DFPattern data_, weight_, bias_;
+  /*! \brief Constants of the gelu pattern */
+  DFPattern sqrt_half_, half0_, half1_;
+  /*! \brief Pattern of the dense */
+  DFPattern dense_;
+  /*! \brief Pattern of the whole chain */
+  DFPattern pattern_;
+};
+
+Expr FuseDenseEpilogue(const Expr& expr, const IRModule& mod) {
+  // Longer chains first, so that their dense + bias prefix is not fused on its own.
+  std::vector<DenseEpilogue> epilogues{DenseEpilogue("gelu"), DenseEpilogue("relu"),
+                                       DenseEpilogue("none")};
+  Array<DFPatternCallback> callbacks;
+  for (auto& epilogue : epilogues) {
+    auto func = [&epilogue](TVMArgs args, TVMRetValue* rv) {
+      Expr pre = args[0];
+      Expr post = args[1];
+      Map<DFPattern, Array<Expr>> node_map = args[2];
+      *rv = epilogue.callback(pre, post, node_map);
+    };
+    callbacks.push_back(DFPatternCallback(epilogue.pattern(), PackedFunc(func), true));
+  }
+  return RewritePatterns(callbacks, expr, mod);
+}
+
+namespace transform {
+
+Pass FuseDenseEpilogue() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(FuseDenseEpilogue(f, m));
+      };
+  return CreateFunctionPass(pass_func, 3, "FuseDenseEpilogue", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.FuseDenseEpilogue").set_body_typed(FuseDenseEpilogue);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -84,6 +84,15 @@ constexpr uint32_t kMaxFusedOps = 256;
 static const Op& stop_fusion_op = Op::Get("annotation.stop_fusion");
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.max_depth", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.cost_model", String);
+
+/*!
+ * \brief Extra reads charged for a non-elementwise injective op (transpose,
+ *  take, strided_slice...) fused into a reduction or a conv-like master.
+ *  Its scattered reads sit in the inner loop of the master, where they defeat
+ *  vectorization; the penalty is a heuristic and not a measured value.
+ */
+constexpr double kStridedAccessPenalty = 3.0;
 
 /*!
  * \brief Indexed data flow graph in forward direction.
@@ -186,6 +195,51 @@ class IndexedForwardGraph::Creator : private ExprVisitor {
     }
   }
 
+  // Visit the dataflow nodes with an explicit stack, in the order of the recursion, as the
+  // recursion overflows the call stack on deep graphs. The VisitExpr_ of a call, tuple or
+  // tuple field access runs before its inputs are visited, the node is added after them.
+  void VisitExpr(const Expr& expr) final {
+    // The nodes, and whether their inputs were pushed.
+    std::vector<std::pair<Expr, bool>> stack;
+    stack.emplace_back(expr, false);
+    while (!stack.empty()) {
+      Expr node = stack.back().first;
+      if (stack.back().second) {
+        stack.pop_back();
+        this->AddNode(node.get());
+        visit_counter_[node.get()] = 1;
+        continue;
+      }
+      auto it = visit_counter_.find(node.get());
+      if (it != visit_counter_.end()) {
+        ++it->second;
+        stack.pop_back();
+        continue;
+      }
+      if (const auto* call = node.as<CallNode>()) {
+        stack.back().second = true;
+        ExprFunctor::VisitExpr(node);
+        for (auto arg = call->args.rbegin(); arg != call->args.rend(); ++arg) {
+          stack.emplace_back(*arg, false);
+        }
+        stack.emplace_back(call->op, false);
+      } else if (const auto* tuple = node.as<TupleNode>()) {
+        stack.back().second = true;
+        ExprFunctor::VisitExpr(node);
+        for (auto field = tuple->fields.rbegin(); field != tuple->fields.rend(); ++field) {
+          stack.emplace_back(*field, false);
+        }
+      } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+        stack.back().second = true;
+        ExprFunctor::VisitExpr(node);
+        stack.emplace_back(tuple_get->tuple, false);
+      } else {
+        stack.pop_back();
+        ExprVisitor::VisitExpr(node);
+      }
+    }
+  }
+
   void AddNode(const tvm::Object* key) {
     auto it = graph_.node_map.find(key);
     CHECK(it != graph_.node_map.end()) << "Cannot find node " << GetRef<ObjectRef>(key);
@@ -265,8 +319,6 @@ class IndexedForwardGraph::Creator : private ExprVisitor {
       }
       this->Update(call->args[i], node, edge_pattern);
     }
-    ExprVisitor::VisitExpr_(call);
-    this->AddNode(call);
   }
 
   void VisitExpr_(const TupleNode* op) final {
@@ -280,8 +332,6 @@ class IndexedForwardGraph::Creator : private ExprVisitor {
         this->Update(field, nullptr, kOpaque);
       }
     }
-    ExprVisitor::VisitExpr_(op);
-    this->AddNode(op);
   }
 
   void VisitExpr_(const TupleGetItemNode* op) final {
@@ -290,8 +340,8 @@ class IndexedForwardGraph::Creator : private ExprVisitor {
     // When TVM lowers a fused function, it expects all arguments to be a Tensor or
     // a tuple containing only Tensors. But this tuple may contain a reference or
     // another tuple. To avoid modifying codegen logic, we do not allow fusing through this node
-    // if the tuple contains such non Tensor fields. However, all fields will be recursively
-    // visited via call to ExprVisitor::VisitExpr_(op) below and corresponding visitor methods.
+    // if the tuple contains such non Tensor fields. However, all fields will be visited
+    // afterwards by VisitExpr and the corresponding visitor methods.
     bool has_non_tensor = false;
     for (auto ty : tuple_type->fields) {
       if (!ty.as<TensorTypeNode>()) {
@@ -307,8 +357,6 @@ class IndexedForwardGraph::Creator : private ExprVisitor {
       node->pattern = kInjective;
       this->Update(op->tuple, node, kInjective);
     }
-    ExprVisitor::VisitExpr_(op);
-    this->AddNode(op);
   }
 
   void VisitExpr_(const VarNode* op) final { this->AddNode(op); }
@@ -498,8 +546,21 @@ DominatorTree DominatorTree::PostDom(support::Arena* arena, const IndexedForward
  */
 class GraphPartitioner {
  public:
-  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth)
-      : arena_(arena), opt_level_(opt_level), max_fuse_depth_(max_fuse_depth) {}
+  /*!
+   * \brief The constructor.
+   * \param arena The arena used for data allocation.
+   * \param opt_level The optimization level of fusion.
+   * \param max_fuse_depth The maximum number of operations in one fused function.
+   * \param cost_model Estimates the cost of a group from its expressions in
+   *  topological order. When set, a fusion allowed by the pattern rules is only
+   *  done if the merged group costs no more than the groups it replaces.
+   */
+  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth,
+                            const runtime::PackedFunc* cost_model = nullptr)
+      : arena_(arena),
+        opt_level_(opt_level),
+        max_fuse_depth_(max_fuse_depth),
+        cost_model_(cost_model) {}
   /*!
    * \brief Group as a union find data structure.
    */
@@ -553,8 +614,16 @@ class GraphPartitioner {
   int opt_level_;
   /*! \brief The maximum number of operations in one fused function */
   size_t max_fuse_depth_;
+  /*! \brief The cost model of fused groups, nullptr when fusing by rules only. */
+  const runtime::PackedFunc* cost_model_;
+  /*! \brief The graph being partitioned. */
+  const IndexedForwardGraph* graph_{nullptr};
   /*! \brief The internal groups. */
   std::vector<Group*> groups_;
+  /*! \brief The node indices of each root group, only kept with a cost model. */
+  std::unordered_map<const Group*, std::vector<size_t>> members_;
+  /*! \brief The estimated cost of each root group, only kept with a cost model. */
+  std::unordered_map<const Group*, double> cost_cache_;
   /*! \brief internal field used for deduplication */
   std::unordered_set<IndexedForwardGraph::Node*> visited_;
   // Internal implelementation of CheckPath
@@ -614,6 +683,14 @@ class GraphPartitioner {
     // update the number of nodes of the parent group
     parent->num_nodes += child->num_nodes;
     child->parent = parent;
+    if (cost_model_ != nullptr) {
+      auto& members = members_[parent];
+      auto& child_members = members_[child];
+      members.insert(members.end(), child_members.begin(), child_members.end());
+      members_.erase(child);
+      cost_cache_.erase(child);
+      cost_cache_.erase(parent);
+    }
     // update master ref and pattern
     if (child->master_ref != nullptr) {
       CHECK(parent->master_ref == nullptr);
@@ -647,6 +724,66 @@ class GraphPartitioner {
     CommitFuse_(src, sink, target);
   }
 
+  // Collect the root groups of the nodes that CommitFuse would merge.
+  void CollectGroups_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
+                      std::vector<Group*>* groups) {
+    if (src == sink || visited_.count(src)) return;
+    visited_.insert(src);
+    Group* root = groups_[src->index]->FindRoot();
+    if (std::find(groups->begin(), groups->end(), root) == groups->end()) {
+      groups->push_back(root);
+    }
+    for (auto link = src->outputs.head; link != nullptr; link = link->next) {
+      CollectGroups_(link->value.node, sink, groups);
+    }
+  }
+
+  // The expressions of the nodes, in topological order.
+  Array<Expr> GroupExprs(std::vector<size_t> indices) const {
+    std::sort(indices.begin(), indices.end());
+    Array<Expr> exprs;
+    for (size_t index : indices) {
+      const auto* node = static_cast<const ExprNode*>(graph_->post_dfs_order[index]->ref);
+      exprs.push_back(GetRef<Expr>(node));
+    }
+    return exprs;
+  }
+
+  double GroupCost(Group* root) {
+    auto it = cost_cache_.find(root);
+    if (it != cost_cache_.end()) return it->second;
+    double cost = (*cost_model_)(GroupExprs(members_[root]));
+    cost_cache_[root] = cost;
+    return cost;
+  }
+
+  /*!
+   * \brief Check whether fusing src into sink lowers the estimated cost.
+   * \param src The source node.
+   * \param sink The termination node.
+   * \return Whether to commit the fusion, always true without a cost model.
+   * \note sink must be a post-dominator of src.
+   */
+  bool FusionProfitable(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
+    if (cost_model_ == nullptr) return true;
+    std::vector<Group*> groups;
+    visited_.clear();
+    CollectGroups_(src, sink, &groups);
+    Group* sink_root = groups_[sink->index]->FindRoot();
+    if (std::find(groups.begin(), groups.end(), sink_root) == groups.end()) {
+      groups.push_back(sink_root);
+    }
+    double separate_cost = 0;
+    std::vector<size_t> merged;
+    for (Group* root : groups) {
+      separate_cost += GroupCost(root);
+      const auto& members = members_[root];
+      merged.insert(merged.end(), members.begin(), members.end());
+    }
+    double merged_cost = (*cost_model_)(GroupExprs(merged));
+    return merged_cost <= separate_cost;
+  }
+
   size_t CountNodesUptoSink_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
     if (src == sink || visited_.count(src)) return 0;
     visited_.insert(src);
@@ -686,6 +823,7 @@ class GraphPartitioner {
         group_node->master_ref = graph_node->ref;
       }
       groups_[nid] = group_node;
+      if (cost_model_ != nullptr) members_[group_node] = {nid};
     }
   }
 
@@ -743,7 +881,8 @@ class GraphPartitioner {
           CHECK(dom_node->parent->gnode != nullptr);
           // The fuse can be executed if all the intermediate ops are still broadcast.
           auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              FusionProfitable(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -763,7 +902,8 @@ class GraphPartitioner {
                       kind == kOutEWiseFusable);
             }
           };
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              FusionProfitable(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -773,7 +913,8 @@ class GraphPartitioner {
         if (phase != 1) continue;
         // Check if all path are injective.
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+            FusionProfitable(graph_node, dom_node->parent->gnode)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       } else {
@@ -786,6 +927,7 @@ class GraphPartitioner {
 
 std::vector<GraphPartitioner::Group*> GraphPartitioner::Partition(
     const IndexedForwardGraph& graph) {
+  graph_ = &graph;
   this->InitGroups(graph);
   if (opt_level_ == 0) return std::move(groups_);
   // get post dominator tree
@@ -800,10 +942,12 @@ std::vector<GraphPartitioner::Group*> GraphPartitioner::Partition(
 class FuseMutator : private ExprMutator {
  public:
   // Run the transform
-  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth) {
+  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth,
+                 const runtime::PackedFunc* cost_model = nullptr) {
     // setup the group map.
     auto graph = IndexedForwardGraph::Create(&arena_, body);
-    auto groups = GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth).Partition(graph);
+    auto groups =
+        GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth, cost_model).Partition(graph);
     for (size_t nid = 0; nid < graph.post_dfs_order.size(); ++nid) {
       CHECK(graph.post_dfs_order[nid]->ref != nullptr);
       gmap_[graph.post_dfs_order[nid]->ref] = groups[nid];
@@ -843,6 +987,75 @@ class FuseMutator : private ExprMutator {
   /* \brief Internal group information map. */
   std::unordered_map<GraphPartitioner::Group*, GroupInfo> ginfo_;
 
+  /*! \brief A dataflow node being mutated, with the inputs its VisitExpr_ mutates. */
+  struct Frame {
+    Expr node;
+    Array<Expr> inputs;
+    size_t next;
+    // The group whose parameters are allocated for the inputs, when the node allocates them.
+    GraphPartitioner::Group* group;
+  };
+
+  Frame MakeFrame(const Expr& node) {
+    Frame frame{node, {}, 0, nullptr};
+    if (const auto* call = node.as<CallNode>()) {
+      static auto fnoncomputational = Op::GetAttrMap<TNonComputational>("TNonComputational");
+      if (!call->op.as<OpNode>() || fnoncomputational.get(Downcast<Op>(call->op), false)) {
+        frame.inputs.push_back(call->op);
+        for (const auto& arg : call->args) frame.inputs.push_back(arg);
+      } else if (call->op == stop_fusion_op) {
+        frame.inputs.push_back(call->args[0]);
+      } else {
+        frame.inputs = call->args;
+        frame.group = gmap_.at(call)->FindRoot();
+      }
+    } else if (const auto* tuple = node.as<TupleNode>()) {
+      frame.inputs = tuple->fields;
+      auto* group = gmap_.at(tuple)->FindRoot();
+      if (group->root_ref != tuple) frame.group = group;
+    } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+      frame.inputs.push_back(tuple_get->tuple);
+      frame.group = gmap_.at(tuple_get)->FindRoot();
+    }
+    return frame;
+  }
+
+  // Mutate the dataflow nodes with an explicit stack, as the recursion overflows the call stack
+  // on deep graphs. The inputs of a node are mutated in the order of the recursion, and the
+  // parameters of its group allocated right after each of them, so the fused functions are the
+  // same. The VisitExpr_ of the node then finds its inputs memoized.
+  Expr VisitExpr(const Expr& expr) final {
+    auto it = memo_.find(expr);
+    if (it != memo_.end()) return it->second;
+    if (!IsDataflowNode(expr)) return ExprMutator::VisitExpr(expr);
+    std::vector<Frame> stack;
+    stack.push_back(MakeFrame(expr));
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      if (frame.next == 0 && memo_.count(frame.node)) {
+        stack.pop_back();
+      } else if (frame.next < frame.inputs.size()) {
+        Expr input = frame.inputs[frame.next];
+        if (!memo_.count(input) && IsDataflowNode(input)) {
+          stack.push_back(MakeFrame(input));
+          continue;
+        }
+        ExprMutator::VisitExpr(input);
+        if (frame.group != nullptr) GetNewArguments({input}, frame.group);
+        ++frame.next;
+      } else {
+        Expr node = frame.node;
+        stack.pop_back();
+        ExprMutator::VisitExpr(node);
+      }
+    }
+    return memo_.at(expr);
+  }
+
+  static bool IsDataflowNode(const Expr& expr) {
+    return expr.as<CallNode>() || expr.as<TupleNode>() || expr.as<TupleGetItemNode>();
+  }
+
   // Skip primitive function.
   Expr VisitExpr_(const FunctionNode* fn_node) {
     if (fn_node->HasNonzeroAttr(attr::kPrimitive)) {
@@ -957,6 +1170,79 @@ class FuseMutator : private ExprMutator {
   }
 };
 
+// Number of bytes of a value of the type, dynamic dimensions count as 1.
+static double TypeBytes(const Type& type) {
+  if (!type.defined()) return 0;
+  if (const auto* tensor_type = type.as<TensorTypeNode>()) {
+    double bytes = tensor_type->dtype.bytes() * tensor_type->dtype.lanes();
+    for (const PrimExpr& dim : tensor_type->shape) {
+      if (const auto* value = dim.as<IntImmNode>()) bytes *= value->value;
+    }
+    return bytes;
+  }
+  double bytes = 0;
+  if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+    for (const Type& field : tuple_type->fields) bytes += TypeBytes(field);
+  }
+  return bytes;
+}
+
+/*!
+ * \brief Analytic fusion cost model, the bytes a fused group moves through memory.
+ *
+ *  A group reads every tensor it takes from outside and writes the tensors
+ *  no member consumes. Non-elementwise injective ops fused under a reduction
+ *  or conv-like master are charged kStridedAccessPenalty extra reads of
+ *  their inputs.
+ *
+ * \param group The expressions of the group in topological order.
+ * \return The estimated cost of the group.
+ */
+double MemoryTrafficCost(const Array<Expr>& group) {
+  static const auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+  static const std::unordered_set<std::string> reshape_ops{
+      "reshape", "reshape_like", "contrib_reverse_reshape", "squeeze", "expand_dims",
+      "nn.batch_flatten"};
+  std::unordered_set<const Object*> members, inputs, used;
+  for (const Expr& expr : group) members.insert(expr.get());
+  double bytes = 0;
+  auto read = [&](const Expr& arg) {
+    used.insert(arg.get());
+    if (!members.count(arg.get()) && !arg.as<OpNode>() && inputs.insert(arg.get()).second) {
+      bytes += TypeBytes(arg->checked_type_);
+    }
+  };
+  bool has_master = false;
+  std::vector<const CallNode*> strided_ops;
+  for (const Expr& expr : group) {
+    if (const auto* call = expr.as<CallNode>()) {
+      for (const Expr& arg : call->args) read(arg);
+      const auto* op = call->op.as<OpNode>();
+      if (op == nullptr) continue;
+      OpPatternKind pattern = static_cast<OpPatternKind>(fpattern.get(GetRef<Op>(op), kOpaque));
+      if (pattern == kCommReduce || pattern == kOutEWiseFusable) has_master = true;
+      if (pattern == kInjective && !reshape_ops.count(op->name)) strided_ops.push_back(call);
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) read(field);
+    } else if (const auto* get_item = expr.as<TupleGetItemNode>()) {
+      read(get_item->tuple);
+    }
+  }
+  for (const Expr& expr : group) {
+    if (!used.count(expr.get())) bytes += TypeBytes(expr->checked_type_);
+  }
+  if (has_master) {
+    for (const CallNode* call : strided_ops) {
+      for (const Expr& arg : call->args) {
+        bytes += kStridedAccessPenalty * TypeBytes(arg->checked_type_);
+      }
+    }
+  }
+  return bytes;
+}
+
+TVM_REGISTER_GLOBAL("relay.analysis.FuseMemoryTrafficCost").set_body_typed(MemoryTrafficCost);
+
 Expr FuseOps(const Expr& expr, int fuse_opt_level, size_t max_fuse_depth, const IRModule& module) {
   return FuseMutator().Transform(expr, fuse_opt_level, max_fuse_depth);
 }
@@ -968,7 +1254,16 @@ Pass FuseOps(int fuse_opt_level) {
       [=](Function f, IRModule m, PassContext pc) {
         int opt_level = fuse_opt_level == -1 ? pc->opt_level : fuse_opt_level;
         auto max_fuse_depth = pc->GetConfig("relay.FuseOps.max_depth", Integer(kMaxFusedOps));
-        return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m));
+        std::string cost_model_name = pc->GetConfig<String>("relay.FuseOps.cost_model", "").value();
+        if (cost_model_name.empty()) {
+          return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m));
+        }
+        if (cost_model_name == "memory") cost_model_name = "relay.analysis.FuseMemoryTrafficCost";
+        const runtime::PackedFunc* cost_model = runtime::Registry::Get(cost_model_name);
+        CHECK(cost_model != nullptr) << "relay.FuseOps.cost_model: " << cost_model_name
+                                     << " is neither \"memory\" nor a registered function";
+        return Downcast<Function>(
+            FuseMutator().Transform(f, opt_level, max_fuse_depth.value(), cost_model));
       };
   return CreateFunctionPass(pass_func, 1, "FuseOps", {"InferType"});
 }
@@ -0,0 +1,298 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/fuse_optimizer_updates.cc
+ * \brief Fuse the per parameter SGD and Adam updates of a training step into
+ *   nn.multi_sgd_update and nn.multi_adam_update.
+ *
+ * A training step written in Relay updates every parameter with its own
+ * elementwise ops, so it launches at least a kernel per parameter. The
+ * multi-tensor ops update all the parameters sharing a learning rate in one
+ * kernel, which reads and writes every tensor once.
+ */
+
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../op/make_op.h"
+#include "pattern_util.h"
+
+namespace tvm {
+namespace relay {
+namespace fuse_optimizer {
+
+/*! \brief The update of one parameter. */
+struct Update {
+  /*! \brief The updated tensors, w' for SGD and w', m', v' for Adam. */
+  std::vector<Expr> outputs;
+  /*! \brief The inputs of the parameter, w, g for SGD and w, g, m, v for Adam. */
+  std::vector<Expr> inputs;
+  Expr lr;
+  bool adam{false};
+  double beta1{0};
+  double beta2{0};
+  double epsilon{0};
+};
+
+/*! \brief The call of op, or nullptr. */
+const CallNode* AsCall(const Expr& expr, const Op& op) {
+  const auto* call = expr.as<CallNode>();
+  return call != nullptr && call->op.same_as(op) ? call : nullptr;
+}
+
+bool IsRank0(const Expr& expr) {
+  const auto* type = expr->checked_type().as<TensorTypeNode>();
+  return type != nullptr && type->shape.empty();
+}
+
+bool SameType(const Expr& a, const Expr& b) {
+  return StructuralEqual()(a->checked_type(), b->checked_type());
+}
+
+/*! \brief Get the value of a float32 or float64 scalar constant. */
+bool GetFloatScalar(const Expr& expr, double* value) {
+  const auto* n = expr.as<ConstantNode>();
+  if (n == nullptr || !n->is_scalar()) return false;
+  DataType dtype = n->data.DataType();
+  if (dtype != DataType::Float(32) && dtype != DataType::Float(64)) return false;
+  *value = static_cast<double>(ToScalar(n->data));
+  return true;
+}
+
+/*! \brief Match multiply(scale, x) or multiply(x, scale) with a scalar scale. */
+bool MatchScaled(const Expr& expr, Expr* scale, Expr* x) {
+  static const Op& multiply = Op::Get("multiply");
+  const CallNode* call = AsCall(expr, multiply);
+  if (call == nullptr) return false;
+  if (IsRank0(call->args[0])) {
+    *scale = call->args[0];
+    *x = call->args[1];
+  } else if (IsRank0(call->args[1])) {
+    *scale = call->args[1];
+    *x = call->args[0];
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/*! \brief Match the moving average beta * avg + (1 - beta) * x, beta being a constant. */
+bool MatchMovingAverage(const Expr& expr, double* beta, Expr* avg, Expr* x) {
+  static const Op& add = Op::Get("add");
+  const CallNode* call = AsCall(expr, add);
+  if (call == nullptr) return false;
+  Expr decay, rest;
+  double one_minus_beta;
+  if (!MatchScaled(call->args[0], &decay, avg) || !MatchScaled(call->args[1], &rest, x)) {
+    return false;
+  }
+  if (!GetFloatScalar(decay, beta) || !GetFloatScalar(rest, &one_minus_beta)) return false;
+  return std::abs(*beta + one_minus_beta - 1) < 1e-6;
+}
+
+/*!
+ * \brief Match the update of a parameter rooted at expr, the parameter and its
+ *   moments being variables:
+ *   SGD:  w - lr * g
+ *   Adam: w - lr * m' / (sqrt(v') + epsilon), with
+ *         m' = beta1 * m + (1 - beta1) * g and v' = beta2 * v + (1 - beta2) * g * g
+ */
+bool MatchUpdate(const Expr& expr, Update* update) {
+  static const Op& subtract = Op::Get("subtract");
+  static const Op& multiply = Op::Get("multiply");
+  static const Op& divide = Op::Get("divide");
+  static const Op& add = Op::Get("add");
+  static const Op& sqrt = Op::Get("sqrt");
+  const CallNode* sub = AsCall(expr, subtract);
+  if (sub == nullptr || sub->args[0].as<VarNode>() == nullptr) return false;
+  Expr w = sub->args[0];
+  Expr step;
+  if (!MatchScaled(sub->args[1], &update->lr, &step) || !SameType(w, expr)) return false;
+
+  const CallNode* div = AsCall(step, divide);
+  const CallNode* denom = div != nullptr ? AsCall(div->args[1], add) : nullptr;
+  const CallNode* root = denom != nullptr ? AsCall(denom->args[0], sqrt) : nullptr;
+  Expr m, v, g, g_sq;
+  if (root != nullptr && GetFloatScalar(denom->args[1], &update->epsilon) &&
+      MatchMovingAverage(div->args[0], &update->beta1, &m, &g) &&
+      MatchMovingAverage(root->args[0], &update->beta2, &v, &g_sq)) {
+    const CallNode* sq = AsCall(g_sq, multiply);
+    if (sq != nullptr && sq->args[0].same_as(g) && sq->args[1].same_as(g) &&
+        m.as<VarNode>() != nullptr && v.as<VarNode>() != nullptr && SameType(g, w) &&
+        SameType(m, w) && SameType(v, w)) {
+      update->adam = true;
+      update->outputs = {expr, div->args[0], root->args[0]};
+      update->inputs = {w, g, m, v};
+      return true;
+    }
+  }
+  if (!SameType(step, w)) return false;
+  update->outputs = {expr};
+  update->inputs = {w, step};
+  return true;
+}
+
+/*! \brief Whether two updates can be computed by the same multi-tensor call. */
+bool SameOptimizer(const Update& a, const Update& b) {
+  return a.adam == b.adam && (a.lr.same_as(b.lr) || IsEqualScalar(a.lr, b.lr)) &&
+         a.beta1 == b.beta1 && a.beta2 == b.beta2 && a.epsilon == b.epsilon;
+}
+
+class OptimizerUpdateFuser : public ExprMutator {
+ public:
+  Expr Fuse(const Expr& body) {
+    bool graph_form = true;
+    std::unordered_map<const Object*, size_t> output_update;
+    PostOrderVisit(body, [&](const Expr& expr) {
+      if (expr.as<LetNode>() != nullptr || expr.as<FunctionNode>() != nullptr) {
+        graph_form = false;
+      }
+      Update update;
+      if (expr.as<CallNode>() != nullptr && MatchUpdate(expr, &update)) {
+        for (const auto& output : update.outputs) output_update[output.get()] = updates_.size();
+        updates_.push_back(std::move(update));
+      }
+    });
+    if (!graph_form) {
+      DLOG(INFO) << "FuseOptimizerUpdates expects the graph normal form";
+      return body;
+    }
+
+    // An update can only join a fused call if its inputs do not depend on the
+    // outputs of an update, or the fused call could depend on itself.
+    std::unordered_map<const Object*, bool> depends;
+    auto depends_on_update = [&](const Expr& expr) {
+      return output_update.count(expr.get()) != 0 || depends[expr.get()];
+    };
+    PostOrderVisit(body, [&](const Expr& expr) {
+      bool d = false;
+      if (const auto* call = expr.as<CallNode>()) {
+        for (const auto& arg : call->args) d = d || depends_on_update(arg);
+      } else if (const auto* tuple = expr.as<TupleNode>()) {
+        for (const auto& field : tuple->fields) d = d || depends_on_update(field);
+      } else if (const auto* get = expr.as<TupleGetItemNode>()) {
+        d = depends_on_update(get->tuple);
+      } else if (const auto* branch = expr.as<IfNode>()) {
+        d = depends_on_update(branch->cond) || depends_on_update(branch->true_branch) ||
+            depends_on_update(branch->false_branch);
+      }
+      depends[expr.get()] = d;
+    });
+
+    for (size_t i = 0; i < updates_.size(); ++i) {
+      const Update& update = updates_[i];
+      bool independent = !depends_on_update(update.lr);
+      for (const auto& input : update.inputs) {
+        independent = independent && !depends_on_update(input);
+      }
+      if (!independent) continue;
+      auto it = std::find_if(groups_.begin(), groups_.end(), [&](const std::vector<size_t>& g) {
+        return SameOptimizer(updates_[g[0]], update);
+      });
+      if (it == groups_.end()) {
+        groups_.push_back({i});
+      } else {
+        it->push_back(i);
+      }
+    }
+    for (size_t g = 0; g < groups_.size(); ++g) {
+      // A single update is already one kernel after FuseOps.
+      if (groups_[g].size() < 2) continue;
+      int num_params = groups_[g].size();
+      for (int k = 0; k < num_params; ++k) {
+        const auto& outputs = updates_[groups_[g][k]].outputs;
+        for (size_t o = 0; o < outputs.size(); ++o) {
+          replace_[outputs[o].get()] = {g, o * num_params + k};
+        }
+      }
+    }
+    if (replace_.empty()) return body;
+    fused_.resize(groups_.size());
+    return VisitExpr(body);
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    auto it = replace_.find(call);
+    if (it == replace_.end()) return ExprMutator::VisitExpr_(call);
+    return TupleGetItem(FusedCall(it->second.first), it->second.second);
+  }
+
+ private:
+  Expr FusedCall(size_t g) {
+    if (fused_[g].defined()) return fused_[g];
+    const Update& first = updates_[groups_[g][0]];
+    std::vector<Array<Expr>> inputs(first.inputs.size());
+    for (size_t i : groups_[g]) {
+      for (size_t j = 0; j < inputs.size(); ++j) {
+        inputs[j].push_back(VisitExpr(updates_[i].inputs[j]));
+      }
+    }
+    Expr lr = VisitExpr(first.lr);
+    if (first.adam) {
+      fused_[g] = MakeMultiAdamUpdate(Tuple(inputs[0]), Tuple(inputs[1]), Tuple(inputs[2]),
+                                      Tuple(inputs[3]), lr, first.beta1, first.beta2,
+                                      first.epsilon);
+    } else {
+      fused_[g] = MakeMultiSGDUpdate(Tuple(inputs[0]), Tuple(inputs[1]), lr);
+    }
+    return fused_[g];
+  }
+
+  std::vector<Update> updates_;
+  /*! \brief The updates fused together, as indices into updates_. */
+  std::vector<std::vector<size_t>> groups_;
+  /*! \brief The fused call of every group, created on first use. */
+  std::vector<Expr> fused_;
+  /*! \brief The outputs replaced by a field of a fused call, with its group and index. */
+  std::unordered_map<const Object*, std::pair<size_t, int>> replace_;
+};
+
+Expr FuseOptimizerUpdates(const Function& func) {
+  Expr body = OptimizerUpdateFuser().Fuse(func->body);
+  if (body.same_as(func->body)) return func;
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs, func->span);
+}
+
+}  // namespace fuse_optimizer
+
+namespace transform {
+
+Pass FuseOptimizerUpdates() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(fuse_optimizer::FuseOptimizerUpdates(f));
+      };
+  auto fused = CreateFunctionPass(pass_func, 1, "FuseOptimizerUpdates", {"InferType"});
+  return Sequential({fused, InferType()});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.FuseOptimizerUpdates").set_body_typed(FuseOptimizerUpdates);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -85,7 +85,8 @@
  * We then can reify the result.
  *
  * 3: Every time a function is called, its code will get expanded and partially evaluated.
- * We can do a binding time analysis to cache the result and avoid re-partial evaluation.
+ * Only calls of closed, monomorphic global functions are memoized, by their static arguments.
+ * A binding time analysis could cache the result for every function.
  *
  * These assumptions do not affect the correctness of the algorithm, however.
  */
@@ -97,11 +98,21 @@
 #include <tvm/relay/pattern_functor.h>
 #include <tvm/relay/transform.h>
 
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include "let_list.h"
 #include "pass_util.h"
 
 namespace tvm {
 namespace relay {
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.PartialEval.memoize", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.PartialEval.max_specializations", Integer);
+
 namespace partial_eval {
 
 using namespace runtime;
@@ -591,7 +602,11 @@ Function AsFunc(const Expr& e) {
 class PartialEvaluator : public ExprFunctor<PStatic(const Expr& e, LetList* ll)>,
                          public PatternFunctor<MatchStatus(const Pattern&, const PStatic&)> {
  public:
-  PartialEvaluator(const IRModule& mod) : mod_(mod) {}
+  PartialEvaluator(const IRModule& mod) : mod_(mod) {
+    transform::PassContext pc = transform::PassContext::Current();
+    memoize_ = pc->GetConfig("relay.PartialEval.memoize", Bool(true)).value();
+    budget_ = pc->GetConfig("relay.PartialEval.max_specializations", Integer(0)).value()->value;
+  }
 
   PStatic VisitExpr(const Expr& e, LetList* ll) final {
     PStatic ret = ExprFunctor<PStatic(const Expr&, LetList*)>::VisitExpr(e, ll);
@@ -799,7 +814,21 @@ class PartialEvaluator : public ExprFunctor<PStatic(const Expr& e, LetList* ll)>
           args_fuel.push_back(GetFuel(v));
         }
         auto meet_res = fuel_map_[fid]->Meet(MkFSeq(args_fuel));
-        if (std::get<1>(meet_res)) {
+        std::string key;
+        if (std::get<1>(meet_res) && memoize_ && SpecializationKey(fid, var, func, pv, &key)) {
+          // The first call is expanded in place, the following ones share a specialization.
+          if (specialized_.count(key) == 0 && !seen_.insert(key).second && TakeBudget()) {
+            FuelFrame tf(this, fid, std::get<0>(meet_res));
+            Specialize(func, Downcast<GlobalVar>(var), pv, key);
+          }
+          if (specialized_.count(key) != 0) {
+            PStatic ret = CallSpecialized(specialized_.at(key), pv, ll);
+            if (ret.defined()) {
+              return ret;
+            }
+          }
+        }
+        if (std::get<1>(meet_res) && TakeBudget()) {
           FuelFrame tf(this, fid, std::get<0>(meet_res));
           Expr dedup_func = RegisterFuncId(DeDup(AnnotateFuncId(func)));
           Function func = AsFunc(dedup_func);
@@ -831,6 +860,150 @@ class PartialEvaluator : public ExprFunctor<PStatic(const Expr& e, LetList* ll)>
     };
   }
 
+  /*! \brief Count a function body specialization against the budget, false if it is spent. */
+  bool TakeBudget() {
+    if (budget_ == 0) {
+      return true;
+    }
+    if (specializations_ >= budget_) {
+      return false;
+    }
+    ++specializations_;
+    return true;
+  }
+
+  /*!
+   * \brief Write the static value ps to os.
+   * \return Whether ps is a tensor or a tuple of tensors known at compile time.
+   */
+  static bool StaticKey(const PStatic& ps, std::ostringstream* os) {
+    if (!ps->pstatic.defined()) {
+      return false;
+    } else if (const STensorNode* st = ps->pstatic.as<STensorNode>()) {
+      NDArray cpu_array = st->data.CopyTo(CPUContext());
+      *os << 't' << DataType(cpu_array->dtype);
+      for (int64_t dim : cpu_array.Shape()) {
+        *os << ',' << dim;
+      }
+      *os << ':';
+      os->write(static_cast<const char*>(cpu_array->data), GetDataSize(*cpu_array.operator->()));
+      return true;
+    } else if (const STupleNode* stuple = ps->pstatic.as<STupleNode>()) {
+      *os << '(';
+      for (const PStatic& field : stuple->fields) {
+        if (!StaticKey(field, os)) {
+          return false;
+        }
+      }
+      *os << ')';
+      return true;
+    }
+    return false;
+  }
+
+  /*!
+   * \brief Compute the memoization key of a call from the function id and the static arguments.
+   * \return Whether the call can be memoized: the callee is a closed, monomorphic global
+   *  function, and every argument is dynamic or a static tensor or tuple of tensors.
+   */
+  bool SpecializationKey(FuncId fid, const Expr& var, const Function& func,
+                         const std::vector<PStatic>& pv, std::string* key) const {
+    if (!var.as<GlobalVarNode>() || !func->type_params.empty()) {
+      return false;
+    }
+    std::ostringstream os;
+    os << fid;
+    for (const PStatic& ps : pv) {
+      os << ';';
+      if (!ps->pstatic.defined()) {
+        os << 'd';
+      } else if (!StaticKey(ps, &os)) {
+        return false;
+      }
+    }
+    *key = os.str();
+    return true;
+  }
+
+  /*! \brief A global function specialized for some static arguments. */
+  struct Specialization {
+    GlobalVar gv;
+    /*! \brief Whether each argument is passed to gv, the static ones are folded into it. */
+    std::vector<bool> dynamic;
+  };
+
+  /*!
+   * \brief Residualize a global function, specialized for the static arguments in pv,
+   *  as a new global function and memoize it under key.
+   */
+  void Specialize(const Function& func, const GlobalVar& var, const std::vector<PStatic>& pv,
+                  const std::string& key) {
+    Specialization spec{var, {}};
+    bool has_static = false;
+    for (const PStatic& ps : pv) {
+      spec.dynamic.push_back(!ps->pstatic.defined());
+      has_static |= ps->pstatic.defined();
+    }
+    if (!has_static) {
+      // Without static arguments the specialization is the function itself.
+      specialized_.insert({key, spec});
+      return;
+    }
+    std::string name = var->name_hint + "_specialized";
+    for (size_t i = specialized_.size(); mod_->ContainGlobalVar(name); ++i) {
+      name = var->name_hint + "_specialized" + std::to_string(i);
+    }
+    spec.gv = GlobalVar(name);
+    specialized_.insert({key, spec});
+    in_progress_.push_back(spec.gv);
+
+    Function f = AsFunc(RegisterFuncId(DeDup(AnnotateFuncId(func))));
+    Array<Var> params;
+    for (size_t i = 0; i < pv.size(); ++i) {
+      if (spec.dynamic[i]) {
+        params.push_back(f->params[i]);
+      }
+    }
+    Expr body = store_.Extend<Expr>([&]() {
+      store_.Invalidate();
+      return env_.Extend<Expr>([&]() {
+        return LetList::With([&](LetList* ll) {
+          for (size_t i = 0; i < pv.size(); ++i) {
+            // The dynamic part of a static argument lives in the caller, rebuild it here.
+            env_.Insert(f->params[i], spec.dynamic[i]
+                                          ? NoStatic(f->params[i])
+                                          : HasStatic(pv[i]->pstatic, ll->Push(Reflect(pv[i]))));
+          }
+          return VisitExpr(RegisterFuncId(AnnotateFuncId(f->body)), ll)->dynamic;
+        });
+      });
+    });
+    in_progress_.pop_back();
+    mod_->Add(spec.gv, AsFunc(PostProcess(Function(params, body, func->ret_type, {}))));
+  }
+
+  /*!
+   * \brief Call a memoized specialization.
+   * \return The result, undefined when the specialization is still being built by an outer
+   *  call, as it cannot be type checked yet.
+   */
+  PStatic CallSpecialized(const Specialization& spec, const std::vector<PStatic>& pv,
+                          LetList* ll) {
+    auto it = std::find_if(in_progress_.begin(), in_progress_.end(),
+                           [&](const GlobalVar& gv) { return gv.same_as(spec.gv); });
+    if (it != in_progress_.end() && !it->same_as(in_progress_.back())) {
+      return PStatic();
+    }
+    tvm::Array<Expr> args;
+    for (size_t i = 0; i < pv.size(); ++i) {
+      if (spec.dynamic[i]) {
+        args.push_back(pv[i]->dynamic);
+      }
+    }
+    store_.Invalidate();
+    return NoStatic(ll->Push(Call(spec.gv, args)));
+  }
+
   Expr VisitFuncDynamic(const Function& func, const Func& f, const Expr& self) {
     return store_.Extend<Expr>([&]() {
       store_.Invalidate();
@@ -1135,6 +1308,16 @@ class PartialEvaluator : public ExprFunctor<PStatic(const Expr& e, LetList* ll)>
    */
   std::unordered_map<Function, FuncId, ObjectPtrHash, ObjectPtrEqual> func_map_;
   std::unordered_map<FuncId, Fuel> fuel_map_;
+  /*! \brief Whether the calls of global functions are memoized by their static arguments. */
+  bool memoize_;
+  /*! \brief The keys of the calls seen once, they get a specialization when seen again. */
+  std::unordered_set<std::string> seen_;
+  std::unordered_map<std::string, Specialization> specialized_;
+  /*! \brief The specializations whose body is being partially evaluated. */
+  std::vector<GlobalVar> in_progress_;
+  /*! \brief The maximum number of function bodies to specialize, 0 for no limit. */
+  int64_t budget_;
+  int64_t specializations_ = 0;
   Store store_;
   DLContext context_ = CPUContext();
   FInterpreter executor_ = CPUInterpreter();
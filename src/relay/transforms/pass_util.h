@@ -95,6 +95,20 @@ bool IsDynamic(const Type& ty);
  */
 bool IsDataDependant(const CallNode* call);
 
+/*!
+ * \brief Get the number of bytes of a value of the type.
+ * \param type The type of the value, a tensor or a tuple of tensors.
+ * \return The number of bytes, 0 if a shape is not static.
+ */
+int64_t ValueBytes(const Type& type);
+
+/*!
+ * \brief Canonicalize the casts of a type inferred expression, see transform::CanonicalizeCast.
+ * \param e The expression.
+ * \return The expression with its casts canonicalized.
+ */
+Expr CanonicalizeCast(const Expr& e);
+
 /*!
  * \brief Make arbitrary transformation preserve the out most function.
  * \param func The transformation.
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * \file src/relay/transforms/prune_compiler_regions.cc
+ *
+ * \brief Keep only the compiler regions which are faster on their external
+ * compiler than on TVM.
+ *
+ * Offloading a region costs a launch and moving its inputs and outputs, which
+ * small regions do not make up for. This pass runs after MergeCompilerRegions,
+ * so the regions are as large as they can be, and estimates the cost of every
+ * region on its compiler and on TVM with a user provided function. The regions
+ * which are not strictly faster on their compiler are annotated with the
+ * "default" compiler, so partition_graph leaves their operators to TVM.
+ */
+
+#include <tvm/ir/error.h>
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/annotation.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../analysis/annotated_region_set.h"
+#include "pass_util.h"
+
+namespace tvm {
+namespace relay {
+namespace prune_compiler_region {
+
+/*! \brief The name of the compiler used for the operators left to TVM. */
+constexpr const char* kDefaultCompiler = "default";
+
+/*!
+ * \brief Create a function computing the outputs of a region from its inputs,
+ * which is what the cost function estimates.
+ */
+class RegionFunctionCreator : public ExprMutator {
+ public:
+  Function Create(const AnnotatedRegion& region) {
+    Array<Var> params;
+    for (const auto& input : region->GetInputs()) {
+      Var param("region_input_" + std::to_string(params.size()), input->checked_type());
+      params.push_back(param);
+      this->memo_[input] = param;
+    }
+    Array<Expr> outputs;
+    for (const auto& output : region->GetOutputs()) {
+      outputs.push_back(VisitExpr(Downcast<Call>(output)->args[0]));
+    }
+    Expr body = outputs.size() == 1 ? outputs[0] : Tuple(outputs);
+    IRModule mod = IRModule::FromExpr(Function(params, body, Type(), {}));
+    mod = transform::InferType()(mod);
+    return Downcast<Function>(mod->Lookup("main"));
+  }
+};
+
+class RegionPruner : public ExprRewriter {
+ public:
+  explicit RegionPruner(std::unordered_set<const Object*> pruned_annotations)
+      : pruned_annotations_(std::move(pruned_annotations)) {}
+
+  Expr Rewrite_(const CallNode* call, const Expr& post) final {
+    if (pruned_annotations_.count(call) == 0) return post;
+    const auto* post_call = post.as<CallNode>();
+    auto attrs = make_object<CompilerAttrs>();
+    attrs->compiler = kDefaultCompiler;
+    return Call(post_call->op, post_call->args, Attrs(attrs), post_call->type_args);
+  }
+
+ private:
+  /*! \brief The begin and end annotations of the pruned regions. */
+  std::unordered_set<const Object*> pruned_annotations_;
+};
+
+Expr PruneCompilerRegions(const Expr& expr, const PackedFunc& region_cost) {
+  AnnotatedRegionSet regions = AnnotatedRegionSet::Create(expr, CompilerBeginOp(), CompilerEndOp());
+
+  std::unordered_set<const Object*> pruned_annotations;
+  for (const auto& region : regions) {
+    std::string target = region->GetTarget();
+    if (target == kDefaultCompiler) continue;
+    Function func = RegionFunctionCreator().Create(region);
+    double offload_cost = region_cost(func, target);
+    double tvm_cost = region_cost(func, kDefaultCompiler);
+    DLOG(INFO) << "Region " << region->GetID() << " of " << target << " costs " << offload_cost
+               << ", and " << tvm_cost << " on TVM";
+    if (offload_cost < tvm_cost) continue;
+    for (const auto& input : region->GetInputs()) pruned_annotations.insert(input.get());
+    for (const auto& output : region->GetOutputs()) pruned_annotations.insert(output.get());
+  }
+  if (pruned_annotations.empty()) return expr;
+
+  RegionPruner pruner(std::move(pruned_annotations));
+  return PostOrderRewrite(expr, &pruner);
+}
+
+}  // namespace prune_compiler_region
+
+namespace transform {
+
+Pass PruneCompilerRegions(PackedFunc region_cost) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> prune_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(prune_compiler_region::PruneCompilerRegions(f, region_cost));
+      };
+  auto pruned = CreateFunctionPass(prune_func, 0, "PruneCompilerRegions", {"InferType"});
+  return Sequential({pruned, InferType()});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.PruneCompilerRegions")
+    .set_body_typed(transform::PruneCompilerRegions);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -0,0 +1,312 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rematerialize.cc
+ *
+ * \brief Recompute cheap activations instead of keeping them alive.
+ *
+ *  The backward part of a training graph reads the activations computed by
+ *  the forward part, so they all stay alive until the gradients have been
+ *  computed. When the estimated peak exceeds a memory budget, this pass
+ *  frees the largest activation alive at the peak that can be recomputed
+ *  by one cheap (injective) call from values still available later, and
+ *  recomputes it right before its first use after the peak. This repeats
+ *  until the peak fits the budget or no such activation is left.
+ *
+ *  The function is flattened into a chain of lets first. Shared nodes are
+ *  bound once, which is how the graph runtime codegen computes them, so the
+ *  forward calls reused by the gradient of first order AD are activations
+ *  here too.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "pass_util.h"
+
+namespace tvm {
+namespace relay {
+
+/*! \brief A let binding of the flattened function. */
+struct RematBinding {
+  Var var;
+  Expr value;
+  /*! \brief The bytes allocated by the binding, 0 for tuples that alias their fields. */
+  int64_t bytes;
+};
+
+/*! \brief Flatten a dataflow function into a chain of bindings of atoms. */
+class LetChainFlattener {
+ public:
+  std::vector<RematBinding> bindings;
+  Expr result;
+
+  /*! \return false if the body is not a pure dataflow program. */
+  bool Flatten(const Function& func) {
+    result = Normalize(func->body);
+    return ok_;
+  }
+
+ private:
+  Expr Normalize(const Expr& expr) {
+    if (const auto* var = expr.as<VarNode>()) {
+      auto it = var_map_.find(var);
+      return it != var_map_.end() ? it->second : expr;
+    }
+    if (expr.as<ConstantNode>() || expr.as<GlobalVarNode>() || expr.as<OpNode>()) return expr;
+    auto it = memo_.find(expr.get());
+    if (it != memo_.end()) return it->second;
+    Expr value;
+    if (const auto* call = expr.as<CallNode>()) {
+      if (call->op.as<FunctionNode>() &&
+          !Downcast<Function>(call->op)->HasNonzeroAttr(attr::kPrimitive)) {
+        ok_ = false;
+        return expr;
+      }
+      Array<Expr> args;
+      for (const Expr& arg : call->args) args.push_back(Normalize(arg));
+      value = Call(call->op, args, call->attrs, call->type_args, call->span);
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const Expr& field : tuple->fields) fields.push_back(Normalize(field));
+      value = Tuple(fields, tuple->span);
+    } else if (const auto* get_item = expr.as<TupleGetItemNode>()) {
+      value = TupleGetItem(Normalize(get_item->tuple), get_item->index, get_item->span);
+    } else if (const auto* let = expr.as<LetNode>()) {
+      var_map_[let->var.get()] = Normalize(let->value);
+      return Normalize(let->body);
+    } else {
+      ok_ = false;
+      return expr;
+    }
+    Type type = expr->checked_type_;
+    Var var("x" + std::to_string(bindings.size()), type);
+    bindings.push_back({var, value, value.as<CallNode>() && type.defined() ? ValueBytes(type) : 0});
+    memo_[expr.get()] = var;
+    return std::move(var);
+  }
+
+  bool ok_{true};
+  std::unordered_map<const Object*, Expr> memo_;
+  std::unordered_map<const VarNode*, Expr> var_map_;
+};
+
+/*! \brief The atoms read by a binding value. */
+static Array<Expr> Operands(const Expr& value) {
+  if (const auto* call = value.as<CallNode>()) return call->args;
+  if (const auto* tuple = value.as<TupleNode>()) return tuple->fields;
+  if (const auto* get_item = value.as<TupleGetItemNode>()) return {get_item->tuple};
+  return {};
+}
+
+/*! \brief Replace the reads of from by to in a binding value. */
+static Expr ReplaceOperand(const Expr& value, const Var& from, const Var& to) {
+  auto replace = [&](const Array<Expr>& atoms) {
+    Array<Expr> result;
+    for (const Expr& atom : atoms) result.push_back(atom.same_as(from) ? to : atom);
+    return result;
+  };
+  if (const auto* call = value.as<CallNode>()) {
+    return Call(call->op, replace(call->args), call->attrs, call->type_args, call->span);
+  }
+  if (const auto* tuple = value.as<TupleNode>()) return Tuple(replace(tuple->fields), tuple->span);
+  const auto* get_item = value.as<TupleGetItemNode>();
+  CHECK(get_item != nullptr);
+  return TupleGetItem(get_item->tuple.same_as(from) ? to : get_item->tuple, get_item->index,
+                      get_item->span);
+}
+
+/*! \brief Whether recomputing the call is cheap, i.e. it is injective. */
+static bool IsCheapToRecompute(const CallNode* call) {
+  static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+  auto is_cheap_op = [&](const Expr& op) {
+    const auto* op_node = op.as<OpNode>();
+    return op_node != nullptr && fpattern.count(GetRef<Op>(op_node)) &&
+           fpattern[GetRef<Op>(op_node)] <= kInjective;
+  };
+  if (const auto* func = call->op.as<FunctionNode>()) {
+    bool cheap = true;
+    PostOrderVisit(func->body, [&](const Expr& expr) {
+      if (const auto* inner = expr.as<CallNode>()) cheap = cheap && is_cheap_op(inner->op);
+    });
+    return cheap;
+  }
+  return is_cheap_op(call->op);
+}
+
+class Rematerializer {
+ public:
+  Rematerializer(std::vector<RematBinding> bindings, Expr result)
+      : bindings_(std::move(bindings)), result_(std::move(result)) {}
+
+  /*!
+   * \brief Recompute activations until the estimated peak fits the budget.
+   * \return Whether any activation is recomputed.
+   */
+  bool Run(int64_t budget) {
+    bool changed = false;
+    for (size_t iter = 0, max_iter = bindings_.size(); iter < max_iter; ++iter) {
+      Analyze();
+      size_t peak_pos = 0;
+      for (size_t t = 1; t < live_.size(); ++t) {
+        if (live_[t] > live_[peak_pos]) peak_pos = t;
+      }
+      if (live_.empty() || (budget > 0 && live_[peak_pos] <= budget)) break;
+      if (!Recompute(peak_pos)) break;
+      changed = true;
+    }
+    return changed;
+  }
+
+  /*! \brief Rebuild the function body as a chain of lets. */
+  Expr Body() const {
+    Expr body = result_;
+    for (auto it = bindings_.rbegin(); it != bindings_.rend(); ++it) {
+      body = Let(it->var, it->value, body);
+    }
+    return body;
+  }
+
+ private:
+  /*! \brief Compute the uses, the last use and the live bytes at each binding. */
+  void Analyze() {
+    size_t num_bindings = bindings_.size();
+    std::unordered_map<const VarNode*, size_t> position;
+    for (size_t i = 0; i < num_bindings; ++i) position[bindings_[i].var.get()] = i;
+    auto binding_of = [&](const Expr& atom) -> int64_t {
+      const auto* var = atom.as<VarNode>();
+      auto it = var != nullptr ? position.find(var) : position.end();
+      return it != position.end() ? static_cast<int64_t>(it->second) : -1;
+    };
+    operands_.assign(num_bindings, {});
+    uses_.assign(num_bindings, {});
+    for (size_t j = 0; j < num_bindings; ++j) {
+      for (const Expr& atom : Operands(bindings_[j].value)) {
+        int64_t i = binding_of(atom);
+        if (i < 0) continue;
+        operands_[j].push_back(i);
+        uses_[i].push_back(j);
+      }
+    }
+    int64_t output = binding_of(result_);
+    if (output >= 0) uses_[output].push_back(num_bindings);
+    last_use_.resize(num_bindings);
+    for (size_t i = 0; i < num_bindings; ++i) {
+      last_use_[i] = uses_[i].empty() ? i : uses_[i].back();
+    }
+    // a tuple keeps the values it refers to alive.
+    for (size_t j = num_bindings; j-- > 0;) {
+      if (bindings_[j].value.as<CallNode>()) continue;
+      for (size_t i : operands_[j]) last_use_[i] = std::max(last_use_[i], last_use_[j]);
+    }
+    std::vector<int64_t> delta(num_bindings + 2, 0);
+    for (size_t i = 0; i < num_bindings; ++i) {
+      delta[i] += bindings_[i].bytes;
+      delta[last_use_[i] + 1] -= bindings_[i].bytes;
+    }
+    live_.assign(num_bindings + 1, 0);
+    for (size_t t = 0; t <= num_bindings; ++t) live_[t] = (t > 0 ? live_[t - 1] : 0) + delta[t];
+  }
+
+  /*!
+   * \brief Free the largest activation alive at the peak that can be
+   *  recomputed after it from values which are alive anyway.
+   */
+  bool Recompute(size_t peak_pos) {
+    int64_t best = -1;
+    size_t best_first_late = 0;
+    for (size_t i = 0; i < peak_pos; ++i) {
+      const RematBinding& binding = bindings_[i];
+      const auto* call = binding.value.as<CallNode>();
+      if (call == nullptr || binding.bytes == 0 || last_use_[i] <= peak_pos) continue;
+      if (best >= 0 && binding.bytes <= bindings_[best].bytes) continue;
+      // every use after the peak must read the recomputed value directly.
+      size_t first_late = 0;
+      bool ok = true;
+      for (size_t use : uses_[i]) {
+        if (use == peak_pos || (use < bindings_.size() && !bindings_[use].value.as<CallNode>())) {
+          ok = false;
+        } else if (use > peak_pos && first_late == 0) {
+          first_late = use;
+        }
+      }
+      if (!ok || first_late == 0 || !IsCheapToRecompute(call)) continue;
+      for (size_t operand : operands_[i]) ok = ok && last_use_[operand] >= first_late;
+      if (!ok) continue;
+      best = static_cast<int64_t>(i);
+      best_first_late = first_late;
+    }
+    if (best < 0) return false;
+
+    RematBinding original = bindings_[best];
+    Var copy(original.var->name_hint() + "_remat", original.var->type_annotation);
+    for (size_t use : uses_[best]) {
+      if (use <= peak_pos) continue;
+      if (use == bindings_.size()) {
+        result_ = copy;
+      } else {
+        bindings_[use].value = ReplaceOperand(bindings_[use].value, original.var, copy);
+      }
+    }
+    bindings_.insert(bindings_.begin() + best_first_late, {copy, original.value, original.bytes});
+    // the activation is not used before the peak, the recomputation just moves it.
+    if (uses_[best].front() > peak_pos) bindings_.erase(bindings_.begin() + best);
+    return true;
+  }
+
+  std::vector<RematBinding> bindings_;
+  Expr result_;
+  std::vector<std::vector<size_t>> operands_;
+  std::vector<std::vector<size_t>> uses_;
+  std::vector<size_t> last_use_;
+  std::vector<int64_t> live_;
+};
+
+Function Rematerialize(const Function& func, int64_t memory_budget) {
+  if (func->HasNonzeroAttr(attr::kPrimitive)) return func;
+  LetChainFlattener flattener;
+  if (!flattener.Flatten(func)) return func;
+  Rematerializer remat(std::move(flattener.bindings), flattener.result);
+  if (!remat.Run(memory_budget)) return func;
+  return Function(func->params, remat.Body(), func->ret_type, func->type_params, func->attrs,
+                  func->span);
+}
+
+namespace transform {
+
+Pass Rematerialize(int64_t memory_budget) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return relay::Rematerialize(f, memory_budget);
+      };
+  return CreateFunctionPass(pass_func, 0, "Rematerialize", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.Rematerialize").set_body_typed(Rematerialize);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
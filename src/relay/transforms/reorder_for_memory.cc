@@ -0,0 +1,303 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file reorder_for_memory.cc
+ *
+ * \brief Reorder the calls of a dataflow function to lower its peak memory.
+ *
+ *  The graph memory planner reuses storage in the order the calls are
+ *  visited, which is the depth first order of the arguments. For branchy
+ *  graphs this order can keep the outputs of many branches alive at once.
+ *  This pass tries two orders and keeps the one with the lower estimated
+ *  peak: a depth first order that visits the inputs needing the most extra
+ *  memory first (Sethi-Ullman), and a greedy list schedule that runs the
+ *  ready call growing the live bytes least. The chosen order is made
+ *  explicit with a chain of lets, which both the planner and the graph
+ *  runtime codegen follow. The function is only rewritten if the estimated
+ *  peak of the new order is lower than the peak of the original one.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "pass_util.h"
+
+namespace tvm {
+namespace relay {
+
+/*! \brief The calls of a dataflow function and the dependencies between them. */
+class CallGraphBuilder : private ExprVisitor {
+ public:
+  /*! \brief The calls in the order they are visited by the planner. */
+  std::vector<const CallNode*> calls;
+  /*! \brief The indices of the calls whose outputs each call reads. */
+  std::vector<std::vector<size_t>> inputs;
+  /*! \brief Whether the output of each call is an output of the function. */
+  std::vector<bool> is_output;
+
+  /*!
+   * \brief Collect the calls of the function body.
+   * \return false if the body is not a pure dataflow graph.
+   */
+  bool Build(const Function& func) {
+    VisitExpr(func->body);
+    if (!dataflow_) return false;
+    is_output.resize(calls.size(), false);
+    for (size_t index : Producers(func->body)) is_output[index] = true;
+    return true;
+  }
+
+  /*! \brief The calls whose outputs expr refers to, through tuples. */
+  std::vector<size_t> Producers(const Expr& expr) {
+    std::vector<size_t> result;
+    if (const auto* call = expr.as<CallNode>()) {
+      result.push_back(call_index_.at(call));
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) {
+        for (size_t index : Producers(field)) result.push_back(index);
+      }
+    } else if (const auto* get_item = expr.as<TupleGetItemNode>()) {
+      result = Producers(get_item->tuple);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+  }
+
+ private:
+  void VisitExpr_(const CallNode* op) final {
+    ExprVisitor::VisitExpr_(op);
+    std::vector<size_t> args;
+    for (const Expr& arg : op->args) {
+      for (size_t index : Producers(arg)) args.push_back(index);
+    }
+    std::sort(args.begin(), args.end());
+    args.erase(std::unique(args.begin(), args.end()), args.end());
+    call_index_[op] = calls.size();
+    calls.push_back(op);
+    inputs.push_back(args);
+  }
+
+  // Primitive functions are lowered separately, do not recurse into them.
+  void VisitExpr_(const FunctionNode* op) final {}
+  void VisitExpr_(const LetNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const IfNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const MatchNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefCreateNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefReadNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefWriteNode* op) final { dataflow_ = false; }
+
+  bool dataflow_{true};
+  std::unordered_map<const CallNode*, size_t> call_index_;
+};
+
+class PeakMemoryScheduler {
+ public:
+  explicit PeakMemoryScheduler(const CallGraphBuilder& graph) : graph_(graph) {
+    size_t num_calls = graph.calls.size();
+    bytes_.resize(num_calls);
+    num_users_.resize(num_calls, 0);
+    for (size_t i = 0; i < num_calls; ++i) {
+      bytes_[i] = ValueBytes(graph.calls[i]->checked_type());
+      for (size_t input : graph.inputs[i]) num_users_[input] += 1;
+    }
+  }
+
+  /*! \brief Estimate the peak live bytes of the call outputs in the order. */
+  int64_t Peak(const std::vector<size_t>& order) const {
+    std::vector<int> remaining = num_users_;
+    int64_t live = 0, peak = 0;
+    for (size_t index : order) {
+      live += bytes_[index];
+      peak = std::max(peak, live);
+      if (remaining[index] == 0 && !graph_.is_output[index]) live -= bytes_[index];
+      for (size_t input : graph_.inputs[index]) {
+        if (--remaining[input] == 0 && !graph_.is_output[input]) live -= bytes_[input];
+      }
+    }
+    return peak;
+  }
+
+  /*!
+   * \brief Depth first order that visits the inputs needing the most extra
+   *  memory first, which is optimal when the calls form a tree.
+   */
+  std::vector<size_t> SubtreeOrder() const {
+    size_t num_calls = graph_.calls.size();
+    // peak bytes of computing each call on its own, as if its inputs were a tree.
+    std::vector<int64_t> peak(num_calls);
+    std::vector<std::vector<size_t>> children(num_calls);
+    auto by_extra = [&](size_t lhs, size_t rhs) {
+      return peak[lhs] - bytes_[lhs] > peak[rhs] - bytes_[rhs];
+    };
+    for (size_t i = 0; i < num_calls; ++i) {
+      children[i] = graph_.inputs[i];
+      std::stable_sort(children[i].begin(), children[i].end(), by_extra);
+      int64_t held = 0;
+      peak[i] = 0;
+      for (size_t child : children[i]) {
+        peak[i] = std::max(peak[i], held + peak[child]);
+        held += bytes_[child];
+      }
+      peak[i] = std::max(peak[i], held + bytes_[i]);
+    }
+    std::vector<size_t> outputs;
+    for (size_t i = 0; i < num_calls; ++i) {
+      if (graph_.is_output[i]) outputs.push_back(i);
+    }
+    std::stable_sort(outputs.begin(), outputs.end(), by_extra);
+
+    std::vector<size_t> order;
+    std::vector<bool> visited(num_calls, false);
+    std::function<void(size_t)> visit = [&](size_t index) {
+      if (visited[index]) return;
+      visited[index] = true;
+      for (size_t child : children[index]) visit(child);
+      order.push_back(index);
+    };
+    for (size_t index : outputs) visit(index);
+    if (order.size() != num_calls) {
+      // calls that do not reach an output keep their relative order.
+      for (size_t i = 0; i < num_calls; ++i) visit(i);
+    }
+    return order;
+  }
+
+  /*! \brief Greedily pick the ready call that grows the live bytes least. */
+  std::vector<size_t> Schedule() const {
+    size_t num_calls = graph_.calls.size();
+    std::vector<int> remaining = num_users_;
+    std::vector<int> pending_inputs(num_calls);
+    std::vector<std::vector<size_t>> users(num_calls);
+    for (size_t i = 0; i < num_calls; ++i) {
+      pending_inputs[i] = static_cast<int>(graph_.inputs[i].size());
+      for (size_t input : graph_.inputs[i]) users[input].push_back(i);
+    }
+    // the ready calls, kept sorted by their original position for stable ties.
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < num_calls; ++i) {
+      if (pending_inputs[i] == 0) ready.push_back(i);
+    }
+    std::vector<size_t> order;
+    while (!ready.empty()) {
+      size_t best = 0;
+      int64_t best_delta = 0;
+      for (size_t k = 0; k < ready.size(); ++k) {
+        size_t index = ready[k];
+        int64_t delta = bytes_[index];
+        for (size_t input : graph_.inputs[index]) {
+          if (remaining[input] == 1 && !graph_.is_output[input]) delta -= bytes_[input];
+        }
+        if (k == 0 || delta < best_delta) {
+          best = k;
+          best_delta = delta;
+        }
+      }
+      size_t index = ready[best];
+      ready.erase(ready.begin() + best);
+      order.push_back(index);
+      for (size_t input : graph_.inputs[index]) remaining[input] -= 1;
+      for (size_t user : users[index]) {
+        if (--pending_inputs[user] == 0) {
+          ready.insert(std::upper_bound(ready.begin(), ready.end(), user), user);
+        }
+      }
+    }
+    CHECK_EQ(order.size(), num_calls);
+    return order;
+  }
+
+ private:
+  const CallGraphBuilder& graph_;
+  /*! \brief The output bytes of each call. */
+  std::vector<int64_t> bytes_;
+  /*! \brief The number of calls that read each call. */
+  std::vector<int> num_users_;
+};
+
+/*! \brief Rebuild the function as a chain of lets in the given order. */
+class LetChainBuilder : private ExprMutator {
+ public:
+  Function Build(const Function& func, const CallGraphBuilder& graph,
+                 const std::vector<size_t>& order) {
+    std::vector<std::pair<Var, Expr>> bindings;
+    for (size_t index : order) {
+      const CallNode* call = graph.calls[index];
+      Array<Expr> args;
+      for (const Expr& arg : call->args) args.push_back(VisitExpr(arg));
+      Var var("x" + std::to_string(bindings.size()), call->checked_type());
+      bindings.emplace_back(var, Call(call->op, args, call->attrs, call->type_args, call->span));
+      memo_[GetRef<Expr>(call)] = var;
+    }
+    Expr body = VisitExpr(func->body);
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return Function(func->params, body, func->ret_type, func->type_params, func->attrs,
+                    func->span);
+  }
+
+ private:
+  // Primitive functions are kept as they are.
+  Expr VisitExpr_(const FunctionNode* op) final { return GetRef<Expr>(op); }
+};
+
+Function ReorderForPeakMemory(const Function& func) {
+  if (func->HasNonzeroAttr(attr::kPrimitive)) return func;
+  CallGraphBuilder graph;
+  if (!graph.Build(func) || graph.calls.size() < 2) return func;
+  PeakMemoryScheduler scheduler(graph);
+  std::vector<size_t> original(graph.calls.size());
+  for (size_t i = 0; i < original.size(); ++i) original[i] = i;
+  int64_t original_peak = scheduler.Peak(original);
+  std::vector<size_t> order = scheduler.SubtreeOrder();
+  int64_t peak = scheduler.Peak(order);
+  std::vector<size_t> greedy_order = scheduler.Schedule();
+  int64_t greedy_peak = scheduler.Peak(greedy_order);
+  if (greedy_peak < peak) {
+    order = std::move(greedy_order);
+    peak = greedy_peak;
+  }
+  DLOG(INFO) << "ReorderForPeakMemory: estimated peak " << original_peak << " -> " << peak
+             << " bytes";
+  if (peak >= original_peak) return func;
+  return LetChainBuilder().Build(func, graph, order);
+}
+
+namespace transform {
+
+Pass ReorderForPeakMemory() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) { return relay::ReorderForPeakMemory(f); };
+  return CreateFunctionPass(pass_func, 0, "ReorderForPeakMemory", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.ReorderForPeakMemory")
+    .set_body_typed(ReorderForPeakMemory);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -0,0 +1,325 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file to_mixed_precision.cc
+ * \brief Run the float32 parts of a graph in float16 or bfloat16 where it is safe.
+ */
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "pass_util.h"
+#include "pattern_util.h"
+
+namespace tvm {
+namespace relay {
+
+// Every operator falls in one of three groups.
+//
+// - allow: compute bound operators, which profit the most from the mixed type.
+//   Their float32 inputs are cast to the mixed type, and so is their out_dtype.
+//   The accumulating ones among them (convolutions, dense and batch_matmul) take
+//   the accumulation type as out_dtype instead, and their result is cast to the
+//   mixed type. batch_matmul has no out_dtype, so it stays in float32 unless it
+//   accumulates in the mixed type.
+// - follow: cheap operators that run in the mixed type when one of their inputs
+//   already does, so that casts only sit at the borders of the mixed regions.
+// - deny: operators that need the float32 range or accumulation, such as softmax
+//   and reductions. Their mixed inputs are cast back to float32.
+//
+// Operators in none of the lists follow when they are at most injective and are
+// denied otherwise. Values keep their original type when they leave the dataflow
+// part of the function (let bindings, branches, calls to functions and the result),
+// so the signature of the function does not change.
+class MixedPrecisionMutator : public ExprMutator {
+ public:
+  enum Category { kAllow, kFollow, kDeny };
+
+  MixedPrecisionMutator(DataType mixed_type, DataType accumulation_type,
+                        const Array<String>& allow_ops, const Array<String>& follow_ops,
+                        const Array<String>& deny_ops)
+      : mixed_type_(mixed_type), accumulation_type_(accumulation_type), cast_op_(Op::Get("cast")) {
+    for (const char* name : {"nn.conv1d", "nn.conv2d", "nn.conv3d", "nn.conv1d_transpose",
+                             "nn.conv2d_transpose", "nn.conv3d_transpose", "nn.dense",
+                             "nn.batch_matmul"}) {
+      category_[name] = kAllow;
+      accumulating_.insert(name);
+    }
+    for (const char* name : {"nn.max_pool1d", "nn.max_pool2d", "nn.max_pool3d",
+                             "nn.global_max_pool2d", "nn.adaptive_max_pool2d"}) {
+      category_[name] = kFollow;
+    }
+    for (const char* name : {"nn.softmax", "nn.log_softmax", "exp", "log", "erf", "sum", "mean",
+                             "prod", "variance", "nn.batch_norm", "nn.layer_norm",
+                             "nn.instance_norm", "nn.group_norm", "nn.avg_pool2d",
+                             "nn.global_avg_pool2d", "nn.adaptive_avg_pool2d"}) {
+      category_[name] = kDeny;
+    }
+    for (const String& name : allow_ops) category_[name] = kAllow;
+    for (const String& name : follow_ops) category_[name] = kFollow;
+    for (const String& name : deny_ops) category_[name] = kDeny;
+  }
+
+  Expr VisitExpr_(const CallNode* call) final {
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr) {
+      // Functions, constructors and globals keep their original signature.
+      Array<Expr> args;
+      for (const Expr& arg : call->args) {
+        args.push_back(CastValue(arg, false));
+      }
+      return Call(VisitExpr(call->op), args, call->attrs, call->type_args);
+    }
+    if (call->op == cast_op_) {
+      // cast accepts any input type, and its output type is fixed by its attribute.
+      return ExprMutator::VisitExpr_(call);
+    }
+
+    bool has_float = false;
+    bool has_converted = false;
+    for (const Expr& arg : call->args) {
+      VisitExpr(arg);
+      has_float |= HasFloat32(arg->checked_type());
+      has_converted |= converted_.count(arg.get());
+    }
+    Category category = GetCategory(op);
+    bool convert = (has_float || has_converted) &&
+                   (category == kAllow || (category == kFollow && has_converted));
+    bool accumulate = convert && category == kAllow && accumulation_type_ != mixed_type_ &&
+                      accumulating_.count(op->name);
+    Attrs accumulate_attrs;
+    if (accumulate) {
+      accumulate_attrs = SetOutDType(call->attrs, accumulation_type_);
+      // Without an out_dtype the operator would accumulate in the mixed type.
+      convert = accumulate_attrs.defined();
+    }
+
+    Array<Expr> args;
+    for (const Expr& arg : call->args) {
+      args.push_back(CastValue(arg, convert));
+    }
+    if (!convert) {
+      return Call(call->op, args, call->attrs, call->type_args);
+    }
+    converted_.insert(call);
+    if (accumulate) {
+      return Cast(Call(call->op, args, accumulate_attrs, {}), mixed_type_);
+    }
+    Attrs attrs = SetOutDType(call->attrs, mixed_type_);
+    return Call(call->op, args, attrs.defined() ? attrs : call->attrs, {});
+  }
+
+  Expr VisitExpr_(const TupleNode* tuple) final {
+    bool has_converted = false;
+    for (const Expr& field : tuple->fields) {
+      VisitExpr(field);
+      has_converted |= converted_.count(field.get());
+    }
+    Array<Expr> fields;
+    for (const Expr& field : tuple->fields) {
+      fields.push_back(CastValue(field, has_converted));
+    }
+    if (has_converted) {
+      converted_.insert(tuple);
+    }
+    return Tuple(fields);
+  }
+
+  Expr VisitExpr_(const TupleGetItemNode* get) final {
+    Expr tuple = VisitExpr(get->tuple);
+    if (converted_.count(get->tuple.get())) {
+      converted_.insert(get);
+    }
+    return TupleGetItem(tuple, get->index);
+  }
+
+  Expr VisitExpr_(const FunctionNode* func) final {
+    if (func->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Expr>(func);
+    }
+    return Function(func->params, CastValue(func->body, false), func->ret_type,
+                    func->type_params, func->attrs);
+  }
+
+  Expr VisitExpr_(const LetNode* let) final {
+    return Let(let->var, CastValue(let->value, false), CastValue(let->body, false));
+  }
+
+  Expr VisitExpr_(const IfNode* cond) final {
+    return If(CastValue(cond->cond, false), CastValue(cond->true_branch, false),
+              CastValue(cond->false_branch, false));
+  }
+
+  Expr VisitExpr_(const RefCreateNode* ref) final {
+    return RefCreate(CastValue(ref->value, false));
+  }
+
+  Expr VisitExpr_(const RefWriteNode* ref) final {
+    return RefWrite(CastValue(ref->ref, false), CastValue(ref->value, false));
+  }
+
+  Expr VisitExpr_(const MatchNode* match) final {
+    Array<Clause> clauses;
+    for (const Clause& clause : match->clauses) {
+      clauses.push_back(Clause(clause->lhs, CastValue(clause->rhs, false)));
+    }
+    return Match(CastValue(match->data, false), clauses, match->complete);
+  }
+
+ private:
+  Category GetCategory(const OpNode* op) const {
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    auto it = category_.find(op->name);
+    if (it != category_.end()) {
+      return it->second;
+    }
+    return fpattern.get(GetRef<Op>(op), kOpaque) <= kInjective ? kFollow : kDeny;
+  }
+
+  static bool HasFloat32(const Type& type) {
+    if (const auto* tensor_type = type.as<TensorTypeNode>()) {
+      return tensor_type->dtype == DataType::Float(32);
+    }
+    if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+      for (const Type& field : tuple_type->fields) {
+        if (HasFloat32(field)) return true;
+      }
+    }
+    return false;
+  }
+
+  // Get the rewritten e in the mixed type when to_mixed is set, and in its
+  // original type otherwise. The casts are shared between the users of e.
+  Expr CastValue(const Expr& e, bool to_mixed) {
+    Expr value = VisitExpr(e);
+    if ((converted_.count(e.get()) != 0) == to_mixed || !HasFloat32(e->checked_type())) {
+      return value;
+    }
+    auto& memo = to_mixed ? to_mixed_memo_ : to_float32_memo_;
+    auto it = memo.find(e.get());
+    if (it != memo.end()) {
+      return it->second;
+    }
+    Expr ret = CastType(value, e->checked_type(), to_mixed ? mixed_type_ : DataType::Float(32));
+    memo[e.get()] = ret;
+    return ret;
+  }
+
+  // Cast the parts of value that are float32 in the original type to dtype.
+  static Expr CastType(const Expr& value, const Type& type, DataType dtype) {
+    if (const auto* tuple_type = type.as<TupleTypeNode>()) {
+      const auto* tuple = value.as<TupleNode>();
+      Array<Expr> fields;
+      for (size_t i = 0; i < tuple_type->fields.size(); ++i) {
+        Expr field = tuple ? tuple->fields[i] : TupleGetItem(value, i);
+        fields.push_back(CastType(field, tuple_type->fields[i], dtype));
+      }
+      return Tuple(fields);
+    }
+    return HasFloat32(type) ? Cast(value, dtype) : value;
+  }
+
+  template <typename T>
+  Attrs SetOutDType(const T* attrs, DataType dtype) const {
+    if (dtype == mixed_type_ && attrs->out_dtype.is_void()) {
+      return GetRef<Attrs>(attrs);
+    }
+    auto new_attrs = make_object<T>(*attrs);
+    new_attrs->out_dtype = dtype;
+    return Attrs(new_attrs);
+  }
+
+  // Set the out_dtype of the compute bound operators to dtype, undefined for the
+  // operators without an out_dtype. A void out_dtype already follows the mixed input type.
+  Attrs SetOutDType(const Attrs& attrs, DataType dtype) const {
+    if (const auto* conv1d = attrs.as<Conv1DAttrs>()) return SetOutDType(conv1d, dtype);
+    if (const auto* conv2d = attrs.as<Conv2DAttrs>()) return SetOutDType(conv2d, dtype);
+    if (const auto* conv3d = attrs.as<Conv3DAttrs>()) return SetOutDType(conv3d, dtype);
+    if (const auto* conv1d_t = attrs.as<Conv1DTransposeAttrs>()) {
+      return SetOutDType(conv1d_t, dtype);
+    }
+    if (const auto* conv2d_t = attrs.as<Conv2DTransposeAttrs>()) {
+      return SetOutDType(conv2d_t, dtype);
+    }
+    if (const auto* conv3d_t = attrs.as<Conv3DTransposeAttrs>()) {
+      return SetOutDType(conv3d_t, dtype);
+    }
+    if (const auto* dense = attrs.as<DenseAttrs>()) return SetOutDType(dense, dtype);
+    return Attrs();
+  }
+
+  DataType mixed_type_;
+  // The out_dtype of the accumulating operators.
+  DataType accumulation_type_;
+  const Op& cast_op_;
+  std::unordered_map<std::string, Category> category_;
+  std::unordered_set<std::string> accumulating_;
+  // The original expressions whose rewritten value is in the mixed type.
+  std::unordered_set<const Object*> converted_;
+  std::unordered_map<const Object*, Expr> to_mixed_memo_;
+  std::unordered_map<const Object*, Expr> to_float32_memo_;
+};
+
+Expr ToMixedPrecision(const Expr& e, DataType mixed_precision_type, const Array<String>& allow_ops,
+                      const Array<String>& follow_ops, const Array<String>& deny_ops,
+                      DataType accumulation_type) {
+  return MixedPrecisionMutator(mixed_precision_type, accumulation_type, allow_ops, follow_ops,
+                               deny_ops)
+      .Mutate(e);
+}
+
+namespace transform {
+
+Pass ToMixedPrecision(DataType mixed_precision_type, Array<String> allow_ops,
+                      Array<String> follow_ops, Array<String> deny_ops,
+                      DataType accumulation_type) {
+  CHECK(mixed_precision_type == DataType::Float(16) || mixed_precision_type.is_bfloat16())
+      << "ToMixedPrecision only supports float16 and bfloat16, but got " << mixed_precision_type;
+  CHECK(accumulation_type == DataType::Float(32) || accumulation_type == mixed_precision_type)
+      << "ToMixedPrecision accumulates in float32 or the mixed type, but got "
+      << accumulation_type;
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(
+            ToMixedPrecision(f, mixed_precision_type, allow_ops, follow_ops, deny_ops,
+                             accumulation_type));
+      };
+  // Fold the cast round trips left at the borders of the mixed regions. This is
+  // part of the pass, so it does not depend on the opt_level of CanonicalizeCast.
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> fold_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(relay::CanonicalizeCast(f));
+      };
+  return Sequential({CreateFunctionPass(pass_func, 0, "ToMixedPrecision", {"InferType"}),
+                     InferType(), CreateFunctionPass(fold_func, 0, "MixedPrecisionFoldCast", {})},
+                    "ToMixedPrecision");
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.ToMixedPrecision").set_body_typed(ToMixedPrecision);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -150,12 +150,46 @@ class TypeInferencer : private ExprFunctor<Type(const Expr&)>,
     if (it != type_map_.end() && it->second.checked_type.defined()) {
       return it->second.checked_type;
     }
+    // Type the inputs of the dataflow nodes with an explicit stack, in the order of the
+    // recursion, as the recursion overflows the call stack on deep graphs. The VisitExpr_ of a
+    // node then finds the types of its inputs.
+    std::vector<std::pair<Expr, bool>> stack;
+    stack.emplace_back(expr, false);
+    while (!stack.empty()) {
+      Expr node = stack.back().first;
+      auto it = type_map_.find(node);
+      if (it != type_map_.end() && it->second.checked_type.defined()) {
+        stack.pop_back();
+      } else if (stack.back().second) {
+        stack.pop_back();
+        InferNodeType(node);
+      } else if (const auto* call = node.as<CallNode>()) {
+        stack.back().second = true;
+        for (auto arg = call->args.rbegin(); arg != call->args.rend(); ++arg) {
+          stack.emplace_back(*arg, false);
+        }
+      } else if (const auto* tuple = node.as<TupleNode>()) {
+        stack.back().second = true;
+        for (auto field = tuple->fields.rbegin(); field != tuple->fields.rend(); ++field) {
+          stack.emplace_back(*field, false);
+        }
+      } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+        stack.back().second = true;
+        stack.emplace_back(tuple_get->tuple, false);
+      } else {
+        stack.pop_back();
+        InferNodeType(node);
+      }
+    }
+    return type_map_.at(expr).checked_type;
+  }
+
+  void InferNodeType(const Expr& expr) {
     Type ret = this->VisitExpr(expr);
     CHECK(ret.defined());
     KindCheck(ret, mod_);
     ResolvedTypeInfo& rti = type_map_[expr];
     rti.checked_type = ret;
-    return ret;
   }
 
   void ReportFatalError(const ObjectRef& expr, const Error& err) {
@@ -559,6 +593,40 @@ class TypeInferencer::Resolver : public ExprMutator, PatternMutator {
            TypeSolver* solver)
       : tmap_(tmap), solver_(solver) {}
 
+  // Resolve the inputs of the dataflow nodes first with an explicit stack, as the recursion
+  // overflows the call stack on deep graphs. The VisitExpr_ of a node then finds them memoized.
+  Expr VisitExpr(const Expr& expr) final {
+    std::vector<std::pair<Expr, bool>> stack;
+    stack.emplace_back(expr, false);
+    while (!stack.empty()) {
+      Expr node = stack.back().first;
+      if (memo_.count(node)) {
+        stack.pop_back();
+      } else if (stack.back().second) {
+        stack.pop_back();
+        ExprMutator::VisitExpr(node);
+      } else if (const auto* call = node.as<CallNode>()) {
+        stack.back().second = true;
+        for (auto arg = call->args.rbegin(); arg != call->args.rend(); ++arg) {
+          stack.emplace_back(*arg, false);
+        }
+        stack.emplace_back(call->op, false);
+      } else if (const auto* tuple = node.as<TupleNode>()) {
+        stack.back().second = true;
+        for (auto field = tuple->fields.rbegin(); field != tuple->fields.rend(); ++field) {
+          stack.emplace_back(*field, false);
+        }
+      } else if (const auto* tuple_get = node.as<TupleGetItemNode>()) {
+        stack.back().second = true;
+        stack.emplace_back(tuple_get->tuple, false);
+      } else {
+        stack.pop_back();
+        ExprMutator::VisitExpr(node);
+      }
+    }
+    return memo_.at(expr);
+  }
+
   Expr VisitExpr_(const VarNode* op) final { return VisitVar(GetRef<Var>(op)); }
 
   Expr VisitExpr_(const ConstantNode* op) final { return AttachCheckedType(op); }
@@ -742,14 +810,100 @@ Function InferType(const Function& func, const IRModule& mod, const GlobalVar& v
   return Downcast<Function>(func_ret);
 }
 
+/*!
+ * \brief Checks whether a function still carries the types of an earlier
+ *  inference and records the global functions it calls.
+ *
+ *  Passes rebuild every node on the path from a change to the function root,
+ *  and rebuilt nodes have no checked_type_, so a function whose nodes are all
+ *  typed is unchanged since it was last checked.
+ */
+class TypedFunctionChecker : private ExprVisitor {
+ public:
+  /*!
+   * \brief Visit the function.
+   * \param func The function to check.
+   * \param callees Receives the names of the global functions that func calls.
+   * \return Whether every expression in func has a checked type.
+   */
+  bool Check(const Function& func, std::unordered_set<std::string>* callees) {
+    callees_ = callees;
+    VisitExpr(func);
+    return typed_;
+  }
+
+ private:
+  void VisitExpr(const Expr& e) final {
+    if (e.as<OpNode>() || e.as<ConstructorNode>()) return;
+    if (auto* gvar = e.as<GlobalVarNode>()) {
+      callees_->insert(gvar->name_hint);
+      return;
+    }
+    if (!e->checked_type_.defined()) typed_ = false;
+    ExprVisitor::VisitExpr(e);
+  }
+
+  bool typed_{true};
+  std::unordered_set<std::string>* callees_;
+};
+
+/*!
+ * \brief Type check the relay functions of a module, skipping those that are
+ *  unchanged since they were last checked.
+ *
+ *  A function is re-checked when one of its nodes lacks a checked type, or when
+ *  the type of a global function it calls changes during this pass.
+ */
+IRModule IncrementalInferType(const IRModule& mod, const transform::PassContext& pass_ctx) {
+  bool incremental = pass_ctx->GetConfig<Bool>("relay.incremental_type_infer", Bool(true)).value();
+  IRModule updated_mod = IRModule(mod->functions, mod->type_definitions, mod->Imports());
+
+  std::vector<GlobalVar> worklist;
+  std::unordered_set<std::string> pending;
+  std::unordered_map<std::string, std::vector<GlobalVar>> callers;
+  for (const auto& it : updated_mod->functions) {
+    auto* func = it.second.as<FunctionNode>();
+    if (func == nullptr) continue;
+    std::unordered_set<std::string> callees;
+    bool typed = TypedFunctionChecker().Check(GetRef<Function>(func), &callees);
+    for (const std::string& callee : callees) {
+      callers[callee].push_back(it.first);
+    }
+    if (!incremental || !typed || !it.first->checked_type_.defined()) {
+      worklist.push_back(it.first);
+      pending.insert(it.first->name_hint);
+    }
+  }
+
+  for (size_t i = 0; i < worklist.size(); ++i) {
+    GlobalVar var = worklist[i];
+    pending.erase(var->name_hint);
+    Function func = Downcast<Function>(updated_mod->Lookup(var));
+    Type old_type = var->checked_type_;
+    // Same as a function pass: external functions are only checked when added.
+    bool skip = func->GetAttr<String>(attr::kCompiler).defined() ||
+                func->GetAttr<Integer>(attr::kSkipOptimization, 0) != 0;
+    if (!skip) func = Downcast<Function>(InferType(func, updated_mod));
+    updated_mod->Add(var, func, true);
+    if (old_type.defined() && StructuralEqual()(old_type, var->checked_type_)) continue;
+    // The signature changed, callers need to be checked against the new one.
+    for (const GlobalVar& caller : callers[var->name_hint]) {
+      if (pending.insert(caller->name_hint).second) worklist.push_back(caller);
+    }
+  }
+  return updated_mod;
+}
+
 namespace transform {
 
 Pass InferType() {
-  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
-      [=](Function f, IRModule m, PassContext pc) { return Downcast<Function>(InferType(f, m)); };
-  return CreateFunctionPass(pass_func, 0, "InferType", {});
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) { return IncrementalInferType(m, pc); };
+  return CreateModulePass(pass_func, 0, "InferType", {});
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.incremental_type_infer", Bool);
+
 TVM_REGISTER_GLOBAL("relay._transform.InferType").set_body_typed([]() { return InferType(); });
 
 }  // namespace transform
@@ -30,6 +30,7 @@
 
 #ifdef TVM_GRAPH_RUNTIME_ARM_COMPUTE_LIB
 #include <arm_compute/core/Types.h>
+#include <arm_compute/runtime/MemoryGroup.h>
 #include <arm_compute/runtime/NEON/functions/NEConvolutionLayer.h>
 #include <arm_compute/runtime/NEON/functions/NEFullyConnectedLayer.h>
 #include <arm_compute/runtime/NEON/functions/NEPoolingLayer.h>
@@ -39,6 +40,11 @@
 #include "acl_utils.h"
 #endif
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace tvm {
 namespace runtime {
 namespace contrib {
@@ -81,69 +87,109 @@ class ACLRuntime : public JSONRuntimeBase {
 
 #ifdef TVM_GRAPH_RUNTIME_ARM_COMPUTE_LIB
   /*!
-   * \brief Unpack inputs and outputs and run inference on a given layer.
+   * \brief Import the graph inputs and outputs and run inference on each
+   * layer in turn.
    *
-   * \param args Access inputs and outputs.
-   * \param function The layer to execute inference on.
-   * \return Status of inference.
+   * Intermediate tensors live in the cross-layer memory group, which holds
+   * its pool only for the duration of the run.
    */
   void Run() override {
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
       auto nid = input_nodes_[i];
       uint32_t eid = EntryID(nid, 0);
-      if (nodes_[nid].GetOpType() == "input") {
+      if (nodes_[nid].GetOpType() == "input" && tensors_.count(eid)) {
         void* data = data_entry_[eid]->data;
-        CheckACLError(layer_.inputs[i].allocator()->import_memory(data));
+        CheckACLError(tensors_[eid]->allocator()->import_memory(data));
       }
     }
 
     for (size_t i = 0; i < outputs_.size(); ++i) {
       uint32_t eid = EntryID(outputs_[i]);
       void* data = data_entry_[eid]->data;
-      CheckACLError(layer_.outputs[i].allocator()->import_memory(data));
+      CheckACLError(tensors_[eid]->allocator()->import_memory(data));
     }
 
-    this->layer_.function->run();
+    arm_compute::MemoryGroupResourceScope scope(this->memory_group_);
+    for (const auto& layer : this->layers_) {
+      layer.function->run();
+    }
   }
 
  private:
   /*!
-   * \brief Build ACL layer from JSON representation and cache.
+   * \brief Build ACL layers from JSON representation and cache.
    *
-   * \note For the time being only one layer or operator is supported
-   * per engine.
+   * Layers are created in the (topological) order of the JSON nodes. The
+   * output of a layer that is not a graph output is managed by a memory
+   * group shared by the whole function, and its lifetime ends once its last
+   * consumer has been configured. The lifetime manager can then place
+   * intermediates whose lifetimes do not overlap at the same offset of a
+   * single pool, so peak memory is bounded by the largest set of live
+   * intermediates rather than their sum.
    */
   void BuildEngine() {
-    std::shared_ptr<arm_compute::MemoryManagerOnDemand> mm = MakeACLMemoryManager();
-    int num_pools = 0;
-    bool found_kernel_node = false;
+    intra_mm_ = MakeACLMemoryManager();
+    cross_mm_ = MakeACLMemoryManager();
+    memory_group_ = arm_compute::MemoryGroup(cross_mm_);
+
+    // The last layer reading each entry, after which its memory can be reused.
+    std::unordered_map<uint32_t, uint32_t> last_use;
+    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+      if (nodes_[nid].GetOpType() != "kernel") continue;
+      for (const auto& e : nodes_[nid].GetInputs()) {
+        last_use[EntryID(e)] = nid;
+      }
+    }
+
+    bool use_intra_mm = false;
     for (size_t nid = 0; nid < nodes_.size(); ++nid) {
       const auto& node = nodes_[nid];
-      if (found_kernel_node) {
-        LOG(FATAL)
-            << "Arm Compute Library runtime module only supports one kernel node per function.";
+      if (node.GetOpType() != "kernel") continue;
+      CachedLayer layer;
+      auto op_name = node.GetOpName();
+      if ("nn.conv2d" == op_name || "qnn.conv2d" == op_name) {
+        CreateConvolution2DLayer(&layer, nid, intra_mm_);
+        use_intra_mm = true;
+      } else if ("nn.dense" == op_name || "qnn.dense" == op_name) {
+        CreateFullyConnectedLayer(&layer, nid, intra_mm_);
+        use_intra_mm = true;
+      } else if ("nn.max_pool2d" == op_name) {
+        CreatePoolingLayer(&layer, nid);
+      } else if ("reshape" == op_name) {
+        CreateReshapeLayer(&layer, nid);
+      } else {
+        LOG(FATAL) << "Unsupported op: " << op_name;
       }
-      if (node.GetOpType() == "kernel") {
-        found_kernel_node = true;
-        auto op_name = node.GetOpName();
-        if ("nn.conv2d" == op_name || "qnn.conv2d" == op_name) {
-          CreateConvolution2DLayer(&layer_, node, mm);
-          num_pools++;
-        } else if ("nn.dense" == op_name || "qnn.dense" == op_name) {
-          CreateFullyConnectedLayer(&layer_, node, mm);
-          num_pools++;
-        } else if ("nn.max_pool2d" == op_name) {
-          CreatePoolingLayer(&layer_, node);
-        } else if ("reshape" == op_name) {
-          CreateReshapeLayer(&layer_, node);
-        } else {
-          LOG(FATAL) << "Unsupported op: " << op_name;
-        }
+      layers_.push_back(layer);
+
+      for (const auto& e : node.GetInputs()) {
+        uint32_t eid = EntryID(e);
+        if (last_use[eid] == nid) ReleaseManagedTensor(eid);
       }
     }
+    // Intermediates nobody reads still need backing memory.
+    while (!managed_.empty()) {
+      ReleaseManagedTensor(managed_.begin()->first);
+    }
 
-    this->layer_.function->prepare();
-    if (num_pools > 0) mm->populate(this->allocator_, num_pools);
+    for (auto& layer : layers_) {
+      layer.function->prepare();
+    }
+    // Layers run one after another, so a single pool per manager is enough.
+    if (use_intra_mm) intra_mm_->populate(this->allocator_, 1);
+    if (has_managed_tensors_) cross_mm_->populate(this->allocator_, 1);
+  }
+
+  /*!
+   * \brief End the lifetime of a managed intermediate tensor.
+   *
+   * \param eid The entry id of the tensor.
+   */
+  void ReleaseManagedTensor(uint32_t eid) {
+    auto it = managed_.find(eid);
+    if (it == managed_.end()) return;
+    it->second->allocator()->allocate();
+    managed_.erase(it);
   }
 
   /*!
@@ -152,28 +198,61 @@ class ACLRuntime : public JSONRuntimeBase {
    */
   struct CachedLayer {
     std::shared_ptr<arm_compute::IFunction> function;
-    std::vector<arm_compute::Tensor> inputs;
-    std::vector<arm_compute::Tensor> outputs;
+    std::vector<std::shared_ptr<arm_compute::Tensor>> inputs;
+    std::vector<std::shared_ptr<arm_compute::Tensor>> outputs;
   };
 
   /*!
-   * \brief Create an ACL tensor given the JSON representation. If scale
-   * and offset are given, then create a quantized ACL tensor.
+   * \brief Get the ACL tensor for a JSON entry, creating it on first use. If
+   * scale and offset are given, then create a quantized ACL tensor.
    *
    * \param tensor The tensor to represent.
    * \param scale (optional) The scale of the tensor as an input.
    * \param offset (optional) The offset of the tensor as an input.
    * \return ACL Tensor.
    */
-  arm_compute::Tensor MakeACLTensorFromJSONEntry(const JSONGraphNodeEntry& tensor,
-                                                 JSONGraphNodeEntry* scale = nullptr,
-                                                 JSONGraphNodeEntry* offset = nullptr) {
+  std::shared_ptr<arm_compute::Tensor> MakeACLTensorFromJSONEntry(
+      const JSONGraphNodeEntry& tensor, JSONGraphNodeEntry* scale = nullptr,
+      JSONGraphNodeEntry* offset = nullptr) {
+    uint32_t eid = EntryID(tensor);
+    auto it = tensors_.find(eid);
+    if (it != tensors_.end()) return it->second;
     JSONGraphNode node = nodes_[tensor.id_];
     void* node_data = nullptr;
     if (node.GetOpType() == "const") {
-      node_data = data_entry_[EntryID(tensor)]->data;
+      node_data = data_entry_[eid]->data;
+    }
+    auto acl_tensor = MakeACLTensorFromJSONNode(node, scale, offset, node_data);
+    tensors_[eid] = acl_tensor;
+    return acl_tensor;
+  }
+
+  /*!
+   * \brief Create the ACL tensor produced by a kernel node. Unless it is an
+   * output of the graph, the tensor is handed to the cross-layer memory group
+   * and must be created before the layer producing it is configured.
+   *
+   * \param nid The id of the kernel node.
+   * \param scale (optional) The scale of the tensor as an output.
+   * \param offset (optional) The offset of the tensor as an output.
+   * \return ACL Tensor.
+   */
+  std::shared_ptr<arm_compute::Tensor> MakeACLOutputTensor(uint32_t nid,
+                                                           JSONGraphNodeEntry* scale = nullptr,
+                                                           JSONGraphNodeEntry* offset = nullptr) {
+    uint32_t eid = EntryID(nid, 0);
+    auto acl_tensor = MakeACLTensorFromJSONNode(nodes_[nid], scale, offset);
+    tensors_[eid] = acl_tensor;
+    bool is_output = false;
+    for (const auto& out : outputs_) {
+      is_output |= EntryID(out) == eid;
     }
-    return MakeACLTensorFromJSONNode(node, scale, offset, node_data);
+    if (!is_output) {
+      memory_group_.manage(acl_tensor.get());
+      managed_[eid] = acl_tensor;
+      has_managed_tensors_ = true;
+    }
+    return acl_tensor;
   }
 
   /*!
@@ -186,10 +265,9 @@ class ACLRuntime : public JSONRuntimeBase {
    * \param data (optional) Constant data of input node.
    * \return ACL Tensor.
    */
-  arm_compute::Tensor MakeACLTensorFromJSONNode(const JSONGraphNode& node,
-                                                JSONGraphNodeEntry* scale = nullptr,
-                                                JSONGraphNodeEntry* offset = nullptr,
-                                                void* data = nullptr) {
+  std::shared_ptr<arm_compute::Tensor> MakeACLTensorFromJSONNode(
+      const JSONGraphNode& node, JSONGraphNodeEntry* scale = nullptr,
+      JSONGraphNodeEntry* offset = nullptr, void* data = nullptr) {
     const DLTensor* scale_data = nullptr;
     const DLTensor* offset_data = nullptr;
     if (scale && offset) {
@@ -203,11 +281,12 @@ class ACLRuntime : public JSONRuntimeBase {
    * \brief Create a 2D convolution layer.
    *
    * \param layer The ACL layer to build. Containing inputs, outputs and the ACL function.
-   * \param node The JSON representation of the operator.
+   * \param nid The id of the JSON node representing the operator.
    * \param mm The ACL conv2d layer can request auxiliary memory from TVM.
    */
-  void CreateConvolution2DLayer(CachedLayer* layer, const JSONGraphNode& node,
+  void CreateConvolution2DLayer(CachedLayer* layer, uint32_t nid,
                                 const std::shared_ptr<arm_compute::MemoryManagerOnDemand>& mm) {
+    const JSONGraphNode& node = nodes_[nid];
     std::vector<std::string> padding = node.GetAttr<std::vector<std::string>>("padding");
     std::vector<std::string> strides = node.GetAttr<std::vector<std::string>>("strides");
     std::vector<std::string> dilation = node.GetAttr<std::vector<std::string>>("dilation");
@@ -243,7 +322,7 @@ class ACLRuntime : public JSONRuntimeBase {
         layer->inputs.push_back(MakeACLTensorFromJSONEntry(inputs[6]));
       }
       layer->outputs.push_back(
-          MakeACLTensorFromJSONNode(node, &inputs[6 + has_bias], &inputs[7 + has_bias]));
+          MakeACLOutputTensor(nid, &inputs[6 + has_bias], &inputs[7 + has_bias]));
     } else {
       CHECK(num_inputs >= 2U && num_inputs <= 3U)
           << "Convolution requires 3 inputs with a bias, 2 inputs without.";
@@ -251,12 +330,13 @@ class ACLRuntime : public JSONRuntimeBase {
       for (const auto& i : inputs) {
         layer->inputs.push_back(MakeACLTensorFromJSONEntry(i));
       }
-      layer->outputs.push_back(MakeACLTensorFromJSONNode(node));
+      layer->outputs.push_back(MakeACLOutputTensor(nid));
     }
 
     auto function = std::make_shared<arm_compute::NEConvolutionLayer>(mm);
-    function->configure(&layer->inputs[0], &layer->inputs[1],
-                        has_bias ? &layer->inputs[2] : nullptr, &layer->outputs[0], pad_stride_info,
+    function->configure(layer->inputs[0].get(), layer->inputs[1].get(),
+                        has_bias ? layer->inputs[2].get() : nullptr, layer->outputs[0].get(),
+                        pad_stride_info,
                         arm_compute::WeightsInfo(), dilation_2d, act_info);
     layer->function = function;
   }
@@ -265,11 +345,12 @@ class ACLRuntime : public JSONRuntimeBase {
    * \brief Create a fully connected (dense) layer.
    *
    * \param layer The ACL layer to build. Containing inputs, outputs and the ACL function.
-   * \param node The JSON representation of the operator.
+   * \param nid The id of the JSON node representing the operator.
    * \param mm The ACL fully connected layer can request auxiliary memory from TVM.
    */
-  void CreateFullyConnectedLayer(CachedLayer* layer, const JSONGraphNode& node,
+  void CreateFullyConnectedLayer(CachedLayer* layer, uint32_t nid,
                                  const std::shared_ptr<arm_compute::MemoryManagerOnDemand>& mm) {
+    const JSONGraphNode& node = nodes_[nid];
     arm_compute::FullyConnectedLayerInfo fc_info;
     fc_info.set_weights_trained_layout(arm_compute::DataLayout::NHWC);
 
@@ -288,7 +369,7 @@ class ACLRuntime : public JSONRuntimeBase {
         layer->inputs.push_back(MakeACLTensorFromJSONEntry(inputs[6]));
       }
       layer->outputs.push_back(
-          MakeACLTensorFromJSONNode(node, &inputs[6 + has_bias], &inputs[7 + has_bias]));
+          MakeACLOutputTensor(nid, &inputs[6 + has_bias], &inputs[7 + has_bias]));
     } else {
       CHECK(num_inputs >= 2U && num_inputs <= 3U)
           << "Fully connected (dense) layer requires 3 inputs with a bias, 2 inputs without.";
@@ -296,12 +377,13 @@ class ACLRuntime : public JSONRuntimeBase {
       for (const auto& i : inputs) {
         layer->inputs.push_back(MakeACLTensorFromJSONEntry(i));
       }
-      layer->outputs.push_back(MakeACLTensorFromJSONNode(node));
+      layer->outputs.push_back(MakeACLOutputTensor(nid));
     }
 
     auto function = std::make_shared<arm_compute::NEFullyConnectedLayer>(mm);
-    function->configure(&layer->inputs[0], &layer->inputs[1],
-                        has_bias ? &layer->inputs[2] : nullptr, &layer->outputs[0], fc_info);
+    function->configure(layer->inputs[0].get(), layer->inputs[1].get(),
+                        has_bias ? layer->inputs[2].get() : nullptr, layer->outputs[0].get(),
+                        fc_info);
     layer->function = function;
   }
 
@@ -311,9 +393,10 @@ class ACLRuntime : public JSONRuntimeBase {
    * \note Currently only maxpool is supported.
    *
    * \param layer The ACL layer to build. Containing inputs, outputs and the ACL function.
-   * \param node The JSON representation of the operator.
+   * \param nid The id of the JSON node representing the operator.
    */
-  void CreatePoolingLayer(CachedLayer* layer, const JSONGraphNode& node) {
+  void CreatePoolingLayer(CachedLayer* layer, uint32_t nid) {
+    const JSONGraphNode& node = nodes_[nid];
     std::vector<std::string> padding = node.GetAttr<std::vector<std::string>>("padding");
     std::vector<std::string> strides = node.GetAttr<std::vector<std::string>>("strides");
     arm_compute::PadStrideInfo pad_stride_info = MakeACLPadStride(padding, strides);
@@ -334,10 +417,10 @@ class ACLRuntime : public JSONRuntimeBase {
                                       arm_compute::DataLayout::NHWC, pad_stride_info);
 
     layer->inputs.push_back(MakeACLTensorFromJSONEntry(node.GetInputs()[0]));
-    layer->outputs.push_back(MakeACLTensorFromJSONNode(node));
+    layer->outputs.push_back(MakeACLOutputTensor(nid));
 
     auto function = std::make_shared<arm_compute::NEPoolingLayer>();
-    function->configure(&layer->inputs[0], &layer->outputs[0], pool_info);
+    function->configure(layer->inputs[0].get(), layer->outputs[0].get(), pool_info);
     layer->function = function;
   }
 
@@ -345,23 +428,33 @@ class ACLRuntime : public JSONRuntimeBase {
    * \brief Create a reshape layer.
    *
    * \param layer The ACL layer to build. Containing inputs, outputs and the ACL function.
-   * \param node The JSON representation of the operator.
+   * \param nid The id of the JSON node representing the operator.
    */
-  void CreateReshapeLayer(CachedLayer* layer, const JSONGraphNode& node) {
+  void CreateReshapeLayer(CachedLayer* layer, uint32_t nid) {
+    const JSONGraphNode& node = nodes_[nid];
     layer->inputs.push_back(MakeACLTensorFromJSONEntry(node.GetInputs()[0]));
-    layer->outputs.push_back(MakeACLTensorFromJSONNode(node));
+    layer->outputs.push_back(MakeACLOutputTensor(nid));
     auto function = std::make_shared<arm_compute::NEReshapeLayer>();
-    function->configure(&layer->inputs[0], &layer->outputs[0]);
+    function->configure(layer->inputs[0].get(), layer->outputs[0].get());
     layer->function = function;
   }
 
   /*! \brief Allow ACL functions to request auxiliary memory from TVM. */
   ACLAllocator allocator_;
-  /*!
-   * \brief The network layers represented by acl functions.
-   * \note Currently only supports a single layer.
-   */
-  CachedLayer layer_;
+  /*! \brief Memory manager for the auxiliary memory used inside each layer. */
+  std::shared_ptr<arm_compute::MemoryManagerOnDemand> intra_mm_;
+  /*! \brief Memory manager for the intermediate tensors passed between layers. */
+  std::shared_ptr<arm_compute::MemoryManagerOnDemand> cross_mm_;
+  /*! \brief The memory group owning the intermediate tensors, backed by cross_mm_. */
+  arm_compute::MemoryGroup memory_group_;
+  /*! \brief The ACL tensor for each entry used by the layers. */
+  std::unordered_map<uint32_t, std::shared_ptr<arm_compute::Tensor>> tensors_;
+  /*! \brief Managed intermediate tensors whose lifetime has not ended yet. */
+  std::unordered_map<uint32_t, std::shared_ptr<arm_compute::Tensor>> managed_;
+  /*! \brief Whether any intermediate tensor is managed by memory_group_. */
+  bool has_managed_tensors_ = false;
+  /*! \brief The network layers represented by acl functions, in execution order. */
+  std::vector<CachedLayer> layers_;
 #else
   void Run() override {
     LOG(FATAL) << "Cannot call run on Arm Compute Library module without runtime enabled. "
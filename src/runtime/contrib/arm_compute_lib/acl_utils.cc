@@ -38,15 +38,15 @@ void CheckACLError(const arm_compute::Status& status) {
   CHECK(status.error_code() == arm_compute::ErrorCode::OK) << "ACL: " << status.error_description();
 }
 
-arm_compute::Tensor MakeACLTensor(const JSONGraphNode& tensor_rep, void* data,
-                                  const DLTensor* scale, const DLTensor* offset) {
-  arm_compute::Tensor tensor;
+std::shared_ptr<arm_compute::Tensor> MakeACLTensor(const JSONGraphNode& tensor_rep, void* data,
+                                                   const DLTensor* scale, const DLTensor* offset) {
+  auto tensor = std::make_shared<arm_compute::Tensor>();
   std::vector<int64_t> shape = tensor_rep.GetOpShape()[0];
   DLDataType dtype = tensor_rep.GetOpDataType()[0];
   arm_compute::TensorInfo info = MakeACLTensorInfo(shape, dtype, scale, offset);
-  tensor.allocator()->init(info);
+  tensor->allocator()->init(info);
   if (data != nullptr) {
-    CheckACLError(tensor.allocator()->import_memory(data));
+    CheckACLError(tensor->allocator()->import_memory(data));
   }
   return tensor;
 }
@@ -60,11 +60,13 @@ void CheckACLError(const arm_compute::Status& status);
  * \param data (optional) Initialize the tensor with memory.
  * \param scale (optional) The quantization scale.
  * \param offset (optional) The quantization offset.
- * \return arm_compute::Tensor.
+ * \return arm_compute::Tensor, heap allocated since a tensor's allocator keeps a
+ * pointer to its owner and so it must not be moved once memory is managed.
  */
-arm_compute::Tensor MakeACLTensor(const JSONGraphNode& tensor_rep, void* data = nullptr,
-                                  const DLTensor* scale = nullptr,
-                                  const DLTensor* offset = nullptr);
+std::shared_ptr<arm_compute::Tensor> MakeACLTensor(const JSONGraphNode& tensor_rep,
+                                                   void* data = nullptr,
+                                                   const DLTensor* scale = nullptr,
+                                                   const DLTensor* offset = nullptr);
 
 /*!
  * \brief Make an acl tensor info object from JSON tensor
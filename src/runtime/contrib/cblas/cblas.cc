@@ -28,6 +28,7 @@ extern "C" {
 #include <cblas.h>
 }
 
+#include "../external_threading.h"
 #include "gemm_common.h"
 
 namespace tvm {
@@ -39,6 +40,18 @@ inline CBLAS_TRANSPOSE BooleanToTranspose(bool trans) { return trans ? CblasTran
 
 inline char BooleanToTransposeChar(bool trans) { return trans ? 'T' : 'N'; }
 
+/*!
+ * \brief Size the OpenBLAS threads like the TVM thread pool. OpenBLAS only has
+ *  a process wide setting, so it is updated when it differs. Other BLAS
+ *  libraries keep their own configuration.
+ */
+inline void ConfigBlasThreads() {
+#ifdef OPENBLAS_VERSION
+  int nthreads = runtime::contrib::ExternalNumThreads();
+  if (openblas_get_num_threads() != nthreads) openblas_set_num_threads(nthreads);
+#endif
+}
+
 struct CblasSgemmOp {
   typedef float TDatatype;
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, float* A, int lda, float* B,
@@ -123,6 +136,7 @@ struct CblasDgemmBatchIterativeOp {
 
 // matrix multiplication for row major
 TVM_REGISTER_GLOBAL("tvm.contrib.cblas.matmul").set_body([](TVMArgs args, TVMRetValue* ret) {
+  ConfigBlasThreads();
   DLTensor* A = args[0];
   CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
 
@@ -133,6 +147,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.cblas.matmul").set_body([](TVMArgs args, TVMRet
 });
 
 TVM_REGISTER_GLOBAL("tvm.contrib.cblas.batch_matmul").set_body([](TVMArgs args, TVMRetValue* ret) {
+  ConfigBlasThreads();
   DLTensor* A = args[0];
   CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
   if (TypeMatch(A->dtype, kDLFloat, 32)) {
@@ -144,6 +159,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.cblas.batch_matmul").set_body([](TVMArgs args,
 
 TVM_REGISTER_GLOBAL("tvm.contrib.cblas.batch_matmul_iterative")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
+      ConfigBlasThreads();
       DLTensor* A = args[0];
       CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
       if (TypeMatch(A->dtype, kDLFloat, 32)) {
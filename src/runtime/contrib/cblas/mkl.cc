@@ -28,6 +28,9 @@ extern "C" {
 #include <mkl_cblas.h>
 }
 
+#include <mkl_service.h>
+
+#include "../external_threading.h"
 #include "gemm_common.h"
 
 namespace tvm {
@@ -52,6 +55,16 @@ inline CBLAS_OFFSET StringToOffset(const std::string offset_type) {
 
 inline char BooleanToTransposeChar(bool trans) { return trans ? 'T' : 'N'; }
 
+/*! \brief Size the MKL threads of the calling thread like the TVM thread pool during a call. */
+class MKLThreadsScope {
+ public:
+  MKLThreadsScope() : prev_(mkl_set_num_threads_local(runtime::contrib::ExternalNumThreads())) {}
+  ~MKLThreadsScope() { mkl_set_num_threads_local(prev_); }
+
+ private:
+  int prev_;
+};
+
 struct MKLGemmU8S8S32Op {
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, const void* A, int lda,
                   int offset_a, const void* B, int ldb, int offset_b, float beta, int* C, int ldc,
@@ -154,6 +167,7 @@ struct MKLDgemmBatchIterativeOp {
 
 // matrix multiplication for row major
 TVM_REGISTER_GLOBAL("tvm.contrib.mkl.matmul").set_body([](TVMArgs args, TVMRetValue* ret) {
+  MKLThreadsScope threads;
   DLTensor* A = args[0];
   CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
 
@@ -165,6 +179,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.mkl.matmul").set_body([](TVMArgs args, TVMRetVa
 
 // integer matrix multiplication for row major
 TVM_REGISTER_GLOBAL("tvm.contrib.mkl.matmul_u8s8s32").set_body([](TVMArgs args, TVMRetValue* ret) {
+  MKLThreadsScope threads;
   DLTensor* A = args[0];
   DLTensor* B = args[1];
   DLTensor* C = args[2];
@@ -175,6 +190,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.mkl.matmul_u8s8s32").set_body([](TVMArgs args,
 });
 
 TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul").set_body([](TVMArgs args, TVMRetValue* ret) {
+  MKLThreadsScope threads;
   DLTensor* A = args[0];
   CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
   if (TypeMatch(A->dtype, kDLFloat, 32)) {
@@ -186,6 +202,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul").set_body([](TVMArgs args, TV
 
 TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul_iterative")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
+      MKLThreadsScope threads;
       DLTensor* A = args[0];
       CHECK(TypeMatch(A->dtype, kDLFloat, 32) || TypeMatch(A->dtype, kDLFloat, 64));
       if (TypeMatch(A->dtype, kDLFloat, 32)) {
@@ -28,6 +28,7 @@ extern "C" {
 #include <dnnl.h>
 }
 
+#include "../dnnl/dnnl_threading.h"
 #include "gemm_common.h"
 
 namespace tvm {
@@ -41,8 +42,15 @@ struct MKLDNNSgemmOp {
   typedef float TDatatype;
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, float* A, int lda, float* B,
                   int ldb, float beta, float* C, int ldc) {
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+    dnnl_threadpool_interop_sgemm(BooleanToTransposeChar(tb), BooleanToTransposeChar(ta), N, M, K,
+                                  alpha, B, ldb, A, lda, beta, C, ldc,
+                                  runtime::contrib::DNNLThreadPool::Global());
+#else
+    runtime::contrib::DNNLThreadsScope threads;
     dnnl_sgemm(BooleanToTransposeChar(tb), BooleanToTransposeChar(ta), N, M, K, alpha, B, ldb, A,
                lda, beta, C, ldc);
+#endif
   }
 };
 
@@ -22,8 +22,13 @@
  */
 #include <dmlc/logging.h>
 #include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <sstream>
+#include <string>
+
+#include "../../cuda/cuda_common.h"
 #include "../cblas/gemm_common.h"
 #include "cublas_utils.h"
 
@@ -202,7 +207,208 @@ inline void CallLtIgemm(TVMArgs args, TVMRetValue* ret, cublasLtHandle_t hdl) {
   CHECK_CUBLAS_ERROR(cublasLtMatmul(hdl, operationDesc, &alpha, B_data, Adesc, A_data, Bdesc, &beta,
                                     C_data, Cdesc, C_data, Cdesc, NULL, NULL, 0, 0));
 }
+
+/*! \brief Activation fused after the matmul of tvm.contrib.cublaslt.dense. */
+enum CuBlasLtActivation { kCuBlasLtNone = 0, kCuBlasLtRelu = 1, kCuBlasLtGelu = 2 };
+
+/*! \brief Workspace offered to the cuBLASLt algorithm heuristic. */
+constexpr size_t kCuBlasLtMaxWorkspace = 32 << 20;
+
+inline void SetLayoutOrder(cublasLtMatrixLayout_t desc, cublasLtOrder_t order) {
+  CHECK_CUBLAS_ERROR(
+      cublasLtMatrixLayoutSetAttribute(desc, CUBLASLT_MATRIX_LAYOUT_ORDER, &order, sizeof(order)));
+}
+
+/*!
+ * \brief Build the descriptors of an int8 dense on tensor cores (IMMA). The data
+ *  is transformed to COL32, the weight to COL4_4R2_8C, and the COL32 int32
+ *  result back to row-major.
+ */
+void InitLtIgemmDensePlan(CuBlasLtDensePlan* plan, int M, int N, int K) {
+#if CUDART_VERSION >= 11000
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&plan->op_desc, CUBLAS_COMPUTE_32I, CUDA_R_32I));
+#else
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&plan->op_desc, CUDA_R_32I));
 #endif
+  cublasOperation_t op_transpose = CUBLAS_OP_T;
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(plan->op_desc, CUBLASLT_MATMUL_DESC_TRANSB,
+                                                    &op_transpose, sizeof(op_transpose)));
+  // The row-major tensors as TVM stores them: data [M, K], weight [N, K], out [M, N].
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->a_row_desc, CUDA_R_8I, M, K, K));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->b_row_desc, CUDA_R_8I, N, K, K));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->c_row_desc, CUDA_R_32I, M, N, N));
+  SetLayoutOrder(plan->a_row_desc, CUBLASLT_ORDER_ROW);
+  SetLayoutOrder(plan->b_row_desc, CUBLASLT_ORDER_ROW);
+  SetLayoutOrder(plan->c_row_desc, CUBLASLT_ORDER_ROW);
+  // The same tensors in the layouts IMMA kernels require.
+  int lda = 32 * M;
+  int ldb = 32 * roundoff(N, 8);
+  int ldc = 32 * M;
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->a_desc, CUDA_R_8I, M, K, lda));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->b_desc, CUDA_R_8I, N, K, ldb));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->c_desc, CUDA_R_32I, M, N, ldc));
+  SetLayoutOrder(plan->a_desc, CUBLASLT_ORDER_COL32);
+  SetLayoutOrder(plan->b_desc, CUBLASLT_ORDER_COL4_4R2_8C);
+  SetLayoutOrder(plan->c_desc, CUBLASLT_ORDER_COL32);
+  plan->a_bytes = static_cast<size_t>(lda) * (roundoff(K, 32) / 32);
+  plan->b_bytes = static_cast<size_t>(ldb) * (roundoff(K, 32) / 32);
+  plan->c_bytes = static_cast<size_t>(ldc) * (roundoff(N, 32) / 32) * sizeof(int32_t);
+  CHECK_CUBLAS_ERROR(cublasLtMatrixTransformDescCreate(&plan->transform_desc, CUDA_R_32F));
+}
+
+/*!
+ * \brief Build the descriptors of a floating point dense with a fused epilogue.
+ *  In column-major terms it computes out^T [N, M] = weight [N, K] * data^T [K, M],
+ *  so the bias runs along the rows of the result as cuBLASLt expects.
+ */
+void InitLtGemmDensePlan(CuBlasLtDensePlan* plan, cudaDataType_t dtype, int M, int N, int K,
+                         int activation, bool has_bias) {
+#if CUDART_VERSION >= 11000
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&plan->op_desc, CUBLAS_COMPUTE_32F, CUDA_R_32F));
+#else
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&plan->op_desc, CUDA_R_32F));
+#endif
+  cublasOperation_t op_transpose = CUBLAS_OP_T;
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(plan->op_desc, CUBLASLT_MATMUL_DESC_TRANSA,
+                                                    &op_transpose, sizeof(op_transpose)));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->a_desc, dtype, K, N, K));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->b_desc, dtype, K, M, K));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&plan->c_desc, dtype, N, M, N));
+#if CUDART_VERSION >= 11000
+  cublasLtEpilogue_t epilogue = has_bias ? CUBLASLT_EPILOGUE_BIAS : CUBLASLT_EPILOGUE_DEFAULT;
+  if (activation == kCuBlasLtRelu) {
+    epilogue = has_bias ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_RELU;
+  } else if (activation == kCuBlasLtGelu) {
+#if CUDART_VERSION >= 11030
+    epilogue = has_bias ? CUBLASLT_EPILOGUE_GELU_BIAS : CUBLASLT_EPILOGUE_GELU;
+#else
+    LOG(FATAL) << "The cuBLASLt GELU epilogue requires CUDA 11.3 or later";
+#endif
+  }
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(plan->op_desc, CUBLASLT_MATMUL_DESC_EPILOGUE,
+                                                    &epilogue, sizeof(epilogue)));
+#else
+  CHECK(activation == kCuBlasLtNone && !has_bias)
+      << "cuBLASLt bias and activation epilogues require CUDA 11.0 or later";
+#endif
+}
+
+/*!
+ * \brief Get the plan of a dense configuration, building it and querying the
+ *  algorithm heuristic on first use.
+ */
+CuBlasLtDensePlan* GetLtDensePlan(CuBlasLtThreadEntry* entry, DLTensor* A, DLTensor* B,
+                                  DLTensor* C, int activation, bool has_bias) {
+  int M = static_cast<int>(A->shape[0]);
+  int K = static_cast<int>(A->shape[1]);
+  int N = static_cast<int>(B->shape[0]);
+  std::ostringstream os;
+  os << DLDataType2String(A->dtype) << "_" << DLDataType2String(C->dtype) << "_" << M << "_" << N
+     << "_" << K << "_" << activation << "_" << has_bias << "_" << A->ctx.device_id;
+  std::string key = os.str();
+  auto it = entry->dense_plans.find(key);
+  if (it != entry->dense_plans.end()) return it->second.get();
+
+  std::unique_ptr<CuBlasLtDensePlan> plan(new CuBlasLtDensePlan());
+  if (TypeMatch(A->dtype, kDLInt, 8)) {
+    CHECK(TypeMatch(C->dtype, kDLInt, 32)) << "int8 dense on cuBLASLt produces int32";
+    CHECK(activation == kCuBlasLtNone && !has_bias)
+        << "int8 dense on cuBLASLt does not support epilogues";
+    InitLtIgemmDensePlan(plan.get(), M, N, K);
+  } else {
+    CHECK(TypeMatch(A->dtype, kDLFloat, 16) || TypeMatch(A->dtype, kDLFloat, 32));
+    CHECK(TypeEqual(A->dtype, C->dtype)) << "Mixed precision is not supported";
+    InitLtGemmDensePlan(plan.get(), GetCudaDataType(A->dtype), M, N, K, activation, has_bias);
+  }
+
+  cublasLtMatmulPreference_t preference = nullptr;
+  uint64_t max_workspace = kCuBlasLtMaxWorkspace;
+  CHECK_CUBLAS_ERROR(cublasLtMatmulPreferenceCreate(&preference));
+  CHECK_CUBLAS_ERROR(cublasLtMatmulPreferenceSetAttribute(
+      preference, CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, &max_workspace, sizeof(max_workspace)));
+  cublasLtMatmulHeuristicResult_t result;
+  int returned_results = 0;
+  CHECK_CUBLAS_ERROR(cublasLtMatmulAlgoGetHeuristic(entry->handle, plan->op_desc, plan->a_desc,
+                                                    plan->b_desc, plan->c_desc, plan->c_desc,
+                                                    preference, 1, &result, &returned_results));
+  CHECK_CUBLAS_ERROR(cublasLtMatmulPreferenceDestroy(preference));
+  CHECK_GT(returned_results, 0) << "cuBLASLt has no algorithm for dense " << key;
+  plan->algo = result.algo;
+  plan->workspace_size = result.workspaceSize;
+
+  CuBlasLtDensePlan* ptr = plan.get();
+  entry->dense_plans[key] = std::move(plan);
+  return ptr;
+}
+
+// Dense of row-major data [M, K] and weight [N, K] with an optional fused bias
+// and activation: args are data, weight, out, activation and then the bias, if any.
+inline void CallLtDense(TVMArgs args, TVMRetValue* ret) {
+  DLTensor* A = args[0];
+  DLTensor* B = args[1];
+  DLTensor* C = args[2];
+  int activation = args[3];
+  DLTensor* bias = args.size() > 4 ? static_cast<DLTensor*>(args[4]) : nullptr;
+  CHECK_EQ(A->ndim, 2);
+  CHECK_EQ(B->ndim, 2);
+  CHECK_EQ(C->ndim, 2);
+  CHECK_EQ(A->shape[1], B->shape[1]);
+  CHECK_EQ(ElementStride(A), 1);
+  CHECK_EQ(ElementStride(B), 1);
+  CHECK_EQ(ElementStride(C), 1);
+  CHECK(TypeEqual(A->dtype, B->dtype));
+
+  CuBlasLtThreadEntry* entry = CuBlasLtThreadEntry::ThreadLocal();
+  CuBlasLtDensePlan* plan = GetLtDensePlan(entry, A, B, C, activation, bias != nullptr);
+  cudaStream_t stream = static_cast<cudaStream_t>(CUDAThreadEntry::ThreadLocal()->stream);
+  DeviceAPI* api = DeviceAPI::Get(A->ctx);
+  auto A_data = reinterpret_cast<void*>(static_cast<char*>(A->data) + A->byte_offset);
+  auto B_data = reinterpret_cast<void*>(static_cast<char*>(B->data) + B->byte_offset);
+  auto C_data = reinterpret_cast<void*>(static_cast<char*>(C->data) + C->byte_offset);
+  void* workspace =
+      plan->workspace_size > 0 ? api->AllocWorkspace(A->ctx, plan->workspace_size) : nullptr;
+
+  if (plan->transform_desc) {
+    void* A_t = api->AllocWorkspace(A->ctx, plan->a_bytes);
+    void* B_t = api->AllocWorkspace(A->ctx, plan->b_bytes);
+    void* C_t = api->AllocWorkspace(A->ctx, plan->c_bytes);
+    float transform_alpha = 1.0f, transform_beta = 0.0f;
+    CHECK_CUBLAS_ERROR(cublasLtMatrixTransform(
+        entry->handle, plan->transform_desc, &transform_alpha, A_data, plan->a_row_desc,
+        &transform_beta, nullptr, nullptr, A_t, plan->a_desc, stream));
+    CHECK_CUBLAS_ERROR(cublasLtMatrixTransform(
+        entry->handle, plan->transform_desc, &transform_alpha, B_data, plan->b_row_desc,
+        &transform_beta, nullptr, nullptr, B_t, plan->b_desc, stream));
+    int32_t alpha = 1, beta = 0;
+    CHECK_CUBLAS_ERROR(cublasLtMatmul(entry->handle, plan->op_desc, &alpha, A_t, plan->a_desc, B_t,
+                                      plan->b_desc, &beta, C_t, plan->c_desc, C_t, plan->c_desc,
+                                      &plan->algo, workspace, plan->workspace_size, stream));
+    CHECK_CUBLAS_ERROR(cublasLtMatrixTransform(
+        entry->handle, plan->transform_desc, &transform_alpha, C_t, plan->c_desc, &transform_beta,
+        nullptr, nullptr, C_data, plan->c_row_desc, stream));
+    api->FreeWorkspace(A->ctx, C_t);
+    api->FreeWorkspace(A->ctx, B_t);
+    api->FreeWorkspace(A->ctx, A_t);
+  } else {
+#if CUDART_VERSION >= 11000
+    if (bias != nullptr) {
+      CHECK_EQ(bias->ndim, 1);
+      CHECK_EQ(bias->shape[0], B->shape[0]);
+      CHECK(TypeEqual(bias->dtype, C->dtype));
+      void* bias_data = static_cast<char*>(bias->data) + bias->byte_offset;
+      CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(
+          plan->op_desc, CUBLASLT_MATMUL_DESC_BIAS_POINTER, &bias_data, sizeof(bias_data)));
+    }
+#endif
+    float alpha = 1.0f, beta = 0.0f;
+    CHECK_CUBLAS_ERROR(cublasLtMatmul(entry->handle, plan->op_desc, &alpha, B_data, plan->a_desc,
+                                      A_data, plan->b_desc, &beta, C_data, plan->c_desc, C_data,
+                                      plan->c_desc, &plan->algo, workspace, plan->workspace_size,
+                                      stream));
+  }
+  if (workspace != nullptr) api->FreeWorkspace(A->ctx, workspace);
+}
+#endif  // CUDART_VERSION >= 10010
 
 inline void CallGemmEx(TVMArgs args, TVMRetValue* ret, cublasHandle_t hdl) {
   DLTensor* A = args[0];
@@ -358,11 +564,25 @@ TVM_REGISTER_GLOBAL("tvm.contrib.cublaslt.matmul").set_body([](TVMArgs args, TVM
   TryEnableTensorCore(entry_ptr->handle);
 
   CHECK(TypeMatch(A->dtype, kDLInt, 8)) << "Expects dtype to be int8\n";
-  cublasLtHandle_t ltHandle;
-  CHECK_CUBLAS_ERROR(cublasLtCreate(&ltHandle));
-  CallLtIgemm(args, ret, ltHandle);
-  CHECK_CUBLAS_ERROR(cublasLtDestroy(ltHandle));
+  CallLtIgemm(args, ret, CuBlasLtThreadEntry::ThreadLocal()->handle);
+});
+
+TVM_REGISTER_GLOBAL("tvm.contrib.cublaslt.dense").set_body([](TVMArgs args, TVMRetValue* ret) {
+  CallLtDense(args, ret);
 });
+
+// Whether this build of cuBLASLt can fuse the given activation and bias into the dense.
+TVM_REGISTER_GLOBAL("tvm.contrib.cublaslt.supports_epilogue")
+    .set_body_typed([](int activation, bool has_bias) {
+      if (activation == kCuBlasLtNone && !has_bias) return true;
+#if CUDART_VERSION >= 11030
+      return true;
+#elif CUDART_VERSION >= 11000
+      return activation != kCuBlasLtGelu;
+#else
+      return false;
+#endif
+    });
 #endif  // CUDART_VERSION >= 10010
 
 TVM_REGISTER_GLOBAL("tvm.contrib.cublas.batch_matmul").set_body([](TVMArgs args, TVMRetValue* ret) {
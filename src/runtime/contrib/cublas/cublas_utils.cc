@@ -48,5 +48,29 @@ CuBlasThreadEntry* CuBlasThreadEntry::ThreadLocal() {
   return retval;
 }
 
+#if CUDART_VERSION >= 10010
+CuBlasLtDensePlan::~CuBlasLtDensePlan() {
+  if (transform_desc) cublasLtMatrixTransformDescDestroy(transform_desc);
+  for (cublasLtMatrixLayout_t desc : {a_desc, b_desc, c_desc, a_row_desc, b_row_desc, c_row_desc}) {
+    if (desc) cublasLtMatrixLayoutDestroy(desc);
+  }
+  if (op_desc) cublasLtMatmulDescDestroy(op_desc);
+}
+
+CuBlasLtThreadEntry::CuBlasLtThreadEntry() { CHECK_CUBLAS_ERROR(cublasLtCreate(&handle)); }
+
+CuBlasLtThreadEntry::~CuBlasLtThreadEntry() {
+  dense_plans.clear();
+  if (handle) {
+    cublasLtDestroy(handle);
+    handle = nullptr;
+  }
+}
+
+typedef dmlc::ThreadLocalStore<CuBlasLtThreadEntry> CuBlasLtThreadStore;
+
+CuBlasLtThreadEntry* CuBlasLtThreadEntry::ThreadLocal() { return CuBlasLtThreadStore::Get(); }
+#endif  // CUDART_VERSION >= 10010
+
 }  // namespace contrib
 }  // namespace tvm
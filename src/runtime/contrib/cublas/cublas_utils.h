@@ -31,6 +31,9 @@
 #include <dmlc/logging.h>
 
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #if CUDART_VERSION >= 10010
 #include <cublasLt.h>
 #endif  // CUDART_VERSION >= 10010
@@ -77,6 +80,41 @@ struct CuBlasThreadEntry {
   static CuBlasThreadEntry* ThreadLocal();
 };  // CuBlasThreadEntry
 
+#if CUDART_VERSION >= 10010
+/*!
+ * \brief Descriptors and the heuristic algorithm of one cuBLASLt dense configuration.
+ *
+ *  For int8 the row-major tensors are transformed into the tensor core layouts
+ *  before the matmul and the result is transformed back, so the plan also holds
+ *  the row-major layouts and the sizes of the transformed buffers.
+ */
+struct CuBlasLtDensePlan {
+  cublasLtMatmulDesc_t op_desc{nullptr};
+  cublasLtMatrixLayout_t a_desc{nullptr};
+  cublasLtMatrixLayout_t b_desc{nullptr};
+  cublasLtMatrixLayout_t c_desc{nullptr};
+  cublasLtMatrixLayout_t a_row_desc{nullptr};
+  cublasLtMatrixLayout_t b_row_desc{nullptr};
+  cublasLtMatrixLayout_t c_row_desc{nullptr};
+  cublasLtMatrixTransformDesc_t transform_desc{nullptr};
+  size_t a_bytes{0};
+  size_t b_bytes{0};
+  size_t c_bytes{0};
+  cublasLtMatmulAlgo_t algo;
+  size_t workspace_size{0};
+  ~CuBlasLtDensePlan();
+};  // CuBlasLtDensePlan
+
+struct CuBlasLtThreadEntry {
+  CuBlasLtThreadEntry();
+  ~CuBlasLtThreadEntry();
+  cublasLtHandle_t handle{nullptr};
+  /*! \brief Dense plans keyed by shape, dtype and epilogue. */
+  std::unordered_map<std::string, std::unique_ptr<CuBlasLtDensePlan>> dense_plans;
+  static CuBlasLtThreadEntry* ThreadLocal();
+};  // CuBlasLtThreadEntry
+#endif  // CUDART_VERSION >= 10010
+
 inline cudaDataType_t GetCudaDataType(DLDataType type) {
   if (type.code == kDLInt) {
     switch (type.bits) {
@@ -24,6 +24,15 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
 #include "cudnn_utils.h"
 
 namespace tvm {
@@ -31,20 +40,17 @@ namespace contrib {
 
 using namespace runtime;
 
-void ConvolutionForward(int mode, int format, int algo, int dims, int groups, const int pad[],
+/*!
+ * \brief Fill the convolution, filter, input and output descriptors for a convolution.
+ */
+void SetConvDescriptors(int mode, int format, int dims, int groups, const int pad[],
                         const int stride[], const int dilation[], DLTensor* x, DLTensor* w,
-                        DLTensor* y, const std::string& conv_dtype) {
-  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
-  // Set Mode
-  entry_ptr->conv_entry.mode = static_cast<cudnnConvolutionMode_t>(mode);
-  // Set Format
-  entry_ptr->conv_entry.tensor_format = static_cast<cudnnTensorFormat_t>(format);
-  // Set Algo
-  entry_ptr->conv_entry.fwd_algo = static_cast<cudnnConvolutionFwdAlgo_t>(algo);
-  // Set Ctx
-  entry_ptr->conv_entry.ctx = x->ctx;
-  // Set Data Type
-  entry_ptr->conv_entry.data_type = CuDNNDataType::DLTypeToCuDNNType(String2DLDataType(conv_dtype));
+                        DLTensor* y, cudnnDataType_t conv_data_type,
+                        cudnnConvolutionDescriptor_t conv_desc,
+                        cudnnFilterDescriptor_t filter_desc, cudnnTensorDescriptor_t input_desc,
+                        cudnnTensorDescriptor_t output_desc) {
+  cudnnConvolutionMode_t conv_mode = static_cast<cudnnConvolutionMode_t>(mode);
+  cudnnTensorFormat_t tensor_format = static_cast<cudnnTensorFormat_t>(format);
   cudnnDataType_t data_type = CuDNNDataType::DLTypeToCuDNNType(x->dtype);
   // Dims includes N and C
   int full_dims = dims + 2;
@@ -55,14 +61,14 @@ void ConvolutionForward(int mode, int format, int algo, int dims, int groups, co
   // Note: For 2D tenor, using ND setters causes CUDNN_STATUS_NOT_SUPPORTED error
   // in following cudnnGetConvolutionForwardWorkspaceSize() when data type is fp16, int
 
-  CUDNN_CALL(cudnnSetConvolutionGroupCount(entry_ptr->conv_entry.conv_desc, groups));
+  CUDNN_CALL(cudnnSetConvolutionGroupCount(conv_desc, groups));
   if (dims == 2) {
     // Set Desc
-    CUDNN_CALL(cudnnSetConvolution2dDescriptor(
-        entry_ptr->conv_entry.conv_desc, pad[0], pad[1], stride[0], stride[1], dilation[0],
-        dilation[1], entry_ptr->conv_entry.mode, entry_ptr->conv_entry.data_type));
+    CUDNN_CALL(cudnnSetConvolution2dDescriptor(conv_desc, pad[0], pad[1], stride[0], stride[1],
+                                               dilation[0], dilation[1], conv_mode,
+                                               conv_data_type));
     int ni, ci, hi, wi;
-    if (entry_ptr->conv_entry.tensor_format == CUDNN_TENSOR_NHWC) {
+    if (tensor_format == CUDNN_TENSOR_NHWC) {
       ni = 0;
       ci = 3;
       hi = 1;
@@ -76,50 +82,231 @@ void ConvolutionForward(int mode, int format, int algo, int dims, int groups, co
 
     // Set Filter
     CUDNN_CALL(cudnnSetFilter4dDescriptor(
-        entry_ptr->conv_entry.filter_desc, data_type, entry_ptr->conv_entry.tensor_format,
-        static_cast<int>(w->shape[ni]), static_cast<int>(w->shape[ci]),
-        static_cast<int>(w->shape[hi]), static_cast<int>(w->shape[wi])));
+        filter_desc, data_type, tensor_format, static_cast<int>(w->shape[ni]),
+        static_cast<int>(w->shape[ci]), static_cast<int>(w->shape[hi]),
+        static_cast<int>(w->shape[wi])));
     // Set Input
     CUDNN_CALL(cudnnSetTensor4dDescriptor(
-        entry_ptr->conv_entry.input_desc, entry_ptr->conv_entry.tensor_format, data_type,
-        static_cast<int>(x->shape[ni]), static_cast<int>(x->shape[ci]),
-        static_cast<int>(x->shape[hi]), static_cast<int>(x->shape[wi])));
+        input_desc, tensor_format, data_type, static_cast<int>(x->shape[ni]),
+        static_cast<int>(x->shape[ci]), static_cast<int>(x->shape[hi]),
+        static_cast<int>(x->shape[wi])));
     // Set Output
     CUDNN_CALL(cudnnSetTensor4dDescriptor(
-        entry_ptr->conv_entry.output_desc, entry_ptr->conv_entry.tensor_format, data_type,
-        static_cast<int>(y->shape[ni]), static_cast<int>(y->shape[ci]),
-        static_cast<int>(y->shape[hi]), static_cast<int>(y->shape[wi])));
+        output_desc, tensor_format, data_type, static_cast<int>(y->shape[ni]),
+        static_cast<int>(y->shape[ci]), static_cast<int>(y->shape[hi]),
+        static_cast<int>(y->shape[wi])));
   } else {
-    CUDNN_CALL(cudnnSetConvolutionNdDescriptor(entry_ptr->conv_entry.conv_desc, dims, pad, stride,
-                                               dilation, entry_ptr->conv_entry.mode,
-                                               entry_ptr->conv_entry.data_type));
+    CUDNN_CALL(cudnnSetConvolutionNdDescriptor(conv_desc, dims, pad, stride, dilation, conv_mode,
+                                               conv_data_type));
 
     // Set Filter
     for (int i = 0; i < full_dims; i++) {
       dim[i] = static_cast<int>(w->shape[i]);
     }
-    CUDNN_CALL(cudnnSetFilterNdDescriptor(entry_ptr->conv_entry.filter_desc, data_type,
-                                          entry_ptr->conv_entry.tensor_format, full_dims,
-                                          dim.data()));
+    CUDNN_CALL(
+        cudnnSetFilterNdDescriptor(filter_desc, data_type, tensor_format, full_dims, dim.data()));
     // Set Input
     for (int i = 0; i < full_dims; i++) {
       dim[i] = static_cast<int>(x->shape[i]);
     }
     GetCudnnStride(full_dims, dim.data(), tensor_stride.data());
-    CUDNN_CALL(cudnnSetTensorNdDescriptor(entry_ptr->conv_entry.input_desc, data_type, full_dims,
-                                          dim.data(), tensor_stride.data()));
+    CUDNN_CALL(cudnnSetTensorNdDescriptor(input_desc, data_type, full_dims, dim.data(),
+                                          tensor_stride.data()));
     // Set Output
     for (int i = 0; i < full_dims; i++) {
       dim[i] = static_cast<int>(y->shape[i]);
     }
     GetCudnnStride(full_dims, dim.data(), tensor_stride.data());
-    CUDNN_CALL(cudnnSetTensorNdDescriptor(entry_ptr->conv_entry.output_desc, data_type, full_dims,
-                                          dim.data(), tensor_stride.data()));
+    CUDNN_CALL(cudnnSetTensorNdDescriptor(output_desc, data_type, full_dims, dim.data(),
+                                          tensor_stride.data()));
   }
 
   if (cudnnGetVersion() > 7000) {
-    CUDNN_CALL(cudnnSetConvolutionMathType(entry_ptr->conv_entry.conv_desc, CUDNN_TENSOR_OP_MATH))
+    CUDNN_CALL(cudnnSetConvolutionMathType(conv_desc, CUDNN_TENSOR_OP_MATH))
+  }
+}
+
+/*!
+ * \brief Upper bound of the workspace the runtime algorithm search may pick,
+ *  read from TVM_CUDNN_WORKSPACE_LIMIT in bytes. Defaults to 1GB.
+ */
+size_t ConvWorkspaceLimit() {
+  static size_t limit = []() -> size_t {
+    const char* val = getenv("TVM_CUDNN_WORKSPACE_LIMIT");
+    if (val == nullptr) return static_cast<size_t>(1) << 30;
+    return static_cast<size_t>(std::stoull(val));
+  }();
+  return limit;
+}
+
+/*!
+ * \brief Algorithms chosen by the runtime search, shared by all threads and kept
+ *  across processes in the file named by TVM_CUDNN_ALGO_CACHE, when it is set.
+ *
+ *  Each line of the file is "<configuration key> <algorithm index>".
+ */
+class ConvAlgoStore {
+ public:
+  static ConvAlgoStore* Global() {
+    static ConvAlgoStore* inst = new ConvAlgoStore();
+    return inst;
+  }
+
+  bool Lookup(const std::string& key, int* algo) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = algos_.find(key);
+    if (it == algos_.end()) return false;
+    *algo = it->second;
+    return true;
+  }
+
+  void Save(const std::string& key, int algo) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!algos_.emplace(key, algo).second || path_.empty()) return;
+    std::ofstream os(path_, std::ios::app);
+    if (os) os << key << " " << algo << "\n";
+  }
+
+ private:
+  ConvAlgoStore() {
+    const char* path = getenv("TVM_CUDNN_ALGO_CACHE");
+    if (path == nullptr) return;
+    path_ = path;
+    std::ifstream is(path_);
+    std::string key;
+    int algo;
+    while (is >> key >> algo) {
+      algos_[key] = algo;
+    }
+  }
+
+  std::mutex mutex_;
+  std::string path_;
+  std::unordered_map<std::string, int> algos_;
+};
+
+/*! \brief Key identifying a convolution configuration on a device. */
+std::string ConvKey(int mode, int format, int dims, int groups, const int pad[],
+                    const int stride[], const int dilation[], DLTensor* x, DLTensor* w,
+                    DLTensor* y, const std::string& conv_dtype) {
+  std::ostringstream os;
+  os << "m" << mode << "_f" << format << "_g" << groups << "_";
+  for (int i = 0; i < dims; ++i) {
+    os << pad[i] << "." << stride[i] << "." << dilation[i] << "_";
+  }
+  for (DLTensor* t : {x, w, y}) {
+    for (int i = 0; i < t->ndim; ++i) {
+      os << t->shape[i] << (i + 1 == t->ndim ? "_" : "x");
+    }
   }
+  os << DLDataType2String(x->dtype) << "_" << conv_dtype << "_dev" << x->ctx.device_id;
+  return os.str();
+}
+
+/*!
+ * \brief Benchmark the forward algorithms on the given buffers and return the
+ *  fastest one whose workspace fits within ConvWorkspaceLimit().
+ */
+cudnnConvolutionFwdAlgo_t SearchFwdAlgo(CuDNNThreadEntry* entry_ptr, ConvAlgoEntry* algo_entry,
+                                        DLTensor* x, DLTensor* w, DLTensor* y) {
+  size_t limit = ConvWorkspaceLimit();
+  size_t search_workspace = 0;
+  for (int i = 0; i < CUDNN_CONVOLUTION_FWD_ALGO_COUNT; ++i) {
+    size_t size = 0;
+    cudnnStatus_t status = cudnnGetConvolutionForwardWorkspaceSize(
+        entry_ptr->handle, algo_entry->input_desc, algo_entry->filter_desc, algo_entry->conv_desc,
+        algo_entry->output_desc, static_cast<cudnnConvolutionFwdAlgo_t>(i), &size);
+    if (status == CUDNN_STATUS_SUCCESS && size <= limit) {
+      search_workspace = std::max(search_workspace, size);
+    }
+  }
+  entry_ptr->conv_entry.UpdateWorkspace(search_workspace);
+
+  int returned_algo_count = 0;
+  cudnnConvolutionFwdAlgoPerf_t perf_results[CUDNN_CONVOLUTION_FWD_ALGO_COUNT];
+  // The search writes y, which is overwritten by the real convolution right after.
+  CUDNN_CALL(cudnnFindConvolutionForwardAlgorithmEx(
+      entry_ptr->handle, algo_entry->input_desc, x->data, algo_entry->filter_desc, w->data,
+      algo_entry->conv_desc, algo_entry->output_desc, y->data, CUDNN_CONVOLUTION_FWD_ALGO_COUNT,
+      &returned_algo_count, perf_results, entry_ptr->conv_entry.workspace, search_workspace));
+  // Results are sorted by time, so the first usable one is the fastest.
+  for (int i = 0; i < returned_algo_count; ++i) {
+    if (perf_results[i].status == CUDNN_STATUS_SUCCESS &&
+        perf_results[i].memory <= search_workspace) {
+      return perf_results[i].algo;
+    }
+  }
+  LOG(FATAL) << "cuDNN: no forward algorithm fits the workspace limit of " << limit << " bytes";
+  return CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_GEMM;
+}
+
+/*!
+ * \brief Convolution whose algorithm is chosen at runtime. The search runs once
+ *  per configuration; the descriptors, algorithm and workspace size are then cached.
+ */
+void ConvolutionForwardSearch(int mode, int format, int dims, int groups, const int pad[],
+                              const int stride[], const int dilation[], DLTensor* x, DLTensor* w,
+                              DLTensor* y, const std::string& conv_dtype) {
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  entry_ptr->conv_entry.ctx = x->ctx;
+  std::string key =
+      ConvKey(mode, format, dims, groups, pad, stride, dilation, x, w, y, conv_dtype);
+  ConvAlgoEntry* algo_entry;
+  auto it = entry_ptr->conv_algo_cache.find(key);
+  if (it != entry_ptr->conv_algo_cache.end()) {
+    algo_entry = it->second.get();
+  } else {
+    std::unique_ptr<ConvAlgoEntry> new_entry(new ConvAlgoEntry());
+    SetConvDescriptors(mode, format, dims, groups, pad, stride, dilation, x, w, y,
+                       CuDNNDataType::DLTypeToCuDNNType(String2DLDataType(conv_dtype)),
+                       new_entry->conv_desc, new_entry->filter_desc, new_entry->input_desc,
+                       new_entry->output_desc);
+    int algo;
+    if (ConvAlgoStore::Global()->Lookup(key, &algo)) {
+      new_entry->fwd_algo = static_cast<cudnnConvolutionFwdAlgo_t>(algo);
+    } else {
+      new_entry->fwd_algo = SearchFwdAlgo(entry_ptr, new_entry.get(), x, w, y);
+      ConvAlgoStore::Global()->Save(key, static_cast<int>(new_entry->fwd_algo));
+    }
+    CUDNN_CALL(cudnnGetConvolutionForwardWorkspaceSize(
+        entry_ptr->handle, new_entry->input_desc, new_entry->filter_desc, new_entry->conv_desc,
+        new_entry->output_desc, new_entry->fwd_algo, &new_entry->workspace_size));
+    algo_entry = new_entry.get();
+    entry_ptr->conv_algo_cache[key] = std::move(new_entry);
+  }
+
+  cudnnDataType_t conv_data_type = CuDNNDataType::DLTypeToCuDNNType(String2DLDataType(conv_dtype));
+  entry_ptr->conv_entry.UpdateWorkspace(algo_entry->workspace_size);
+  CUDNN_CALL(cudnnConvolutionForward(
+      entry_ptr->handle, CuDNNDataType::GetConst<1>(conv_data_type), algo_entry->input_desc,
+      x->data, algo_entry->filter_desc, w->data, algo_entry->conv_desc, algo_entry->fwd_algo,
+      entry_ptr->conv_entry.workspace, algo_entry->workspace_size,
+      CuDNNDataType::GetConst<0>(conv_data_type), algo_entry->output_desc, y->data));
+}
+
+void ConvolutionForward(int mode, int format, int algo, int dims, int groups, const int pad[],
+                        const int stride[], const int dilation[], DLTensor* x, DLTensor* w,
+                        DLTensor* y, const std::string& conv_dtype) {
+  if (algo < 0) {
+    ConvolutionForwardSearch(mode, format, dims, groups, pad, stride, dilation, x, w, y,
+                             conv_dtype);
+    return;
+  }
+  CuDNNThreadEntry* entry_ptr = CuDNNThreadEntry::ThreadLocal();
+  // Set Mode
+  entry_ptr->conv_entry.mode = static_cast<cudnnConvolutionMode_t>(mode);
+  // Set Format
+  entry_ptr->conv_entry.tensor_format = static_cast<cudnnTensorFormat_t>(format);
+  // Set Algo
+  entry_ptr->conv_entry.fwd_algo = static_cast<cudnnConvolutionFwdAlgo_t>(algo);
+  // Set Ctx
+  entry_ptr->conv_entry.ctx = x->ctx;
+  // Set Data Type
+  entry_ptr->conv_entry.data_type = CuDNNDataType::DLTypeToCuDNNType(String2DLDataType(conv_dtype));
+  SetConvDescriptors(mode, format, dims, groups, pad, stride, dilation, x, w, y,
+                     entry_ptr->conv_entry.data_type, entry_ptr->conv_entry.conv_desc,
+                     entry_ptr->conv_entry.filter_desc, entry_ptr->conv_entry.input_desc,
+                     entry_ptr->conv_entry.output_desc);
 
   // Set workspace
   size_t workspace_size = 0;
@@ -28,6 +28,10 @@
 #include <dmlc/logging.h>
 #include <tvm/runtime/device_api.h>
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "../../cuda/cuda_common.h"
 
 namespace tvm {
@@ -82,6 +86,21 @@ struct ConvEntry {
   void CleanWorkspace();
 };  // ConvThreadEntry
 
+/*!
+ * \brief Descriptors and the chosen forward algorithm of one convolution
+ *  configuration, built once and reused by every later call with that configuration.
+ */
+struct ConvAlgoEntry {
+  cudnnConvolutionDescriptor_t conv_desc;
+  cudnnFilterDescriptor_t filter_desc;
+  cudnnTensorDescriptor_t input_desc;
+  cudnnTensorDescriptor_t output_desc;
+  cudnnConvolutionFwdAlgo_t fwd_algo;
+  size_t workspace_size{0};
+  ConvAlgoEntry();
+  ~ConvAlgoEntry();
+};  // ConvAlgoEntry
+
 struct SoftmaxEntry {
   cudnnSoftmaxMode_t mode;
   cudnnDataType_t data_type;
@@ -96,6 +115,8 @@ struct CuDNNThreadEntry {
   cudnnHandle_t handle{nullptr};
   ConvEntry conv_entry;
   SoftmaxEntry softmax_entry;
+  /*! \brief Convolutions whose algorithm was searched at runtime, keyed by configuration. */
+  std::unordered_map<std::string, std::unique_ptr<ConvAlgoEntry>> conv_algo_cache;
   runtime::DeviceAPI* cuda_api{nullptr};
   static CuDNNThreadEntry* ThreadLocal();
 };  // CuDNNThreadEntry
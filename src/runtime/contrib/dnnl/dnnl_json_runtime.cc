@@ -26,12 +26,15 @@
 #include <tvm/runtime/registry.h>
 
 #include <cstddef>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../json/json_node.h"
 #include "../json/json_runtime.h"
 #include "dnnl.hpp"
+#include "dnnl_threading.h"
 
 namespace tvm {
 namespace runtime {
@@ -59,12 +62,30 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
 
     // Setup constants entries for weights.
     SetupConstants(consts);
+
+    // Constants do not change across runs, so copy them into DNNL memory and reorder them
+    // to the layouts picked by the primitives only once.
+    for (size_t i = 0; i < const_idx_.size(); ++i) {
+      auto eid = EntryID(const_idx_[i], 0);
+      if (entry_out_mem_.count(eid) == 0) continue;
+      size_t offset_in_bytes = entry_out_mem_[eid].second * 4;
+      size_t buffer_size = GetDataSize(*data_entry_[eid]);
+      write_to_dnnl_memory(data_entry_[eid]->data, entry_out_mem_[eid].first, buffer_size,
+                           offset_in_bytes);
+    }
+    DNNLThreadsScope threads;
+    for (size_t i = 0; i < const_net_.size(); ++i) {
+      const_net_.at(i).execute(stream_, const_net_args_.at(i));
+    }
+    stream_.wait();
   }
 
   void Run() override {
-    // Fill in the input buffers.
-    for (size_t i = 0; i < input_nodes_.size(); ++i) {
-      auto eid = EntryID(input_nodes_[i], 0);
+    // Fill in the input buffers. Constants have been filled in at Init, and inputs bound
+    // in place are read directly.
+    for (size_t i = 0; i < input_var_idx_.size(); ++i) {
+      auto eid = EntryID(input_var_idx_[i], 0);
+      if (IsZeroCopy(eid)) continue;
       // TODO(@comaniac): Support other data lengths.
       size_t offset_in_bytes = entry_out_mem_[eid].second * 4;
       size_t buffer_size = GetDataSize(*data_entry_[eid]);
@@ -73,6 +94,7 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     }
 
     // Invoke the engine through intepreting the stream.
+    DNNLThreadsScope threads;
     for (size_t i = 0; i < net_.size(); ++i) {
       net_.at(i).execute(stream_, net_args_.at(i));
     }
@@ -81,6 +103,7 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     // Read output buffers.
     for (size_t i = 0; i < outputs_.size(); ++i) {
       auto eid = EntryID(outputs_[i]);
+      if (IsZeroCopy(eid)) continue;
       size_t offset_in_bytes = entry_out_mem_[eid].second * 4;
       size_t buffer_size = GetDataSize(*data_entry_[eid]);
       read_from_dnnl_memory(data_entry_[eid]->data, entry_out_mem_[eid].first, buffer_size,
@@ -88,11 +111,35 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     }
   }
 
+ protected:
+  // Point the DNNL memory of an input or output at the user buffer. Only entries that
+  // own a whole plain memory qualify; the primitives were created for that memory, so
+  // swapping its handle rebinds them without rebuilding anything.
+  bool BindExternalBuffer(uint32_t eid, const DLTensor* tensor) override {
+    auto it = entry_out_mem_.find(eid);
+    if (it == entry_out_mem_.end() || it->second.second != 0) return false;
+    dnnl::memory& mem = it->second.first;
+    if (owned_handles_.count(eid) == 0) {
+      owned_handles_[eid] = mem.get_data_handle();
+    }
+    if (tensor == nullptr) {
+      mem.set_data_handle(owned_handles_[eid]);
+      return false;
+    }
+    if (mem.get_desc().get_size() != GetDataSize(*tensor)) return false;
+    mem.set_data_handle(static_cast<char*>(tensor->data) + tensor->byte_offset);
+    return true;
+  }
+
  private:
   // Build up the engine based on the input graph.
   void BuildEngine() {
     engine_ = dnnl::engine(dnnl::engine::kind::cpu, 0);
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+    stream_ = dnnl::threadpool_interop::make_stream(engine_, DNNLThreadPool::Global());
+#else
     stream_ = dnnl::stream(engine_);
+#endif
 
     // Build subgraph engine.
     for (size_t nid = 0; nid < nodes_.size(); ++nid) {
@@ -106,8 +153,18 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
           Conv2d(nid, true, false);
         } else if ("dnnl.conv2d_bias_relu" == op_name) {
           Conv2d(nid, true, true);
+        } else if ("dnnl.conv2d_bias" == op_name) {
+          Conv2d(nid, false, true);
+        } else if ("dnnl.conv2d_bias_sum_relu" == op_name) {
+          Conv2d(nid, true, true, true);
         } else if ("nn.dense" == op_name) {
           Dense(nid);
+        } else if ("dnnl.dense_relu" == op_name) {
+          Dense(nid, true, false);
+        } else if ("dnnl.dense_bias_relu" == op_name) {
+          Dense(nid, true, true);
+        } else if ("dnnl.dense_bias" == op_name) {
+          Dense(nid, false, true);
         } else if ("nn.batch_norm" == op_name) {
           BatchNorm(nid);
         } else if ("nn.relu" == op_name) {
@@ -148,7 +205,77 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     return entry_out_mem_[eid].first;
   }
 
-  void Conv2d(const size_t& nid, const bool has_relu = false, const bool has_bias = false) {
+  // Build the post-ops fused into a convolution or an inner product. A sum post-op adds the
+  // content of the destination memory, so it has to come first.
+  dnnl::primitive_attr PostOpAttr(const bool has_relu, const bool has_sum) {
+    dnnl::primitive_attr attr;
+    dnnl::post_ops ops;
+    if (has_sum) {
+      ops.append_sum(1.f);
+    }
+    if (has_relu) {
+      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
+    }
+    attr.set_post_ops(ops);
+    return attr;
+  }
+
+  // Append dimensions to a primitive cache key.
+  static void AppendDims(std::ostringstream* key, const dnnl::memory::dims& dims) {
+    for (auto dim : dims) {
+      *key << dim << ",";
+    }
+    *key << ";";
+  }
+
+  // Get the primitive of the given description from the cache, or create it. Creating a
+  // primitive generates its kernel, so layers of the same configuration share one.
+  template <typename PrimT>
+  dnnl::primitive GetOrCreatePrimitive(const std::string& key,
+                                       const typename PrimT::primitive_desc& prim_desc) {
+    auto it = primitive_cache_.find(key);
+    if (it == primitive_cache_.end()) {
+      it = primitive_cache_.emplace(key, PrimT(prim_desc)).first;
+    }
+    return it->second;
+  }
+
+  // Return a memory in the layout required by a primitive, reordering the given memory into it
+  // when the layouts differ. Reorders of constants run once at Init, others on every run.
+  dnnl::memory ReorderIfNeeded(const JSONGraphNodeEntry& entry, const dnnl::memory& mem,
+                               const dnnl::memory::desc& required_md) {
+    if (mem.get_desc() == required_md) {
+      return mem;
+    }
+    auto reordered = dnnl::memory(required_md, engine_);
+    auto reorder = dnnl::reorder(mem, reordered);
+    if (nodes_[entry.id_].GetOpType() == "const") {
+      const_net_.push_back(reorder);
+      const_net_args_.push_back({{DNNL_ARG_FROM, mem}, {DNNL_ARG_TO, reordered}});
+    } else {
+      net_.push_back(reorder);
+      net_args_.push_back({{DNNL_ARG_FROM, mem}, {DNNL_ARG_TO, reordered}});
+    }
+    return reordered;
+  }
+
+  // Bind the destination memory of a primitive. With a sum post-op, the summand is first
+  // copied into the destination, which the primitive then accumulates into.
+  dnnl::memory BindDstMemory(const size_t& nid, const dnnl::memory::desc& dst_md,
+                             const bool has_sum, const size_t sum_input_idx) {
+    JSONGraphNodeEntry out_entry(nid, 0);
+    auto dst_memory = BindDNNLMemory(out_entry, dst_md);
+    if (has_sum) {
+      auto sum_entry = nodes_[nid].GetInputs()[sum_input_idx];
+      auto sum_memory = BindDNNLMemory(sum_entry, dst_md);
+      net_.push_back(dnnl::reorder(sum_memory, dst_memory));
+      net_args_.push_back({{DNNL_ARG_FROM, sum_memory}, {DNNL_ARG_TO, dst_memory}});
+    }
+    return dst_memory;
+  }
+
+  void Conv2d(const size_t& nid, const bool has_relu = false, const bool has_bias = false,
+              const bool has_sum = false) {
     auto node = nodes_[nid];
 
     // Setup attributes.
@@ -163,16 +290,16 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dim N = input_shape[0],       // batch size
         IC = input_shape[1],                    // input channels
         IH = input_shape[2],                    // input height
-        IW = input_shape[2],                    // input width
+        IW = input_shape[3],                    // input width
         OC = weight_shape[0],                   // output channels
         KH = weight_shape[2],                   // weight height
         KW = weight_shape[3],                   // weight width
-        PH_L = std::stoi(str_padding[1]),       // height padding: left
-        PH_R = std::stoi(str_padding[3]),       // height padding: right
-        PW_L = std::stoi(str_padding[0]),       // width padding: left
-        PW_R = std::stoi(str_padding[2]),       // width padding: right
+        PH_L = std::stoi(str_padding[0]),       // height padding: top
+        PH_R = std::stoi(str_padding[2]),       // height padding: bottom
+        PW_L = std::stoi(str_padding[1]),       // width padding: left
+        PW_R = std::stoi(str_padding[3]),       // width padding: right
         SH = std::stoi(str_strides[0]),         // height-wise stride
-        SW = std::stoi(str_strides[0]),         // weight-wise stride
+        SW = std::stoi(str_strides[1]),         // width-wise stride
         OH = (IH - KH + PH_L + PH_R) / SH + 1,  // output height
         OW = (IW - KW + PW_L + PW_R) / SW + 1;  // output width
 
@@ -180,7 +307,7 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dims src_dims = {N, IC, IH, IW};
     dnnl::memory::dims weights_dims = {OC, IC, KH, KW};
     if (groups > 1) {
-      weights_dims = {groups, 1, IC / groups, KH, KW};
+      weights_dims = {groups, OC / groups, IC / groups, KH, KW};
     }
     dnnl::memory::dims bias_dims = {OC};
     dnnl::memory::dims dst_dims = {N, OC, OH, OW};
@@ -188,7 +315,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dims padding_dims_l = {PH_L, PW_L};
     dnnl::memory::dims padding_dims_r = {PH_R, PW_R};
 
-    // Memory descriptions.
+    // Memory descriptions. Let DNNL pick the layouts of the source and the weights; the
+    // destination stays plain since other nodes read it.
     auto conv_src_md = dnnl::memory::desc(src_dims, dt::f32, tag::any);
     auto conv_weights_md = dnnl::memory::desc(weights_dims, dt::f32, tag::any);
     auto conv_bias_md = dnnl::memory::desc(bias_dims, dt::f32, tag::any);
@@ -199,28 +327,24 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
         dnnl::prop_kind::forward_inference, dnnl::algorithm::convolution_direct, conv_src_md,
         conv_weights_md, conv_bias_md, conv_dst_md, strides_dims, padding_dims_l, padding_dims_r);
 
-    // Enable ReLU
-    dnnl::primitive_attr attr;
-    if (has_relu) {
-      dnnl::post_ops ops;
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
-      attr.set_post_ops(ops);
-    }
+    // Fuse the sum and ReLU post-ops.
+    dnnl::primitive_attr attr = PostOpAttr(has_relu, has_sum);
 
     auto conv2d_prim_desc = dnnl::convolution_forward::primitive_desc(conv_desc, attr, engine_);
 
-    // Push to the network.
-    auto conv = dnnl::convolution_forward(conv2d_prim_desc);
-    net_.push_back(conv);
-
     // Data memory.
     CHECK_EQ(node.GetAttr<std::vector<std::string>>("data_layout")[0], "NCHW");
-    auto conv2d_src_memory = BindDNNLMemory(data_entry, {src_dims, dt::f32, tag::nchw});
+    auto conv2d_src_memory = ReorderIfNeeded(
+        data_entry, BindDNNLMemory(data_entry, {src_dims, dt::f32, tag::nchw}),
+        conv2d_prim_desc.src_desc());
 
     // Weight memory.
     CHECK_EQ(node.GetAttr<std::vector<std::string>>("kernel_layout")[0], "OIHW");
-    auto conv2d_weights_memory = BindDNNLMemory(
-        weight_entry, {weights_dims, dt::f32, (groups > 1) ? tag::goihw : tag::oihw});
+    auto conv2d_weights_memory = ReorderIfNeeded(
+        weight_entry,
+        BindDNNLMemory(weight_entry,
+                       {weights_dims, dt::f32, (groups > 1) ? tag::goihw : tag::oihw}),
+        conv2d_prim_desc.weights_desc());
 
     // Bias memory.
     auto conv2d_bias_memory = dnnl::memory({bias_dims, dt::f32, tag::x}, engine_);
@@ -228,13 +352,23 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
       auto bias_entry = node.GetInputs()[2];
       BindDNNLMemory(bias_entry, conv2d_bias_memory);
     } else {
-      float bias[OC] = {0};
-      write_to_dnnl_memory(bias, conv2d_bias_memory, OC * sizeof(float));
+      std::vector<float> bias(OC, 0);
+      write_to_dnnl_memory(bias.data(), conv2d_bias_memory, OC * sizeof(float));
     }
 
     // Output memory.
-    JSONGraphNodeEntry out_entry(nid, 0);
-    auto conv2d_dst_memory = BindDNNLMemory(out_entry, conv2d_prim_desc.dst_desc());
+    auto conv2d_dst_memory =
+        BindDstMemory(nid, conv2d_prim_desc.dst_desc(), has_sum, has_bias ? 3 : 2);
+
+    // Push to the network.
+    std::ostringstream key;
+    key << "conv2d" << has_relu << has_sum << ";";
+    for (const auto& dims :
+         {src_dims, weights_dims, strides_dims, padding_dims_l, padding_dims_r}) {
+      AppendDims(&key, dims);
+    }
+    net_.push_back(
+        GetOrCreatePrimitive<dnnl::convolution_forward>(key.str(), conv2d_prim_desc));
 
     // Bind memory buffers.
     net_args_.push_back({{DNNL_ARG_SRC, conv2d_src_memory},
@@ -243,7 +377,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
                          {DNNL_ARG_DST, conv2d_dst_memory}});
   }
 
-  void Dense(const size_t& nid) {
+  void Dense(const size_t& nid, const bool has_relu = false, const bool has_bias = false,
+             const bool has_sum = false) {
     auto node = nodes_[nid];
 
     // Setup attributes.
@@ -262,28 +397,40 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dims bias_dims = {OC};
     dnnl::memory::dims out_dims = {B, OC};
 
-    // Memory descriptions.
+    // Memory descriptions. Let DNNL pick the layout of the weights.
     auto data_md = dnnl::memory::desc({data_dims, dt::f32, tag::nc});
-    auto weight_md = dnnl::memory::desc({weight_dims, dt::f32, tag::nc});
+    auto weight_md = dnnl::memory::desc({weight_dims, dt::f32, tag::any});
     auto bias_md = dnnl::memory::desc({bias_dims, dt::f32, tag::x});
     auto dst_md = dnnl::memory::desc({out_dims, dt::f32, tag::nc});
 
     // Dense description.
     auto dense_desc = dnnl::inner_product_forward::desc(dnnl::prop_kind::forward_inference, data_md,
                                                         weight_md, bias_md, dst_md);
-    auto dense_prim_desc = dnnl::inner_product_forward::primitive_desc(dense_desc, engine_);
-
-    auto dense = dnnl::inner_product_forward(dense_prim_desc);
-    net_.push_back(dense);
+    dnnl::primitive_attr attr = PostOpAttr(has_relu, has_sum);
+    auto dense_prim_desc =
+        dnnl::inner_product_forward::primitive_desc(dense_desc, attr, engine_);
 
     // Memories.
     auto data_memory = BindDNNLMemory(data_entry, data_md);
-    auto weight_memory = BindDNNLMemory(weight_entry, weight_md);
+    auto weight_memory = ReorderIfNeeded(
+        weight_entry, BindDNNLMemory(weight_entry, {weight_dims, dt::f32, tag::nc}),
+        dense_prim_desc.weights_desc());
     auto bias_memory = dnnl::memory(bias_md, engine_);
-    float bias[OC] = {0};
-    write_to_dnnl_memory(bias, bias_memory, OC * sizeof(float));
-    JSONGraphNodeEntry out_entry(nid, 0);
-    auto dst_memory = BindDNNLMemory(out_entry, dense_prim_desc.dst_desc());
+    if (has_bias) {
+      auto bias_entry = node.GetInputs()[2];
+      BindDNNLMemory(bias_entry, bias_memory);
+    } else {
+      std::vector<float> bias(OC, 0);
+      write_to_dnnl_memory(bias.data(), bias_memory, OC * sizeof(float));
+    }
+    auto dst_memory = BindDstMemory(nid, dense_prim_desc.dst_desc(), has_sum, has_bias ? 3 : 2);
+
+    std::ostringstream key;
+    key << "dense" << has_relu << has_sum << ";";
+    AppendDims(&key, data_dims);
+    AppendDims(&key, weight_dims);
+    net_.push_back(
+        GetOrCreatePrimitive<dnnl::inner_product_forward>(key.str(), dense_prim_desc));
 
     net_args_.push_back({{DNNL_ARG_SRC, data_memory},
                          {DNNL_ARG_WEIGHTS, weight_memory},
@@ -435,8 +582,16 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
   std::vector<dnnl::primitive> net_;
   /* The memory that is consumed by arguments. */
   std::vector<std::unordered_map<int, dnnl::memory>> net_args_;
+  /* The reorders of constants, which run once at initialization. */
+  std::vector<dnnl::primitive> const_net_;
+  /* The memory that is consumed by the reorders of constants. */
+  std::vector<std::unordered_map<int, dnnl::memory>> const_net_args_;
+  /* The created primitives, keyed by their configuration. */
+  std::unordered_map<std::string, dnnl::primitive> primitive_cache_;
   /* The entry ID to its corresponding output memory. */
   std::unordered_map<uint32_t, std::pair<dnnl::memory, size_t>> entry_out_mem_;
+  /* The buffers DNNL allocated for inputs and outputs that are now bound to user buffers. */
+  std::unordered_map<uint32_t, void*> owned_handles_;
 };
 
 runtime::Module DNNLJSONRuntimeCreate(String symbol_name, String graph_json,
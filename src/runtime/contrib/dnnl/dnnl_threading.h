@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/contrib/dnnl/dnnl_threading.h
+ * \brief Run DNNL on the threads given to TVM.
+ *
+ *  A DNNL built with the threadpool CPU runtime runs its parallel regions
+ *  on the TVM thread pool. Otherwise DNNL uses OpenMP, and the OpenMP threads
+ *  are sized like the TVM thread pool around each call.
+ */
+#ifndef TVM_RUNTIME_CONTRIB_DNNL_DNNL_THREADING_H_
+#define TVM_RUNTIME_CONTRIB_DNNL_DNNL_THREADING_H_
+
+#include <dnnl_config.h>
+#include <tvm/runtime/c_backend_api.h>
+
+#include "../external_threading.h"
+
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+#include <dnnl_threadpool.hpp>
+#include <dnnl_threadpool_iface.hpp>
+
+#include <algorithm>
+#include <functional>
+#endif
+
+namespace tvm {
+namespace runtime {
+namespace contrib {
+
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+/*! \brief DNNL threadpool running the parallel regions of DNNL with TVMBackendParallelLaunch. */
+class DNNLThreadPool : public dnnl::threadpool_interop::threadpool_iface {
+ public:
+  int get_num_threads() const override { return ExternalNumThreads(); }
+
+  bool get_in_parallel() const override { return InParallel(); }
+
+  uint64_t get_flags() const override { return 0; }
+
+  void parallel_for(int n, const std::function<void(int, int)>& fn) override {
+    if (n <= 0) return;
+    if (n == 1 || InParallel()) {
+      for (int i = 0; i < n; ++i) fn(i, n);
+      return;
+    }
+    Closure closure{n, &fn};
+    TVMBackendParallelLaunch(RunTasks, &closure, std::min(n, get_num_threads()));
+  }
+
+  /*! \return The threadpool shared by all the DNNL calls of the process. */
+  static DNNLThreadPool* Global() {
+    static DNNLThreadPool* inst = new DNNLThreadPool();
+    return inst;
+  }
+
+ private:
+  struct Closure {
+    int n;
+    const std::function<void(int, int)>* fn;
+  };
+
+  static bool& InParallel() {
+    static thread_local bool in_parallel = false;
+    return in_parallel;
+  }
+
+  static int RunTasks(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    auto* closure = static_cast<Closure*>(cdata);
+    InParallel() = true;
+    for (int i = task_id; i < closure->n; i += penv->num_task) {
+      (*closure->fn)(i, closure->n);
+    }
+    InParallel() = false;
+    return 0;
+  }
+};
+
+/*! \brief DNNL runs on the TVM thread pool, there is nothing to size. */
+struct DNNLThreadsScope {
+  DNNLThreadsScope() {}
+};
+#else
+/*! \brief Size the OpenMP threads used by DNNL like the TVM thread pool. */
+using DNNLThreadsScope = OpenMPThreadsScope;
+#endif
+
+}  // namespace contrib
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_CONTRIB_DNNL_DNNL_THREADING_H_
@@ -31,39 +31,42 @@
 namespace tvm {
 namespace runtime {
 
-void EdgeTPURuntime::Init(const std::string& tflite_model_bytes, TVMContext ctx) {
-  const char* buffer = tflite_model_bytes.c_str();
-  size_t buffer_size = tflite_model_bytes.size();
-  // Load compiled model as a FlatBufferModel
-  std::unique_ptr<tflite::FlatBufferModel> model =
-      tflite::FlatBufferModel::BuildFromBuffer(buffer, buffer_size);
+void EdgeTPURuntime::Init(const std::string& tflite_model_bytes, TVMContext ctx, int num_threads,
+                          int max_interpreters) {
+  // Init EdgeTPUContext object, shared by all the interpreters
+  edgetpu_context_ = edgetpu::EdgeTpuManager::GetSingleton()->OpenDevice();
+  TFLiteRuntime::Init(tflite_model_bytes, ctx, num_threads, max_interpreters);
+}
+
+std::unique_ptr<tflite::Interpreter> EdgeTPURuntime::BuildInterpreter(int num_threads) {
   // Build resolver
   tflite::ops::builtin::BuiltinOpResolver resolver;
-  // Init EdgeTPUContext object
-  edgetpu_context_ = edgetpu::EdgeTpuManager::GetSingleton()->OpenDevice();
   // Add custom edgetpu ops to resolver
   resolver.AddCustom(edgetpu::kCustomOp, edgetpu::RegisterCustomOp());
   // Build interpreter
-  TfLiteStatus status = tflite::InterpreterBuilder(*model, resolver)(&interpreter_);
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  TfLiteStatus status = tflite::InterpreterBuilder(*model_, resolver)(&interpreter);
   CHECK_TFLITE_STATUS(status) << "Failed to build interpreter.";
   // Bind EdgeTPU context with interpreter.
-  interpreter_->SetExternalContext(kTfLiteEdgeTpuContext, edgetpu_context_.get());
-  interpreter_->SetNumThreads(1);
+  interpreter->SetExternalContext(kTfLiteEdgeTpuContext, edgetpu_context_.get());
+  interpreter->SetNumThreads(num_threads > 0 ? num_threads : DefaultNumThreads());
   // Allocate tensors
-  status = interpreter_->AllocateTensors();
+  status = interpreter->AllocateTensors();
   CHECK_TFLITE_STATUS(status) << "Failed to allocate tensors.";
-
-  ctx_ = ctx;
+  return interpreter;
 }
 
-Module EdgeTPURuntimeCreate(const std::string& tflite_model_bytes, TVMContext ctx) {
+Module EdgeTPURuntimeCreate(const std::string& tflite_model_bytes, TVMContext ctx,
+                            int num_threads = 0, int max_interpreters = 1) {
   auto exec = make_object<EdgeTPURuntime>();
-  exec->Init(tflite_model_bytes, ctx);
+  exec->Init(tflite_model_bytes, ctx, num_threads, max_interpreters);
   return Module(exec);
 }
 
 TVM_REGISTER_GLOBAL("tvm.edgetpu_runtime.create").set_body([](TVMArgs args, TVMRetValue* rv) {
-  *rv = EdgeTPURuntimeCreate(args[0], args[1]);
+  int num_threads = args.size() > 2 ? static_cast<int>(args[2]) : 0;
+  int max_interpreters = args.size() > 3 ? static_cast<int>(args[3]) : 1;
+  *rv = EdgeTPURuntimeCreate(args[0], args[1], num_threads, max_interpreters);
 });
 }  // namespace runtime
 }  // namespace tvm
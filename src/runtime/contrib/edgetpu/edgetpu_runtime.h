@@ -50,8 +50,15 @@ class EdgeTPURuntime : public TFLiteRuntime {
    * \brief Initialize the edge TPU tflite runtime with tflite model and context.
    * \param tflite_model_bytes The tflite model.
    * \param ctx The context where the tflite model will be executed on.
+   * \param num_threads The number of intra-op threads of each interpreter, 0 for one.
+   * \param max_interpreters The maximum number of interpreters serving concurrent runs.
    */
-  void Init(const std::string& tflite_model_bytes, TVMContext ctx);
+  void Init(const std::string& tflite_model_bytes, TVMContext ctx, int num_threads = 0,
+            int max_interpreters = 1);
+
+ protected:
+  std::unique_ptr<tflite::Interpreter> BuildInterpreter(int num_threads) final;
+  int DefaultNumThreads() const final { return 1; }
 
  private:
   std::shared_ptr<edgetpu::EdgeTpuContext> edgetpu_context_;
@@ -30,7 +30,11 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
+#include "ethosn_device.h"
 #include "ethosn_driver_library/Buffer.hpp"
 #include "ethosn_support_library/Support.hpp"
 
@@ -72,97 +76,161 @@ bool WaitForInference(dl::Inference* inference, int timeout) {
   return true;
 }
 
-template <typename T>
-void CopyOutput(dl::Buffer* source_buffers[], std::vector<DLTensor*>* outputs) {
-  for (DLTensor* tensor : *outputs) {
-    dl::Buffer* source_buffer = source_buffers[0];
-    uint8_t* source_buffer_data = source_buffer->GetMappedBuffer();
-    size_t size = source_buffer->GetSize();
-    T* dest_pointer = static_cast<T*>(tensor->data);
-    std::copy_backward(source_buffer_data, source_buffer_data + size, dest_pointer + size);
-    source_buffers++;
+struct LoadedNetwork {
+  std::unique_ptr<dl::Network> network;
+};
+
+/*! \brief An output of an inference, written back when the inference completes. */
+struct OutputBinding {
+  uint8_t* data;
+  size_t size;
+};
+
+struct PendingInference {
+  /*! \brief Keeps the network loaded until the inference completes. */
+  std::shared_ptr<LoadedNetwork> npu;
+  /*! \brief The buffers read and written by the NPU. */
+  std::vector<std::shared_ptr<dl::Buffer>> ifm;
+  std::vector<std::shared_ptr<dl::Buffer>> ofm;
+  /*! \brief Where each output buffer is copied to, in the order of ofm. */
+  std::vector<OutputBinding> outputs;
+  std::unique_ptr<dl::Inference> inference;
+};
+
+/*! \brief The buffers allocated by AllocateBuffer, keyed by their mapping. */
+class ImportedBuffers {
+ public:
+  void Add(const std::shared_ptr<dl::Buffer>& buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_[buffer->GetMappedBuffer()] = buffer;
+  }
+  void Remove(const void* data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.erase(data);
   }
+  /*! \return The buffer mapped at data with the given size, nullptr when there is none. */
+  std::shared_ptr<dl::Buffer> Find(const void* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffers_.find(data);
+    if (it == buffers_.end() || it->second->GetSize() != size) return nullptr;
+    return it->second;
+  }
+  static ImportedBuffers* Global() {
+    static ImportedBuffers* inst = new ImportedBuffers();
+    return inst;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<const void*, std::shared_ptr<dl::Buffer>> buffers_;
+};
+
+std::shared_ptr<LoadedNetwork> LoadNetwork(sl::CompiledNetwork* network) {
+  auto npu = std::make_shared<LoadedNetwork>();
+  npu->network = std::make_unique<dl::Network>(*network);
+  return npu;
 }
 
-void CreateBuffers(std::vector<std::shared_ptr<dl::Buffer> >* fm,
-                   const std::vector<DLTensor*>& tensors) {
-  int index = 0;
-  for (auto buffer : tensors) {
-    auto* data = static_cast<uint8_t*>(buffer->data);
+std::shared_ptr<PendingInference> SubmitInference(TVMArgs args,
+                                                  const std::shared_ptr<LoadedNetwork>& npu,
+                                                  sl::CompiledNetwork* network,
+                                                  const std::vector<uint32_t>& input_order,
+                                                  const std::vector<uint32_t>& output_order) {
+  size_t num_inputs = network->GetInputBufferInfos().size();
+  size_t num_outputs = network->GetOutputBufferInfos().size();
+  CHECK_EQ(static_cast<size_t>(args.size()), num_inputs + num_outputs)
+      << "The network expects " << num_inputs << " inputs and " << num_outputs << " outputs.";
+  auto pending = std::make_shared<PendingInference>();
+  pending->npu = npu;
+  pending->ifm.resize(num_inputs);
+  pending->ofm.resize(num_outputs);
+  pending->outputs.resize(num_outputs);
+
+  // Set up input buffers, reading the buffers allocated for the NPU in place.
+  for (size_t i = 0; i < num_inputs; i++) {
+    const DLTensor* tensor = args[i];
+    auto* data = static_cast<uint8_t*>(tensor->data) + tensor->byte_offset;
     // The NPU only needs the size of the tensor * uint8_t.
-    auto data_size = static_cast<uint32_t>(GetDataSize(*buffer));
-    (*fm)[index++] = std::make_shared<dl::Buffer>(data, data_size, dl::DataFormat::NHWC);
+    size_t size = GetDataSize(*tensor);
+    std::shared_ptr<dl::Buffer> buffer = ImportedBuffers::Global()->Find(data, size);
+    if (buffer == nullptr) {
+      buffer = std::make_shared<dl::Buffer>(data, static_cast<uint32_t>(size),
+                                            dl::DataFormat::NHWC);
+    }
+    pending->ifm[input_order[i]] = buffer;
   }
-}
 
-bool Inference(tvm::runtime::TVMArgs args, sl::CompiledNetwork* network,
-               const std::vector<uint32_t>& input_order,
-               const std::vector<uint32_t>& output_order) {
-  // Unpack parameters
-  uint8_t argc = 0;
-  std::vector<DLTensor*> inputs(input_order.size());
-  for (uint8_t i = 0; i < network->GetInputBufferInfos().size(); i++) {
-    inputs[input_order[i]] = args[argc++];
-  }
-  auto out_infos = network->GetOutputBufferInfos();
-  std::vector<DLTensor*> outputs(output_order.size());
-  for (uint8_t i = 0; i < network->GetOutputBufferInfos().size(); i++) {
-    outputs[output_order[i]] = args[argc++];
+  // Set up output buffers, writing to the buffers allocated for the NPU in place.
+  for (size_t i = 0; i < num_outputs; i++) {
+    const DLTensor* tensor = args[num_inputs + i];
+    auto* data = static_cast<uint8_t*>(tensor->data) + tensor->byte_offset;
+    size_t size = GetDataSize(*tensor);
+    std::shared_ptr<dl::Buffer> buffer = ImportedBuffers::Global()->Find(data, size);
+    if (buffer == nullptr) {
+      buffer = std::make_shared<dl::Buffer>(static_cast<uint32_t>(size), dl::DataFormat::NHWC);
+    }
+    pending->ofm[output_order[i]] = buffer;
+    pending->outputs[output_order[i]] = OutputBinding{data, size};
   }
 
-  // Set up input buffers
-  std::vector<std::shared_ptr<dl::Buffer> > ifm(inputs.size());
-  CreateBuffers(&ifm, inputs);
-
-  // Set up output buffers
-  std::vector<std::shared_ptr<dl::Buffer> > ofm(outputs.size());
-  CreateBuffers(&ofm, outputs);
-
   // Raw pointers for the inference
-  dl::Buffer* ifm_raw[inputs.size()];
-  for (size_t i = 0; i < inputs.size(); i++) {
-    ifm_raw[i] = ifm[i].get();
+  std::vector<dl::Buffer*> ifm_raw(num_inputs);
+  for (size_t i = 0; i < num_inputs; i++) {
+    ifm_raw[i] = pending->ifm[i].get();
   }
-  dl::Buffer* ofm_raw[outputs.size()];
-  for (size_t i = 0; i < outputs.size(); i++) {
-    ofm_raw[i] = ofm[i].get();
+  std::vector<dl::Buffer*> ofm_raw(num_outputs);
+  for (size_t i = 0; i < num_outputs; i++) {
+    ofm_raw[i] = pending->ofm[i].get();
   }
 
-  auto npu = std::make_unique<dl::Network>(*network);
+  // Schedule the inference, it is queued behind the ones already submitted to the NPU.
+  pending->inference.reset(npu->network->ScheduleInference(ifm_raw.data(), ifm_raw.size(),
+                                                           ofm_raw.data(), ofm_raw.size()));
+  return pending;
+}
 
-  // Execute the inference.
-  std::unique_ptr<dl::Inference> result(
-      npu->ScheduleInference(ifm_raw, sizeof(ifm_raw) / sizeof(ifm_raw[0]), ofm_raw,
-                             sizeof(ofm_raw) / sizeof(ofm_raw[0])));
-  bool inferenceCompleted = WaitForInference(result.get(), 60);
+bool CompleteInference(PendingInference* pending, int timeout) {
+  bool inferenceCompleted = WaitForInference(pending->inference.get(), timeout);
   if (inferenceCompleted) {
-    switch ((outputs)[0]->dtype.bits) {
-      case 8: {
-        dl::Buffer** ofms = &ofm_raw[0];
-        for (DLTensor* tensor : outputs) {
-          uint8_t* source_buffer_data = (*ofms++)->GetMappedBuffer();
-          uint8_t* dest_pointer = static_cast<uint8_t*>(tensor->data);
-          if (source_buffer_data != dest_pointer) {
-            CopyOutput<uint8_t>(ofm_raw, &outputs);
-            break;
-          }
-        }
-        break;
+    for (size_t i = 0; i < pending->outputs.size(); i++) {
+      uint8_t* source_buffer_data = pending->ofm[i]->GetMappedBuffer();
+      const OutputBinding& dest = pending->outputs[i];
+      if (source_buffer_data != dest.data) {
+        std::copy(source_buffer_data, source_buffer_data + dest.size, dest.data);
       }
-      case 16:
-        CopyOutput<uint16_t>(ofm_raw, &outputs);
-        break;
-      case 32:
-        CopyOutput<uint32_t>(ofm_raw, &outputs);
-        break;
-      default:
-        break;
     }
   }
-
   return inferenceCompleted;
 }
 
+NDArray AllocateBuffer(const std::vector<int64_t>& shape, DLDataType dtype) {
+  struct Holder {
+    std::shared_ptr<dl::Buffer> buffer;
+    std::vector<int64_t> shape;
+    DLManagedTensor tensor;
+  };
+  auto* holder = new Holder();
+  holder->shape = shape;
+  DLTensor& tensor = holder->tensor.dl_tensor;
+  tensor.ctx = {kDLCPU, 0};
+  tensor.ndim = static_cast<int>(shape.size());
+  tensor.dtype = dtype;
+  tensor.shape = holder->shape.data();
+  tensor.strides = nullptr;
+  tensor.byte_offset = 0;
+  size_t size = GetDataSize(tensor);
+  holder->buffer = std::make_shared<dl::Buffer>(static_cast<uint32_t>(size), dl::DataFormat::NHWC);
+  tensor.data = holder->buffer->GetMappedBuffer();
+  ImportedBuffers::Global()->Add(holder->buffer);
+  holder->tensor.manager_ctx = holder;
+  holder->tensor.deleter = [](DLManagedTensor* self) {
+    auto* holder = static_cast<Holder*>(self->manager_ctx);
+    ImportedBuffers::Global()->Remove(holder->tensor.dl_tensor.data);
+    delete holder;
+  };
+  return NDArray::FromDLPack(&holder->tensor);
+}
+
 }  // namespace ethosn
 }  // namespace runtime
 }  // namespace tvm
@@ -196,10 +264,23 @@ TVM_REGISTER_GLOBAL("relay.ethos-n.test.infra.inference_result")
       }
     });
 
-// Allow the ethos-n support code to be tested without a device
-bool Inference(tvm::runtime::TVMArgs args, sl::CompiledNetwork* network,
-               const std::vector<uint32_t>& input_order,
-               const std::vector<uint32_t>& output_order) {
+struct LoadedNetwork {};
+
+struct PendingInference {
+  bool completed;
+};
+
+std::shared_ptr<LoadedNetwork> LoadNetwork(sl::CompiledNetwork* network) {
+  return std::make_shared<LoadedNetwork>();
+}
+
+// Allow the ethos-n support code to be tested without a device, the mocked
+// inference completes as soon as it is submitted.
+std::shared_ptr<PendingInference> SubmitInference(TVMArgs args,
+                                                  const std::shared_ptr<LoadedNetwork>& npu,
+                                                  sl::CompiledNetwork* network,
+                                                  const std::vector<uint32_t>& input_order,
+                                                  const std::vector<uint32_t>& output_order) {
   std::vector<DLTensor*> outputs;
   for (int argc = network->GetInputBufferInfos().size(); argc < args.size(); argc++) {
     outputs.push_back(args[argc]);
@@ -213,7 +294,13 @@ bool Inference(tvm::runtime::TVMArgs args, sl::CompiledNetwork* network,
   }
   // Clear after first usage; on-exit destructor of NDArray fails
   test_outputs.clear();
-  return rc;
+  return std::make_shared<PendingInference>(PendingInference{rc});
+}
+
+bool CompleteInference(PendingInference* pending, int timeout) { return pending->completed; }
+
+NDArray AllocateBuffer(const std::vector<int64_t>& shape, DLDataType dtype) {
+  return NDArray::Empty(shape, dtype, {kDLCPU, 0});
 }
 
 }  // namespace ethosn
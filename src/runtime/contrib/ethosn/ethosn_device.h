@@ -24,6 +24,10 @@
 #ifndef TVM_RUNTIME_CONTRIB_ETHOSN_ETHOSN_DEVICE_H_
 #define TVM_RUNTIME_CONTRIB_ETHOSN_ETHOSN_DEVICE_H_
 
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <memory>
 #include <vector>
 
 #include "ethosn_support_library/Support.hpp"
@@ -34,8 +38,56 @@ namespace ethosn {
 
 namespace sl = ::ethosn::support_library;
 
-bool Inference(tvm::runtime::TVMArgs args, sl::CompiledNetwork* network,
-               const std::vector<uint32_t>& input_order, const std::vector<uint32_t>& output_order);
+/*! \brief A compiled network loaded on the NPU, reused by all its inferences. */
+struct LoadedNetwork;
+
+/*! \brief An inference scheduled on the NPU whose result has not been collected. */
+struct PendingInference;
+
+/*!
+ * \brief Load a compiled network on the NPU.
+ * \param network The compiled network.
+ * \return The loaded network.
+ */
+std::shared_ptr<LoadedNetwork> LoadNetwork(sl::CompiledNetwork* network);
+
+/*!
+ * \brief Schedule an inference on the NPU without waiting for it.
+ *
+ *  Inputs are copied into NPU buffers before returning, unless they were
+ *  allocated with AllocateBuffer, in which case the NPU reads them in place.
+ *  The outputs are written when the inference is completed, so they must stay
+ *  alive until then.
+ *
+ * \param args The input tensors followed by the output tensors.
+ * \param npu The loaded network.
+ * \param network The compiled network.
+ * \param input_order The order of the inputs expected by the network.
+ * \param output_order The order of the outputs produced by the network.
+ * \return The scheduled inference.
+ */
+std::shared_ptr<PendingInference> SubmitInference(TVMArgs args,
+                                                  const std::shared_ptr<LoadedNetwork>& npu,
+                                                  sl::CompiledNetwork* network,
+                                                  const std::vector<uint32_t>& input_order,
+                                                  const std::vector<uint32_t>& output_order);
+
+/*!
+ * \brief Wait for a scheduled inference and write its outputs.
+ * \param pending The scheduled inference.
+ * \param timeout The timeout in seconds.
+ * \return Whether the inference completed successfully.
+ */
+bool CompleteInference(PendingInference* pending, int timeout);
+
+/*!
+ * \brief Allocate a tensor in memory the NPU can access directly. Passing it
+ *  as an input or output of an inference avoids a copy.
+ * \param shape The shape of the tensor.
+ * \param dtype The data type of the tensor.
+ * \return The tensor, on the CPU.
+ */
+NDArray AllocateBuffer(const std::vector<int64_t>& shape, DLDataType dtype);
 
 }  // namespace ethosn
 }  // namespace runtime
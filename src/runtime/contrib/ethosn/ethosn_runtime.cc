@@ -58,12 +58,65 @@ EthosnModule::EthosnModule(std::vector<OrderedCompiledNetwork>* cmms) {
   }
 }
 
+std::shared_ptr<PendingInference> EthosnModule::Submit(OrderedCompiledNetwork* network,
+                                                       TVMArgs args) {
+  std::shared_ptr<LoadedNetwork> npu;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (network->npu == nullptr) {
+      network->npu = LoadNetwork(network->cmm.get());
+    }
+    npu = network->npu;
+  }
+  return SubmitInference(args, npu, network->cmm.get(), network->inputs, network->outputs);
+}
+
 PackedFunc EthosnModule::GetFunction(const std::string& name,
                                      const ObjectPtr<Object>& sptr_to_self) {
+  const int default_timeout = 60;
   if (network_map_.find(name) != network_map_.end()) {
-    return PackedFunc([sptr_to_self, this, name](TVMArgs args, TVMRetValue* rv) {
-      *rv = Inference(args, network_map_[name].cmm.get(), network_map_[name].inputs,
-                      network_map_[name].outputs);
+    OrderedCompiledNetwork* network = &network_map_[name];
+    return PackedFunc([sptr_to_self, this, network](TVMArgs args, TVMRetValue* rv) {
+      std::shared_ptr<PendingInference> pending = Submit(network, args);
+      *rv = CompleteInference(pending.get(), default_timeout);
+    });
+  } else if (name == "submit") {
+    // Schedule an inference and return a ticket to wait on, so that the
+    // next inputs can be prepared while the NPU is busy.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK_GE(args.size(), 1) << "Expected the name of the network to run";
+      std::string symbol = args[0];
+      auto it = network_map_.find(symbol);
+      CHECK(it != network_map_.end()) << "Unknown Ethos-N network " << symbol;
+      TVMArgs tensors(args.values + 1, args.type_codes + 1, args.num_args - 1);
+      std::shared_ptr<PendingInference> pending = Submit(&it->second, tensors);
+      std::lock_guard<std::mutex> lock(mutex_);
+      int64_t ticket = next_ticket_++;
+      pending_[ticket] = pending;
+      *rv = ticket;
+    });
+  } else if (name == "wait") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int64_t ticket = args[0];
+      int timeout = args.size() > 1 ? args[1].operator int() : default_timeout;
+      std::shared_ptr<PendingInference> pending;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(ticket);
+        CHECK(it != pending_.end()) << "No inference was submitted with ticket " << ticket;
+        pending = it->second;
+        pending_.erase(it);
+      }
+      *rv = CompleteInference(pending.get(), timeout);
+    });
+  } else if (name == "alloc_buffer") {
+    return PackedFunc([sptr_to_self](TVMArgs args, TVMRetValue* rv) {
+      DLDataType dtype = String2DLDataType(args[0]);
+      std::vector<int64_t> shape;
+      for (int i = 1; i < args.size(); i++) {
+        shape.push_back(args[i]);
+      }
+      *rv = AllocateBuffer(shape, dtype);
     });
   } else {
     return PackedFunc();
@@ -28,10 +28,12 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "ethosn_device.h"
 #include "ethosn_support_library/Support.hpp"
 
 namespace tvm {
@@ -45,6 +47,8 @@ struct OrderedCompiledNetwork {
   std::string name;
   std::vector<uint32_t> inputs;
   std::vector<uint32_t> outputs;
+  /*! \brief The network loaded on the NPU, created by the first inference. */
+  std::shared_ptr<LoadedNetwork> npu;
 };
 
 class EthosnModule : public ModuleNode {
@@ -90,8 +94,22 @@ class EthosnModule : public ModuleNode {
   const char* type_key() const override { return "ethos-n"; }
 
  private:
+  /*!
+   * \brief Schedule an inference of a network on the NPU.
+   * \param network The network.
+   * \param args The input tensors followed by the output tensors.
+   * \return The scheduled inference.
+   */
+  std::shared_ptr<PendingInference> Submit(OrderedCompiledNetwork* network, TVMArgs args);
+
   /*! \brief A map between ext_symbols (function names) and ordered compiled networks. */
   std::map<std::string, OrderedCompiledNetwork> network_map_;
+  /*! \brief The inferences scheduled through "submit", keyed by their ticket. */
+  std::unordered_map<int64_t, std::shared_ptr<PendingInference>> pending_;
+  /*! \brief The ticket of the next inference scheduled through "submit". */
+  int64_t next_ticket_{0};
+  /*! \brief Guards the loaded networks and the scheduled inferences. */
+  std::mutex mutex_;
 };
 
 }  // namespace ethosn
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/contrib/external_threading.h
+ * \brief Size the threads of external libraries like the TVM thread pool.
+ */
+#ifndef TVM_RUNTIME_CONTRIB_EXTERNAL_THREADING_H_
+#define TVM_RUNTIME_CONTRIB_EXTERNAL_THREADING_H_
+
+#include <tvm/runtime/threading_backend.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+namespace contrib {
+
+/*!
+ * \brief The number of threads an external library call runs on.
+ * \param nthreads The number requested by the caller, 0 to follow the thread
+ *  pool of the calling thread as configured by runtime.config_threadpool.
+ * \return The number of threads.
+ */
+inline int ExternalNumThreads(int nthreads = 0) {
+  return nthreads > 0 ? nthreads : threading::NumThreads();
+}
+
+/*!
+ * \brief RAII helper sizing the OpenMP threads of the calling thread like the
+ *  TVM thread pool for the duration of an external library call, so that
+ *  OpenMP based libraries do not oversubscribe the cores TVM was given.
+ *  The previous setting is restored on exit. A no-op without OpenMP.
+ */
+class OpenMPThreadsScope {
+ public:
+  explicit OpenMPThreadsScope(int nthreads = 0) {
+#ifdef _OPENMP
+    prev_ = omp_get_max_threads();
+    omp_set_num_threads(ExternalNumThreads(nthreads));
+#endif
+  }
+  ~OpenMPThreadsScope() {
+#ifdef _OPENMP
+    omp_set_num_threads(prev_);
+#endif
+  }
+
+ private:
+  int prev_{0};
+};
+
+}  // namespace contrib
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_CONTRIB_EXTERNAL_THREADING_H_
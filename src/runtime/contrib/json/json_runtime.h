@@ -29,6 +29,7 @@
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/ndarray.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <string>
 #include <tuple>
@@ -139,6 +140,53 @@ class JSONRuntimeBase : public ModuleNode {
   std::string GetSource(const std::string& format = "json") override { return graph_json_; }
 
  protected:
+  /*!
+   * \brief Use an input or output buffer in place instead of copying it through a buffer
+   * owned by the runtime. Runtimes that support zero-copy I/O override this.
+   *
+   * SetInputOutputBuffers calls it only when the buffer of an entry changed since the previous
+   * call, so a runtime can keep its binding while callers pass the same buffers, and only for
+   * tensors that are compact, have the shape and dtype recorded in the graph and are aligned
+   * to ZeroCopyAlignment(). When the new buffer of a previously wrapped entry does not qualify,
+   * it is called with nullptr so the runtime can go back to its own buffer.
+   *
+   * \param eid The data entry id of the input or output.
+   * \param tensor The tensor to wrap, or nullptr to release the previous one.
+   * \return Whether the entry now reads or writes the tensor in place.
+   */
+  virtual bool BindExternalBuffer(uint32_t eid, const DLTensor* tensor) { return false; }
+
+  /*! \brief The alignment in bytes a buffer needs to be used in place. */
+  virtual size_t ZeroCopyAlignment() const { return 64; }
+
+  /*!
+   * \brief Whether the input or output entry uses the user buffer in place, in which case
+   * the runtime must not copy it in or out at Run.
+   */
+  bool IsZeroCopy(uint32_t eid) const { return zero_copy_[eid]; }
+
+  /*!
+   * \brief Whether a tensor can be used in place for an output of a graph node.
+   *
+   * \param tensor The user tensor.
+   * \param node The node producing the entry.
+   * \param index The output index of the entry.
+   */
+  bool IsZeroCopyCompatible(const DLTensor* tensor, const JSONGraphNode& node,
+                            uint32_t index) const {
+    if (tensor->ctx.device_type != kDLCPU || !IsContiguous(*tensor)) return false;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(tensor->data) + tensor->byte_offset;
+    if (addr % ZeroCopyAlignment() != 0) return false;
+    const auto& shape = node.GetOpShape()[index];
+    DLDataType dtype = node.GetOpDataType()[index];
+    if (tensor->dtype.code != dtype.code || tensor->dtype.bits != dtype.bits ||
+        tensor->dtype.lanes != dtype.lanes) {
+      return false;
+    }
+    return static_cast<size_t>(tensor->ndim) == shape.size() &&
+           std::equal(shape.begin(), shape.end(), tensor->shape);
+  }
+
   /*!
    * \brief Set up the input and output buffers by binding their DLTensor pointers to the
    * corresponding data entry.
@@ -150,8 +198,10 @@ class JSONRuntimeBase : public ModuleNode {
         << "Found mismatch in the number of provided data entryies and required.";
 
     for (size_t i = 0; i < static_cast<size_t>(args.size()); i++) {
-      auto eid = i < input_var_idx_.size() ? EntryID(input_var_idx_[i], 0)
-                                           : EntryID(outputs_[i - input_var_idx_.size()]);
+      JSONGraphNodeEntry entry = i < input_var_idx_.size()
+                                     ? JSONGraphNodeEntry(input_var_idx_[i], 0)
+                                     : outputs_[i - input_var_idx_.size()];
+      auto eid = EntryID(entry);
       CHECK(args[i].type_code() == kTVMNDArrayHandle || args[i].type_code() == kTVMDLTensorHandle)
           << "Expect NDArray or DLTensor as inputs";
 
@@ -166,6 +216,19 @@ class JSONRuntimeBase : public ModuleNode {
       // Assign input/output the NDArray pointers to data entry so that we can directly
       // read/write host buffers.
       data_entry_[eid] = arg;
+
+      // Rebind only when the buffer changed, so repeated runs on the same buffers keep
+      // the bindings of the runtime.
+      const void* data = static_cast<const char*>(arg->data) + arg->byte_offset;
+      if (bound_data_[eid] != data) {
+        bound_data_[eid] = data;
+        if (IsZeroCopyCompatible(arg, nodes_[entry.id_], entry.index_)) {
+          zero_copy_[eid] = BindExternalBuffer(eid, arg);
+        } else if (zero_copy_[eid]) {
+          BindExternalBuffer(eid, nullptr);
+          zero_copy_[eid] = false;
+        }
+      }
     }
   }
 
@@ -202,6 +265,8 @@ class JSONRuntimeBase : public ModuleNode {
 
     // Reserve data entries.
     data_entry_.resize(NumEntries());
+    bound_data_.resize(NumEntries(), nullptr);
+    zero_copy_.resize(NumEntries(), false);
   }
 
   /*!
@@ -261,6 +326,10 @@ class JSONRuntimeBase : public ModuleNode {
   std::vector<JSONGraphNodeEntry> outputs_;
   /*! \brief Data of that entry. */
   std::vector<const DLTensor*> data_entry_;
+  /*! \brief The user buffer each input/output entry was last bound to. */
+  std::vector<const void*> bound_data_;
+  /*! \brief Whether each input/output entry uses the user buffer in place. */
+  std::vector<bool> zero_copy_;
   /*! \brief Map the input name to node index. */
   std::vector<uint32_t> input_var_idx_;
   /*! \brief input const node index. */
@@ -22,6 +22,8 @@
  */
 #include "nnpack_utils.h"
 
+#include "../external_threading.h"
+
 namespace tvm {
 namespace contrib {
 using namespace runtime;
@@ -33,6 +35,8 @@ NNPackThreadLocalEntry* NNPackThreadLocalEntry::ThreadLocal() {
 }
 
 bool NNPackConfig(uint64_t nthreads) {
+  // 0 sizes the NNPACK threadpool like the TVM thread pool of the calling thread.
+  nthreads = runtime::contrib::ExternalNumThreads(static_cast<int>(nthreads));
   NNPackThreadLocalEntry* entry = NNPackThreadLocalEntry::ThreadLocal();
   if (entry->threadpool && pthreadpool_get_threads_count(entry->threadpool) == nthreads) {
     CHECK_NE(nthreads, 1);
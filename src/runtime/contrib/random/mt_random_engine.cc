@@ -29,7 +29,7 @@
 #include <ctime>
 #include <random>
 
-#include "../3rdparty/compiler-rt/builtin_fp16.h"
+#include "philox_random_engine.cc"
 
 namespace tvm {
 namespace contrib {
@@ -115,47 +115,13 @@ class RandomEngine {
     }
   }
 
+  /*!
+   * \brief Fills a tensor with values in [1, 10), using a Philox engine seeded from this one so
+   *  that large tensors are filled in parallel.
+   */
   void RandomFill(DLTensor* data) {
-    int64_t size = 1;
-    for (int i = 0; i < data->ndim; ++i) {
-      size *= data->shape[i];
-    }
-
-    if (data->ctx.device_type == kDLCPU) {
-      FillData(data, size);
-    } else {
-      runtime::NDArray local = runtime::NDArray::Empty(
-          std::vector<int64_t>{data->shape, data->shape + data->ndim}, data->dtype, {kDLCPU, 0});
-      FillData(&local.ToDLPack()->dl_tensor, size);
-      runtime::NDArray::CopyFromTo(&local.ToDLPack()->dl_tensor, data);
-    }
-  }
-
- private:
-  void FillData(DLTensor* tensor, int64_t size) {
-    // Make the value be 1.0 - 10.0, not (0.0 - 1.0) so that we could satisfy
-    // quantized dtype (uint8 / int8) data non-empty requirement
-    std::uniform_real_distribution<> dist(1.0, 10.0);
-    // Use float representation could make us work well on float / int type too.
-    if (tensor->dtype.bits == 1) {
-      std::generate_n(static_cast<bool*>(tensor->data), size, [&]() { return dist(rnd_engine_); });
-    } else if (tensor->dtype.bits == 8) {
-      std::generate_n(static_cast<uint8_t*>(tensor->data), size,
-                      [&]() { return dist(rnd_engine_); });
-    } else if (tensor->dtype.bits == 16) {
-      std::generate_n(static_cast<uint16_t*>(tensor->data), size, [&]() {
-        return __truncXfYf2__<float, uint32_t, 23, uint16_t, uint16_t, 10>(
-            static_cast<float>(dist(rnd_engine_)));
-      });
-    } else if (tensor->dtype.bits == 32) {
-      std::generate_n(static_cast<float*>(tensor->data), size, [&]() { return dist(rnd_engine_); });
-    } else if (tensor->dtype.bits == 64) {
-      std::generate_n(static_cast<double*>(tensor->data), size,
-                      [&]() { return dist(rnd_engine_); });
-    } else {
-      LOG(FATAL) << "Doesn't support dtype code " << tensor->dtype.code << " dtype bits "
-                 << tensor->dtype.bits;
-    }
+    uint64_t seed = (static_cast<uint64_t>(rnd_engine_()) << 32) | rnd_engine_();
+    PhiloxRandomEngine(seed).RandomFill(data);
   }
 
  private:
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file random/philox_random_engine.cc
+ * \brief Counter-based Philox4x32-10 random engine
+ */
+#include <dmlc/logging.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "../3rdparty/compiler-rt/builtin_fp16.h"
+
+namespace tvm {
+namespace contrib {
+
+/*!
+ * \brief A counter-based random engine (Philox4x32-10, Salmon et al., SC'11).
+ *
+ *  Element i of a tensor filled at offset o is a pure function of the seed and of o + i, so the
+ *  fill is split across the thread pool and still gives the same values for any number of
+ *  threads, and a tensor generated on the host matches one generated for another device.
+ */
+class PhiloxRandomEngine {
+ public:
+  /*!
+   * \brief Creates an engine.
+   * \param seed The key of the generator.
+   * \param offset The counter of the first element of the next tensor.
+   */
+  explicit PhiloxRandomEngine(uint64_t seed, uint64_t offset = 0) : seed_(seed), offset_(offset) {}
+
+  /*! \return The counter of the first element of the next tensor. */
+  uint64_t offset() const { return offset_; }
+
+  /*!
+   * \brief Computes the four 32-bit random words of a counter.
+   * \param key The key, i.e. the seed.
+   * \param counter The counter.
+   */
+  static std::array<uint32_t, 4> Block(uint64_t key, uint64_t counter) {
+    uint32_t c0 = static_cast<uint32_t>(counter), c1 = static_cast<uint32_t>(counter >> 32);
+    uint32_t c2 = 0, c3 = 0;
+    uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+    for (int round = 0; round < 10; ++round) {
+      uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+      uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+      uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+      uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    return {c0, c1, c2, c3};
+  }
+
+  /*!
+   * \brief Fills a tensor with values drawn from Unif(low, high)
+   */
+  void SampleUniform(DLTensor* data, float low, float high) {
+    CHECK_GT(high, low) << "high must be bigger than low";
+    CHECK(data->strides == nullptr);
+    DLDataType dtype = data->dtype;
+    CHECK(dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1);
+    Fill<float>(data, [low, high](const std::array<uint32_t, 4>& block, int lane) {
+      return low + (high - low) * ToUnit(block[lane]);
+    });
+  }
+
+  /*!
+   * \brief Fills a tensor with values drawn from Normal(loc, scale**2)
+   */
+  void SampleNormal(DLTensor* data, float loc, float scale) {
+    CHECK_GT(scale, 0) << "standard deviation must be positive";
+    CHECK(data->strides == nullptr);
+    DLDataType dtype = data->dtype;
+    CHECK(dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1);
+    Fill<float>(data, [loc, scale](const std::array<uint32_t, 4>& block, int lane) {
+      // Box-Muller on the pair of words that the lane belongs to
+      float u1 = 1.0f - ToUnit(block[lane & ~1]);
+      float u2 = ToUnit(block[lane | 1]);
+      float r = std::sqrt(-2.0f * std::log(u1));
+      float theta = 6.28318530717958647692f * u2;
+      return loc + scale * r * ((lane & 1) ? std::sin(theta) : std::cos(theta));
+    });
+  }
+
+  /*!
+   * \brief Fills a tensor with values in [1, 10), which suits float and quantized types alike.
+   */
+  void RandomFill(DLTensor* data) {
+    auto dist = [](const std::array<uint32_t, 4>& block, int lane) {
+      return 1.0f + 9.0f * ToUnit(block[lane]);
+    };
+    if (data->dtype.bits == 1) {
+      Fill<bool>(data, dist);
+    } else if (data->dtype.bits == 8) {
+      Fill<uint8_t>(data, dist);
+    } else if (data->dtype.bits == 16) {
+      Fill<uint16_t>(data, [&dist](const std::array<uint32_t, 4>& block, int lane) {
+        return __truncXfYf2__<float, uint32_t, 23, uint16_t, uint16_t, 10>(dist(block, lane));
+      });
+    } else if (data->dtype.bits == 32) {
+      Fill<float>(data, dist);
+    } else if (data->dtype.bits == 64) {
+      Fill<double>(data, dist);
+    } else {
+      LOG(FATAL) << "Doesn't support dtype code " << data->dtype.code << " dtype bits "
+                 << data->dtype.bits;
+    }
+  }
+
+ private:
+  /*! \brief Maps a word to [0, 1) with the 24 bits a float can hold. */
+  static float ToUnit(uint32_t x) { return (x >> 8) * (1.0f / 16777216.0f); }
+
+  template <typename T, typename F>
+  struct FillClosure {
+    T* data;
+    int64_t size;
+    uint64_t seed;
+    uint64_t offset;
+    const F* sample;
+  };
+
+  template <typename T, typename F>
+  static int FillLambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    auto* closure = static_cast<FillClosure<T, F>*>(cdata);
+    // Element i takes lane (offset + i) % 4 of block (offset + i) / 4. Split on block
+    // boundaries, so that each block is computed once.
+    uint64_t begin = closure->offset;
+    uint64_t end = closure->offset + closure->size;
+    int64_t num_blocks = static_cast<int64_t>((end + 3) / 4 - begin / 4);
+    int64_t step = (num_blocks + penv->num_task - 1) / penv->num_task;
+    int64_t block_begin = std::min(task_id * step, num_blocks);
+    int64_t block_end = std::min(block_begin + step, num_blocks);
+    for (int64_t b = block_begin; b < block_end; ++b) {
+      uint64_t counter = begin / 4 + b;
+      std::array<uint32_t, 4> block = Block(closure->seed, counter);
+      for (int lane = 0; lane < 4; ++lane) {
+        uint64_t pos = counter * 4 + lane;
+        if (pos < begin || pos >= end) continue;
+        closure->data[pos - begin] = static_cast<T>((*closure->sample)(block, lane));
+      }
+    }
+    return 0;
+  }
+
+  /*!
+   * \brief Fills a tensor of T elementwise with sample(block, lane), on the host, and advances the
+   *  offset past it. Tensors on other devices are filled on the host and copied.
+   */
+  template <typename T, typename F>
+  void Fill(DLTensor* data, const F& sample) {
+    int64_t size = 1;
+    for (int i = 0; i < data->ndim; ++i) {
+      size *= data->shape[i];
+    }
+    runtime::NDArray local;
+    DLTensor* host = data;
+    if (data->ctx.device_type != kDLCPU) {
+      local = runtime::NDArray::Empty(std::vector<int64_t>{data->shape, data->shape + data->ndim},
+                                      data->dtype, {kDLCPU, 0});
+      host = const_cast<DLTensor*>(local.operator->());
+    }
+    FillClosure<T, F> closure{static_cast<T*>(host->data), size, seed_, offset_, &sample};
+    if (size < kParallelMinSize) {
+      TVMParallelGroupEnv env{nullptr, 1};
+      FillLambda<T, F>(0, &env, &closure);
+    } else {
+      CHECK_EQ(TVMBackendParallelLaunch(FillLambda<T, F>, &closure, 0), 0);
+    }
+    if (host != data) {
+      runtime::NDArray::CopyFromTo(host, data);
+    }
+    // Start the next tensor on a block boundary, so that no block is shared between tensors.
+    offset_ = (offset_ + size + 3) / 4 * 4;
+  }
+
+  /*! \brief Tensors smaller than this are filled on the calling thread. */
+  static constexpr int64_t kParallelMinSize = 16384;
+
+  uint64_t seed_;
+  uint64_t offset_;
+};
+
+}  // namespace contrib
+}  // namespace tvm
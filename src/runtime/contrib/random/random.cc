@@ -117,6 +117,26 @@ TVM_REGISTER_GLOBAL("tvm.contrib.random.normal").set_body([](TVMArgs args, TVMRe
   entry->random_engine.SampleNormal(out, loc, scale);
 });
 
+TVM_REGISTER_GLOBAL("tvm.contrib.random.philox_uniform")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      int64_t seed = args[0];
+      int64_t offset = args[1];
+      double low = args[2];
+      double high = args[3];
+      DLTensor* out = args[4];
+      PhiloxRandomEngine(seed, offset).SampleUniform(out, low, high);
+    });
+
+TVM_REGISTER_GLOBAL("tvm.contrib.random.philox_normal")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      int64_t seed = args[0];
+      int64_t offset = args[1];
+      double loc = args[2];
+      double scale = args[3];
+      DLTensor* out = args[4];
+      PhiloxRandomEngine(seed, offset).SampleNormal(out, loc, scale);
+    });
+
 TVM_REGISTER_GLOBAL("tvm.contrib.random.random_fill").set_body([](TVMArgs args, TVMRetValue* ret) {
   RandomThreadLocalEntry* entry = RandomThreadLocalEntry::ThreadLocal();
   DLTensor* out = args[0];
@@ -22,9 +22,13 @@
  */
 
 #include <dlpack/dlpack.h>
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -124,14 +128,150 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.argsort_nms").set_body([](TVMArgs args, TV
   }
 });
 
+// Rows smaller than this are sorted with std::sort rather than radix sort.
+constexpr int64_t kRadixSortMinSize = 1024;
+// Inputs smaller than this are sorted on the calling thread.
+constexpr int64_t kParallelMinSize = 16384;
+
+// Whether the keys of a type can be radix sorted.
+template <typename DataType>
+struct IsRadixSortable
+    : std::integral_constant<bool, (std::is_floating_point<DataType>::value ||
+                                    std::is_integral<DataType>::value) &&
+                                       (sizeof(DataType) == 4 || sizeof(DataType) == 8)> {};
+
+// Map a value to an unsigned key with the same ascending order. Every NaN sorts after
+// +inf (or before -inf when its sign bit is set), which keeps the order total.
+template <typename DataType, typename KeyType = typename std::conditional<
+                                 sizeof(DataType) == 8, uint64_t, uint32_t>::type>
+KeyType ToRadixKey(DataType value) {
+  const KeyType sign_bit = KeyType(1) << (sizeof(KeyType) * 8 - 1);
+  if (std::is_floating_point<DataType>::value && value == 0) {
+    // -0.0 and 0.0 compare equal.
+    value = 0;
+  }
+  KeyType bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if (std::is_unsigned<DataType>::value) {
+    return bits;
+  }
+  if (!std::is_floating_point<DataType>::value) {
+    // Flipping the sign bit moves the negative values before the positive ones.
+    return bits ^ sign_bit;
+  }
+  return (bits & sign_bit) ? ~bits : bits | sign_bit;
+}
+
+// Stable LSD radix sort of (key, index) entries by key, one byte per pass.
+template <typename KeyType>
+void RadixSort(std::vector<std::pair<KeyType, int64_t>>* entries) {
+  std::vector<std::pair<KeyType, int64_t>> buffer(entries->size());
+  auto* src = entries;
+  auto* dst = &buffer;
+  for (size_t shift = 0; shift < sizeof(KeyType) * 8; shift += 8) {
+    int64_t count[257] = {0};
+    for (const auto& entry : *src) {
+      ++count[((entry.first >> shift) & 0xFF) + 1];
+    }
+    // Skip the pass when all the keys share this byte.
+    if (count[((src->front().first >> shift) & 0xFF) + 1] == static_cast<int64_t>(src->size())) {
+      continue;
+    }
+    for (int i = 0; i < 256; ++i) {
+      count[i + 1] += count[i];
+    }
+    for (const auto& entry : *src) {
+      (*dst)[count[(entry.first >> shift) & 0xFF]++] = entry;
+    }
+    std::swap(src, dst);
+  }
+  if (src != entries) {
+    entries->swap(buffer);
+  }
+}
+
+// Write the indices of the first k elements of a row in sorted order to order. Ties keep the
+// order of the input, as with std::stable_sort.
+template <typename DataType>
+void SortRow(const DataType* data, int64_t stride, int64_t n, int64_t k, bool is_ascend,
+             std::vector<int64_t>* order, std::true_type /* radix sortable */) {
+  using KeyType = decltype(ToRadixKey(DataType()));
+  // The index breaks ties, so every ordering of the entries below agrees with a stable sort.
+  std::vector<std::pair<KeyType, int64_t>> entries(n);
+  for (int64_t i = 0; i < n; ++i) {
+    KeyType key = ToRadixKey(data[i * stride]);
+    entries[i] = std::make_pair(is_ascend ? key : ~key, i);
+  }
+  if (k < n) {
+    std::nth_element(entries.begin(), entries.begin() + k, entries.end());
+    std::sort(entries.begin(), entries.begin() + k);
+  } else if (n >= kRadixSortMinSize) {
+    RadixSort(&entries);
+  } else {
+    std::sort(entries.begin(), entries.end());
+  }
+  order->resize(k);
+  for (int64_t i = 0; i < k; ++i) {
+    (*order)[i] = entries[i].second;
+  }
+}
+
+template <typename DataType>
+void SortRow(const DataType* data, int64_t stride, int64_t n, int64_t k, bool is_ascend,
+             std::vector<int64_t>* order, std::false_type /* radix sortable */) {
+  std::vector<std::pair<int64_t, DataType>> sorter;
+  for (int64_t i = 0; i < n; ++i) {
+    sorter.emplace_back(std::make_pair(i, data[i * stride]));
+  }
+  if (is_ascend) {
+    std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
+  } else {
+    std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
+  }
+  order->resize(k);
+  for (int64_t i = 0; i < k; ++i) {
+    (*order)[i] = sorter[i].first;
+  }
+}
+
+template <typename F>
+struct ParallelRowsClosure {
+  const F* f;
+  int64_t num_rows;
+};
+
+template <typename F>
+int ParallelRowsLambda(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  auto* closure = static_cast<ParallelRowsClosure<F>*>(cdata);
+  int64_t step = (closure->num_rows + penv->num_task - 1) / penv->num_task;
+  int64_t begin = std::min(task_id * step, closure->num_rows);
+  int64_t end = std::min(begin + step, closure->num_rows);
+  for (int64_t row = begin; row < end; ++row) {
+    (*closure->f)(row);
+  }
+  return 0;
+}
+
+// Call f on every row in [0, num_rows), on the TVM thread pool when the input is large enough.
+template <typename F>
+void ParallelForRows(int64_t num_rows, int64_t row_size, const F& f) {
+  if (num_rows <= 1 || num_rows * row_size < kParallelMinSize) {
+    for (int64_t row = 0; row < num_rows; ++row) {
+      f(row);
+    }
+    return;
+  }
+  ParallelRowsClosure<F> closure{&f, num_rows};
+  CHECK_EQ(TVMBackendParallelLaunch(ParallelRowsLambda<F>, &closure, 0), 0);
+}
+
 template <typename DataType, typename OutType>
 void argsort(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend) {
   auto data_ptr = static_cast<DataType*>(input->data);
   auto out_ptr = static_cast<OutType*>(output->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -140,24 +280,18 @@ void argsort(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend) {
     }
   }
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
-      }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].first);
-      }
+  int64_t n = input->shape[axis];
+  ParallelForRows(axis_mul_before * axis_mul_after, n, [&](int64_t row) {
+    int64_t i = row / axis_mul_after;
+    int64_t j = row % axis_mul_after;
+    int64_t base_idx = i * n * axis_mul_after + j;
+    std::vector<int64_t> order;
+    SortRow(data_ptr + base_idx, axis_mul_after, n, n, is_ascend, &order,
+            IsRadixSortable<DataType>());
+    for (int64_t k = 0; k < n; ++k) {
+      out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(order[k]);
     }
-  }
+  });
 }
 
 // Argsort implemented C library sort.
@@ -251,10 +385,9 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
       (out_values == nullptr) ? nullptr : static_cast<DataType*>(out_values->data);
   IndicesType* indices_ptr =
       (out_indices == nullptr) ? nullptr : static_cast<IndicesType*>(out_indices->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -262,36 +395,29 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
       axis_mul_after *= input->shape[i];
     }
   }
-  if (k < 1) {
-    k = input->shape[axis];
+  int64_t n = input->shape[axis];
+  if (k < 1 || k > n) {
+    k = n;
   }
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t src_base_idx = i * input->shape[axis] * axis_mul_after + j;
-      int64_t dst_base_idx = i * k * axis_mul_after + j;
-      for (int64_t kk = 0; kk < input->shape[axis]; ++kk) {
-        int64_t full_idx = src_base_idx + kk * axis_mul_after;
-        sorter.emplace_back(std::make_pair(kk, data_ptr[full_idx]));
+  ParallelForRows(axis_mul_before * axis_mul_after, n, [&](int64_t row) {
+    int64_t i = row / axis_mul_after;
+    int64_t j = row % axis_mul_after;
+    int64_t src_base_idx = i * n * axis_mul_after + j;
+    int64_t dst_base_idx = i * k * axis_mul_after + j;
+    std::vector<int64_t> order;
+    SortRow(data_ptr + src_base_idx, axis_mul_after, n, k, is_ascend, &order,
+            IsRadixSortable<DataType>());
+    for (int64_t kk = 0; kk < k; ++kk) {
+      if (indices_ptr != nullptr) {
+        indices_ptr[dst_base_idx + kk * axis_mul_after] = static_cast<IndicesType>(order[kk]);
       }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      int64_t cnt = k > 0 ? k : input->shape[axis];
-      for (int64_t kk = 0; kk < cnt; ++kk) {
-        if (indices_ptr != nullptr) {
-          indices_ptr[dst_base_idx + kk * axis_mul_after] =
-              static_cast<IndicesType>(sorter[kk].first);
-        }
-        if (values_ptr != nullptr) {
-          values_ptr[dst_base_idx + kk * axis_mul_after] = static_cast<DataType>(sorter[kk].second);
-        }
+      if (values_ptr != nullptr) {
+        values_ptr[dst_base_idx + kk * axis_mul_after] =
+            data_ptr[src_base_idx + order[kk] * axis_mul_after];
       }
     }
-  }
+  });
 }
 
 // Argsort implemented C library sort.
@@ -22,11 +22,16 @@
  */
 #include "tflite_runtime.h"
 
+#include <tensorflow/core/public/version.h>
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/kernels/register.h>
 #include <tensorflow/lite/model.h>
+#include <tensorflow/lite/util.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstring>
+#include <utility>
+
 namespace tvm {
 namespace runtime {
 
@@ -68,6 +73,13 @@ namespace runtime {
     LOG(FATAL) << "unknown data type " << type; \
   }
 
+// Inputs can be bound to external buffers since TensorFlow 2.4.
+#if TF_MAJOR_VERSION > 2 || (TF_MAJOR_VERSION == 2 && TF_MINOR_VERSION >= 4)
+#define TVM_TFLITE_CUSTOM_ALLOCATION 1
+#else
+#define TVM_TFLITE_CUSTOM_ALLOCATION 0
+#endif
+
 DataType TfLiteDType2TVMDType(TfLiteType dtype) {
   switch (dtype) {
     case kTfLiteFloat32:
@@ -90,46 +102,139 @@ DataType TfLiteDType2TVMDType(TfLiteType dtype) {
   }
 }
 
-void TFLiteRuntime::Init(const std::string& tflite_model_bytes, TVMContext ctx) {
+void TFLiteRuntime::Init(const std::string& tflite_model_bytes, TVMContext ctx, int num_threads,
+                         int max_interpreters) {
+  CHECK_GE(max_interpreters, 1) << "The pool needs at least one interpreter.";
   const char* buffer = tflite_model_bytes.c_str();
   size_t buffer_size = tflite_model_bytes.size();
   // The buffer used to construct the model must be kept alive for
   // dependent interpreters to be used.
   flatBuffersBuffer_ = std::unique_ptr<char[]>(new char[buffer_size]);
   std::memcpy(flatBuffersBuffer_.get(), buffer, buffer_size);
-  std::unique_ptr<tflite::FlatBufferModel> model =
-      tflite::FlatBufferModel::BuildFromBuffer(flatBuffersBuffer_.get(), buffer_size);
+  model_ = tflite::FlatBufferModel::BuildFromBuffer(flatBuffersBuffer_.get(), buffer_size);
+  CHECK(model_ != nullptr) << "Failed to load the tflite model.";
+  num_threads_ = num_threads;
+  max_interpreters_ = max_interpreters;
+  ctx_ = ctx;
+  primary_ = CreateInterpreter();
+}
+
+std::unique_ptr<tflite::Interpreter> TFLiteRuntime::BuildInterpreter(int num_threads) {
   tflite::ops::builtin::BuiltinOpResolver resolver;
+  std::unique_ptr<tflite::Interpreter> interpreter;
   // Build interpreter
-  TfLiteStatus status = tflite::InterpreterBuilder(*model, resolver)(&interpreter_);
+  TfLiteStatus status = tflite::InterpreterBuilder(*model_, resolver)(&interpreter);
   CHECK_TFLITE_STATUS(status) << "Failed to build interpreter.";
+  interpreter->SetNumThreads(num_threads > 0 ? num_threads : DefaultNumThreads());
   // Allocate tensors
-  status = interpreter_->AllocateTensors();
+  status = interpreter->AllocateTensors();
   CHECK_TFLITE_STATUS(status) << "Failed to allocate tensors.";
+  return interpreter;
+}
 
-  ctx_ = ctx;
+std::unique_ptr<TFLiteInterpreter> TFLiteRuntime::CreateInterpreter() {
+  std::unique_ptr<TFLiteInterpreter> entry(new TFLiteInterpreter());
+  entry->num_threads = num_threads_;
+  entry->interpreter = BuildInterpreter(entry->num_threads);
+  size_t num_inputs = entry->interpreter->inputs().size();
+  entry->bound_inputs.resize(num_inputs, nullptr);
+  entry->staging_inputs.resize(num_inputs);
+  return entry;
 }
 
-void TFLiteRuntime::Invoke() { interpreter_->Invoke(); }
+std::unique_ptr<TFLiteInterpreter> TFLiteRuntime::AcquireInterpreter() {
+  std::unique_lock<std::mutex> lock(pool_mutex_);
+  if (idle_.empty() && num_pooled_ < max_interpreters_) {
+    ++num_pooled_;
+    lock.unlock();
+    return CreateInterpreter();
+  }
+  pool_cv_.wait(lock, [this] { return !idle_.empty(); });
+  std::unique_ptr<TFLiteInterpreter> entry = std::move(idle_.back());
+  idle_.pop_back();
+  if (entry->num_threads != num_threads_) {
+    entry->num_threads = num_threads_;
+    entry->interpreter->SetNumThreads(num_threads_ > 0 ? num_threads_ : DefaultNumThreads());
+  }
+  return entry;
+}
+
+void TFLiteRuntime::ReleaseInterpreter(std::unique_ptr<TFLiteInterpreter> entry) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    idle_.push_back(std::move(entry));
+  }
+  pool_cv_.notify_one();
+}
 
-void TFLiteRuntime::SetInput(int index, DLTensor* data_in) {
+void TFLiteRuntime::SetNumThreads(int num_threads) {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  num_threads_ = num_threads;
+  // The interpreters of the pool pick the setting up when they are acquired.
+  primary_->num_threads = num_threads;
+  primary_->interpreter->SetNumThreads(num_threads > 0 ? num_threads : DefaultNumThreads());
+}
+
+void TFLiteRuntime::BindInput(TFLiteInterpreter* entry, int index, const DLTensor* data_in,
+                              bool zero_copy) {
+  tflite::Interpreter* interpreter = entry->interpreter.get();
+  CHECK_LT(static_cast<size_t>(index), interpreter->inputs().size())
+      << "The model only has " << interpreter->inputs().size() << " inputs.";
+  int tensor_index = interpreter->inputs()[index];
+  TfLiteTensor* tensor = interpreter->tensor(tensor_index);
   DataType dtype(data_in->dtype);
-  TVM_DTYPE_DISPATCH(dtype, DType, {
-    DType* dest = interpreter_->typed_input_tensor<DType>(index);
-    DType* src = static_cast<DType*>(data_in->data);
-    CHECK(data_in->strides == NULL);
-    int64_t size = 1;
-    for (int64_t i = 0; i < data_in->ndim; ++i) {
-      size *= data_in->shape[i];
+  CHECK(dtype == TfLiteDType2TVMDType(tensor->type))
+      << "Input " << index << " of the model is " << TfLiteDType2TVMDType(tensor->type)
+      << ", got " << dtype;
+  CHECK(IsContiguous(*data_in)) << "Input " << index << " must be contiguous.";
+  size_t nbytes = GetDataSize(*data_in);
+  CHECK_EQ(nbytes, tensor->bytes) << "Input " << index << " of the model has " << tensor->bytes
+                                  << " bytes, got " << nbytes;
+  const void* data = static_cast<const char*>(data_in->data) + data_in->byte_offset;
+#if TVM_TFLITE_CUSTOM_ALLOCATION
+  // Inputs on the CPU meeting the alignment of the arena are read in place. The
+  // interpreter re-plans its arena when a binding changes, so repeated runs
+  // with the same buffers cost nothing.
+  zero_copy = zero_copy &&
+              (data_in->ctx.device_type == kDLCPU || data_in->ctx.device_type == kDLCPUPinned) &&
+              reinterpret_cast<uintptr_t>(data) % tflite::kDefaultTensorAlignment == 0;
+  const void* binding = nullptr;
+  if (zero_copy) {
+    binding = data;
+  } else if (entry->bound_inputs[index] != nullptr) {
+    // Stop reading the previous external buffer, which may have been released.
+    NDArray& staging = entry->staging_inputs[index];
+    if (!staging.defined()) {
+      std::vector<int64_t> shape(data_in->shape, data_in->shape + data_in->ndim);
+      staging = NDArray::Empty(shape, dtype, {kDLCPU, 0});
     }
-    for (int64_t i = 0; i < size; ++i) {
-      dest[i] = src[i];
-    }
-  });
+    binding = staging->data;
+  }
+  if (binding != entry->bound_inputs[index]) {
+    TfLiteCustomAllocation allocation{const_cast<void*>(binding), nbytes};
+    CHECK_TFLITE_STATUS(interpreter->SetCustomAllocationForTensor(tensor_index, allocation))
+        << "Failed to bind input " << index;
+    CHECK_TFLITE_STATUS(interpreter->AllocateTensors()) << "Failed to allocate tensors.";
+    entry->bound_inputs[index] = zero_copy ? binding : nullptr;
+  }
+  if (zero_copy) return;
+#else
+  (void)zero_copy;
+#endif
+  std::memcpy(tensor->data.raw, data, nbytes);
+}
+
+void TFLiteRuntime::Invoke() {
+  CHECK_TFLITE_STATUS(primary_->interpreter->Invoke()) << "Failed to invoke the model.";
+}
+
+void TFLiteRuntime::SetInput(int index, DLTensor* data_in, bool zero_copy) {
+  BindInput(primary_.get(), index, data_in, zero_copy);
 }
 
 NDArray TFLiteRuntime::GetOutput(int index) const {
-  TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[index]);
+  tflite::Interpreter* interpreter = primary_->interpreter.get();
+  TfLiteTensor* output = interpreter->tensor(interpreter->outputs()[index]);
   DataType dtype = TfLiteDType2TVMDType(output->type);
   TfLiteIntArray* dims = output->dims;
   int64_t size = 1;
@@ -141,7 +246,7 @@ NDArray TFLiteRuntime::GetOutput(int index) const {
   NDArray ret = NDArray::Empty(shape, dtype, ctx_);
   TVM_DTYPE_DISPATCH(dtype, DType, {
     DType* dest = static_cast<DType*>(ret->data);
-    DType* src = interpreter_->typed_output_tensor<DType>(index);
+    DType* src = interpreter->typed_output_tensor<DType>(index);
     for (int64_t i = 0; i < size; ++i) {
       dest[i] = src[i];
     }
@@ -149,6 +254,32 @@ NDArray TFLiteRuntime::GetOutput(int index) const {
   return ret;
 }
 
+void TFLiteRuntime::Run(TVMArgs args) {
+  std::unique_ptr<TFLiteInterpreter> entry = AcquireInterpreter();
+  tflite::Interpreter* interpreter = entry->interpreter.get();
+  int num_inputs = static_cast<int>(interpreter->inputs().size());
+  int num_outputs = static_cast<int>(interpreter->outputs().size());
+  CHECK_EQ(args.size(), num_inputs + num_outputs)
+      << "run expects " << num_inputs << " inputs followed by " << num_outputs << " outputs.";
+  for (int i = 0; i < num_inputs; ++i) {
+    // The inputs outlive this call, so they can be read in place.
+    BindInput(entry.get(), i, args[i], true);
+  }
+  TfLiteStatus status = interpreter->Invoke();
+  if (status == kTfLiteOk) {
+    for (int i = 0; i < num_outputs; ++i) {
+      DLTensor* out = args[num_inputs + i];
+      const TfLiteTensor* tensor = interpreter->output_tensor(i);
+      CHECK_EQ(GetDataSize(*out), tensor->bytes)
+          << "Output " << i << " of the model has " << tensor->bytes << " bytes.";
+      std::memcpy(static_cast<char*>(out->data) + out->byte_offset, tensor->data.raw,
+                  tensor->bytes);
+    }
+  }
+  ReleaseInterpreter(std::move(entry));
+  CHECK_TFLITE_STATUS(status) << "Failed to invoke the model.";
+}
+
 PackedFunc TFLiteRuntime::GetFunction(const std::string& name,
                                       const ObjectPtr<Object>& sptr_to_self) {
   // Return member functions during query.
@@ -156,28 +287,49 @@ PackedFunc TFLiteRuntime::GetFunction(const std::string& name,
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       int in_idx = args[0];
       CHECK_GE(in_idx, 0);
-      this->SetInput(in_idx, args[1]);
+      if (args[1].type_code() == kTVMNDArrayHandle) {
+        // Holding the array lets the interpreter read it in place until it is replaced.
+        NDArray arr = args[1];
+        if (input_refs_.size() <= static_cast<size_t>(in_idx)) {
+          input_refs_.resize(in_idx + 1);
+        }
+        input_refs_[in_idx] = arr;
+        this->SetInput(in_idx, const_cast<DLTensor*>(arr.operator->()), true);
+      } else {
+        this->SetInput(in_idx, args[1]);
+      }
     });
   } else if (name == "get_output") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetOutput(args[0]); });
   } else if (name == "invoke") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Invoke(); });
+  } else if (name == "run") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(args); });
+  } else if (name == "set_num_threads") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetNumThreads(args[0]); });
   } else {
     return PackedFunc();
   }
 }
 
-Module TFLiteRuntimeCreate(const std::string& tflite_model_bytes, TVMContext ctx) {
+Module TFLiteRuntimeCreate(const std::string& tflite_model_bytes, TVMContext ctx,
+                           int num_threads = 0, int max_interpreters = 1) {
   auto exec = make_object<TFLiteRuntime>();
-  exec->Init(tflite_model_bytes, ctx);
+  exec->Init(tflite_model_bytes, ctx, num_threads, max_interpreters);
   return Module(exec);
 }
 
 TVM_REGISTER_GLOBAL("tvm.tflite_runtime.create").set_body([](TVMArgs args, TVMRetValue* rv) {
-  *rv = TFLiteRuntimeCreate(args[0], args[1]);
+  int num_threads = args.size() > 2 ? static_cast<int>(args[2]) : 0;
+  int max_interpreters = args.size() > 3 ? static_cast<int>(args[3]) : 1;
+  *rv = TFLiteRuntimeCreate(args[0], args[1], num_threads, max_interpreters);
 });
 
-TVM_REGISTER_GLOBAL("target.runtime.tflite").set_body_typed(TFLiteRuntimeCreate);
+TVM_REGISTER_GLOBAL("target.runtime.tflite")
+    .set_body_typed([](const std::string& tflite_model_bytes, TVMContext ctx) {
+      return TFLiteRuntimeCreate(tflite_model_bytes, ctx);
+    });
 }  // namespace runtime
 }  // namespace tvm
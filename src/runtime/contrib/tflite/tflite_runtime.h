@@ -27,10 +27,13 @@
 
 #include <dlpack/dlpack.h>
 #include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/model.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -39,11 +42,31 @@ namespace runtime {
 
 #define CHECK_TFLITE_STATUS(ret) CHECK_EQ(ret, kTfLiteOk)
 
+/*!
+ * \brief A tflite interpreter together with the external buffers bound to
+ *  its inputs.
+ */
+struct TFLiteInterpreter {
+  /*! \brief The interpreter. */
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  /*! \brief The number of intra-op threads the interpreter was set up with. */
+  int num_threads{0};
+  /*! \brief The external buffer each input reads in place, nullptr when it is copied. */
+  std::vector<const void*> bound_inputs;
+  /*! \brief Buffers owned by the runtime backing the inputs that stopped reading in place. */
+  std::vector<NDArray> staging_inputs;
+};
+
 /*!
  * \brief Tflite runtime.
  *
  *  This runtime can be accessed in various language via
  *  TVM runtime PackedFunc API.
+ *
+ *  set_input, invoke and get_output drive a primary interpreter and are not
+ *  thread safe. run executes the whole model in a single call on an
+ *  interpreter taken from a pool, so that several threads can run the model
+ *  concurrently.
  */
 class TFLiteRuntime : public ModuleNode {
  public:
@@ -70,15 +93,21 @@ class TFLiteRuntime : public ModuleNode {
    * \brief Initialize the tflite runtime with tflite model and context.
    * \param tflite_model_bytes The tflite model.
    * \param ctx The context where the tflite model will be executed on.
+   * \param num_threads The number of intra-op threads of each interpreter, 0 for the
+   *  default of the interpreter.
+   * \param max_interpreters The maximum number of interpreters serving concurrent runs.
    */
-  void Init(const std::string& tflite_model_bytes, TVMContext ctx);
+  void Init(const std::string& tflite_model_bytes, TVMContext ctx, int num_threads = 0,
+            int max_interpreters = 1);
 
   /*!
    * \brief set index-th input to the model.
    * \param index The input index.
    * \param data_in The input data.
+   * \param zero_copy Whether the interpreter may read data_in in place, in which case
+   *  data_in must stay alive until it is replaced.
    */
-  void SetInput(int index, DLTensor* data_in);
+  void SetInput(int index, DLTensor* data_in, bool zero_copy = false);
   /*!
    * \brief Return NDArray for given input index.
    * \param index The input index.
@@ -94,12 +123,67 @@ class TFLiteRuntime : public ModuleNode {
    */
   NDArray GetOutput(int index) const;
 
+  /*!
+   * \brief Run the model on an interpreter of the pool. Inputs are read in place
+   *  when they are suitably aligned CPU buffers.
+   * \param args The input tensors followed by the output tensors.
+   */
+  void Run(TVMArgs args);
+
+  /*!
+   * \brief Set the number of intra-op threads of all the interpreters.
+   * \param num_threads The number of threads, 0 for the default of the interpreter.
+   */
+  void SetNumThreads(int num_threads);
+
   // Buffer backing the interpreter's model
   std::unique_ptr<char[]> flatBuffersBuffer_;
-  // TFLite interpreter
-  std::unique_ptr<tflite::Interpreter> interpreter_;
+  // The model, kept to build the interpreters of the pool
+  std::unique_ptr<tflite::FlatBufferModel> model_;
+  // The primary interpreter, used by set_input, invoke and get_output
+  std::unique_ptr<TFLiteInterpreter> primary_;
   // TVM context
   TVMContext ctx_;
+
+ protected:
+  /*!
+   * \brief Build an interpreter of the model with its tensors allocated.
+   * \param num_threads The number of intra-op threads.
+   */
+  virtual std::unique_ptr<tflite::Interpreter> BuildInterpreter(int num_threads);
+  /*! \return The number of intra-op threads used when none is configured. */
+  virtual int DefaultNumThreads() const { return -1; }
+
+ private:
+  /*!
+   * \brief Feed an input of an interpreter, in place when allowed and possible.
+   * \param entry The interpreter.
+   * \param index The input index.
+   * \param data_in The input data.
+   * \param zero_copy Whether data_in may be read in place.
+   */
+  void BindInput(TFLiteInterpreter* entry, int index, const DLTensor* data_in, bool zero_copy);
+  /*! \brief Build an interpreter along with its bookkeeping. */
+  std::unique_ptr<TFLiteInterpreter> CreateInterpreter();
+  /*! \brief Take an idle interpreter, building one or waiting when the pool is exhausted. */
+  std::unique_ptr<TFLiteInterpreter> AcquireInterpreter();
+  /*! \brief Give an interpreter back to the pool. */
+  void ReleaseInterpreter(std::unique_ptr<TFLiteInterpreter> entry);
+
+  // The inputs the primary interpreter reads in place, kept alive until replaced
+  std::vector<NDArray> input_refs_;
+  // The number of intra-op threads of each interpreter
+  int num_threads_{0};
+  // The maximum number of interpreters of the pool
+  int max_interpreters_{1};
+  // The number of interpreters built for the pool
+  int num_pooled_{0};
+  // The idle interpreters of the pool
+  std::vector<std::unique_ptr<TFLiteInterpreter>> idle_;
+  // Guards the pool and num_threads_
+  std::mutex pool_mutex_;
+  // Signaled when an interpreter returns to the pool
+  std::condition_variable pool_cv_;
 };
 
 }  // namespace runtime
@@ -24,18 +24,49 @@
 #include <dmlc/thread_local.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "workspace_pool.h"
 
 #ifdef __ANDROID__
 #include <android/api-level.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_mbind)
+#define TVM_CPU_NUMA_POLICY 1
+#endif
+#endif
 
 namespace tvm {
 namespace runtime {
+
+/*! \brief The placement of the pages of a CPU allocation over the NUMA nodes. */
+enum class NumaPolicy : int {
+  /*! \brief Leave it to the OS, pages land on the node of the thread touching them first. */
+  kDefault = 0,
+  /*! \brief Pages are spread round-robin over all the nodes. */
+  kInterleave = 1,
+  /*! \brief Pages are placed on the node of the allocating thread. */
+  kLocal = 2,
+  /*! \brief Pages are placed on a given node. */
+  kBind = 3,
+};
+
+/*! \brief A NUMA policy and its node, for kBind. */
+struct NumaPlacement {
+  NumaPolicy policy{NumaPolicy::kDefault};
+  int node{-1};
+};
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(TVMContext ctx) final {}
@@ -46,6 +77,15 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
   void* AllocDataSpace(TVMContext ctx, size_t nbytes, size_t alignment,
                        DLDataType type_hint) final {
+    const NumaPlacement& placement = in_workspace_alloc_ ? workspace_numa_ : data_numa_;
+#ifdef TVM_CPU_NUMA_POLICY
+    // Pages have a single policy, so placed allocations own all of their pages.
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (placement.policy != NumaPolicy::kDefault && nbytes >= page_size) {
+      nbytes = (nbytes + page_size - 1) / page_size * page_size;
+      alignment = std::max(alignment, page_size);
+    }
+#endif
     void* ptr;
 #if _MSC_VER
     ptr = _aligned_malloc(nbytes, alignment);
@@ -58,6 +98,7 @@ class CPUDeviceAPI final : public DeviceAPI {
     int ret = posix_memalign(&ptr, alignment, nbytes);
     if (ret != 0) throw std::bad_alloc();
 #endif
+    Place(ptr, nbytes, placement);
     return ptr;
   }
 
@@ -80,12 +121,76 @@ class CPUDeviceAPI final : public DeviceAPI {
   void* AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) final;
   void FreeWorkspace(TVMContext ctx, void* data) final;
 
+  /*!
+   * \brief Set the NUMA policy of the allocations.
+   * \param workspace Whether to set the policy of the workspaces or of the other data,
+   *  e.g. the parameters and the intermediate tensors of a model.
+   * \param placement The policy.
+   */
+  void SetNumaPolicy(bool workspace, NumaPlacement placement) {
+    if (placement.policy == NumaPolicy::kBind) {
+      std::vector<int> nodes = threading::NumaNodes();
+      CHECK(std::find(nodes.begin(), nodes.end(), placement.node) != nodes.end())
+          << "Cannot find NUMA node " << placement.node;
+    }
+    (workspace ? workspace_numa_ : data_numa_) = placement;
+  }
+
   static CPUDeviceAPI* Global() {
     // NOTE: explicitly use new to avoid exit-time destruction of global state
     // Global state will be recycled by OS as the process exits.
     static auto* inst = new CPUDeviceAPI();
     return inst;
   }
+
+ private:
+  friend class CPUWorkspaceAllocScope;
+
+  // apply the NUMA policy to the pages of an allocation
+  void Place(void* ptr, size_t nbytes, const NumaPlacement& placement) {
+#ifdef TVM_CPU_NUMA_POLICY
+    constexpr int kMpolPreferred = 1;
+    constexpr int kMpolBind = 2;
+    constexpr int kMpolInterleave = 3;
+    constexpr unsigned kMpolMfMove = 1 << 1;
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (placement.policy == NumaPolicy::kDefault || nbytes < page_size) return;
+    std::vector<int> nodes = threading::NumaNodes();
+    if (nodes.size() < 2) return;
+    int max_node = *std::max_element(nodes.begin(), nodes.end());
+    constexpr size_t kBitsPerWord = sizeof(unsigned long) * 8;  // NOLINT(*)
+    std::vector<unsigned long> mask(max_node / kBitsPerWord + 1, 0);  // NOLINT(*)
+    int mode = kMpolPreferred;
+    if (placement.policy == NumaPolicy::kInterleave) {
+      mode = kMpolInterleave;
+      for (int node : nodes) mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    } else if (placement.policy == NumaPolicy::kBind) {
+      mode = kMpolBind;
+      mask[placement.node / kBitsPerWord] |= 1UL << (placement.node % kBitsPerWord);
+    }
+    // an empty mask with MPOL_PREFERRED places the pages on the local node.
+    // pages reused by the allocator may already be resident, they are moved.
+    if (syscall(SYS_mbind, ptr, nbytes, mode,
+                placement.policy == NumaPolicy::kLocal ? nullptr : mask.data(),
+                mask.size() * kBitsPerWord + 1, kMpolMfMove) != 0) {
+      LOG(WARNING) << "Cannot set the NUMA policy of a CPU allocation, errno=" << errno;
+    }
+#endif
+  }
+
+  NumaPlacement data_numa_;
+  NumaPlacement workspace_numa_;
+  // whether the calling thread allocates the pages of a workspace
+  static thread_local bool in_workspace_alloc_;
+};
+
+thread_local bool CPUDeviceAPI::in_workspace_alloc_ = false;
+
+/*! \brief Route the allocations of the calling thread to the workspace NUMA policy. */
+class CPUWorkspaceAllocScope {
+ public:
+  CPUWorkspaceAllocScope() { CPUDeviceAPI::in_workspace_alloc_ = true; }
+  ~CPUWorkspaceAllocScope() { CPUDeviceAPI::in_workspace_alloc_ = false; }
 };
 
 struct CPUWorkspacePool : public WorkspacePool {
@@ -93,6 +198,7 @@ struct CPUWorkspacePool : public WorkspacePool {
 };
 
 void* CPUDeviceAPI::AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) {
+  CPUWorkspaceAllocScope scope;
   return dmlc::ThreadLocalStore<CPUWorkspacePool>::Get()->AllocWorkspace(ctx, size);
 }
 
@@ -104,5 +210,27 @@ TVM_REGISTER_GLOBAL("device_api.cpu").set_body([](TVMArgs args, TVMRetValue* rv)
   DeviceAPI* ptr = CPUDeviceAPI::Global();
   *rv = static_cast<void*>(ptr);
 });
+
+TVM_REGISTER_GLOBAL("device_api.cpu.set_numa_policy").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string kind = args[0];
+  std::string policy = args[1];
+  CHECK(kind == "data" || kind == "workspace")
+      << "The NUMA policy applies to \"data\" or \"workspace\", got " << kind;
+  NumaPlacement placement;
+  if (policy == "default") {
+    placement.policy = NumaPolicy::kDefault;
+  } else if (policy == "interleave") {
+    placement.policy = NumaPolicy::kInterleave;
+  } else if (policy == "local") {
+    placement.policy = NumaPolicy::kLocal;
+  } else if (policy == "bind") {
+    CHECK_GT(args.size(), 2) << "The bind NUMA policy requires a node";
+    placement.policy = NumaPolicy::kBind;
+    placement.node = args[2];
+  } else {
+    LOG(FATAL) << "Unknown NUMA policy " << policy;
+  }
+  CPUDeviceAPI::Global()->SetNumaPolicy(kind == "workspace", placement);
+});
 }  // namespace runtime
 }  // namespace tvm
@@ -34,6 +34,7 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/crt/internal/common/logging.h>
 #include <tvm/runtime/crt/internal/common/memory.h>
+#include <tvm/runtime/crt/internal/common/memory_tlsf.h>
 #include <tvm/runtime/crt/memory.h>
 #include <tvm/runtime/crt/platform.h>
 
@@ -308,6 +309,50 @@ void MemoryManagerCreate(MemoryManager* manager, uint8_t* memory_pool,
   manager->free_map.insert = MultiMap_Insert;
 }
 
+#if TVM_CRT_MEMORY_ALLOCATOR == TVM_CRT_MEMORY_ALLOCATOR_TLSF
+
+TLSFAllocator* TVMGetGlobalTLSFAllocator() {
+  /* initialize once */
+  static uint32_t initialized = 0;
+  static TLSFAllocator alloc;
+  if (!initialized) {
+    TLSFAllocatorCreate(&alloc, g_memory_pool, TVM_CRT_VIRT_MEM_SIZE);
+    initialized = 1;
+  }
+  return &alloc;
+}
+
+/** \brief Allocate memory from allocator */
+void* vmalloc(size_t size) {
+  TLSFAllocator* alloc = TVMGetGlobalTLSFAllocator();
+  void* data = alloc->Alloc(alloc, size);
+  CHECK_NE(data, NULL, "insufficient memory, size=%zu, free=%zu", size, alloc->free_bytes);
+  return data;
+}
+
+/** \brief Reallocate memory from allocator */
+void* vrealloc(void* ptr, size_t size) {
+  TLSFAllocator* alloc = TVMGetGlobalTLSFAllocator();
+  void* data = alloc->Realloc(alloc, ptr, size);
+  CHECK_NE(data, NULL, "insufficient memory, size=%zu, free=%zu", size, alloc->free_bytes);
+  return data;
+}
+
+/** \brief Release memory from allocator */
+void vfree(void* ptr) {
+  TLSFAllocator* alloc = TVMGetGlobalTLSFAllocator();
+  alloc->Free(alloc, ptr);
+}
+
+/** \brief Report the statistics of the allocator */
+int vstats(VirtualMemoryStats* stats) {
+  TLSFAllocator* alloc = TVMGetGlobalTLSFAllocator();
+  alloc->Stats(alloc, stats);
+  return 0;
+}
+
+#else
+
 MemoryManager* TVMGetGlobalMemoryManager() {
   /* initialize once */
   static uint32_t initialized = 0;
@@ -338,4 +383,9 @@ void vfree(void* ptr) {
   mgr->Free(mgr, ptr);
 }
 
+/** \brief The page allocator keeps no statistics */
+int vstats(VirtualMemoryStats* stats) { return -1; }
+
+#endif  // TVM_CRT_MEMORY_ALLOCATOR
+
 int vleak_size = 0;
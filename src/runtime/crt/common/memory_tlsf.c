@@ -0,0 +1,367 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+// LINT_C_FILE
+
+/*!
+ * \file memory_tlsf.c
+ * \brief Two-level segregated-fit (TLSF) memory allocator
+ *
+ * Every block starts with a header holding its payload size and the address of
+ * the block before it in the pool, so that a released block merges with both
+ * neighbours in constant time. A free block also keeps the links of its free
+ * list at the start of its payload. The pool ends with a sentinel block of size
+ * zero that is never free.
+ *
+ * A size falls in first-level class floor(log2(size)), split into
+ * TVM_CRT_TLSF_SL_COUNT linear second-level classes. Allocation rounds the
+ * request up to the next class boundary, so that any block in the first
+ * non-empty class at or above it fits, and finds that class with two bit scans.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <tvm/runtime/crt/internal/common/memory_tlsf.h>
+
+/*! \brief Set in TLSFBlock::size while the block is in a free list. */
+#define TLSF_BLOCK_FREE ((size_t)1)
+
+#define TLSF_ALIGN_BYTES ((size_t)1 << TVM_CRT_TLSF_ALIGN_LOG2)
+
+/*! \brief Header size, rounded up so that payloads keep the allocation alignment. */
+#define TLSF_HEADER_BYTES \
+  ((2 * sizeof(void*) + TLSF_ALIGN_BYTES - 1) & ~(TLSF_ALIGN_BYTES - 1))
+
+/*! \brief Smallest payload; it must hold the free list links. */
+#define TLSF_MIN_BLOCK_BYTES TLSF_ALIGN_BYTES
+
+/*! \brief Sizes below this share the first first-level class, in steps of TLSF_ALIGN_BYTES. */
+#define TLSF_SMALL_BLOCK_BYTES ((size_t)1 << (TVM_CRT_TLSF_ALIGN_LOG2 + TVM_CRT_TLSF_SL_LOG2))
+
+#define TLSF_MAX_BLOCK_BYTES \
+  ((((size_t)1 << TVM_CRT_TLSF_MAX_SIZE_LOG2) - 1) & ~(TLSF_ALIGN_BYTES - 1))
+
+struct TLSFBlock {
+  // Block before this one in the pool, NULL for the first block.
+  struct TLSFBlock* prev_phys;
+  // Payload bytes, a multiple of TLSF_ALIGN_BYTES, or'ed with TLSF_BLOCK_FREE.
+  size_t size;
+};
+
+// Free list links, stored in the payload of a free block.
+typedef struct TLSFFreeLinks {
+  TLSFBlock* next;
+  TLSFBlock* prev;
+} TLSFFreeLinks;
+
+static inline size_t TLSFBlock_Size(const TLSFBlock* block) {
+  return block->size & ~TLSF_BLOCK_FREE;
+}
+
+static inline bool TLSFBlock_IsFree(const TLSFBlock* block) {
+  return (block->size & TLSF_BLOCK_FREE) != 0;
+}
+
+static inline uint8_t* TLSFBlock_Payload(TLSFBlock* block) {
+  return (uint8_t*)block + TLSF_HEADER_BYTES;  // NOLINT(*)
+}
+
+static inline TLSFBlock* TLSFBlock_FromPayload(void* ptr) {
+  return (TLSFBlock*)((uint8_t*)ptr - TLSF_HEADER_BYTES);  // NOLINT(*)
+}
+
+static inline TLSFBlock* TLSFBlock_Next(TLSFBlock* block) {
+  return (TLSFBlock*)(TLSFBlock_Payload(block) + TLSFBlock_Size(block));  // NOLINT(*)
+}
+
+static inline TLSFFreeLinks* TLSFBlock_Links(TLSFBlock* block) {
+  return (TLSFFreeLinks*)TLSFBlock_Payload(block);  // NOLINT(*)
+}
+
+// Index of the most significant set bit, x must be non-zero.
+static inline uint32_t TLSFFindLastSet(size_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint32_t)(sizeof(unsigned long long) * 8 - 1 -  // NOLINT(*)
+                    __builtin_clzll((unsigned long long)x));  // NOLINT(*)
+#else
+  uint32_t bit = 0;
+  while (x >>= 1) {
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+// Index of the least significant set bit, x must be non-zero.
+static inline uint32_t TLSFFindFirstSet(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint32_t)__builtin_ctz(x);
+#else
+  uint32_t bit = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    bit++;
+  }
+  return bit;
+#endif
+}
+
+// The size class that holds blocks of the given size.
+static void TLSFMapping(size_t size, uint32_t* fl, uint32_t* sl) {
+  if (size < TLSF_SMALL_BLOCK_BYTES) {
+    *fl = 0;
+    *sl = (uint32_t)(size >> TVM_CRT_TLSF_ALIGN_LOG2);
+  } else {
+    uint32_t log2 = TLSFFindLastSet(size);
+    *sl = (uint32_t)(size >> (log2 - TVM_CRT_TLSF_SL_LOG2)) ^ TVM_CRT_TLSF_SL_COUNT;
+    *fl = log2 - (TVM_CRT_TLSF_ALIGN_LOG2 + TVM_CRT_TLSF_SL_LOG2) + 1;
+  }
+}
+
+static void TLSFAllocator_InsertFree(TLSFAllocator* alloc, TLSFBlock* block) {
+  uint32_t fl, sl;
+  TLSFMapping(TLSFBlock_Size(block), &fl, &sl);
+  TLSFBlock* head = alloc->free_lists[fl][sl];
+  TLSFFreeLinks* links = TLSFBlock_Links(block);
+  links->next = head;
+  links->prev = NULL;
+  if (head != NULL) {
+    TLSFBlock_Links(head)->prev = block;
+  }
+  alloc->free_lists[fl][sl] = block;
+  alloc->fl_bitmap |= 1U << fl;
+  alloc->sl_bitmap[fl] |= 1U << sl;
+  block->size |= TLSF_BLOCK_FREE;
+  alloc->free_bytes += TLSFBlock_Size(block);
+  alloc->num_free_blocks++;
+}
+
+static void TLSFAllocator_RemoveFree(TLSFAllocator* alloc, TLSFBlock* block) {
+  uint32_t fl, sl;
+  TLSFMapping(TLSFBlock_Size(block), &fl, &sl);
+  TLSFFreeLinks* links = TLSFBlock_Links(block);
+  if (links->next != NULL) {
+    TLSFBlock_Links(links->next)->prev = links->prev;
+  }
+  if (links->prev != NULL) {
+    TLSFBlock_Links(links->prev)->next = links->next;
+  } else {
+    alloc->free_lists[fl][sl] = links->next;
+    if (links->next == NULL) {
+      alloc->sl_bitmap[fl] &= ~(1U << sl);
+      if (alloc->sl_bitmap[fl] == 0) {
+        alloc->fl_bitmap &= ~(1U << fl);
+      }
+    }
+  }
+  block->size &= ~TLSF_BLOCK_FREE;
+  alloc->free_bytes -= TLSFBlock_Size(block);
+  alloc->num_free_blocks--;
+}
+
+// Find a free block of at least size bytes, or NULL.
+static TLSFBlock* TLSFAllocator_FindFree(TLSFAllocator* alloc, size_t size) {
+  if (size >= TLSF_SMALL_BLOCK_BYTES) {
+    // Round up to the next class so that every block of the class found fits.
+    size += ((size_t)1 << (TLSFFindLastSet(size) - TVM_CRT_TLSF_SL_LOG2)) - 1;
+  }
+  uint32_t fl, sl;
+  TLSFMapping(size, &fl, &sl);
+  if (fl >= TVM_CRT_TLSF_FL_COUNT) {
+    return NULL;
+  }
+  uint32_t sl_map = alloc->sl_bitmap[fl] & (~0U << sl);
+  if (sl_map == 0) {
+    uint32_t fl_map = alloc->fl_bitmap & (~0U << (fl + 1));
+    if (fl_map == 0) {
+      return NULL;
+    }
+    fl = TLSFFindFirstSet(fl_map);
+    sl_map = alloc->sl_bitmap[fl];
+  }
+  sl = TLSFFindFirstSet(sl_map);
+  return alloc->free_lists[fl][sl];
+}
+
+// Shrink a used block to size bytes, returning the tail to the free lists.
+static void TLSFAllocator_Trim(TLSFAllocator* alloc, TLSFBlock* block, size_t size) {
+  size_t block_size = TLSFBlock_Size(block);
+  if (block_size < size + TLSF_HEADER_BYTES + TLSF_MIN_BLOCK_BYTES) {
+    return;
+  }
+  TLSFBlock* next = TLSFBlock_Next(block);
+  TLSFBlock* rest = (TLSFBlock*)(TLSFBlock_Payload(block) + size);  // NOLINT(*)
+  rest->prev_phys = block;
+  rest->size = block_size - size - TLSF_HEADER_BYTES;
+  block->size = size;
+  if (TLSFBlock_IsFree(next)) {
+    TLSFAllocator_RemoveFree(alloc, next);
+    rest->size += TLSF_HEADER_BYTES + TLSFBlock_Size(next);
+    next = TLSFBlock_Next(rest);
+  }
+  next->prev_phys = rest;
+  TLSFAllocator_InsertFree(alloc, rest);
+}
+
+static size_t TLSFAdjustSize(size_t size) {
+  if (size > TLSF_MAX_BLOCK_BYTES) {
+    return 0;
+  }
+  size = (size + TLSF_ALIGN_BYTES - 1) & ~(TLSF_ALIGN_BYTES - 1);
+  return size < TLSF_MIN_BLOCK_BYTES ? TLSF_MIN_BLOCK_BYTES : size;
+}
+
+/*!
+ * \brief Allocate memory from the allocator
+ * \param size The size of memory
+ * \return The address, NULL when no free block is large enough
+ */
+void* TLSFAllocator_Alloc(TLSFAllocator* alloc, size_t size) {
+  size = TLSFAdjustSize(size);
+  TLSFBlock* block = size != 0 ? TLSFAllocator_FindFree(alloc, size) : NULL;
+  if (block == NULL) {
+    return NULL;
+  }
+  TLSFAllocator_RemoveFree(alloc, block);
+  TLSFAllocator_Trim(alloc, block, size);
+  alloc->used_bytes += TLSFBlock_Size(block);
+  alloc->num_used_blocks++;
+  vleak_size++;
+  return TLSFBlock_Payload(block);
+}
+
+/*!
+ * \brief Free the memory.
+ * \param ptr The pointer to the memory to deallocate
+ */
+void TLSFAllocator_Free(TLSFAllocator* alloc, void* ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  TLSFBlock* block = TLSFBlock_FromPayload(ptr);
+  alloc->used_bytes -= TLSFBlock_Size(block);
+  alloc->num_used_blocks--;
+  vleak_size--;
+
+  TLSFBlock* prev = block->prev_phys;
+  if (prev != NULL && TLSFBlock_IsFree(prev)) {
+    TLSFAllocator_RemoveFree(alloc, prev);
+    prev->size += TLSF_HEADER_BYTES + TLSFBlock_Size(block);
+    block = prev;
+  }
+  TLSFBlock* next = TLSFBlock_Next(block);
+  if (TLSFBlock_IsFree(next)) {
+    TLSFAllocator_RemoveFree(alloc, next);
+    block->size += TLSF_HEADER_BYTES + TLSFBlock_Size(next);
+    next = TLSFBlock_Next(block);
+  }
+  next->prev_phys = block;
+  TLSFAllocator_InsertFree(alloc, block);
+}
+
+/*!
+ * \brief Reallocate memory, growing into the following block when it is free
+ * \param ptr The pointer to the memory area to be reallocated
+ * \param size The size of memory
+ * \return The address, NULL when no free block is large enough; ptr stays valid then
+ */
+void* TLSFAllocator_Realloc(TLSFAllocator* alloc, void* ptr, size_t size) {
+  if (ptr == NULL) {
+    return TLSFAllocator_Alloc(alloc, size);
+  }
+  size = TLSFAdjustSize(size);
+  if (size == 0) {
+    return NULL;
+  }
+  TLSFBlock* block = TLSFBlock_FromPayload(ptr);
+  size_t old_size = TLSFBlock_Size(block);
+  TLSFBlock* next = TLSFBlock_Next(block);
+  if (old_size < size && TLSFBlock_IsFree(next) &&
+      old_size + TLSF_HEADER_BYTES + TLSFBlock_Size(next) >= size) {
+    TLSFAllocator_RemoveFree(alloc, next);
+    block->size += TLSF_HEADER_BYTES + TLSFBlock_Size(next);
+    TLSFBlock_Next(block)->prev_phys = block;
+  }
+  if (TLSFBlock_Size(block) >= size) {
+    TLSFAllocator_Trim(alloc, block, size);
+    alloc->used_bytes += TLSFBlock_Size(block);
+    alloc->used_bytes -= old_size;
+    return ptr;
+  }
+
+  void* data = TLSFAllocator_Alloc(alloc, size);
+  if (data == NULL) {
+    return NULL;
+  }
+  memcpy(data, ptr, old_size);
+  TLSFAllocator_Free(alloc, ptr);
+  return data;
+}
+
+/*!
+ * \brief Report the occupancy and fragmentation of the pool.
+ * \param stats Filled with the statistics.
+ */
+void TLSFAllocator_Stats(TLSFAllocator* alloc, VirtualMemoryStats* stats) {
+  stats->used_bytes = alloc->used_bytes;
+  stats->free_bytes = alloc->free_bytes;
+  stats->num_used_blocks = alloc->num_used_blocks;
+  stats->num_free_blocks = alloc->num_free_blocks;
+  stats->largest_free_block = 0;
+  if (alloc->fl_bitmap != 0) {
+    // Only the highest non-empty class can hold the largest block.
+    uint32_t fl = TLSFFindLastSet(alloc->fl_bitmap);
+    uint32_t sl = TLSFFindLastSet(alloc->sl_bitmap[fl]);
+    for (TLSFBlock* b = alloc->free_lists[fl][sl]; b != NULL; b = TLSFBlock_Links(b)->next) {
+      size_t size = TLSFBlock_Size(b);
+      if (size > stats->largest_free_block) {
+        stats->largest_free_block = size;
+      }
+    }
+  }
+}
+
+void TLSFAllocatorCreate(TLSFAllocator* alloc, uint8_t* memory_pool,
+                         size_t memory_pool_size_bytes) {
+  memset(alloc, 0, sizeof(TLSFAllocator));
+
+  /* handle TLSFAllocator member functions */
+  alloc->Alloc = TLSFAllocator_Alloc;
+  alloc->Realloc = TLSFAllocator_Realloc;
+  alloc->Free = TLSFAllocator_Free;
+  alloc->Stats = TLSFAllocator_Stats;
+
+  // One free block spanning the aligned pool, followed by the sentinel.
+  uintptr_t begin = ((uintptr_t)memory_pool + TLSF_ALIGN_BYTES - 1) & ~(TLSF_ALIGN_BYTES - 1);
+  uintptr_t end = ((uintptr_t)memory_pool + memory_pool_size_bytes) & ~(TLSF_ALIGN_BYTES - 1);
+  if (end < begin + 2 * TLSF_HEADER_BYTES + TLSF_MIN_BLOCK_BYTES) {
+    return;
+  }
+  size_t size = end - begin - 2 * TLSF_HEADER_BYTES;
+  if (size > TLSF_MAX_BLOCK_BYTES) {
+    size = TLSF_MAX_BLOCK_BYTES;
+  }
+  TLSFBlock* block = (TLSFBlock*)begin;  // NOLINT(*)
+  block->prev_phys = NULL;
+  block->size = size;
+  TLSFBlock* sentinel = TLSFBlock_Next(block);
+  sentinel->prev_phys = block;
+  sentinel->size = 0;
+  TLSFAllocator_InsertFree(alloc, block);
+}
@@ -24,12 +24,14 @@
  * \brief implement graph runtime in pure C
  */
 
+#include <inttypes.h>
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/crt/internal/common/logging.h>
 #include <tvm/runtime/crt/internal/graph_runtime/graph_runtime.h>
 #include <tvm/runtime/crt/memory.h>
 #include <tvm/runtime/crt/module.h>
 #include <tvm/runtime/crt/packed_func.h>
+#include <tvm/runtime/crt/platform.h>
 
 #include "crt_config.h"
 
@@ -77,7 +79,8 @@ int NodeEntry_Load(TVMGraphRuntimeNodeEntry* entry, JSONReader* reader) {
 void TVMGraphRuntimeNode_LoadAttrs(TVMGraphRuntimeNode* node, JSONReader* reader,
                                    TVMOpParam* param) {
   int bitmask = 0;
-  char key[20], value[120];
+  // Graph codegen also emits longer keys, such as "arithmetic_intensity", which are skipped.
+  char key[TVM_CRT_STRLEN_NAME], value[120];
   memset(param, 0, sizeof(TVMOpParam));
   memset(key, 0, sizeof(key));
   memset(value, 0, sizeof(value));
@@ -373,6 +376,59 @@ int TVMGraphRuntimeGraphAttr_Load(TVMGraphRuntimeGraphAttr* attr, JSONReader* re
         status = -1;
         break;
       }
+    } else if (!strcmp(key, "storage_offset")) {
+      reader->BeginArray(reader);
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      status = reader->ReadString(reader, type, sizeof(type));
+      if (status != 0) {
+        fprintf(stderr, "error reading storage_offset array item");
+        break;
+      }
+      if (strcmp(type, "list_int")) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      reader->BeginArray(reader);
+      while (reader->NextArrayItem(reader)) {
+        attr->storage_offset =
+            vrealloc(attr->storage_offset, sizeof(uint32_t) * (attr->storage_offset_count + 1));
+        reader->ReadUnsignedInteger(reader, &(attr->storage_offset[attr->storage_offset_count]));
+        attr->storage_offset_count++;
+      }
+      if (reader->NextArrayItem(reader)) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+    } else if (!strcmp(key, "arena_bytes")) {
+      reader->BeginArray(reader);
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      status = reader->ReadString(reader, type, sizeof(type));
+      if (status != 0 || strcmp(type, "size_t") || !(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      reader->ReadUnsignedInteger(reader, &(attr->arena_bytes));
+      if (reader->NextArrayItem(reader)) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
     } else {
       reader->BeginArray(reader);
       if (!(reader->NextArrayItem(reader))) {
@@ -438,6 +494,14 @@ void TVMGraphRuntimeGraphAttr_Release(TVMGraphRuntimeGraphAttr* attr) {
     vfree(attr->device_index);
     attr->device_index = 0;
   }
+  if (attr->storage_offset) {
+    vfree(attr->storage_offset);
+    attr->storage_offset = 0;
+  }
+  if (attr->dltype_value) {
+    vfree(attr->dltype_value);
+    attr->dltype_value = 0;
+  }
   if (attr->dltype) {
     vfree(attr->dltype);
     attr->dltype = 0;
@@ -535,6 +599,171 @@ int TVMGraphRuntime_Load(TVMGraphRuntime* runtime, JSONReader* reader) {
   return status;
 }
 
+/*! \brief A bounded reader over a serialized binary graph. */
+typedef struct BinaryReader {
+  const char* pos;
+  const char* end;
+  int status;
+} BinaryReader;
+
+static int BinaryRead(BinaryReader* reader, void* out, size_t size) {
+  if (reader->status != 0 || size > (size_t)(reader->end - reader->pos)) {  // NOLINT(*)
+    if (reader->status == 0) {
+      fprintf(stderr, "truncated binary graph\n");
+    }
+    reader->status = -1;
+    memset(out, 0, size);
+    return -1;
+  }
+  memcpy(out, reader->pos, size);
+  reader->pos += size;
+  return 0;
+}
+
+static uint32_t BinaryReadU32(BinaryReader* reader) {
+  uint32_t v;
+  BinaryRead(reader, &v, sizeof(v));
+  return v;
+}
+
+/*! \brief Read a count of elements of elem_size bytes, which must fit in the rest of the blob. */
+static uint32_t BinaryReadCount(BinaryReader* reader, size_t elem_size) {
+  uint32_t count = BinaryReadU32(reader);
+  size_t remaining = (size_t)(reader->end - reader->pos);  // NOLINT(*)
+  if (reader->status == 0 && count > remaining / elem_size) {
+    fprintf(stderr, "invalid binary graph count %u\n", count);
+    reader->status = -1;
+  }
+  return reader->status == 0 ? count : 0;
+}
+
+static int BinaryReadString(BinaryReader* reader, char* out, uint32_t out_size) {
+  uint32_t len = BinaryReadCount(reader, 1);
+  if (len >= out_size) {
+    fprintf(stderr, "binary graph string of length %u does not fit in %u bytes\n", len, out_size);
+    reader->status = -1;
+    return -1;
+  }
+  if (BinaryRead(reader, out, len) != 0) {
+    return -1;
+  }
+  out[len] = '\0';
+  return 0;
+}
+
+static void BinaryReadNodeEntry(BinaryReader* reader, TVMGraphRuntimeNodeEntry* entry) {
+  entry->node_id = BinaryReadU32(reader);
+  entry->index = BinaryReadU32(reader);
+  entry->version = BinaryReadU32(reader);
+}
+
+int TVMGraphRuntime_LoadBinary(TVMGraphRuntime* runtime, const char* blob, uint32_t blob_size) {
+  BinaryReader reader = {blob, blob + blob_size, 0};
+  BinaryReader* strm = &reader;
+  uint64_t magic;
+  uint32_t idx, count;
+  BinaryRead(strm, &magic, sizeof(magic));
+  if (strm->status != 0 || magic != kTVMGraphBinaryMagic) {
+    fprintf(stderr, "invalid binary graph magic\n");
+    return -1;
+  }
+  uint32_t version = BinaryReadU32(strm);
+  if (version != kTVMGraphBinaryVersion) {
+    fprintf(stderr, "unsupported binary graph version %u\n", version);
+    return -1;
+  }
+
+  // Each node takes at least its 3 string lengths and 4 counts.
+  runtime->nodes_count = BinaryReadCount(strm, 7 * sizeof(uint32_t));
+  runtime->nodes = vmalloc(sizeof(TVMGraphRuntimeNode) * runtime->nodes_count);
+  memset(runtime->nodes, 0, sizeof(TVMGraphRuntimeNode) * runtime->nodes_count);
+  for (idx = 0; idx < runtime->nodes_count && strm->status == 0; idx++) {
+    TVMGraphRuntimeNode* node = runtime->nodes + idx;
+    if (BinaryReadString(strm, node->op_type, sizeof(node->op_type)) != 0 ||
+        BinaryReadString(strm, node->name, sizeof(node->name)) != 0 ||
+        BinaryReadString(strm, node->param.func_name, sizeof(node->param.func_name)) != 0) {
+      return -1;
+    }
+    node->param.num_inputs = BinaryReadU32(strm);
+    node->param.num_outputs = BinaryReadU32(strm);
+    node->param.flatten_data = BinaryReadU32(strm);
+    node->inputs_count = BinaryReadCount(strm, 3 * sizeof(uint32_t));
+    if (node->inputs_count) {
+      node->inputs = vmalloc(sizeof(TVMGraphRuntimeNodeEntry) * node->inputs_count);
+      memset(node->inputs, 0, sizeof(TVMGraphRuntimeNodeEntry) * node->inputs_count);
+    }
+    for (count = 0; count < node->inputs_count; count++) {
+      BinaryReadNodeEntry(strm, node->inputs + count);
+    }
+  }
+
+  runtime->input_nodes_count = BinaryReadCount(strm, sizeof(uint32_t));
+  runtime->input_nodes = vmalloc(sizeof(uint32_t) * (runtime->input_nodes_count + 1));
+  for (idx = 0; idx < runtime->input_nodes_count; idx++) {
+    runtime->input_nodes[idx] = BinaryReadU32(strm);
+  }
+  runtime->node_row_ptr_count = BinaryReadCount(strm, sizeof(uint32_t));
+  runtime->node_row_ptr = vmalloc(sizeof(uint32_t) * (runtime->node_row_ptr_count + 1));
+  for (idx = 0; idx < runtime->node_row_ptr_count; idx++) {
+    runtime->node_row_ptr[idx] = BinaryReadU32(strm);
+  }
+  runtime->outputs_count = BinaryReadCount(strm, 3 * sizeof(uint32_t));
+  runtime->outputs = vmalloc(sizeof(TVMGraphRuntimeNodeEntry) * (runtime->outputs_count + 1));
+  memset(runtime->outputs, 0, sizeof(TVMGraphRuntimeNodeEntry) * (runtime->outputs_count + 1));
+  for (idx = 0; idx < runtime->outputs_count; idx++) {
+    BinaryReadNodeEntry(strm, runtime->outputs + idx);
+  }
+
+  TVMGraphRuntimeGraphAttr* attr = &(runtime->attrs);
+  // Each entry takes at least its storage id, DLDataType and ndim.
+  uint32_t num_entries = BinaryReadCount(strm, 2 * sizeof(uint32_t) + sizeof(DLDataType));
+  attr->storage_id = vmalloc(sizeof(uint32_t) * (num_entries + 1));
+  for (idx = 0; idx < num_entries; idx++) {
+    attr->storage_id[idx] = BinaryReadU32(strm);
+  }
+  count = BinaryReadCount(strm, sizeof(uint32_t));
+  if (count) {
+    attr->device_index = vmalloc(sizeof(uint32_t) * count);
+    for (idx = 0; idx < count; idx++) {
+      attr->device_index[idx] = BinaryReadU32(strm);
+    }
+  }
+  attr->dltype_count = num_entries;
+  attr->dltype_value = vmalloc(sizeof(DLDataType) * (num_entries + 1));
+  BinaryRead(strm, attr->dltype_value, sizeof(DLDataType) * num_entries);
+  attr->shape_count = num_entries;
+  attr->ndim = vmalloc(sizeof(uint32_t) * (num_entries + 1));
+  attr->shape = vmalloc(sizeof(int64_t) * TVM_CRT_MAX_NDIM * (num_entries + 1));
+  memset(attr->shape, 0, sizeof(int64_t) * TVM_CRT_MAX_NDIM * (num_entries + 1));
+  for (idx = 0; idx < num_entries; idx++) {
+    attr->ndim[idx] = BinaryReadU32(strm);
+    if (attr->ndim[idx] > TVM_CRT_MAX_NDIM) {
+      fprintf(stderr, "Invalid ndim=%u: expected to be 0 ~ %d.\n", attr->ndim[idx],
+              TVM_CRT_MAX_NDIM);
+      return -1;
+    }
+  }
+  for (idx = 0; idx < num_entries; idx++) {
+    BinaryRead(strm, attr->shape + idx * TVM_CRT_MAX_NDIM, sizeof(int64_t) * attr->ndim[idx]);
+  }
+  attr->storage_offset_count = BinaryReadCount(strm, sizeof(uint32_t));
+  if (attr->storage_offset_count) {
+    attr->storage_offset = vmalloc(sizeof(uint32_t) * attr->storage_offset_count);
+    for (idx = 0; idx < attr->storage_offset_count; idx++) {
+      attr->storage_offset[idx] = BinaryReadU32(strm);
+    }
+  }
+  uint64_t arena_bytes;
+  BinaryRead(strm, &arena_bytes, sizeof(arena_bytes));
+  if (arena_bytes > UINT32_MAX) {
+    fprintf(stderr, "arena of %llu bytes does not fit the CRT\n",
+            (unsigned long long)arena_bytes);  // NOLINT(*)
+    return -1;
+  }
+  attr->arena_bytes = (uint32_t)arena_bytes;  // NOLINT(*)
+  return strm->status;
+}
+
 uint32_t TVMGraphRuntime_GetEntryId(TVMGraphRuntime* runtime, uint32_t nid, uint32_t index) {
   return runtime->node_row_ptr[nid] + index;
 }
@@ -574,6 +803,97 @@ void TVMGraphRuntime_SetInput(TVMGraphRuntime* runtime, const char* name, DLTens
   runtime->data_entry[eid].dl_tensor.data = data_in->data;
 }
 
+/*!
+ * \brief Check that a caller-owned tensor can stand in for a data entry.
+ * \param runtime The graph runtime.
+ * \param eid The data entry to be bound.
+ * \param data_ref The caller-owned tensor.
+ * \return 0 if the tensor matches the entry, -1 otherwise.
+ */
+static int TVMGraphRuntime_CheckExternalTensor(TVMGraphRuntime* runtime, uint32_t eid,
+                                               const DLTensor* data_ref) {
+  const DLTensor* tensor = &(runtime->data_entry[eid].dl_tensor);
+  uint32_t idx;
+  if (data_ref->ndim != tensor->ndim) {
+    fprintf(stderr, "expected a tensor of %d dimensions, but got %d.\n", tensor->ndim,
+            data_ref->ndim);
+    return -1;
+  }
+  for (idx = 0; idx < (uint32_t)tensor->ndim; idx++) {  // NOLINT(*)
+    if (data_ref->shape[idx] != tensor->shape[idx]) {
+      fprintf(stderr, "shape mismatch in dimension %d: expected %" PRId64 ", but got %" PRId64
+              ".\n", idx, tensor->shape[idx], data_ref->shape[idx]);
+      return -1;
+    }
+  }
+  if (data_ref->dtype.code != tensor->dtype.code || data_ref->dtype.bits != tensor->dtype.bits ||
+      data_ref->dtype.lanes != tensor->dtype.lanes) {
+    fprintf(stderr, "dtype mismatch: expected %d-bit code %d, but got %d-bit code %d.\n",
+            tensor->dtype.bits, tensor->dtype.code, data_ref->dtype.bits, data_ref->dtype.code);
+    return -1;
+  }
+  if (data_ref->ctx.device_type != tensor->ctx.device_type ||
+      data_ref->ctx.device_id != tensor->ctx.device_id) {
+    fprintf(stderr, "tensor must live on the context of the graph runtime.\n");
+    return -1;
+  }
+  if (data_ref->strides != NULL) {
+    fprintf(stderr, "tensor must be compact.\n");
+    return -1;
+  }
+  uintptr_t data = (uintptr_t)data_ref->data + data_ref->byte_offset;  // NOLINT(*)
+  if (data_ref->data == NULL || data % TVM_CRT_GRAPH_ARENA_ALIGNMENT != 0) {
+    fprintf(stderr, "tensor data %p must be %d-byte aligned.\n", (void*)data,  // NOLINT(*)
+            TVM_CRT_GRAPH_ARENA_ALIGNMENT);
+    return -1;
+  }
+  return 0;
+}
+
+/*!
+ * \brief Bind an input of the graph to caller-owned memory instead of copying it.
+ * \param runtime The graph runtime.
+ * \param name The name of the input.
+ * \param data_ref The caller-owned tensor, which must outlive every run that reads it.
+ * \return 0 on success, -1 if the tensor does not match the input.
+ */
+int TVMGraphRuntime_SetInputZeroCopy(TVMGraphRuntime* runtime, const char* name,
+                                     DLTensor* data_ref) {
+  int index = TVMGraphRuntime_GetInputIndex(runtime, name);
+  uint32_t eid = TVMGraphRuntime_GetEntryId(runtime, runtime->input_nodes[index], 0);
+  if (TVMGraphRuntime_CheckExternalTensor(runtime, eid, data_ref) != 0) {
+    fprintf(stderr, "cannot bind input '%s'.\n", name);
+    return -1;
+  }
+  // Every operator holds a pointer to the entry, so this rebinds all of its readers.
+  runtime->data_entry[eid].dl_tensor.data = (uint8_t*)data_ref->data + data_ref->byte_offset;
+  return 0;
+}
+
+/*!
+ * \brief Bind an output of the graph to caller-owned memory, so that Run writes it in place.
+ * \param runtime The graph runtime.
+ * \param index The output index.
+ * \param data_ref The caller-owned tensor, which must outlive every run that writes it.
+ * \return 0 on success, -1 if the tensor does not match the output.
+ */
+int TVMGraphRuntime_SetOutputZeroCopy(TVMGraphRuntime* runtime, const int32_t index,
+                                      DLTensor* data_ref) {
+  if (index < 0 || (uint32_t)index >= runtime->outputs_count) {  // NOLINT(*)
+    fprintf(stderr, "output index %d is out of range [0, %d).\n", index,
+            runtime->outputs_count);
+    return -1;
+  }
+  uint32_t eid = TVMGraphRuntime_GetEntryId(runtime, runtime->outputs[index].node_id,
+                                            runtime->outputs[index].index);
+  if (TVMGraphRuntime_CheckExternalTensor(runtime, eid, data_ref) != 0) {
+    fprintf(stderr, "cannot bind output %d.\n", index);
+    return -1;
+  }
+  runtime->data_entry[eid].dl_tensor.data = (uint8_t*)data_ref->data + data_ref->byte_offset;
+  return 0;
+}
+
 /*!
  * \brief Load parameters from parameter blob.
  * \param runtime The graph runtime.
@@ -658,6 +978,57 @@ int TVMGraphRuntime_LoadParams(TVMGraphRuntime* runtime, const char* param_blob,
   return status;
 }
 
+#if TVM_CRT_GRAPH_RUNTIME_PROFILE
+/*!
+ * \brief Cycles spent in each node, summed over all runs since the last reset.
+ *  Returned as is by "tvm.crt.node_cycles", so the layout is part of its interface.
+ */
+static struct {
+  uint64_t num_runs;
+  uint64_t cycles[TVM_CRT_MAX_PROFILED_NODES];
+} g_node_cycles;
+
+/*! \brief Number of nodes of the profiled graph, capped at TVM_CRT_MAX_PROFILED_NODES. */
+static uint32_t g_profiled_nodes_count;
+
+static TVMByteArray g_node_cycles_bytes;
+
+/*!
+ * \brief Return the recorded cycles: the number of runs, then the cycles of each node by node
+ *  id, all as uint64 in the byte order of the device.
+ */
+static int TVMGraphRuntime_NodeCycles(TVMValue* args, int* type_codes, int num_args,
+                                      TVMValue* ret_value, int* ret_type_codes,
+                                      void* resource_handle) {
+  g_node_cycles_bytes.data = (const char*)&g_node_cycles;  // NOLINT(*)
+  g_node_cycles_bytes.size = sizeof(uint64_t) * (1 + g_profiled_nodes_count);
+  ret_value[0].v_handle = &g_node_cycles_bytes;
+  ret_type_codes[0] = kTVMBytes;
+  return 0;
+}
+
+/*! \brief Clear the recorded cycles. */
+static int TVMGraphRuntime_ResetNodeCycles(TVMValue* args, int* type_codes, int num_args,
+                                           TVMValue* ret_value, int* ret_type_codes,
+                                           void* resource_handle) {
+  memset(&g_node_cycles, 0, sizeof(g_node_cycles));
+  return 0;
+}
+
+static void TVMGraphRuntime_SetupProfile(TVMGraphRuntime* runtime) {
+  memset(&g_node_cycles, 0, sizeof(g_node_cycles));
+  g_profiled_nodes_count = runtime->nodes_count < TVM_CRT_MAX_PROFILED_NODES
+                               ? runtime->nodes_count
+                               : TVM_CRT_MAX_PROFILED_NODES;
+  if (TVMFuncRegisterGlobal("tvm.crt.node_cycles", (TVMFunctionHandle)&TVMGraphRuntime_NodeCycles,
+                            1) != 0 ||
+      TVMFuncRegisterGlobal("tvm.crt.reset_node_cycles",
+                            (TVMFunctionHandle)&TVMGraphRuntime_ResetNodeCycles, 1) != 0) {
+    fprintf(stderr, "failed to register the node cycle functions.\n");
+  }
+}
+#endif  // TVM_CRT_GRAPH_RUNTIME_PROFILE
+
 /*!
  * \brief Run all the operations one by one.
  * \param runtime The graph runtime.
@@ -670,9 +1041,21 @@ void TVMGraphRuntime_Run(TVMGraphRuntime* runtime) {
 #if TVM_CRT_DEBUG
       printf("calling: %s (%d)\n", runtime->op_execs[idx].name, idx);
 #endif  // TVM_CRT_DEBUG
+#if TVM_CRT_GRAPH_RUNTIME_PROFILE
+      uint32_t start = TVMPlatformCycleCount();
+#endif  // TVM_CRT_GRAPH_RUNTIME_PROFILE
       runtime->op_execs[idx].Call(&(runtime->op_execs[idx]));
+#if TVM_CRT_GRAPH_RUNTIME_PROFILE
+      if (idx < TVM_CRT_MAX_PROFILED_NODES) {
+        // Unsigned subtraction stays correct across one wrap of the counter.
+        g_node_cycles.cycles[idx] += (uint32_t)(TVMPlatformCycleCount() - start);
+      }
+#endif  // TVM_CRT_GRAPH_RUNTIME_PROFILE
     }
   }
+#if TVM_CRT_GRAPH_RUNTIME_PROFILE
+  g_node_cycles.num_runs++;
+#endif  // TVM_CRT_GRAPH_RUNTIME_PROFILE
 }
 
 int TVMGraphRuntime_GetOutput(TVMGraphRuntime* runtime, const int32_t idx, DLTensor* out) {
@@ -688,7 +1071,10 @@ int TVMGraphRuntime_GetOutput(TVMGraphRuntime* runtime, const int32_t idx, DLTen
   CHECK(out->ndim == tensor->ndim);
   CHECK(out->dtype.bits == tensor->dtype.bits);
   CHECK(Shape_Accumulate(out->shape, out->ndim) == Shape_Accumulate(tensor->shape, tensor->ndim));
-  memcpy(out->data, tensor->data, size * elem_bytes);
+  // An output bound with TVMGraphRuntime_SetOutputZeroCopy is already in place.
+  if (out->data != tensor->data) {
+    memcpy(out->data, tensor->data, size * elem_bytes);
+  }
   return status;
 }
 
@@ -699,7 +1085,11 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
   TVMGraphRuntimeGraphAttr* attrs = &(runtime->attrs);
   DLDataType* vtype = vmalloc(sizeof(DLDataType) * attrs->dltype_count);
   for (idx = 0; idx < attrs->dltype_count; idx++) {
-    vtype[idx] = String2DLDataType(attrs->dltype + idx * TVM_CRT_STRLEN_DLTYPE);
+    if (attrs->dltype_value) {
+      vtype[idx] = attrs->dltype_value[idx];
+    } else {
+      vtype[idx] = String2DLDataType(attrs->dltype + idx * TVM_CRT_STRLEN_DLTYPE);
+    }
   }
 
   // Size and device type of each storage pool entry.
@@ -725,6 +1115,31 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
     pool_entry[sid].device_type = device_type;
   }
 
+  // When the caller supplied an arena, every pool entry becomes a view at the offset chosen
+  // by the offline planner; without a plan the entries are simply laid out back to back.
+  uint32_t* offsets = 0;
+  if (runtime->arena) {
+    offsets = vmalloc(sizeof(uint32_t) * (pool_entry_count + 1));
+    uint32_t arena_bytes = 0;
+    if (attrs->storage_offset_count) {
+      CHECK_EQ(attrs->storage_offset_count, pool_entry_count,
+               "storage_offset does not match the number of storage ids");
+      for (idx = 0; idx < pool_entry_count; idx++) {
+        offsets[idx] = attrs->storage_offset[idx];
+        arena_bytes = MAX(arena_bytes, offsets[idx] + pool_entry[idx].size);
+      }
+      arena_bytes = MAX(arena_bytes, attrs->arena_bytes);
+    } else {
+      for (idx = 0; idx < pool_entry_count; idx++) {
+        offsets[idx] = arena_bytes;
+        uint32_t align = TVM_CRT_GRAPH_ARENA_ALIGNMENT;
+        arena_bytes += (pool_entry[idx].size + align - 1) / align * align;
+      }
+    }
+    CHECK_LE(arena_bytes, runtime->arena_size, "arena of %u bytes is too small",
+             runtime->arena_size);
+  }
+
   // Allocate the space.
   for (idx = 0; idx < pool_entry_count; idx++) {
     runtime->storage_pool =
@@ -736,7 +1151,13 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
     TVMContext ctx = runtime->ctxs[0];
     DLDataType dtype = {kDLFloat, 32, 1};
     shape[0] = (pit.size + 3) / 4;
-    runtime->storage_pool[runtime->storage_pool_count] = TVMNDArray_Empty(1, shape, dtype, ctx);
+    if (runtime->arena) {
+      runtime->storage_pool[runtime->storage_pool_count] = TVMNDArray_Create(1, shape, dtype, ctx);
+      runtime->storage_pool[runtime->storage_pool_count].dl_tensor.data =
+          runtime->arena + offsets[idx];
+    } else {
+      runtime->storage_pool[runtime->storage_pool_count] = TVMNDArray_Empty(1, shape, dtype, ctx);
+    }
     CHECK_NE(runtime->storage_pool[runtime->storage_pool_count].dl_tensor.data, 0,
              "fail to create storage_pool with idx=%d\n", idx);
     runtime->storage_pool_count++;
@@ -758,6 +1179,9 @@ void TVMGraphRuntime_SetupStorage(TVMGraphRuntime* runtime) {
   }
 
   // Release memory
+  if (offsets) {
+    vfree(offsets);
+  }
   vfree(vtype);
   vfree(pool_entry);
 }
@@ -855,22 +1279,50 @@ int32_t TVMGraphRuntime_CreateTVMOp(TVMGraphRuntime* runtime, const TVMOpParam*
   return status;
 }
 
+/*!
+ * \brief Whether a NUL-terminated graph starts with kTVMGraphBinaryMagic.
+ *
+ * The magic has no zero byte, so the comparison stops at the end of a shorter string.
+ */
+static int TVMGraphRuntime_IsBinaryGraph(const char* graph) {
+  uint64_t magic = kTVMGraphBinaryMagic;
+  const char* bytes = (const char*)&magic;  // NOLINT(*)
+  size_t idx;
+  for (idx = 0; idx < sizeof(magic); ++idx) {
+    if (graph[idx] != bytes[idx]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
 /*!
  * \brief Initialize the graph executor with graph and context.
  * \param graph_json The execution graph.
+ * \param graph_size The size of a graph in the binary graph format, 0 for a JSON graph.
  * \param module The module containing the compiled functions for the host
  * processor.
  * \param ctxs The context of the host and devices where graph nodes will be
  * executed on.
  */
-void TVMGraphRuntime_Init(TVMGraphRuntime* runtime, const char* graph_json, const TVMModule* module,
-                          const TVMContext* ctxs) {
-  JSONReader reader = JSONReader_Create(graph_json);
-  TVMGraphRuntime_Load(runtime, &reader);
-  JSONReader_Release(&reader);
+void TVMGraphRuntime_Init(TVMGraphRuntime* runtime, const char* graph_json, uint32_t graph_size,
+                          const TVMModule* module, const TVMContext* ctxs) {
+  if (graph_size != 0) {
+    CHECK_EQ(TVMGraphRuntime_LoadBinary(runtime, graph_json, graph_size), 0,
+             "failed to load the binary graph");
+  } else {
+    CHECK_EQ(TVMGraphRuntime_IsBinaryGraph(graph_json), 0,
+             "binary graphs are loaded with TVMGraphRuntime_CreateFromBinary");
+    JSONReader reader = JSONReader_Create(graph_json);
+    TVMGraphRuntime_Load(runtime, &reader);
+    JSONReader_Release(&reader);
+  }
   runtime->ctxs[0] = ctxs[0];
   TVMGraphRuntime_SetupStorage(runtime);
   TVMGraphRuntime_SetupOpExecs(runtime);
+#if TVM_CRT_GRAPH_RUNTIME_PROFILE
+  TVMGraphRuntime_SetupProfile(runtime);
+#endif  // TVM_CRT_GRAPH_RUNTIME_PROFILE
 }
 
 TVMGraphRuntime* TVMGraphRuntime_Create(const char* sym_json, const TVMModule* m,
@@ -879,7 +1331,36 @@ TVMGraphRuntime* TVMGraphRuntime_Create(const char* sym_json, const TVMModule* m
   TVMGraphRuntime* runtime = (TVMGraphRuntime*)vmalloc(sizeof(TVMGraphRuntime));  // NOLINT(*)
   memset(runtime, 0, sizeof(TVMGraphRuntime));
   // init
-  TVMGraphRuntime_Init(runtime, sym_json, m, ctxs);
+  TVMGraphRuntime_Init(runtime, sym_json, 0, m, ctxs);
+  return runtime;
+}
+
+static TVMGraphRuntime* TVMGraphRuntime_AllocWithArena(void* arena, uint32_t arena_size) {
+  CHECK_EQ(vleak_size, 1, "memory leak checking won't work with concurrent CRT use");
+  CHECK_EQ(((uintptr_t)arena) % TVM_CRT_GRAPH_ARENA_ALIGNMENT, 0,  // NOLINT(*)
+           "arena must be %d-byte aligned", TVM_CRT_GRAPH_ARENA_ALIGNMENT);
+  TVMGraphRuntime* runtime = (TVMGraphRuntime*)vmalloc(sizeof(TVMGraphRuntime));  // NOLINT(*)
+  memset(runtime, 0, sizeof(TVMGraphRuntime));
+  runtime->arena = (uint8_t*)arena;  // NOLINT(*)
+  runtime->arena_size = arena_size;
+  return runtime;
+}
+
+TVMGraphRuntime* TVMGraphRuntime_CreateWithArena(const char* sym_json, const TVMModule* m,
+                                                 const TVMContext* ctxs, void* arena,
+                                                 uint32_t arena_size) {
+  CHECK_NE(arena, 0, "arena must not be NULL");
+  TVMGraphRuntime* runtime = TVMGraphRuntime_AllocWithArena(arena, arena_size);
+  TVMGraphRuntime_Init(runtime, sym_json, 0, m, ctxs);
+  return runtime;
+}
+
+TVMGraphRuntime* TVMGraphRuntime_CreateFromBinary(const char* blob, uint32_t blob_size,
+                                                  const TVMModule* m, const TVMContext* ctxs,
+                                                  void* arena, uint32_t arena_size) {
+  CHECK_GT(blob_size, 0, "binary graph must not be empty");
+  TVMGraphRuntime* runtime = TVMGraphRuntime_AllocWithArena(arena, arena_size);
+  TVMGraphRuntime_Init(runtime, blob, blob_size, m, ctxs);
   return runtime;
 }
 
@@ -892,7 +1373,12 @@ void TVMGraphRuntime_Release(TVMGraphRuntime** pptr) {
   vfree(runtime->nodes);
   TVMGraphRuntimeGraphAttr_Release(&(runtime->attrs));
   for (idx = 0; idx < runtime->storage_pool_count; ++idx) {
-    TVMNDArray_Release(&(runtime->storage_pool[idx]));
+    if (runtime->arena) {
+      // Arena-backed entries only own their shape; the arena belongs to the caller.
+      vfree(runtime->storage_pool[idx].dl_tensor.shape);
+    } else {
+      TVMNDArray_Release(&(runtime->storage_pool[idx]));
+    }
   }
   for (idx = 0; idx < runtime->data_entry_count; ++idx) {
     vfree(runtime->data_entry[idx].dl_tensor.shape);
@@ -197,7 +197,20 @@ int JSONReader_ReadString(JSONReader* reader, char* out_str, size_t out_str_size
       out_str[output_counter++] = ch;
     }
     if (output_counter == out_str_size - 1) {
+      // The string fits exactly when its closing quote comes next.
+      ch = reader->NextChar(reader);
+      if (ch == '\"') {
+        break;
+      }
       fprintf(stderr, "Error: string size greater than buffer size (%zu).\n", out_str_size);
+      // Skip the rest of the string, so the reader stays in sync with the stream.
+      while (ch != '\"' && ch != EOF && ch != '\r' && ch != '\n') {
+        if (ch == '\\') {
+          reader->NextChar(reader);
+        }
+        ch = reader->NextChar(reader);
+      }
+      status = -1;
       break;
     }
     if (ch == EOF || ch == '\r' || ch == '\n') {
@@ -288,8 +301,9 @@ uint8_t JSONReader_NextObjectItem(JSONReader* reader, char* out_key, size_t out_
     scope_counter_->back(scope_counter_)[0] += 1;
     int err = reader->ReadString(reader, out_key, out_key_size);
     if (err != 0) {
-      fprintf(stderr, "error reading key");
-      return 0;
+      // A key longer than out_key is left empty, so the caller skips its value.
+      fprintf(stderr, "error reading key\n");
+      out_key[0] = 0;
     }
     int ch = reader->NextNonSpace(reader);
     if (ch != ':') {
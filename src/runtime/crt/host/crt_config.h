@@ -59,10 +59,31 @@
 /*! \brief Log2 of page size for virtual memory allocation */
 #define TVM_CRT_PAGE_BYTES_LOG 12
 
+/*!
+ * \brief Allocator behind vmalloc
+ *
+ * * use 0 for the page allocator, which rounds allocations up to whole pages
+ * * use 1 for the two-level segregated-fit allocator, with O(1) allocation and
+ *   release, 16-byte granularity and fragmentation statistics through vstats
+ */
+#define TVM_CRT_MEMORY_ALLOCATOR 0
+
 /*! Maximum number of registered modules. */
 #define TVM_CRT_MAX_REGISTERED_MODULES 2
 
 /*! Size of the global function registry, in bytes. */
 #define TVM_CRT_GLOBAL_FUNC_REGISTRY_SIZE_BYTES 200
 
+/*!
+ * \brief Record the cycles spent in each graph node
+ *
+ * When 1, the graph runtime times every operator with TVMPlatformCycleCount, which the platform
+ * must then provide, and accumulates the counts of the first TVM_CRT_MAX_PROFILED_NODES nodes in
+ * a static buffer that is read over RPC with the "tvm.crt.node_cycles" global function.
+ */
+#define TVM_CRT_GRAPH_RUNTIME_PROFILE 0
+
+/*! Number of graph nodes whose cycles are recorded. */
+#define TVM_CRT_MAX_PROFILED_NODES 256
+
 #endif  // TVM_RUNTIME_CRT_HOST_CRT_CONFIG_H_
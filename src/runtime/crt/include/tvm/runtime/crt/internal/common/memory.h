@@ -34,6 +34,14 @@
 extern "C" {
 #endif
 
+/*! \brief Values of TVM_CRT_MEMORY_ALLOCATOR */
+#define TVM_CRT_MEMORY_ALLOCATOR_PAGE 0
+#define TVM_CRT_MEMORY_ALLOCATOR_TLSF 1
+
+#ifndef TVM_CRT_MEMORY_ALLOCATOR
+#define TVM_CRT_MEMORY_ALLOCATOR TVM_CRT_MEMORY_ALLOCATOR_PAGE
+#endif
+
 /*! Number of bits in a page */
 #define TVM_CRT_PAGE_BITS ((1 << TVM_CRT_PAGE_BYTES_LOG) << 3)
 
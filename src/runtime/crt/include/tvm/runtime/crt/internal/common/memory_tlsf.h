@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file runtime/crt/include/tvm/runtime/crt/internal/common/memory_tlsf.h
+ * \brief Defines the two-level segregated-fit (TLSF) memory allocator.
+ *     Exposed for testing.
+ */
+
+#ifndef TVM_RUNTIME_CRT_INCLUDE_TVM_RUNTIME_CRT_INTERNAL_COMMON_MEMORY_TLSF_H_
+#define TVM_RUNTIME_CRT_INCLUDE_TVM_RUNTIME_CRT_INTERNAL_COMMON_MEMORY_TLSF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tvm/runtime/crt/memory.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Log2 of the allocation granularity, which is also the alignment of every block. */
+#define TVM_CRT_TLSF_ALIGN_LOG2 4
+
+/*! \brief Log2 of the number of second-level size classes in each first-level class. */
+#define TVM_CRT_TLSF_SL_LOG2 4
+
+/*! \brief Number of second-level size classes in each first-level class. */
+#define TVM_CRT_TLSF_SL_COUNT (1 << TVM_CRT_TLSF_SL_LOG2)
+
+/*! \brief Log2 of the bound on the size of a block; larger pools are truncated. */
+#define TVM_CRT_TLSF_MAX_SIZE_LOG2 31
+
+/*!
+ * \brief Number of first-level size classes. Blocks smaller than
+ *  (1 << (TVM_CRT_TLSF_ALIGN_LOG2 + TVM_CRT_TLSF_SL_LOG2)) bytes share the first one.
+ */
+#define TVM_CRT_TLSF_FL_COUNT \
+  (TVM_CRT_TLSF_MAX_SIZE_LOG2 - TVM_CRT_TLSF_ALIGN_LOG2 - TVM_CRT_TLSF_SL_LOG2 + 1)
+
+/*! \brief The header of a block in the pool; the payload follows it. */
+typedef struct TLSFBlock TLSFBlock;
+
+/*!
+ * \brief Two-level segregated-fit allocator
+ *  Keeps one free list per size class and a bitmap of the non-empty lists, so that
+ *  allocation and release are O(1) and freed blocks coalesce with their neighbours.
+ */
+typedef struct TLSFAllocator {
+  /*!
+   * \brief Allocate memory from the allocator
+   * \param size The size of memory
+   * \return The address, NULL when no free block is large enough
+   */
+  void* (*Alloc)(struct TLSFAllocator* alloc, size_t size);
+  /*!
+   * \brief Reallocate memory, growing into the following block when it is free
+   * \param ptr The pointer to the memory area to be reallocated
+   * \param size The size of memory
+   * \return The address, NULL when no free block is large enough; ptr stays valid then
+   */
+  void* (*Realloc)(struct TLSFAllocator* alloc, void* ptr, size_t size);
+  /*!
+   * \brief Free the memory.
+   * \param ptr The pointer to the memory to deallocate
+   */
+  void (*Free)(struct TLSFAllocator* alloc, void* ptr);
+  /*!
+   * \brief Report the occupancy and fragmentation of the pool.
+   * \param stats Filled with the statistics.
+   */
+  void (*Stats)(struct TLSFAllocator* alloc, VirtualMemoryStats* stats);
+
+  // Bit i is set when free_lists[i] has a non-empty list.
+  uint32_t fl_bitmap;
+  // Bit j of sl_bitmap[i] is set when free_lists[i][j] is non-empty.
+  uint32_t sl_bitmap[TVM_CRT_TLSF_FL_COUNT];
+  // Free blocks by first- and second-level size class.
+  TLSFBlock* free_lists[TVM_CRT_TLSF_FL_COUNT][TVM_CRT_TLSF_SL_COUNT];
+
+  size_t used_bytes;
+  size_t free_bytes;
+  size_t num_used_blocks;
+  size_t num_free_blocks;
+} TLSFAllocator;
+
+// Exposed for testing
+void TLSFAllocatorCreate(TLSFAllocator* alloc, uint8_t* memory_pool, size_t memory_pool_size_bytes);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TVM_RUNTIME_CRT_INCLUDE_TVM_RUNTIME_CRT_INTERNAL_COMMON_MEMORY_TLSF_H_
@@ -29,6 +29,11 @@
 #include <tvm/runtime/crt/internal/graph_runtime/load_json.h>
 #include <tvm/runtime/crt/module.h>
 
+/*! \brief Magic number of the binary graph format, see relay/backend/graph_runtime_codegen.cc */
+static const uint64_t kTVMGraphBinaryMagic = 0xF7E58D4F05049CB9;
+/*! \brief Version of the binary graph format understood by this runtime. */
+static const uint32_t kTVMGraphBinaryVersion = 1;
+
 // Memory pool entry.
 typedef struct TVMGraphRuntimePoolEntry {
   size_t size;
@@ -89,6 +94,9 @@ typedef struct TVMGraphRuntime {
   /*! \brief Common storage pool for all devices. */
   TVMNDArray* storage_pool;
   uint32_t storage_pool_count;
+  /*! \brief Caller-owned tensor arena backing the storage pool, or NULL. */
+  uint8_t* arena;
+  uint32_t arena_size;
   /*! \brief Data entry of each node. */
   TVMNDArray* data_entry;
   uint32_t data_entry_count;
@@ -101,6 +109,15 @@ typedef DLTensor* DLTensorPtr;
 
 // private functions
 void TVMGraphRuntime_SetInput(TVMGraphRuntime* runtime, const char* name, DLTensor* data_in);
+/*!
+ * \brief Load a graph serialized in the binary graph format.
+ * \param runtime The graph runtime.
+ * \param blob The serialized graph, starting with kTVMGraphBinaryMagic.
+ * \param blob_size The size of blob in bytes, no read goes past it.
+ * \return 0 on success.
+ */
+int TVMGraphRuntime_LoadBinary(TVMGraphRuntime* runtime, const char* blob, uint32_t blob_size);
+
 int TVMGraphRuntime_LoadParams(TVMGraphRuntime* runtime, const char* param_blob,
                                const uint32_t param_size);
 void TVMGraphRuntime_Run(TVMGraphRuntime* runtime);
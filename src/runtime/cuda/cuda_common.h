@@ -27,7 +27,9 @@
 #include <cuda_runtime.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "../workspace_pool.h"
 
@@ -57,8 +59,15 @@ class CUDAThreadEntry {
   cudaStream_t stream{nullptr};
   /*! \brief thread local pool*/
   WorkspacePool pool;
+  /*!
+   * \brief The pools of non-default streams. Workspace freed after a launch may
+   *  still be in use by the kernel, so only launches on one stream can share it.
+   */
+  std::unordered_map<cudaStream_t, std::unique_ptr<WorkspacePool>> stream_pools;
   /*! \brief constructor */
   CUDAThreadEntry();
+  /*! \brief get the workspace pool of the current stream */
+  WorkspacePool* CurrentPool();
   // get the threadlocal workspace
   static CUDAThreadEntry* ThreadLocal();
 };
@@ -27,13 +27,30 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 
 #include "cuda_common.h"
 
 namespace tvm {
 namespace runtime {
 
+/*!
+ * \brief Whether the workspaces come from the stream-ordered allocator.
+ *  Set TVM_CUDA_STREAM_ORDERED_ALLOC=1 before the first allocation to enable it.
+ */
+static bool UseStreamOrderedWorkspace() {
+  static bool enabled = [] {
+    const char* value = std::getenv("TVM_CUDA_STREAM_ORDERED_ALLOC");
+    return value != nullptr && std::string(value) != "0";
+  }();
+  return enabled;
+}
+
 class CUDADeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(TVMContext ctx) final { CUDA_CALL(cudaSetDevice(ctx.device_id)); }
@@ -176,6 +193,7 @@ class CUDADeviceAPI final : public DeviceAPI {
   void FreeStream(TVMContext ctx, TVMStreamHandle stream) {
     CUDA_CALL(cudaSetDevice(ctx.device_id));
     cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
+    CUDAThreadEntry::ThreadLocal()->stream_pools.erase(cu_stream);
     CUDA_CALL(cudaStreamDestroy(cu_stream));
   }
 
@@ -200,11 +218,61 @@ class CUDADeviceAPI final : public DeviceAPI {
   }
 
   void* AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) final {
-    return CUDAThreadEntry::ThreadLocal()->pool.AllocWorkspace(ctx, size);
+    if (ctx.device_type == kDLGPU && UseStreamOrderedWorkspace()) {
+      return AllocAsync(ctx, size);
+    }
+    return CUDAThreadEntry::ThreadLocal()->CurrentPool()->AllocWorkspace(ctx, size);
   }
 
   void FreeWorkspace(TVMContext ctx, void* data) final {
-    CUDAThreadEntry::ThreadLocal()->pool.FreeWorkspace(ctx, data);
+    if (ctx.device_type == kDLGPU && UseStreamOrderedWorkspace()) {
+      FreeAsync(ctx, data);
+      return;
+    }
+    CUDAThreadEntry::ThreadLocal()->CurrentPool()->FreeWorkspace(ctx, data);
+  }
+
+  /*!
+   * \brief Allocate from the memory pool of the device, ordered on the current stream.
+   *  The memory can be used by the work enqueued on the stream after the allocation,
+   *  and is reused by the allocations that follow its FreeAsync on the same stream,
+   *  without a device synchronization.
+   */
+  void* AllocAsync(TVMContext ctx, size_t nbytes) {
+#if CUDART_VERSION >= 11020
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    InitAsyncPool(ctx.device_id);
+    void* ret;
+    CUDA_CALL(cudaMallocAsync(&ret, nbytes, CUDAThreadEntry::ThreadLocal()->stream));
+    return ret;
+#else
+    LOG(FATAL) << "The stream-ordered allocator requires CUDA 11.2 or later";
+    return nullptr;
+#endif  // CUDART_VERSION >= 11020
+  }
+
+  /*!
+   * \brief Free memory of AllocAsync, ordered on the current stream.
+   *  The work on other streams that uses the memory must be ordered before the free.
+   */
+  void FreeAsync(TVMContext ctx, void* ptr) {
+#if CUDART_VERSION >= 11020
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaFreeAsync(ptr, CUDAThreadEntry::ThreadLocal()->stream));
+#else
+    LOG(FATAL) << "The stream-ordered allocator requires CUDA 11.2 or later";
+#endif  // CUDART_VERSION >= 11020
+  }
+
+  /*! \brief Release the memory cached in the pool of the device that is not in use. */
+  void TrimAsyncPool(TVMContext ctx) {
+#if CUDART_VERSION >= 11020
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    CUDA_CALL(cudaDeviceSynchronize());
+    cudaMemPool_t pool;
+    CUDA_CALL(cudaDeviceGetDefaultMemPool(&pool, ctx.device_id));
+    CUDA_CALL(cudaMemPoolTrimTo(pool, 0));
+#endif  // CUDART_VERSION >= 11020
   }
 
   static CUDADeviceAPI* Global() {
@@ -215,6 +283,23 @@ class CUDADeviceAPI final : public DeviceAPI {
   }
 
  private:
+#if CUDART_VERSION >= 11020
+  // Keep the freed memory in the pool of the device instead of releasing it
+  // at every synchronization, so that it is reused by later allocations.
+  void InitAsyncPool(int device_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (async_pool_devices_.count(device_id)) return;
+    int supported = 0;
+    CUDA_CALL(cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, device_id));
+    CHECK(supported) << "GPU " << device_id << " does not support stream-ordered allocation";
+    cudaMemPool_t pool;
+    CUDA_CALL(cudaDeviceGetDefaultMemPool(&pool, device_id));
+    uint64_t threshold = UINT64_MAX;
+    CUDA_CALL(cudaMemPoolSetAttribute(pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+    async_pool_devices_.insert(device_id);
+  }
+#endif  // CUDART_VERSION >= 11020
+
   static void GPUCopy(const void* from, void* to, size_t size, cudaMemcpyKind kind,
                       cudaStream_t stream) {
     if (stream != 0) {
@@ -223,6 +308,10 @@ class CUDADeviceAPI final : public DeviceAPI {
       CUDA_CALL(cudaMemcpy(to, from, size, kind));
     }
   }
+
+  // the devices whose memory pool is initialized
+  std::unordered_set<int> async_pool_devices_;
+  std::mutex mutex_;
 };
 
 typedef dmlc::ThreadLocalStore<CUDAThreadEntry> CUDAThreadStore;
@@ -231,11 +320,37 @@ CUDAThreadEntry::CUDAThreadEntry() : pool(kDLGPU, CUDADeviceAPI::Global()) {}
 
 CUDAThreadEntry* CUDAThreadEntry::ThreadLocal() { return CUDAThreadStore::Get(); }
 
+WorkspacePool* CUDAThreadEntry::CurrentPool() {
+  if (stream == nullptr) return &pool;
+  std::unique_ptr<WorkspacePool>& stream_pool = stream_pools[stream];
+  if (stream_pool == nullptr) {
+    stream_pool.reset(new WorkspacePool(kDLGPU, CUDADeviceAPI::Global()));
+  }
+  return stream_pool.get();
+}
+
 TVM_REGISTER_GLOBAL("device_api.gpu").set_body([](TVMArgs args, TVMRetValue* rv) {
   DeviceAPI* ptr = CUDADeviceAPI::Global();
   *rv = static_cast<void*>(ptr);
 });
 
+TVM_REGISTER_GLOBAL("device_api.gpu.alloc_async").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx = args[0];
+  int64_t nbytes = args[1];
+  *rv = CUDADeviceAPI::Global()->AllocAsync(ctx, static_cast<size_t>(nbytes));
+});
+
+TVM_REGISTER_GLOBAL("device_api.gpu.free_async").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx = args[0];
+  void* ptr = args[1];
+  CUDADeviceAPI::Global()->FreeAsync(ctx, ptr);
+});
+
+TVM_REGISTER_GLOBAL("device_api.gpu.trim_async_pool").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx = args[0];
+  CUDADeviceAPI::Global()->TrimAsyncPool(ctx);
+});
+
 TVM_REGISTER_GLOBAL("device_api.cpu_pinned").set_body([](TVMArgs args, TVMRetValue* rv) {
   DeviceAPI* ptr = CUDADeviceAPI::Global();
   *rv = static_cast<void*>(ptr);
@@ -26,9 +26,17 @@
 #include <cuda_runtime.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -41,24 +49,42 @@
 namespace tvm {
 namespace runtime {
 
+// The prefix of the format of a module whose kernels are split into units, in its binary.
+static constexpr const char* kSplitFormatPrefix = "split_";
+
 // Module to support thread-safe multi-GPU execution.
 // cuModule is a per-GPU module
 // The runtime will contain a per-device module table
 // The modules will be lazily loaded
+//
+// The kernels can be split into several units, each a separate ptx/cubin,
+// and a unit is only loaded on a device when one of its kernels is first used.
+// Units in ptx are JIT compiled by the driver, when TVM_CUDA_JIT_CACHE_DIR
+// is set the resulting cubin is kept in that directory and reused across runs.
 class CUDAModuleNode : public runtime::ModuleNode {
  public:
-  explicit CUDAModuleNode(std::string data, std::string fmt,
+  explicit CUDAModuleNode(std::vector<std::string> units,
+                          std::unordered_map<std::string, uint32_t> func_unit, std::string fmt,
                           std::unordered_map<std::string, FunctionInfo> fmap,
                           std::string cuda_source)
-      : data_(data), fmt_(fmt), fmap_(fmap), cuda_source_(cuda_source) {
-    std::fill(module_.begin(), module_.end(), nullptr);
+      : units_(units),
+        func_unit_(func_unit),
+        fmt_(fmt),
+        fmap_(fmap),
+        cuda_source_(cuda_source),
+        module_(units.size()) {
+    for (auto& modules : module_) {
+      std::fill(modules.begin(), modules.end(), nullptr);
+    }
   }
   // destructor
   ~CUDAModuleNode() {
-    for (size_t i = 0; i < module_.size(); ++i) {
-      if (module_[i] != nullptr) {
-        CUDA_CALL(cudaSetDevice(static_cast<int>(i)));
-        CUDA_DRIVER_CALL(cuModuleUnload(module_[i]));
+    for (auto& modules : module_) {
+      for (size_t i = 0; i < modules.size(); ++i) {
+        if (modules[i] != nullptr) {
+          CUDA_CALL(cudaSetDevice(static_cast<int>(i)));
+          CUDA_DRIVER_CALL(cuModuleUnload(modules[i]));
+        }
       }
     }
   }
@@ -76,36 +102,41 @@ class CUDAModuleNode : public runtime::ModuleNode {
       SaveBinaryToFile(file_name, cuda_source_);
     } else {
       CHECK_EQ(fmt, fmt_) << "Can only save to format=" << fmt_;
+      CHECK_EQ(units_.size(), 1U) << "Cannot save the split kernels into a single " << fmt_
+                                  << " file, export the module into a library instead";
       SaveMetaDataToFile(meta_file, fmap_);
-      SaveBinaryToFile(file_name, data_);
+      SaveBinaryToFile(file_name, units_[0]);
     }
   }
 
   void SaveToBinary(dmlc::Stream* stream) final {
-    stream->Write(fmt_);
-    stream->Write(fmap_);
-    stream->Write(data_);
+    if (units_.size() == 1) {
+      stream->Write(fmt_);
+      stream->Write(fmap_);
+      stream->Write(units_[0]);
+    } else {
+      stream->Write(kSplitFormatPrefix + fmt_);
+      stream->Write(fmap_);
+      stream->Write(units_);
+      stream->Write(func_unit_);
+    }
   }
 
   std::string GetSource(const std::string& format) final {
-    if (format == fmt_) return data_;
+    if (format == fmt_) return JoinUnits();
     if (cuda_source_.length() != 0) {
       return cuda_source_;
     } else {
-      if (fmt_ == "ptx") return data_;
+      if (fmt_ == "ptx") return JoinUnits();
       return "";
     }
   }
 
   // get a CUfunction from primary context in device_id
   CUfunction GetFunc(int device_id, const std::string& func_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
-    }
+    CUmodule module = GetModule(device_id, UnitOf(func_name));
     CUfunction func;
-    CUresult result = cuModuleGetFunction(&func, module_[device_id], func_name.c_str());
+    CUresult result = cuModuleGetFunction(&func, module, func_name.c_str());
     if (result != CUDA_SUCCESS) {
       const char* msg;
       cuGetErrorName(result, &msg);
@@ -115,15 +146,11 @@ class CUDAModuleNode : public runtime::ModuleNode {
   }
   // get a global var from primary context in device_id
   CUdeviceptr GetGlobal(int device_id, const std::string& global_name, size_t expect_nbytes) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
-    }
+    CUmodule module = GetModule(device_id, 0);
     CUdeviceptr global;
     size_t nbytes;
 
-    CUresult result = cuModuleGetGlobal(&global, &nbytes, module_[device_id], global_name.c_str());
+    CUresult result = cuModuleGetGlobal(&global, &nbytes, module, global_name.c_str());
     CHECK_EQ(nbytes, expect_nbytes);
     if (result != CUDA_SUCCESS) {
       const char* msg;
@@ -132,18 +159,156 @@ class CUDAModuleNode : public runtime::ModuleNode {
     }
     return global;
   }
+  // get a global var in each unit already loaded in device_id that defines it.
+  // The units that are not loaded yet get a zero initialized copy once loaded.
+  std::vector<CUdeviceptr> GetLoadedGlobals(int device_id, const std::string& global_name,
+                                            size_t expect_nbytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CUdeviceptr> globals;
+    for (const auto& modules : module_) {
+      if (modules[device_id] == nullptr) continue;
+      CUdeviceptr global;
+      size_t nbytes;
+      CUresult result =
+          cuModuleGetGlobal(&global, &nbytes, modules[device_id], global_name.c_str());
+      if (result == CUDA_ERROR_NOT_FOUND) continue;
+      if (result != CUDA_SUCCESS) {
+        const char* msg;
+        cuGetErrorName(result, &msg);
+        LOG(FATAL) << "CUDAError: cuModuleGetGlobal " << global_name
+                   << " failed with error: " << msg;
+      }
+      CHECK_EQ(nbytes, expect_nbytes);
+      globals.push_back(global);
+    }
+    return globals;
+  }
+  // load all the units of the module in device_id, JIT compiles them in parallel
+  void LoadAll(int device_id) {
+    size_t num_threads = std::min<size_t>(units_.size(), std::thread::hardware_concurrency());
+    num_threads = std::max<size_t>(num_threads, 1);
+    std::atomic<size_t> next_unit{0};
+    auto worker = [this, device_id, &next_unit]() {
+      CUDA_CALL(cudaSetDevice(device_id));
+      for (size_t unit = next_unit++; unit < units_.size(); unit = next_unit++) {
+        GetModule(device_id, unit);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+  // whether the kernels are split into several units
+  bool is_split() const { return units_.size() > 1; }
 
  private:
-  // the binary data
-  std::string data_;
+  // the unit that contains func_name
+  size_t UnitOf(const std::string& func_name) const {
+    if (units_.size() == 1) return 0;
+    auto it = func_unit_.find(func_name);
+    CHECK(it != func_unit_.end()) << "Cannot find the unit of function " << func_name;
+    return it->second;
+  }
+  // get the module of a unit in device_id, loading it on first use
+  CUmodule GetModule(int device_id, size_t unit) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (module_[unit][device_id] != nullptr) return module_[unit][device_id];
+    }
+    // load outside of the lock, so that different units JIT compile concurrently
+    CUmodule module = LoadUnit(units_[unit]);
+    std::lock_guard<std::mutex> lock(mutex_);
+    // must recheck under the lock scope
+    if (module_[unit][device_id] != nullptr) {
+      CUDA_DRIVER_CALL(cuModuleUnload(module));
+    } else {
+      module_[unit][device_id] = module;
+    }
+    return module_[unit][device_id];
+  }
+  // load the data of a unit in the current context
+  CUmodule LoadUnit(const std::string& data) {
+    CUmodule module;
+    const char* cache_dir = std::getenv("TVM_CUDA_JIT_CACHE_DIR");
+    if (fmt_ != "ptx" || cache_dir == nullptr || cache_dir[0] == '\0') {
+      CUDA_DRIVER_CALL(cuModuleLoadData(&module, data.c_str()));
+      return module;
+    }
+    std::string cubin;
+    std::string cache_file = std::string(cache_dir) + "/" + JITCacheKey(data) + ".cubin";
+    std::ifstream fs(cache_file, std::ios::in | std::ios::binary);
+    if (fs) {
+      fs.close();
+      LoadBinaryFromFile(cache_file, &cubin);
+    } else {
+      cubin = JITCompile(data);
+      // write to a temporary file first, concurrent processes may fill the same entry
+      std::ostringstream temp_file;
+      temp_file << cache_file << ".tmp" << std::this_thread::get_id();
+      SaveBinaryToFile(temp_file.str(), cubin);
+      if (std::rename(temp_file.str().c_str(), cache_file.c_str()) != 0) {
+        std::remove(temp_file.str().c_str());
+      }
+    }
+    CUDA_DRIVER_CALL(cuModuleLoadData(&module, cubin.data()));
+    return module;
+  }
+  // JIT compile ptx into a cubin for the current device
+  static std::string JITCompile(const std::string& ptx) {
+    CUlinkState state;
+    CUDA_DRIVER_CALL(cuLinkCreate(0, nullptr, nullptr, &state));
+    CUDA_DRIVER_CALL(cuLinkAddData(state, CU_JIT_INPUT_PTX, const_cast<char*>(ptx.c_str()),
+                                   ptx.length() + 1, "tvm_kernels", 0, nullptr, nullptr));
+    void* cubin_data;
+    size_t cubin_size;
+    CUDA_DRIVER_CALL(cuLinkComplete(state, &cubin_data, &cubin_size));
+    // the cubin is owned by the link state
+    std::string cubin(static_cast<const char*>(cubin_data), cubin_size);
+    CUDA_DRIVER_CALL(cuLinkDestroy(state));
+    return cubin;
+  }
+  // the JIT cache key of ptx, the cubin depends on the device and the driver that compiles it
+  static std::string JITCacheKey(const std::string& ptx) {
+    CUdevice device;
+    int major, minor, driver_version;
+    CUDA_DRIVER_CALL(cuCtxGetDevice(&device));
+    CUDA_DRIVER_CALL(
+        cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, device));
+    CUDA_DRIVER_CALL(
+        cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, device));
+    CUDA_DRIVER_CALL(cuDriverGetVersion(&driver_version));
+    std::ostringstream os;
+    os << "sm_" << major << minor << "-" << driver_version << "-" << std::hex
+       << std::hash<std::string>()(ptx) << "-" << std::dec << ptx.length();
+    return os.str();
+  }
+  // the data of all the units, for display
+  std::string JoinUnits() const {
+    if (units_.size() == 1) return units_[0];
+    std::ostringstream os;
+    for (const std::string& unit : units_) {
+      os << unit << "\n";
+    }
+    return os.str();
+  }
+
+  // the binary data of each unit
+  std::vector<std::string> units_;
+  // the unit of each function, empty when there is a single unit.
+  std::unordered_map<std::string, uint32_t> func_unit_;
   // The format
   std::string fmt_;
   // function information table.
   std::unordered_map<std::string, FunctionInfo> fmap_;
   // The cuda source.
   std::string cuda_source_;
-  // the internal modules per GPU, to be lazily initialized.
-  std::array<CUmodule, kMaxNumGPUs> module_;
+  // the internal modules of each unit per GPU, to be lazily initialized.
+  std::vector<std::array<CUmodule, kMaxNumGPUs>> module_;
   // internal mutex when updating the module
   std::mutex mutex_;
 };
@@ -214,6 +379,14 @@ class CUDAPrepGlobalBarrier {
   void operator()(const TVMArgs& args, TVMRetValue* rv) const {
     int device_id;
     CUDA_CALL(cudaGetDevice(&device_id));
+    if (m_->is_split()) {
+      // every unit using the barrier has its own state, reset those that are loaded
+      for (CUdeviceptr state : m_->GetLoadedGlobals(
+               device_id, runtime::symbol::tvm_global_barrier_state, sizeof(unsigned))) {
+        CUDA_DRIVER_CALL(cuMemsetD32(state, 0, 1));
+      }
+      return;
+    }
     if (pcache_[device_id] == 0) {
       pcache_[device_id] =
           m_->GetGlobal(device_id, runtime::symbol::tvm_global_barrier_state, sizeof(unsigned));
@@ -237,6 +410,13 @@ PackedFunc CUDAModuleNode::GetFunction(const std::string& name,
   if (name == symbol::tvm_prepare_global_barrier) {
     return PackedFunc(CUDAPrepGlobalBarrier(this, sptr_to_self));
   }
+  if (name == "__tvm_cuda_load_kernels") {
+    return PackedFunc([this, sptr_to_self](TVMArgs args, TVMRetValue* rv) {
+      int device_id;
+      CUDA_CALL(cudaGetDevice(&device_id));
+      this->LoadAll(device_id);
+    });
+  }
   auto it = fmap_.find(name);
   if (it == fmap_.end()) return PackedFunc();
   const FunctionInfo& info = it->second;
@@ -248,7 +428,18 @@ PackedFunc CUDAModuleNode::GetFunction(const std::string& name,
 Module CUDAModuleCreate(std::string data, std::string fmt,
                         std::unordered_map<std::string, FunctionInfo> fmap,
                         std::string cuda_source) {
-  auto n = make_object<CUDAModuleNode>(data, fmt, fmap, cuda_source);
+  auto n = make_object<CUDAModuleNode>(std::vector<std::string>{data},
+                                       std::unordered_map<std::string, uint32_t>(), fmt, fmap,
+                                       cuda_source);
+  return Module(n);
+}
+
+Module CUDAModuleCreate(std::vector<std::string> units,
+                        std::unordered_map<std::string, uint32_t> func_unit, std::string fmt,
+                        std::unordered_map<std::string, FunctionInfo> fmap,
+                        std::string cuda_source) {
+  CHECK(!units.empty());
+  auto n = make_object<CUDAModuleNode>(units, func_unit, fmt, fmap, cuda_source);
   return Module(n);
 }
 
@@ -270,6 +461,14 @@ Module CUDAModuleLoadBinary(void* strm) {
   std::string fmt;
   stream->Read(&fmt);
   stream->Read(&fmap);
+  if (fmt.compare(0, std::strlen(kSplitFormatPrefix), kSplitFormatPrefix) == 0) {
+    std::vector<std::string> units;
+    std::unordered_map<std::string, uint32_t> func_unit;
+    stream->Read(&units);
+    stream->Read(&func_unit);
+    return CUDAModuleCreate(units, func_unit, fmt.substr(std::strlen(kSplitFormatPrefix)), fmap,
+                            std::string());
+  }
   stream->Read(&data);
   return CUDAModuleCreate(data, fmt, fmap, std::string());
 }
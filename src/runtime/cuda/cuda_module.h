@@ -50,6 +50,22 @@ static constexpr const int kMaxNumGPUs = 32;
 Module CUDAModuleCreate(std::string data, std::string fmt,
                         std::unordered_map<std::string, FunctionInfo> fmap,
                         std::string cuda_source);
+
+/*!
+ * \brief create a cuda module whose kernels are split into separately loaded units.
+ *
+ *  Each unit is only loaded on a device when one of its kernels is first used.
+ *
+ * \param units The data of each unit, can be ptx, cubin
+ * \param func_unit The index of the unit that contains each function.
+ * \param fmt The format of the data of every unit, can be "ptx", "cubin"
+ * \param fmap The map function information map of each function.
+ * \param cuda_source Optional, cuda source file
+ */
+Module CUDAModuleCreate(std::vector<std::string> units,
+                        std::unordered_map<std::string, uint32_t> func_unit, std::string fmt,
+                        std::unordered_map<std::string, FunctionInfo> fmap,
+                        std::string cuda_source);
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_CUDA_CUDA_MODULE_H_
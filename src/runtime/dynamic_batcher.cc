@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file dynamic_batcher.cc
+ * \brief Batch single-sample requests into one inference of a graph runtime or VM.
+ */
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Collects the requests of concurrent callers and runs them as one batch.
+ *
+ *  The wrapped executor is built for a batch of max_batch along the first axis.
+ *  Each request carries a batch of one. A worker thread waits for max_batch
+ *  requests, or for the timeout to expire after the oldest one arrived, copies
+ *  their inputs into pre-allocated host buffers, runs one inference and scatters
+ *  the rows of the outputs back to the requests. Unused rows of a partial batch
+ *  hold stale data and their outputs are dropped.
+ */
+class DynamicBatcher : public ModuleNode {
+ public:
+  /*!
+   * \brief Create the batcher.
+   * \param executor A graph runtime or a VM module.
+   * \param max_batch The batch size the executor was built for.
+   * \param timeout_us The microseconds a request waits for others to join its batch.
+   * \param names The batched input names of a graph runtime, or the function name of a VM.
+   */
+  DynamicBatcher(Module executor, int max_batch, int64_t timeout_us,
+                 std::vector<std::string> names)
+      : executor_(executor),
+        max_batch_(max_batch),
+        timeout_(timeout_us),
+        names_(std::move(names)) {
+    CHECK_GT(max_batch_, 0);
+    CHECK_GE(timeout_us, 0);
+    std::string type_key = executor_->type_key();
+    if (type_key == "GraphRuntime") {
+      CHECK(!names_.empty()) << "The batched inputs of the graph runtime are required";
+      num_inputs_ = static_cast<int>(names_.size());
+    } else {
+      CHECK_EQ(type_key, "VirtualMachine") << "Cannot batch a " << type_key << " module";
+      CHECK_EQ(names_.size(), 1U) << "The function of the VM to run is required";
+      is_vm_ = true;
+      num_inputs_ = -1;
+    }
+    worker_ = std::thread([this]() { this->Loop(); });
+  }
+
+  ~DynamicBatcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+
+  const char* type_key() const final { return "DynamicBatcher"; }
+
+  /*!
+   * \brief Run a request as part of the next batch, blocking until it is done.
+   * \param inputs The inputs of the request, each with a batch of one.
+   * \return The outputs of the request, each with a batch of one.
+   */
+  Array<NDArray> Infer(std::vector<NDArray> inputs) {
+    CHECK(!inputs.empty()) << "A request needs inputs";
+    for (const NDArray& input : inputs) {
+      CHECK_GE(input->ndim, 1);
+      CHECK_EQ(input->shape[0], 1) << "A request must hold a single sample";
+    }
+    auto request = std::make_shared<Request>();
+    request->inputs = std::move(inputs);
+    request->arrival = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    CHECK(!stop_) << "The batcher was shut down";
+    queue_.push_back(request);
+    cv_.notify_all();
+    request->cv.wait(lock, [&request]() { return request->done; });
+    if (!request->error.empty()) LOG(FATAL) << request->error;
+    Array<NDArray> ret;
+    for (const NDArray& output : request->outputs) ret.push_back(output);
+    return ret;
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "infer") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<NDArray> inputs;
+        for (int i = 0; i < args.num_args; ++i) {
+          inputs.push_back(args[i].operator NDArray());
+        }
+        *rv = this->Infer(std::move(inputs));
+      });
+    } else if (name == "get_max_batch") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = max_batch_; });
+    } else if (name == "get_num_batches") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        *rv = num_batches_;
+      });
+    }
+    return PackedFunc();
+  }
+
+ private:
+  /*! \brief A request waiting for its batch. */
+  struct Request {
+    std::vector<NDArray> inputs;
+    std::vector<NDArray> outputs;
+    std::string error;
+    std::chrono::steady_clock::time_point arrival;
+    bool done{false};
+    std::condition_variable cv;
+  };
+
+  /*! \brief The loop of the worker thread, forming and running the batches. */
+  void Loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      auto deadline = queue_.front()->arrival + timeout_;
+      cv_.wait_until(lock, deadline, [this]() {
+        return stop_ || queue_.size() >= static_cast<size_t>(max_batch_);
+      });
+      std::vector<std::shared_ptr<Request>> batch;
+      while (!queue_.empty() && batch.size() < static_cast<size_t>(max_batch_)) {
+        batch.push_back(queue_.front());
+        queue_.pop_front();
+      }
+      ++num_batches_;
+      lock.unlock();
+      std::string error;
+      try {
+        this->Execute(batch);
+      } catch (const dmlc::Error& e) {
+        error = std::string("Batched inference failed: ") + e.what();
+      }
+      lock.lock();
+      for (auto& request : batch) {
+        request->error = error;
+        request->done = true;
+        request->cv.notify_all();
+      }
+    }
+  }
+
+  /*! \brief Gather the inputs of the requests, run the executor and scatter its outputs. */
+  void Execute(const std::vector<std::shared_ptr<Request>>& batch) {
+    const std::vector<NDArray>& first = batch.front()->inputs;
+    if (buffers_.empty()) {
+      CHECK(num_inputs_ < 0 || static_cast<int>(first.size()) == num_inputs_)
+          << "Expected " << num_inputs_ << " inputs but got " << first.size();
+      for (const NDArray& input : first) {
+        std::vector<int64_t> shape(input->shape, input->shape + input->ndim);
+        shape[0] = max_batch_;
+        buffers_.push_back(NDArray::Empty(shape, input->dtype, {kDLCPU, 0}));
+      }
+    }
+    for (size_t r = 0; r < batch.size(); ++r) {
+      const std::vector<NDArray>& inputs = batch[r]->inputs;
+      CHECK_EQ(inputs.size(), buffers_.size()) << "All requests must have the same inputs";
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        const DLTensor* buffer = buffers_[i].operator->();
+        size_t row_bytes = GetDataSize(*buffer) / max_batch_;
+        CHECK_EQ(GetDataSize(*inputs[i].operator->()), row_bytes)
+            << "Input " << i << " does not match the shape of the first request";
+        // Upload the row in place, from whatever device the request lives on.
+        DLTensor row = *buffer;
+        row.shape = inputs[i]->shape;
+        row.byte_offset = buffer->byte_offset + r * row_bytes;
+        inputs[i].CopyTo(&row);
+      }
+    }
+
+    std::vector<NDArray> outputs = this->RunExecutor();
+    for (size_t r = 0; r < batch.size(); ++r) {
+      batch[r]->outputs.clear();
+      for (const NDArray& output : outputs) {
+        CHECK(output->ndim >= 1 && output->shape[0] == max_batch_)
+            << "The outputs must have the batch of the executor along the first axis";
+        std::vector<int64_t> shape(output->shape, output->shape + output->ndim);
+        shape[0] = 1;
+        NDArray row = NDArray::Empty(shape, output->dtype, {kDLCPU, 0});
+        size_t row_bytes = GetDataSize(*row.operator->());
+        const char* src = static_cast<const char*>(output->data) + output->byte_offset;
+        std::memcpy(row->data, src + r * row_bytes, row_bytes);
+        batch[r]->outputs.push_back(row);
+      }
+    }
+  }
+
+  /*! \return The outputs of one executor run on the buffers, copied to the host. */
+  std::vector<NDArray> RunExecutor() {
+    std::vector<NDArray> outputs;
+    auto to_host = [](NDArray array) {
+      return array->ctx.device_type == kDLCPU ? array : array.CopyTo({kDLCPU, 0});
+    };
+    if (!is_vm_) {
+      PackedFunc set_input = executor_.GetFunction("set_input");
+      for (size_t i = 0; i < names_.size(); ++i) {
+        set_input(names_[i], buffers_[i]);
+      }
+      executor_.GetFunction("run")();
+      PackedFunc get_output = executor_.GetFunction("get_output");
+      int num_outputs = executor_.GetFunction("get_num_outputs")();
+      for (int i = 0; i < num_outputs; ++i) {
+        outputs.push_back(to_host(get_output(i)));
+      }
+      return outputs;
+    }
+    size_t num_args = buffers_.size() + 1;
+    std::vector<TVMValue> values(num_args);
+    std::vector<int> codes(num_args);
+    TVMArgsSetter setter(values.data(), codes.data());
+    setter(0, names_[0]);
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      setter(i + 1, buffers_[i]);
+    }
+    TVMRetValue rv;
+    executor_.GetFunction("set_input")
+        .CallPacked(TVMArgs(values.data(), codes.data(), static_cast<int>(num_args)), &rv);
+    ObjectRef result = executor_.GetFunction("invoke")(names_[0]);
+    if (const auto* adt = result.as<ADTObj>()) {
+      for (size_t i = 0; i < adt->size; ++i) {
+        outputs.push_back(to_host(Downcast<NDArray>((*adt)[i])));
+      }
+    } else {
+      outputs.push_back(to_host(Downcast<NDArray>(result)));
+    }
+    return outputs;
+  }
+
+  /*! \brief The executor running the batches. */
+  Module executor_;
+  /*! \brief Whether the executor is a VM. */
+  bool is_vm_{false};
+  /*! \brief The batch size of the executor. */
+  int max_batch_;
+  /*! \brief How long the oldest request waits for the batch to fill. */
+  std::chrono::microseconds timeout_;
+  /*! \brief The batched input names, or the VM function name. */
+  std::vector<std::string> names_;
+  /*! \brief The number of inputs of a request, -1 when set by the first request. */
+  int num_inputs_;
+  /*! \brief The host buffers of the batched inputs, allocated by the first batch. */
+  std::vector<NDArray> buffers_;
+  /*! \brief The number of batches run. */
+  int64_t num_batches_{0};
+  /*! \brief The requests waiting for a batch. */
+  std::deque<std::shared_ptr<Request>> queue_;
+  /*! \brief Whether the batcher is shutting down. */
+  bool stop_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread worker_;
+};
+
+TVM_REGISTER_GLOBAL("tvm.dynamic_batcher.create").set_body([](TVMArgs args, TVMRetValue* rv) {
+  CHECK_GE(args.num_args, 4) << "The expected arguments are the executor, the max batch, "
+                                "the timeout and the input names or the VM function name";
+  std::vector<std::string> names;
+  for (int i = 3; i < args.num_args; ++i) {
+    names.push_back(args[i].operator std::string());
+  }
+  int64_t timeout_us = args[2];
+  *rv = Module(make_object<DynamicBatcher>(args[0], args[1], timeout_us, names));
+});
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_runtime_cuda_graph.cc
+ */
+#include <cuda_runtime.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+
+#include <vector>
+
+#include "../../cuda/cuda_common.h"
+#include "../graph_runtime.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Graph runtime which replays the graph as a CUDA Graph.
+ *
+ *  The first run captures every operator launch into a CUDA Graph, later runs
+ *  launch the whole graph at once. The graph is captured again whenever the
+ *  data pointers of the inputs or params change, e.g. through set_input_zero_copy.
+ */
+class GraphRuntimeCudaGraph : public GraphRuntime {
+ public:
+  ~GraphRuntimeCudaGraph() {
+    this->ResetGraph();
+    if (stream_ != nullptr) DeviceAPI::Get(ctx_)->FreeStream(ctx_, stream_);
+  }
+
+  /*!
+   * \brief Run the graph, replaying the captured CUDA Graph when possible.
+   */
+  void RunCudaGraph() {
+    if (!this->Capturable()) {
+      GraphRuntime::Run();
+      return;
+    }
+    // Lazily loaded params must be uploaded before capturing.
+    this->PrefetchParams({});
+    std::vector<void*> data = this->InputData();
+    if (exec_ == nullptr || data != captured_data_) {
+      this->Capture();
+      captured_data_ = data;
+    }
+    CUDA_CALL(cudaGraphLaunch(exec_, stream_));
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "run") {
+      return PackedFunc(
+          [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->RunCudaGraph(); });
+    }
+    return GraphRuntime::GetFunction(name, sptr_to_self);
+  }
+
+ private:
+  /*!
+   * \brief Whether every operator can be captured, i.e. all run on a single CUDA
+   *  device and none of them copies data across devices on the default stream.
+   */
+  bool Capturable() {
+    if (capturable_ != -1) return capturable_ == 1;
+    capturable_ = 1;
+    bool found = false;
+    for (uint32_t nid = 0; nid < op_execs_.size(); ++nid) {
+      if (!op_execs_[nid] || nodes_[nid].param.func_name == "__nop") continue;
+      TVMContext ctx = data_entry_[entry_id(nid, 0)]->ctx;
+      if (nodes_[nid].param.func_name == "__copy" || ctx.device_type != kDLGPU ||
+          (found && ctx.device_id != ctx_.device_id)) {
+        LOG(WARNING) << "Node " << nodes_[nid].name << " cannot be captured into a CUDA Graph, "
+                     << "running the graph without it";
+        capturable_ = 0;
+        return false;
+      }
+      ctx_ = ctx;
+      found = true;
+    }
+    return true;
+  }
+
+  /*! \brief The data pointers every operator reads inputs and params from. */
+  std::vector<void*> InputData() const {
+    std::vector<void*> data;
+    for (const auto& tensors : input_dltensors_) {
+      for (const DLTensor* t : tensors) data.push_back(t->data);
+    }
+    return data;
+  }
+
+  /*! \brief Capture the operator launches into a new executable graph. */
+  void Capture() {
+    this->ResetGraph();
+    if (stream_ == nullptr) {
+      stream_ = static_cast<cudaStream_t>(DeviceAPI::Get(ctx_)->CreateStream(ctx_));
+    }
+    DeviceAPI* api = DeviceAPI::Get(ctx_);
+    api->SetStream(ctx_, stream_);
+    // Run once uncaptured, so that modules are loaded and workspace is allocated
+    // from the capture stream's pool before recording.
+    for (size_t i = 0; i < op_execs_.size(); ++i) {
+      if (op_execs_[i]) op_execs_[i]();
+    }
+    CUDA_CALL(cudaStreamBeginCapture(stream_, cudaStreamCaptureModeRelaxed));
+    for (size_t i = 0; i < op_execs_.size(); ++i) {
+      if (op_execs_[i]) op_execs_[i]();
+    }
+    CUDA_CALL(cudaStreamEndCapture(stream_, &graph_));
+    api->SetStream(ctx_, nullptr);
+    CUDA_CALL(cudaGraphInstantiate(&exec_, graph_, nullptr, nullptr, 0));
+  }
+
+  /*! \brief Destroy the captured graph. */
+  void ResetGraph() {
+    if (exec_ != nullptr) CUDA_CALL(cudaGraphExecDestroy(exec_));
+    if (graph_ != nullptr) CUDA_CALL(cudaGraphDestroy(graph_));
+    exec_ = nullptr;
+    graph_ = nullptr;
+  }
+
+  /*! \brief Whether the graph can be captured, -1 until checked. */
+  int capturable_{-1};
+  /*! \brief The device every operator runs on. */
+  TVMContext ctx_;
+  /*! \brief The stream the graph is captured on and launched on. */
+  cudaStream_t stream_{nullptr};
+  /*! \brief The captured graph. */
+  cudaGraph_t graph_{nullptr};
+  /*! \brief The executable instance of the captured graph. */
+  cudaGraphExec_t exec_{nullptr};
+  /*! \brief The input data pointers at capture time. */
+  std::vector<void*> captured_data_;
+};
+
+/*!
+ * \brief GraphRuntimeCudaGraphCreate Create a graph runtime which replays CUDA Graphs.
+ * \param sym_json The graph symbol in json format.
+ * \param m Compiled module which will be loaded.
+ * \param ctxs All devices contexts.
+ */
+Module GraphRuntimeCudaGraphCreate(const std::string& sym_json, const tvm::runtime::Module& m,
+                                   const std::vector<TVMContext>& ctxs) {
+  auto exec = make_object<GraphRuntimeCudaGraph>();
+  exec->Init(sym_json, m, ctxs);
+  return Module(exec);
+}
+
+TVM_REGISTER_GLOBAL("tvm.graph_runtime_cuda_graph.create")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      CHECK_GE(args.num_args, 4) << "The expected number of arguments for "
+                                    "graph_runtime_cuda_graph.create is at least 4, but it has "
+                                 << args.num_args;
+      *rv = GraphRuntimeCudaGraphCreate(args[0], args[1], GetAllContext(args));
+    });
+}  // namespace runtime
+}  // namespace tvm
@@ -21,18 +21,116 @@
  * \file graph_runtime_debug.cc
  */
 #include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "../../timeline.h"
 #include "../graph_runtime.h"
 
 namespace tvm {
 namespace runtime {
 
+/*!
+ * \brief Hardware performance counters of every thread of the process.
+ *
+ *  Uses perf_event on Linux, and is unavailable elsewhere or when the kernel does
+ *  not allow unprivileged access (see /proc/sys/kernel/perf_event_paranoid).
+ *  Threads created after construction, e.g. new thread pool workers, are not counted.
+ */
+class PerfCounters {
+ public:
+  /*! \return The names of the collected counters. */
+  static const std::vector<std::string>& Names() {
+    static const std::vector<std::string> names = {"cycles", "instructions", "cache_references",
+                                                   "cache_misses"};
+    return names;
+  }
+
+  PerfCounters() {
+#ifdef __linux__
+    const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) return;
+    while (dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') continue;
+      pid_t tid = static_cast<pid_t>(std::atoi(entry->d_name));
+      for (size_t i = 0; i < Names().size(); ++i) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0));
+        if (fd < 0) continue;
+        fds_.emplace_back(i, fd);
+      }
+    }
+    closedir(dir);
+#endif
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (const auto& fd : fds_) close(fd.second);
+#endif
+  }
+
+  /*! \return Whether any counter could be opened. */
+  bool available() const { return !fds_.empty(); }
+
+  /*! \brief Reset and start counting. */
+  void Start() {
+#ifdef __linux__
+    for (const auto& fd : fds_) {
+      ioctl(fd.second, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd.second, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  /*!
+   * \brief Stop counting and accumulate the counts since Start.
+   * \param counts The counts to add to, indexed like Names().
+   */
+  void Stop(std::vector<double>* counts) {
+#ifdef __linux__
+    for (const auto& fd : fds_) ioctl(fd.second, PERF_EVENT_IOC_DISABLE, 0);
+    for (const auto& fd : fds_) {
+      uint64_t value = 0;
+      if (read(fd.second, &value, sizeof(value)) == sizeof(value)) {
+        (*counts)[fd.first] += static_cast<double>(value);
+      }
+    }
+#endif
+  }
+
+ private:
+  /*! \brief The counter index and file descriptor of each opened counter. */
+  std::vector<std::pair<size_t, int>> fds_;
+};
+
 /*!
  * \brief Graph runtime with debug .
  *
@@ -60,6 +158,23 @@ class GraphRuntimeDebug : public GraphRuntime {
     GraphRuntime::Run();
     std::ostringstream os;
     std::vector<double> time_per_op(op_execs_.size(), 0);
+    // Ops on devices that time their commands report the device time
+    // rather than the host time around the op.
+    std::vector<const PackedFunc*> profiled_time(op_execs_.size(), nullptr);
+    std::vector<std::pair<const PackedFunc*, TVMContext>> profiling;
+    for (size_t index = 0; index < op_execs_.size(); ++index) {
+      if (!op_execs_[index]) continue;
+      const TVMContext& ctx = data_entry_[entry_id(index, 0)]->ctx;
+      std::string prefix = std::string("device_api.") + DeviceName(ctx.device_type);
+      const PackedFunc* set_profiling = Registry::Get(prefix + ".set_profiling");
+      profiled_time[index] = Registry::Get(prefix + ".profiled_time");
+      if (set_profiling == nullptr || profiled_time[index] == nullptr) {
+        profiled_time[index] = nullptr;
+        continue;
+      }
+      (*set_profiling)(ctx.device_id, true);
+      profiling.emplace_back(set_profiling, ctx);
+    }
     for (int i = 0; i < repeat; ++i) {
       std::chrono::time_point<std::chrono::high_resolution_clock, std::chrono::nanoseconds> tbegin,
           tend;
@@ -82,6 +197,11 @@ class GraphRuntimeDebug : public GraphRuntime {
               double op_duration =
                   std::chrono::duration_cast<std::chrono::duration<double> >(op_tend - op_tbegin)
                       .count();
+              if (profiled_time[index] != nullptr) {
+                // negative when the op enqueued no command, e.g. a copy on the host.
+                double device_us = (*profiled_time[index])(ctx.device_id);
+                if (device_us >= 0) op_duration = device_us * 1e-6;
+              }
               time_per_op[index] += op_duration * 1e6;  // us
             }
           }
@@ -102,12 +222,97 @@ class GraphRuntimeDebug : public GraphRuntime {
         }
       }
     }
+    for (const auto& p : profiling) {
+      (*p.first)(p.second.device_id, false);
+    }
     for (size_t index = 0; index < time_per_op.size(); index++) {
       os << time_per_op[index] << ",";
     }
     return os.str();
   }
 
+  /*!
+   * \brief Run each operation in the graph and collect its hardware counters.
+   *
+   * Only operations on the CPU are measured.
+   *
+   * \param number The number of times to run each op, counts are averaged over them.
+   * \return The counter names on the first line, then one line of comma separated
+   *         counts per node, empty if counters are not available on this machine.
+   */
+  std::string RunIndividualCounters(int number) {
+    // warmup run, which also starts the thread pool workers to be counted
+    GraphRuntime::Run();
+    PerfCounters counters;
+    if (!counters.available()) {
+      LOG(WARNING) << "Hardware performance counters are not available";
+      return "";
+    }
+    const std::vector<std::string>& names = PerfCounters::Names();
+    std::ostringstream os;
+    for (size_t i = 0; i < names.size(); ++i) {
+      os << names[i] << (i + 1 < names.size() ? "," : "\n");
+    }
+    for (size_t index = 0; index < op_execs_.size(); ++index) {
+      std::vector<double> counts(names.size(), 0);
+      // The counters measure the host, so ops on other devices report zeros.
+      if (op_execs_[index] && data_entry_[entry_id(index, 0)]->ctx.device_type == kDLCPU) {
+        for (int k = 0; k < number; k++) {
+          counters.Start();
+          op_execs_[index]();
+          counters.Stop(&counts);
+        }
+      }
+      for (size_t i = 0; i < counts.size(); ++i) {
+        os << counts[i] / number << (i + 1 < counts.size() ? "," : "\n");
+      }
+    }
+    return os.str();
+  }
+
+  /*!
+   * \brief Run the graph once, one operation at a time, and record its timeline.
+   *
+   * Each operation runs on the stream assigned by the multi-stream mode, and is
+   * synchronized before the next one starts, so the recorded durations are per op.
+   *
+   * \return The storage allocations, operations and data copies of the run in the
+   *         Chrome trace event JSON format.
+   */
+  std::string RunTimeline() {
+    // warmup run, which also sets the streams up
+    GraphRuntime::Run();
+    Timeline timeline;
+    for (size_t sid = 0; sid < storage_pool_.size(); ++sid) {
+      if (!storage_pool_[sid].defined()) continue;
+      const DLTensor* pool = storage_pool_[sid].operator->();
+      timeline.AddInstant("storage_" + std::to_string(sid), "alloc", pool->ctx, 0,
+                          {{"bytes", static_cast<int64_t>(GetDataSize(*pool))}});
+    }
+    for (size_t index = 0; index < op_execs_.size(); ++index) {
+      if (!op_execs_[index]) continue;
+      TVMContext ctx = data_entry_[entry_id(index, 0)]->ctx;
+      TVMStreamHandle stream = nullptr;
+      int stream_index = 0;
+      if (!op_streams_.empty() && op_streams_[index].stream != nullptr) {
+        stream = op_streams_[index].stream;
+        for (size_t i = 0; i < streams_.size(); ++i) {
+          if (streams_[i].second == stream) stream_index = static_cast<int>(i) + 1;
+        }
+        DeviceAPI::Get(ctx)->SetStream(ctx, stream);
+      }
+      double begin = timeline.Now();
+      op_execs_[index]();
+      TVMSynchronize(ctx.device_type, ctx.device_id, stream);
+      double end = timeline.Now();
+      if (stream != nullptr) DeviceAPI::Get(ctx)->SetStream(ctx, nullptr);
+      const std::string& func_name = nodes_[index].param.func_name;
+      timeline.AddSpan(GetNodeName(index), func_name == "__copy" ? "copy" : "op", ctx,
+                       stream_index, begin, end, {{"node", static_cast<int64_t>(index)}});
+    }
+    return timeline.ToJSON();
+  }
+
   /*!
    * \brief Run each operation and get the output.
    * \param index The index of op which needs to be returned.
@@ -152,6 +357,7 @@ class GraphRuntimeDebug : public GraphRuntime {
     uint32_t eid = index;
 
     for (size_t i = 0; i < op_execs_.size(); ++i) {
+      if (!pending_params_.empty()) this->MaterializeInputs(i);
       if (op_execs_[i]) op_execs_[i]();
       if (static_cast<int>(i) == index) break;
     }
@@ -190,6 +396,15 @@ PackedFunc GraphRuntimeDebug::GetFunction(const std::string& name,
       CHECK_GE(min_repeat_ms, 0);
       *rv = this->RunIndividual(number, repeat, min_repeat_ms);
     });
+  } else if (name == "run_individual_counters") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int number = args[0];
+      CHECK_GT(number, 0);
+      *rv = this->RunIndividualCounters(number);
+    });
+  } else if (name == "run_timeline") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->RunTimeline(); });
   } else {
     return GraphRuntime::GetFunction(name, sptr_to_self);
   }
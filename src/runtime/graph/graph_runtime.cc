@@ -28,8 +28,11 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <numeric>
@@ -38,6 +41,10 @@
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
+#include "../trace.h"
+#include "../weight_registry.h"
+
 namespace tvm {
 namespace runtime {
 namespace details {
@@ -46,16 +53,400 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
   if (align < kAllocAlignment) return kAllocAlignment;
   return align;
 }
+
+/*!
+ * \brief Create an NDArray with the shape, dtype and context of another one but no data.
+ *  It stands in for a param whose storage has been released.
+ */
+inline NDArray Placeholder(const NDArray& like) {
+  MappedTensorContext* manager = new MappedTensorContext{
+      nullptr, std::vector<int64_t>(like->shape, like->shape + like->ndim)};
+  DLManagedTensor* tensor = new DLManagedTensor();
+  tensor->dl_tensor = *like.operator->();
+  tensor->dl_tensor.data = nullptr;
+  tensor->dl_tensor.shape = manager->shape.data();
+  tensor->dl_tensor.strides = nullptr;
+  tensor->dl_tensor.byte_offset = 0;
+  tensor->manager_ctx = manager;
+  tensor->deleter = [](DLManagedTensor* self) {
+    delete static_cast<MappedTensorContext*>(self->manager_ctx);
+    delete self;
+  };
+  return NDArray::FromDLPack(tensor);
+}
 }  // namespace details
 
 /*!
  * \brief Run all the operations one by one.
  */
-void GraphRuntime::Run() {
+void GraphRuntime::Run() { this->Launch(false); }
+
+int64_t GraphRuntime::RunAsync() {
+  if (async_streams_.empty()) this->SetupAsyncStreams();
+  this->Launch(true);
+  return ++async_launched_;
+}
+
+void GraphRuntime::WaitAsync(int64_t ticket) {
+  CHECK_LE(ticket, async_launched_) << "unknown asynchronous run " << ticket;
+  if (ticket <= async_finished_) return;
+  for (const AsyncStreams& s : async_streams_) {
+    DeviceAPI::Get(s.ctx)->StreamSync(s.ctx, s.compute);
+  }
+  async_finished_ = async_launched_;
+}
+
+void GraphRuntime::Launch(bool async) {
+  threading::ThreadPoolPartitionScope partition_scope(thread_pool_partition_);
+  if (op_streams_.empty() && num_streams_ > 1) this->SetupStreams();
+  if (!async_streams_.empty()) {
+    // Wait for the uploads, move the staged inputs in place, then let the next
+    // uploads proceed while this run computes.
+    for (const AsyncStreams& s : async_streams_) {
+      TVMStreamHandle run_stream = async ? s.compute : nullptr;
+      DeviceAPI* api = DeviceAPI::Get(s.ctx);
+      api->SyncStreamFromTo(s.ctx, s.upload, run_stream);
+      if (async) api->SetStream(s.ctx, s.compute);
+    }
+    for (uint32_t eid : staged_inputs_) {
+      const DLTensor* entry = data_entry_[eid].operator->();
+      NDArray::CopyFromTo(input_staging_[eid].operator->(), const_cast<DLTensor*>(entry),
+                          async ? GetAsyncStreams(entry->ctx)->compute : nullptr);
+    }
+    staged_inputs_.clear();
+    for (const AsyncStreams& s : async_streams_) {
+      DeviceAPI::Get(s.ctx)->SyncStreamFromTo(s.ctx, async ? s.compute : nullptr, s.upload);
+    }
+  }
+  if (async) {
+    for (const auto& stream : streams_) {
+      DeviceAPI::Get(stream.first)
+          ->SyncStreamFromTo(stream.first, GetAsyncStreams(stream.first)->compute, stream.second);
+    }
+  }
+  if (overlap_copies_ && copy_issue_.empty()) this->SetupCopies();
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
-    if (op_execs_[i]) op_execs_[i]();
+    if (!copy_issue_.empty()) this->IssueCopies(i, async);
+    if (!pending_params_.empty()) this->MaterializeInputs(i);
+    if (!op_execs_[i]) continue;
+    if (!copy_issue_.empty() && overlapped_copy_[i]) continue;
+    TVM_TRACE_SPAN(kOp, nodes_[i].param.func_name, -1);
+    if (op_streams_.empty() || op_streams_[i].stream == nullptr) {
+      op_execs_[i]();
+      continue;
+    }
+    const OpStream& op_stream = op_streams_[i];
+    DeviceAPI* api = DeviceAPI::Get(op_stream.ctx);
+    for (TVMStreamHandle wait : op_stream.waits) {
+      api->SyncStreamFromTo(op_stream.ctx, wait, op_stream.stream);
+    }
+    api->SetStream(op_stream.ctx, op_stream.stream);
+    op_execs_[i]();
+    api->SetStream(op_stream.ctx, async ? GetAsyncStreams(op_stream.ctx)->compute : nullptr);
+  }
+  // Join every stream back into the stream outputs are read from. Outputs copied
+  // to the host are read right after Run, so wait for them.
+  for (const auto& stream : copy_streams_) {
+    DeviceAPI* api = DeviceAPI::Get(stream.first);
+    api->SyncStreamFromTo(stream.first, stream.second, BaseStream(stream.first, async));
+    if (!async) api->StreamSync(stream.first, stream.second);
+  }
+  for (const auto& stream : streams_) {
+    TVMStreamHandle join = async ? GetAsyncStreams(stream.first)->compute : nullptr;
+    DeviceAPI::Get(stream.first)->SyncStreamFromTo(stream.first, stream.second, join);
+  }
+  if (async) {
+    for (const AsyncStreams& s : async_streams_) {
+      DeviceAPI::Get(s.ctx)->SetStream(s.ctx, nullptr);
+    }
+  }
+}
+
+GraphRuntime::~GraphRuntime() {
+  this->FreeStreams();
+  this->FreeAsyncStreams();
+  this->FreeCopies();
+}
+
+// Whether the device implements the stream API, CUDA and ROCm do.
+static bool HasStreams(TVMContext ctx) {
+  return ctx.device_type == kDLGPU || ctx.device_type == kDLROCM;
+}
+
+void GraphRuntime::SetNumStreams(int num_streams) {
+  CHECK_GE(num_streams, 1);
+  CHECK(num_streams == 1 || !overlap_copies_)
+      << "Overlapped copies only run with the default stream of each device";
+  num_streams_ = num_streams;
+  this->FreeStreams();
+}
+
+void GraphRuntime::SetupStreams() {
+  this->FreeStreams();
+  op_streams_.resize(op_execs_.size());
+  // The streams of one device, and the node last launched on each of them.
+  struct DeviceStreams {
+    TVMContext ctx;
+    std::vector<TVMStreamHandle> streams;
+    std::vector<int64_t> tail;
+  };
+  std::vector<DeviceStreams> devices;
+  std::vector<int> node_device(op_execs_.size(), -1);
+  std::vector<int> node_stream(op_execs_.size(), -1);
+  // The planner reuses storage ids, so the last node writing each of them and the nodes
+  // reading it since then must also finish before another node writes it.
+  struct StorageUse {
+    int writer{-1};
+    std::vector<int> readers;
+  };
+  size_t num_storage = 0;
+  for (int sid : attrs_.storage_id) {
+    num_storage = std::max(num_storage, static_cast<size_t>(sid) + 1);
+  }
+  std::vector<StorageUse> storage_uses(num_storage);
+  for (uint32_t nid = 0; nid < op_execs_.size(); ++nid) {
+    if (!op_execs_[nid]) continue;
+    TVMContext ctx = data_entry_[entry_id(nid, 0)]->ctx;
+    op_streams_[nid].ctx = ctx;
+    // Devices without the stream API stay on the default stream.
+    if (!HasStreams(ctx)) continue;
+    int device = 0;
+    while (device < static_cast<int>(devices.size()) &&
+           devices[device].ctx.device_id != ctx.device_id) {
+      ++device;
+    }
+    if (device == static_cast<int>(devices.size())) {
+      DeviceStreams d;
+      d.ctx = ctx;
+      for (int i = 0; i < num_streams_; ++i) {
+        d.streams.push_back(DeviceAPI::Get(ctx)->CreateStream(ctx));
+        d.tail.push_back(-1);
+        streams_.emplace_back(ctx, d.streams.back());
+      }
+      devices.push_back(std::move(d));
+    }
+    DeviceStreams& d = devices[device];
+
+    // Continue the stream of a producer when this is the first node following it,
+    // otherwise start on the least recently used stream.
+    int chosen = -1;
+    for (const auto& e : nodes_[nid].inputs) {
+      int producer = static_cast<int>(e.node_id);
+      if (node_device[producer] == device && d.tail[node_stream[producer]] == producer) {
+        chosen = node_stream[producer];
+        break;
+      }
+    }
+    if (chosen < 0) {
+      chosen = static_cast<int>(std::min_element(d.tail.begin(), d.tail.end()) - d.tail.begin());
+    }
+    node_device[nid] = device;
+    node_stream[nid] = chosen;
+    d.tail[chosen] = nid;
+    op_streams_[nid].stream = d.streams[chosen];
+
+    // The nodes this one must follow: the producers of its inputs, the last writers of the
+    // storage it reads, and the last writer and readers of the storage it overwrites.
+    std::vector<int> deps;
+    for (const auto& e : nodes_[nid].inputs) {
+      deps.push_back(static_cast<int>(e.node_id));
+      deps.push_back(storage_uses[attrs_.storage_id[entry_id(e)]].writer);
+    }
+    for (uint32_t i = 0; i < nodes_[nid].param.num_outputs; ++i) {
+      const StorageUse& use = storage_uses[attrs_.storage_id[entry_id(nid, i)]];
+      deps.push_back(use.writer);
+      deps.insert(deps.end(), use.readers.begin(), use.readers.end());
+    }
+    // Only dependencies crossing streams need an event. Nodes on the default stream are
+    // ordered by it, as CUDA and HIP streams are blocking.
+    for (int dep : deps) {
+      if (dep < 0 || node_device[dep] != device || node_stream[dep] == chosen) continue;
+      TVMStreamHandle wait = d.streams[node_stream[dep]];
+      auto& waits = op_streams_[nid].waits;
+      if (std::find(waits.begin(), waits.end(), wait) == waits.end()) {
+        waits.push_back(wait);
+      }
+    }
+    for (const auto& e : nodes_[nid].inputs) {
+      storage_uses[attrs_.storage_id[entry_id(e)]].readers.push_back(nid);
+    }
+    for (uint32_t i = 0; i < nodes_[nid].param.num_outputs; ++i) {
+      StorageUse& use = storage_uses[attrs_.storage_id[entry_id(nid, i)]];
+      use.writer = nid;
+      use.readers.clear();
+    }
+  }
+}
+
+void GraphRuntime::FreeStreams() {
+  for (const auto& stream : streams_) {
+    DeviceAPI::Get(stream.first)->FreeStream(stream.first, stream.second);
+  }
+  streams_.clear();
+  op_streams_.clear();
+}
+
+void GraphRuntime::SetupAsyncStreams() {
+  for (const TVMContext& ctx : ctxs_) {
+    // Devices without the stream API run synchronously.
+    if (!HasStreams(ctx) || GetAsyncStreams(ctx) != nullptr) continue;
+    AsyncStreams s;
+    s.ctx = ctx;
+    s.compute = DeviceAPI::Get(ctx)->CreateStream(ctx);
+    s.upload = DeviceAPI::Get(ctx)->CreateStream(ctx);
+    async_streams_.push_back(s);
+  }
+}
+
+void GraphRuntime::FreeAsyncStreams() {
+  for (const AsyncStreams& s : async_streams_) {
+    DeviceAPI::Get(s.ctx)->StreamSync(s.ctx, s.compute);
+    DeviceAPI::Get(s.ctx)->FreeStream(s.ctx, s.compute);
+    DeviceAPI::Get(s.ctx)->FreeStream(s.ctx, s.upload);
+  }
+  async_streams_.clear();
+}
+
+void GraphRuntime::SetPinnedStaging(bool enable) {
+  if (!enable) {
+    pinned_staging_.reset();
+  } else if (pinned_staging_ == nullptr) {
+    pinned_staging_.reset(new PinnedStaging());
+  }
+}
+
+void GraphRuntime::SetOverlapCopies(bool overlap) {
+  CHECK(!overlap || num_streams_ == 1)
+      << "Overlapped copies only run with the default stream of each device";
+  overlap_copies_ = overlap;
+  this->FreeCopies();
+}
+
+void GraphRuntime::SetupCopies() {
+  size_t num_nodes = op_execs_.size();
+  copy_issue_.assign(num_nodes + 1, {});
+  copy_waits_.assign(num_nodes, {});
+  overlapped_copy_.assign(num_nodes, false);
+  auto reads = [this](uint32_t nid, uint32_t eid) {
+    for (const auto& e : nodes_[nid].inputs) {
+      if (this->entry_id(e) == eid) return true;
+    }
+    return false;
+  };
+  auto writes = [this](uint32_t nid, int sid) {
+    for (uint32_t eid = node_row_ptr_[nid]; eid < node_row_ptr_[nid + 1]; ++eid) {
+      if (attrs_.storage_id[eid] == sid) return true;
+    }
+    return false;
+  };
+  auto uses = [this, &writes](uint32_t nid, int sid) {
+    for (const auto& e : nodes_[nid].inputs) {
+      if (attrs_.storage_id[this->entry_id(e)] == sid) return true;
+    }
+    return writes(nid, sid);
+  };
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (!op_execs_[nid] || nodes_[nid].param.func_name != "__copy") continue;
+    uint32_t in_eid = this->entry_id(nodes_[nid].inputs[0]);
+    uint32_t out_eid = this->entry_id(nid, 0);
+    TVMContext from = data_entry_[in_eid]->ctx;
+    TVMContext to = data_entry_[out_eid]->ctx;
+    // Only copies between the host and a device with streams can overlap.
+    CopyNode copy{nid, from};
+    if (from.device_type == kDLCPU && HasStreams(to)) {
+      copy.ctx = to;
+    } else if (!HasStreams(from) || to.device_type != kDLCPU) {
+      continue;
+    }
+    bool has_stream = false;
+    for (const auto& stream : copy_streams_) {
+      has_stream |= stream.first.device_id == copy.ctx.device_id;
+    }
+    if (!has_stream) {
+      copy_streams_.emplace_back(copy.ctx, DeviceAPI::Get(copy.ctx)->CreateStream(copy.ctx));
+    }
+
+    // Issue the copy right after its producer, unless the nodes in between still
+    // use the storage it writes.
+    int in_sid = attrs_.storage_id[in_eid];
+    int out_sid = attrs_.storage_id[out_eid];
+    uint32_t issue = nodes_[nid].inputs[0].node_id + 1;
+    for (uint32_t n = issue; n < nid; ++n) {
+      if (uses(n, out_sid)) issue = n + 1;
+    }
+    copy_issue_[issue].push_back(copy);
+    overlapped_copy_[nid] = true;
+
+    // The first node reading its output, or overwriting the storage it reads or
+    // writes, waits for the copy. A node on the device waits on its stream, which
+    // orders the later nodes of the device. A node elsewhere blocks the host until
+    // the copy is done, which orders everything after it.
+    for (uint32_t n = issue; n < num_nodes; ++n) {
+      if (n == nid || !op_execs_[n]) continue;
+      if (!reads(n, out_eid) && !writes(n, in_sid) && !writes(n, out_sid)) continue;
+      TVMContext ctx = data_entry_[this->entry_id(n, 0)]->ctx;
+      bool on_device = ctx.device_type == copy.ctx.device_type &&
+                       ctx.device_id == copy.ctx.device_id;
+      bool waited = false;
+      for (uint32_t m = issue; m < n && !waited; ++m) {
+        for (const CopyNode& w : copy_waits_[m]) waited |= w.nid == nid;
+      }
+      if (on_device && waited) continue;
+      copy_waits_[n].push_back(copy);
+      if (!on_device) break;
+    }
+  }
+}
+
+void GraphRuntime::FreeCopies() {
+  for (const auto& stream : copy_streams_) {
+    DeviceAPI::Get(stream.first)->FreeStream(stream.first, stream.second);
   }
+  copy_streams_.clear();
+  copy_issue_.clear();
+  copy_waits_.clear();
+  overlapped_copy_.clear();
+}
+
+void GraphRuntime::IssueCopies(uint32_t nid, bool async) {
+  auto copy_stream = [this](TVMContext ctx) {
+    for (const auto& stream : copy_streams_) {
+      if (stream.first.device_id == ctx.device_id) return stream.second;
+    }
+    return TVMStreamHandle(nullptr);
+  };
+  for (const CopyNode& copy : copy_issue_[nid]) {
+    if (!pending_params_.empty()) this->MaterializeInputs(copy.nid);
+    TVMStreamHandle stream = copy_stream(copy.ctx);
+    // Order the copy after the device work launched so far, which includes its
+    // producer and the previous users of its output.
+    DeviceAPI::Get(copy.ctx)->SyncStreamFromTo(copy.ctx, BaseStream(copy.ctx, async), stream);
+    op_args_[copy.nid]->stream = stream;
+    op_execs_[copy.nid]();
+    op_args_[copy.nid]->stream = nullptr;
+  }
+  for (const CopyNode& copy : copy_waits_[nid]) {
+    TVMContext ctx = data_entry_[this->entry_id(nid, 0)]->ctx;
+    DeviceAPI* api = DeviceAPI::Get(copy.ctx);
+    if (ctx.device_type == copy.ctx.device_type && ctx.device_id == copy.ctx.device_id) {
+      api->SyncStreamFromTo(copy.ctx, copy_stream(copy.ctx), BaseStream(copy.ctx, async));
+    } else {
+      api->StreamSync(copy.ctx, copy_stream(copy.ctx));
+    }
+  }
+}
+
+TVMStreamHandle GraphRuntime::BaseStream(TVMContext ctx, bool async) const {
+  const AsyncStreams* s = async ? this->GetAsyncStreams(ctx) : nullptr;
+  return s != nullptr ? s->compute : nullptr;
+}
+
+const GraphRuntime::AsyncStreams* GraphRuntime::GetAsyncStreams(TVMContext ctx) const {
+  for (const AsyncStreams& s : async_streams_) {
+    if (s.ctx.device_type == ctx.device_type && s.ctx.device_id == ctx.device_id) return &s;
+  }
+  return nullptr;
 }
 /*!
  * \brief Initialize the graph executor with graph and context.
@@ -66,13 +457,12 @@ void GraphRuntime::Run() {
  * executed on.
  */
 void GraphRuntime::Init(const std::string& graph_json, tvm::runtime::Module module,
-                        const std::vector<TVMContext>& ctxs) {
-  std::istringstream is(graph_json);
-  dmlc::JSONReader reader(&is);
-  this->Load(&reader);
+                        const std::vector<TVMContext>& ctxs,
+                        const std::vector<NDArray>& storage_pool) {
+  this->LoadGraph(graph_json);
   module_ = module;
   ctxs_ = ctxs;
-  this->SetupStorage();
+  this->SetupStorage(storage_pool);
   this->SetupOpExecs();
   for (size_t i = 0; i < input_nodes_.size(); i++) {
     const uint32_t nid = input_nodes_[i];
@@ -80,6 +470,115 @@ void GraphRuntime::Init(const std::string& graph_json, tvm::runtime::Module modu
     input_map_[name] = i;
   }
 }
+
+void GraphRuntime::GrowStoragePool(const std::string& graph_json,
+                                   const std::vector<TVMContext>& ctxs,
+                                   const std::unordered_set<std::string>& private_inputs,
+                                   std::vector<NDArray>* storage_pool) {
+  GraphRuntime graph;
+  graph.LoadGraph(graph_json);
+  graph.ctxs_ = ctxs;
+  std::vector<PoolEntry> pool_entry = graph.PlanStorage();
+  // The storage ids only used by private inputs.
+  std::vector<bool> is_private(pool_entry.size(), true);
+  for (uint32_t nid = 0; nid < graph.nodes_.size(); ++nid) {
+    bool private_node =
+        graph.nodes_[nid].op_type == "null" && private_inputs.count(graph.nodes_[nid].name);
+    for (uint32_t eid = graph.node_row_ptr_[nid]; eid < graph.node_row_ptr_[nid + 1]; ++eid) {
+      if (!private_node) is_private[graph.attrs_.storage_id[eid]] = false;
+    }
+  }
+  if (storage_pool->size() < pool_entry.size()) {
+    storage_pool->resize(pool_entry.size());
+  }
+  for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+    if (is_private[sid]) continue;
+    TVMContext ctx = graph.PoolContext(pool_entry[sid]);
+    NDArray& storage = (*storage_pool)[sid];
+    if (storage.defined()) {
+      CHECK(storage->ctx.device_type == ctx.device_type && storage->ctx.device_id == ctx.device_id)
+          << "The graphs sharing a storage pool place storage id " << sid
+          << " on different devices";
+      if (GetDataSize(*storage.operator->()) >= pool_entry[sid].size) continue;
+    }
+    std::vector<int64_t> shape{static_cast<int64_t>(pool_entry[sid].size + 3) / 4};
+    storage = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, ctx);
+  }
+}
+
+void GraphRuntime::LoadGraph(const std::string& graph_json) {
+  uint64_t magic = 0;
+  if (graph_json.size() >= sizeof(magic)) {
+    std::memcpy(&magic, graph_json.data(), sizeof(magic));
+  }
+  if (magic == kTVMGraphBinaryMagic) {
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(graph_json.data()), graph_json.size());
+    strm.Read(&magic, sizeof(magic));
+    this->LoadBinary(&strm);
+  } else {
+    std::istringstream is(graph_json);
+    dmlc::JSONReader reader(&is);
+    this->Load(&reader);
+  }
+}
+void GraphRuntime::LoadBinary(dmlc::Stream* strm) {
+  auto read_u32 = [strm]() {
+    uint32_t v;
+    CHECK_EQ(strm->Read(&v, sizeof(v)), sizeof(v)) << "truncated binary graph";
+    return v;
+  };
+  auto read_str = [strm, &read_u32]() {
+    std::string str(read_u32(), '\0');
+    CHECK_EQ(strm->Read(&str[0], str.size()), str.size()) << "truncated binary graph";
+    return str;
+  };
+  auto read_entry = [&read_u32]() {
+    NodeEntry e;
+    e.node_id = read_u32();
+    e.index = read_u32();
+    e.version = read_u32();
+    return e;
+  };
+  uint32_t version = read_u32();
+  CHECK_EQ(version, kTVMGraphBinaryVersion) << "unsupported binary graph version " << version;
+  nodes_.resize(read_u32());
+  for (Node& node : nodes_) {
+    node.op_type = read_str();
+    node.name = read_str();
+    node.param.func_name = read_str();
+    node.param.num_inputs = read_u32();
+    node.param.num_outputs = read_u32();
+    node.param.flatten_data = read_u32();
+    node.inputs.resize(read_u32());
+    for (NodeEntry& e : node.inputs) e = read_entry();
+  }
+  input_nodes_.resize(read_u32());
+  for (uint32_t& nid : input_nodes_) nid = read_u32();
+  node_row_ptr_.resize(read_u32());
+  for (uint32_t& eid : node_row_ptr_) eid = read_u32();
+  outputs_.resize(read_u32());
+  for (NodeEntry& e : outputs_) e = read_entry();
+
+  uint32_t num_entries = read_u32();
+  attrs_.storage_id.resize(num_entries);
+  for (int& sid : attrs_.storage_id) sid = static_cast<int>(read_u32());
+  attrs_.device_index.resize(read_u32());
+  for (int& dev : attrs_.device_index) dev = static_cast<int>(read_u32());
+  attrs_.dltype.resize(num_entries);
+  for (std::string& dtype : attrs_.dltype) {
+    DLDataType t;
+    CHECK_EQ(strm->Read(&t, sizeof(t)), sizeof(t)) << "truncated binary graph";
+    dtype = DLDataType2String(t);
+  }
+  attrs_.shape.resize(num_entries);
+  for (auto& shape : attrs_.shape) shape.resize(read_u32());
+  for (auto& shape : attrs_.shape) {
+    size_t bytes = sizeof(int64_t) * shape.size();
+    CHECK_EQ(strm->Read(shape.data(), bytes), bytes) << "truncated binary graph";
+  }
+  // The arena plan that follows is only consumed by the C runtime.
+}
+
 /*!
  * \brief Get the input index given the name of input.
  * \param name The name of the input.
@@ -101,7 +600,36 @@ int GraphRuntime::GetInputIndex(const std::string& name) {
 void GraphRuntime::SetInput(int index, DLTensor* data_in) {
   CHECK_LT(static_cast<size_t>(index), input_nodes_.size());
   uint32_t eid = this->entry_id(input_nodes_[index], 0);
-  data_entry_[eid].CopyFrom(data_in);
+  this->MaterializeParam(eid);
+  this->Unshare(eid);
+  const AsyncStreams* async = this->GetAsyncStreams(data_entry_[eid]->ctx);
+  bool staged = pinned_staging_ != nullptr &&
+                PinnedStaging::CanStage(data_in->ctx, data_entry_[eid]->ctx);
+  if (async == nullptr) {
+    if (staged) {
+      pinned_staging_->Copy(index, data_in, const_cast<DLTensor*>(data_entry_[eid].operator->()),
+                            nullptr);
+    } else {
+      data_entry_[eid].CopyFrom(data_in);
+    }
+    return;
+  }
+  // The launched run may still read the input, upload the next one aside.
+  NDArray& staging = input_staging_[eid];
+  if (!staging.defined()) {
+    const DLTensor* entry = data_entry_[eid].operator->();
+    std::vector<int64_t> shape(entry->shape, entry->shape + entry->ndim);
+    staging = NDArray::Empty(shape, entry->dtype, entry->ctx);
+  }
+  if (staged) {
+    pinned_staging_->Copy(index, data_in, const_cast<DLTensor*>(staging.operator->()),
+                          async->upload);
+  } else {
+    NDArray::CopyFromTo(data_in, const_cast<DLTensor*>(staging.operator->()), async->upload);
+  }
+  if (std::find(staged_inputs_.begin(), staged_inputs_.end(), eid) == staged_inputs_.end()) {
+    staged_inputs_.push_back(eid);
+  }
 }
 /*!
  * \brief set index-th input to the graph without copying the data.
@@ -111,11 +639,25 @@ void GraphRuntime::SetInput(int index, DLTensor* data_in) {
 void GraphRuntime::SetInputZeroCopy(int index, DLTensor* data_ref) {
   CHECK_LT(static_cast<size_t>(index), input_nodes_.size());
   uint32_t eid = this->entry_id(input_nodes_[index], 0);
+  this->MaterializeParam(eid);
+  staged_inputs_.erase(std::remove(staged_inputs_.begin(), staged_inputs_.end(), eid),
+                       staged_inputs_.end());
+  shared_params_.erase(eid);
   const DLTensor* old_t = data_entry_[eid].operator->();
 
   // check the consistency of input
+  CHECK(IsContiguous(*data_ref))
+      << "set_input_zero_copy expects a compact array, use set_input to copy a strided view";
+  void* data = data_ref->data;
+  if (data_ref->byte_offset != 0) {
+    // A view of a larger array, the kernels expect it at the data pointer.
+    CHECK(IsAddressableContext(data_ref->ctx))
+        << "set_input_zero_copy does not support a byte_offset on "
+        << DeviceName(data_ref->ctx.device_type);
+    data = static_cast<char*>(data) + data_ref->byte_offset;
+  }
   CHECK_EQ(data_alignment_[eid], details::GetDataAlignment(*data_ref));
-  CHECK_EQ(reinterpret_cast<size_t>(data_ref->data) % kAllocAlignment, 0);
+  CHECK_EQ(reinterpret_cast<size_t>(data) % kAllocAlignment, 0);
   CHECK_EQ(old_t->ndim, static_cast<size_t>(data_ref->ndim));
   CHECK_EQ(old_t->ctx.device_type, data_ref->ctx.device_type);
   CHECK_EQ(old_t->ctx.device_id, data_ref->ctx.device_id);
@@ -125,7 +667,7 @@ void GraphRuntime::SetInputZeroCopy(int index, DLTensor* data_ref) {
 
   // Update the data pointer for each argument of each op
   for (DLTensor* t : input_dltensors_[eid]) {
-    t->data = data_ref->data;
+    t->data = data;
   }
 }
 /*!
@@ -178,6 +720,11 @@ void GraphRuntime::CopyOutputTo(int index, DLTensor* data_out) {
     CHECK_EQ(data->shape[j], data_out->shape[j]);
   }
 
+  if (pinned_staging_ != nullptr && PinnedStaging::CanStage(data->ctx, data_out->ctx)) {
+    // the outputs use the buffers after those of the inputs
+    pinned_staging_->Copy(input_nodes_.size() + index, data.operator->(), data_out, nullptr);
+    return;
+  }
   data_entry_[eid].CopyTo(data_out);
 }
 
@@ -215,11 +762,204 @@ void GraphRuntime::LoadParams(dmlc::Stream* strm) {
     // The data_entry is allocated on device, NDArray.load always load the array into CPU.
     NDArray temp;
     temp.Load(strm);
-    data_entry_[eid].CopyFrom(temp);
+    this->SetParam(eid, temp);
+  }
+}
+
+void GraphRuntime::LoadParamsFromFile(const std::string& path) {
+  uint64_t header = 0;
+  {
+    std::ifstream fs(path, std::ios::in | std::ios::binary);
+    CHECK(!fs.fail()) << "Cannot open " << path;
+    fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (header != kTVMMappedNDArrayListMagic) {
+      fs.seekg(0, std::ios::beg);
+      std::string param_blob((std::istreambuf_iterator<char>(fs)),
+                             std::istreambuf_iterator<char>());
+      this->LoadParams(param_blob);
+      return;
+    }
+  }
+  CHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Mapped parameters require a little endian host";
+
+  auto file = std::make_shared<MappedFile>(path);
+  dmlc::MemoryFixedSizeStream strm(file->data(), file->size());
+  uint64_t alignment;
+  CHECK(strm.Read(&header)) << "Invalid parameters file format";
+  CHECK(header == kTVMMappedNDArrayListMagic) << "Invalid parameters file format";
+  CHECK(strm.Read(&alignment)) << "Invalid parameters file format";
+  std::vector<std::string> names;
+  CHECK(strm.Read(&names)) << "Invalid parameters file format";
+  uint64_t sz;
+  CHECK(strm.Read(&sz)) << "Invalid parameters file format";
+  size_t size = static_cast<size_t>(sz);
+  CHECK(size == names.size()) << "Invalid parameters file format";
+
+  bool rebind = false;
+  for (size_t i = 0; i < size; ++i) {
+    DLDataType dtype;
+    int ndim;
+    CHECK(strm.Read(&dtype)) << "Invalid parameters file format";
+    CHECK(strm.Read(&ndim)) << "Invalid parameters file format";
+    std::vector<int64_t> shape(ndim);
+    if (ndim != 0) {
+      CHECK(strm.ReadArray(&shape[0], ndim)) << "Invalid parameters file format";
+    }
+    uint64_t offset, nbytes;
+    CHECK(strm.Read(&offset)) << "Invalid parameters file format";
+    CHECK(strm.Read(&nbytes)) << "Invalid parameters file format";
+    CHECK_LE(offset + nbytes, file->size()) << "Invalid parameters file format";
+
+    int in_idx = GetInputIndex(names[i]);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    CHECK_LT(eid, data_entry_.size());
+    const NDArray& entry = data_entry_[eid];
+    CHECK_EQ(entry->ndim, ndim) << "Shape mismatch for param " << names[i];
+    for (int j = 0; j < ndim; ++j) {
+      CHECK_EQ(entry->shape[j], shape[j]) << "Shape mismatch for param " << names[i];
+    }
+    CHECK(TypeEqual(entry->dtype, dtype)) << "Type mismatch for param " << names[i];
+
+    NDArray view = MappedView(file, offset, dtype, shape);
+    if (entry->ctx.device_type == kDLCPU && offset % kAllocAlignment == 0) {
+      pending_params_.erase(eid);
+      data_entry_[eid] = view;
+      data_alignment_[eid] = details::GetDataAlignment(*view.operator->());
+      // Track the view as a shared param: the storage only used by params is released,
+      // and a write gets a private copy instead of touching the mapping.
+      shared_params_.insert(eid);
+      this->ReleaseStorage(attrs_.storage_id[eid]);
+      rebind = true;
+      continue;
+    }
+    if (lazy_params_ || pending_params_.count(eid)) {
+      this->SetParam(eid, view);
+      continue;
+    }
+    this->Unshare(eid);
+    // Stream the payload to the device, dropping each copied chunk from memory.
+    DeviceAPI* api = DeviceAPI::Get(entry->ctx);
+    for (size_t done = 0; done < nbytes; done += kMappedParamsChunkBytes) {
+      size_t chunk = std::min(kMappedParamsChunkBytes, static_cast<size_t>(nbytes) - done);
+      api->CopyDataFromTo(view->data, done, entry->data, entry->byte_offset + done, chunk,
+                          view->ctx, entry->ctx, dtype, nullptr);
+      if (entry->ctx.device_type != kDLCPU) {
+        api->StreamSync(entry->ctx, nullptr);
+      }
+      file->Release(offset + done, chunk);
+    }
+  }
+  // Point the operator arguments at the zero-copy params.
+  if (rebind) this->SetupOpExecs();
+}
+
+void GraphRuntime::SetParam(uint32_t eid, const NDArray& source) {
+  this->Unshare(eid);
+  if (!lazy_params_) {
+    if (pending_params_.count(eid)) {
+      pending_params_[eid] = source;
+      this->MaterializeParam(eid);
+    } else {
+      data_entry_[eid].CopyFrom(source);
+    }
+    return;
+  }
+  pending_params_[eid] = source;
+  this->ReleaseStorage(attrs_.storage_id[eid]);
+}
+
+void GraphRuntime::ReleaseStorage(int storage_id) {
+  if (!storage_pool_[storage_id].defined()) return;
+  for (size_t i = 0; i < data_entry_.size(); ++i) {
+    if (attrs_.storage_id[i] == storage_id && pending_params_.count(i) == 0 &&
+        shared_params_.count(i) == 0) {
+      return;
+    }
+  }
+  // Shared params already point at the registry copy.
+  for (size_t i = 0; i < data_entry_.size(); ++i) {
+    if (attrs_.storage_id[i] == storage_id && pending_params_.count(i)) {
+      data_entry_[i] = details::Placeholder(data_entry_[i]);
+    }
+  }
+  storage_pool_[storage_id] = NDArray();
+}
+
+void GraphRuntime::SetInputShared(int index, const NDArray& source) {
+  CHECK_LT(static_cast<size_t>(index), input_nodes_.size());
+  uint32_t eid = this->entry_id(input_nodes_[index], 0);
+  const NDArray& entry = data_entry_[eid];
+  CHECK_EQ(entry->ndim, source->ndim) << "Shape mismatch for input " << index;
+  for (int j = 0; j < entry->ndim; ++j) {
+    CHECK_EQ(entry->shape[j], source->shape[j]) << "Shape mismatch for input " << index;
+  }
+  CHECK(TypeEqual(entry->dtype, source->dtype)) << "Type mismatch for input " << index;
+  NDArray shared = WeightRegistry::Global()->Acquire(source, entry->ctx);
+  CHECK_EQ(data_alignment_[eid], details::GetDataAlignment(*shared.operator->()));
+  pending_params_.erase(eid);
+  data_entry_[eid] = shared;
+  // Point the operator arguments at the shared storage.
+  for (DLTensor* t : input_dltensors_[eid]) {
+    t->data = shared->data;
+    t->byte_offset = shared->byte_offset;
+  }
+  shared_params_.insert(eid);
+  this->ReleaseStorage(attrs_.storage_id[eid]);
+}
+
+void GraphRuntime::Unshare(uint32_t eid) {
+  if (shared_params_.erase(eid) == 0) return;
+  const NDArray& entry = data_entry_[eid];
+  std::vector<int64_t> shape(entry->shape, entry->shape + entry->ndim);
+  NDArray copy = NDArray::Empty(shape, entry->dtype, entry->ctx);
+  copy.CopyFrom(entry);
+  data_entry_[eid] = copy;
+  for (DLTensor* t : input_dltensors_[eid]) {
+    t->data = copy->data;
+    t->byte_offset = 0;
+  }
+}
+
+void GraphRuntime::MaterializeParam(uint32_t eid) {
+  auto it = pending_params_.find(eid);
+  if (it == pending_params_.end()) return;
+  const NDArray& entry = data_entry_[eid];
+  if (entry->data == nullptr) {
+    std::vector<int64_t> shape(entry->shape, entry->shape + entry->ndim);
+    data_entry_[eid] = NDArray::Empty(shape, entry->dtype, entry->ctx);
+    // Point the operator arguments at the new storage.
+    for (DLTensor* t : input_dltensors_[eid]) {
+      t->data = data_entry_[eid]->data;
+    }
+  }
+  data_entry_[eid].CopyFrom(it->second);
+  pending_params_.erase(it);
+}
+
+void GraphRuntime::MaterializeInputs(uint32_t nid) {
+  for (const auto& e : nodes_[nid].inputs) {
+    this->MaterializeParam(this->entry_id(e));
+  }
+}
+
+void GraphRuntime::PrefetchParams(const std::vector<std::string>& names) {
+  if (names.empty()) {
+    while (!pending_params_.empty()) {
+      this->MaterializeParam(pending_params_.begin()->first);
+    }
+    return;
+  }
+  for (const std::string& name : names) {
+    int in_idx = GetInputIndex(name);
+    if (in_idx < 0) continue;
+    this->MaterializeParam(this->entry_id(input_nodes_[in_idx], 0));
   }
 }
 
 void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
+  CHECK(other.pending_params_.empty())
+      << "Cannot share params which are still deferred, prefetch them first";
   uint64_t header, reserved;
   CHECK(strm->Read(&header)) << "Invalid parameters file format";
   CHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
@@ -236,6 +976,7 @@ void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
     uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
     CHECK_LT(eid, data_entry_.size());
     CHECK_EQ(data_entry_[eid].use_count(), 1);
+    pending_params_.erase(eid);
     data_entry_[eid] = other.GetInput(GetInputIndex(names[i]));
     CHECK_GT(data_entry_[eid].use_count(), 1);
     const DLTensor* tmp = data_entry_[eid].operator->();
@@ -244,13 +985,9 @@ void GraphRuntime::ShareParams(const GraphRuntime& other, dmlc::Stream* strm) {
   this->SetupOpExecs();
 }
 
-void GraphRuntime::SetupStorage() {
-  // Grab saved optimization plan from graph.
-  std::vector<DLDataType> vtype;
-  for (const std::string& s_type : attrs_.dltype) {
-    vtype.push_back(tvm::runtime::String2DLDataType(s_type));
-  }
-
+std::vector<GraphRuntime::PoolEntry> GraphRuntime::PlanStorage() const {
+  CHECK(attrs_.entry_offset.empty() || attrs_.entry_offset.size() == attrs_.shape.size())
+      << "entry_offset should have one offset per entry";
   // Size and device type of each storage pool entry.
   std::vector<PoolEntry> pool_entry;
   // Find the maximum space size.
@@ -266,10 +1003,13 @@ void GraphRuntime::SetupStorage() {
       size *= static_cast<size_t>(sz);
     }
     CHECK_GE(storage_id, 0) << "Do not support runtime shape op";
-    DLDataType t = vtype[i];
+    DLDataType t = String2DLDataType(attrs_.dltype[i]);
     size_t bits = t.bits * t.lanes;
     CHECK(bits % 8U == 0U || bits == 1U);
     size_t bytes = ((bits + 7U) / 8U) * size;
+    if (!attrs_.entry_offset.empty()) {
+      bytes += static_cast<size_t>(attrs_.entry_offset[i]);
+    }
 
     uint32_t sid = static_cast<uint32_t>(storage_id);
     if (sid >= pool_entry.size()) {
@@ -281,18 +1021,41 @@ void GraphRuntime::SetupStorage() {
     pool_entry[sid].size = std::max(pool_entry[sid].size, bytes);
     pool_entry[sid].device_type = device_type;
   }
+  return pool_entry;
+}
+
+TVMContext GraphRuntime::PoolContext(const PoolEntry& entry) const {
+  // This for loop is very fast since there are usually only a couple of
+  // devices available on the same hardware.
+  const auto& cit = std::find_if(ctxs_.begin(), ctxs_.end(), [&entry](const TVMContext& c) {
+    return entry.device_type == static_cast<int>(c.device_type);
+  });
+  return cit == ctxs_.end() ? ctxs_[0] : *cit;
+}
+
+void GraphRuntime::SetupStorage(const std::vector<NDArray>& storage_pool) {
+  // Grab saved optimization plan from graph.
+  std::vector<DLDataType> vtype;
+  for (const std::string& s_type : attrs_.dltype) {
+    vtype.push_back(tvm::runtime::String2DLDataType(s_type));
+  }
+  std::vector<PoolEntry> pool_entry = this->PlanStorage();
 
-  // Allocate the space.
-  for (const auto& pit : pool_entry) {
+  // Allocate the space, or take it from the shared pool.
+  for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+    const PoolEntry& pit = pool_entry[sid];
+    if (sid < storage_pool.size() && storage_pool[sid].defined()) {
+      const NDArray& storage = storage_pool[sid];
+      CHECK_GE(GetDataSize(*storage.operator->()), pit.size)
+          << "The shared storage of storage id " << sid << " is too small";
+      CHECK_EQ(static_cast<int>(storage->ctx.device_type), pit.device_type)
+          << "The shared storage of storage id " << sid << " is on another device";
+      storage_pool_.push_back(storage);
+      continue;
+    }
     std::vector<int64_t> shape;
-    // This for loop is very fast since there are usually only a couple of
-    // devices available on the same hardware.
-    const auto& cit = std::find_if(ctxs_.begin(), ctxs_.end(), [&pit](const TVMContext& c) {
-      return pit.device_type == static_cast<int>(c.device_type);
-    });
-    TVMContext ctx = cit == ctxs_.end() ? ctxs_[0] : *cit;
     shape.push_back(static_cast<int64_t>(pit.size + 3) / 4);
-    storage_pool_.push_back(NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, ctx));
+    storage_pool_.push_back(NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, PoolContext(pit)));
   }
 
   // Assign the pooled entries. A unified memory pool is used to simplifiy
@@ -303,7 +1066,14 @@ void GraphRuntime::SetupStorage() {
   for (size_t i = 0; i < data_entry_.size(); ++i) {
     int storage_id = attrs_.storage_id[i];
     CHECK_LT(static_cast<size_t>(storage_id), storage_pool_.size());
-    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i]);
+    int64_t offset = attrs_.entry_offset.empty() ? 0 : attrs_.entry_offset[i];
+    if (offset != 0) {
+      // The entry is a slice of a concatenation, the kernels expect it at the data pointer.
+      const DLContext& ctx = storage_pool_[storage_id]->ctx;
+      CHECK(IsAddressableContext(ctx))
+          << "entry_offset is not supported on " << DeviceName(ctx.device_type);
+    }
+    data_entry_[i] = storage_pool_[storage_id].CreateView(attrs_.shape[i], vtype[i], offset);
     const DLTensor* tmp = data_entry_[i].operator->();
     data_alignment_[i] = details::GetDataAlignment(*tmp);
   }
@@ -311,6 +1081,9 @@ void GraphRuntime::SetupStorage() {
 
 void GraphRuntime::SetupOpExecs() {
   op_execs_.resize(this->GetNumOfNodes());
+  op_args_.assign(this->GetNumOfNodes(), nullptr);
+  // Drop the argument pointers of any previous setup, as they are about to be freed.
+  input_dltensors_.clear();
   input_dltensors_.resize(num_node_entries());
   std::unordered_set<uint32_t> input_node_eids;
   for (size_t i = 0; i < input_nodes_.size(); i++) {
@@ -335,6 +1108,7 @@ void GraphRuntime::SetupOpExecs() {
 
     std::shared_ptr<OpArgs> op_args = nullptr;
     std::tie(op_execs_[nid], op_args) = CreateTVMOp(inode.param, args, inode.inputs.size());
+    op_args_[nid] = op_args;
 
     for (size_t i = 0; i < inode.inputs.size(); i++) {
       uint32_t eid = this->entry_id(inode.inputs[i]);
@@ -376,7 +1150,7 @@ std::pair<std::function<void()>, std::shared_ptr<GraphRuntime::OpArgs> > GraphRu
     auto fexec = [arg_ptr]() {
       DLTensor* from = static_cast<DLTensor*>(arg_ptr->arg_values[0].v_handle);
       DLTensor* to = static_cast<DLTensor*>(arg_ptr->arg_values[1].v_handle);
-      TVM_CCALL(TVMArrayCopyFromTo(from, to, nullptr));
+      TVM_CCALL(TVMArrayCopyFromTo(from, to, arg_ptr->stream));
     };
     return {fexec, arg_ptr};
   }
@@ -386,6 +1160,19 @@ std::pair<std::function<void()>, std::shared_ptr<GraphRuntime::OpArgs> > GraphRu
   tvm::runtime::PackedFunc pf = module_.GetFunction(param.func_name, true);
   CHECK(pf != nullptr) << "no such function in module: " << param.func_name;
 
+  // Call the functions compiled in a library directly, as the arguments are set up once.
+  if (TVMBackendPackedCFunc faddr = module_.GetPackedCFunc(param.func_name, true)) {
+    auto fexec = [arg_ptr, faddr]() {
+      TVMValue ret_value;
+      int ret_type_code = kTVMNullptr;
+      int ret = (*faddr)(arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
+                         static_cast<int>(arg_ptr->arg_values.size()), &ret_value, &ret_type_code,
+                         nullptr);
+      CHECK_EQ(ret, 0) << TVMGetLastError();
+    };
+    return {fexec, arg_ptr};
+  }
+
   auto fexec = [arg_ptr, pf]() {
     TVMRetValue rv;
     TVMArgs targs(arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
@@ -433,6 +1220,7 @@ PackedFunc GraphRuntime::GetFunction(const std::string& name,
         in_idx = args[0];
       }
       if (in_idx >= 0) {
+        this->MaterializeParam(this->entry_id(input_nodes_[in_idx], 0));
         *rv = this->GetInput(in_idx);
       }
     });
@@ -444,10 +1232,51 @@ PackedFunc GraphRuntime::GetFunction(const std::string& name,
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumInputs(); });
   } else if (name == "run") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+  } else if (name == "run_async") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int64_t ticket = this->RunAsync();
+      // The completion handle, blocking until the run finished when called.
+      *rv = PackedFunc([sptr_to_self, this, ticket](TVMArgs args, TVMRetValue* rv) {
+        this->WaitAsync(ticket);
+      });
+    });
+  } else if (name == "get_num_staged_inputs") {
+    // The inputs uploaded aside for the next asynchronous run, for the tests.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int64_t>(this->staged_inputs_.size());
+    });
   } else if (name == "load_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       this->LoadParams(args[0].operator std::string());
     });
+  } else if (name == "load_params_from_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsFromFile(args[0].operator std::string());
+    });
+  } else if (name == "set_lazy_params") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetLazyParams(args[0]);
+    });
+  } else if (name == "prefetch_params") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::vector<std::string> names;
+      for (int i = 0; i < args.num_args; ++i) {
+        names.push_back(args[i].operator std::string());
+      }
+      this->PrefetchParams(names);
+    });
+  } else if (name == "set_overlap_copies") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetOverlapCopies(args[0]);
+    });
+  } else if (name == "set_pinned_staging") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetPinnedStaging(args[0]);
+    });
+  } else if (name == "set_num_streams") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetNumStreams(args[0]);
+    });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       const auto& module = args[0].operator Module();
@@ -456,6 +1285,10 @@ PackedFunc GraphRuntime::GetFunction(const std::string& name,
       dmlc::MemoryStringStream strm(const_cast<std::string*>(&param_blob));
       this->ShareParams(dynamic_cast<const GraphRuntime&>(*module.operator->()), &strm);
     });
+  } else if (name == "set_thread_pool_partition") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetThreadPoolPartition(args[0].operator std::string());
+    });
   } else {
     return PackedFunc();
   }
@@ -34,9 +34,12 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "../pinned_staging.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -49,6 +52,25 @@ namespace runtime {
 
 /*! \brief Magic number for NDArray list file  */
 constexpr uint64_t kTVMNDArrayListMagic = 0xF7E58D4F05049CB7;
+/*!
+ * \brief Magic number for the memory-mappable NDArray list file.
+ *
+ * The file starts with the magic, the payload alignment, the list of names and,
+ * for each tensor, its dtype, ndim, shape, payload offset and payload size. The
+ * payloads follow the header, each one aligned to the payload alignment.
+ */
+constexpr uint64_t kTVMMappedNDArrayListMagic = 0xF7E58D4F05049CB8;
+/*!
+ * \brief Magic number for the binary graph format.
+ *
+ * The layout is documented with the writer in relay/backend/graph_runtime_codegen.cc:
+ * fixed-width little endian counts followed by flat arrays, so loading needs no parsing.
+ */
+constexpr uint64_t kTVMGraphBinaryMagic = 0xF7E58D4F05049CB9;
+/*! \brief Version of the binary graph format understood by this runtime. */
+constexpr uint32_t kTVMGraphBinaryVersion = 1;
+/*! \brief Bytes copied at a time when streaming mapped params to a device. */
+constexpr size_t kMappedParamsChunkBytes = 64UL << 20;
 
 /*! \brief operator attributes about tvm op */
 struct TVMOpParam {
@@ -70,9 +92,37 @@ class TVM_DLL GraphRuntime : public ModuleNode {
     std::vector<TVMValue> arg_values;
     std::vector<int> arg_tcodes;
     std::vector<int64_t> shape_data;
+    /*! \brief The stream a __copy node copies on, nullptr for the default stream. */
+    TVMStreamHandle stream{nullptr};
+  };
+  /*! \brief The stream an operator is launched on. */
+  struct OpStream {
+    /*! \brief The device of the operator. */
+    TVMContext ctx;
+    /*! \brief The stream, nullptr for the default stream. */
+    TVMStreamHandle stream{nullptr};
+    /*! \brief The streams producing its inputs, which it must wait on. */
+    std::vector<TVMStreamHandle> waits;
+  };
+  /*! \brief The streams of a device used by RunAsync. */
+  struct AsyncStreams {
+    /*! \brief The device. */
+    TVMContext ctx;
+    /*! \brief The stream the graph is launched on. */
+    TVMStreamHandle compute{nullptr};
+    /*! \brief The stream inputs are uploaded on, overlapping with the previous run. */
+    TVMStreamHandle upload{nullptr};
+  };
+  /*! \brief A __copy node running on the copy stream of a device. */
+  struct CopyNode {
+    /*! \brief The node id. */
+    uint32_t nid;
+    /*! \brief The CUDA or ROCm device whose copy stream runs the copy. */
+    TVMContext ctx;
   };
 
  public:
+  ~GraphRuntime();
   /*!
    * \brief Get member function to front-end
    * \param name The name of the function.
@@ -86,6 +136,22 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    */
   const char* type_key() const final { return "GraphRuntime"; }
   void Run();
+  /*!
+   * \brief Launch the graph and return without waiting for it to finish.
+   *
+   * The graph runs on a stream of each CUDA and ROCm device, other devices finish their
+   * part before this returns. Once a run is launched, SetInput uploads the inputs
+   * of the next run on a separate stream into staging buffers, so the upload
+   * overlaps with the computation of the launched run.
+   *
+   * \return The ticket of the run, to pass to WaitAsync.
+   */
+  int64_t RunAsync();
+  /*!
+   * \brief Block until a run launched by RunAsync, and the runs before it, finished.
+   * \param ticket The ticket returned by RunAsync.
+   */
+  void WaitAsync(int64_t ticket);
 
   /*!
    * \brief Initialize the graph executor with graph and context.
@@ -94,10 +160,27 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    *  processor.
    * \param ctxs The context of the host and devices where graph nodes will be
    *  executed on.
+   * \param storage_pool The storage of each storage id, shared with executors which never
+   *  run concurrently with this one, see GrowStoragePool. The storage ids left undefined are
+   *  allocated by this executor. Empty to allocate all the storage.
    */
 
   void Init(const std::string& graph_json, tvm::runtime::Module module,
-            const std::vector<TVMContext>& ctxs);
+            const std::vector<TVMContext>& ctxs,
+            const std::vector<NDArray>& storage_pool = std::vector<NDArray>());
+
+  /*!
+   * \brief Grow a storage pool shared by several executors to fit a graph.
+   * \param graph_json The execution graph.
+   * \param ctxs The context of the host and devices where graph nodes will be
+   *  executed on.
+   * \param private_inputs The inputs whose storage is not shared, such as the params
+   *  bound with SetInputShared. The storage ids only used by them are left undefined.
+   * \param storage_pool The storage of each storage id, reallocated when too small.
+   */
+  static void GrowStoragePool(const std::string& graph_json, const std::vector<TVMContext>& ctxs,
+                              const std::unordered_set<std::string>& private_inputs,
+                              std::vector<NDArray>* storage_pool);
 
   /*!
    * \brief Get the input index given the name of input.
@@ -118,6 +201,17 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    * \param data_ref The input data that is referred.
    */
   void SetInputZeroCopy(int index, DLTensor* data_ref);
+  /*!
+   * \brief Set index-th input to a read-only weight shared with other runtimes.
+   *
+   * The device copy comes from the process-wide WeightRegistry, so every runtime
+   * setting the same source array on a device uses the same storage. Setting the
+   * input again later gives this runtime a private copy first.
+   *
+   * \param index The input index.
+   * \param source The host array of the weight.
+   */
+  void SetInputShared(int index, const NDArray& source);
   /*!
    * \brief Get the number of outputs
    *
@@ -160,6 +254,17 @@ class TVM_DLL GraphRuntime : public ModuleNode {
    * \param param_blob A binary blob of parameter.
    */
   void LoadParams(const std::string& param_blob);
+  /*!
+   * \brief Load parameters from a file.
+   *
+   * Files in the memory-mappable format are mapped rather than read: params on
+   * a CPU context become zero-copy views into the mapping, releasing the storage
+   * only used by params, and params on other devices are copied from it chunk by
+   * chunk. Other files are read and passed to LoadParams.
+   *
+   * \param path The path of the parameter file.
+   */
+  void LoadParamsFromFile(const std::string& path);
 
   /*!
    * \brief Share parameters from pre-existing GraphRuntime instance.
@@ -177,6 +282,64 @@ class TVM_DLL GraphRuntime : public ModuleNode {
 
   std::string GetNodeName(uint32_t nid) const { return nodes_[nid].name; }
 
+  /*!
+   * \brief Get the name of an input.
+   * \param index The input index.
+   * \return The name of the input node.
+   */
+  std::string GetInputName(int index) const { return nodes_[input_nodes_[index]].name; }
+
+  /*!
+   * \brief Run the graph on a named thread pool partition.
+   * \param name The name of the partition, empty to use the pool of the calling thread.
+   */
+  void SetThreadPoolPartition(const std::string& name) { thread_pool_partition_ = name; }
+
+  /*!
+   * \brief Defer uploading params until the first op that reads them runs.
+   *
+   * Params loaded while enabled keep only their host copy; the device storage
+   * they would occupy is released when no other node entry shares it.
+   *
+   * \param lazy Whether params loaded from now on are materialized on demand.
+   */
+  void SetLazyParams(bool lazy) { lazy_params_ = lazy; }
+  /*!
+   * \brief Materialize deferred params ahead of their first use.
+   * \param names The names of the params, empty to materialize all deferred params.
+   */
+  void PrefetchParams(const std::vector<std::string>& names);
+
+  /*!
+   * \brief Run independent branches of the graph concurrently on several streams.
+   *
+   * Operators on CUDA and ROCm devices are assigned to streams following the dependency
+   * structure of the graph, and cross-stream edges are synchronized with events.
+   *
+   * \param num_streams The number of streams per device, 1 for the default stream only.
+   */
+  void SetNumStreams(int num_streams);
+  /*!
+   * \brief Overlap the copies between the host and CUDA or ROCm devices with the compute.
+   *
+   * The __copy nodes inserted for heterogeneous execution are issued on a copy
+   * stream of the device, as early as their producer and the previous users of
+   * their output allow, and only the first nodes depending on them wait for them.
+   *
+   * \param overlap Whether to overlap the copies.
+   */
+  void SetOverlapCopies(bool overlap);
+  /*!
+   * \brief Stage the inputs set from pageable host memory, and the outputs copied
+   *  to it, through reusable pinned host buffers.
+   *
+   * The copies to and from GPU devices then run at the full DMA bandwidth, and the
+   * uploads of RunAsync are queued without waiting for the previous inputs.
+   *
+   * \param enable Whether to stage the copies.
+   */
+  void SetPinnedStaging(bool enable);
+
  protected:
   // Memory pool entry.
   struct PoolEntry {
@@ -270,6 +433,8 @@ class TVM_DLL GraphRuntime : public ModuleNode {
     size_t storage_num_not_alloctaed{0};
     std::vector<int> storage_id;
     std::vector<int> device_index;
+    // The byte offset of each entry in its storage, empty when all are 0.
+    std::vector<int> entry_offset;
     std::vector<std::string> dltype;
     std::vector<std::vector<int64_t>> shape;
     // The graph attribute fields.
@@ -313,6 +478,14 @@ class TVM_DLL GraphRuntime : public ModuleNode {
           CHECK(reader->NextArrayItem());
           reader->Read(&device_index);
           CHECK(!reader->NextArrayItem());
+        } else if (key == "entry_offset") {
+          reader->BeginArray();
+          CHECK(reader->NextArrayItem());
+          reader->Read(&type);
+          CHECK_EQ(type, "list_int");
+          CHECK(reader->NextArrayItem());
+          reader->Read(&entry_offset);
+          CHECK(!reader->NextArrayItem());
         } else {
           reader->BeginArray();
           CHECK(reader->NextArrayItem());
@@ -363,10 +536,86 @@ class TVM_DLL GraphRuntime : public ModuleNode {
     }
     CHECK_EQ(bitmask, 1 | 2 | 4 | 8 | 16) << "invalid format";
   }
-  /*! \brief Setup the temporal storage */
-  void SetupStorage();
+  /*!
+   * \brief Load a graph serialized in the binary graph format.
+   * \param strm The input stream, positioned after the magic number.
+   */
+  void LoadBinary(dmlc::Stream* strm);
+  /*! \brief Load the execution graph, in the JSON or the binary format. */
+  void LoadGraph(const std::string& graph_json);
+  /*! \return The size and device type of each storage id. */
+  std::vector<PoolEntry> PlanStorage() const;
+  /*! \return The context a storage pool entry is allocated on. */
+  TVMContext PoolContext(const PoolEntry& entry) const;
+  /*!
+   * \brief Setup the temporal storage.
+   * \param storage_pool The storage shared for each pool entry, allocated when undefined.
+   */
+  void SetupStorage(const std::vector<NDArray>& storage_pool);
   /*! \brief Setup the executors. */
   void SetupOpExecs();
+  /*!
+   * \brief Set the value of a param, deferring the upload in lazy mode.
+   * \param eid The entry id of the param.
+   * \param source The host copy of the param.
+   */
+  void SetParam(uint32_t eid, const NDArray& source);
+  /*!
+   * \brief Upload a deferred param, allocating its storage if it was released.
+   * \param eid The entry id of the param.
+   */
+  void MaterializeParam(uint32_t eid);
+  /*!
+   * \brief Materialize the deferred params read by a node.
+   * \param nid The node id.
+   */
+  void MaterializeInputs(uint32_t nid);
+  /*!
+   * \brief Release a storage once every entry placed in it is a deferred or shared param.
+   * \param storage_id The storage id.
+   */
+  void ReleaseStorage(int storage_id);
+  /*!
+   * \brief Give a shared param a private copy before it is written.
+   * \param eid The entry id of the param.
+   */
+  void Unshare(uint32_t eid);
+  /*! \brief Assign operators to streams according to num_streams_. */
+  void SetupStreams();
+  /*! \brief Release the streams created by SetupStreams. */
+  void FreeStreams();
+  /*!
+   * \brief Launch the operators, on the async streams when async is set.
+   * \param async Whether the launch is made by RunAsync.
+   */
+  void Launch(bool async);
+  /*! \brief Create the streams used by RunAsync on every CUDA and ROCm device. */
+  void SetupAsyncStreams();
+  /*! \brief Release the streams created by SetupAsyncStreams. */
+  void FreeAsyncStreams();
+  /*!
+   * \brief Get the async streams of a device.
+   * \param ctx The device.
+   * \return The streams, nullptr when the device does not run asynchronously.
+   */
+  const AsyncStreams* GetAsyncStreams(TVMContext ctx) const;
+  /*!
+   * \brief Get the stream of a device operators are launched on.
+   * \param ctx The device.
+   * \param async Whether the launch is made by RunAsync.
+   * \return The stream, nullptr for the default stream.
+   */
+  TVMStreamHandle BaseStream(TVMContext ctx, bool async) const;
+  /*! \brief Schedule the __copy nodes on the copy streams, see SetOverlapCopies. */
+  void SetupCopies();
+  /*! \brief Release the copy streams and drop the copy schedule. */
+  void FreeCopies();
+  /*!
+   * \brief Issue the copies scheduled before a node, then wait for the copies it depends on.
+   * \param nid The node id.
+   * \param async Whether the launch is made by RunAsync.
+   */
+  void IssueCopies(uint32_t nid, bool async);
   /*!
    * \brief Create an execution function given input.
    * \param attrs The node attributes.
@@ -408,6 +657,44 @@ class TVM_DLL GraphRuntime : public ModuleNode {
   std::vector<size_t> data_alignment_;
   /*! \brief Operator on each node. */
   std::vector<std::function<void()>> op_execs_;
+  /*! \brief The arguments of the operator on each node. */
+  std::vector<std::shared_ptr<OpArgs>> op_args_;
+  /*! \brief The thread pool partition the graph runs on. */
+  std::string thread_pool_partition_;
+  /*! \brief Whether params are materialized on demand. */
+  bool lazy_params_{false};
+  /*! \brief The host copy of each param not yet uploaded, by entry id. */
+  std::unordered_map<uint32_t, NDArray> pending_params_;
+  /*! \brief The entries of the params shared through the WeightRegistry or mapped from a file. */
+  std::unordered_set<uint32_t> shared_params_;
+  /*! \brief The number of streams per device. */
+  int num_streams_{1};
+  /*! \brief The stream of each node, empty when running on the default stream. */
+  std::vector<OpStream> op_streams_;
+  /*! \brief The streams created for all devices. */
+  std::vector<std::pair<TVMContext, TVMStreamHandle>> streams_;
+  /*! \brief The streams used by RunAsync, empty until the first asynchronous run. */
+  std::vector<AsyncStreams> async_streams_;
+  /*! \brief The staging buffer of each input uploaded asynchronously, by entry id. */
+  std::unordered_map<uint32_t, NDArray> input_staging_;
+  /*! \brief The entries of the inputs staged since the last asynchronous run. */
+  std::vector<uint32_t> staged_inputs_;
+  /*! \brief The pinned buffers of the inputs and outputs, null when not staging. */
+  std::unique_ptr<PinnedStaging> pinned_staging_;
+  /*! \brief Whether the copies between the host and GPU devices overlap with the compute. */
+  bool overlap_copies_{false};
+  /*! \brief The copy stream of each GPU device with overlapped copies. */
+  std::vector<std::pair<TVMContext, TVMStreamHandle>> copy_streams_;
+  /*! \brief The copies issued before each node, empty until the copies are scheduled. */
+  std::vector<std::vector<CopyNode>> copy_issue_;
+  /*! \brief The copies each node waits for before it runs. */
+  std::vector<std::vector<CopyNode>> copy_waits_;
+  /*! \brief Whether a node is a copy issued by IssueCopies. */
+  std::vector<bool> overlapped_copy_;
+  /*! \brief The number of runs launched by RunAsync. */
+  int64_t async_launched_{0};
+  /*! \brief The number of asynchronous runs known to have finished. */
+  int64_t async_finished_{0};
 };
 
 std::vector<TVMContext> GetAllContext(const TVMArgs& args);
@@ -31,6 +31,8 @@
 #include <iterator>
 #include <vector>
 
+#include "../params_section.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -64,6 +66,10 @@ PackedFunc GraphRuntimeFactory::GetFunction(
       }
       *rv = this->DebugRuntimeCreate(contexts);
     });
+  } else if (name == "set_share_params") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetShareParams(args[0]);
+    });
   } else if (name == "remove_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::unordered_map<std::string, tvm::runtime::NDArray> empty_params{};
@@ -148,6 +154,11 @@ Module GraphRuntimeFactoryModuleLoadBinary(void* strm) {
   }
   CHECK(stream->Read(&module_name));
   auto exec = make_object<GraphRuntimeFactory>(graph_json, params, module_name);
+  // The params viewing the params section of the library are used in place
+  // by the CPU runtimes, and uploaded once for the others.
+  if (ParamsSectionReader::Current() != nullptr) {
+    exec->SetShareParams(true);
+  }
   return Module(exec);
 }
 
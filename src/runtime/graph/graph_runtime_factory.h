@@ -89,6 +89,12 @@ class TVM_DLL GraphRuntimeFactory : public runtime::ModuleNode {
    */
   Module DebugRuntimeCreate(const std::vector<TVMContext>& ctxs);
 
+  /*!
+   * \brief Set whether the runtimes created share their params through the WeightRegistry.
+   * \param share Whether to share the params.
+   */
+  void SetShareParams(bool share) { share_params_ = share; }
+
   /*!
    * \brief Set params.
    * \param graph_runtime The graph runtime we want to set the params into.
@@ -110,7 +116,10 @@ class TVM_DLL GraphRuntimeFactory : public runtime::ModuleNode {
               });
     for (const auto& key : keys) {
       int in_idx = graph_runtime->GetInputIndex(key);
-      if (in_idx >= 0) {
+      if (in_idx < 0) continue;
+      if (share_params_) {
+        graph_runtime->SetInputShared(in_idx, value[key]);
+      } else {
         graph_runtime->SetInput(in_idx, const_cast<DLTensor*>(value[key].operator->()));
       }
     }
@@ -123,6 +132,8 @@ class TVM_DLL GraphRuntimeFactory : public runtime::ModuleNode {
   std::unordered_map<std::string, tvm::runtime::NDArray> params_;
   /*! \brief module name */
   std::string module_name_;
+  /*! \brief Whether the runtimes created share their params through the WeightRegistry. */
+  bool share_params_{false};
 };
 
 }  // namespace runtime
@@ -0,0 +1,330 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_shape_graph_runtime.cc
+ * \brief A graph runtime specialized for several input shapes, on one storage pool.
+ */
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./graph_runtime.h"
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The params of a specialization, by name. */
+using ParamMap = std::unordered_map<std::string, NDArray>;
+
+/*!
+ * \brief Runs the graph specialized for the shapes of the inputs of each run.
+ *
+ *  The specializations are graph runtimes of the same model built for different
+ *  input shapes. They share the device copy of their params, through the
+ *  WeightRegistry, and one storage pool sized for the largest of their plans, so
+ *  only one of them holds valid intermediate values at a time: the outputs of a
+ *  run are valid until a run of another specialization.
+ */
+class MultiShapeGraphRuntime : public ModuleNode {
+ public:
+  /*!
+   * \brief Create the specializations.
+   * \param graph_jsons The graph of each specialization.
+   * \param params The params of each specialization.
+   * \param module The module containing the compiled functions of all the graphs.
+   * \param ctxs The context of the host and devices where graph nodes will be executed on.
+   */
+  void Init(const std::vector<std::string>& graph_jsons, const std::vector<ParamMap>& params,
+            Module module, const std::vector<TVMContext>& ctxs) {
+    CHECK_EQ(graph_jsons.size(), params.size());
+    for (size_t i = 0; i < graph_jsons.size(); ++i) {
+      std::unordered_set<std::string> param_names;
+      for (const auto& kv : params[i]) {
+        param_names.insert(kv.first);
+      }
+      GraphRuntime::GrowStoragePool(graph_jsons[i], ctxs, param_names, &storage_pool_);
+    }
+    for (size_t i = 0; i < graph_jsons.size(); ++i) {
+      auto exec = make_object<GraphRuntime>();
+      exec->Init(graph_jsons[i], module, ctxs, storage_pool_);
+      for (const auto& kv : params[i]) {
+        int index = exec->GetInputIndex(kv.first);
+        if (index >= 0) exec->SetInputShared(index, kv.second);
+      }
+      // The shapes of the other inputs select the specialization.
+      std::unordered_map<std::string, std::vector<int64_t>> shapes;
+      for (int index = 0; index < exec->NumInputs(); ++index) {
+        NDArray input = exec->GetInput(index);
+        std::string name = exec->GetInputName(index);
+        if (params[i].count(name)) continue;
+        shapes[name] = std::vector<int64_t>(input->shape, input->shape + input->ndim);
+      }
+      specializations_.push_back({exec, std::move(shapes)});
+    }
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "set_input") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        NDArray data;
+        if (args[1].type_code() == kTVMNDArrayHandle) {
+          data = args[1];
+        } else {
+          DLTensor* tensor = args[1];
+          std::vector<int64_t> shape(tensor->shape, tensor->shape + tensor->ndim);
+          data = NDArray::Empty(shape, tensor->dtype, tensor->ctx);
+          data.CopyFrom(tensor);
+        }
+        this->SetInput(args[0], data);
+      });
+    } else if (name == "run") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+    } else if (name == "get_output") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        CHECK_GE(active_, 0) << "Run the graph before getting its outputs";
+        *rv = specializations_[active_].exec->GetOutput(args[0]);
+      });
+    } else if (name == "get_num_outputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = specializations_[0].exec->NumOutputs();
+      });
+    } else if (name == "get_num_specializations") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(specializations_.size());
+      });
+    } else if (name == "get_active_specialization") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = active_; });
+    } else if (name == "get_storage_bytes") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        int64_t bytes = 0;
+        for (const NDArray& storage : storage_pool_) {
+          if (storage.defined()) bytes += GetDataSize(*storage.operator->());
+        }
+        *rv = bytes;
+      });
+    }
+    return PackedFunc();
+  }
+
+  const char* type_key() const final { return "MultiShapeGraphRuntime"; }
+
+  /*!
+   * \brief Set an input of the next runs, it is copied into the specialization at run time.
+   * \param name The name of the input.
+   * \param data The input data.
+   */
+  void SetInput(const std::string& name, const NDArray& data) {
+    inputs_[name] = data;
+    dirty_.insert(name);
+  }
+
+  /*! \brief Run the specialization matching the shapes of the inputs. */
+  void Run() {
+    int selected = -1;
+    for (size_t i = 0; i < specializations_.size() && selected < 0; ++i) {
+      if (this->Matches(specializations_[i])) selected = static_cast<int>(i);
+    }
+    CHECK_GE(selected, 0) << "No specialization matches the shapes of the inputs";
+    GraphRuntime* exec = specializations_[selected].exec.get();
+    // Another specialization may have overwritten the inputs in the shared storage.
+    for (const auto& kv : inputs_) {
+      if (selected != active_ || dirty_.count(kv.first)) {
+        DLTensor* data = const_cast<DLTensor*>(kv.second.operator->());
+        exec->SetInput(exec->GetInputIndex(kv.first), data);
+      }
+    }
+    dirty_.clear();
+    active_ = selected;
+    exec->Run();
+  }
+
+ private:
+  /*! \brief A graph runtime specialized for some input shapes. */
+  struct Specialization {
+    ObjectPtr<GraphRuntime> exec;
+    /*! \brief The shape of each input which is not a param. */
+    std::unordered_map<std::string, std::vector<int64_t>> input_shapes;
+  };
+
+  /*! \return Whether the inputs set are exactly the inputs of the specialization. */
+  bool Matches(const Specialization& spec) const {
+    if (spec.input_shapes.size() != inputs_.size()) return false;
+    for (const auto& kv : inputs_) {
+      auto it = spec.input_shapes.find(kv.first);
+      if (it == spec.input_shapes.end()) return false;
+      const NDArray& data = kv.second;
+      if (it->second != std::vector<int64_t>(data->shape, data->shape + data->ndim)) return false;
+    }
+    return true;
+  }
+
+  std::vector<Specialization> specializations_;
+  /*! \brief The storage shared by the specializations. */
+  std::vector<NDArray> storage_pool_;
+  /*! \brief The inputs of the next runs. */
+  std::unordered_map<std::string, NDArray> inputs_;
+  /*! \brief The inputs set since the last run. */
+  std::unordered_set<std::string> dirty_;
+  /*! \brief The specialization of the last run, -1 before the first run. */
+  int active_{-1};
+};
+
+/*!
+ * \brief Factory of the multi-shape graph runtime, the module exported by
+ *  relay.build_multi_shape.
+ */
+class MultiShapeGraphRuntimeFactory : public ModuleNode {
+ public:
+  MultiShapeGraphRuntimeFactory(std::vector<std::string> graph_jsons, std::vector<ParamMap> params,
+                                std::string module_name)
+      : graph_jsons_(std::move(graph_jsons)),
+        params_(std::move(params)),
+        module_name_(std::move(module_name)) {}
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == module_name_) {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<TVMContext> contexts;
+        for (int i = 0; i < args.num_args; ++i) {
+          contexts.emplace_back(args[i].operator TVMContext());
+        }
+        auto exec = make_object<MultiShapeGraphRuntime>();
+        exec->Init(graph_jsons_, params_, this->imports_[0], contexts);
+        *rv = Module(exec);
+      });
+    } else if (name == "get_num_specializations") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(graph_jsons_.size());
+      });
+    } else if (name == "get_graph_json") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        int index = args[0];
+        CHECK_LT(static_cast<size_t>(index), graph_jsons_.size());
+        *rv = graph_jsons_[index];
+      });
+    }
+    return PackedFunc();
+  }
+
+  const char* type_key() const final { return "MultiShapeGraphRuntimeFactory"; }
+
+  /*!
+   * \brief Save the graphs and the params, the params shared by several
+   *  specializations are saved once.
+   * \param stream The binary stream to save to.
+   */
+  void SaveToBinary(dmlc::Stream* stream) final {
+    stream->Write(graph_jsons_);
+    std::vector<NDArray> arrays;
+    std::unordered_map<const Object*, uint64_t> array_index;
+    std::vector<std::vector<std::string>> names(params_.size());
+    std::vector<std::vector<uint64_t>> indices(params_.size());
+    for (size_t i = 0; i < params_.size(); ++i) {
+      for (const auto& kv : params_[i]) {
+        auto it = array_index.emplace(kv.second.get(), arrays.size()).first;
+        if (it->second == arrays.size()) arrays.push_back(kv.second);
+        names[i].push_back(kv.first);
+        indices[i].push_back(it->second);
+      }
+    }
+    uint64_t num_arrays = arrays.size();
+    stream->Write(num_arrays);
+    for (const NDArray& array : arrays) {
+      SaveDLTensor(stream, array.operator->());
+    }
+    for (size_t i = 0; i < params_.size(); ++i) {
+      stream->Write(names[i]);
+      stream->Write(indices[i]);
+    }
+    stream->Write(module_name_);
+  }
+
+ private:
+  std::vector<std::string> graph_jsons_;
+  std::vector<ParamMap> params_;
+  std::string module_name_;
+};
+
+Module MultiShapeGraphRuntimeFactoryLoadBinary(void* strm) {
+  dmlc::Stream* stream = static_cast<dmlc::Stream*>(strm);
+  std::vector<std::string> graph_jsons;
+  CHECK(stream->Read(&graph_jsons));
+  uint64_t num_arrays;
+  CHECK(stream->Read(&num_arrays));
+  std::vector<NDArray> arrays(num_arrays);
+  for (NDArray& array : arrays) {
+    array.Load(stream);
+  }
+  std::vector<ParamMap> params(graph_jsons.size());
+  for (ParamMap& param : params) {
+    std::vector<std::string> names;
+    std::vector<uint64_t> indices;
+    CHECK(stream->Read(&names));
+    CHECK(stream->Read(&indices));
+    CHECK_EQ(names.size(), indices.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+      CHECK_LT(indices[i], arrays.size());
+      param[names[i]] = arrays[indices[i]];
+    }
+  }
+  std::string module_name;
+  CHECK(stream->Read(&module_name));
+  auto exec = make_object<MultiShapeGraphRuntimeFactory>(graph_jsons, params, module_name);
+  return Module(exec);
+}
+
+TVM_REGISTER_GLOBAL("tvm.multi_shape_graph_runtime_factory.create")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      // The argument order is module_name, module, the number of graphs, the graphs, and
+      // for each graph its number of params followed by the name and value of each param.
+      std::string module_name = args[0];
+      int num_graphs = args[2];
+      CHECK_GT(num_graphs, 0) << "A multi-shape graph runtime needs at least one graph";
+      int pos = 3;
+      std::vector<std::string> graph_jsons;
+      for (int i = 0; i < num_graphs; ++i) {
+        graph_jsons.push_back(args[pos++].operator std::string());
+      }
+      std::vector<ParamMap> params(num_graphs);
+      for (ParamMap& param : params) {
+        int num_params = args[pos++];
+        for (int i = 0; i < num_params; ++i, pos += 2) {
+          param[args[pos].operator std::string()] = args[pos + 1].operator NDArray();
+        }
+      }
+      CHECK_EQ(pos, args.num_args);
+      auto exec = make_object<MultiShapeGraphRuntimeFactory>(graph_jsons, params, module_name);
+      exec->Import(args[1]);
+      *rv = Module(exec);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.module.loadbinary_MultiShapeGraphRuntimeFactory")
+    .set_body_typed(MultiShapeGraphRuntimeFactoryLoadBinary);
+
+}  // namespace runtime
+}  // namespace tvm
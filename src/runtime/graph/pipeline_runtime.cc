@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pipeline_runtime.cc
+ * \brief Pipeline-parallel execution of a graph partitioned into stages.
+ */
+#include <dmlc/json.h>
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Runs the stages of a partitioned graph on their own threads, so that each
+ *  stage works on a different micro-batch at the same time.
+ *
+ *  Each stage is a graph runtime module. Its inputs are bound either to the inputs
+ *  of the pipeline or to the outputs of an earlier stage, which are copied to the
+ *  context of the consuming stage.
+ */
+class PipelineRuntime : public ModuleNode {
+ public:
+  /*! \brief The source of a stage input: stage -1 is the pipeline input `index`. */
+  struct Binding {
+    std::string name;
+    int stage;
+    int index;
+  };
+
+  /*! \brief A micro-batch flowing through the stages. */
+  struct Packet {
+    /*! \brief The inputs of the pipeline. */
+    std::vector<NDArray> inputs;
+    /*! \brief The outputs of each stage which already ran. */
+    std::vector<std::vector<NDArray>> stage_outputs;
+    /*! \brief The error raised by a stage, empty on success. */
+    std::string error;
+  };
+
+  /*! \brief A bounded blocking queue of packets. */
+  class PacketQueue {
+   public:
+    explicit PacketQueue(size_t capacity) : capacity_(capacity) {}
+
+    /*! \return false if the queue was closed. */
+    bool Push(std::unique_ptr<Packet> packet) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+      if (closed_) return false;
+      queue_.push(std::move(packet));
+      not_empty_.notify_one();
+      return true;
+    }
+
+    /*! \return nullptr if the queue was closed. */
+    std::unique_ptr<Packet> Pop() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+      if (queue_.empty()) return nullptr;
+      std::unique_ptr<Packet> packet = std::move(queue_.front());
+      queue_.pop();
+      not_full_.notify_one();
+      return packet;
+    }
+
+    void Close() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      not_empty_.notify_all();
+      not_full_.notify_all();
+    }
+
+   private:
+    size_t capacity_;
+    bool closed_{false};
+    std::queue<std::unique_ptr<Packet>> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_, not_full_;
+  };
+
+  /*!
+   * \brief Create the pipeline.
+   * \param config The json config, e.g.
+   *  {"stages": [{"x": [-1, 0]}, {"y": [0, 0]}], "outputs": [[1, 0]], "num_inputs": 1,
+   *   "max_in_flight": 4}
+   *  maps the input x of stage 0 to pipeline input 0, the input y of stage 1 to output 0
+   *  of stage 0, and outputs output 0 of stage 1.
+   * \param stages The graph runtime module of each stage.
+   */
+  PipelineRuntime(const std::string& config, std::vector<Module> stages) {
+    std::vector<std::map<std::string, std::vector<int>>> stage_inputs;
+    std::vector<std::vector<int>> outputs;
+    int max_in_flight = 0;
+    std::istringstream is(config);
+    dmlc::JSONReader reader(&is);
+    std::string key;
+    reader.BeginObject();
+    while (reader.NextObjectItem(&key)) {
+      if (key == "stages") {
+        reader.Read(&stage_inputs);
+      } else if (key == "outputs") {
+        reader.Read(&outputs);
+      } else if (key == "num_inputs") {
+        reader.Read(&num_inputs_);
+      } else if (key == "max_in_flight") {
+        reader.Read(&max_in_flight);
+      } else {
+        LOG(FATAL) << "Unknown key in pipeline config: " << key;
+      }
+    }
+    CHECK_EQ(stage_inputs.size(), stages.size()) << "Config must bind the inputs of every stage";
+    for (size_t s = 0; s < stages.size(); ++s) {
+      Stage stage;
+      stage.run = stages[s].GetFunction("run");
+      stage.set_input = stages[s].GetFunction("set_input");
+      stage.set_input_zero_copy = stages[s].GetFunction("set_input_zero_copy");
+      stage.get_input = stages[s].GetFunction("get_input");
+      stage.get_output = stages[s].GetFunction("get_output");
+      stage.num_outputs = stages[s].GetFunction("get_num_outputs")();
+      CHECK(stage.run != nullptr) << "Stage " << s << " is not a graph runtime";
+      for (const auto& it : stage_inputs[s]) {
+        CHECK_EQ(it.second.size(), 2U) << "A binding is a pair [stage, index]";
+        Binding binding{it.first, it.second[0], it.second[1]};
+        CHECK_LT(binding.stage, static_cast<int>(s)) << "Stages can only read earlier stages";
+        if (binding.stage < 0) {
+          CHECK_LT(binding.index, num_inputs_) << "Invalid pipeline input " << binding.index;
+        } else {
+          CHECK_LT(binding.index, stage_[binding.stage].num_outputs)
+              << "Invalid output " << binding.index << " of stage " << binding.stage;
+        }
+        stage.bindings.push_back(binding);
+      }
+      stage.module = stages[s];
+      stage_.push_back(std::move(stage));
+    }
+    CHECK(!stage_.empty()) << "A pipeline needs at least one stage";
+    if (outputs.empty()) {
+      for (int i = 0; i < stage_.back().num_outputs; ++i) {
+        outputs.push_back({static_cast<int>(stage_.size()) - 1, i});
+      }
+    }
+    for (const auto& output : outputs) {
+      CHECK_EQ(output.size(), 2U) << "An output is a pair [stage, index]";
+      CHECK_LT(output[0], static_cast<int>(stage_.size()));
+      CHECK_LT(output[1], stage_[output[0]].num_outputs);
+      outputs_.emplace_back(output[0], output[1]);
+    }
+
+    // Every stage holds one micro-batch, the queues hold the remaining ones.
+    size_t capacity = std::max(1, max_in_flight - static_cast<int>(stage_.size()));
+    for (size_t s = 0; s <= stage_.size(); ++s) {
+      queues_.emplace_back(new PacketQueue(capacity));
+    }
+    for (size_t s = 0; s < stage_.size(); ++s) {
+      threads_.emplace_back([this, s]() { this->RunStage(s); });
+    }
+  }
+
+  ~PipelineRuntime() {
+    for (auto& queue : queues_) queue->Close();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  const char* type_key() const final { return "PipelineRuntime"; }
+
+  /*!
+   * \brief Push a micro-batch into the pipeline, blocking while it is full.
+   * \param inputs The pipeline inputs.
+   */
+  void Enqueue(std::vector<NDArray> inputs) {
+    CHECK_EQ(inputs.size(), static_cast<size_t>(num_inputs_));
+    std::unique_ptr<Packet> packet(new Packet());
+    packet->inputs = std::move(inputs);
+    ++num_pending_;
+    CHECK(queues_.front()->Push(std::move(packet))) << "The pipeline was shut down";
+  }
+
+  /*!
+   * \brief Wait for the oldest micro-batch in the pipeline to finish.
+   * \return The pipeline outputs of the micro-batch.
+   */
+  Array<NDArray> Dequeue() {
+    CHECK_GT(num_pending_, 0) << "No micro-batch was enqueued";
+    std::unique_ptr<Packet> packet = queues_.back()->Pop();
+    CHECK(packet != nullptr) << "The pipeline was shut down";
+    --num_pending_;
+    if (!packet->error.empty()) LOG(FATAL) << packet->error;
+    Array<NDArray> ret;
+    for (const auto& output : outputs_) {
+      ret.push_back(packet->stage_outputs[output.first][output.second]);
+    }
+    return ret;
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "enqueue") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<NDArray> inputs;
+        for (int i = 0; i < args.num_args; ++i) {
+          inputs.push_back(args[i].operator NDArray());
+        }
+        this->Enqueue(std::move(inputs));
+      });
+    } else if (name == "dequeue") {
+      return PackedFunc(
+          [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Dequeue(); });
+    } else if (name == "get_num_inputs") {
+      return PackedFunc(
+          [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = num_inputs_; });
+    } else if (name == "get_num_outputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(outputs_.size());
+      });
+    } else if (name == "get_num_stages") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(stage_.size());
+      });
+    }
+    return PackedFunc();
+  }
+
+ private:
+  /*! \brief A stage and the functions of its graph runtime. */
+  struct Stage {
+    Module module;
+    PackedFunc run, set_input, set_input_zero_copy, get_input, get_output;
+    int num_outputs;
+    std::vector<Binding> bindings;
+  };
+
+  /*! \brief The loop of the thread running stage s. */
+  void RunStage(size_t s) {
+    Stage& stage = stage_[s];
+    while (std::unique_ptr<Packet> packet = queues_[s]->Pop()) {
+      if (packet->error.empty()) {
+        try {
+          this->Execute(stage, packet.get());
+        } catch (const dmlc::Error& e) {
+          packet->error = "Stage " + std::to_string(s) + " failed: " + e.what();
+        }
+      }
+      if (!queues_[s + 1]->Push(std::move(packet))) return;
+    }
+  }
+
+  /*! \brief Run a stage on a micro-batch, appending its outputs to the packet. */
+  void Execute(const Stage& stage, Packet* packet) {
+    for (const Binding& binding : stage.bindings) {
+      NDArray source = binding.stage < 0 ? packet->inputs[binding.index]
+                                         : packet->stage_outputs[binding.stage][binding.index];
+      NDArray input = stage.get_input(binding.name);
+      if (source->ctx.device_type == input->ctx.device_type &&
+          source->ctx.device_id == input->ctx.device_id &&
+          reinterpret_cast<size_t>(source->data) % kAllocAlignment == 0) {
+        stage.set_input_zero_copy(binding.name, source);
+      } else {
+        stage.set_input(binding.name, source);
+      }
+    }
+    stage.run();
+    // The output buffers are reused by the next micro-batch, so copy them out.
+    std::vector<NDArray> outputs;
+    for (int i = 0; i < stage.num_outputs; ++i) {
+      NDArray output = stage.get_output(i);
+      std::vector<int64_t> shape(output->shape, output->shape + output->ndim);
+      NDArray copy = NDArray::Empty(shape, output->dtype, output->ctx);
+      copy.CopyFrom(output);
+      outputs.push_back(copy);
+    }
+    packet->stage_outputs.push_back(std::move(outputs));
+  }
+
+  std::vector<Stage> stage_;
+  std::vector<std::pair<int, int>> outputs_;
+  int num_inputs_{0};
+  int num_pending_{0};
+  /*! \brief queues_[s] feeds stage s, the last queue holds finished micro-batches. */
+  std::vector<std::unique_ptr<PacketQueue>> queues_;
+  std::vector<std::thread> threads_;
+};
+
+TVM_REGISTER_GLOBAL("tvm.pipeline_runtime.create").set_body([](TVMArgs args, TVMRetValue* rv) {
+  CHECK_GE(args.num_args, 2) << "The expected arguments are the config and the stage modules";
+  std::vector<Module> stages;
+  for (int i = 1; i < args.num_args; ++i) {
+    stages.push_back(args[i].operator Module());
+  }
+  *rv = Module(make_object<PipelineRuntime>(args[0].operator std::string(), stages));
+});
+
+}  // namespace runtime
+}  // namespace tvm
@@ -66,6 +66,8 @@ inline void* HexagonDeviceAPI::AllocDataSpace(TVMContext ctx, size_t nbytes, siz
 
 inline void HexagonDeviceAPI::FreeDataSpace(TVMContext ctx, void* ptr) {
   CHECK(hexagon::Device::ValidateDeviceId(ctx.device_id));
+  // a queued call may still use the memory.
+  hexagon::CallQueue::Global()->Flush();
   hexagon::Device::Global()->Free(ptr);
 }
 
@@ -75,6 +77,8 @@ inline void HexagonDeviceAPI::CopyDataFromTo(const void* from, size_t from_offse
                                              DLDataType type_hint, TVMStreamHandle stream) {
   const char* src = static_cast<const char*>(from) + from_offset;
   char* dst = static_cast<char*>(to) + to_offset;
+  // The host accesses the device memory directly, complete the queued calls first.
+  hexagon::CallQueue::Global()->Flush();
 
   auto Is32bit = [](const void* p) {
     return p == reinterpret_cast<const void*>(uint32_t(uintptr_t(p)));
@@ -106,7 +110,9 @@ inline void HexagonDeviceAPI::CopyDataFromTo(const void* from, size_t from_offse
   }
 }
 
-inline void HexagonDeviceAPI::StreamSync(TVMContext ctx, TVMStreamHandle stream) {}
+inline void HexagonDeviceAPI::StreamSync(TVMContext ctx, TVMStreamHandle stream) {
+  hexagon::CallQueue::Global()->Flush();
+}
 
 inline void* HexagonDeviceAPI::AllocWorkspace(TVMContext ctx, size_t nbytes, DLDataType type_hint) {
   CHECK(hexagon::Device::ValidateDeviceId(ctx.device_id));
@@ -126,6 +132,11 @@ TVM_REGISTER_GLOBAL("device_api.hexagon").set_body([](TVMArgs args, TVMRetValue*
   DeviceAPI* ptr = HexagonDeviceAPI::Global();
   *rv = ptr;
 });
+
+TVM_REGISTER_GLOBAL("device_api.hexagon.set_batching").set_body([](TVMArgs args, TVMRetValue* rv) {
+  bool enable = args[0];
+  hexagon::CallQueue::Global()->SetBatching(enable);
+});
 }  // namespace runtime
 }  // namespace tvm
 
@@ -137,6 +148,7 @@ void* HexagonBackendAllocateVTCM(uint32_t nbytes, uint32_t align) {
   return tvm::runtime::hexagon::Device::Global()->AllocVtcm(nbytes, align);
 }
 void HexagonBackendFreeVTCM(void* ptr) {
+  tvm::runtime::hexagon::CallQueue::Global()->Flush();
   return tvm::runtime::hexagon::Device::Global()->FreeVtcm(ptr);
 }
 }
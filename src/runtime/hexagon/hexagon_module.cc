@@ -25,6 +25,7 @@
 #include <dmlc/logging.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -39,6 +40,19 @@ namespace runtime {
 
 hexagon::Device::~Device() {}
 
+void hexagon::Device::CallBatch(const std::vector<uint32_t>& calls) {
+  // Call takes non-const arrays.
+  std::vector<uint32_t> words(calls);
+  for (size_t k = 0; k + 3 <= words.size();) {
+    void* func = reinterpret_cast<void*>(static_cast<uintptr_t>(words[k]));
+    unsigned sc_num = words[k + 1];
+    unsigned st_num = words[k + 2];
+    uint32_t* scalar = words.data() + k + 3;
+    Call(func, scalar, sc_num, scalar + sc_num, st_num);
+    k += 3 + sc_num + st_num;
+  }
+}
+
 namespace hexagon {
 
 /*!
@@ -208,6 +222,8 @@ class HexagonModuleNode final : public runtime::ModuleNode {
 
   ~HexagonModuleNode() {
     if (dl_handle_) {
+      // The queued calls and their arguments refer to the module.
+      hexagon::CallQueue::Global()->Release();
       hexagon_device_->Unload(dl_handle_);
     }
   }
@@ -250,9 +266,8 @@ class HexagonModuleNode final : public runtime::ModuleNode {
   void CallRemotePackedCABI(void* func_ptr, const TVMArgs& args, TVMRetValue* rv) const;
   void CallRemoteDirect(void* func_ptr, const TVMArgs& args, TVMRetValue* rv) const;
   void RemapArgs(const TVMArgs& args,
-                 std::vector<TVMValue>& values,              // NOLINT(*)
-                 std::vector<int>& type_codes,               // NOLINT(*)
-                 std::vector<void*>& remote_tensors) const;  // NOLINT(*)
+                 std::vector<TVMValue>& values,       // NOLINT(*)
+                 std::vector<int>& type_codes) const;  // NOLINT(*)
   void* CreateRemoteTensor(const DLTensor* T) const;
   hexagon::ArgLayout BuildArgLayout(const TVMArgs& Aa) const;
 
@@ -270,12 +285,15 @@ class HexagonModuleNode final : public runtime::ModuleNode {
 
 void HexagonModuleNode::CallRemotePackedCABI(void* func_ptr, const TVMArgs& args,
                                              TVMRetValue* rv) const {
+  // The remote arguments live until the call completes, possibly in a later batch.
+  hexagon::CallQueue* queue = hexagon::CallQueue::Global();
+  auto lock = queue->Lock();
+
   // Remap all arguments, creating remote DLTensors.
   std::vector<TVMValue> values;
   std::vector<int> codes;
-  std::vector<void*> remote_tensors;
 
-  RemapArgs(args, values, codes, remote_tensors);
+  RemapArgs(args, values, codes);
   // The prototype of packed C function is
   //   int (TVMValue* args, int* type_codes, int num_args,
   //        TVMValue* ret_value, int* ret_code)
@@ -290,8 +308,7 @@ void HexagonModuleNode::CallRemotePackedCABI(void* func_ptr, const TVMArgs& args
   int num_args = args.size();
   int values_size = num_args * sizeof(TVMValue);
   int codes_size = num_args * sizeof(int);
-  void* remote =
-      hexagon_device_->Alloc(values_size + sizeof(TVMValue) + codes_size + sizeof(int), 8);
+  void* remote = queue->AllocArgs(values_size + sizeof(TVMValue) + codes_size + sizeof(int));
 
   // Copy all argument TVMValues to the remote space.
   void* remote_values = remote;
@@ -313,20 +330,18 @@ void HexagonModuleNode::CallRemotePackedCABI(void* func_ptr, const TVMArgs& args
                        kTVMOpaqueHandle};
   TVMArgs temp_args(temp_values, temp_codes, 5);
   hexagon::ArgLayout as = BuildArgLayout(temp_args);
-  hexagon_device_->Call(func_ptr, as.Scalar.data(), as.Scalar.size(), as.Stack.data(),
-                        as.Stack.size());
+  queue->Call(func_ptr, as.Scalar, as.Stack);
 
   // TODO(kparzysz-quic): copy return value back
-  std::for_each(remote_tensors.begin(), remote_tensors.end(),
-                [this](void* t) { hexagon_device_->Free(t); });
-  hexagon_device_->Free(remote);
 }
 
 void HexagonModuleNode::CallRemoteDirect(void* func_ptr, const TVMArgs& args,
                                          TVMRetValue* rv) const {
   hexagon::ArgLayout as = BuildArgLayout(args);
-  hexagon_device_->Call(func_ptr, as.Scalar.data(), as.Scalar.size(), as.Stack.data(),
-                        as.Stack.size());
+  // Keep the order with the queued calls.
+  hexagon::CallQueue* queue = hexagon::CallQueue::Global();
+  auto lock = queue->Lock();
+  queue->Call(func_ptr, as.Scalar, as.Stack);
 }
 
 PackedFunc HexagonModuleNode::GetFunction(const std::string& name,
@@ -335,7 +350,11 @@ PackedFunc HexagonModuleNode::GetFunction(const std::string& name,
   if (f == fmap_.end()) return PackedFunc(nullptr);
 
   if (!hexagon_device_) hexagon_device_ = hexagon::Device::Global();
-  if (!dl_handle_) dl_handle_ = hexagon_device_->Load(data_, fmt_);
+  if (!dl_handle_) {
+    // Loading a module replaces the one the queued calls refer to.
+    hexagon::CallQueue::Global()->Flush();
+    dl_handle_ = hexagon_device_->Load(data_, fmt_);
+  }
 
   // Get function pointer from device.
   void* pf = hexagon_device_->Resolve(name);
@@ -370,8 +389,7 @@ std::string HexagonModuleNode::GetSource(const std::string& format) {
 }
 
 void HexagonModuleNode::RemapArgs(const TVMArgs& args, std::vector<TVMValue>& values,
-                                  std::vector<int>& type_codes,
-                                  std::vector<void*>& remote_tensors) const {
+                                  std::vector<int>& type_codes) const {
   for (unsigned i = 0, e = args.size(); i != e; ++i) {
     const TVMArgValue& a = args[i];
 
@@ -382,7 +400,6 @@ void HexagonModuleNode::RemapArgs(const TVMArgs& args, std::vector<TVMValue>& va
         assert(TVMDeviceExtType(t->ctx.device_type) == kDLHexagon);
         TVMValue v;
         v.v_handle = CreateRemoteTensor(t);
-        remote_tensors.push_back(v.v_handle);
         values.push_back(v);
         type_codes.push_back(tc);
         break;
@@ -438,7 +455,7 @@ void* HexagonModuleNode::CreateRemoteTensor(const DLTensor* t) const {
   int ndim = t->ndim;
   uint32_t size_s = 8 * ndim;  // sizeof(uint64_t)*ndim
   uint32_t size_ss = t->strides ? 2 * size_s : size_s;
-  void* remote = hexagon_device_->Alloc(size_ht + size_ss, 8);
+  void* remote = hexagon::CallQueue::Global()->AllocArgs(size_ht + size_ss);
   uint32_t remote_as_int = reinterpret_cast<uintptr_t>(remote);
   void* remote_ss = reinterpret_cast<void*>(remote_as_int + size_ht);
 
@@ -553,6 +570,78 @@ std::shared_ptr<Device> Device::Global() {
   return dev;
 }
 
+constexpr int CallQueue::kMaxBatchSize;
+constexpr unsigned CallQueue::kChunkSize;
+
+void* CallQueue::AllocArgs(unsigned size) {
+  size = (size + 7) & ~7u;
+  for (; current_chunk_ < chunks_.size(); ++current_chunk_) {
+    Chunk& chunk = chunks_[current_chunk_];
+    if (chunk.size - chunk.used >= size) {
+      void* ptr = static_cast<char*>(chunk.ptr) + chunk.used;
+      chunk.used += size;
+      return ptr;
+    }
+  }
+  unsigned chunk_size = std::max(size, kChunkSize);
+  void* ptr = Device::Global()->Alloc(chunk_size, 8);
+  CHECK(ptr != nullptr) << "Cannot allocate " << chunk_size << " bytes for the arguments";
+  chunks_.push_back(Chunk{ptr, chunk_size, size});
+  current_chunk_ = chunks_.size() - 1;
+  return ptr;
+}
+
+void CallQueue::Call(void* func, const std::vector<uint32_t>& scalar,
+                     const std::vector<uint32_t>& stack) {
+  if (!batching_) {
+    std::vector<uint32_t> sc(scalar), st(stack);
+    Device::Global()->Call(func, sc.data(), sc.size(), st.data(), st.size());
+    FlushLocked();
+    return;
+  }
+  queued_.push_back(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(func)));
+  queued_.push_back(static_cast<uint32_t>(scalar.size()));
+  queued_.push_back(static_cast<uint32_t>(stack.size()));
+  queued_.insert(queued_.end(), scalar.begin(), scalar.end());
+  queued_.insert(queued_.end(), stack.begin(), stack.end());
+  if (++num_queued_ >= kMaxBatchSize) FlushLocked();
+}
+
+void CallQueue::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlushLocked();
+}
+
+void CallQueue::FlushLocked() {
+  if (!queued_.empty()) {
+    Device::Global()->CallBatch(queued_);
+    queued_.clear();
+    num_queued_ = 0;
+  }
+  // no call is pending, the argument memory can be reused.
+  for (Chunk& chunk : chunks_) chunk.used = 0;
+  current_chunk_ = 0;
+}
+
+void CallQueue::SetBatching(bool enable) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!enable) FlushLocked();
+  batching_ = enable;
+}
+
+void CallQueue::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlushLocked();
+  for (Chunk& chunk : chunks_) Device::Global()->Free(chunk.ptr);
+  chunks_.clear();
+}
+
+CallQueue* CallQueue::Global() {
+  // NOTE: explicitly use new to avoid destruction of global state
+  static CallQueue* inst = new CallQueue();
+  return inst;
+}
+
 }  // namespace hexagon
 
 TVM_REGISTER_GLOBAL("runtime.module.loadfile_hexagon").set_body([](TVMArgs args, TVMRetValue* rv) {
@@ -25,9 +25,11 @@
 
 #include <array>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../meta_data.h"
 
@@ -139,6 +141,17 @@ class Device {
    */
   virtual void Call(void* func, uint32_t* scalar, unsigned sc_num, uint32_t* stack,
                     unsigned st_num) = 0;
+  /*!
+   * \brief Invoke a sequence of functions on device, in order.
+   * \param calls   The calls laid out back to back. Each call is the
+   *                address of the function, the number of values in the
+   *                "scalar" array, the number of values in the "stack"
+   *                array, followed by the values of both arrays, as they
+   *                are passed to \ref Call.
+   * \note The default implementation invokes \ref Call for each function,
+   *       a device may run the whole sequence with a single remote call.
+   */
+  virtual void CallBatch(const std::vector<uint32_t>& calls);
 
   virtual ~Device() = 0;
 
@@ -149,6 +162,75 @@ class Device {
   }
 };
 
+/*!
+ * \brief The calls to device functions issued by the host, and the device
+ *        memory holding their arguments.
+ *
+ * The arguments are placed in device memory suballocated from chunks that
+ * are reused from call to call, instead of being allocated and released
+ * by every call. When batching is enabled, the calls are queued and sent
+ * to the device with a single \ref Device::CallBatch, e.g. the kernels of
+ * a whole graph between two copies of its inputs and outputs. The queue is
+ * flushed before any access to device memory by the host.
+ */
+class CallQueue {
+ public:
+  /*!
+   * \brief Lock the queue, it must be held while preparing and issuing a call.
+   * \return The lock.
+   */
+  std::unique_lock<std::mutex> Lock() { return std::unique_lock<std::mutex>(mutex_); }
+  /*!
+   * \brief Allocate device memory for the arguments of the next call.
+   * \param size    Requested size, the memory is aligned to 8 bytes.
+   * \return        Pointer (local to the device) of the allocated memory.
+   * \note The memory lives until the call completes. Requires the lock.
+   */
+  void* AllocArgs(unsigned size);
+  /*!
+   * \brief Invoke a function on device, or queue it when batching.
+   *        See \ref Device::Call for the arguments. Requires the lock.
+   */
+  void Call(void* func, const std::vector<uint32_t>& scalar, const std::vector<uint32_t>& stack);
+  /*!
+   * \brief Send the queued calls to the device and wait for them.
+   */
+  void Flush();
+  /*!
+   * \brief Enable or disable batching. Disabling it flushes the queue.
+   */
+  void SetBatching(bool enable);
+  /*!
+   * \brief Flush the queue and release the argument memory, e.g. before
+   *        unloading the module with the queued functions.
+   */
+  void Release();
+
+  static CallQueue* Global();
+
+ private:
+  // flush with the lock held
+  void FlushLocked();
+
+  // maximum number of calls sent in a single batch
+  static constexpr int kMaxBatchSize = 64;
+  // minimum size of a chunk of argument memory
+  static constexpr unsigned kChunkSize = 64 * 1024;
+
+  struct Chunk {
+    void* ptr;
+    unsigned size;
+    unsigned used;
+  };
+
+  std::mutex mutex_;
+  bool batching_{false};
+  int num_queued_{0};
+  std::vector<uint32_t> queued_;
+  std::vector<Chunk> chunks_;
+  size_t current_chunk_{0};
+};
+
 }  // namespace hexagon
 
 }  // namespace runtime
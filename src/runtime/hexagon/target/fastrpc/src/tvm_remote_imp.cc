@@ -175,6 +175,31 @@ int tvm_remote_kernel(remote_handle64 handle, tvm_remote_handle_t lib, tvm_remot
       time_usec);
 }
 
+/*!
+ *  \brief Call a sequence of functions, in order.
+ *
+ *  \param handle         Domain channel handle.
+ *  \param lib            Handle of the library containing the functions.
+ *  \param calls          The calls, see tvm_remote_nd_kernel_batch.
+ *  \param calls_len      Number of values in calls.
+ *  \param in_octet       Address of the incoming buffers.
+ *  \param in_octet_len   Number of incoming buffers.
+ *  \param out_octet      Address of the outgoing buffers.
+ *  \param out_octet_len  Number of outgoing buffers.
+ *  \param pcycles        Pointer to where to store cycle count.
+ *  \param time_usec      Pointer to where to store time in usec.
+ *
+ *  \return 0 on success, negative value on error.
+ */
+int tvm_remote_kernel_batch(remote_handle64 handle, tvm_remote_handle_t lib, const int* calls,
+                            int calls_len, const tvm_remote_buffer* in_octet, int in_octet_len,
+                            tvm_remote_buffer* out_octet, int out_octet_len, uint64* pcycles,
+                            uint64* time_usec) {
+  return tvm_remote_nd_kernel_batch(
+      lib, calls, calls_len, reinterpret_cast<const tvm_remote_nd_buffer*>(in_octet), in_octet_len,
+      reinterpret_cast<tvm_remote_nd_buffer*>(out_octet), out_octet_len, pcycles, time_usec);
+}
+
 /*!
  *  \brief Release previously loaded shared object.
  *
@@ -227,6 +227,31 @@ static void print_msg_call(const msg_call& mc) {
   }
 }
 
+// Reserve the HVX units for the calling thread, return the result of the lock.
+static int acquire_hvx(hvx::config_t* hvx_info) {
+  hvx::prepare_mt_job(hvx_info);
+
+  int lock_result = -1;
+  // Check if HVX units are available
+  if (hvx_info->num_reserved > 0) {
+    lock_result = hvx::lock(hvx::MODE_128B);
+    if (lock_result < 0) {
+      FARF(ERROR, "%s: HVX locking failed lock_result=%d num_reserved=%d", __func__, lock_result,
+           hvx_info->num_reserved);
+    } else {
+      FARF(ALWAYS, "%s: HVX lock successful lock_result=%d", __func__, lock_result);
+    }
+  } else {
+    FARF(ERROR, "%s: there are no HVX units available", __func__);
+  }
+  return lock_result;
+}
+
+static void release_hvx(hvx::config_t* hvx_info, int lock_result) {
+  if (lock_result > 0) hvx::unlock();
+  hvx::cleanup_mt_job(hvx_info);
+}
+
 /*!
  *  \brief Call the specified function.
  *
@@ -263,21 +288,7 @@ int tvm_remote_nd_kernel(tvm_remote_nd_handle_t lib, tvm_remote_nd_handle_t symb
                          tvm_remote_nd_buffer* stack_out_octet, int stack_out_octet_len,
                          uint64* pcycles, uint64* time_usec) {
   hvx::config_t hvx_info = {0};
-  hvx::prepare_mt_job(&hvx_info);
-
-  int lock_result;
-  // Check if HVX units are available
-  if (hvx_info.num_reserved > 0) {
-    lock_result = hvx::lock(hvx::MODE_128B);
-    if (lock_result < 0) {
-      FARF(ERROR, "%s: HVX locking failed lock_result=%d num_reserved=%d", __func__, lock_result,
-           hvx_info.num_reserved);
-    } else {
-      FARF(ALWAYS, "%s: HVX lock successful lock_result=%d", __func__, lock_result);
-    }
-  } else {
-    FARF(ERROR, "%s: there are no HVX units available", __func__);
-  }
+  int lock_result = acquire_hvx(&hvx_info);
 
   struct msg_call* mc = (struct msg_call*)malloc(sizeof(uint32_t) * (3 + scalar_len + stack_len));
   if (mc == nullptr) {
@@ -304,12 +315,64 @@ int tvm_remote_nd_kernel(tvm_remote_nd_handle_t lib, tvm_remote_nd_handle_t symb
   int result = launcher(mc, pcycles);
   *time_usec = HAP_perf_get_time_us() - start_time;
   FARF(ALWAYS, "kernel execution: %llu pcycles  %llu usec", *pcycles, *time_usec);
-  if (lock_result > 0) hvx::unlock();
-  hvx::cleanup_mt_job(&hvx_info);
+  release_hvx(&hvx_info, lock_result);
   if (mc) free(mc);
   return result;
 }
 
+/*!
+ *  \brief Call a sequence of functions, in order.
+ *
+ *  \param lib            Handle of the library containing the functions.
+ *  \param calls          The calls, laid out back to back. Each call is
+ *                        a msg_call: the address of the function, the
+ *                        number of values passed in registers, the number
+ *                        of values passed on stack, followed by these
+ *                        values.
+ *  \param calls_len      Number of values in calls.
+ *  \param in_octet       Address of the incoming buffers.
+ *  \param in_octet_len   Number of incoming buffers.
+ *  \param out_octet      Address of the outgoing buffers.
+ *  \param out_octet_len  Number of outgoing buffers.
+ *  \param pcycles        Pointer to where to store the total cycle count.
+ *  \param time_usec      Pointer to where to store the total time in usec.
+ *
+ *  \return 0 on success, negative value on error. The sequence stops at
+ *          the first call returning an error.
+ *
+ * The HVX units are locked once for the whole sequence. The "octet"
+ * arguments are used for cache operations only.
+ */
+int tvm_remote_nd_kernel_batch(tvm_remote_nd_handle_t lib, const int* calls, int calls_len,
+                               const tvm_remote_nd_buffer* in_octet, int in_octet_len,
+                               tvm_remote_nd_buffer* out_octet, int out_octet_len,
+                               uint64* pcycles, uint64* time_usec) {
+  hvx::config_t hvx_info = {0};
+  int lock_result = acquire_hvx(&hvx_info);
+
+  *pcycles = 0;
+  int result = AEE_SUCCESS;
+  uint64_t start_time = HAP_perf_get_time_us();
+  for (int k = 0; k + 3 <= calls_len && result == AEE_SUCCESS;) {
+    // The calls are already laid out as msg_call, launch them in place.
+    msg_call* mc = reinterpret_cast<msg_call*>(const_cast<int*>(calls + k));
+    int next = k + 3 + mc->scalar_num + mc->stack_num;
+    if (next > calls_len) {
+      FARF(ERROR, "%s: truncated call at offset %d", __func__, k);
+      result = AEE_EBADPARM;
+      break;
+    }
+    uint64_t call_pcycles = 0;
+    result = launcher(mc, &call_pcycles);
+    *pcycles += call_pcycles;
+    k = next;
+  }
+  *time_usec = HAP_perf_get_time_us() - start_time;
+  FARF(ALWAYS, "batch execution: %llu pcycles  %llu usec", *pcycles, *time_usec);
+  release_hvx(&hvx_info, lock_result);
+  return result;
+}
+
 /*!
  *  \brief Release previously loaded shared object.
  *
@@ -24,8 +24,10 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "../hexagon_module.h"
 #include "AEEStdErr.h"
@@ -70,6 +72,7 @@ class HexagonTarget : public tvm::runtime::hexagon::Device {
   void* Resolve(const std::string& sym) final;
   void Call(void* func, uint32_t* scalar, unsigned scalar_num, uint32_t* stack,
             unsigned stack_num) final;
+  void CallBatch(const std::vector<uint32_t>& calls) final;
 
  private:
   std::pair<void*, size_t> AddAddrMapping(const void* dsp_addr, void* apps_addr, size_t size);
@@ -514,6 +517,39 @@ void HexagonTarget::Call(void* func, uint32_t* scalar, unsigned scalar_num, uint
   }
 }
 
+void HexagonTarget::CallBatch(const std::vector<uint32_t>& calls) {
+  uint64 pcycles = 0, execution_time_usec = 0;
+  // Pass every mapped buffer referenced by the arguments once, for the
+  // cache operations done by FastRPC.
+  std::vector<tvm_remote_buffer> octets;
+  std::set<void*> seen;
+  for (size_t k = 0; k + 3 <= calls.size(); k += 3 + calls[k + 1] + calls[k + 2]) {
+    for (unsigned i = 0, e = calls[k + 1] + calls[k + 2]; i != e; ++i) {
+      void* ptr = reinterpret_cast<void*>(static_cast<uintptr_t>(calls[k + 3 + i]));
+      auto aa = GetAppsAddr(ptr, false);
+      if (aa.first == nullptr || aa.first == vtcm_mark_ || !seen.insert(aa.first).second) continue;
+      tvm_remote_buffer buffer;
+      std::memset(&buffer, 0, sizeof(buffer));
+      buffer.data = static_cast<unsigned char*>(aa.first);
+      buffer.dataLen = aa.second;
+      octets.push_back(buffer);
+    }
+  }
+
+  const StubAPI* stub_api = StubAPI::Global();
+  int rc = stub_api->tvm_remote_kernel_batch(
+      domain_channel_handle_, module_pointer_, reinterpret_cast<const int*>(calls.data()),
+      static_cast<int>(calls.size()), octets.data(), static_cast<int>(octets.size()),
+      octets.data(), static_cast<int>(octets.size()), &pcycles, &execution_time_usec);
+
+  if (rc != AEE_SUCCESS) {
+    TVM_LOGE_HT("failed to run kernel batch on CDSP rc=0x%x", rc);
+  } else {
+    TVM_LOGD_HT("batch execution: %llu pcycles, %llu usec, %zu words", pcycles,
+                execution_time_usec, calls.size());
+  }
+}
+
 }  // namespace hexagon
 }  // namespace runtime
 }  // namespace tvm
@@ -23,14 +23,20 @@
  */
 #include "library_module.h"
 
+#include <dmlc/json.h>
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/registry.h>
 
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "params_section.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -42,18 +48,28 @@ class LibraryModuleNode final : public ModuleNode {
   const char* type_key() const final { return "library"; }
 
   PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
-    TVMBackendPackedCFunc faddr;
+    if (name == "__tvm_pgo_profile") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = GetPGOProfile([this](const char* sym) { return lib_->GetSymbol(sym); },
+                            args.size() != 0 && args[0].operator bool());
+      });
+    }
+    TVMBackendPackedCFunc faddr = GetPackedCFunc(name);
+    if (faddr == nullptr) return PackedFunc();
+    return WrapPackedFunc(faddr, sptr_to_self);
+  }
+
+  TVMBackendPackedCFunc GetPackedCFunc(const std::string& name) final {
     if (name == runtime::symbol::tvm_module_main) {
       const char* entry_name =
           reinterpret_cast<const char*>(lib_->GetSymbol(runtime::symbol::tvm_module_main));
       CHECK(entry_name != nullptr)
           << "Symbol " << runtime::symbol::tvm_module_main << " is not presented";
-      faddr = reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(entry_name));
-    } else {
-      faddr = reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(name.c_str()));
+      return reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(entry_name));
     }
-    if (faddr == nullptr) return PackedFunc();
-    return WrapPackedFunc(faddr, sptr_to_self);
+    std::string func_name =
+        SelectISAVariant(name, [this](const char* sym) { return lib_->GetSymbol(sym); });
+    return reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(func_name.c_str()));
   }
 
  private:
@@ -99,6 +115,55 @@ void InitContextFunctions(std::function<void*(const char*)> fgetsymbol) {
 #undef TVM_INIT_CONTEXT_FUNC
 }
 
+/*!
+ * \brief Whether the CPU supports an ISA level of the variants.
+ *  The levels must match the ones the LLVM codegen builds variants for.
+ */
+static bool CPUSupportsISA(const std::string& isa) {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (isa == "avx2") {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  } else if (isa == "avx512") {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") &&
+           __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+           __builtin_cpu_supports("avx512vl");
+  }
+#endif
+  return false;
+}
+
+std::string SelectISAVariant(const std::string& name,
+                             std::function<void*(const char*)> fgetsymbol) {
+  const char* variants = reinterpret_cast<const char*>(fgetsymbol(symbol::tvm_isa_variants));
+  if (variants == nullptr) return name;
+  std::istringstream is(variants);
+  std::string isa;
+  while (std::getline(is, isa, ',')) {
+    if (!CPUSupportsISA(isa)) continue;
+    std::string variant = name + "__" + isa;
+    if (fgetsymbol(variant.c_str()) != nullptr) return variant;
+  }
+  return name;
+}
+
+std::string GetPGOProfile(std::function<void*(const char*)> fgetsymbol, bool reset) {
+  const char* sites = reinterpret_cast<const char*>(fgetsymbol(symbol::tvm_pgo_sites));
+  int64_t* counters = reinterpret_cast<int64_t*>(fgetsymbol(symbol::tvm_pgo_counters));
+  if (sites == nullptr || counters == nullptr) return "";
+  std::map<std::string, std::vector<int64_t>> profile;
+  std::istringstream is(sites);
+  std::string key;
+  for (size_t i = 0; std::getline(is, key); ++i) {
+    profile[key] = {counters[2 * i], counters[2 * i + 1]};
+    if (reset) counters[2 * i] = counters[2 * i + 1] = 0;
+  }
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.Write(profile);
+  return os.str();
+}
+
 /*!
  * \brief Load and append module blob to module list
  * \param mblob The module blob.
@@ -116,6 +181,12 @@ runtime::Module ProcessModuleBlob(const char* mblob, ObjectPtr<Library> lib) {
   dmlc::MemoryFixedSizeStream fs(const_cast<char*>(mblob + sizeof(nbytes)),
                                  static_cast<size_t>(nbytes));
   dmlc::Stream* stream = &fs;
+  // The tensors with their payload in the params section view it in place.
+  std::unique_ptr<ParamsSectionReader> params_reader;
+  if (const char* mparams =
+          reinterpret_cast<const char*>(lib->GetSymbol(runtime::symbol::tvm_dev_mparams))) {
+    params_reader.reset(new ParamsSectionReader(mparams, lib));
+  }
   uint64_t size;
   CHECK(stream->Read(&size));
   std::vector<Module> modules;
@@ -29,6 +29,7 @@
 #include <tvm/runtime/module.h>
 
 #include <functional>
+#include <string>
 
 namespace tvm {
 namespace runtime {
@@ -66,6 +67,31 @@ PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>&
  */
 void InitContextFunctions(std::function<void*(const char*)> fgetsymbol);
 
+/*!
+ * \brief Get the symbol of the best variant of a function the CPU supports.
+ *
+ *  A library built with ISA variants lists them in symbol::tvm_isa_variants,
+ *  the first variant the CPU supports and the library defines is selected.
+ *
+ * \param name The name of the function.
+ * \param fgetsymbol A function to get a symbol of the library.
+ * \return The symbol to call, name if there is no suitable variant.
+ */
+std::string SelectISAVariant(const std::string& name,
+                             std::function<void*(const char*)> fgetsymbol);
+
+/*!
+ * \brief Get the PGO profile of a library instrumented with "codegen.llvm.pgo_instrument".
+ *
+ *  The profile maps the key of each site in symbol::tvm_pgo_sites to its two
+ *  counters in symbol::tvm_pgo_counters, see tir/transforms/pgo_profile.h.
+ *
+ * \param fgetsymbol A function to get a symbol of the library.
+ * \param reset Whether to zero the counters once read.
+ * \return The JSON profile, empty if the library is not instrumented.
+ */
+std::string GetPGOProfile(std::function<void*(const char*)> fgetsymbol, bool reset);
+
 /*!
  * \brief Create a module from a library.
  *
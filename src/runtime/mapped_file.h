@@ -0,0 +1,138 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.h
+ * \brief Memory-mapped files and the NDArray views into them.
+ */
+#ifndef TVM_RUNTIME_MAPPED_FILE_H_
+#define TVM_RUNTIME_MAPPED_FILE_H_
+
+#include <tvm/runtime/ndarray.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief A read-only file, memory-mapped where the platform allows it. */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Cannot open " << path;
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << path;
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ != 0) {
+      // A private mapping keeps the file untouched should a tensor be written to.
+      void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      CHECK(ptr != MAP_FAILED) << "Cannot mmap " << path;
+      data_ = static_cast<char*>(ptr);
+    }
+    close(fd);
+#else
+    std::ifstream fs(path, std::ios::in | std::ios::binary);
+    CHECK(!fs.fail()) << "Cannot open " << path;
+    fs.seekg(0, std::ios::end);
+    size_ = static_cast<size_t>(fs.tellg());
+    fs.seekg(0, std::ios::beg);
+    buffer_ = NDArray::Empty({static_cast<int64_t>(size_)}, DLDataType{kDLUInt, 8, 1},
+                             TVMContext{kDLCPU, 0});
+    data_ = static_cast<char*>(buffer_->data);
+    fs.read(data_, size_);
+#endif
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (data_ != nullptr) munmap(data_, size_);
+#endif
+  }
+
+  char* data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  /*!
+   * \brief Drop the resident pages of a byte range which is no longer needed.
+   * \param offset The start of the range.
+   * \param size The size of the range.
+   */
+  void Release(size_t offset, size_t size) {
+#ifndef _WIN32
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page - 1) / page * page;
+    size_t end = (offset + size) / page * page;
+    if (begin < end) madvise(data_ + begin, end - begin, MADV_DONTNEED);
+#endif
+  }
+
+ private:
+  char* data_{nullptr};
+  size_t size_{0};
+#ifdef _WIN32
+  NDArray buffer_;
+#endif
+};
+
+/*! \brief The DLPack manager of a tensor viewing a mapped file, or of a placeholder. */
+struct MappedTensorContext {
+  std::shared_ptr<MappedFile> file;
+  std::vector<int64_t> shape;
+};
+
+/*!
+ * \brief Create a CPU NDArray viewing a range of a mapped file.
+ *  The view keeps the mapping alive.
+ */
+inline NDArray MappedView(const std::shared_ptr<MappedFile>& file, size_t offset,
+                          DLDataType dtype, std::vector<int64_t> shape) {
+  MappedTensorContext* manager = new MappedTensorContext{file, std::move(shape)};
+  DLManagedTensor* tensor = new DLManagedTensor();
+  tensor->dl_tensor.data = file->data() + offset;
+  tensor->dl_tensor.ctx = TVMContext{kDLCPU, 0};
+  tensor->dl_tensor.ndim = static_cast<int>(manager->shape.size());
+  tensor->dl_tensor.dtype = dtype;
+  tensor->dl_tensor.shape = manager->shape.data();
+  tensor->dl_tensor.strides = nullptr;
+  tensor->dl_tensor.byte_offset = 0;
+  tensor->manager_ctx = manager;
+  tensor->deleter = [](DLManagedTensor* self) {
+    delete static_cast<MappedTensorContext*>(self->manager_ctx);
+    delete self;
+  };
+  return NDArray::FromDLPack(tensor);
+}
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_MAPPED_FILE_H_
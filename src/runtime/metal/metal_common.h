@@ -28,6 +28,8 @@
 #import <Metal/MTLBuffer.h>
 #import <Metal/MTLCommandBuffer.h>
 #import <Metal/MTLCommandQueue.h>
+#import <Metal/MTLComputeCommandEncoder.h>
+#import <Metal/MTLComputePipeline.h>
 #import <Metal/MTLDevice.h>
 #import <Metal/MTLLibrary.h>
 #include <dmlc/logging.h>
@@ -97,10 +99,26 @@ class MetalWorkspace final : public DeviceAPI {
 /*! \brief Thread local workspace */
 class MetalThreadEntry {
  public:
+  /*!
+   * \brief The command buffer batching the consecutive kernel launches of the
+   *  thread on a device, with its compute encoder and the state bound to it.
+   */
+  struct Batch {
+    id<MTLCommandBuffer> cmd_buffer = nil;
+    id<MTLComputeCommandEncoder> encoder = nil;
+    // The pipeline state bound to the encoder.
+    id<MTLComputePipelineState> pipeline = nil;
+    // The buffers bound to the encoder, by index.
+    std::vector<id<MTLBuffer> > buffers;
+    // The number of dispatches encoded.
+    int num_dispatches = 0;
+  };
   /*! \brief The current context */
   TVMContext context;
   /*! \brief The shared buffer used for copy. */
   std::vector<id<MTLBuffer> > temp_buffer_;
+  /*! \brief The open batch of each device. */
+  std::vector<Batch> batches_;
   /*! \brief workspace pool */
   WorkspacePool pool;
   // constructor
@@ -111,6 +129,10 @@ class MetalThreadEntry {
   ~MetalThreadEntry();
   // Get temp buffer with at least size under ctx.
   id<MTLBuffer> GetTempBuffer(TVMContext ctx, size_t size);
+  // Get the open batch of ctx, starting a new one if needed.
+  Batch* GetBatch(TVMContext ctx);
+  // Commit the open batch of ctx if any, optionally waiting for it to complete.
+  void Flush(TVMContext ctx, bool wait = false);
   // get the global workspace
   static MetalThreadEntry* ThreadLocal();
 };
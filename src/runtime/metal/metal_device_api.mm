@@ -175,6 +175,8 @@ void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
   CHECK(stream == nullptr);
   TVMContext ctx = ctx_from;
   if (ctx_from.device_type == kDLCPU) ctx = ctx_to;
+  // The copy is ordered after the kernels launched so far.
+  MetalThreadEntry::ThreadLocal()->Flush(ctx);
   id<MTLCommandQueue> queue = GetCommandQueue(ctx);
   id<MTLCommandBuffer> cb = [queue commandBuffer];
   int from_dev_type = static_cast<int>(ctx_from.device_type);
@@ -205,6 +207,9 @@ void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
       [cb waitUntilCompleted];
       memcpy(static_cast<char*>(to) + to_offset, static_cast<char*>([temp contents]), size);
     } else {
+      // wait for the pending writes to the buffer.
+      [cb commit];
+      [cb waitUntilCompleted];
       memcpy(static_cast<char*>(to) + to_offset,
              static_cast<char*>([from_buf contents]) + from_offset, size);
     }
@@ -223,6 +228,9 @@ void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
       [cb commit];
       [cb waitUntilCompleted];
     } else {
+      // wait for the pending reads of the buffer.
+      [cb commit];
+      [cb waitUntilCompleted];
       memcpy(static_cast<char*>([to_buf contents]) + to_offset,
              static_cast<const char*>(from) + from_offset, size);
     }
@@ -234,6 +242,7 @@ void MetalWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
 
 void MetalWorkspace::StreamSync(TVMContext ctx, TVMStreamHandle stream) {
   CHECK(stream == nullptr);
+  MetalThreadEntry::ThreadLocal()->Flush(ctx);
   // commit an empty command buffer and wait until it completes.
   id<MTLCommandQueue> queue = GetCommandQueue(ctx);
   id<MTLCommandBuffer> cb = [queue commandBuffer];
@@ -250,6 +259,9 @@ void MetalWorkspace::FreeWorkspace(TVMContext ctx, void* data) {
 }
 
 MetalThreadEntry::~MetalThreadEntry() {
+  for (size_t i = 0; i < batches_.size(); ++i) {
+    Flush(TVMContext{static_cast<DLDeviceType>(kDLMetal), static_cast<int>(i)});
+  }
   for (auto x : temp_buffer_) {
     if (x != nil) [x release];
   }
@@ -270,6 +282,31 @@ id<MTLBuffer> MetalThreadEntry::GetTempBuffer(TVMContext ctx, size_t size) {
   return temp_buffer_[ctx.device_id];
 }
 
+MetalThreadEntry::Batch* MetalThreadEntry::GetBatch(TVMContext ctx) {
+  if (batches_.size() <= static_cast<size_t>(ctx.device_id)) {
+    batches_.resize(ctx.device_id + 1);
+  }
+  Batch& batch = batches_[ctx.device_id];
+  if (batch.cmd_buffer == nil) {
+    id<MTLCommandQueue> queue = MetalWorkspace::Global()->GetCommandQueue(ctx);
+    batch.cmd_buffer = [[queue commandBuffer] retain];
+    batch.encoder = [[batch.cmd_buffer computeCommandEncoder] retain];
+  }
+  return &batch;
+}
+
+void MetalThreadEntry::Flush(TVMContext ctx, bool wait) {
+  if (batches_.size() <= static_cast<size_t>(ctx.device_id)) return;
+  Batch& batch = batches_[ctx.device_id];
+  if (batch.cmd_buffer == nil) return;
+  [batch.encoder endEncoding];
+  [batch.cmd_buffer commit];
+  if (wait) [batch.cmd_buffer waitUntilCompleted];
+  [batch.encoder release];
+  [batch.cmd_buffer release];
+  batch = Batch();
+}
+
 typedef dmlc::ThreadLocalStore<MetalThreadEntry> MetalThreadStore;
 
 MetalThreadEntry* MetalThreadEntry::ThreadLocal() { return MetalThreadStore::Get(); }
@@ -37,6 +37,8 @@ namespace tvm {
 namespace runtime {
 /*! \brief Maximum number of GPU supported in MetalModule. */
 static constexpr const int kMetalMaxNumDevice = 32;
+/*! \brief Number of kernel launches batched into a command buffer before it is committed. */
+static constexpr const int kMetalMaxBatchSize = 64;
 
 /*!
  * \brief create a metal module from data.
@@ -188,25 +188,43 @@ class MetalWrappedFunc {
       scache_[device_id] = m_->GetPipelineState(device_id, func_name_);
     }
     ThreadWorkLoad wl = thread_axis_cfg_.Extract(args);
-    id<MTLCommandQueue> queue = w_->GetCommandQueue(t->context);
-    id<MTLCommandBuffer> cb = [queue commandBuffer];
-    id<MTLComputeCommandEncoder> encoder = [cb computeCommandEncoder];
-    [encoder setComputePipelineState:scache_[device_id]];
+    // Consecutive launches are encoded into the same command buffer and encoder,
+    // whose serial dispatches see the writes of the previous ones.
+    metal::MetalThreadEntry::Batch* batch = t->GetBatch(t->context);
+    id<MTLComputeCommandEncoder> encoder = batch->encoder;
+    // Only bind the state that differs from the previous launch.
+    if (batch->pipeline != scache_[device_id]) {
+      [encoder setComputePipelineState:scache_[device_id]];
+      batch->pipeline = scache_[device_id];
+    }
+    if (batch->buffers.size() < num_buffer_args_) {
+      batch->buffers.resize(num_buffer_args_, nil);
+    }
     for (size_t i = 0; i < num_buffer_args_; ++i) {
       void* buf = args[static_cast<int>(i)];
-      [encoder setBuffer:(__bridge id<MTLBuffer>)(buf) offset:0 atIndex:i];
+      id<MTLBuffer> buffer = (__bridge id<MTLBuffer>)(buf);
+      if (batch->buffers[i] != buffer) {
+        [encoder setBuffer:buffer offset:0 atIndex:i];
+        batch->buffers[i] = buffer;
+      }
     }
     if (num_pack_args_ != 0) {
       [encoder setBytes:pack_args
                  length:num_pack_args_ * sizeof(ArgUnion)
                 atIndex:num_buffer_args_];
+      // setBytes overrides the buffer bound at this index.
+      if (batch->buffers.size() > num_buffer_args_) {
+        batch->buffers[num_buffer_args_] = nil;
+      }
     }
     // launch
     MTLSize dimGrid = MTLSizeMake(wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2));
     MTLSize dimBlock = MTLSizeMake(wl.block_dim(0), wl.block_dim(1), wl.block_dim(2));
     [encoder dispatchThreadgroups:dimGrid threadsPerThreadgroup:dimBlock];
-    [encoder endEncoding];
-    [cb commit];
+    // Commit long batches so the device starts on them.
+    if (++batch->num_dispatches >= kMetalMaxBatchSize) {
+      t->Flush(t->context);
+    }
   }
 
  private:
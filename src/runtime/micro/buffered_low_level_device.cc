@@ -0,0 +1,183 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file buffered_low_level_device.cc
+ * \brief low-level device wrapper that coalesces writes and caches reads
+ */
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "low_level_device.h"
+#include "micro_common.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Low-level device that defers writes and caches reads.
+ *
+ * Each transfer to a JTAG-attached device is a round trip, and a task flush issues many small
+ * ones for adjacent symbols and arguments. Writes are merged into contiguous runs and sent when
+ * the device next needs them: before a read that the buffered data cannot serve, and before an
+ * execution. Device memory only changes when the device executes, so reads are cached until
+ * then.
+ */
+class BufferedLowLevelDevice final : public LowLevelDevice {
+ public:
+  explicit BufferedLowLevelDevice(std::shared_ptr<LowLevelDevice> device)
+      : device_(std::move(device)) {}
+
+  void Read(TargetPtr addr, void* buf, size_t num_bytes) override {
+    if (num_bytes == 0) {
+      return;
+    }
+    uint64_t begin = addr.value().uint64();
+    auto it = cache_.upper_bound(begin);
+    if (it != cache_.begin()) {
+      --it;
+      if (it->first + it->second.size() >= begin + num_bytes) {
+        std::memcpy(buf, it->second.data() + (begin - it->first), num_bytes);
+        return;
+      }
+    }
+    Flush();
+    device_->Read(addr, buf, num_bytes);
+    Cache(begin, static_cast<const uint8_t*>(buf), num_bytes);
+  }
+
+  void Write(TargetPtr addr, const void* buf, size_t num_bytes) override {
+    if (num_bytes == 0) {
+      return;
+    }
+    word_size_ = TargetWordSize(addr.value().width_bits());
+    uint64_t begin = addr.value().uint64();
+    const uint8_t* data = static_cast<const uint8_t*>(buf);
+    Merge(&pending_, begin, data, num_bytes);
+    pending_bytes_ += num_bytes;
+    Cache(begin, data, num_bytes);
+    if (pending_bytes_ > kMaxPendingBytes) {
+      Flush();
+    }
+  }
+
+  void Execute(TargetPtr func_addr, TargetPtr breakpoint_addr) override {
+    Flush();
+    // The device may write anywhere in its memory while it runs.
+    cache_.clear();
+    cache_bytes_ = 0;
+    device_->Execute(func_addr, breakpoint_addr);
+  }
+
+  const char* device_type() const final { return device_->device_type(); }
+
+ private:
+  /*! \brief disjoint, non-adjacent runs of device memory by start address */
+  using RunMap = std::map<uint64_t, std::vector<uint8_t>>;
+
+  /*! \brief send the pending writes to the device */
+  void Flush() {
+    for (const auto& run : pending_) {
+      device_->Write(TargetPtr(word_size_, run.first), run.second.data(), run.second.size());
+    }
+    pending_.clear();
+    pending_bytes_ = 0;
+  }
+
+  /*! \brief record bytes known to be in device memory, once it is up to date */
+  void Cache(uint64_t addr, const uint8_t* data, size_t num_bytes) {
+    if (num_bytes > kMaxCacheBytes) {
+      // Too large to keep, and it may overwrite cached bytes.
+      cache_.clear();
+      cache_bytes_ = 0;
+      return;
+    }
+    if (cache_bytes_ + num_bytes > kMaxCacheBytes) {
+      cache_.clear();
+      cache_bytes_ = 0;
+    }
+    cache_bytes_ += num_bytes;
+    Merge(&cache_, addr, data, num_bytes);
+  }
+
+  /*!
+   * \brief overwrite [addr, addr + num_bytes) in runs, joining the runs it overlaps or touches
+   *  into one
+   */
+  static void Merge(RunMap* runs, uint64_t addr, const uint8_t* data, size_t num_bytes) {
+    uint64_t end = addr + num_bytes;
+    auto first = runs->upper_bound(addr);
+    if (first != runs->begin()) {
+      auto prev = std::prev(first);
+      if (prev->first + prev->second.size() >= addr) {
+        first = prev;
+      }
+    }
+    auto last = first;
+    uint64_t merged_begin = addr;
+    uint64_t merged_end = end;
+    for (; last != runs->end() && last->first <= end; ++last) {
+      merged_begin = std::min(merged_begin, last->first);
+      merged_end = std::max(merged_end, last->first + last->second.size());
+    }
+    // Grow the run that starts the merged range in place, so appending stays cheap.
+    std::vector<uint8_t> merged;
+    if (first != last && first->first == merged_begin) {
+      merged = std::move(first->second);
+      ++first;
+    }
+    merged.resize(merged_end - merged_begin);
+    for (auto it = first; it != last; ++it) {
+      std::memcpy(merged.data() + (it->first - merged_begin), it->second.data(),
+                  it->second.size());
+    }
+    std::memcpy(merged.data() + (addr - merged_begin), data, num_bytes);
+    runs->erase(first, last);
+    (*runs)[merged_begin] = std::move(merged);
+  }
+
+  /*! \brief bound on the buffered writes, flushed beyond it */
+  static const constexpr size_t kMaxPendingBytes = 1 << 20;
+  /*! \brief bound on the cached bytes, dropped beyond it */
+  static const constexpr size_t kMaxCacheBytes = 1 << 20;
+
+  /*! \brief the wrapped device */
+  std::shared_ptr<LowLevelDevice> device_;
+  /*! \brief word size of the addresses passed to the wrapped device */
+  TargetWordSize word_size_{64};
+  /*! \brief writes not yet sent to the device */
+  RunMap pending_;
+  size_t pending_bytes_{0};
+  /*! \brief device memory contents known since the last execution */
+  RunMap cache_;
+  size_t cache_bytes_{0};
+};
+
+const std::shared_ptr<LowLevelDevice> BufferedLowLevelDeviceCreate(
+    std::shared_ptr<LowLevelDevice> device) {
+  return std::make_shared<BufferedLowLevelDevice>(std::move(device));
+}
+
+}  // namespace runtime
+}  // namespace tvm
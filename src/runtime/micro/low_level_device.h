@@ -85,6 +85,15 @@ const std::shared_ptr<LowLevelDevice> HostLowLevelDeviceCreate(size_t num_bytes,
 const std::shared_ptr<LowLevelDevice> OpenOCDLowLevelDeviceCreate(const std::string& addr,
                                                                   int port);
 
+/*!
+ * \brief wrap a low-level device so that writes are coalesced into contiguous transfers, sent
+ *  before the next read they affect or the next execution, and reads are cached until the next
+ *  execution
+ * \param device the low-level device to wrap
+ */
+const std::shared_ptr<LowLevelDevice> BufferedLowLevelDeviceCreate(
+    std::shared_ptr<LowLevelDevice> device);
+
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_MICRO_LOW_LEVEL_DEVICE_H_
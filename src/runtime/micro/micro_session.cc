@@ -148,7 +148,8 @@ MicroSession::MicroSession(const std::string& comms_method, const std::string& b
                                                                      word_size_);
     curr_addr += stack_size;
   } else if (comms_method == "openocd") {
-    low_level_device_ = OpenOCDLowLevelDeviceCreate(server_addr, port);
+    low_level_device_ =
+        BufferedLowLevelDeviceCreate(OpenOCDLowLevelDeviceCreate(server_addr, port));
     section_allocators_[0] =
         std::make_shared<MicroSectionAllocator>("text",
                                                 DevMemRegion{
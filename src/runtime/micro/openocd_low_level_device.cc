@@ -76,20 +76,15 @@ class OpenOCDLowLevelDevice final : public LowLevelDevice {
       return;
     }
     {
-      socket_.cmd_builder() << "array unset output";
-      socket_.SendCommand();
-
-      socket_.cmd_builder() << "mem2array output"
+      // Clear, fill and return `output` in one script, so the read is a single round trip.
+      socket_.cmd_builder() << "array unset output; "
+                            << "mem2array output"
                             << " " << std::dec << kWordSize << " "
                             << addr.cast_to<void*>()
                             // Round up any request sizes under a byte, since OpenOCD doesn't
                             // support sub-byte-sized transfers.
-                            << " " << std::dec << (num_bytes < 8 ? 8 : num_bytes);
-      socket_.SendCommand();
-    }
-
-    {
-      socket_.cmd_builder() << "return $output";
+                            << " " << std::dec << (num_bytes < 8 ? 8 : num_bytes)
+                            << "; return $output";
       socket_.SendCommand();
       const std::string& reply = socket_.last_reply();
 
@@ -142,12 +137,11 @@ class OpenOCDLowLevelDevice final : public LowLevelDevice {
       return;
     }
 
-    // Clear `input` array.
-    socket_.cmd_builder() << "array unset input";
-    socket_.SendCommand();
-    // Build a command to set the value of `input`.
+    // Clear `input`, set its value and copy it to the device in one script, so the write is a
+    // single round trip.
     {
       std::ostringstream& cmd_builder = socket_.cmd_builder();
+      cmd_builder << "array unset input; ";
       cmd_builder << "array set input {";
       const char* char_buf = reinterpret_cast<const char*>(buf);
       for (size_t i = 0; i < num_bytes; i++) {
@@ -158,13 +152,10 @@ class OpenOCDLowLevelDevice final : public LowLevelDevice {
         // printed, and not the ASCII representation.
         cmd_builder << static_cast<uint32_t>(char_buf[i]) << " ";
       }
-      cmd_builder << "}";
-      socket_.SendCommand();
-    }
-    {
-      socket_.cmd_builder() << "array2mem input"
-                            << " " << std::dec << kWordSize << " " << addr.cast_to<void*>() << " "
-                            << std::dec << num_bytes;
+      cmd_builder << "}; ";
+      cmd_builder << "array2mem input"
+                  << " " << std::dec << kWordSize << " " << addr.cast_to<void*>() << " "
+                  << std::dec << num_bytes;
       socket_.SendCommand();
     }
   }
@@ -73,6 +73,16 @@ PackedFunc ModuleNode::GetFunction(const std::string& name, bool query_imports)
   return pf;
 }
 
+TVMBackendPackedCFunc ModuleNode::GetPackedCFunc(const std::string& name, bool query_imports) {
+  TVMBackendPackedCFunc faddr = this->GetPackedCFunc(name);
+  if (faddr != nullptr || !query_imports) return faddr;
+  for (Module& m : imports_) {
+    faddr = m->GetPackedCFunc(name, query_imports);
+    if (faddr != nullptr) return faddr;
+  }
+  return nullptr;
+}
+
 Module Module::LoadFromFile(const std::string& file_name, const std::string& format) {
   std::string fmt = GetFileFormat(file_name, format);
   CHECK(fmt.length() != 0) << "Cannot deduce format of file " << file_name;
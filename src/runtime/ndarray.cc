@@ -25,8 +25,13 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <cstring>
+#include <vector>
 
 #include "runtime_base.h"
+#include "trace.h"
 
 extern "C" {
 // C-mangled dlpack deleter.
@@ -64,12 +69,122 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
   return align;
 }
 
+inline bool IsHostContext(const DLContext& ctx) {
+  return ctx.device_type == kDLCPU || ctx.device_type == kDLCPUPinned;
+}
+
+/*!
+ * \brief The number of bytes from the first to past the last element of an array,
+ *  following its strides.
+ */
+int64_t GetExtentBytes(const DLTensor& arr) {
+  if (arr.strides == nullptr) return static_cast<int64_t>(GetDataSize(arr));
+  int64_t last = 0;
+  for (int i = 0; i < arr.ndim; ++i) {
+    if (arr.shape[i] == 0) return 0;
+    last += (arr.shape[i] - 1) * arr.strides[i];
+  }
+  return (last + 1) * ((arr.dtype.bits * arr.dtype.lanes + 7) / 8);
+}
+
+/*!
+ * \brief Copy between two host arrays of the same shape, following their strides.
+ */
+void CopyStridedHost(const DLTensor* from, DLTensor* to) {
+  int ndim = from->ndim;
+  size_t elem_bytes = (from->dtype.bits * from->dtype.lanes + 7) / 8;
+  CHECK_EQ(elem_bytes * 8, from->dtype.bits * from->dtype.lanes)
+      << "Can not copy strided arrays of sub-byte types";
+  if (GetDataSize(*from) == 0) return;
+  // The strides in bytes, the compact ones for arrays without strides.
+  std::vector<int64_t> from_strides(ndim), to_strides(ndim);
+  int64_t from_stride = elem_bytes, to_stride = elem_bytes;
+  for (int i = ndim - 1; i >= 0; --i) {
+    from_strides[i] = from->strides != nullptr ? from->strides[i] * elem_bytes : from_stride;
+    to_strides[i] = to->strides != nullptr ? to->strides[i] * elem_bytes : to_stride;
+    from_stride *= from->shape[i];
+    to_stride *= to->shape[i];
+  }
+  const char* src = static_cast<const char*>(from->data) + from->byte_offset;
+  char* dst = static_cast<char*>(to->data) + to->byte_offset;
+  if (ndim == 0) {
+    std::memcpy(dst, src, elem_bytes);
+    return;
+  }
+  // Copy the innermost rows, counting the index of the outer dimensions.
+  int64_t row = from->shape[ndim - 1];
+  bool compact_rows = from_strides[ndim - 1] == static_cast<int64_t>(elem_bytes) &&
+                      to_strides[ndim - 1] == static_cast<int64_t>(elem_bytes);
+  std::vector<int64_t> index(ndim, 0);
+  while (true) {
+    if (compact_rows) {
+      std::memcpy(dst, src, row * elem_bytes);
+    } else {
+      for (int64_t j = 0; j < row; ++j) {
+        std::memcpy(dst + j * to_strides[ndim - 1], src + j * from_strides[ndim - 1], elem_bytes);
+      }
+    }
+    int k = ndim - 2;
+    for (; k >= 0; --k) {
+      src += from_strides[k];
+      dst += to_strides[k];
+      if (++index[k] < from->shape[k]) break;
+      src -= from_strides[k] * from->shape[k];
+      dst -= to_strides[k] * to->shape[k];
+      index[k] = 0;
+    }
+    if (k < 0) return;
+  }
+}
+
+/*!
+ * \brief Copy between arrays of which one is strided, a device side is staged
+ *  through a compact host array.
+ */
+void CopyStrided(const DLTensor* from, DLTensor* to, TVMStreamHandle stream) {
+  if (IsHostContext(from->ctx) && IsHostContext(to->ctx)) {
+    CopyStridedHost(from, to);
+    return;
+  }
+  CHECK((IsHostContext(from->ctx) || IsContiguous(*from)) &&
+        (IsHostContext(to->ctx) || IsContiguous(*to)))
+      << "Can only copy strided arrays on the host";
+  NDArray staging = NDArray::Empty(std::vector<int64_t>(from->shape, from->shape + from->ndim),
+                                   from->dtype, {kDLCPU, 0});
+  DLTensor* compact = const_cast<DLTensor*>(staging.operator->());
+  if (!IsContiguous(*from)) {
+    CopyStridedHost(from, compact);
+    NDArray::CopyFromTo(compact, to, stream);
+    // The staging array is freed on return.
+    DeviceAPI::Get(to->ctx)->StreamSync(to->ctx, stream);
+  } else {
+    NDArray::CopyFromTo(from, compact, stream);
+    DeviceAPI::Get(from->ctx)->StreamSync(from->ctx, stream);
+    CopyStridedHost(compact, to);
+  }
+}
+
+// A compact host array over the bytes of a copy from or to an array.
+inline DLTensor BytesAsArray(const DLTensor& arr, const void* data) {
+  DLTensor bytes = arr;
+  bytes.data = const_cast<void*>(data);
+  bytes.ctx = {kDLCPU, 0};
+  bytes.strides = nullptr;
+  bytes.byte_offset = 0;
+  return bytes;
+}
+
 void ArrayCopyFromBytes(DLTensor* handle, const void* data, size_t nbytes) {
   TVMContext cpu_ctx;
   cpu_ctx.device_type = kDLCPU;
   cpu_ctx.device_id = 0;
   size_t arr_size = GetDataSize(*handle);
   CHECK_EQ(arr_size, nbytes) << "ArrayCopyFromBytes: size mismatch";
+  if (!IsContiguous(*handle)) {
+    DLTensor bytes = BytesAsArray(*handle, data);
+    CopyStrided(&bytes, handle, nullptr);
+    return;
+  }
   DeviceAPI::Get(handle->ctx)
       ->CopyDataFromTo(data, 0, handle->data, static_cast<size_t>(handle->byte_offset), nbytes,
                        cpu_ctx, handle->ctx, handle->dtype, nullptr);
@@ -81,6 +196,11 @@ void ArrayCopyToBytes(const DLTensor* handle, void* data, size_t nbytes) {
   cpu_ctx.device_id = 0;
   size_t arr_size = GetDataSize(*handle);
   CHECK_EQ(arr_size, nbytes) << "ArrayCopyToBytes: size mismatch";
+  if (!IsContiguous(*handle)) {
+    DLTensor bytes = BytesAsArray(*handle, data);
+    CopyStrided(handle, &bytes, nullptr);
+    return;
+  }
   DeviceAPI::Get(handle->ctx)
       ->CopyDataFromTo(handle->data, static_cast<size_t>(handle->byte_offset), data, 0, nbytes,
                        handle->ctx, cpu_ctx, handle->dtype, nullptr);
@@ -132,6 +252,20 @@ struct NDArray::Internal {
     data->dl_tensor.ctx = ctx;
     return ret;
   }
+  // Let a view share the data of an array, at an offset from its start.
+  static void ShareData(NDArray::Container* from, NDArray::Container* view,
+                        int64_t relative_byte_offset) {
+    // increase ref count
+    from->IncRef();
+    view->manager_ctx = from;
+    view->dl_tensor.data = from->dl_tensor.data;
+    view->dl_tensor.byte_offset = from->dl_tensor.byte_offset + relative_byte_offset;
+    if (IsAddressableContext(view->dl_tensor.ctx)) {
+      // The compiled kernels expect the view at the data pointer.
+      view->dl_tensor.data = static_cast<char*>(view->dl_tensor.data) + view->dl_tensor.byte_offset;
+      view->dl_tensor.byte_offset = 0;
+    }
+  }
   // Implementation of API function
   static DLTensor* MoveToFFIHandle(NDArray arr) {
     DLTensor* handle = NDArray::FFIGetHandle(arr);
@@ -162,19 +296,43 @@ struct NDArray::Internal {
   }
 };
 
-NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype) {
+NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype,
+                            int64_t relative_byte_offset) {
   CHECK(data_ != nullptr);
-  CHECK(get_mutable()->dl_tensor.strides == nullptr) << "Can only create view for compact tensor";
+  CHECK(IsContiguous()) << "Can only create view for compact tensor";
   NDArray ret = Internal::Create(shape, dtype, get_mutable()->dl_tensor.ctx);
-  ret.get_mutable()->dl_tensor.byte_offset = this->get_mutable()->dl_tensor.byte_offset;
-  size_t curr_size = GetDataSize(this->get_mutable()->dl_tensor);
-  size_t view_size = GetDataSize(ret.get_mutable()->dl_tensor);
-  CHECK_LE(view_size, curr_size)
+  int64_t curr_size = GetExtentBytes(get_mutable()->dl_tensor);
+  int64_t view_size = static_cast<int64_t>(GetDataSize(ret.get_mutable()->dl_tensor));
+  CHECK(relative_byte_offset >= 0 && relative_byte_offset + view_size <= curr_size)
       << "Tries to create a view that has bigger memory than current one";
-  // increase ref count
-  get_mutable()->IncRef();
-  ret.get_mutable()->manager_ctx = get_mutable();
-  ret.get_mutable()->dl_tensor.data = get_mutable()->dl_tensor.data;
+  CHECK_EQ(relative_byte_offset % ((dtype.bits * dtype.lanes + 7) / 8), 0)
+      << "The offset of a view should be a multiple of the element size";
+  Internal::ShareData(get_mutable(), ret.get_mutable(), relative_byte_offset);
+  return ret;
+}
+
+NDArray NDArray::CreateStridedView(std::vector<int64_t> shape, std::vector<int64_t> strides,
+                                   int64_t relative_byte_offset) {
+  CHECK(data_ != nullptr);
+  CHECK_EQ(shape.size(), strides.size()) << "The view needs one stride per dimension";
+  for (int64_t stride : strides) {
+    CHECK_GE(stride, 0) << "Can not create a view with negative strides";
+  }
+  const DLTensor& curr = get_mutable()->dl_tensor;
+  NDArray ret = Internal::Create(shape, curr.dtype, curr.ctx);
+  Container* view = ret.get_mutable();
+  view->strides_ = std::move(strides);
+  view->dl_tensor.strides = dmlc::BeginPtr(view->strides_);
+  // The extent of the view over the current array, which may itself be strided.
+  int64_t curr_size = GetExtentBytes(curr);
+  int64_t view_size = GetExtentBytes(view->dl_tensor);
+  CHECK(relative_byte_offset >= 0 && relative_byte_offset + view_size <= curr_size)
+      << "Tries to create a view that has bigger memory than current one";
+  CHECK_EQ(relative_byte_offset % ((curr.dtype.bits * curr.dtype.lanes + 7) / 8), 0)
+      << "The offset of a view should be a multiple of the element size";
+  // Keep compact views compact for the kernels.
+  if (::tvm::runtime::IsContiguous(view->dl_tensor)) view->dl_tensor.strides = nullptr;
+  Internal::ShareData(get_mutable(), view, relative_byte_offset);
   return ret;
 }
 
@@ -220,6 +378,15 @@ void NDArray::CopyFromTo(const DLTensor* from, DLTensor* to, TVMStreamHandle str
   size_t from_size = GetDataSize(*from);
   size_t to_size = GetDataSize(*to);
   CHECK_EQ(from_size, to_size) << "TVMArrayCopyFromTo: The size must exactly match";
+  if (!::tvm::runtime::IsContiguous(*from) || !::tvm::runtime::IsContiguous(*to)) {
+    CHECK_EQ(from->ndim, to->ndim) << "TVMArrayCopyFromTo: Strided arrays must have the same shape";
+    for (int i = 0; i < from->ndim; ++i) {
+      CHECK_EQ(from->shape[i], to->shape[i])
+          << "TVMArrayCopyFromTo: Strided arrays must have the same shape";
+    }
+    CopyStrided(from, to, stream);
+    return;
+  }
 
   CHECK(from->ctx.device_type == to->ctx.device_type || from->ctx.device_type == kDLCPU ||
         to->ctx.device_type == kDLCPU || from->ctx.device_type == kDLCPUPinned ||
@@ -230,6 +397,7 @@ void NDArray::CopyFromTo(const DLTensor* from, DLTensor* to, TVMStreamHandle str
   // api manager.
   TVMContext ctx = from->ctx.device_type != kDLCPU ? from->ctx : to->ctx;
 
+  TVM_TRACE_SPAN(kCopy, "copy", static_cast<int64_t>(from_size));
   DeviceAPI::Get(ctx)->CopyDataFromTo(from->data, static_cast<size_t>(from->byte_offset), to->data,
                                       static_cast<size_t>(to->byte_offset), from_size, from->ctx,
                                       to->ctx, from->dtype, stream);
@@ -242,6 +410,31 @@ runtime::DataType NDArray::DataType() const {
 
 TVM_REGISTER_OBJECT_TYPE(NDArray::Container);
 
+TVM_REGISTER_GLOBAL("runtime.NDArrayCreateView").set_body([](TVMArgs args, TVMRetValue* rv) {
+  NDArray arr = args[0];
+  DLDataType dtype = args[1];
+  int64_t relative_byte_offset = args[2];
+  std::vector<int64_t> shape;
+  for (int i = 3; i < args.num_args; ++i) {
+    shape.push_back(args[i]);
+  }
+  *rv = arr.CreateView(shape, dtype, relative_byte_offset);
+});
+
+TVM_REGISTER_GLOBAL("runtime.NDArrayCreateStridedView")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      NDArray arr = args[0];
+      int64_t relative_byte_offset = args[1];
+      int ndim = args[2];
+      CHECK_EQ(args.num_args, 3 + 2 * ndim) << "Expects the shape and the strides of the view";
+      std::vector<int64_t> shape, strides;
+      for (int i = 0; i < ndim; ++i) {
+        shape.push_back(args[3 + i]);
+        strides.push_back(args[3 + ndim + i]);
+      }
+      *rv = arr.CreateStridedView(shape, strides, relative_byte_offset);
+    });
+
 }  // namespace runtime
 }  // namespace tvm
 
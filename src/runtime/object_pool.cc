@@ -0,0 +1,419 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/object_pool.cc
+ * \brief The pooled object allocator and the object arenas.
+ */
+#include <tvm/runtime/memory.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+/*! \brief The granularity of the size classes. */
+constexpr size_t kUnit = PoolObjAllocator::kAlignment;
+/*! \brief The number of size classes, up to 512 byte objects. */
+constexpr size_t kNumSizeClasses = 32;
+/*! \brief The size class of the objects allocated with new. */
+constexpr size_t kLargeClass = kNumSizeClasses;
+/*! \brief The size class of the objects allocated in an arena. */
+constexpr size_t kArenaClass = kNumSizeClasses + 1;
+/*! \brief The number of slots exchanged between a thread and the shared pool. */
+constexpr size_t kBatchSize = 32;
+/*! \brief The size of the chunks the pooled slots are carved from. */
+constexpr size_t kChunkSize = 1 << 20;
+/*! \brief The size of the chunks of an arena. */
+constexpr size_t kArenaChunkSize = 64 << 10;
+/*! \brief The number of type indices with their own statistics, the others share the last. */
+constexpr uint32_t kNumTypeStats = 4096;
+
+struct ObjectArena;
+
+/*! \brief The header of every object, the object follows it. */
+struct alignas(kUnit) SlotHeader {
+  union {
+    /*! \brief The arena of an object of kArenaClass. */
+    ObjectArena* arena;
+    /*! \brief The allocation holding an object of kLargeClass. */
+    void* base;
+  };
+  /*! \brief The size class of the object. */
+  size_t size_class;
+};
+static_assert(sizeof(SlotHeader) == kUnit, "the header must keep objects aligned");
+
+/*! \brief A free slot, linked in place of the object. */
+struct FreeSlot {
+  FreeSlot* next;
+};
+
+inline SlotHeader* HeaderOf(void* ptr) { return static_cast<SlotHeader*>(ptr) - 1; }
+
+inline size_t RoundUp(size_t size) { return (size + kUnit - 1) / kUnit * kUnit; }
+
+/*!
+ * \brief Allocate memory aligned to kUnit.
+ * \param size The size of the memory.
+ * \param base Set to the allocation to pass to ::operator delete.
+ */
+inline char* AllocateAligned(size_t size, void** base) {
+  *base = ::operator new(size + kUnit);
+  uintptr_t addr = reinterpret_cast<uintptr_t>(*base);
+  return reinterpret_cast<char*>(RoundUp(addr));
+}
+
+/*! \brief The bytes held by the pool and the arenas. */
+std::atomic<int64_t> pool_bytes{0};
+std::atomic<int64_t> arena_bytes{0};
+
+/*! \brief The per-type statistics. */
+struct TypeStats {
+  std::atomic<int64_t> num_allocs{0};
+  std::atomic<int64_t> num_frees{0};
+  std::atomic<int64_t> bytes{0};
+};
+
+std::atomic<bool> stats_enabled{false};
+
+TypeStats* GetTypeStats(uint32_t type_index) {
+  // Leaked, as objects can be freed during the static destruction.
+  static TypeStats* stats = new TypeStats[kNumTypeStats];
+  return &stats[type_index < kNumTypeStats ? type_index : kNumTypeStats - 1];
+}
+
+/*! \brief The free slots shared by all threads, and the chunks they come from. */
+class CentralPool {
+ public:
+  static CentralPool* Global() {
+    // Leaked, as objects can be freed during the static destruction.
+    static CentralPool* inst = new CentralPool();
+    return inst;
+  }
+
+  /*!
+   * \brief Take up to kBatchSize free slots of a size class, carving new ones
+   *  when none is free.
+   * \param size_class The size class.
+   * \param count Set to the number of slots taken.
+   * \return The linked slots.
+   */
+  FreeSlot* TakeBatch(size_t size_class, size_t* count) {
+    SizeClass& sc = classes_[size_class];
+    {
+      std::lock_guard<std::mutex> lock(sc.mutex);
+      if (sc.head != nullptr) {
+        FreeSlot* head = sc.head;
+        FreeSlot* tail = head;
+        *count = 1;
+        while (*count < kBatchSize && tail->next != nullptr) {
+          tail = tail->next;
+          ++*count;
+        }
+        sc.head = tail->next;
+        sc.count -= *count;
+        tail->next = nullptr;
+        return head;
+      }
+    }
+    return Carve(size_class, count);
+  }
+
+  /*!
+   * \brief Give back linked free slots of a size class.
+   * \param size_class The size class.
+   * \param head The first slot.
+   * \param tail The last slot.
+   * \param count The number of slots.
+   */
+  void ReturnBatch(size_t size_class, FreeSlot* head, FreeSlot* tail, size_t count) {
+    SizeClass& sc = classes_[size_class];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    tail->next = sc.head;
+    sc.head = head;
+    sc.count += count;
+  }
+
+  /*! \brief Allocate a slot without a thread cache. */
+  void* AllocateOne(size_t size_class) {
+    size_t count;
+    FreeSlot* head = TakeBatch(size_class, &count);
+    if (count > 1) {
+      FreeSlot* tail = head->next;
+      while (tail->next != nullptr) tail = tail->next;
+      ReturnBatch(size_class, head->next, tail, count - 1);
+    }
+    return head;
+  }
+
+  /*! \brief Free a slot without a thread cache. */
+  void FreeOne(size_t size_class, FreeSlot* slot) { ReturnBatch(size_class, slot, slot, 1); }
+
+ private:
+  struct SizeClass {
+    std::mutex mutex;
+    FreeSlot* head{nullptr};
+    size_t count{0};
+  };
+
+  FreeSlot* Carve(size_t size_class, size_t* count) {
+    size_t slot_size = sizeof(SlotHeader) + (size_class + 1) * kUnit;
+    std::lock_guard<std::mutex> lock(chunk_mutex_);
+    if (chunk_offset_ + slot_size > kChunkSize) {
+      void* base;
+      chunk_ = AllocateAligned(kChunkSize, &base);
+      chunk_offset_ = 0;
+      pool_bytes.fetch_add(kChunkSize + kUnit, std::memory_order_relaxed);
+    }
+    size_t num_slots = std::min(kBatchSize, (kChunkSize - chunk_offset_) / slot_size);
+    FreeSlot* head = nullptr;
+    for (size_t i = 0; i < num_slots; ++i) {
+      SlotHeader* header = reinterpret_cast<SlotHeader*>(chunk_ + chunk_offset_);
+      chunk_offset_ += slot_size;
+      header->base = nullptr;
+      header->size_class = size_class;
+      FreeSlot* slot = reinterpret_cast<FreeSlot*>(header + 1);
+      slot->next = head;
+      head = slot;
+    }
+    *count = num_slots;
+    return head;
+  }
+
+  SizeClass classes_[kNumSizeClasses];
+  std::mutex chunk_mutex_;
+  char* chunk_{nullptr};
+  size_t chunk_offset_{kChunkSize};
+};
+
+/*! \brief Set once the cache of the thread is destroyed, at thread exit. */
+thread_local bool thread_cache_destroyed = false;
+
+/*! \brief The free slots of a thread, exchanged with the central pool in batches. */
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      FreeList& list = lists_[i];
+      if (list.head != nullptr) {
+        FreeSlot* tail = list.head;
+        while (tail->next != nullptr) tail = tail->next;
+        CentralPool::Global()->ReturnBatch(i, list.head, tail, list.count);
+      }
+    }
+    thread_cache_destroyed = true;
+  }
+
+  void* Allocate(size_t size_class) {
+    FreeList& list = lists_[size_class];
+    if (list.head == nullptr) {
+      list.head = CentralPool::Global()->TakeBatch(size_class, &list.count);
+    }
+    FreeSlot* slot = list.head;
+    list.head = slot->next;
+    --list.count;
+    return slot;
+  }
+
+  void Free(size_t size_class, FreeSlot* slot) {
+    FreeList& list = lists_[size_class];
+    slot->next = list.head;
+    list.head = slot;
+    // Keep at most two batches, so a thread freeing what another allocates
+    // does not hoard the slots.
+    if (++list.count >= 2 * kBatchSize) {
+      FreeSlot* head = list.head;
+      FreeSlot* tail = head;
+      for (size_t i = 1; i < kBatchSize; ++i) tail = tail->next;
+      list.head = tail->next;
+      list.count -= kBatchSize;
+      CentralPool::Global()->ReturnBatch(size_class, head, tail, kBatchSize);
+    }
+  }
+
+  /*! \return The cache of this thread, nullptr once the thread is exiting. */
+  static ThreadCache* Get() {
+    if (thread_cache_destroyed) return nullptr;
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+
+ private:
+  struct FreeList {
+    FreeSlot* head{nullptr};
+    size_t count{0};
+  };
+  FreeList lists_[kNumSizeClasses];
+};
+
+/*!
+ * \brief Memory bump allocated by a thread, released at once when its scope
+ *  has ended and all its objects are freed.
+ */
+struct ObjectArena {
+  ~ObjectArena() {
+    for (void* base : chunks) {
+      ::operator delete(base);
+    }
+    arena_bytes.fetch_sub(chunks.size() * (kArenaChunkSize + kUnit), std::memory_order_relaxed);
+  }
+
+  /*! \return The storage of an object, nullptr when it is too large for the arena. */
+  void* Allocate(size_t size) {
+    size_t slot_size = sizeof(SlotHeader) + RoundUp(size);
+    if (slot_size > kArenaChunkSize / 4) return nullptr;
+    if (offset + slot_size > kArenaChunkSize) {
+      void* base;
+      chunk = AllocateAligned(kArenaChunkSize, &base);
+      chunks.push_back(base);
+      offset = 0;
+      arena_bytes.fetch_add(kArenaChunkSize + kUnit, std::memory_order_relaxed);
+    }
+    SlotHeader* header = reinterpret_cast<SlotHeader*>(chunk + offset);
+    offset += slot_size;
+    header->arena = this;
+    header->size_class = kArenaClass;
+    ref_counter.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+  }
+
+  void DecRef() {
+    if (ref_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  /*! \brief The references of the scope and of the live objects. */
+  std::atomic<size_t> ref_counter{1};
+  std::vector<void*> chunks;
+  char* chunk{nullptr};
+  size_t offset{kArenaChunkSize};
+};
+
+/*! \brief The arena of the innermost scope on this thread. */
+thread_local ObjectArena* current_arena = nullptr;
+
+}  // namespace
+
+void* PoolObjAllocator::Allocate(size_t size, uint32_t type_index) {
+  if (stats_enabled.load(std::memory_order_relaxed)) {
+    TypeStats* stats = GetTypeStats(type_index);
+    stats->num_allocs.fetch_add(1, std::memory_order_relaxed);
+    stats->bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  if (current_arena != nullptr) {
+    void* ptr = current_arena->Allocate(size);
+    if (ptr != nullptr) return ptr;
+  }
+  size_t size_class = size == 0 ? 0 : (size - 1) / kUnit;
+  if (size_class < kNumSizeClasses) {
+    ThreadCache* cache = ThreadCache::Get();
+    return cache != nullptr ? cache->Allocate(size_class)
+                            : CentralPool::Global()->AllocateOne(size_class);
+  }
+  void* base;
+  SlotHeader* header =
+      reinterpret_cast<SlotHeader*>(AllocateAligned(sizeof(SlotHeader) + size, &base));
+  header->base = base;
+  header->size_class = kLargeClass;
+  return header + 1;
+}
+
+void PoolObjAllocator::Free(void* ptr, uint32_t type_index) {
+  if (stats_enabled.load(std::memory_order_relaxed)) {
+    GetTypeStats(type_index)->num_frees.fetch_add(1, std::memory_order_relaxed);
+  }
+  SlotHeader* header = HeaderOf(ptr);
+  size_t size_class = header->size_class;
+  if (size_class < kNumSizeClasses) {
+    FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+    ThreadCache* cache = ThreadCache::Get();
+    if (cache != nullptr) {
+      cache->Free(size_class, slot);
+    } else {
+      CentralPool::Global()->FreeOne(size_class, slot);
+    }
+  } else if (size_class == kLargeClass) {
+    ::operator delete(header->base);
+  } else {
+    header->arena->DecRef();
+  }
+}
+
+void PoolObjAllocator::EnableStats(bool enable) {
+  if (enable) {
+    for (uint32_t i = 0; i < kNumTypeStats; ++i) {
+      TypeStats* stats = GetTypeStats(i);
+      stats->num_allocs.store(0, std::memory_order_relaxed);
+      stats->num_frees.store(0, std::memory_order_relaxed);
+      stats->bytes.store(0, std::memory_order_relaxed);
+    }
+  }
+  stats_enabled.store(enable, std::memory_order_relaxed);
+}
+
+std::string PoolObjAllocator::GetStats() {
+  std::ostringstream os;
+  os << "{\"pool_bytes\": " << pool_bytes.load(std::memory_order_relaxed)
+     << ", \"arena_bytes\": " << arena_bytes.load(std::memory_order_relaxed) << ", \"types\": {";
+  bool first = true;
+  for (uint32_t i = 0; i < kNumTypeStats; ++i) {
+    TypeStats* stats = GetTypeStats(i);
+    int64_t num_allocs = stats->num_allocs.load(std::memory_order_relaxed);
+    int64_t num_frees = stats->num_frees.load(std::memory_order_relaxed);
+    if (num_allocs == 0 && num_frees == 0) continue;
+    std::string key = i + 1 < kNumTypeStats ? Object::TypeIndex2Key(i) : "<other>";
+    os << (first ? "" : ", ") << "\"" << key << "\": {\"allocs\": " << num_allocs
+       << ", \"frees\": " << num_frees
+       << ", \"bytes\": " << stats->bytes.load(std::memory_order_relaxed) << "}";
+    first = false;
+  }
+  os << "}}";
+  return os.str();
+}
+
+ObjectArenaScope::ObjectArenaScope() : arena_(new ObjectArena()), prev_(current_arena) {
+  current_arena = static_cast<ObjectArena*>(arena_);
+}
+
+ObjectArenaScope::~ObjectArenaScope() {
+  current_arena = static_cast<ObjectArena*>(prev_);
+  static_cast<ObjectArena*>(arena_)->DecRef();
+}
+
+TVM_REGISTER_GLOBAL("runtime.ObjectPoolEnabled").set_body_typed([]() -> bool {
+  return TVM_OBJECT_POOL_ALLOCATOR;
+});
+
+TVM_REGISTER_GLOBAL("runtime.ObjectPoolEnableStats").set_body_typed(PoolObjAllocator::EnableStats);
+
+TVM_REGISTER_GLOBAL("runtime.ObjectPoolStats").set_body_typed(PoolObjAllocator::GetStats);
+
+}  // namespace runtime
+}  // namespace tvm
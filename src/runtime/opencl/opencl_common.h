@@ -45,6 +45,8 @@
 #include <CL/opencl.h>
 #endif
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -198,6 +200,16 @@ class OpenCLWorkspace : public DeviceAPI {
   std::vector<cl_device_id> devices;
   // the queues
   std::vector<cl_command_queue> queues;
+  // the properties the queues are created with
+  cl_command_queue_properties queue_properties{0};
+  // Whether the queues execute out of order, ordered by explicit event dependencies.
+  bool out_of_order{false};
+  // Bumped when a memory object is released, invalidating the cached kernel arguments.
+  std::atomic<size_t> mem_epoch{0};
+  // The mutex guarding last_events.
+  std::mutex event_mu;
+  // The event of the last command accessing each memory object, on out-of-order queues.
+  std::unordered_map<cl_mem, cl_event> last_events;
   // Number of registered kernels
   // Used to register kernel into the workspace.
   size_t num_registered_kernels{0};
@@ -238,6 +250,40 @@ class OpenCLWorkspace : public DeviceAPI {
   void StreamSync(TVMContext ctx, TVMStreamHandle stream) final;
   void* AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) final;
   void FreeWorkspace(TVMContext ctx, void* data) final;
+  /*!
+   * \brief Allocate a 2D image of RGBA texels, freed by FreeDataSpace.
+   * \param ctx The context of the image.
+   * \param width The width of the image in texels.
+   * \param height The height of the image in texels.
+   * \param type_hint The type of the channels of a texel.
+   * \return The image memory object.
+   */
+  void* AllocTexture(TVMContext ctx, size_t width, size_t height, DLDataType type_hint);
+  /*!
+   * \brief Enqueue a command with the events it depends on.
+   *
+   *  On out-of-order queues the command waits for the last command accessing any
+   *  of its memory objects, it is considered to both read and write them. The
+   *  event of the command is kept when the calling thread is profiling.
+   *
+   * \param mems The memory objects accessed by the command.
+   * \param enqueue Enqueue the command given its wait list, and its event if not null.
+   */
+  void Enqueue(const std::vector<cl_mem>& mems,
+               const std::function<void(cl_uint, const cl_event*, cl_event*)>& enqueue);
+  /*!
+   * \brief Start or stop profiling the commands enqueued by the calling thread.
+   *
+   *  The queues are recreated with profiling enabled the first time, which must
+   *  happen while no other thread uses them.
+   * \param enable Whether to profile.
+   */
+  void SetProfiling(bool enable);
+  /*!
+   * \brief Wait for the commands profiled since the last call.
+   * \return The device time they spanned in microseconds, -1 if there were none.
+   */
+  double ProfiledTime();
 
   /*!
    * \brief Get the thread local ThreadEntry
@@ -257,6 +303,10 @@ class OpenCLThreadEntry {
     cl_kernel kernel{nullptr};
     // timestamp used to recognize stale kernel
     size_t version{0};
+    // The argument values last set, to skip setting unchanged ones.
+    std::vector<char> arg_cache;
+    // The memory epoch of the workspace when the arguments were cached.
+    size_t arg_epoch{0};
   };
   /*! \brief The current context */
   TVMContext context;
@@ -264,6 +314,10 @@ class OpenCLThreadEntry {
   std::vector<KTEntry> kernel_table;
   /*! \brief workspace pool */
   WorkspacePool pool;
+  /*! \brief Whether the commands enqueued by the thread are profiled */
+  bool profiling{false};
+  /*! \brief The events of the profiled commands */
+  std::vector<cl_event> profiled_events;
   // constructor
   OpenCLThreadEntry(DLDeviceType device_type, DeviceAPI* device) : pool(device_type, device) {
     context.device_id = 0;
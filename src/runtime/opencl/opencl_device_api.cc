@@ -21,8 +21,15 @@
  * \file opencl_device_api.cc
  */
 #include <dmlc/thread_local.h>
+#include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
 #include "opencl_common.h"
 
 namespace tvm {
@@ -126,42 +133,218 @@ void* OpenCLWorkspace::AllocDataSpace(TVMContext ctx, size_t size, size_t alignm
   return mptr;
 }
 
+void* OpenCLWorkspace::AllocTexture(TVMContext ctx, size_t width, size_t height,
+                                    DLDataType type_hint) {
+  this->Init();
+  CHECK(context != nullptr) << "No OpenCL device";
+  cl_image_format format;
+  format.image_channel_order = CL_RGBA;
+  DataType dtype(type_hint);
+  if (dtype == DataType::Float(32)) {
+    format.image_channel_data_type = CL_FLOAT;
+  } else if (dtype == DataType::Float(16)) {
+    format.image_channel_data_type = CL_HALF_FLOAT;
+  } else if (dtype == DataType::Int(32)) {
+    format.image_channel_data_type = CL_SIGNED_INT32;
+  } else if (dtype == DataType::UInt(32)) {
+    format.image_channel_data_type = CL_UNSIGNED_INT32;
+  } else {
+    LOG(FATAL) << "Cannot allocate an OpenCL image of type " << dtype;
+  }
+  cl_image_desc desc = {};
+  desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+  desc.image_width = width;
+  desc.image_height = height;
+  cl_int err_code;
+  cl_mem mptr =
+      clCreateImage(this->context, CL_MEM_READ_WRITE, &format, &desc, nullptr, &err_code);
+  OPENCL_CHECK_ERROR(err_code);
+  return mptr;
+}
+
 void OpenCLWorkspace::FreeDataSpace(TVMContext ctx, void* ptr) {
   // We have to make sure that the memory object is not in the command queue
   // for some OpenCL platforms.
   OPENCL_CALL(clFinish(this->GetQueue(ctx)));
 
   cl_mem mptr = static_cast<cl_mem>(ptr);
+  if (out_of_order) {
+    std::lock_guard<std::mutex> lock(event_mu);
+    auto it = last_events.find(mptr);
+    if (it != last_events.end()) {
+      OPENCL_CALL(clReleaseEvent(it->second));
+      last_events.erase(it);
+    }
+  }
+  // A new memory object may reuse the handle, kernels must set their arguments again.
+  ++mem_epoch;
   OPENCL_CALL(clReleaseMemObject(mptr));
 }
 
+// Whether the memory object is an image rather than a buffer.
+static bool IsImage(cl_mem mem) {
+  cl_mem_object_type type;
+  OPENCL_CALL(clGetMemObjectInfo(mem, CL_MEM_TYPE, sizeof(type), &type, nullptr));
+  return type != CL_MEM_OBJECT_BUFFER;
+}
+
+// The region of a whole image, images are only copied as a whole.
+static std::array<size_t, 3> ImageRegion(cl_mem image, size_t offset, size_t size) {
+  size_t width, height, elem_size;
+  OPENCL_CALL(clGetImageInfo(image, CL_IMAGE_WIDTH, sizeof(width), &width, nullptr));
+  OPENCL_CALL(clGetImageInfo(image, CL_IMAGE_HEIGHT, sizeof(height), &height, nullptr));
+  OPENCL_CALL(clGetImageInfo(image, CL_IMAGE_ELEMENT_SIZE, sizeof(elem_size), &elem_size, nullptr));
+  CHECK(offset == 0 && size == width * height * elem_size)
+      << "OpenCL images can only be copied as a whole";
+  return {width, height, 1};
+}
+
 void OpenCLWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void* to,
                                      size_t to_offset, size_t size, TVMContext ctx_from,
                                      TVMContext ctx_to, DLDataType type_hint,
                                      TVMStreamHandle stream) {
   this->Init();
   CHECK(stream == nullptr);
+  const size_t origin[3] = {0, 0, 0};
   if (IsOpenCLDevice(ctx_from) && IsOpenCLDevice(ctx_to)) {
-    OPENCL_CALL(clEnqueueCopyBuffer(this->GetQueue(ctx_to),
-                                    static_cast<cl_mem>((void*)from),  // NOLINT(*)
-                                    static_cast<cl_mem>(to), from_offset, to_offset, size, 0,
-                                    nullptr, nullptr));
+    cl_command_queue queue = this->GetQueue(ctx_to);
+    cl_mem from_mem = static_cast<cl_mem>((void*)from);  // NOLINT(*)
+    cl_mem to_mem = static_cast<cl_mem>(to);
+    bool from_image = IsImage(from_mem), to_image = IsImage(to_mem);
+    Enqueue({from_mem, to_mem}, [&](cl_uint num_wait, const cl_event* wait, cl_event* event) {
+      if (from_image && to_image) {
+        auto region = ImageRegion(from_mem, from_offset, size);
+        OPENCL_CALL(clEnqueueCopyImage(queue, from_mem, to_mem, origin, origin, region.data(),
+                                       num_wait, wait, event));
+      } else if (from_image) {
+        auto region = ImageRegion(from_mem, from_offset, size);
+        OPENCL_CALL(clEnqueueCopyImageToBuffer(queue, from_mem, to_mem, origin, region.data(),
+                                               to_offset, num_wait, wait, event));
+      } else if (to_image) {
+        auto region = ImageRegion(to_mem, to_offset, size);
+        OPENCL_CALL(clEnqueueCopyBufferToImage(queue, from_mem, to_mem, from_offset, origin,
+                                               region.data(), num_wait, wait, event));
+      } else {
+        OPENCL_CALL(clEnqueueCopyBuffer(queue, from_mem, to_mem, from_offset, to_offset, size,
+                                        num_wait, wait, event));
+      }
+    });
   } else if (IsOpenCLDevice(ctx_from) && ctx_to.device_type == kDLCPU) {
-    OPENCL_CALL(clEnqueueReadBuffer(this->GetQueue(ctx_from),
-                                    static_cast<cl_mem>((void*)from),  // NOLINT(*)
-                                    CL_FALSE, from_offset, size, static_cast<char*>(to) + to_offset,
-                                    0, nullptr, nullptr));
-    OPENCL_CALL(clFinish(this->GetQueue(ctx_from)));
+    cl_command_queue queue = this->GetQueue(ctx_from);
+    cl_mem from_mem = static_cast<cl_mem>((void*)from);  // NOLINT(*)
+    Enqueue({from_mem}, [&](cl_uint num_wait, const cl_event* wait, cl_event* event) {
+      if (IsImage(from_mem)) {
+        auto region = ImageRegion(from_mem, from_offset, size);
+        OPENCL_CALL(clEnqueueReadImage(queue, from_mem, CL_FALSE, origin, region.data(), 0, 0,
+                                       static_cast<char*>(to) + to_offset, num_wait, wait,
+                                       event));
+      } else {
+        OPENCL_CALL(clEnqueueReadBuffer(queue, from_mem, CL_FALSE, from_offset, size,
+                                        static_cast<char*>(to) + to_offset, num_wait, wait,
+                                        event));
+      }
+    });
+    OPENCL_CALL(clFinish(queue));
   } else if (ctx_from.device_type == kDLCPU && IsOpenCLDevice(ctx_to)) {
-    OPENCL_CALL(clEnqueueWriteBuffer(this->GetQueue(ctx_to), static_cast<cl_mem>(to), CL_FALSE,
-                                     to_offset, size, static_cast<const char*>(from) + from_offset,
-                                     0, nullptr, nullptr));
-    OPENCL_CALL(clFinish(this->GetQueue(ctx_to)));
+    cl_command_queue queue = this->GetQueue(ctx_to);
+    cl_mem to_mem = static_cast<cl_mem>(to);
+    Enqueue({to_mem}, [&](cl_uint num_wait, const cl_event* wait, cl_event* event) {
+      if (IsImage(to_mem)) {
+        auto region = ImageRegion(to_mem, to_offset, size);
+        OPENCL_CALL(clEnqueueWriteImage(queue, to_mem, CL_FALSE, origin, region.data(), 0, 0,
+                                        static_cast<const char*>(from) + from_offset, num_wait,
+                                        wait, event));
+      } else {
+        OPENCL_CALL(clEnqueueWriteBuffer(queue, to_mem, CL_FALSE, to_offset, size,
+                                         static_cast<const char*>(from) + from_offset, num_wait,
+                                         wait, event));
+      }
+    });
+    OPENCL_CALL(clFinish(queue));
   } else {
     LOG(FATAL) << "Expect copy from/to OpenCL or between OpenCL";
   }
 }
 
+void OpenCLWorkspace::Enqueue(
+    const std::vector<cl_mem>& mems,
+    const std::function<void(cl_uint, const cl_event*, cl_event*)>& enqueue) {
+  OpenCLThreadEntry* t = GetThreadEntry();
+  if (!out_of_order && !t->profiling) {
+    enqueue(0, nullptr, nullptr);
+    return;
+  }
+  cl_event event = nullptr;
+  if (!out_of_order) {
+    enqueue(0, nullptr, &event);
+  } else {
+    // Enqueue under the lock, so the command order matches the recorded events.
+    std::lock_guard<std::mutex> lock(event_mu);
+    std::vector<cl_event> wait;
+    for (cl_mem mem : mems) {
+      auto it = last_events.find(mem);
+      if (it == last_events.end()) continue;
+      if (std::find(wait.begin(), wait.end(), it->second) == wait.end()) {
+        wait.push_back(it->second);
+      }
+    }
+    enqueue(static_cast<cl_uint>(wait.size()), wait.empty() ? nullptr : wait.data(), &event);
+    for (cl_mem mem : mems) {
+      cl_event& last = last_events[mem];
+      if (last == event) continue;
+      if (last != nullptr) {
+        OPENCL_CALL(clReleaseEvent(last));
+      }
+      OPENCL_CALL(clRetainEvent(event));
+      last = event;
+    }
+  }
+  if (t->profiling) {
+    t->profiled_events.push_back(event);
+  } else {
+    OPENCL_CALL(clReleaseEvent(event));
+  }
+}
+
+void OpenCLWorkspace::SetProfiling(bool enable) {
+  this->Init();
+  if (enable && !(queue_properties & CL_QUEUE_PROFILING_ENABLE)) {
+    // The queue properties are fixed at creation.
+    std::lock_guard<std::mutex> lock(this->mu);
+    if (!(queue_properties & CL_QUEUE_PROFILING_ENABLE)) {
+      queue_properties |= CL_QUEUE_PROFILING_ENABLE;
+      for (size_t i = 0; i < queues.size(); ++i) {
+        OPENCL_CALL(clFinish(queues[i]));
+        OPENCL_CALL(clReleaseCommandQueue(queues[i]));
+        cl_int err_code;
+        queues[i] = clCreateCommandQueue(this->context, devices[i], queue_properties, &err_code);
+        OPENCL_CHECK_ERROR(err_code);
+      }
+    }
+  }
+  if (!enable) ProfiledTime();
+  GetThreadEntry()->profiling = enable;
+}
+
+double OpenCLWorkspace::ProfiledTime() {
+  std::vector<cl_event>& events = GetThreadEntry()->profiled_events;
+  if (events.empty()) return -1;
+  OPENCL_CALL(clWaitForEvents(static_cast<cl_uint>(events.size()), events.data()));
+  cl_ulong begin = std::numeric_limits<cl_ulong>::max(), end = 0;
+  for (cl_event event : events) {
+    cl_ulong start, stop;
+    OPENCL_CALL(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start,
+                                        nullptr));
+    OPENCL_CALL(
+        clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(stop), &stop, nullptr));
+    begin = std::min(begin, start);
+    end = std::max(end, stop);
+    OPENCL_CALL(clReleaseEvent(event));
+  }
+  events.clear();
+  return static_cast<double>(end - begin) * 1e-3;
+}
+
 void OpenCLWorkspace::StreamSync(TVMContext ctx, TVMStreamHandle stream) {
   CHECK(stream == nullptr);
   OPENCL_CALL(clFinish(this->GetQueue(ctx)));
@@ -267,9 +450,26 @@ void OpenCLWorkspace::Init(const std::string& type_key, const std::string& devic
                                   nullptr, &err_code);
   OPENCL_CHECK_ERROR(err_code);
   CHECK_EQ(this->queues.size(), 0U);
+  // Out-of-order queues let independent kernels overlap, they are opt-in.
+  const char* out_of_order_env = getenv("TVM_OPENCL_OUT_OF_ORDER_QUEUE");
+  if (out_of_order_env != nullptr && std::atoi(out_of_order_env) != 0) {
+    this->out_of_order = true;
+    for (cl_device_id did : this->devices) {
+      cl_command_queue_properties props;
+      OPENCL_CALL(
+          clGetDeviceInfo(did, CL_DEVICE_QUEUE_PROPERTIES, sizeof(props), &props, nullptr));
+      this->out_of_order &= (props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) != 0;
+    }
+    if (!this->out_of_order) {
+      LOG(WARNING) << "OpenCL device does not support out-of-order queues";
+    } else {
+      this->queue_properties |= CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+    }
+  }
   for (size_t i = 0; i < this->devices.size(); ++i) {
     cl_device_id did = this->devices[i];
-    this->queues.push_back(clCreateCommandQueue(this->context, did, 0, &err_code));
+    this->queues.push_back(
+        clCreateCommandQueue(this->context, did, this->queue_properties, &err_code));
     OPENCL_CHECK_ERROR(err_code);
   }
   initialized_ = true;
@@ -280,6 +480,43 @@ TVM_REGISTER_GLOBAL("device_api.opencl").set_body([](TVMArgs args, TVMRetValue*
   *rv = static_cast<void*>(ptr);
 });
 
+// Profile the commands of the calling thread, see OpenCLWorkspace::SetProfiling.
+TVM_REGISTER_GLOBAL("device_api.opencl.set_profiling")
+    .set_body_typed([](int device_id, bool enable) {
+      OpenCLWorkspace::Global()->SetProfiling(enable);
+    });
+
+TVM_REGISTER_GLOBAL("device_api.opencl.profiled_time").set_body_typed([](int device_id) {
+  return OpenCLWorkspace::Global()->ProfiledTime();
+});
+
+// An NDArray of shape [height, width, 4] backed by a 2D image, the data of a texture buffer.
+TVM_REGISTER_GLOBAL("device_api.opencl.alloc_texture")
+    .set_body_typed([](int64_t height, int64_t width, DataType dtype, int device_id) {
+      struct TextureTensor {
+        std::vector<int64_t> shape;
+        DLManagedTensor tensor;
+      };
+      TVMContext ctx{kDLOpenCL, device_id};
+      auto* texture = new TextureTensor();
+      texture->shape = {height, width, 4};
+      DLTensor& dl_tensor = texture->tensor.dl_tensor;
+      dl_tensor.data = OpenCLWorkspace::Global()->AllocTexture(ctx, width, height, dtype);
+      dl_tensor.ctx = ctx;
+      dl_tensor.ndim = 3;
+      dl_tensor.dtype = dtype;
+      dl_tensor.shape = texture->shape.data();
+      dl_tensor.strides = nullptr;
+      dl_tensor.byte_offset = 0;
+      texture->tensor.manager_ctx = texture;
+      texture->tensor.deleter = [](DLManagedTensor* tensor) {
+        auto* texture = static_cast<TextureTensor*>(tensor->manager_ctx);
+        OpenCLWorkspace::Global()->FreeDataSpace(tensor->dl_tensor.ctx, tensor->dl_tensor.data);
+        delete texture;
+      };
+      return NDArray::FromDLPack(&texture->tensor);
+    });
+
 }  // namespace cl
 }  // namespace runtime
 }  // namespace tvm
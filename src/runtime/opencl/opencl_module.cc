@@ -25,6 +25,7 @@
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstring>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -38,7 +39,7 @@ class OpenCLWrappedFunc {
  public:
   // initialize the OpenCL function.
   void Init(OpenCLModuleNode* m, ObjectPtr<Object> sptr, OpenCLModuleNode::KTRefEntry entry,
-            std::string func_name, std::vector<size_t> arg_size,
+            std::string func_name, std::vector<size_t> arg_size, std::vector<size_t> mem_args,
             const std::vector<std::string>& thread_axis_tags) {
     w_ = m->GetGlobalWorkspace();
     m_ = m;
@@ -46,6 +47,9 @@ class OpenCLWrappedFunc {
     entry_ = entry;
     func_name_ = func_name;
     arg_size_ = arg_size;
+    arg_bytes_ = 0;
+    for (size_t size : arg_size) arg_bytes_ += size;
+    mem_args_ = mem_args;
     thread_axis_cfg_.Init(arg_size.size(), thread_axis_tags);
   }
   // invoke the function with void arguments
@@ -56,14 +60,25 @@ class OpenCLWrappedFunc {
     if (entry_.kernel_id >= t->kernel_table.size()) {
       t->kernel_table.resize(entry_.kernel_id + 1);
     }
-    const auto& e = t->kernel_table[entry_.kernel_id];
+    auto& e = t->kernel_table[entry_.kernel_id];
     cl_kernel kernel = e.kernel;
     if (kernel == nullptr || e.version != entry_.version) {
       kernel = m_->InstallKernel(w_, t, func_name_, entry_);
     }
-    // setup arguments.
+    // setup arguments, skipping those unchanged since the last launch on this thread.
+    size_t epoch = w_->mem_epoch.load(std::memory_order_relaxed);
+    bool set_all = e.arg_cache.size() != arg_bytes_ || e.arg_epoch != epoch;
+    if (set_all) {
+      e.arg_cache.resize(arg_bytes_);
+      e.arg_epoch = epoch;
+    }
+    char* cached = e.arg_cache.data();
     for (cl_uint i = 0; i < arg_size_.size(); ++i) {
-      OPENCL_CALL(clSetKernelArg(kernel, i, arg_size_[i], void_args[i]));
+      if (set_all || std::memcmp(cached, void_args[i], arg_size_[i]) != 0) {
+        OPENCL_CALL(clSetKernelArg(kernel, i, arg_size_[i], void_args[i]));
+        std::memcpy(cached, void_args[i], arg_size_[i]);
+      }
+      cached += arg_size_[i];
     }
     cl_command_queue queue = w_->GetQueue(t->context);
     ThreadWorkLoad wl = thread_axis_cfg_.Extract(args);
@@ -71,9 +86,17 @@ class OpenCLWrappedFunc {
     for (cl_uint i = 0; i < work_dim; ++i) {
       wl.work_size[i] *= wl.work_size[i + 3];
     }
+    std::vector<cl_mem> mems;
+    if (w_->out_of_order) {
+      for (size_t i : mem_args_) {
+        mems.push_back(*static_cast<cl_mem*>(void_args[i]));
+      }
+    }
     // launch kernel
-    OPENCL_CALL(clEnqueueNDRangeKernel(queue, kernel, work_dim, nullptr, wl.work_size,
-                                       wl.work_size + 3, 0, nullptr, nullptr));
+    w_->Enqueue(mems, [&](cl_uint num_wait, const cl_event* wait, cl_event* event) {
+      OPENCL_CALL(clEnqueueNDRangeKernel(queue, kernel, work_dim, nullptr, wl.work_size,
+                                         wl.work_size + 3, num_wait, wait, event));
+    });
   }
 
  private:
@@ -89,6 +112,10 @@ class OpenCLWrappedFunc {
   std::string func_name_;
   // convert code for void argument
   std::vector<size_t> arg_size_;
+  // the total size of the arguments
+  size_t arg_bytes_;
+  // the indices of the memory object arguments
+  std::vector<size_t> mem_args_;
   // thread axis config
   ThreadAxisConfig thread_axis_cfg_;
 };
@@ -123,12 +150,14 @@ PackedFunc OpenCLModuleNode::GetFunction(const std::string& name,
   const FunctionInfo& info = it->second;
   OpenCLWrappedFunc f;
   std::vector<size_t> arg_size(info.arg_types.size());
+  std::vector<size_t> mem_args;
   for (size_t i = 0; i < info.arg_types.size(); ++i) {
     DLDataType t = info.arg_types[i];
     CHECK_EQ(t.lanes, 1U);
     if (t.code == kTVMOpaqueHandle) {
       // specially store pointer type size in OpenCL driver
       arg_size[i] = sizeof(void*);
+      mem_args.push_back(i);
     } else {
       uint32_t bits = t.bits;
       CHECK_EQ(bits % 8, 0U);
@@ -136,7 +165,8 @@ PackedFunc OpenCLModuleNode::GetFunction(const std::string& name,
     }
   }
   // initialize the wrapped func.
-  f.Init(this, sptr_to_self, kid_map_.at(name), name, arg_size, info.thread_axis_tags);
+  f.Init(this, sptr_to_self, kid_map_.at(name), name, arg_size, mem_args,
+         info.thread_axis_tags);
   return PackFuncVoidAddr(f, info.arg_types);
 }
 
@@ -227,6 +257,7 @@ cl_kernel OpenCLModuleNode::InstallKernel(cl::OpenCLWorkspace* w, cl::OpenCLThre
   OPENCL_CHECK_ERROR(err);
   t->kernel_table[e.kernel_id].kernel = kernel;
   t->kernel_table[e.kernel_id].version = e.version;
+  t->kernel_table[e.kernel_id].arg_cache.clear();
   kernels_.push_back(kernel);
   return kernel;
 }
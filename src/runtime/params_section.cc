@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file params_section.cc
+ * \brief The params section of a library.
+ */
+#include "params_section.h"
+
+#include <tvm/runtime/device_api.h>
+
+#include <cstring>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+
+namespace {
+
+thread_local ParamsSectionWriter* current_writer = nullptr;
+thread_local ParamsSectionReader* current_reader = nullptr;
+
+/*! \brief The DLPack manager of a tensor viewing a params section. */
+struct SectionTensorContext {
+  ObjectPtr<Object> owner;
+  std::vector<int64_t> shape;
+};
+
+size_t PayloadAlignment(size_t nbytes) {
+  return nbytes >= kParamsSectionAlignment ? kParamsSectionAlignment : kAllocAlignment;
+}
+
+}  // namespace
+
+ParamsSectionWriter::ParamsSectionWriter() : prev_(current_writer) { current_writer = this; }
+
+ParamsSectionWriter::~ParamsSectionWriter() { current_writer = prev_; }
+
+uint64_t ParamsSectionWriter::Add(const DLTensor* tensor) {
+  std::string payload(GetDataSize(*tensor), '\0');
+  if (tensor->ctx.device_type == kDLCPU && tensor->strides == nullptr) {
+    std::memcpy(&payload[0], static_cast<const char*>(tensor->data) + tensor->byte_offset,
+                payload.size());
+  } else {
+    CHECK_EQ(TVMArrayCopyToBytes(const_cast<DLTensor*>(tensor), &payload[0], payload.size()), 0)
+        << TVMGetLastError();
+  }
+  payloads_.emplace_back(std::move(payload));
+  return payloads_.size() - 1;
+}
+
+std::string ParamsSectionWriter::Finish() const {
+  uint64_t count = payloads_.size();
+  std::vector<uint64_t> header = {kTVMParamsSectionMagic, count};
+  size_t offset = (header.size() + 2 * count) * sizeof(uint64_t);
+  for (const std::string& payload : payloads_) {
+    size_t align = PayloadAlignment(payload.size());
+    offset = (offset + align - 1) / align * align;
+    header.push_back(offset);
+    header.push_back(payload.size());
+    offset += payload.size();
+  }
+  std::string section(offset, '\0');
+  std::memcpy(&section[0], header.data(), header.size() * sizeof(uint64_t));
+  for (uint64_t i = 0; i < count; ++i) {
+    std::memcpy(&section[header[2 + 2 * i]], payloads_[i].data(), payloads_[i].size());
+  }
+  return section;
+}
+
+ParamsSectionWriter* ParamsSectionWriter::Current() { return current_writer; }
+
+ParamsSectionReader::ParamsSectionReader(const char* section, ObjectPtr<Object> owner)
+    : prev_(current_reader), section_(section), owner_(std::move(owner)) {
+  const uint64_t* header = reinterpret_cast<const uint64_t*>(section_);
+  CHECK_EQ(header[0], kTVMParamsSectionMagic) << "Invalid params section";
+  count_ = header[1];
+  current_reader = this;
+}
+
+ParamsSectionReader::~ParamsSectionReader() { current_reader = prev_; }
+
+NDArray ParamsSectionReader::View(uint64_t index, DLDataType dtype, std::vector<int64_t> shape,
+                                  int64_t nbytes) const {
+  CHECK_LT(index, count_) << "Invalid params section index " << index;
+  const uint64_t* entry = reinterpret_cast<const uint64_t*>(section_) + 2 + 2 * index;
+  CHECK_EQ(entry[1], static_cast<uint64_t>(nbytes)) << "Invalid params section payload size";
+  SectionTensorContext* manager = new SectionTensorContext{owner_, std::move(shape)};
+  DLManagedTensor* tensor = new DLManagedTensor();
+  // The section is read-only, the users of a view copy it before writing.
+  tensor->dl_tensor.data = const_cast<char*>(section_ + entry[0]);
+  tensor->dl_tensor.ctx = TVMContext{kDLCPU, 0};
+  tensor->dl_tensor.ndim = static_cast<int>(manager->shape.size());
+  tensor->dl_tensor.dtype = dtype;
+  tensor->dl_tensor.shape = manager->shape.data();
+  tensor->dl_tensor.strides = nullptr;
+  tensor->dl_tensor.byte_offset = 0;
+  tensor->manager_ctx = manager;
+  tensor->deleter = [](DLManagedTensor* self) {
+    delete static_cast<SectionTensorContext*>(self->manager_ctx);
+    delete self;
+  };
+  return NDArray::FromDLPack(tensor);
+}
+
+ParamsSectionReader* ParamsSectionReader::Current() { return current_reader; }
+
+int64_t ParamsSectionAdd(const DLTensor* tensor) {
+  if (current_writer == nullptr || !DMLC_IO_NO_ENDIAN_SWAP) return -1;
+  return static_cast<int64_t>(current_writer->Add(tensor));
+}
+
+NDArray ParamsSectionView(uint64_t index, DLDataType dtype, std::vector<int64_t> shape,
+                          int64_t nbytes) {
+  CHECK(current_reader != nullptr)
+      << "The tensor is in the params section of a library, load it with the library";
+  return current_reader->View(index, dtype, std::move(shape), nbytes);
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file params_section.h
+ * \brief The params section a library can carry the tensor payloads of its
+ *  module blob in, so they are used in place once the library is loaded.
+ *
+ *  The section starts with its magic number, the number of payloads and the
+ *  offset and size of each payload from the start of the section. Payloads of
+ *  a page or more are page aligned, smaller ones are aligned to kAllocAlignment.
+ */
+#ifndef TVM_RUNTIME_PARAMS_SECTION_H_
+#define TVM_RUNTIME_PARAMS_SECTION_H_
+
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/object.h>
+
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief Magic number of a params section. */
+constexpr uint64_t kTVMParamsSectionMagic = 0xA7C3B1E4D2905F61;
+/*! \brief The alignment of the params section and of its large payloads. */
+constexpr size_t kParamsSectionAlignment = 4096;
+
+/*!
+ * \brief While alive, the tensors saved on this thread have their payloads
+ *  moved to this section instead of their records.
+ */
+class TVM_DLL ParamsSectionWriter {
+ public:
+  ParamsSectionWriter();
+  ~ParamsSectionWriter();
+
+  /*!
+   * \brief Add the payload of a tensor.
+   * \param tensor The tensor.
+   * \return The index of the payload.
+   */
+  uint64_t Add(const DLTensor* tensor);
+
+  /*! \return The number of payloads added. */
+  size_t size() const { return payloads_.size(); }
+
+  /*! \return The bytes of the section. */
+  std::string Finish() const;
+
+  /*! \return The writer of this thread, nullptr if none. */
+  static ParamsSectionWriter* Current();
+
+ private:
+  ParamsSectionWriter* prev_;
+  std::vector<std::string> payloads_;
+};
+
+/*!
+ * \brief While alive, the tensor records loaded on this thread view their
+ *  payloads in this section.
+ */
+class TVM_DLL ParamsSectionReader {
+ public:
+  /*!
+   * \param section The start of the section.
+   * \param owner The object keeping the section alive, which the views hold.
+   */
+  ParamsSectionReader(const char* section, ObjectPtr<Object> owner);
+  ~ParamsSectionReader();
+
+  /*!
+   * \brief View a payload in place.
+   * \param index The index of the payload.
+   * \param dtype The data type of the tensor.
+   * \param shape The shape of the tensor.
+   * \param nbytes The expected size of the payload.
+   * \return A CPU NDArray viewing the payload.
+   */
+  NDArray View(uint64_t index, DLDataType dtype, std::vector<int64_t> shape,
+               int64_t nbytes) const;
+
+  /*! \return The reader of this thread, nullptr if none. */
+  static ParamsSectionReader* Current();
+
+ private:
+  ParamsSectionReader* prev_;
+  const char* section_;
+  ObjectPtr<Object> owner_;
+  uint64_t count_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_PARAMS_SECTION_H_
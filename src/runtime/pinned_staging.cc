@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file pinned_staging.cc
+ * \brief Stage the copies between pageable host memory and a device through pinned buffers.
+ */
+#include "pinned_staging.h"
+
+namespace tvm {
+namespace runtime {
+
+static constexpr TVMContext kPinnedContext = {kDLCPUPinned, 0};
+
+PinnedStaging::~PinnedStaging() {
+  for (auto& kv : slots_) {
+    Slot& slot = kv.second;
+    if (slot.pending != nullptr) DeviceAPI::Get(slot.ctx)->StreamSync(slot.ctx, slot.pending);
+    if (slot.data != nullptr) {
+      DeviceAPI::Get(kPinnedContext)->FreeDataSpace(kPinnedContext, slot.data);
+    }
+  }
+}
+
+bool PinnedStaging::CanStage(TVMContext from, TVMContext to) {
+  bool upload =
+      from.device_type == kDLCPU && (to.device_type == kDLGPU || to.device_type == kDLROCM);
+  bool download =
+      to.device_type == kDLCPU && (from.device_type == kDLGPU || from.device_type == kDLROCM);
+  if (!upload && !download) return false;
+  // the pinned memory must belong to the runtime of the device
+  DeviceAPI* pinned = DeviceAPI::Get(kPinnedContext, true);
+  return pinned != nullptr && pinned == DeviceAPI::Get(upload ? to : from, true);
+}
+
+void PinnedStaging::Copy(int64_t index, const DLTensor* from, DLTensor* to,
+                         TVMStreamHandle stream) {
+  CHECK(CanStage(from->ctx, to->ctx)) << "Cannot stage the copy through pinned memory";
+  size_t nbytes = GetDataSize(*from);
+  DeviceAPI* pinned = DeviceAPI::Get(kPinnedContext);
+  Slot& slot = slots_[index];
+  if (slot.pending != nullptr) {
+    DeviceAPI::Get(slot.ctx)->StreamSync(slot.ctx, slot.pending);
+    slot.pending = nullptr;
+  }
+  if (slot.size < nbytes) {
+    if (slot.data != nullptr) pinned->FreeDataSpace(kPinnedContext, slot.data);
+    slot.data = pinned->AllocDataSpace(kPinnedContext, nbytes, kAllocAlignment, from->dtype);
+    slot.size = nbytes;
+  }
+  DLTensor staged = *from;
+  staged.data = slot.data;
+  staged.ctx = kPinnedContext;
+  staged.strides = nullptr;
+  staged.byte_offset = 0;
+  if (from->ctx.device_type == kDLCPU) {
+    NDArray::CopyFromTo(from, &staged, nullptr);
+    NDArray::CopyFromTo(&staged, to, stream);
+    if (stream != nullptr) {
+      slot.ctx = to->ctx;
+      slot.pending = stream;
+    }
+  } else {
+    NDArray::CopyFromTo(from, &staged, stream);
+    if (stream != nullptr) DeviceAPI::Get(from->ctx)->StreamSync(from->ctx, stream);
+    NDArray::CopyFromTo(&staged, to, nullptr);
+  }
+}
+
+}  // namespace runtime
+}  // namespace tvm
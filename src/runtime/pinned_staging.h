@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file pinned_staging.h
+ * \brief Stage the copies between pageable host memory and a device through pinned buffers.
+ */
+#ifndef TVM_RUNTIME_PINNED_STAGING_H_
+#define TVM_RUNTIME_PINNED_STAGING_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+
+#include <unordered_map>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Reusable pinned host buffers to stage the copies between pageable host
+ *  memory and a device.
+ *
+ *  The driver copies pageable memory through a bounce buffer of its own at a
+ *  fraction of the bandwidth, and cannot overlap such a copy with the host.
+ *  A staged copy moves the data between the pageable memory and a pinned buffer
+ *  on the host, and DMAs between the pinned buffer and the device, possibly
+ *  asynchronously on a stream.
+ *
+ *  Each slot, e.g. an input index, keeps its own buffer, so the uploads of
+ *  different slots overlap. A slot is not rewritten before its previous
+ *  asynchronous copy finishes. It is not thread-safe.
+ */
+class PinnedStaging {
+ public:
+  ~PinnedStaging();
+  /*!
+   * \brief Whether a copy between from and to can be staged through pinned memory.
+   * \param from The source context.
+   * \param to The destination context.
+   */
+  static bool CanStage(TVMContext from, TVMContext to);
+  /*!
+   * \brief Copy between a pageable host tensor and a device tensor through a buffer.
+   * \param index The index of the buffer to stage through.
+   * \param from The source tensor.
+   * \param to The destination tensor.
+   * \param stream The stream of the device. Uploads return once the DMA is queued,
+   *  downloads return once the data is in the destination.
+   */
+  void Copy(int64_t index, const DLTensor* from, DLTensor* to, TVMStreamHandle stream);
+
+ private:
+  struct Slot {
+    /*! \brief The pinned buffer. */
+    void* data{nullptr};
+    /*! \brief The size of the buffer. */
+    size_t size{0};
+    /*! \brief The device of the pending copy out of the buffer. */
+    TVMContext ctx;
+    /*! \brief The stream of the pending copy, nullptr when nothing is pending. */
+    TVMStreamHandle pending{nullptr};
+  };
+  /*! \brief The buffer of each slot. */
+  std::unordered_map<int64_t, Slot> slots_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_PINNED_STAGING_H_
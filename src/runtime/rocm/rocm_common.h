@@ -28,7 +28,9 @@
 #include <hip/hip_version.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "../workspace_pool.h"
 
@@ -56,8 +58,15 @@ class ROCMThreadEntry {
   hipStream_t stream{nullptr};
   /*! \brief thread local pool*/
   WorkspacePool pool;
+  /*!
+   * \brief The pools of non-default streams. Workspace freed after a launch may
+   *  still be in use by the kernel, so only launches on one stream can share it.
+   */
+  std::unordered_map<hipStream_t, std::unique_ptr<WorkspacePool>> stream_pools;
   /*! \brief constructor */
   ROCMThreadEntry();
+  /*! \brief get the workspace pool of the current stream */
+  WorkspacePool* CurrentPool();
   // get the threadlocal workspace
   static ROCMThreadEntry* ThreadLocal();
 };
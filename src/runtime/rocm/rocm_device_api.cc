@@ -28,6 +28,8 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstring>
+
 #include "rocm_common.h"
 
 namespace tvm {
@@ -121,16 +123,24 @@ class ROCMDeviceAPI final : public DeviceAPI {
   }
   void* AllocDataSpace(TVMContext ctx, size_t nbytes, size_t alignment,
                        DLDataType type_hint) final {
-    ROCM_CALL(hipSetDevice(ctx.device_id));
     CHECK_EQ(256 % alignment, 0U) << "ROCM space is aligned at 256 bytes";
     void* ret;
-    ROCM_CALL(hipMalloc(&ret, nbytes));
+    if (ctx.device_type == kDLCPUPinned) {
+      ROCM_CALL(hipHostMalloc(&ret, nbytes));
+    } else {
+      ROCM_CALL(hipSetDevice(ctx.device_id));
+      ROCM_CALL(hipMalloc(&ret, nbytes));
+    }
     return ret;
   }
 
   void FreeDataSpace(TVMContext ctx, void* ptr) final {
-    ROCM_CALL(hipSetDevice(ctx.device_id));
-    ROCM_CALL(hipFree(ptr));
+    if (ctx.device_type == kDLCPUPinned) {
+      ROCM_CALL(hipHostFree(ptr));
+    } else {
+      ROCM_CALL(hipSetDevice(ctx.device_id));
+      ROCM_CALL(hipFree(ptr));
+    }
   }
 
   void CopyDataFromTo(const void* from, size_t from_offset, void* to, size_t to_offset, size_t size,
@@ -139,12 +149,27 @@ class ROCMDeviceAPI final : public DeviceAPI {
     hipStream_t hip_stream = static_cast<hipStream_t>(stream);
     from = static_cast<const char*>(from) + from_offset;
     to = static_cast<char*>(to) + to_offset;
+
+    if (ctx_from.device_type == kDLCPUPinned) {
+      ctx_from.device_type = kDLCPU;
+    }
+
+    if (ctx_to.device_type == kDLCPUPinned) {
+      ctx_to.device_type = kDLCPU;
+    }
+
+    if (ctx_to.device_type == kDLCPU && ctx_from.device_type == kDLCPU) {
+      memcpy(to, from, size);
+      return;
+    }
+
     if (ctx_from.device_type == kDLROCM && ctx_to.device_type == kDLROCM) {
       ROCM_CALL(hipSetDevice(ctx_from.device_id));
       if (ctx_from.device_id == ctx_to.device_id) {
         GPUCopy(from, to, size, hipMemcpyDeviceToDevice, hip_stream);
       } else {
-        hipMemcpyPeerAsync(to, ctx_to.device_id, from, ctx_from.device_id, size, hip_stream);
+        ROCM_CALL(
+            hipMemcpyPeerAsync(to, ctx_to.device_id, from, ctx_from.device_id, size, hip_stream));
       }
     } else if (ctx_from.device_type == kDLROCM && ctx_to.device_type == kDLCPU) {
       ROCM_CALL(hipSetDevice(ctx_from.device_id));
@@ -157,6 +182,31 @@ class ROCMDeviceAPI final : public DeviceAPI {
     }
   }
 
+  TVMStreamHandle CreateStream(TVMContext ctx) {
+    ROCM_CALL(hipSetDevice(ctx.device_id));
+    hipStream_t retval;
+    ROCM_CALL(hipStreamCreate(&retval));
+    return static_cast<TVMStreamHandle>(retval);
+  }
+
+  void FreeStream(TVMContext ctx, TVMStreamHandle stream) {
+    ROCM_CALL(hipSetDevice(ctx.device_id));
+    hipStream_t hip_stream = static_cast<hipStream_t>(stream);
+    ROCMThreadEntry::ThreadLocal()->stream_pools.erase(hip_stream);
+    ROCM_CALL(hipStreamDestroy(hip_stream));
+  }
+
+  void SyncStreamFromTo(TVMContext ctx, TVMStreamHandle event_src, TVMStreamHandle event_dst) {
+    ROCM_CALL(hipSetDevice(ctx.device_id));
+    hipStream_t src_stream = static_cast<hipStream_t>(event_src);
+    hipStream_t dst_stream = static_cast<hipStream_t>(event_dst);
+    hipEvent_t evt;
+    ROCM_CALL(hipEventCreateWithFlags(&evt, hipEventDisableTiming));
+    ROCM_CALL(hipEventRecord(evt, src_stream));
+    ROCM_CALL(hipStreamWaitEvent(dst_stream, evt, 0));
+    ROCM_CALL(hipEventDestroy(evt));
+  }
+
   void StreamSync(TVMContext ctx, TVMStreamHandle stream) final {
     ROCM_CALL(hipSetDevice(ctx.device_id));
     ROCM_CALL(hipStreamSynchronize(static_cast<hipStream_t>(stream)));
@@ -167,11 +217,11 @@ class ROCMDeviceAPI final : public DeviceAPI {
   }
 
   void* AllocWorkspace(TVMContext ctx, size_t size, DLDataType type_hint) final {
-    return ROCMThreadEntry::ThreadLocal()->pool.AllocWorkspace(ctx, size);
+    return ROCMThreadEntry::ThreadLocal()->CurrentPool()->AllocWorkspace(ctx, size);
   }
 
   void FreeWorkspace(TVMContext ctx, void* data) final {
-    ROCMThreadEntry::ThreadLocal()->pool.FreeWorkspace(ctx, data);
+    ROCMThreadEntry::ThreadLocal()->CurrentPool()->FreeWorkspace(ctx, data);
   }
 
   static ROCMDeviceAPI* Global() {
@@ -196,9 +246,26 @@ ROCMThreadEntry::ROCMThreadEntry() : pool(kDLROCM, ROCMDeviceAPI::Global()) {}
 
 ROCMThreadEntry* ROCMThreadEntry::ThreadLocal() { return ROCMThreadStore::Get(); }
 
+WorkspacePool* ROCMThreadEntry::CurrentPool() {
+  if (stream == nullptr) return &pool;
+  std::unique_ptr<WorkspacePool>& stream_pool = stream_pools[stream];
+  if (stream_pool == nullptr) {
+    stream_pool.reset(new WorkspacePool(kDLROCM, ROCMDeviceAPI::Global()));
+  }
+  return stream_pool.get();
+}
+
 TVM_REGISTER_GLOBAL("device_api.rocm").set_body([](TVMArgs args, TVMRetValue* rv) {
   DeviceAPI* ptr = ROCMDeviceAPI::Global();
   *rv = static_cast<void*>(ptr);
 });
+
+// The CUDA runtime owns the pinned host memory when both runtimes are built.
+#ifndef TVM_CUDA_RUNTIME
+TVM_REGISTER_GLOBAL("device_api.cpu_pinned").set_body([](TVMArgs args, TVMRetValue* rv) {
+  DeviceAPI* ptr = ROCMDeviceAPI::Global();
+  *rv = static_cast<void*>(ptr);
+});
+#endif  // TVM_CUDA_RUNTIME
 }  // namespace runtime
 }  // namespace tvm
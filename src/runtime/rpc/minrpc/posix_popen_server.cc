@@ -20,10 +20,14 @@
 // Disable constructor to bring minimum dep on c++ABI.
 #define TVM_ARENA_HAS_DESTRUCTOR 0
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cstdlib>
+#include <cstring>
 
+#include "../../../support/shm_ring_buffer.h"
 #include "minrpc_server.h"
 
 namespace tvm {
@@ -56,11 +60,70 @@ class PosixIOHandler {
 /*! \brief Type for the posix version of min rpc server. */
 using PosixMinRPCServer = MinRPCServer<PosixIOHandler>;
 
+/*!
+ * \brief IOHandler over the rings in memory shared with the parent process.
+ *
+ *  The memory holds the ring from the parent to the child,
+ *  followed by the ring from the child to the parent.
+ */
+class ShmIOHandler {
+ public:
+  ShmIOHandler(void* memory, size_t nbytes)
+      : memory_(memory),
+        nbytes_(nbytes),
+        parent_pid_(getppid()),
+        recv_ring_(memory, support::ShmRingBuffer::Capacity(nbytes / 2)),
+        send_ring_(static_cast<char*>(memory) + nbytes / 2,
+                   support::ShmRingBuffer::Capacity(nbytes / 2)) {}
+
+  ssize_t PosixRead(void* data, size_t size) {
+    return static_cast<ssize_t>(
+        recv_ring_.Read(data, size, [this]() { return getppid() == parent_pid_; }));
+  }
+
+  ssize_t PosixWrite(const void* data, size_t size) {
+    return static_cast<ssize_t>(
+        send_ring_.Write(data, size, [this]() { return getppid() == parent_pid_; }));
+  }
+
+  void Exit(int code) { exit(code); }
+
+  void Close() {
+    recv_ring_.Close();
+    send_ring_.Close();
+    munmap(memory_, nbytes_);
+  }
+
+ private:
+  void* memory_;
+  size_t nbytes_;
+  pid_t parent_pid_;
+  support::ShmRingBuffer recv_ring_;
+  support::ShmRingBuffer send_ring_;
+};
+
+/*! \brief Type for the shared memory version of min rpc server. */
+using ShmMinRPCServer = MinRPCServer<ShmIOHandler>;
+
 }  // namespace runtime
 }  // namespace tvm
 
 int main(int argc, char* argv[]) {
   if (argc != 3) return -1;
+  if (strcmp(argv[1], "--shm") == 0) {
+    // pass the shared memory descriptor via arguments.
+    int fd = atoi(argv[2]);
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    size_t nbytes = static_cast<size_t>(st.st_size);
+    void* memory = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) return -1;
+    close(fd);
+    tvm::runtime::ShmIOHandler handler(memory, nbytes);
+    tvm::runtime::ShmMinRPCServer server(handler);
+    server.ServerLoop();
+    return 0;
+  }
   // pass the descriptor via arguments.
   tvm::runtime::PosixIOHandler handler(atoi(argv[1]), atoi(argv[2]));
   tvm::runtime::PosixMinRPCServer server(handler);
@@ -45,6 +45,16 @@ class RPCChannel {
    * \return The actual bytes sent.
    */
   virtual size_t Send(const void* data, size_t size) = 0;
+  /*!
+   * \brief Send a sequence of buffers over to the channel, as if they were concatenated.
+   * \param data The data pointers.
+   * \param size The sizes of the data.
+   * \param num The number of buffers.
+   * \return The actual bytes sent.
+   */
+  virtual size_t SendV(const void* const* data, const size_t* size, int num) {
+    return this->Send(data[0], size[0]);
+  }
   /*!
    * \brief Recv data from channel.
    *
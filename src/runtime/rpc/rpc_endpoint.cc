@@ -33,19 +33,34 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "../../support/arena.h"
+#include "../../support/lz4.h"
 #include "../../support/ring_buffer.h"
 #include "../object_internal.h"
 #include "rpc_local_session.h"
+#include "rpc_payload.h"
 
 namespace tvm {
 namespace runtime {
 
+/*!
+ * \brief Copies of at least this size send and receive their data directly
+ *  from and to the user buffer, instead of going through the ring buffers.
+ */
+constexpr size_t kRPCBulkCopyMinBytes = 16 * 1024;
+
+/*!
+ * \brief The maximum number of submitted calls in flight, submitting more
+ *  first waits for the oldest one to return.
+ */
+constexpr size_t kRPCMaxPendingRequests = 16;
+
 /*!
  * Event-driven state-machine based handlers for RPCEndpoint.
  *
@@ -57,12 +72,14 @@ namespace runtime {
 class RPCEndpoint::EventHandler : public dmlc::Stream {
  public:
   EventHandler(support::RingBuffer* reader, support::RingBuffer* writer, std::string name,
-               std::string* remote_key, std::function<void()> flush_writer)
+               std::string* remote_key, std::function<void()> flush_writer,
+               std::function<void(const void*, size_t)> send_with_payload)
       : reader_(reader),
         writer_(writer),
         name_(name),
         remote_key_(remote_key),
-        flush_writer_(flush_writer) {
+        flush_writer_(flush_writer),
+        send_with_payload_(send_with_payload) {
     this->Clear();
 
     if (*remote_key == "%toinit") {
@@ -398,7 +415,12 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
 
       this->Write(packet_nbytes);
       this->Write(code);
-      this->WriteArray(data_ptr, num_bytes);
+      // the event driven server only hands the written bytes back to its caller.
+      if (!async_server_mode_ && num_bytes >= kRPCBulkCopyMinBytes) {
+        send_with_payload_(data_ptr, num_bytes);
+      } else {
+        this->WriteArray(data_ptr, num_bytes);
+      }
       this->SwitchToState(kRecvPacketNumBytes);
     };
 
@@ -629,6 +651,8 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   std::string* remote_key_;
   // function to flush the writer.
   std::function<void()> flush_writer_;
+  // function to flush the writer followed by a payload sent in place.
+  std::function<void(const void*, size_t)> send_with_payload_;
 };
 
 RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn) {
@@ -667,11 +691,17 @@ void RPCEndpoint::Init() {
     }
   };
 
+  auto send_with_payload = [this](const void* data, size_t size) {
+    this->SendWithPayload(data, size);
+  };
+
   // Event handler
-  handler_ = std::make_shared<EventHandler>(&reader_, &writer_, name_, &remote_key_, flush_writer);
+  handler_ = std::make_shared<EventHandler>(&reader_, &writer_, name_, &remote_key_, flush_writer,
+                                            send_with_payload);
 
   // Quick function to for syscall remote.
   syscall_remote_ = PackedFunc([this](TVMArgs all_args, TVMRetValue* rv) {
+    std::vector<RPCSession::FAsyncCallback> returned;
     std::lock_guard<std::mutex> lock(mutex_);
     RPCCode code = static_cast<RPCCode>(all_args[0].operator int());
     TVMArgs args(all_args.values + 1, all_args.type_codes + 1, all_args.num_args - 1);
@@ -684,6 +714,7 @@ void RPCEndpoint::Init() {
     handler_->Write(code);
     handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
 
+    RecvPendingReturns(next_request_id_, &returned);
     code = HandleUntilReturnEvent(true, [rv](TVMArgs args) {
       CHECK_EQ(args.size(), 1);
       *rv = args[0];
@@ -780,6 +811,7 @@ void RPCEndpoint::InitRemoteSession(TVMArgs args) {
 void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
                            const int* arg_type_codes, int num_args,
                            RPCSession::FEncodeReturn encode_return) {
+  std::vector<RPCSession::FAsyncCallback> returned;
   std::lock_guard<std::mutex> lock(mutex_);
 
   handler_->ValidateArguments(arg_values, arg_type_codes, num_args);
@@ -795,12 +827,78 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_v
   handler_->Write(handle);
   handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
 
+  RecvPendingReturns(next_request_id_, &returned);
   code = HandleUntilReturnEvent(true, encode_return);
   CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
 }
 
+uint64_t RPCEndpoint::SubmitCallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
+                                     const int* arg_type_codes, int num_args,
+                                     RPCSession::FAsyncCallback callback) {
+  std::vector<RPCSession::FAsyncCallback> returned;
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  handler_->ValidateArguments(arg_values, arg_type_codes, num_args);
+  RPCCode code = RPCCode::kCallFunc;
+  uint64_t handle = reinterpret_cast<uint64_t>(h);
+
+  uint64_t packet_nbytes =
+      sizeof(code) + sizeof(handle) +
+      handler_->PackedSeqGetNumBytes(arg_values, arg_type_codes, num_args, true);
+
+  handler_->Write(packet_nbytes);
+  handler_->Write(code);
+  handler_->Write(handle);
+  handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
+  // Send the request now so that the remote starts on it while we return.
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [this](const void* data, size_t size) { return channel_->Send(data, size); },
+        writer_.bytes_available());
+  }
+
+  uint64_t request_id = next_request_id_++;
+  pending_.emplace_back(request_id, std::move(callback));
+  if (pending_.size() > kRPCMaxPendingRequests) {
+    RecvPendingReturns(pending_.front().first, &returned);
+  }
+  return request_id;
+}
+
+void RPCEndpoint::Wait(uint64_t request_id) {
+  std::vector<RPCSession::FAsyncCallback> returned;
+  std::lock_guard<std::mutex> lock(mutex_);
+  RecvPendingReturns(request_id, &returned);
+}
+
+void RPCEndpoint::RecvPendingReturns(uint64_t request_id,
+                                     std::vector<RPCSession::FAsyncCallback>* returned) {
+  // The remote serves the requests in order, so the returns arrive in the order of pending_.
+  while (!pending_.empty() && pending_.front().first <= request_id) {
+    returned->emplace_back(std::move(pending_.front().second));
+    pending_.pop_front();
+    RPCSession::FAsyncCallback& callback = returned->back();
+    bool called = false;
+    try {
+      RPCCode code = HandleUntilReturnEvent(true, [&callback, &called](TVMArgs args) {
+        called = true;
+        callback(RPCCode::kReturn, args);
+      });
+      CHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+    } catch (const dmlc::Error& e) {
+      // Errors raised by the callback itself are not the remote's.
+      if (called) throw;
+      TVMValue value;
+      value.v_str = e.what();
+      int32_t tcode = kTVMStr;
+      callback(RPCCode::kException, TVMArgs(&value, &tcode, 1));
+    }
+  }
+}
+
 void RPCEndpoint::CopyToRemote(void* from, size_t from_offset, void* to, size_t to_offset,
                                size_t data_size, TVMContext ctx_to, DLDataType type_hint) {
+  std::vector<RPCSession::FAsyncCallback> returned;
   std::lock_guard<std::mutex> lock(mutex_);
   RPCCode code = RPCCode::kCopyToRemote;
   uint64_t handle = reinterpret_cast<uint64_t>(to);
@@ -817,13 +915,19 @@ void RPCEndpoint::CopyToRemote(void* from, size_t from_offset, void* to, size_t
   handler_->Write(size);
   handler_->Write(ctx_to);
   handler_->Write(type_hint);
-  handler_->WriteArray(reinterpret_cast<char*>(from) + from_offset, data_size);
+  if (data_size >= kRPCBulkCopyMinBytes) {
+    SendWithPayload(reinterpret_cast<char*>(from) + from_offset, data_size);
+  } else {
+    handler_->WriteArray(reinterpret_cast<char*>(from) + from_offset, data_size);
+  }
 
+  RecvPendingReturns(next_request_id_, &returned);
   CHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
 }
 
 void RPCEndpoint::CopyFromRemote(void* from, size_t from_offset, void* to, size_t to_offset,
                                  size_t data_size, TVMContext ctx_from, DLDataType type_hint) {
+  std::vector<RPCSession::FAsyncCallback> returned;
   std::lock_guard<std::mutex> lock(mutex_);
   RPCCode code = RPCCode::kCopyFromRemote;
   uint64_t handle = reinterpret_cast<uint64_t>(from);
@@ -841,12 +945,79 @@ void RPCEndpoint::CopyFromRemote(void* from, size_t from_offset, void* to, size_
   handler_->Write(ctx_from);
   handler_->Write(type_hint);
 
+  RecvPendingReturns(next_request_id_, &returned);
+  if (data_size >= kRPCBulkCopyMinBytes &&
+      RecvCopyAck(reinterpret_cast<char*>(to) + to_offset, data_size)) {
+    return;
+  }
   TVMRetValue rv;
   CHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
   handler_->ReadArray(reinterpret_cast<char*>(to) + to_offset, data_size);
   handler_->FinishCopyAck();
 }
 
+void RPCEndpoint::SendWithPayload(const void* data, size_t size) {
+  // The pending bytes of the writer are the header of the payload, send both in one go.
+  std::string header(writer_.bytes_available(), '\0');
+  if (header.size() != 0) writer_.Read(&header[0], header.size());
+  const void* bufs[2] = {header.data(), data};
+  size_t sizes[2] = {header.size(), size};
+  int i = 0;
+  while (i < 2) {
+    if (sizes[i] == 0) {
+      ++i;
+      continue;
+    }
+    size_t n = channel_->SendV(bufs + i, sizes + i, 2 - i);
+    CHECK_NE(n, 0U) << "Channel closes before we send the data";
+    for (; i < 2 && n >= sizes[i]; ++i) n -= sizes[i];
+    if (i < 2) {
+      bufs[i] = static_cast<const char*>(bufs[i]) + n;
+      sizes[i] -= n;
+    }
+  }
+}
+
+bool RPCEndpoint::RecvCopyAck(void* data, size_t size) {
+  // Only when the handler is waiting for a new packet and the header needs no byte swap.
+  if (!DMLC_IO_NO_ENDIAN_SWAP || !handler_->CanCleanShutdown()) return false;
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [this](const void* buf, size_t len) { return channel_->Send(buf, len); },
+        writer_.bytes_available());
+  }
+  // Receive the packet size and code of the reply.
+  constexpr size_t kHeaderBytes = sizeof(uint64_t) + sizeof(int32_t);
+  while (reader_.bytes_available() < kHeaderBytes) {
+    size_t n = reader_.WriteWithCallback(
+        [this](void* buf, size_t len) { return channel_->Recv(buf, len); },
+        kHeaderBytes - reader_.bytes_available());
+    CHECK_NE(n, 0U) << "Channel closes before we get neded bytes";
+  }
+  char header[kHeaderBytes];
+  reader_.Peek(header, kHeaderBytes);
+  uint64_t packet_nbytes;
+  int32_t code;
+  std::memcpy(&packet_nbytes, header, sizeof(packet_nbytes));
+  std::memcpy(&code, header + sizeof(packet_nbytes), sizeof(code));
+  // e.g. an exception raised by the remote, left to the event handler.
+  if (static_cast<RPCCode>(code) != RPCCode::kCopyAck ||
+      packet_nbytes != sizeof(code) + size) {
+    return false;
+  }
+  reader_.Read(header, kHeaderBytes);
+  // The data already buffered, then the rest straight from the channel.
+  char* dst = static_cast<char*>(data);
+  size_t nread = std::min(size, reader_.bytes_available());
+  reader_.Read(dst, nread);
+  while (nread < size) {
+    size_t n = channel_->Recv(dst + nread, size - nread);
+    CHECK_NE(n, 0U) << "Channel closes before we get neded bytes";
+    nread += n;
+  }
+  return true;
+}
+
 // SysCallEventHandler functions
 void RPCGetGlobalFunc(RPCSession* handler, TVMArgs args, TVMRetValue* rv) {
   std::string name = args[0];
@@ -963,6 +1134,36 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
    */
   explicit RPCClientSession(std::shared_ptr<RPCEndpoint> endpoint) : endpoint_(endpoint) {}
 
+  ~RPCClientSession() { this->FreePayloadFuncs(); }
+
+  /*!
+   * \brief Set how the large copies to the remote send their payload.
+   *
+   *  The features are negotiated with the remote, those it does not support stay disabled.
+   *
+   * \param compress Whether to compress the payload.
+   * \param cache Whether to skip the payload the remote already has in its cache.
+   * \return The enabled features, separated by commas.
+   */
+  std::string SetPayloadOptions(bool compress, bool cache) {
+    this->FreePayloadFuncs();
+    compress_ = false;
+    cache_ = false;
+    if (!compress && !cache) return "";
+    PackedFuncHandle fcodecs = this->GetFunction("tvm.rpc.server.payload_codecs");
+    // The remote predates the payload functions.
+    if (fcodecs == nullptr) return "";
+    std::string codecs = this->CallRemote(fcodecs).operator std::string();
+    this->FreeHandle(fcodecs, kTVMPackedFuncHandle);
+    fpayload_copy_to_ = this->GetFunction("tvm.rpc.server.payload_copy_to");
+    fpayload_cache_load_ = this->GetFunction("tvm.rpc.server.payload_cache_load");
+    compress_ = compress && ("," + codecs + ",").find(",lz4,") != std::string::npos;
+    cache_ = cache;
+    std::string enabled = compress_ ? "lz4" : "";
+    if (cache_) enabled += enabled.empty() ? "cache" : ",cache";
+    return enabled;
+  }
+
   // function overrides
   PackedFuncHandle GetFunction(const std::string& name) final {
     return endpoint_->SysCallRemote(RPCCode::kGetGlobalFunc, name);
@@ -973,8 +1174,20 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
     endpoint_->CallFunc(func, arg_values, arg_type_codes, num_args, fencode_return);
   }
 
+  uint64_t SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                          const int* arg_type_codes, int num_args, FAsyncCallback callback) final {
+    return endpoint_->SubmitCallFunc(func, arg_values, arg_type_codes, num_args, callback);
+  }
+
+  void WaitCall(uint64_t call_id) final { endpoint_->Wait(call_id); }
+
   void CopyToRemote(void* from, size_t from_offset, void* to, size_t to_offset, size_t nbytes,
                     TVMContext ctx_to, DLDataType type_hint) final {
+    if (nbytes >= kRPCPayloadMinBytes && (compress_ || cache_) &&
+        this->CopyPayloadToRemote(static_cast<char*>(from) + from_offset, to, to_offset, nbytes,
+                                  ctx_to, type_hint)) {
+      return;
+    }
     endpoint_->CopyToRemote(from, from_offset, to, to_offset, nbytes, ctx_to, type_hint);
   }
 
@@ -1023,12 +1236,97 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   bool IsLocalSession() const final { return false; }
 
  private:
+  // Call a remote function with the arguments, returns its return value.
+  template <typename... Args>
+  TVMRetValue CallRemote(PackedFuncHandle func, Args&&... args) {
+    const int kNumArgs = sizeof...(Args);
+    const int kArraySize = kNumArgs > 0 ? kNumArgs : 1;
+    TVMValue values[kArraySize];
+    int type_codes[kArraySize];
+    detail::for_each(TVMArgsSetter(values, type_codes), std::forward<Args>(args)...);
+    TVMRetValue rv;
+    endpoint_->CallFunc(func, values, type_codes, kNumArgs, [&rv](TVMArgs encoded_args) {
+      if (encoded_args.size() == 2) rv = encoded_args[1];
+    });
+    return rv;
+  }
+
+  // Copy through the payload functions of the remote.
+  // Returns false when neither the cache nor the compression applies.
+  bool CopyPayloadToRemote(const char* data, void* to, size_t to_offset, size_t nbytes,
+                           TVMContext ctx_to, DLDataType type_hint) {
+    // The destination as a flat remote tensor.
+    size_t elem_bytes = (type_hint.bits * type_hint.lanes + 7) / 8;
+    DLTensor tensor;
+    int64_t shape;
+    if (elem_bytes != 0 && nbytes % elem_bytes == 0) {
+      tensor.dtype = type_hint;
+      shape = static_cast<int64_t>(nbytes / elem_bytes);
+    } else {
+      tensor.dtype = DLDataType{kDLUInt, 8, 1};
+      shape = static_cast<int64_t>(nbytes);
+    }
+    tensor.data = to;
+    tensor.ctx = ctx_to;
+    tensor.ndim = 1;
+    tensor.shape = &shape;
+    tensor.strides = nullptr;
+    tensor.byte_offset = to_offset;
+
+    std::string key;
+    if (cache_) {
+      key = RPCPayloadKey(data, nbytes);
+      if (this->CallRemote(fpayload_cache_load_, &tensor, key).operator bool()) return true;
+    }
+    std::string codec;
+    std::string compressed;
+    TVMByteArray payload{data, nbytes};
+    if (compress_) {
+      compressed = support::LZ4Compress(data, nbytes);
+      // Only worth decompressing on the remote when it saves a good part of the transfer.
+      if (compressed.size() < nbytes - nbytes / 8) {
+        codec = "lz4";
+        payload = TVMByteArray{compressed.data(), compressed.size()};
+      }
+    }
+    if (codec.empty() && key.empty()) return false;
+    this->CallRemote(fpayload_copy_to_, &tensor, key, codec, payload);
+    return true;
+  }
+
+  void FreePayloadFuncs() {
+    try {
+      if (fpayload_copy_to_ != nullptr) this->FreeHandle(fpayload_copy_to_, kTVMPackedFuncHandle);
+      if (fpayload_cache_load_ != nullptr) {
+        this->FreeHandle(fpayload_cache_load_, kTVMPackedFuncHandle);
+      }
+    } catch (const dmlc::Error& e) {
+      // fault tolerance to remote close
+    }
+    fpayload_copy_to_ = nullptr;
+    fpayload_cache_load_ = nullptr;
+  }
+
   std::shared_ptr<RPCEndpoint> endpoint_;
+  // Whether large copies to the remote compress their payload.
+  bool compress_{false};
+  // Whether large copies to the remote skip the payload cached by the remote.
+  bool cache_{false};
+  // The payload functions of the remote.
+  PackedFuncHandle fpayload_copy_to_{nullptr};
+  PackedFuncHandle fpayload_cache_load_{nullptr};
 };
 
 std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> endpoint) {
   return std::make_shared<RPCClientSession>(endpoint);
 }
 
+TVM_REGISTER_GLOBAL("rpc.SetPayloadOptions")
+    .set_body_typed([](Module sess, bool compress, bool cache) {
+      auto* client = dynamic_cast<RPCClientSession*>(RPCModuleGetSession(sess).get());
+      CHECK(client != nullptr) << "Payload options only apply to the client of a remote session";
+      return client->SetPayloadOptions(compress, cache);
+    });
+
 }  // namespace runtime
 }  // namespace tvm
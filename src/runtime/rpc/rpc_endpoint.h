@@ -26,10 +26,12 @@
 
 #include <tvm/runtime/packed_func.h>
 
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "../../support/ring_buffer.h"
 #include "rpc_channel.h"
@@ -125,6 +127,28 @@ class RPCEndpoint {
    */
   void CallFunc(RPCSession::PackedFuncHandle handle, const TVMValue* arg_values,
                 const int* arg_type_codes, int num_args, RPCSession::FEncodeReturn encode_return);
+  /*!
+   * \brief Call into remote function without waiting for its return.
+   *
+   *  The request is sent right away. As the remote serves the requests in order,
+   *  its return is received by Wait or by any later request made through the endpoint,
+   *  so several calls can be in flight over the same channel.
+   *
+   * \param handle The function handle
+   * \param arg_values The argument values.
+   * \param arg_type_codes the type codes of the argument.
+   * \param num_args Number of arguments.
+   * \param callback The callback to receive the return value or the exception.
+   * \return The id of the request.
+   */
+  uint64_t SubmitCallFunc(RPCSession::PackedFuncHandle handle, const TVMValue* arg_values,
+                          const int* arg_type_codes, int num_args,
+                          RPCSession::FAsyncCallback callback);
+  /*!
+   * \brief Wait until the return of a submitted call is received.
+   * \param request_id The id returned by SubmitCallFunc.
+   */
+  void Wait(uint64_t request_id);
   /*!
    * \brief Copy bytes into remote array content.
    * \param from The source host data.
@@ -174,6 +198,16 @@ class RPCEndpoint {
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
+  // Send the pending bytes of the writer followed by the payload, without copying the payload.
+  void SendWithPayload(const void* data, size_t size);
+  // Receive the data of a copy ack directly into its destination.
+  // Returns false, consuming nothing, when the reply is not a copy ack.
+  bool RecvCopyAck(void* data, size_t size);
+  // Receive the returns of the submitted calls up to request_id.
+  // The callbacks are moved to returned, for the caller to destroy them after unlocking,
+  // as they may hold remote objects whose deleters call into the endpoint.
+  void RecvPendingReturns(uint64_t request_id,
+                          std::vector<RPCSession::FAsyncCallback>* returned);
   // Initalization
   void Init();
   // Shutdown
@@ -186,6 +220,10 @@ class RPCEndpoint {
   support::RingBuffer reader_, writer_;
   // Event handler.
   std::shared_ptr<EventHandler> handler_;
+  // Submitted calls waiting for their returns, in the order they were sent.
+  std::deque<std::pair<uint64_t, RPCSession::FAsyncCallback>> pending_;
+  // The id of the next submitted call.
+  uint64_t next_request_id_{1};
   // syscall remote with specified function code.
   PackedFunc syscall_remote_;
   // The name of the session.
@@ -44,63 +44,108 @@ class RPCWrappedFunc : public Object {
   RPCWrappedFunc(void* handle, std::shared_ptr<RPCSession> sess) : handle_(handle), sess_(sess) {}
 
   void operator()(TVMArgs args, TVMRetValue* rv) const {
-    std::vector<TVMValue> values(args.values, args.values + args.size());
-    std::vector<int> type_codes(args.type_codes, args.type_codes + args.size());
+    std::vector<TVMValue> values;
+    std::vector<int> type_codes;
     std::vector<std::unique_ptr<DLTensor>> temp_dltensors;
+    this->RemapArgs(args, &values, &type_codes, &temp_dltensors);
+    auto set_return = [this, rv](TVMArgs args) { this->WrapRemoteReturnToValue(args, rv); };
+    sess_->CallFunc(handle_, values.data(), type_codes.data(), args.size(), set_return);
+  }
+
+  /*!
+   * \brief Submit a call to the remote function without waiting for its return.
+   * \param self The wrapped function, kept alive until the call returns.
+   * \param args The arguments.
+   * \return A function that waits for the call and returns its return value.
+   */
+  static PackedFunc Submit(std::shared_ptr<RPCWrappedFunc> self, TVMArgs args) {
+    std::vector<TVMValue> values;
+    std::vector<int> type_codes;
+    std::vector<std::unique_ptr<DLTensor>> temp_dltensors;
+    self->RemapArgs(args, &values, &type_codes, &temp_dltensors);
+
+    struct CallState {
+      bool done{false};
+      std::string error;
+      TVMRetValue ret;
+    };
+    auto state = std::make_shared<CallState>();
+    auto callback = [self, state](RPCCode status, TVMArgs ret_args) {
+      state->done = true;
+      if (status == RPCCode::kException) {
+        state->error = ret_args[0].operator std::string();
+      } else {
+        self->WrapRemoteReturnToValue(ret_args, &state->ret);
+      }
+    };
+    uint64_t call_id = self->sess_->SubmitCallFunc(self->handle_, values.data(),
+                                                   type_codes.data(), args.size(), callback);
+    return PackedFunc([self, state, call_id](TVMArgs args, TVMRetValue* rv) {
+      if (!state->done) self->sess_->WaitCall(call_id);
+      CHECK(state->done) << "The submitted RPC call did not return";
+      // rethrow the error as the synchronous call would have raised it
+      if (!state->error.empty()) throw dmlc::Error(state->error);
+      *rv = state->ret;
+    });
+  }
+
+  ~RPCWrappedFunc() {
+    try {
+      sess_->FreeHandle(handle_, kTVMPackedFuncHandle);
+    } catch (const dmlc::Error& e) {
+      // fault tolerance to remote close
+    }
+  }
+
+ private:
+  // remote function handle
+  void* handle_{nullptr};
+  // pointer to the session.
+  std::shared_ptr<RPCSession> sess_;
 
+  // Translate the arguments to their remote variant.
+  // The remote views of the tensors are kept in temp_dltensors.
+  void RemapArgs(TVMArgs args, std::vector<TVMValue>* values, std::vector<int>* type_codes,
+                 std::vector<std::unique_ptr<DLTensor>>* temp_dltensors) const {
+    values->assign(args.values, args.values + args.size());
+    type_codes->assign(args.type_codes, args.type_codes + args.size());
     // scan and check whether we need rewrite these arguments
     // to their remote variant.
     for (int i = 0; i < args.size(); ++i) {
       if (args[i].IsObjectRef<String>()) {
         String str = args[i];
-        type_codes[i] = kTVMStr;
-        values[i].v_str = str.c_str();
+        (*type_codes)[i] = kTVMStr;
+        (*values)[i].v_str = str.c_str();
         continue;
       }
-      int tcode = type_codes[i];
+      int tcode = (*type_codes)[i];
       switch (tcode) {
         case kTVMDLTensorHandle:
         case kTVMNDArrayHandle: {
           // Pass NDArray as DLTensor, NDArray and DLTensor
           // are compatible to each other, just need to change the index.
-          type_codes[i] = kTVMDLTensorHandle;
+          (*type_codes)[i] = kTVMDLTensorHandle;
           // translate to a remote view of DLTensor
-          auto dptr = std::make_unique<DLTensor>(*static_cast<DLTensor*>(values[i].v_handle));
+          auto dptr = std::make_unique<DLTensor>(*static_cast<DLTensor*>((*values)[i].v_handle));
           dptr->ctx = RemoveSessMask(dptr->ctx);
           dptr->data = static_cast<RemoteSpace*>(dptr->data)->data;
-          values[i].v_handle = dptr.get();
-          temp_dltensors.emplace_back(std::move(dptr));
+          (*values)[i].v_handle = dptr.get();
+          temp_dltensors->emplace_back(std::move(dptr));
           break;
         }
         case kTVMContext: {
-          values[i].v_ctx = RemoveSessMask(values[i].v_ctx);
+          (*values)[i].v_ctx = RemoveSessMask((*values)[i].v_ctx);
           break;
         }
         case kTVMPackedFuncHandle:
         case kTVMModuleHandle: {
-          values[i].v_handle = UnwrapRemoteValueToHandle(TVMArgValue(values[i], tcode));
+          (*values)[i].v_handle = UnwrapRemoteValueToHandle(TVMArgValue((*values)[i], tcode));
           break;
         }
       }
     }
-    auto set_return = [this, rv](TVMArgs args) { this->WrapRemoteReturnToValue(args, rv); };
-    sess_->CallFunc(handle_, values.data(), type_codes.data(), args.size(), set_return);
-  }
-
-  ~RPCWrappedFunc() {
-    try {
-      sess_->FreeHandle(handle_, kTVMPackedFuncHandle);
-    } catch (const dmlc::Error& e) {
-      // fault tolerance to remote close
-    }
   }
 
- private:
-  // remote function handle
-  void* handle_{nullptr};
-  // pointer to the session.
-  std::shared_ptr<RPCSession> sess_;
-
   // unwrap a remote value to the underlying handle.
   void* UnwrapRemoteValueToHandle(const TVMArgValue& arg) const;
   // wrap a remote return via Set
@@ -152,6 +197,16 @@ class RPCWrappedFunc : public Object {
   }
 };
 
+/*!
+ * \brief The body of a PackedFunc that calls a remote function,
+ *  a named type so that the remote function can be recovered from the PackedFunc.
+ */
+struct RPCWrappedFuncBody {
+  std::shared_ptr<RPCWrappedFunc> wf;
+
+  void operator()(TVMArgs args, TVMRetValue* rv) const { wf->operator()(args, rv); }
+};
+
 // RPC that represents a remote module session.
 class RPCModuleNode final : public ModuleNode {
  public:
@@ -230,8 +285,7 @@ class RPCModuleNode final : public ModuleNode {
 
   PackedFunc WrapRemoteFunc(RPCSession::PackedFuncHandle handle) {
     if (handle == nullptr) return PackedFunc();
-    auto wf = std::make_shared<RPCWrappedFunc>(handle, sess_);
-    return PackedFunc([wf](TVMArgs args, TVMRetValue* rv) { return wf->operator()(args, rv); });
+    return PackedFunc(RPCWrappedFuncBody{std::make_shared<RPCWrappedFunc>(handle, sess_)});
   }
 
   // The module handle
@@ -272,8 +326,7 @@ void RPCWrappedFunc::WrapRemoteReturnToValue(TVMArgs args, TVMRetValue* rv) cons
   if (tcode == kTVMPackedFuncHandle) {
     CHECK_EQ(args.size(), 2);
     void* handle = args[1];
-    auto wf = std::make_shared<RPCWrappedFunc>(handle, sess_);
-    *rv = PackedFunc([wf](TVMArgs args, TVMRetValue* rv) { return wf->operator()(args, rv); });
+    *rv = PackedFunc(RPCWrappedFuncBody{std::make_shared<RPCWrappedFunc>(handle, sess_)});
   } else if (tcode == kTVMModuleHandle) {
     CHECK_EQ(args.size(), 2);
     void* handle = args[1];
@@ -462,6 +515,20 @@ TVM_REGISTER_GLOBAL("rpc.ImportRemoteModule").set_body_typed([](Module parent, M
   static_cast<RPCModuleNode*>(parent.operator->())->ImportModule(child);
 });
 
+TVM_REGISTER_GLOBAL("rpc.SubmitCall").set_body([](TVMArgs args, TVMRetValue* rv) {
+  PackedFunc f = args[0];
+  TVMArgs call_args(args.values + 1, args.type_codes + 1, args.num_args - 1);
+  const auto* body = f.body().target<RPCWrappedFuncBody>();
+  if (body != nullptr) {
+    *rv = RPCWrappedFunc::Submit(body->wf, call_args);
+  } else {
+    // Not a remote function, call it right away.
+    TVMRetValue ret;
+    f.CallPacked(call_args, &ret);
+    *rv = PackedFunc([ret](TVMArgs args, TVMRetValue* rv) { *rv = ret; });
+  }
+});
+
 TVM_REGISTER_GLOBAL("rpc.SessTableIndex").set_body([](TVMArgs args, TVMRetValue* rv) {
   Module m = args[0];
   std::string tkey = m->type_key();
@@ -0,0 +1,233 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file rpc_payload.cc
+ * \brief Compression and caching of the payload of the copies to the remote.
+ *
+ *  The server side is a set of global functions, which a client looks up to
+ *  negotiate the features with the server:
+ *
+ *  - tvm.rpc.server.payload_codecs: the comma separated codecs the server decodes.
+ *  - tvm.rpc.server.payload_cache_load: fill a tensor from the cache of the server.
+ *  - tvm.rpc.server.payload_copy_to: fill a tensor from an optionally compressed payload,
+ *    and store the content in the cache.
+ *
+ *  The cache is a directory of files named by the keys of their content, it is
+ *  shared by the sessions of the server. It is enabled by TVM_RPC_PAYLOAD_CACHE_DIR,
+ *  and holds at most TVM_RPC_PAYLOAD_CACHE_BYTES bytes (1GB by default),
+ *  evicting the least recently used files.
+ */
+#include "rpc_payload.h"
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../support/lz4.h"
+
+namespace tvm {
+namespace runtime {
+
+std::string RPCPayloadKey(const void* data, size_t size) {
+  // Two independent 64 bit lanes over the 8 byte words of the content.
+  const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+  const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  uint64_t h1 = 0x27D4EB2F165667C5ULL ^ size;
+  uint64_t h2 = 0x165667B19E3779F9ULL + size;
+  const char* p = static_cast<const char*>(data);
+  size_t nwords = size / sizeof(uint64_t);
+  for (size_t i = 0; i < nwords; ++i) {
+    uint64_t w;
+    memcpy(&w, p + i * sizeof(uint64_t), sizeof(w));
+    h1 = (h1 ^ w) * kPrime1;
+    h1 = (h1 << 31) | (h1 >> 33);
+    h2 = (h2 + w) * kPrime2;
+    h2 ^= h2 >> 29;
+  }
+  for (size_t i = nwords * sizeof(uint64_t); i < size; ++i) {
+    uint8_t b = static_cast<uint8_t>(p[i]);
+    h1 = (h1 ^ b) * kPrime1;
+    h2 = (h2 + b) * kPrime2;
+  }
+  h1 ^= h2 >> 31;
+  h2 ^= h1 >> 27;
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%016llx%016llx-%llu", static_cast<unsigned long long>(h1),
+           static_cast<unsigned long long>(h2), static_cast<unsigned long long>(size));
+  return buf;
+}
+
+namespace {
+
+// Copy host bytes into a tensor of the server.
+void CopyBytesToTensor(DLTensor* to, const void* data, size_t nbytes) {
+  CHECK_EQ(GetDataSize(*to), nbytes) << "Payload size mismatch";
+  TVMContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  DeviceAPI* api = DeviceAPI::Get(to->ctx);
+  api->CopyDataFromTo(data, 0, to->data, static_cast<size_t>(to->byte_offset), nbytes, cpu_ctx,
+                      to->ctx, to->dtype, nullptr);
+  api->StreamSync(to->ctx, nullptr);
+}
+
+// The directory of the cache, empty when the cache is disabled.
+std::string PayloadCacheDir() {
+#ifndef _WIN32
+  const char* dir = getenv("TVM_RPC_PAYLOAD_CACHE_DIR");
+  if (dir != nullptr) return dir;
+#endif
+  return "";
+}
+
+// Keys are generated by RPCPayloadKey, refuse anything that could escape the directory.
+bool IsValidKey(const std::string& key) {
+  if (key.empty()) return false;
+  for (char c : key) {
+    if (!isxdigit(static_cast<unsigned char>(c)) && c != '-') return false;
+  }
+  return true;
+}
+
+#ifndef _WIN32
+// Evict the least recently used files until the cache fits in its budget.
+void EvictPayloadCache(const std::string& dir) {
+  size_t max_bytes = static_cast<size_t>(1) << 30;
+  if (const char* val = getenv("TVM_RPC_PAYLOAD_CACHE_BYTES")) {
+    max_bytes = static_cast<size_t>(atoll(val));
+  }
+  DIR* d = opendir(dir.c_str());
+  if (d == nullptr) return;
+  std::vector<std::pair<time_t, std::pair<std::string, size_t>>> files;
+  size_t total = 0;
+  while (dirent* entry = readdir(d)) {
+    std::string name = entry->d_name;
+    if (!IsValidKey(name)) continue;
+    std::string path = dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) continue;
+    files.push_back({st.st_mtime, {path, static_cast<size_t>(st.st_size)}});
+    total += static_cast<size_t>(st.st_size);
+  }
+  closedir(d);
+  std::sort(files.begin(), files.end());
+  for (const auto& f : files) {
+    if (total <= max_bytes) break;
+    if (unlink(f.second.first.c_str()) == 0) total -= f.second.second;
+  }
+}
+#endif
+
+// Load the content of key into the tensor, returns false if it is not cached.
+bool LoadPayloadCache(DLTensor* to, const std::string& key) {
+  std::string dir = PayloadCacheDir();
+  if (dir.empty() || !IsValidKey(key)) return false;
+  std::string path = dir + "/" + key;
+  std::ifstream fs(path, std::ios::in | std::ios::binary);
+  if (fs.fail()) return false;
+  std::string data((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+  if (data.size() != GetDataSize(*to) || RPCPayloadKey(data.data(), data.size()) != key) {
+    return false;
+  }
+  CopyBytesToTensor(to, data.data(), data.size());
+#ifndef _WIN32
+  // mark as recently used.
+  utime(path.c_str(), nullptr);
+#endif
+  return true;
+}
+
+// Store the content of key into the cache.
+void StorePayloadCache(const std::string& key, const void* data, size_t nbytes) {
+  std::string dir = PayloadCacheDir();
+  if (dir.empty() || !IsValidKey(key)) return;
+#ifndef _WIN32
+  mkdir(dir.c_str(), 0755);
+  // write to a temporary file and rename, so that concurrent sessions never see a partial file.
+  std::string path = dir + "/" + key;
+  std::string temp = path + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream fs(temp, std::ios::out | std::ios::binary);
+    if (fs.fail()) return;
+    fs.write(static_cast<const char*>(data), nbytes);
+    if (fs.fail()) {
+      fs.close();
+      unlink(temp.c_str());
+      return;
+    }
+  }
+  if (rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
+    return;
+  }
+  EvictPayloadCache(dir);
+#endif
+}
+
+}  // namespace
+
+TVM_REGISTER_GLOBAL("tvm.rpc.server.payload_codecs").set_body_typed([]() {
+  return std::string("lz4");
+});
+
+TVM_REGISTER_GLOBAL("tvm.rpc.server.payload_cache_load")
+    .set_body_typed([](DLTensor* to, std::string key) { return LoadPayloadCache(to, key); });
+
+TVM_REGISTER_GLOBAL("tvm.rpc.server.payload_copy_to").set_body([](TVMArgs args, TVMRetValue* rv) {
+  DLTensor* to = args[0];
+  std::string key = args[1];
+  std::string codec = args[2];
+  CHECK_EQ(args.type_codes[3], kTVMBytes) << "Expect the payload as bytes";
+  const TVMByteArray* payload = static_cast<TVMByteArray*>(args.values[3].v_handle);
+  const void* data = payload->data;
+  size_t nbytes = payload->size;
+  std::string decoded;
+  if (codec == "lz4") {
+    decoded.resize(GetDataSize(*to));
+    CHECK(support::LZ4Decompress(payload->data, payload->size, &decoded[0], decoded.size()))
+        << "Corrupted lz4 payload";
+    data = decoded.data();
+    nbytes = decoded.size();
+  } else {
+    CHECK(codec.empty()) << "Unknown payload codec " << codec;
+  }
+  CopyBytesToTensor(to, data, nbytes);
+  if (!key.empty()) StorePayloadCache(key, data, nbytes);
+});
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file rpc_payload.h
+ * \brief Compression and caching of the payload of the copies to the remote.
+ */
+#ifndef TVM_RUNTIME_RPC_RPC_PAYLOAD_H_
+#define TVM_RUNTIME_RPC_RPC_PAYLOAD_H_
+
+#include <cstddef>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Copies to the remote of at least this size are compressed or cached
+ *  when the session enables it.
+ */
+constexpr size_t kRPCPayloadMinBytes = 64 * 1024;
+
+/*!
+ * \brief Get the key of a payload in the cache of the server.
+ * \param data The data pointer.
+ * \param size The size of the data.
+ * \return The key, a 128 bit hash of the content followed by its size.
+ */
+std::string RPCPayloadKey(const void* data, size_t size);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_RPC_RPC_PAYLOAD_H_
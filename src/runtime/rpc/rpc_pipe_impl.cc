@@ -19,21 +19,26 @@
 
 /*!
  * \file rpc_pipe_impl.cc
- * \brief Pipe-based RPC channel.
+ * \brief Pipe and shared memory based RPC channels to a server in a child process.
  */
 // Linux only for now, as linux is the most common usecase.
 #if defined(__linux__) || defined(__ANDROID__)
 
 #include <errno.h>
 #include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <tvm/runtime/registry.h>
 #include <unistd.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 
 #include "../../support/pipe.h"
+#include "../../support/shm_ring_buffer.h"
 #include "rpc_endpoint.h"
 #include "rpc_local_session.h"
 
@@ -75,33 +80,92 @@ class PipeChannel final : public RPCChannel {
   pid_t child_pid_;
 };
 
-Module CreatePipeClient(std::vector<std::string> cmd) {
-  int parent2child[2];
-  int child2parent[2];
-  CHECK_EQ(pipe(parent2child), 0);
-  CHECK_EQ(pipe(child2parent), 0);
+/*!
+ * \brief Channel over a pair of rings in memory shared with the child process,
+ *  which saves the copies of the data into and out of the kernel pipes.
+ */
+class ShmChannel final : public RPCChannel {
+ public:
+  explicit ShmChannel(void* memory, size_t capacity, pid_t child_pid)
+      : memory_(memory),
+        capacity_(capacity),
+        child_pid_(child_pid),
+        send_ring_(memory, capacity),
+        recv_ring_(static_cast<char*>(memory) + support::ShmRingBuffer::MemorySize(capacity),
+                   capacity) {}
 
-  int parent_read = child2parent[0];
-  int parent_write = parent2child[1];
-  int child_read = parent2child[0];
-  int child_write = child2parent[1];
+  ~ShmChannel() { Close(); }
+
+  size_t Send(const void* data, size_t size) final {
+    size_t n = send_ring_.Write(data, size, [this]() { return this->ChildAlive(); });
+    if (n == 0 && size != 0) {
+      LOG(FATAL) << "Shared memory write error";
+    }
+    return n;
+  }
 
+  size_t Recv(void* data, size_t size) final {
+    return recv_ring_.Read(data, size, [this]() { return this->ChildAlive(); });
+  }
+
+  void Close() {
+    send_ring_.Close();
+    recv_ring_.Close();
+    munmap(memory_, 2 * support::ShmRingBuffer::MemorySize(capacity_));
+    kill(child_pid_, SIGKILL);
+  }
+
+ private:
+  bool ChildAlive() const { return waitpid(child_pid_, nullptr, WNOHANG) == 0; }
+
+  void* memory_;
+  size_t capacity_;
+  pid_t child_pid_;
+  support::ShmRingBuffer send_ring_;
+  support::ShmRingBuffer recv_ring_;
+};
+
+/*!
+ * \brief Fork and execute cmd followed by extra_args in the child.
+ * \param cmd The command.
+ * \param extra_args The arguments appended to the command.
+ * \param parent_fds The descriptors the child closes before executing.
+ * \return The pid of the child.
+ */
+static pid_t ForkExec(std::vector<std::string> cmd, std::vector<std::string> extra_args,
+                      const std::vector<int>& parent_fds) {
   pid_t pid = fork();
   if (pid == 0) {
     // child process
-    close(parent_read);
-    close(parent_write);
-    std::string sread_pipe = std::to_string(child_read);
-    std::string swrite_pipe = std::to_string(child_write);
+    for (int fd : parent_fds) {
+      close(fd);
+    }
     std::vector<char*> argv;
     for (auto& str : cmd) {
       argv.push_back(dmlc::BeginPtr(str));
     }
-    argv.push_back(dmlc::BeginPtr(sread_pipe));
-    argv.push_back(dmlc::BeginPtr(swrite_pipe));
+    for (auto& str : extra_args) {
+      argv.push_back(dmlc::BeginPtr(str));
+    }
     argv.push_back(nullptr);
     execvp(argv[0], &argv[0]);
   }
+  return pid;
+}
+
+Module CreatePipeClient(std::vector<std::string> cmd) {
+  int parent2child[2];
+  int child2parent[2];
+  CHECK_EQ(pipe(parent2child), 0);
+  CHECK_EQ(pipe(child2parent), 0);
+
+  int parent_read = child2parent[0];
+  int parent_write = parent2child[1];
+  int child_read = parent2child[0];
+  int child_write = child2parent[1];
+
+  pid_t pid = ForkExec(cmd, {std::to_string(child_read), std::to_string(child_write)},
+                       {parent_read, parent_write});
   // parent process
   close(child_read);
   close(child_write);
@@ -113,6 +177,37 @@ Module CreatePipeClient(std::vector<std::string> cmd) {
   return CreateRPCSessionModule(CreateClientSession(endpt));
 }
 
+/*!
+ * \brief Create a client to a server in a child process, communicating over shared memory.
+ *
+ *  The command is executed with the arguments "--shm <fd>", where fd is the descriptor of
+ *  the shared memory. The memory holds the ring from the parent to the child,
+ *  followed by the ring from the child to the parent.
+ *
+ * \param cmd The command of the server.
+ * \param capacity The capacity of each ring in bytes.
+ * \return The session module.
+ */
+Module CreateShmClient(std::vector<std::string> cmd, size_t capacity) {
+  size_t nbytes = 2 * support::ShmRingBuffer::MemorySize(capacity);
+  // Not close-on-exec, so that the server inherits the descriptor.
+  int fd = static_cast<int>(syscall(SYS_memfd_create, "tvm_rpc_shm", 0));
+  CHECK_GE(fd, 0) << "Cannot create shared memory: " << strerror(errno);
+  CHECK_EQ(ftruncate(fd, static_cast<off_t>(nbytes)), 0)
+      << "Cannot allocate shared memory: " << strerror(errno);
+  void* memory = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  CHECK(memory != MAP_FAILED) << "Cannot map shared memory: " << strerror(errno);
+
+  pid_t pid = ForkExec(cmd, {"--shm", std::to_string(fd)}, {});
+  // parent process
+  close(fd);
+
+  auto endpt = RPCEndpoint::Create(
+      std::unique_ptr<ShmChannel>(new ShmChannel(memory, capacity, pid)), "shm", "shm");
+  endpt->InitRemoteSession(TVMArgs(nullptr, nullptr, 0));
+  return CreateRPCSessionModule(CreateClientSession(endpt));
+}
+
 TVM_REGISTER_GLOBAL("rpc.CreatePipeClient").set_body([](TVMArgs args, TVMRetValue* rv) {
   std::vector<std::string> cmd;
   for (int i = 0; i < args.size(); ++i) {
@@ -121,6 +216,15 @@ TVM_REGISTER_GLOBAL("rpc.CreatePipeClient").set_body([](TVMArgs args, TVMRetValu
   *rv = CreatePipeClient(cmd);
 });
 
+TVM_REGISTER_GLOBAL("rpc.CreateShmClient").set_body([](TVMArgs args, TVMRetValue* rv) {
+  size_t capacity = static_cast<size_t>(args[0].operator int64_t());
+  std::vector<std::string> cmd;
+  for (int i = 1; i < args.size(); ++i) {
+    cmd.push_back(args[i].operator std::string());
+  }
+  *rv = CreateShmClient(cmd, capacity);
+});
+
 }  // namespace runtime
 }  // namespace tvm
 #endif
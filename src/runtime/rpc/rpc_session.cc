@@ -51,6 +51,15 @@ void RPCSession::AsyncCallFunc(PackedFuncHandle func, const TVMValue* arg_values
   }
 }
 
+uint64_t RPCSession::SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                                    const int* arg_type_codes, int num_args,
+                                    FAsyncCallback callback) {
+  RPCSession::AsyncCallFunc(func, arg_values, arg_type_codes, num_args, callback);
+  return 0;
+}
+
+void RPCSession::WaitCall(uint64_t call_id) {}
+
 void RPCSession::AsyncCopyToRemote(void* local_from, size_t local_from_offset, void* remote_to,
                                    size_t remote_to_offset, size_t nbytes, TVMContext remote_ctx_to,
                                    DLDataType type_hint, RPCSession::FAsyncCallback callback) {
@@ -125,6 +125,31 @@ class RPCSession {
                         const int* arg_type_codes, int num_args,
                         const FEncodeReturn& fencode_return) = 0;
 
+  /*!
+   * \brief Call into a remote Packed function without waiting for its return.
+   *
+   *  Sessions that can pipeline the calls send the request and return right away,
+   *  the callback is called by WaitCall or by any later request to the session.
+   *  The default implementation calls the function synchronously,
+   *  and the callback is called before SubmitCallFunc returns.
+   *
+   * \param func The function handle.
+   * \param arg_values The argument values.
+   * \param arg_type_codes the type codes of the argument.
+   * \param num_args Number of arguments.
+   * \param callback The callback to pass the return value or exception.
+   * \return The id of the submitted call.
+   */
+  virtual uint64_t SubmitCallFunc(PackedFuncHandle func, const TVMValue* arg_values,
+                                  const int* arg_type_codes, int num_args,
+                                  FAsyncCallback callback);
+
+  /*!
+   * \brief Wait until the callback of a submitted call is called.
+   * \param call_id The id returned by SubmitCallFunc.
+   */
+  virtual void WaitCall(uint64_t call_id);
+
   /*!
    * \brief Copy bytes into remote array content.
    * \param local_from The source host data.
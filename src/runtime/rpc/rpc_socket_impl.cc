@@ -53,6 +53,13 @@ class SockChannel final : public RPCChannel {
     }
     return static_cast<size_t>(n);
   }
+  size_t SendV(const void* const* data, const size_t* size, int num) final {
+    ssize_t n = sock_.SendV(data, size, num);
+    if (n == -1) {
+      support::Socket::Error("SockChannel::SendV");
+    }
+    return static_cast<size_t>(n);
+  }
   size_t Recv(void* data, size_t size) final {
     ssize_t n = sock_.Recv(data, size);
     if (n == -1) {
@@ -40,8 +40,12 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "../support/stealable_task_range.h"
+#include "trace.h"
+
 const constexpr int kL1CacheBytes = 64;
 
 namespace tvm {
@@ -58,11 +62,40 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+constexpr int kDefaultChunksPerWorker = 4;
+
+}  // namespace
+
+/*! \brief The policy used to distribute the tasks of a parallel launch to workers. */
+enum ScheduleMode : int {
+  /*! \brief Task i always runs on worker i. */
+  kStaticSchedule = 0,
+  /*!
+   * \brief Over-decompose the launch into more tasks than workers, and let
+   *  idle workers steal pending tasks from the busy ones.
+   */
+  kWorkStealingSchedule = 1,
+};
+
+namespace {
+
+ScheduleMode GetDefaultScheduleMode() {
+  const char* val = getenv("TVM_THREAD_POOL_SCHEDULE");
+  if (val && std::string(val) == "work_stealing") {
+    return kWorkStealingSchedule;
+  }
+  return kStaticSchedule;
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
 
+using support::StealableTaskRange;
+
+class ThreadPool;
+
 /*!
  * \brief Thread local master environment.
  */
@@ -74,17 +107,20 @@ class ParallelLauncher {
     this->cdata = cdata;
     this->flambda = flambda;
     this->env.num_task = num_task;
+    this->work_stealing = false;
     has_error_.store(false);
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    if (need_sync && num_task > num_sync_counter_) {
+      delete[] sync_counter_;
+      // one extra slot records whether the barrier is ever used.
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride + 1];
+      num_sync_counter_ = num_task;
     }
     if (need_sync) {
-      for (int i = 0; i < num_task; ++i) {
+      for (int i = 0; i <= num_task; ++i) {
         sync_counter_[i * kSyncStride].store(0, std::memory_order_relaxed);
       }
       this->env.sync_handle = sync_counter_;
@@ -92,6 +128,64 @@ class ParallelLauncher {
       this->env.sync_handle = nullptr;
     }
   }
+  /*!
+   * \brief Distribute the tasks to the workers in contiguous blocks,
+   *  to be consumed with RunStealingWorker.
+   * \param num_workers The number of workers taking part in the launch.
+   */
+  void InitWorkStealing(int num_workers) {
+    CHECK(env.sync_handle == nullptr) << "Work stealing launch cannot use parallel barrier";
+    this->work_stealing = true;
+    if (static_cast<size_t>(num_workers) > task_ranges_.size()) {
+      task_ranges_ = std::vector<StealableTaskRange>(num_workers);
+    }
+    num_stealing_workers_ = num_workers;
+    num_active_stealers_.store(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+      uint32_t begin = static_cast<uint64_t>(env.num_task) * i / num_workers;
+      uint32_t end = static_cast<uint64_t>(env.num_task) * (i + 1) / num_workers;
+      task_ranges_[i].Reset(begin, end);
+    }
+  }
+  /*!
+   * \brief Run tasks of a work stealing launch until no pending task is left.
+   * \param worker_id The index of the range owned by the calling worker.
+   */
+  void RunStealingWorker(int worker_id) {
+    int task_id;
+    while (true) {
+      while (task_ranges_[worker_id].PopFront(&task_id)) {
+        RunTask(task_id);
+      }
+      // our own range is drained, try to steal from the others.
+      bool stolen = false;
+      for (int k = 1; k < num_stealing_workers_ && !stolen; ++k) {
+        uint32_t begin, end;
+        int victim = (worker_id + k) % num_stealing_workers_;
+        if (task_ranges_[victim].StealBack(&begin, &end)) {
+          // run the first stolen task and expose the rest to the others.
+          task_ranges_[worker_id].Reset(begin + 1, end);
+          RunTask(static_cast<int>(begin));
+          stolen = true;
+        }
+      }
+      // ranges only shrink during a launch, nothing is left to steal.
+      if (!stolen) return;
+    }
+  }
+  // Signal that one worker has left RunStealingWorker and no longer uses the launcher.
+  void SignalStealerExit() { num_active_stealers_.fetch_sub(1); }
+  // Wait all workers to leave RunStealingWorker, so the ranges can be reused.
+  void WaitForStealingWorkers() {
+    while (num_active_stealers_.load() != 0) {
+      tvm::runtime::threading::Yield();
+    }
+  }
+  /*! \return Whether the barrier was called during the last synchronized launch. */
+  bool BarrierUsed() const {
+    return env.sync_handle != nullptr &&
+           sync_counter_[env.num_task * kSyncStride].load(std::memory_order_relaxed) != 0;
+  }
   ~ParallelLauncher() { delete[] sync_counter_; }
   // Wait n jobs to finish
   int WaitForJobs() {
@@ -117,6 +211,14 @@ class ParallelLauncher {
   }
   // Signal that one job has finished.
   void SignalJobFinish() { num_pending_.fetch_sub(1); }
+  // Run one task and signal its completion.
+  void RunTask(int task_id) {
+    if ((*flambda)(task_id, &env, cdata) == 0) {
+      SignalJobFinish();
+    } else {
+      SignalJobError(task_id);
+    }
+  }
   // Get thread local version of the store.
   static ParallelLauncher* ThreadLocal() { return dmlc::ThreadLocalStore<ParallelLauncher>::Get(); }
   // The parallel lambda
@@ -126,8 +228,18 @@ class ParallelLauncher {
   // Local env
   TVMParallelGroupEnv env;
   // Whether this thread is worker of the pool.
-  // used to prevent recursive launch.
+  // used to redirect recursive launch to the owner pool.
   bool is_worker{false};
+  // The pool owning this thread when it is a worker.
+  ThreadPool* owner_pool{nullptr};
+  // The thread pool partition bound to this thread.
+  ThreadPool* partition_pool{nullptr};
+  // The name of the bound partition.
+  std::string partition;
+  // Whether this thread is running a launch as the master.
+  bool in_launch{false};
+  // Whether the current launch uses the work stealing schedule.
+  bool work_stealing{false};
 
  private:
   // The pending jobs.
@@ -136,8 +248,16 @@ class ParallelLauncher {
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // The number of tasks the counter page can host.
+  int num_sync_counter_{0};
   // The error message
   std::vector<std::string> par_errors_;
+  // The task ranges of each worker in work stealing launches.
+  std::vector<StealableTaskRange> task_ranges_;
+  // The number of workers taking part in the current work stealing launch.
+  int num_stealing_workers_{0};
+  // The number of workers still inside RunStealingWorker.
+  std::atomic<int> num_active_stealers_{0};
 };
 
 /*! \brief Lock-free single-producer-single-consumer queue for each thread */
@@ -195,6 +315,32 @@ class SpscTaskQueue {
     return true;
   }
 
+  /*!
+   * \brief Try to reserve the idle consumer for a new task, so that
+   *  at most one producer pushes to the queue at a time.
+   * \return Whether the consumer was idle and is now reserved.
+   */
+  bool TryReserve() {
+    bool idle = false;
+    return !reserved_.load(std::memory_order_relaxed) &&
+           reserved_.compare_exchange_strong(idle, true, std::memory_order_acquire);
+  }
+
+  /*!
+   * \brief Reserve the consumer, waiting for it to become idle.
+   */
+  void Reserve() {
+    while (!TryReserve()) {
+      tvm::runtime::threading::Yield();
+    }
+  }
+
+  /*!
+   * \brief Mark the consumer as idle, called by the consumer once it
+   *  no longer touches the launcher of the popped task.
+   */
+  void Release() { reserved_.store(false, std::memory_order_release); }
+
   /*!
    * \brief Signal to terminate the worker.
    */
@@ -248,6 +394,10 @@ class SpscTaskQueue {
   // signal for exit now
   std::atomic<bool> exit_now_{false};
 
+  cache_line_pad_t pad5_;
+  // whether the consumer is reserved by a producer
+  std::atomic<bool> reserved_{false};
+
   // internal mutex
   std::mutex mutex_;
   // cv for consumer
@@ -258,20 +408,24 @@ class SpscTaskQueue {
 class ThreadPool {
  public:
   ThreadPool() : num_workers_(tvm::runtime::threading::MaxConcurrency()) {
-    for (int i = 0; i < num_workers_; ++i) {
-      // The SpscTaskQueue only hosts ONE item at a time
-      queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
-    }
     const char* exclude_worker0 = getenv("TVM_EXCLUDE_WORKER0");
     if (exclude_worker0 && atoi(exclude_worker0) == 0) {
       exclude_worker0_ = false;
     }
-    threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
-        new tvm::runtime::threading::ThreadGroup(
-            num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
-            exclude_worker0_ /* include_main_thread */));
+    StartWorkers();
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
   }
+  /*!
+   * \brief Create a pool shared by all the threads bound to a partition.
+   *  All the tasks run on the workers of the pool, so that the affinity
+   *  of the launching threads is left untouched.
+   * \param num_workers The number of workers of the pool.
+   */
+  explicit ThreadPool(int num_workers)
+      : num_workers_(num_workers), exclude_worker0_(false), shared_(true) {
+    StartWorkers();
+    num_workers_used_ = num_workers_;
+  }
   ~ThreadPool() {
     for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
       q->SignalForKill();
@@ -280,8 +434,79 @@ class ThreadPool {
   }
   int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
-    CHECK(!launcher->is_worker)
-        << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    if (launcher->is_worker || launcher->in_launch) {
+      TVM_TRACE_SPAN(kParallel, "nested_launch", num_task);
+      return LaunchNested(flambda, cdata, num_task);
+    }
+    TVM_TRACE_SPAN(kParallel, "launch", num_task);
+    // a shared pool serves one launching thread at a time.
+    std::unique_lock<std::mutex> lock(launch_mutex_, std::defer_lock);
+    if (shared_) lock.lock();
+    launcher->in_launch = true;
+    int res = LaunchTopLevel(launcher, flambda, cdata, num_task, need_sync);
+    launcher->in_launch = false;
+    return res;
+  }
+
+  static ThreadPool* ThreadLocal() {
+    ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
+    if (launcher->partition_pool != nullptr) return launcher->partition_pool;
+    // launches from the workers go to the pool owning them
+    if (launcher->owner_pool != nullptr) return launcher->owner_pool;
+    return dmlc::ThreadLocalStore<ThreadPool>::Get();
+  }
+
+  int NumThreads() const { return num_workers_used_; }
+
+  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads) {
+    // this will also reset the affinity of the ThreadGroup
+    // may use less than the MaxConcurrency number of workers
+    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_);
+    // if MaxConcurrency restricted the number of workers (e.g., due to
+    // hyperthreading), respect the restriction
+    num_workers_used_ = std::min(num_workers_, num_workers_used_);
+  }
+
+  void UpdateWorkerConfiguration(const std::vector<unsigned int>& cpus) {
+    num_workers_used_ = threads_->Configure(cpus, exclude_worker0_);
+  }
+
+  void UpdateScheduleConfiguration(ScheduleMode mode, int chunks_per_worker) {
+    CHECK(mode == kStaticSchedule || mode == kWorkStealingSchedule)
+        << "Unknown thread pool schedule mode " << static_cast<int>(mode);
+    schedule_mode_ = mode;
+    if (chunks_per_worker > 0) {
+      chunks_per_worker_ = chunks_per_worker;
+    }
+  }
+
+  void UpdateNestedConfiguration(int max_fan_out) {
+    CHECK_GE(max_fan_out, 0) << "Nested fan-out must be non-negative";
+    max_nested_fan_out_ = max_fan_out;
+  }
+
+ private:
+  void StartWorkers() {
+    for (int i = 0; i < num_workers_; ++i) {
+      // The SpscTaskQueue only hosts ONE item at a time
+      queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
+    }
+    schedule_mode_ = GetDefaultScheduleMode();
+    threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
+        new tvm::runtime::threading::ThreadGroup(
+            num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
+            exclude_worker0_ /* include_main_thread */));
+  }
+  int LaunchTopLevel(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata,
+                     int num_task, int need_sync) {
+    if (schedule_mode_ == kWorkStealingSchedule && num_workers_used_ > 1) {
+      // Lambdas are launched with the barrier available until they are known
+      // not to use it, because the barrier requires all tasks to run concurrently.
+      auto it = lambda_uses_barrier_.find(flambda);
+      if (it != lambda_uses_barrier_.end() && !it->second) {
+        return LaunchWorkStealing(launcher, flambda, cdata, num_task);
+      }
+    }
     if (num_task == 0) {
       num_task = num_workers_used_;
     }
@@ -296,6 +521,7 @@ class ThreadPool {
     // if worker0 is taken by the master, queues_[0] is abandoned
     for (int i = exclude_worker0_; i < num_task; ++i) {
       tsk.task_id = i;
+      queues_[i]->Reserve();
       queues_[i]->Push(tsk);
     }
     // use the master thread to run task 0
@@ -308,35 +534,108 @@ class ThreadPool {
       }
     }
     int res = launcher->WaitForJobs();
+    if (schedule_mode_ == kWorkStealingSchedule && need_sync != 0) {
+      lambda_uses_barrier_[flambda] = launcher->BarrierUsed();
+    }
     return res;
   }
-
-  static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
-
-  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads) {
-    // this will also reset the affinity of the ThreadGroup
-    // may use less than the MaxConcurrency number of workers
-    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_);
-    // if MaxConcurrency restricted the number of workers (e.g., due to
-    // hyperthreading), respect the restriction
-    num_workers_used_ = std::min(num_workers_, num_workers_used_);
+  // Launch the job over-decomposed, letting idle workers steal the pending tasks.
+  int LaunchWorkStealing(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata,
+                         int num_task) {
+    if (num_task == 0) {
+      num_task = num_workers_used_ * chunks_per_worker_;
+    }
+    int num_workers = std::min(num_task, num_workers_used_);
+    launcher->Init(flambda, cdata, num_task, false);
+    launcher->InitWorkStealing(num_workers);
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    // the task id of the start message is the range owned by the worker.
+    for (int i = exclude_worker0_; i < num_workers; ++i) {
+      tsk.task_id = i;
+      queues_[i]->Reserve();
+      queues_[i]->Push(tsk);
+    }
+    if (exclude_worker0_) {
+      launcher->RunStealingWorker(0);
+      launcher->SignalStealerExit();
+    }
+    int res = launcher->WaitForJobs();
+    launcher->WaitForStealingWorkers();
+    return res;
+  }
+  /*!
+   * \brief Launch a job from inside a running task.
+   *
+   *  The calling thread runs the job together with the workers of the pool
+   *  that are idle at the time of the call, instead of spawning new threads.
+   *  The job falls back to run serially on the calling thread when all
+   *  workers are busy. The barrier is not available in nested launches.
+   */
+  int LaunchNested(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    // the thread local launcher may be in use by the enclosing launch.
+    ParallelLauncher launcher;
+    int max_fan_out = num_task == 0 ? num_workers_used_ : num_task;
+    if (max_nested_fan_out_ != 0) {
+      max_fan_out = std::min(max_fan_out, max_nested_fan_out_);
+    }
+    std::vector<int> helpers;
+    for (int i = exclude_worker0_;
+         i < num_workers_used_ && static_cast<int>(helpers.size()) + 1 < max_fan_out; ++i) {
+      if (queues_[i]->TryReserve()) {
+        helpers.push_back(i);
+      }
+    }
+    int num_workers = static_cast<int>(helpers.size()) + 1;
+    if (num_task == 0) {
+      num_task = num_workers * chunks_per_worker_;
+    }
+    launcher.Init(flambda, cdata, num_task, false);
+    launcher.InitWorkStealing(num_workers);
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = &launcher;
+    // the calling thread owns range 0
+    for (int k = 0; k < static_cast<int>(helpers.size()); ++k) {
+      tsk.task_id = k + 1;
+      queues_[helpers[k]]->Push(tsk);
+    }
+    launcher.RunStealingWorker(0);
+    launcher.SignalStealerExit();
+    int res = launcher.WaitForJobs();
+    launcher.WaitForStealingWorkers();
+    return res;
   }
-
- private:
   // Internal worker function.
   void RunWorker(int worker_id) {
     SpscTaskQueue* queue = queues_[worker_id].get();
     SpscTaskQueue::Task task;
     ParallelLauncher::ThreadLocal()->is_worker = true;
+    ParallelLauncher::ThreadLocal()->owner_pool = this;
     // Initialize the spin count (from envvar TVM_THREAD_POOL_SPIN_COUNT) on
     // the global first use of the ThreadPool.
     // TODO(tulloch): should we make this configurable via standard APIs?
     static size_t spin_count = GetSpinCount();
     while (queue->Pop(&task, spin_count)) {
       CHECK(task.launcher != nullptr);
+      if (task.launcher->work_stealing) {
+        {
+          TVM_TRACE_SPAN(kTask, "stealing_worker", task.task_id);
+          task.launcher->RunStealingWorker(task.task_id);
+        }
+        // release the worker before the producer is allowed to reuse the launcher.
+        queue->Release();
+        task.launcher->SignalStealerExit();
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
-      if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
+      int ret;
+      {
+        TVM_TRACE_SPAN(kTask, "task", task.task_id);
+        ret = (*task.launcher->flambda)(task.task_id, penv, cdata);
+      }
+      queue->Release();
+      if (ret == 0) {
         task.launcher->SignalJobFinish();
       } else {
         task.launcher->SignalJobError(task.task_id);
@@ -348,10 +647,93 @@ class ThreadPool {
   int num_workers_used_;
   // if or not to exclude worker 0 and use master to run task 0
   bool exclude_worker0_{true};
+  // whether the pool is a partition shared by several launching threads
+  bool shared_{false};
+  // serializes the launches of a shared pool
+  std::mutex launch_mutex_;
+  // the policy used to distribute tasks to workers
+  ScheduleMode schedule_mode_{kStaticSchedule};
+  // number of tasks per worker when a work stealing launch picks the task count
+  int chunks_per_worker_{kDefaultChunksPerWorker};
+  // maximum number of threads running a nested launch, 0 means all workers
+  int max_nested_fan_out_{0};
+  // whether each launched lambda has been observed to call the parallel barrier
+  std::unordered_map<FTVMParallelLambda, bool> lambda_uses_barrier_;
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
+/*! \brief The named thread pool partitions, shared by all the threads of the process. */
+class ThreadPoolPartitionRegistry {
+ public:
+  /*!
+   * \brief Create or reconfigure a partition.
+   * \param name The name of the partition.
+   * \param mode The preferred CPU type, used when cpus is empty.
+   * \param nthreads The number of threads (0 = use all), used when cpus is empty.
+   * \param cpus The ids of the cores the workers are bound to.
+   */
+  void Configure(const std::string& name, threading::ThreadGroup::AffinityMode mode, int nthreads,
+                 const std::vector<unsigned int>& cpus) {
+    CHECK(!name.empty()) << "The name of a thread pool partition cannot be empty";
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<ThreadPool>& pool = pools_[name];
+    if (pool == nullptr) {
+      int num_workers = cpus.size() != 0 ? static_cast<int>(cpus.size())
+                                         : (nthreads != 0 ? nthreads : threading::MaxConcurrency());
+      pool.reset(new ThreadPool(num_workers));
+    }
+    if (cpus.size() != 0) {
+      pool->UpdateWorkerConfiguration(cpus);
+    } else {
+      pool->UpdateWorkerConfiguration(mode, nthreads);
+    }
+  }
+  /*!
+   * \brief Get a partition.
+   * \param name The name of the partition.
+   * \return The thread pool of the partition.
+   */
+  ThreadPool* Get(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(name);
+    CHECK(it != pools_.end()) << "Cannot find thread pool partition " << name;
+    return it->second.get();
+  }
+
+  static ThreadPoolPartitionRegistry* Global() {
+    // never destructed, the partitions may still be bound to threads at exit.
+    static ThreadPoolPartitionRegistry* inst = new ThreadPoolPartitionRegistry();
+    return inst;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<ThreadPool>> pools_;
+};
+
+namespace threading {
+
+std::string BindThreadPoolPartition(const std::string& name) {
+  ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
+  CHECK(!launcher->in_launch) << "Cannot change the thread pool partition during a launch";
+  ThreadPool* pool = name.empty() ? nullptr : ThreadPoolPartitionRegistry::Global()->Get(name);
+  std::string prev = launcher->partition;
+  launcher->partition_pool = pool;
+  launcher->partition = name;
+  return prev;
+}
+
+int NumThreads() {
+#if TVM_THREADPOOL_USE_OPENMP
+  return MaxConcurrency();
+#else
+  return ThreadPool::ThreadLocal()->NumThreads();
+#endif
+}
+
+}  // namespace threading
+
 TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRetValue* rv) {
   threading::ThreadGroup::AffinityMode mode =
       static_cast<threading::ThreadGroup::AffinityMode>(static_cast<int>(args[0]));
@@ -359,6 +741,52 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
   ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads);
 });
 
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_schedule")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      ScheduleMode mode = static_cast<ScheduleMode>(static_cast<int>(args[0]));
+      int chunks_per_worker = args.size() > 1 ? static_cast<int>(args[1]) : 0;
+      ThreadPool::ThreadLocal()->UpdateScheduleConfiguration(mode, chunks_per_worker);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_partition")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      std::string name = args[0];
+      threading::ThreadGroup::AffinityMode mode =
+          static_cast<threading::ThreadGroup::AffinityMode>(static_cast<int>(args[1]));
+      int nthreads = args[2];
+      std::vector<unsigned int> cpus;
+      for (int i = 3; i < args.size(); ++i) {
+        cpus.push_back(static_cast<int>(args[i]));
+      }
+      ThreadPoolPartitionRegistry::Global()->Configure(name, mode, nthreads, cpus);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_numa_partition")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      std::string name = args[0];
+      int node = args[1];
+      int nthreads = args.size() > 2 ? static_cast<int>(args[2]) : 0;
+      std::vector<unsigned int> cpus = threading::NumaNodeCpus(node);
+      CHECK(!cpus.empty()) << "Cannot find the cores of NUMA node " << node;
+      if (nthreads > 0 && nthreads < static_cast<int>(cpus.size())) {
+        cpus.resize(nthreads);
+      }
+      ThreadPoolPartitionRegistry::Global()->Configure(name, threading::ThreadGroup::kBig, 0,
+                                                       cpus);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.bind_threadpool_partition")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      *rv = threading::BindThreadPoolPartition(args[0]);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.num_threads").set_body_typed(threading::NumThreads);
+
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_nested").set_body([](TVMArgs args, TVMRetValue* rv) {
+  int max_fan_out = args[0];
+  ThreadPool::ThreadLocal()->UpdateNestedConfiguration(max_fan_out);
+});
+
 }  // namespace runtime
 }  // namespace tvm
 
@@ -387,6 +815,9 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
   using tvm::runtime::kSyncStride;
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
+  CHECK(sync_counter != nullptr) << "Parallel barrier is not available in this launch";
+  // record the use of barrier, see ThreadPool::Launch
+  sync_counter[num_task * kSyncStride].store(1, std::memory_order_relaxed);
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
   for (int i = 0; i < num_task; ++i) {
     if (i != task_id) {
@@ -25,7 +25,10 @@
 #include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <set>
+#include <string>
 #include <thread>
+#include <vector>
 #if defined(__linux__) || defined(__ANDROID__)
 #include <fstream>
 #include <sstream>
@@ -93,6 +96,16 @@ class ThreadGroup::Impl {
     return num_workers_used;
   }
 
+  int Configure(const std::vector<unsigned int>& cpus, bool exclude_worker0) {
+    CHECK(!cpus.empty()) << "Cannot bind workers to an empty set of cores";
+    int num_workers_used = std::min(num_workers_, static_cast<int>(cpus.size()));
+    const char* val = getenv("TVM_BIND_THREADS");
+    if (val == nullptr || atoi(val) == 1) {
+      SetAffinity(cpus, exclude_worker0);
+    }
+    return num_workers_used;
+  }
+
  private:
   // bind worker threads to disjoint cores
   // if worker 0 is offloaded to master, i.e. exclude_worker0 is true,
@@ -140,6 +153,23 @@ class ThreadGroup::Impl {
 #endif
   }
 
+  // bind worker i to the i-th core of the given list.
+  void SetAffinity(const std::vector<unsigned int>& cpus, bool exclude_worker0) {
+#if defined(__linux__) || defined(__ANDROID__)
+    for (unsigned i = 0; i < threads_.size(); ++i) {
+      unsigned core_id = cpus[(i + exclude_worker0) % cpus.size()];
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET(core_id, &cpuset);
+#if defined(__ANDROID__)
+      sched_setaffinity(threads_[i].native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+      pthread_setaffinity_np(threads_[i].native_handle(), sizeof(cpu_set_t), &cpuset);
+#endif
+    }
+#endif
+  }
+
   void SetMasterThreadFullCpuAffinity(bool reverse) {
 #if defined(__linux__) || defined(__ANDROID__)
     cpu_set_t cpuset;
@@ -235,8 +265,67 @@ int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0
   return impl_->Configure(mode, nthreads, exclude_worker0);
 }
 
+int ThreadGroup::Configure(const std::vector<unsigned int>& cpus, bool exclude_worker0) {
+  return impl_->Configure(cpus, exclude_worker0);
+}
+
 void Yield() { std::this_thread::yield(); }
 
+#if defined(__linux__) || defined(__ANDROID__)
+// Parse a sysfs cpu or node list such as "0-3,8-11".
+static std::vector<unsigned int> ReadIdList(const std::string& path) {
+  std::vector<unsigned int> ids;
+  std::ifstream ifs(path);
+  std::string list;
+  if (ifs.fail() || !std::getline(ifs, list)) return ids;
+  std::istringstream is(list);
+  std::string range;
+  while (std::getline(is, range, ',')) {
+    if (range.empty()) continue;
+    size_t dash = range.find('-');
+    unsigned int begin = static_cast<unsigned int>(std::stoul(range.substr(0, dash)));
+    unsigned int end = begin;
+    if (dash != std::string::npos) {
+      end = static_cast<unsigned int>(std::stoul(range.substr(dash + 1)));
+    }
+    for (unsigned int i = begin; i <= end; ++i) {
+      ids.push_back(i);
+    }
+  }
+  return ids;
+}
+#endif
+
+std::vector<int> NumaNodes() {
+  std::vector<int> nodes;
+#if defined(__linux__) || defined(__ANDROID__)
+  for (unsigned int node : ReadIdList("/sys/devices/system/node/online")) {
+    nodes.push_back(static_cast<int>(node));
+  }
+#endif
+  return nodes;
+}
+
+std::vector<unsigned int> NumaNodeCpus(int node) {
+  std::vector<unsigned int> cpus;
+#if defined(__linux__) || defined(__ANDROID__)
+  std::ostringstream path;
+  path << "/sys/devices/system/node/node" << node << "/cpulist";
+  // keep the first hardware thread of each core, like MaxConcurrency ignores hyper-threading.
+  std::set<unsigned int> siblings;
+  for (unsigned int cpu : ReadIdList(path.str())) {
+    if (siblings.count(cpu)) continue;
+    std::ostringstream siblings_path;
+    siblings_path << "/sys/devices/system/cpu/cpu" << cpu << "/topology/thread_siblings_list";
+    for (unsigned int sibling : ReadIdList(siblings_path.str())) {
+      siblings.insert(sibling);
+    }
+    cpus.push_back(cpu);
+  }
+#endif
+  return cpus;
+}
+
 int MaxConcurrency() {
   int max_concurrency = 1;
   const char* val = getenv("TVM_NUM_THREADS");
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file timeline.cc
+ * \brief Chrome trace timeline of runtime events.
+ */
+#include "timeline.h"
+
+#include <tvm/runtime/device_api.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+
+namespace {
+
+std::string EscapeJSON(const std::string& str) {
+  std::ostringstream os;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      os << ' ';
+    } else {
+      os << c;
+    }
+  }
+  return os.str();
+}
+
+}  // namespace
+
+void Timeline::AddSpan(const std::string& name, const std::string& category, TVMContext ctx,
+                       int stream, double begin, double end, EventArgs args) {
+  events_.push_back({name, category, 'X', ctx, stream, begin, end - begin, std::move(args)});
+}
+
+void Timeline::AddInstant(const std::string& name, const std::string& category, TVMContext ctx,
+                          int stream, EventArgs args) {
+  events_.push_back({name, category, 'i', ctx, stream, Now(), 0, std::move(args)});
+}
+
+void Timeline::AddInstant(const std::string& name, const std::string& category, TVMContext ctx,
+                          int stream, double ts, EventArgs args) {
+  events_.push_back({name, category, 'i', ctx, stream, ts, 0, std::move(args)});
+}
+
+void Timeline::Clear() {
+  events_.clear();
+  start_ = std::chrono::high_resolution_clock::now();
+}
+
+std::string Timeline::ToJSON() const {
+  // Every device gets its own trace process, numbered in order of appearance.
+  std::vector<TVMContext> devices;
+  auto pid_of = [&devices](TVMContext ctx) {
+    auto it = std::find_if(devices.begin(), devices.end(), [ctx](const TVMContext& other) {
+      return other.device_type == ctx.device_type && other.device_id == ctx.device_id;
+    });
+    if (it == devices.end()) {
+      devices.push_back(ctx);
+      return static_cast<int>(devices.size());
+    }
+    return static_cast<int>(it - devices.begin()) + 1;
+  };
+
+  std::ostringstream os;
+  os.precision(3);
+  os << std::fixed << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+  bool first = true;
+  for (const Event& e : events_) {
+    os << (first ? "\n" : ",\n") << "  {\"name\": \"" << EscapeJSON(e.name) << "\", \"cat\": \""
+       << EscapeJSON(e.category) << "\", \"ph\": \"" << e.phase << "\", \"ts\": " << e.ts;
+    if (e.phase == 'X') {
+      os << ", \"dur\": " << e.dur;
+    } else {
+      os << ", \"s\": \"t\"";
+    }
+    os << ", \"pid\": " << pid_of(e.ctx) << ", \"tid\": " << e.stream;
+    if (!e.args.empty()) {
+      os << ", \"args\": {";
+      for (size_t i = 0; i < e.args.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << "\"" << EscapeJSON(e.args[i].first)
+           << "\": " << e.args[i].second;
+      }
+      os << "}";
+    }
+    os << "}";
+    first = false;
+  }
+  for (size_t i = 0; i < devices.size(); ++i) {
+    os << (first ? "\n" : ",\n") << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": "
+       << i + 1 << ", \"args\": {\"name\": \"" << DeviceName(devices[i].device_type) << "("
+       << devices[i].device_id << ")\"}}";
+    first = false;
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
+}  // namespace runtime
+}  // namespace tvm
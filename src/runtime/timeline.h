@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file timeline.h
+ * \brief Collect runtime events and export them as a Chrome trace timeline.
+ */
+#ifndef TVM_RUNTIME_TIMELINE_H_
+#define TVM_RUNTIME_TIMELINE_H_
+
+#include <tvm/runtime/c_runtime_api.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief A trace of the events of one or several runs of an executor.
+ *
+ *  Events are grouped by device (a trace process) and stream (a trace thread),
+ *  and serialized in the Chrome trace event format, which can be loaded
+ *  in chrome://tracing or https://ui.perfetto.dev.
+ */
+class Timeline {
+ public:
+  /*! \brief Named integer arguments attached to an event. */
+  using EventArgs = std::vector<std::pair<std::string, int64_t>>;
+
+  Timeline() : start_(std::chrono::high_resolution_clock::now()) {}
+  /*! \return The microseconds elapsed since the timeline was created or cleared. */
+  double Now() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() -
+                                                     start_)
+        .count();
+  }
+  /*!
+   * \brief Record an event spanning an interval.
+   * \param name The name of the event, e.g. the operator.
+   * \param category The category of the event, e.g. "op" or "copy".
+   * \param ctx The device the event ran on.
+   * \param stream The index of the stream on the device, 0 for the default stream.
+   * \param begin The begin of the event, as returned by Now().
+   * \param end The end of the event, as returned by Now().
+   * \param args The arguments of the event.
+   */
+  void AddSpan(const std::string& name, const std::string& category, TVMContext ctx, int stream,
+               double begin, double end, EventArgs args = {});
+  /*!
+   * \brief Record an event happening at the current time, e.g. an allocation.
+   * \param name The name of the event.
+   * \param category The category of the event, e.g. "alloc".
+   * \param ctx The device of the event.
+   * \param stream The index of the stream on the device.
+   * \param args The arguments of the event, e.g. the allocated bytes.
+   */
+  void AddInstant(const std::string& name, const std::string& category, TVMContext ctx,
+                  int stream, EventArgs args = {});
+  /*!
+   * \brief Record an event which happened at the given time.
+   * \param name The name of the event.
+   * \param category The category of the event.
+   * \param ctx The device of the event.
+   * \param stream The index of the stream on the device.
+   * \param ts The time of the event, in microseconds on the clock of the other events.
+   * \param args The arguments of the event.
+   */
+  void AddInstant(const std::string& name, const std::string& category, TVMContext ctx,
+                  int stream, double ts, EventArgs args = {});
+  /*! \brief Drop all the events and restart the clock. */
+  void Clear();
+  /*! \return Whether no event was recorded. */
+  bool empty() const { return events_.empty(); }
+  /*! \return The events in the Chrome trace event JSON format. */
+  std::string ToJSON() const;
+
+ private:
+  struct Event {
+    std::string name;
+    std::string category;
+    /*! \brief 'X' for a complete event, 'i' for an instant event. */
+    char phase;
+    TVMContext ctx;
+    int stream;
+    double ts;
+    double dur;
+    EventArgs args;
+  };
+  /*! \brief The time the timeline started. */
+  std::chrono::high_resolution_clock::time_point start_;
+  /*! \brief The recorded events, in recording order. */
+  std::vector<Event> events_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_TIMELINE_H_
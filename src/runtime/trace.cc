@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file trace.cc
+ * \brief Per-thread event rings of the runtime tracing.
+ */
+#include "trace.h"
+
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../support/ring_buffer.h"
+#include "timeline.h"
+
+namespace tvm {
+namespace runtime {
+
+namespace {
+
+/*! \brief A recorded event, the size of a cache line. */
+struct TraceEvent {
+  static constexpr size_t kMaxName = 45;
+  /*! \brief Nanoseconds since the tracer started. */
+  int64_t ts;
+  int64_t value;
+  TraceCategory category;
+  char phase;
+  char name[kMaxName + 1];
+};
+static_assert(sizeof(TraceEvent) == 64, "TraceEvent should fill a cache line");
+constexpr size_t TraceEvent::kMaxName;
+
+/*! \brief Number of events kept by each thread, 1MB. */
+constexpr size_t kEventsPerThread = 1 << 14;
+
+/*! \brief The events of one thread. */
+struct ThreadTrace {
+  ThreadTrace(int tid, size_t capacity) : tid(tid), ring(capacity) {}
+  /*! \brief The trace thread id, in order of the first event of the thread. */
+  int tid;
+  support::OverwriteRingBuffer<TraceEvent> ring;
+  /*! \brief The write count of the ring at the last clearing dump, guarded by the registry. */
+  uint64_t dumped{0};
+  /*! \brief Whether the thread exited, its ring is dropped once dumped. */
+  std::atomic<bool> exited{false};
+};
+
+class TraceRegistry {
+ public:
+  static TraceRegistry* Global() {
+    // Leaked, threads may record events during the static destruction.
+    static TraceRegistry* inst = new TraceRegistry();
+    return inst;
+  }
+
+  int64_t Now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+  }
+
+  std::shared_ptr<ThreadTrace> NewThread() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto trace = std::make_shared<ThreadTrace>(next_tid_++, kEventsPerThread);
+    threads_.push_back(trace);
+    return trace;
+  }
+
+  std::string Dump(bool clear) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Timeline timeline;
+    TVMContext host{kDLCPU, 0};
+    std::vector<TraceEvent> events;
+    // The open spans of a thread, as indices into events.
+    std::vector<size_t> open;
+    for (const auto& thread : threads_) {
+      events.clear();
+      open.clear();
+      // The spans still open at a clearing dump are not reported by the next one.
+      uint64_t end = thread->ring.Snapshot(thread->dumped, &events);
+      if (clear) thread->dumped = end;
+      for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& e = events[i];
+        if (e.phase == 'B') {
+          open.push_back(i);
+        } else if (e.phase == 'E') {
+          // The begin of a span may have been overwritten, or dumped before.
+          if (open.empty()) continue;
+          const TraceEvent& b = events[open.back()];
+          open.pop_back();
+          timeline.AddSpan(b.name, CategoryName(b.category), host, thread->tid, b.ts * 1e-3,
+                           e.ts * 1e-3, Args(b));
+        } else {
+          timeline.AddInstant(e.name, CategoryName(e.category), host, thread->tid, e.ts * 1e-3,
+                              Args(e));
+        }
+      }
+    }
+    if (clear) {
+      threads_.erase(std::remove_if(threads_.begin(), threads_.end(),
+                                    [](const std::shared_ptr<ThreadTrace>& t) {
+                                      return t->exited.load(std::memory_order_acquire);
+                                    }),
+                     threads_.end());
+    }
+    return timeline.ToJSON();
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  TraceRegistry() : start_(Clock::now()) {}
+
+  static const char* CategoryName(TraceCategory category) {
+    switch (category) {
+      case TraceCategory::kOp:
+        return "op";
+      case TraceCategory::kAlloc:
+        return "alloc";
+      case TraceCategory::kFree:
+        return "free";
+      case TraceCategory::kCopy:
+        return "copy";
+      case TraceCategory::kParallel:
+        return "parallel";
+      case TraceCategory::kTask:
+        return "task";
+    }
+    return "unknown";
+  }
+
+  static Timeline::EventArgs Args(const TraceEvent& e) {
+    if (e.value < 0) return {};
+    switch (e.category) {
+      case TraceCategory::kParallel:
+        return {{"num_task", e.value}};
+      case TraceCategory::kTask:
+        return {{"task_id", e.value}};
+      default:
+        return {{"bytes", e.value}};
+    }
+  }
+
+  Clock::time_point start_;
+  std::mutex mutex_;
+  int next_tid_{0};
+  std::vector<std::shared_ptr<ThreadTrace>> threads_;
+};
+
+/*! \brief Owns the ring of a thread, marks it exited when the thread exits. */
+class LocalTrace {
+ public:
+  explicit LocalTrace(std::shared_ptr<ThreadTrace> trace) : trace_(trace) {}
+  ~LocalTrace() { trace_->exited.store(true, std::memory_order_release); }
+
+ private:
+  std::shared_ptr<ThreadTrace> trace_;
+};
+
+/*! \brief The ring of the calling thread, a plain thread local for the fast path. */
+thread_local ThreadTrace* local_trace = nullptr;
+
+ThreadTrace* NewLocalTrace() {
+  std::shared_ptr<ThreadTrace> trace = TraceRegistry::Global()->NewThread();
+  static thread_local LocalTrace owner(trace);
+  local_trace = trace.get();
+  return local_trace;
+}
+
+bool EnabledFromEnv() {
+  const char* val = std::getenv("TVM_RUNTIME_TRACE");
+  return TVM_RUNTIME_TRACE && val != nullptr && std::atoi(val) != 0;
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::enabled_{EnabledFromEnv()};
+
+void Tracer::Enable(bool enable) {
+  CHECK(TVM_RUNTIME_TRACE || !enable) << "The runtime is built without USE_RUNTIME_TRACE";
+  enabled_.store(enable, std::memory_order_relaxed);
+}
+
+void Tracer::Record(TraceCategory category, char phase, TraceName name, int64_t value) {
+  ThreadTrace* trace = local_trace != nullptr ? local_trace : NewLocalTrace();
+  TraceEvent e;
+  e.ts = TraceRegistry::Global()->Now();
+  e.value = value;
+  e.category = category;
+  e.phase = phase;
+  size_t size = name.size == std::string::npos ? std::strlen(name.data) : name.size;
+  size = std::min(size, TraceEvent::kMaxName);
+  std::memcpy(e.name, name.data, size);
+  e.name[size] = '\0';
+  trace->ring.Push(e);
+}
+
+std::string Tracer::Dump(bool clear) { return TraceRegistry::Global()->Dump(clear); }
+
+TVM_REGISTER_GLOBAL("runtime.TraceEnabled").set_body_typed(Tracer::Enabled);
+
+TVM_REGISTER_GLOBAL("runtime.TraceEnable").set_body_typed(Tracer::Enable);
+
+TVM_REGISTER_GLOBAL("runtime.TraceDump").set_body_typed(Tracer::Dump);
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,152 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file trace.h
+ * \brief Low overhead tracing of the runtime hot paths.
+ *
+ *  Every thread records its events into its own fixed size ring, without locks,
+ *  keeping the most recent events only, so tracing can stay on in production.
+ *  The events are collected on demand with Tracer::Dump.
+ *
+ *  The trace points are the TVM_TRACE_SPAN and TVM_TRACE_INSTANT macros, which
+ *  compile to nothing unless TVM_RUNTIME_TRACE is set (USE_RUNTIME_TRACE in cmake),
+ *  and cost a relaxed atomic load while tracing is off at run time.
+ */
+#ifndef TVM_RUNTIME_TRACE_H_
+#define TVM_RUNTIME_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef TVM_RUNTIME_TRACE
+#define TVM_RUNTIME_TRACE 0
+#endif
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The kind of a traced event, the category of the trace. */
+enum class TraceCategory : uint8_t {
+  /*! \brief An operator launched by an executor, a span. */
+  kOp,
+  /*! \brief An allocation, the value is its size in bytes. */
+  kAlloc,
+  /*! \brief A free, the value is its size in bytes when known. */
+  kFree,
+  /*! \brief A copy between tensors, the value is its size in bytes. */
+  kCopy,
+  /*! \brief A parallel launch, a span from the fork to the join of its tasks. */
+  kParallel,
+  /*! \brief A task of a parallel launch run by a worker, the value is its task id. */
+  kTask,
+};
+
+/*! \brief The name of an event, a view of a string which is only measured when recorded. */
+struct TraceName {
+  TraceName(const char* str) : data(str), size(std::string::npos) {}  // NOLINT(*)
+  TraceName(const std::string& str) : data(str.data()), size(str.size()) {}  // NOLINT(*)
+  const char* data;
+  size_t size;
+};
+
+/*! \brief The process wide tracing state. */
+class Tracer {
+ public:
+  /*! \return Whether tracing is on, a relaxed load. */
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+  /*!
+   * \brief Turn tracing on or off, the recorded events are kept.
+   * \param enable Whether to record the events.
+   */
+  static void Enable(bool enable);
+  /*!
+   * \brief Record an event of the calling thread.
+   * \param category The category of the event.
+   * \param phase 'B' for the begin of a span, 'E' for its end, 'i' for an instant event.
+   * \param name The name of the event, long names are truncated.
+   * \param value The value of the event, see TraceCategory, negative when there is none.
+   */
+  static void Record(TraceCategory category, char phase, TraceName name, int64_t value);
+  /*!
+   * \brief Collect the events recorded by all the threads.
+   * \param clear Whether the returned events are skipped by the next dump.
+   * \return The events in the Chrome trace event JSON format, one trace thread per thread.
+   */
+  static std::string Dump(bool clear);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+/*! \brief Record a span of the calling thread for the lifetime of the object. */
+class TraceSpan {
+ public:
+  TraceSpan(TraceCategory category, TraceName name, int64_t value)
+      : category_(category), active_(Tracer::Enabled()) {
+    if (active_) Tracer::Record(category, 'B', name, value);
+  }
+  ~TraceSpan() {
+    if (active_) Tracer::Record(category_, 'E', "", -1);
+  }
+
+ private:
+  TraceCategory category_;
+  // whether the begin was recorded, the end is recorded even if tracing was turned off since.
+  bool active_;
+};
+
+#define TVM_TRACE_CONCAT_(a, b) a##b
+#define TVM_TRACE_CONCAT(a, b) TVM_TRACE_CONCAT_(a, b)
+
+#if TVM_RUNTIME_TRACE
+/*!
+ * \brief Trace a span from this statement to the end of the enclosing scope.
+ * \param category A TraceCategory enumerator, e.g. kOp.
+ * \param name The name of the span, a string.
+ * \param value The value of the span, negative when there is none.
+ */
+#define TVM_TRACE_SPAN(category, name, value)                                    \
+  ::tvm::runtime::TraceSpan TVM_TRACE_CONCAT(tvm_trace_span_, __LINE__)(         \
+      ::tvm::runtime::TraceCategory::category, name, value)
+/*!
+ * \brief Trace an instant event, the arguments are only evaluated while tracing is on.
+ * \param category A TraceCategory enumerator, e.g. kAlloc.
+ * \param name The name of the event, a string.
+ * \param value The value of the event, negative when there is none.
+ */
+#define TVM_TRACE_INSTANT(category, name, value)                                          \
+  do {                                                                                    \
+    if (::tvm::runtime::Tracer::Enabled()) {                                              \
+      ::tvm::runtime::Tracer::Record(::tvm::runtime::TraceCategory::category, 'i', name, \
+                                     value);                                              \
+    }                                                                                     \
+  } while (0)
+#else
+#define TVM_TRACE_SPAN(category, name, value)
+#define TVM_TRACE_INSTANT(category, name, value) \
+  do {                                           \
+  } while (0)
+#endif
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_TRACE_H_
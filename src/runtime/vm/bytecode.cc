@@ -116,6 +116,11 @@ Instruction::Instruction(const Instruction& instr) {
     case Opcode::AllocStorage:
       this->alloc_storage = instr.alloc_storage;
       return;
+    case Opcode::AllocStorageTensor:
+      this->alloc_storage_tensor = instr.alloc_storage_tensor;
+      this->alloc_storage_tensor.shape = Duplicate<int64_t>(instr.alloc_storage_tensor.shape,
+                                                            instr.alloc_storage_tensor.ndim);
+      return;
     case Opcode::ShapeOf:
       this->shape_of.tensor = instr.shape_of.tensor;
       return;
@@ -217,6 +222,11 @@ Instruction& Instruction::operator=(const Instruction& instr) {
     case Opcode::AllocStorage:
       this->alloc_storage = instr.alloc_storage;
       return *this;
+    case Opcode::AllocStorageTensor:
+      this->alloc_storage_tensor = instr.alloc_storage_tensor;
+      this->alloc_storage_tensor.shape = Duplicate<int64_t>(instr.alloc_storage_tensor.shape,
+                                                            instr.alloc_storage_tensor.ndim);
+      return *this;
     case Opcode::ShapeOf:
       this->shape_of.tensor = instr.shape_of.tensor;
       return *this;
@@ -246,6 +256,9 @@ Instruction::~Instruction() {
     case Opcode::AllocTensor:
       delete[] this->alloc_tensor.shape;
       return;
+    case Opcode::AllocStorageTensor:
+      delete[] this->alloc_storage_tensor.shape;
+      return;
     case Opcode::AllocADT:
       delete[] this->datatype_fields;
       return;
@@ -311,6 +324,23 @@ Instruction Instruction::AllocTensor(RegName storage, RegName offset,
   return instr;
 }
 
+Instruction Instruction::AllocStorageTensor(RegName size, Index alignment, DLDataType dtype_hint,
+                                            RegName offset, const std::vector<int64_t>& shape,
+                                            DLDataType dtype, RegName dst) {
+  Instruction instr;
+  instr.op = Opcode::AllocStorageTensor;
+  instr.dst = dst;
+  instr.alloc_storage_tensor.allocation_size = size;
+  instr.alloc_storage_tensor.alignment = alignment;
+  instr.alloc_storage_tensor.dtype_hint = dtype_hint;
+  instr.alloc_storage_tensor.offset = offset;
+  instr.alloc_storage_tensor.ndim = shape.size();
+  instr.alloc_storage_tensor.shape = new int64_t[shape.size()];
+  std::copy(shape.begin(), shape.end(), instr.alloc_storage_tensor.shape);
+  instr.alloc_storage_tensor.dtype = dtype;
+  return instr;
+}
+
 Instruction Instruction::AllocTensorReg(RegName storage, RegName offset, RegName shape_register,
                                         DLDataType dtype, RegName dst) {
   Instruction instr;
@@ -585,6 +615,14 @@ void InstructionPrint(std::ostream& os, const Instruction& instr) {
          << DLDataType2String(instr.alloc_storage.dtype_hint);
       break;
     }
+    case Opcode::AllocStorageTensor: {
+      const auto& fused = instr.alloc_storage_tensor;
+      os << "alloc_storage_tensor $" << instr.dst << " $" << fused.allocation_size << " "
+         << fused.alignment << " " << DLDataType2String(fused.dtype_hint) << " $" << fused.offset
+         << " [" << StrJoin<int64_t>(fused.shape, 0, fused.ndim) << "] ";
+      DLDatatypePrint(os, fused.dtype);
+      break;
+    }
     case Opcode::ShapeOf: {
       os << "shape_of $" << instr.dst << " $" << instr.shape_of.tensor;
       break;
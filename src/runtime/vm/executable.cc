@@ -24,7 +24,9 @@
 
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/serializer.h>
 #include <tvm/runtime/vm/executable.h>
 #include <tvm/runtime/vm/vm.h>
 
@@ -36,6 +38,7 @@
 #include <utility>
 #include <vector>
 
+#include "../mapped_file.h"
 #include "serialize_util.h"
 
 namespace tvm {
@@ -103,6 +106,51 @@ std::string Executable::GetFunctionParameterName(std::string func_name, uint32_t
   return func.params[index];
 }
 
+const std::vector<PackedFunc>& Executable::GetPackedFuncs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (packed_funcs_resolved_) return packed_funcs_;
+  // Get the list of packed functions.
+  CHECK(primitive_map.empty() || lib.operator->())
+      << "runtime module should have been built for primitive functions"
+      << "\n";
+  runtime::Module mod = lib;
+  std::vector<PackedFunc> funcs;
+  for (const auto& it : primitive_map) {
+    const auto& packed_name = it.first;
+    auto packed_index = static_cast<size_t>(it.second);
+    if (funcs.size() <= packed_index) {
+      funcs.resize(packed_index + 1);
+    }
+    tvm::runtime::PackedFunc pf = mod.GetFunction(packed_name, true);
+    CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
+    funcs[packed_index] = pf;
+  }
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    CHECK(funcs[i] != nullptr) << "Packed function " << i << " is not initialized";
+  }
+  packed_funcs_ = std::move(funcs);
+  packed_funcs_resolved_ = true;
+  return packed_funcs_;
+}
+
+ObjectRef Executable::GetConstant(Index const_index, const TVMContext& ctx, bool* copied) const {
+  CHECK_LT(const_index, constants.size());
+  if (copied) *copied = false;
+  const auto& constant = constants[const_index];
+  const auto* array = constant.as<NDArray::ContainerType>();
+  if (array == nullptr || array->dl_tensor.ctx.device_type == ctx.device_type) {
+    return constant;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& pool = device_constants_[std::make_pair(static_cast<int>(ctx.device_type), ctx.device_id)];
+  if (pool.empty()) pool.resize(constants.size());
+  if (!pool[const_index].defined()) {
+    pool[const_index] = Downcast<NDArray>(constant).CopyTo(ctx);
+    if (copied) *copied = true;
+  }
+  return pool[const_index];
+}
+
 std::string Executable::GetBytecode() const {
   std::ostringstream oss;
 
@@ -240,15 +288,68 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
 }
 
 void Executable::SaveConstantSection(dmlc::Stream* strm) {
-  std::vector<DLTensor*> arrays;
+  std::vector<NDArray> arrays;
   for (const auto& obj : this->constants) {
-    const auto cell = Downcast<runtime::NDArray>(obj);
-    arrays.push_back(const_cast<DLTensor*>(cell.operator->()));
+    arrays.push_back(Downcast<runtime::NDArray>(obj));
+  }
+  if (!DMLC_IO_NO_ENDIAN_SWAP) {
+    // The mapped layout stores the tensor data as is, keep the portable one.
+    strm->Write(static_cast<uint64_t>(this->constants.size()));
+    for (const auto& it : arrays) {
+      runtime::SaveDLTensor(strm, const_cast<DLTensor*>(it.operator->()));
+    }
+    return;
+  }
+
+  // The tensor descriptions come first, then the data block, starting at a page
+  // boundary of the executable with every tensor aligned for direct use.
+  auto write_descriptions = [&arrays](dmlc::Stream* out, const std::vector<uint64_t>& offsets,
+                                      uint64_t section_end) {
+    out->Write(kTVMVMMappedConstantMagic);
+    out->Write(section_end);
+    out->Write(static_cast<uint64_t>(arrays.size()));
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      const DLTensor* tensor = arrays[i].operator->();
+      out->Write(tensor->dtype);
+      out->Write(tensor->ndim);
+      out->WriteArray(tensor->shape, tensor->ndim);
+      out->Write(offsets[i]);
+      out->Write(static_cast<uint64_t>(GetDataSize(*tensor)));
+    }
+  };
+  std::vector<uint64_t> offsets(arrays.size(), 0);
+  std::string descriptions;
+  {
+    dmlc::MemoryStringStream sizer(&descriptions);
+    write_descriptions(&sizer, offsets, 0);
+  }
+  // Save() writes the executable into code_ from its start.
+  uint64_t begin = code_.size() + descriptions.size();
+  uint64_t data_begin = (begin + kTVMVMConstantPageSize - 1) / kTVMVMConstantPageSize *
+                        kTVMVMConstantPageSize;
+  uint64_t end = data_begin;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    end = (end + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+    offsets[i] = end;
+    end += GetDataSize(*arrays[i].operator->());
   }
-  strm->Write(static_cast<uint64_t>(this->constants.size()));
-  for (const auto& it : arrays) {
-    runtime::SaveDLTensor(strm, it);
+  write_descriptions(strm, offsets, end);
+
+  std::string padding;
+  uint64_t pos = begin;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    padding.assign(offsets[i] - pos, '\0');
+    strm->Write(padding.data(), padding.size());
+    NDArray host = arrays[i];
+    if (host->ctx.device_type != kDLCPU || !IsContiguous(*host.operator->())) {
+      host = host.CopyTo({kDLCPU, 0});
+    }
+    size_t nbytes = GetDataSize(*host.operator->());
+    strm->Write(static_cast<const char*>(host->data) + host->byte_offset, nbytes);
+    pos = offsets[i] + nbytes;
   }
+  padding.assign(end - pos, '\0');
+  strm->Write(padding.data(), padding.size());
 }
 
 void Executable::SavePrimitiveOpNames(dmlc::Stream* strm) {
@@ -354,6 +455,24 @@ VMInstructionSerializer SerializeInstruction(const Instruction& instr) {
       fields.push_back(instr.dst);
       break;
     }
+    case Opcode::AllocStorageTensor: {
+      // Number of fields = 11 + instr.alloc_storage_tensor.ndim
+      const auto& fused = instr.alloc_storage_tensor;
+      fields.push_back(fused.allocation_size);
+      fields.push_back(fused.alignment);
+      fields.push_back(fused.dtype_hint.code);
+      fields.push_back(fused.dtype_hint.bits);
+      fields.push_back(fused.dtype_hint.lanes);
+      fields.push_back(fused.offset);
+      fields.push_back(fused.dtype.code);
+      fields.push_back(fused.dtype.bits);
+      fields.push_back(fused.dtype.lanes);
+      fields.push_back(fused.ndim);
+      fields.push_back(instr.dst);
+      // The shape is rotated to the end of the list, as for AllocTensor.
+      fields.insert(fields.end(), fused.shape, fused.shape + fused.ndim);
+      break;
+    }
     case Opcode::AllocADT: {
       // Number of fields = 3 + instr.num_fields
       fields.assign({instr.constructor_tag, instr.num_fields, instr.dst});
@@ -465,27 +584,40 @@ void LoadHeader(dmlc::Stream* strm) {
   STREAM_CHECK(version == TVM_VERSION, "version");
 }
 
-runtime::Module Executable::Load(const std::string& code, const runtime::Module lib) {
-  auto exec = make_object<Executable>();
-  exec->lib = lib;
-  exec->code_ = code;
-  dmlc::MemoryStringStream strm(&exec->code_);
-
+void Executable::LoadSections(dmlc::SeekStream* strm) {
   // Load header.
-  LoadHeader(&strm);
+  LoadHeader(strm);
 
   // Global section.
-  exec->LoadGlobalSection(&strm);
+  LoadGlobalSection(strm);
 
   // Constant section.
-  exec->LoadConstantSection(&strm);
+  LoadConstantSection(strm);
 
   // Primitive names that will be invoked by `InvokePacked` instructions.
-  exec->LoadPrimitiveOpNames(&strm);
+  LoadPrimitiveOpNames(strm);
 
   // Code section.
-  exec->LoadCodeSection(&strm);
+  LoadCodeSection(strm);
+}
 
+runtime::Module Executable::Load(const std::string& code, const runtime::Module lib) {
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  exec->code_ = code;
+  dmlc::MemoryStringStream strm(&exec->code_);
+  exec->LoadSections(&strm);
+  return runtime::Module(exec);
+}
+
+runtime::Module Executable::LoadFromFile(const std::string& path, const runtime::Module lib) {
+  auto exec = make_object<Executable>();
+  exec->lib = lib;
+  exec->mapped_file_ = std::make_shared<MappedFile>(path);
+  dmlc::MemoryFixedSizeStream strm(exec->mapped_file_->data(), exec->mapped_file_->size());
+  exec->LoadSections(&strm);
+  // The constants viewing the file keep it mapped.
+  exec->mapped_file_ = nullptr;
   return runtime::Module(exec);
 }
 
@@ -497,11 +629,43 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* strm) {
+void Executable::LoadConstantSection(dmlc::SeekStream* strm) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
 
+  if (sz == kTVMVMMappedConstantMagic) {
+    STREAM_CHECK(DMLC_IO_NO_ENDIAN_SWAP, "constant");
+    uint64_t section_end;
+    STREAM_CHECK(strm->Read(&section_end), "constant");
+    STREAM_CHECK(strm->Read(&sz), "constant");
+    size_t total = mapped_file_ ? mapped_file_->size() : code_.size();
+    STREAM_CHECK(section_end <= total, "constant");
+    for (size_t i = 0; i < static_cast<size_t>(sz); i++) {
+      DLDataType dtype;
+      int ndim;
+      STREAM_CHECK(strm->Read(&dtype), "constant");
+      STREAM_CHECK(strm->Read(&ndim), "constant");
+      std::vector<int64_t> shape(ndim);
+      if (ndim != 0) {
+        STREAM_CHECK(strm->ReadArray(&shape[0], ndim), "constant");
+      }
+      uint64_t offset, nbytes;
+      STREAM_CHECK(strm->Read(&offset), "constant");
+      STREAM_CHECK(strm->Read(&nbytes), "constant");
+      STREAM_CHECK(offset + nbytes <= section_end, "constant");
+      if (mapped_file_) {
+        this->constants.push_back(MappedView(mapped_file_, offset, dtype, shape));
+      } else {
+        auto constant = NDArray::Empty(shape, dtype, {kDLCPU, 0});
+        constant.CopyFromBytes(code_.data() + offset, nbytes);
+        this->constants.push_back(constant);
+      }
+    }
+    strm->Seek(section_end);
+    return;
+  }
+
   size_t size = static_cast<size_t>(sz);
   // Load each of the constants.
   for (size_t i = 0; i < size; i++) {
@@ -635,6 +799,33 @@ Instruction DeserializeInstruction(const VMInstructionSerializer& instr) {
 
       return Instruction::AllocStorage(allocation_size, alignment, dtype, dst);
     }
+    case Opcode::AllocStorageTensor: {
+      // Number of fields = 11 + instr.alloc_storage_tensor.ndim
+      DCHECK_GE(instr.fields.size(), 11U);
+      DCHECK_EQ(instr.fields.size(), 11U + static_cast<size_t>(instr.fields[9]));
+
+      RegName allocation_size = instr.fields[0];
+      Index alignment = instr.fields[1];
+
+      DLDataType dtype_hint;
+      dtype_hint.code = instr.fields[2];
+      dtype_hint.bits = instr.fields[3];
+      dtype_hint.lanes = instr.fields[4];
+
+      RegName offset = instr.fields[5];
+
+      DLDataType dtype;
+      dtype.code = instr.fields[6];
+      dtype.bits = instr.fields[7];
+      dtype.lanes = instr.fields[8];
+
+      Index ndim = instr.fields[9];
+      RegName dst = instr.fields[10];
+      std::vector<Index> shape = ExtractFields(instr.fields, 11, ndim);
+
+      return Instruction::AllocStorageTensor(allocation_size, alignment, dtype_hint, offset, shape,
+                                             dtype, dst);
+    }
     case Opcode::If: {
       // Number of fields = 4
       DCHECK_EQ(instr.fields.size(), 4U);
@@ -791,6 +982,11 @@ TVM_REGISTER_GLOBAL("runtime.Load_Executable")
       return Executable::Load(code, lib);
     });
 
+TVM_REGISTER_GLOBAL("runtime.Load_ExecutableFile")
+    .set_body_typed([](std::string path, runtime::Module lib) {
+      return Executable::LoadFromFile(path, lib);
+    });
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
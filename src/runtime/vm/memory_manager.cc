@@ -21,6 +21,7 @@
  * \file tvm/runtime/vm/memory_manager.cc
  * \brief Allocate and manage memory for the runtime.
  */
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
 #include <memory>
@@ -28,6 +29,8 @@
 
 #include "naive_allocator.h"
 #include "pooled_allocator.h"
+#include "size_class_allocator.h"
+#include "stream_ordered_allocator.h"
 
 namespace tvm {
 namespace runtime {
@@ -115,6 +118,12 @@ MemoryManager* MemoryManager::Global() {
 }
 
 Allocator* MemoryManager::GetOrCreateAllocator(TVMContext ctx, AllocatorType type) {
+  if (type == kStreamOrdered && !StreamOrderedAllocator::IsSupported(ctx)) {
+    // e.g. the CPU, when the same config is used for all the contexts.
+    DLOG(INFO) << "No stream-ordered allocation on " << DeviceName(ctx.device_type)
+               << ", using the pooled allocator";
+    type = kPooled;
+  }
   MemoryManager* m = MemoryManager::Global();
   std::lock_guard<std::mutex> lock(m->mu_);
   if (m->allocators_.find(ctx) == m->allocators_.end()) {
@@ -132,6 +141,18 @@ Allocator* MemoryManager::GetOrCreateAllocator(TVMContext ctx, AllocatorType typ
         alloc.reset(new PooledAllocator(ctx));
         break;
       }
+      case kSizeClass: {
+        DLOG(INFO) << "New size class allocator for " << DeviceName(ctx.device_type) << "("
+                   << ctx.device_id << ")";
+        alloc.reset(new SizeClassAllocator(ctx));
+        break;
+      }
+      case kStreamOrdered: {
+        DLOG(INFO) << "New stream-ordered allocator for " << DeviceName(ctx.device_type) << "("
+                   << ctx.device_id << ")";
+        alloc.reset(new StreamOrderedAllocator(ctx));
+        break;
+      }
       default:
         LOG(FATAL) << "Unknown allocator type: " << type;
     }
@@ -172,6 +193,32 @@ NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLContext
   return NDArray(GetObjectPtr<Object>(container));
 }
 
+TVM_REGISTER_GLOBAL("runtime.VMAllocatorTrim").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(args[0].operator int());
+  ctx.device_id = args[1];
+  MemoryManager::GetAllocator(ctx)->Trim();
+});
+
+TVM_REGISTER_GLOBAL("runtime.VMAllocatorUsedMemory").set_body([](TVMArgs args, TVMRetValue* rv) {
+  TVMContext ctx;
+  ctx.device_type = static_cast<DLDeviceType>(args[0].operator int());
+  ctx.device_id = args[1];
+  *rv = static_cast<int64_t>(MemoryManager::GetAllocator(ctx)->UsedMemory());
+});
+
+TVM_REGISTER_GLOBAL("runtime.VMAllocatorSetMaxCachedBytes")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      TVMContext ctx;
+      ctx.device_type = static_cast<DLDeviceType>(args[0].operator int());
+      ctx.device_id = args[1];
+      int64_t nbytes = args[2];
+      Allocator* alloc = MemoryManager::GetAllocator(ctx);
+      CHECK_EQ(alloc->type(), kSizeClass)
+          << "Only the size class allocator supports a high-water mark of cached memory";
+      static_cast<SizeClassAllocator*>(alloc)->SetMaxCachedMemory(static_cast<size_t>(nbytes));
+    });
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
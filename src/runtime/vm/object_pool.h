@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/object_pool.h
+ * \brief Recycling allocator of the small objects created by the VM.
+ */
+#ifndef TVM_RUNTIME_VM_OBJECT_POOL_H_
+#define TVM_RUNTIME_VM_OBJECT_POOL_H_
+
+#include <tvm/runtime/memory.h>
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*!
+ * \brief An object allocator carving the ADTs and closures of a VM out of
+ *  large chunks, with a free list per size class.
+ *
+ *  An object freed by the last reference, on any thread, goes back to the free
+ *  list of its size class and is reused by the next allocation of that size,
+ *  so the steady state of a tuple heavy program does not touch the heap.
+ *
+ *  Objects may escape the invocation that created them, e.g. as results. Each
+ *  live object holds a reference to the pool, which is destroyed once the
+ *  owner released it and no object lives in it anymore.
+ *
+ *  Allocation is reserved to the owner, deallocation is thread safe.
+ */
+class VMObjectPool : public ObjAllocatorBase<VMObjectPool> {
+ public:
+  /*! \brief The granularity of the size classes. */
+  static constexpr size_t kUnit = 16;
+  /*! \brief The number of size classes, larger objects are allocated with new. */
+  static constexpr size_t kNumSizeClasses = 16;
+  /*! \brief The size of the chunks the slots are carved from. */
+  static constexpr size_t kChunkSize = 64 << 10;
+
+  /*! \brief Create a pool referenced by the caller. */
+  static VMObjectPool* Create() { return new VMObjectPool(); }
+
+  /*! \brief Release the reference of the owner. */
+  void Release() { DecRef(); }
+
+  template <typename T>
+  class Handler {
+   public:
+    template <typename... Args>
+    static T* New(VMObjectPool* pool, Args&&... args) {
+      void* data = pool->Allocate(sizeof(T));
+      new (data) T(std::forward<Args>(args)...);
+      return static_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      T* tptr = static_cast<T*>(objptr);
+      tptr->T::~T();
+      VMObjectPool::Free(tptr);
+    }
+  };
+
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+
+    template <typename... Args>
+    static ArrayType* New(VMObjectPool* pool, size_t num_elems, Args&&... args) {
+      void* data = pool->Allocate(sizeof(ArrayType) + num_elems * sizeof(ElemType));
+      new (data) ArrayType(std::forward<Args>(args)...);
+      return static_cast<ArrayType*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      tptr->ArrayType::~ArrayType();
+      VMObjectPool::Free(tptr);
+    }
+  };
+
+ private:
+  /*! \brief The header of every slot, the object follows it. */
+  struct alignas(kUnit) SlotHeader {
+    /*! \brief The pool of the slot, nullptr for an object allocated with new. */
+    VMObjectPool* pool;
+    /*! \brief The size class of the slot. */
+    size_t size_class;
+  };
+  /*! \brief A free slot, linked in place of the object. */
+  struct FreeSlot {
+    SlotHeader header;
+    FreeSlot* next;
+  };
+
+  VMObjectPool() {
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      free_[i] = nullptr;
+      returned_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~VMObjectPool() {
+    for (char* chunk : chunks_) {
+      delete[] chunk;
+    }
+  }
+
+  void DecRef() {
+    if (ref_counter_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  void* Allocate(size_t size) {
+    size_t size_class = (size + kUnit - 1) / kUnit - 1;
+    if (size_class >= kNumSizeClasses) {
+      SlotHeader* header = static_cast<SlotHeader*>(::operator new(sizeof(SlotHeader) + size));
+      header->pool = nullptr;
+      return header + 1;
+    }
+    FreeSlot* slot = free_[size_class];
+    if (slot == nullptr) {
+      // Take over the slots freed on any thread since the last time.
+      slot = returned_[size_class].exchange(nullptr, std::memory_order_acquire);
+    }
+    if (slot != nullptr) {
+      free_[size_class] = slot->next;
+    } else {
+      size_t slot_size = sizeof(SlotHeader) + (size_class + 1) * kUnit;
+      if (chunk_offset_ + slot_size > kChunkSize) {
+        chunks_.push_back(new char[kChunkSize]);
+        chunk_offset_ = 0;
+      }
+      slot = reinterpret_cast<FreeSlot*>(chunks_.back() + chunk_offset_);
+      chunk_offset_ += slot_size;
+      slot->header.pool = this;
+      slot->header.size_class = size_class;
+    }
+    ref_counter_.fetch_add(1, std::memory_order_relaxed);
+    return &slot->header + 1;
+  }
+
+  static void Free(void* data) {
+    SlotHeader* header = static_cast<SlotHeader*>(data) - 1;
+    VMObjectPool* pool = header->pool;
+    if (pool == nullptr) {
+      ::operator delete(header);
+      return;
+    }
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(header);
+    std::atomic<FreeSlot*>& head = pool->returned_[header->size_class];
+    slot->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(slot->next, slot, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+    pool->DecRef();
+  }
+
+  /*! \brief The reference of the owner and of every live object. */
+  std::atomic<int64_t> ref_counter_{1};
+  /*! \brief The free slots of each size class, owned by the allocating thread. */
+  FreeSlot* free_[kNumSizeClasses];
+  /*! \brief The slots freed since the owner last took them, pushed from any thread. */
+  std::atomic<FreeSlot*> returned_[kNumSizeClasses];
+  /*! \brief The chunks the slots are carved from. */
+  std::vector<char*> chunks_;
+  /*! \brief The offset of the next slot in the last chunk, a full chunk to start. */
+  size_t chunk_offset_{kChunkSize};
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_OBJECT_POOL_H_
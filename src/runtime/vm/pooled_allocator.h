@@ -74,6 +74,8 @@ class PooledAllocator final : public Allocator {
 
   size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
 
+  void Trim() override { ReleaseAll(); }
+
  private:
   void ReleaseAll() {
     std::lock_guard<std::mutex> lock(mu_);
@@ -81,10 +83,10 @@ class PooledAllocator final : public Allocator {
       auto const& pool = it.second;
       for (auto const& buf : pool) {
         DeviceAPI::Get(buf.ctx)->FreeDataSpace(buf.ctx, buf.data);
+        used_memory_.fetch_sub(buf.size, std::memory_order_relaxed);
       }
     }
     memory_pool_.clear();
-    used_memory_ = 0;
     DLOG(INFO) << "release all buffers";
   }
 
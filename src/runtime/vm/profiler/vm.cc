@@ -24,11 +24,13 @@
 
 #include "vm.h"
 
+#include <dmlc/json.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -43,7 +45,11 @@ PackedFunc VirtualMachineDebug::GetFunction(const std::string& name,
                                             const ObjectPtr<Object>& sptr_to_self) {
   if (name == "get_stat") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-      CHECK_EQ(args.size(), 1U);
+      CHECK(args.size() == 1U || args.size() == 2U);
+      if (args.size() == 2U && args[1].operator std::string() == "json") {
+        *rv = GetStatJSON();
+        return;
+      }
       std::vector<std::pair<Index, double>> op_acc_time;
       for (auto kv : op_durations_) {
         auto val =
@@ -83,16 +89,87 @@ PackedFunc VirtualMachineDebug::GetFunction(const std::string& name,
          << "Total Packed Functions: " << total_packed_funcs << std::endl;
       *rv = os.str();
     });
+  } else if (name == "get_timeline") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = trace_.ToJSON(); });
   } else if (name == "reset") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       op_durations_.clear();
       op_invokes_.clear();
+      trace_.Clear();
+      profile_.Clear();
     });
   } else {
     return VirtualMachine::GetFunction(name, sptr_to_self);
   }
 }
 
+std::string VirtualMachineDebug::GetStatJSON() {
+  static const char* opcode_names[kNumVMOpcodes] = {
+      "move",        "ret",          "invoke",        "invoke_closure", "invoke_packed",
+      "alloc_tensor", "alloc_tensor_reg", "alloc_data", "alloc_closure", "get_field",
+      "if",          "load_const",   "goto",          "get_tag",        "load_consti",
+      "fatal",       "alloc_storage", "shape_of",     "reshape_tensor", "alloc_storage_tensor"};
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginObject();
+
+  std::map<std::string, std::map<std::string, double>> packed;
+  for (const auto& kv : op_durations_) {
+    const auto& vals = kv.second;
+    if (vals.empty()) continue;
+    double sum = std::accumulate(vals.begin(), vals.end(), 0.0);
+    packed[packed_index_map_[kv.first]] = {
+        {"count", static_cast<double>(op_invokes_[kv.first])},
+        {"sum_us", sum},
+        {"mean_us", sum / static_cast<double>(vals.size())},
+        {"min_us", *std::min_element(vals.begin(), vals.end())},
+        {"max_us", *std::max_element(vals.begin(), vals.end())}};
+  }
+  writer.WriteObjectKeyValue("packed_funcs", packed);
+
+  std::map<std::string, std::map<std::string, double>> opcodes;
+  for (size_t i = 0; i < kNumVMOpcodes; ++i) {
+    const auto& op = profile_.opcodes[i];
+    if (op.count == 0) continue;
+    opcodes[opcode_names[i]] = {{"count", static_cast<double>(op.count)}, {"time_us", op.time_us}};
+  }
+  writer.WriteObjectKeyValue("opcodes", opcodes);
+
+  // Allocating instructions are named "<function>@<pc>".
+  std::map<std::string, std::map<std::string, double>> allocs;
+  for (const auto& kv : profile_.allocs) {
+    std::string site;
+    for (const auto& func : exec_->functions) {
+      const Instruction* begin = func.instructions.data();
+      if (kv.first >= begin && kv.first < begin + func.instructions.size()) {
+        site = func.name + "@" + std::to_string(kv.first - begin);
+      }
+    }
+    allocs[site] = {{"count", static_cast<double>(kv.second.count)},
+                    {"replayed", static_cast<double>(kv.second.replayed)},
+                    {"bytes", static_cast<double>(kv.second.bytes)},
+                    {"time_us", kv.second.time_us}};
+  }
+  writer.WriteObjectKeyValue("allocs", allocs);
+
+  // Devices are named "<device type>:<device id>".
+  std::map<std::string, int64_t> peak_memory;
+  for (const auto& kv : profile_.peak_bytes) {
+    peak_memory[std::to_string(kv.first.first) + ":" + std::to_string(kv.first.second)] = kv.second;
+  }
+  writer.WriteObjectKeyValue("peak_memory", peak_memory);
+
+  std::map<std::string, std::map<std::string, int64_t>> copies;
+  copies["host_to_device"] = {{"count", profile_.host_to_device.count},
+                              {"bytes", profile_.host_to_device.bytes}};
+  copies["device_to_host"] = {{"count", profile_.device_to_host.count},
+                              {"bytes", profile_.device_to_host.bytes}};
+  writer.WriteObjectKeyValue("copies", copies);
+  writer.EndObject();
+  return os.str();
+}
+
 void VirtualMachineDebug::LoadExecutable(const Executable* exec) {
   VirtualMachine::LoadExecutable(exec);
   CHECK(exec_);
@@ -110,10 +187,12 @@ void VirtualMachineDebug::InvokePacked(Index packed_index, const PackedFunc& fun
   VirtualMachine::InvokePacked(packed_index, func, arg_count, output_size, args);
   TVMSynchronize(ctx.device_type, ctx.device_id, nullptr);
 
+  double trace_begin = trace_.Now();
   auto op_begin = std::chrono::high_resolution_clock::now();
   VirtualMachine::InvokePacked(packed_index, func, arg_count, output_size, args);
   TVMSynchronize(ctx.device_type, ctx.device_id, nullptr);
   auto op_end = std::chrono::high_resolution_clock::now();
+  trace_.AddSpan(packed_index_map_[packed_index], "op", ctx, 0, trace_begin, trace_.Now());
   double op_duration =
       std::chrono::duration_cast<std::chrono::duration<double>>(op_end - op_begin).count();
 
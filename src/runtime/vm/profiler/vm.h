@@ -32,13 +32,19 @@
 #include <unordered_map>
 #include <vector>
 
+#include "../../timeline.h"
+#include "../vm_stats.h"
+
 namespace tvm {
 namespace runtime {
 namespace vm {
 
 class VirtualMachineDebug : public VirtualMachine {
  public:
-  VirtualMachineDebug() : VirtualMachine() {}
+  VirtualMachineDebug() : VirtualMachine() {
+    timeline_ = &trace_;
+    stats_ = &profile_;
+  }
 
   PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
 
@@ -53,6 +59,13 @@ class VirtualMachineDebug : public VirtualMachine {
   std::unordered_map<Index, std::string> packed_index_map_;
   std::unordered_map<Index, std::vector<double>> op_durations_;
   std::unordered_map<Index, int> op_invokes_;
+  /*! \brief The timeline of the packed function calls, allocations and copies. */
+  Timeline trace_;
+  /*! \brief The counters of the instructions, allocations and copies. */
+  VMStats profile_;
+
+  /*! \return The statistics in JSON, see get_stat. */
+  std::string GetStatJSON();
 };
 
 }  // namespace vm
@@ -39,6 +39,15 @@ namespace vm {
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kTVMVMBytecodeMagic = 0xD225DE2F4214151D;
 
+/*!
+ * \brief The magic number opening a constant section whose tensor data is laid
+ *  out page-aligned after the tensor descriptions, so that it can be mapped.
+ */
+constexpr uint64_t kTVMVMMappedConstantMagic = 0xB2E4A81C3F6D5079;
+
+/*! \brief The alignment of the data block of a mapped constant section. */
+constexpr uint64_t kTVMVMConstantPageSize = 4096;
+
 template <typename T>
 static inline size_t VectorHash(size_t key, const std::vector<T>& values) {
   for (const auto& it : values) {
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file runtime/size_class_allocator.h
+ * \brief Pooled allocator rounding requests to geometric size classes,
+ *  with the free buffers spread over several thread caches.
+ */
+#ifndef TVM_RUNTIME_VM_SIZE_CLASS_ALLOCATOR_H_
+#define TVM_RUNTIME_VM_SIZE_CLASS_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/vm/memory_manager.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+class SizeClassAllocator final : public Allocator {
+ public:
+  static constexpr size_t kDefaultPageSize = 4096;
+  /*! \brief The number of size classes between two consecutive powers of two. */
+  static constexpr size_t kClassesPerDoubling = 4;
+  /*! \brief The number of thread caches, threads are assigned to them round-robin. */
+  static constexpr int kNumThreadCaches = 16;
+
+  explicit SizeClassAllocator(TVMContext ctx, size_t page_size = kDefaultPageSize)
+      : Allocator(kSizeClass),
+        page_size_(page_size),
+        used_memory_(0),
+        cached_memory_(0),
+        max_cached_memory_(DefaultMaxCachedMemory()),
+        ctx_(ctx) {}
+
+  ~SizeClassAllocator() { Trim(); }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    size_t size = SizeClass(nbytes);
+    int index = ThreadCacheIndex();
+    Buffer buf;
+    // look into the cache of this thread first, then into the others before
+    // going to the device.
+    for (int i = 0; i < kNumThreadCaches; ++i) {
+      if (caches_[(index + i) % kNumThreadCaches].Pop(size, &buf)) {
+        cached_memory_.fetch_sub(size, std::memory_order_relaxed);
+        return buf;
+      }
+    }
+    buf.ctx = ctx_;
+    buf.size = size;
+    buf.data = DeviceAPI::Get(ctx_)->AllocDataSpace(ctx_, size, alignment, type_hint);
+    used_memory_.fetch_add(size, std::memory_order_relaxed);
+    DLOG(INFO) << "allocate " << size << " B, used memory " << used_memory_ << " B";
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    size_t cached = cached_memory_.fetch_add(buffer.size, std::memory_order_relaxed);
+    if (cached + buffer.size > max_cached_memory_.load(std::memory_order_relaxed)) {
+      // over the high-water mark, give the buffer back to the device.
+      cached_memory_.fetch_sub(buffer.size, std::memory_order_relaxed);
+      Release(buffer);
+      return;
+    }
+    caches_[ThreadCacheIndex()].Push(buffer);
+    DLOG(INFO) << "reclaim buffer " << buffer.size;
+  }
+
+  void Trim() override {
+    for (int i = 0; i < kNumThreadCaches; ++i) {
+      std::vector<Buffer> buffers = caches_[i].PopAll();
+      for (const Buffer& buf : buffers) {
+        cached_memory_.fetch_sub(buf.size, std::memory_order_relaxed);
+        Release(buf);
+      }
+    }
+    DLOG(INFO) << "trim cached buffers, used memory " << used_memory_ << " B";
+  }
+
+  size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
+
+  /*!
+   * \brief Set the high-water mark of the memory kept in the caches, the
+   *  buffers freed beyond it are returned to the device.
+   * \param nbytes The maximum number of cached bytes.
+   */
+  void SetMaxCachedMemory(size_t nbytes) {
+    max_cached_memory_.store(nbytes, std::memory_order_relaxed);
+    if (cached_memory_.load(std::memory_order_relaxed) > nbytes) Trim();
+  }
+
+ private:
+  /*! \brief A set of free buffers binned by size class. */
+  class ThreadCache {
+   public:
+    bool Pop(size_t size, Buffer* buf) {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = bins_.find(size);
+      if (it == bins_.end() || it->second.empty()) return false;
+      *buf = it->second.back();
+      it->second.pop_back();
+      return true;
+    }
+    void Push(const Buffer& buf) {
+      std::lock_guard<std::mutex> lock(mu_);
+      bins_[buf.size].push_back(buf);
+    }
+    std::vector<Buffer> PopAll() {
+      std::lock_guard<std::mutex> lock(mu_);
+      std::vector<Buffer> ret;
+      for (auto& kv : bins_) {
+        ret.insert(ret.end(), kv.second.begin(), kv.second.end());
+      }
+      bins_.clear();
+      return ret;
+    }
+
+   private:
+    std::mutex mu_;
+    std::unordered_map<size_t, std::vector<Buffer>> bins_;
+    // pad to cache line to avoid false sharing between the caches.
+    char pad_[64];
+  };
+
+  /*!
+   * \brief Round the request up to its size class. Requests up to
+   *  kClassesPerDoubling pages are rounded to pages, larger ones to one
+   *  of the kClassesPerDoubling steps between two powers of two pages,
+   *  which bounds the wasted memory to 1 / kClassesPerDoubling.
+   */
+  size_t SizeClass(size_t nbytes) const {
+    size_t pages = std::max<size_t>((nbytes + page_size_ - 1) / page_size_, 1);
+    if (pages > kClassesPerDoubling) {
+      size_t base = 1;
+      while (base * 2 <= pages) base *= 2;
+      size_t step = base / kClassesPerDoubling;
+      pages = (pages + step - 1) / step * step;
+    }
+    return pages * page_size_;
+  }
+
+  void Release(const Buffer& buf) {
+    DeviceAPI::Get(buf.ctx)->FreeDataSpace(buf.ctx, buf.data);
+    used_memory_.fetch_sub(buf.size, std::memory_order_relaxed);
+  }
+
+  static int ThreadCacheIndex() {
+    static std::atomic<int> num_threads{0};
+    static thread_local int index = num_threads.fetch_add(1) % kNumThreadCaches;
+    return index;
+  }
+
+  static size_t DefaultMaxCachedMemory() {
+    const char* val = getenv("TVM_VM_MAX_CACHED_BYTES");
+    if (val == nullptr) return std::numeric_limits<size_t>::max();
+    return static_cast<size_t>(atoll(val));
+  }
+
+  size_t page_size_;
+  std::atomic<size_t> used_memory_;
+  std::atomic<size_t> cached_memory_;
+  std::atomic<size_t> max_cached_memory_;
+  ThreadCache caches_[kNumThreadCaches];
+  TVMContext ctx_;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_SIZE_CLASS_ALLOCATOR_H_
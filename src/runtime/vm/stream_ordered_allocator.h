@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/stream_ordered_allocator.h
+ */
+#ifndef TVM_RUNTIME_VM_STREAM_ORDERED_ALLOCATOR_H_
+#define TVM_RUNTIME_VM_STREAM_ORDERED_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/vm/memory_manager.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*!
+ * \brief Allocate from the memory pool of the device, ordered on the current
+ *  stream of the calling thread, e.g. cudaMallocAsync on CUDA. The freed memory
+ *  is reused by the following allocations on the stream without synchronizing
+ *  the device, so the pool is shared by the VMs running on different streams.
+ *  A buffer must be freed on the stream it was last used on.
+ */
+class StreamOrderedAllocator final : public Allocator {
+ public:
+  explicit StreamOrderedAllocator(TVMContext ctx)
+      : Allocator(kStreamOrdered), used_memory_(0), ctx_(ctx) {
+    std::string prefix = Prefix(ctx);
+    falloc_ = Registry::Get(prefix + ".alloc_async");
+    ffree_ = Registry::Get(prefix + ".free_async");
+    ftrim_ = Registry::Get(prefix + ".trim_async_pool");
+    CHECK(falloc_ != nullptr && ffree_ != nullptr)
+        << "The stream-ordered allocator is not supported on " << DeviceName(ctx.device_type);
+  }
+
+  /*! \brief Whether the device API of ctx provides the stream-ordered allocation. */
+  static bool IsSupported(TVMContext ctx) {
+    std::string prefix = Prefix(ctx);
+    return Registry::Get(prefix + ".alloc_async") != nullptr &&
+           Registry::Get(prefix + ".free_async") != nullptr;
+  }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    Buffer buf;
+    buf.ctx = ctx_;
+    buf.size = nbytes;
+    void* data = (*falloc_)(ctx_, static_cast<int64_t>(nbytes));
+    buf.data = data;
+    CHECK_EQ(reinterpret_cast<uintptr_t>(buf.data) % alignment, 0U)
+        << "The stream-ordered allocation is not aligned to " << alignment << " bytes";
+    used_memory_.fetch_add(nbytes, std::memory_order_relaxed);
+    DLOG(INFO) << "allocate " << nbytes << " B, used memory " << used_memory_ << " B";
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    (*ffree_)(buffer.ctx, buffer.data);
+    used_memory_.fetch_sub(buffer.size, std::memory_order_relaxed);
+    DLOG(INFO) << "free " << buffer.size << " B, used memory " << used_memory_ << " B";
+  }
+
+  size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
+
+  void Trim() override {
+    if (ftrim_ != nullptr) (*ftrim_)(ctx_);
+  }
+
+ private:
+  static std::string Prefix(TVMContext ctx) {
+    return std::string("device_api.") + DeviceName(ctx.device_type);
+  }
+
+  std::atomic<size_t> used_memory_;
+  TVMContext ctx_;
+  const PackedFunc* falloc_;
+  const PackedFunc* ffree_;
+  const PackedFunc* ftrim_;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_STREAM_ORDERED_ALLOCATOR_H_
@@ -24,17 +24,27 @@
 
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <tvm/runtime/threading_backend.h>
 #include <tvm/runtime/vm/vm.h>
 #include <tvm/support/logging.h>
 
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 #include <vector>
 
+#include "../pinned_staging.h"
+#include "../timeline.h"
+#include "../trace.h"
+#include "../weight_registry.h"
+#include "object_pool.h"
+#include "vm_stats.h"
+
 using namespace tvm::runtime;
 
 namespace tvm {
@@ -62,16 +72,6 @@ std::ostream& operator<<(std::ostream& os, const VMFunction& vm_func) {
   return os;
 }
 
-inline ObjectRef CopyTo(ObjectRef src, const DLContext& ctx) {
-  if (src->IsInstance<NDArray::ContainerType>()) {
-    auto nd_array = Downcast<NDArray>(src);
-    if (nd_array->ctx.device_type != ctx.device_type) {
-      return nd_array.CopyTo(ctx);
-    }
-  }
-  return src;
-}
-
 std::vector<int64_t> ToShape(NDArray shape_tensor) {
   std::vector<int64_t> shape;
   auto rank = shape_tensor.Shape().size();
@@ -152,18 +152,122 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
           << "The number of provided parameters doesn't match the number of arguments";
       std::vector<ObjectRef> func_args(param_names.size());
       for (int i = 1; i < args.size(); ++i) {
-        ObjectRef obj = CopyTo(args[i], ctx);
+        ObjectRef arg = args[i];
+        const auto* array = arg.as<NDArray::ContainerType>();
+        if (pinned_staging_ != nullptr && array != nullptr &&
+            PinnedStaging::CanStage(array->dl_tensor.ctx, ctx)) {
+          const DLTensor* src = &array->dl_tensor;
+          if (stats_) stats_->AddCopy(src->ctx, ctx, static_cast<int64_t>(GetDataSize(*src)));
+          NDArray dst = NDArray::Empty(std::vector<int64_t>(src->shape, src->shape + src->ndim),
+                                       src->dtype, ctx);
+          pinned_staging_->Copy(i - 1, src, const_cast<DLTensor*>(dst.operator->()),
+                                GetStream(ctx));
+          func_args[i - 1] = dst;
+          continue;
+        }
+        ObjectRef obj = this->CopyTo(arg, ctx);
         func_args[i - 1] = obj;
       }
       inputs_.erase(func_name);
       inputs_.emplace(func_name, func_args);
     });
+  } else if (name == "set_static_memory_plan") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      static_memory_plan_ = args[0];
+      if (!static_memory_plan_) memory_plan_.clear();
+    });
+  } else if (name == "set_share_constants") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      share_constants_ = args[0];
+      const_pool_.clear();
+    });
+  } else if (name == "set_shape_func_cache") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int size = args[0];
+      CHECK_GE(size, 0);
+      shape_func_cache_size_ = static_cast<size_t>(size);
+      shape_func_cache_.clear();
+    });
+  } else if (name == "set_async_execution") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetAsyncExecution(args[0]); });
+  } else if (name == "set_pinned_staging") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      bool enable = args[0];
+      if (!enable) {
+        pinned_staging_.reset();
+      } else if (pinned_staging_ == nullptr) {
+        pinned_staging_ = std::make_shared<PinnedStaging>();
+      }
+    });
+  } else if (name == "set_thread_pool_partition") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      thread_pool_partition_ = args[0].operator std::string();
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](TVMArgs args, TVMRetValue* rv) {});
   }
 }
 
+VirtualMachine::~VirtualMachine() {
+  this->SetAsyncExecution(false);
+  // The objects still referenced outside of the VM keep the pool alive.
+  if (object_pool_) object_pool_->Release();
+}
+
+void VirtualMachine::SetAsyncExecution(bool async) {
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (streams_[i] == nullptr) continue;
+    DeviceAPI* api = DeviceAPI::Get(ctxs_[i]);
+    api->StreamSync(ctxs_[i], streams_[i]);
+    api->FreeStream(ctxs_[i], streams_[i]);
+  }
+  streams_.clear();
+  async_execution_ = async;
+}
+
+TVMStreamHandle VirtualMachine::GetStream(const TVMContext& ctx) const {
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (ctxs_[i].device_type == ctx.device_type && ctxs_[i].device_id == ctx.device_id) {
+      return streams_[i];
+    }
+  }
+  return nullptr;
+}
+
+ObjectRef VirtualMachine::CopyTo(const ObjectRef& src, const TVMContext& ctx) const {
+  const auto* array = src.as<NDArray::ContainerType>();
+  if (array == nullptr) {
+    return src;
+  }
+  auto nd_array = Downcast<NDArray>(src);
+  if (array->dl_tensor.ctx.device_type == ctx.device_type) {
+    // The kernels take compact arrays at the data pointer, other views are compacted.
+    if (nd_array.IsContiguous() && array->dl_tensor.byte_offset == 0) {
+      return src;
+    }
+    if (nd_array.IsContiguous() && IsAddressableContext(array->dl_tensor.ctx)) {
+      return nd_array.CreateView(nd_array.Shape(), nd_array->dtype);
+    }
+  }
+  if (stats_) {
+    stats_->AddCopy(nd_array->ctx, ctx, static_cast<int64_t>(GetDataSize(*nd_array.operator->())));
+  }
+  TVMContext device = ctx.device_type == kDLCPU ? nd_array->ctx : ctx;
+  TVMStreamHandle stream = GetStream(device);
+  if (stream == nullptr) {
+    return nd_array.CopyTo(ctx);
+  }
+  NDArray ret = NDArray::Empty(nd_array.Shape(), nd_array->dtype, ctx);
+  NDArray::CopyFromTo(nd_array.operator->(), const_cast<DLTensor*>(ret.operator->()), stream);
+  if (ctx.device_type == kDLCPU) {
+    // The host reads the result right away.
+    DeviceAPI::Get(device)->StreamSync(device, stream);
+  }
+  return ret;
+}
+
 TVMContext VirtualMachine::GetParamsContext() const {
   CHECK(!ctxs_.empty()) << "Context has not been initialized yet.";
 
@@ -178,9 +282,20 @@ TVMContext VirtualMachine::GetParamsContext() const {
   return (cit == ctxs_.end() ? ctxs_[0] : *cit);
 }
 
-void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func) {
-  auto frame = VMFrame(ret_pc, func_index_, arg_count, code_, vm_func.register_file_size);
-  frames_.push_back(frame);
+void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, Index func_index) {
+  const VMFunction& vm_func = exec_->functions[func_index];
+  Index base = 0;
+  if (!frames_.empty()) {
+    base = frames_.back().register_base + frames_.back().register_file_size;
+  }
+  size_t top = static_cast<size_t>(base + vm_func.register_file_size);
+  if (register_stack_.size() < top) {
+    register_stack_.resize(top);
+  }
+  // The frame keeps the caller's function index, PopFrame restores it.
+  frames_.emplace_back(ret_pc, func_index_, arg_count, code_, base, vm_func.register_file_size);
+  func_index_ = func_index;
+  registers_ = register_stack_.data() + base;
 }
 
 Index VirtualMachine::PopFrame() {
@@ -189,15 +304,41 @@ Index VirtualMachine::PopFrame() {
   func_index_ = fr.func_index;
   code_ = fr.code;
   pc_ = fr.pc;
+  // Release the objects held by the frame, the registers stay for the next call.
+  for (Index i = 0; i < fr.register_file_size; ++i) {
+    registers_[i] = ObjectRef();
+  }
   auto call_stack_size = frames_.size();
   frames_.pop_back();
+  registers_ = frames_.empty() ? nullptr : register_stack_.data() + frames_.back().register_base;
   return call_stack_size;
 }
 
-void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<ObjectRef>& args) {
+void VirtualMachine::InvokeLocal(Index func_index, const std::vector<ObjectRef>* free_vars,
+                                 Index num_args, const RegName* arg_registers, RegName dst) {
+  const VMFunction& func = exec_->functions[func_index];
+  // Arguments are read by offset, pushing the frame may grow the register stack.
+  Index caller_base = frames_.back().register_base;
+  PushFrame(func.params.size(), this->pc_ + 1, func_index);
+  Index i = 0;
+  if (free_vars) {
+    for (const auto& free_var : *free_vars) {
+      registers_[i++] = free_var;
+    }
+  }
+  for (Index j = 0; j < num_args; ++j) {
+    registers_[i++] = register_stack_[caller_base + arg_registers[j]];
+  }
+  frames_.back().caller_return_register = dst;
+  code_ = func.instructions.data();
+  pc_ = 0;
+}
+
+void VirtualMachine::InvokeGlobal(Index func_index, const std::vector<ObjectRef>& args) {
+  const VMFunction& func = exec_->functions[func_index];
   DLOG(INFO) << "Invoking global " << func.name << " " << args.size();
 
-  PushFrame(func.params.size(), this->pc_ + 1, func);
+  PushFrame(func.params.size(), this->pc_ + 1, func_index);
   for (size_t i = 0; i < args.size(); ++i) {
     WriteRegister(i, args[i]);
   }
@@ -209,8 +350,37 @@ void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<Obje
 
 ObjectRef VirtualMachine::Invoke(const VMFunction& func, const std::vector<ObjectRef>& args) {
   DLOG(INFO) << "Executing Function: " << std::endl << func;
+  threading::ThreadPoolPartitionScope partition_scope(thread_pool_partition_);
+  // drop the result of the previous invocation, which has been handed to the caller,
+  // so that its storage can be reused.
+  return_register_ = ObjectRef();
+
+  if (async_execution_ && streams_.empty()) {
+    for (const auto& ctx : ctxs_) {
+      streams_.push_back(ctx.device_type == kDLCPU ? nullptr
+                                                   : DeviceAPI::Get(ctx)->CreateStream(ctx));
+    }
+  }
+  // Kernels launch on the current stream of their device.
+  struct StreamScope {
+    const std::vector<TVMContext>& ctxs;
+    const std::vector<TVMStreamHandle>& streams;
+    StreamScope(const std::vector<TVMContext>& ctxs, const std::vector<TVMStreamHandle>& streams)
+        : ctxs(ctxs), streams(streams) {
+      Set(false);
+    }
+    ~StreamScope() { Set(true); }
+    void Set(bool reset) {
+      for (size_t i = 0; i < streams.size(); ++i) {
+        if (streams[i] == nullptr) continue;
+        DeviceAPI* api = DeviceAPI::Get(ctxs[i]);
+        if (reset) api->StreamSync(ctxs[i], streams[i]);
+        api->SetStream(ctxs[i], reset ? nullptr : streams[i]);
+      }
+    }
+  } stream_scope(ctxs_, streams_);
 
-  InvokeGlobal(func, args);
+  InvokeGlobal(exec_->global_map.at(func.name), args);
   RunLoop();
   return return_register_;
 }
@@ -219,9 +389,8 @@ ObjectRef VirtualMachine::Invoke(const std::string& name, const std::vector<Obje
   CHECK(exec_) << "The executable has not been created yet.";
   auto it = exec_->global_map.find(name);
   CHECK(it != exec_->global_map.end()) << "Cannot find function " << name << " in the executable";
-  auto func_index_ = it->second;
-  DLOG(INFO) << "Invoke Global " << name << " at index " << func_index_;
-  return Invoke(exec_->functions[func_index_], args);
+  DLOG(INFO) << "Invoke Global " << name << " at index " << it->second;
+  return Invoke(exec_->functions[it->second], args);
 }
 
 void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, Index arg_count,
@@ -252,6 +421,16 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
     }
   }
 
+  TVM_TRACE_SPAN(kOp, packed_names_[packed_index], -1);
+  TVMBackendPackedCFunc faddr = packed_cfuncs_[packed_index];
+  if (faddr != nullptr) {
+    TVMValue ret_value;
+    int ret_type_code = kTVMNullptr;
+    int ret = (*faddr)(values.data(), codes.data(), static_cast<int>(arity), &ret_value,
+                       &ret_type_code, nullptr);
+    CHECK_EQ(ret, 0) << TVMGetLastError();
+    return;
+  }
   TVMRetValue rv;
   func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
 }
@@ -259,25 +438,57 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
 void VirtualMachine::LoadExecutable(const Executable* exec) {
   CHECK(exec) << "The executable is not created yet.";
   exec_ = exec;
-
+  if (object_pool_ == nullptr) object_pool_ = VMObjectPool::Create();
+  memory_plan_.clear();
+  const_pool_.clear();
+  // Resolved once per executable, loading it is cheap for every VM after the first.
+  packed_funcs_ = &exec_->GetPackedFuncs();
+  // The compile engine names the lowered shape functions after "shape_func".
+  is_shape_func_.assign(packed_funcs_->size(), false);
+  packed_cfuncs_.assign(packed_funcs_->size(), nullptr);
+  packed_names_.assign(packed_funcs_->size(), std::string());
   runtime::Module lib = exec_->lib;
-  // Get the list of packed functions.
-  CHECK(exec->primitive_map.empty() || lib.operator->())
-      << "runtime module should have been built for primitive functions"
-      << "\n";
   for (const auto& it : exec_->primitive_map) {
-    const auto& packed_name = it.first;
-    auto packed_index = static_cast<size_t>(it.second);
-    if (packed_funcs_.size() <= packed_index) {
-      packed_funcs_.resize(packed_index + 1);
-    }
-    tvm::runtime::PackedFunc pf = lib.GetFunction(packed_name, true);
-    CHECK(pf != nullptr) << "Cannot find function in module: " << packed_name;
-    packed_funcs_[packed_index] = pf;
+    packed_cfuncs_[it.second] = lib->GetPackedCFunc(it.first, true);
+    packed_names_[it.second] = it.first;
+  }
+  for (const auto& it : exec_->primitive_map) {
+    is_shape_func_[it.second] = it.first.compare(0, 10, "shape_func") == 0;
   }
-  for (size_t i = 0; i < packed_funcs_.size(); ++i) {
-    CHECK(packed_funcs_[i] != nullptr) << "Packed function " << i << " is not initialized";
+  shape_func_cache_.clear();
+}
+
+bool VirtualMachine::GetShapeFuncKey(Index num_inputs, const std::vector<ObjectRef>& args,
+                                     std::string* key) const {
+  // Shape inputs are a few integers, larger data dependent inputs are not worth hashing.
+  constexpr size_t kMaxKeyBytes = 1024;
+  key->clear();
+  auto append = [key](const void* data, size_t size) {
+    key->append(static_cast<const char*>(data), size);
+  };
+  auto add_tensor = [&](const ObjectRef& obj) {
+    const auto* array = obj.as<NDArray::ContainerType>();
+    if (array == nullptr) return false;
+    const DLTensor& tensor = array->dl_tensor;
+    if (tensor.ctx.device_type != kDLCPU || !IsContiguous(tensor)) return false;
+    size_t nbytes = GetDataSize(tensor);
+    if (key->size() + nbytes > kMaxKeyBytes) return false;
+    append(&tensor.dtype, sizeof(tensor.dtype));
+    append(&tensor.ndim, sizeof(tensor.ndim));
+    append(tensor.shape, sizeof(int64_t) * tensor.ndim);
+    append(static_cast<const char*>(tensor.data) + tensor.byte_offset, nbytes);
+    return true;
+  };
+  for (Index i = 0; i < num_inputs; ++i) {
+    if (const auto* adt = args[i].as<ADTObj>()) {
+      for (size_t fi = 0; fi < adt->size; ++fi) {
+        if (!add_tensor((*adt)[fi])) return false;
+      }
+    } else if (!add_tensor(args[i])) {
+      return false;
+    }
   }
+  return true;
 }
 
 void VirtualMachine::Init(const std::vector<TVMContext>& ctxs,
@@ -290,18 +501,14 @@ void VirtualMachine::Init(const std::vector<TVMContext>& ctxs,
   }
 }
 
-inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) {
-  frames_.back().register_file[r] = val;
-}
+inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) { registers_[r] = val; }
 
-inline ObjectRef VirtualMachine::ReadRegister(Index r) const {
-  return frames_.back().register_file[r];
-}
+inline ObjectRef VirtualMachine::ReadRegister(Index r) const { return registers_[r]; }
 
 inline int64_t VirtualMachine::LoadScalarInt(Index r) const {
   int64_t result = 0;
   const auto& obj = ReadRegister(r);
-  NDArray array = Downcast<NDArray>(CopyTo(obj, {kDLCPU, 0}));
+  NDArray array = Downcast<NDArray>(this->CopyTo(obj, {kDLCPU, 0}));
 
   switch (array->dtype.bits) {
     case 1: {
@@ -330,237 +537,415 @@ inline int64_t VirtualMachine::LoadScalarInt(Index r) const {
   return result;
 }
 
+Storage VirtualMachine::AllocateStorage(const Instruction& instr, int64_t size, Index alignment,
+                                        DLDataType dtype_hint) {
+  if (static_memory_plan_) {
+    // Replay the storage of the previous invocation when nothing but
+    // the plan refers to it, e.g. the returned tensors have been released.
+    auto pit = memory_plan_.find(&instr);
+    if (pit != memory_plan_.end() && pit->second.second.unique() && size <= pit->second.first) {
+      if (stats_) {
+        stats_->allocs[&instr].count++;
+        stats_->allocs[&instr].replayed++;
+      }
+      return pit->second.second;
+    }
+  }
+
+  auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
+  auto it = allocators_.find(ctxs_[0]);
+  CHECK(it != allocators_.end()) << "Did you forget to init the VirtualMachine with contexts?";
+  auto alloc = it->second;
+  auto alloc_begin = stats_ ? VMStats::Clock::now() : VMStats::Clock::time_point();
+  storage_obj->buffer = alloc->Alloc(size, alignment, dtype_hint);
+  TVM_TRACE_INSTANT(kAlloc, "alloc_storage", size);
+  if (stats_) {
+    auto& site = stats_->allocs[&instr];
+    site.count++;
+    site.bytes += size;
+    site.time_us +=
+        std::chrono::duration<double, std::micro>(VMStats::Clock::now() - alloc_begin).count();
+    stats_->AddUsedMemory(ctxs_[0], static_cast<int64_t>(alloc->UsedMemory()));
+  }
+  if (timeline_) {
+    timeline_->AddInstant("alloc_storage", "alloc", ctxs_[0], 0, {{"bytes", size}});
+  }
+  Storage storage(storage_obj);
+  if (static_memory_plan_) {
+    auto pit = memory_plan_.find(&instr);
+    // record the first allocation, or a replacement once the shapes changed.
+    if (pit == memory_plan_.end() || pit->second.second.unique()) {
+      memory_plan_[&instr] = std::make_pair(size, storage);
+    }
+  }
+  return storage;
+}
+
+/*! \brief Iterate over the objects held by a list of registers of a frame. */
+class RegisterIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = ObjectRef;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const ObjectRef*;
+  using reference = const ObjectRef&;
+
+  RegisterIterator(const ObjectRef* registers, const RegName* reg)
+      : registers_(registers), reg_(reg) {}
+
+  reference operator*() const { return registers_[*reg_]; }
+  RegisterIterator& operator++() {
+    ++reg_;
+    return *this;
+  }
+  RegisterIterator operator++(int) {
+    RegisterIterator it = *this;
+    ++reg_;
+    return it;
+  }
+  bool operator==(const RegisterIterator& other) const { return reg_ == other.reg_; }
+  bool operator!=(const RegisterIterator& other) const { return reg_ != other.reg_; }
+
+ private:
+  const ObjectRef* registers_;
+  const RegName* reg_;
+};
+
+// Threaded dispatch: with the labels-as-values extension each handler ends by
+// fetching the next instruction and jumping straight to its handler, so every
+// handler has its own indirect branch instead of sharing the one of the switch.
+// Every case carries a label so the table can address it; the switch remains
+// the fallback for other compilers.
+#if defined(__GNUC__) || defined(__clang__)
+#define TVM_VM_THREADED_DISPATCH 1
+#else
+#define TVM_VM_THREADED_DISPATCH 0
+#endif
+#define TVM_VM_OP_LABEL(op) op_##op
+
+#if USE_RELAY_DEBUG
+#define TVM_VM_PRINT_INSTRUCTION(instr) InstructionPrint(std::cout, instr)
+#else
+#define TVM_VM_PRINT_INSTRUCTION(instr)
+#endif  // USE_RELAY_DEBUG
+
+// Point instr at the instruction at pc_.
+#define TVM_VM_FETCH()                                  \
+  instr = &code_[this->pc_];                            \
+  DLOG(INFO) << "Executing(" << pc_ << "): " << *instr; \
+  TVM_VM_PRINT_INSTRUCTION(*instr);                     \
+  if (stats_) stats_->Dispatch(instr->op)
+
+// Run the instruction at pc_, the last statement of every handler.
+#if TVM_VM_THREADED_DISPATCH
+#define DISPATCH()                                                                \
+  {                                                                               \
+    TVM_VM_FETCH();                                                               \
+    goto* dispatch_table[std::min(static_cast<size_t>(instr->op), kNumOpcodes)]; \
+  }
+#else
+#define DISPATCH() continue
+#endif  // TVM_VM_THREADED_DISPATCH
+
 void VirtualMachine::RunLoop() {
   CHECK(this->exec_);
   CHECK(this->code_);
+#if TVM_VM_THREADED_DISPATCH
+  // Indexed by opcode, must follow the order of the Opcode enum. The last entry
+  // catches the unknown opcodes.
+  static void* const dispatch_table[] = {
+      &&op_Move,          &&op_Ret,          &&op_Invoke,         &&op_InvokeClosure,
+      &&op_InvokePacked,  &&op_AllocTensor,  &&op_AllocTensorReg, &&op_AllocADT,
+      &&op_AllocClosure,  &&op_GetField,     &&op_If,             &&op_LoadConst,
+      &&op_Goto,          &&op_GetTag,       &&op_LoadConsti,     &&op_Fatal,
+      &&op_AllocStorage,  &&op_ShapeOf,      &&op_ReshapeTensor,  &&op_AllocStorageTensor,
+      &&op_Unknown,
+  };
+  constexpr size_t kNumOpcodes = sizeof(dispatch_table) / sizeof(dispatch_table[0]) - 1;
+#endif  // TVM_VM_THREADED_DISPATCH
   pc_ = 0;
   Index frame_start = frames_.size();
+  const Instruction* instr;
   while (true) {
-  main_loop:
-    auto const& instr = code_[this->pc_];
-    DLOG(INFO) << "Executing(" << pc_ << "): " << instr;
-#if USE_RELAY_DEBUG
-    InstructionPrint(std::cout, instr);
-#endif  // USE_RELAY_DEBUG
-
-    switch (instr.op) {
-      case Opcode::Move: {
+#if TVM_VM_THREADED_DISPATCH
+    DISPATCH();
+#else
+    TVM_VM_FETCH();
+#endif  // TVM_VM_THREADED_DISPATCH
+
+    switch (instr->op) {
+      case Opcode::Move:
+      TVM_VM_OP_LABEL(Move) : {
         ObjectRef from_obj;
-        from_obj = ReadRegister(instr.from);
-        WriteRegister(instr.dst, from_obj);
+        from_obj = ReadRegister(instr->from);
+        WriteRegister(instr->dst, from_obj);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::Fatal: {
+      case Opcode::Fatal:
+      TVM_VM_OP_LABEL(Fatal) : {
         throw std::runtime_error("VM encountered fatal error");
       }
-      case Opcode::LoadConst: {
-        auto constant_obj = exec_->constants[instr.const_index];
+      case Opcode::LoadConst:
+      TVM_VM_OP_LABEL(LoadConst) : {
         // We cache the allocated object in the constant pool. To measure, the
         // first iteration will set the pool up. The other iterations will
         // directly reuse the allocated objects.
-        if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
-          const_pool_.resize(instr.const_index + 1);
+        if (const_pool_.size() <= static_cast<size_t>(instr->const_index)) {
+          const_pool_.resize(instr->const_index + 1);
         }
 
-        if (!const_pool_[instr.const_index].defined()) {
+        if (!const_pool_[instr->const_index].defined()) {
           // TODO(wweic) ctx could be obtained from the ctxs list.
-          const_pool_[instr.const_index] = CopyTo(constant_obj, ctxs_[0]);
+          double copy_begin = timeline_ ? timeline_->Now() : 0;
+          const auto& constant_obj = exec_->constants[instr->const_index];
+          if (share_constants_ && constant_obj.as<NDArray::ContainerType>()) {
+            const_pool_[instr->const_index] =
+                WeightRegistry::Global()->Acquire(Downcast<NDArray>(constant_obj), ctxs_[0]);
+          } else {
+            // The device copy is made once and shared by the VMs running the executable.
+            bool copied = false;
+            const_pool_[instr->const_index] =
+                exec_->GetConstant(instr->const_index, ctxs_[0], &copied);
+            if (stats_ && copied) {
+              const auto& host = Downcast<NDArray>(exec_->constants[instr->const_index]);
+              stats_->AddCopy(host->ctx, ctxs_[0],
+                              static_cast<int64_t>(GetDataSize(*host.operator->())));
+            }
+          }
+          if (timeline_) {
+            timeline_->AddSpan("load_const", "copy", ctxs_[0], 0, copy_begin, timeline_->Now(),
+                               {{"const_index", instr->const_index}});
+          }
         }
-        WriteRegister(instr.dst, const_pool_[instr.const_index]);
+        WriteRegister(instr->dst, const_pool_[instr->const_index]);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::LoadConsti: {
+      case Opcode::LoadConsti:
+      TVM_VM_OP_LABEL(LoadConsti) : {
         auto tensor = NDArray::Empty({1}, {kDLInt, 64, 1}, {kDLCPU, 0});
-        reinterpret_cast<int64_t*>(tensor->data)[0] = instr.load_consti.val;
-        WriteRegister(instr.dst, tensor);
+        reinterpret_cast<int64_t*>(tensor->data)[0] = instr->load_consti.val;
+        WriteRegister(instr->dst, tensor);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::Invoke: {
-        std::vector<ObjectRef> args;
-        for (Index i = 0; i < instr.num_args; ++i) {
-          args.push_back(ReadRegister(instr.invoke_args_registers[i]));
-        }
-        InvokeGlobal(exec_->functions[instr.func_index], args);
-        frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+      case Opcode::Invoke:
+      TVM_VM_OP_LABEL(Invoke) : {
+        InvokeLocal(instr->func_index, nullptr, instr->num_args, instr->invoke_args_registers,
+                    instr->dst);
+        DISPATCH();
       }
-      case Opcode::InvokePacked: {
-        DLOG(INFO) << "InvokedPacked " << instr.packed_index << " arity=" << instr.arity;
-        CHECK_LE(instr.packed_index, packed_funcs_.size());
-        const auto& func = packed_funcs_[instr.packed_index];
-        const auto& arity = instr.arity;
+      case Opcode::InvokePacked:
+      TVM_VM_OP_LABEL(InvokePacked) : {
+        DLOG(INFO) << "InvokedPacked " << instr->packed_index << " arity=" << instr->arity;
+        CHECK_LE(instr->packed_index, packed_funcs_->size());
+        const auto& func = (*packed_funcs_)[instr->packed_index];
+        const auto& arity = instr->arity;
         std::vector<ObjectRef> args;
         for (Index i = 0; i < arity; ++i) {
-          DLOG(INFO) << "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
+          DLOG(INFO) << "arg" << i << " $" << instr->packed_args[i];
+          auto arg = ReadRegister(instr->packed_args[i]);
           args.push_back(arg);
         }
 
+        std::string key;
+        Index num_inputs = arity - instr->output_size;
+        if (shape_func_cache_size_ != 0 && is_shape_func_[instr->packed_index] &&
+            GetShapeFuncKey(num_inputs, args, &key)) {
+          // Shape functions are pure, recurring input shapes reuse the memoized outputs.
+          auto& cache = shape_func_cache_[instr->packed_index];
+          auto it = cache.find(key);
+          if (it != cache.end()) {
+            for (Index i = 0; i < instr->output_size; ++i) {
+              Downcast<NDArray>(args[num_inputs + i]).CopyFrom(it->second[i]);
+            }
+          } else {
+            InvokePacked(instr->packed_index, func, arity, instr->output_size, args);
+            if (cache.size() < shape_func_cache_size_) {
+              std::vector<NDArray> outputs;
+              for (Index i = 0; i < instr->output_size; ++i) {
+                outputs.push_back(Downcast<NDArray>(args[num_inputs + i]).CopyTo({kDLCPU, 0}));
+              }
+              cache.emplace(std::move(key), std::move(outputs));
+            }
+          }
+          pc_++;
+          DISPATCH();
+        }
+
         // We no longer need to write the registers back, we write directly
         // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        InvokePacked(instr->packed_index, func, arity, instr->output_size, args);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::InvokeClosure: {
-        auto object = ReadRegister(instr.closure);
+      case Opcode::InvokeClosure:
+      TVM_VM_OP_LABEL(InvokeClosure) : {
+        auto object = ReadRegister(instr->closure);
         const auto* closure = object.as<VMClosureObj>();
-
-        std::vector<ObjectRef> args;
-        for (auto free_var : closure->free_vars) {
-          args.push_back(free_var);
-        }
-        for (Index i = 0; i < instr.num_closure_args; ++i) {
-          args.push_back(ReadRegister(instr.closure_args[i]));
-        }
-        InvokeGlobal(exec_->functions[closure->func_index], args);
-        frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+        InvokeLocal(closure->func_index, &closure->free_vars, instr->num_closure_args,
+                    instr->closure_args, instr->dst);
+        DISPATCH();
       }
-      case Opcode::GetField: {
-        auto object = ReadRegister(instr.object);
+      case Opcode::GetField:
+      TVM_VM_OP_LABEL(GetField) : {
+        auto object = ReadRegister(instr->object);
         const auto& tuple = Downcast<ADT>(object);
-        auto field = tuple[instr.field_index];
-        WriteRegister(instr.dst, field);
+        auto field = tuple[instr->field_index];
+        WriteRegister(instr->dst, field);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::GetTag: {
-        auto object = ReadRegister(instr.get_tag.object);
+      case Opcode::GetTag:
+      TVM_VM_OP_LABEL(GetTag) : {
+        auto object = ReadRegister(instr->get_tag.object);
         const auto& adt = Downcast<ADT>(object);
         auto tag = adt.tag();
         auto tag_tensor = NDArray::Empty({1}, {kDLInt, 32, 1}, {kDLCPU, 0});
         reinterpret_cast<int32_t*>(tag_tensor->data)[0] = tag;
-        WriteRegister(instr.dst, tag_tensor);
+        WriteRegister(instr->dst, tag_tensor);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::Goto: {
-        pc_ += instr.pc_offset;
-        goto main_loop;
+      case Opcode::Goto:
+      TVM_VM_OP_LABEL(Goto) : {
+        pc_ += instr->pc_offset;
+        DISPATCH();
       }
-      case Opcode::If: {
-        int32_t test_val = LoadScalarInt(instr.if_op.test);
-        int32_t target_val = LoadScalarInt(instr.if_op.target);
+      case Opcode::If:
+      TVM_VM_OP_LABEL(If) : {
+        int32_t test_val = LoadScalarInt(instr->if_op.test);
+        int32_t target_val = LoadScalarInt(instr->if_op.target);
 
         if (test_val == target_val) {
-          CHECK_NE(instr.if_op.true_offset, 0);
-          pc_ += instr.if_op.true_offset;
+          CHECK_NE(instr->if_op.true_offset, 0);
+          pc_ += instr->if_op.true_offset;
         } else {
-          CHECK_NE(instr.if_op.false_offset, 0);
-          pc_ += instr.if_op.false_offset;
+          CHECK_NE(instr->if_op.false_offset, 0);
+          pc_ += instr->if_op.false_offset;
         }
 
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::AllocTensor: {
-        auto shape = std::vector<int64_t>(instr.alloc_tensor.ndim);
+      case Opcode::AllocTensor:
+      TVM_VM_OP_LABEL(AllocTensor) : {
+        auto shape = std::vector<int64_t>(instr->alloc_tensor.ndim);
 
-        for (uint32_t i = 0; i < instr.alloc_tensor.ndim; ++i) {
-          shape[i] = instr.alloc_tensor.shape[i];
+        for (uint32_t i = 0; i < instr->alloc_tensor.ndim; ++i) {
+          shape[i] = instr->alloc_tensor.shape[i];
         }
 
-        auto storage_obj = ReadRegister(instr.alloc_tensor.storage);
-        auto offset = LoadScalarInt(instr.alloc_tensor.offset);
+        auto storage_obj = ReadRegister(instr->alloc_tensor.storage);
+        auto offset = LoadScalarInt(instr->alloc_tensor.offset);
         auto storage = Downcast<Storage>(storage_obj);
-        auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor.dtype);
+        auto obj = storage->AllocNDArray(offset, shape, instr->alloc_tensor.dtype);
 
-        WriteRegister(instr.dst, obj);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::AllocTensorReg: {
+      case Opcode::AllocTensorReg:
+      TVM_VM_OP_LABEL(AllocTensorReg) : {
         DLContext cpu_ctx;
         cpu_ctx.device_type = kDLCPU;
         cpu_ctx.device_id = 0;
-        auto shape_obj = ReadRegister(instr.alloc_tensor_reg.shape_register);
-        NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_ctx));
+        auto shape_obj = ReadRegister(instr->alloc_tensor_reg.shape_register);
+        NDArray shape_tensor = Downcast<NDArray>(this->CopyTo(shape_obj, cpu_ctx));
         auto shape = ToShape(shape_tensor);
-        auto storage_obj = ReadRegister(instr.alloc_tensor_reg.storage);
+        auto storage_obj = ReadRegister(instr->alloc_tensor_reg.storage);
         auto storage = Downcast<Storage>(storage_obj);
-        auto offset = LoadScalarInt(instr.alloc_tensor.offset);
-        auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor_reg.dtype);
+        auto offset = LoadScalarInt(instr->alloc_tensor.offset);
+        auto obj = storage->AllocNDArray(offset, shape, instr->alloc_tensor_reg.dtype);
 
-        WriteRegister(instr.dst, obj);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::AllocADT: {
-        std::vector<ObjectRef> fields;
-        for (Index i = 0; i < instr.num_fields; ++i) {
-          fields.push_back(ReadRegister(instr.datatype_fields[i]));
-        }
-        ObjectRef obj = ADT(instr.constructor_tag, fields);
-        WriteRegister(instr.dst, obj);
+      case Opcode::AllocADT:
+      TVM_VM_OP_LABEL(AllocADT) : {
+        RegisterIterator fields(registers_, instr->datatype_fields);
+        RegisterIterator fields_end(registers_, instr->datatype_fields + instr->num_fields);
+        ObjectRef obj = ADT(object_pool_, instr->constructor_tag, fields, fields_end);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::AllocClosure: {
-        std::vector<ObjectRef> free_vars;
-        for (Index i = 0; i < instr.num_freevar; i++) {
-          free_vars.push_back(ReadRegister(instr.free_vars[i]));
-        }
-        WriteRegister(instr.dst, VMClosure(instr.func_index, free_vars));
+      case Opcode::AllocClosure:
+      TVM_VM_OP_LABEL(AllocClosure) : {
+        auto closure = object_pool_->make_object<VMClosureObj>();
+        closure->func_index = instr->func_index;
+        RegisterIterator free_vars(registers_, instr->free_vars);
+        RegisterIterator free_vars_end(registers_, instr->free_vars + instr->num_freevar);
+        closure->free_vars.assign(free_vars, free_vars_end);
+        WriteRegister(instr->dst, VMClosure(closure));
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::AllocStorage: {
-        auto size = LoadScalarInt(instr.alloc_storage.allocation_size);
-        auto alignment = instr.alloc_storage.alignment;
+      case Opcode::AllocStorage:
+      TVM_VM_OP_LABEL(AllocStorage) : {
+        auto size = LoadScalarInt(instr->alloc_storage.allocation_size);
+        auto alignment = instr->alloc_storage.alignment;
 
         DLOG(INFO) << "AllocStorage: allocation_size=" << size << "alignment=" << alignment
-                   << "dtype_hint=" << DLDataType2String(instr.alloc_storage.dtype_hint);
-
-        auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
-        auto it = allocators_.find(ctxs_[0]);
-        CHECK(it != allocators_.end())
-            << "Did you forget to init the VirtualMachine with contexts?";
-        auto alloc = it->second;
-        storage_obj->buffer = alloc->Alloc(size, alignment, instr.alloc_storage.dtype_hint);
-        Storage storage(storage_obj);
-        WriteRegister(instr.dst, storage);
+                   << "dtype_hint=" << DLDataType2String(instr->alloc_storage.dtype_hint);
+
+        WriteRegister(instr->dst,
+                      AllocateStorage(*instr, size, alignment, instr->alloc_storage.dtype_hint));
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::ShapeOf: {
-        auto input = ReadRegister(instr.shape_of.tensor);
+      case Opcode::AllocStorageTensor:
+      TVM_VM_OP_LABEL(AllocStorageTensor) : {
+        const auto& fused = instr->alloc_storage_tensor;
+        auto size = LoadScalarInt(fused.allocation_size);
+        auto storage = AllocateStorage(*instr, size, fused.alignment, fused.dtype_hint);
+        auto offset = LoadScalarInt(fused.offset);
+        std::vector<int64_t> shape(fused.shape, fused.shape + fused.ndim);
+        WriteRegister(instr->dst, storage->AllocNDArray(offset, shape, fused.dtype));
+        pc_++;
+        DISPATCH();
+      }
+      case Opcode::ShapeOf:
+      TVM_VM_OP_LABEL(ShapeOf) : {
+        auto input = ReadRegister(instr->shape_of.tensor);
         NDArray input_array = Downcast<NDArray>(input);
         int ndim = input_array->ndim;
         auto out_tensor = NDArray::Empty({ndim}, {kDLInt, 64, 1}, {kDLCPU, 0});
         for (int i = 0; i < ndim; ++i) {
           reinterpret_cast<int64_t*>(out_tensor->data)[i] = input_array->shape[i];
         }
-        WriteRegister(instr.dst, out_tensor);
+        WriteRegister(instr->dst, out_tensor);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
-      case Opcode::Ret: {
+      case Opcode::Ret:
+      TVM_VM_OP_LABEL(Ret) : {
         // If we have hit the point from which we started
         // running, we should return to the caller breaking
         // the dispatch loop.
-        return_register_ = ReadRegister(instr.result);
+        return_register_ = ReadRegister(instr->result);
         auto caller_return_register = frames_.back().caller_return_register;
 
         if (PopFrame() == frame_start) {
+          if (stats_) stats_->Exit();
           return;
           // Otherwise we are just returning from a local call.
         } else {
           WriteRegister(caller_return_register, return_register_);
-          goto main_loop;
+          DISPATCH();
         }
       }
-      case Opcode::ReshapeTensor: {
+      case Opcode::ReshapeTensor:
+      TVM_VM_OP_LABEL(ReshapeTensor) : {
         DLContext cpu_ctx;
         cpu_ctx.device_type = kDLCPU;
         cpu_ctx.device_id = 0;
-        auto tensor_obj = ReadRegister(instr.reshape_tensor.tensor);
+        auto tensor_obj = ReadRegister(instr->reshape_tensor.tensor);
         NDArray tensor_arr = Downcast<NDArray>(tensor_obj);
         // Read the shape from shape tensor
-        auto shape_obj = ReadRegister(instr.reshape_tensor.newshape);
-        NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_ctx));
+        auto shape_obj = ReadRegister(instr->reshape_tensor.newshape);
+        NDArray shape_tensor = Downcast<NDArray>(this->CopyTo(shape_obj, cpu_ctx));
         const DLTensor* dl_tensor = shape_tensor.operator->();
         CHECK_EQ(dl_tensor->dtype.code, 0u);
         CHECK_EQ(dl_tensor->dtype.bits, 64);
@@ -569,16 +954,21 @@ void VirtualMachine::RunLoop() {
         std::vector<int64_t> shape(dims, dims + ndim);
         // Reshape the input tensor
         auto out_tensor = tensor_arr.CreateView(shape, tensor_arr->dtype);
-        WriteRegister(instr.dst, out_tensor);
+        WriteRegister(instr->dst, out_tensor);
         pc_++;
-        goto main_loop;
+        DISPATCH();
       }
       default:
-        LOG(FATAL) << "Unknown instruction opcode: " << int(instr.op);
+      TVM_VM_OP_LABEL(Unknown) :
+        LOG(FATAL) << "Unknown instruction opcode: " << int(instr->op);
     }
   }
 }
 
+#undef DISPATCH
+#undef TVM_VM_FETCH
+#undef TVM_VM_PRINT_INSTRUCTION
+
 runtime::Module CreateVirtualMachine(const Executable* exec) {
   auto vm = make_object<VirtualMachine>();
   vm->LoadExecutable(exec);
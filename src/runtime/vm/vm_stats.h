@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/vm/vm_stats.h
+ * \brief Counters of the interpreter, the allocations and the copies of a VM.
+ */
+#ifndef TVM_RUNTIME_VM_VM_STATS_H_
+#define TVM_RUNTIME_VM_VM_STATS_H_
+
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/vm/bytecode.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+namespace vm {
+
+/*! \brief The number of opcodes of the VM. */
+constexpr size_t kNumVMOpcodes = static_cast<size_t>(Opcode::AllocStorageTensor) + 1;
+
+/*!
+ * \brief The statistics the VM collects while the debug VM is attached.
+ *
+ *  The time of an instruction lasts from its dispatch to the dispatch of the
+ *  next one, so it includes the interpreter overhead.
+ */
+struct VMStats {
+  using Clock = std::chrono::high_resolution_clock;
+
+  /*! \brief Counters of one instruction class. */
+  struct OpcodeStats {
+    int64_t count{0};
+    double time_us{0};
+  };
+  /*! \brief Counters of the storage allocated by one instruction. */
+  struct AllocStats {
+    int64_t count{0};
+    /*! \brief The number of allocations served by the static memory plan. */
+    int64_t replayed{0};
+    int64_t bytes{0};
+    double time_us{0};
+  };
+  /*! \brief Counters of the copies in one direction. */
+  struct CopyStats {
+    int64_t count{0};
+    int64_t bytes{0};
+  };
+
+  OpcodeStats opcodes[kNumVMOpcodes];
+  /*! \brief The allocations of every AllocStorage or AllocStorageTensor instruction. */
+  std::map<const Instruction*, AllocStats> allocs;
+  /*! \brief The peak memory held by the allocator of each (device type, device id). */
+  std::map<std::pair<int, int>, int64_t> peak_bytes;
+  /*! \brief The copies from the host to a device. */
+  CopyStats host_to_device;
+  /*! \brief The copies from a device to the host. */
+  CopyStats device_to_host;
+
+  /*! \brief Account the time since the last dispatch and start timing \p op. */
+  void Dispatch(Opcode op) {
+    auto now = Clock::now();
+    if (current_ >= 0) {
+      opcodes[current_].time_us += std::chrono::duration<double, std::micro>(now - last_).count();
+    }
+    current_ = static_cast<int>(op);
+    opcodes[current_].count++;
+    last_ = now;
+  }
+
+  /*! \brief Account the time of the last instruction, when the dispatch loop exits. */
+  void Exit() {
+    if (current_ < 0) return;
+    opcodes[current_].time_us +=
+        std::chrono::duration<double, std::micro>(Clock::now() - last_).count();
+    current_ = -1;
+  }
+
+  /*! \brief Record a copy of \p bytes between \p from and \p to. */
+  void AddCopy(TVMContext from, TVMContext to, int64_t bytes) {
+    CopyStats& stats = to.device_type == kDLCPU ? device_to_host : host_to_device;
+    stats.count++;
+    stats.bytes += bytes;
+  }
+
+  /*! \brief Record the memory held by the allocator of \p ctx. */
+  void AddUsedMemory(TVMContext ctx, int64_t bytes) {
+    auto& peak = peak_bytes[std::make_pair(static_cast<int>(ctx.device_type), ctx.device_id)];
+    if (bytes > peak) peak = bytes;
+  }
+
+  /*! \brief Drop all the counters. */
+  void Clear() { *this = VMStats(); }
+
+ private:
+  int current_{-1};
+  Clock::time_point last_;
+};
+
+}  // namespace vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_VM_VM_STATS_H_
@@ -45,6 +45,9 @@ static constexpr const int kVulkanMaxNumDevice = 8;
 /*! \brief TVM Vulkan binary pack magic number */
 static constexpr const int kVulkanModuleMagic = 0x02700027;
 
+/*! \brief Largest upload recorded inline into a command buffer by vkCmdUpdateBuffer. */
+static constexpr const size_t kVulkanMaxInlineUpload = 65536;
+
 class VulkanThreadEntry {
  public:
   VulkanThreadEntry();
@@ -213,27 +216,16 @@ class VulkanDeviceAPI final : public DeviceAPI {
       VulkanThreadEntry::ThreadLocal()
           ->Stream(ctx_from.device_id)
           ->Launch([=](VulkanStreamState* state) {
-            // 1: copy
+            CHECK_EQ(ctx_from.device_id, ctx_to.device_id) << "Vulkan disallow cross device copy.";
             const auto* from_buf = static_cast<const VulkanBuffer*>(from);
             auto* to_buf = static_cast<VulkanBuffer*>(to);
+            // The stream records a barrier if the copy depends on an earlier command.
+            state->Access({from_buf->buffer}, {to_buf->buffer});
             VkBufferCopy copy_info;
             copy_info.srcOffset = from_offset;
             copy_info.dstOffset = to_offset;
             copy_info.size = size;
             vkCmdCopyBuffer(state->cmd_buffer_, from_buf->buffer, to_buf->buffer, 1, &copy_info);
-            // 2: barrier(transfer-> compute|transfer)
-            CHECK_EQ(ctx_from.device_id, ctx_to.device_id) << "Vulkan disallow cross device copy.";
-            VkMemoryBarrier barrier_info;
-            barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-            barrier_info.pNext = nullptr;
-            barrier_info.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier_info.dstAccessMask =
-                (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
-                 VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
-            vkCmdPipelineBarrier(
-                state->cmd_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
-                &barrier_info, 0, nullptr, 0, nullptr);
           });
 
     } else if (from_dev_type == kDLVulkan && to_dev_type == kDLCPU) {
@@ -242,12 +234,22 @@ class VulkanDeviceAPI final : public DeviceAPI {
       auto* temp = VulkanThreadEntry::ThreadLocal()->StagingBuffer(ctx_from.device_id, size);
       VulkanThreadEntry::ThreadLocal()
           ->Stream(ctx_from.device_id)
-          ->Launch([&](VulkanStreamState* state) {
+          ->Launch([=](VulkanStreamState* state) {
+            state->Access({from_buf->buffer}, {});
             VkBufferCopy copy_info;
             copy_info.srcOffset = from_offset;
             copy_info.dstOffset = 0;
             copy_info.size = size;
             vkCmdCopyBuffer(state->cmd_buffer_, from_buf->buffer, temp->buffer, 1, &copy_info);
+            // barrier(transfer->host), so the staging buffer is visible to the host read.
+            VkMemoryBarrier barrier_info;
+            barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier_info.pNext = nullptr;
+            barrier_info.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier_info.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+            vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
+                                 nullptr);
           });
       VulkanThreadEntry::ThreadLocal()->Stream(ctx_from.device_id)->Synchronize();
       if (!vctx.coherent_staging) {
@@ -263,6 +265,19 @@ class VulkanDeviceAPI final : public DeviceAPI {
     } else if (from_dev_type == kDLCPU && to_dev_type == kDLVulkan) {
       const auto& vctx = context(ctx_to.device_id);
       const auto* to_buf = static_cast<const VulkanBuffer*>(to);
+      VulkanStream* stream = VulkanThreadEntry::ThreadLocal()->Stream(ctx_to.device_id);
+      if (size != 0 && size <= kVulkanMaxInlineUpload && size % 4 == 0 && to_offset % 4 == 0) {
+        // Small uploads are recorded inline into the command buffer,
+        // they need neither the staging buffer nor a synchronization.
+        const char* data = static_cast<const char*>(from) + from_offset;
+        std::vector<char> inline_data(data, data + size);
+        stream->Launch([to_buf, to_offset, inline_data](VulkanStreamState* state) {
+          state->Access({}, {to_buf->buffer});
+          vkCmdUpdateBuffer(state->cmd_buffer_, to_buf->buffer, to_offset, inline_data.size(),
+                            inline_data.data());
+        });
+        return;
+      }
       VulkanStagingBuffer* temp =
           VulkanThreadEntry::ThreadLocal()->StagingBuffer(ctx_to.device_id, size);
       memcpy(temp->host_addr, static_cast<const char*>(from) + from_offset, size);
@@ -278,28 +293,18 @@ class VulkanDeviceAPI final : public DeviceAPI {
         VULKAN_CALL(vkFlushMappedMemoryRanges(vctx.device, 1, &mrange));
       }
 
-      VulkanThreadEntry::ThreadLocal()
-          ->Stream(ctx_from.device_id)
-          ->Launch([&](VulkanStreamState* state) {
-            // 0: barrier(host->transfer)
-            VkMemoryBarrier barrier_info;
-            barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-            barrier_info.pNext = nullptr;
-            barrier_info.srcAccessMask = 0;
-            barrier_info.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_HOST_BIT,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
-                                 nullptr);
-            // 1: copy
-            VkBufferCopy copy_info;
-            copy_info.srcOffset = 0;
-            copy_info.dstOffset = to_offset;
-            copy_info.size = size;
-            vkCmdCopyBuffer(state->cmd_buffer_, temp->buffer, to_buf->buffer, 1, &copy_info);
-          });
-      // TODO(tulloch): should we instead make the staging buffer a property of the
-      // Stream? This would allow us to elide synchronizations here.
-      VulkanThreadEntry::ThreadLocal()->Stream(ctx_from.device_id)->Synchronize();
+      // The host writes to the staging buffer are made visible by the queue submission.
+      VkBuffer staging = temp->buffer;
+      stream->Launch([staging, to_buf, to_offset, size](VulkanStreamState* state) {
+        state->Access({}, {to_buf->buffer});
+        VkBufferCopy copy_info;
+        copy_info.srcOffset = 0;
+        copy_info.dstOffset = to_offset;
+        copy_info.size = size;
+        vkCmdCopyBuffer(state->cmd_buffer_, staging, to_buf->buffer, 1, &copy_info);
+      });
+      // The upload is not waited on, the next user of the staging buffer waits instead.
+      temp->last_use = stream->Pending();
     } else {
       LOG(FATAL) << "Expect copy from/to Vulkan or between Vulkan"
                  << ", from=" << from_dev_type << ", to=" << to_dev_type;
@@ -352,6 +357,8 @@ class VulkanDeviceAPI final : public DeviceAPI {
 
  private:
   VkInstance instance_{nullptr};
+  // The Vulkan API version the instance is created with
+  uint32_t instance_api_version_{0};
   // The physical devices, have 1 to 1 mapping to devices
   std::vector<VulkanContext> context_;
 };
@@ -380,7 +387,27 @@ void VulkanDeviceAPI::GetAttr(TVMContext ctx, DeviceAttrKind kind, TVMRetValue*
       break;
     }
     case kWarpSize: {
-      *rv = 1;
+      // The subgroup size, when the subgroups can shuffle in compute shaders.
+      int64_t value = 1;
+#ifdef VK_API_VERSION_1_1
+      VkPhysicalDeviceProperties phy_prop;
+      vkGetPhysicalDeviceProperties(vctx.phy_device, &phy_prop);
+      if (instance_api_version_ >= VK_API_VERSION_1_1 &&
+          phy_prop.apiVersion >= VK_API_VERSION_1_1) {
+        VkPhysicalDeviceSubgroupProperties subgroup_prop;
+        subgroup_prop.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+        subgroup_prop.pNext = nullptr;
+        VkPhysicalDeviceProperties2 phy_prop2;
+        phy_prop2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        phy_prop2.pNext = &subgroup_prop;
+        vkGetPhysicalDeviceProperties2(vctx.phy_device, &phy_prop2);
+        if ((subgroup_prop.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+            (subgroup_prop.supportedOperations & VK_SUBGROUP_FEATURE_SHUFFLE_BIT)) {
+          value = subgroup_prop.subgroupSize;
+        }
+      }
+#endif
+      *rv = value;
       break;
     }
     case kComputeVersion: {
@@ -431,6 +458,18 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
   app_info.pEngineName = "";
   app_info.engineVersion = 0;
   app_info.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+#ifdef VK_API_VERSION_1_1
+  // Vulkan 1.1 is needed to query the subgroup properties.
+  auto enumerate_instance_version = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+      vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+  if (enumerate_instance_version != nullptr) {
+    uint32_t version = 0;
+    if (enumerate_instance_version(&version) == VK_SUCCESS && version >= VK_API_VERSION_1_1) {
+      app_info.apiVersion = VK_API_VERSION_1_1;
+    }
+  }
+#endif
+  instance_api_version_ = app_info.apiVersion;
 
   VkInstanceCreateInfo inst_info;
   inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -547,9 +586,17 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
             dp.specVersion > 0) {
           extensions.push_back("VK_KHR_dedicated_allocation");
         }
+        if ((std::strcmp(dp.extensionName, "VK_KHR_timeline_semaphore") == 0) &&
+            dp.specVersion > 0) {
+          extensions.push_back("VK_KHR_timeline_semaphore");
+        }
       }
       return extensions;
     }();
+    auto has_extension = [&extensions](const char* query) {
+      return std::any_of(extensions.begin(), extensions.end(),
+                         [&](const char* extension) { return std::strcmp(query, extension) == 0; });
+    };
     VkDeviceCreateInfo device_create_info;
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     device_create_info.pNext = nullptr;
@@ -561,6 +608,24 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
     device_create_info.enabledExtensionCount = extensions.size();
     device_create_info.ppEnabledExtensionNames = extensions.data();
     device_create_info.pEnabledFeatures = nullptr;
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    // Timeline semaphores let the streams submit asynchronously and wait for a given submission.
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_features;
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+    timeline_features.pNext = nullptr;
+    timeline_features.timelineSemaphore = VK_FALSE;
+    if (has_extension("VK_KHR_timeline_semaphore") &&
+        instance_api_version_ >= VK_API_VERSION_1_1 &&
+        ctx.phy_device_prop.apiVersion >= VK_API_VERSION_1_1) {
+      VkPhysicalDeviceFeatures2 features2;
+      features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+      features2.pNext = &timeline_features;
+      vkGetPhysicalDeviceFeatures2(ctx.phy_device, &features2);
+    }
+    if (timeline_features.timelineSemaphore) {
+      device_create_info.pNext = &timeline_features;
+    }
+#endif
     VULKAN_CALL(vkCreateDevice(phy_dev, &device_create_info, nullptr, &(ctx.device)));
     ctx.queue_mutex.reset(new std::mutex());
     vkGetDeviceQueue(ctx.device, queue_family_index, 0, &(ctx.queue));
@@ -632,10 +697,6 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
       }
     }
     CHECK_GE(win_rank, 0) << "Cannot find suitable local memory on device.";
-    auto has_extension = [&extensions](const char* query) {
-      return std::any_of(extensions.begin(), extensions.end(),
-                         [&](const char* extension) { return std::strcmp(query, extension) == 0; });
-    };
 
 #ifdef USE_VULKAN_IMMEDIATE_MODE
     if (has_extension("VK_KHR_push_descriptor") &&
@@ -668,6 +729,16 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
               ctx.device, "vkGetBufferMemoryRequirements2KHR"));
     }
 #endif
+
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    if (timeline_features.timelineSemaphore) {
+      ctx.timeline_semaphore_khr_functions = std::unique_ptr<VulkanTimelineSemaphoreKHRFunctions>(
+          new VulkanTimelineSemaphoreKHRFunctions());
+      ctx.timeline_semaphore_khr_functions->vkWaitSemaphoresKHR =
+          CHECK_NOTNULL((PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(ctx.device,
+                                                                      "vkWaitSemaphoresKHR"));
+    }
+#endif
     context_.push_back(std::move(ctx));
   }
 
@@ -675,7 +746,8 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
   for (size_t i = 0; i < context_.size(); ++i) {
     LOG(INFO) << "vulkan(" << i << ")=\'" << context_[i].phy_device_prop.deviceName
               << "\' phy_dev_id=" << context_[i].phy_device
-              << " use_immediate=" << context_[i].UseImmediate();
+              << " use_immediate=" << context_[i].UseImmediate()
+              << " use_timeline_semaphore=" << context_[i].UseTimelineSemaphore();
   }
 }  // namespace vulkan
 class VulkanModuleNode;
@@ -968,6 +1040,11 @@ VulkanStagingBuffer* VulkanThreadEntry::StagingBuffer(int device_id, size_t size
     staging_buffers_[device_id] = std::unique_ptr<VulkanStagingBuffer>(new VulkanStagingBuffer());
   }
   auto& buf = *(staging_buffers_[device_id]);
+  if (buf.last_use != 0) {
+    // Wait for the pending upload that still reads the buffer.
+    Stream(device_id)->WaitFor(buf.last_use);
+    buf.last_use = 0;
+  }
   if (buf.device != nullptr && buf.size < size) {
     // free previous buffer
     if (buf.host_addr != nullptr) {
@@ -1040,6 +1117,8 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv, const ArgUnion
   ThreadWorkLoad wl = thread_axis_cfg_.Extract(args);
   std::vector<VkDescriptorBufferInfo> descriptor_buffers;
   descriptor_buffers.resize(num_buffer_args_);
+  // The kernel may read and write any of its buffers.
+  std::vector<VkBuffer> buffers(num_buffer_args_);
   for (size_t i = 0; i < num_buffer_args_; ++i) {
     void* buf = args[static_cast<int>(i)];
     VkDescriptorBufferInfo binfo;
@@ -1047,10 +1126,12 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv, const ArgUnion
     binfo.offset = 0;
     binfo.range = VK_WHOLE_SIZE;
     descriptor_buffers[i] = binfo;
+    buffers[i] = binfo.buffer;
   }
   if (vctx.UseImmediate()) {
     // Can safely capture by reference as this lambda is immediately executed on the calling thread.
     VulkanThreadEntry::ThreadLocal()->Stream(device_id)->Launch([&](VulkanStreamState* state) {
+      state->Access(buffers, buffers);
       vkCmdBindPipeline(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
       CHECK(pipeline->descriptor_update_template != VK_NULL_HANDLE);
       vctx.descriptor_template_khr_functions->vkCmdPushDescriptorSetWithTemplateKHR(
@@ -1062,15 +1143,6 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv, const ArgUnion
                            pack_args);
       }
       vkCmdDispatch(state->cmd_buffer_, wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2));
-      VkMemoryBarrier barrier_info;
-      barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-      barrier_info.pNext = nullptr;
-      barrier_info.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
-      barrier_info.dstAccessMask = (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
-                                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
-      vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                           VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
-                           1, &barrier_info, 0, nullptr, 0, nullptr);
     });
     return;
   }
@@ -1095,7 +1167,9 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv, const ArgUnion
     vkUpdateDescriptorSets(vctx.device, write_descriptor_sets.size(), write_descriptor_sets.data(),
                            0, 0);
   };
-  const auto& deferred_kernel = [pipeline, wl, pack_args_storage](VulkanStreamState* state) {
+  const auto& deferred_kernel = [pipeline, wl, pack_args_storage,
+                                 buffers](VulkanStreamState* state) {
+    state->Access(buffers, buffers);
     vkCmdBindPipeline(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
     vkCmdBindDescriptorSets(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
                             pipeline->pipeline_layout, 0, 1, &(pipeline->descriptor_set), 0,
@@ -1105,22 +1179,10 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv, const ArgUnion
                          0, pack_args_storage.size() * sizeof(ArgUnion), pack_args_storage.data());
     }
     vkCmdDispatch(state->cmd_buffer_, wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2));
-    VkMemoryBarrier barrier_info;
-    barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-    barrier_info.pNext = nullptr;
-    barrier_info.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
-    barrier_info.dstAccessMask = (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
-                                  VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
-    vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
-                         1, &barrier_info, 0, nullptr, 0, nullptr);
   };
   VulkanStreamToken deferred_token;
   deferred_token.descriptor_set_ = pipeline->descriptor_set;
-  deferred_token.buffers_.resize(descriptor_buffers.size());
-  for (size_t i = 0; i < descriptor_buffers.size(); ++i) {
-    deferred_token.buffers_[i] = descriptor_buffers[i].buffer;
-  }
+  deferred_token.buffers_ = buffers;
   VulkanThreadEntry::ThreadLocal()->Stream(device_id)->LaunchDeferred(
       deferred_initializer, deferred_kernel, deferred_token);
 }
@@ -103,12 +103,20 @@ struct VulkanGetBufferMemoryRequirements2Functions {
   PFN_vkGetBufferMemoryRequirements2KHR vkGetBufferMemoryRequirements2KHR{nullptr};
 };
 
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+struct VulkanTimelineSemaphoreKHRFunctions {
+  PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR{nullptr};
+};
+#endif
+
 struct VulkanStagingBuffer {
   VkDevice device{nullptr};
   VkBuffer buffer{VK_NULL_HANDLE};
   VkDeviceMemory memory{VK_NULL_HANDLE};
   void* host_addr{nullptr};
   size_t size{0};
+  // The stream submission that last used the buffer, 0 if none.
+  uint64_t last_use{0};
 };
 
 struct VulkanContext {
@@ -124,6 +132,9 @@ struct VulkanContext {
   std::unique_ptr<VulkanDescriptorTemplateKHRFunctions> descriptor_template_khr_functions{nullptr};
   std::unique_ptr<VulkanGetBufferMemoryRequirements2Functions>
       get_buffer_memory_requirements_2_functions{nullptr};
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+  std::unique_ptr<VulkanTimelineSemaphoreKHRFunctions> timeline_semaphore_khr_functions{nullptr};
+#endif
   // Memory type index for compute
   uint32_t compute_mtype_index{0};
   // The logical device
@@ -138,6 +149,14 @@ struct VulkanContext {
   VkQueueFamilyProperties queue_prop;
 
   bool UseImmediate() const { return descriptor_template_khr_functions.get() != nullptr; }
+
+  bool UseTimelineSemaphore() const {
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    return timeline_semaphore_khr_functions.get() != nullptr;
+#else
+    return false;
+#endif
+  }
 };
 
 }  // namespace vulkan
@@ -18,9 +18,11 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "vulkan_common.h"
@@ -33,6 +35,64 @@ class VulkanStreamState {
  public:
   VkCommandBuffer cmd_buffer_;
   VkFence fence_;
+  // The value the submission of cmd_buffer_ signals on completion.
+  uint64_t value_{0};
+  // Whether cmd_buffer_ has been submitted since it began recording.
+  bool submitted_{false};
+  // Whether any command has been recorded into cmd_buffer_.
+  bool recorded_{false};
+
+  /*!
+   * \brief Declare the buffers the next recorded command reads and writes.
+   *
+   *  A pipeline barrier is only recorded when the command depends on a command
+   *  recorded since the last barrier, or on a previous submission that may still
+   *  be running. Independent commands are left free to overlap.
+   */
+  void Access(const std::vector<VkBuffer>& reads, const std::vector<VkBuffer>& writes) {
+    bool conflict = after_submit_;
+    for (VkBuffer buffer : reads) {
+      conflict = conflict || writes_.count(buffer);
+    }
+    for (VkBuffer buffer : writes) {
+      conflict = conflict || writes_.count(buffer) || reads_.count(buffer);
+    }
+    if (conflict) {
+      VkMemoryBarrier barrier_info;
+      barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      barrier_info.pNext = nullptr;
+      barrier_info.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier_info.dstAccessMask = (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+                                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+      vkCmdPipelineBarrier(cmd_buffer_,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                           1, &barrier_info, 0, nullptr, 0, nullptr);
+      reads_.clear();
+      writes_.clear();
+      after_submit_ = false;
+    }
+    reads_.insert(reads.begin(), reads.end());
+    writes_.insert(writes.begin(), writes.end());
+    recorded_ = true;
+  }
+
+  // Start tracking a freshly begun command buffer.
+  void Reset(uint64_t value, bool after_submit) {
+    value_ = value;
+    submitted_ = false;
+    recorded_ = false;
+    after_submit_ = after_submit;
+    reads_.clear();
+    writes_.clear();
+  }
+
+ private:
+  // Whether an earlier submission may still access buffers used by this one.
+  bool after_submit_{false};
+  // The buffers read and written since the last barrier.
+  std::unordered_set<VkBuffer> reads_;
+  std::unordered_set<VkBuffer> writes_;
 };
 
 // Used to identify state that should only be used once-per-stream.
@@ -41,9 +101,18 @@ struct VulkanStreamToken {
   std::vector<VkBuffer> buffers_;
 };
 
+/*!
+ * \brief A stream records commands into a ring of command buffers.
+ *
+ *  Commands are batched into the current command buffer until the host needs
+ *  their results. Submission is asynchronous: every submission is identified by
+ *  an increasing value, signaled through a timeline semaphore when the device
+ *  supports it or through a per-buffer fence otherwise, and the host only waits
+ *  for the value it depends on.
+ */
 class VulkanStream {
  public:
-  explicit VulkanStream(const VulkanContext* vctx) : vctx_(vctx), state_(new VulkanStreamState()) {
+  explicit VulkanStream(const VulkanContext* vctx) : vctx_(vctx) {
     // create command pool
     VkCommandPoolCreateInfo cmd_pool_cinfo;
     cmd_pool_cinfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -52,38 +121,64 @@ class VulkanStream {
     cmd_pool_cinfo.queueFamilyIndex = vctx_->queue_family_index;
     VULKAN_CALL(vkCreateCommandPool(vctx_->device, &cmd_pool_cinfo, nullptr, &cmd_pool_));
 
-    VkCommandBufferAllocateInfo buffer_alloc_info;
-    buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    buffer_alloc_info.pNext = nullptr;
-    buffer_alloc_info.commandPool = cmd_pool_;
-    buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    buffer_alloc_info.commandBufferCount = 1;
-    VULKAN_CALL(
-        vkAllocateCommandBuffers(vctx_->device, &buffer_alloc_info, &(state_->cmd_buffer_)));
-
-    VkFenceCreateInfo fence_cinfo;
-    fence_cinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_cinfo.pNext = nullptr;
-    fence_cinfo.flags = 0;  // VK_FENCE_CREATE_SIGNALED_BIT;
-    VULKAN_CALL(vkCreateFence(vctx_->device, &fence_cinfo, nullptr, &(state_->fence_)));
+    for (int i = 0; i < kNumCommandBuffers; ++i) {
+      std::unique_ptr<VulkanStreamState> state(new VulkanStreamState());
+      VkCommandBufferAllocateInfo buffer_alloc_info;
+      buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      buffer_alloc_info.pNext = nullptr;
+      buffer_alloc_info.commandPool = cmd_pool_;
+      buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      buffer_alloc_info.commandBufferCount = 1;
+      VULKAN_CALL(
+          vkAllocateCommandBuffers(vctx_->device, &buffer_alloc_info, &(state->cmd_buffer_)));
 
-    VkCommandBufferBeginInfo cb_begin;
-    cb_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cb_begin.pNext = nullptr;
-    cb_begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    cb_begin.pInheritanceInfo = 0;
-    VULKAN_CALL(vkBeginCommandBuffer(state_->cmd_buffer_, &cb_begin));
+      VkFenceCreateInfo fence_cinfo;
+      fence_cinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      fence_cinfo.pNext = nullptr;
+      fence_cinfo.flags = 0;  // VK_FENCE_CREATE_SIGNALED_BIT;
+      VULKAN_CALL(vkCreateFence(vctx_->device, &fence_cinfo, nullptr, &(state->fence_)));
+      ring_.push_back(std::move(state));
+    }
+
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    if (vctx_->UseTimelineSemaphore()) {
+      VkSemaphoreTypeCreateInfoKHR type_cinfo;
+      type_cinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+      type_cinfo.pNext = nullptr;
+      type_cinfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+      type_cinfo.initialValue = 0;
+      VkSemaphoreCreateInfo semaphore_cinfo;
+      semaphore_cinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      semaphore_cinfo.pNext = &type_cinfo;
+      semaphore_cinfo.flags = 0;
+      VULKAN_CALL(vkCreateSemaphore(vctx_->device, &semaphore_cinfo, nullptr, &timeline_));
+    }
+#endif
+
+    state_ = ring_[0].get();
+    Begin();
   }
 
   ~VulkanStream() {
-    vkDestroyFence(vctx_->device, state_->fence_, nullptr);
+    // The submitted command buffers must retire before their pool is destroyed.
+    WaitFor(last_submitted_);
+    for (const auto& state : ring_) {
+      vkDestroyFence(vctx_->device, state->fence_, nullptr);
+    }
+    if (timeline_ != VK_NULL_HANDLE) {
+      vkDestroySemaphore(vctx_->device, timeline_, nullptr);
+    }
     vkDestroyCommandPool(vctx_->device, cmd_pool_, nullptr);
   }
 
   // Launch the kernel on the current stream.
   void Launch(const std::function<void(VulkanStreamState*)>& kernel) {
     if (vctx_->UseImmediate()) {
-      kernel(state_.get());
+      kernel(state_);
+      // Hand long batches to the device early so it works while the host records more.
+      if (++num_recorded_ >= kMaxBatchSize) {
+        Submit();
+      }
     } else {
       deferred_kernels_.push_back(kernel);
     }
@@ -115,18 +210,33 @@ class VulkanStream {
                        return token.descriptor_set_ == deferred_token.descriptor_set_ &&
                               token.buffers_ == deferred_token.buffers_;
                      })) {
+      // The descriptor set cannot be updated while a submission still uses it.
+      auto it = descriptor_last_use_.find(deferred_token.descriptor_set_);
+      if (it != descriptor_last_use_.end()) {
+        WaitFor(it->second);
+      }
       deferred_initializer();
     }
 
     deferred_kernels_.push_back(deferred_kernel);
     deferred_tokens_[deferred_token.descriptor_set_].push_back(deferred_token);
+    descriptor_last_use_[deferred_token.descriptor_set_] = state_->value_;
   }
 
-  // Synchronize the current stream `state_` with respect to the host.
-  void Synchronize() {
+  /*!
+   * \brief The value signaled once every command launched so far completes,
+   *  to be waited on with WaitFor.
+   */
+  uint64_t Pending() const { return state_->value_; }
+
+  /*!
+   * \brief Submit the recorded commands without waiting for them.
+   * \return The value signaled on their completion, 0 if nothing was ever submitted.
+   */
+  uint64_t Submit() {
     if (!vctx_->UseImmediate()) {
       for (const auto& deferred_kernel : deferred_kernels_) {
-        deferred_kernel(state_.get());
+        deferred_kernel(state_);
       }
       deferred_kernels_.clear();
       deferred_tokens_.clear();
@@ -134,6 +244,10 @@ class VulkanStream {
       DCHECK_EQ(deferred_kernels_.size(), 0);
       DCHECK_EQ(deferred_tokens_.size(), 0);
     }
+    if (!state_->recorded_) {
+      // Nothing to submit, the previous submission covers every launched command.
+      return last_submitted_;
+    }
 
     VULKAN_CALL(vkEndCommandBuffer(state_->cmd_buffer_));
     VkSubmitInfo cb_submit;
@@ -146,23 +260,100 @@ class VulkanStream {
     cb_submit.pCommandBuffers = &(state_->cmd_buffer_);
     cb_submit.signalSemaphoreCount = 0;
     cb_submit.pSignalSemaphores = nullptr;
+    VkFence fence = state_->fence_;
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    VkTimelineSemaphoreSubmitInfoKHR timeline_submit;
+    if (timeline_ != VK_NULL_HANDLE) {
+      timeline_submit.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+      timeline_submit.pNext = nullptr;
+      timeline_submit.waitSemaphoreValueCount = 0;
+      timeline_submit.pWaitSemaphoreValues = nullptr;
+      timeline_submit.signalSemaphoreValueCount = 1;
+      timeline_submit.pSignalSemaphoreValues = &(state_->value_);
+      cb_submit.pNext = &timeline_submit;
+      cb_submit.signalSemaphoreCount = 1;
+      cb_submit.pSignalSemaphores = &timeline_;
+      fence = VK_NULL_HANDLE;
+    }
+#endif
 
     {
       // Multiple streams (on different threads) use the same VulkanContext
       // instance, so we need to externally synchronize accesses.
       std::lock_guard<std::mutex> g(*(vctx_->queue_mutex));
-      VULKAN_CALL(vkQueueSubmit(vctx_->queue, 1, &cb_submit, state_->fence_));
+      VULKAN_CALL(vkQueueSubmit(vctx_->queue, 1, &cb_submit, fence));
+    }
+    state_->submitted_ = true;
+    last_submitted_ = state_->value_;
+
+    // Move on to the next command buffer of the ring, once the device is done with it.
+    next_ = (next_ + 1) % kNumCommandBuffers;
+    state_ = ring_[next_].get();
+    WaitFor(state_->value_);
+    Begin();
+    return last_submitted_;
+  }
+
+  // Wait on the host until the submission identified by value completes.
+  void WaitFor(uint64_t value) {
+    if (value == 0 || value <= completed_) return;
+    if (value > last_submitted_) {
+      // The value belongs to the command buffer being recorded.
+      CHECK_EQ(value, state_->value_);
+      Submit();
+      if (value > last_submitted_) return;
     }
     uint64_t timeout = 1UL << 30UL;
     VkResult res;
-    do {
-      res = vkWaitForFences(vctx_->device, 1, &(state_->fence_), 0, timeout);
-    } while (res == VK_TIMEOUT);
-    VULKAN_CHECK_ERROR(res);
-    VULKAN_CALL(vkResetCommandBuffer(state_->cmd_buffer_, 0));
-    VULKAN_CALL(vkResetFences(vctx_->device, 1, &(state_->fence_)));
-
-    // Re-initialize the command buffer
+#if defined(USE_VULKAN_TIMELINE_SEMAPHORE) && defined(VK_KHR_timeline_semaphore)
+    if (timeline_ != VK_NULL_HANDLE) {
+      VkSemaphoreWaitInfoKHR wait_info;
+      wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+      wait_info.pNext = nullptr;
+      wait_info.flags = 0;
+      wait_info.semaphoreCount = 1;
+      wait_info.pSemaphores = &timeline_;
+      wait_info.pValues = &value;
+      do {
+        res = vctx_->timeline_semaphore_khr_functions->vkWaitSemaphoresKHR(vctx_->device,
+                                                                           &wait_info, timeout);
+      } while (res == VK_TIMEOUT);
+      VULKAN_CHECK_ERROR(res);
+      completed_ = value;
+      return;
+    }
+#endif
+    // A command buffer is only recycled once it completed, so the one that
+    // signals value is still in the ring. Its fence also covers every earlier
+    // submission on the queue.
+    for (const auto& state : ring_) {
+      if (state->submitted_ && state->value_ == value) {
+        do {
+          res = vkWaitForFences(vctx_->device, 1, &(state->fence_), 0, timeout);
+        } while (res == VK_TIMEOUT);
+        VULKAN_CHECK_ERROR(res);
+        completed_ = value;
+        return;
+      }
+    }
+    LOG(FATAL) << "Cannot find the submission " << value << " on the Vulkan stream";
+  }
+
+  // Synchronize the current stream `state_` with respect to the host.
+  void Synchronize() { WaitFor(Submit()); }
+
+ private:
+  // Reset the current command buffer and begin recording into it.
+  void Begin() {
+    if (state_->submitted_) {
+      VULKAN_CALL(vkResetCommandBuffer(state_->cmd_buffer_, 0));
+      if (timeline_ == VK_NULL_HANDLE) {
+        VULKAN_CALL(vkResetFences(vctx_->device, 1, &(state_->fence_)));
+      }
+    }
+    state_->Reset(++next_value_, last_submitted_ > completed_);
+    num_recorded_ = 0;
+
     VkCommandBufferBeginInfo cb_begin;
     cb_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cb_begin.pNext = nullptr;
@@ -171,12 +362,31 @@ class VulkanStream {
     VULKAN_CALL(vkBeginCommandBuffer(state_->cmd_buffer_, &cb_begin));
   }
 
- private:
+  // The number of command buffers that can be in flight at once.
+  static constexpr const int kNumCommandBuffers = 3;
+  // The number of launches recorded before the batch is submitted without waiting.
+  static constexpr const int kMaxBatchSize = 64;
+
   const VulkanContext* vctx_;
-  std::unique_ptr<VulkanStreamState> state_;
+  std::vector<std::unique_ptr<VulkanStreamState>> ring_;
+  // The command buffer being recorded, ring_[next_].
+  VulkanStreamState* state_{nullptr};
+  size_t next_{0};
+  // The timeline semaphore signaled by the submissions, if supported.
+  VkSemaphore timeline_{VK_NULL_HANDLE};
+  // The value of the last recorded command buffer.
+  uint64_t next_value_{0};
+  // The value of the last submission.
+  uint64_t last_submitted_{0};
+  // The value of the last submission known to be complete.
+  uint64_t completed_{0};
+  // The number of launches recorded into the current command buffer.
+  int num_recorded_{0};
   // An index of deferred tokens, allowing us to efficiently detect duplicated
   // deferred_initializer blocks.
   std::unordered_map<VkDescriptorSet, std::vector<VulkanStreamToken>> deferred_tokens_;
+  // The value of the last submission using each descriptor set.
+  std::unordered_map<VkDescriptorSet, uint64_t> descriptor_last_use_;
   std::vector<std::function<void(VulkanStreamState*)>> deferred_kernels_;
   VkCommandPool cmd_pool_;
 };
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_registry.cc
+ * \brief Process-wide registry sharing the device copies of read-only weights.
+ */
+#include "weight_registry.h"
+
+#include <tvm/runtime/registry.h>
+
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+WeightRegistry* WeightRegistry::Global() {
+  static WeightRegistry* inst = new WeightRegistry();
+  return inst;
+}
+
+NDArray WeightRegistry::Acquire(const NDArray& source, TVMContext ctx) {
+  CHECK(source.defined());
+  if (source->ctx.device_type == ctx.device_type && source->ctx.device_id == ctx.device_id) {
+    return source;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Acquiring happens when executors are created, a good time to drop copies
+  // left behind by the executors destroyed since.
+  this->SweepLocked();
+  Key key(source.get(), ctx.device_type, ctx.device_id);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) return it->second.copy;
+  std::vector<int64_t> shape(source->shape, source->shape + source->ndim);
+  NDArray copy = NDArray::Empty(shape, source->dtype, ctx);
+  copy.CopyFrom(source);
+  entries_[key] = Entry{source, copy};
+  return copy;
+}
+
+void WeightRegistry::Sweep() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  this->SweepLocked();
+}
+
+size_t WeightRegistry::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void WeightRegistry::SweepLocked() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.copy.use_count() == 1) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+TVM_REGISTER_GLOBAL("runtime.WeightRegistrySweep").set_body_typed([]() {
+  WeightRegistry::Global()->Sweep();
+  return static_cast<int64_t>(WeightRegistry::Global()->size());
+});
+
+}  // namespace runtime
+}  // namespace tvm
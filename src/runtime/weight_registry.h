@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file weight_registry.h
+ * \brief Process-wide registry sharing the device copies of read-only weights.
+ */
+#ifndef TVM_RUNTIME_WEIGHT_REGISTRY_H_
+#define TVM_RUNTIME_WEIGHT_REGISTRY_H_
+
+#include <tvm/runtime/ndarray.h>
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Share the device copy of a weight among all the executors using it.
+ *
+ *  Executors created from the same factory module, or the same VM executable,
+ *  refer to the same host arrays. The registry uploads each of them once per
+ *  device and hands out the same device array to every executor, which must
+ *  treat it as read-only. A device copy is released once no executor uses it.
+ */
+class WeightRegistry {
+ public:
+  /*! \return The registry of the process. */
+  static WeightRegistry* Global();
+  /*!
+   * \brief Get the shared copy of a weight on a device, uploading it on first use.
+   * \param source The host array of the weight.
+   * \param ctx The device.
+   * \return The shared copy, the source itself when it already lives on the device.
+   */
+  NDArray Acquire(const NDArray& source, TVMContext ctx);
+  /*! \brief Release the device copies no executor uses anymore. */
+  void Sweep();
+  /*! \return The number of device copies held. */
+  size_t size();
+
+ private:
+  /*! \brief The source object, device type and device id of a copy. */
+  using Key = std::tuple<const Object*, int, int>;
+  /*! \brief The source, kept alive so its address is not reused, and the device copy. */
+  struct Entry {
+    NDArray source;
+    NDArray copy;
+  };
+  /*! \brief Release the unused copies, with mutex_ held. */
+  void SweepLocked();
+  std::mutex mutex_;
+  std::map<Key, Entry> entries_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_WEIGHT_REGISTRY_H_
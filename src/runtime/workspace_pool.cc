@@ -23,7 +23,15 @@
  */
 #include "workspace_pool.h"
 
+#include <tvm/runtime/registry.h>
+
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "trace.h"
 
 namespace tvm {
 namespace runtime {
@@ -31,19 +39,56 @@ namespace runtime {
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
 
+struct WorkspacePool::Counters {
+  /*! \brief allocations served from the cache */
+  std::atomic<int64_t> hits{0};
+  /*! \brief allocations that allocate from the device */
+  std::atomic<int64_t> misses{0};
+  /*! \brief bytes of the workspaces in use */
+  std::atomic<int64_t> outstanding_bytes{0};
+  /*! \brief the peak of outstanding_bytes */
+  std::atomic<int64_t> peak_outstanding_bytes{0};
+  /*! \brief bytes of the freed workspaces kept by the pools */
+  std::atomic<int64_t> cached_bytes{0};
+  /*! \brief the maximum bytes cached by each pool, -1 for no limit */
+  std::atomic<int64_t> max_cached_bytes{-1};
+  /*! \brief bumped to request the pools to release their cache */
+  std::atomic<int64_t> trim_epoch{0};
+
+  void AddOutstanding(int64_t nbytes) {
+    int64_t current = outstanding_bytes.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    int64_t peak = peak_outstanding_bytes.load(std::memory_order_relaxed);
+    while (current > peak && !peak_outstanding_bytes.compare_exchange_weak(
+                                 peak, current, std::memory_order_relaxed)) {
+    }
+  }
+
+  static Counters* Get(DLDeviceType device_type) {
+    static std::mutex mutex;
+    // NOTE: explicitly use new, the thread local pools can outlive exit-time destruction
+    static auto* counters = new std::unordered_map<int, std::unique_ptr<Counters>>();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Counters>& ret = (*counters)[static_cast<int>(device_type)];
+    if (ret == nullptr) ret.reset(new Counters());
+    return ret.get();
+  }
+};
+
 class WorkspacePool::Pool {
  public:
   // constructor
-  Pool() {
+  explicit Pool(Counters* counters) : counters_(counters) {
     // safe guard header on each list.
     Entry e;
     e.data = nullptr;
     e.size = 0;
     free_list_.push_back(e);
     allocated_.push_back(e);
+    trim_epoch_ = counters_->trim_epoch.load(std::memory_order_relaxed);
   }
   // allocate from pool
   void* Alloc(TVMContext ctx, DeviceAPI* device, size_t nbytes) {
+    MaybeTrim(ctx, device);
     // Allocate align to page.
     nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
     if (nbytes == 0) nbytes = kWorkspacePageSize;
@@ -52,14 +97,18 @@ class WorkspacePool::Pool {
     type.code = kDLUInt;
     type.bits = 8;
     type.lanes = 1;
+    bool hit = false;
     if (free_list_.size() == 2) {
       e = free_list_.back();
       free_list_.pop_back();
+      UpdateCached(-static_cast<int64_t>(e.size));
       if (e.size < nbytes) {
         // resize the page
         device->FreeDataSpace(ctx, e.data);
         e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
         e.size = nbytes;
+      } else {
+        hit = true;
       }
     } else if (free_list_.size() == 1) {
       e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
@@ -72,20 +121,25 @@ class WorkspacePool::Pool {
         }
         e = *(it + 1);
         free_list_.erase(it + 1);
+        hit = true;
       } else {
         // resize the page
         e = free_list_.back();
         free_list_.pop_back();
         device->FreeDataSpace(ctx, e.data);
+        UpdateCached(-static_cast<int64_t>(e.size));
         e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
         e.size = nbytes;
       }
+      if (hit) UpdateCached(-static_cast<int64_t>(e.size));
     }
+    (hit ? counters_->hits : counters_->misses).fetch_add(1, std::memory_order_relaxed);
+    counters_->AddOutstanding(static_cast<int64_t>(e.size));
     allocated_.push_back(e);
     return e.data;
   }
   // free resource back to pool
-  void Free(void* data) {
+  void Free(TVMContext ctx, DeviceAPI* device, void* data) {
     Entry e;
     if (allocated_.back().data == data) {
       // quick path, last allocated.
@@ -99,6 +153,8 @@ class WorkspacePool::Pool {
       e = allocated_[index];
       allocated_.erase(allocated_.begin() + index);
     }
+    counters_->outstanding_bytes.fetch_sub(static_cast<int64_t>(e.size),
+                                           std::memory_order_relaxed);
     if (free_list_.back().size < e.size) {
       free_list_.push_back(e);
     } else if (free_list_.size() == 2) {
@@ -112,17 +168,45 @@ class WorkspacePool::Pool {
       }
       free_list_[i + 1] = e;
     }
+    UpdateCached(static_cast<int64_t>(e.size));
+    MaybeTrim(ctx, device);
+    // release the largest pages until the cache is under the cap
+    int64_t max_cached = counters_->max_cached_bytes.load(std::memory_order_relaxed);
+    while (max_cached >= 0 && cached_bytes_ > max_cached && free_list_.size() > 1) {
+      ReleaseBack(ctx, device);
+    }
   }
   // Release all resources
   void Release(TVMContext ctx, DeviceAPI* device) {
     CHECK_EQ(allocated_.size(), 1);
-    for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(ctx, free_list_[i].data);
+    while (free_list_.size() > 1) {
+      ReleaseBack(ctx, device);
     }
     free_list_.clear();
   }
 
  private:
+  // release the cache if a trim is requested since the last check
+  void MaybeTrim(TVMContext ctx, DeviceAPI* device) {
+    int64_t epoch = counters_->trim_epoch.load(std::memory_order_relaxed);
+    if (epoch == trim_epoch_) return;
+    trim_epoch_ = epoch;
+    while (free_list_.size() > 1) {
+      ReleaseBack(ctx, device);
+    }
+  }
+  // release the largest free page to the device
+  void ReleaseBack(TVMContext ctx, DeviceAPI* device) {
+    Entry e = free_list_.back();
+    free_list_.pop_back();
+    device->FreeDataSpace(ctx, e.data);
+    UpdateCached(-static_cast<int64_t>(e.size));
+  }
+  void UpdateCached(int64_t delta) {
+    cached_bytes_ += delta;
+    counters_->cached_bytes.fetch_add(delta, std::memory_order_relaxed);
+  }
+
   /*! \brief a single entry in the pool */
   struct Entry {
     void* data;
@@ -132,10 +216,16 @@ class WorkspacePool::Pool {
   std::vector<Entry> free_list_;
   /*! \brief List of allocated items */
   std::vector<Entry> allocated_;
+  /*! \brief The counters of the device type */
+  Counters* counters_;
+  /*! \brief The bytes in the free list */
+  int64_t cached_bytes_{0};
+  /*! \brief The last trim epoch handled */
+  int64_t trim_epoch_;
 };
 
 WorkspacePool::WorkspacePool(DLDeviceType device_type, DeviceAPI* device)
-    : device_type_(device_type), device_(device) {}
+    : device_type_(device_type), device_(device), counters_(Counters::Get(device_type)) {}
 
 WorkspacePool::~WorkspacePool() {
   for (size_t i = 0; i < array_.size(); ++i) {
@@ -154,15 +244,62 @@ void* WorkspacePool::AllocWorkspace(TVMContext ctx, size_t size) {
     array_.resize(ctx.device_id + 1, nullptr);
   }
   if (array_[ctx.device_id] == nullptr) {
-    array_[ctx.device_id] = new Pool();
+    array_[ctx.device_id] = new Pool(counters_);
   }
+  TVM_TRACE_INSTANT(kAlloc, "workspace", static_cast<int64_t>(size));
   return array_[ctx.device_id]->Alloc(ctx, device_, size);
 }
 
 void WorkspacePool::FreeWorkspace(TVMContext ctx, void* ptr) {
   CHECK(static_cast<size_t>(ctx.device_id) < array_.size() && array_[ctx.device_id] != nullptr);
-  array_[ctx.device_id]->Free(ptr);
+  TVM_TRACE_INSTANT(kFree, "workspace", -1);
+  array_[ctx.device_id]->Free(ctx, device_, ptr);
+}
+
+void WorkspacePool::SetMaxCachedBytes(DLDeviceType device_type, int64_t nbytes) {
+  CHECK_GE(nbytes, -1) << "The maximum cached bytes must be -1 or non-negative";
+  Counters::Get(device_type)->max_cached_bytes.store(nbytes, std::memory_order_relaxed);
+}
+
+void WorkspacePool::Trim(DLDeviceType device_type) {
+  Counters::Get(device_type)->trim_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string WorkspacePool::GetStats(DLDeviceType device_type) {
+  Counters* counters = Counters::Get(device_type);
+  std::ostringstream os;
+  os << "{\"hits\": " << counters->hits.load()
+     << ", \"misses\": " << counters->misses.load()
+     << ", \"outstanding_bytes\": " << counters->outstanding_bytes.load()
+     << ", \"peak_outstanding_bytes\": " << counters->peak_outstanding_bytes.load()
+     << ", \"cached_bytes\": " << counters->cached_bytes.load()
+     << ", \"max_cached_bytes\": " << counters->max_cached_bytes.load() << "}";
+  return os.str();
+}
+
+void WorkspacePool::ResetStats(DLDeviceType device_type) {
+  Counters* counters = Counters::Get(device_type);
+  counters->hits.store(0);
+  counters->misses.store(0);
+  counters->peak_outstanding_bytes.store(counters->outstanding_bytes.load());
 }
 
+TVM_REGISTER_GLOBAL("runtime.WorkspacePoolStats").set_body_typed([](int device_type) {
+  return WorkspacePool::GetStats(static_cast<DLDeviceType>(device_type));
+});
+
+TVM_REGISTER_GLOBAL("runtime.WorkspacePoolResetStats").set_body_typed([](int device_type) {
+  WorkspacePool::ResetStats(static_cast<DLDeviceType>(device_type));
+});
+
+TVM_REGISTER_GLOBAL("runtime.WorkspacePoolSetMaxCachedBytes")
+    .set_body_typed([](int device_type, int64_t nbytes) {
+      WorkspacePool::SetMaxCachedBytes(static_cast<DLDeviceType>(device_type), nbytes);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.WorkspacePoolTrim").set_body_typed([](int device_type) {
+  WorkspacePool::Trim(static_cast<DLDeviceType>(device_type));
+});
+
 }  // namespace runtime
 }  // namespace tvm
@@ -27,6 +27,7 @@
 #include <tvm/runtime/device_api.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -41,6 +42,11 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  A pool is not thread-safe, each thread owns its pools, see the thread local
+ *  entries of the device APIs. The pools of a device type share counters, and a
+ *  cap on the bytes each of them caches, which can be tuned at runtime through
+ *  the runtime.WorkspacePool* globals.
  */
 class TVM_DLL WorkspacePool {
  public:
@@ -65,15 +71,44 @@ class TVM_DLL WorkspacePool {
    * \param ptr The pointer to be freed.
    */
   void FreeWorkspace(TVMContext ctx, void* ptr);
+  /*!
+   * \brief Set the maximum bytes each pool of the device type keeps cached after
+   *  its workspaces are freed, the rest is released to the device.
+   * \param device_type The device type.
+   * \param nbytes The maximum bytes, -1 for no limit.
+   */
+  static void SetMaxCachedBytes(DLDeviceType device_type, int64_t nbytes);
+  /*!
+   * \brief Release the cached workspaces of all the pools of the device type.
+   *  Each pool releases its cache at its next allocation or free, on the
+   *  thread that owns it.
+   * \param device_type The device type.
+   */
+  static void Trim(DLDeviceType device_type);
+  /*!
+   * \brief Get the counters of the pools of the device type as a JSON object with
+   *  hits, misses, outstanding_bytes, peak_outstanding_bytes, cached_bytes and
+   *  max_cached_bytes.
+   * \param device_type The device type.
+   */
+  static std::string GetStats(DLDeviceType device_type);
+  /*!
+   * \brief Reset the hits, misses and peak of the pools of the device type.
+   * \param device_type The device type.
+   */
+  static void ResetStats(DLDeviceType device_type);
 
  private:
   class Pool;
+  struct Counters;
   /*! \brief pool of device local array */
   std::vector<Pool*> array_;
   /*! \brief device type this pool support */
   DLDeviceType device_type_;
   /*! \brief The device API */
   DeviceAPI* device_;
+  /*! \brief The counters shared by the pools of the device type */
+  Counters* counters_;
 };
 
 }  // namespace runtime
@@ -84,6 +84,10 @@
 #define TVM_INFO_USE_GRAPH_RUNTIME_DEBUG "NOT-FOUND"
 #endif
 
+#ifndef TVM_INFO_USE_GRAPH_RUNTIME_CUDA_GRAPH
+#define TVM_INFO_USE_GRAPH_RUNTIME_CUDA_GRAPH "NOT-FOUND"
+#endif
+
 #ifndef TVM_INFO_USE_OPENMP
 #define TVM_INFO_USE_OPENMP "NOT-FOUND"
 #endif
@@ -120,6 +124,14 @@
 #define TVM_INFO_USE_FALLBACK_STL_MAP "NOT-FOUND"
 #endif
 
+#ifndef TVM_INFO_USE_OBJECT_POOL_ALLOCATOR
+#define TVM_INFO_USE_OBJECT_POOL_ALLOCATOR "NOT-FOUND"
+#endif
+
+#ifndef TVM_INFO_USE_RUNTIME_TRACE
+#define TVM_INFO_USE_RUNTIME_TRACE "NOT-FOUND"
+#endif
+
 #ifndef TVM_INFO_USE_BLAS
 #define TVM_INFO_USE_BLAS "NOT-FOUND"
 #endif
@@ -224,6 +236,7 @@ TVM_DLL Map<String, String> GetLibInfo() {
       {"USE_STACKVM_RUNTIME", TVM_INFO_USE_STACKVM_RUNTIME},
       {"USE_GRAPH_RUNTIME", TVM_INFO_USE_GRAPH_RUNTIME},
       {"USE_GRAPH_RUNTIME_DEBUG", TVM_INFO_USE_GRAPH_RUNTIME_DEBUG},
+      {"USE_GRAPH_RUNTIME_CUDA_GRAPH", TVM_INFO_USE_GRAPH_RUNTIME_CUDA_GRAPH},
       {"USE_OPENMP", TVM_INFO_USE_OPENMP},
       {"USE_RELAY_DEBUG", TVM_INFO_USE_RELAY_DEBUG},
       {"USE_RTTI", TVM_INFO_USE_RTTI},
@@ -233,6 +246,8 @@ TVM_DLL Map<String, String> GetLibInfo() {
       {"HIDE_PRIVATE_SYMBOLS", TVM_INFO_HIDE_PRIVATE_SYMBOLS},
       {"USE_TF_TVMDSOOP", TVM_INFO_USE_TF_TVMDSOOP},
       {"USE_FALLBACK_STL_MAP", TVM_INFO_USE_FALLBACK_STL_MAP},
+      {"USE_OBJECT_POOL_ALLOCATOR", TVM_INFO_USE_OBJECT_POOL_ALLOCATOR},
+      {"USE_RUNTIME_TRACE", TVM_INFO_USE_RUNTIME_TRACE},
       {"USE_BLAS", TVM_INFO_USE_BLAS},
       {"USE_MKL", TVM_INFO_USE_MKL},
       {"USE_MKLDNN", TVM_INFO_USE_MKLDNN},
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file lz4.h
+ * \brief Dependency free encoder and decoder of the LZ4 block format.
+ */
+#ifndef TVM_SUPPORT_LZ4_H_
+#define TVM_SUPPORT_LZ4_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace support {
+namespace lz4 {
+
+/*! \brief The minimum length of a match. */
+constexpr size_t kMinMatch = 4;
+/*! \brief The last bytes of a block that are always literals. */
+constexpr size_t kLastLiterals = 5;
+/*! \brief A match starts at least this many bytes before the end of a block. */
+constexpr size_t kMatchFindLimit = 12;
+/*! \brief The maximum offset of a match. */
+constexpr size_t kMaxOffset = 65535;
+/*! \brief Log2 of the number of entries of the match finding hash table. */
+constexpr int kHashLog = 16;
+
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Hash(uint32_t seq) { return (seq * 2654435761U) >> (32 - kHashLog); }
+
+// Append a length that does not fit into the token.
+inline void AppendLength(std::string* out, size_t len) {
+  for (; len >= 255; len -= 255) out->push_back(static_cast<char>(255));
+  out->push_back(static_cast<char>(len));
+}
+
+// Append a sequence of literals followed by a match, or only literals when match_len is 0.
+inline void AppendSequence(std::string* out, const uint8_t* lit, size_t lit_len, size_t offset,
+                           size_t match_len) {
+  size_t ml = match_len == 0 ? 0 : match_len - kMinMatch;
+  uint8_t token = static_cast<uint8_t>(((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15));
+  out->push_back(static_cast<char>(token));
+  if (lit_len >= 15) AppendLength(out, lit_len - 15);
+  out->append(reinterpret_cast<const char*>(lit), lit_len);
+  if (match_len == 0) return;
+  out->push_back(static_cast<char>(offset & 255));
+  out->push_back(static_cast<char>(offset >> 8));
+  if (ml >= 15) AppendLength(out, ml - 15);
+}
+
+}  // namespace lz4
+
+/*!
+ * \brief Compress data into a LZ4 block.
+ * \param data The data pointer.
+ * \param size The size of the data.
+ * \return The compressed block.
+ */
+inline std::string LZ4Compress(const void* data, size_t size) {
+  using namespace lz4;  // NOLINT(*)
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  const uint8_t* end = src + size;
+  const uint8_t* anchor = src;
+  std::string out;
+  out.reserve(size / 2 + 16);
+  if (size > kMatchFindLimit) {
+    const uint8_t* match_find_limit = end - kMatchFindLimit;
+    const uint8_t* match_limit = end - kLastLiterals;
+    // position + 1 of the last occurrence of each hashed sequence, 0 for none.
+    std::vector<uint32_t> table(1 << kHashLog, 0);
+    const uint8_t* ip = src;
+    size_t misses = 0;
+    while (ip < match_find_limit) {
+      uint32_t seq = Read32(ip);
+      uint32_t h = Hash(seq);
+      uint32_t ref_pos = table[h];
+      table[h] = static_cast<uint32_t>(ip - src) + 1;
+      const uint8_t* ref = src + ref_pos - 1;
+      if (ref_pos == 0 || static_cast<size_t>(ip - ref) > kMaxOffset || Read32(ref) != seq) {
+        // skip faster over data that does not compress.
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      size_t match_len = kMinMatch;
+      while (ip + match_len < match_limit && ip[match_len] == ref[match_len]) ++match_len;
+      AppendSequence(&out, anchor, ip - anchor, ip - ref, match_len);
+      ip += match_len;
+      anchor = ip;
+      misses = 0;
+    }
+  }
+  AppendSequence(&out, anchor, end - anchor, 0, 0);
+  return out;
+}
+
+/*!
+ * \brief Decompress a LZ4 block.
+ * \param block The compressed block.
+ * \param block_size The size of the block.
+ * \param data The output data pointer.
+ * \param size The size of the data.
+ * \return Whether the block is valid and decompresses into exactly size bytes.
+ */
+inline bool LZ4Decompress(const void* block, size_t block_size, void* data, size_t size) {
+  const uint8_t* ip = static_cast<const uint8_t*>(block);
+  const uint8_t* iend = ip + block_size;
+  uint8_t* dst = static_cast<uint8_t*>(data);
+  uint8_t* op = dst;
+  uint8_t* oend = dst + size;
+  auto read_length = [&ip, iend](size_t* len) {
+    uint8_t b;
+    do {
+      if (ip == iend) return false;
+      b = *ip++;
+      *len += b;
+    } while (b == 255);
+    return true;
+  };
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t lit_len = token >> 4;
+    if (lit_len == 15 && !read_length(&lit_len)) return false;
+    if (lit_len > static_cast<size_t>(iend - ip) || lit_len > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    if (lit_len != 0) memcpy(op, ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+    // the last sequence has no match.
+    if (ip == iend) break;
+    if (iend - ip < 2) return false;
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+    size_t match_len = token & 15;
+    if (match_len == 15 && !read_length(&match_len)) return false;
+    match_len += lz4::kMinMatch;
+    if (match_len > static_cast<size_t>(oend - op)) return false;
+    const uint8_t* ref = op - offset;
+    if (offset >= match_len) {
+      memcpy(op, ref, match_len);
+      op += match_len;
+    } else {
+      // overlapping match, repeats the last offset bytes.
+      for (size_t i = 0; i < match_len; ++i) *op++ = ref[i];
+    }
+  }
+  return op == oend;
+}
+
+}  // namespace support
+}  // namespace tvm
+#endif  // TVM_SUPPORT_LZ4_H_
@@ -24,14 +24,187 @@
 #include <dmlc/logging.h>
 #include <tvm/support/parallel_for.h>
 
-#include <future>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "stealable_task_range.h"
+
 namespace tvm {
 namespace support {
 
+namespace {
+
+/*! \brief A chunk taken from the own block is this fraction of the iterations left in it. */
+constexpr uint32_t kChunkDivisor = 4;
+
+/*! \brief A loop run by the pool. */
+struct ParallelJob {
+  ParallelJob(int num_iters, int num_threads,
+              const std::function<void(int thread_id, int index)>* f)
+      : num_threads(num_threads), f(f), ranges(num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      ranges[i].Reset(static_cast<uint64_t>(num_iters) * i / num_threads,
+                      static_cast<uint64_t>(num_iters) * (i + 1) / num_threads);
+    }
+  }
+  /*! \brief Run iterations until none is left, as the given thread of the job. */
+  void Run(int thread_id) {
+    uint32_t begin, end;
+    while (!failed.load(std::memory_order_relaxed)) {
+      if (!ranges[thread_id].PopChunk(kChunkDivisor, &begin, &end)) {
+        // the own block is drained, steal the back half of another one.
+        bool stolen = false;
+        for (int k = 1; k < num_threads && !stolen; ++k) {
+          int victim = (thread_id + k) % num_threads;
+          stolen = ranges[victim].StealBack(&begin, &end);
+        }
+        // blocks only shrink, nothing is left to steal.
+        if (!stolen) return;
+        ranges[thread_id].Reset(begin, end);
+        continue;
+      }
+      try {
+        for (uint32_t i = begin; i < end; ++i) (*f)(thread_id, static_cast<int>(i));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed.load(std::memory_order_relaxed)) error = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  }
+  /*!
+   * \brief Join the job as a helper.
+   * \return The thread index of the helper, or -1 when the job needs no more threads.
+   */
+  int Claim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || next_thread == num_threads) return -1;
+    ++num_helpers;
+    return next_thread++;
+  }
+  /*! \brief Called by a helper when it leaves the job. */
+  void Leave() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--num_helpers == 0) cv.notify_all();
+  }
+  /*! \brief Stop more helpers from joining, and wait for the ones which joined to leave. */
+  void Close() {
+    std::unique_lock<std::mutex> lock(mutex);
+    closed = true;
+    cv.wait(lock, [this]() { return num_helpers == 0; });
+  }
+
+  const int num_threads;
+  const std::function<void(int thread_id, int index)>* f;
+  /*! \brief The iterations left to each thread. */
+  std::vector<StealableTaskRange> ranges;
+  /*! \brief Whether an iteration threw, the others are skipped. */
+  std::atomic<bool> failed{false};
+  /*! \brief The first exception thrown by an iteration. */
+  std::exception_ptr error;
+  /*! \brief Guards the fields below and error. */
+  std::mutex mutex;
+  std::condition_variable cv;
+  /*! \brief The next thread index given to a helper, the caller is thread 0. */
+  int next_thread{1};
+  /*! \brief The number of helpers which joined and did not leave yet. */
+  int num_helpers{0};
+  /*! \brief Whether the caller finished, later helpers find nothing to do. */
+  bool closed{false};
+};
+
+/*!
+ * \brief The persistent threads of the compiler.
+ *
+ *  A loop posts one request per helper it wants, and runs its first block itself.
+ *  The caller steals whatever the helpers did not take, so it never waits for a
+ *  worker to become free: nested loops cannot deadlock, and a loop completes even
+ *  when the workers are gone, e.g. in a forked child process.
+ */
+class CompilerThreadPool {
+ public:
+  static CompilerThreadPool* Global() {
+    // Leaked, the workers may still be blocked when the process exits.
+    static CompilerThreadPool* inst = new CompilerThreadPool();
+    return inst;
+  }
+
+  int NumThreads() const { return num_workers_ + 1; }
+
+  void Run(int num_iters, int num_threads,
+           const std::function<void(int thread_id, int index)>& f) {
+    num_threads = std::max(1, std::min({num_threads, num_iters, NumThreads()}));
+    if (num_threads == 1) {
+      for (int i = 0; i < num_iters; ++i) f(0, i);
+      return;
+    }
+    auto job = std::make_shared<ParallelJob>(num_iters, num_threads, &f);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      StartWorkers();
+      for (int i = 1; i < num_threads; ++i) queue_.push_back(job);
+    }
+    if (num_threads == 2) {
+      cv_.notify_one();
+    } else {
+      cv_.notify_all();
+    }
+    job->Run(0);
+    job->Close();
+    if (job->error) std::rethrow_exception(job->error);
+  }
+
+ private:
+  CompilerThreadPool() {
+    const char* val = std::getenv("TVM_NUM_COMPILER_THREADS");
+    int num_threads = val != nullptr ? std::atoi(val) : std::thread::hardware_concurrency();
+    num_workers_ = std::max(1, num_threads) - 1;
+  }
+
+  void StartWorkers() {
+    if (started_) return;
+    started_ = true;
+    for (int i = 0; i < num_workers_; ++i) {
+      std::thread([this]() { this->RunWorker(); }).detach();
+    }
+  }
+
+  void RunWorker() {
+    while (true) {
+      std::shared_ptr<ParallelJob> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return !queue_.empty(); });
+        job = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      // the request is stale when the caller finished the job already.
+      int thread_id = job->Claim();
+      if (thread_id < 0) continue;
+      job->Run(thread_id);
+      job->Leave();
+    }
+  }
+
+  int num_workers_;
+  bool started_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /*! \brief Requests for helpers, one entry per helper. */
+  std::deque<std::shared_ptr<ParallelJob>> queue_;
+};
+
+}  // namespace
+
 std::vector<std::vector<int>> rr_partitioner(int begin, int end, int step, int num_threads) {
   int total_task_count = (end - begin) / step;
   CHECK_GT(total_task_count, 0) << "Infinite loop condition, check the input value of "
@@ -49,35 +222,32 @@ std::vector<std::vector<int>> rr_partitioner(int begin, int end, int step, int n
 
 void parallel_for(int begin, int end, const std::function<void(int)>& f, int step,
                   const PartitionerFuncType partitioner) {
-  int default_num_threads = std::thread::hardware_concurrency();
-  const auto& run_partitions = partitioner(begin, end, step, default_num_threads);
-
-  std::vector<std::thread> threads;
-  threads.reserve(run_partitions.size());
-  std::vector<std::future<void>> res_vec;
-  res_vec.reserve(run_partitions.size());
-  for (const auto& run_partition : run_partitions) {
-    std::packaged_task<void(const std::vector<int>&, const std::function<void(int)>&)> task(
-        [](const std::vector<int>& run_pattition, const std::function<void(int)>& f) {
-          for (const auto& i : run_pattition) {
-            f(i);
-          }
-        });
-    res_vec.emplace_back(task.get_future());
-    threads.emplace_back(std::move(task), run_partition, f);
-  }
-
-  for (auto&& thread : threads) {
-    thread.join();
-  }
+  CHECK_GT(step, 0) << "Infinite loop condition, check the input value of `step`.";
   try {
-    for (auto&& i : res_vec) {
-      i.get();
+    if (partitioner != nullptr) {
+      const auto& run_partitions = partitioner(begin, end, step, NumCompilerThreads());
+      int num_partitions = static_cast<int>(run_partitions.size());
+      parallel_for_dynamic(0, num_partitions, num_partitions, [&](int, int p) {
+        for (int i : run_partitions[p]) f(i);
+      });
+    } else {
+      int num_iters = begin < end ? (end - begin + step - 1) / step : 0;
+      parallel_for_dynamic(0, num_iters, NumCompilerThreads(),
+                           [&](int, int i) { f(begin + i * step); });
     }
   } catch (const std::exception& e) {
     LOG(FATAL) << "Parallel_for error with " << e.what();
   }
 }
 
+void parallel_for_dynamic(int begin, int end, int num_threads,
+                          const std::function<void(int thread_id, int index)>& f) {
+  if (begin >= end) return;
+  CompilerThreadPool::Global()->Run(end - begin, num_threads,
+                                    [&](int thread_id, int i) { f(thread_id, begin + i); });
+}
+
+int NumCompilerThreads() { return CompilerThreadPool::Global()->NumThreads(); }
+
 }  // namespace support
 }  // namespace tvm
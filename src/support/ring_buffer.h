@@ -25,6 +25,8 @@
 #define TVM_SUPPORT_RING_BUFFER_H_
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
@@ -102,6 +104,20 @@ class RingBuffer {
     head_ptr_ = (head_ptr_ + size) % ring_.size();
     bytes_available_ -= size;
   }
+  /*!
+   * \brief Copy data from the front of the buffer without consuming it.
+   *  size must be smaller than this->bytes_available()
+   * \param data the data pointer.
+   * \param size The number of bytes to copy.
+   */
+  void Peek(void* data, size_t size) const {
+    CHECK_GE(bytes_available_, size);
+    size_t ncopy = std::min(size, ring_.size() - head_ptr_);
+    memcpy(data, &ring_[0] + head_ptr_, ncopy);
+    if (ncopy < size) {
+      memcpy(reinterpret_cast<char*>(data) + ncopy, &ring_[0], size - ncopy);
+    }
+  }
   /*!
    * \brief Read data from buffer with and put them to non-blocking send function.
    *
@@ -179,6 +195,77 @@ class RingBuffer {
   // The internal data ring.
   std::vector<char> ring_;
 };
+
+/*!
+ * \brief Fixed capacity ring of trivially copyable records with a single writer,
+ *  which overwrites the oldest records once the ring is full.
+ *
+ *  Unlike RingBuffer, a write never allocates, blocks or takes a lock, and other
+ *  threads can copy the records concurrently with the writer. Like a seqlock, the
+ *  copy checks the write count again afterwards and drops the records which may
+ *  have been overwritten while they were copied.
+ *
+ * \tparam T The record type, trivially copyable.
+ */
+template <typename T>
+class OverwriteRingBuffer {
+ public:
+  /*!
+   * \brief constructor
+   * \param capacity The number of records kept, rounded up to a power of two.
+   */
+  explicit OverwriteRingBuffer(size_t capacity) {
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+    ring_.resize(n);
+  }
+  /*! \return The number of records kept. */
+  size_t capacity() const { return ring_.size(); }
+  /*! \return The number of records written since construction. */
+  uint64_t write_count() const { return write_count_.load(std::memory_order_acquire); }
+  /*!
+   * \brief Append a record, overwriting the oldest one when the ring is full.
+   *  Only called from the writer thread.
+   * \param record The record.
+   */
+  void Push(const T& record) {
+    uint64_t n = write_count_.load(std::memory_order_relaxed);
+    // A reader that sees part of this record also sees the count it is overwritten at.
+    std::atomic_thread_fence(std::memory_order_release);
+    ring_[n & (ring_.size() - 1)] = record;
+    write_count_.store(n + 1, std::memory_order_release);
+  }
+  /*!
+   * \brief Copy the records still in the ring, callable from any thread.
+   * \param from The write count to copy from, the records before it are skipped.
+   * \param out The records are appended to it, oldest first.
+   * \return The write count after the last copied record, to continue from.
+   */
+  uint64_t Snapshot(uint64_t from, std::vector<T>* out) const {
+    uint64_t end = write_count_.load(std::memory_order_acquire);
+    uint64_t cap = ring_.size();
+    uint64_t begin = std::max(from, end > cap ? end - cap : 0);
+    size_t offset = out->size();
+    for (uint64_t i = begin; i < end; ++i) {
+      out->push_back(ring_[i & (cap - 1)]);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The writer may be overwriting the record at the current count - capacity.
+    uint64_t now = write_count_.load(std::memory_order_relaxed);
+    uint64_t valid = now + 1 > cap ? now + 1 - cap : 0;
+    if (valid > begin) {
+      uint64_t ndrop = std::min(valid, end) - begin;
+      out->erase(out->begin() + offset, out->begin() + offset + ndrop);
+    }
+    return end;
+  }
+
+ private:
+  // Total number of records written.
+  std::atomic<uint64_t> write_count_{0};
+  // The records, indexed by the write count modulo the capacity.
+  std::vector<T> ring_;
+};
 }  // namespace support
 }  // namespace tvm
 #endif  // TVM_SUPPORT_RING_BUFFER_H_
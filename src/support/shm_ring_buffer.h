@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file shm_ring_buffer.h
+ * \brief Ring buffer in memory shared between two processes, used for IPC.
+ */
+#ifndef TVM_SUPPORT_SHM_RING_BUFFER_H_
+#define TVM_SUPPORT_SHM_RING_BUFFER_H_
+
+// Linux only for now, as the waits are built on futex.
+#if defined(__linux__) || defined(__ANDROID__)
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace tvm {
+namespace support {
+
+/*!
+ * \brief Ring buffer with a single writer and a single reader, which can live in different
+ *  processes sharing the memory of the ring.
+ *
+ *  Unlike RingBuffer, the capacity is fixed. Write blocks while the ring is full
+ *  and Read blocks while it is empty, the blocked side spins shortly before it sleeps
+ *  on a futex. The ring only uses lock-free atomics and no allocation, so it is
+ *  usable from the minimum RPC server.
+ */
+class ShmRingBuffer {
+ public:
+  /*! \brief The control block at the start of the memory of a ring. */
+  struct alignas(64) Control {
+    /*! \brief Total number of bytes written. */
+    std::atomic<uint64_t> write_count;
+    /*! \brief Total number of bytes read. */
+    std::atomic<uint64_t> read_count;
+    /*! \brief Bumped by every write, the blocked reader sleeps on it. */
+    std::atomic<uint32_t> data_seq;
+    /*! \brief Bumped by every read, the blocked writer sleeps on it. */
+    std::atomic<uint32_t> space_seq;
+    /*! \brief Number of sides sleeping on a seq. */
+    std::atomic<uint32_t> num_sleepers;
+    /*! \brief Whether the ring is closed by either side. */
+    std::atomic<uint32_t> closed;
+  };
+  /*!
+   * \brief Get the size of the memory of a ring.
+   * \param capacity The number of data bytes of the ring.
+   * \return The size in bytes.
+   */
+  static size_t MemorySize(size_t capacity) { return sizeof(Control) + capacity; }
+  /*!
+   * \brief Get the capacity of a ring from the size of its memory.
+   * \param nbytes The size in bytes.
+   * \return The number of data bytes of the ring.
+   */
+  static size_t Capacity(size_t nbytes) { return nbytes - sizeof(Control); }
+  /*!
+   * \brief constructor
+   * \param memory The memory of the ring, zero filled when the ring is created.
+   * \param capacity The number of data bytes of the ring.
+   */
+  ShmRingBuffer(void* memory, size_t capacity)
+      : ctrl_(static_cast<Control*>(memory)),
+        data_(static_cast<char*>(memory) + sizeof(Control)),
+        capacity_(capacity) {}
+  /*!
+   * \brief Write data into the ring, blocks until at least one byte is written.
+   * \param data The data pointer.
+   * \param size The size of the data.
+   * \param falive Called while blocked for long, returns false when the peer is gone.
+   * \return The number of bytes written, 0 when the ring is closed or the peer is gone.
+   * \tparam FAlive A function with signature bool ().
+   */
+  template <typename FAlive>
+  size_t Write(const void* data, size_t size, FAlive falive) {
+    if (size == 0) return 0;
+    uint64_t tail = ctrl_->write_count.load(std::memory_order_relaxed);
+    size_t space = 0;
+    while (true) {
+      uint32_t seq = ctrl_->space_seq.load(std::memory_order_seq_cst);
+      if (ctrl_->closed.load(std::memory_order_acquire) != 0) return 0;
+      uint64_t head = ctrl_->read_count.load(std::memory_order_acquire);
+      space = capacity_ - static_cast<size_t>(tail - head);
+      if (space != 0) break;
+      if (!this->WaitChange(&ctrl_->space_seq, seq, falive)) return 0;
+    }
+    size_t n = std::min(size, space);
+    size_t offset = static_cast<size_t>(tail % capacity_);
+    size_t ncopy = std::min(n, capacity_ - offset);
+    memcpy(data_ + offset, data, ncopy);
+    memcpy(data_, static_cast<const char*>(data) + ncopy, n - ncopy);
+    ctrl_->write_count.store(tail + n, std::memory_order_release);
+    this->Notify(&ctrl_->data_seq);
+    return n;
+  }
+  /*!
+   * \brief Read data from the ring, blocks until at least one byte is read.
+   * \param data The data pointer.
+   * \param size The maximum number of bytes to read.
+   * \param falive Called while blocked for long, returns false when the peer is gone.
+   * \return The number of bytes read, 0 when the ring is closed or the peer is gone.
+   * \tparam FAlive A function with signature bool ().
+   */
+  template <typename FAlive>
+  size_t Read(void* data, size_t size, FAlive falive) {
+    if (size == 0) return 0;
+    uint64_t head = ctrl_->read_count.load(std::memory_order_relaxed);
+    size_t avail = 0;
+    while (true) {
+      uint32_t seq = ctrl_->data_seq.load(std::memory_order_seq_cst);
+      avail = static_cast<size_t>(ctrl_->write_count.load(std::memory_order_acquire) - head);
+      if (avail != 0) break;
+      // Data written before the close is still delivered.
+      if (ctrl_->closed.load(std::memory_order_acquire) != 0) return 0;
+      if (!this->WaitChange(&ctrl_->data_seq, seq, falive)) return 0;
+    }
+    size_t n = std::min(size, avail);
+    size_t offset = static_cast<size_t>(head % capacity_);
+    size_t ncopy = std::min(n, capacity_ - offset);
+    memcpy(data, data_ + offset, ncopy);
+    memcpy(static_cast<char*>(data) + ncopy, data_, n - ncopy);
+    ctrl_->read_count.store(head + n, std::memory_order_release);
+    this->Notify(&ctrl_->space_seq);
+    return n;
+  }
+  /*! \brief Close the ring, waking up the blocked peer. */
+  void Close() {
+    ctrl_->closed.store(1, std::memory_order_release);
+    this->Notify(&ctrl_->data_seq);
+    this->Notify(&ctrl_->space_seq);
+  }
+
+ private:
+  /*! \brief Number of yields before a blocked side sleeps. */
+  static constexpr int kSpinCount = 256;
+  /*! \brief Sleep time in nanoseconds between the checks of the peer. */
+  static constexpr long kSleepNanoSec = 10 * 1000 * 1000;  // NOLINT(*)
+
+  // Wait until seq no longer equals value, returns false if the peer is gone.
+  template <typename FAlive>
+  bool WaitChange(std::atomic<uint32_t>* seq, uint32_t value, FAlive falive) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (seq->load(std::memory_order_acquire) != value) return true;
+      sched_yield();
+    }
+    ctrl_->num_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    while (seq->load(std::memory_order_seq_cst) == value) {
+      timespec timeout;
+      timeout.tv_sec = 0;
+      timeout.tv_nsec = kSleepNanoSec;
+      // The futex only sleeps if seq still equals value, so a notify is never lost.
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(seq), FUTEX_WAIT, value, &timeout, nullptr,
+              0);
+      if (seq->load(std::memory_order_acquire) == value && !falive()) {
+        ctrl_->num_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        return false;
+      }
+    }
+    ctrl_->num_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+    return true;
+  }
+  // Bump seq and wake up the sleepers on it.
+  void Notify(std::atomic<uint32_t>* seq) {
+    seq->fetch_add(1, std::memory_order_seq_cst);
+    if (ctrl_->num_sleepers.load(std::memory_order_seq_cst) != 0) {
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(seq), FUTEX_WAKE, INT32_MAX, nullptr,
+              nullptr, 0);
+    }
+  }
+
+  /*! \brief The control block. */
+  Control* ctrl_;
+  /*! \brief The data bytes. */
+  char* data_;
+  /*! \brief The number of data bytes. */
+  size_t capacity_;
+};
+
+}  // namespace support
+}  // namespace tvm
+#endif  // defined(__linux__) || defined(__ANDROID__)
+#endif  // TVM_SUPPORT_SHM_RING_BUFFER_H_
@@ -43,6 +43,7 @@ using ssize_t = int;
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 #include <dmlc/logging.h>
@@ -458,6 +459,26 @@ class TCPSocket : public Socket {
     const char* buf = reinterpret_cast<const char*>(buf_);
     return send(sockfd, buf, static_cast<sock_size_t>(len), flag);
   }
+  /*!
+   * \brief send a sequence of buffers using the socket, as if they were concatenated
+   * \param bufs the pointers to the buffers
+   * \param lens the sizes of the buffers
+   * \param num the number of buffers
+   * \return size of data actually sent
+   *         return -1 if error occurs
+   */
+  ssize_t SendV(const void* const* bufs, const size_t* lens, int num) {
+#if defined(_WIN32)
+    return Send(bufs[0], lens[0]);
+#else
+    std::vector<iovec> iov(num);
+    for (int i = 0; i < num; ++i) {
+      iov[i].iov_base = const_cast<void*>(bufs[i]);
+      iov[i].iov_len = lens[i];
+    }
+    return writev(sockfd, iov.data(), num);
+#endif
+  }
   /*!
    * \brief receive data using the socket
    * \param buf_ the pointer to the buffer
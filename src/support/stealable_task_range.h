@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file stealable_task_range.h
+ * \brief A range of task ids shared by the workers of a work stealing pool.
+ */
+#ifndef TVM_SUPPORT_STEALABLE_TASK_RANGE_H_
+#define TVM_SUPPORT_STEALABLE_TASK_RANGE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace tvm {
+namespace support {
+
+/*!
+ * \brief A contiguous range of task ids that can be consumed by its owner
+ *  worker from the front and stolen by other workers from the back.
+ *
+ *  The range behaves as a work-stealing deque whose elements are implied by
+ *  [begin, end), both ends are packed into a single atomic word so that the
+ *  owner and the thieves synchronize with one compare-and-swap.
+ */
+class StealableTaskRange {
+ public:
+  /*! \brief Reset the range, only called while no other worker is consuming it. */
+  void Reset(uint32_t begin, uint32_t end) { range_.store(Pack(begin, end)); }
+  /*!
+   * \brief Take the first task of the range, called by the owner worker.
+   * \param task_id The task id taken.
+   * \return Whether a task was taken.
+   */
+  bool PopFront(int* task_id) {
+    uint64_t cur = range_.load(std::memory_order_acquire);
+    while (Begin(cur) < End(cur)) {
+      if (range_.compare_exchange_weak(cur, Pack(Begin(cur) + 1, End(cur)))) {
+        *task_id = static_cast<int>(Begin(cur));
+        return true;
+      }
+    }
+    return false;
+  }
+  /*!
+   * \brief Take a chunk from the front of the range, called by the owner worker.
+   *
+   *  The chunk is a fraction of the remaining tasks, so chunks shrink as the range
+   *  drains: large chunks keep the synchronization rare, the small last ones keep
+   *  the workers balanced.
+   * \param divisor The chunk is 1/divisor of the remaining tasks, at least one.
+   * \param begin The begin of the tasks taken.
+   * \param end The end of the tasks taken.
+   * \return Whether any task was taken.
+   */
+  bool PopChunk(uint32_t divisor, uint32_t* begin, uint32_t* end) {
+    uint64_t cur = range_.load(std::memory_order_acquire);
+    while (Begin(cur) < End(cur)) {
+      uint32_t chunk = std::max<uint32_t>(1, (End(cur) - Begin(cur)) / divisor);
+      if (range_.compare_exchange_weak(cur, Pack(Begin(cur) + chunk, End(cur)))) {
+        *begin = Begin(cur);
+        *end = Begin(cur) + chunk;
+        return true;
+      }
+    }
+    return false;
+  }
+  /*!
+   * \brief Steal the back half of the range, called by the other workers.
+   * \param begin The begin of the stolen tasks.
+   * \param end The end of the stolen tasks.
+   * \return Whether any task was stolen.
+   */
+  bool StealBack(uint32_t* begin, uint32_t* end) {
+    uint64_t cur = range_.load(std::memory_order_acquire);
+    while (Begin(cur) < End(cur)) {
+      uint32_t mid = Begin(cur) + (End(cur) - Begin(cur)) / 2;
+      if (range_.compare_exchange_weak(cur, Pack(Begin(cur), mid))) {
+        *begin = mid;
+        *end = End(cur);
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  static constexpr int kL1CacheBytes = 64;
+  static uint64_t Pack(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+  }
+  static uint32_t Begin(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+  static uint32_t End(uint64_t range) { return static_cast<uint32_t>(range); }
+  // the packed range, begin in the higher 32 bits.
+  std::atomic<uint64_t> range_{0};
+  // pad to cache line to avoid false sharing between the workers.
+  char pad_[kL1CacheBytes - sizeof(std::atomic<uint64_t>)];
+};
+
+}  // namespace support
+}  // namespace tvm
+#endif  // TVM_SUPPORT_STEALABLE_TASK_RANGE_H_
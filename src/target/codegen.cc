@@ -38,6 +38,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "../runtime/params_section.h"
+
 namespace tvm {
 namespace codegen {
 
@@ -216,8 +218,15 @@ std::string PackImportsToC(const runtime::Module& mod, bool system_lib) {
 }
 
 runtime::Module PackImportsToLLVM(const runtime::Module& mod, bool system_lib,
-                                  const std::string& target_triple) {
-  std::string bin = SerializeModule(mod);
+                                  const std::string& target_triple, bool params_section) {
+  std::string bin, params;
+  if (params_section) {
+    runtime::ParamsSectionWriter writer;
+    bin = SerializeModule(mod);
+    if (writer.size() != 0) params = writer.Finish();
+  } else {
+    bin = SerializeModule(mod);
+  }
 
   uint64_t nbytes = bin.length();
   std::string header;
@@ -228,13 +237,16 @@ runtime::Module PackImportsToLLVM(const runtime::Module& mod, bool system_lib,
   TVMByteArray blob_byte_array;
   blob_byte_array.size = blob.length();
   blob_byte_array.data = blob.data();
+  TVMByteArray params_byte_array;
+  params_byte_array.size = params.length();
+  params_byte_array.data = params.data();
 
   // Call codegen_blob to generate LLVM module
   std::string codegen_f_name = "codegen.codegen_blob";
   // the codegen function.
   const PackedFunc* codegen_f = runtime::Registry::Get(codegen_f_name);
   CHECK(codegen_f != nullptr) << "codegen.codegen_blob is not presented.";
-  return (*codegen_f)(blob_byte_array, system_lib, target_triple);
+  return (*codegen_f)(blob_byte_array, system_lib, target_triple, params_byte_array);
 }
 
 TVM_REGISTER_GLOBAL("target.Build").set_body_typed(Build);
@@ -161,6 +161,33 @@ TVM_REGISTER_GLOBAL("tvm.intrin.rule.default.q_multiply_shift")
       *rv = cast(lp_dtype, x);
     });
 
+// Get lane i of a vector of 4 8-bit integers.
+static PrimExpr DP4ALane(const PrimExpr& vec, int i) {
+  if (const auto* load = vec.as<tir::LoadNode>()) {
+    if (const auto* ramp = load->index.as<tir::RampNode>()) {
+      return tir::Load(vec.dtype().element_of(), load->buffer_var,
+                       ramp->base + ramp->stride * i, tir::const_true());
+    }
+  }
+  return tir::Shuffle::ExtractElement(vec, i);
+}
+
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.default.dp4a")
+    .set_body([](const TVMArgs& args, TVMRetValue* rv) {
+      PrimExpr e = args[0];
+      const tir::CallNode* call = e.as<tir::CallNode>();
+      CHECK(call != nullptr);
+      CHECK_EQ(call->args.size(), 3);  // a, b, c
+
+      PrimExpr ret = call->args[2];
+      for (int i = 0; i < 4; ++i) {
+        PrimExpr a = cast(ret.dtype(), DP4ALane(call->args[0], i));
+        PrimExpr b = cast(ret.dtype(), DP4ALane(call->args[1], i));
+        ret = ret + a * b;
+      }
+      *rv = ret;
+    });
+
 }  // namespace intrin
 }  // namespace codegen
 }  // namespace tvm
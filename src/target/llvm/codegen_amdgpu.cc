@@ -27,6 +27,9 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <cctype>
+#include <string>
+
 #include "../../runtime/rocm/rocm_module.h"
 #include "../build_common.h"
 #include "codegen_llvm.h"
@@ -191,12 +194,13 @@ class CodeGenAMDGPU : public CodeGenLLVM {
   }
 };
 
-inline int DetectROCMComputeVersion(const std::string& target) {
+/*! \brief The gfx architecture of the target, e.g. 908 or 90a. */
+inline std::string DetectROCMComputeVersion(const std::string& target) {
   size_t pos = target.find("=gfx");
   if (pos != std::string::npos) {
-    int value;
-    std::stringstream is(target.substr(pos + 4));
-    if (is >> value) return value;
+    size_t end = pos + 4;
+    while (end < target.length() && std::isalnum(static_cast<unsigned char>(target[end]))) ++end;
+    if (end != pos + 4) return target.substr(pos + 4, end - pos - 4);
   }
   TVMContext tvm_ctx;
   tvm_ctx.device_type = kDLROCM;
@@ -207,11 +211,11 @@ inline int DetectROCMComputeVersion(const std::string& target) {
     api->GetAttr(tvm_ctx, tvm::runtime::kExist, &val);
     if (val.operator int() == 1) {
       tvm::runtime::DeviceAPI::Get(tvm_ctx)->GetAttr(tvm_ctx, tvm::runtime::kGcnArch, &val);
-      return val.operator int();
+      return std::to_string(val.operator int());
     }
   }
   LOG(WARNING) << "Cannot find -mcpu to specify rocm compute version assume gfx900";
-  return 900;
+  return "900";
 }
 
 inline int DetectROCMApiVersion() {
@@ -130,6 +130,39 @@ TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_arm")
       *rv = static_cast<void*>(cg);
     });
 
+// AArch64 specific code generator, the loops left to the LLVM loop vectorizer
+// use scalable vectors with predicated tails when the target has SVE.
+class CodeGenAArch64 final : public CodeGenCPU {
+ public:
+  void InitTarget(llvm::TargetMachine* tm) final {
+    has_sve_ = tm->getTargetFeatureString().find("+sve") != llvm::StringRef::npos;
+    CodeGenCPU::InitTarget(tm);
+  }
+
+  std::vector<llvm::Metadata*> GetLoopVectorizeProperties() final {
+    std::vector<llvm::Metadata*> properties = CodeGenCPU::GetLoopVectorizeProperties();
+#if TVM_LLVM_VERSION >= 120
+    if (has_sve_) {
+      llvm::Metadata* enable = llvm::ConstantAsMetadata::get(builder_->getTrue());
+      properties.push_back(llvm::MDNode::get(
+          *ctx_, {llvm::MDString::get(*ctx_, "llvm.loop.vectorize.scalable.enable"), enable}));
+      properties.push_back(llvm::MDNode::get(
+          *ctx_, {llvm::MDString::get(*ctx_, "llvm.loop.vectorize.predicate.enable"), enable}));
+    }
+#endif
+    return properties;
+  }
+
+ private:
+  bool has_sve_{false};
+};
+
+TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_aarch64")
+    .set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+      CodeGenLLVM* cg = new CodeGenAArch64();
+      *rv = static_cast<void*>(cg);
+    });
+
 }  // namespace codegen
 }  // namespace tvm
 #endif  // TVM_LLVM_VERSION
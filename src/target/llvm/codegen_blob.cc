@@ -25,13 +25,17 @@
 
 #include <tvm/runtime/module.h>
 
-#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../runtime/params_section.h"
 
 namespace tvm {
 namespace codegen {
 
 std::pair<std::unique_ptr<llvm::Module>, std::shared_ptr<llvm::LLVMContext>> CodeGenBlob(
-    const std::string& data, bool system_lib, const std::string& target_triple) {
+    const std::string& data, bool system_lib, const std::string& target_triple,
+    const std::string& params) {
   InitializeLLVM();
   std::string full_target_triple = std::string("-mtriple ") + target_triple;
   auto tm = GetLLVMTargetMachine(full_target_triple);
@@ -60,6 +64,31 @@ std::pair<std::unique_ptr<llvm::Module>, std::shared_ptr<llvm::LLVMContext>> Cod
     tvm_dev_mblob->setDLLStorageClass(llvm::GlobalVariable::DLLExportStorageClass);
   }
 
+  // The params section is page aligned in a read-only section, so that the tensors loaded from
+  // the blob view the mapped library in place.
+  llvm::GlobalVariable* tvm_dev_mparams = nullptr;
+  if (!params.empty()) {
+    auto* params_value = llvm::ConstantDataArray::getString(*ctx, params, false);
+    tvm_dev_mparams = new llvm::GlobalVariable(
+        *module, params_value->getType(), true, llvm::GlobalValue::ExternalLinkage, params_value,
+        runtime::symbol::tvm_dev_mparams, nullptr, llvm::GlobalVariable::NotThreadLocal, 0);
+#if TVM_LLVM_VERSION >= 100
+    tvm_dev_mparams->setAlignment(llvm::Align(runtime::kParamsSectionAlignment));
+#else
+    tvm_dev_mparams->setAlignment(runtime::kParamsSectionAlignment);
+#endif
+    if (triple.isOSBinFormatELF()) {
+      tvm_dev_mparams->setSection(".rodata.tvm_params");
+    } else if (triple.isOSBinFormatMachO()) {
+      tvm_dev_mparams->setSection("__TEXT,__tvm_params");
+    } else if (triple.isOSBinFormatCOFF()) {
+      tvm_dev_mparams->setSection(".rdata$tvm_params");
+    }
+    if (triple.isOSWindows()) {
+      tvm_dev_mparams->setDLLStorageClass(llvm::GlobalVariable::DLLExportStorageClass);
+    }
+  }
+
   if (system_lib) {
     // LLVM type helper
     auto void_ty = llvm::Type::getVoidTy(*ctx);
@@ -68,28 +97,36 @@ std::pair<std::unique_ptr<llvm::Module>, std::shared_ptr<llvm::LLVMContext>> Cod
     auto int8_ptr_ty = int8_ty->getPointerTo(0);
 
     llvm::Constant* constant_zero = llvm::Constant::getNullValue(int32_ty);
-    auto* tvm_dev_mblob_reg = new llvm::GlobalVariable(
-        *module, int32_ty, false, llvm::GlobalValue::InternalLinkage, constant_zero,
-        std::string(runtime::symbol::tvm_dev_mblob) + "_reg_");
-    auto tvm_dev_mblob_reg_alignment = module->getDataLayout().getABITypeAlignment(int32_ty);
+    auto reg_alignment = module->getDataLayout().getABITypeAlignment(int32_ty);
+
+    // The globals registered as system library symbols, with the variables
+    // keeping the results of registration and the strings of their names.
+    std::vector<llvm::GlobalVariable*> reg_symbols = {tvm_dev_mblob};
+    if (tvm_dev_mparams != nullptr) reg_symbols.push_back(tvm_dev_mparams);
+    std::vector<llvm::GlobalVariable*> reg_results, reg_names;
+    for (llvm::GlobalVariable* symbol : reg_symbols) {
+      std::string name = symbol->getName().str();
+      auto* reg = new llvm::GlobalVariable(*module, int32_ty, false,
+                                           llvm::GlobalValue::InternalLinkage, constant_zero,
+                                           name + "_reg_");
 #if TVM_LLVM_VERSION >= 100
-    tvm_dev_mblob_reg->setAlignment(llvm::Align(tvm_dev_mblob_reg_alignment));
+      reg->setAlignment(llvm::Align(reg_alignment));
 #else
-    tvm_dev_mblob_reg->setAlignment(tvm_dev_mblob_reg_alignment);
+      reg->setAlignment(reg_alignment);
 #endif
+      reg_results.push_back(reg);
 
-    auto* tvm_dev_mblob_string_ty =
-        llvm::ArrayType::get(int8_ty, std::strlen(runtime::symbol::tvm_dev_mblob) + 1);
-    auto* tvm_dev_mblob_string_value =
-        llvm::ConstantDataArray::getString(*ctx, runtime::symbol::tvm_dev_mblob, true);
-    auto* tvm_dev_mblob_string = new llvm::GlobalVariable(
-        *module, tvm_dev_mblob_string_ty, true, llvm::GlobalValue::PrivateLinkage,
-        tvm_dev_mblob_string_value, std::string(runtime::symbol::tvm_dev_mblob) + ".str");
+      auto* string_value = llvm::ConstantDataArray::getString(*ctx, name, true);
+      auto* name_string = new llvm::GlobalVariable(*module, string_value->getType(), true,
+                                                   llvm::GlobalValue::PrivateLinkage,
+                                                   string_value, name + ".str");
 #if TVM_LLVM_VERSION >= 100
-    tvm_dev_mblob_string->setAlignment(llvm::Align(1));
+      name_string->setAlignment(llvm::Align(1));
 #else
-    tvm_dev_mblob_string->setAlignment(1);
+      name_string->setAlignment(1);
 #endif
+      reg_names.push_back(name_string);
+    }
 
     // Global init function
     llvm::Function* init_fn = llvm::Function::Create(
@@ -139,13 +176,15 @@ std::pair<std::unique_ptr<llvm::Module>, std::shared_ptr<llvm::LLVMContext>> Cod
     llvm::BasicBlock* var_init_fn_bb = llvm::BasicBlock::Create(*ctx, "entry", var_init_fn);
     ir_builder.SetInsertPoint(var_init_fn_bb);
     llvm::Constant* indices[] = {constant_zero, constant_zero};
-    llvm::SmallVector<llvm::Value*, 2> args;
-    args.push_back(llvm::ConstantExpr::getGetElementPtr(tvm_dev_mblob_string_ty,
-                                                        tvm_dev_mblob_string, indices));
-    args.push_back(
-        llvm::ConstantExpr::getGetElementPtr(blob_value->getType(), tvm_dev_mblob, indices));
-    auto* tvm_backend_fn_ret_value = ir_builder.CreateCall(tvm_backend_fn, args);
-    ir_builder.CreateStore(tvm_backend_fn_ret_value, tvm_dev_mblob_reg);
+    for (size_t i = 0; i < reg_symbols.size(); ++i) {
+      llvm::SmallVector<llvm::Value*, 2> args;
+      args.push_back(llvm::ConstantExpr::getGetElementPtr(reg_names[i]->getValueType(),
+                                                          reg_names[i], indices));
+      args.push_back(llvm::ConstantExpr::getGetElementPtr(reg_symbols[i]->getValueType(),
+                                                          reg_symbols[i], indices));
+      auto* tvm_backend_fn_ret_value = ir_builder.CreateCall(tvm_backend_fn, args);
+      ir_builder.CreateStore(tvm_backend_fn_ret_value, reg_results[i]);
+    }
     ir_builder.CreateRetVoid();
   }
 
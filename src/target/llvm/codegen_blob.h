@@ -38,11 +38,14 @@ namespace codegen {
  * \param data Blob data
  * \param system_lib Whether expose as system library.
  * \param target_triple LLVM target triple
+ * \param params The params section of the blob, emitted page aligned in a
+ *  read-only section when not empty.
  *
  * \return LLVM module and LLVM context
  */
 std::pair<std::unique_ptr<llvm::Module>, std::shared_ptr<llvm::LLVMContext>> CodeGenBlob(
-    const std::string& data, bool system_lib, const std::string& target_triple);
+    const std::string& data, bool system_lib, const std::string& target_triple,
+    const std::string& params = "");
 
 }  // namespace codegen
 }  // namespace tvm
@@ -26,9 +26,11 @@
 
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
 #include <tvm/tir/op.h>
 
 #include <algorithm>
+#include <limits>
 
 #include "../../arith/pattern_match.h"
 #include "../build_common.h"
@@ -87,6 +89,9 @@ void CodeGenLLVM::InitTarget(llvm::TargetMachine* tm) {
       native_vector_bits_ = 256;
     } else if (arch == llvm::Triple::arm || arch == llvm::Triple::aarch64) {
       native_vector_bits_ = 128;
+    } else if (arch == llvm::Triple::wasm32 || arch == llvm::Triple::wasm64) {
+      // SIMD128, enabled with -mattr=+simd128
+      native_vector_bits_ = 128;
     } else {
       native_vector_bits_ = 128;
       std::string arch_name = std::string(tm->getTargetTriple().getArchName());
@@ -130,6 +135,11 @@ void CodeGenLLVM::AddFunctionInternal(const PrimFunc& f, bool ret_void) {
       << "CodeGenLLVM: Expect PrimFunc to have the global_symbol attribute";
   CHECK(module_->getFunction(static_cast<std::string>(global_symbol.value())) == nullptr)
       << "Function " << global_symbol << " already exist in module";
+  pgo_func_name_ = global_symbol.value();
+  pgo_loop_keys_.clear();
+  if (pgo_instrument_ || pgo_profile_ != nullptr) {
+    pgo_loop_keys_ = PGOProfile::LoopKeys(pgo_func_name_, f->body);
+  }
 
   function_ = llvm::Function::Create(ftype, llvm::Function::ExternalLinkage,
                                      global_symbol.value().operator std::string(), module_.get());
@@ -180,6 +190,7 @@ void CodeGenLLVM::AddFunctionInternal(const PrimFunc& f, bool ret_void) {
 }
 
 std::unique_ptr<llvm::Module> CodeGenLLVM::Finish() {
+  this->AddPGOCounters();
   this->AddStartupFunction();
   for (size_t i = 0; i < link_modules_.size(); ++i) {
     CHECK(!llvm::Linker::linkModules(*module_, std::move(link_modules_[i])))
@@ -566,29 +577,132 @@ llvm::Value* CodeGenLLVM::CreateVecConcat(std::vector<llvm::Value*> vecs) {
 }
 
 void CodeGenLLVM::CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                                  const Var& loop_var, const Stmt& body) {
+                                  const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md) {
   using llvm::BasicBlock;
   BasicBlock* pre_block = builder_->GetInsertBlock();
   BasicBlock* for_begin = BasicBlock::Create(*ctx_, "for_begin", function_);
   BasicBlock* for_body = BasicBlock::Create(*ctx_, "for_body", function_);
   BasicBlock* for_end = BasicBlock::Create(*ctx_, "for_end", function_);
+  bool use_pgo = pgo_instrument_ || pgo_profile_ != nullptr;
+  std::string pgo_key;
+  if (use_pgo) {
+    auto it = pgo_loop_keys_.find(loop_var.get());
+    // A loop outside of the body of the function is keyed by its variable alone.
+    pgo_key = it != pgo_loop_keys_.end() ? it->second
+                                         : pgo_func_name_ + ":for:" + loop_var->name_hint;
+  }
+  if (pgo_instrument_) PGOCount(pgo_key, 0);
   builder_->CreateBr(for_begin);
   builder_->SetInsertPoint(for_begin);
   llvm::PHINode* loop_value = builder_->CreatePHI(begin->getType(), 2);
   loop_value->addIncoming(begin, pre_block);
   CHECK(!var_map_.count(loop_var.get()));
   var_map_[loop_var.get()] = loop_value;
+  llvm::MDNode* weights = PGOBranchWeights(pgo_key, true);
   builder_->CreateCondBr(CreateLT(loop_var.dtype(), loop_value, end), for_body, for_end,
-                         md_very_likely_branch_);
+                         weights != nullptr ? weights : md_very_likely_branch_);
   builder_->SetInsertPoint(for_body);
+  if (pgo_instrument_) PGOCount(pgo_key, 1);
   this->VisitStmt(body);
   var_map_.erase(loop_var.get());
   llvm::Value* loop_next = CreateAdd(loop_var.dtype(), loop_value, stride);
   loop_value->addIncoming(loop_next, builder_->GetInsertBlock());
-  builder_->CreateBr(for_begin);
+  llvm::BranchInst* latch = builder_->CreateBr(for_begin);
+  if (loop_md != nullptr) {
+    latch->setMetadata(llvm::LLVMContext::MD_loop, loop_md);
+  }
   builder_->SetInsertPoint(for_end);
 }
 
+void CodeGenLLVM::PGOCount(const std::string& key, int counter) {
+  auto it = pgo_site_index_.find(key);
+  if (it == pgo_site_index_.end()) {
+    it = pgo_site_index_.emplace(key, pgo_site_keys_.size()).first;
+    pgo_site_keys_.push_back(key);
+  }
+  if (pgo_counters_ == nullptr) {
+    pgo_counters_ = new llvm::GlobalVariable(*module_, llvm::ArrayType::get(t_int64_, 0), false,
+                                             llvm::GlobalValue::ExternalLinkage, nullptr,
+                                             "__tvm_pgo_counters_placeholder");
+  }
+  llvm::Value* counter_ptr = builder_->CreateGEP(
+      pgo_counters_, {ConstInt32(0), ConstInt32(2 * it->second + counter)});
+  // Parallel tasks count into the same counters.
+#if TVM_LLVM_VERSION >= 130
+  builder_->CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter_ptr,
+                            llvm::ConstantInt::get(t_int64_, 1), llvm::MaybeAlign(),
+                            llvm::AtomicOrdering::Monotonic);
+#else
+  builder_->CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter_ptr,
+                            llvm::ConstantInt::get(t_int64_, 1), llvm::AtomicOrdering::Monotonic);
+#endif
+}
+
+llvm::MDNode* CodeGenLLVM::PGOBranchWeights(const std::string& key, bool is_loop) {
+  int64_t first, second;
+  if (pgo_profile_ == nullptr || !pgo_profile_->Lookup(key, &first, &second) || first <= 0) {
+    return nullptr;
+  }
+  // A loop goes to its body on each iteration and leaves on each entry,
+  // a branch is taken on second of its first runs.
+  uint64_t taken = std::max<int64_t>(second, 0);
+  uint64_t not_taken = is_loop ? first : std::max<int64_t>(first - second, 0);
+  while (taken > std::numeric_limits<uint32_t>::max() ||
+         not_taken > std::numeric_limits<uint32_t>::max()) {
+    taken >>= 1;
+    not_taken >>= 1;
+  }
+  return md_builder_->createBranchWeights(static_cast<uint32_t>(taken),
+                                          static_cast<uint32_t>(not_taken));
+}
+
+void CodeGenLLVM::AddPGOCounters() {
+  if (pgo_counters_ == nullptr) return;
+  auto* counters_ty = llvm::ArrayType::get(t_int64_, 2 * pgo_site_keys_.size());
+  auto* counters = new llvm::GlobalVariable(
+      *module_, counters_ty, false, llvm::GlobalValue::ExternalLinkage,
+      llvm::ConstantAggregateZero::get(counters_ty), runtime::symbol::tvm_pgo_counters);
+#if TVM_LLVM_VERSION >= 100
+  counters->setAlignment(llvm::Align(8));
+#else
+  counters->setAlignment(8);
+#endif
+  pgo_counters_->replaceAllUsesWith(
+      llvm::ConstantExpr::getBitCast(counters, pgo_counters_->getType()));
+  pgo_counters_->eraseFromParent();
+  pgo_counters_ = nullptr;
+
+  std::string keys;
+  for (const std::string& key : pgo_site_keys_) {
+    keys += key + "\n";
+  }
+  auto* sites_value = llvm::ConstantDataArray::getString(*ctx_, keys, true);
+  auto* sites = new llvm::GlobalVariable(*module_, sites_value->getType(), true,
+                                         llvm::GlobalValue::ExternalLinkage, sites_value,
+                                         runtime::symbol::tvm_pgo_sites);
+#if TVM_LLVM_VERSION >= 100
+  sites->setAlignment(llvm::Align(1));
+#else
+  sites->setAlignment(1);
+#endif
+  counters->setDLLStorageClass(llvm::GlobalValue::DLLStorageClassTypes::DLLExportStorageClass);
+  sites->setDLLStorageClass(llvm::GlobalValue::DLLStorageClassTypes::DLLExportStorageClass);
+}
+
+llvm::MDNode* CodeGenLLVM::CreateLoopMetadata(const std::vector<llvm::Metadata*>& properties) {
+  // The first operand of a loop ID refers to itself.
+  std::vector<llvm::Metadata*> ops{nullptr};
+  ops.insert(ops.end(), properties.begin(), properties.end());
+  llvm::MDNode* loop_id = llvm::MDNode::getDistinct(*ctx_, ops);
+  loop_id->replaceOperandWith(0, loop_id);
+  return loop_id;
+}
+
+std::vector<llvm::Metadata*> CodeGenLLVM::GetLoopVectorizeProperties() {
+  return {llvm::MDNode::get(*ctx_, {llvm::MDString::get(*ctx_, "llvm.loop.vectorize.enable"),
+                                    llvm::ConstantAsMetadata::get(builder_->getTrue())})};
+}
+
 // cast operatpr
 llvm::Value* CodeGenLLVM::CreateCast(DataType from, DataType to, llvm::Value* value) {
   llvm::Type* target = DTypeToLLVMType(to);
@@ -1037,6 +1151,9 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
   llvm::Value* buffer = MakeValue(op->buffer_var);
   llvm::Value* index = MakeValue(op->index);
 
+  if (!is_one(op->predicate)) {
+    return CreatePredicatedLoad(op, buffer, index);
+  }
   if (t.lanes() == 1) {
     int alignment, native_bits;
     GetAlignment(t, op->buffer_var.get(), op->index, &alignment, &native_bits);
@@ -1147,13 +1264,17 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const BroadcastNode* op) {
 }
 
 void CodeGenLLVM::VisitStmt_(const StoreNode* op) {
-  CHECK(is_one(op->predicate));
   DataType t = op->value.dtype();
   bool is_volatile = volatile_buf_.count(op->buffer_var.get());
   llvm::Value* buffer = MakeValue(op->buffer_var);
   llvm::Value* index = MakeValue(op->index);
   llvm::Value* value = MakeValue(op->value);
 
+  if (!is_one(op->predicate)) {
+    CreatePredicatedStore(op, buffer, index, value);
+    return;
+  }
+
   if (t.lanes() == 1) {
     int alignment, native_bits;
     GetAlignment(t, op->buffer_var.get(), op->index, &alignment, &native_bits);
@@ -1204,6 +1325,125 @@ void CodeGenLLVM::VisitStmt_(const StoreNode* op) {
   this->Scalarize(op->index, f);
 }
 
+llvm::Value* CodeGenLLVM::CreatePredicatedLoad(const LoadNode* op, llvm::Value* buffer,
+                                               llvm::Value* index) {
+  DataType t = op->dtype;
+  CHECK_EQ(op->predicate.dtype().lanes(), t.lanes());
+  llvm::Value* mask = MakeValue(op->predicate);
+  // The masked off lanes read zero.
+  llvm::Value* pass_thru = llvm::Constant::getNullValue(DTypeToLLVMType(t));
+  if (t.lanes() == 1) {
+    using llvm::BasicBlock;
+    int alignment, native_bits;
+    GetAlignment(t, op->buffer_var.get(), op->index, &alignment, &native_bits);
+    BasicBlock* entry_block = builder_->GetInsertBlock();
+    BasicBlock* load_block = BasicBlock::Create(*ctx_, "pred_load", function_);
+    BasicBlock* end_block = BasicBlock::Create(*ctx_, "pred_load_end", function_);
+    builder_->CreateCondBr(mask, load_block, end_block);
+    builder_->SetInsertPoint(load_block);
+    llvm::Value* ptr = CreateBufferPtr(t, buffer, index);
+#if TVM_LLVM_VERSION >= 110
+    llvm::LoadInst* load = builder_->CreateAlignedLoad(ptr, llvm::Align(alignment));
+#else
+    llvm::LoadInst* load = builder_->CreateAlignedLoad(ptr, alignment);
+#endif
+    AddAliasInfo(load, op->buffer_var.get(), op->index);
+    builder_->CreateBr(end_block);
+    builder_->SetInsertPoint(end_block);
+    llvm::PHINode* ret = builder_->CreatePHI(load->getType(), 2);
+    ret->addIncoming(pass_thru, entry_block);
+    ret->addIncoming(load, load_block);
+    return ret;
+  }
+  if (const RampNode* ramp = op->index.as<RampNode>()) {
+    if (is_one(ramp->stride)) {
+      int alignment, native_bits;
+      GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
+      unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
+      llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, MakeValue(ramp->base));
+      ptr = builder_->CreatePointerCast(ptr, DTypeToLLVMType(t)->getPointerTo(addrspace));
+#if TVM_LLVM_VERSION >= 110
+      llvm::CallInst* load =
+          builder_->CreateMaskedLoad(ptr, llvm::Align(alignment), mask, pass_thru);
+#else
+      llvm::CallInst* load = builder_->CreateMaskedLoad(ptr, alignment, mask, pass_thru);
+#endif
+      AddAliasInfo(load, op->buffer_var.get(), op->index);
+      return load;
+    }
+  }
+  // Gather the other accesses, targets without native gathers scalarize them.
+  int basic_align = t.bits() / 8;
+  if (op->index.dtype().lanes() == 1) {
+    index = CreateBroadcast(index, t.lanes());
+  }
+  llvm::Value* ptrs = CreateBufferPtr(t.element_of(), buffer, index);
+#if TVM_LLVM_VERSION >= 110
+  llvm::CallInst* load =
+      builder_->CreateMaskedGather(ptrs, llvm::Align(basic_align), mask, pass_thru);
+#else
+  llvm::CallInst* load = builder_->CreateMaskedGather(ptrs, basic_align, mask, pass_thru);
+#endif
+  AddAliasInfo(load, op->buffer_var.get(), PrimExpr());
+  return load;
+}
+
+void CodeGenLLVM::CreatePredicatedStore(const StoreNode* op, llvm::Value* buffer,
+                                        llvm::Value* index, llvm::Value* value) {
+  DataType t = op->value.dtype();
+  CHECK_EQ(op->predicate.dtype().lanes(), t.lanes());
+  llvm::Value* mask = MakeValue(op->predicate);
+  if (t.lanes() == 1) {
+    using llvm::BasicBlock;
+    int alignment, native_bits;
+    GetAlignment(t, op->buffer_var.get(), op->index, &alignment, &native_bits);
+    BasicBlock* store_block = BasicBlock::Create(*ctx_, "pred_store", function_);
+    BasicBlock* end_block = BasicBlock::Create(*ctx_, "pred_store_end", function_);
+    builder_->CreateCondBr(mask, store_block, end_block);
+    builder_->SetInsertPoint(store_block);
+    llvm::Value* ptr = CreateBufferPtr(t, buffer, index);
+#if TVM_LLVM_VERSION >= 110
+    llvm::StoreInst* store = builder_->CreateAlignedStore(value, ptr, llvm::Align(alignment));
+#else
+    llvm::StoreInst* store = builder_->CreateAlignedStore(value, ptr, alignment);
+#endif
+    AddAliasInfo(store, op->buffer_var.get(), op->index);
+    builder_->CreateBr(end_block);
+    builder_->SetInsertPoint(end_block);
+    return;
+  }
+  if (const RampNode* ramp = op->index.as<RampNode>()) {
+    if (is_one(ramp->stride)) {
+      int alignment, native_bits;
+      GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
+      unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
+      llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, MakeValue(ramp->base));
+      ptr = builder_->CreatePointerCast(ptr, DTypeToLLVMType(t)->getPointerTo(addrspace));
+#if TVM_LLVM_VERSION >= 110
+      llvm::CallInst* store =
+          builder_->CreateMaskedStore(value, ptr, llvm::Align(alignment), mask);
+#else
+      llvm::CallInst* store = builder_->CreateMaskedStore(value, ptr, alignment, mask);
+#endif
+      AddAliasInfo(store, op->buffer_var.get(), op->index);
+      return;
+    }
+  }
+  // Scatter the other accesses, targets without native scatters scalarize them.
+  int basic_align = t.bits() / 8;
+  if (op->index.dtype().lanes() == 1) {
+    index = CreateBroadcast(index, t.lanes());
+  }
+  llvm::Value* ptrs = CreateBufferPtr(t.element_of(), buffer, index);
+#if TVM_LLVM_VERSION >= 110
+  llvm::CallInst* store =
+      builder_->CreateMaskedScatter(value, ptrs, llvm::Align(basic_align), mask);
+#else
+  llvm::CallInst* store = builder_->CreateMaskedScatter(value, ptrs, basic_align, mask);
+#endif
+  AddAliasInfo(store, op->buffer_var.get(), PrimExpr());
+}
+
 void CodeGenLLVM::VisitStmt_(const ForNode* op) {
   CHECK(is_zero(op->min));
   analyzer_->Bind(op->loop_var, Range::FromMinExtent(op->min, op->extent));
@@ -1222,18 +1462,25 @@ void CodeGenLLVM::VisitStmt_(const IfThenElseNode* op) {
   llvm::Value* cond = MakeValue(op->condition);
   BasicBlock* then_block = BasicBlock::Create(*ctx_, "if_then", function_);
   BasicBlock* end_block = BasicBlock::Create(*ctx_, "if_end", function_);
+  bool use_pgo = pgo_instrument_ || pgo_profile_ != nullptr;
+  std::string pgo_key = use_pgo ? PGOProfile::BranchKey(pgo_func_name_, op->condition) : "";
+  if (pgo_instrument_) PGOCount(pgo_key, 0);
+  llvm::MDNode* weights = PGOBranchWeights(pgo_key, false);
   if (op->else_case.defined()) {
     BasicBlock* else_block = BasicBlock::Create(*ctx_, "if_else", function_);
-    builder_->CreateCondBr(cond, then_block, else_block);
+    builder_->CreateCondBr(cond, then_block, else_block, weights);
     builder_->SetInsertPoint(then_block);
+    if (pgo_instrument_) PGOCount(pgo_key, 1);
     this->VisitStmt(op->then_case);
     builder_->CreateBr(end_block);
     builder_->SetInsertPoint(else_block);
     this->VisitStmt(op->else_case);
     builder_->CreateBr(end_block);
   } else {
-    builder_->CreateCondBr(cond, then_block, end_block, md_very_likely_branch_);
+    builder_->CreateCondBr(cond, then_block, end_block,
+                           weights != nullptr ? weights : md_very_likely_branch_);
     builder_->SetInsertPoint(then_block);
+    if (pgo_instrument_) PGOCount(pgo_key, 1);
     this->VisitStmt(op->then_case);
     builder_->CreateBr(end_block);
   }
@@ -1300,6 +1547,16 @@ void CodeGenLLVM::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* v = op->node.as<VarNode>();
     CHECK(v);
     volatile_buf_.insert(v);
+  } else if (op->attr_key == tir::attr::scalable_vectorize_scope) {
+    const ForNode* loop = op->body.as<ForNode>();
+    if (loop != nullptr && loop->for_type == ForType::Serial) {
+      CHECK(is_zero(loop->min));
+      analyzer_->Bind(loop->loop_var, Range::FromMinExtent(loop->min, loop->extent));
+      CreateSerialFor(MakeValue(loop->min), MakeValue(loop->extent),
+                      llvm::ConstantInt::getSigned(GetLLVMType(loop->extent), 1), loop->loop_var,
+                      loop->body, CreateLoopMetadata(GetLoopVectorizeProperties()));
+      return;
+    }
   }
   this->VisitStmt(op->body);
 }
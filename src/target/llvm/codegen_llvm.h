@@ -46,6 +46,7 @@
 
 #include "../../runtime/thread_storage_scope.h"
 #include "../../tir/transforms/ir_util.h"
+#include "../../tir/transforms/pgo_profile.h"
 #include "llvm_common.h"
 
 namespace tvm {
@@ -98,6 +99,15 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
    * \param mod The module to be linked.
    */
   void AddLinkModule(std::unique_ptr<llvm::Module>&& mod);
+  /*!
+   * \brief Set up the profile guided optimization of the functions added next.
+   * \param instrument Whether to count the runs of the branches and loops.
+   * \param profile The profile to weight the branches with, or nullptr.
+   */
+  void SetPGO(bool instrument, std::shared_ptr<const PGOProfile> profile) {
+    pgo_instrument_ = instrument;
+    pgo_profile_ = std::move(profile);
+  }
   /*!
    * \brief Create Value for expression e
    * \param e The expression to be created value for.
@@ -193,6 +203,8 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   virtual void Scalarize(const PrimExpr& e, std::function<void(int i, llvm::Value* v)> f);
   // Initialize target
   virtual void InitTarget(llvm::TargetMachine* tm);
+  // The loop metadata properties of a loop marked by scalable_vectorize_scope.
+  virtual std::vector<llvm::Metadata*> GetLoopVectorizeProperties();
   // Add module startup function if needed.
   virtual void AddStartupFunction() {}
   // apply optimization on the module.
@@ -267,14 +279,26 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   llvm::Value* CreateMul(DataType t, llvm::Value* a, llvm::Value* b);
   llvm::Value* CreateBroadcast(llvm::Value* value, int lanes);
   llvm::Value* CreateBufferPtr(DataType t, llvm::Value* buffer, llvm::Value* index);
+  // Memory accesses with a predicate, lowered to masked loads and stores.
+  llvm::Value* CreatePredicatedLoad(const LoadNode* op, llvm::Value* buffer, llvm::Value* index);
+  void CreatePredicatedStore(const StoreNode* op, llvm::Value* buffer, llvm::Value* index,
+                             llvm::Value* value);
   // Vector concatenation.
   llvm::Value* CreateVecSlice(llvm::Value* vec, int begin, int extent);
   llvm::Value* CreateVecFlip(llvm::Value* vec);
   llvm::Value* CreateVecConcat(std::vector<llvm::Value*> vecs);
   llvm::Value* CreateVecPad(llvm::Value* vec, int target_lanes);
-  // Create serial for
+  // Create serial for, loop_md is the loop metadata attached to its latch.
   void CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                       const Var& loop_var, const Stmt& body);
+                       const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md = nullptr);
+  // Create the distinct loop metadata with the properties.
+  llvm::MDNode* CreateLoopMetadata(const std::vector<llvm::Metadata*>& properties);
+  // Count a run of a site of the PGO instrumentation in one of its two counters.
+  void PGOCount(const std::string& key, int counter);
+  // The weights of the branch of a PGO profiled site, nullptr if it has no runs.
+  llvm::MDNode* PGOBranchWeights(const std::string& key, bool is_loop);
+  // Emit the counters and the keys of the sites of the PGO instrumentation.
+  void AddPGOCounters();
   // add alias information.
   void AddAliasInfo(llvm::Instruction* load, const VarNode* buffer, PrimExpr index);
   // The IRBuilder.
@@ -318,6 +342,19 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   std::unordered_map<std::string, llvm::Constant*> str_map_;
   // Whether current function is restricted
   bool is_restricted_{true};
+  // Whether to count the runs of the branches and loops.
+  bool pgo_instrument_{false};
+  // The PGO profile the branches are weighted with.
+  std::shared_ptr<const PGOProfile> pgo_profile_;
+  // The global symbol of the current function, which keys its PGO sites.
+  std::string pgo_func_name_;
+  // The PGO keys of the loops of the current function.
+  std::unordered_map<const VarNode*, std::string> pgo_loop_keys_;
+  // The keys of the instrumented sites, and their index in the counters.
+  std::vector<std::string> pgo_site_keys_;
+  std::unordered_map<std::string, size_t> pgo_site_index_;
+  // The counters of the instrumented sites, sized once all of them are known.
+  llvm::GlobalVariable* pgo_counters_{nullptr};
   // The analyzer information
   std::unique_ptr<arith::Analyzer> analyzer_;
   // set of var that are not restricted(can alias)
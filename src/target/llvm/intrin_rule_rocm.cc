@@ -28,6 +28,7 @@
 #include <tvm/tir/op.h>
 
 #include <sstream>
+#include <string>
 
 namespace tvm {
 namespace codegen {
@@ -92,6 +93,47 @@ inline void DispatchShuffle(const TVMArgs& targs, TVMRetValue* rv) {
   *rv = res;
 }
 
+inline void DispatchMFMA(const TVMArgs& targs, TVMRetValue* rv) {
+  PrimExpr e_call = targs[0];
+  using namespace tir;
+  const CallNode* call = e_call.as<CallNode>();
+  CHECK(call != nullptr);
+  CHECK_EQ(call->args.size(), 3);  // a, b, c
+  PrimExpr a = call->args[0];
+  PrimExpr b = call->args[1];
+  PrimExpr c = call->args[2];
+  DataType t = a.dtype();
+  CHECK(t == b.dtype()) << "mfma operands must have the same type, but get " << t << " and "
+                        << b.dtype();
+
+  std::string name;
+  if (c.dtype() == DataType::Float(32, 16)) {
+    if (t == DataType::Float(16, 4)) {
+      name = "llvm.amdgcn.mfma.f32.32x32x8f16";
+    } else if ((t.is_bfloat16() || t.is_uint()) && t.bits() == 16) {
+      // bfloat16 is stored as uint16 once legalized, both are i16 in LLVM.
+      if (t.lanes() == 2) {
+        name = "llvm.amdgcn.mfma.f32.32x32x4bf16";
+      } else if (t.lanes() == 4) {
+        // gfx90a and later
+        name = "llvm.amdgcn.mfma.f32.32x32x8bf16.1k";
+      }
+    }
+  } else if (c.dtype() == DataType::Int(32, 16) && t == DataType::Int(8, 4)) {
+    // The int8 operands are passed packed in an i32.
+    name = "llvm.amdgcn.mfma.i32.32x32x8i8";
+    a = reinterpret(DataType::Int(32), a);
+    b = reinterpret(DataType::Int(32), b);
+  }
+  CHECK(!name.empty()) << "No mfma instruction for " << t << " operands accumulated in "
+                       << c.dtype();
+
+  // cbsz, abid and blgp, no broadcast of the operands between the blocks or lanes.
+  PrimExpr zero = tir::make_zero(DataType::Int(32));
+  *rv = Call(call->dtype, builtin::call_pure_extern(),
+             {StringImm(name), a, b, c, zero, zero, zero});
+}
+
 namespace llvm {
 
 // dummy because we don't have the activemask
@@ -107,6 +149,8 @@ TVM_REGISTER_GLOBAL("tvm.intrin.rule.rocm.tvm_warp_shuffle_up").set_body(Dispatc
 
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.rocm.tvm_warp_shuffle_down").set_body(DispatchShuffle);
 
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.rocm.mfma").set_body(DispatchMFMA);
+
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.rocm.floor").set_body(DispatchPureExternOCML);
 
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.rocm.ceil").set_body(DispatchPureExternOCML);
@@ -24,11 +24,17 @@
 #ifdef TVM_LLVM_VERSION
 
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/target/codegen.h>
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "../../runtime/file_util.h"
 #include "../../runtime/library_module.h"
@@ -36,6 +42,12 @@
 #include "codegen_llvm.h"
 #include "llvm_common.h"
 
+#if TVM_LLVM_VERSION >= 130
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#endif
+
 namespace tvm {
 namespace codegen {
 
@@ -43,9 +55,134 @@ using runtime::PackedFunc;
 using runtime::TVMArgs;
 using runtime::TVMRetValue;
 
+// The number of LLVM modules the functions are split into, each generated,
+// optimized and emitted to object code on its own thread.
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.num_threads", Integer);
+// Whether to count the runs of the branches and loops of the CPU functions,
+// see tir/transforms/pgo_profile.h.
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.pgo_instrument", Bool);
+
+#if TVM_LLVM_VERSION >= 130
+/*!
+ * \brief The ORC JITs shared by the LLVM modules, one per target.
+ *
+ *  Each module is added to its own JITDylib of the JIT of its target and
+ *  removed when the module is destroyed, so no engine is created per module.
+ *  The functions are only compiled when they are first called, possibly on
+ *  several threads at once.
+ */
+class OrcJITPool {
+ public:
+  static OrcJITPool* Global() {
+    static OrcJITPool* inst = new OrcJITPool();
+    return inst;
+  }
+
+  /*!
+   * \brief Add a module to a new JITDylib of the JIT of the target.
+   * \param target The target string of the module.
+   * \param module The module, moved to a context owned by the JIT.
+   * \param pjit The JIT the module is added to.
+   * \return The JITDylib of the module.
+   */
+  llvm::orc::JITDylib* Add(const std::string& target, const llvm::Module& module,
+                           llvm::orc::LLLazyJIT** pjit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    llvm::orc::LLLazyJIT* jit = GetJIT(target);
+    CHECK(jit->getDataLayout() == module.getDataLayout())
+        << "Data layout mismatch between module("
+        << module.getDataLayout().getStringRepresentation() << ")"
+        << " and ORC JIT (" << jit->getDataLayout().getStringRepresentation() << ")";
+    std::string name = "tvm_module_" + std::to_string(counter_++);
+    llvm::orc::JITDylib& dylib = Check(jit->createJITDylib(name));
+    dylib.addGenerator(Check(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        jit->getDataLayout().getGlobalPrefix())));
+    // The JIT owns the module and its context, so hand it a copy.
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(module, os);
+    auto ctx = std::make_unique<llvm::LLVMContext>();
+    std::unique_ptr<llvm::Module> copy = Check(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), name), *ctx));
+    llvm::orc::ThreadSafeModule tsm(std::move(copy), std::move(ctx));
+    llvm::Error err = jit->addLazyIRModule(dylib, std::move(tsm));
+    CHECK(!err) << llvm::toString(std::move(err));
+    *pjit = jit;
+    return &dylib;
+  }
+
+  /*!
+   * \brief Remove a module added by Add, with its JITDylib and the one the lazy
+   *  compilation emits its code to, so that their code and symbols are released.
+   * \param jit The JIT the module was added to.
+   * \param dylib The JITDylib of the module.
+   */
+  void Remove(llvm::orc::LLLazyJIT* jit, llvm::orc::JITDylib* dylib) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    llvm::orc::ExecutionSession& session = jit->getExecutionSession();
+    // The compile on demand layer emits the functions to "<name>.impl".
+    std::string impl_name = dylib->getName() + ".impl";
+    llvm::Error err = session.removeJITDylib(*dylib);
+    if (llvm::orc::JITDylib* impl = session.getJITDylibByName(impl_name)) {
+      err = llvm::joinErrors(std::move(err), session.removeJITDylib(*impl));
+    }
+    if (err) LOG(WARNING) << "Failed to remove module from the ORC JIT: "
+                          << llvm::toString(std::move(err));
+  }
+
+  template <typename T>
+  static T Check(llvm::Expected<T> value) {
+    if (!value) {
+      LOG(FATAL) << "ORC JIT error: " << llvm::toString(value.takeError());
+    }
+    return std::move(*value);
+  }
+
+  template <typename T>
+  static T& Check(llvm::Expected<T&> value) {
+    if (!value) {
+      LOG(FATAL) << "ORC JIT error: " << llvm::toString(value.takeError());
+    }
+    return *value;
+  }
+
+ private:
+  llvm::orc::LLLazyJIT* GetJIT(const std::string& target) {
+    auto it = jits_.find(target);
+    if (it != jits_.end()) return it->second.get();
+    std::string triple, mcpu, mattr;
+    llvm::TargetOptions opt;
+    ParseLLVMTargetOptions(target, &triple, &mcpu, &mattr, &opt);
+    llvm::orc::JITTargetMachineBuilder jtmb{llvm::Triple(triple)};
+    jtmb.setCPU(mcpu);
+    if (mattr.length() != 0) {
+      jtmb.addFeatures(std::vector<std::string>{mattr});
+    }
+    jtmb.setOptions(opt);
+    jtmb.setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+    auto jit = Check(llvm::orc::LLLazyJITBuilder()
+                         .setJITTargetMachineBuilder(std::move(jtmb))
+                         .setNumCompileThreads(std::thread::hardware_concurrency())
+                         .create());
+    llvm::orc::LLLazyJIT* ptr = jit.get();
+    jits_[target] = std::move(jit);
+    return ptr;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<llvm::orc::LLLazyJIT>> jits_;
+  int64_t counter_{0};
+};
+#endif
+
 class LLVMModuleNode final : public runtime::ModuleNode {
  public:
   ~LLVMModuleNode() {
+#if TVM_LLVM_VERSION >= 130
+    if (orc_dylib_ != nullptr) {
+      OrcJITPool::Global()->Remove(orc_jit_, orc_dylib_);
+    }
+#endif
     module_.reset();
     if (ee_ != nullptr) {
       ee_->runStaticConstructorsDestructors(true);
@@ -67,11 +204,24 @@ class LLVMModuleNode final : public runtime::ModuleNode {
         target_triple += " -mfloat-abi=soft";
       }
       return PackedFunc([target_triple](TVMArgs args, TVMRetValue* rv) { *rv = target_triple; });
+    } else if (name == "_save_object_parts") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = SaveObjectParts(args[0]);
+      });
     }
-    if (ee_ == nullptr) LazyInitJIT();
+    if (!jit_ready_) LazyInitJIT();
 
     std::lock_guard<std::mutex> lock(mutex_);
 
+    if (name == "__tvm_pgo_profile") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        *rv = runtime::GetPGOProfile(
+            [this](const char* sym) { return reinterpret_cast<void*>(GetGlobalAddr(sym)); },
+            args.size() != 0 && args[0].operator bool());
+      });
+    }
+
     TVMBackendPackedCFunc faddr;
     if (name == runtime::symbol::tvm_module_main) {
       const char* entry_name =
@@ -80,7 +230,11 @@ class LLVMModuleNode final : public runtime::ModuleNode {
           << "Symbol " << runtime::symbol::tvm_module_main << " is not presented";
       faddr = reinterpret_cast<TVMBackendPackedCFunc>(GetFunctionAddr(entry_name));
     } else {
-      faddr = reinterpret_cast<TVMBackendPackedCFunc>(GetFunctionAddr(name));
+      std::string func_name = runtime::SelectISAVariant(name, [this](const char* sym) {
+        uint64_t addr = GetGlobalAddr(sym);
+        return reinterpret_cast<void*>(addr != 0 ? addr : GetFunctionAddr(sym));
+      });
+      faddr = reinterpret_cast<TVMBackendPackedCFunc>(GetFunctionAddr(func_name));
     }
     if (faddr == nullptr) return PackedFunc();
     return WrapPackedFunc(faddr, sptr_to_self);
@@ -211,19 +365,48 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       funcs.push_back(f);
     }
     CHECK_NE(funcs.size(), 0U);
-    // TODO(tqchen): remove the entry function behavior as it does not
-    // makes sense when we start to use multiple modules.
-    cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
-
-    for (const auto& f : funcs) {
-      cg->AddFunction(f);
+    transform::PassContext pass_ctx = transform::PassContext::Current();
+    Integer num_threads =
+        pass_ctx->GetConfig<Integer>("codegen.llvm.num_threads", Integer(1)).value();
+    int num_parts = std::min(static_cast<int>(num_threads->value), static_cast<int>(funcs.size()));
+    Array<String> isa_variants =
+        target->GetAttr<Array<String>>("isa-variants").value_or(Array<String>());
+    if (isa_variants.size() != 0) {
+      CHECK(!system_lib && !target_c_runtime)
+          << "ISA variants are not supported by the system library or the C runtime";
+      num_parts = 1;
     }
-
-    if (entry_func.length() != 0) {
-      cg->AddMainFunction(entry_func);
+    bool pgo_instrument =
+        pass_ctx->GetConfig<Bool>("codegen.llvm.pgo_instrument", Bool(false)).value();
+    std::shared_ptr<const PGOProfile> pgo_profile = PGOProfile::FromContext(pass_ctx);
+    if (pgo_instrument) {
+      // The counters of a module are one array, which its variants would not count into.
+      CHECK(isa_variants.size() == 0) << "PGO instrumentation does not support ISA variants";
+      num_parts = 1;
     }
+    // The startup function of a system library registers all the functions
+    // of the module, so it is built in one piece.
+    if (num_parts > 1 && !system_lib && !target_c_runtime) {
+      module_ = BuildParts(funcs, entry_func, target_str, num_parts, pgo_profile);
+    } else {
+      // TODO(tqchen): remove the entry function behavior as it does not
+      // makes sense when we start to use multiple modules.
+      cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
+      cg->SetPGO(pgo_instrument, pgo_profile);
 
-    module_ = cg->Finish();
+      for (const auto& f : funcs) {
+        cg->AddFunction(f);
+      }
+
+      if (entry_func.length() != 0) {
+        cg->AddMainFunction(entry_func);
+      }
+
+      module_ = cg->Finish();
+      if (isa_variants.size() != 0) {
+        AddISAVariants(funcs, target_str, isa_variants);
+      }
+    }
     module_->addModuleFlag(llvm::Module::Warning, "tvm_target",
                            llvm::MDString::get(*ctx_, target_str));
     module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
@@ -279,10 +462,205 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   }
 
  private:
+  /*!
+   * \brief Add a variant of each function for each ISA level to module_.
+   *
+   *  The variant for an ISA is optimized and emitted with its features, and named
+   *  name + "__" + ISA. The levels are listed in runtime::symbol::tvm_isa_variants,
+   *  the runtime calls the best variant the CPU supports.
+   */
+  void AddISAVariants(const std::vector<PrimFunc>& funcs, const std::string& target_str,
+                      const Array<String>& isa_variants) {
+    llvm::Triple::ArchType arch = tm_->getTargetTriple().getArch();
+    CHECK(arch == llvm::Triple::x86 || arch == llvm::Triple::x86_64)
+        << "ISA variants are only supported on x86, not " << tm_->getTargetTriple().str();
+    std::string triple, mcpu, mattr;
+    llvm::TargetOptions opt;
+    ParseLLVMTargetOptions(target_str, &triple, &mcpu, &mattr, &opt);
+    std::string isa_list;
+    for (const String& isa : isa_variants) {
+      std::string features;
+      if (isa == "avx2") {
+        features = "+avx2,+fma";
+      } else if (isa == "avx512") {
+        features = "+avx512f,+avx512cd,+avx512bw,+avx512dq,+avx512vl,+avx2,+fma";
+      } else {
+        LOG(FATAL) << "Unknown ISA variant " << isa << ", expect avx2 or avx512";
+      }
+      if (mattr.length() != 0) {
+        features = mattr + "," + features;
+      }
+      std::unique_ptr<llvm::TargetMachine> tm =
+          GetLLVMTargetMachine(target_str + " -mattr=" + features);
+      std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm.get());
+      cg->Init("TVMMod", tm.get(), ctx_.get(), false, false, false);
+      for (const PrimFunc& f : funcs) {
+        String global_symbol = f->GetAttr<String>(tvm::attr::kGlobalSymbol).value();
+        cg->AddFunction(WithAttr(f, tvm::attr::kGlobalSymbol,
+                                 String(std::string(global_symbol) + "__" + std::string(isa))));
+      }
+      std::unique_ptr<llvm::Module> module = cg->Finish();
+      // the object code is emitted by tm_, which takes the features from the functions.
+      for (llvm::Function& f : *module) {
+        if (f.isDeclaration()) continue;
+        f.addFnAttr("target-cpu", tm->getTargetCPU());
+        f.addFnAttr("target-features", tm->getTargetFeatureString());
+      }
+      CHECK(!llvm::Linker::linkModules(*module_, std::move(module)))
+          << "Failed to link the LLVM module of the " << isa << " variants";
+      if (isa_list.length() != 0) isa_list += ",";
+      isa_list += isa;
+    }
+    llvm::Type* type = llvm::ArrayType::get(llvm::Type::getInt8Ty(*ctx_), isa_list.length() + 1);
+    llvm::GlobalVariable* global =
+        new llvm::GlobalVariable(*module_, type, true, llvm::GlobalValue::WeakAnyLinkage, 0,
+                                 runtime::symbol::tvm_isa_variants);
+#if TVM_LLVM_VERSION >= 100
+    global->setAlignment(llvm::Align(1));
+#else
+    global->setAlignment(1);
+#endif
+    global->setInitializer(llvm::ConstantDataArray::getString(*ctx_, isa_list));
+  }
+
+  /*!
+   * \brief Generate and optimize the functions in num_parts modules concurrently.
+   *
+   *  Each part has its own context and target machine. The optimized parts are
+   *  kept as bitcode for SaveObjectParts, and are linked into one module in ctx_
+   *  for the JIT and the other formats.
+   */
+  std::unique_ptr<llvm::Module> BuildParts(const std::vector<PrimFunc>& funcs,
+                                           const std::string& entry_func,
+                                           const std::string& target_str, int num_parts,
+                                           std::shared_ptr<const PGOProfile> pgo_profile) {
+    parts_.assign(num_parts, std::string());
+    support::parallel_for(
+        0, num_parts,
+        [&](int part) {
+          llvm::LLVMContext ctx;
+          std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target_str);
+          std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm.get());
+          cg->Init("TVMMod", tm.get(), &ctx, false, false, false);
+          cg->SetPGO(false, pgo_profile);
+          for (size_t i = part; i < funcs.size(); i += num_parts) {
+            cg->AddFunction(funcs[i]);
+          }
+          if (part == 0 && entry_func.length() != 0) {
+            cg->AddMainFunction(entry_func);
+          }
+          std::unique_ptr<llvm::Module> module = cg->Finish();
+          llvm::raw_string_ostream os(parts_[part]);
+#if TVM_LLVM_VERSION <= 60
+          llvm::WriteBitcodeToFile(module.get(), os);
+#else
+          llvm::WriteBitcodeToFile(*module, os);
+#endif
+          os.flush();
+        },
+        1, Partitioner(num_parts));
+
+    std::unique_ptr<llvm::Module> module;
+    for (const std::string& part : parts_) {
+      std::unique_ptr<llvm::Module> m = ParsePart(part, ctx_.get());
+      if (module == nullptr) {
+        module = std::move(m);
+      } else {
+        CHECK(!llvm::Linker::linkModules(*module, std::move(m)))
+            << "Failed to link the LLVM modules of the functions";
+      }
+    }
+    return module;
+  }
+
+  /*!
+   * \brief Emit each part to an object file named prefix + index + ".o", concurrently.
+   *  A module that is not split is saved to one object file.
+   * \param prefix The prefix of the object files.
+   * \return The object files.
+   */
+  Array<runtime::String> SaveObjectParts(const std::string& prefix) {
+    if (parts_.empty()) {
+      SaveToFile(prefix + ".o", "o");
+      return {prefix + ".o"};
+    }
+    Array<runtime::String> files;
+    for (size_t i = 0; i < parts_.size(); ++i) {
+      files.push_back(prefix + "_" + std::to_string(i) + ".o");
+    }
+    std::string target = target_;
+    support::parallel_for(
+        0, static_cast<int>(parts_.size()),
+        [&](int part) {
+          llvm::LLVMContext ctx;
+          std::unique_ptr<llvm::Module> m = ParsePart(parts_[part], &ctx);
+          std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
+          std::error_code ecode;
+          std::string file_name = files[part];
+          llvm::raw_fd_ostream dest(file_name, ecode, llvm::sys::fs::F_None);
+          CHECK_EQ(ecode.value(), 0) << "Cannot open file: " << file_name << " " << ecode.message();
+          llvm::legacy::PassManager pass;
+#if TVM_LLVM_VERSION <= 60
+          CHECK(tm->addPassesToEmitFile(pass, dest, llvm::TargetMachine::CGFT_ObjectFile) == 0)
+              << "Cannot emit target CGFT_ObjectFile";
+#elif TVM_LLVM_VERSION <= 90
+          CHECK(tm->addPassesToEmitFile(pass, dest, nullptr,
+                                        llvm::TargetMachine::CGFT_ObjectFile) == 0)
+              << "Cannot emit target CGFT_ObjectFile";
+#else
+          CHECK(tm->addPassesToEmitFile(pass, dest, nullptr, llvm::CGFT_ObjectFile) == 0)
+              << "Cannot emit target CGFT_ObjectFile";
+#endif
+          pass.run(*m);
+          dest.close();
+        },
+        1, Partitioner(static_cast<int>(parts_.size())));
+    return files;
+  }
+
+  // Parse the bitcode of a part into ctx.
+  static std::unique_ptr<llvm::Module> ParsePart(const std::string& bitcode,
+                                                 llvm::LLVMContext* ctx) {
+    std::unique_ptr<llvm::MemoryBuffer> buffer =
+        llvm::MemoryBuffer::getMemBuffer(bitcode, "TVMMod", false);
+    auto module = llvm::parseBitcodeFile(buffer->getMemBufferRef(), *ctx);
+    if (!module) {
+      LOG(FATAL) << "Fail to load the LLVM module of the functions: "
+                 << llvm::toString(module.takeError());
+    }
+    return std::move(module.get());
+  }
+
+  // Run each of the num_parts tasks on its own thread.
+  static support::PartitionerFuncType Partitioner(int num_parts) {
+    return [num_parts](int begin, int end, int step, int) {
+      return support::rr_partitioner(begin, end, step, num_parts);
+    };
+  }
+
   void LazyInitJIT() {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (ee_) {
+    if (jit_ready_) {
+      return;
+    }
+    String jit = Target::Create(target_)->GetAttr<String>("jit").value_or("mcjit");
+    CHECK(jit == "mcjit" || jit == "orc") << "Unknown LLVM JIT " << jit;
+    // The startup function of a system library is a static constructor, run by MCJIT.
+    if (jit == "orc" && mptr_->getFunction("__tvm_module_startup") == nullptr) {
+#if TVM_LLVM_VERSION >= 130
+      std::unique_ptr<llvm::TargetMachine> tm_sys = GetLLVMTargetMachine("llvm");
+      if (tm_sys->getTargetTriple().getArch() != tm_->getTargetTriple().getArch()) {
+        LOG(FATAL) << "Cannot run module, architecture mismatch "
+                   << " module=" << tm_->getTargetTriple().str()
+                   << " system=" << tm_sys->getTargetTriple().str();
+      }
+      // The module is kept to look up which symbols exist, a copy is compiled.
+      orc_dylib_ = OrcJITPool::Global()->Add(target_, *mptr_, &orc_jit_);
+      InitJITContext();
       return;
+#else
+      LOG(WARNING) << "The ORC JIT requires LLVM 13 or later, fall back to MCJIT";
+#endif
     }
     llvm::EngineBuilder builder(std::move(module_));
     std::string triple, mcpu, mattr;
@@ -313,7 +691,11 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     ee_ = builder.create(tm.release());
     CHECK(ee_ != nullptr) << "Failed to initialize jit engine for " << mptr_->getTargetTriple();
     ee_->runStaticConstructorsDestructors(false);
-
+    InitJITContext();
+  }
+  // Set the module context and the runtime functions used by the generated code.
+  void InitJITContext() {
+    jit_ready_ = true;
     if (void** ctx_addr =
             reinterpret_cast<void**>(GetGlobalAddr(runtime::symbol::tvm_module_ctx))) {
       *ctx_addr = this;
@@ -325,7 +707,7 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   uint64_t GetGlobalAddr(const std::string& name) const {
     // first verifies if GV exists.
     if (mptr_->getGlobalVariable(name) != nullptr) {
-      return ee_->getGlobalValueAddress(name);
+      return LookupJIT(name, false);
     } else {
       return 0;
     }
@@ -333,18 +715,39 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   uint64_t GetFunctionAddr(const std::string& name) const {
     // first verifies if GV exists.
     if (mptr_->getFunction(name) != nullptr) {
-      return ee_->getFunctionAddress(name);
+      return LookupJIT(name, true);
     } else {
       return 0;
     }
   }
+  uint64_t LookupJIT(const std::string& name, bool is_function) const {
+#if TVM_LLVM_VERSION >= 130
+    if (orc_dylib_ != nullptr) {
+      // a function is compiled the first time it is called through the address.
+      auto symbol = OrcJITPool::Check(orc_jit_->lookup(*orc_dylib_, name));
+#if TVM_LLVM_VERSION >= 150
+      return symbol.getValue();
+#else
+      return symbol.getAddress();
+#endif
+    }
+#endif
+    return is_function ? ee_->getFunctionAddress(name) : ee_->getGlobalValueAddress(name);
+  }
 
   // The target configuration string
   std::string target_;
   // JIT lock
   std::mutex mutex_;
+  // whether the JIT is initialized
+  bool jit_ready_{false};
   // execution engine
   llvm::ExecutionEngine* ee_{nullptr};
+#if TVM_LLVM_VERSION >= 130
+  // the ORC JIT and the JITDylib of the module when the ORC JIT is used
+  llvm::orc::LLLazyJIT* orc_jit_{nullptr};
+  llvm::orc::JITDylib* orc_dylib_{nullptr};
+#endif
   // The raw pointer to the module.
   llvm::Module* mptr_{nullptr};
   // The target machine
@@ -353,6 +756,8 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   std::unique_ptr<llvm::Module> module_;
   // the context.
   std::shared_ptr<llvm::LLVMContext> ctx_;
+  // The optimized bitcode of each part when the functions are split.
+  std::vector<std::string> parts_;
 };
 
 unsigned LookupLLVMIntrinsic(const std::string& name) {
@@ -409,7 +814,7 @@ TVM_REGISTER_GLOBAL("codegen.llvm_target_enabled").set_body([](TVMArgs args, TVM
 TVM_REGISTER_GLOBAL("codegen.codegen_blob").set_body([](TVMArgs args, TVMRetValue* rv) {
   auto n = make_object<LLVMModuleNode>();
   auto p = CodeGenBlob(args[0].operator std::string(), args[1].operator bool(),
-                       args[2].operator std::string());
+                       args[2].operator std::string(), args[3].operator std::string());
   n->Init(std::move(p.first), p.second);
   *rv = runtime::Module(n);
 });
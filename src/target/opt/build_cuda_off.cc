@@ -30,5 +30,13 @@ Module CUDAModuleCreate(std::string data, std::string fmt,
   LOG(FATAL) << "CUDA is not enabled";
   return Module();
 }
+
+Module CUDAModuleCreate(std::vector<std::string> units,
+                        std::unordered_map<std::string, uint32_t> func_unit, std::string fmt,
+                        std::unordered_map<std::string, FunctionInfo> fmap,
+                        std::string cuda_source) {
+  LOG(FATAL) << "CUDA is not enabled";
+  return Module();
+}
 }  // namespace runtime
 }  // namespace tvm
@@ -28,8 +28,14 @@
 #endif
 #include <cuda_runtime.h>
 #include <nvrtc.h>
+#include <tvm/ir/transform.h>
+#include <tvm/support/parallel_for.h>
 
 #include <cstdlib>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../../runtime/cuda/cuda_common.h"
 #include "../../runtime/cuda/cuda_module.h"
@@ -39,6 +45,9 @@
 namespace tvm {
 namespace codegen {
 
+// Emit each kernel as its own PTX/cubin, so that the runtime only loads the kernels it launches.
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.cuda.split_kernels", Bool);
+
 #define NVRTC_CALL(x)                                                                        \
   {                                                                                          \
     nvrtcResult result = x;                                                                  \
@@ -121,18 +130,88 @@ std::string NVRTCCompile(const std::string& code, bool include_path = false) {
   return ptx;
 }
 
-runtime::Module BuildCUDA(IRModule mod, std::string target) {
+// Compile the generated code of a single unit, returns the image and sets its format.
+std::string CompileCUDA(const std::string& code, bool include_path, std::string* fmt) {
   using tvm::runtime::Registry;
-  bool output_ssa = false;
-  CodeGenCUDA cg;
-  cg.Init(output_ssa);
+  *fmt = "ptx";
+  std::string ptx;
+  if (const auto* f = Registry::Get("tvm_callback_cuda_compile")) {
+    ptx = (*f)(code).operator std::string();
+    // Dirty matching to check PTX vs cubin.
+    // TODO(tqchen) more reliable checks
+    if (ptx[0] != '/') *fmt = "cubin";
+  } else {
+    ptx = NVRTCCompile(code, include_path);
+  }
+  return ptx;
+}
+
+// Build every kernel into its own image, NVRTC compiles the images in parallel.
+runtime::Module BuildCUDASplit(IRModule mod, const std::vector<PrimFunc>& funcs) {
+  using tvm::runtime::Registry;
+  size_t num_units = funcs.size();
+  std::vector<std::string> codes(num_units);
+  std::vector<bool> include_path(num_units);
+  std::unordered_map<std::string, uint32_t> func_unit;
+  for (size_t i = 0; i < num_units; ++i) {
+    CodeGenCUDA cg;
+    cg.Init(false);
+    cg.AddFunction(funcs[i]);
+    codes[i] = cg.Finish();
+    include_path[i] = cg.need_include_path();
+    if (const auto* f = Registry::Get("tvm_callback_cuda_postproc")) {
+      codes[i] = (*f)(codes[i]).operator std::string();
+    }
+    auto global_symbol = funcs[i]->GetAttr<String>(tvm::attr::kGlobalSymbol);
+    func_unit[static_cast<std::string>(global_symbol.value())] = static_cast<uint32_t>(i);
+  }
+
+  std::vector<std::string> units(num_units);
+  std::vector<std::string> fmts(num_units);
+  if (Registry::Get("tvm_callback_cuda_compile") != nullptr) {
+    // the callback goes through the frontend, compile one unit at a time
+    for (size_t i = 0; i < num_units; ++i) {
+      units[i] = CompileCUDA(codes[i], include_path[i], &fmts[i]);
+    }
+  } else {
+    support::parallel_for(0, static_cast<int>(num_units), [&](int i) {
+      units[i] = CompileCUDA(codes[i], include_path[i], &fmts[i]);
+    });
+  }
+  for (size_t i = 1; i < num_units; ++i) {
+    CHECK_EQ(fmts[i], fmts[0]) << "CodeGenCUDA: kernels compiled into different formats";
+  }
 
+  std::ostringstream code;
+  for (const std::string& unit_code : codes) {
+    code << unit_code << "\n";
+  }
+  return CUDAModuleCreate(units, func_unit, fmts[0], ExtractFuncInfo(mod), code.str());
+}
+
+runtime::Module BuildCUDA(IRModule mod, std::string target) {
+  using tvm::runtime::Registry;
+  std::vector<PrimFunc> funcs;
   for (auto kv : mod->functions) {
     CHECK(kv.second->IsInstance<PrimFuncNode>()) << "CodeGenCUDA: Can only take PrimFunc";
     auto f = Downcast<PrimFunc>(kv.second);
     auto calling_conv = f->GetAttr<Integer>(tvm::attr::kCallingConv);
     CHECK(calling_conv == CallingConv::kDeviceKernelLaunch)
         << "CodeGenCUDA: expect calling_conv equals CallingConv::kDeviceKernelLaunch";
+    funcs.push_back(f);
+  }
+
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  bool split_kernels =
+      pass_ctx->GetConfig<Bool>("codegen.cuda.split_kernels", Bool(false)).value();
+  if (split_kernels && funcs.size() > 1) {
+    return BuildCUDASplit(mod, funcs);
+  }
+
+  bool output_ssa = false;
+  CodeGenCUDA cg;
+  cg.Init(output_ssa);
+  for (const PrimFunc& f : funcs) {
     cg.AddFunction(f);
   }
 
@@ -141,16 +220,8 @@ runtime::Module BuildCUDA(IRModule mod, std::string target) {
   if (const auto* f = Registry::Get("tvm_callback_cuda_postproc")) {
     code = (*f)(code).operator std::string();
   }
-  std::string fmt = "ptx";
-  std::string ptx;
-  if (const auto* f = Registry::Get("tvm_callback_cuda_compile")) {
-    ptx = (*f)(code).operator std::string();
-    // Dirty matching to check PTX vs cubin.
-    // TODO(tqchen) more reliable checks
-    if (ptx[0] != '/') fmt = "cubin";
-  } else {
-    ptx = NVRTCCompile(code, cg.need_include_path());
-  }
+  std::string fmt;
+  std::string ptx = CompileCUDA(code, cg.need_include_path(), &fmt);
   return CUDAModuleCreate(ptx, fmt, ExtractFuncInfo(mod), code);
 }
 
@@ -89,24 +89,7 @@ void CodeGenC::AddFunction(const PrimFunc& f) {
     std::string vid = AllocVarID(v.get());
     if (i != 0) stream << ", ";
     if (v.dtype().is_handle()) {
-      auto it = alloc_storage_scope_.find(v.get());
-      if (it != alloc_storage_scope_.end()) {
-        PrintStorageScope(it->second, stream);
-      }
-
-      PrintType(GetType(v), stream);
-      // Register handle data type
-      // TODO(tvm-team): consider simply keep type info in the
-      // type annotation(via a normalizing rewriting).
-      if (auto* ptr = v->type_annotation.as<PointerTypeNode>()) {
-        if (auto* prim = ptr->element_type.as<PrimTypeNode>()) {
-          RegisterHandleType(v.get(), prim->dtype);
-        }
-      }
-
-      if (no_alias && restrict_keyword_.length() != 0) {
-        stream << ' ' << restrict_keyword_;
-      }
+      PrintHandleParamType(v, no_alias, stream);
     } else {
       PrintType(GetType(v), stream);
     }
@@ -122,6 +105,27 @@ void CodeGenC::AddFunction(const PrimFunc& f) {
   this->stream << "}\n\n";
 }
 
+void CodeGenC::PrintHandleParamType(const Var& v, bool no_alias, std::ostream& os) {  // NOLINT(*)
+  auto it = alloc_storage_scope_.find(v.get());
+  if (it != alloc_storage_scope_.end()) {
+    PrintStorageScope(it->second, os);
+  }
+
+  PrintType(GetType(v), os);
+  // Register handle data type
+  // TODO(tvm-team): consider simply keep type info in the
+  // type annotation(via a normalizing rewriting).
+  if (auto* ptr = v->type_annotation.as<PointerTypeNode>()) {
+    if (auto* prim = ptr->element_type.as<PrimTypeNode>()) {
+      RegisterHandleType(v.get(), prim->dtype);
+    }
+  }
+
+  if (no_alias && restrict_keyword_.length() != 0) {
+    os << ' ' << restrict_keyword_;
+  }
+}
+
 void CodeGenC::PrintFuncPrefix() { stream << "void"; }
 
 void CodeGenC::PrintFinalReturn() {}
@@ -671,6 +675,58 @@ void CodeGenC::PrintVecBinaryOp(const std::string& op, DataType t, PrimExpr lhs,
   }
 }
 
+PrimExpr ExtractLane(const PrimExpr& e, int lane) {
+  if (e.dtype().lanes() == 1) return e;
+  if (const auto* op = e.as<BroadcastNode>()) return op->value;
+  if (const auto* op = e.as<RampNode>()) {
+    return op->base + op->stride * make_const(op->stride.dtype(), lane);
+  }
+  if (const auto* op = e.as<NotNode>()) return Not(ExtractLane(op->a, lane));
+  if (const auto* op = e.as<CastNode>()) {
+    return Cast(op->dtype.element_of(), ExtractLane(op->value, lane));
+  }
+  if (const auto* op = e.as<SelectNode>()) {
+    return Select(ExtractLane(op->condition, lane), ExtractLane(op->true_value, lane),
+                  ExtractLane(op->false_value, lane));
+  }
+  if (const auto* op = e.as<LoadNode>()) {
+    return Load(op->dtype.element_of(), op->buffer_var, ExtractLane(op->index, lane),
+                ExtractLane(op->predicate, lane));
+  }
+  if (const auto* op = e.as<CallNode>()) {
+    // Vectorized calls, such as likely, apply lane by lane.
+    Array<PrimExpr> args;
+    for (const PrimExpr& arg : op->args) {
+      args.push_back(ExtractLane(arg, lane));
+    }
+    return Call(op->dtype.element_of(), op->op, args);
+  }
+#define TVM_EXTRACT_LANE_BINARY(Node, Make)                           \
+  if (const auto* op = e.as<Node>()) {                               \
+    return Make(ExtractLane(op->a, lane), ExtractLane(op->b, lane)); \
+  }
+  TVM_EXTRACT_LANE_BINARY(AddNode, Add)
+  TVM_EXTRACT_LANE_BINARY(SubNode, Sub)
+  TVM_EXTRACT_LANE_BINARY(MulNode, Mul)
+  TVM_EXTRACT_LANE_BINARY(DivNode, Div)
+  TVM_EXTRACT_LANE_BINARY(ModNode, Mod)
+  TVM_EXTRACT_LANE_BINARY(FloorDivNode, FloorDiv)
+  TVM_EXTRACT_LANE_BINARY(FloorModNode, FloorMod)
+  TVM_EXTRACT_LANE_BINARY(MinNode, Min)
+  TVM_EXTRACT_LANE_BINARY(MaxNode, Max)
+  TVM_EXTRACT_LANE_BINARY(EQNode, EQ)
+  TVM_EXTRACT_LANE_BINARY(NENode, NE)
+  TVM_EXTRACT_LANE_BINARY(LTNode, LT)
+  TVM_EXTRACT_LANE_BINARY(LENode, LE)
+  TVM_EXTRACT_LANE_BINARY(GTNode, GT)
+  TVM_EXTRACT_LANE_BINARY(GENode, GE)
+  TVM_EXTRACT_LANE_BINARY(AndNode, And)
+  TVM_EXTRACT_LANE_BINARY(OrNode, Or)
+#undef TVM_EXTRACT_LANE_BINARY
+  LOG(FATAL) << "Cannot extract lane " << lane << " of predicate " << e;
+  return PrimExpr();
+}
+
 void CodeGenC::VisitExpr_(const LoadNode* op, std::ostream& os) {  // NOLINT(*)
   int lanes = op->dtype.lanes();
   // delcare type.
@@ -678,10 +734,8 @@ void CodeGenC::VisitExpr_(const LoadNode* op, std::ostream& os) {  // NOLINT(*)
     std::string ref = GetBufferRef(op->dtype, op->buffer_var.get(), op->index);
     HandleVolatileLoads(ref, op, os);
   } else {
-    CHECK(is_one(op->predicate)) << "predicated load is not supported";
-
     arith::PVar<PrimExpr> base;
-    if (arith::ramp(base, 1, op->dtype.lanes()).Match(op->index)) {
+    if (is_one(op->predicate) && arith::ramp(base, 1, op->dtype.lanes()).Match(op->index)) {
       std::string ref = GetVecLoad(op->dtype, op->buffer_var.get(), base.Eval());
       HandleVolatileLoads(ref, op, os);
     } else {
@@ -707,7 +761,13 @@ void CodeGenC::VisitExpr_(const LoadNode* op, std::ostream& os) {  // NOLINT(*)
         value_temp << '[';
         PrintVecElemLoad(sindex, op->index.dtype(), i, value_temp);
         value_temp << ']';
-        PrintVecElemLoadExpr(op->dtype, i, value_temp.str(), svalue_expr);
+        std::string elem = value_temp.str();
+        if (!is_one(op->predicate)) {
+          // The masked off lanes read zero.
+          elem = "(" + PrintExpr(ExtractLane(op->predicate, i)) + " ? " + elem + " : " +
+                 PrintExpr(make_zero(elem_type)) + ")";
+        }
+        PrintVecElemLoadExpr(op->dtype, i, elem, svalue_expr);
       }
       os << svalue_expr.str();
     }
@@ -722,14 +782,13 @@ void CodeGenC::VisitStmt_(const StoreNode* op) {
     this->PrintIndent();
     stream << ref << " = " << value << ";\n";
   } else {
-    CHECK(is_one(op->predicate)) << "Predicated store is not supported";
     arith::PVar<PrimExpr> base;
 
     // The assignment below introduces side-effect, and the resulting value cannot
     // be reused across multiple expression, thus a new scope is needed
     int vec_scope = BeginScope();
 
-    if (arith::ramp(base, 1, t.lanes()).Match(op->index)) {
+    if (is_one(op->predicate) && arith::ramp(base, 1, t.lanes()).Match(op->index)) {
       std::string value = this->PrintExpr(op->value);
       this->PrintVecStore(op->buffer_var.get(), t, base.Eval(), value);
     } else {
@@ -738,7 +797,14 @@ void CodeGenC::VisitStmt_(const StoreNode* op) {
       std::string value = SSAGetID(PrintExpr(op->value), op->value.dtype());
       std::string vid = GetVarID(op->buffer_var.get());
       for (int i = 0; i < t.lanes(); ++i) {
+        std::string pred;
+        if (!is_one(op->predicate)) {
+          pred = PrintExpr(ExtractLane(op->predicate, i));
+        }
         this->PrintIndent();
+        if (!pred.empty()) {
+          stream << "if (" << pred << ") ";
+        }
         DataType elem_type = t.element_of();
         if (!HandleTypeMatch(op->buffer_var.get(), elem_type)) {
           stream << "((";
@@ -103,6 +103,13 @@ class CodeGenC : public ExprFunctor<void(const PrimExpr&, std::ostream&)>,
    *  Example: stream << "void";
    */
   virtual void PrintFuncPrefix();  // NOLINT(*)
+  /*!
+   * \brief Print the type of a handle parameter of the function.
+   * \param v The parameter.
+   * \param no_alias Whether the function does not alias its buffers.
+   * \param os The stream to print to.
+   */
+  virtual void PrintHandleParamType(const Var& v, bool no_alias, std::ostream& os);  // NOLINT(*)
   /*!
    * \brief Print the final return at the end the function.
    */
@@ -276,6 +283,15 @@ class CodeGenC : public ExprFunctor<void(const PrimExpr&, std::ostream&)>,
   std::unordered_map<Var, const LetNode*, ObjectPtrHash, ObjectPtrEqual> let_binding_;
 };
 
+/*!
+ * \brief Get the scalar expression of a lane of a vector expression, used to
+ *  print the predicates of masked loads and stores lane by lane.
+ * \param e The vector expression.
+ * \param lane The lane.
+ * \return The expression of the lane.
+ */
+PrimExpr ExtractLane(const PrimExpr& e, int lane);
+
 }  // namespace codegen
 }  // namespace tvm
 #endif  // TVM_TARGET_SOURCE_CODEGEN_C_H_
@@ -25,9 +25,11 @@
 #include <tvm/runtime/container.h>
 #include <tvm/target/codegen.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
+#include "../../arith/pattern_match.h"
 #include "../../support/str_escape.h"
 #include "../build_common.h"
 #include "../func_registry_generator.h"
@@ -35,13 +37,44 @@
 namespace tvm {
 namespace codegen {
 
+// Check that the vector type t has a 128-bit SIMD type.
+static void CheckSIMDType(const std::string& simd, DataType t) {
+  bool supported = t.is_float() ? t.bits() == 32 : (t.is_int() || t.is_uint()) && t.bits() <= 32;
+  CHECK(supported && t.bits() >= 8 && t.bits() * t.lanes() == 128)
+      << "Cannot map type " << t << " to a " << simd
+      << " SIMD type, vectorize by 128 bits of 8 to 32 bit elements";
+}
+
+// The suffix of the intrinsics on the element type of vector type t,
+// such as f32 and s8 for Arm, ps and epi8 for SSE.
+static std::string IntrinsicSuffix(const std::string& simd, DataType t) {
+  CheckSIMDType(simd, t);
+  std::ostringstream os;
+  if (simd == "sse") {
+    os << (t.is_float() ? "ps" : "epi" + std::to_string(t.bits()));
+  } else {
+    os << (t.is_float() ? 'f' : (t.is_int() ? 's' : 'u')) << t.bits();
+  }
+  return os.str();
+}
+
 CodeGenCHost::CodeGenCHost() { module_name_ = GetUniqueName("__tvm_module_ctx"); }
 
-void CodeGenCHost::Init(bool output_ssa, bool emit_asserts) {
+void CodeGenCHost::Init(bool output_ssa, bool emit_asserts, std::string simd) {
   emit_asserts_ = emit_asserts;
+  simd_ = simd;
   declared_globals_.clear();
   decl_stream << "#include \"tvm/runtime/c_runtime_api.h\"\n";
   decl_stream << "#include \"tvm/runtime/c_backend_api.h\"\n";
+  if (simd_ == "neon") {
+    decl_stream << "#include <arm_neon.h>\n";
+  } else if (simd_ == "mve") {
+    decl_stream << "#include <arm_mve.h>\n";
+  } else if (simd_ == "sse") {
+    decl_stream << "#include <emmintrin.h>\n";
+  } else {
+    CHECK(simd_.empty()) << "Unknown SIMD intrinsics " << simd_ << ", expect neon, mve or sse";
+  }
   decl_stream << "void* " << module_name_ << " = NULL;\n";
   CodeGenC::Init(output_ssa);
 }
@@ -51,6 +84,8 @@ void CodeGenCHost::AddFunction(const PrimFunc& f) {
   CHECK(global_symbol.defined())
       << "CodeGenCHost: Expect PrimFunc to have the global_symbol attribute";
   function_names_.emplace_back(global_symbol.value());
+  no_alias_ = f->HasNonzeroAttr(tir::attr::kNoAlias);
+  alignment_.clear();
 
   CodeGenC::AddFunction(f);
 }
@@ -69,6 +104,10 @@ void CodeGenCHost::PrintFinalReturn() {  // NOLINT(*)
 
 void CodeGenCHost::PrintType(DataType t, std::ostream& os) {  // NOLINT(*)
   int lanes = t.lanes();
+  if (!simd_.empty() && lanes > 1) {
+    os << SIMDType(t);
+    return;
+  }
   if (t.is_handle()) {
     CHECK_EQ(lanes, 1) << "does not support vector types";
     os << "void*";
@@ -134,6 +173,11 @@ void CodeGenCHost::PrintType(DataType t, std::ostream& os) {  // NOLINT(*)
 
 void CodeGenCHost::VisitExpr_(const BroadcastNode* op, std::ostream& os) {  // NOLINT(*)
   std::string v = PrintExpr(op->value);
+  if (!simd_.empty()) {
+    os << (simd_ == "sse" ? "_mm_set1_" : "vdupq_n_") << IntrinsicSuffix(simd_, op->dtype) << "("
+       << v << ")";
+    return;
+  }
   os << "((";
   PrintType(op->dtype, os);
   os << ")(";
@@ -144,6 +188,300 @@ void CodeGenCHost::VisitExpr_(const BroadcastNode* op, std::ostream& os) {  // N
   os << "))";
 }
 
+std::string CodeGenCHost::SIMDType(DataType t) {
+  CheckSIMDType(simd_, t);
+  if (simd_ == "sse") {
+    return t.is_float() ? "__m128" : "__m128i";
+  }
+  std::ostringstream os;
+  os << (t.is_float() ? "float" : (t.is_int() ? "int" : "uint")) << t.bits() << 'x' << t.lanes()
+     << "_t";
+  return os.str();
+}
+
+std::string CodeGenCHost::SIMDBinaryIntrinsic(const std::string& op, DataType t) {
+  std::string suffix = IntrinsicSuffix(simd_, t);
+  if (simd_ == "neon" || simd_ == "mve") {
+    if (op == "+") return "vaddq_" + suffix;
+    if (op == "-") return "vsubq_" + suffix;
+    if (op == "*") return "vmulq_" + suffix;
+    if (op == "min" || op == "max") {
+      // MVE only has the minNum and maxNum of floats.
+      return "v" + op + (simd_ == "mve" && t.is_float() ? "nmq_" : "q_") + suffix;
+    }
+    if (t.is_float()) return "";
+    if (op == "&") return "vandq_" + suffix;
+    if (op == "|") return "vorrq_" + suffix;
+    if (op == "^") return "veorq_" + suffix;
+    return "";
+  }
+  if (t.is_float()) {
+    if (op == "+") return "_mm_add_ps";
+    if (op == "-") return "_mm_sub_ps";
+    if (op == "*") return "_mm_mul_ps";
+    if (op == "/") return "_mm_div_ps";
+    if (op == "min") return "_mm_min_ps";
+    if (op == "max") return "_mm_max_ps";
+    return "";
+  }
+  if (op == "+") return "_mm_add_" + suffix;
+  if (op == "-") return "_mm_sub_" + suffix;
+  if (op == "&") return "_mm_and_si128";
+  if (op == "|") return "_mm_or_si128";
+  if (op == "^") return "_mm_xor_si128";
+  // SSE2 only has these products, min and max of integers.
+  if (op == "*" && t.is_int() && t.bits() == 16) return "_mm_mullo_epi16";
+  if ((op == "min" || op == "max") && t.is_int() && t.bits() == 16) return "_mm_" + op + "_epi16";
+  if ((op == "min" || op == "max") && t.is_uint() && t.bits() == 8) return "_mm_" + op + "_epu8";
+  return "";
+}
+
+std::string CodeGenCHost::GetVecAddr(DataType t, const VarNode* buffer, PrimExpr base) {
+  std::ostringstream os;
+  os << "((";
+  PrintType(t.element_of(), os);
+  os << "*)" << GetVarID(buffer) << " + " << PrintExpr(base) << ")";
+  return os.str();
+}
+
+bool CodeGenCHost::IsAlignedVecAccess(DataType t, const VarNode* buffer, PrimExpr base) {
+  auto it = alignment_.find(buffer);
+  if (it == alignment_.end() || it->second < 16) return false;
+  return analyzer_.CanProve(floormod(base, 128 / t.bits()) == 0);
+}
+
+std::string CodeGenCHost::GetVecLoad(DataType t, const VarNode* buffer, PrimExpr base) {
+  if (simd_.empty()) return CodeGenC::GetVecLoad(t, buffer, base);
+  std::string suffix = IntrinsicSuffix(simd_, t);
+  std::string addr = GetVecAddr(t, buffer, base);
+  if (simd_ != "sse") return "vld1q_" + suffix + "(" + addr + ")";
+  std::string load = IsAlignedVecAccess(t, buffer, base) ? "_mm_load_" : "_mm_loadu_";
+  if (t.is_float()) return load + "ps(" + addr + ")";
+  return load + "si128((const __m128i*)" + addr + ")";
+}
+
+void CodeGenCHost::PrintVecStore(const VarNode* buffer, DataType t, PrimExpr base,
+                                 const std::string& value) {
+  if (simd_.empty()) return CodeGenC::PrintVecStore(buffer, t, base, value);
+  std::string suffix = IntrinsicSuffix(simd_, t);
+  std::string addr = GetVecAddr(t, buffer, base);
+  this->PrintIndent();
+  if (simd_ != "sse") {
+    stream << "vst1q_" << suffix << "(" << addr << ", " << value << ");\n";
+    return;
+  }
+  stream << (IsAlignedVecAccess(t, buffer, base) ? "_mm_store_" : "_mm_storeu_");
+  if (t.is_float()) {
+    stream << "ps(" << addr;
+  } else {
+    stream << "si128((__m128i*)" << addr;
+  }
+  stream << ", " << value << ");\n";
+}
+
+void CodeGenCHost::PrintVecBinaryOp(const std::string& op, DataType t, PrimExpr lhs, PrimExpr rhs,
+                                    std::ostream& os) {  // NOLINT(*)
+  if (simd_.empty()) return CodeGenC::PrintVecBinaryOp(op, t, lhs, rhs, os);
+  std::string opstr = op;
+  opstr.erase(std::remove(opstr.begin(), opstr.end(), ' '), opstr.end());
+  std::string intrinsic = SIMDBinaryIntrinsic(opstr, t);
+  if (!intrinsic.empty()) {
+    os << intrinsic << "(";
+    PrintExpr(lhs, os);
+    os << ", ";
+    PrintExpr(rhs, os);
+    os << ")";
+    return;
+  }
+  // The operations without intrinsic are done lane by lane.
+  std::string vlhs = SSAGetID(PrintExpr(lhs), lhs.dtype());
+  std::string vrhs = SSAGetID(PrintExpr(rhs), rhs.dtype());
+  for (int i = 0; i < t.lanes(); ++i) {
+    std::ostringstream a, b;
+    PrintVecElemLoad(vlhs, lhs.dtype(), i, a);
+    PrintVecElemLoad(vrhs, rhs.dtype(), i, b);
+    std::ostringstream elem;
+    if (opstr == "min" || opstr == "max") {
+      elem << "((" << a.str() << ") " << (opstr == "min" ? "<" : ">") << " (" << b.str()
+           << ") ? (" << a.str() << ") : (" << b.str() << "))";
+    } else {
+      elem << "(" << a.str() << " " << opstr << " " << b.str() << ")";
+    }
+    PrintVecElemLoadExpr(t, i, elem.str(), os);
+  }
+}
+
+void CodeGenCHost::PrintVecElemLoad(const std::string& vec, DataType t, int i,
+                                    std::ostream& os) {  // NOLINT(*)
+  if (simd_.empty()) return CodeGenC::PrintVecElemLoad(vec, t, i, os);
+  if (t.is_scalar()) {
+    os << vec;
+  } else if (simd_ == "sse") {
+    os << "((";
+    PrintType(t.element_of(), os);
+    os << "*)&" << vec << ")[" << i << "]";
+  } else {
+    os << "vgetq_lane_" << IntrinsicSuffix(simd_, t) << "(" << vec << ", " << i << ")";
+  }
+}
+
+void CodeGenCHost::PrintVecElemLoadExpr(DataType t, int i, const std::string& value,
+                                        std::ostream& os) {  // NOLINT(*)
+  if (simd_.empty()) return CodeGenC::PrintVecElemLoadExpr(t, i, value, os);
+  if (i == 0) {
+    if (simd_ == "sse") {
+      os << "_mm_setr_" << IntrinsicSuffix(simd_, t) << "(";
+    } else {
+      os << "((" << SIMDType(t) << "){";
+    }
+  }
+  os << value;
+  if (i != t.lanes() - 1) {
+    os << ", ";
+  } else {
+    os << (simd_ == "sse" ? ")" : "})");
+  }
+}
+
+std::string CodeGenCHost::CastFromTo(std::string value, DataType from, DataType target) {
+  if (simd_.empty() || from == target || target.lanes() == 1) {
+    return CodeGenC::CastFromTo(value, from, target);
+  }
+  std::string v = SSAGetID(value, from);
+  std::ostringstream os;
+  for (int i = 0; i < target.lanes(); ++i) {
+    std::ostringstream elem;
+    elem << "((";
+    PrintType(target.element_of(), elem);
+    elem << ")";
+    PrintVecElemLoad(v, from, i, elem);
+    elem << ")";
+    PrintVecElemLoadExpr(target, i, elem.str(), os);
+  }
+  return os.str();
+}
+
+void CodeGenCHost::PrintCallExtern(Type ret_type, String global_symbol,
+                                   const Array<PrimExpr>& args, bool skip_first_arg,
+                                   std::ostream& os) {  // NOLINT(*)
+  const auto* prim = ret_type.as<PrimTypeNode>();
+  if (simd_.empty() || prim == nullptr || prim->dtype.lanes() == 1) {
+    return CodeGenC::PrintCallExtern(ret_type, global_symbol, args, skip_first_arg, os);
+  }
+  // The extern functions are scalar, call them lane by lane.
+  std::vector<std::string> sargs;
+  for (size_t i = static_cast<size_t>(skip_first_arg); i < args.size(); ++i) {
+    sargs.push_back(args[i].dtype().lanes() == 1 ? PrintExpr(args[i])
+                                                  : SSAGetID(PrintExpr(args[i]), args[i].dtype()));
+  }
+  for (int lane = 0; lane < prim->dtype.lanes(); ++lane) {
+    std::ostringstream call;
+    call << global_symbol << "(";
+    for (size_t i = 0; i < sargs.size(); ++i) {
+      if (i != 0) call << ", ";
+      PrintVecElemLoad(sargs[i], args[i + skip_first_arg].dtype(), lane, call);
+    }
+    call << ")";
+    PrintVecElemLoadExpr(prim->dtype, lane, call.str(), os);
+  }
+}
+
+void CodeGenCHost::VisitExpr_(const LoadNode* op, std::ostream& os) {  // NOLINT(*)
+  arith::PVar<PrimExpr> base;
+  if (simd_.empty() || op->dtype.lanes() == 1 ||
+      (is_one(op->predicate) && arith::ramp(base, 1, op->dtype.lanes()).Match(op->index))) {
+    return CodeGenC::VisitExpr_(op, os);
+  }
+  // Gather the lanes, whose indices need not fit a SIMD type.
+  DataType elem_type = op->dtype.element_of();
+  for (int i = 0; i < op->dtype.lanes(); ++i) {
+    std::string elem = PrintExpr(Load(elem_type, op->buffer_var, ExtractLane(op->index, i),
+                                      const_true()));
+    if (!is_one(op->predicate)) {
+      // The masked off lanes read zero.
+      elem = "(" + PrintExpr(ExtractLane(op->predicate, i)) + " ? " + elem + " : " +
+             PrintExpr(make_zero(elem_type)) + ")";
+    }
+    PrintVecElemLoadExpr(op->dtype, i, elem, os);
+  }
+}
+
+void CodeGenCHost::VisitStmt_(const StoreNode* op) {
+  DataType t = op->value.dtype();
+  arith::PVar<PrimExpr> base;
+  if (simd_.empty() || t.lanes() == 1 ||
+      (is_one(op->predicate) && arith::ramp(base, 1, t.lanes()).Match(op->index))) {
+    return CodeGenC::VisitStmt_(op);
+  }
+  // Scatter the lanes, whose indices need not fit a SIMD type.
+  int vec_scope = BeginScope();
+  std::string value = SSAGetID(PrintExpr(op->value), t);
+  for (int i = 0; i < t.lanes(); ++i) {
+    std::string ref = GetBufferRef(t.element_of(), op->buffer_var.get(), ExtractLane(op->index, i));
+    this->PrintIndent();
+    if (!is_one(op->predicate)) {
+      stream << "if (" << PrintExpr(ExtractLane(op->predicate, i)) << ") ";
+    }
+    stream << ref << " = ";
+    PrintVecElemLoad(value, t, i, stream);
+    stream << ";\n";
+  }
+  EndScope(vec_scope);
+}
+
+void CodeGenCHost::VisitExpr_(const RampNode* op, std::ostream& os) {  // NOLINT(*)
+  if (simd_.empty()) return CodeGenC::VisitExpr_(op, os);
+  for (int i = 0; i < op->lanes; ++i) {
+    PrintVecElemLoadExpr(op->dtype, i, PrintExpr(ExtractLane(GetRef<PrimExpr>(op), i)), os);
+  }
+}
+
+void CodeGenCHost::VisitExpr_(const SelectNode* op, std::ostream& os) {  // NOLINT(*)
+  if (simd_.empty() || op->dtype.lanes() == 1) return CodeGenC::VisitExpr_(op, os);
+  // Select lane by lane, the conditions have no SIMD type.
+  std::string vtrue = SSAGetID(PrintExpr(op->true_value), op->dtype);
+  std::string vfalse = SSAGetID(PrintExpr(op->false_value), op->dtype);
+  for (int i = 0; i < op->dtype.lanes(); ++i) {
+    std::ostringstream elem;
+    elem << "(" << PrintExpr(ExtractLane(op->condition, i)) << " ? ";
+    PrintVecElemLoad(vtrue, op->dtype, i, elem);
+    elem << " : ";
+    PrintVecElemLoad(vfalse, op->dtype, i, elem);
+    elem << ")";
+    PrintVecElemLoadExpr(op->dtype, i, elem.str(), os);
+  }
+}
+
+void CodeGenCHost::VisitStmt_(const AttrStmtNode* op) {
+  if (op->attr_key == tir::attr::storage_alignment) {
+    const VarNode* buffer = op->node.as<VarNode>();
+    const IntImmNode* align = op->value.as<IntImmNode>();
+    if (buffer != nullptr && align != nullptr) {
+      alignment_[buffer] = align->value;
+    }
+  }
+  CodeGenC::VisitStmt_(op);
+}
+
+void CodeGenCHost::VisitStmt_(const LetStmtNode* op) {
+  // The data of the buffers of a no-alias function is declared restrict, so that the
+  // C compiler can vectorize the loops left scalar. The module may be compiled as C++,
+  // which only has the __restrict extension.
+  const auto* ptr = op->var->type_annotation.as<PointerTypeNode>();
+  const auto* prim = ptr != nullptr ? ptr->element_type.as<PrimTypeNode>() : nullptr;
+  if (!no_alias_ || prim == nullptr || handle_data_type_.count(op->var.get())) {
+    return CodeGenC::VisitStmt_(op);
+  }
+  std::string value = PrintExpr(op->value);
+  RegisterHandleType(op->var.get(), prim->dtype);
+  this->PrintIndent();
+  PrintType(prim->dtype, stream);
+  stream << "* __restrict " << AllocVarID(op->var.get()) << " = (";
+  PrintType(prim->dtype, stream);
+  stream << "*)" << value << ";\n";
+  PrintStmt(op->body);
+}
+
 void CodeGenCHost::PrintGetFuncFromBackend(const std::string& func_name,
                                            const std::string& packed_func_name) {
   this->PrintIndent();
@@ -304,7 +642,7 @@ runtime::Module BuildCHost(IRModule mod, const std::string& target_str) {
   bool emit_asserts = false;
   CodeGenCHost cg;
   auto target = Target::Create(target_str);
-  cg.Init(output_ssa, emit_asserts);
+  cg.Init(output_ssa, emit_asserts, target->GetAttr<String>("simd").value_or(""));
 
   for (auto kv : mod->functions) {
     CHECK(kv.second->IsInstance<PrimFuncNode>()) << "CodegenCHost: Can only take PrimFunc";
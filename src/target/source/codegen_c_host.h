@@ -24,8 +24,11 @@
 #ifndef TVM_TARGET_SOURCE_CODEGEN_C_HOST_H_
 #define TVM_TARGET_SOURCE_CODEGEN_C_HOST_H_
 
+#include <tvm/arith/analyzer.h>
+
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "codegen_c.h"
@@ -38,7 +41,14 @@ namespace codegen {
 class CodeGenCHost final : public CodeGenC {
  public:
   CodeGenCHost();
-  void Init(bool output_ssa, bool emit_asserts);
+  /*!
+   * \brief Initialize the code generator.
+   * \param output_ssa Whether to output SSA.
+   * \param emit_asserts Whether to emit the asserts.
+   * \param simd The SIMD intrinsics the vector types and operations map to,
+   *  "neon", "mve" or "sse", or empty for the C vector types.
+   */
+  void Init(bool output_ssa, bool emit_asserts, std::string simd = "");
 
   void AddFunction(const PrimFunc& f);
 
@@ -46,15 +56,35 @@ class CodeGenCHost final : public CodeGenC {
   void PrintFuncPrefix() final;                        // NOLINT(*)
   void PrintFinalReturn() final;                       // NOLINT(*)
 
+  // SIMD intrinsics of the vector accesses and operations
+  std::string GetVecLoad(DataType t, const VarNode* buffer, PrimExpr base) final;
+  void PrintVecStore(const VarNode* buffer, DataType t, PrimExpr base,
+                     const std::string& value) final;
+  void PrintVecBinaryOp(const std::string& op, DataType t, PrimExpr lhs, PrimExpr rhs,
+                        std::ostream& os) final;  // NOLINT(*)
+  void PrintVecElemLoad(const std::string& vec, DataType t, int i,
+                        std::ostream& os) final;  // NOLINT(*)
+  void PrintVecElemLoadExpr(DataType t, int i, const std::string& value,
+                            std::ostream& os) final;  // NOLINT(*)
+  std::string CastFromTo(std::string value, DataType from, DataType target) final;
+  void PrintCallExtern(Type ret_type, String global_symbol, const Array<PrimExpr>& args,
+                       bool skip_first_arg, std::ostream& os) final;  // NOLINT(*)
+
   // overload visitor functions
   void VisitExpr_(const BroadcastNode* op, std::ostream& os) final;  // NOLINT(*)
   void VisitExpr_(const CallNode* op, std::ostream& os) final;       // NOLINT(*)
+  void VisitExpr_(const LoadNode* op, std::ostream& os) final;       // NOLINT(*)
+  void VisitExpr_(const RampNode* op, std::ostream& os) final;       // NOLINT(*)
+  void VisitExpr_(const SelectNode* op, std::ostream& os) final;     // NOLINT(*)
   // overload min and max to use the ternary operator, so we don't rely on the
   // standard library implementations
   void VisitExpr_(const MinNode* op, std::ostream& os) final;  // NOLINT(*)
   void VisitExpr_(const MaxNode* op, std::ostream& os) final;  // NOLINT(*)
 
   void VisitStmt_(const AssertStmtNode* op) final;  // NOLINT(*)
+  void VisitStmt_(const AttrStmtNode* op) final;    // NOLINT(*)
+  void VisitStmt_(const LetStmtNode* op) final;     // NOLINT(*)
+  void VisitStmt_(const StoreNode* op) final;       // NOLINT(*)
 
   /*! \brief Generate C runtime FuncRegistry global constant. */
   void GenerateFuncRegistry();
@@ -70,6 +100,23 @@ class CodeGenCHost final : public CodeGenC {
   std::vector<std::string> function_names_;
   /*! \brief whether to emit asserts in the resulting C code */
   bool emit_asserts_;
+  /*! \brief the SIMD intrinsics of the vector code, empty for the C vector types */
+  std::string simd_;
+  /*! \brief whether the buffers of the current function do not alias */
+  bool no_alias_{false};
+  /*! \brief the alignment in bytes of the external buffers */
+  std::unordered_map<const VarNode*, int64_t> alignment_;
+  /*! \brief analyzer to prove the alignment of the vector accesses */
+  arith::Analyzer analyzer_;
+
+  /*! \brief The SIMD type of the vector type t, which must be 128 bits of 8 to 32 bit elements. */
+  std::string SIMDType(DataType t);
+  /*! \brief The SIMD intrinsic of the binary op on vectors of type t, empty if it has none. */
+  std::string SIMDBinaryIntrinsic(const std::string& op, DataType t);
+  /*! \brief Print the address of the vector access of buffer at base. */
+  std::string GetVecAddr(DataType t, const VarNode* buffer, PrimExpr base);
+  /*! \brief Whether the vector access of buffer at base is aligned to the SIMD width. */
+  bool IsAlignedVecAccess(DataType t, const VarNode* buffer, PrimExpr base);
 
   void PrintGetFuncFromBackend(const std::string& func_name, const std::string& packed_func_name);
   void PrintFuncCall(const std::string& packed_func_name, int num_args);
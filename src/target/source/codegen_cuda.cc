@@ -26,6 +26,7 @@
 #include <tvm/runtime/registry.h>
 
 #include <cmath>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -209,8 +210,9 @@ void CodeGenCUDA::PrintType(DataType t, std::ostream& os) {  // NOLINT(*)
 
           // We use int for int8x4 instead of char4 because using char4 is
           // likely to produce extra instructions to pack four int8 elements
-          // into 32-bit data.
-          os << "int";
+          // into 32-bit data. uint8x4 is uint, as its broadcasts, which
+          // selects the unsigned overloads, e.g. of __dp4a.
+          os << (t.is_uint() ? "uint" : "int");
           return;
         } else if (t.lanes() == 8) {
           enable_int8_ = true;
@@ -566,10 +568,61 @@ void CodeGenCUDA::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* buffer = op->node.as<VarNode>();
     const StringImmNode* layout_str = op->value.as<StringImmNode>();
     fragment_layouts[buffer] = layout_str->value;
+  } else if (op->attr_key == tir::attr::async_scope) {
+    in_async_scope_ = true;
+    this->PrintStmt(op->body);
+    in_async_scope_ = false;
+    return;
   }
   CodeGenC::VisitStmt_(op);
 }
 
+void CodeGenCUDA::VisitStmt_(const StoreNode* op) {
+  // Copies from global to shared memory of 4, 8 or 16 bytes become cp.async on sm_80.
+  const LoadNode* load = op->value.as<LoadNode>();
+  DataType t = op->value.dtype();
+  int bytes = t.bytes() * t.lanes();
+  auto is_shared = [this](const VarNode* buffer) {
+    auto it = alloc_storage_scope_.find(buffer);
+    return it != alloc_storage_scope_.end() && it->second == "shared";
+  };
+  if (!in_async_scope_ || load == nullptr || !is_one(op->predicate) ||
+      !is_one(load->predicate) || (bytes != 4 && bytes != 8 && bytes != 16) ||
+      !is_shared(op->buffer_var.get()) || alloc_storage_scope_.count(load->buffer_var.get())) {
+    CodeGenC::VisitStmt_(op);
+    return;
+  }
+  PrimExpr dst_index = op->index;
+  PrimExpr src_index = load->index;
+  if (t.lanes() > 1) {
+    const RampNode* dst_ramp = dst_index.as<RampNode>();
+    const RampNode* src_ramp = src_index.as<RampNode>();
+    if (!dst_ramp || !src_ramp || !is_one(dst_ramp->stride) || !is_one(src_ramp->stride)) {
+      CodeGenC::VisitStmt_(op);
+      return;
+    }
+    dst_index = dst_ramp->base;
+    src_index = src_ramp->base;
+  }
+  std::string dst = GetBufferRef(t, op->buffer_var.get(), dst_index);
+  std::string src = GetBufferRef(t, load->buffer_var.get(), src_index);
+  this->PrintIndent();
+  stream << "{\n";
+  stream << "#if (__CUDA_ARCH__ >= 800)\n";
+  this->PrintIndent();
+  stream << "  unsigned int addr = (unsigned int)__cvta_generic_to_shared(&(" << dst << "));\n";
+  this->PrintIndent();
+  stream << "  asm volatile(\"cp.async.ca.shared.global [%0], [%1], %2;\\n\"\n";
+  this->PrintIndent();
+  stream << "               :: \"r\"(addr), \"l\"(&(" << src << ")), \"n\"(" << bytes << "));\n";
+  stream << "#else\n";
+  this->PrintIndent();
+  stream << "  " << dst << " = " << src << ";\n";
+  stream << "#endif\n";
+  this->PrintIndent();
+  stream << "}\n";
+}
+
 void CodeGenCUDA::VisitStmt_(const AllocateNode* op) {
   CHECK(!is_zero(op->condition));
   std::string vid = AllocVarID(op->buffer_var.get());
@@ -611,7 +664,22 @@ void CodeGenCUDA::VisitStmt_(const AllocateNode* op) {
 void CodeGenCUDA::VisitStmt_(const EvaluateNode* op) {
   if (is_const_int(op->value)) return;
   const CallNode* call = op->value.as<CallNode>();
-  if (call && call->op.same_as(builtin::tvm_global_barrier_kinit())) {
+  if (call && (call->op.same_as(builtin::ptx_commit_group()) ||
+               call->op.same_as(builtin::ptx_wait_group()))) {
+    stream << "#if (__CUDA_ARCH__ >= 800)\n";
+    PrintIndent();
+    if (call->op.same_as(builtin::ptx_commit_group())) {
+      stream << "asm volatile(\"cp.async.commit_group;\\n\" ::);\n";
+    } else {
+      stream << "asm volatile(\"cp.async.wait_group " << Downcast<IntImm>(call->args[0])->value
+             << ";\\n\" ::);\n";
+    }
+    stream << "#endif\n";
+  } else if (call && call->op.same_as(builtin::ptx_mma())) {
+    PrintPTXMMA(call);
+  } else if (call && call->op.same_as(builtin::ptx_ldmatrix())) {
+    PrintPTXLdMatrix(call);
+  } else if (call && call->op.same_as(builtin::tvm_global_barrier_kinit())) {
     PrintIndent();
     stream << "__shared__ unsigned " << vid_global_barrier_expect_ << ";\n";
     PrintIndent();
@@ -625,6 +693,135 @@ void CodeGenCUDA::VisitStmt_(const EvaluateNode* op) {
   }
 }
 
+namespace {
+// The number of 32-bit registers each thread holds of the fragments of a mma shape.
+struct PTXMMAConfig {
+  const char* shape;
+  bool is_int;
+  const char* c_dtype;
+  int num_a, num_b, num_c;
+};
+
+const PTXMMAConfig kPTXMMAConfigs[] = {
+    {"m16n8k8", false, "fp32", 2, 1, 4},   {"m16n8k8", false, "fp16", 2, 1, 2},
+    {"m16n8k16", false, "fp32", 4, 2, 4},  {"m16n8k16", false, "fp16", 4, 2, 2},
+    {"m8n8k16", true, "int32", 1, 1, 2},   {"m16n8k16", true, "int32", 2, 1, 4},
+    {"m16n8k32", true, "int32", 4, 2, 4},
+};
+
+std::string PTXDType(const std::string& dtype) {
+  if (dtype == "fp16") return "f16";
+  if (dtype == "bf16") return "bf16";
+  if (dtype == "fp32") return "f32";
+  if (dtype == "int8") return "s8";
+  if (dtype == "uint8") return "u8";
+  if (dtype == "int32") return "s32";
+  LOG(FATAL) << "Unsupported mma data type " << dtype;
+  return "";
+}
+
+// Print the operand list of registers first, first + 1, ..., first + num - 1.
+std::string PTXOperands(int first, int num) {
+  std::ostringstream os;
+  os << "{";
+  for (int i = 0; i < num; ++i) {
+    os << (i == 0 ? "" : ", ") << "%" << first + i;
+  }
+  os << "}";
+  return os.str();
+}
+}  // namespace
+
+void CodeGenCUDA::PrintPTXMMA(const CallNode* op) {
+  CHECK_EQ(op->args.size(), 12U);
+  auto str = [op](int i) { return Downcast<StringImm>(op->args[i])->value; };
+  std::string shape = str(0), a_layout = str(1), b_layout = str(2);
+  std::string a_dtype = str(3), b_dtype = str(4), c_dtype = str(5);
+  CHECK(a_layout == "row" && b_layout == "col")
+      << "mma " << shape << " only supports row-major A and column-major B";
+  bool is_int = a_dtype == "int8" || a_dtype == "uint8";
+  CHECK(is_int ? (b_dtype == "int8" || b_dtype == "uint8") : a_dtype == b_dtype)
+      << "Mismatched mma data types " << a_dtype << " and " << b_dtype;
+  const PTXMMAConfig* config = nullptr;
+  for (const PTXMMAConfig& c : kPTXMMAConfigs) {
+    if (shape == c.shape && is_int == c.is_int && c_dtype == c.c_dtype) config = &c;
+  }
+  CHECK(config != nullptr && (a_dtype != "bf16" || c_dtype == "fp32"))
+      << "Unsupported mma " << shape << " of " << a_dtype << " accumulated in " << c_dtype;
+  const char* c_type = c_dtype == "fp32" ? "float" : c_dtype == "int32" ? "int" : "unsigned";
+  const char* c_constraint = c_dtype == "fp32" ? "+f" : "+r";
+
+  this->PrintIndent();
+  stream << "{\n";
+  int scope = this->BeginScope();
+  this->PrintIndent();
+  stream << "unsigned* A = (unsigned*)(&(" << PrintExpr(op->args[6]) << "["
+         << PrintExpr(op->args[7]) << "]));\n";
+  this->PrintIndent();
+  stream << "unsigned* B = (unsigned*)(&(" << PrintExpr(op->args[8]) << "["
+         << PrintExpr(op->args[9]) << "]));\n";
+  this->PrintIndent();
+  stream << c_type << "* C = (" << c_type << "*)(&(" << PrintExpr(op->args[10]) << "["
+         << PrintExpr(op->args[11]) << "]));\n";
+  this->PrintIndent();
+  stream << "asm volatile(\"mma.sync.aligned." << shape << ".row.col." << PTXDType(c_dtype) << "."
+         << PTXDType(a_dtype) << "." << PTXDType(b_dtype) << "." << PTXDType(c_dtype) << " "
+         << PTXOperands(0, config->num_c) << ", " << PTXOperands(config->num_c, config->num_a)
+         << ", " << PTXOperands(config->num_c + config->num_a, config->num_b) << ", "
+         << PTXOperands(0, config->num_c) << ";\\n\"\n";
+  this->PrintIndent();
+  stream << "             : ";
+  for (int i = 0; i < config->num_c; ++i) {
+    stream << (i == 0 ? "" : ", ") << "\"" << c_constraint << "\"(C[" << i << "])";
+  }
+  stream << "\n";
+  this->PrintIndent();
+  stream << "             : ";
+  for (int i = 0; i < config->num_a; ++i) {
+    stream << (i == 0 ? "" : ", ") << "\"r\"(A[" << i << "])";
+  }
+  for (int i = 0; i < config->num_b; ++i) {
+    stream << ", \"r\"(B[" << i << "])";
+  }
+  stream << ");\n";
+  this->EndScope(scope);
+  this->PrintIndent();
+  stream << "}\n";
+}
+
+void CodeGenCUDA::PrintPTXLdMatrix(const CallNode* op) {
+  CHECK_EQ(op->args.size(), 7U);
+  bool trans = is_one(op->args[0]);
+  int num = static_cast<int>(Downcast<IntImm>(op->args[1])->value);
+  std::string type = Downcast<StringImm>(op->args[2])->value;
+  CHECK(num == 1 || num == 2 || num == 4) << "ldmatrix loads 1, 2 or 4 matrices, not " << num;
+  CHECK_EQ(type, "b16") << "ldmatrix only loads 16-bit elements";
+
+  this->PrintIndent();
+  stream << "{\n";
+  int scope = this->BeginScope();
+  this->PrintIndent();
+  stream << "unsigned int addr = (unsigned int)__cvta_generic_to_shared(&("
+         << PrintExpr(op->args[5]) << "[" << PrintExpr(op->args[6]) << "]));\n";
+  this->PrintIndent();
+  stream << "unsigned* R = (unsigned*)(&(" << PrintExpr(op->args[3]) << "["
+         << PrintExpr(op->args[4]) << "]));\n";
+  this->PrintIndent();
+  stream << "asm volatile(\"ldmatrix.sync.aligned.m8n8.x" << num << (trans ? ".trans" : "")
+         << ".shared." << type << " " << PTXOperands(0, num) << ", [%" << num << "];\\n\"\n";
+  this->PrintIndent();
+  stream << "             : ";
+  for (int i = 0; i < num; ++i) {
+    stream << (i == 0 ? "" : ", ") << "\"=r\"(R[" << i << "])";
+  }
+  stream << "\n";
+  this->PrintIndent();
+  stream << "             : \"r\"(addr));\n";
+  this->EndScope(scope);
+  this->PrintIndent();
+  stream << "}\n";
+}
+
 void CodeGenCUDA::VisitExpr_(const RampNode* op, std::ostream& os) {
   os << "((make_int" << op->lanes << ")(";
   for (int i = 0; i < op->lanes; i++) {
@@ -68,6 +68,7 @@ class CodeGenCUDA final : public CodeGenC {
   void VisitStmt_(const EvaluateNode* op) final;
   void VisitStmt_(const AllocateNode* op) final;
   void VisitStmt_(const AttrStmtNode* op) final;
+  void VisitStmt_(const StoreNode* op) final;
 
  protected:
   void PrintCallExtern(Type ret_type, String global_symbol, const Array<PrimExpr>& args,
@@ -96,6 +97,8 @@ class CodeGenCUDA final : public CodeGenC {
   bool need_math_constants_h_{false};
   // whether need mma.h
   bool need_mma_h_{false};
+  // whether the stores are asynchronous copies
+  bool in_async_scope_{false};
   // Op attribute map
   OpAttrMap<bool> op_need_warp_shuffle_ = Op::GetAttrMap<bool>("cuda.need_warp_shuffle");
 
@@ -105,6 +108,9 @@ class CodeGenCUDA final : public CodeGenC {
   void PrintWmmaScope(const std::string& scope, DataType t, const VarNode* variable,
                       std::ostream& os);
   int32_t GetWmmaFragmentSize(const std::string& scope, const VarNode* variable, int32_t size);
+  // Print the inline assembly of builtin::ptx_mma and builtin::ptx_ldmatrix.
+  void PrintPTXMMA(const CallNode* op);
+  void PrintPTXLdMatrix(const CallNode* op);
 };
 
 }  // namespace codegen
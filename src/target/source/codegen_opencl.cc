@@ -42,6 +42,33 @@ void CodeGenOpenCL::InitFuncState(const PrimFunc& f) {
       alloc_storage_scope_[arg.get()] = "global";
     }
   }
+  // The texture buffers are passed as images, which a kernel can either read or write.
+  image_written_.clear();
+  PostOrderVisit(f->body, [this](const ObjectRef& node) {
+    const CallNode* call = node.as<CallNode>();
+    if (call == nullptr) return;
+    bool is_store = call->op.same_as(builtin::texture2d_store());
+    if (!is_store && !call->op.same_as(builtin::texture2d_load())) return;
+    const VarNode* image = call->args[0].as<VarNode>();
+    CHECK(image) << "Expect the image of " << call->op << " to be a Var";
+    auto it = image_written_.find(image);
+    if (it == image_written_.end()) {
+      image_written_[image] = is_store;
+    } else {
+      CHECK_EQ(it->second, is_store)
+          << "OpenCL image " << image->name_hint << " cannot be both read and written in a kernel";
+    }
+  });
+}
+
+void CodeGenOpenCL::PrintHandleParamType(const Var& v, bool no_alias,
+                                         std::ostream& os) {  // NOLINT(*)
+  auto it = image_written_.find(v.get());
+  if (it == image_written_.end()) {
+    CodeGenC::PrintHandleParamType(v, no_alias, os);
+  } else {
+    os << (it->second ? "__write_only" : "__read_only") << " image2d_t";
+  }
 }
 
 void CodeGenOpenCL::PrintFuncPrefix() { stream << "__kernel void"; }
@@ -75,6 +102,10 @@ std::string CodeGenOpenCL::Finish() {
     decl_stream << "#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable\n"
                    "#pragma OPENCL EXTENSION cl_khr_global_int32_extended_atomics : enable\n\n";
   }
+  if (enable_image_sampler_) {
+    decl_stream << "__constant sampler_t image_sampler = CLK_NORMALIZED_COORDS_FALSE | "
+                   "CLK_ADDRESS_CLAMP | CLK_FILTER_NEAREST;\n\n";
+  }
   return CodeGenC::Finish();
 }
 
@@ -213,6 +244,19 @@ void CodeGenOpenCL::PrintStorageScope(const std::string& scope, std::ostream& os
   }
 }
 
+std::string CodeGenOpenCL::GetImageTypeSuffix(DataType t) {
+  CHECK_EQ(t.lanes(), 4) << "OpenCL images are accessed by texels of 4 channels, but got " << t;
+  if (t.is_float() && t.bits() == 32) return "f";
+  if (t.is_float() && t.bits() == 16) {
+    enable_fp16_ = true;
+    return "h";
+  }
+  if (t.is_int() && t.bits() == 32) return "i";
+  if (t.is_uint() && t.bits() == 32) return "ui";
+  LOG(FATAL) << "Cannot access OpenCL images of type " << t;
+  return "";
+}
+
 std::string CodeGenOpenCL::CastFromTo(std::string value, DataType from, DataType target) {
   if (from == target) return value;
   std::ostringstream os;
@@ -243,6 +287,25 @@ void CodeGenOpenCL::VisitExpr_(const CallNode* op, std::ostream& os) {
     os << " *)" << this->GetVarID(load->buffer_var.get()) << " + ";
     this->PrintExpr(load->index, os);
     os << ')';
+  } else if (op->op.same_as(builtin::texture2d_load())) {
+    enable_image_sampler_ = true;
+    os << "read_image" << GetImageTypeSuffix(op->dtype) << "(";
+    this->PrintExpr(op->args[0], os);
+    os << ", image_sampler, (int2)(";
+    this->PrintExpr(op->args[1], os);
+    os << ", ";
+    this->PrintExpr(op->args[2], os);
+    os << "))";
+  } else if (op->op.same_as(builtin::texture2d_store())) {
+    os << "write_image" << GetImageTypeSuffix(op->args[3].dtype()) << "(";
+    this->PrintExpr(op->args[0], os);
+    os << ", (int2)(";
+    this->PrintExpr(op->args[1], os);
+    os << ", ";
+    this->PrintExpr(op->args[2], os);
+    os << "), ";
+    this->PrintExpr(op->args[3], os);
+    os << ")";
   } else if (op->op.same_as(builtin_call_extern_)) {
     auto func = Downcast<StringImm>(op->args[0]);
     // Enable atomics extension if used.
@@ -27,6 +27,7 @@
 #include <tvm/target/codegen.h>
 
 #include <string>
+#include <unordered_map>
 
 #include "codegen_c.h"
 
@@ -40,6 +41,7 @@ class CodeGenOpenCL final : public CodeGenC {
 
   // override print thread tag.
   void InitFuncState(const PrimFunc& f) final;
+  void PrintHandleParamType(const Var& v, bool no_alias, std::ostream& os) final;
   void PrintFuncPrefix() final;                                              // NOLINT(*)
   void BindThreadIndex(const IterVar& iv) final;                             // NOLINT(*)
   void PrintStorageScope(const std::string& scope, std::ostream& os) final;  // NOLINT(*)
@@ -52,6 +54,8 @@ class CodeGenOpenCL final : public CodeGenC {
   void PrintVecAddr(const VarNode* buffer, DataType t, PrimExpr base,
                     std::ostream& os);                                        // NOLINT(*)
   std::string CastFromTo(std::string value, DataType from, DataType target);  // NOLINT(*)
+  // the suffix of read_image and write_image for the texel type
+  std::string GetImageTypeSuffix(DataType t);
 
   // overload visitor
   void VisitExpr_(const CallNode* op, std::ostream& os) final;       // NOLINT(*)
@@ -64,6 +68,10 @@ class CodeGenOpenCL final : public CodeGenC {
   bool enable_fp64_{false};
   // Whether to enable atomics extension.
   bool enable_atomics_{false};
+  // Whether to declare the sampler of the image reads.
+  bool enable_image_sampler_{false};
+  // The image parameters of the function, whether each is written.
+  std::unordered_map<const VarNode*, bool> image_written_;
 };
 
 }  // namespace codegen
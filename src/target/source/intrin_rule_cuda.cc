@@ -22,6 +22,7 @@
  * \brief CUDA intrinsic rules.
  */
 #include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
 #include <tvm/tir/op_attr_types.h>
 
 #include "../intrin_rule.h"
@@ -113,6 +114,20 @@ static void DispatchCUDAWarpActiveMask(const TVMArgs& args, TVMRetValue* rv) {
   *rv = Call(call->dtype, Op::Get("tir.cuda.__activemask"), call->args);
 }
 
+static void DispatchCUDADP4A(const TVMArgs& args, TVMRetValue* rv) {
+  PrimExpr e = args[0];
+  const CallNode* call = e.as<CallNode>();
+  CHECK(call != nullptr);
+  CHECK_EQ(call->args.size(), 3);  // a, b, c
+  // uint8x4 is printed as uint, all the arguments should be unsigned to select
+  // the unsigned __dp4a.
+  DataType acc = call->args[0].dtype().is_uint() ? DataType::UInt(32) : DataType::Int(32);
+  Array<PrimExpr> cuda_args{
+      {StringImm("__dp4a"), call->args[0], call->args[1], cast(acc, call->args[2])}};
+  PrimExpr dot = Call(acc, builtin::call_pure_extern(), cuda_args);
+  *rv = cast(call->dtype, dot);
+}
+
 template <typename T>
 static void DispatchCUDAShuffle(const TVMArgs& args, TVMRetValue* rv) {
   PrimExpr e = args[0];
@@ -182,6 +197,8 @@ TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.tvm_warp_activemask")
 
 TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.fmod").set_body(DispatchPureExtern<CUDAMath>);
 
+TVM_REGISTER_GLOBAL("tvm.intrin.rule.cuda.dp4a").set_body(DispatchCUDADP4A);
+
 // Register low-level builtin ops.
 // TODO(tvm-team): consider make CUDA its own subfolder and create a file for low-level builtins.
 TVM_REGISTER_OP("tir.cuda.__shfl_sync")
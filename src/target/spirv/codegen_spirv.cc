@@ -322,6 +322,27 @@ spirv::Value CodeGenSPIRV::VisitExpr_(const CallNode* op) {
   } else if (op->op.same_as(builtin::popcount())) {
     return builder_->MakeValue(spv::OpBitCount, builder_->GetSType(op->dtype),
                                MakeValue(op->args[0]));
+  } else if (op->op.same_as(builtin::tvm_warp_activemask())) {
+    // Subgroup operations take no mask, all the invocations take part.
+    return builder_->UIntImm(builder_->GetSType(op->dtype), 0xFFFFFFFF);
+  } else if (op->op.same_as(builtin::tvm_warp_shuffle()) ||
+             op->op.same_as(builtin::tvm_warp_shuffle_down())) {
+    // (mask, value, lane or delta, width, warp_size), within segments of width invocations.
+    CHECK_EQ(op->args.size(), 5U);
+    spirv::Value value = MakeValue(op->args[1]);
+    spirv::Value arg = MakeValue(op->args[2]);
+    spirv::Value width = MakeValue(op->args[3]);
+    spirv::Value id = builder_->GetSubgroupLocalID();
+    spirv::Value pos = builder_->Mod(id, width);
+    spirv::Value index;
+    if (op->op.same_as(builtin::tvm_warp_shuffle())) {
+      index = builder_->Add(builder_->Sub(id, pos), builder_->Mod(arg, width));
+    } else {
+      // an invocation past the end of its segment keeps its own value.
+      index = builder_->Select(builder_->LT(builder_->Add(pos, arg), width),
+                               builder_->Add(id, arg), id);
+    }
+    return builder_->SubgroupShuffle(value, index);
   } else {
     LOG(FATAL) << "Unresolved call  " << op->op;
     return spirv::Value();
@@ -352,12 +373,11 @@ spirv::Value CodeGenSPIRV::VisitExpr_(const BroadcastNode* op) {
 }
 
 spirv::Value CodeGenSPIRV::VisitExpr_(const LoadNode* op) {
-  CHECK(is_one(op->predicate));
   auto it = storage_info_.find(op->buffer_var.get());
   CHECK(it != storage_info_.end());
   StorageInfo& info = it->second;
   if (!info.content_fixed) {
-    info.UpdateContentType(op->dtype);
+    info.UpdateContentType(is_one(op->predicate) ? op->dtype : op->dtype.element_of());
   }
 
   spirv::SType content_type = builder_->GetSType(info.content_type);
@@ -368,6 +388,19 @@ spirv::Value CodeGenSPIRV::VisitExpr_(const LoadNode* op) {
   if (info.is_volatile) {
     mask |= spv::MemoryAccessVolatileMask;
   }
+  if (!is_one(op->predicate)) {
+    CHECK_EQ(info.content_type, op->dtype.element_of())
+        << "Masked vector access needs a scalar content type in SPIRV";
+    // Load each lane under its own branch, the masked-off lanes read zero.
+    spirv::Value zero = MakeValue(make_zero(info.content_type));
+    std::vector<spirv::Value> values;
+    auto f = [&](int i, spirv::Value index) {
+      spirv::Value ptr = builder_->StructArrayAccess(ptr_type, buffer, index);
+      return builder_->MakeValue(spv::OpLoad, content_type, ptr, mask);
+    };
+    this->ScalarizeMasked(op->predicate, op->index, f, &zero, &values);
+    return builder_->Concat(values);
+  }
   if (op->dtype.lanes() == 1) {
     CHECK_EQ(info.content_type, op->dtype)
         << "Vulkan only allow one type access to the same buffer";
@@ -419,14 +452,42 @@ void CodeGenSPIRV::Scalarize(const PrimExpr& e, std::function<void(int i, spirv:
   }
 }
 
+void CodeGenSPIRV::ScalarizeMasked(const PrimExpr& predicate, const PrimExpr& index,
+                                   std::function<spirv::Value(int i, spirv::Value v)> f,
+                                   const spirv::Value* masked_value,
+                                   std::vector<spirv::Value>* values) {
+  spirv::Value pred = MakeValue(predicate);
+  spirv::SType bool_type = builder_->GetSType(DataType::UInt(1));
+  auto lane = [&](int i, spirv::Value v) {
+    spirv::Value cond = builder_->MakeValue(spv::OpCompositeExtract, bool_type, pred, i);
+    spirv::Label init_label = builder_->CurrentLabel();
+    spirv::Label then_label = builder_->NewLabel();
+    spirv::Label merge_label = builder_->NewLabel();
+    builder_->MakeInst(spv::OpSelectionMerge, merge_label, spv::SelectionControlMaskNone);
+    builder_->MakeInst(spv::OpBranchConditional, cond, then_label, merge_label);
+    builder_->StartLabel(then_label);
+    spirv::Value value = f(i, v);
+    spirv::Label value_label = builder_->CurrentLabel();
+    builder_->MakeInst(spv::OpBranch, merge_label);
+    builder_->StartLabel(merge_label);
+    if (masked_value != nullptr) {
+      spirv::PhiValue phi = builder_->MakePhi(masked_value->stype, 2);
+      phi.SetIncoming(0, value, value_label);
+      phi.SetIncoming(1, *masked_value, init_label);
+      values->push_back(phi);
+    }
+  };
+  this->Scalarize(index, lane);
+}
+
 void CodeGenSPIRV::VisitStmt_(const StoreNode* op) {
-  CHECK(is_one(op->predicate));
   auto it = storage_info_.find(op->buffer_var.get());
   CHECK(it != storage_info_.end());
   StorageInfo& info = it->second;
 
   if (!info.content_fixed) {
-    info.UpdateContentType(op->value.dtype());
+    info.UpdateContentType(is_one(op->predicate) ? op->value.dtype()
+                                                 : op->value.dtype().element_of());
   }
 
   spirv::SType content_type = builder_->GetSType(info.content_type);
@@ -439,6 +500,19 @@ void CodeGenSPIRV::VisitStmt_(const StoreNode* op) {
     mask |= spv::MemoryAccessVolatileMask;
   }
 
+  if (!is_one(op->predicate)) {
+    CHECK_EQ(info.content_type, op->value.dtype().element_of())
+        << "Masked vector access needs a scalar content type in SPIRV";
+    // Store each lane under its own branch.
+    auto f = [&](int i, spirv::Value index) {
+      spirv::Value elem = builder_->MakeValue(spv::OpCompositeExtract, content_type, value, i);
+      spirv::Value ptr = builder_->StructArrayAccess(ptr_type, buffer, index);
+      builder_->MakeInst(spv::OpStore, ptr, elem, mask);
+      return elem;
+    };
+    this->ScalarizeMasked(op->predicate, op->index, f, nullptr, nullptr);
+    return;
+  }
   if (op->value.dtype().lanes() == 1) {
     CHECK_EQ(info.content_type, op->value.dtype())
         << "Vulkan only allow one type access to the same buffer";
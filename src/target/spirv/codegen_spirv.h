@@ -129,6 +129,11 @@ class CodeGenSPIRV : public ExprFunctor<spirv::Value(const PrimExpr&)>,
   spirv::Value GetThreadIndex(const IterVar& iv, const PrimExpr& extent);
   spirv::Value CreateStorageSync(const CallNode* op);
   void Scalarize(const PrimExpr& e, std::function<void(int i, spirv::Value v)> f);
+  // Scalarize a masked access, running f for each lane in a branch taken when the lane of
+  // predicate is set. Collect the results in values, masked_value in the masked-off lanes.
+  void ScalarizeMasked(const PrimExpr& predicate, const PrimExpr& index,
+                       std::function<spirv::Value(int i, spirv::Value v)> f,
+                       const spirv::Value* masked_value, std::vector<spirv::Value>* values);
   // The builder
   std::unique_ptr<spirv::IRBuilder> builder_;
   // Work group size of three
@@ -47,7 +47,7 @@ void IRBuilder::InitHeader() {
   // Schema: reserved
   header_.push_back(0U);
   // shader
-  ib_.Begin(spv::OpCapability).Add(spv::CapabilityShader).Commit(&header_);
+  this->AddCapability(spv::CapabilityShader);
   // memory model
   ib_.Begin(spv::OpMemoryModel)
       .AddSeq(spv::AddressingModelLogical, spv::MemoryModelGLSL450)
@@ -251,6 +251,9 @@ void IRBuilder::CommitKernelFunction(const Value& func, const std::string& name)
   if (local_id_.id != 0) {
     ib_.Add(local_id_);
   }
+  if (subgroup_local_id_.id != 0) {
+    ib_.Add(subgroup_local_id_);
+  }
   ib_.Commit(&entry_);
 }
 
@@ -316,6 +319,43 @@ Value IRBuilder::GetLocalID(uint32_t dim_index) {
   return this->MakeValue(spv::OpLoad, t_int32_, ptr);
 }
 
+void IRBuilder::AddCapability(spv::Capability capability) {
+  if (capabilities_.insert(static_cast<uint32_t>(capability)).second) {
+    ib_.Begin(spv::OpCapability).Add(capability).Commit(&header_);
+  }
+}
+
+Value IRBuilder::GetSubgroupLocalID() {
+#if SPV_VERSION >= 0x10300
+  if (subgroup_local_id_.id == 0) {
+    SType ptr_type = this->GetPointerType(t_int32_, spv::StorageClassInput);
+    subgroup_local_id_ = NewValue(ptr_type, kNormal);
+    ib_.Begin(spv::OpVariable)
+        .AddSeq(ptr_type, subgroup_local_id_, spv::StorageClassInput)
+        .Commit(&global_);
+    this->Decorate(spv::OpDecorate, subgroup_local_id_, spv::DecorationBuiltIn,
+                   spv::BuiltInSubgroupLocalInvocationId);
+    this->AddCapability(spv::CapabilityGroupNonUniform);
+  }
+  return this->MakeValue(spv::OpLoad, t_int32_, subgroup_local_id_);
+#else
+  LOG(FATAL) << "Subgroup operations require SPIR-V 1.3";
+  return Value();
+#endif
+}
+
+Value IRBuilder::SubgroupShuffle(Value value, Value index) {
+#if SPV_VERSION >= 0x10300
+  this->AddCapability(spv::CapabilityGroupNonUniform);
+  this->AddCapability(spv::CapabilityGroupNonUniformShuffle);
+  Value scope = UIntImm(t_uint32_, spv::ScopeSubgroup);
+  return this->MakeValue(spv::OpGroupNonUniformShuffle, value.stype, scope, value, index);
+#else
+  LOG(FATAL) << "Subgroup operations require SPIR-V 1.3";
+  return Value();
+#endif
+}
+
 Value IRBuilder::GetConst_(const SType& dtype, const uint64_t* pvalue) {
   auto key = std::make_pair(dtype.id, pvalue[0]);
   auto it = const_tbl_.find(key);
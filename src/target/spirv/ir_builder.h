@@ -32,6 +32,7 @@
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <spirv.hpp>
@@ -278,7 +279,7 @@ class IRBuilder {
    */
   Value ExtInstImport(const std::string& name) {
     Value val = NewValue(SType(), kExtInst);
-    ib_.Begin(spv::OpExtInstImport).AddSeq(val, name).Commit(&header_);
+    ib_.Begin(spv::OpExtInstImport).AddSeq(val, name).Commit(&extended_instruction_set_);
     return val;
   }
   /*!
@@ -291,6 +292,7 @@ class IRBuilder {
     const int kBoundLoc = 3;
     header_[kBoundLoc] = id_counter_;
     data.insert(data.end(), header_.begin(), header_.end());
+    data.insert(data.end(), extended_instruction_set_.begin(), extended_instruction_set_.end());
     data.insert(data.end(), entry_.begin(), entry_.end());
     data.insert(data.end(), exec_mode_.begin(), exec_mode_.end());
     data.insert(data.end(), debug_.begin(), debug_.end());
@@ -529,6 +531,23 @@ class IRBuilder {
    * \return The value representing the local id.
    */
   Value GetLocalID(uint32_t dim_index);
+  /*!
+   * \brief Declare a capability the module requires, once.
+   * \param capability The capability.
+   */
+  void AddCapability(spv::Capability capability);
+  /*
+   * \brief Get the index of the invocation within its subgroup.
+   * \return The value representing the subgroup local id.
+   */
+  Value GetSubgroupLocalID();
+  /*!
+   * \brief Read a value of another invocation of the subgroup.
+   * \param value The value to read.
+   * \param index The subgroup local id of the invocation to read from.
+   * \return The value of that invocation.
+   */
+  Value SubgroupShuffle(Value value, Value index);
   // Expressions
   Value Add(Value a, Value b);
   Value Sub(Value a, Value b);
@@ -571,8 +590,10 @@ class IRBuilder {
   SType t_bool_, t_int32_, t_uint32_, t_fp32_, t_void_, t_void_func_;
   /*! \brief quick cache for const one i32 */
   Value const_i32_zero_;
-  /*! \brief cache value for workgroup_id, local_id */
-  Value workgroup_id_, local_id_;
+  /*! \brief cache value for workgroup_id, local_id, subgroup_local_id */
+  Value workgroup_id_, local_id_, subgroup_local_id_;
+  /*! \brief The capabilities declared */
+  std::unordered_set<uint32_t> capabilities_;
   /*! \brief whether push constant is defined */
   Value push_const_;
   /*! \brief map from type code to the type */
@@ -585,6 +606,8 @@ class IRBuilder {
   std::map<std::pair<uint32_t, uint64_t>, Value> const_tbl_;
   /*! \brief Header segment, include import */
   std::vector<uint32_t> header_;
+  /*! \brief Extended instruction set imports */
+  std::vector<uint32_t> extended_instruction_set_;
   /*! \brief engtry point segment */
   std::vector<uint32_t> entry_;
   /*! \brief Header segment */
@@ -72,6 +72,8 @@ TVM_REGISTER_TARGET_KIND("llvm")
     .add_attr_option<Array<String>>("mattr")
     .add_attr_option<String>("mtriple")
     .add_attr_option<String>("mfloat-abi")
+    .add_attr_option<String>("jit")
+    .add_attr_option<Array<String>>("isa-variants")
     .set_default_keys({"cpu"})
     .set_device_type(kDLCPU);
 
@@ -82,6 +84,7 @@ TVM_REGISTER_TARGET_KIND("c")
     .add_attr_option<String>("model")
     .add_attr_option<Bool>("system-lib")
     .add_attr_option<String>("runtime")
+    .add_attr_option<String>("simd")
     .set_default_keys({"cpu"})
     .set_device_type(kDLCPU);
 
@@ -148,6 +151,7 @@ TVM_REGISTER_TARGET_KIND("vulkan")
     .add_attr_option<String>("model")
     .add_attr_option<Bool>("system-lib")
     .add_attr_option<Integer>("max_num_threads", Integer(256))
+    .add_attr_option<Integer>("thread_warp_size", Integer(1))
     .set_default_keys({"vulkan", "gpu"})
     .set_device_type(kDLVulkan);
 
@@ -130,6 +130,29 @@ TVM_DLL arith::IntConstraintsTransform SimplifyDomain(const arith::IntConstraint
 TVM_DLL Tensor RemoveJacobianAndLiftNonzeroCond(const Tensor& tensor,
                                                 const Map<Var, Range>& vranges = Map<Var, Range>());
 
+/*!
+ * \brief Check whether a combiner is a sum.
+ * \param combiner The combiner.
+ * \param vranges Optional map from free variables to their value ranges.
+ */
+bool IsSumCombiner(const CommReducer& combiner, const Map<Var, Range>& vranges);
+
+/*!
+ * \brief Multiply \p head by the Jacobian of \p output wrt \p input without forming the Jacobian.
+ *
+ *  This works when \p output is an element-wise expression or a sum, and all accesses to
+ *  \p input use the same indices, each of which is a different iteration variable ranging over the
+ *  whole dimension (e.g. dense, matmul, transpose, broadcast). The adjoint is then a sum of
+ *  \p head times the local derivative over the iteration variables that do not index \p input.
+ *
+ * \param output The tensor to differentiate.
+ * \param input The input tensor, which \p output should directly use.
+ * \param head The adjoint of \p output, of shape `prefix + output.shape`.
+ * \return The tensor of shape `prefix + input.shape`, or an undefined tensor if \p output does
+ *  not match the pattern.
+ */
+Tensor DirectVectorJacobianProduct(const Tensor& output, const Tensor& input, const Tensor& head);
+
 }  // namespace te
 }  // namespace tvm
 #endif  // TVM_TE_AUTODIFF_AD_UTIL_H_
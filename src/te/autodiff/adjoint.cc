@@ -62,6 +62,12 @@ Tensor Identity(const Tensor& output) {
 }
 
 Tensor VectorJacobianProduct(const Tensor& output, const Tensor& input, const Tensor& head) {
+  // Sums over accesses indexed by plain loop variables don't need the Jacobian, whose
+  // simplification is slow and may leave large intermediate bodies behind.
+  Tensor direct = DirectVectorJacobianProduct(output, input, head);
+  if (direct.defined()) {
+    return direct;
+  }
   Tensor jac = Jacobian(output, input);
   Tensor result = topi::tensordot(head, jac, /*axes=*/output->shape.size(),
                                   output->op->name + "." + input->op->name + ".grad");
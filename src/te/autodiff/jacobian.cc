@@ -26,8 +26,10 @@
 #include <tvm/arith/analyzer.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/te/autodiff.h>
+#include <tvm/tir/analysis.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "ad_util.h"
@@ -361,5 +363,101 @@ Tensor Jacobian(const Tensor& output, const Tensor& input) {
   return ret;
 }
 
+Tensor DirectVectorJacobianProduct(const Tensor& output, const Tensor& input, const Tensor& head) {
+  const ComputeOpNode* op = output->op.as<ComputeOpNode>();
+  if (op == nullptr) return Tensor();
+  PrimExpr source = op->body[output->value_index];
+  Array<IterVar> reduce_axis;
+  if (const ReduceNode* red = source.as<ReduceNode>()) {
+    if (red->source.size() != 1 || !is_one(red->condition) ||
+        !IsSumCombiner(red->combiner, Map<Var, Range>())) {
+      return Tensor();
+    }
+    source = red->source[0];
+    reduce_axis = red->axis;
+  }
+
+  std::unordered_map<const VarNode*, IterVar> loop_vars;
+  for (const IterVar& iv : op->axis) {
+    loop_vars[iv->var.get()] = iv;
+  }
+  for (const IterVar& iv : reduce_axis) {
+    loop_vars[iv->var.get()] = iv;
+  }
+
+  // All accesses to the input must use the same indices
+  Array<PrimExpr> access;
+  bool same_access = true;
+  PostOrderVisit(source, [&](const ObjectRef& node) {
+    if (const ProducerLoadNode* load = node.as<ProducerLoadNode>()) {
+      if (Downcast<Tensor>(load->producer) == input) {
+        if (!access.defined()) {
+          access = load->indices;
+        } else if (!std::equal(access.begin(), access.end(), load->indices.begin(),
+                               tir::ExprDeepEqual())) {
+          same_access = false;
+        }
+      }
+    }
+  });
+  if (!same_access || !access.defined()) return Tensor();
+
+  // Each index must be a different loop variable ranging over the whole input dimension
+  arith::Analyzer analyzer;
+  Array<IterVar> new_axis;
+  Map<Var, PrimExpr> vmap;
+  size_t prefix_ndim = head->shape.size() - output->shape.size();
+  Array<PrimExpr> head_indices;
+  for (size_t i = 0; i < prefix_ndim; ++i) {
+    IterVar new_v = IterVar(Range(0, head->shape[i]), Var("prefix" + std::to_string(i)),
+                            IterVarType::kDataPar);
+    new_axis.push_back(new_v);
+    head_indices.push_back(new_v);
+  }
+  for (size_t i = 0; i < access.size(); ++i) {
+    const VarNode* var = access[i].as<VarNode>();
+    if (var == nullptr || !loop_vars.count(var) || vmap.count(GetRef<Var>(var))) {
+      return Tensor();
+    }
+    const Range& dom = loop_vars.at(var)->dom;
+    if (!is_zero(dom->min) || !analyzer.CanProve(dom->extent == input->shape[i])) {
+      return Tensor();
+    }
+    IterVar new_v = IterVar(Range(0, input->shape[i]), GetRef<Var>(var).copy_with_suffix(""),
+                            IterVarType::kDataPar);
+    new_axis.push_back(new_v);
+    vmap.Set(GetRef<Var>(var), new_v->var);
+  }
+
+  // The other loop variables are summed over
+  Array<IterVar> new_reduce_axis;
+  auto add_reduce_axis = [&new_reduce_axis, &vmap](const IterVar& iv) {
+    if (!vmap.count(iv->var)) {
+      IterVar new_v = IterVar(iv->dom, iv->var.copy_with_suffix(""), IterVarType::kCommReduce);
+      new_reduce_axis.push_back(new_v);
+      vmap.Set(iv->var, new_v->var);
+    }
+  };
+  for (const IterVar& iv : op->axis) {
+    add_reduce_axis(iv);
+  }
+  for (const IterVar& iv : reduce_axis) {
+    add_reduce_axis(iv);
+  }
+  for (const IterVar& iv : op->axis) {
+    head_indices.push_back(vmap.at(iv->var));
+  }
+
+  PrimExpr derivative = analyzer.Simplify(Jacobian(source, input, access));
+  PrimExpr new_body = Mul(head(head_indices), Substitute(derivative, vmap));
+  if (!new_reduce_axis.empty()) {
+    new_body = sum(new_body, new_reduce_axis);
+  }
+
+  auto new_op = ComputeOp(output->op->name + "." + input->op->name + ".grad", op->tag, op->attrs,
+                          new_axis, {new_body});
+  return new_op.output(0);
+}
+
 }  // namespace te
 }  // namespace tvm
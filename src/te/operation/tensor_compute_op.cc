@@ -114,6 +114,7 @@ void TensorComputeOpNode::PropBoundToInputs(
     const Operation& self, arith::Analyzer* analyzer,
     const std::unordered_map<const VarNode*, IntSet>& dom_map,
     std::unordered_map<Tensor, TensorDom>* out_dom_map) const {
+  arith::RegionEvaluator evaluator(dom_map, analyzer);
   for (size_t i = 0; i < this->inputs.size(); ++i) {
     Tensor t = this->inputs[i];
     Region region = input_regions[i];
@@ -122,7 +123,7 @@ void TensorComputeOpNode::PropBoundToInputs(
     if (it == out_dom_map->end()) continue;
     TensorDom& dom = it->second;
     for (size_t j = 0; j < t.ndim(); ++j) {
-      dom.data[j].emplace_back(EvalSet(region[j], dom_map));
+      dom.data[j].emplace_back(evaluator.Eval(region[j]));
     }
   }
 }
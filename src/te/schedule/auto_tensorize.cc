@@ -0,0 +1,199 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_tensorize.cc
+ * \brief Find and apply the loop transformations that let a stage be tensorized.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/te/operation.h>
+#include <tvm/te/schedule_pass.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_map>
+
+namespace tvm {
+namespace te {
+
+using namespace tir;
+
+/*!
+ * \brief Rewrite the body of a compute operation the way tensorize sees it inside the tensorized
+ *  region: the matched axes become the offset of the region plus the intrinsic's axes, and the
+ *  inputs become the intrinsic's inputs, indexed relative to the start of their region.
+ */
+class TensorIntrinBodyRewriter : public ExprMutator {
+ public:
+  bool Init(const ComputeOpNode* self, const TensorIntrin& intrin) {
+    const ComputeOpNode* intrin_compute = intrin->op.as<ComputeOpNode>();
+    if (intrin_compute == nullptr || self->body.size() != intrin_compute->body.size()) {
+      return false;
+    }
+    Array<Tensor> inputs = self->InputTensors();
+    if (inputs.size() != intrin->inputs.size()) return false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (inputs[i]->dtype != intrin->inputs[i]->dtype ||
+          inputs[i].ndim() < intrin->inputs[i].ndim()) {
+        return false;
+      }
+      in_remap_[inputs[i]] = intrin->inputs[i];
+    }
+    return MapAxes(self->axis, intrin_compute->axis) &&
+           MapAxes(self->reduce_axis, intrin_compute->reduce_axis);
+  }
+
+  PrimExpr VisitExpr_(const VarNode* op) final {
+    auto it = var_remap_.find(op);
+    return it != var_remap_.end() ? it->second : GetRef<PrimExpr>(op);
+  }
+
+  PrimExpr VisitExpr_(const ProducerLoadNode* op) final {
+    Tensor t = Downcast<Tensor>(op->producer);
+    auto it = in_remap_.find(t);
+    if (it == in_remap_.end()) {
+      matched_ = false;
+      return GetRef<PrimExpr>(op);
+    }
+    const Tensor& target = it->second;
+    size_t start = op->indices.size() - target.ndim();
+    Array<PrimExpr> indices;
+    for (size_t i = 0; i < op->indices.size(); ++i) {
+      // The region of the input starts where all the intrinsic's axes are zero.
+      PrimExpr index = analyzer_.Simplify(Substitute(op->indices[i], var_remap_) -
+                                          Substitute(op->indices[i], offset_remap_));
+      if (i < start) {
+        // The leading dimensions are outside of the intrinsic's inputs.
+        if (!is_zero(index)) matched_ = false;
+      } else {
+        indices.push_back(index);
+      }
+    }
+    return ProducerLoad(target, indices);
+  }
+
+  PrimExpr VisitExpr_(const ReduceNode* op) final {
+    PrimExpr expr = ExprMutator::VisitExpr_(op);
+    op = expr.as<ReduceNode>();
+    Array<IterVar> axis;
+    for (const IterVar& iv : op->axis) {
+      auto it = axis_remap_.find(iv);
+      if (it != axis_remap_.end()) {
+        axis.push_back(it->second);
+      }
+    }
+    return Reduce(op->combiner, op->source, axis, op->condition, op->value_index);
+  }
+
+  /*! \brief Whether the rewritten body can still match. */
+  bool matched_{true};
+  /*! \brief The analyzer, with the ranges of the intrinsic's axes. */
+  arith::Analyzer analyzer_;
+
+ private:
+  bool MapAxes(const Array<IterVar>& axes, const Array<IterVar>& intrin_axes) {
+    if (axes.size() < intrin_axes.size()) return false;
+    size_t start = axes.size() - intrin_axes.size();
+    for (size_t i = 0; i < axes.size(); ++i) {
+      const IterVar& iv = axes[i];
+      Var offset = iv->var.copy_with_suffix(".offset");
+      offset_remap_[iv->var.get()] = offset;
+      if (i < start) {
+        var_remap_[iv->var.get()] = offset;
+        continue;
+      }
+      const IterVar& target = intrin_axes[i - start];
+      const int64_t* extent = as_const_int(iv->dom->extent);
+      const int64_t* intrin_extent = as_const_int(target->dom->extent);
+      if (!is_zero(iv->dom->min) || !is_zero(target->dom->min) || extent == nullptr ||
+          intrin_extent == nullptr || *intrin_extent <= 0 || *extent % *intrin_extent != 0) {
+        return false;
+      }
+      var_remap_[iv->var.get()] = offset + target->var;
+      axis_remap_[iv] = target;
+      analyzer_.Bind(target->var, target->dom);
+    }
+    return true;
+  }
+
+  std::unordered_map<Tensor, Tensor> in_remap_;
+  std::unordered_map<const VarNode*, PrimExpr> var_remap_;
+  std::unordered_map<const VarNode*, PrimExpr> offset_remap_;
+  std::unordered_map<IterVar, IterVar> axis_remap_;
+};
+
+bool MatchTensorIntrin(const Operation& op, const TensorIntrin& intrin) {
+  const ComputeOpNode* self = op.as<ComputeOpNode>();
+  if (self == nullptr) return false;
+  TensorIntrinBodyRewriter rewriter;
+  if (!rewriter.Init(self, intrin)) return false;
+  const ComputeOpNode* intrin_compute = intrin->op.as<ComputeOpNode>();
+  StructuralEqual expr_equal;
+  for (size_t i = 0; i < self->body.size(); ++i) {
+    PrimExpr lhs = rewriter.analyzer_.Simplify(rewriter(self->body[i]));
+    if (!rewriter.matched_) return false;
+    PrimExpr rhs = rewriter.analyzer_.Simplify(intrin_compute->body[i]);
+    if (lhs.dtype() != rhs.dtype() || !expr_equal(lhs, rhs)) return false;
+  }
+  return true;
+}
+
+bool AutoTensorize(Schedule sch, const Operation& op, const TensorIntrin& intrin) {
+  Stage stage = sch[op];
+  if (!stage->relations.empty() || !MatchTensorIntrin(stage->op, intrin)) return false;
+  const ComputeOpNode* self = stage->op.as<ComputeOpNode>();
+  const ComputeOpNode* intrin_compute = intrin->op.as<ComputeOpNode>();
+
+  Array<IterVar> outer, inner;
+  auto split_axes = [&](const Array<IterVar>& axes, const Array<IterVar>& intrin_axes) {
+    size_t start = axes.size() - intrin_axes.size();
+    for (size_t i = 0; i < axes.size(); ++i) {
+      if (i < start) {
+        outer.push_back(axes[i]);
+      } else if (*as_const_int(axes[i]->dom->extent) ==
+                 *as_const_int(intrin_axes[i - start]->dom->extent)) {
+        inner.push_back(axes[i]);
+      } else {
+        IterVar xo, xi;
+        stage.split(axes[i], intrin_axes[i - start]->dom->extent, &xo, &xi);
+        outer.push_back(xo);
+        inner.push_back(xi);
+      }
+    }
+  };
+  split_axes(self->axis, intrin_compute->axis);
+  split_axes(self->reduce_axis, intrin_compute->reduce_axis);
+  if (inner.empty()) return false;
+
+  Array<IterVar> order = outer;
+  for (const IterVar& iv : inner) {
+    order.push_back(iv);
+  }
+  stage.reorder(order);
+  stage.tensorize(inner[0], intrin);
+  return true;
+}
+
+TVM_REGISTER_GLOBAL("schedule.MatchTensorIntrin").set_body_typed(MatchTensorIntrin);
+
+TVM_REGISTER_GLOBAL("schedule.AutoTensorize").set_body_typed(AutoTensorize);
+
+}  // namespace te
+}  // namespace tvm
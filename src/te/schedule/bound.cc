@@ -24,7 +24,11 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule_pass.h>
+#include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+#include <functional>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -204,7 +208,250 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
   stage->op->GatherBound(stage->op, tmap, rmap);
 }
 
-Map<IterVar, Range> InferBound(const Schedule& sch) {
+// Infer the bound of the root iter vars of a stage and pass them down to the other iter vars.
+void InferStageBound(const Stage& stage, const GraphContext& ctx,
+                     std::unordered_map<IterVar, Range>* rmap, arith::Analyzer* analyzer) {
+  InferRootBound(stage, ctx, rmap);
+
+  // bind bound of root iter vars.
+  for (auto iv : stage->op->root_iter_vars()) {
+    auto it = rmap->find(iv);
+    if (it != rmap->end()) {
+      analyzer->Bind(iv->var, it->second);
+    }
+  }
+
+  // pass down to get bound of all iter vars.
+  PassDownDomain(stage, rmap, analyzer);
+  for (IterVar iv : stage->env_threads) {
+    CHECK(iv->dom.defined());
+    (*rmap)[iv] = iv->dom;
+  }
+}
+
+/*!
+ * \brief Visit the iter vars whose bounds a stage decides, together with their slots.
+ *  The slots are the index in all_iter_vars, then the thread bound to each of them,
+ *  then the index in env_threads.
+ */
+void ForEachSlot(const Stage& stage, const std::function<void(const IterVar&, int)>& fvisit) {
+  int num_iter_vars = static_cast<int>(stage->all_iter_vars.size());
+  for (int i = 0; i < num_iter_vars; ++i) {
+    fvisit(stage->all_iter_vars[i], i);
+  }
+  for (int i = 0; i < num_iter_vars; ++i) {
+    auto it = stage->iter_var_attrs.find(stage->all_iter_vars[i]);
+    if (it != stage->iter_var_attrs.end() && (*it).second->bind_thread.defined()) {
+      fvisit((*it).second->bind_thread, num_iter_vars + i);
+    }
+  }
+  for (size_t i = 0; i < stage->env_threads.size(); ++i) {
+    fvisit(stage->env_threads[i], 2 * num_iter_vars + static_cast<int>(i));
+  }
+}
+
+// Print what decides the bounds of an operation, return false if that is not its structure.
+bool PrintOpStructure(const Operation& op, std::ostream& os) {
+  if (const auto* compute = op.as<ComputeOpNode>()) {
+    os << "compute " << compute->name;
+    for (const IterVar& iv : compute->axis) {
+      os << ' ' << iv->var << ' ' << iv->dom;
+    }
+    for (const IterVar& iv : compute->reduce_axis) {
+      os << " reduce " << iv->var << ' ' << iv->dom;
+    }
+    for (const PrimExpr& e : compute->body) {
+      os << ' ' << e;
+    }
+    return true;
+  }
+  if (const auto* placeholder = op.as<PlaceholderOpNode>()) {
+    os << "placeholder " << placeholder->name << ' ' << placeholder->shape << ' '
+       << placeholder->dtype;
+    return true;
+  }
+  return false;
+}
+
+/*!
+ * \brief Compute the cache key of every suffix of the stages.
+ *
+ *  The key of a suffix describes its first stage and the key of the rest of the suffix, so equal
+ *  keys mean InferBound computes the same bounds for the first stage, up to the iter vars. The
+ *  iter vars are identified by slot variables of the cache; `to_slot` and `from_slot` map the
+ *  variables of this schedule to the slot variables and back.
+ *
+ * \return false if the schedule has stages the key cannot describe.
+ */
+bool MakeSuffixKeys(const Schedule& sch, const GraphContext& ctx, InferBoundCache* cache,
+                    std::vector<std::string>* keys,
+                    std::unordered_map<const VarNode*, PrimExpr>* to_slot,
+                    std::unordered_map<const VarNode*, PrimExpr>* from_slot) {
+  if (sch->groups.size() != 0) return false;
+  size_t num_stages = sch->stages.size();
+  keys->resize(num_stages);
+  // The rank of the visited stages and their operations, counted from the last stage.
+  std::unordered_map<const Object*, int> rank_of;
+  std::vector<std::unordered_map<const Object*, int>> slots_of(num_stages);
+  size_t rest_hash = 0;
+  for (size_t rank = 0; rank < num_stages; ++rank) {
+    const Stage& stage = sch->stages[num_stages - 1 - rank];
+    std::ostringstream os;
+    if (!PrintOpStructure(stage->op, os)) return false;
+
+    std::unordered_map<const Object*, int>& slots = slots_of[rank];
+    ForEachSlot(stage, [&](const IterVar& iv, int slot) {
+      slots.emplace(iv.get(), slot);
+      os << " [" << slot << ' ' << iv->iter_type << ' ' << iv->thread_tag << ' '
+         << iv->var.dtype();
+      if (iv->dom.defined()) {
+        os << ' ' << iv->dom;
+      }
+      auto it = to_slot->find(iv->var.get());
+      if (it != to_slot->end()) {
+        // The iter var is shared with a stage visited before, e.g. a thread axis.
+        os << " = " << it->second;
+      } else {
+        Var var = cache->SlotVar(static_cast<int>(rank), slot, iv->var.dtype());
+        (*to_slot)[iv->var.get()] = var;
+        (*from_slot)[var.get()] = iv->var;
+      }
+      os << ']';
+    });
+    for (IterVarRelation rel : stage->relations) {
+      if (const SplitNode* r = rel.as<SplitNode>()) {
+        os << " split " << slots.at(r->parent.get()) << ' ' << slots.at(r->outer.get()) << ' '
+           << slots.at(r->inner.get()) << ' ' << r->factor << ' ' << r->nparts;
+      } else if (const FuseNode* r = rel.as<FuseNode>()) {
+        os << " fuse " << slots.at(r->outer.get()) << ' ' << slots.at(r->inner.get()) << ' '
+           << slots.at(r->fused.get());
+      } else if (const RebaseNode* r = rel.as<RebaseNode>()) {
+        os << " rebase " << slots.at(r->parent.get()) << ' ' << slots.at(r->rebased.get());
+      } else if (const SingletonNode* r = rel.as<SingletonNode>()) {
+        os << " singleton " << slots.at(r->iter.get());
+      } else {
+        return false;
+      }
+    }
+    os << " leaf";
+    for (const IterVar& iv : stage->leaf_iter_vars) {
+      os << ' ' << slots.at(iv.get());
+    }
+    os << " attach " << stage->attach_type;
+    if (stage->attach_stage.defined()) {
+      auto it = rank_of.find(stage->attach_stage.get());
+      if (it == rank_of.end()) return false;
+      auto jt = slots_of[it->second].find(stage->attach_ivar.get());
+      if (jt == slots_of[it->second].end()) return false;
+      os << ' ' << it->second << ' ' << jt->second;
+    }
+    os << " scope " << stage->scope << " output " << stage->is_output << " consumers";
+    for (int i = 0; i < stage->op->num_outputs(); ++i) {
+      std::vector<int> consumers;
+      auto it = ctx.feed_graph.find(stage->op.output(i));
+      if (it != ctx.feed_graph.end()) {
+        for (const Operation& op : it->second) {
+          auto jt = rank_of.find(op.get());
+          if (jt == rank_of.end()) return false;
+          consumers.push_back(jt->second);
+        }
+      }
+      std::sort(consumers.begin(), consumers.end());
+      os << " (";
+      for (int consumer : consumers) {
+        os << ' ' << consumer;
+      }
+      os << " )";
+    }
+    rank_of[stage.get()] = static_cast<int>(rank);
+    rank_of[stage->op.get()] = static_cast<int>(rank);
+
+    os << " # " << rest_hash;
+    std::string& key = (*keys)[num_stages - 1 - rank];
+    key = os.str();
+    rest_hash = std::hash<std::string>()(key);
+  }
+  return true;
+}
+
+// Collect the bounds a stage contributed to rmap, written in the slot variables.
+InferBoundCache::StageBounds RecordStageBound(
+    const Stage& stage, const std::unordered_map<IterVar, Range>& rmap,
+    const std::unordered_map<const VarNode*, PrimExpr>& to_slot) {
+  InferBoundCache::StageBounds bounds;
+  ForEachSlot(stage, [&](const IterVar& iv, int slot) {
+    auto it = rmap.find(iv);
+    if (it != rmap.end()) {
+      bounds.emplace_back(slot, Range::FromMinExtent(tir::Substitute(it->second->min, to_slot),
+                                                     tir::Substitute(it->second->extent, to_slot)));
+    }
+  });
+  return bounds;
+}
+
+/*!
+ * \brief Replay the cached bounds of a stage, making the same analyzer bindings as
+ *  InferStageBound in the same order.
+ */
+void ReplayStageBound(const Stage& stage, const InferBoundCache::StageBounds& bounds,
+                      const std::unordered_map<const VarNode*, PrimExpr>& from_slot,
+                      std::unordered_map<IterVar, Range>* rmap, arith::Analyzer* analyzer) {
+  std::unordered_map<int, IterVar> slot_iter_vars;
+  ForEachSlot(stage, [&](const IterVar& iv, int slot) { slot_iter_vars.emplace(slot, iv); });
+  std::unordered_map<IterVar, Range> cached;
+  for (const auto& kv : bounds) {
+    cached[slot_iter_vars.at(kv.first)] =
+        Range::FromMinExtent(tir::Substitute(kv.second->min, from_slot),
+                             tir::Substitute(kv.second->extent, from_slot));
+  }
+  // Bounds that PassDownDomain binds only when it infers them first.
+  auto bind_new = [&](const IterVar& iv) {
+    auto it = cached.find(iv);
+    if (it == cached.end() || rmap->count(iv)) return;
+    (*rmap)[iv] = it->second;
+    analyzer->Bind(iv->var, it->second);
+  };
+  // Bounds that are assigned without binding.
+  auto assign = [&](const IterVar& iv) {
+    auto it = cached.find(iv);
+    if (it != cached.end()) {
+      (*rmap)[iv] = it->second;
+    }
+  };
+
+  for (auto iv : stage->op->root_iter_vars()) {
+    bind_new(iv);
+  }
+  for (IterVarRelation rel : stage->relations) {
+    if (const SplitNode* r = rel.as<SplitNode>()) {
+      if (r->factor.defined()) {
+        bind_new(r->inner);
+        bind_new(r->outer);
+      } else {
+        bind_new(r->outer);
+        bind_new(r->inner);
+      }
+    } else if (const FuseNode* r = rel.as<FuseNode>()) {
+      assign(r->fused);
+    } else if (const RebaseNode* r = rel.as<RebaseNode>()) {
+      bind_new(r->rebased);
+    } else if (const SingletonNode* s = rel.as<SingletonNode>()) {
+      bind_new(s->iter);
+    }
+  }
+  for (auto kv : stage->iter_var_attrs) {
+    if (kv.second->bind_thread.defined()) {
+      bind_new(kv.second->bind_thread);
+    }
+  }
+  for (IterVar iv : stage->env_threads) {
+    assign(iv);
+  }
+}
+
+Map<IterVar, Range> InferBound(const Schedule& sch) { return InferBound(sch, nullptr); }
+
+Map<IterVar, Range> InferBound(const Schedule& sch, InferBoundCache* cache) {
   // Prepare context
   GraphContext ctx;
   Array<Operation> roots;
@@ -225,25 +472,27 @@ Map<IterVar, Range> InferBound(const Schedule& sch) {
     ctx.op2stage_[stage->op.get()] = stage;
   }
   ctx.attach_path = CreateAttachPath(sch);
+
+  std::vector<std::string> keys;
+  std::unordered_map<const VarNode*, PrimExpr> to_slot, from_slot;
+  if (cache != nullptr && !MakeSuffixKeys(sch, ctx, cache, &keys, &to_slot, &from_slot)) {
+    cache = nullptr;
+  }
   // Run inference.
   std::unordered_map<IterVar, Range> ret;
-  for (size_t i = sch->stages.size(); i != 0; --i) {
-    const Stage& stage = sch->stages[i - 1];
-    InferRootBound(stage, ctx, &ret);
-
-    // bind bound of root iter vars.
-    for (auto iv : stage->op->root_iter_vars()) {
-      auto it = ret.find(iv);
-      if (it != ret.end()) {
-        analyzer.Bind(iv->var, it->second);
-      }
+  size_t i = sch->stages.size();
+  if (cache != nullptr) {
+    // Reuse the bounds of the longest suffix inferred before.
+    InferBoundCache::StageBounds bounds;
+    for (; i != 0 && cache->Lookup(keys[i - 1], &bounds); --i) {
+      ReplayStageBound(sch->stages[i - 1], bounds, from_slot, &ret, &analyzer);
     }
-
-    // pass down to get bound of all iter vars.
-    PassDownDomain(stage, &ret, &analyzer);
-    for (IterVar iv : stage->env_threads) {
-      CHECK(iv->dom.defined());
-      ret[iv] = iv->dom;
+  }
+  for (; i != 0; --i) {
+    const Stage& stage = sch->stages[i - 1];
+    InferStageBound(stage, ctx, &ret, &analyzer);
+    if (cache != nullptr) {
+      cache->Insert(keys[i - 1], RecordStageBound(stage, ret, to_slot));
     }
   }
   for (auto& p : ret) {
@@ -253,7 +502,37 @@ Map<IterVar, Range> InferBound(const Schedule& sch) {
   return Map<IterVar, Range>(ret.begin(), ret.end());
 }
 
-TVM_REGISTER_GLOBAL("schedule.InferBound").set_body_typed(InferBound);
+bool InferBoundCache::Lookup(const std::string& key, StageBounds* bounds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *bounds = it->second;
+  return true;
+}
+
+void InferBoundCache::Insert(const std::string& key, StageBounds bounds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.size() >= max_entries_) {
+    entries_.clear();
+  }
+  entries_[key] = std::move(bounds);
+}
+
+Var InferBoundCache::SlotVar(int rank, int slot, DataType dtype) {
+  std::ostringstream os;
+  os << "slot" << rank << '_' << slot << '_' << dtype;
+  std::string name = os.str();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = slot_vars_.find(name);
+  if (it != slot_vars_.end()) return it->second;
+  Var var(name, dtype);
+  slot_vars_.emplace(name, var);
+  return var;
+}
+
+TVM_REGISTER_GLOBAL("schedule.InferBound").set_body_typed([](const Schedule& sch) {
+  return InferBound(sch);
+});
 
 }  // namespace te
 }  // namespace tvm
@@ -62,6 +62,9 @@ std::string simplify_name(std::string input) {
   }
 }
 
+// The smallest dimension of any supported wmma fragment shape
+constexpr int kMinFragmentDim = 8;
+
 PrimExpr unpack_type_cast(const PrimExpr& input, const DataType& target_type) {
   auto cast = input.as<CastNode>();
   if (cast == nullptr) {
@@ -73,7 +76,7 @@ PrimExpr unpack_type_cast(const PrimExpr& input, const DataType& target_type) {
 }
 
 // MMAMatcher matches C = Cast(A)*Cast(B)+C,
-// where A & B are fp16/int8 local buffers,
+// where A & B are fp16/int8/uint8/int4/uint4/int1 local buffers of the same type,
 // and C is fp32/int32 local buffer.
 class MMAMatcher : public StmtVisitor {
  public:
@@ -173,6 +176,15 @@ class MMAMatcher : public StmtVisitor {
     return true;
   }
 
+  // Check whether the input type has a wmma fragment accumulating into the given type
+  bool check_input_type_(DataType input, DataType accumulator) {
+    if (accumulator == DataType::Float(32)) {
+      return input == DataType::Float(16);
+    }
+    return input == DataType::Int(8) || input == DataType::UInt(8) || input == DataType::Int(4) ||
+           input == DataType::UInt(4) || input == DataType::Int(1);
+  }
+
   // Do the pattern matching
   bool mma_sync_match_(const ProducerStoreNode* op, BufferInfo store_buffer) {
     auto* add = op->value.as<AddNode>();
@@ -196,19 +208,14 @@ class MMAMatcher : public StmtVisitor {
     auto load_a = load_a_expr.as<ProducerLoadNode>();
     BufferInfo buffer_a;
     if (!check_local_buffer_(load_a, &buffer_a) ||
-        !(buffer_a.dtype == DataType::Float(16) || buffer_a.dtype == DataType::Int(8) ||
-          buffer_a.dtype == DataType::UInt(8) || buffer_a.dtype == DataType::Int(4) ||
-          buffer_a.dtype == DataType::UInt(4) || buffer_a.dtype == DataType::Int(1))) {
+        !check_input_type_(buffer_a.dtype, buffer_c.dtype)) {
       return false;
     }
 
     auto load_b_expr = unpack_type_cast(mul->b, buffer_c.dtype);
     auto load_b = load_b_expr.as<ProducerLoadNode>();
     BufferInfo buffer_b;
-    if (!check_local_buffer_(load_b, &buffer_b) ||
-        !(buffer_b.dtype == DataType::Float(16) || buffer_b.dtype == DataType::Int(8) ||
-          buffer_b.dtype == DataType::UInt(8) || buffer_b.dtype == DataType::Int(4) ||
-          buffer_a.dtype == DataType::UInt(4) || buffer_a.dtype == DataType::Int(1))) {
+    if (!check_local_buffer_(load_b, &buffer_b) || buffer_b.dtype != buffer_a.dtype) {
       return false;
     }
 
@@ -333,8 +340,8 @@ class ScheduleAnalyser {
 
     for (auto& mma_sync : mma_sync_) {
       auto& operands = mma_sync.second;
-      auto* load_a = operands[0].as<CallNode>();
-      auto* load_b = operands[1].as<CallNode>();
+      auto* load_a = operands[0].as<ProducerLoadNode>();
+      auto* load_b = operands[1].as<ProducerLoadNode>();
       auto input0 = simplify_name(buf_name_.find(load_a)->second);
       auto input1 = simplify_name(buf_name_.find(load_b)->second);
       auto it0 = matrix_abc_.find(input0);
@@ -444,7 +451,7 @@ class BufferAnalyser : public StmtExprVisitor {
       }
       for (auto i = bi.shape.size() - 1; i + 2 >= bi.shape.size(); --i) {
         const IntImmNode* shape = bi.shape[i].as<IntImmNode>();
-        if (shape == nullptr || shape->value % 16 != 0) {
+        if (shape == nullptr || shape->value % kMinFragmentDim != 0) {
           invalid_ = true;
           return;
         }
@@ -546,7 +553,7 @@ class BufferAnalyser : public StmtExprVisitor {
       }
       for (auto i = bi.shape.size() - 1; i + 2 >= bi.shape.size(); --i) {
         const IntImmNode* shape = bi.shape[i].as<IntImmNode>();
-        if (shape == nullptr || shape->value % 16 != 0) {
+        if (shape == nullptr || shape->value % kMinFragmentDim != 0) {
           invalid_ = true;
           return;
         }
@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file estimate_roofline.cc
+ * \brief Static estimate of the operations and memory traffic of a PrimFunc.
+ */
+#include <tvm/ir/op.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/op_attr_types.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Count the arithmetic operations and the bytes loaded and stored in each
+ *  storage scope, weighted by the trip count of the enclosing loops and threads.
+ *
+ *  Loops with a non-constant extent count once and both branches of a condition
+ *  are counted, so the result is an estimate. Every access counts, no cache reuse
+ *  is modelled: the bytes are the traffic seen by the memory level of the scope.
+ */
+class RooflineEstimator : public StmtExprVisitor {
+ public:
+  Map<String, PrimExpr> Estimate(const PrimFunc& func) {
+    this->VisitStmt(func->body);
+    Map<String, PrimExpr> result;
+    result.Set("flops", FloatImm(DataType::Float(64), flops_));
+    result.Set("int_ops", FloatImm(DataType::Float(64), int_ops_));
+    for (const auto& kv : bytes_) {
+      result.Set("bytes." + kv.first, FloatImm(DataType::Float(64), kv.second));
+    }
+    auto it = bytes_.find("global");
+    double global_bytes = it != bytes_.end() ? it->second : 0;
+    double intensity = global_bytes > 0 ? flops_ / global_bytes : 0;
+    result.Set("arithmetic_intensity", FloatImm(DataType::Float(64), intensity));
+    return result;
+  }
+
+  void VisitStmt_(const ForNode* op) final {
+    double scale = scale_;
+    if (const auto* extent = op->extent.as<IntImmNode>()) {
+      scale_ *= extent->value;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+    scale_ = scale;
+  }
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      double scale = scale_;
+      if (const auto* extent = op->value.as<IntImmNode>()) {
+        scale_ *= extent->value;
+      }
+      StmtExprVisitor::VisitStmt_(op);
+      scale_ = scale;
+      return;
+    }
+    if (op->attr_key == attr::storage_scope) {
+      const auto* buf = op->node.as<VarNode>();
+      const auto* scope = op->value.as<StringImmNode>();
+      if (buf != nullptr && scope != nullptr) {
+        scope_[buf] = scope->value;
+      }
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    AddBytes(op->buffer_var.get(), "", op->dtype);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    AddBytes(op->buffer_var.get(), "", op->value.dtype());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    AddBytes(op->buffer->data.get(), op->buffer->scope, op->dtype);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const BufferStoreNode* op) final {
+    AddBytes(op->buffer->data.get(), op->buffer->scope, op->value.dtype());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+#define TVM_ROOFLINE_COUNT_BINARY(Node)  \
+  void VisitExpr_(const Node* op) final { \
+    CountOp(op->a.dtype());               \
+    StmtExprVisitor::VisitExpr_(op);      \
+  }
+
+  TVM_ROOFLINE_COUNT_BINARY(AddNode);
+  TVM_ROOFLINE_COUNT_BINARY(SubNode);
+  TVM_ROOFLINE_COUNT_BINARY(MulNode);
+  TVM_ROOFLINE_COUNT_BINARY(DivNode);
+  TVM_ROOFLINE_COUNT_BINARY(ModNode);
+  TVM_ROOFLINE_COUNT_BINARY(FloorDivNode);
+  TVM_ROOFLINE_COUNT_BINARY(FloorModNode);
+  TVM_ROOFLINE_COUNT_BINARY(MinNode);
+  TVM_ROOFLINE_COUNT_BINARY(MaxNode);
+  TVM_ROOFLINE_COUNT_BINARY(EQNode);
+  TVM_ROOFLINE_COUNT_BINARY(NENode);
+  TVM_ROOFLINE_COUNT_BINARY(LTNode);
+  TVM_ROOFLINE_COUNT_BINARY(LENode);
+  TVM_ROOFLINE_COUNT_BINARY(GTNode);
+  TVM_ROOFLINE_COUNT_BINARY(GENode);
+
+#undef TVM_ROOFLINE_COUNT_BINARY
+
+  void VisitExpr_(const CallNode* op) final {
+    // Pure calls are math functions such as exp or sqrt, the others are
+    // intrinsics with no arithmetic of their own.
+    if (const auto* pop = op->op.as<OpNode>()) {
+      static auto op_call_effect = Op::GetAttrMap<TCallEffectKind>("TCallEffectKind");
+      CallEffectKind effect = static_cast<CallEffectKind>(
+          op_call_effect.get(GetRef<Op>(pop), Integer(CallEffectKind::kOpaque))->value);
+      if (effect == CallEffectKind::kPure) {
+        CountOp(op->dtype);
+      }
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+ private:
+  void CountOp(DataType dtype) {
+    if (dtype.is_float() || dtype.is_bfloat16()) {
+      flops_ += scale_ * dtype.lanes();
+    } else {
+      int_ops_ += scale_ * dtype.lanes();
+    }
+  }
+
+  void AddBytes(const VarNode* buf, const String& buffer_scope, DataType dtype) {
+    std::string scope = "global";
+    auto it = scope_.find(buf);
+    if (it != scope_.end()) {
+      scope = it->second;
+    } else if (!buffer_scope.empty()) {
+      scope = buffer_scope;
+    }
+    bytes_[scope] += scale_ * dtype.bytes() * dtype.lanes();
+  }
+
+  // The trip count of the current statement.
+  double scale_{1};
+  double flops_{0};
+  double int_ops_{0};
+  // The bytes loaded and stored in each scope.
+  std::map<std::string, double> bytes_;
+  // The scope of the allocated buffers, the others are global.
+  std::unordered_map<const VarNode*, std::string> scope_;
+};
+
+Map<String, PrimExpr> EstimateRoofline(const PrimFunc& func) {
+  return RooflineEstimator().Estimate(func);
+}
+
+TVM_REGISTER_GLOBAL("tir.analysis.estimate_roofline").set_body_typed(EstimateRoofline);
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file global_coalescing.cc
+ * \brief Measure how many global memory accesses of a kernel are coalesced.
+ */
+#include <tvm/arith/pattern.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_set>
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Classify the accesses to global buffers under threadIdx.x by the
+ *  stride of their offset along threadIdx.x. An access is coalesced when
+ *  consecutive threads access the same or consecutive elements.
+ */
+class GlobalCoalescingCounter : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      if (const auto* buf = op->node.as<VarNode>()) {
+        allocated_.insert(buf);
+      }
+    } else if (op->attr_key == attr::thread_extent) {
+      IterVar iv = Downcast<IterVar>(op->node);
+      if (iv->thread_tag == "threadIdx.x") {
+        Var tx = tx_;
+        tx_ = iv->var;
+        StmtExprVisitor::VisitStmt_(op);
+        tx_ = tx;
+        return;
+      }
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    Count(op->buffer_var, op->index);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    Count(op->buffer_var, op->index);
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  int64_t num_accesses{0};
+  int64_t num_coalesced{0};
+
+ private:
+  void Count(const Var& buffer_var, const PrimExpr& index) {
+    if (!tx_.defined() || allocated_.count(buffer_var.get())) return;
+    ++num_accesses;
+    PrimExpr base = index;
+    int lanes = 1;
+    if (const auto* ramp = index.as<RampNode>()) {
+      if (!is_one(ramp->stride)) return;
+      base = ramp->base;
+      lanes = ramp->lanes;
+    }
+    Array<PrimExpr> coeffs = arith::DetectLinearEquation(base, {tx_});
+    if (coeffs.size() != 2) return;
+    const auto* stride = coeffs[0].as<IntImmNode>();
+    if (stride != nullptr && (stride->value == 0 || stride->value == lanes)) {
+      ++num_coalesced;
+    }
+  }
+
+  // the threadIdx.x of the current kernel
+  Var tx_;
+  // the buffers allocated in the function, the others are global
+  std::unordered_set<const VarNode*> allocated_;
+};
+
+double GlobalCoalescingRatio(const PrimFunc& func) {
+  GlobalCoalescingCounter counter;
+  counter(func->body);
+  if (counter.num_accesses == 0) return 1.0;
+  return static_cast<double>(counter.num_coalesced) / counter.num_accesses;
+}
+
+TVM_REGISTER_GLOBAL("tir.analysis.global_coalescing_ratio").set_body_typed(GlobalCoalescingRatio);
+
+}  // namespace tir
+}  // namespace tvm
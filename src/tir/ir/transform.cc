@@ -23,12 +23,18 @@
  */
 #include <tvm/node/repr_printer.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/tir/transform.h>
 
+#include <vector>
+
 namespace tvm {
 namespace tir {
 namespace transform {
 
+// The number of threads PrimFunc passes may use to transform several functions at once.
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.num_func_pass_threads", Integer);
+
 /*!
  * \brief Function level pass that applies transformations to all
  *        TIR functions within the module.
@@ -41,6 +47,13 @@ class PrimFuncPassNode : public PassNode {
   /*! \brief The pass function called on each. */
   runtime::TypedPackedFunc<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func;
 
+  /*!
+   * \brief Whether pass_func can transform several functions concurrently.
+   *  Only set for the passes implemented in C++, a frontend function
+   *  could block on the interpreter lock held by the calling thread.
+   */
+  bool concurrent{false};
+
   void VisitAttrs(tvm::AttrVisitor* v) { v->Visit("pass_info", &pass_info); }
 
   /*!
@@ -60,6 +73,17 @@ class PrimFuncPassNode : public PassNode {
 
   static constexpr const char* _type_key = "tir.PrimFuncPass";
   TVM_DECLARE_FINAL_OBJECT_INFO(PrimFuncPassNode, PassNode);
+
+ private:
+  /*!
+   * \brief Transform the functions of func_dict on num_threads threads.
+   *
+   *  The other functions of the module stay readable by pass_func while it
+   *  runs, so the results are only written back once all are done, in the
+   *  iteration order of the module. The result is the same as the serial one.
+   */
+  void RunConcurrently(MapNode* func_dict, const IRModule& mod, const PassContext& pass_ctx,
+                       int num_threads, std::vector<ObjectRef>* deleted_list) const;
 };
 
 class PrimFuncPass : public Pass {
@@ -68,20 +92,22 @@ class PrimFuncPass : public Pass {
    * \brief The constructor
    * \param pass_func The packed function which implements a pass.
    * \param pass_info The pass info.
+   * \param concurrent Whether pass_func can transform several functions concurrently.
    */
   TVM_DLL PrimFuncPass(
       runtime::TypedPackedFunc<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
-      PassInfo pass_info);
+      PassInfo pass_info, bool concurrent = false);
 
   TVM_DEFINE_OBJECT_REF_METHODS(PrimFuncPass, Pass, PrimFuncPassNode);
 };
 
 PrimFuncPass::PrimFuncPass(
     runtime::TypedPackedFunc<PrimFunc(PrimFunc, IRModule, PassContext)> pass_func,
-    PassInfo pass_info) {
+    PassInfo pass_info, bool concurrent) {
   auto n = make_object<PrimFuncPassNode>();
   n->pass_func = std::move(pass_func);
   n->pass_info = std::move(pass_info);
+  n->concurrent = concurrent;
   data_ = std::move(n);
 }
 
@@ -93,17 +119,26 @@ IRModule PrimFuncPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
   std::vector<ObjectRef> deleted_list;
   IRModuleNode* mod_ptr = mod.CopyOnWrite();
   auto* func_dict = mod_ptr->functions.CopyOnWrite();
-  // directly loop over the underlying dict
-  for (auto& kv : *func_dict) {
-    // only picks up tir::PrimFunc
-    if (kv.second->IsInstance<PrimFuncNode>()) {
-      // move out the function so that it is the only copy.
-      PrimFunc func = Downcast<PrimFunc>(std::move(kv.second));
-      func = pass_func(std::move(func), mod, pass_ctx);
-      kv.second = std::move(func);
-
-      if (!kv.second.defined()) {
-        deleted_list.push_back(kv.first);
+  int num_threads = 1;
+  if (concurrent) {
+    Integer config = pass_ctx->GetConfig<Integer>("tir.num_func_pass_threads", Integer(1)).value();
+    num_threads = static_cast<int>(config->value);
+  }
+  if (num_threads > 1) {
+    RunConcurrently(func_dict, mod, pass_ctx, num_threads, &deleted_list);
+  } else {
+    // directly loop over the underlying dict
+    for (auto& kv : *func_dict) {
+      // only picks up tir::PrimFunc
+      if (kv.second->IsInstance<PrimFuncNode>()) {
+        // move out the function so that it is the only copy.
+        PrimFunc func = Downcast<PrimFunc>(std::move(kv.second));
+        func = pass_func(std::move(func), mod, pass_ctx);
+        kv.second = std::move(func);
+
+        if (!kv.second.defined()) {
+          deleted_list.push_back(kv.first);
+        }
       }
     }
   }
@@ -116,11 +151,35 @@ IRModule PrimFuncPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
   return mod;
 }
 
+void PrimFuncPassNode::RunConcurrently(MapNode* func_dict, const IRModule& mod,
+                                       const PassContext& pass_ctx, int num_threads,
+                                       std::vector<ObjectRef>* deleted_list) const {
+  std::vector<MapNode::KVType*> entries;
+  for (auto& kv : *func_dict) {
+    if (kv.second->IsInstance<PrimFuncNode>()) {
+      entries.push_back(&kv);
+    }
+  }
+  if (entries.empty()) return;
+  std::vector<PrimFunc> results(entries.size());
+  support::parallel_for_dynamic(0, static_cast<int>(entries.size()), num_threads, [&](int, int i) {
+    // the current context is thread local, make it the one of the pass.
+    With<PassContext> scope(pass_ctx);
+    results[i] = pass_func(Downcast<PrimFunc>(entries[i]->second), mod, pass_ctx);
+  });
+  for (size_t i = 0; i < entries.size(); ++i) {
+    entries[i]->second = std::move(results[i]);
+    if (!entries[i]->second.defined()) {
+      deleted_list->push_back(entries[i]->first);
+    }
+  }
+}
+
 Pass CreatePrimFuncPass(
     const runtime::TypedPackedFunc<PrimFunc(PrimFunc, IRModule, PassContext)>& pass_func,
     int opt_level, String name, tvm::Array<String> required) {
   PassInfo pass_info = PassInfo(opt_level, name, required);
-  return PrimFuncPass(pass_func, pass_info);
+  return PrimFuncPass(pass_func, pass_info, true);
 }
 
 TVM_REGISTER_NODE_TYPE(PrimFuncPassNode);
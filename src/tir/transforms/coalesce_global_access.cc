@@ -0,0 +1,306 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file coalesce_global_access.cc
+ * \brief Stage the non-coalesced global accesses of a thread block through shared memory.
+ */
+#include <tvm/arith/pattern.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+struct CoalesceGlobalAccessConfigNode : public tvm::AttrsNode<CoalesceGlobalAccessConfigNode> {
+  int max_shared_bytes;
+
+  TVM_DECLARE_ATTRS(CoalesceGlobalAccessConfigNode, "tir.transform.CoalesceGlobalAccessConfig") {
+    TVM_ATTR_FIELD(max_shared_bytes)
+        .describe("Maximum bytes of shared memory a staged tile may use, 0 disables the pass")
+        .set_default(16384);
+  }
+};
+
+class CoalesceGlobalAccessConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(CoalesceGlobalAccessConfig, Attrs,
+                                            CoalesceGlobalAccessConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(CoalesceGlobalAccessConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.CoalesceGlobalAccess", CoalesceGlobalAccessConfig);
+
+// Replace the given loads.
+class LoadReplacer : public StmtExprMutator {
+ public:
+  explicit LoadReplacer(const std::unordered_map<const LoadNode*, PrimExpr>& vmap) : vmap_(vmap) {}
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    auto it = vmap_.find(op);
+    if (it != vmap_.end()) {
+      return it->second;
+    }
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  const std::unordered_map<const LoadNode*, PrimExpr>& vmap_;
+};
+
+/*
+ * A thread block with threadIdx.x of extent X and threadIdx.y of extent Y, whose
+ * body is a store under bound checks, accesses the tile of elements (tx, ty).
+ * An access with offset c * tx + ty, c != 1, is coalesced along threadIdx.y
+ * instead of threadIdx.x, like the load of a transpose:
+ *
+ * if (cond(tx, ty))
+ *   B[tx + ty * n] = A[tx * m + ty]
+ *
+ * Each such load is staged through a shared tile with rows padded to Y + 1
+ * elements, so the reads of a column do not conflict on the banks. The tile is
+ * filled by remapping the threads to the elements (x, y), where y follows
+ * threadIdx.x: x = ty / (Y / X) and y = tx + X * (ty % (Y / X)).
+ *
+ * if (cond(x, y))
+ *   A.shared[x * (Y + 1) + y] = A[x * m + y]
+ * if (cond(tx, ty))
+ *   B[tx + ty * n] = A.shared[tx * (Y + 1) + ty]
+ *
+ * A non-coalesced store is staged the same way: the value is computed into a
+ * shared tile and written out by the remapped threads. ThreadSync inserts the
+ * barriers between the phases.
+ */
+class GlobalAccessCoalescer : public StmtExprMutator {
+ public:
+  explicit GlobalAccessCoalescer(int max_shared_bytes) : max_shared_bytes_(max_shared_bytes) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      if (const auto* buf = op->node.as<VarNode>()) {
+        allocated_.insert(buf);
+      }
+      return StmtExprMutator::VisitStmt_(op);
+    }
+    if (op->attr_key != attr::thread_extent) {
+      return StmtExprMutator::VisitStmt_(op);
+    }
+    IterVar iv = Downcast<IterVar>(op->node);
+    std::string tag = iv->thread_tag;
+    auto it = threads_.find(tag);
+    bool bound = it != threads_.end();
+    std::pair<Var, PrimExpr> saved = bound ? it->second : std::pair<Var, PrimExpr>();
+    threads_[tag] = {iv->var, op->value};
+    Stmt body;
+    const auto* inner = op->body.as<AttrStmtNode>();
+    if (inner != nullptr && inner->attr_key == attr::thread_extent) {
+      body = this->VisitStmt(op->body);
+    } else {
+      body = Coalesce(op->body);
+    }
+    if (bound) {
+      threads_[tag] = saved;
+    } else {
+      threads_.erase(tag);
+    }
+    if (body.same_as(op->body)) {
+      return GetRef<Stmt>(op);
+    }
+    return AttrStmt(op->node, op->attr_key, op->value, body);
+  }
+
+ private:
+  // Get the extent of the thread with tag, 0 when it is not constant or not bound.
+  int64_t ThreadExtent(const std::string& tag, Var* var) const {
+    auto it = threads_.find(tag);
+    if (it == threads_.end()) return 0;
+    const auto* extent = it->second.second.as<IntImmNode>();
+    if (extent == nullptr) return 0;
+    if (var != nullptr) *var = it->second.first;
+    return extent->value;
+  }
+
+  // Whether the access index is coalesced along threadIdx.y but strided along threadIdx.x.
+  // A zero threadIdx.x stride is a broadcast and already needs a single transaction.
+  bool IsTransposed(const PrimExpr& index) const {
+    if (index.dtype().lanes() != 1) return false;
+    Array<PrimExpr> coeffs = arith::DetectLinearEquation(index, {tx_, ty_});
+    return coeffs.size() == 3 && !is_zero(coeffs[0]) && !is_one(coeffs[0]) &&
+           is_one(coeffs[1]);
+  }
+
+  // The loads only evaluated under a condition, which staging would make unconditional.
+  static std::unordered_set<const LoadNode*> ConditionalLoads(const PrimExpr& value) {
+    std::unordered_set<const LoadNode*> loads;
+    auto collect = [&loads](const PrimExpr& branch) {
+      PostOrderVisit(branch, [&loads](const ObjectRef& node) {
+        if (const auto* load = node.as<LoadNode>()) loads.insert(load);
+      });
+    };
+    PostOrderVisit(value, [&collect](const ObjectRef& node) {
+      if (const auto* select = node.as<SelectNode>()) {
+        collect(select->true_value);
+        collect(select->false_value);
+      } else if (const auto* call = node.as<CallNode>()) {
+        if (call->op.same_as(builtin::if_then_else())) {
+          collect(call->args[1]);
+          collect(call->args[2]);
+        }
+      }
+    });
+    return loads;
+  }
+
+  bool IsGlobal(const Var& buffer_var) const { return !allocated_.count(buffer_var.get()); }
+
+  Stmt Coalesce(const Stmt& body) {
+    if (max_shared_bytes_ <= 0) return body;
+    extent_x_ = ThreadExtent("threadIdx.x", &tx_);
+    extent_y_ = ThreadExtent("threadIdx.y", &ty_);
+    if (extent_x_ <= 0 || extent_y_ <= 0 || extent_y_ % extent_x_ != 0) return body;
+    if (ThreadExtent("threadIdx.z", nullptr) > 1) return body;
+
+    // The body must be a store under bound checks.
+    std::vector<PrimExpr> conds;
+    Stmt stmt = body;
+    while (const auto* cond = stmt.as<IfThenElseNode>()) {
+      if (cond->else_case.defined()) return body;
+      conds.push_back(cond->condition);
+      stmt = cond->then_case;
+    }
+    const auto* store = stmt.as<StoreNode>();
+    if (store == nullptr || store->value.dtype().lanes() != 1 || !IsGlobal(store->buffer_var)) {
+      return body;
+    }
+
+    // The tile coordinates of the remapped threads.
+    int64_t k = extent_y_ / extent_x_;
+    PrimExpr x = k == 1 ? PrimExpr(ty_) : floordiv(ty_, make_const(ty_.dtype(), k));
+    PrimExpr y = k == 1 ? PrimExpr(tx_)
+                        : tx_ + make_const(tx_.dtype(), extent_x_) *
+                                    floormod(ty_, make_const(ty_.dtype(), k));
+    Map<Var, PrimExpr> remap{{tx_, x}, {ty_, y}};
+    PrimExpr row = make_const(DataType::Int(32), extent_y_ + 1);
+    PrimExpr tile_size = make_const(DataType::Int(32), extent_x_ * (extent_y_ + 1));
+    PrimExpr thread_offset = cast(DataType::Int(32), tx_) * row + cast(DataType::Int(32), ty_);
+    PrimExpr remap_offset = cast(DataType::Int(32), x) * row + cast(DataType::Int(32), y);
+
+    // Stage the transposed loads of the buffers the block does not write.
+    std::vector<std::pair<Var, DataType>> tiles;
+    std::vector<Stmt> stages;
+    int64_t shared_bytes = 0;
+    std::unordered_map<const LoadNode*, PrimExpr> staged;
+    std::unordered_set<const LoadNode*> conditional = ConditionalLoads(store->value);
+    PostOrderVisit(store->value, [&](const ObjectRef& node) {
+      const auto* load = node.as<LoadNode>();
+      if (load == nullptr || load->dtype.lanes() != 1 || !IsGlobal(load->buffer_var) ||
+          load->buffer_var.same_as(store->buffer_var) || conditional.count(load) ||
+          !IsTransposed(load->index)) {
+        return;
+      }
+      int64_t bytes = extent_x_ * (extent_y_ + 1) * load->dtype.bytes();
+      if (shared_bytes + bytes > max_shared_bytes_) return;
+      shared_bytes += bytes;
+      Var tile(load->buffer_var->name_hint + ".shared", DataType::Handle());
+      tiles.emplace_back(tile, load->dtype);
+      PrimExpr pred = const_true();
+      Stmt fill = Store(tile, Load(load->dtype, load->buffer_var, Substitute(load->index, remap),
+                                   pred),
+                        remap_offset, pred);
+      stages.push_back(Guard(conds, remap, fill));
+      staged[load] = Load(load->dtype, tile, thread_offset, pred);
+    });
+    PrimExpr value = LoadReplacer(staged)(store->value);
+
+    // Stage a transposed store through a tile of its value.
+    Stmt compute;
+    DataType dtype = store->value.dtype();
+    int64_t bytes = extent_x_ * (extent_y_ + 1) * dtype.bytes();
+    if (IsTransposed(store->index) && shared_bytes + bytes <= max_shared_bytes_) {
+      Var tile(store->buffer_var->name_hint + ".shared", DataType::Handle());
+      tiles.emplace_back(tile, dtype);
+      PrimExpr pred = const_true();
+      stages.push_back(Guard(conds, {}, Store(tile, value, thread_offset, pred)));
+      compute = Guard(conds, remap,
+                      Store(store->buffer_var, Load(dtype, tile, remap_offset, pred),
+                            Substitute(store->index, remap), store->predicate));
+    } else if (tiles.empty()) {
+      return body;
+    } else {
+      compute = Guard(conds, {}, Store(store->buffer_var, value, store->index, store->predicate));
+    }
+
+    stages.push_back(compute);
+    Stmt ret = SeqStmt(stages);
+    for (auto it = tiles.rbegin(); it != tiles.rend(); ++it) {
+      ret = Allocate(it->first, it->second, {tile_size}, const_true(), ret);
+      ret = AttrStmt(it->first, attr::storage_scope, StringImm("shared"), ret);
+    }
+    return ret;
+  }
+
+  // Guard stmt with the bound checks, with the threads remapped.
+  Stmt Guard(const std::vector<PrimExpr>& conds, const Map<Var, PrimExpr>& remap, Stmt stmt) {
+    for (auto it = conds.rbegin(); it != conds.rend(); ++it) {
+      stmt = IfThenElse(Substitute(*it, remap), stmt);
+    }
+    return stmt;
+  }
+
+  // the maximum bytes of a staged tile
+  int max_shared_bytes_;
+  // the bound threads by tag, with their extent
+  std::unordered_map<std::string, std::pair<Var, PrimExpr>> threads_;
+  // the buffers allocated in the function, the others are global
+  std::unordered_set<const VarNode*> allocated_;
+  // the threads of the current block
+  Var tx_, ty_;
+  int64_t extent_x_{0}, extent_y_{0};
+};
+
+namespace transform {
+
+Pass CoalesceGlobalAccess() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto cfg = ctx->GetConfig<CoalesceGlobalAccessConfig>("tir.CoalesceGlobalAccess");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<CoalesceGlobalAccessConfig>();
+    }
+    auto* n = f.CopyOnWrite();
+    n->body = GlobalAccessCoalescer(cfg.value()->max_shared_bytes)(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.CoalesceGlobalAccess", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.CoalesceGlobalAccess").set_body_typed(CoalesceGlobalAccess);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
@@ -19,6 +19,11 @@
 
 /*!
  * \brief Inject double buffering optimization for data fetch.
+ *
+ *  With num_stages > 2 this becomes a software pipeline: the buffer is rotated
+ *  through num_stages copies and the fetch runs num_stages - 1 iterations ahead.
+ *  With use_async_copy the fetches into shared memory are issued as asynchronous
+ *  copies, one group per stage, and each iteration waits for its own group.
  * \file inject_double_buffer.cc
  */
 #include <tvm/runtime/registry.h>
@@ -33,9 +38,17 @@ namespace tir {
 
 struct InjectDoubleBufferConfigNode : public tvm::AttrsNode<InjectDoubleBufferConfigNode> {
   int split_loop;
+  int num_stages;
+  bool use_async_copy;
 
   TVM_DECLARE_ATTRS(InjectDoubleBufferConfigNode, "tir.transform.InjectDoubleBufferConfig") {
     TVM_ATTR_FIELD(split_loop).describe("Split loop factors").set_default(1);
+    TVM_ATTR_FIELD(num_stages)
+        .describe("Number of copies of the buffer in the pipeline")
+        .set_default(2);
+    TVM_ATTR_FIELD(use_async_copy)
+        .describe("Fetch into shared memory with asynchronous copies")
+        .set_default(false);
   }
 };
 
@@ -82,7 +95,10 @@ class StripDoubleBufferWrite : public StmtMutator {
 
 class DoubleBufferInjector : public StmtExprMutator {
  public:
-  explicit DoubleBufferInjector(int split_loop) : split_loop_(split_loop) {}
+  DoubleBufferInjector(int split_loop, int num_stages, bool use_async_copy)
+      : split_loop_(split_loop), num_stages_(num_stages), use_async_copy_(use_async_copy) {
+    CHECK_GE(num_stages, 2) << "A pipeline needs at least two stages";
+  }
 
   Stmt Inject(Stmt stmt) {
     DoubleBufferDetector detector;
@@ -119,7 +135,7 @@ class DoubleBufferInjector : public StmtExprMutator {
           foldl(fmul, make_const(DataType::Int(32), 1), op->extents) * op->dtype.lanes();
       Stmt stmt = StmtExprMutator::VisitStmt_(op);
       op = stmt.as<AllocateNode>();
-      Array<PrimExpr> new_extents{make_const(op->extents[0].dtype(), 2)};
+      Array<PrimExpr> new_extents{make_const(op->extents[0].dtype(), num_stages_)};
       for (PrimExpr e : op->extents) {
         new_extents.push_back(e);
       }
@@ -138,8 +154,22 @@ class DoubleBufferInjector : public StmtExprMutator {
   Stmt VisitStmt_(const ForNode* op) final {
     loop_nest_.push_back(op);
     Stmt stmt = StmtExprMutator::VisitStmt_(op);
-    auto it = loop_pre_.find(op);
-    if (it != loop_pre_.end()) {
+    auto async_it = async_fetches_.find(op);
+    if (async_it != async_fetches_.end()) {
+      // Wait for the groups of this iteration, the ones of the next num_stages - 2
+      // iterations can stay in flight. The barrier makes the copies of the other
+      // threads visible, and keeps the next fetch from overwriting a stage which is
+      // still being read.
+      const ForNode* loop = stmt.as<ForNode>();
+      int in_flight = async_it->second * (num_stages_ - 2);
+      Stmt wait = Evaluate(Call(DataType::Void(), builtin::ptx_wait_group(), {in_flight}));
+      Stmt sync = Evaluate(
+          Call(DataType::Int(32), builtin::tvm_storage_sync(), {StringImm("shared")}));
+      stmt = For(loop->loop_var, loop->min, loop->extent, loop->for_type, loop->device_api,
+                 SeqStmt::Flatten(wait, sync, loop->body));
+    }
+    auto pre_it = loop_prologue_.find(op);
+    if (pre_it != loop_prologue_.end()) {
       const ForNode* old_loop = stmt.as<ForNode>();
       if (split_loop_ != 0) {
         // Explicitly unroll the loop
@@ -170,9 +200,15 @@ class DoubleBufferInjector : public StmtExprMutator {
         }
         stmt = SeqStmt::Flatten(loop, tail_seq);
       }
-      stmt = SeqStmt::Flatten(it->second, stmt);
+      // Fill the stages one after the other, so that the groups of a stage are
+      // committed before those of the next one, whatever the number of buffers.
+      std::vector<Stmt> prologue;
+      for (const std::vector<Stmt>& stage : pre_it->second) {
+        prologue.insert(prologue.end(), stage.begin(), stage.end());
+      }
+      stmt = SeqStmt::Flatten(prologue, stmt);
     }
-    it = loop_allocs_.find(op);
+    auto it = loop_allocs_.find(op);
     if (it != loop_allocs_.end()) {
       stmt = MergeNest(it->second, stmt);
     }
@@ -226,26 +262,52 @@ class DoubleBufferInjector : public StmtExprMutator {
     }
     StorageEntry& e = it->second;
     e.loop = loop_nest_.back();
-    PrimExpr zero = make_const(e.loop->loop_var.dtype(), 0);
-    PrimExpr one = make_const(e.loop->loop_var.dtype(), 1);
-    PrimExpr two = make_const(e.loop->loop_var.dtype(), 2);
-    PrimExpr loop_shift = e.loop->loop_var + one;
-    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", e.loop->loop_var.dtype());
-    e.switch_read_var = indexmod(e.loop->loop_var, two);
+    DataType dtype = e.loop->loop_var.dtype();
+    PrimExpr stages = make_const(dtype, num_stages_);
+    PrimExpr loop_shift = e.loop->loop_var + make_const(dtype, num_stages_ - 1);
+    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", dtype);
+    e.switch_read_var = indexmod(e.loop->loop_var, stages);
     in_double_buffer_scope_ = true;
     Stmt body = this->VisitStmt(op->body);
     in_double_buffer_scope_ = false;
+    bool async = use_async_copy_ && e.scope == "shared";
+    if (async) {
+      body = AttrStmt(make_zero(DataType::Int(32)), attr::async_scope, 1, body);
+    }
+    // Fill the first num_stages - 1 stages before the loop.
     std::unordered_map<const VarNode*, PrimExpr> vmap;
-    vmap[e.switch_write_var.get()] = zero;
-    vmap[e.loop->loop_var.get()] = zero;
-    loop_pre_[e.loop].emplace_back(Substitute(body, vmap));
+    std::vector<std::vector<Stmt>>& prologue = loop_prologue_[e.loop];
+    prologue.resize(num_stages_ - 1);
+    for (int i = 0; i < num_stages_ - 1; ++i) {
+      PrimExpr stage = make_const(dtype, i);
+      vmap[e.switch_write_var.get()] = stage;
+      vmap[e.loop->loop_var.get()] = stage;
+      Stmt fetch = Substitute(body, vmap);
+      if (i != 0) {
+        fetch = IfThenElse(stage < e.loop->extent, fetch);
+      }
+      prologue[i].emplace_back(fetch);
+      if (async) {
+        prologue[i].emplace_back(CommitGroup());
+      }
+    }
     vmap[e.loop->loop_var.get()] = loop_shift;
-    vmap[e.switch_write_var.get()] = indexmod(loop_shift, two);
+    vmap[e.switch_write_var.get()] = indexmod(loop_shift, stages);
     body = Substitute(body, vmap);
     body = AttrStmt(buffer, attr::double_buffer_write, 1, body);
     body = IfThenElse(loop_shift < e.loop->extent, body);
+    if (async) {
+      // Commit even when there is nothing left to fetch, so that every
+      // iteration waits for the same number of groups.
+      ++async_fetches_[e.loop];
+      body = SeqStmt::Flatten(body, CommitGroup());
+    }
     return body;
   }
+
+  static Stmt CommitGroup() {
+    return Evaluate(Call(DataType::Void(), builtin::ptx_commit_group(), {}));
+  }
   // Storage entry for those who need double buffering.
   struct StorageEntry {
     // The size of the buffer
@@ -261,14 +323,20 @@ class DoubleBufferInjector : public StmtExprMutator {
   };
   // Whether split loop
   int32_t split_loop_;
+  // The number of copies of each buffer
+  int num_stages_;
+  // Whether to fetch into shared memory with asynchronous copies
+  bool use_async_copy_;
   // Whether we are inside double buffer scope.
   bool in_double_buffer_scope_{false};
   // The current loop next
   std::vector<const ForNode*> loop_nest_;
   // The allocs to be appended before the loop
   std::unordered_map<const ForNode*, std::vector<Stmt> > loop_allocs_;
-  // The stmt to be appended before the loop
-  std::unordered_map<const ForNode*, std::vector<Stmt> > loop_pre_;
+  // The fetches of each stage to be appended before the loop
+  std::unordered_map<const ForNode*, std::vector<std::vector<Stmt>>> loop_prologue_;
+  // The number of asynchronous fetches in each loop
+  std::unordered_map<const ForNode*, int> async_fetches_;
   // The allocation size of the buffer
   std::unordered_map<const VarNode*, StorageEntry> dbuffer_info_;
 };
@@ -282,7 +350,9 @@ Pass InjectDoubleBuffer() {
     if (!cfg.defined()) {
       cfg = AttrsWithDefaultValues<InjectDoubleBufferConfig>();
     }
-    n->body = DoubleBufferInjector(cfg.value()->split_loop).Inject(std::move(n->body));
+    n->body = DoubleBufferInjector(cfg.value()->split_loop, cfg.value()->num_stages,
+                                   cfg.value()->use_async_copy)
+                  .Inject(std::move(n->body));
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.InjectDoubleBuffer", {});
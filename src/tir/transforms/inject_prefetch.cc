@@ -23,13 +23,17 @@
 // Inject prefetch op in HalideIR
 #include <tvm/arith/analyzer.h>
 #include <tvm/arith/bound.h>
+#include <tvm/arith/pattern.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 namespace tir {
@@ -37,12 +41,150 @@ namespace tir {
 using arith::DomainTouched;
 using arith::IntSet;
 
+struct InjectPrefetchConfigNode : public tvm::AttrsNode<InjectPrefetchConfigNode> {
+  bool auto_prefetch;
+  int cache_line_bytes;
+  int prefetch_latency;
+
+  TVM_DECLARE_ATTRS(InjectPrefetchConfigNode, "tir.transform.InjectPrefetchConfig") {
+    TVM_ATTR_FIELD(auto_prefetch)
+        .describe("Prefetch the streaming reads of innermost loops without prefetch_scope")
+        .set_default(false);
+    TVM_ATTR_FIELD(cache_line_bytes).describe("Size of a cache line in bytes").set_default(64);
+    TVM_ATTR_FIELD(prefetch_latency)
+        .describe("Estimated latency of a memory access in cycles")
+        .set_default(200);
+  }
+};
+
+class InjectPrefetchConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(InjectPrefetchConfig, Attrs,
+                                            InjectPrefetchConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(InjectPrefetchConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.InjectPrefetch", InjectPrefetchConfig);
+
+// Find the reads of the input buffers in the body of an innermost serial loop
+// that stream through memory, and prefetch them far enough ahead to hide the
+// memory latency. The distance is the number of iterations that cover the
+// latency at the estimated cost of one iteration, rounded up to a whole cache
+// line, and each line is only prefetched once.
+class StreamPrefetcher : public StmtExprVisitor {
+ public:
+  StreamPrefetcher(const std::unordered_set<const BufferNode*>& inputs, int cache_line_bytes,
+                   int prefetch_latency)
+      : inputs_(inputs), cache_line_bytes_(cache_line_bytes), prefetch_latency_(prefetch_latency) {}
+
+  Stmt Inject(const ForNode* loop) {
+    loop_var_ = loop->loop_var;
+    this->VisitStmt(loop->body);
+    if (has_loop_ || loads_.empty()) return loop->body;
+    // Each node of the body stands for about one cycle.
+    int64_t cost = std::max<int64_t>(num_nodes_, 1);
+    int64_t latency_iters = (prefetch_latency_ + cost - 1) / cost;
+    const auto* extent = loop->extent.as<IntImmNode>();
+
+    std::vector<Stmt> prefetches;
+    for (const BufferLoadNode* load : loads_) {
+      if (stored_.count(load->buffer.get())) continue;
+      int64_t bytes = ElemStride(load) * load->dtype.bytes() * load->dtype.lanes();
+      if (bytes <= 0) continue;
+      int64_t distance = (latency_iters * bytes + cache_line_bytes_ - 1) / cache_line_bytes_ *
+                         cache_line_bytes_;
+      distance = (distance + bytes - 1) / bytes;
+      // The data of short loops is better fetched by an outer loop.
+      if (extent && distance >= extent->value) continue;
+
+      Map<Var, PrimExpr> ahead;
+      ahead.Set(loop_var_, loop_var_ + make_const(loop_var_.dtype(), distance));
+      Array<Range> region;
+      for (const PrimExpr& index : load->indices) {
+        region.push_back(Range::FromMinExtent(Substitute(index, ahead),
+                                              make_const(index.dtype(), 1)));
+      }
+      Stmt prefetch = Prefetch(load->buffer, region);
+      int64_t iters_per_line = cache_line_bytes_ / bytes;
+      if (iters_per_line > 1) {
+        PrimExpr first = floormod(loop_var_ - loop->min, make_const(loop_var_.dtype(),
+                                                                    iters_per_line)) == 0;
+        prefetch = IfThenElse(first, prefetch);
+      }
+      prefetches.push_back(prefetch);
+    }
+    if (prefetches.empty()) return loop->body;
+    prefetches.push_back(loop->body);
+    return SeqStmt(prefetches);
+  }
+
+  void VisitStmt_(const ForNode* op) final { has_loop_ = true; }
+
+  void VisitStmt_(const BufferStoreNode* op) final {
+    stored_.insert(op->buffer.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    if (inputs_.count(op->buffer.get())) {
+      bool seen = std::any_of(loads_.begin(), loads_.end(), [op](const BufferLoadNode* load) {
+        return load->buffer.same_as(op->buffer) && StructuralEqual()(load->indices, op->indices);
+      });
+      if (!seen) loads_.push_back(op);
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr(const PrimExpr& e) final {
+    ++num_nodes_;
+    StmtExprVisitor::VisitExpr(e);
+  }
+
+ private:
+  // The number of elements the flattened index of load advances in one
+  // iteration, 0 if it is not a constant.
+  int64_t ElemStride(const BufferLoadNode* load) {
+    const Buffer& buffer = load->buffer;
+    PrimExpr stride = make_const(loop_var_.dtype(), 0);
+    PrimExpr dim_stride = make_const(loop_var_.dtype(), 1);
+    for (size_t i = load->indices.size(); i != 0; --i) {
+      Array<PrimExpr> coeff = arith::DetectLinearEquation(load->indices[i - 1], {loop_var_});
+      if (coeff.empty()) return 0;
+      if (!buffer->strides.empty()) dim_stride = buffer->strides[i - 1];
+      stride = stride + coeff[0] * dim_stride;
+      dim_stride = dim_stride * buffer->shape[i - 1];
+    }
+    const auto* value = analyzer_.Simplify(stride).as<IntImmNode>();
+    return value ? std::abs(value->value) : 0;
+  }
+
+  const std::unordered_set<const BufferNode*>& inputs_;
+  int cache_line_bytes_;
+  int prefetch_latency_;
+  Var loop_var_;
+  arith::Analyzer analyzer_;
+  bool has_loop_{false};
+  int64_t num_nodes_{0};
+  std::vector<const BufferLoadNode*> loads_;
+  std::unordered_set<const BufferNode*> stored_;
+};
+
 class PrefetchInjector : public StmtMutator {
  public:
+  PrefetchInjector() = default;
+
+  PrefetchInjector(std::unordered_set<const BufferNode*> inputs, int cache_line_bytes,
+                   int prefetch_latency)
+      : auto_prefetch_(true),
+        inputs_(std::move(inputs)),
+        cache_line_bytes_(cache_line_bytes),
+        prefetch_latency_(prefetch_latency) {}
+
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     Stmt ret = StmtMutator::VisitStmt_(op);
     op = ret.as<AttrStmtNode>();
     if (op && op->attr_key == attr::prefetch_scope) {
+      explicit_prefetch_ = true;
       Buffer buffer = Downcast<Buffer>(op->node);
       CHECK_NE(loop_nest_.size(), 0U);
       Region domain = DomainTouched(op->body, buffer, true, false);
@@ -74,15 +216,32 @@ class PrefetchInjector : public StmtMutator {
     if (op->for_type == ForType::Vectorized) {
       vectorized_[var.get()] = IntSet::Interval(op->min, (op->min + op->extent) - 1);
     }
+    bool explicit_prefetch = explicit_prefetch_;
+    explicit_prefetch_ = false;
     Stmt ret = StmtMutator::VisitStmt_(op);
     if (op->for_type == ForType::Vectorized) {
       vectorized_.erase(var.get());
     }
     loop_nest_.pop_back();
+    // Loops scheduled with explicit prefetches are left alone.
+    if (auto_prefetch_ && !explicit_prefetch_ &&
+        (op->for_type == ForType::Serial || op->for_type == ForType::Unrolled)) {
+      op = ret.as<ForNode>();
+      Stmt body = StreamPrefetcher(inputs_, cache_line_bytes_, prefetch_latency_).Inject(op);
+      if (!body.same_as(op->body)) {
+        ret = For(op->loop_var, op->min, op->extent, op->for_type, op->device_api, body);
+      }
+    }
+    explicit_prefetch_ |= explicit_prefetch;
     return ret;
   }
 
  private:
+  bool auto_prefetch_{false};
+  std::unordered_set<const BufferNode*> inputs_;
+  int cache_line_bytes_{64};
+  int prefetch_latency_{0};
+  bool explicit_prefetch_{false};
   std::vector<Var> loop_nest_;
   std::unordered_map<const VarNode*, IntSet> vectorized_;
   static const Range none;
@@ -96,8 +255,21 @@ namespace transform {
 
 Pass InjectPrefetch() {
   auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto cfg = ctx->GetConfig<InjectPrefetchConfig>("tir.InjectPrefetch");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<InjectPrefetchConfig>();
+    }
     auto* n = f.CopyOnWrite();
-    n->body = PrefetchInjector()(std::move(n->body));
+    if (cfg.value()->auto_prefetch) {
+      std::unordered_set<const BufferNode*> inputs;
+      for (const auto& kv : n->buffer_map) {
+        inputs.insert(kv.second.get());
+      }
+      n->body = PrefetchInjector(std::move(inputs), cfg.value()->cache_line_bytes,
+                                 cfg.value()->prefetch_latency)(std::move(n->body));
+    } else {
+      n->body = PrefetchInjector()(std::move(n->body));
+    }
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.InjectPrefetch", {});
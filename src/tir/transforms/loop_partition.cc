@@ -28,21 +28,34 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include "../../arith/interval_set.h"
 #include "../../runtime/thread_storage_scope.h"
 #include "ir_util.h"
+#include "pgo_profile.h"
 
 namespace tvm {
 namespace tir {
 
 struct LoopPartitionConfigNode : public tvm::AttrsNode<LoopPartitionConfigNode> {
   bool partition_const_loop;
+  double min_interior_ratio;
+  int max_versions;
 
   TVM_DECLARE_ATTRS(LoopPartitionConfigNode, "tir.transform.LoopPartitionConfig") {
     TVM_ATTR_FIELD(partition_const_loop).describe("Split constant loop").set_default(false);
+    TVM_ATTR_FIELD(min_interior_ratio)
+        .describe("Minimum fraction of the iterations of a loop in its interior range")
+        .set_default(0.0);
+    TVM_ATTR_FIELD(max_versions)
+        .describe("Maximum number of loop versions the partitions may add to a function, "
+                  "-1 for no limit")
+        .set_default(-1);
   }
 };
 
@@ -54,6 +67,22 @@ class LoopPartitionConfig : public Attrs {
 TVM_REGISTER_NODE_TYPE(LoopPartitionConfigNode);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.LoopPartition", LoopPartitionConfig);
 
+/*!
+ * \brief The partitions of the process, and the ones skipped by the cost bounds.
+ * \note The functions of a module may be lowered concurrently.
+ */
+struct LoopPartitionStats {
+  std::atomic<int64_t> partitioned{0};
+  std::atomic<int64_t> versions{0};
+  std::atomic<int64_t> skipped_ratio{0};
+  std::atomic<int64_t> skipped_versions{0};
+
+  static LoopPartitionStats* Global() {
+    static LoopPartitionStats inst;
+    return &inst;
+  }
+};
+
 using arith::DeduceBound;
 using arith::Intersect;
 using arith::IntSet;
@@ -100,12 +129,15 @@ bool ExprUseVars(PrimExpr expr, const std::unordered_set<const VarNode*>& vars)
 class CandidateSelector final : public StmtExprVisitor {
  public:
   using VarIsUsed = bool;
-  explicit CandidateSelector(bool partition_const_loop)
-      : partition_const_loop_(partition_const_loop) {}
+  explicit CandidateSelector(bool partition_const_loop,
+                             std::unordered_set<const VarNode*> cold_loops)
+      : partition_const_loop_(partition_const_loop), cold_loops_(std::move(cold_loops)) {}
 
   void VisitStmt_(const ForNode* op) final {
-    // partition const loop when sets partition_const_loop_
-    if (!is_const_int(op->min) || !is_const_int(op->extent) || partition_const_loop_) {
+    // partition const loop when sets partition_const_loop_,
+    // the loops which never ran in the profile are kept in one piece.
+    if ((!is_const_int(op->min) || !is_const_int(op->extent) || partition_const_loop_) &&
+        !cold_loops_.count(op->loop_var.get())) {
       const VarNode* var = op->loop_var.get();
       record_.insert({var, false});
       StmtExprVisitor::VisitStmt_(op);
@@ -175,6 +207,7 @@ class CandidateSelector final : public StmtExprVisitor {
   bool in_likely_{false};
   bool no_split_{false};
   bool partition_const_loop_{false};
+  std::unordered_set<const VarNode*> cold_loops_;
   std::unordered_map<const VarNode*, VarIsUsed> record_;
 };
 
@@ -334,8 +367,12 @@ class ThreadPartitionInserter : public StmtMutator {
 // likely conditions
 class LoopPartitioner : public StmtMutator {
  public:
-  explicit LoopPartitioner(bool partition_const_loop)
-      : selector(CandidateSelector(partition_const_loop)) {}
+  explicit LoopPartitioner(bool partition_const_loop,
+                           std::unordered_set<const VarNode*> cold_loops = {},
+                           double min_interior_ratio = 0, int max_versions = -1)
+      : selector(CandidateSelector(partition_const_loop, std::move(cold_loops))),
+        min_interior_ratio_(min_interior_ratio),
+        max_versions_(max_versions) {}
 
   Stmt VisitAndMutate(Stmt stmt) {
     selector(stmt);
@@ -397,13 +434,52 @@ class LoopPartitioner : public StmtMutator {
 
   inline Stmt MakeFor(const Object* op, PrimExpr extent, Stmt body);
 
+  bool WithinCostBounds(PrimExpr interior_extent, PrimExpr extent, int num_ranges);
+
   /* Candidate IRs that may be partitioned potentially */
   std::unordered_map<const VarNode*, IntSet> hint_map_;
   std::unordered_map<const VarNode*, IntSet> relax_map_;
   arith::Analyzer analyzer_;
   CandidateSelector selector;
+  /*! \brief The minimum fraction of the iterations in the interior range. */
+  double min_interior_ratio_;
+  /*! \brief The maximum number of loop versions added, -1 for no limit. */
+  int max_versions_;
+  /*! \brief The number of loop versions added so far. */
+  int num_versions_{0};
 };
 
+// Whether partitioning a loop in num_ranges ranges is worth the code it adds,
+// the interior range without the conditions should hold most of the iterations
+// and each range beyond the first is another version of the loop body. The ratio
+// is only checked when the extents are constant.
+bool LoopPartitioner::WithinCostBounds(PrimExpr interior_extent, PrimExpr extent,
+                                       int num_ranges) {
+  LoopPartitionStats* stats = LoopPartitionStats::Global();
+  if (min_interior_ratio_ > 0) {
+    const auto* interior = analyzer_.Simplify(interior_extent).as<IntImmNode>();
+    const auto* total = analyzer_.Simplify(extent).as<IntImmNode>();
+    if (interior != nullptr && total != nullptr && total->value > 0 &&
+        interior->value < min_interior_ratio_ * total->value) {
+      DLOG(INFO) << "Not partitioning a loop of " << total->value << " iterations, "
+                 << interior->value << " are in the interior range";
+      ++stats->skipped_ratio;
+      return false;
+    }
+  }
+  int added = std::max(num_ranges - 1, 0);
+  if (max_versions_ >= 0 && num_versions_ + added > max_versions_) {
+    DLOG(INFO) << "Not partitioning a loop, the function already has " << num_versions_
+               << " loop versions";
+    ++stats->skipped_versions;
+    return false;
+  }
+  num_versions_ += added;
+  ++stats->partitioned;
+  stats->versions += added;
+  return true;
+}
+
 // Returns an interval (in the first component) in which all the conditions
 // given in the second component provably have value given by cond_value
 std::pair<IntSet, ExpressionSet> LoopPartitioner::GetIntervalAndCondset(
@@ -564,7 +640,12 @@ Stmt LoopPartitioner::TryPartition(const Stmt& stmt, Var var, PrimExpr min, Prim
   // Generating code for middle subrange
   if (!partition_thread_scope) {
     Stmt mid_stmt;
-    if (!analyzer_.CanProve(body_begin >= post_doubt_begin)) {
+    bool has_mid = !analyzer_.CanProve(body_begin >= post_doubt_begin);
+    int num_ranges = has_mid + pre_stmt.defined() + post_stmt.defined();
+    if (!WithinCostBounds(post_doubt_begin - body_begin, max - min + 1, num_ranges)) {
+      return Stmt();
+    }
+    if (has_mid) {
       // [body_begin, post_doubt_begin)
       Stmt simplified_body = ConditionEliminator(cond_set, cond_value)(body);
       Stmt new_body = Substitute(simplified_body, {{Var{var}, var + body_begin}});
@@ -617,8 +698,12 @@ class RemoveLikelyTags : public StmtExprMutator {
   }
 };
 
-Stmt LoopPartition(Stmt stmt, bool partition_const_loop) {
-  stmt = LoopPartitioner(partition_const_loop).VisitAndMutate(std::move(stmt));
+Stmt LoopPartition(Stmt stmt, bool partition_const_loop,
+                   std::unordered_set<const VarNode*> cold_loops = {},
+                   double min_interior_ratio = 0, int max_versions = -1) {
+  stmt = LoopPartitioner(partition_const_loop, std::move(cold_loops), min_interior_ratio,
+                         max_versions)
+             .VisitAndMutate(std::move(stmt));
   stmt = RemoveLikelyTags()(std::move(stmt));
   return stmt;
 }
@@ -632,7 +717,13 @@ Pass LoopPartition() {
     if (!cfg.defined()) {
       cfg = AttrsWithDefaultValues<LoopPartitionConfig>();
     }
-    n->body = LoopPartition(std::move(n->body), cfg.value()->partition_const_loop);
+    std::unordered_set<const VarNode*> cold_loops;
+    if (auto profile = PGOProfile::FromContext(ctx)) {
+      cold_loops = profile->ColdLoops(f);
+    }
+    n->body = LoopPartition(std::move(n->body), cfg.value()->partition_const_loop,
+                            std::move(cold_loops), cfg.value()->min_interior_ratio,
+                            cfg.value()->max_versions);
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.LoopPartition", {});
@@ -640,6 +731,19 @@ Pass LoopPartition() {
 
 TVM_REGISTER_GLOBAL("tir.transform.LoopPartition").set_body_typed(LoopPartition);
 
+TVM_REGISTER_GLOBAL("tir.transform.LoopPartitionStats").set_body_typed([](bool reset) {
+  LoopPartitionStats* stats = LoopPartitionStats::Global();
+  auto read = [reset](std::atomic<int64_t>* counter) {
+    return Integer(static_cast<int>(reset ? counter->exchange(0) : counter->load()));
+  };
+  Map<String, Integer> ret;
+  ret.Set("partitioned", read(&stats->partitioned));
+  ret.Set("versions", read(&stats->versions));
+  ret.Set("skipped_ratio", read(&stats->skipped_ratio));
+  ret.Set("skipped_versions", read(&stats->skipped_versions));
+  return ret;
+});
+
 }  // namespace transform
 
 }  // namespace tir
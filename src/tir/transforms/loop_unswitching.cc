@@ -0,0 +1,354 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file loop_unswitching.cc
+ * \brief Version loops on the conditions in their body.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../../arith/interval_set.h"
+#include "ir_util.h"
+
+namespace tvm {
+namespace tir {
+
+using arith::IntSet;
+
+struct LoopUnswitchingConfigNode : public tvm::AttrsNode<LoopUnswitchingConfigNode> {
+  int max_growth;
+
+  TVM_DECLARE_ATTRS(LoopUnswitchingConfigNode, "tir.transform.LoopUnswitchingConfig") {
+    TVM_ATTR_FIELD(max_growth)
+        .describe("Maximum number of statements the loop versions may add to a function")
+        .set_default(0);
+  }
+};
+
+class LoopUnswitchingConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(LoopUnswitchingConfig, Attrs,
+                                            LoopUnswitchingConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(LoopUnswitchingConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.LoopUnswitching", LoopUnswitchingConfig);
+
+/*
+ * Each condition of IfThenElse, Select and if_then_else in the body of a loop
+ * is split in the terms of its conjunction. A term that does not depend on the
+ * variables defined in the loop is unswitched out of it:
+ *
+ * for (i, 0, n)
+ *   if (likely(m > 0) && likely(i < m))
+ *     A[i] = B[i]
+ *
+ * becomes
+ *
+ * if (m > 0)
+ *   for (i, 0, n)
+ *     if (likely(i < m))
+ *       A[i] = B[i]
+ * else
+ *   for (i, 0, n)
+ *     // nothing
+ *
+ * A comparison that is linear in the loop variables, as the padding conditions
+ * of topi.nn.pad, gets a guard for the values of the enclosing variables that
+ * make it hold in every iteration. The loop is versioned in an interior version
+ * without the terms and a boundary version that keeps them:
+ *
+ * for (k, 0, 3)
+ *   B[i] = B[i] + if_then_else(likely(1 <= i + k) && likely(i + k < 17), A[i + k - 1], 0)
+ *
+ * becomes
+ *
+ * if (1 <= i && i < 15)
+ *   for (k, 0, 3)
+ *     B[i] = B[i] + A[i + k - 1]
+ * else
+ *   for (k, 0, 3)
+ *     B[i] = B[i] + if_then_else(likely(1 <= i + k) && likely(i + k < 17), A[i + k - 1], 0)
+ *
+ * The loops are visited from the outside in, so the conditions are unswitched
+ * out of the outermost loop possible, and each version costs the size of the
+ * loop from the budget. Loop partitioning complements this by splitting the
+ * range of a loop itself on the conditions.
+ */
+
+// Collect the terms of the conditions in a loop, and the ranges of the loops in it.
+class ConditionCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const ForNode* op) final {
+    defined_.insert(op->loop_var.get());
+    if (!UsesDefined(op->min) && !UsesDefined(op->extent)) {
+      dom_map_[op->loop_var.get()] = IntSet::FromRange(Range::FromMinExtent(op->min, op->extent));
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const LetStmtNode* op) final {
+    defined_.insert(op->var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AllocateNode* op) final {
+    defined_.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (const auto* iv = op->node.as<IterVarNode>()) {
+      defined_.insert(iv->var.get());
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    defined_.insert(op->var.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const IfThenElseNode* op) final {
+    AddTerms(op->condition);
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const SelectNode* op) final {
+    AddTerms(op->condition);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (op->op.same_as(builtin::if_then_else())) {
+      AddTerms(op->args[0]);
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  bool UsesDefined(const PrimExpr& e) const {
+    return ExprUseVar(e, [this](const VarNode* v) { return defined_.count(v) != 0; });
+  }
+
+  // The vars defined in the loop, and the ranges of the loops among them.
+  std::unordered_set<const VarNode*> defined_;
+  std::unordered_map<const VarNode*, IntSet> dom_map_;
+  std::vector<PrimExpr> terms_;
+
+ private:
+  void AddTerms(const PrimExpr& cond) {
+    if (const auto* op = cond.as<AndNode>()) {
+      AddTerms(op->a);
+      AddTerms(op->b);
+      return;
+    }
+    if (const auto* op = cond.as<CallNode>()) {
+      if (op->op.same_as(builtin::likely())) {
+        AddTerms(op->args[0]);
+        return;
+      }
+    }
+    if (is_const_int(cond) || SideEffect(cond) > CallEffectKind::kPure) return;
+    for (const PrimExpr& term : terms_) {
+      if (StructuralEqual()(term, cond)) return;
+    }
+    terms_.push_back(cond);
+  }
+};
+
+// Replace the terms of the conditions by constants, and fold the branches
+// whose condition becomes constant.
+class TermReplacer : public StmtExprMutator {
+ public:
+  explicit TermReplacer(std::vector<std::pair<PrimExpr, bool>> values)
+      : values_(std::move(values)) {}
+
+  Stmt VisitStmt_(const IfThenElseNode* op) final {
+    PrimExpr cond = Replace(op->condition);
+    if (is_one(cond)) return this->VisitStmt(op->then_case);
+    if (is_zero(cond)) {
+      return op->else_case.defined() ? this->VisitStmt(op->else_case) : Evaluate(0);
+    }
+    Stmt then_case = this->VisitStmt(op->then_case);
+    Stmt else_case = op->else_case.defined() ? this->VisitStmt(op->else_case) : Stmt();
+    return IfThenElse(cond, then_case, else_case);
+  }
+
+  PrimExpr VisitExpr_(const SelectNode* op) final {
+    PrimExpr cond = Replace(op->condition);
+    if (is_one(cond)) return this->VisitExpr(op->true_value);
+    if (is_zero(cond)) return this->VisitExpr(op->false_value);
+    return Select(cond, this->VisitExpr(op->true_value), this->VisitExpr(op->false_value));
+  }
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    if (op->op.same_as(builtin::if_then_else())) {
+      PrimExpr cond = Replace(op->args[0]);
+      if (is_one(cond)) return this->VisitExpr(op->args[1]);
+      if (is_zero(cond)) return this->VisitExpr(op->args[2]);
+      return if_then_else(cond, this->VisitExpr(op->args[1]), this->VisitExpr(op->args[2]));
+    }
+    return StmtExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  PrimExpr Replace(const PrimExpr& cond) {
+    if (const auto* op = cond.as<AndNode>()) {
+      PrimExpr a = Replace(op->a);
+      PrimExpr b = Replace(op->b);
+      if (is_zero(a) || is_zero(b)) return const_false();
+      if (is_one(a)) return b;
+      if (is_one(b)) return a;
+      return a && b;
+    }
+    if (const auto* op = cond.as<CallNode>()) {
+      if (op->op.same_as(builtin::likely())) {
+        PrimExpr value = Replace(op->args[0]);
+        return is_const_int(value) ? value : likely(value);
+      }
+    }
+    for (const auto& kv : values_) {
+      if (StructuralEqual()(kv.first, cond)) return make_const(cond.dtype(), kv.second);
+    }
+    return this->VisitExpr(cond);
+  }
+
+  std::vector<std::pair<PrimExpr, bool>> values_;
+};
+
+class LoopUnswitcher : public StmtMutator {
+ public:
+  explicit LoopUnswitcher(int max_growth) : budget_(max_growth) {}
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    int64_t size = 0;
+    PostOrderVisit(GetRef<Stmt>(op), [&size](const ObjectRef& node) {
+      if (node->IsInstance<StmtNode>()) ++size;
+    });
+    if (size > budget_) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    ConditionCollector collector;
+    collector(GetRef<Stmt>(op));
+    Stmt loop = GetRef<Stmt>(op);
+
+    // Unswitch the first term that does not depend on the loop.
+    for (const PrimExpr& term : collector.terms_) {
+      if (!collector.UsesDefined(term)) {
+        budget_ -= size;
+        Stmt then_case = this->VisitStmt(TermReplacer({{term, true}})(loop));
+        Stmt else_case = this->VisitStmt(TermReplacer({{term, false}})(loop));
+        return IfThenElse(term, then_case, else_case);
+      }
+    }
+
+    // Version the loop on the guard of the linear terms.
+    std::vector<std::pair<PrimExpr, bool>> values;
+    PrimExpr guard = const_true();
+    for (const PrimExpr& term : collector.terms_) {
+      PrimExpr term_guard = analyzer_.Simplify(Guard(term, collector));
+      if (is_zero(term_guard)) continue;
+      values.emplace_back(term, true);
+      if (!is_one(term_guard)) guard = guard && term_guard;
+    }
+    if (values.empty()) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    if (!is_one(guard)) budget_ -= size;
+    Stmt interior = this->VisitStmt(TermReplacer(values)(loop));
+    if (is_one(guard)) return interior;
+    return IfThenElse(analyzer_.Simplify(guard), interior, StmtMutator::VisitStmt_(op));
+  }
+
+ private:
+  // Get the condition on the enclosing variables under which term holds in
+  // every iteration of the loop, false if it is not known.
+  PrimExpr Guard(const PrimExpr& term, const ConditionCollector& collector) {
+    PrimExpr diff;
+    bool strict;
+    if (const auto* op = term.as<LTNode>()) {
+      diff = op->a - op->b;
+      strict = true;
+    } else if (const auto* op = term.as<LENode>()) {
+      diff = op->a - op->b;
+      strict = false;
+    } else if (const auto* op = term.as<GTNode>()) {
+      diff = op->b - op->a;
+      strict = true;
+    } else if (const auto* op = term.as<GENode>()) {
+      diff = op->b - op->a;
+      strict = false;
+    } else {
+      return const_false();
+    }
+    if (!diff.dtype().is_int()) return const_false();
+    IntSet set = arith::EvalSet(diff, collector.dom_map_);
+    const auto* interval = set.as<arith::IntervalSetNode>();
+    if (interval == nullptr || !interval->HasUpperBound() || collector.UsesDefined(set.max())) {
+      return const_false();
+    }
+    PrimExpr zero = make_zero(diff.dtype());
+    return strict ? set.max() < zero : set.max() <= zero;
+  }
+
+  int64_t budget_;
+  arith::Analyzer analyzer_;
+};
+
+Stmt LoopUnswitching(Stmt stmt, int max_growth) {
+  Stmt ret = LoopUnswitcher(max_growth)(stmt);
+  if (!ret.same_as(stmt)) {
+    return ConvertSSA(ret);
+  }
+  return ret;
+}
+
+namespace transform {
+
+Pass LoopUnswitching() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto cfg = ctx->GetConfig<LoopUnswitchingConfig>("tir.LoopUnswitching");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<LoopUnswitchingConfig>();
+    }
+    auto* n = f.CopyOnWrite();
+    n->body = LoopUnswitching(std::move(n->body), cfg.value()->max_growth);
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.LoopUnswitching", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.LoopUnswitching").set_body_typed(LoopUnswitching);
+
+}  // namespace transform
+
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lower_texture_access.cc
+ * \brief Lower the accesses of texture buffers to reads and writes of 2D image texels.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "../../arith/ir_mutator_with_analyzer.h"
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief A buffer of shape [height, width, 4] in the "global.texture" scope is
+ *  stored as a 2D image of RGBA texels. Its accesses, vectorized along the
+ *  channel axis, become texture2d_load and texture2d_store of the texel.
+ */
+class TextureAccessLowerer : public arith::IRMutatorWithAnalyzer {
+ public:
+  explicit TextureAccessLowerer(arith::Analyzer* analyzer) : IRMutatorWithAnalyzer(analyzer) {}
+
+  void AddTexture(const Buffer& buffer) {
+    CHECK_EQ(buffer->shape.size(), 3U)
+        << "Texture buffer " << buffer->name << " must have the shape [height, width, 4]";
+    const auto* channels = buffer->shape[2].as<IntImmNode>();
+    CHECK(channels && channels->value == 4)
+        << "Texture buffer " << buffer->name << " must have 4 channels in its last axis";
+    CHECK(buffer->strides.empty()) << "Texture buffer " << buffer->name << " must be compact";
+    CHECK(is_zero(buffer->elem_offset))
+        << "Texture buffer " << buffer->name << " must not have an element offset";
+    DataType t = buffer->dtype;
+    CHECK((t.is_float() && (t.bits() == 16 || t.bits() == 32)) ||
+          ((t.is_int() || t.is_uint()) && t.bits() == 32))
+        << "Texture buffer " << buffer->name << " has unsupported type " << t;
+    width_[buffer->data.get()] = buffer->shape[1];
+  }
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    auto it = width_.find(op->buffer_var.get());
+    if (it == width_.end()) {
+      return IRMutatorWithAnalyzer::VisitExpr_(op);
+    }
+    PrimExpr index = VisitExpr(op->index);
+    CheckPredicate(op->buffer_var, op->predicate);
+    PrimExpr x, y;
+    std::tie(x, y) = TexelCoord(op->buffer_var, index, it->second);
+    return Call(op->dtype, builtin::texture2d_load(), {op->buffer_var, x, y});
+  }
+
+  Stmt VisitStmt_(const StoreNode* op) final {
+    auto it = width_.find(op->buffer_var.get());
+    if (it == width_.end()) {
+      return IRMutatorWithAnalyzer::VisitStmt_(op);
+    }
+    PrimExpr value = VisitExpr(op->value);
+    PrimExpr index = VisitExpr(op->index);
+    CheckPredicate(op->buffer_var, op->predicate);
+    PrimExpr x, y;
+    std::tie(x, y) = TexelCoord(op->buffer_var, index, it->second);
+    return Evaluate(
+        Call(DataType::Void(), builtin::texture2d_store(), {op->buffer_var, x, y, value}));
+  }
+
+ private:
+  void CheckPredicate(const Var& buffer_var, const PrimExpr& predicate) {
+    CHECK(is_one(predicate)) << "Texture buffer " << buffer_var->name_hint
+                             << " does not support predicated accesses";
+  }
+
+  // The column and row of the texel accessed by a ramp of the 4 channels.
+  std::pair<PrimExpr, PrimExpr> TexelCoord(const Var& buffer_var, const PrimExpr& index,
+                                           const PrimExpr& width) {
+    const auto* ramp = index.as<RampNode>();
+    CHECK(ramp && ramp->lanes == 4 && is_one(ramp->stride))
+        << "Texture buffer " << buffer_var->name_hint
+        << " must be accessed as a whole texel, vectorize its channel axis";
+    CHECK(analyzer_->CanProve(floormod(ramp->base, 4) == 0))
+        << "Texture buffer " << buffer_var->name_hint << " is accessed across texels at "
+        << ramp->base;
+    PrimExpr texel = analyzer_->Simplify(floordiv(ramp->base, 4));
+    PrimExpr x = analyzer_->Simplify(floormod(texel, width));
+    PrimExpr y = analyzer_->Simplify(floordiv(texel, width));
+    return {x, y};
+  }
+
+  // the width of the texture buffers by their data var
+  std::unordered_map<const VarNode*, PrimExpr> width_;
+};
+
+namespace transform {
+
+Pass LowerTextureAccess() {
+  auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
+    arith::Analyzer analyzer;
+    TextureAccessLowerer lowerer(&analyzer);
+    bool has_texture = false;
+    for (const auto& kv : f->buffer_map) {
+      if (kv.second->scope == "global.texture") {
+        lowerer.AddTexture(kv.second);
+        has_texture = true;
+      }
+    }
+    if (!has_texture) return f;
+    auto* n = f.CopyOnWrite();
+    n->body = lowerer(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.LowerTextureAccess", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.LowerTextureAccess").set_body_typed(LowerTextureAccess);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
@@ -197,6 +197,9 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     std::vector<Stmt> seq;
     std::vector<Var> shared_bufs(size);
     std::vector<Stmt> local_vars;
+    // The shared staging buffers of multi-warp reductions.
+    std::vector<Var> staging_bufs;
+    std::vector<Stmt> staging_allocs;
     //
     // This is an optimization. For small reduction sizes, it may be beneficial
     // for a single warp to performance the entire reduction. No trips to shared
@@ -251,49 +254,9 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       }
 
       // Emit reductions within a warp.
-      for (int offset = warp_size_ / 2; offset > 0; offset /= 2) {
-        // Load reduction values, no synchronization needed.
-        Array<PrimExpr> a, b;
-        for (size_t i = 0; i < size; ++i) {
-          Var var = shared_bufs[i];
-          PrimExpr pred = const_true(types[i].lanes());
-          PrimExpr val = Load(types[i], var, index, pred);
-          a.push_back(val);
-
-          // __shfl_*sync calls shall not appear in if_then_else expressions
-          // as this is causing extra divergency. E.g.
-          //
-          // v1 = (v2 < v3) ? v3 : __shfl_sync(mask, v1, 0);
-          //
-          // behaves differently from
-          //
-          // int t = __shfl_sync(mask, v1, 0);
-          // v1 = (v2 < v3) ? v3 : t;
-          //
-          // The former may cause dead lock as there is a divergent
-          // branch with a warp sync call inside.
-          //
-          PrimExpr other = WarpShuffle(builtin::tvm_warp_shuffle_down(), mask_var, val, offset);
-          const AllocateNode* repl = local_vars[i].as<AllocateNode>();
-          Stmt s = Store(repl->buffer_var, other, index, pred);
-          seq.push_back(s);
-
-          PrimExpr load = Load(types[i], repl->buffer_var, index, pred);
-          b.push_back(load);
-        }
-
-        // Do reductions.
-        Array<PrimExpr> ret = (*combiner)(a, b);
-
-        // Store the reduction result to itself.
-        std::vector<Stmt> stores(size);
-        for (size_t i = 0; i < size; ++i) {
-          Var var = shared_bufs[i];
-          PrimExpr pred = const_true(types[i].lanes());
-          stores[i] = Store(var, ret[i], index, pred);
-        }
-        seq.push_back(SeqStmt::Flatten(stores));
-      }
+      std::vector<Stmt> warp_seq =
+          MakeWarpReduce(combiner, types, shared_bufs, local_vars, mask_var, warp_size_);
+      seq.insert(seq.end(), warp_seq.begin(), warp_seq.end());
 
       // Broadcast the reduction result from lane 0 to all other lanes.
       // This avoids to emit predicated stores, as all threads are
@@ -318,6 +281,86 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
         alloc_remap_[buffers[i]] = node;
         warp_allocs_.insert(node.get());
       }
+    } else if (is_multi_warp_reduction(types, vred, reduce_extent)) {
+      //
+      // The reduction spans several warps. Each warp reduces its values with
+      // shuffles, lane 0 of each warp writes the partial result to shared memory,
+      // and every warp then reduces the partial results with shuffles again:
+      //
+      // red_buf[0] <- warp_reduce(value)
+      // if (lane == 0) red_buf_staging[warp] <- red_buf[0]
+      // sync
+      // red_buf[0] <- warp_reduce(lane < num_warps ? red_buf_staging[lane] : identity)
+      //
+      // So no thread waits on a tree reduction in shared memory, and all
+      // threads get the result without another synchronization.
+      //
+      int num_warps = reduce_extent / warp_size_;
+      PrimExpr index(0);
+      PrimExpr lane = indexmod(reduce_index, warp_size_);
+      PrimExpr warp = indexdiv(reduce_index, warp_size_);
+      for (size_t idx = 0; idx < size; ++idx) {
+        shared_bufs[idx] = Var("red_buf" + std::to_string(idx), DataType::Handle());
+        PrimExpr pred = const_true(types[idx].lanes());
+        seq.emplace_back(Store(shared_bufs[idx], values[idx], index, pred));
+        Var var("t" + std::to_string(idx), types[idx]);
+        local_vars.push_back(Allocate(var, var.dtype(), {PrimExpr(1)}, pred, Evaluate(0)));
+      }
+      Var mask_var("mask", DataType::UInt(32));
+      {
+        PrimExpr pred = const_true(1);
+        PrimExpr mask = Call(DataType::UInt(32), builtin::tvm_warp_activemask(), {});
+        seq.emplace_back(Store(mask_var, mask, index, pred));
+        local_vars.push_back(Allocate(mask_var, mask_var->dtype, {PrimExpr(1)}, pred, Evaluate(0)));
+      }
+      std::vector<Stmt> warp_seq =
+          MakeWarpReduce(combiner, types, shared_bufs, local_vars, mask_var, warp_size_);
+      seq.insert(seq.end(), warp_seq.begin(), warp_seq.end());
+
+      // This sync is necessary because there might be incomplete read of
+      // previous iteration on the same buffer.
+      seq.emplace_back(SyncThread("shared"));
+      std::vector<Stmt> stores(size);
+      for (size_t idx = 0; idx < size; ++idx) {
+        staging_bufs.push_back(Var("red_buf_staging" + std::to_string(idx), DataType::Handle()));
+        PrimExpr pred = const_true(types[idx].lanes());
+        stores[idx] = Store(staging_bufs[idx], Load(types[idx], shared_bufs[idx], index, pred),
+                            BufIndex(warp, group_index, num_warps), pred);
+        staging_allocs.push_back(Allocate(staging_bufs[idx], types[idx],
+                                          {PrimExpr(group_extent * num_warps)}, pred,
+                                          Evaluate(0)));
+      }
+      seq.emplace_back(IfThenElse(lane == 0, SeqStmt::Flatten(stores)));
+      seq.emplace_back(SyncThread("shared"));
+      for (size_t idx = 0; idx < size; ++idx) {
+        PrimExpr pred = const_true(types[idx].lanes());
+        PrimExpr partial = Load(types[idx], staging_bufs[idx],
+                                BufIndex(lane, group_index, num_warps), pred);
+        seq.emplace_back(Store(shared_bufs[idx],
+                               if_then_else(lane < num_warps, partial, inits[idx]), index, pred));
+      }
+      int width = 1;
+      while (width < num_warps) width <<= 1;
+      warp_seq = MakeWarpReduce(combiner, types, shared_bufs, local_vars, mask_var, width);
+      seq.insert(seq.end(), warp_seq.begin(), warp_seq.end());
+
+      // Broadcast the reduction result from lane 0 to all other lanes.
+      for (size_t i = 0; i < size; ++i) {
+        PrimExpr pred = const_true(types[i].lanes());
+        PrimExpr val = Load(types[i], shared_bufs[i], index, pred);
+        PrimExpr splat = WarpShuffle(builtin::tvm_warp_shuffle(), mask_var, val, 0);
+        seq.push_back(Store(shared_bufs[i], splat, index, pred));
+      }
+
+      for (size_t i = 0; i < size; ++i) {
+        CHECK(!load_remap_.count(buffers[i]));
+        PrimExpr pred = const_true(types[i].lanes());
+        Var var = shared_bufs[i];
+        load_remap_[buffers[i]] = Load(types[i], var, index, pred);
+        auto node = Allocate(var, types[i], {PrimExpr(1)}, pred, Evaluate(0));
+        alloc_remap_[buffers[i]] = node;
+        warp_allocs_.insert(node.get());
+      }
     } else {
       int threadx_extent = 1;
       if (reduce_extent == 1) {
@@ -367,10 +410,72 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
         body = AttrStmt(repl->buffer_var, attr::storage_scope, StringImm("local"), body);
       }
     }
+    for (const Stmt& alloc : staging_allocs) {
+      const AllocateNode* repl = alloc.as<AllocateNode>();
+      body = Allocate(repl->buffer_var, repl->dtype, repl->extents, repl->condition, body);
+      body = AttrStmt(repl->buffer_var, attr::storage_scope, StringImm("shared"), body);
+    }
 
     return body;
   }
 
+  // Reduce the values in the local buffers reduce_bufs across the lanes of each
+  // warp with shuffles over strides from width / 2 down to 1, so that lane 0
+  // gets the result over lanes [0, width). The shuffled values go through the
+  // local allocations in local_vars.
+  std::vector<Stmt> MakeWarpReduce(const CommReducerNode* combiner,
+                                   const std::vector<DataType>& types,
+                                   const std::vector<Var>& reduce_bufs,
+                                   const std::vector<Stmt>& local_vars, Var mask_var, int width) {
+    size_t size = reduce_bufs.size();
+    PrimExpr index(0);
+    std::vector<Stmt> seq;
+    for (int offset = width / 2; offset > 0; offset /= 2) {
+      // Load reduction values, no synchronization needed.
+      Array<PrimExpr> a, b;
+      for (size_t i = 0; i < size; ++i) {
+        Var var = reduce_bufs[i];
+        PrimExpr pred = const_true(types[i].lanes());
+        PrimExpr val = Load(types[i], var, index, pred);
+        a.push_back(val);
+
+        // __shfl_*sync calls shall not appear in if_then_else expressions
+        // as this is causing extra divergency. E.g.
+        //
+        // v1 = (v2 < v3) ? v3 : __shfl_sync(mask, v1, 0);
+        //
+        // behaves differently from
+        //
+        // int t = __shfl_sync(mask, v1, 0);
+        // v1 = (v2 < v3) ? v3 : t;
+        //
+        // The former may cause dead lock as there is a divergent
+        // branch with a warp sync call inside.
+        //
+        PrimExpr other = WarpShuffle(builtin::tvm_warp_shuffle_down(), mask_var, val, offset);
+        const AllocateNode* repl = local_vars[i].as<AllocateNode>();
+        Stmt s = Store(repl->buffer_var, other, index, pred);
+        seq.push_back(s);
+
+        PrimExpr load = Load(types[i], repl->buffer_var, index, pred);
+        b.push_back(load);
+      }
+
+      // Do reductions.
+      Array<PrimExpr> ret = (*combiner)(a, b);
+
+      // Store the reduction result to itself.
+      std::vector<Stmt> stores(size);
+      for (size_t i = 0; i < size; ++i) {
+        Var var = reduce_bufs[i];
+        PrimExpr pred = const_true(types[i].lanes());
+        stores[i] = Store(var, ret[i], index, pred);
+      }
+      seq.push_back(SeqStmt::Flatten(stores));
+    }
+    return seq;
+  }
+
   // make allreduce.
   Stmt MakeBufAllreduce(const CommReducerNode* combiner, const std::vector<DataType>& types,
                         const Array<Var>& shared_bufs, PrimExpr reduce_index, PrimExpr group_index,
@@ -483,25 +588,7 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
   // Note: The ROCm backend will only have warp reductions for now.
   // Also, the warp/wavefront size differs (64 on rocm, 32 on cuda).
   bool is_warp_reduction(const std::vector<DataType>& types) const {
-    // Only cuda target supports warp reductions.
-    if ((target_->kind->name != "cuda") && (target_->kind->name != "rocm")) return false;
-
-    // rocm only supports 32 bit operands for shuffling at the moment
-    if ((target_->kind->name == "rocm") &&
-        (std::any_of(types.begin(), types.end(), [](DataType ty) {
-          if (ty.is_vector()) return true;
-          return ty.bits() != 32;
-        }))) {
-      return false;
-    }
-
-    // Supported types:
-    // {u}int, {u}long, {u}long long, float, double, half/half2
-    if (std::any_of(types.begin(), types.end(), [](DataType ty) {
-          if (ty.is_float16()) return ty.lanes() > 2;
-          if (ty.is_vector()) return true;
-          return ty.bytes() < 4 || ty.bytes() > 8;
-        })) {
+    if (!is_warp_shuffle_type(types)) {
       return false;
     }
     if (thread_extents_.empty()) {
@@ -522,6 +609,47 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     return e.extent == warp_size_ && e.scope.dim_index == 0 && e.scope.rank == 1;
   }
 
+  // Check if this is a reduction on threadIdx.x over several whole warps,
+  // whose partial results fit in one warp.
+  bool is_multi_warp_reduction(const std::vector<DataType>& types,
+                               const std::vector<ThreadEntry>& vred, int reduce_extent) const {
+    if (!is_warp_shuffle_type(types) || warp_size_ <= 1) {
+      return false;
+    }
+    return vred.size() == 1 && vred[0].scope.dim_index == 0 && reduce_extent > warp_size_ &&
+           reduce_extent % warp_size_ == 0 && reduce_extent / warp_size_ <= warp_size_;
+  }
+
+  // Check if the target can shuffle values of the types within a warp.
+  bool is_warp_shuffle_type(const std::vector<DataType>& types) const {
+    // Only cuda, rocm and vulkan targets support warp reductions.
+    const std::string& kind = target_->kind->name;
+    if (kind != "cuda" && kind != "rocm" && kind != "vulkan") return false;
+
+    // vulkan uses subgroup shuffles, when the subgroup size is given by thread_warp_size.
+    if (kind == "vulkan" && warp_size_ <= 1) return false;
+
+    // rocm and vulkan only support 32 bit operands for shuffling at the moment
+    if ((kind == "rocm" || kind == "vulkan") &&
+        (std::any_of(types.begin(), types.end(), [](DataType ty) {
+          if (ty.is_vector()) return true;
+          return ty.bits() != 32;
+        }))) {
+      return false;
+    }
+
+    // Supported types:
+    // {u}int, {u}long, {u}long long, float, double, half/half2
+    if (std::any_of(types.begin(), types.end(), [](DataType ty) {
+          if (ty.is_float16()) return ty.lanes() > 2;
+          if (ty.is_vector()) return true;
+          return ty.bytes() < 4 || ty.bytes() > 8;
+        })) {
+      return false;
+    }
+    return true;
+  }
+
   // The target.
   const TargetNode* target_ = nullptr;
 
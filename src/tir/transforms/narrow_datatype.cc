@@ -27,6 +27,8 @@
 #include <tvm/tir/op.h>
 #include <tvm/tir/transform.h>
 
+#include <unordered_set>
+
 #include "../../arith/ir_mutator_with_analyzer.h"
 #include "../../arith/ir_visitor_with_analyzer.h"
 
@@ -40,34 +42,31 @@ namespace tir {
 // on others, like llvm), we may want this pass when i32/i16
 // indices are more efficient.
 //
-// For Var v, we determine its dtype by examining all the PrimExpr
-// that contains v, denoted by E = {e_0 = v, e_1, e_2, ..., e_k}.
-// If all expressions in E fit into i32/i16, then we think v can be narrowed
-// to i32/i16.
-//
-// To make an indexing expression i32/i16, we must make sure that every
-// component of that expression is of dtype i32/i16. So besides Var, we
-// rewrite the following inside an indexing expression
-// - Var
-// - IntImm
-// - Cast
+// The dtype is chosen per expression. A Var is narrowed to i32/i16 when
+// its own range fits, and so are the IntImm and Cast of an indexing
+// expression. An expression whose range does not fit, like the offset
+// i * stride + j into a tensor of more than 2^31 elements, keeps its
+// original dtype and its operands are cast back to it, so the loop vars
+// and the parts of the index that fit are still computed in i32/i16:
+// int64(i) * stride + int64(j).
 //
 // Algorithm:
-// - Use DataTypeVisitor to determine whether a Var can be narrowed or not.
-// - Use DataTypeRewritter to rewrite the components of an indexing expression.
+// - Use DataTypeVisitor to determine which Vars can be narrowed and which
+//   expressions do not fit into i32/i16.
+// - Use DataTypeRewritter to rewrite the components of an indexing expression,
+//   promoting the operands of the expressions that do not fit.
 
 using arith::Analyzer;
 using arith::ConstIntBound;
 using arith::IRMutatorWithAnalyzer;
 
 // Determine the result dtype for Var, IntImm and Cast,
-// which will be stored in `vmap` eventually.
+// which will be stored in `vmap` eventually, and the expressions
+// that do not fit into `target_bits_`, which are stored in `wide`.
 //
 // Algorithm:
-// We propogate the dtypes of all the Exprs that contain Var `var` into `vmap[var]`.
-// To be more specific, if for each Expr `e` which contains `var`
-// (`var` is a child node of `e` in AST), `e` fits into `target_bits_`,
-// then we narrow `var` into `target_bits_`. That is,
+// If the range of `var` fits into `target_bits_`, then we narrow `var`
+// into `target_bits_`. That is,
 // `vmap[var] = min(target_bits_, var.dtype.bits())`
 // Otherwise, `var` is not narrowed, that is, `vmap[var] = var.dtype.bits()`
 class DataTypeVisitor final : public StmtExprVisitor {
@@ -86,8 +85,10 @@ class DataTypeVisitor final : public StmtExprVisitor {
       if (e.dtype().bits() <= target_bits_ ||
           (bound->max_value <= ubound && bound->min_value >= lbound)) {
         bits = target_bits_;
+      } else {
+        wide.insert(e.get());
       }
-      int tmp = bits > bits_ ? bits : bits_;
+      int tmp = bits;
       std::swap(bits_, tmp);
       StmtExprVisitor::VisitExpr(e);
       std::swap(bits_, tmp);
@@ -169,6 +170,8 @@ class DataTypeVisitor final : public StmtExprVisitor {
 
   // the narrowed datatype of Var and IntImm
   std::unordered_map<const PrimExprNode*, DataType> vmap;
+  // the integer expressions that do not fit into target bits in some context
+  std::unordered_set<const PrimExprNode*> wide;
 
  protected:
   // internal analyzer
@@ -205,12 +208,26 @@ class DataTypeRewriter : public StmtExprMutator {
   }
 
   Stmt VisitStmt_(const StoreNode* op) final {
-    PrimExpr value = this->VisitExpr(op->value);
     is_index_ = true;
     PrimExpr index = this->VisitExpr(op->index);
     is_index_ = false;
-    Stmt s = Store(op->buffer_var, op->value, index, op->predicate);
-    return StmtExprMutator::VisitStmt_(s.as<StoreNode>());
+    // The stored value keeps the element type of the buffer.
+    PrimExpr value = cast(op->value.dtype(), this->VisitExpr(op->value));
+    PrimExpr predicate = this->VisitExpr(op->predicate);
+    if (index.same_as(op->index) && value.same_as(op->value) &&
+        predicate.same_as(op->predicate)) {
+      return GetRef<Stmt>(op);
+    }
+    return Store(op->buffer_var, value, index, predicate);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    PrimExpr value = cast(op->var.dtype(), this->VisitExpr(op->value));
+    Stmt body = this->VisitStmt(op->body);
+    if (value.same_as(op->value) && body.same_as(op->body)) {
+      return GetRef<Stmt>(op);
+    }
+    return LetStmt(op->var, value, body);
   }
 
   Stmt VisitStmt_(const ForNode* op) final {
@@ -271,6 +288,41 @@ class DataTypeRewriter : public StmtExprMutator {
     return StmtExprMutator::VisitExpr_(e.as<LoadNode>());
   }
 
+  PrimExpr VisitExpr_(const LetNode* op) final {
+    PrimExpr value = cast(op->var.dtype(), this->VisitExpr(op->value));
+    PrimExpr body = this->VisitExpr(op->body);
+    if (value.same_as(op->value) && body.same_as(op->body)) {
+      return GetRef<PrimExpr>(op);
+    }
+    return Let(op->var, value, body);
+  }
+
+  PrimExpr VisitExpr_(const SelectNode* op) final {
+    PrimExpr condition = this->VisitExpr(op->condition);
+    PrimExpr true_value = this->VisitExpr(op->true_value);
+    PrimExpr false_value = this->VisitExpr(op->false_value);
+    if (condition.same_as(op->condition) && true_value.same_as(op->true_value) &&
+        false_value.same_as(op->false_value)) {
+      return GetRef<PrimExpr>(op);
+    }
+    MatchTypes(&true_value, &false_value);
+    return Select(condition, true_value, false_value);
+  }
+
+  PrimExpr VisitExpr_(const RampNode* op) final {
+    PrimExpr base = this->VisitExpr(op->base);
+    PrimExpr stride = this->VisitExpr(op->stride);
+    if (base.same_as(op->base) && stride.same_as(op->stride)) {
+      return GetRef<PrimExpr>(op);
+    }
+    if (visitor_.wide.count(op)) {
+      base = cast(op->base.dtype(), base);
+      stride = cast(op->stride.dtype(), stride);
+    }
+    MatchTypes(&base, &stride);
+    return Ramp(base, stride, op->lanes);
+  }
+
   PrimExpr VisitExpr_(const IntImmNode* op) final {
     if (is_index_) {
       if (visitor_.vmap.find(op) != visitor_.vmap.end()) {
@@ -286,7 +338,7 @@ class DataTypeRewriter : public StmtExprMutator {
       const CastNode* new_op = e.as<CastNode>();
       CHECK(new_op != nullptr) << "Expected type to be CastNode"
                                << ", but get " << e->GetTypeKey();
-      return Cast(visitor_.vmap[op], new_op->value);
+      return cast(visitor_.vmap[op], new_op->value);
     }
     return StmtExprMutator::VisitExpr_(op);
   }
@@ -309,6 +361,15 @@ class DataTypeRewriter : public StmtExprMutator {
   PrimExpr VisitExpr_(const CallNode* op) final;
 
  private:
+  // Cast the narrower of a and b to the dtype of the other.
+  static void MatchTypes(PrimExpr* a, PrimExpr* b) {
+    if (a->dtype().bits() < b->dtype().bits()) {
+      *a = cast(b->dtype(), *a);
+    } else if (b->dtype().bits() < a->dtype().bits()) {
+      *b = cast(a->dtype(), *b);
+    }
+  }
+
   // the internal visitor to deduce the narrowed dtype
   DataTypeVisitor visitor_;
   // a map from Var before rewrite to that after rewrite,
@@ -323,15 +384,20 @@ class DataTypeRewriter : public StmtExprMutator {
   const Op& builtin_pow_ = Op::Get("tir.pow");
 };
 
+// An expression that does not fit into the target bits is computed in its
+// original dtype, from narrowed operands cast back to it.
 #define DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(OP, FUNC) \
   PrimExpr DataTypeRewriter::VisitExpr_(const OP* op) {   \
     PrimExpr a = this->VisitExpr(op->a);                  \
     PrimExpr b = this->VisitExpr(op->b);                  \
     if (a.same_as(op->a) && b.same_as(op->b)) {           \
       return GetRef<PrimExpr>(op);                        \
-    } else {                                              \
-      return FUNC(a, b);                                  \
     }                                                     \
+    if (visitor_.wide.count(op)) {                        \
+      a = cast(op->a.dtype(), a);                         \
+      b = cast(op->b.dtype(), b);                         \
+    }                                                     \
+    return FUNC(a, b);                                    \
   }
 
 DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(AddNode, operator+);
@@ -351,10 +417,19 @@ DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(GTNode, operator>);  // NOLINT(*)
 DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(GENode, operator>=);
 
 PrimExpr DataTypeRewriter::VisitExpr_(const CallNode* op) {
+  const CallNode* origin = op;
   PrimExpr e = StmtExprMutator::VisitExpr_(op);
   op = e.as<CallNode>();
   CHECK(op != nullptr) << "Expected type to be CallNode"
                        << ", but get " << e->GetTypeKey();
+  if (visitor_.wide.count(origin) && !e.same_as(GetRef<PrimExpr>(origin))) {
+    Array<PrimExpr> args;
+    for (size_t i = 0; i < op->args.size(); ++i) {
+      args.push_back(cast(origin->args[i].dtype(), op->args[i]));
+    }
+    e = Call(op->dtype, op->op, args);
+    op = e.as<CallNode>();
+  }
 
   if (op->op.same_as(builtin::if_then_else())) {
     return if_then_else(op->args[0], op->args[1], op->args[2]);
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pgo_profile.cc
+ * \brief The profiles of the branches and loops of CPU kernels.
+ */
+#include "pgo_profile.h"
+
+#include <dmlc/json.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace tvm {
+namespace tir {
+
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.pgo_profile", String);
+
+std::shared_ptr<const PGOProfile> PGOProfile::FromContext(const transform::PassContext& ctx) {
+  String path = ctx->GetConfig<String>("tir.pgo_profile", String("")).value();
+  if (path.empty()) return nullptr;
+  // The passes ask for the profile once per function, parse it once per context.
+  // The context is held so that its address is not reused by another one.
+  static std::mutex mutex;
+  static transform::PassContext last_ctx;
+  static std::string last_path;
+  static std::shared_ptr<const PGOProfile> last_profile;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (last_ctx.same_as(ctx) && last_path == path) return last_profile;
+  std::ifstream is(path);
+  CHECK(!is.fail()) << "Cannot open the PGO profile " << path;
+  auto profile = std::make_shared<PGOProfile>();
+  dmlc::JSONReader reader(&is);
+  reader.Read(&profile->sites_);
+  last_ctx = ctx;
+  last_path = path;
+  last_profile = profile;
+  return profile;
+}
+
+namespace {
+
+/*!
+ * \brief Name the loops by their path from the root of the function. A step of the
+ *  path is the name of a loop and its rank among the loops of the same name nested
+ *  directly in the same loop, so that the loops which share a name are told apart.
+ */
+class LoopPathCollector : public StmtVisitor {
+ public:
+  explicit LoopPathCollector(const std::string& func) : path_(func + ":for:") {}
+
+  void VisitStmt_(const ForNode* op) final {
+    std::string name = op->loop_var->name_hint;
+    int rank = ranks_.back()[name]++;
+    std::string path = path_;
+    path_ += (ranks_.size() == 1 ? "" : "/") + name + "#" + std::to_string(rank);
+    keys[op->loop_var.get()] = path_;
+    ranks_.emplace_back();
+    StmtVisitor::VisitStmt_(op);
+    ranks_.pop_back();
+    path_ = path;
+  }
+
+  std::unordered_map<const VarNode*, std::string> keys;
+
+ private:
+  std::string path_;
+  std::vector<std::unordered_map<std::string, int>> ranks_{1};
+};
+
+}  // namespace
+
+std::unordered_map<const VarNode*, std::string> PGOProfile::LoopKeys(const std::string& func,
+                                                                    const Stmt& body) {
+  LoopPathCollector collector(func);
+  collector(body);
+  return std::move(collector.keys);
+}
+
+std::string PGOProfile::BranchKey(const std::string& func, const PrimExpr& condition) {
+  std::ostringstream os;
+  os << func << ":if:" << condition;
+  return os.str();
+}
+
+bool PGOProfile::Lookup(const std::string& key, int64_t* first, int64_t* second) const {
+  auto it = sites_.find(key);
+  if (it == sites_.end() || it->second.size() != 2) return false;
+  *first = it->second[0];
+  *second = it->second[1];
+  return true;
+}
+
+std::unordered_set<const VarNode*> PGOProfile::ColdLoops(const PrimFunc& f) const {
+  std::unordered_set<const VarNode*> cold;
+  auto global_symbol = f->GetAttr<String>(tvm::attr::kGlobalSymbol);
+  if (!global_symbol.defined()) return cold;
+  for (const auto& kv : LoopKeys(global_symbol.value(), f->body)) {
+    int64_t entries, iterations;
+    if (Lookup(kv.second, &entries, &iterations) && iterations == 0) {
+      cold.insert(kv.first);
+    }
+  }
+  return cold;
+}
+
+}  // namespace tir
+}  // namespace tvm
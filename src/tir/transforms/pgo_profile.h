@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file pgo_profile.h
+ * \brief The profiles of the branches and loops of CPU kernels.
+ *
+ *  A module built with the "codegen.llvm.pgo_instrument" config counts the runs
+ *  of its sites. The JSON profile of the counters is rebuilt from with the
+ *  "tir.pgo_profile" config: the LLVM codegen weights the branches with it and
+ *  the loop passes do not grow the loops which never ran.
+ *
+ *  A site is keyed by its function and the path of its loop from the root of the
+ *  function or its branch condition, so the sites are matched across builds which
+ *  lower the function alike.
+ *  Each site has two counters: the entries and the iterations of a loop, the
+ *  runs and the taken runs of a branch.
+ */
+#ifndef TVM_TIR_TRANSFORMS_PGO_PROFILE_H_
+#define TVM_TIR_TRANSFORMS_PGO_PROFILE_H_
+
+#include <tvm/ir/transform.h>
+#include <tvm/tir/function.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+class PGOProfile {
+ public:
+  /*!
+   * \brief Load the profile named by the "tir.pgo_profile" config.
+   * \param ctx The pass context.
+   * \return The profile, nullptr when none is configured.
+   * \note The profile is parsed once per context.
+   */
+  static std::shared_ptr<const PGOProfile> FromContext(const transform::PassContext& ctx);
+
+  /*!
+   * \brief Get the keys of the loops of a function.
+   * \param func The global symbol of the function.
+   * \param body The body of the function.
+   * \return The key of each loop variable, which names the path of its loop.
+   */
+  static std::unordered_map<const VarNode*, std::string> LoopKeys(const std::string& func,
+                                                                  const Stmt& body);
+
+  /*! \return The key of a branch of a function. */
+  static std::string BranchKey(const std::string& func, const PrimExpr& condition);
+
+  /*!
+   * \brief Look up the counters of a site.
+   * \param key The key of the site.
+   * \param first The entries of a loop, the runs of a branch.
+   * \param second The iterations of a loop, the taken runs of a branch.
+   * \return Whether the site is in the profile.
+   */
+  bool Lookup(const std::string& key, int64_t* first, int64_t* second) const;
+
+  /*! \return The loops of a function which were profiled and never iterated. */
+  std::unordered_set<const VarNode*> ColdLoops(const PrimFunc& f) const;
+
+ private:
+  std::map<std::string, std::vector<int64_t>> sites_;
+};
+
+}  // namespace tir
+}  // namespace tvm
+#endif  // TVM_TIR_TRANSFORMS_PGO_PROFILE_H_
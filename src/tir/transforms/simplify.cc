@@ -101,10 +101,15 @@ class StmtSimplifier : public IRMutatorWithAnalyzer {
 namespace tir {
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("arith.memoize", Bool);
+
 Pass Simplify() {
   auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
     auto* n = f.CopyOnWrite();
     arith::Analyzer analyzer;
+    if (ctx->GetConfig<Bool>("arith.memoize", Bool(false)).value()) {
+      analyzer.EnableMemo();
+    }
     n->body = arith::StmtSimplifier(&analyzer).Simplify(std::move(n->body));
     return f;
   };
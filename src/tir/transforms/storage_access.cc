@@ -149,10 +149,11 @@ void StorageAccessVisitor::VisitStmt_(const ForNode* op) {
     std::unordered_map<const VarNode*, arith::IntSet> relax_map;
     relax_map[op->loop_var.get()] =
         arith::IntSet::FromRange(Range::FromMinExtent(op->min, op->extent));
+    arith::RegionEvaluator evaluator(relax_map);
     for (AccessEntry& e : s.access) {
       if (e.buffer.defined()) {
         CHECK(e.touched.defined());
-        e.touched = arith::EvalSet(e.touched, relax_map);
+        e.touched = evaluator.Eval(e.touched);
       }
     }
   }
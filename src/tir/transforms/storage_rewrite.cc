@@ -31,7 +31,10 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -44,6 +47,25 @@ namespace tir {
 using runtime::StorageRank;
 using runtime::StorageScope;
 
+struct StorageRewriteConfigNode : public tvm::AttrsNode<StorageRewriteConfigNode> {
+  bool merge_arena;
+
+  TVM_DECLARE_ATTRS(StorageRewriteConfigNode, "tir.transform.StorageRewriteConfig") {
+    TVM_ATTR_FIELD(merge_arena)
+        .describe("Pack the global and shared buffers of each scope into one arena")
+        .set_default(false);
+  }
+};
+
+class StorageRewriteConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(StorageRewriteConfig, Attrs,
+                                            StorageRewriteConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(StorageRewriteConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.StorageRewrite", StorageRewriteConfig);
+
 // Find a linear pattern of storage access
 // Used for liveness analysis.
 // Composite scopes(loop/thread_launch/IfThen) is represented by two points:
@@ -336,8 +358,18 @@ class StoragePlanRewriter : public StmtExprMutator {
   using StmtEntry = LinearAccessPatternFinder::StmtEntry;
   using AllocEntry = LinearAccessPatternFinder::AllocEntry;
 
-  Stmt Rewrite(Stmt stmt, bool detect_inplace) {
+  Stmt Rewrite(Stmt stmt, bool detect_inplace, bool merge_arena = false) {
     detect_inplace_ = detect_inplace;
+    merge_arena_ = merge_arena;
+    if (merge_arena_) {
+      PostOrderVisit(stmt, [this](const ObjectRef& n) {
+        if (const auto* load = n.as<LoadNode>()) {
+          RecordAccess(load->buffer_var.get(), load->dtype);
+        } else if (const auto* store = n.as<StoreNode>()) {
+          RecordAccess(store->buffer_var.get(), store->value.dtype());
+        }
+      });
+    }
     // plan the rewrite
     LinearAccessPatternFinder finder;
     finder(stmt);
@@ -482,6 +514,10 @@ class StoragePlanRewriter : public StmtExprMutator {
     // This allows effective sharing among different types as long as their alignment
     // requirement fits into the max_simd_bits.
     uint64_t bits_offset{0};
+    // The first and last position in the linear access sequence where
+    // one of the allocs is live.
+    int64_t live_begin{-1};
+    int64_t live_end{-1};
   };
 
   // Alllocate entry of node.
@@ -507,10 +543,18 @@ class StoragePlanRewriter : public StmtExprMutator {
   // Remap the index
   PrimExpr RemapIndex(DataType dtype, PrimExpr index, StorageEntry* e) {
     if (e->bits_offset == 0) return index;
-    uint64_t elem_bits = dtype.bits() * dtype.lanes();
+    // A vector index, such as a ramp, counts elements, a scalar one counts vectors.
+    uint64_t elem_bits = dtype.bits() * (dtype.lanes() / index.dtype().lanes());
     CHECK_EQ(e->bits_offset % elem_bits, 0U);
     return make_const(index.dtype(), e->bits_offset / elem_bits) + index;
   }
+  // Record the width of an access, the arena aligns the buffers to the widest.
+  void RecordAccess(const VarNode* buffer, DataType dtype) {
+    uint64_t bits = 1;
+    while (bits < static_cast<uint64_t>(dtype.bits() * dtype.lanes())) bits *= 2;
+    uint64_t& widest = access_bits_[buffer];
+    widest = std::max(widest, bits);
+  }
   // Prepare the new allocations
   void PrepareNewAlloc() {
     for (size_t i = 0; i < alloc_vec_.size(); ++i) {
@@ -608,6 +652,107 @@ class StoragePlanRewriter : public StmtExprMutator {
         }
       }
     }
+    if (merge_arena_) {
+      for (auto& kv : attach_map_) {
+        MergeArena(&kv.second);
+      }
+    }
+  }
+  // Pack the constant size entries of each global or shared scope attached at
+  // the same place into one arena. The offsets in the arena color the interval
+  // graph of the lifetimes of the entries: the largest entries are placed first,
+  // each at the lowest offset that is free during its lifetime. So entries of
+  // any element type that are not live at the same time share memory, which
+  // the free list only does for entries of the same type.
+  void MergeArena(std::vector<StorageEntry*>* vec) {
+    std::map<std::string, std::vector<StorageEntry*>> groups;
+    for (StorageEntry* e : *vec) {
+      if (e->scope.tag.length() != 0 ||
+          (e->scope.rank != StorageRank::kGlobal && e->scope.rank != StorageRank::kShared)) {
+        continue;
+      }
+      if (!e->new_alloc.defined() || e->const_nbits == 0 || e->elem_type.is_handle()) continue;
+      if (e->live_end < e->live_begin) {
+        e->live_end = std::numeric_limits<int64_t>::max();
+      }
+      uint64_t elem_bits = ElemBits(e);
+      // offsets must be multiples of the size of every element type
+      if ((elem_bits & (elem_bits - 1)) != 0) continue;
+      groups[e->scope.to_string()].push_back(e);
+    }
+    for (auto& kv : groups) {
+      std::vector<StorageEntry*>& entries = kv.second;
+      if (entries.size() < 2) continue;
+      // Align to 128 bits for vector accesses, at least.
+      uint64_t align = 128;
+      DataType arena_type = entries[0]->allocs[0]->dtype;
+      for (StorageEntry* e : entries) {
+        align = std::max(align, ElemBits(e));
+        for (const AllocateNode* op : e->allocs) {
+          auto it = access_bits_.find(op->buffer_var.get());
+          if (it != access_bits_.end()) align = std::max(align, it->second);
+          if (op->dtype.bits() * op->dtype.lanes() > arena_type.bits() * arena_type.lanes()) {
+            arena_type = op->dtype;
+          }
+        }
+      }
+      auto aligned_size = [align](const StorageEntry* e) {
+        return (e->const_nbits + align - 1) / align * align;
+      };
+      std::stable_sort(entries.begin(), entries.end(),
+                       [&](const StorageEntry* a, const StorageEntry* b) {
+                         return aligned_size(a) > aligned_size(b);
+                       });
+      std::vector<std::pair<uint64_t, StorageEntry*>> placed;
+      uint64_t total_bits = 0, arena_bits = 0;
+      for (StorageEntry* e : entries) {
+        uint64_t size = aligned_size(e);
+        total_bits += size;
+        // the ranges used by the placed entries live at the same time
+        std::vector<std::pair<uint64_t, uint64_t>> used;
+        for (const auto& p : placed) {
+          if (p.second->live_begin <= e->live_end && e->live_begin <= p.second->live_end) {
+            used.emplace_back(p.first, p.first + aligned_size(p.second));
+          }
+        }
+        std::sort(used.begin(), used.end());
+        uint64_t offset = 0;
+        for (const auto& range : used) {
+          if (offset + size <= range.first) break;
+          offset = std::max(offset, range.second);
+        }
+        placed.emplace_back(offset, e);
+        arena_bits = std::max(arena_bits, offset + size);
+      }
+      if (arena_bits >= total_bits) continue;
+
+      std::unique_ptr<StorageEntry> arena(new StorageEntry());
+      arena->attach_scope_ = entries[0]->attach_scope_;
+      arena->scope = entries[0]->scope;
+      arena->elem_type = arena_type.element_of();
+      arena->const_nbits = arena_bits;
+      arena->alloc_var = Var(kv.first + "_arena", DataType::Handle());
+      uint64_t type_bits = arena_type.bits() * arena_type.lanes();
+      arena->new_alloc =
+          Allocate(arena->alloc_var, arena_type,
+                   {make_const(DataType::Int(32), arena_bits / type_bits)}, const_true(),
+                   Evaluate(0));
+      for (const auto& p : placed) {
+        p.second->alloc_var = arena->alloc_var;
+        p.second->bits_offset = p.first;
+        p.second->new_alloc = Stmt();
+      }
+      vec->push_back(arena.get());
+      alloc_vec_.emplace_back(std::move(arena));
+    }
+  }
+  // The largest number of bits of an element of the allocs of an entry.
+  static uint64_t ElemBits(const StorageEntry* e) {
+    uint64_t bits = 0;
+    for (const AllocateNode* op : e->allocs) {
+      bits = std::max(bits, static_cast<uint64_t>(op->dtype.bits() * op->dtype.lanes()));
+    }
+    return bits;
   }
   // New allocation for merged data
   void NewAllocTagMerged(StorageEntry* e) {
@@ -748,6 +893,9 @@ class StoragePlanRewriter : public StmtExprMutator {
             dst_entry = FindAlloc(ae.alloc, thread_scope_, ae.storage_scope);
           }
           dst_entry->allocs.emplace_back(ae.alloc);
+          if (dst_entry->live_begin < 0) {
+            dst_entry->live_begin = static_cast<int64_t>(i);
+          }
           alloc_map_[var] = dst_entry;
         }
       }
@@ -774,6 +922,10 @@ class StoragePlanRewriter : public StmtExprMutator {
       // In both cases, we need to handle the kill event correctly
       if (it != event_map_.end() && seq[i].scope_pair_offset <= 0) {
         for (const VarNode* var : it->second.kill) {
+          auto entry = alloc_map_.find(var);
+          if (entry != alloc_map_.end()) {
+            entry->second->live_end = static_cast<int64_t>(i);
+          }
           // skip space which are already replaced by inplace
           if (!inplace_flag.count(var)) {
             this->Free(var);
@@ -881,6 +1033,10 @@ class StoragePlanRewriter : public StmtExprMutator {
   const Object* thread_scope_{nullptr};
   // whether enable inplace detection.
   bool detect_inplace_{false};
+  // whether to pack the buffers into arenas.
+  bool merge_arena_{false};
+  // The widest access into each buffer in bits, rounded up to a power of two.
+  std::unordered_map<const VarNode*, uint64_t> access_bits_;
   // Locations of free ops.
   std::unordered_map<const Object*, EventEntry> event_map_;
   // constant size free map.
@@ -999,8 +1155,13 @@ namespace transform {
 
 Pass StorageRewrite() {
   auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
+    auto cfg = ctx->GetConfig<StorageRewriteConfig>("tir.StorageRewrite");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<StorageRewriteConfig>();
+    }
     auto* n = f.CopyOnWrite();
-    n->body = StoragePlanRewriter().Rewrite(std::move(n->body), true);
+    n->body =
+        StoragePlanRewriter().Rewrite(std::move(n->body), true, cfg.value()->merge_arena);
     n->body = VectorAllocRewriter()(std::move(n->body));
     return f;
   };
@@ -23,17 +23,22 @@
  */
 // Unrolls the loop as in Halide pipeline.
 #include <tvm/arith/analyzer.h>
+#include <tvm/arith/pattern.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "ir_util.h"
+#include "pgo_profile.h"
 
 namespace tvm {
 namespace tir {
@@ -43,6 +48,7 @@ struct UnrollLoopConfigNode : public tvm::AttrsNode<UnrollLoopConfigNode> {
   int auto_max_depth;
   int auto_max_extent;
   int explicit_unroll;
+  int auto_unroll_and_jam;
 
   TVM_DECLARE_ATTRS(UnrollLoopConfigNode, "tir.transform.UnrollLoopConfig") {
     TVM_ATTR_FIELD(auto_max_step)
@@ -57,6 +63,9 @@ struct UnrollLoopConfigNode : public tvm::AttrsNode<UnrollLoopConfigNode> {
     TVM_ATTR_FIELD(explicit_unroll)
         .describe("Whether to explicitly unroll the loop instead of setting a pragma")
         .set_default(true);
+    TVM_ATTR_FIELD(auto_unroll_and_jam)
+        .describe("The maximum factor to automatically unroll and jam loops by, 0 to disable")
+        .set_default(0);
   }
 };
 
@@ -68,14 +77,50 @@ class UnrollLoopConfig : public Attrs {
 TVM_REGISTER_NODE_TYPE(UnrollLoopConfigNode);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.UnrollLoop", UnrollLoopConfig);
 
+// Collect the memory accesses of the body of an innermost loop, to check that
+// it can be jammed with the copies of the enclosing loop body.
+class JamAccessCollector : public StmtExprVisitor {
+ public:
+  void VisitStmt_(const ForNode* op) final { unsafe_ = true; }
+  void VisitStmt_(const AllocateNode* op) final { unsafe_ = true; }
+  void VisitStmt_(const LetStmtNode* op) final { unsafe_ = true; }
+  void VisitExpr_(const LetNode* op) final { unsafe_ = true; }
+
+  void VisitStmt_(const StoreNode* op) final {
+    written_.insert(op->buffer_var.get());
+    accesses_[op->buffer_var.get()].push_back(op->index);
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const LoadNode* op) final {
+    accesses_[op->buffer_var.get()].push_back(op->index);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (SideEffect(GetRef<PrimExpr>(op)) > CallEffectKind::kReadState) {
+      unsafe_ = true;
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  // Whether the body touches memory other than through loads and stores.
+  bool unsafe_{false};
+  std::unordered_set<const VarNode*> written_;
+  std::unordered_map<const VarNode*, std::vector<PrimExpr>> accesses_;
+};
+
 class LoopUnroller : public StmtExprMutator {
  public:
   explicit LoopUnroller(int auto_max_step, int auto_max_depth, int auto_max_extent,
-                        bool explicit_unroll)
+                        bool explicit_unroll, int auto_unroll_and_jam,
+                        std::unordered_set<const VarNode*> cold_loops = {})
       : auto_max_step_(auto_max_step),
         auto_max_depth_(auto_max_depth),
         auto_max_extent_(auto_max_extent),
-        explicit_unroll_(explicit_unroll) {}
+        explicit_unroll_(explicit_unroll),
+        auto_unroll_and_jam_(auto_unroll_and_jam),
+        cold_loops_(std::move(cold_loops)) {}
 
   Stmt VisitStmt_(const AttrStmtNode* op) final {
     if (op->attr_key == "pragma_auto_unroll_max_step") {
@@ -90,18 +135,34 @@ class LoopUnroller : public StmtExprMutator {
       Stmt ret = this->VisitStmt(op->body);
       std::swap(explicit_unroll, explicit_unroll_);
       return ret;
+    } else if (op->attr_key == "pragma_unroll_and_jam") {
+      int factor = static_cast<int>(Downcast<Integer>(op->value)->value);
+      const ForNode* loop = op->body.as<ForNode>();
+      if (loop != nullptr && CanUnrollAndJam(loop, factor)) {
+        return this->VisitStmt(UnrollAndJam(loop, factor));
+      }
+      LOG(WARNING) << "Cannot unroll and jam loop " << op->node << " by " << factor;
+      return this->VisitStmt(op->body);
     } else {
       return StmtExprMutator::VisitStmt_(op);
     }
   }
 
   Stmt VisitStmt_(const ForNode* op) {
+    bool cold = cold_loops_.count(op->loop_var.get());
+    if (auto_unroll_and_jam_ > 1 && !jammed_.count(op->loop_var.get()) && !cold) {
+      int factor = AutoJamFactor(op);
+      if (factor > 1) {
+        return this->VisitStmt(UnrollAndJam(op, factor));
+      }
+    }
     Stmt stmt = StmtExprMutator::VisitStmt_(op);
     op = stmt.as<ForNode>();
     int value = GetExtent(op);
     // condition for auto unroll
+    // the loops which never ran in the profile are not grown.
     bool auto_unroll = (op->for_type == ForType::Serial && value >= 0 && normal_loop_depth_ == 0 &&
-                        unroll_depth_ <= auto_max_depth_);
+                        unroll_depth_ <= auto_max_depth_ && !cold);
 
     auto_unroll =
         auto_unroll && (value * step_count_ <= auto_max_step_ || value <= auto_max_extent_);
@@ -176,7 +237,121 @@ class LoopUnroller : public StmtExprMutator {
     return SeqStmt::Flatten(unrolled);
   }
 
+  /*!
+   * \brief Unroll the outer loop of a perfect nest of two loops by factor, and jam
+   *  the copies of its body into one inner loop:
+   *
+   *    for (i, 0, 2 * n) { for (j, 0, m) { B(i, j) } }
+   *
+   *  becomes
+   *
+   *    for (i.jam, 0, n) { for (j, 0, m) { B(2 * i.jam, j); B(2 * i.jam + 1, j) } }
+   *
+   *  The remaining iterations of the outer loop run after it in the original form.
+   */
+  Stmt UnrollAndJam(const ForNode* op, int factor) {
+    const ForNode* inner = op->body.as<ForNode>();
+    int value = GetExtent(op);
+    DataType dtype = op->loop_var.dtype();
+    Var jam_var = op->loop_var.copy_with_suffix(".jam");
+    jammed_.insert(jam_var.get());
+    Map<Var, PrimExpr> vmap;
+    Array<Stmt> jammed;
+    for (int i = 0; i < factor; ++i) {
+      vmap.Set(op->loop_var, op->min + jam_var * make_const(dtype, factor) + make_const(dtype, i));
+      jammed.push_back(Substitute(inner->body, vmap));
+    }
+    Stmt body = For(inner->loop_var, inner->min, inner->extent, inner->for_type,
+                    inner->device_api, SeqStmt::Flatten(jammed));
+    Stmt ret = For(jam_var, make_const(dtype, 0), make_const(dtype, value / factor),
+                   ForType::Serial, op->device_api, body);
+    if (value % factor != 0) {
+      jammed_.insert(op->loop_var.get());
+      Stmt tail = For(op->loop_var, op->min + make_const(dtype, value / factor * factor),
+                      make_const(dtype, value % factor), op->for_type, op->device_api, op->body);
+      ret = SeqStmt({ret, tail});
+    }
+    return ret;
+  }
+
  private:
+  // Check that op is a perfect nest of two serial loops with constant extents, so
+  // the outer loop can be unrolled and jammed by factor without reordering the
+  // accesses to the same element of a buffer that the body writes.
+  bool CanUnrollAndJam(const ForNode* op, int factor) {
+    const ForNode* inner = op->body.as<ForNode>();
+    if (factor < 2 || inner == nullptr || op->for_type != ForType::Serial ||
+        inner->for_type != ForType::Serial || GetExtent(op) < factor || GetExtent(inner) < 0 ||
+        ExprUseVar(inner->min, op->loop_var) || ExprUseVar(inner->extent, op->loop_var)) {
+      return false;
+    }
+    JamAccessCollector collector;
+    collector(inner->body);
+    if (collector.unsafe_) return false;
+    int64_t inner_extent = GetExtent(inner);
+    for (const VarNode* buffer : collector.written_) {
+      const std::vector<PrimExpr>& indices = collector.accesses_[buffer];
+      for (const PrimExpr& index : indices) {
+        if (!StructuralEqual()(index, indices[0])) return false;
+      }
+      // Iterations (i, j) and (i + di, j - dj) with 0 < di < factor and dj > 0 swap
+      // their order, so they must not touch the same element.
+      int64_t outer_coeff, inner_coeff;
+      if (!GetCoeffs(indices[0], op->loop_var, inner->loop_var, &outer_coeff, &inner_coeff)) {
+        return false;
+      }
+      if (outer_coeff == 0 && inner_coeff == 0) return false;
+      if (outer_coeff == 0 || inner_coeff == 0 || (outer_coeff > 0) != (inner_coeff > 0)) {
+        continue;
+      }
+      for (int64_t di = 1; di < factor; ++di) {
+        int64_t delta = std::abs(outer_coeff) * di;
+        if (delta % std::abs(inner_coeff) == 0 && delta / std::abs(inner_coeff) < inner_extent) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // The factor to unroll and jam op by automatically, 1 if it should not be. The
+  // outer loop is jammed when the body loads values that do not depend on it, so
+  // that the copies share them in registers.
+  int AutoJamFactor(const ForNode* op) {
+    const ForNode* inner = op->body.as<ForNode>();
+    int value = GetExtent(op);
+    if (inner == nullptr || value < 2) return 1;
+    bool reuse = false;
+    PostOrderVisit(inner->body, [&](const ObjectRef& node) {
+      if (const auto* load = node.as<LoadNode>()) {
+        int64_t outer_coeff, inner_coeff;
+        if (GetCoeffs(load->index, op->loop_var, inner->loop_var, &outer_coeff, &inner_coeff) &&
+            outer_coeff == 0) {
+          reuse = true;
+        }
+      }
+    });
+    if (!reuse) return 1;
+    for (int factor = std::min(auto_unroll_and_jam_, value); factor > 1; --factor) {
+      if (value % factor == 0 && CanUnrollAndJam(op, factor)) return factor;
+    }
+    return 1;
+  }
+
+  // Get the constant coefficients of the outer and inner loop variables in index.
+  bool GetCoeffs(const PrimExpr& index, const Var& outer, const Var& inner, int64_t* outer_coeff,
+                 int64_t* inner_coeff) {
+    Array<PrimExpr> coeffs = arith::DetectLinearEquation(index, {outer, inner});
+    if (coeffs.empty()) return false;
+    const auto* outer_imm = analyzer_.Simplify(coeffs[0]).as<IntImmNode>();
+    const auto* inner_imm = analyzer_.Simplify(coeffs[1]).as<IntImmNode>();
+    if (outer_imm == nullptr || inner_imm == nullptr) return false;
+    *outer_coeff = outer_imm->value;
+    *inner_coeff = inner_imm->value;
+    return true;
+  }
+
+
   // returns the extent of the loop if it's a constant integer, otherwise return -1
   int GetExtent(const ForNode* op) {
     // constant folding.
@@ -198,6 +373,12 @@ class LoopUnroller : public StmtExprMutator {
   // this not not count the total steps, only count the number of loops
   int auto_max_extent_;
   bool explicit_unroll_;
+  // max factor to auto unroll and jam
+  int auto_unroll_and_jam_;
+  // loops created by unroll and jam, which are not jammed again
+  std::unordered_set<const VarNode*> jammed_;
+  // loops which never iterated in the PGO profile
+  std::unordered_set<const VarNode*> cold_loops_;
   // Number of normal loops in scope
   int normal_loop_depth_{0};
   // number of unrolled cases in current scope.
@@ -208,9 +389,11 @@ class LoopUnroller : public StmtExprMutator {
   arith::Analyzer analyzer_;
 };
 
-Stmt UnrollLoop(Stmt stmt, UnrollLoopConfig cfg) {
+Stmt UnrollLoop(Stmt stmt, UnrollLoopConfig cfg,
+                std::unordered_set<const VarNode*> cold_loops = {}) {
   Stmt ret = LoopUnroller(cfg->auto_max_step, cfg->auto_max_depth, cfg->auto_max_extent,
-                          cfg->explicit_unroll)(stmt);
+                          cfg->explicit_unroll, cfg->auto_unroll_and_jam,
+                          std::move(cold_loops))(stmt);
   if (!ret.same_as(stmt)) {
     return ConvertSSA(ret);
   } else {
@@ -227,7 +410,11 @@ Pass UnrollLoop() {
     if (!cfg.defined()) {
       cfg = AttrsWithDefaultValues<UnrollLoopConfig>();
     }
-    n->body = UnrollLoop(std::move(f->body), cfg.value());
+    std::unordered_set<const VarNode*> cold_loops;
+    if (auto profile = PGOProfile::FromContext(ctx)) {
+      cold_loops = profile->ColdLoops(f);
+    }
+    n->body = UnrollLoop(std::move(f->body), cfg.value(), std::move(cold_loops));
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.UnrollLoop", {});
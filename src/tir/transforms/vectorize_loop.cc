@@ -109,6 +109,11 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     Stmt ret = StmtMutator::VisitStmt(stmt);
     if (need_scalarize_) {
       need_scalarize_ = false;
+      if (predicate_.defined()) {
+        // The scalarized statement would ignore the mask, give up on the whole branch.
+        predicate_failed_ = true;
+        return ret;
+      }
       return Scalarize(stmt);
     } else {
       return ret;
@@ -247,8 +252,11 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr MutateIfThenElseExpr_(const CallNode* op) {
     PrimExpr cond = this->VisitExpr(op->args[0]);
     if (cond.dtype().is_vector()) {
-      need_scalarize_ = true;
-      return GetRef<PrimExpr>(op);
+      // Evaluate both sides, each one only reads memory in the lanes which select it.
+      PrimExpr t = VisitPredicated(op->args[1], cond);
+      PrimExpr f = VisitPredicated(op->args[2], !cond);
+      int lanes = std::max(std::max(cond.dtype().lanes(), t.dtype().lanes()), f.dtype().lanes());
+      return Select(BroadcastTo(cond, lanes), BroadcastTo(t, lanes), BroadcastTo(f, lanes));
     }
     PrimExpr t = this->VisitExpr(op->args[1]);
     PrimExpr f = this->VisitExpr(op->args[2]);
@@ -300,10 +308,14 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr VisitExpr_(const LoadNode* op) final {
     PrimExpr index = this->VisitExpr(op->index);
     PrimExpr pred = this->VisitExpr(op->predicate);
-    if (index.same_as(op->index) && pred.same_as(op->predicate)) {
+    if (index.same_as(op->index) && pred.same_as(op->predicate) && !predicate_.defined()) {
       return GetRef<PrimExpr>(op);
     } else {
       int lanes = std::max(index.dtype().lanes(), pred.dtype().lanes());
+      if (predicate_.defined()) {
+        lanes = std::max(lanes, predicate_.dtype().lanes());
+        pred = MaskPredicate(BroadcastTo(pred, lanes));
+      }
       return Load(op->dtype.with_lanes(lanes), op->buffer_var, BroadcastTo(index, lanes),
                   BroadcastTo(pred, lanes));
     }
@@ -338,14 +350,26 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   }
   // Store
   Stmt VisitStmt_(const StoreNode* op) final {
+    if (var_lanes_ == 4 && !predicate_.defined()) {
+      Stmt dot = VectorizeDotProduct(op);
+      if (dot.defined()) return dot;
+    }
     PrimExpr value = this->VisitExpr(op->value);
     PrimExpr index = this->VisitExpr(op->index);
     PrimExpr pred = this->VisitExpr(op->predicate);
-    if (value.same_as(op->value) && index.same_as(op->index)) {
+    if (value.same_as(op->value) && index.same_as(op->index) && !predicate_.defined()) {
+      return GetRef<Stmt>(op);
+    } else if (index.dtype().lanes() == 1 && value.dtype().lanes() > 1) {
+      // The lanes update the same element, e.g. in a reduction.
+      need_scalarize_ = true;
       return GetRef<Stmt>(op);
     } else {
       int lanes = std::max(value.dtype().lanes(), index.dtype().lanes());
       lanes = std::max(lanes, pred.dtype().lanes());
+      if (predicate_.defined()) {
+        lanes = std::max(lanes, predicate_.dtype().lanes());
+        pred = MaskPredicate(BroadcastTo(pred, lanes));
+      }
       return Store(op->buffer_var, BroadcastTo(value, lanes), BroadcastTo(index, lanes),
                    BroadcastTo(pred, lanes));
     }
@@ -373,7 +397,7 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     CHECK(!op->condition.dtype().is_vector());
     PrimExpr condition = this->VisitExpr(op->condition);
     if (condition.dtype().is_vector()) {
-      return Scalarize(GetRef<Stmt>(op));
+      return PredicateIfThenElse(op, condition);
     }
     Stmt then_case = this->VisitStmt(op->then_case);
     Stmt else_case;
@@ -431,6 +455,122 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     return Allocate(op->buffer_var, op->dtype, extents, condition, body);
   }
 
+  // Vectorize both branches of an if with a vector condition, by masking the memory
+  // accesses of each branch with the lanes which take it. This keeps loop tails and
+  // other guarded code vectorized, the backends lower the masks to masked loads and
+  // stores. Branches which cannot be masked are scalarized.
+  Stmt PredicateIfThenElse(const IfThenElseNode* op, const PrimExpr& condition) {
+    if (!IsPredicable(op->then_case) ||
+        (op->else_case.defined() && (!IsPredicable(op->else_case) || HasLoad(condition)))) {
+      // The else branch evaluates the condition again, after the then branch could
+      // write the memory it reads.
+      return Scalarize(GetRef<Stmt>(op));
+    }
+    bool outer = !predicate_.defined();
+    Stmt then_case = VisitPredicated(op->then_case, condition);
+    Stmt else_case;
+    if (op->else_case.defined()) {
+      else_case = VisitPredicated(op->else_case, !condition);
+    }
+    if (predicate_failed_) {
+      if (!outer) return GetRef<Stmt>(op);
+      predicate_failed_ = false;
+      return Scalarize(GetRef<Stmt>(op));
+    }
+    return else_case.defined() ? SeqStmt({then_case, else_case}) : then_case;
+  }
+
+  Stmt VisitPredicated(const Stmt& stmt, const PrimExpr& mask) {
+    PrimExpr outer = predicate_;
+    predicate_ = outer.defined() ? outer && mask : mask;
+    Stmt ret = this->VisitStmt(stmt);
+    predicate_ = outer;
+    return ret;
+  }
+
+  PrimExpr VisitPredicated(const PrimExpr& e, const PrimExpr& mask) {
+    PrimExpr outer = predicate_;
+    predicate_ = outer.defined() ? outer && mask : mask;
+    PrimExpr ret = this->VisitExpr(e);
+    predicate_ = outer;
+    return ret;
+  }
+
+  // Combine the predicate of a memory access with the current mask.
+  PrimExpr MaskPredicate(const PrimExpr& pred) {
+    PrimExpr mask = BroadcastTo(predicate_, pred.dtype().lanes());
+    return is_one(pred) ? mask : pred && mask;
+  }
+
+  // Whether all the side effects of stmt are stores, which can be masked.
+  static bool IsPredicable(const Stmt& stmt) {
+    bool predicable = true;
+    PostOrderVisit(stmt, [&predicable](const ObjectRef& n) {
+      if (n->IsInstance<StmtNode>() && !n->IsInstance<StoreNode>() &&
+          !n->IsInstance<SeqStmtNode>() && !n->IsInstance<IfThenElseNode>() &&
+          !n->IsInstance<LetStmtNode>()) {
+        predicable = false;
+      }
+    });
+    return predicable;
+  }
+
+  static bool HasLoad(const PrimExpr& e) {
+    bool has_load = false;
+    PostOrderVisit(e, [&has_load](const ObjectRef& n) { has_load |= n->IsInstance<LoadNode>(); });
+    return has_load;
+  }
+
+  // Rewrite a reduction over the 4 lanes of products of 8-bit integers,
+  //   C[i] = C[i] + int32(A[j + var]) * int32(B[k + var])
+  // into C[i] = dp4a(A[ramp(j, 1, 4)], B[ramp(k, 1, 4)], C[i]).
+  // Return an undefined statement if op is not such a reduction.
+  Stmt VectorizeDotProduct(const StoreNode* op) {
+    const auto* add = op->value.as<AddNode>();
+    if (add == nullptr || op->value.dtype() != DataType::Int(32) || !is_one(op->predicate) ||
+        !this->VisitExpr(op->index).same_as(op->index)) {
+      return Stmt();
+    }
+    // The accumulator may be on either side.
+    const auto* acc = add->a.as<LoadNode>();
+    PrimExpr prod = add->b;
+    if (!IsAccumulator(acc, op)) {
+      acc = add->b.as<LoadNode>();
+      prod = add->a;
+    }
+    const auto* mul = prod.as<MulNode>();
+    if (!IsAccumulator(acc, op) || mul == nullptr) return Stmt();
+    PrimExpr a = PackedOperand(mul->a);
+    PrimExpr b = PackedOperand(mul->b);
+    if (!a.defined() || !b.defined() || a.dtype() != b.dtype()) return Stmt();
+    PrimExpr dot = Call(DataType::Int(32), builtin::dp4a(), {a, b, GetRef<PrimExpr>(acc)});
+    return Store(op->buffer_var, dot, op->index, op->predicate);
+  }
+
+  bool IsAccumulator(const LoadNode* load, const StoreNode* store) {
+    return load != nullptr && load->buffer_var.same_as(store->buffer_var) &&
+           is_one(load->predicate) && deep_equal_(load->index, store->index);
+  }
+
+  // Get the vector of 4 8-bit integers loaded by an operand of the products, the
+  // start of which is aligned to 4 elements so the vector is one 32-bit word.
+  PrimExpr PackedOperand(const PrimExpr& e) {
+    const auto* cast = e.as<CastNode>();
+    if (cast == nullptr || cast->dtype != DataType::Int(32)) return PrimExpr();
+    DataType t = cast->value.dtype();
+    if (t.bits() != 8 || !(t.is_int() || t.is_uint()) || !cast->value.as<LoadNode>()) {
+      return PrimExpr();
+    }
+    PrimExpr value = this->VisitExpr(cast->value);
+    const auto* load = value.as<LoadNode>();
+    const auto* ramp = load != nullptr ? load->index.as<RampNode>() : nullptr;
+    if (ramp == nullptr || !is_one(ramp->stride) || ramp->lanes != 4 ||
+        !analyzer_.CanProve(floormod(ramp->base, make_const(ramp->base.dtype(), 4)) == 0)) {
+      return PrimExpr();
+    }
+    return value;
+  }
+
   // scalarize the statment
   Stmt Scalarize(Stmt stmt) {
     Var idx(var_->name_hint + ".s", var_->dtype);
@@ -457,6 +597,11 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr ramp_;
   // flag to mark requirment of scalarization.
   bool need_scalarize_{false};
+  // the mask of the lanes which execute the current branch, undefined outside of
+  // branches with a vector condition.
+  PrimExpr predicate_;
+  // flag to mark that a masked branch needs scalarization.
+  bool predicate_failed_{false};
   // Let binding
   std::unordered_map<Var, PrimExpr, ObjectPtrHash, ObjectPtrEqual> let_binding_;
   // vectorizable property
@@ -555,13 +700,37 @@ class VectorizeSkipper : public StmtMutator {
 
 Stmt SkipVectorize(Stmt stmt) { return VectorizeSkipper()(std::move(stmt)); }
 
+// Keep the vectorized loops as serial loops marked for the vectorizer of the backend,
+// whose extent may be symbolic and need not match the vector length of the hardware.
+class ScalableVectorizeMarker : public StmtMutator {
+ public:
+  Stmt VisitStmt_(const ForNode* op) final {
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (op->for_type == ForType::Vectorized) {
+      CHECK(is_zero(op->min));
+      return AttrStmt(op->loop_var, attr::scalable_vectorize_scope, op->extent,
+                      For(op->loop_var, op->min, op->extent, ForType::Serial, op->device_api,
+                          op->body));
+    } else {
+      return stmt;
+    }
+  }
+};
+
 namespace transform {
 
+// Whether to leave the vectorized loops to the backend, for targets with scalable vectors.
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.scalable_vectorize", Bool);
+
 // TODO(tvm-team): Make it as a target property.
 Pass VectorizeLoop(bool enable_vectorize) {
   auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
     auto* n = f.CopyOnWrite();
-    if (enable_vectorize) {
+    bool scalable = ctx->GetConfig<Bool>("tir.scalable_vectorize", Bool(false)).value();
+    if (enable_vectorize && scalable) {
+      n->body = ScalableVectorizeMarker()(std::move(n->body));
+    } else if (enable_vectorize) {
       n->body = LoopVectorizer()(std::move(n->body));
     } else {
       n->body = VectorizeSkipper()(std::move(n->body));
@@ -133,6 +133,10 @@ TVM_REGISTER_GLOBAL("topi.nn.softmax").set_body([](TVMArgs args, TVMRetValue* rv
   *rv = nn::softmax(args[0], args[1]);
 });
 
+TVM_REGISTER_GLOBAL("topi.nn.online_softmax").set_body([](TVMArgs args, TVMRetValue* rv) {
+  *rv = nn::online_softmax(args[0], args[1]);
+});
+
 TVM_REGISTER_GLOBAL("topi.nn.log_softmax").set_body([](TVMArgs args, TVMRetValue* rv) {
   *rv = nn::log_softmax(args[0]);
 });
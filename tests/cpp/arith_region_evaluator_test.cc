@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <tvm/arith/int_set.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/te/operation.h>
+#include <tvm/tir/op.h>
+
+#include <unordered_map>
+
+using namespace tvm;
+using namespace tvm::arith;
+
+namespace {
+
+void CheckSameSet(const IntSet& a, const IntSet& b) {
+  CHECK(StructuralEqual()(a.min(), b.min())) << a << " vs " << b;
+  CHECK(StructuralEqual()(a.max(), b.max())) << a << " vs " << b;
+}
+
+}  // namespace
+
+// The load indices and the loop relaxation of a tiled conv2d, the regions
+// PropBoundToInputs and StorageAccessVisitor evaluate.
+TEST(RegionEvaluator, MatchesEvalSet) {
+  auto n_outer = te::var("n_outer"), n_inner = te::var("n_inner");
+  auto rc_outer = te::var("rc_outer"), rc_inner = te::var("rc_inner");
+  auto yy = te::var("yy"), ry = te::var("ry"), xx = te::var("xx");
+  std::unordered_map<const VarNode*, IntSet> dom_map;
+  dom_map[n_outer.get()] = IntSet::FromRange(Range::FromMinExtent(0, 4));
+  dom_map[n_inner.get()] = IntSet::FromRange(Range::FromMinExtent(0, 8));
+  dom_map[rc_outer.get()] = IntSet::FromRange(Range::FromMinExtent(0, 16));
+  dom_map[rc_inner.get()] = IntSet::FromRange(Range::FromMinExtent(0, 4));
+  dom_map[yy.get()] = IntSet::FromRange(Range::FromMinExtent(0, 7));
+  dom_map[ry.get()] = IntSet::FromRange(Range::FromMinExtent(0, 3));
+  // A domain that depends on another variable is relaxed recursively.
+  dom_map[xx.get()] = IntSet::Interval(yy * 2, yy * 2 + 1);
+
+  Array<PrimExpr> indices = {n_outer * 8 + n_inner,
+                             rc_outer * 4 + rc_inner,
+                             yy * 2 + ry - 1,
+                             xx + ry,
+                             floordiv(n_outer * 8 + n_inner, 4),
+                             floormod(rc_outer * 4 + rc_inner, 16),
+                             tvm::max(yy * 2 + ry - 1, 0)};
+  Array<Range> region = {Range::FromMinExtent(n_outer * 8, 8),
+                         Range::FromMinExtent(rc_outer * 4 + rc_inner, 1),
+                         Range::FromMinExtent(yy * 2 - 1, ry + 3)};
+  IntSet touched = IntSet::Interval(rc_outer * 4, rc_outer * 4 + 3);
+
+  // One evaluator for every access, its cache is shared across them.
+  RegionEvaluator evaluator(dom_map);
+  Array<IntSet> index_sets = evaluator.Eval(indices);
+  ASSERT_EQ(index_sets.size(), indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    CheckSameSet(index_sets[i], EvalSet(indices[i], dom_map));
+  }
+  Array<IntSet> region_sets = evaluator.Eval(region);
+  ASSERT_EQ(region_sets.size(), region.size());
+  for (size_t i = 0; i < region.size(); ++i) {
+    CheckSameSet(region_sets[i], EvalSet(region[i], dom_map));
+  }
+  CheckSameSet(evaluator.Eval(touched), EvalSet(touched, dom_map));
+  // Evaluating again hits the cache.
+  for (size_t i = 0; i < indices.size(); ++i) {
+    CheckSameSet(evaluator.Eval(indices[i]), EvalSet(indices[i], dom_map));
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
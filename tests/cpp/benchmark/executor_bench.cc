@@ -0,0 +1,154 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file executor_bench.cc
+ * \brief Microbenchmarks of the executor overhead of the graph runtime and the VM,
+ *  on synthetic programs chaining kernels that do nothing.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/vm/executable.h>
+#include <tvm/runtime/vm/vm.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tvm::runtime;
+
+static constexpr const char* kKernelName = "bench_noop";
+
+static int NoopKernel(TVMValue* args, int* type_codes, int num_args, TVMValue* out_ret_value,
+                      int* out_ret_tcode, void* resource_handle) {
+  return 0;
+}
+
+/*!
+ * \brief A module standing in for a compiled library with a single kernel doing nothing.
+ *  With expose_cfunc the executors call the kernel directly, as for a library module,
+ *  otherwise through its PackedFunc.
+ */
+class NoopModuleNode : public ModuleNode {
+ public:
+  explicit NoopModuleNode(bool expose_cfunc) : expose_cfunc_(expose_cfunc) {}
+
+  const char* type_key() const final { return "bench_noop"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name != kKernelName) return PackedFunc();
+    return PackedFunc([](TVMArgs args, TVMRetValue* rv) {});
+  }
+
+  TVMBackendPackedCFunc GetPackedCFunc(const std::string& name) final {
+    if (!expose_cfunc_ || name != kKernelName) return nullptr;
+    return NoopKernel;
+  }
+
+ private:
+  bool expose_cfunc_;
+};
+
+static Module NoopModule(bool expose_cfunc) {
+  return Module(make_object<NoopModuleNode>(expose_cfunc));
+}
+
+// The number of kernels in the program, and whether they are called directly.
+static void ExecutorArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"ops", "cfunc"});
+  for (int num_ops : {1, 16, 256}) {
+    for (int cfunc : {0, 1}) {
+      b->Args({num_ops, cfunc});
+    }
+  }
+}
+
+// A graph applying the kernel num_ops times in a chain to a [16] float32 input.
+static std::string ChainGraphJSON(int num_ops) {
+  int num_nodes = num_ops + 1;
+  std::ostringstream os;
+  os << "{\"nodes\": [{\"op\": \"null\", \"name\": \"x\", \"inputs\": []}";
+  for (int i = 0; i < num_ops; ++i) {
+    os << ", {\"op\": \"tvm_op\", \"name\": \"op" << i << "\", \"attrs\": {\"func_name\": \""
+       << kKernelName << "\", \"num_inputs\": \"1\", \"num_outputs\": \"1\", "
+       << "\"flatten_data\": \"0\"}, \"inputs\": [[" << i << ", 0, 0]]}";
+  }
+  os << "], \"arg_nodes\": [0], \"heads\": [[" << num_ops << ", 0, 0]], \"node_row_ptr\": [";
+  for (int i = 0; i <= num_nodes; ++i) {
+    os << (i ? ", " : "") << i;
+  }
+  os << "], \"attrs\": {\"dltype\": [\"list_str\", [";
+  for (int i = 0; i < num_nodes; ++i) {
+    os << (i ? ", " : "") << "\"float32\"";
+  }
+  os << "]], \"storage_id\": [\"list_int\", [";
+  for (int i = 0; i < num_nodes; ++i) {
+    os << (i ? ", " : "") << i % 2;
+  }
+  os << "]], \"shape\": [\"list_shape\", [";
+  for (int i = 0; i < num_nodes; ++i) {
+    os << (i ? ", " : "") << "[16]";
+  }
+  os << "]]}}";
+  return os.str();
+}
+
+static void BM_GraphRuntimeRun(benchmark::State& state) {
+  const PackedFunc* create = Registry::Get("tvm.graph_runtime.create");
+  CHECK(create != nullptr) << "the graph runtime is not enabled";
+  Module runtime = (*create)(ChainGraphJSON(static_cast<int>(state.range(0))),
+                             NoopModule(state.range(1) != 0), static_cast<int>(kDLCPU), 0);
+  PackedFunc set_input = runtime.GetFunction("set_input");
+  PackedFunc run = runtime.GetFunction("run");
+  set_input("x", NDArray::Empty({16}, {kDLFloat, 32, 1}, {kDLCPU, 0}));
+  for (auto _ : state) {
+    run();
+  }
+}
+BENCHMARK(BM_GraphRuntimeRun)->Apply(ExecutorArgs);
+
+static void BM_VMInvoke(benchmark::State& state) {
+  auto exec = make_object<vm::Executable>();
+  exec->lib = NoopModule(state.range(1) != 0);
+  exec->primitive_map[kKernelName] = 0;
+  // main(x) calls the kernel num_ops times in place on x and returns it.
+  std::vector<vm::Instruction> instructions;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    instructions.push_back(vm::Instruction::InvokePacked(0, 2, 1, {0, 0}));
+  }
+  instructions.push_back(vm::Instruction::Ret(0));
+  exec->functions.push_back(vm::VMFunction("main", {"x"}, instructions, 1));
+  exec->global_map["main"] = 0;
+  Module exec_mod(exec);
+
+  Module vm = (*Registry::Get("runtime._VirtualMachine"))(exec_mod);
+  vm.GetFunction("init")(static_cast<int>(kDLCPU), 0, static_cast<int>(vm::kPooled));
+  vm.GetFunction("set_input")("main", NDArray::Empty({16}, {kDLFloat, 32, 1}, {kDLCPU, 0}));
+  PackedFunc invoke = vm.GetFunction("invoke");
+  for (auto _ : state) {
+    invoke("main");
+  }
+}
+BENCHMARK(BM_VMInvoke)->Apply(ExecutorArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,179 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file runtime_bench.cc
+ * \brief Microbenchmarks of the runtime API: PackedFunc calls, NDArray allocation
+ *  and copy, workspace allocation, parallel launch and tracing.
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace tvm::runtime;
+
+static constexpr DLDataType kFloat32{kDLFloat, 32, 1};
+static constexpr DLContext kCPU{kDLCPU, 0};
+
+static void BM_PackedFuncCallNoArgs(benchmark::State& state) {
+  PackedFunc f([](TVMArgs args, TVMRetValue* rv) {});
+  for (auto _ : state) {
+    f();
+  }
+}
+BENCHMARK(BM_PackedFuncCallNoArgs);
+
+static void BM_PackedFuncCallIntArgs(benchmark::State& state) {
+  TypedPackedFunc<int(int, int)> f([](int a, int b) { return a + b; });
+  int x = 0;
+  for (auto _ : state) {
+    x = f(x, 1);
+    benchmark::DoNotOptimize(x);
+  }
+}
+BENCHMARK(BM_PackedFuncCallIntArgs);
+
+static void BM_PackedFuncCallNDArray(benchmark::State& state) {
+  TypedPackedFunc<int64_t(NDArray)> f([](NDArray a) { return a->shape[0]; });
+  NDArray a = NDArray::Empty({1}, kFloat32, kCPU);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f(a));
+  }
+}
+BENCHMARK(BM_PackedFuncCallNDArray);
+
+// The call through the C API, as made by the language frontends.
+static void BM_TVMFuncCall(benchmark::State& state) {
+  PackedFunc f([](TVMArgs args, TVMRetValue* rv) { *rv = args[0]; });
+  TVMFunctionHandle handle = new PackedFunc(f);
+  TVMValue arg, ret;
+  arg.v_int64 = 1;
+  int arg_type = kDLInt, ret_type;
+  for (auto _ : state) {
+    TVMFuncCall(handle, &arg, &arg_type, 1, &ret, &ret_type);
+    benchmark::DoNotOptimize(ret);
+  }
+  TVMFuncFree(handle);
+}
+BENCHMARK(BM_TVMFuncCall);
+
+static void BM_NDArrayEmpty(benchmark::State& state) {
+  int64_t n = state.range(0);
+  for (auto _ : state) {
+    NDArray a = NDArray::Empty({n}, kFloat32, kCPU);
+    benchmark::DoNotOptimize(a->data);
+  }
+}
+BENCHMARK(BM_NDArrayEmpty)->RangeMultiplier(16)->Range(1, 1 << 20);
+
+static void BM_NDArrayCopyFrom(benchmark::State& state) {
+  int64_t n = state.range(0);
+  NDArray src = NDArray::Empty({n}, kFloat32, kCPU);
+  NDArray dst = NDArray::Empty({n}, kFloat32, kCPU);
+  for (auto _ : state) {
+    dst.CopyFrom(src);
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(float));
+}
+BENCHMARK(BM_NDArrayCopyFrom)->RangeMultiplier(16)->Range(1, 1 << 20);
+
+static void BM_WorkspaceAllocFree(benchmark::State& state) {
+  uint64_t nbytes = state.range(0);
+  for (auto _ : state) {
+    void* ptr = TVMBackendAllocWorkspace(kDLCPU, 0, nbytes, kDLFloat, 32);
+    benchmark::DoNotOptimize(ptr);
+    TVMBackendFreeWorkspace(kDLCPU, 0, ptr);
+  }
+}
+BENCHMARK(BM_WorkspaceAllocFree)->RangeMultiplier(16)->Range(1 << 6, 1 << 22);
+
+// A kernel allocating nested workspaces, freed in reverse order.
+static void BM_WorkspaceNested(benchmark::State& state) {
+  const int depth = 8;
+  std::vector<void*> ptrs(depth);
+  for (auto _ : state) {
+    for (int i = 0; i < depth; ++i) {
+      ptrs[i] = TVMBackendAllocWorkspace(kDLCPU, 0, 1024 << i, kDLFloat, 32);
+    }
+    for (int i = depth - 1; i >= 0; --i) {
+      TVMBackendFreeWorkspace(kDLCPU, 0, ptrs[i]);
+    }
+  }
+}
+BENCHMARK(BM_WorkspaceNested);
+
+// The fork-join latency of an empty parallel region with the given number of tasks.
+static void BM_ParallelLaunch(benchmark::State& state) {
+  FTVMParallelLambda noop = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    return 0;
+  };
+  int num_task = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    TVMBackendParallelLaunch(noop, nullptr, num_task);
+  }
+}
+BENCHMARK(BM_ParallelLaunch)
+    ->RangeMultiplier(2)
+    ->Range(1, std::max(1u, std::thread::hardware_concurrency()));
+
+// A parallel region synchronizing its tasks with a barrier.
+static void BM_ParallelLaunchBarrier(benchmark::State& state) {
+  FTVMParallelLambda barrier = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    return TVMBackendParallelBarrier(task_id, penv);
+  };
+  int num_task = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    TVMBackendParallelLaunch(barrier, nullptr, num_task);
+  }
+}
+BENCHMARK(BM_ParallelLaunchBarrier)
+    ->RangeMultiplier(2)
+    ->Range(1, std::max(1u, std::thread::hardware_concurrency()));
+
+// The cost of the trace points of a workspace allocation and a parallel launch,
+// with tracing off and on.
+static void BM_TraceOverhead(benchmark::State& state) {
+  const PackedFunc* enable = Registry::Get("runtime.TraceEnable");
+  try {
+    (*enable)(state.range(0) != 0);
+  } catch (const dmlc::Error&) {
+    state.SkipWithError("The runtime is built without USE_RUNTIME_TRACE");
+    return;
+  }
+  FTVMParallelLambda noop = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    return 0;
+  };
+  for (auto _ : state) {
+    void* ptr = TVMBackendAllocWorkspace(kDLCPU, 0, 1024, kDLFloat, 32);
+    TVMBackendParallelLaunch(noop, ptr, 0);
+    TVMBackendFreeWorkspace(kDLCPU, 0, ptr);
+  }
+  (*enable)(false);
+  (*Registry::Get("runtime.TraceDump"))(true);
+}
+BENCHMARK(BM_TraceOverhead)->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -164,6 +164,20 @@ TEST(Array, Mutate) {
   CHECK(list2[1].same_as(z));
 }
 
+TEST(Array, SharedEmpty) {
+  using namespace tvm;
+  Var x("x");
+  Array<PrimExpr> a, b;
+  CHECK(a.same_as(b));
+  a.push_back(x);
+  CHECK_EQ(a.size(), 1);
+  CHECK_EQ(b.size(), 0);
+  CHECK(Array<PrimExpr>().same_as(b));
+  b.resize(3);
+  CHECK_EQ(b.size(), 3);
+  CHECK_EQ(Array<PrimExpr>().size(), 0);
+}
+
 TEST(Array, Iterator) {
   using namespace tvm;
   Array<PrimExpr> array{1, 2, 3};
@@ -313,6 +327,21 @@ TEST(Map, Mutate) {
   CHECK(it == dict2.end());
 }
 
+TEST(Map, SharedEmpty) {
+  using namespace tvm;
+  Var x("x");
+  using ExprMap = Map<PrimExpr, PrimExpr>;
+  ExprMap a, b;
+  CHECK(a.same_as(b));
+  a.Set(x, 1);
+  CHECK_EQ(a.size(), 1);
+  CHECK_EQ(b.size(), 0);
+  CHECK(ExprMap().same_as(b));
+  b.erase(x);
+  CHECK_EQ(b.size(), 0);
+  CHECK_EQ(ExprMap().count(x), 0);
+}
+
 TEST(Map, Iterator) {
   using namespace tvm;
   PrimExpr a = 1, b = 2;
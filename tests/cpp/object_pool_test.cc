@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/memory.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tvm::runtime;
+
+TEST(PoolObjAllocator, Reuse) {
+  const Object* first = nullptr;
+  {
+    ObjectPtr<StringObj> str = PoolObjAllocator().make_object<StringObj>();
+    first = str.get();
+  }
+  // The slot freed by the first object serves the next one of the same size.
+  ObjectPtr<StringObj> str = PoolObjAllocator().make_object<StringObj>();
+  CHECK_EQ(str.get(), first);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(str.get()) % PoolObjAllocator::kAlignment, 0U);
+  // Larger objects fall back to new.
+  ObjectPtr<ADTObj> large = PoolObjAllocator().make_inplace_array<ADTObj, ObjectRef>(100);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(large.get()) % PoolObjAllocator::kAlignment, 0U);
+}
+
+TEST(PoolObjAllocator, CrossThreadFree) {
+  std::vector<ObjectRef> objects;
+  for (int i = 0; i < 10000; ++i) {
+    objects.emplace_back(PoolObjAllocator().make_object<StringObj>());
+  }
+  std::thread worker([&objects]() {
+    for (size_t i = 0; i < objects.size(); i += 2) {
+      objects[i] = ObjectRef();
+    }
+  });
+  worker.join();
+  for (size_t i = 1; i < objects.size(); i += 2) {
+    CHECK(objects[i].defined());
+  }
+  objects.clear();
+}
+
+TEST(PoolObjAllocator, Arena) {
+  std::vector<ObjectRef> escaped;
+  {
+    ObjectArenaScope arena;
+    for (int i = 0; i < 10000; ++i) {
+      ObjectPtr<ADTObj> adt = PoolObjAllocator().make_inplace_array<ADTObj, ObjectRef>(2);
+      adt->tag = i;
+      if (i % 1000 == 0) escaped.emplace_back(adt);
+    }
+  }
+  // Objects outliving the scope keep its arena alive.
+  for (size_t i = 0; i < escaped.size(); ++i) {
+    CHECK_EQ(Downcast<ADT>(escaped[i]).tag(), static_cast<int>(i * 1000));
+  }
+  escaped.clear();
+}
+
+TEST(PoolObjAllocator, Stats) {
+  PoolObjAllocator::EnableStats(true);
+  { ObjectPtr<StringObj> str = PoolObjAllocator().make_object<StringObj>(); }
+  std::string stats = PoolObjAllocator::GetStats();
+  PoolObjAllocator::EnableStats(false);
+  CHECK_NE(stats.find("\"runtime.String\": {\"allocs\": 1, \"frees\": 1"), std::string::npos)
+      << stats;
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 #include <tvm/support/parallel_for.h>
 
+#include <atomic>
 #include <vector>
 
 TEST(ParallelFor, Basic) {
@@ -89,6 +90,55 @@ TEST(ParallelFor, NestedWithNormalForLoop) {
   }
 }
 
+TEST(ParallelFor, Nested) {
+  using tvm::support::parallel_for;
+
+  std::vector<std::atomic<int>> count(100 * 100);
+  parallel_for(0, 100, [&count](int i) {
+    parallel_for(0, 100, [&count, i](int j) { count[i * 100 + j]++; });
+  });
+  for (const auto& c : count) {
+    CHECK_EQ(c.load(), 1);
+  }
+}
+
+TEST(ParallelFor, Dynamic) {
+  using tvm::support::parallel_for_dynamic;
+
+  int num_threads = tvm::support::NumCompilerThreads();
+  CHECK_GE(num_threads, 1);
+  // Every thread index is used by one thread at a time, so per-thread data needs no lock.
+  std::vector<int64_t> sums(num_threads, 0);
+  std::vector<std::atomic<int>> count(10000);
+  parallel_for_dynamic(10, 10010, num_threads, [&](int thread_id, int i) {
+    CHECK_GE(thread_id, 0);
+    CHECK_LT(thread_id, num_threads);
+    sums[thread_id] += i;
+    count[i - 10]++;
+  });
+  int64_t sum = 0;
+  for (int64_t s : sums) sum += s;
+  CHECK_EQ(sum, (10 + 10009) * 10000 / 2);
+  for (const auto& c : count) {
+    CHECK_EQ(c.load(), 1);
+  }
+  // An empty loop runs nothing.
+  parallel_for_dynamic(5, 5, num_threads, [](int, int) { LOG(FATAL) << "unreachable"; });
+}
+
+TEST(ParallelFor, Partitioner) {
+  using tvm::support::parallel_for;
+  using tvm::support::rr_partitioner;
+
+  std::vector<std::atomic<int>> count(1000);
+  parallel_for(
+      0, 1000, [&count](int i) { count[i]++; }, 3,
+      [](int begin, int end, int step, int) { return rr_partitioner(begin, end, step, 2); });
+  for (int i = 0; i < 1000; ++i) {
+    CHECK_EQ(count[i].load(), i % 3 == 0 ? 1 : 0);
+  }
+}
+
 TEST(ParallelFor, Exception) {
   using tvm::support::parallel_for;
 
@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/runtime/trace.h"
+#include "../../src/support/ring_buffer.h"
+
+using tvm::support::OverwriteRingBuffer;
+
+TEST(OverwriteRingBuffer, Wrap) {
+  OverwriteRingBuffer<int> ring(5);
+  CHECK_EQ(ring.capacity(), 8U);
+  std::vector<int> out;
+  CHECK_EQ(ring.Snapshot(0, &out), 0U);
+  CHECK(out.empty());
+  for (int i = 0; i < 20; ++i) ring.Push(i);
+  CHECK_EQ(ring.Snapshot(0, &out), 20U);
+  // The oldest records are overwritten, and the one at the write count is dropped
+  // as the writer may be overwriting it.
+  CHECK_EQ(out.size(), 7U);
+  CHECK_EQ(out.front(), 13);
+  CHECK_EQ(out.back(), 19);
+  out.clear();
+  ring.Push(20);
+  ring.Push(21);
+  CHECK_EQ(ring.Snapshot(20, &out), 22U);
+  CHECK_EQ(out.size(), 2U);
+  CHECK_EQ(out[0], 20);
+  CHECK_EQ(out[1], 21);
+}
+
+TEST(OverwriteRingBuffer, ConcurrentSnapshot) {
+  // Every record repeats its index, a torn copy would not.
+  struct Record {
+    uint64_t a, b, c, d;
+  };
+  OverwriteRingBuffer<Record> ring(64);
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+      ring.Push({i, i, i, i});
+    }
+  });
+  while (ring.write_count() < 1000) std::this_thread::yield();
+  std::vector<Record> out;
+  for (int iter = 0; iter < 10000; ++iter) {
+    out.clear();
+    ring.Snapshot(0, &out);
+    for (size_t i = 0; i < out.size(); ++i) {
+      CHECK(out[i].a == out[i].b && out[i].b == out[i].c && out[i].c == out[i].d);
+      if (i != 0) CHECK_EQ(out[i].a, out[i - 1].a + 1);
+    }
+  }
+  stop = true;
+  writer.join();
+}
+
+#if TVM_RUNTIME_TRACE
+
+using tvm::runtime::TraceCategory;
+using tvm::runtime::Tracer;
+
+TEST(Tracer, Dump) {
+  Tracer::Enable(true);
+  Tracer::Dump(true);
+  std::thread worker([]() {
+    TVM_TRACE_SPAN(kOp, std::string("fused_nn_conv2d"), -1);
+    TVM_TRACE_INSTANT(kAlloc, "workspace", 256);
+  });
+  worker.join();
+  {
+    TVM_TRACE_SPAN(kParallel, "launch", 4);
+  }
+  Tracer::Enable(false);
+  // Nothing is recorded while tracing is off.
+  TVM_TRACE_INSTANT(kCopy, "not_traced", 8);
+
+  std::string trace = Tracer::Dump(true);
+  CHECK_NE(trace.find("\"name\": \"fused_nn_conv2d\", \"cat\": \"op\", \"ph\": \"X\""),
+           std::string::npos);
+  CHECK_NE(trace.find("\"name\": \"workspace\", \"cat\": \"alloc\", \"ph\": \"i\""),
+           std::string::npos);
+  CHECK_NE(trace.find("\"args\": {\"bytes\": 256}"), std::string::npos);
+  CHECK_NE(trace.find("\"args\": {\"num_task\": 4}"), std::string::npos);
+  CHECK_EQ(trace.find("not_traced"), std::string::npos);
+  // The events were cleared by the dump.
+  CHECK_EQ(Tracer::Dump(false).find("fused_nn_conv2d"), std::string::npos);
+}
+
+TEST(Tracer, LongName) {
+  Tracer::Enable(true);
+  Tracer::Dump(true);
+  std::string name(100, 'a');
+  TVM_TRACE_INSTANT(kOp, name, -1);
+  Tracer::Enable(false);
+  std::string trace = Tracer::Dump(true);
+  CHECK_NE(trace.find("\"" + std::string(45, 'a') + "\""), std::string::npos);
+}
+
+#endif  // TVM_RUNTIME_TRACE
@@ -19,10 +19,14 @@
 
 #include <gtest/gtest.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <atomic>
 #include <memory>
+#include <set>
 #include <thread>
+#include <vector>
 
 constexpr size_t N = 128;
 
@@ -64,6 +68,116 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
   }
 }
 
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  const tvm::runtime::PackedFunc* config =
+      tvm::runtime::Registry::Get("runtime.config_threadpool_schedule");
+  ASSERT_TRUE(config != nullptr);
+  // switch to the work stealing schedule with 8 tasks per worker.
+  (*config)(1, 8);
+  // the first launch runs statically, the following ones are stolen.
+  for (size_t i = 0; i < 4; ++i) {
+    std::atomic<size_t> acc(0);
+    TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  }
+  // lambdas using the barrier keep running with one task per worker.
+  FTVMParallelLambda count_with_barrier = [](int task_id, TVMParallelGroupEnv* penv,
+                                             void* cdata) -> int {
+    reinterpret_cast<std::atomic<size_t>*>(cdata)->fetch_add(1, std::memory_order_relaxed);
+    return TVMBackendParallelBarrier(task_id, penv);
+  };
+  for (size_t i = 0; i < 4; ++i) {
+    std::atomic<size_t> num_task(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(count_with_barrier, &num_task, 0), 0);
+    EXPECT_GT(num_task.load(std::memory_order_relaxed), 0);
+  }
+  (*config)(0);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchNested) {
+  const tvm::runtime::PackedFunc* config =
+      tvm::runtime::Registry::Get("runtime.config_threadpool_nested");
+  ASSERT_TRUE(config != nullptr);
+  FTVMParallelLambda nested_launch = [](int task_id, TVMParallelGroupEnv* penv,
+                                        void* cdata) -> int {
+    std::atomic<size_t> acc(0);
+    if (TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0) != 0) return -1;
+    reinterpret_cast<std::atomic<size_t>*>(cdata)->fetch_add(acc.load(), std::memory_order_relaxed);
+    return 0;
+  };
+  // unbounded nested fan-out, then nested jobs running on their caller only.
+  for (int max_fan_out : {0, 1}) {
+    (*config)(max_fan_out);
+    std::atomic<size_t> outer_num_task(0);
+    FTVMParallelLambda count_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                       void* cdata) -> int {
+      reinterpret_cast<std::atomic<size_t>*>(cdata)->store(penv->num_task);
+      return 0;
+    };
+    TVMBackendParallelLaunch(count_task, &outer_num_task, 0);
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(nested_launch, &acc, 0), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), outer_num_task.load() * N * (N - 1) / 2);
+  }
+  (*config)(0);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchPartition) {
+  const tvm::runtime::PackedFunc* config =
+      tvm::runtime::Registry::Get("runtime.config_threadpool_partition");
+  ASSERT_TRUE(config != nullptr);
+  (*config)("test_partition", 1, 2);
+  std::vector<std::unique_ptr<std::thread>> ts;
+  for (size_t i = 0; i < 2; ++i) {
+    // both threads launch into the same partition.
+    ts.emplace_back(new std::thread([&]() {
+      tvm::runtime::threading::ThreadPoolPartitionScope scope("test_partition");
+      for (size_t j = 0; j < 8; ++j) {
+        std::atomic<size_t> acc(0);
+        TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+        EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+      }
+    }));
+  }
+  for (auto& t : ts) {
+    t->join();
+  }
+  EXPECT_EQ(tvm::runtime::threading::BindThreadPoolPartition(""), "");
+}
+
+TEST(ThreadingBackend, NumThreads) {
+  const tvm::runtime::PackedFunc* config =
+      tvm::runtime::Registry::Get("runtime.config_threadpool");
+  ASSERT_TRUE(config != nullptr);
+  // external libraries follow the size of the pool configured for the thread.
+  (*config)(1, 2);
+  int nthreads = tvm::runtime::threading::NumThreads();
+  EXPECT_GE(nthreads, 1);
+  EXPECT_LE(nthreads, 2);
+  (*config)(1, 0);
+  EXPECT_LE(tvm::runtime::threading::NumThreads(), tvm::runtime::threading::MaxConcurrency());
+}
+
+TEST(ThreadingBackend, NumaPartition) {
+  std::vector<int> nodes = tvm::runtime::threading::NumaNodes();
+  if (nodes.empty()) return;
+  // the nodes own disjoint sets of cores.
+  std::set<unsigned int> seen;
+  for (int node : nodes) {
+    for (unsigned int cpu : tvm::runtime::threading::NumaNodeCpus(node)) {
+      EXPECT_TRUE(seen.insert(cpu).second);
+    }
+  }
+  const tvm::runtime::PackedFunc* config =
+      tvm::runtime::Registry::Get("runtime.config_threadpool_numa_partition");
+  ASSERT_TRUE(config != nullptr);
+  (*config)("test_numa_partition", nodes[0], 2);
+  tvm::runtime::threading::ThreadPoolPartitionScope scope("test_numa_partition");
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
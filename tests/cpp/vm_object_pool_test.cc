@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <tvm/runtime/container.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../src/runtime/vm/object_pool.h"
+
+using namespace tvm::runtime;
+using namespace tvm::runtime::vm;
+
+TEST(VMObjectPool, Reuse) {
+  VMObjectPool* pool = VMObjectPool::Create();
+  std::vector<ObjectRef> fields{ADT::Tuple(), ADT::Tuple()};
+  const Object* first = nullptr;
+  {
+    ADT adt(pool, 1, fields.begin(), fields.end());
+    CHECK_EQ(adt.tag(), 1);
+    CHECK_EQ(adt.size(), 2U);
+    CHECK(adt[1].same_as(fields[1]));
+    first = adt.get();
+  }
+  // The slot freed by the first tuple serves the next one of the same size.
+  ADT adt(pool, 0, fields.begin(), fields.end());
+  CHECK_EQ(adt.get(), first);
+  // Larger objects fall back to new.
+  std::vector<ObjectRef> many(100, fields[0]);
+  ADT large(pool, 0, many.begin(), many.end());
+  CHECK_EQ(large.size(), 100U);
+  pool->Release();
+}
+
+TEST(VMObjectPool, Escape) {
+  VMObjectPool* pool = VMObjectPool::Create();
+  std::vector<ObjectRef> fields{ADT::Tuple()};
+  std::vector<ADT> escaped;
+  for (int i = 0; i < 10000; ++i) {
+    escaped.emplace_back(pool, i, fields.begin(), fields.end());
+  }
+  // The live objects keep the pool alive once the owner released it.
+  pool->Release();
+  std::thread worker([&escaped]() {
+    for (size_t i = 0; i < escaped.size(); i += 2) {
+      escaped[i] = ADT::Tuple();
+    }
+  });
+  worker.join();
+  for (size_t i = 1; i < escaped.size(); i += 2) {
+    CHECK_EQ(escaped[i].tag(), static_cast<int>(i));
+  }
+  escaped.clear();
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+
+#include "../../src/runtime/vm/size_class_allocator.h"
+
+using namespace tvm::runtime;
+using namespace tvm::runtime::vm;
+
+namespace {
+
+const DLDataType kFloat32{kDLFloat, 32, 1};
+
+size_t AllocSize(SizeClassAllocator* alloc, size_t nbytes) {
+  Buffer buf = alloc->Alloc(nbytes, 64, kFloat32);
+  size_t size = buf.size;
+  alloc->Free(buf);
+  return size;
+}
+
+}  // namespace
+
+TEST(VMSizeClassAllocator, SizeClasses) {
+  SizeClassAllocator alloc({kDLCPU, 0});
+  // Up to 4 pages are rounded to pages.
+  CHECK_EQ(AllocSize(&alloc, 1), 4096U);
+  CHECK_EQ(AllocSize(&alloc, 4096), 4096U);
+  CHECK_EQ(AllocSize(&alloc, 4097), 2 * 4096U);
+  CHECK_EQ(AllocSize(&alloc, 4 * 4096), 4 * 4096U);
+  // Beyond, to 4 steps between two consecutive powers of two pages.
+  CHECK_EQ(AllocSize(&alloc, 5 * 4096 + 1), 6 * 4096U);
+  CHECK_EQ(AllocSize(&alloc, 9 * 4096), 10 * 4096U);
+  CHECK_EQ(AllocSize(&alloc, 17 * 4096), 20 * 4096U);
+  alloc.Trim();
+  CHECK_EQ(alloc.UsedMemory(), 0U);
+}
+
+TEST(VMSizeClassAllocator, Reuse) {
+  SizeClassAllocator alloc({kDLCPU, 0});
+  Buffer first = alloc.Alloc(1000, 64, kFloat32);
+  void* data = first.data;
+  alloc.Free(first);
+  CHECK_EQ(alloc.UsedMemory(), 4096U);
+  // A request of the same class takes the cached buffer.
+  Buffer second = alloc.Alloc(3000, 64, kFloat32);
+  CHECK_EQ(second.data, data);
+  CHECK_EQ(alloc.UsedMemory(), 4096U);
+  // Another class goes to the device.
+  Buffer third = alloc.Alloc(5000, 64, kFloat32);
+  CHECK_NE(third.data, data);
+  CHECK_EQ(alloc.UsedMemory(), 3 * 4096U);
+  alloc.Free(second);
+  alloc.Free(third);
+  alloc.Trim();
+  CHECK_EQ(alloc.UsedMemory(), 0U);
+}
+
+TEST(VMSizeClassAllocator, MaxCachedMemory) {
+  SizeClassAllocator alloc({kDLCPU, 0});
+  Buffer a = alloc.Alloc(4096, 64, kFloat32);
+  Buffer b = alloc.Alloc(4096, 64, kFloat32);
+  alloc.SetMaxCachedMemory(4096);
+  alloc.Free(a);
+  // Over the high-water mark, the buffer goes back to the device.
+  alloc.Free(b);
+  CHECK_EQ(alloc.UsedMemory(), 4096U);
+  alloc.SetMaxCachedMemory(0);
+  CHECK_EQ(alloc.UsedMemory(), 0U);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/crt/internal/common/memory_tlsf.h>
+#include <tvm/runtime/crt/memory.h>
+
+#include <cstring>
+#include <vector>
+
+static constexpr const size_t kMemoryPoolSizeBytes = 64 << 10;
+static constexpr const size_t kAlignBytes = 1 << TVM_CRT_TLSF_ALIGN_LOG2;
+
+class TLSFAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(memory_pool, 0, sizeof(memory_pool));
+    TLSFAllocatorCreate(&alloc, memory_pool, kMemoryPoolSizeBytes);
+    initial = Stats();
+    ASSERT_EQ(initial.num_free_blocks, 1);
+    ASSERT_EQ(initial.free_bytes, initial.largest_free_block);
+    ASSERT_GT(initial.free_bytes, kMemoryPoolSizeBytes - 4 * kAlignBytes);
+  }
+
+  VirtualMemoryStats Stats() {
+    VirtualMemoryStats stats;
+    alloc.Stats(&alloc, &stats);
+    return stats;
+  }
+
+  void ExpectEmpty() {
+    VirtualMemoryStats stats = Stats();
+    EXPECT_EQ(stats.used_bytes, 0);
+    EXPECT_EQ(stats.num_used_blocks, 0);
+    EXPECT_EQ(stats.num_free_blocks, 1);
+    EXPECT_EQ(stats.free_bytes, initial.free_bytes);
+    EXPECT_EQ(stats.largest_free_block, initial.free_bytes);
+  }
+
+  alignas(16) uint8_t memory_pool[kMemoryPoolSizeBytes];
+  TLSFAllocator alloc;
+  VirtualMemoryStats initial;
+};
+
+TEST_F(TLSFAllocatorTest, AllocFree) {
+  EXPECT_EQ(vleak_size, 0);
+
+  void* a = alloc.Alloc(&alloc, 1);
+  void* b = alloc.Alloc(&alloc, 17);
+  void* c = alloc.Alloc(&alloc, 1000);
+  EXPECT_EQ(vleak_size, 3);
+  for (void* p : {a, b, c}) {
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % kAlignBytes, 0);
+  }
+  EXPECT_LT(static_cast<uint8_t*>(a) + kAlignBytes, static_cast<uint8_t*>(b));
+  EXPECT_LT(static_cast<uint8_t*>(b) + 2 * kAlignBytes, static_cast<uint8_t*>(c));
+
+  VirtualMemoryStats stats = Stats();
+  EXPECT_EQ(stats.num_used_blocks, 3);
+  EXPECT_EQ(stats.used_bytes, kAlignBytes + 2 * kAlignBytes + 1008);
+
+  // Freeing the middle block leaves a hole until its neighbours are freed.
+  alloc.Free(&alloc, b);
+  EXPECT_EQ(Stats().num_free_blocks, 2);
+  alloc.Free(&alloc, a);
+  EXPECT_EQ(Stats().num_free_blocks, 2);
+  alloc.Free(&alloc, c);
+  EXPECT_EQ(vleak_size, 0);
+  ExpectEmpty();
+
+  alloc.Free(&alloc, nullptr);
+  EXPECT_EQ(vleak_size, 0);
+}
+
+TEST_F(TLSFAllocatorTest, ReuseFreedBlock) {
+  void* a = alloc.Alloc(&alloc, 100);
+  void* b = alloc.Alloc(&alloc, 100);
+  alloc.Free(&alloc, a);
+  EXPECT_EQ(alloc.Alloc(&alloc, 64), a);
+  alloc.Free(&alloc, a);
+  alloc.Free(&alloc, b);
+  ExpectEmpty();
+}
+
+TEST_F(TLSFAllocatorTest, Realloc) {
+  uint8_t* a = static_cast<uint8_t*>(alloc.Realloc(&alloc, nullptr, 32));
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(vleak_size, 1);
+  for (int i = 0; i < 32; i++) a[i] = i;
+
+  // Grows into the free space that follows it.
+  EXPECT_EQ(alloc.Realloc(&alloc, a, 256), a);
+  EXPECT_EQ(Stats().used_bytes, 256);
+  // Shrinks in place.
+  EXPECT_EQ(alloc.Realloc(&alloc, a, 48), a);
+  EXPECT_EQ(Stats().used_bytes, 48);
+
+  // Moves once the following block is taken.
+  void* b = alloc.Alloc(&alloc, 16);
+  uint8_t* c = static_cast<uint8_t*>(alloc.Realloc(&alloc, a, 4096));
+  ASSERT_NE(c, nullptr);
+  EXPECT_NE(c, a);
+  EXPECT_EQ(vleak_size, 2);
+  for (int i = 0; i < 32; i++) EXPECT_EQ(c[i], i);
+
+  // A request that cannot be met leaves the block in place.
+  EXPECT_EQ(alloc.Realloc(&alloc, c, kMemoryPoolSizeBytes), nullptr);
+  EXPECT_EQ(c[31], 31);
+
+  alloc.Free(&alloc, b);
+  alloc.Free(&alloc, c);
+  EXPECT_EQ(vleak_size, 0);
+  ExpectEmpty();
+}
+
+TEST_F(TLSFAllocatorTest, Exhaustion) {
+  std::vector<void*> ptrs;
+  void* p;
+  while ((p = alloc.Alloc(&alloc, 1000)) != nullptr) ptrs.push_back(p);
+  EXPECT_GT(ptrs.size(), 60);
+  EXPECT_EQ(alloc.Alloc(&alloc, kMemoryPoolSizeBytes), nullptr);
+  EXPECT_EQ(alloc.Alloc(&alloc, static_cast<size_t>(-1)), nullptr);
+
+  alloc.Free(&alloc, ptrs.back());
+  ptrs.pop_back();
+  EXPECT_NE(p = alloc.Alloc(&alloc, 1000), nullptr);
+  ptrs.push_back(p);
+
+  for (void* q : ptrs) alloc.Free(&alloc, q);
+  EXPECT_EQ(vleak_size, 0);
+  ExpectEmpty();
+}
+
+TEST_F(TLSFAllocatorTest, FragmentationStats) {
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 32; i++) ptrs.push_back(alloc.Alloc(&alloc, 512));
+  for (int i = 0; i < 32; i += 2) alloc.Free(&alloc, ptrs[i]);
+
+  VirtualMemoryStats stats = Stats();
+  EXPECT_EQ(stats.num_used_blocks, 16);
+  EXPECT_EQ(stats.used_bytes, 16 * 512);
+  // Sixteen holes plus the tail of the pool.
+  EXPECT_EQ(stats.num_free_blocks, 17);
+  EXPECT_LT(stats.largest_free_block, stats.free_bytes);
+
+  for (int i = 1; i < 32; i += 2) alloc.Free(&alloc, ptrs[i]);
+  ExpectEmpty();
+}
+
+TEST_F(TLSFAllocatorTest, RandomAllocFree) {
+  struct Allocation {
+    uint8_t* data;
+    size_t size;
+  };
+  std::vector<Allocation> live;
+  uint32_t seed = 1;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+  };
+  for (int i = 0; i < 20000; i++) {
+    if (live.empty() || next() % 3 != 0) {
+      size_t size = next() % 4 == 0 ? next() % 4096 : next() % 128;
+      uint8_t* data = static_cast<uint8_t*>(alloc.Alloc(&alloc, size));
+      if (data == nullptr) continue;
+      memset(data, static_cast<int>(live.size() & 0xff), size);
+      live.push_back({data, size});
+    } else {
+      size_t idx = next() % live.size();
+      Allocation a = live[idx];
+      for (size_t j = 0; j < a.size; j++) {
+        ASSERT_EQ(a.data[j], static_cast<uint8_t>(idx & 0xff));
+      }
+      alloc.Free(&alloc, a.data);
+      live[idx] = live.back();
+      live.pop_back();
+      if (idx < live.size()) {
+        memset(live[idx].data, static_cast<int>(idx & 0xff), live[idx].size);
+      }
+    }
+    ASSERT_EQ(Stats().num_used_blocks, live.size());
+  }
+  for (const Allocation& a : live) alloc.Free(&alloc, a.data);
+  EXPECT_EQ(vleak_size, 0);
+  ExpectEmpty();
+}
+
+extern "C" {
+void TVMPlatformAbort(int error_code) { FAIL() << "TVMPlatformAbort(" << error_code << ")"; }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -158,13 +158,14 @@ def skip_codegen_test():
         return True
 
 
-def build_module(mod, target, params=None, enable_acl=True, tvm_ops=0, acl_partitions=1):
+def build_module(mod, target, params=None, enable_acl=True, tvm_ops=0, acl_partitions=1,
+                 merge_regions=False):
     """Build module with option to build for ACL."""
     if isinstance(mod, tvm.relay.expr.Call):
         mod = tvm.IRModule.from_expr(mod)
     with tvm.transform.PassContext(opt_level=3, disabled_pass=["AlterOpLayout"]):
         if enable_acl:
-            mod = arm_compute_lib.partition_for_arm_compute_lib(mod, params)
+            mod = arm_compute_lib.partition_for_arm_compute_lib(mod, params, merge_regions)
             tvm_op_count = get_cpu_op_count(mod)
             assert tvm_op_count == tvm_ops, \
                 "Got {} TVM operators, expected {}".format(tvm_op_count, tvm_ops)
@@ -181,9 +182,10 @@ def build_module(mod, target, params=None, enable_acl=True, tvm_ops=0, acl_parti
 
 
 def build_and_run(mod, inputs, outputs, params, device, enable_acl=True, no_runs=1,
-                  tvm_ops=0, acl_partitions=1):
+                  tvm_ops=0, acl_partitions=1, merge_regions=False):
     """Build and run the relay module."""
-    lib = build_module(mod, device.target, params, enable_acl, tvm_ops, acl_partitions)
+    lib = build_module(mod, device.target, params, enable_acl, tvm_ops, acl_partitions,
+                       merge_regions)
     lib = update_lib(lib, device.device, device.cross_compile)
     gen_module = graph_runtime.GraphModule(lib['default'](device.device.cpu(0)))
     gen_module.set_input(**inputs)
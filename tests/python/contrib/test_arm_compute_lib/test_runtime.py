@@ -132,7 +132,52 @@ def test_multiple_runs():
     verify(outputs, atol=0.002, rtol=0.01)
 
 
+
+def test_merged_layers():
+    """
+    Test a function holding several layers, whose intermediate tensors
+    are managed by the runtime and share memory.
+    """
+    Device.load("test_config.json")
+
+    if skip_runtime_test():
+        return
+
+    device = Device()
+    np.random.seed(0)
+
+    def get_model():
+        a = relay.var("a", shape=(1, 14, 14, 32), dtype="float32")
+        w = tvm.nd.array(np.random.uniform(-1, 1, (32, 3, 3, 32)).astype("float32"))
+        out = a
+        for _ in range(3):
+            out = relay.nn.conv2d(
+                out,
+                relay.const(w, "float32"),
+                kernel_size=(3, 3),
+                data_layout="NHWC",
+                kernel_layout="OHWI",
+                padding=(1, 1),
+                channels=32
+            )
+        out = relay.nn.max_pool2d(out, pool_size=(2, 2), strides=(2, 2), layout="NHWC")
+        out = relay.reshape(out, (1, 7 * 7 * 32))
+        return out
+
+    inputs = {
+        "a": tvm.nd.array(np.random.uniform(-1, 1, (1, 14, 14, 32)).astype("float32")),
+    }
+
+    outputs = []
+    for acl in [False, True]:
+        outputs.extend(build_and_run(get_model(), inputs, 1, None, device,
+                                     enable_acl=acl, no_runs=2, acl_partitions=1,
+                                     merge_regions=True))
+    verify(outputs, atol=0.002, rtol=0.01)
+
+
 if __name__ == "__main__":
     test_multiple_ops()
     test_heterogeneous()
     test_multiple_runs()
+    test_merged_layers()
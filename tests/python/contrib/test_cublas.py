@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import math
 import tvm
 from tvm import te
 import numpy as np
@@ -132,6 +133,45 @@ def verify_batch_matmul(in_dtype, out_dtype, rtol=1e-5):
                                    b.asnumpy().astype(C.dtype)).astype(C.dtype), rtol=rtol)
     verify()
 
+def verify_dense_lt(in_dtype, activation="none", with_bias=True, rtol=1e-5):
+    n = 64
+    l = 128
+    m = 96
+    A = te.placeholder((n, l), name='A', dtype=in_dtype)
+    B = te.placeholder((m, l), name='B', dtype=in_dtype)
+    bias = te.placeholder((m,), name='bias', dtype=in_dtype) if with_bias else None
+    C = cublaslt.dense(A, B, bias, activation)
+    s = te.create_schedule(C.op)
+    args = [A, B, bias, C] if with_bias else [A, B, C]
+
+    def verify(target="cuda"):
+        if not tvm.runtime.enabled(target):
+            print("skip because %s is not enabled..." % target)
+            return
+        if not cublaslt.supports_epilogue(activation, with_bias):
+            print("skip because the epilogue is not available")
+            return
+        ctx = tvm.gpu(0)
+        f = tvm.build(s, args, target)
+        low, high = (-64, 64) if in_dtype == "int8" else (-1, 1)
+        a_np = np.random.uniform(low, high, size=(n, l)).astype(A.dtype)
+        b_np = np.random.uniform(low, high, size=(m, l)).astype(B.dtype)
+        c_np = np.dot(a_np.astype(C.dtype), b_np.T.astype(C.dtype))
+        arrays = [tvm.nd.array(a_np, ctx), tvm.nd.array(b_np, ctx)]
+        if with_bias:
+            bias_np = np.random.uniform(-1, 1, size=(m,)).astype(bias.dtype)
+            c_np = c_np + bias_np
+            arrays.append(tvm.nd.array(bias_np, ctx))
+        if activation == "relu":
+            c_np = np.maximum(c_np, 0)
+        elif activation == "gelu":
+            erf = np.vectorize(math.erf)
+            c_np = c_np * (0.5 + erf(c_np * 0.5 ** 0.5) * 0.5)
+        c = tvm.nd.array(np.zeros((n, m), dtype=C.dtype), ctx)
+        f(*arrays, c)
+        tvm.testing.assert_allclose(c.asnumpy(), c_np.astype(C.dtype), rtol=rtol, atol=rtol)
+    verify()
+
 def test_matmul_add():
     verify_matmul_add('float', 'float', rtol=1e-3)
     verify_matmul_add('float16', 'float')
@@ -141,6 +181,13 @@ def test_matmul_add():
 def test_matmul_add_igemm():
     verify_matmul_add_igemm('int8', 'int32')
 
+def test_dense_lt():
+    verify_dense_lt('float32', with_bias=False, rtol=1e-4)
+    verify_dense_lt('float32', 'relu', rtol=1e-4)
+    verify_dense_lt('float32', 'gelu', rtol=1e-4)
+    verify_dense_lt('float16', 'relu', rtol=1e-2)
+    verify_dense_lt('int8', with_bias=False)
+
 def test_batch_matmul():
     verify_batch_matmul('float', 'float')
     verify_batch_matmul('float16', 'float')
@@ -150,4 +197,5 @@ if __name__ == "__main__":
     test_matmul_add()
     test_batch_matmul()
     test_matmul_add_igemm()
+    test_dense_lt()
 
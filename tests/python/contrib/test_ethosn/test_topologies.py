@@ -121,3 +121,32 @@ def test_input_tuples():
         outputs.append(tei.run(graph, lib, {}, inputs, 1, npu=npu))
 
     tei.verify(outputs, 0)
+
+
+def test_submit_and_wait():
+    if not ethosn_available():
+        return
+
+    def get_model(shape):
+        a = relay.var("a", shape=shape, dtype="uint8")
+        split = relay.op.split(a, indices_or_sections=2, axis=2)
+        return relay.Tuple((split[0], split[1]))
+
+    shape = (1, 4, 4, 16)
+    np.random.seed(0)
+    data = np.random.randint(0, high=256, size=shape, dtype="uint8")
+    model = get_model(shape)
+    mod = tei.make_module(model, {})
+    graph, lib, params = tei.build(mod, {}, npu=False)
+    expected = tei.run(graph, lib, params, {"a": tvm.nd.array(data)}, 2, npu=False)
+
+    graph, lib, params = tei.build(mod, {}, npu=True)
+    ethosn = [m for m in lib.imported_modules if m.type_key == "ethos-n"][0]
+    # Inputs allocated by the runtime are read by the NPU without a copy
+    a = ethosn["alloc_buffer"]("uint8", *shape)
+    a.copyfrom(data)
+    outputs = [tvm.nd.empty(out.shape, "uint8") for out in expected]
+    ticket = ethosn["submit"]("ethos-n_0", a, *outputs)
+    assert ethosn["wait"](ticket)
+
+    tei.verify([expected, outputs], 0)
@@ -146,8 +146,41 @@ def test_random_fill():
             test_local(ctx, dtype)
         test_rpc(dtype)
 
+def test_philox():
+    if not tvm.get_global_func("tvm.contrib.random.philox_uniform", True):
+        print("skip because extern function is not available")
+        return
+    n = 1 << 20
+
+    def run(A):
+        s = te.create_schedule(A.op)
+        f = tvm.build(s, [A], "llvm")
+        a = tvm.nd.array(np.zeros([int(x) for x in A.shape], dtype=A.dtype), tvm.cpu(0))
+        f(a)
+        return a.asnumpy()
+
+    u = run(random.philox_uniform(0, 1, size=(n,), seed=7))
+    assert abs(np.mean(u) - 0.5) < 1e-2
+    assert np.min(u) >= 0 and np.max(u) < 1
+    # The same seed gives the same values, whatever the number of threads
+    tvm.testing.assert_allclose(u, run(random.philox_uniform(0, 1, size=(n,), seed=7)))
+    # Element i only depends on offset + i
+    tvm.testing.assert_allclose(
+        u[8:], run(random.philox_uniform(0, 1, size=(n - 8,), seed=7, offset=8)))
+    tvm.testing.assert_allclose(
+        u[5:], run(random.philox_uniform(0, 1, size=(n - 5,), seed=7, offset=5)))
+    assert not np.allclose(u, run(random.philox_uniform(0, 1, size=(n,), seed=8)))
+
+    v = run(random.philox_normal(3, 4, size=(n,), seed=7))
+    assert abs(np.mean(v) - 3) < 1e-1
+    assert abs(np.std(v) - 4) < 1e-1
+    tvm.testing.assert_allclose(
+        v[3:], run(random.philox_normal(3, 4, size=(n - 3,), seed=7, offset=3)))
+
+
 if __name__ == "__main__":
     test_randint()
     test_uniform()
     test_normal()
     test_random_fill()
+    test_philox()
@@ -74,6 +74,36 @@ def test_sort_np():
     f(a, b, c)
     tvm.testing.assert_allclose(c.asnumpy(), np_out, rtol=1e-5)
 
+def test_topk_large():
+    # Large enough to take the parallel, partial sort and radix sort paths
+    dshape = (4, 20000)
+    k = 10
+    data = te.placeholder(dshape, name='data')
+    indices = te.extern((dshape[0], k), [data],
+                        lambda ins, outs: tvm.tir.call_packed(
+                            "tvm.contrib.sort.topk", ins[0], outs[0],
+                            k, -1, "indices", False),
+                        dtype='int32', name="topk_indices")
+    order = te.extern(dshape, [data],
+                      lambda ins, outs: tvm.tir.call_packed(
+                          "tvm.contrib.sort.argsort", ins[0], outs[0], -1, True),
+                      dtype='int32', name="argsort")
+
+    ctx = tvm.cpu(0)
+    s = te.create_schedule([indices.op, order.op])
+    f = tvm.build(s, [data, indices, order], "llvm")
+    # Few distinct values, so that the ties have to keep their input order
+    np_data = np.random.randint(0, 100, size=dshape).astype(data.dtype)
+    a = tvm.nd.array(np_data, ctx)
+    b = tvm.nd.array(np.zeros((dshape[0], k), dtype=indices.dtype), ctx)
+    c = tvm.nd.array(np.zeros(dshape, dtype=order.dtype), ctx)
+    f(a, b, c)
+    np_order = np.argsort(np_data, axis=-1, kind="stable")
+    np_topk = np.argsort(-np_data, axis=-1, kind="stable")[:, :k]
+    tvm.testing.assert_allclose(b.asnumpy(), np_topk)
+    tvm.testing.assert_allclose(c.asnumpy(), np_order)
+
 if __name__ == "__main__":
     test_sort()
     test_sort_np()
+    test_topk_large()
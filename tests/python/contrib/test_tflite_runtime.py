@@ -138,6 +138,35 @@ def test_remote():
     server.terminate()
 
 
+def test_concurrent_run():
+    tflite_model = _create_tflite_model()
+    if tflite_model is None:
+        return
+
+    import threading
+    runtime = tflite_runtime.create(tflite_model, tvm.cpu(0), num_threads=1, max_interpreters=2)
+    errors = []
+
+    def worker(seed):
+        try:
+            rng = np.random.RandomState(seed)
+            for _ in range(16):
+                x = rng.random_sample((2,)).astype("float32")
+                out = tvm.nd.empty((2,), "float32")
+                runtime.run([tvm.nd.array(x)], [out])
+                np.testing.assert_allclose(out.asnumpy(), x * np.array([1., 2.], "float32"))
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors, errors
+
+
 if __name__ == "__main__":
     test_local()
     test_remote()
+    test_concurrent_run()
@@ -0,0 +1,115 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import ctypes
+
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.contrib import cc, graph_runtime, util
+from tvm.relay.backend import aot_codegen
+
+
+def run_aot(src, lib, prefix, inputs, out_shape):
+    """Compile the executor with the operators, set the inputs in order and run it."""
+    temp = util.tempdir()
+    lib.save(temp.relpath("lib.o"))
+    with open(temp.relpath("executor.c"), "w") as f:
+        f.write(src)
+    includes = ["-I" + path for path in tvm._ffi.libinfo.find_include_path()]
+    cc.create_shared(temp.relpath("aot.so"), [temp.relpath("lib.o"), temp.relpath("executor.c")],
+                     options=includes, cc="gcc")
+    dll = ctypes.CDLL(temp.relpath("aot.so"))
+    get_input, get_output = dll[prefix + "_get_input"], dll[prefix + "_get_output"]
+    get_input.restype = get_output.restype = ctypes.c_void_p
+    assert dll[prefix + "_num_inputs"]() == len(inputs)
+    # the data pointer is the first field of DLTensor
+    def data(tensor):
+        return ctypes.cast(tensor, ctypes.POINTER(ctypes.c_void_p))[0]
+    for i, value in enumerate(inputs):
+        ctypes.memmove(data(get_input(i)), value.ctypes.data, value.nbytes)
+    assert dll[prefix + "_run"]() == 0
+    out = np.empty(out_shape, "float32")
+    ctypes.memmove(out.ctypes.data, data(get_output(0)), out.nbytes)
+    return out
+
+
+def run_graph(mod, params, inputs):
+    with tvm.transform.PassContext(opt_level=3):
+        factory = relay.build(mod, "llvm", params=params)
+    module = graph_runtime.GraphModule(factory["default"](tvm.cpu()))
+    module.run(**inputs)
+    return module.get_output(0).asnumpy()
+
+
+def test_aot_source():
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(10,))
+    z = relay.exp(relay.add(x, y))
+    z = relay.nn.relu(relay.multiply(z, y))
+    mod = tvm.IRModule.from_expr(relay.Function([x, y], z))
+    with tvm.transform.PassContext(opt_level=3):
+        opt_mod, _ = relay.optimize(mod, "llvm")
+        grc = aot_codegen.AOTCodegen(None, "llvm")
+        _, lowered, _ = grc.codegen(opt_mod["main"])
+    src = grc.get_source("net")
+
+    func_names = [gv.name_hint for ir_mod in lowered.values() for gv in ir_mod.get_global_vars()]
+    assert func_names
+    for name in func_names:
+        assert "TVM_DLL int32_t " + name in src
+        assert name + "(values, type_codes" in src
+    for symbol in ["net_run(void)", "net_get_input(", "net_get_output(", "net_arena["]:
+        assert symbol in src
+    assert '"x", "y", NULL' in src
+    assert "storage_offset" in grc._get_graph_json()
+
+    # The executor computes what the graph runtime does.
+    x_np = np.random.uniform(-1, 1, size=(10,)).astype("float32")
+    y_np = np.random.uniform(-1, 1, size=(10,)).astype("float32")
+    with tvm.transform.PassContext(opt_level=3):
+        src, lib = aot_codegen.build(mod, "llvm --system-lib", prefix="net")
+    res = run_aot(src, lib, "net", [x_np, y_np], (10,))
+    ref = run_graph(mod, None, {"x": x_np, "y": y_np})
+    tvm.testing.assert_allclose(res, ref, rtol=1e-5)
+
+
+def test_aot_linked_params():
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(10,))
+    mod = tvm.IRModule.from_expr(relay.Function([x, y], relay.add(x, y)))
+    params = {"y": np.ones((10,), "float32")}
+    with tvm.transform.PassContext(opt_level=3):
+        src, lib = aot_codegen.build(mod, "llvm --system-lib", params=params, prefix="net")
+
+    assert lib.type_key == "llvm"
+    # The ten ones of y are linked in as little-endian float32 bytes.
+    assert src.count("0x00, 0x00, 0x80, 0x3f,") == 10
+    assert "static const uint8_t net_param_" in src
+    assert "{(void*)net_param_" in src
+    # y is linked in, so it is not an input
+    assert '"x", NULL' in src
+
+    x_np = np.random.uniform(-1, 1, size=(10,)).astype("float32")
+    res = run_aot(src, lib, "net", [x_np], (10,))
+    ref = run_graph(mod, params, {"x": x_np})
+    tvm.testing.assert_allclose(res, ref, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_aot_source()
+    test_aot_linked_params()
@@ -234,6 +234,35 @@ def test_compile_nhwc_pack():
     relay.build(mod, target="llvm")
 
 
+def test_compile_persistent_cache():
+    import os
+    from tvm.contrib import graph_runtime, util
+
+    x = relay.var("x", shape=(5, 9))
+    y = relay.nn.softmax(relay.exp(x))
+    func = relay.Function([x], y)
+    x_data = np.random.rand(5, 9).astype("float32")
+    engine = relay.backend.compile_engine.get()
+    cache_dir = util.tempdir()
+    config = {"relay.backend.compile_cache_dir": cache_dir.temp_dir}
+
+    def build_and_run():
+        engine.clear()
+        with tvm.transform.PassContext(opt_level=0, config=config):
+            graph, lib, _ = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        mod = graph_runtime.create(graph, lib, tvm.cpu())
+        mod.run(x=x_data)
+        return mod.get_output(0).asnumpy()
+
+    ref = build_and_run()
+    entries = [f for f in os.listdir(cache_dir.temp_dir) if f.endswith(".json")]
+    assert len(entries) == 2
+    out = build_and_run()
+    # functions loaded from the cache are not scheduled again
+    assert all(value.cached_func.schedule is None for _, value in engine.items())
+    tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_get_valid_implementations()
     test_select_implementation()
@@ -243,3 +272,4 @@ if __name__ == "__main__":
     test_compile_tuple_dup()
     test_compile_full()
     test_compile_nhwc_pack()
+    test_compile_persistent_cache()
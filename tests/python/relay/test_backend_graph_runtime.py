@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import json
 import numpy as np
 
 import tvm
@@ -141,6 +142,134 @@ def test_plan_memory():
     assert len(device_types) == 1
 
 
+def test_static_arena():
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(1,))
+    z = relay.add(x, relay.exp(y))
+    for _ in range(4):
+        z = relay.negative(z)
+    func = relay.Function([x, y], z)
+    with tvm.transform.PassContext(opt_level=0, config={"relay.backend.static_arena": True}):
+        graph, lib, _ = relay.build(tvm.IRModule.from_expr(func), "llvm")
+    attrs = json.loads(graph)["attrs"]
+    offsets = attrs["storage_offset"][1]
+    arena_bytes = attrs["arena_bytes"][1]
+    assert len(offsets) == max(attrs["storage_id"][1]) + 1
+    assert all(off % 64 == 0 for off in offsets)
+    assert max(offsets) < arena_bytes <= 64 * len(offsets)
+
+    # the arena attributes are ignored by the C++ runtime
+    mod = graph_runtime.create(graph, lib, tvm.cpu())
+    x_data = np.random.rand(10).astype("float32")
+    y_data = np.random.rand(1).astype("float32")
+    mod.run(x=x_data, y=y_data)
+    ref = x_data + np.exp(y_data)
+    tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-5)
+
+
+def test_plan_memory_view():
+    x = relay.var("x", shape=(1, 8))
+    w = relay.var("w", shape=(16, 8))
+    y = relay.reshape(relay.nn.dense(x, w), (4, 4))
+    func = relay.Function([x, w], y)
+    with tvm.transform.PassContext(opt_level=3):
+        graph, lib, _ = relay.build(tvm.IRModule.from_expr(func), "llvm")
+    graph_json = json.loads(graph)
+    storage_ids = graph_json["attrs"]["storage_id"][1]
+    row_ptr = graph_json["node_row_ptr"]
+    funcs = [node.get("attrs", {}).get("func_name") for node in graph_json["nodes"]]
+    views = [nid for nid, f in enumerate(funcs) if f == "__nop"]
+    assert len(views) == 1
+    (src,) = graph_json["nodes"][views[0]]["inputs"]
+    # the reshape is a view of the dense output
+    assert storage_ids[row_ptr[views[0]]] == storage_ids[row_ptr[src[0]] + src[1]]
+
+    mod = graph_runtime.create(graph, lib, tvm.cpu())
+    x_data = np.random.rand(1, 8).astype("float32")
+    w_data = np.random.rand(16, 8).astype("float32")
+    mod.run(x=x_data, w=w_data)
+    ref = np.dot(x_data, w_data.T).reshape(4, 4)
+    tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-5)
+
+
+def test_inplace_concat():
+    x = relay.var("x", shape=(1, 8))
+    w1 = relay.var("w1", shape=(32, 8))
+    w2 = relay.var("w2", shape=(32, 8))
+    y = relay.concatenate([relay.nn.dense(x, w1), relay.nn.dense(x, w2)], axis=1)
+    func = relay.Function([x, w1, w2], y)
+    config = {"relay.backend.inplace_concat": True}
+    with tvm.transform.PassContext(opt_level=3, config=config):
+        builder = relay.build_module.BuildModule()
+        graph, lib, _ = builder.build(tvm.IRModule.from_expr(func), "llvm")
+        graph_binary = builder.get_graph_binary()
+    graph_json = json.loads(graph)
+    # the second dense writes its output after the first one, in the concatenation
+    assert sorted(graph_json["attrs"]["entry_offset"][1])[-1] == 128
+    funcs = [node.get("attrs", {}).get("func_name") for node in graph_json["nodes"]]
+    assert "__nop" in funcs
+    assert not any("concatenate" in f for f in funcs if f)
+    assert len(graph_binary) == 0
+
+    mod = graph_runtime.create(graph, lib, tvm.cpu())
+    x_data = np.random.rand(1, 8).astype("float32")
+    w1_data = np.random.rand(32, 8).astype("float32")
+    w2_data = np.random.rand(32, 8).astype("float32")
+    mod.run(x=x_data, w1=w1_data, w2=w2_data)
+    ref = np.concatenate([np.dot(x_data, w1_data.T), np.dot(x_data, w2_data.T)], axis=1)
+    tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-5)
+
+
+def test_graph_binary():
+    x = relay.var("x", shape=(2, 3))
+    w = relay.var("w", shape=(2, 3))
+    y = relay.nn.relu(relay.multiply(relay.add(x, w), x))
+    func = relay.Function([x, w], relay.Tuple([y, relay.exp(y)]))
+    with tvm.transform.PassContext(opt_level=3):
+        builder = relay.build_module.BuildModule()
+        graph, lib, _ = builder.build(tvm.IRModule.from_expr(func), "llvm")
+        graph_binary = builder.get_graph_binary()
+    assert len(graph_binary) > 0
+    assert bytes(graph_binary[:1]) != b"{"
+
+    x_data = np.random.uniform(-1, 1, size=(2, 3)).astype("float32")
+    w_data = np.random.uniform(-1, 1, size=(2, 3)).astype("float32")
+    outputs = []
+    for g in [graph, bytes(graph_binary)]:
+        mod = graph_runtime.create(g, lib, tvm.cpu())
+        mod.run(x=x_data, w=w_data)
+        outputs.append([mod.get_output(i).asnumpy() for i in range(mod.get_num_outputs())])
+    assert len(outputs[1]) == 2
+    for expected, actual in zip(*outputs):
+        tvm.testing.assert_allclose(actual, expected)
+
+
+def test_multi_shape():
+    x = relay.var("x", shape=(1, 8))
+    w = relay.var("w", shape=(16, 8))
+    y = relay.nn.relu(relay.nn.dense(relay.exp(x), w))
+    mod = tvm.IRModule.from_expr(relay.Function([x, w], y))
+    w_data = np.random.rand(16, 8).astype("float32")
+    batches = [1, 4, 16]
+    with tvm.transform.PassContext(opt_level=2):
+        factory = relay.build_multi_shape(
+            mod, [{"x": (b, 8)} for b in batches], "llvm", params={"w": w_data}
+        )
+    # the specializations share the folded weight
+    params = factory.get_params()
+    assert all(p["p0"] is params[0]["p0"] for p in params)
+
+    mod = graph_runtime.MultiShapeGraphModule(factory["default"](tvm.cpu()))
+    # the pool holds x, exp(x) and the output of the largest batch, the weight is not in it
+    assert mod.get_storage_bytes() == 4 * (16 * 8 * 2 + 16 * 16)
+    for i in [2, 0, 1, 2]:
+        x_data = np.random.rand(batches[i], 8).astype("float32")
+        mod.run(x=x_data)
+        assert mod.get_active_specialization() == i
+        ref = np.maximum(np.dot(np.exp(x_data), w_data.T), 0)
+        tvm.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-5)
+
+
 def test_gru_like():
     def unit(rnn_dim):
         X = relay.var("X", shape=(1, rnn_dim))
@@ -178,8 +307,68 @@ def test_gru_like():
             tvm.testing.assert_allclose(out, ref, rtol=1e-5, atol=1e-5)
 
 
+def test_parallel_build():
+    x = relay.var("x", shape=(3, 11))
+    y = relay.nn.softmax(relay.exp(x))
+    y = relay.nn.softmax(relay.sqrt(y), axis=0)
+    y = relay.add(relay.nn.softmax(relay.negative(y)), x)
+    func = relay.Function([x], y)
+
+    def build_and_run(num_threads):
+        relay.backend.compile_engine.get().clear()
+        config = {"relay.backend.num_build_threads": num_threads}
+        with tvm.transform.PassContext(opt_level=0, config=config):
+            graph, lib, _ = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        mod = graph_runtime.create(graph, lib, tvm.cpu())
+        mod.run(x=x_data)
+        return lib, mod.get_output(0).asnumpy()
+
+    x_data = np.random.rand(3, 11).astype("float32")
+    _, ref = build_and_run(1)
+    lib, out = build_and_run(4)
+    # the host code is split into several llvm modules
+    assert len(lib.imported_modules) > 0
+    tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+
+def test_incremental_build():
+    x = relay.var("x", shape=(4, 8))
+    w = relay.var("w", shape=(6, 8))
+    b = relay.var("b", shape=(6,))
+    y = relay.nn.relu(relay.nn.bias_add(relay.nn.dense(x, w), b))
+    mod = tvm.IRModule.from_expr(relay.Function([x, w, b], y))
+    x_data = np.random.rand(4, 8).astype("float32")
+
+    def build_and_run(w_data, b_data):
+        config = {"relay.backend.incremental_build": True}
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            graph, lib, params = relay.build(mod, "llvm", params={"w": w_data, "b": b_data})
+        m = graph_runtime.create(graph, lib, tvm.cpu())
+        m.set_input(**params)
+        m.run(x=x_data)
+        return graph, lib, m.get_output(0).asnumpy()
+
+    graph1, lib1, _ = build_and_run(np.random.rand(6, 8).astype("float32"),
+                                    np.random.rand(6).astype("float32"))
+    w_data = np.random.rand(6, 8).astype("float32")
+    b_data = np.random.rand(6).astype("float32")
+    graph2, lib2, out = build_and_run(w_data, b_data)
+    # only the params are emitted again
+    assert graph1 == graph2
+    assert lib1.handle.value == lib2.handle.value
+    ref = np.maximum(np.dot(x_data, w_data.T) + b_data, 0)
+    tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_plan_memory()
+    test_static_arena()
+    test_plan_memory_view()
+    test_inplace_concat()
+    test_parallel_build()
+    test_incremental_build()
+    test_graph_binary()
+    test_multi_shape()
     test_with_params()
     test_add_op_scalar()
     test_add_op_tensor()
@@ -231,6 +231,35 @@ def test_tuple_passing():
     out = f(value_tuple)
     tvm.testing.assert_allclose(out.asnumpy(), np.array(11))
 
+def test_compiled_op_cache():
+    x = relay.var('x', shape=(4,), dtype='float32')
+    func = relay.Function([x], relay.exp(x) + relay.const(1.0))
+    x_data = np.random.rand(4).astype('float32')
+    engine = relay.backend.compile_engine.get()
+    relay.backend.interpreter.clear_cache()
+    engine.clear()
+    check_eval(func, [x_data], np.exp(x_data) + 1, rtol=1e-5)
+    assert len(engine.items()) == 1
+    # Another interpreter reuses the compiled operator, even once the engine is cleared.
+    engine.clear()
+    check_eval(func, [x_data], np.exp(x_data) + 1, rtol=1e-5)
+    assert len(engine.items()) == 0
+    relay.backend.interpreter.clear_cache()
+    check_eval(func, [x_data], np.exp(x_data) + 1, rtol=1e-5)
+    assert len(engine.items()) == 1
+
+
+def test_output_buffer_reuse():
+    x = relay.var('x', shape=(3,), dtype='float32')
+    f = create_executor().evaluate(relay.Function([x], relay.negative(x)))
+    x_data = np.random.rand(3).astype('float32')
+    out1 = f(x_data)
+    out2 = f(x_data + 1)
+    # A buffer still referred to is never overwritten.
+    tvm.testing.assert_allclose(out1.asnumpy(), -x_data)
+    tvm.testing.assert_allclose(out2.asnumpy(), -(x_data + 1))
+
+
 if __name__ == "__main__":
     test_id()
     test_add_const()
@@ -245,3 +274,5 @@ if __name__ == "__main__":
     test_tuple_getitem()
     test_function_taking_adt_ref_tuple()
     test_tuple_passing()
+    test_compiled_op_cache()
+    test_output_buffer_reuse()
@@ -609,6 +609,32 @@ def test_rewrite():
     assert sub_pattern.match(out)
 
 
+def test_rewrite_rematch():
+    x = relay.var('x')
+    y = relay.var('y')
+    z = relay.var('z')
+
+    class AddToSubtract(DFPatternCallback):
+        def __init__(self):
+            super(AddToSubtract, self).__init__()
+            self.pattern = is_op('add')(wildcard(), wildcard())
+
+        def callback(self, pre, post, node_map):
+            return post.args[0] - post.args[1]
+
+    class MultiplyToAdd(DFPatternCallback):
+        def __init__(self):
+            super(MultiplyToAdd, self).__init__()
+            self.pattern = is_op('multiply')(wildcard(), wildcard())
+
+        def callback(self, pre, post, node_map):
+            return post.args[0] + post.args[1]
+
+    # The add created by the second callback is rewritten by the first one in the next pass.
+    out = rewrite([AddToSubtract(), MultiplyToAdd()], x * y + z)
+    assert tvm.ir.structural_equal(out, (x - y) - z)
+
+
 def test_rewrite_func():
     x = relay.var('x')
     w = relay.var('w')
@@ -1389,6 +1415,7 @@ if __name__ == "__main__":
     test_match_dominator()
     test_not_match_dominator()
     test_rewrite()
+    test_rewrite_rematch()
     test_rewrite_func()
     test_nested_rewrite()
     test_not_fuse_multi_diamond()
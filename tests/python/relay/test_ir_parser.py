@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 from tvm import te
 from tvm import relay
@@ -950,6 +951,21 @@ def test_resnet_inlined_params():
     parsed_mod = tvm.parser.parse(text)
     tvm.ir.assert_structural_equal(mod, parsed_mod)
 
+def test_meta_table_lazy_load():
+    data = np.random.uniform(size=(8, 8)).astype("float32")
+    c = relay.const(data)
+    unused = relay.const(np.zeros((4, 4), "float32"))
+    x = relay.var("x", shape=(8, 8))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.add(relay.add(x, c), c)))
+    # Only the referenced entries of the metadata section are loaded.
+    meta = {"relay.Constant": [c, unused]}
+    text = mod.astext(show_meta_data=False) + "#[metadata]\n" + tvm.ir.save_json(meta)
+    parsed_mod = tvm.parser.parse(text)
+    tvm.ir.assert_structural_equal(mod, parsed_mod)
+    body = parsed_mod["main"].body
+    assert body.args[1].same_as(body.args[0].args[1])
+    np.testing.assert_equal(body.args[1].data.asnumpy(), data)
+
 if __name__ == "__main__":
     import sys
     pytest.main(sys.argv)
@@ -511,7 +511,119 @@ def test_composite():
 
         return mod, ref_mod, {'data': i_data, 'weight': w1_data, 'bias': b_data}, (1, 32, 14, 14)
 
-    for mod, ref_mod, input_maps, out_shape in [conv2d_relu(), conv2d_bias_relu()]:
+    def conv2d_bias_sum_relu():
+        ishape = (1, 32, 14, 14)
+        w1shape = (32, 32, 3, 3)
+        bshape = (32, 1, 1)
+
+        # Composite function
+        in_1 = relay.var("in_1", shape=ishape, dtype=dtype)
+        in_2 = relay.var("in_2", shape=w1shape, dtype=dtype)
+        in_3 = relay.var("in_3", shape=bshape, dtype=dtype)
+        in_4 = relay.var("in_4", shape=ishape, dtype=dtype)
+        conv2d = relay.nn.conv2d(in_1, in_2, kernel_size=(3, 3), padding=(1, 1))
+        add = relay.add(conv2d, in_3)
+        add = relay.add(add, in_4)
+        relu = relay.nn.relu(add)
+        func = relay.Function([in_1, in_2, in_3, in_4], relu)
+        func = func.with_attr('Composite', 'dnnl.conv2d_bias_sum_relu')
+        func = func.with_attr('PartitionedFromPattern', 'nn.conv2d_add_add_nn.relu_')
+
+        # Partition function
+        arg_1 = relay.var("arg_1", shape=ishape, dtype=dtype)
+        arg_2 = relay.var("arg_2", shape=w1shape, dtype=dtype)
+        arg_3 = relay.var("arg_3", shape=bshape, dtype=dtype)
+        arg_4 = relay.var("arg_4", shape=ishape, dtype=dtype)
+        call = relay.Call(func, [arg_1, arg_2, arg_3, arg_4])
+        p_func = relay.Function([arg_1, arg_2, arg_3, arg_4], call)
+        p_func = set_func_attr(p_func, "dnnl", "dnnl_0")
+        glb_var = relay.GlobalVar("dnnl_0")
+        mod = tvm.IRModule()
+        mod[glb_var] = p_func
+
+        # Main function
+        data = relay.var("data", shape=ishape, dtype=dtype)
+        weight = relay.var("weight", shape=w1shape, dtype=dtype)
+        bias = relay.var('bias', shape=bshape, dtype=dtype)
+        residual = relay.var('residual', shape=ishape, dtype=dtype)
+        main_func = relay.Function([data, weight, bias, residual],
+                                   glb_var(data, weight, bias, residual))
+        mod["main"] = main_func
+
+        # Reference module
+        data = relay.var("data", shape=ishape, dtype=dtype)
+        weight = relay.var("weight", shape=w1shape, dtype=dtype)
+        bias = relay.var('bias', shape=bshape, dtype=dtype)
+        residual = relay.var('residual', shape=ishape, dtype=dtype)
+        conv2d = relay.nn.conv2d(data, weight, kernel_size=(3, 3), padding=(1, 1))
+        add = relay.add(conv2d, bias)
+        add = relay.add(add, residual)
+        relu = relay.nn.relu(add)
+        main_func = relay.Function([data, weight, bias, residual], relu)
+        ref_mod = tvm.IRModule()
+        ref_mod["main"] = main_func
+
+        i_data = np.random.uniform(0, 1, ishape).astype(dtype)
+        w1_data = np.random.uniform(0, 1, w1shape).astype(dtype)
+        b_data = np.random.uniform(0, 1, bshape).astype(dtype)
+        r_data = np.random.uniform(-1, 1, ishape).astype(dtype)
+
+        return mod, ref_mod, {'data': i_data, 'weight': w1_data, 'bias': b_data,
+                              'residual': r_data}, (1, 32, 14, 14)
+
+    def dense_bias_relu():
+        ishape = (1, 32)
+        w1shape = (16, 32)
+        bshape = (16,)
+
+        # Composite function
+        in_1 = relay.var("in_1", shape=ishape, dtype=dtype)
+        in_2 = relay.var("in_2", shape=w1shape, dtype=dtype)
+        in_3 = relay.var("in_3", shape=bshape, dtype=dtype)
+        dense = relay.nn.dense(in_1, in_2)
+        add = relay.add(dense, in_3)
+        relu = relay.nn.relu(add)
+        func = relay.Function([in_1, in_2, in_3], relu)
+        func = func.with_attr('Composite', 'dnnl.dense_bias_relu')
+        func = func.with_attr('PartitionedFromPattern', 'nn.dense_add_nn.relu_')
+
+        # Partition function
+        arg_1 = relay.var("arg_1", shape=ishape, dtype=dtype)
+        arg_2 = relay.var("arg_2", shape=w1shape, dtype=dtype)
+        arg_3 = relay.var("arg_3", shape=bshape, dtype=dtype)
+        call = relay.Call(func, [arg_1, arg_2, arg_3])
+        p_func = relay.Function([arg_1, arg_2, arg_3], call)
+        p_func = set_func_attr(p_func, "dnnl", "dnnl_0")
+        glb_var = relay.GlobalVar("dnnl_0")
+        mod = tvm.IRModule()
+        mod[glb_var] = p_func
+
+        # Main function
+        data = relay.var("data", shape=ishape, dtype=dtype)
+        weight = relay.var("weight", shape=w1shape, dtype=dtype)
+        bias = relay.var('bias', shape=bshape, dtype=dtype)
+        main_func = relay.Function([data, weight, bias], glb_var(data, weight, bias))
+        mod["main"] = main_func
+
+        # Reference module
+        data = relay.var("data", shape=ishape, dtype=dtype)
+        weight = relay.var("weight", shape=w1shape, dtype=dtype)
+        bias = relay.var('bias', shape=bshape, dtype=dtype)
+        dense = relay.nn.dense(data, weight)
+        add = relay.add(dense, bias)
+        relu = relay.nn.relu(add)
+        main_func = relay.Function([data, weight, bias], relu)
+        ref_mod = tvm.IRModule()
+        ref_mod["main"] = main_func
+
+        i_data = np.random.uniform(0, 1, ishape).astype(dtype)
+        w1_data = np.random.uniform(0, 1, w1shape).astype(dtype)
+        b_data = np.random.uniform(-1, 1, bshape).astype(dtype)
+
+        return mod, ref_mod, {'data': i_data, 'weight': w1_data, 'bias': b_data}, (1, 16)
+
+    for mod, ref_mod, input_maps, out_shape in [conv2d_relu(), conv2d_bias_relu(),
+                                                conv2d_bias_sum_relu(), dense_bias_relu()]:
         check_result(mod, ref_mod, input_maps, out_shape, tol=1e-5)
 
 
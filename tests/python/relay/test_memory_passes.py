@@ -104,7 +104,42 @@ def test_no_fuse():
     func = relay.Function([x, y, w], out)
     check_memory_plan(func, check_no_fuse)
 
+def planned_region_bytes(func):
+    mod = tvm.IRModule.from_expr(func)
+    mod = relay.transform.InferType()(mod)
+    mod = relay.transform.FuseOps(0)(mod)
+    mod = relay.transform.ToANormalForm()(mod)
+    mod = relay.transform._ffi_api.InlinePrimitives()(mod)
+    mod = relay.transform.InferType()(mod)
+    mod = relay.transform.memory_alloc.ManifestAlloc(tvm.target.create("llvm"))(mod)
+    mod = relay.transform.memory_plan.MemoryPlan()(mod)
+
+    sizes = []
+    def _visit(node):
+        if isinstance(node, relay.Let) and node.var.name_hint.startswith("total_size"):
+            assert isinstance(node.value, relay.Constant)
+            sizes.append(node.value.data.asnumpy().item())
+    relay.analysis.post_order_visit(mod["main"], _visit)
+    return sum(sizes)
+
+def check_chain(x):
+    for _ in range(4):
+        x = np.exp(x)
+    return x
+
+def test_liveness_reuse():
+    x = relay.var('x', shape=(5, 5))
+    y = x
+    for _ in range(4):
+        y = relay.exp(y)
+    func = relay.Function([x], y)
+
+    # Four float32 outputs of 128 aligned bytes, only two live at once.
+    assert planned_region_bytes(func) == 256
+    check_memory_plan(func, check_chain)
+
 if __name__ == "__main__":
     test_tyck_alloc_tensor()
     test_add()
     test_add_sub()
+    test_liveness_reuse()
@@ -1117,6 +1117,132 @@ def test_alter_layout_nhwc_int8_aarch64():
 
     assert tvm.ir.structural_equal(a, b), "Actual = \n" + str(a)
 
+def test_alter_layout_dense_pack():
+    """ Check that AlterOpLayout pre-packs the weight of dense on x86. """
+    from tvm import autotvm
+    from tvm.autotvm.task.space import SplitEntity
+    M, N, K, bn = 32, 48, 64, 8
+
+    # Only the dense_pack template has a tuned config, so it is selected.
+    class DensePackContext(autotvm.FallbackContext):
+        def _query_inside(self, target, workload):
+            key = (target, workload)
+            if key in self.memory:
+                return self.memory[key]
+            cfg = autotvm.task.space.FallbackConfigEntity()
+            if workload[0] == "dense_pack.x86":
+                cfg.is_fallback = False
+                cfg.cost = 0
+                cfg["tile_y"] = SplitEntity([2, 2, 8])
+                cfg["tile_x"] = SplitEntity([3, 2, bn])
+                cfg["tile_k"] = SplitEntity([K, 1])
+            self.memory[key] = cfg
+            return cfg
+
+    def alter_dense(attrs, inputs, tinfos, out_type):
+        from tvm import topi
+        with tvm.target.create("llvm"):
+            with DensePackContext():
+                return topi.nn.dense_alter_layout(attrs, inputs, tinfos, out_type)
+
+    def before():
+        x = relay.var("x", shape=(M, K))
+        weight = relay.var("weight", shape=(N, K))
+        y = relay.nn.dense(x, weight)
+        y = relay.nn.relu(y)
+        y = relay.Function(analysis.free_vars(y), y)
+        return y
+
+    def expected():
+        x = relay.var("x", shape=(M, K))
+        weight = relay.var("weight", shape=(N, K))
+        weight = relay.layout_transform(weight, "NK", "NK%dn" % bn)
+        y = relay.nn.contrib_dense_pack(x, weight, None, "float32", "NK%dn" % bn)
+        y = relay.nn.relu(y)
+        y = relay.Function(analysis.free_vars(y), y)
+        return y
+
+    with TempOpAttr("nn.dense", "FTVMAlterOpLayout", alter_dense):
+        a = run_opt_pass(before(), transform.AlterOpLayout())
+        b = run_opt_pass(expected(), transform.InferType())
+    assert tvm.ir.structural_equal(a, b), "Actual = \n" + str(a)
+
+    # The pre-packed graph computes the same result.
+    x_np = np.random.uniform(size=(M, K)).astype("float32")
+    w_np = np.random.uniform(size=(N, K)).astype("float32")
+    ref = np.maximum(np.dot(x_np, w_np.T), 0)
+    for target, ctx in ctx_list():
+        if target != "llvm":
+            continue
+        ex = relay.create_executor("graph", ctx=ctx, target=target)
+        res = ex.evaluate(a)(x_np, w_np)
+        tvm.testing.assert_allclose(res.asnumpy(), ref, rtol=1e-5)
+
+
+def test_alter_layout_dense_int8_dot():
+    """ Check that AlterOpLayout pre-packs the weight of the int8 dot product dense. """
+    M, N, K = 8, 32, 64
+
+    def check(target, data_dtype, weight_dtype, weight_layout, packed_shape):
+        def alter_dense(attrs, inputs, tinfos, out_type):
+            from tvm import topi
+            with tvm.target.create(target):
+                return topi.nn.dense_alter_layout(attrs, inputs, tinfos, out_type)
+
+        def before():
+            x = relay.var("x", shape=(M, K), dtype=data_dtype)
+            weight = relay.var("weight", shape=(N, K), dtype=weight_dtype)
+            y = relay.nn.dense(x, weight, out_dtype="int32")
+            y = relay.Function(analysis.free_vars(y), y)
+            return y
+
+        def expected():
+            x = relay.var("x", shape=(M, K), dtype=data_dtype)
+            weight = relay.var("weight", shape=(N, K), dtype=weight_dtype)
+            weight = relay.layout_transform(weight, "NK", weight_layout)
+            y = relay.nn.contrib_dense_pack(x, weight, None, "int32", weight_layout)
+            y = relay.Function(analysis.free_vars(y), y)
+            return y
+
+        with TempOpAttr("nn.dense", "FTVMAlterOpLayout", alter_dense):
+            a = run_opt_pass(before(), transform.AlterOpLayout())
+            b = run_opt_pass(expected(), transform.InferType())
+        assert tvm.ir.structural_equal(a, b), "Actual = \n" + str(a)
+
+        # With a constant weight, the packing is folded at compile time.
+        low = -128 if weight_dtype == "int8" else 0
+        w_np = np.random.randint(low, 127, size=(N, K)).astype(weight_dtype)
+        with tvm.transform.PassContext(opt_level=3):
+            mod, _ = relay.optimize(tvm.IRModule.from_expr(before()), target,
+                                    params={"weight": w_np})
+        packed = []
+        def visit(expr):
+            if isinstance(expr, relay.Call) and expr.op.name == "nn.contrib_dense_pack":
+                packed.append(expr.args[1])
+        relay.analysis.post_order_visit(mod["main"], visit)
+        assert len(packed) == 1 and isinstance(packed[0], relay.Constant)
+        assert packed[0].data.shape == packed_shape
+        return w_np
+
+    if not tvm.runtime.enabled("llvm") or tvm.target.codegen.llvm_version_major() < 8:
+        return
+    check("llvm -device=arm_cpu -mtriple=aarch64-linux-gnu -mattr=+v8.2a,+dotprod",
+          "int8", "int8", "NK4n4k", (N // 4, K // 4, 4, 4))
+    target = "llvm -mcpu=cascadelake"
+    w_np = check(target, "uint8", "int8", "NK16n4k", (N // 16, K // 4, 16, 4))
+
+    # only compare the result when the host is able to run AVX512 VNNI code
+    if "avx512vnni" not in open("/proc/cpuinfo").read():
+        return
+    x_np = np.random.randint(0, 255, size=(M, K)).astype("uint8")
+    x = relay.var("x", shape=(M, K), dtype="uint8")
+    y = relay.nn.dense(x, relay.const(w_np), out_dtype="int32")
+    ex = relay.create_executor("graph", ctx=tvm.cpu(), target=target)
+    res = ex.evaluate(relay.Function([x], y))(x_np)
+    tvm.testing.assert_allclose(res.asnumpy(), np.dot(x_np.astype("int32"),
+                                                      w_np.T.astype("int32")))
+
+
 def test_alter_op_with_global_var():
     """Test directly replacing an operator with a new one"""
     def before():
@@ -1179,4 +1305,6 @@ if __name__ == "__main__":
     test_alter_layout_sum()
     test_alter_layout_nhwc_arm()
     test_alter_layout_nhwc_int8_aarch64()
+    test_alter_layout_dense_pack()
+    test_alter_layout_dense_int8_dot()
     test_alter_op_with_global_var()
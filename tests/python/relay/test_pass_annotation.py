@@ -669,6 +669,40 @@ def test_tuple_get_item():
     assert tvm.ir.structural_equal(annotated_func, expected_func)
 
 
+def test_auto_device_placement():
+    ctx1 = tvm.context(1)
+    ctx2 = tvm.context(2)
+    x = relay.var("x", shape=(3,))
+    y = relay.var("y", shape=(3,))
+    z = relay.var("z", shape=(3,))
+
+    def op_cost(call, device_type):
+        if call.op.name == "add":
+            return 1.0 if device_type == ctx1.device_type else -1.0
+        if call.op.name == "exp":
+            return 10.0 if device_type == ctx1.device_type else 0.1
+        return 1.0
+
+    def placed(transfer):
+        add = relay.add(x, y)
+        sub = relay.subtract(add, z)
+        func = relay.Function([x, y, z], relay.exp(sub))
+        return run_opt_pass(func, [transform.InferType(),
+                                   transform.AutoDevicePlacement(
+                                       [ctx1, ctx2], op_cost,
+                                       lambda nbytes, src, dst: transfer)])
+
+    def expected(exp_ctx):
+        add = relay.annotation.on_device(relay.add(x, y), ctx1)
+        sub = relay.annotation.on_device(relay.subtract(add, z), ctx1)
+        exp = relay.annotation.on_device(relay.exp(sub), exp_ctx)
+        return run_opt_pass(relay.Function([x, y, z], exp), transform.InferType())
+
+    # The exp moves to the second device once the copy is cheaper than the difference.
+    assert tvm.ir.structural_equal(placed(0.01), expected(ctx2))
+    assert tvm.ir.structural_equal(placed(100.0), expected(ctx1))
+
+
 if __name__ == "__main__":
     test_redundant_annotation()
     test_annotate_expr()
@@ -677,3 +711,4 @@ if __name__ == "__main__":
     test_conv_network()
     test_check_run()
     test_tuple_get_item()
+    test_auto_device_placement()
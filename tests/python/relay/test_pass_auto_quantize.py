@@ -73,6 +73,61 @@ def test_batch_flatten_rewrite():
     # check if batch_flatten is quantized
     relay.analysis.post_order_visit(qmod["main"], _check_batch_flatten)
 
+def test_per_channel_weight_quantize():
+    """per-channel weight scales keep low-magnitude channels accurate, depthwise included"""
+    data = relay.var("data", shape=(1, 8, 16, 16))
+    conv = relay.nn.conv2d(data, relay.var("weight"),
+                           kernel_size=(3, 3),
+                           padding=(1, 1),
+                           channels=8)
+    act = relay.nn.relu(conv)
+    out = relay.nn.conv2d(act, relay.var("dw_weight"),
+                          kernel_size=(3, 3),
+                          padding=(1, 1),
+                          channels=8,
+                          groups=8)
+    mod = tvm.IRModule.from_expr(relay.Function(relay.analysis.free_vars(out), out))
+    mod = relay.transform.InferType()(mod)
+
+    np.random.seed(0)
+    # the magnitude of the weights shrinks by 2x for every output channel
+    channel_mag = (2.0 ** -np.arange(8)).astype("float32")
+    params = {
+        "weight": np.random.uniform(
+            0, 0.25, (8, 8, 3, 3)).astype("float32") * channel_mag.reshape(8, 1, 1, 1),
+        "dw_weight": np.random.uniform(
+            -1, 1, (8, 1, 3, 3)).astype("float32") * channel_mag.reshape(8, 1, 1, 1),
+    }
+    x = np.random.uniform(0, 1, (1, 8, 16, 16)).astype("float32")
+
+    def _run(mod, params=None):
+        params = params if params else {}
+        ex = relay.create_executor("graph", mod=mod, ctx=tvm.cpu(), target="llvm")
+        return ex.evaluate()(x, **params).asnumpy()
+
+    ref = _run(mod, params)
+
+    def _channel_error(per_channel):
+        with relay.quantize.qconfig(skip_conv_layers=[], weight_per_channel=per_channel):
+            qmod = relay.quantize.quantize(mod, params)
+
+        if per_channel:
+            def _check_conv2d(node):
+                if isinstance(node, Call) and node.op.name == "nn.conv2d":
+                    assert node.args[1].checked_type.dtype == "int8"
+                    assert node.checked_type.dtype == "int32"
+            relay.analysis.post_order_visit(qmod["main"], _check_conv2d)
+
+        res = _run(qmod)
+        err = np.abs(res - ref).mean(axis=(0, 2, 3))
+        return np.max(err / np.abs(ref).mean(axis=(0, 2, 3)))
+
+    per_tensor_err = _channel_error(False)
+    per_channel_err = _channel_error(True)
+    assert per_channel_err < per_tensor_err
+    assert per_channel_err < 0.1
+
+
 def get_calibration_dataset(mod, input_name):
     dataset = []
     input_shape = [int(x) for x in mod["main"].checked_type.arg_types[0].shape]
@@ -105,6 +160,43 @@ def test_calibrate_memory_bound():
         relay.quantize.quantize(mod, params, dataset)
 
 
+def test_calibrate_percentile():
+    mod, params = testing.synthetic.get_workload()
+    dataset = get_calibration_dataset(mod, "data")
+    with relay.quantize.qconfig(calibrate_mode="percentile", calibrate_percentile=0.999):
+        relay.quantize.quantize(mod, params, dataset)
+
+
+def test_streaming_calibrator():
+    from tvm.relay.quantize import _quantize
+    from tvm.relay.quantize.kl_divergence import _find_scale_by_kl
+    np.random.seed(0)
+    num_bins = 8001
+    batches = [np.random.normal(0, 1, (4, 256)).astype("float32"),
+               np.zeros((4, 256), "float32"),
+               np.random.normal(0, 3, (4, 256)).astype("float32")]
+
+    # a single batch is binned the same way as numpy
+    calibrator = _quantize.CreateStreamingCalibrator(num_bins)
+    _quantize.StreamingCalibratorUpdate(calibrator, tvm.nd.array(batches[0]))
+    kl = _quantize.StreamingCalibratorKLThresholds(calibrator, 255)[0].value
+    np.testing.assert_allclose(kl, _find_scale_by_kl(batches[0].reshape(-1)), rtol=1e-3)
+
+    # later batches widen the range without keeping the earlier ones
+    calibrator = _quantize.CreateStreamingCalibrator(num_bins)
+    for batch in batches:
+        _quantize.StreamingCalibratorUpdate(
+            calibrator, tvm.nd.array(batch), tvm.nd.array(-batch))
+    data = np.abs(np.concatenate(batches).reshape(-1))
+    max_bin_width = 2 * 2 * np.max(data) / num_bins
+    for percentile in [0.5, 0.99, 1.0]:
+        thresholds = _quantize.StreamingCalibratorPercentileThresholds(calibrator, percentile)
+        assert len(thresholds) == 2
+        expected = np.percentile(data, percentile * 100)
+        for t in thresholds:
+            assert abs(t.value - expected) <= 2 * max_bin_width
+
+
 ####################################
 # Quant/Dequant Partitioning Tests #
 ####################################
@@ -306,9 +398,12 @@ def test_unquantizable_suffix_partition():
 if __name__ == "__main__":
     test_mul_rewrite()
     test_batch_flatten_rewrite()
+    test_per_channel_weight_quantize()
     test_calibrate_target(False)
     test_calibrate_target(True)
     test_calibrate_memory_bound()
+    test_calibrate_percentile()
+    test_streaming_calibrator()
 
     test_add_partition()
     test_conv2d_partition()
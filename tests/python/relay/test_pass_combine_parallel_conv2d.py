@@ -232,8 +232,95 @@ def test_combine_parallel_conv2d_multiple_blocks():
     check((1, 4, 16, 16), 4)
 
 
+def test_combine_parallel_conv2d_different_kernels():
+    """Kernels of different sizes with the same center are padded to the largest one."""
+    def before(x, w1, w2, w3):
+        args = [x, w1, w2, w3]
+        y1 = relay.nn.conv2d(x, w1, kernel_size=(1, 1))
+        y2 = relay.nn.conv2d(x, w2, kernel_size=(3, 3), padding=(1, 1))
+        y3 = relay.nn.conv2d(x, w3, kernel_size=(5, 5), padding=(2, 2))
+        y = relay.Tuple((y1, y2, y3))
+        return relay.Function(args, y)
+
+    def expected(x, w1, w2, w3, channels1, channels2, channels3):
+        args = [x, w1, w2, w3]
+        w1 = relay.nn.pad(w1, ((0, 0), (0, 0), (2, 2), (2, 2)))
+        w2 = relay.nn.pad(w2, ((0, 0), (0, 0), (1, 1), (1, 1)))
+        w = relay.concatenate((w1, w2, w3), axis=0)
+        y = relay.nn.conv2d(x, w, channels=channels1 + channels2 + channels3,
+                            kernel_size=(5, 5), padding=(2, 2))
+        y1 = relay.strided_slice(y,
+                                 begin=relay.const([0, 0], "int64"),
+                                 end=relay.const([-1, channels1], "int64"),
+                                 strides=relay.const([1, 1], 'int64'),
+                                 slice_mode="size")
+        y2 = relay.strided_slice(y,
+                                 begin=relay.const([0, channels1], "int64"),
+                                 end=relay.const([-1, channels2], "int64"),
+                                 strides=relay.const([1, 1], 'int64'),
+                                 slice_mode="size")
+        y3 = relay.strided_slice(y,
+                                 begin=relay.const([0, channels1 + channels2], "int64"),
+                                 end=relay.const([-1, channels3], "int64"),
+                                 strides=relay.const([1, 1], 'int64'),
+                                 slice_mode="size")
+        y = relay.Tuple((y1, y2, y3))
+        return relay.Function(args, y)
+
+    def check(x_shape, channels1, channels2, channels3):
+        x = relay.var("x", shape=x_shape)
+        in_c = x_shape[1]
+        w1 = relay.var("w1", shape=(channels1, in_c, 1, 1))
+        w2 = relay.var("w2", shape=(channels2, in_c, 3, 3))
+        w3 = relay.var("w3", shape=(channels3, in_c, 5, 5))
+        y_before = before(x, w1, w2, w3)
+        y = run_opt_pass(y_before,
+                         transform.CombineParallelConv2D(min_num_branches=3))
+        y_expected = expected(x, w1, w2, w3, channels1, channels2, channels3)
+        y_expected = run_opt_pass(y_expected, transform.InferType())
+        assert tvm.ir.structural_equal(y, y_expected, map_free_vars=True)
+
+    check((1, 4, 16, 16), 4, 8, 4)
+
+
+def test_combine_parallel_conv2d_different_kernels_blocked_layout():
+    """The kernels are padded on the axes of a blocked kernel layout."""
+    def before(x, w1, w2):
+        y1 = relay.nn.conv2d(x, w1, kernel_size=(1, 1), kernel_layout="OIHW4o")
+        y2 = relay.nn.conv2d(x, w2, kernel_size=(3, 3), padding=(1, 1),
+                             kernel_layout="OIHW4o")
+        return relay.Function([x, w1, w2], relay.Tuple((y1, y2)))
+
+    def expected(x, w1, w2, channels1, channels2):
+        args = [x, w1, w2]
+        w1 = relay.nn.pad(w1, ((0, 0), (0, 0), (1, 1), (1, 1), (0, 0)))
+        w = relay.concatenate((w1, w2), axis=0)
+        y = relay.nn.conv2d(x, w, channels=channels1 + channels2, kernel_size=(3, 3),
+                            padding=(1, 1), kernel_layout="OIHW4o")
+        y1 = relay.strided_slice(y,
+                                 begin=relay.const([0, 0], "int64"),
+                                 end=relay.const([-1, channels1], "int64"),
+                                 strides=relay.const([1, 1], 'int64'),
+                                 slice_mode="size")
+        y2 = relay.strided_slice(y,
+                                 begin=relay.const([0, channels1], "int64"),
+                                 end=relay.const([-1, channels2], "int64"),
+                                 strides=relay.const([1, 1], 'int64'),
+                                 slice_mode="size")
+        return relay.Function(args, relay.Tuple((y1, y2)))
+
+    x = relay.var("x", shape=(1, 4, 16, 16))
+    w1 = relay.var("w1", shape=(2, 4, 1, 1, 4))
+    w2 = relay.var("w2", shape=(1, 4, 3, 3, 4))
+    y = run_opt_pass(before(x, w1, w2), transform.CombineParallelConv2D(min_num_branches=2))
+    y_expected = run_opt_pass(expected(x, w1, w2, 8, 4), transform.InferType())
+    assert tvm.ir.structural_equal(y, y_expected, map_free_vars=True)
+
+
 if __name__ == "__main__":
     test_combine_parallel_conv2d()
     test_combine_parallel_conv2d_scale_relu()
     test_combine_parallel_conv2d_scale()
     test_combine_parallel_conv2d_multiple_blocks()
+    test_combine_parallel_conv2d_different_kernels()
+    test_combine_parallel_conv2d_different_kernels_blocked_layout()
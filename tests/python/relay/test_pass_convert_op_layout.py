@@ -737,6 +737,40 @@ def test_different_ops_convert_layout():
     assert tvm.ir.structural_equal(a, b), "Actual = \n" + str(a)
 
 
+def test_plan_layout():
+    def before():
+        x = relay.var("x", shape=(1, 64, 56, 56))
+        weight1 = relay.var('weight1', shape=(64, 64, 3, 3))
+        weight2 = relay.var('weight2', shape=(64, 64, 3, 3))
+        y = relay.nn.conv2d(x, weight1, channels=64, kernel_size=(3, 3), padding=(1, 1))
+        y = relay.nn.relu(y)
+        y = relay.nn.conv2d(y, weight2, channels=64, kernel_size=(3, 3), padding=(1, 1))
+        y = relay.nn.relu(y)
+        return relay.Function(analysis.free_vars(y), y)
+
+    candidates = {'nn.conv2d': [['NHWC', 'HWIO']]}
+    unchanged = run_opt_pass(before(), transform.InferType())
+
+    # without a reason to convert, the transforms keep the original layouts
+    a = run_opt_pass(before(), transform.PlanLayout(candidates))
+    assert tvm.ir.structural_equal(a, unchanged), "Actual = \n" + str(a)
+
+    # a gain on the first conv alone does not pay for the transforms around it
+    def first_conv_cost(call, layouts):
+        return -100.0 if layouts and isinstance(call.args[0], relay.Var) else 0.0
+
+    a = run_opt_pass(before(), transform.PlanLayout(candidates, first_conv_cost))
+    assert tvm.ir.structural_equal(a, unchanged), "Actual = \n" + str(a)
+
+    # when both convs gain, they are converted together with no transform between them
+    def conv_cost(call, layouts):
+        return 0.0 if layouts else 1e9
+
+    a = run_opt_pass(before(), transform.PlanLayout(candidates, conv_cost))
+    b = run_opt_pass(before(), transform.ConvertLayout({'nn.conv2d': ['NHWC', 'HWIO']}))
+    assert tvm.ir.structural_equal(a, b), "Actual = \n" + str(a)
+
+
 if __name__ == "__main__":
     test_no_convert_layout()
     test_conv_convert_layout()
@@ -753,3 +787,4 @@ if __name__ == "__main__":
     test_conv_convert_kernel_layout()
     test_default_keyword()
     test_different_ops_convert_layout()
+    test_plan_layout()
@@ -0,0 +1,71 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay import transform
+
+
+def constants(expr):
+    consts = []
+
+    def _visit(node):
+        if isinstance(node, relay.Constant) and all(not c.same_as(node) for c in consts):
+            consts.append(node)
+
+    relay.analysis.post_order_visit(expr, _visit)
+    return consts
+
+
+def test_tied_weights():
+    w_data = np.random.uniform(size=(8, 8)).astype("float32")
+    x = relay.var("x", shape=(1, 8))
+    w0 = relay.const(w_data)
+    w1 = relay.const(w_data.copy())
+    w2 = relay.const(w_data.astype("float16"))
+    y = relay.nn.dense(relay.nn.dense(x, w0), w1)
+    z = relay.nn.dense(relay.cast(y, "float16"), w2)
+    mod = tvm.IRModule.from_expr(relay.Function([x], z))
+    new_mod = transform.DeduplicateConstants()(mod)
+    # the float16 copy has different contents and stays apart
+    assert len(constants(new_mod["main"])) == 2
+    # the input module is left untouched
+    assert len(constants(mod["main"])) == 3
+
+
+def test_deduplicate_then_cse():
+    w_data = np.random.uniform(size=(8, 8)).astype("float32")
+    x = relay.var("x", shape=(1, 8))
+    a = relay.nn.dense(x, relay.const(w_data))
+    b = relay.nn.dense(x, relay.const(w_data.copy()))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.Tuple([a, b])))
+    seq = tvm.transform.Sequential(
+        [
+            transform.InferType(),
+            transform.DeduplicateConstants(),
+            transform.EliminateCommonSubexpr(),
+        ]
+    )
+    mod = seq(mod)
+    body = mod["main"].body
+    assert body.fields[0].same_as(body.fields[1])
+
+
+if __name__ == "__main__":
+    test_tied_weights()
+    test_deduplicate_then_cse()
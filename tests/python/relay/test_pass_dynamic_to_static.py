@@ -360,6 +360,29 @@ def test_dynamic_to_static_pad():
     verify_pad((4, 10, 7, 7), ((1, 1), (2, 2), (3, 3), (4, 4)), 2.0, "int32")
     verify_pad((2, 7), ((1, 4), (2, 2)), 4.0, "float64")
 
+def test_specialize_dynamic_shapes():
+    x = relay.var("x", relay.TensorType((relay.Any(), 4), "float32"))
+    z = relay.add(x, relay.ones(relay.shape_of(x), "float32"))
+    func = run_infer_type(relay.Function([x], z))
+    profile = {"x": [(8, 4), (3, 4), (8, 4)]}
+    mod = transform.SpecializeDynamicShapes(profile)(tvm.IRModule.from_expr(func))
+    mod = transform.InferType()(mod)
+    assert mod["main"].checked_type == func.checked_type
+
+    guarded = mod["main"].body
+    assert isinstance(guarded, relay.Let) and isinstance(guarded.body, relay.If)
+    # the fast path computes with static shapes, the fallback is unchanged
+    assert "dyn.ones" not in guarded.body.true_branch.astext()
+    assert "dyn.ones" in guarded.body.false_branch.astext()
+
+    for shape in [(8, 4), (3, 4)]:
+        x_data = np.random.uniform(size=shape).astype("float32")
+        for target, ctx in ctx_list():
+            intrp = relay.create_executor("vm", mod=mod, ctx=ctx, target=target)
+            op_res = intrp.evaluate()(x_data)
+            tvm.testing.assert_allclose(op_res.asnumpy(), x_data + 1, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_dynamic_to_static_reshape()
     test_dynamic_to_static_double_reshape()
@@ -373,3 +396,4 @@ if __name__ == "__main__":
     test_dynamic_to_static_full()
     test_dynamic_to_static_upsampling()
     test_dynamic_to_static_pad()
+    test_specialize_dynamic_shapes()
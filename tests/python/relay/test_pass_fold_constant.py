@@ -241,6 +241,45 @@ def test_fold_batch_norm():
     assert tvm.ir.structural_equal(mod["main"], expect)
 
 
+def test_fold_native_ops():
+    x_data = np.random.rand(2, 16, 3, 4).astype("float32")
+    b_data = np.random.rand(16).astype("float32")
+    def before():
+        y = relay.layout_transform(relay.const(x_data), "NCHW", "NCHW8c")
+        y = relay.layout_transform(y, "NCHW8c", "NHWC")
+        y = relay.transpose(y, axes=(0, 3, 1, 2))
+        y = relay.add(y, relay.reshape(relay.const(b_data), (16, 1, 1)))
+        y = relay.maximum(relay.negative(y), relay.const(-0.5))
+        y = relay.cast(relay.expand_dims(y, 0), "float64")
+        return relay.Function([], y)
+
+    fold = tvm.transform.Sequential([transform.InferType(), transform.FoldConstant()])
+    zz = run_opt_pass(before(), fold)
+    assert isinstance(zz.body, relay.Constant)
+    ref = np.maximum(-(x_data + b_data.reshape(16, 1, 1)), -0.5)[None].astype("float64")
+    np.testing.assert_allclose(zz.body.data.asnumpy(), ref)
+
+
+def test_fold_batched():
+    c_data = np.random.rand(3, 4).astype("float32")
+    def before():
+        c = relay.const(c_data)
+        x = relay.var("x", shape=(3, 4))
+        y = relay.add(x, relay.exp(relay.exp(c)))
+        z = relay.split(relay.sqrt(c), 2, axis=1)[1]
+        return relay.Function([x], relay.Tuple([y, z, relay.nn.softmax(c)]))
+
+    fold = tvm.transform.Sequential([transform.InferType(), transform.FoldConstant()])
+    zz = run_opt_pass(before(), fold)
+    assert isinstance(zz.body.fields[0].args[1], relay.Constant)
+    assert isinstance(zz.body.fields[1], relay.Constant)
+    assert isinstance(zz.body.fields[2], relay.Constant)
+    np.testing.assert_allclose(zz.body.fields[0].args[1].data.asnumpy(),
+                               np.exp(np.exp(c_data)), rtol=1e-5)
+    np.testing.assert_allclose(zz.body.fields[1].data.asnumpy(),
+                               np.split(np.sqrt(c_data), 2, axis=1)[1], rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_fold_const()
     test_fold_let()
@@ -250,3 +289,5 @@ if __name__ == "__main__":
     test_fold_full()
     test_fold_batch_norm()
     test_fold_ndarray_size()
+    test_fold_native_ops()
+    test_fold_batched()
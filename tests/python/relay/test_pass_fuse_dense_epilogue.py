@@ -0,0 +1,70 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import relay
+from tvm.relay import transform
+from tvm.relay.testing import run_opt_pass
+
+
+def _inputs(dtype="float32", bias_shape=(32,)):
+    x = relay.var("x", shape=(8, 16), dtype=dtype)
+    w = relay.var("w", shape=(32, 16), dtype=dtype)
+    b = relay.var("b", shape=bias_shape, dtype=dtype)
+    return x, w, b
+
+
+def _gelu(y):
+    return y * (relay.const(0.5) +
+                relay.erf(y * relay.const(0.5 ** 0.5)) * relay.const(0.5))
+
+
+def check_fused(act_func, activation):
+    x, w, b = _inputs()
+    y = act_func(relay.add(relay.nn.dense(x, w), b))
+    before = relay.Function([x, w, b], y)
+
+    x, w, b = _inputs()
+    y = relay.nn.contrib_dense_bias_act(x, w, b, units=None, activation=activation)
+    expected = run_opt_pass(relay.Function([x, w, b], y), transform.InferType())
+
+    after = run_opt_pass(before, transform.FuseDenseEpilogue())
+    assert tvm.ir.structural_equal(after, expected), after
+
+
+def test_fuse_dense_epilogue():
+    check_fused(lambda y: y, "none")
+    check_fused(relay.nn.relu, "relu")
+    check_fused(_gelu, "gelu")
+
+
+def test_fuse_dense_epilogue_skip():
+    def check_unchanged(dtype, bias_shape):
+        x, w, b = _inputs(dtype, bias_shape)
+        y = relay.nn.relu(relay.add(relay.nn.dense(x, w), b))
+        func = relay.Function([x, w, b], y)
+        after = run_opt_pass(func, transform.FuseDenseEpilogue())
+        assert tvm.ir.structural_equal(after, run_opt_pass(func, transform.InferType()))
+
+    # The bias must broadcast along the units.
+    check_unchanged("float32", (8, 32))
+    # Only floating point GEMMs have an epilogue.
+    check_unchanged("int32", (32,))
+
+
+if __name__ == "__main__":
+    test_fuse_dense_epilogue()
+    test_fuse_dense_epilogue_skip()
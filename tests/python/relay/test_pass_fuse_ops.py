@@ -773,6 +773,58 @@ def test_fuse_max_diamond():
     assert tvm.ir.structural_equal(fused, expected)
 
 
+def test_fuse_cost_model():
+    def before():
+        x = relay.var("x", shape=(64, 64))
+        a = relay.exp(x)
+        b = relay.transpose(a)
+        c = relay.add(a, b)
+        return relay.Function([x], relay.sum(c, axis=1))
+
+    def num_groups(func):
+        calls = []
+        relay.analysis.post_order_visit(
+            func, lambda e: calls.append(e)
+            if isinstance(e, relay.Call) and isinstance(e.op, relay.Function) else None)
+        return len(calls)
+
+    # the rules fuse the transpose into the reduction
+    assert num_groups(run_opt_pass(before(), transform.FuseOps())) == 1
+
+    # the memory traffic model keeps the strided reads out of the reduction
+    with tvm.transform.PassContext(config={"relay.FuseOps.cost_model": "memory"}):
+        fused = run_opt_pass(before(), transform.FuseOps())
+    assert num_groups(fused) == 2
+    reduce_func = fused.body.op
+    assert isinstance(reduce_func.body, relay.Call) and reduce_func.body.op.name == "sum"
+    assert isinstance(reduce_func.body.args[0], relay.Var)
+
+    # a registered function can serve as the cost model
+    tvm.register_func("relay.test.fuse_cost_no_fusion",
+                      lambda group: float(len(group)) ** 2, override=True)
+    with tvm.transform.PassContext(
+            config={"relay.FuseOps.cost_model": "relay.test.fuse_cost_no_fusion"}):
+        assert num_groups(run_opt_pass(before(), transform.FuseOps())) == 4
+
+
+def test_fuse_deep_chain():
+    """Test graphs deeper than the recursion allows."""
+    depth = 20000
+    x = relay.var("x", shape=(10, 20))
+    y = x
+    for _ in range(depth):
+        y = relay.exp(y)
+    fused = run_opt_pass(relay.Function([x], y), transform.FuseOps())
+
+    num_groups = 0
+    body = fused.body
+    while isinstance(body, relay.Call) and isinstance(body.op, relay.Function):
+        num_groups += 1
+        body = body.args[0]
+    assert body.same_as(fused.params[0])
+    assert num_groups == (depth + 255) // 256
+
+
 if __name__ == "__main__":
     test_fuse_simple()
     test_conv2d_fuse()
@@ -793,3 +845,5 @@ if __name__ == "__main__":
     test_fuse_gather_nd()
     test_fuse_bcast_reduce_scalar()
     test_fuse_max_diamond()
+    test_fuse_cost_model()
+    test_fuse_deep_chain()
@@ -0,0 +1,101 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay import transform
+from tvm.relay.testing import run_opt_pass
+
+SHAPES = [(4, 3), (7,), (2, 5, 3)]
+
+
+def _vars(prefix):
+    return [relay.var("%s%d" % (prefix, i), shape=shape) for i, shape in enumerate(SHAPES)]
+
+
+def _run(func, args):
+    mod = tvm.IRModule.from_expr(func)
+    result = relay.create_executor("graph", mod=mod, target="llvm").evaluate()(*args)
+    return [r.asnumpy() for r in result]
+
+
+def _random_args(num):
+    return [np.random.uniform(0.5, 1, size=shape).astype("float32")
+            for _ in range(num) for shape in SHAPES] + [np.array(0.1, dtype="float32")]
+
+
+def test_fuse_sgd():
+    def before():
+        ws, gs, lr = _vars("w"), _vars("g"), relay.var("lr", shape=())
+        outs = [w - lr * g for w, g in zip(ws, gs)]
+        return relay.Function(ws + gs + [lr], relay.Tuple(outs))
+
+    def expected():
+        ws, gs, lr = _vars("w"), _vars("g"), relay.var("lr", shape=())
+        fused = relay.nn.multi_sgd_update(ws, gs, lr)
+        return relay.Function(ws + gs + [lr], relay.Tuple([fused[i] for i in range(len(ws))]))
+
+    after = run_opt_pass(before(), transform.FuseOptimizerUpdates())
+    assert tvm.ir.structural_equal(after, run_opt_pass(expected(), transform.InferType())), after
+
+    args = _random_args(2)
+    for ref, out in zip(_run(before(), args), _run(after, args)):
+        tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+
+def test_fuse_adam():
+    beta1, beta2, eps = 0.9, 0.999, 1e-8
+
+    def before():
+        ws, gs, ms, vs = _vars("w"), _vars("g"), _vars("m"), _vars("v")
+        lr = relay.var("lr", shape=())
+        new_ws, new_ms, new_vs = [], [], []
+        for w, g, m, v in zip(ws, gs, ms, vs):
+            m1 = relay.const(beta1) * m + relay.const(1 - beta1) * g
+            v1 = relay.const(beta2) * v + relay.const(1 - beta2) * (g * g)
+            new_ws.append(w - lr * (m1 / (relay.sqrt(v1) + relay.const(eps))))
+            new_ms.append(m1)
+            new_vs.append(v1)
+        return relay.Function(ws + gs + ms + vs + [lr], relay.Tuple(new_ws + new_ms + new_vs))
+
+    after = run_opt_pass(before(), transform.FuseOptimizerUpdates())
+    calls = []
+    relay.analysis.post_order_visit(
+        after, lambda e: calls.append(e.op.name) if isinstance(e, relay.Call) else None)
+    assert calls == ["nn.multi_adam_update"], after
+
+    args = _random_args(4)
+    for ref, out in zip(_run(before(), args), _run(after, args)):
+        tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+
+def test_fuse_skip_dependent():
+    # The gradient of w1 depends on the update of w0, they cannot be fused.
+    w0, w1 = relay.var("w0", shape=(3,)), relay.var("w1", shape=(3,))
+    g0, lr = relay.var("g0", shape=(3,)), relay.var("lr", shape=())
+    new_w0 = w0 - lr * g0
+    new_w1 = w1 - lr * relay.exp(new_w0)
+    func = relay.Function([w0, w1, g0, lr], relay.Tuple([new_w0, new_w1]))
+    after = run_opt_pass(func, transform.FuseOptimizerUpdates())
+    assert tvm.ir.structural_equal(after, run_opt_pass(func, transform.InferType()))
+
+
+if __name__ == "__main__":
+    test_fuse_sgd()
+    test_fuse_adam()
+    test_fuse_skip_dependent()
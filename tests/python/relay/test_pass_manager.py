@@ -555,5 +555,36 @@ def test_print_debug_callback():
     assert __TRACE_COUNTER__ == 3
 
 
+def test_pass_profile():
+    x = relay.var("x", shape=(1, 2, 3))
+    y = relay.add(x, x)
+    y = relay.multiply(y, relay.add(relay.const(1.0), relay.const(1.0)))
+    mod = tvm.IRModule.from_expr(relay.Function([x], y))
+
+    seq = tvm.transform.Sequential([
+        relay.transform.InferType(),
+        relay.transform.FoldConstant(),
+        relay.transform.DeadCodeElimination()
+    ], name="outer")
+
+    with tvm.transform.PassContext(opt_level=3) as ctx:
+        seq(mod)
+    assert len(ctx.pass_profiles) == 0
+
+    with tvm.transform.PassContext(opt_level=3, config={"ir.profile_passes": True}) as ctx:
+        seq(mod)
+    profiles = {p.name: p for p in ctx.pass_profiles}
+    for name in ["InferType", "FoldConstant", "DeadCodeElimination"]:
+        assert name in profiles
+        assert profiles[name].depth >= 1
+        assert profiles[name].nodes_before > 0
+    outer = profiles["outer"]
+    assert outer.depth == 0
+    assert outer.time_ms >= sum(p.time_ms for p in ctx.pass_profiles if p.depth == 1)
+    assert outer.self_time_ms <= outer.time_ms
+    report = ctx.profile_report()
+    assert "outer" in report and "FoldConstant" in report
+
+
 if __name__ == "__main__":
     pytest.main()
@@ -211,6 +211,37 @@ def test_example_graph():
     assert tvm.ir.structural_equal(mod, ref_mod)
 
 
+def test_prune_compiler_regions():
+    """The single operator region is not worth its launch, the other one is."""
+    def region_cost(func, compiler):
+        num_ops = []
+        relay.analysis.post_order_visit(
+            func.body, lambda e: num_ops.append(e) if isinstance(e, relay.Call) else None)
+        if compiler == "default":
+            return 1.0 * len(num_ops)
+        assert compiler == "test"
+        return 1.5 + 0.1 * len(num_ops)
+
+    def annotated(small_target):
+        data = relay.var('data', shape=(10, 10))
+        cb_1 = compiler_begin(data, small_target)
+        O_1 = relay.abs(cb_1)
+        ce_1 = compiler_end(O_1, small_target)
+        cb_2 = compiler_begin(ce_1, "default")
+        X = relay.tanh(cb_2)
+        ce_2 = compiler_end(X, "default")
+        cb_3 = compiler_begin(ce_2, "test")
+        O_2 = relay.nn.relu(relay.exp(cb_3))
+        ce_3 = compiler_end(O_2, "test")
+        return relay.Function([data], ce_3)
+
+    result = run_opt_pass(annotated("test"),
+                          relay.transform.PruneCompilerRegions(region_cost))
+    golden = run_opt_pass(annotated("default"), relay.transform.InferType())
+    assert tvm.ir.structural_equal(result, golden)
+
+
 if __name__ == "__main__":
     test_diamond_graph_fanouts()
     test_example_graph()
+    test_prune_compiler_regions()
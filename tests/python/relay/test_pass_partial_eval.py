@@ -339,5 +339,52 @@ def test_tuple_match():
     tvm.ir.assert_structural_equal(dcpe(x), const(2))
 
 
+def count_global_calls(expr, name):
+    calls = []
+    def _visit(node):
+        if isinstance(node, Call) and isinstance(node.op, GlobalVar) and node.op.name_hint == name:
+            calls.append(node)
+    relay.analysis.post_order_visit(expr, _visit)
+    return len(calls)
+
+
+def scale_module():
+    mod = tvm.IRModule()
+    t = TensorType([4], "float32")
+    x = Var("x", t)
+    w = Var("w", t)
+    scale = GlobalVar("scale")
+    mod[scale] = Function([x, w], x * w + w)
+    a = Var("a", t)
+    w_data = const(np.arange(4).astype("float32"))
+    y = scale(scale(scale(a, w_data), w_data), w_data)
+    mod["main"] = Function([a], y)
+    return mod
+
+
+def test_memoize_global_call():
+    mod = scale_module()
+    a_data = np.random.uniform(size=4).astype("float32")
+    ref = create_executor(mod=mod).evaluate(mod["main"])(a_data).asnumpy()
+    with tvm.transform.PassContext(opt_level=3):
+        mod = transform.PartialEvaluate()(mod)
+    # the first call is expanded, the other two share one specialization for w_data
+    assert "scale_specialized" in [gv.name_hint for gv in mod.get_global_vars()]
+    assert len(mod["scale_specialized"].params) == 1
+    assert count_global_calls(mod["main"], "scale_specialized") == 2
+    res = create_executor(mod=mod).evaluate(mod["main"])(a_data).asnumpy()
+    np.testing.assert_allclose(res, ref, rtol=1e-5)
+
+
+def test_specialization_budget():
+    mod = scale_module()
+    config = {"relay.PartialEval.memoize": False, "relay.PartialEval.max_specializations": 2}
+    with tvm.transform.PassContext(opt_level=3, config=config):
+        mod = transform.PartialEvaluate()(mod)
+    assert "scale_specialized" not in [gv.name_hint for gv in mod.get_global_vars()]
+    # the two inner calls spend the budget, the outer one is kept
+    assert count_global_calls(mod["main"], "scale") == 1
+
+
 if __name__ == '__main__':
     pytest.main([__file__])
@@ -0,0 +1,59 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay import create_executor, transform
+from tvm.relay.transform import gradient
+from tvm.relay.testing import run_infer_type, rand, count_ops
+from test_pass_reorder_for_memory import planned_bytes
+
+
+def training_func():
+    x = relay.var("x", shape=(64, 64))
+    out = relay.sum(relay.exp(relay.exp(relay.exp(x))))
+    func = run_infer_type(relay.Function([x], out))
+    return run_infer_type(gradient(func, mode="first_order"))
+
+
+def test_rematerialize_gradient():
+    back_func = training_func()
+    mod = transform.Rematerialize()(tvm.IRModule.from_expr(back_func))
+    remat_func = mod["main"]
+    assert remat_func.checked_type == back_func.checked_type
+    # the activations read by the backward part are recomputed
+    assert count_ops(remat_func)["exp"] > count_ops(back_func)["exp"]
+    assert planned_bytes(remat_func) < planned_bytes(back_func)
+
+    ex = create_executor()
+    x = rand("float32", 64, 64)
+    forward, (grad,) = ex.evaluate(back_func)(x)
+    remat_forward, (remat_grad,) = ex.evaluate(remat_func)(x)
+    tvm.testing.assert_allclose(remat_forward.asnumpy(), forward.asnumpy(), rtol=1e-5)
+    tvm.testing.assert_allclose(remat_grad.asnumpy(), grad.asnumpy(), rtol=1e-5)
+
+
+def test_rematerialize_within_budget():
+    back_func = training_func()
+    mod = transform.Rematerialize(1 << 30)(tvm.IRModule.from_expr(back_func))
+    tvm.ir.assert_structural_equal(mod["main"], back_func)
+
+
+if __name__ == "__main__":
+    test_rematerialize_gradient()
+    test_rematerialize_within_budget()
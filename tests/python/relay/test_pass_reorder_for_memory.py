@@ -0,0 +1,82 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay import transform
+from tvm.contrib import graph_runtime
+
+
+def branchy_func():
+    x = relay.var("x", shape=(128, 128))
+    y = relay.var("y", shape=(128, 128))
+    a = relay.exp(x)
+    c = relay.exp(relay.log(y))
+    m = relay.multiply(a, relay.sum(c))
+    out = relay.add(relay.sum(m), relay.sum(a))
+    return relay.Function([x, y], out)
+
+
+def planned_bytes(func):
+    mod = transform.InferType()(tvm.IRModule.from_expr(func))
+    f = tvm._ffi.get_global_func("relay.backend.GraphPlanMemoryBytes")
+    return f(mod["main"])[0].value
+
+
+def test_reorder_lowers_plan():
+    func = branchy_func()
+    mod = tvm.IRModule.from_expr(func)
+    mod = transform.ReorderForPeakMemory()(mod)
+    reordered = mod["main"]
+    assert isinstance(reordered.body, relay.Let)
+    # the y branch runs first, so exp(x) is not held while it runs
+    assert reordered.body.value.op.name == "log"
+    assert planned_bytes(reordered) < planned_bytes(func)
+
+
+def test_reorder_keeps_good_order():
+    x = relay.var("x", shape=(128, 128))
+    out = relay.sum(relay.exp(relay.exp(x)))
+    func = relay.Function([x], out)
+    mod = transform.ReorderForPeakMemory()(tvm.IRModule.from_expr(func))
+    tvm.ir.assert_structural_equal(mod["main"], transform.InferType()(
+        tvm.IRModule.from_expr(func))["main"])
+
+
+def test_reorder_build():
+    func = branchy_func()
+    x = np.random.uniform(size=(128, 128)).astype("float32")
+    y = np.random.uniform(1, 2, size=(128, 128)).astype("float32")
+    results = []
+    for reorder in [False, True]:
+        with tvm.transform.PassContext(
+                opt_level=3, config={"relay.backend.reorder_for_memory": reorder}):
+            graph, lib, params = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        m = graph_runtime.create(graph, lib, tvm.cpu())
+        m.set_input("x", x)
+        m.set_input("y", y)
+        m.set_input(**params)
+        m.run()
+        results.append(m.get_output(0).asnumpy())
+    np.testing.assert_allclose(results[0], results[1], rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_reorder_lowers_plan()
+    test_reorder_keeps_good_order()
+    test_reorder_build()
@@ -0,0 +1,132 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.relay import create_executor, transform
+from tvm.relay.testing import run_infer_type, count_ops
+
+
+def conv_softmax_func():
+    x = relay.var("x", shape=(1, 8, 16, 16))
+    w = relay.var("w", shape=(16, 8, 3, 3))
+    b = relay.var("b", shape=(16,))
+    y = relay.nn.conv2d(x, w, channels=16, kernel_size=(3, 3), padding=(1, 1))
+    y = relay.nn.relu(relay.nn.bias_add(y, b))
+    y = relay.nn.max_pool2d(y, pool_size=(2, 2), strides=(2, 2))
+    y = relay.nn.softmax(relay.nn.batch_flatten(y))
+    return run_infer_type(relay.Function([x, w, b], y))
+
+
+def find_calls(expr, op_name):
+    calls = []
+    def _visit(node):
+        if isinstance(node, relay.Call) and isinstance(node.op, tvm.ir.Op) and \
+                node.op.name == op_name:
+            calls.append(node)
+    relay.analysis.post_order_visit(expr, _visit)
+    return calls
+
+
+def test_mixed_precision_lists():
+    func = conv_softmax_func()
+    mod = transform.ToMixedPrecision()(tvm.IRModule.from_expr(func))
+    mixed_func = mod["main"]
+    # the signature is unchanged
+    assert mixed_func.checked_type == func.checked_type
+    conv, = find_calls(mixed_func, "nn.conv2d")
+    assert conv.args[0].checked_type.dtype == "float16"
+    # conv2d accumulates in float32 before its result is cast down
+    assert conv.checked_type.dtype == "float32"
+    # relu, bias_add and max_pool2d follow conv2d
+    pool, = find_calls(mixed_func, "nn.max_pool2d")
+    assert pool.checked_type.dtype == "float16"
+    softmax, = find_calls(mixed_func, "nn.softmax")
+    assert softmax.args[0].checked_type.dtype == "float32"
+    # x, w, b and the conv2d output are cast down and the batch_flatten output is cast up
+    assert count_ops(mixed_func)["cast"] == 5
+
+    x = np.random.uniform(-1, 1, size=(1, 8, 16, 16)).astype("float32")
+    w = np.random.uniform(-1, 1, size=(16, 8, 3, 3)).astype("float32")
+    b = np.random.uniform(-1, 1, size=(16,)).astype("float32")
+    ex = create_executor()
+    ref = ex.evaluate(func)(x, w, b).asnumpy()
+    res = ex.evaluate(mixed_func)(x, w, b).asnumpy()
+    tvm.testing.assert_allclose(res, ref, rtol=1e-2, atol=1e-3)
+
+
+def test_mixed_precision_deny_override():
+    func = conv_softmax_func()
+    mod = transform.ToMixedPrecision(deny_ops=["nn.conv2d"])(tvm.IRModule.from_expr(func))
+    tvm.ir.assert_structural_equal(mod["main"], func)
+
+
+def test_mixed_precision_bfloat16():
+    x = relay.var("x", shape=(4, 32))
+    w = relay.var("w", shape=(16, 32))
+    y = relay.sum(relay.nn.dense(x, w), axis=1)
+    func = run_infer_type(relay.Function([x, w], y))
+    mod = transform.ToMixedPrecision("bfloat16")(tvm.IRModule.from_expr(func))
+    dense, = find_calls(mod["main"], "nn.dense")
+    assert dense.args[0].checked_type.dtype == "bfloat16"
+    assert dense.checked_type.dtype == "float32"
+    total, = find_calls(mod["main"], "sum")
+    assert total.checked_type.dtype == "float32"
+
+
+def test_mixed_precision_fold_cast():
+    x = relay.var("x", shape=(8, 8), dtype="float16")
+    w = relay.var("w", shape=(8, 8))
+    y = relay.nn.dense(relay.cast(x, "float32"), w)
+    func = run_infer_type(relay.Function([x, w], y))
+    mod = transform.ToMixedPrecision()(tvm.IRModule.from_expr(func))
+    # cast(cast(x, float32), float16) is folded to x
+    dense, = find_calls(mod["main"], "nn.dense")
+    assert dense.args[0].same_as(mod["main"].params[0])
+
+
+def test_mixed_precision_accumulation_type():
+    x = relay.var("x", shape=(4, 32))
+    w = relay.var("w", shape=(16, 32))
+    y = relay.var("y", shape=(2, 4, 32))
+    z = relay.var("z", shape=(2, 16, 32))
+    out = relay.Tuple([relay.nn.dense(x, w), relay.nn.batch_matmul(y, z)])
+    func = run_infer_type(relay.Function([x, w, y, z], out))
+
+    mod = transform.ToMixedPrecision()(tvm.IRModule.from_expr(func))
+    dense, = find_calls(mod["main"], "nn.dense")
+    assert dense.args[0].checked_type.dtype == "float16"
+    assert dense.attrs.out_dtype == "float32"
+    assert dense.checked_type.dtype == "float32"
+    # batch_matmul cannot accumulate in float32 from float16 inputs
+    bmm, = find_calls(mod["main"], "nn.batch_matmul")
+    assert bmm.args[0].checked_type.dtype == "float32"
+
+    mod = transform.ToMixedPrecision(accumulation_type="float16")(tvm.IRModule.from_expr(func))
+    dense, = find_calls(mod["main"], "nn.dense")
+    assert dense.checked_type.dtype == "float16"
+    bmm, = find_calls(mod["main"], "nn.batch_matmul")
+    assert bmm.checked_type.dtype == "float16"
+
+
+if __name__ == "__main__":
+    test_mixed_precision_lists()
+    test_mixed_precision_deny_override()
+    test_mixed_precision_bfloat16()
+    test_mixed_precision_fold_cast()
+    test_mixed_precision_accumulation_type()
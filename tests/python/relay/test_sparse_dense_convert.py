@@ -82,5 +82,44 @@ def test_bsr_sparse_dense():
     sparse_output = run_func(sparse_func, params, x_np)
     np.testing.assert_allclose(sparse_output, dense_output, atol=1e-5, rtol=1e-5)
 
+def test_select_bsr_block_size():
+    w = random_bsr_matrix(64, 32, 4, 1, 0.1).todense()
+    block_size, cost = relay.analysis.sparse_dense.select_bsr_block_size(np.asarray(w))
+    assert block_size == (4, 1)
+    assert cost < w.size
+
+def test_bsr_sparse_conv2d():
+    def check(data_layout, kernel_layout, strides):
+        in_shape = (1, 16, 8, 8) if data_layout == "NCHW" else (1, 8, 8, 16)
+        data = relay.var("data", shape=in_shape, dtype="float32")
+        w_shape = tuple({"O": 32, "I": 16, "H": 3, "W": 3}[axis] for axis in kernel_layout)
+        w = relay.var("weight", shape=w_shape, dtype="float32")
+        y = relay.nn.conv2d(data, w, strides=strides, padding=(1, 1), channels=32,
+                            kernel_size=(3, 3), data_layout=data_layout,
+                            kernel_layout=kernel_layout)
+        z = relay.nn.relu(y)
+        func = relay.Function(relay.analysis.free_vars(z), z)
+
+        # only the diagonal taps of the pruned kernel have weights
+        w_oihw = np.zeros((32, 16, 3, 3), dtype="float32")
+        for k in range(3):
+            w_oihw[:, :, k, k] = random_bsr_matrix(32, 16, 8, 1, 0.1).todense()
+        w_np = w_oihw.transpose(["OIHW".index(axis) for axis in kernel_layout])
+        params = {"weight": tvm.nd.array(w_np)}
+
+        x_np = np.random.randn(*in_shape).astype("float32")
+        dense_output = run_func(func, params, x_np)
+        sparse_func, params = relay.data_dep_optimization.bsr_conv2d.convert(func, params)
+        assert "weight" not in params
+        assert "weight.0.1.data" not in params
+        assert "weight.1.1.data" in params
+        sparse_output = run_func(sparse_func, params, x_np)
+        np.testing.assert_allclose(sparse_output, dense_output, atol=1e-5, rtol=1e-5)
+
+    check("NCHW", "OIHW", (1, 1))
+    check("NHWC", "HWIO", (2, 2))
+
 if __name__ == "__main__":
     test_bsr_sparse_dense()
+    test_select_bsr_block_size()
+    test_bsr_sparse_conv2d()
@@ -372,5 +372,46 @@ def test_if():
     ft = run_infer_type(top)
     tvm.ir.assert_structural_equal(ft.ret_type, relay.TensorType([Any(), 1], dtype='float32'))
 
+
+def test_incremental_infer_type():
+    x = relay.var("x", shape=(2, 3))
+    y = relay.var("y", shape=(2, 3))
+    gv_f = relay.GlobalVar("f")
+    gv_g = relay.GlobalVar("g")
+    mod = tvm.IRModule({
+        gv_f: relay.Function([x], relay.add(x, x)),
+        gv_g: relay.Function([y], relay.multiply(y, y)),
+    })
+    z = relay.var("z", shape=(2, 3))
+    mod["main"] = relay.Function([z], gv_f(z))
+    mod = transform.InferType()(mod)
+
+    # unchanged functions are not checked again
+    mod2 = transform.InferType()(mod)
+    for gv in mod.get_global_vars():
+        assert mod2[gv].same_as(mod[gv])
+
+    # only the rewritten function is checked
+    funcs = {gv: mod[gv] for gv in mod.get_global_vars()}
+    funcs[gv_g] = relay.Function([y], relay.subtract(y, y))
+    mod3 = transform.InferType()(tvm.IRModule(funcs))
+    assert mod3["main"].same_as(mod["main"])
+    assert mod3[gv_f].same_as(mod[gv_f])
+    assert not mod3[gv_g].same_as(mod[gv_g])
+    assert mod3[gv_g].body.checked_type == relay.TensorType((2, 3), "float32")
+
+    # a new signature makes the callers to be checked again
+    funcs = {gv: mod[gv] for gv in mod.get_global_vars()}
+    funcs[gv_f] = relay.Function([x], relay.sum(x))
+    mod4 = transform.InferType()(tvm.IRModule(funcs))
+    assert mod4[gv_g].same_as(mod[gv_g])
+    assert mod4["main"].checked_type.ret_type == relay.TensorType((), "float32")
+
+    # the pass config turns the reuse off
+    with tvm.transform.PassContext(config={"relay.incremental_type_infer": False}):
+        mod5 = transform.InferType()(mod)
+    assert not mod5[gv_g].same_as(mod[gv_g])
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
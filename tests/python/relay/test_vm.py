@@ -217,6 +217,29 @@ def test_sum_loop():
     mod["main"] = relay.Function([iarg, aarg], sum_up(iarg, aarg))
     check_result([i_data, accum_data], sum(range(1, loop_bound + 1)), mod=mod)
 
+def test_recursion_reuses_frames():
+    mod = tvm.IRModule({})
+    sum_up = relay.GlobalVar('sum_up')
+    i = relay.var('i', shape=[], dtype='int32')
+    accum = relay.var('accum', shape=[], dtype='int32')
+    sb = ScopeBuilder()
+    with sb.if_scope(relay.equal(i, relay.const(0, 'int32'))):
+        sb.ret(accum)
+    with sb.else_scope():
+        one_less = relay.subtract(i, relay.const(1, 'int32'))
+        new_accum = relay.add(accum, i)
+        sb.ret(relay.Call(sum_up, [one_less, new_accum]))
+    mod[sum_up] = relay.Function([i, accum], sb.get())
+    iarg = relay.var('i', shape=[], dtype='int32')
+    aarg = relay.var('accum', shape=[], dtype='int32')
+    mod["main"] = relay.Function([iarg, aarg], sum_up(iarg, aarg))
+    exe = relay.vm.compile(mod, "llvm")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    # deeper, shallower and deeper again calls share the register stack.
+    for bound in [50, 3, 0, 80]:
+        res = vm.run(np.array(bound, dtype='int32'), np.array(0, dtype='int32'))
+        assert res.asnumpy() == sum(range(1, bound + 1))
+
 def test_tuple_fst():
     ttype = relay.TupleType([relay.TensorType((1,)), relay.TensorType((10,))])
     tup = relay.var('tup', type_annotation=ttype)
@@ -681,5 +704,242 @@ def test_vm_reshape_tensor():
     y_np = np.array([8, 2, 8]).astype("int32")
     check_result([x_np, y_np], x_np.reshape([8, 2, 8]), mod)
 
+def test_vm_size_class_allocator():
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.add(x, x))
+    exe = relay.vm.compile(mod, "llvm")
+    # use a dedicated context, the allocator type of a context is fixed on first use
+    ctx = tvm.cpu(5)
+    vm = runtime.vm.VirtualMachine(exe, ctx, memory_cfg="size_class")
+    used_memory = tvm.get_global_func("runtime.VMAllocatorUsedMemory")
+    used = []
+    # all the outputs, of at most 48 * 16 * 4 bytes, fall in the one page size class
+    for n in [31, 32, 33, 48, 31]:
+        x_np = np.random.rand(n, 16).astype("float32")
+        res = vm.run(x_np)
+        tvm.testing.assert_allclose(res.asnumpy(), x_np + x_np)
+        used.append(used_memory(ctx.device_type, ctx.device_id))
+        del res
+    # the VM holds the last output until the next run, from the second run on the
+    # buffers freed by the previous run are reused
+    assert used[0] > 0 and used[0] % 4096 == 0
+    assert used[1] <= 2 * used[0] and used[1] % 4096 == 0
+    assert all(u == used[1] for u in used[1:])
+    tvm.get_global_func("runtime.VMAllocatorTrim")(ctx.device_type, ctx.device_id)
+    assert used_memory(ctx.device_type, ctx.device_id) < used[1]
+    tvm.get_global_func("runtime.VMAllocatorSetMaxCachedBytes")(ctx.device_type, ctx.device_id, 0)
+    res = vm.run(np.ones((8, 16), "float32"))
+    tvm.testing.assert_allclose(res.asnumpy(), np.full((8, 16), 2, "float32"))
+
+def test_vm_stream_ordered_allocator():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("skip because cuda is not enabled..")
+        return
+    if tvm.gpu(0).api_version < 11020:
+        print("skip because stream-ordered allocation requires CUDA 11.2")
+        return
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.add(x, x))
+    exe = relay.vm.compile(mod, "cuda")
+    ctx = tvm.gpu(0)
+    vm = runtime.vm.VirtualMachine(exe, ctx, memory_cfg="stream_ordered")
+    for n in [31, 32, 48, 31]:
+        x_np = np.random.rand(n, 16).astype("float32")
+        res = vm.run(x_np)
+        tvm.testing.assert_allclose(res.asnumpy(), x_np + x_np)
+    del res
+    tvm.get_global_func("runtime.VMAllocatorTrim")(ctx.device_type, ctx.device_id)
+
+def test_vm_stream_ordered_allocator_fallback():
+    # the CPU has no stream-ordered pool, it takes the pooled allocator instead
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.add(x, x))
+    exe = relay.vm.compile(mod, "llvm")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu(), memory_cfg="stream_ordered")
+    x_np = np.random.rand(8, 16).astype("float32")
+    tvm.testing.assert_allclose(vm.run(x_np).asnumpy(), x_np + x_np)
+
+def test_vm_static_memory_plan():
+    x = relay.var("x", shape=(10, 10), dtype="float32")
+    y = relay.var("y", shape=(10, 10), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x, y], relay.multiply(relay.add(x, y), y))
+    exe = relay.vm.compile(mod, "llvm")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    vm.set_static_memory_plan()
+    x_np = np.random.rand(10, 10).astype("float32")
+    y_np = np.random.rand(10, 10).astype("float32")
+    first = vm.run(x_np, y_np)
+    # the output of the first run is still alive, its storage cannot be reused.
+    second = vm.run(y_np, x_np)
+    tvm.testing.assert_allclose(first.asnumpy(), (x_np + y_np) * y_np)
+    tvm.testing.assert_allclose(second.asnumpy(), (x_np + y_np) * x_np)
+    del first, second
+    for _ in range(3):
+        res = vm.run(x_np, y_np)
+        tvm.testing.assert_allclose(res.asnumpy(), (x_np + y_np) * y_np)
+
+def test_vm_fuse_bytecode():
+    x = relay.var("x", shape=(10, 10), dtype="float32")
+    y = relay.var("y", shape=(10, 10), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x, y], relay.multiply(relay.add(x, y), y))
+    x_np = np.random.rand(10, 10).astype("float32")
+    y_np = np.random.rand(10, 10).astype("float32")
+    with tvm.transform.PassContext(opt_level=3, config={"relay.vm.fuse_bytecode": False}):
+        plain = relay.vm.compile(mod, "llvm")
+    with tvm.transform.PassContext(opt_level=3):
+        fused = relay.vm.compile(mod, "llvm")
+    assert "alloc_storage_tensor" not in plain.bytecode
+    assert "alloc_storage_tensor" in fused.bytecode
+    assert fused.bytecode.count("\n") < plain.bytecode.count("\n")
+    for exe in [plain, fused]:
+        vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+        res = vm.run(x_np, y_np)
+        tvm.testing.assert_allclose(res.asnumpy(), (x_np + y_np) * y_np)
+
+def test_vm_async_execution():
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    w = np.random.rand(1, 16).astype("float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.nn.relu(relay.add(x, relay.const(w))))
+    for target, ctx in [("llvm", tvm.cpu()), ("cuda", tvm.gpu())]:
+        if not tvm.runtime.enabled(target) or not ctx.exist:
+            continue
+        exe = relay.vm.compile(mod, target)
+        vm = runtime.vm.VirtualMachine(exe, ctx)
+        vm.set_async_execution()
+        for n in [3, 17, 3]:
+            x_np = np.random.uniform(-1, 1, size=(n, 16)).astype("float32")
+            res = vm.run(x_np)
+            tvm.testing.assert_allclose(res.asnumpy(), np.maximum(x_np + w, 0))
+        vm.set_async_execution(False)
+        res = vm.run(x_np)
+        tvm.testing.assert_allclose(res.asnumpy(), np.maximum(x_np + w, 0))
+
+def test_vm_shared_executable_threads():
+    import threading
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    w = np.random.rand(1, 16).astype("float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.multiply(x, relay.const(w)))
+    exe = relay.vm.compile(mod, "llvm")
+    errors = []
+
+    def serve(seed):
+        # each thread only owns a light VM context over the shared executable.
+        try:
+            vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+            rng = np.random.RandomState(seed)
+            for _ in range(10):
+                x_np = rng.rand(rng.randint(1, 9), 16).astype("float32")
+                tvm.testing.assert_allclose(vm.run(x_np).asnumpy(), x_np * w, rtol=1e-5)
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    threads = [threading.Thread(target=serve, args=(i,)) for i in range(8)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not errors, errors
+
+def test_vm_shape_func_cache():
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    y = relay.var("y", shape=(relay.Any(), 1), dtype="float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x, y], relay.concatenate([relay.add(x, y), x], axis=1))
+    exe = relay.vm.compile(mod, "llvm")
+    assert any(name.startswith("shape_func") for name in exe.primitive_ops)
+    for max_entries in [64, 1]:
+        vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+        vm.set_shape_func_cache(max_entries)
+        for n in [4, 9, 4, 4, 9, 1]:
+            x_np = np.random.rand(n, 16).astype("float32")
+            y_np = np.random.rand(n, 1).astype("float32")
+            res = vm.run(x_np, y_np)
+            tvm.testing.assert_allclose(res.asnumpy(),
+                                        np.concatenate([x_np + y_np, x_np], axis=1))
+
+def test_vm_share_constants():
+    x = relay.var("x", shape=(10, 10), dtype="float32")
+    w = np.random.rand(10, 10).astype("float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.add(x, relay.const(w)))
+    ctxs = [tvm.cpu()]
+    if tvm.runtime.enabled("cuda") and tvm.gpu().exist:
+        ctxs.append(tvm.gpu())
+    sweep = tvm.get_global_func("runtime.WeightRegistrySweep")
+    for ctx in ctxs:
+        exe = relay.vm.compile(mod, "cuda" if ctx.device_type == tvm.gpu().device_type else "llvm")
+        vms = [runtime.vm.VirtualMachine(exe, ctx) for _ in range(3)]
+        x_np = np.random.rand(10, 10).astype("float32")
+        for vm in vms:
+            vm.set_share_constants()
+            tvm.testing.assert_allclose(vm.run(x_np).asnumpy(), x_np + w)
+        if ctx.device_type != tvm.cpu().device_type:
+            assert sweep() == 1
+        del vms, vm
+        assert sweep() == 0
+
+def test_vm_tuple_outlives_vm():
+    x = relay.var('x', shape=(4,))
+    inner = relay.Tuple([x, relay.add(x, x)])
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.Tuple([inner, relay.TupleGetItem(inner, 1), x]))
+    exe = relay.vm.compile(mod, "llvm")
+    x_np = np.random.rand(4).astype("float32")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    results = [vm.run(x_np) for _ in range(3)]
+    # the tuples are allocated from the pool of the VM, which they keep alive.
+    del vm
+    for res in results:
+        tvm.testing.assert_allclose(res[0][1].asnumpy(), x_np + x_np)
+        tvm.testing.assert_allclose(res[1].asnumpy(), x_np + x_np)
+        tvm.testing.assert_allclose(res[2].asnumpy(), x_np)
+
+def test_vm_shape_buckets():
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    w = np.random.rand(1, 16).astype("float32")
+    mod = tvm.IRModule()
+    mod["main"] = relay.Function([x], relay.nn.relu(relay.add(x, relay.const(w))))
+    generic = relay.vm.compile(mod, "llvm")
+    with tvm.transform.PassContext(config={"relay.vm.shape_buckets": [16, 4]}):
+        exe = relay.vm.compile(mod, "llvm")
+    # a static kernel for each bucket, next to the generic one.
+    assert len(exe.primitive_ops) > len(generic.primitive_ops) + 1
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    for n in [1, 4, 5, 16, 40, 3]:
+        x_np = np.random.uniform(-1, 1, size=(n, 16)).astype("float32")
+        res = vm.run(x_np)
+        assert res.shape == (n, 16)
+        tvm.testing.assert_allclose(res.asnumpy(), np.maximum(x_np + w, 0))
+
+def test_vm_shape_buckets_batch_axis():
+    def check(x, out, shape):
+        mod = tvm.IRModule()
+        mod["main"] = relay.Function([x], out)
+        generic = relay.vm.compile(mod, "llvm")
+        with tvm.transform.PassContext(config={"relay.vm.shape_buckets": [2, 8]}):
+            exe = relay.vm.compile(mod, "llvm")
+        # the batch axis is not reduced, so the kernels are specialized.
+        assert len(exe.primitive_ops) > len(generic.primitive_ops) + 1
+        ref = runtime.vm.VirtualMachine(generic, tvm.cpu())
+        vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+        for n in [1, 2, 5, 8, 11]:
+            x_np = np.random.uniform(-1, 1, size=(n,) + shape).astype("float32")
+            tvm.testing.assert_allclose(vm.run(x_np).asnumpy(), ref.run(x_np).asnumpy(),
+                                        rtol=1e-5)
+
+    x = relay.var("x", shape=(relay.Any(), 16), dtype="float32")
+    w = relay.const(np.random.rand(8, 16).astype("float32"))
+    check(x, relay.nn.relu(relay.nn.dense(x, w)), (16,))
+    x = relay.var("x", shape=(relay.Any(), 3, 8, 8), dtype="float32")
+    w = relay.const(np.random.rand(4, 3, 3, 3).astype("float32"))
+    check(x, relay.nn.relu(relay.nn.conv2d(x, w, padding=(1, 1))), (3, 8, 8))
+
 if __name__ == "__main__":
     pytest.main([__file__])
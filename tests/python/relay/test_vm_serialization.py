@@ -142,6 +142,32 @@ def test_save_load():
     tvm.testing.assert_allclose(res.asnumpy(), x_data + x_data)
 
 
+def test_load_exec_file():
+    x = relay.var('x', shape=(10, 10))
+    w = np.random.rand(10, 10).astype('float32')
+    b = np.random.rand(3).astype('float32')
+    f = relay.Function([x], relay.multiply(x + relay.const(w), relay.const(b[0])))
+    x_data = np.random.rand(10, 10).astype('float32')
+
+    code, lib = create_exec(f).save()
+    tmp = util.tempdir()
+    path_lib = tmp.relpath("lib.so")
+    lib.export_library(path_lib)
+    path_code = tmp.relpath("code.ro")
+    with open(path_code, "wb") as fo:
+        fo.write(code)
+
+    loaded_lib = tvm.runtime.load_module(path_lib)
+    for des_exec in [_vm.Executable.load_exec_file(path_code, loaded_lib),
+                     _vm.Executable.load_exec(bytearray(open(path_code, "rb").read()),
+                                              loaded_lib)]:
+        des_vm = _vm.VirtualMachine(des_exec, tvm.cpu())
+        res = des_vm.run(x_data)
+        tvm.testing.assert_allclose(res.asnumpy(), (x_data + w) * b[0], rtol=1e-5)
+        # the executable saved again matches the original one.
+        assert des_exec.save()[0] == code
+
+
 def test_const():
     c = relay.const(1.0, "float32")
     x = relay.var('x', shape=(10, 10), dtype='float32')
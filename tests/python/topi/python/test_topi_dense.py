@@ -128,6 +128,73 @@ def verify_dense_int8(batch, in_dim, out_dim, use_bias=True):
         check_device(device)
 
 
+def verify_dense_vnni(batch, in_dim, out_dim, use_bias=True):
+    target = "llvm -mcpu=cascadelake"
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    A = te.placeholder((batch, in_dim), name='A', dtype="uint8")
+    B = te.placeholder((out_dim, in_dim), name='B', dtype="int8")
+    C = te.placeholder((out_dim,), name='C', dtype="int32")
+
+    a_np = np.random.randint(low=0, high=255, size=(batch, in_dim)).astype("uint8")
+    b_np = np.random.randint(low=-128, high=127, size=(out_dim, in_dim)).astype("int8")
+    c_np = np.random.randint(low=-128, high=127, size=(out_dim,)).astype("int32")
+    d_np = np.dot(a_np.astype("int32"), b_np.T.astype("int32"))
+    if use_bias:
+        d_np += c_np
+
+    ctx = tvm.cpu(0)
+    with tvm.target.create(target):
+        D = topi.x86.dense_vnni(A, B, C if use_bias else None, "int32")
+        s = topi.x86.schedule_dense_vnni([D])
+    f = tvm.build(s, [A, B, C, D], target, name="dense")
+    # only compare the result when the host is able to run AVX512 VNNI code
+    if "avx512vnni" not in open("/proc/cpuinfo").read():
+        print("Skip running because the host does not support avx512vnni")
+        return
+    a = tvm.nd.array(a_np, ctx)
+    b = tvm.nd.array(b_np, ctx)
+    c = tvm.nd.array(c_np, ctx)
+    d = tvm.nd.array(np.zeros(get_const_tuple(D.shape), dtype="int32"), ctx)
+    f(a, b, c, d)
+    tvm.testing.assert_allclose(d.asnumpy(), d_np, rtol=1e-5)
+
+
+def verify_dense_bf16(batch, in_dim, out_dim):
+    target = "llvm -mcpu=cooperlake"
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    A = te.placeholder((batch, in_dim), name='A', dtype="bfloat16")
+    B = te.placeholder((out_dim, in_dim), name='B', dtype="bfloat16")
+    with tvm.target.create(target):
+        if not topi.x86.is_bf16_hw_support(A.dtype, B.dtype):
+            print("Skip because LLVM does not take the AVX512 BF16 dot product as int32 lanes")
+            return
+        D = topi.x86.dense_bf16(A, B, None, "float32")
+        s = topi.x86.schedule_dense_bf16([D])
+    f = tvm.build(s, [A, B, D], target, name="dense")
+    assert "vdpbf16ps" in f.get_source("asm")
+    # only compare the result when the host is able to run AVX512 BF16 code
+    if "avx512_bf16" not in open("/proc/cpuinfo").read():
+        print("Skip running because the host does not support avx512_bf16")
+        return
+    # bfloat16 is passed as the upper half of float32 in uint16
+    a_np = np.random.uniform(size=(batch, in_dim)).astype("float32")
+    b_np = np.random.uniform(size=(out_dim, in_dim)).astype("float32")
+    a_bf16 = np.right_shift(a_np.view("<u4"), 16).astype("uint16")
+    b_bf16 = np.right_shift(b_np.view("<u4"), 16).astype("uint16")
+    a_trunc = np.left_shift(a_bf16.astype("uint32"), 16).view("<f4")
+    b_trunc = np.left_shift(b_bf16.astype("uint32"), 16).view("<f4")
+    ctx = tvm.cpu(0)
+    a = tvm.nd.empty(a_bf16.shape, "uint16").copyfrom(a_bf16)
+    b = tvm.nd.empty(b_bf16.shape, "uint16").copyfrom(b_bf16)
+    d = tvm.nd.array(np.zeros((batch, out_dim), dtype="float32"), ctx)
+    f(a, b, d)
+    tvm.testing.assert_allclose(d.asnumpy(), np.dot(a_trunc, b_trunc.T), rtol=1e-3)
+
+
 def test_dense():
     verify_dense(1, 1024, 1000, use_bias=True)
     verify_dense(1, 1024, 1000, use_bias=False)
@@ -142,6 +209,18 @@ def test_dense_int8():
         verify_dense_int8(2, 1024, 1000, use_bias=False)
 
 
+def test_dense_vnni():
+    verify_dense_vnni(2, 1024, 1008, use_bias=True)
+    verify_dense_vnni(16, 512, 256, use_bias=False)
+
+
+def test_dense_bf16():
+    verify_dense_bf16(2, 1024, 1008)
+    verify_dense_bf16(16, 512, 256)
+
+
 if __name__ == "__main__":
     test_dense()
     test_dense_int8()
+    test_dense_vnni()
+    test_dense_bf16()
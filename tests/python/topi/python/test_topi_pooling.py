@@ -276,7 +276,7 @@ def verify_adaptive_pool(dshape, out_size, pool_type, layout="NCHW", dtype="floa
         print("Running on target: %s" % device)
         with tvm.target.create(device):
             s_func = tvm.topi.testing.dispatch(device, _adaptive_pool_schedule)
-            if device == "cuda":
+            if device in ["cuda", "llvm"]:
                 s = s_func(out, layout)
             else:
                 s = s_func(out)
@@ -306,6 +306,8 @@ def test_adaptive_pool():
     verify_adaptive_pool((1, 16, 32, 32, 32), (1, 1, 1), "avg", layout="NDHWC")
     verify_adaptive_pool((1, 16, 32, 32, 32), (2, 2, 2), "max", layout="NDHWC")
     verify_adaptive_pool((1, 16, 32, 32, 32), (2, 4, 4), "max", layout="NDHWC")
+    verify_adaptive_pool((1, 16, 16, 64), (4, 3), "avg", layout="NHWC")
+    verify_adaptive_pool((1, 13, 16, 100), (7, 5), "max", layout="NHWC")
 
 
 def verify_pool3d(n, ic, ih, kh, sh, padding, pool_type,
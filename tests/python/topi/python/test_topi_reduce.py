@@ -174,6 +174,14 @@ def test_reduce_map():
                           axis=None,
                           keepdims=False,
                           type="sum")
+    verify_reduce_map_ele(in_shape=(4, 33, 1023),
+                          axis=(1, 2),
+                          keepdims=False,
+                          type="sum")
+    verify_reduce_map_ele(in_shape=(64, 1000),
+                          axis=None,
+                          keepdims=False,
+                          type="max")
     verify_reduce_map_ele(in_shape=(128, 24, 128, 24),
                           axis=(1, 2, 3),
                           keepdims=True,
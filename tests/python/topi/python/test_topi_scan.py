@@ -0,0 +1,67 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test code for scan operators"""
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import te
+from tvm import topi
+
+
+def verify_cumsum(shape, num_blocks):
+    data = te.placeholder(shape, name="data", dtype="float32")
+    np_data = np.random.uniform(size=shape).astype("float32")
+
+    ctx = tvm.cpu(0)
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    out = topi.cumsum(data, num_blocks)
+    s = topi.x86.schedule_blocked_scan(out)
+    f = tvm.build(s, [data, out], "llvm")
+    tvm_data = tvm.nd.array(np_data, ctx)
+    tvm_out = tvm.nd.array(np.zeros(shape, dtype="float32"), ctx)
+    f(tvm_data, tvm_out)
+    tvm.testing.assert_allclose(tvm_out.asnumpy(), np.cumsum(np_data, axis=0), rtol=1e-5)
+
+
+def test_cumsum():
+    verify_cumsum((100,), 1)
+    verify_cumsum((100,), 4)
+    verify_cumsum((101,), 8)
+    verify_cumsum((37, 3), 5)
+    verify_cumsum((5, 2), 3)
+
+
+def test_blocked_scan_max():
+    shape = (50, 4)
+    data = te.placeholder(shape, name="data", dtype="float32")
+    np_data = np.random.uniform(size=shape).astype("float32")
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    out = topi.blocked_scan(data, te.max, num_blocks=6)
+    s = topi.x86.schedule_blocked_scan(out)
+    f = tvm.build(s, [data, out], "llvm")
+    tvm_out = tvm.nd.array(np.zeros(shape, dtype="float32"))
+    f(tvm.nd.array(np_data), tvm_out)
+    tvm.testing.assert_allclose(tvm_out.asnumpy(), np.maximum.accumulate(np_data, axis=0))
+
+
+if __name__ == "__main__":
+    test_cumsum()
+    test_blocked_scan_max()
@@ -80,6 +80,23 @@ def test_softmax():
     verify_softmax(32, 10, "float64")
     verify_softmax_4d((1, 16, 256, 256))
 
+def verify_online_softmax(shape, axis, dtype="float32"):
+    A = te.placeholder(shape, dtype=dtype, name='A')
+    B = topi.nn.online_softmax(A, axis=axis)
+
+    a_np = np.random.uniform(-10, 10, size=get_const_tuple(A.shape)).astype(A.dtype)
+    b_np = np.exp(a_np - np.max(a_np, axis=axis, keepdims=True))
+    b_np = b_np / np.sum(b_np, axis=axis, keepdims=True)
+
+    for device in ["llvm", "cuda"]:
+        check_device(A, B, a_np, b_np, device, "online_softmax")
+
+def test_online_softmax():
+    verify_online_softmax((32, 10), 1)
+    verify_online_softmax((3, 4), 1)
+    verify_online_softmax((32, 1000), 1, "float64")
+    verify_online_softmax((1, 16, 32, 32), 1)
+
 def verify_log_softmax(m, n, dtype="float32"):
     A = te.placeholder((m, n), dtype=dtype, name='A')
     B = topi.nn.log_softmax(A)
@@ -101,4 +118,5 @@ def test_log_softmax():
 if __name__ == "__main__":
     logging.basicConfig(level=logging.DEBUG)
     test_softmax()
+    test_online_softmax()
     test_log_softmax()
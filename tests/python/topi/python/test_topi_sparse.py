@@ -372,10 +372,51 @@ def test_sparse_dense_bsr_randomized():
             check_device(device)
 
 
+def verify_sparse_dense_binned(W_sp_np, M):
+    ctx = tvm.gpu(0)
+    if not ctx.exist:
+        print("Skip because cuda is not enabled")
+        return
+    K = W_sp_np.shape[1]
+    X_np = np.random.randn(M, K).astype("float32")
+    Y_np = np.array(X_np.dot(W_sp_np.todense().T))
+
+    W_data = te.placeholder(shape=W_sp_np.data.shape, dtype=str(W_sp_np.data.dtype))
+    W_indices = te.placeholder(shape=W_sp_np.indices.shape, dtype=str(W_sp_np.indices.dtype))
+    W_indptr = te.placeholder(shape=W_sp_np.indptr.shape, dtype=str(W_sp_np.indptr.dtype))
+    X = te.placeholder(shape=X_np.shape, dtype=str(X_np.dtype))
+    with tvm.target.create("cuda"):
+        Y = topi.cuda.sparse_dense_binned(X, W_data, W_indices, W_indptr)
+        s = topi.cuda.schedule_sparse_dense_binned([Y])
+        func = tvm.build(s, [X, W_data, W_indices, W_indptr, Y])
+    Y_tvm = tvm.nd.array(np.zeros(Y_np.shape, dtype=Y_np.dtype), ctx=ctx)
+    func(tvm.nd.array(X_np, ctx=ctx),
+         tvm.nd.array(W_sp_np.data, ctx=ctx),
+         tvm.nd.array(W_sp_np.indices, ctx=ctx),
+         tvm.nd.array(W_sp_np.indptr, ctx=ctx),
+         Y_tvm)
+    tvm.testing.assert_allclose(Y_tvm.asnumpy(), Y_np, atol=1e-4, rtol=1e-4)
+
+def test_sparse_dense_binned():
+    # rows of very different nnz, with empty rows in the middle and at the end
+    N, K = 64, 256
+    W_np = np.zeros((N, K), dtype="float32")
+    for row in range(N):
+        if row % 7 == 3 or row >= N - 5:
+            continue
+        nnz = K if row % 13 == 0 else 1 + row % 5
+        cols = np.random.choice(K, size=nnz, replace=False)
+        W_np[row, cols] = np.random.randn(nnz)
+    for M in [1, 7, 33]:
+        verify_sparse_dense_binned(sp.csr_matrix(W_np), M)
+        verify_sparse_dense_binned(sp.bsr_matrix(W_np, blocksize=(4, 8)), M)
+    verify_sparse_dense_binned(random_bsr_matrix(128, 4096, 16, 1, 0.1, "float32"), 3)
+
 def test_sparse_dense():
     test_sparse_dense_csr()
     test_sparse_dense_bsr()
     test_sparse_dense_bsr_randomized()
+    test_sparse_dense_binned()
 
 if __name__ == "__main__":
     test_csrmv()
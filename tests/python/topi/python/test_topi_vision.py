@@ -209,6 +209,94 @@ def test_non_max_suppression():
                                max_output_size, 0.7, False, 2, 1, 0, -1)
 
 
+def _non_max_suppression_bitmask_python(np_data, np_valid_count, max_output_size,
+                                         iou_threshold, force_suppress):
+    """Sequential reference of the GPU nms output layout, with top_k disabled."""
+    def iou(a, b):
+        w = max(0.0, min(a[2], b[2]) - max(a[0], b[0]))
+        h = max(0.0, min(a[3], b[3]) - max(a[1], b[1]))
+        i = w * h
+        u = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - i
+        return 0.0 if u <= 0 else i / u
+
+    batch, num_anchors, _ = np_data.shape
+    out = np.full(np_data.shape, -1, dtype=np_data.dtype)
+    indices = np.full((batch, num_anchors), -1, dtype="int32")
+    for b in range(batch):
+        nkeep = np_valid_count[b]
+        order = np.argsort(-np_data[b, :, 1], kind="stable")[:nkeep]
+        out[b, :nkeep] = np_data[b, order]
+        indices[b, :nkeep] = order
+        suppressed = np.zeros(nkeep, dtype=bool)
+        num_kept = 0
+        for j in range(nkeep):
+            if out[b, j, 1] <= 0 or out[b, j, 0] < 0:
+                continue
+            if suppressed[j]:
+                out[b, j, :2] = -1
+                indices[b, j] = -1
+                continue
+            if 0 < max_output_size <= num_kept:
+                out[b, j] = -1
+                indices[b, j] = -1
+                continue
+            num_kept += 1
+            for k in range(j + 1, nkeep):
+                if (force_suppress or out[b, k, 0] == out[b, j, 0]) and \
+                        iou(out[b, j, 2:], out[b, k, 2:]) >= iou_threshold:
+                    suppressed[k] = True
+    return out, indices
+
+
+def test_non_max_suppression_bitmask():
+    # More boxes than one bitmask word, in two batches, with two classes.
+    batch, num_anchors = 2, 70
+    np.random.seed(0)
+    np_data = np.zeros((batch, num_anchors, 6), dtype="float32")
+    np_data[:, :, 0] = np.random.randint(0, 2, size=(batch, num_anchors))
+    np_data[:, :, 1] = np.random.permutation(batch * num_anchors).reshape(batch, num_anchors) \
+        / (batch * num_anchors) + 0.01
+    corner = np.random.uniform(0, 40, size=(batch, num_anchors, 2))
+    np_data[:, :, 2:4] = corner
+    np_data[:, :, 4:6] = corner + np.random.uniform(5, 20, size=(batch, num_anchors, 2))
+    np_valid_count = np.array([num_anchors, num_anchors - 5]).astype("int32")
+    np_indices = np.tile(np.arange(num_anchors, dtype="int32"), (batch, 1))
+
+    for force_suppress, max_output_size in [(False, -1), (True, -1), (False, 10)]:
+        np_result, np_indices_result = _non_max_suppression_bitmask_python(
+            np_data, np_valid_count, max_output_size, 0.5, force_suppress)
+        for device in ['cuda', 'opencl']:
+            ctx = tvm.context(device, 0)
+            if not ctx.exist:
+                print("Skip because %s is not enabled" % device)
+                continue
+            data = te.placeholder(np_data.shape, name="data")
+            valid_count = te.placeholder((batch,), dtype="int32", name="valid_count")
+            indices = te.placeholder((batch, num_anchors), dtype="int32", name="indices")
+            with tvm.target.create(device):
+                out = topi.cuda.non_max_suppression_bitmask(
+                    data, valid_count, indices, max_output_size, 0.5, force_suppress, -1,
+                    coord_start=2, score_index=1, id_index=0, return_indices=False)
+                indices_out = topi.cuda.non_max_suppression_bitmask(
+                    data, valid_count, indices, max_output_size, 0.5, force_suppress, -1,
+                    coord_start=2, score_index=1, id_index=0, return_indices=True)
+                s = topi.cuda.schedule_nms(out)
+                indices_s = topi.cuda.schedule_nms(indices_out)
+
+            tvm_data = tvm.nd.array(np_data, ctx)
+            tvm_valid_count = tvm.nd.array(np_valid_count, ctx)
+            tvm_indices = tvm.nd.array(np_indices, ctx)
+            tvm_out = tvm.nd.array(np.zeros(np_data.shape, dtype="float32"), ctx)
+            f = tvm.build(s, [data, valid_count, indices, out], device)
+            f(tvm_data, tvm_valid_count, tvm_indices, tvm_out)
+            tvm.testing.assert_allclose(tvm_out.asnumpy(), np_result, rtol=1e-4)
+
+            tvm_indices_out = tvm.nd.array(np.zeros((batch, num_anchors), dtype="int32"), ctx)
+            f = tvm.build(indices_s, [data, valid_count, indices, indices_out], device)
+            f(tvm_data, tvm_valid_count, tvm_indices, tvm_indices_out)
+            tvm.testing.assert_allclose(tvm_indices_out.asnumpy(), np_indices_result)
+
+
 def verify_multibox_prior(dshape, sizes=(1,), ratios=(1,), steps=(-1, -1), offsets=(0.5, 0.5), clip=False):
     data = te.placeholder(dshape, name="data")
 
@@ -489,3 +577,4 @@ if __name__ == "__main__":
     test_roi_pool()
     test_proposal()
     test_non_max_suppression()
+    test_non_max_suppression_bitmask()
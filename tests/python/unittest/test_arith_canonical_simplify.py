@@ -281,6 +281,32 @@ def test_complex_cases():
     ck.verify(res3, tdiv((x*1024) + y, 256) - tdiv(y,256) - (x*4))
 
 
+def test_deep_split_fuse():
+    ck = CanonicalChecker()
+    x = te.var("x")
+    fld = tvm.te.floordiv
+    flm = tvm.te.floormod
+
+    def balanced_sum(terms):
+        if len(terms) == 1:
+            return terms[0]
+        mid = len(terms) // 2
+        return balanced_sum(terms[:mid]) + balanced_sum(terms[mid:])
+
+    # fuse back all the binary digits of x, the sums of the halves
+    # are merged with each other segment by segment.
+    digits = [flm(fld(x, 2 ** k), 2) * (2 ** k) for k in range(16)]
+    digits.append(fld(x, 2 ** 16) * (2 ** 16))
+    ck.verify(balanced_sum(digits), x)
+    ck.verify(balanced_sum(digits[::-1]), x)
+    ck.verify(balanced_sum(digits[1::2] + digits[0::2]), x)
+    # the same index split at every level of a nested expression.
+    y = x
+    for _ in range(8):
+        y = fld(y, 4) * 4 + flm(y, 4)
+    ck.verify(y, x)
+
+
 if __name__ == "__main__":
     test_floormod_simplify()
     test_mul_sum_simplify()
@@ -292,3 +318,4 @@ if __name__ == "__main__":
     test_split_index_simplify()
     test_canonical_mixed()
     test_complex_cases()
+    test_deep_split_fuse()
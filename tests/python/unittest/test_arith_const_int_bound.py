@@ -304,6 +304,29 @@ def test_let_bound():
     assert bd.max_value == 2
 
 
+def test_memo():
+    analyzer = tvm.arith.Analyzer()
+    analyzer.enable_memo()
+    x, y = te.var("x", "int64"), te.var("y", "int64")
+    bd = analyzer.const_int_bound(x + y)
+    assert bd.min_value == bd.NEG_INF
+    assert bd.max_value == bd.POS_INF
+
+    # updates invalidate the memoized bounds
+    analyzer.update(x, tvm.arith.ConstIntBound(0, 4))
+    analyzer.update(y, tvm.arith.ConstIntBound(1, 3))
+    bd = analyzer.const_int_bound(x + y)
+    assert bd.min_value == 1
+    assert bd.max_value == 7
+
+    # constraints are memoized in their own scope
+    with analyzer.constraint_scope(x < 2):
+        bd = analyzer.const_int_bound(x + y)
+        assert bd.max_value == 4
+    bd = analyzer.const_int_bound(x + y)
+    assert bd.max_value == 7
+
+
 if __name__ == "__main__":
     test_let_bound()
     test_dtype_bound()
@@ -319,3 +342,4 @@ if __name__ == "__main__":
     test_shift_and_bound()
     test_mix_index_bound()
     test_size_var_bound()
+    test_memo()
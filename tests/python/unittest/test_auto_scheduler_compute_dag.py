@@ -36,6 +36,26 @@ def test_infer_bound():
     s = dag.infer_bound_from_state(s)
 
 
+def test_infer_bound_reuse():
+    def make_dag():
+        A, B, C = matmul_auto_scheduler_test(64, 64, 64)
+        D = topi.nn.relu(C)
+        return auto_scheduler.ComputeDAG([A, B, D]), C, D
+
+    dag, C, D = make_dag()
+    # The states only differ in the producer stage, the bounds of the consumer are reused
+    for factor in [2, 4, 8, 4]:
+        s = dag.get_init_state()
+        its = s.split(D, s[D].iters[0], [8])
+        s.compute_at(C, D, its[0])
+        s.split(C, s[C].iters[2], [factor])
+        cached = dag.infer_bound_from_state(s)
+
+        fresh_dag, _, _ = make_dag()
+        fresh = fresh_dag.infer_bound_from_state(s.state_object)
+        assert str(cached) == str(fresh)
+
+
 def test_estimate_flop():
     N = 512
     A, B, C = matmul_auto_scheduler_test(N, N, N)
@@ -59,4 +79,5 @@ def test_estimate_flop():
 if __name__ == "__main__":
     test_apply_steps()
     test_infer_bound()
+    test_infer_bound_reuse()
     test_estimate_flop()
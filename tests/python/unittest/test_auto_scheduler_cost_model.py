@@ -27,9 +27,8 @@ from tvm import auto_scheduler
 from test_auto_scheduler_common import matmul_auto_scheduler_test
 
 
-def get_sample_records(number):
+def get_sample_records(number, N=128):
     """Generate random a list of random MeasureInput and MeasureResult pairs"""
-    N = 128
     workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (N, N, N))
     dag = auto_scheduler.ComputeDAG(workload_key)
     target = tvm.target.create('llvm')
@@ -76,6 +75,58 @@ def test_xgb_model():
         model.load(fp.name)
 
 
+def test_gbdt_model():
+    task, dag, inputs, results = get_sample_records(50)
+
+    model = auto_scheduler.GBDTModel(num_warmup_sample=-1)
+    model.update(inputs, results)
+    preds = model.predict(task, [x.state for x in inputs])
+    assert len(preds) == len(inputs)
+
+    costs = [np.mean([x.value for x in res.costs]) for res in results]
+    throughputs = np.min(costs) / costs
+
+    rmse = np.sqrt(np.mean([np.square(pred - label) for pred, label in zip(preds, throughputs)]))
+    assert rmse <= 0.3
+
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, inputs, results)
+        model.update_from_file(fp.name)
+
+    with tempfile.NamedTemporaryFile() as fp:
+        model.save(fp.name)
+        loaded = auto_scheduler.GBDTModel()
+        loaded.load(fp.name)
+        assert np.allclose(loaded.predict(task, [x.state for x in inputs]),
+                           model.predict(task, [x.state for x in inputs]))
+
+
+def test_update_from_history():
+    _, _, inputs, results = get_sample_records(20, N=128)
+    _, _, other_inputs, other_results = get_sample_records(20, N=32)
+
+    workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (112, 112, 112))
+    new_task = auto_scheduler.SearchTask(auto_scheduler.ComputeDAG(workload_key), workload_key,
+                                         tvm.target.create('llvm'))
+
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, inputs + other_inputs, results + other_results)
+
+        # Only the records of the most similar workload are selected
+        sel_inputs, _ = auto_scheduler.cost_model.cost_model.select_similar_records(
+            fp.name, [new_task], num_similar_workloads=1, max_records_per_workload=10)
+        assert len(sel_inputs) == 10
+        assert len(set(inp.task.workload_key for inp in sel_inputs)) == 1
+
+        # The bootstrapped model predicts without the random warmup
+        model = auto_scheduler.GBDTModel(num_warmup_sample=30)
+        model.update_from_history(fp.name, [new_task], num_similar_workloads=2)
+        states = [inp.state for inp in inputs[:5]]
+        assert np.allclose(model.predict(new_task, states), model.predict(new_task, states))
+
+
 if __name__ == "__main__":
     test_random_model()
     test_xgb_model()
+    test_gbdt_model()
+    test_update_from_history()
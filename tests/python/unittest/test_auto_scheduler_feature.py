@@ -130,6 +130,31 @@ def test_cpu_fusion():
     assert found
 
 
+def test_cpu_feature_cache():
+    dag = auto_scheduler.ComputeDAG(matmul_auto_scheduler_test(128, 128, 128))
+    states = []
+    for factor in [2, 4, 8, 16]:
+        s = dag.get_init_state()
+        C = s.stage_ops[2]
+        i, j, k = s[C].iters
+        s.split(C, i, [factor])
+        states.append(s)
+
+    target = tvm.target.create('llvm')
+    task = auto_scheduler.SearchTask(dag, "test", target)
+
+    auto_scheduler.feature.clear_per_store_feature_cache()
+    # The batch is extracted in parallel, the second time from the cache
+    fea_0 = auto_scheduler.feature.get_per_store_features_from_states(states, task)
+    fea_1 = auto_scheduler.feature.get_per_store_features_from_states(states[::-1], task)[::-1]
+    auto_scheduler.feature.clear_per_store_feature_cache()
+    fea_2 = auto_scheduler.feature.get_per_store_features_from_states(states, task)
+
+    for a, b, c in zip(fea_0, fea_1, fea_2):
+        assert a.shape == b.shape == c.shape
+        assert (a == b).all() and (a == c).all()
+
+
 def test_gpu_feature():
     # Use records to build a complicated GPU program
     json_records = "\n".join((
@@ -194,4 +219,5 @@ def test_gpu_feature():
 if __name__ == "__main__":
     test_cpu_matmul()
     test_cpu_fusion()
+    test_cpu_feature_cache()
     test_gpu_feature()
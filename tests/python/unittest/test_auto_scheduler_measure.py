@@ -164,6 +164,44 @@ def test_record_pragma_storage_align_rfactor():
     record_common(dag, s)
 
 
+def test_record_indexed_log():
+    if not tvm.runtime.enabled("llvm"):
+        return
+
+    target = tvm.target.create("llvm")
+    dags = [auto_scheduler.ComputeDAG(matmul_auto_scheduler_test(n, n, n)) for n in [64, 128]]
+    tasks = [auto_scheduler.SearchTask(dag, "matmul_%d" % i, target) for i, dag in enumerate(dags)]
+
+    inputs, results = [], []
+    for task, dag in zip(tasks, dags):
+        for cost in [0.3, 0.1, 0.2]:
+            inputs.append(auto_scheduler.MeasureInput(task, dag.get_init_state()))
+            results.append(auto_scheduler.MeasureResult([cost], 0, "", 0.2, 1))
+        # A failed measurement is never returned
+        inputs.append(auto_scheduler.MeasureInput(task, dag.get_init_state()))
+        results.append(auto_scheduler.MeasureResult([0.01], 1, "", 0.2, 1))
+
+    with tempfile.NamedTemporaryFile() as json_fp, tempfile.NamedTemporaryFile() as indexed_fp:
+        auto_scheduler.save_records(json_fp.name, inputs, results)
+        auto_scheduler.convert_records_to_indexed(json_fp.name, indexed_fp.name)
+        assert not auto_scheduler.measure_record.is_indexed_record_file(json_fp.name)
+        assert auto_scheduler.measure_record.is_indexed_record_file(indexed_fp.name)
+
+        reader = auto_scheduler.IndexedRecordReader(indexed_fp.name)
+        assert sorted(reader.workload_keys()) == ["matmul_0", "matmul_1"]
+
+        inps, ress = reader.top_k("matmul_1", 2)
+        assert [r.costs[0].value for r in ress] == [0.1, 0.2]
+        assert all(inp.task.workload_key == "matmul_1" for inp in inps)
+        assert len(reader.top_k("matmul_1", None)[0]) == 3
+        assert len(reader.top_k("matmul_1", None, tvm.target.create("cuda"))[0]) == 0
+        assert len(reader.top_k("unknown", 1)[0]) == 0
+
+        inp, res = auto_scheduler.load_best(indexed_fp.name, "matmul_0", target)
+        assert inp.task.workload_key == "matmul_0"
+        assert res.costs[0].value == 0.1
+
+
 def test_measure_local_builder_runner():
     if not tvm.runtime.enabled("llvm"):
         return
@@ -182,6 +220,55 @@ def test_measure_local_builder_runner():
     assert mress[0].error_no == 0
 
 
+def test_measure_local_runner_adaptive_repeat():
+    if not tvm.runtime.enabled("llvm"):
+        return
+
+    dag, s0 = get_tiled_matmul()
+    tgt = tvm.target.create("llvm")
+    task = auto_scheduler.SearchTask(dag, "test_adaptive", tgt)
+
+    minp = auto_scheduler.MeasureInput(task, s0)
+    local_builder = auto_scheduler.LocalBuilder()
+    local_runner = auto_scheduler.LocalRunner(timeout=60, repeat=2, max_repeat=10,
+                                              confidence_tolerance=0.05, slow_abort_ratio=2.0)
+
+    for _ in range(2):
+        bress = local_builder.build([minp])
+        assert bress[0].error_no == 0
+        mress = local_runner.run([minp], bress)
+        assert mress[0].error_no == 0
+        assert 2 <= len(mress[0].costs) <= 10
+
+
+def test_measure_adaptive_repeat_statistics():
+    class FakeTimeResult:
+        def __init__(self, results):
+            self.results = results
+
+    calls = []
+    def fake_time_f(noise):
+        def time_f():
+            calls.append(None)
+            costs = [1.0 + noise * (len(calls) % 3 - 1), 1.0 - noise * (len(calls) % 3 - 1)]
+            if len(calls) == 1:
+                costs[0] = 10.0  # A cold warmup run
+            return FakeTimeResult(costs)
+        return time_f
+
+    # Stable costs stop early, without the warmup outlier
+    costs = auto_scheduler.measure.adaptive_time_costs(fake_time_f(0.001), [], 2, 20, 0.02, 0, None)
+    assert len(calls) < 10 and 10.0 not in costs
+
+    # Noisy costs repeat up to the limit, unless they are surely slower than the best
+    del calls[:]
+    costs = auto_scheduler.measure.adaptive_time_costs(fake_time_f(0.5), [], 2, 20, 0.001, 0, None)
+    assert len(calls) == 10
+    del calls[:]
+    costs = auto_scheduler.measure.adaptive_time_costs(fake_time_f(0.5), [], 2, 20, 0.001, 2.0, 0.1)
+    assert len(calls) < 10
+
+
 def test_measure_local_builder_rpc_runner():
     if not tvm.runtime.enabled("llvm"):
         return
@@ -206,5 +293,8 @@ if __name__ == "__main__":
     test_record_compute_at_root_inline_cache_read_write()
     test_record_follow_split_follow_fused_split()
     test_record_pragma_storage_align_rfactor()
+    test_record_indexed_log()
     test_measure_local_builder_runner()
+    test_measure_local_runner_adaptive_repeat()
+    test_measure_adaptive_repeat_statistics()
     test_measure_local_builder_rpc_runner()
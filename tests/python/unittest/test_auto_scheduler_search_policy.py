@@ -29,7 +29,7 @@ from test_auto_scheduler_common import matmul_auto_scheduler_test, PropagatingTh
 def search_common(workload=matmul_auto_scheduler_test, target="llvm",
                   search_policy='empty', seed=random.randint(1, 1 << 30), runner='local',
                   cost_model=auto_scheduler.RandomModel(), num_measure_trials=2,
-                  init_search_callbacks=None):
+                  init_search_callbacks=None, builder='local', measure_pipeline_depth=0):
     print("Test %s schedule search with the default search policy" % (target))
 
     random.seed(seed)
@@ -52,7 +52,9 @@ def search_common(workload=matmul_auto_scheduler_test, target="llvm",
                     init_search_callbacks=init_search_callbacks)
 
         tuning_options = auto_scheduler.TuningOptions(num_measure_trials=num_measure_trials,
-                runner=runner, verbose=1, measure_callbacks=[auto_scheduler.RecordToFile(log_file)])
+                builder=builder, runner=runner, verbose=1,
+                measure_callbacks=[auto_scheduler.RecordToFile(log_file)],
+                measure_pipeline_depth=measure_pipeline_depth)
         sch, args = auto_scheduler.auto_schedule(task, search_policy, tuning_options)
         inp, res = auto_scheduler.load_best(log_file, workload_key, target)
 
@@ -107,6 +109,63 @@ def test_sketch_search_policy_basic():
     t.join()
 
 
+def test_sketch_search_policy_pipelined_measure():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    # With one build process a batch holds two programs, so the six trials are built and
+    # measured as three overlapped batches
+    t = PropagatingThread(target=search_common,
+                          kwargs={'seed': 944563397, 'search_policy': 'sketch',
+                                  'num_measure_trials': 6,
+                                  'builder': auto_scheduler.LocalBuilder(n_parallel=1),
+                                  'measure_pipeline_depth': 1})
+    t.start()
+    t.join()
+
+
+def distributed_search_common():
+    from tvm.rpc.tracker import Tracker
+    from tvm.rpc.server import Server
+
+    tracker = Tracker('0.0.0.0', port=9000, port_end=10000, silent=True)
+    # The workers fork from this process, so the test workloads are registered on them
+    servers = [Server('0.0.0.0', port=tracker.port, port_end=10000, key='test_worker',
+                      silent=True, tracker_addr=(tracker.host, tracker.port)) for _ in range(2)]
+    try:
+        tasks = []
+        for n in [32, 64]:
+            workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (n, n, n))
+            dag = auto_scheduler.ComputeDAG(workload_key)
+            tasks.append(auto_scheduler.SearchTask(dag, workload_key, tvm.target.create("llvm")))
+
+        with tempfile.NamedTemporaryFile() as fp:
+            search = auto_scheduler.DistributedSearch(tracker.host, tracker.port, 'test_worker',
+                                                      num_workers=2, seed=0, verbose=0)
+            best = search.tune(tasks, fp.name, num_measure_trials=4, num_trials_per_shard=2,
+                               num_measures_per_round=2)
+
+            num_records = {}
+            for inp, _ in auto_scheduler.load_records(fp.name):
+                key = inp.task.workload_key
+                num_records[key] = num_records.get(key, 0) + 1
+            for task in tasks:
+                assert 0 < num_records[task.workload_key] <= 4
+                inp, res = best[task.workload_key]
+                assert inp.task.workload_key == task.workload_key and res.error_no == 0
+    finally:
+        for server in servers:
+            server.terminate()
+        tracker.terminate()
+
+
+def test_distributed_search():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    t = PropagatingThread(target=distributed_search_common)
+    t.start()
+    t.join()
+
+
 def test_sketch_search_policy_cuda_rpc_runner():
     if not tvm.runtime.enabled("cuda"):
         return
@@ -123,4 +182,6 @@ def test_sketch_search_policy_cuda_rpc_runner():
 if __name__ == "__main__":
     test_workload_registry_search_basic()
     test_sketch_search_policy_basic()
+    test_sketch_search_policy_pipelined_measure()
+    test_distributed_search()
     test_sketch_search_policy_cuda_rpc_runner()
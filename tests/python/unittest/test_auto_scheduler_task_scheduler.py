@@ -0,0 +1,71 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Test the task scheduler"""
+
+import tempfile
+
+import tvm
+from tvm import auto_scheduler
+
+from test_auto_scheduler_common import matmul_auto_scheduler_test, PropagatingThread
+
+
+def tune_tasks_common():
+    tasks = []
+    for n in [16, 32, 64]:
+        workload_key = auto_scheduler.make_workload_key(matmul_auto_scheduler_test, (n, n, n))
+        dag = auto_scheduler.ComputeDAG(workload_key)
+        tasks.append(auto_scheduler.SearchTask(dag, workload_key, tvm.target.create("llvm")))
+
+    with tempfile.NamedTemporaryFile() as fp:
+        log_file = fp.name
+
+        num_measures_per_round = 2
+        num_measure_trials = len(tasks) * num_measures_per_round * 2
+        tuner = auto_scheduler.TaskScheduler(tasks, task_weights=[1, 2, 4], seed=0, verbose=0)
+        tuning_options = auto_scheduler.TuningOptions(
+            num_measure_trials=num_measure_trials, num_measures_per_round=num_measures_per_round,
+            verbose=0, measure_callbacks=[auto_scheduler.RecordToFile(log_file)])
+        tuner.tune(tuning_options)
+
+        # Every task is warmed up with one round, then the trials go by the gradient
+        assert len(tuner.task_cts) == len(tasks)
+        assert all(ct.value >= 1 for ct in tuner.task_cts)
+        num_rounds = num_measure_trials // num_measures_per_round
+        assert sum(ct.value for ct in tuner.task_cts) <= num_rounds
+
+        counts = {}
+        for inp, _ in auto_scheduler.load_records(log_file):
+            counts[inp.task.workload_key] = counts.get(inp.task.workload_key, 0) + 1
+        assert set(counts.keys()) == set(task.workload_key for task in tasks)
+        assert sum(counts.values()) <= num_measure_trials
+
+        assert all(cost.value > 0 for cost in tuner.best_costs)
+
+def test_task_scheduler_tune():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    # wrap the search in a new thread to avoid the conflict
+    # between python's multiprocessing and tvm's thread pool
+    t = PropagatingThread(target=tune_tasks_common)
+    t.start()
+    t.join()
+
+
+if __name__ == "__main__":
+    test_task_scheduler_tune()
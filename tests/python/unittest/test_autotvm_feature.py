@@ -79,6 +79,38 @@ def test_curve_feature_gemm():
     # sample_n * #buffers * #curves * 2 numbers per curve
     assert len(feas) == 30 * 3 * 4 * 2
 
+def test_feature_batch():
+    """test the batch extraction matches the extraction of one schedule at a time"""
+    N = 128
+
+    def get_gemm_schedule(tile):
+        k = te.reduce_axis((0, N), 'k')
+        A = te.placeholder((N, N), name='A')
+        B = te.placeholder((N, N), name='B')
+        C = te.compute(A.shape, lambda y, x: te.sum(A[y, k] * B[k, x], axis=k), name='C')
+        s = te.create_schedule(C.op)
+        y, x = s[C].op.axis
+        s[C].tile(y, x, tile, tile)
+        return s, [A, B, C]
+
+    schedules = [get_gemm_schedule(tile) for tile in [2, 4, 8, 16, 32]]
+    stmts = [feature.ana_lower(s, args, simple_mode=True) for s, args in schedules]
+
+    feas = feature.get_itervar_feature_flatten_batch(stmts, take_log=True)
+    assert feas.shape[0] == len(schedules)
+    for row, (s, args) in zip(feas, schedules):
+        expected = feature.get_itervar_feature_flatten(s, args, take_log=True)
+        np.testing.assert_allclose(row[:len(expected)], expected)
+        assert not row[len(expected):].any()
+
+    feas = feature.get_buffer_curve_sample_flatten_batch(stmts, sample_n=30)
+    for row, (s, args) in zip(feas, schedules):
+        expected = feature.get_buffer_curve_sample_flatten(s, args, sample_n=30)
+        np.testing.assert_allclose(row[:len(expected)], expected)
+
+    assert feature.get_itervar_feature_flatten_batch([], take_log=True).shape == (0, 0)
+
+
 def test_feature_shape():
     """test the dimensions of flatten feature are the same"""
 
@@ -131,5 +163,6 @@ def test_feature_shape():
 if __name__ == "__main__":
     test_iter_feature_gemm()
     test_curve_feature_gemm()
+    test_feature_batch()
     test_feature_shape()
 
@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 import pytest
 from tvm import te
@@ -52,6 +53,24 @@ def test_make_smap():
     tvm.ir.assert_structural_equal(arr, [smap], map_free_vars=True)
 
 
+def test_saveload_binary():
+    x = tvm.tir.const(1, "int32")
+    y = tvm.tir.const(float("-inf"), "float32")
+    v = tvm.tir.Var("v", "int64")
+    smap = tvm.runtime.convert({"x": x, "y": y})
+    omap = tvm.runtime.convert({v: x + x})
+    node = tvm.runtime.convert([smap, omap, "str", v])
+    data = tvm.ir.save_binary(node)
+    tvm.ir.assert_structural_equal(tvm.ir.load_binary(data), node, map_free_vars=True)
+
+    a = tvm.relay.var("a", shape=(2, 3), dtype="float32")
+    c = tvm.relay.const(np.arange(6, dtype="float32").reshape(2, 3))
+    mod = tvm.IRModule.from_expr(tvm.relay.Function([a], tvm.relay.nn.relu(a + c)))
+    data = tvm.ir.save_binary(mod)
+    assert len(data) < len(tvm.ir.save_json(mod))
+    tvm.ir.assert_structural_equal(tvm.ir.load_binary(data), mod)
+
+
 def test_make_node():
     x = tvm.ir.make_node("IntImm", dtype="int32", value=10)
     assert isinstance(x, tvm.tir.IntImm)
@@ -154,6 +173,7 @@ if __name__ == "__main__":
     test_make_node()
     test_make_smap()
     test_const_saveload_json()
+    test_saveload_binary()
     test_make_sum()
     test_pass_config()
     test_dict()
@@ -0,0 +1,85 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import threading
+
+import tvm
+import numpy as np
+from tvm import relay
+from tvm.contrib import graph_runtime, dynamic_batcher
+
+
+def _model(batch):
+    x = relay.var('x', shape=(batch, 8))
+    w = relay.var('w', shape=(4, 8))
+    return relay.Function([x, w], relay.nn.relu(relay.nn.dense(x, w)))
+
+
+def _run_concurrently(batcher, samples, w_np):
+    results = [None] * len(samples)
+
+    def client(i):
+        results[i] = batcher.infer(samples[i])
+
+    threads = [threading.Thread(target=client, args=(i,)) for i in range(len(samples))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for sample, outputs in zip(samples, results):
+        assert len(outputs) == 1
+        np.testing.assert_allclose(
+            outputs[0].asnumpy(), np.maximum(sample.dot(w_np.T), 0), rtol=1e-5)
+
+
+def test_dynamic_batcher_graph_runtime():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    graph, lib, _ = relay.build(_model(4), target="llvm")
+    mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+    w_np = np.random.uniform(-1, 1, size=(4, 8)).astype("float32")
+    mod.set_input("w", w_np)
+    batcher = dynamic_batcher.create(mod, 4, timeout_ms=1000, input_names=["x"])
+    samples = [np.random.uniform(-1, 1, size=(1, 8)).astype("float32") for _ in range(8)]
+    _run_concurrently(batcher, samples, w_np)
+    # the requests waited for each other instead of running one by one
+    assert batcher.num_batches < len(samples)
+
+    # a lonely request runs on its own once the timeout expired
+    batcher = dynamic_batcher.create(mod, 4, timeout_ms=1, input_names=["x"])
+    _run_concurrently(batcher, samples[:1], w_np)
+    assert batcher.num_batches == 1
+
+
+def test_dynamic_batcher_vm():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    w_np = np.random.uniform(-1, 1, size=(4, 8)).astype("float32")
+    x = relay.var('x', shape=(4, 8))
+    func = relay.Function([x], relay.nn.relu(relay.nn.dense(x, relay.const(w_np))))
+    exe = relay.vm.compile(tvm.IRModule.from_expr(func), "llvm")
+    vm = tvm.runtime.vm.VirtualMachine(exe, tvm.cpu())
+    batcher = dynamic_batcher.create(vm, 4, timeout_ms=1000)
+    samples = [np.random.uniform(-1, 1, size=(1, 8)).astype("float32") for _ in range(4)]
+    _run_concurrently(batcher, samples, w_np)
+    assert batcher.num_batches == 1
+
+
+if __name__ == "__main__":
+    test_dynamic_batcher_graph_runtime()
+    test_dynamic_batcher_vm()
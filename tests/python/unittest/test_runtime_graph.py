@@ -123,5 +123,247 @@ def test_graph_simple():
     check_remote()
     check_sharing()
 
+def test_graph_thread_pool_partition():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    from tvm import relay
+    x = relay.var('x', shape=(64, 64))
+    func = relay.Function([x], relay.nn.relu(x))
+    graph, lib, _ = relay.build(func, target="llvm")
+
+    config_partition = tvm.get_global_func("runtime.config_threadpool_partition")
+    # two workers with the default affinity mode
+    config_partition("graph_test", 1, 2)
+    mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+    mod.set_thread_pool_partition("graph_test")
+    a = np.random.uniform(-1, 1, size=(64, 64)).astype("float32")
+    for _ in range(4):
+        mod.run(x=a)
+        out = mod.get_output(0, tvm.nd.empty((64, 64)))
+        np.testing.assert_equal(out.asnumpy(), np.maximum(a, 0))
+
+
+def test_graph_load_mapped_params():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    from tvm import relay
+    x = relay.var('x', shape=(1, 10))
+    y = relay.var('y', shape=(1, 10))
+    w = relay.var('w', shape=(1, 10))
+    func = relay.Function([x, y, w], relay.add(relay.add(x, y), w))
+    x_in = np.ones((1, 10)).astype("float32")
+    w_in = np.random.uniform(size=(1, 10)).astype("float32")
+    params = {'x': x_in, 'w': w_in}
+    graph, lib, params = relay.build(func, target="llvm", params=params)
+
+    temp = util.tempdir()
+    a = np.random.uniform(size=(1, 10)).astype("float32")
+    for mapped in [False, True]:
+        path = temp.relpath("params_{}.bin".format(mapped))
+        with open(path, "wb") as fo:
+            fo.write(relay.save_param_dict(params, mapped=mapped))
+        mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+        mod.load_params_from_file(path)
+        mod.run(y=a)
+        out = mod.get_output(0, tvm.nd.empty((1, 10)))
+        np.testing.assert_allclose(out.asnumpy(), x_in + a + w_in, rtol=1e-6)
+        # writing a mapped param gives it a private copy
+        mod.set_input(w=a)
+        mod.run(y=a)
+        out = mod.get_output(0, tvm.nd.empty((1, 10)))
+        np.testing.assert_allclose(out.asnumpy(), x_in + a + a, rtol=1e-6)
+
+def test_graph_lazy_params():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    from tvm import relay
+    x = relay.var('x', shape=(1, 10))
+    y = relay.var('y', shape=(1, 10))
+    w = relay.var('w', shape=(1, 10))
+    func = relay.Function([x, y, w], relay.add(relay.add(x, y), w))
+    x_in = np.ones((1, 10)).astype("float32")
+    w_in = np.random.uniform(size=(1, 10)).astype("float32")
+    params = {'x': x_in, 'w': w_in}
+    graph, lib, params = relay.build(func, target="llvm", params=params)
+
+    a = np.random.uniform(size=(1, 10)).astype("float32")
+    for prefetch in [False, True]:
+        mod = graph_runtime.create(graph, lib, tvm.cpu(0))
+        mod.set_lazy_params()
+        mod.load_params(relay.save_param_dict(params))
+        if prefetch:
+            mod.prefetch_params(list(params.keys()))
+        for _ in range(2):
+            mod.run(y=a)
+            out = mod.get_output(0, tvm.nd.empty((1, 10)))
+            np.testing.assert_allclose(out.asnumpy(), x_in + a + w_in, rtol=1e-6)
+
+def test_graph_multi_stream():
+    targets = []
+    if tvm.gpu(0).exist and tvm.runtime.enabled("cuda"):
+        targets.append(("cuda", tvm.gpu(0)))
+    if tvm.rocm(0).exist and tvm.runtime.enabled("rocm"):
+        targets.append(("rocm", tvm.rocm(0)))
+    if not targets:
+        print("Skip because neither cuda nor rocm is enabled")
+        return
+    from tvm import relay
+    x = relay.var('x', shape=(32, 32))
+    w1 = relay.var('w1', shape=(32, 32))
+    w2 = relay.var('w2', shape=(32, 32))
+    # two independent branches joined at the end
+    b1 = relay.nn.relu(relay.nn.dense(x, w1))
+    b2 = relay.nn.relu(relay.nn.dense(x, w2))
+    func = relay.Function([x, w1, w2], relay.add(b1, b2))
+
+    data = {name: np.random.uniform(-1, 1, size=(32, 32)).astype("float32")
+            for name in ["x", "w1", "w2"]}
+    ref = np.maximum(data["x"].dot(data["w1"].T), 0) + \
+        np.maximum(data["x"].dot(data["w2"].T), 0)
+    for target, ctx in targets:
+        graph, lib, _ = relay.build(func, target=target)
+        mod = graph_runtime.create(graph, lib, ctx)
+        mod.set_num_streams(2)
+        for _ in range(3):
+            mod.run(**data)
+            out = mod.get_output(0, tvm.nd.empty((32, 32)))
+            np.testing.assert_allclose(out.asnumpy(), ref, rtol=1e-5, atol=1e-5)
+
+def test_graph_run_async():
+    from tvm import relay
+    x = relay.var('x', shape=(32, 32))
+    func = relay.Function([x], relay.nn.relu(relay.add(x, relay.const(1.0))))
+    targets = [("llvm", tvm.cpu(0))]
+    if tvm.gpu(0).exist and tvm.runtime.enabled("cuda"):
+        targets.append(("cuda", tvm.gpu(0)))
+    if tvm.rocm(0).exist and tvm.runtime.enabled("rocm"):
+        targets.append(("rocm", tvm.rocm(0)))
+    for target, ctx in targets:
+        graph, lib, _ = relay.build(func, target=target)
+        mod = graph_runtime.create(graph, lib, ctx)
+        data = [np.random.uniform(-2, 2, size=(32, 32)).astype("float32") for _ in range(3)]
+        # keep two runs in flight, uploading the input of a run while the previous computes
+        waits = [mod.run_async(x=data[0])]
+        for i in range(1, len(data)):
+            mod.set_input(x=data[i])
+            waits[-1]()
+            out = mod.get_output(0).asnumpy()
+            np.testing.assert_allclose(out, np.maximum(data[i - 1] + 1, 0), rtol=1e-5)
+            waits.append(mod.run_async())
+        waits[-1]()
+        # waiting again on finished runs returns immediately
+        waits[0]()
+        out = mod.get_output(0).asnumpy()
+        np.testing.assert_allclose(out, np.maximum(data[-1] + 1, 0), rtol=1e-5)
+        # a synchronous run picks up the staged input
+        mod.set_input(x=data[0])
+        mod.run()
+        out = mod.get_output(0).asnumpy()
+        np.testing.assert_allclose(out, np.maximum(data[0] + 1, 0), rtol=1e-5)
+
+
+def test_graph_run_async_staging():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("Skip because cuda is not enabled")
+        return
+    from tvm import relay
+    n = 1024
+    x = relay.var('x', shape=(n, n))
+    y = x
+    for _ in range(4):
+        y = relay.tanh(relay.nn.dense(y, x))
+    graph, lib, _ = relay.build(relay.Function([x], y), target="cuda")
+    mod = graph_runtime.create(graph, lib, tvm.gpu(0))
+    num_staged = mod.module["get_num_staged_inputs"]
+
+    def ref(a):
+        b = a
+        for _ in range(4):
+            b = np.tanh(np.dot(b, a.T))
+        return b
+
+    data = [np.random.uniform(-0.1, 0.1, size=(n, n)).astype("float32") for _ in range(2)]
+    wait = mod.run_async(x=data[0])
+    # the input set while the run computes is uploaded aside, not over the one it reads
+    mod.set_input(x=data[1])
+    assert num_staged() == 1
+    wait()
+    np.testing.assert_allclose(mod.get_output(0).asnumpy(), ref(data[0]), rtol=1e-4, atol=1e-4)
+    # the next launch consumes the staged input
+    wait = mod.run_async()
+    assert num_staged() == 0
+    wait()
+    np.testing.assert_allclose(mod.get_output(0).asnumpy(), ref(data[1]), rtol=1e-4, atol=1e-4)
+
+
+def test_graph_overlap_copies():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("Skip because cuda is not enabled")
+        return
+    from tvm import relay
+    x = relay.var('x', shape=(64, 64))
+    y = relay.var('y', shape=(64, 64))
+    # the kernels run on the GPU, the reduction on the CPU, with copies both ways
+    a = relay.nn.relu(relay.add(x, y))
+    b = relay.multiply(x, y)
+    c = relay.annotation.on_device(relay.sum(relay.add(a, b), axis=1), tvm.cpu(0))
+    func = relay.Function([x, y], relay.add(c, relay.const(1.0)))
+    mod = tvm.IRModule.from_expr(func)
+    with tvm.transform.PassContext(opt_level=1, config={"relay.fallback_device_type": 2}):
+        graph, lib, _ = relay.build(mod, target={"cpu": "llvm", "cuda": "cuda"})
+    x_np = np.random.uniform(-1, 1, size=(64, 64)).astype("float32")
+    y_np = np.random.uniform(-1, 1, size=(64, 64)).astype("float32")
+    ref = (np.maximum(x_np + y_np, 0) + x_np * y_np).sum(axis=1) + 1
+    mod = graph_runtime.create(graph, lib, [tvm.cpu(0), tvm.gpu(0)])
+    mod.set_overlap_copies()
+    for _ in range(3):
+        mod.run(x=x_np, y=y_np)
+        np.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-4)
+    mod.set_overlap_copies(False)
+    mod.run(x=x_np, y=y_np)
+    np.testing.assert_allclose(mod.get_output(0).asnumpy(), ref, rtol=1e-4)
+
+
+
+def test_graph_pinned_staging():
+    from tvm import relay
+    x = relay.var('x', shape=(64, 64))
+    func = relay.Function([x], relay.nn.relu(relay.add(x, relay.const(1.0))))
+    targets = [("llvm", tvm.cpu(0))]
+    if tvm.gpu(0).exist and tvm.runtime.enabled("cuda"):
+        targets.append(("cuda", tvm.gpu(0)))
+    for target, ctx in targets:
+        graph, lib, _ = relay.build(func, target=target)
+        mod = graph_runtime.create(graph, lib, ctx)
+        # copies that do not involve a GPU are not staged
+        mod.set_pinned_staging()
+        data = [np.random.uniform(-2, 2, size=(64, 64)).astype("float32") for _ in range(3)]
+        out = tvm.nd.empty((64, 64), "float32", tvm.cpu(0))
+        for x_np in data:
+            mod.run(x=x_np)
+            mod.get_output(0, out)
+            np.testing.assert_allclose(out.asnumpy(), np.maximum(x_np + 1, 0), rtol=1e-5)
+        # the staged upload of the next input overlaps with the launched run
+        wait = mod.run_async(x=data[0])
+        mod.set_input(x=data[1])
+        wait()
+        mod.get_output(0, out)
+        np.testing.assert_allclose(out.asnumpy(), np.maximum(data[0] + 1, 0), rtol=1e-5)
+        mod.run()
+        mod.set_pinned_staging(False)
+        mod.get_output(0, out)
+        np.testing.assert_allclose(out.asnumpy(), np.maximum(data[1] + 1, 0), rtol=1e-5)
+
 if __name__ == "__main__":
     test_graph_simple()
+    test_graph_thread_pool_partition()
+    test_graph_load_mapped_params()
+    test_graph_lazy_params()
+    test_graph_multi_stream()
+    test_graph_run_async()
+    test_graph_run_async_staging()
+    test_graph_overlap_copies()
+    test_graph_pinned_staging()
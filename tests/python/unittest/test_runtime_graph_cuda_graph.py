@@ -0,0 +1,56 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+import numpy as np
+from tvm import relay
+from tvm.contrib.cuda_graph import cuda_graph_runtime
+
+
+def test_graph_cuda_graph():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("Skip because cuda is not enabled")
+        return
+    if not tvm.get_global_func("tvm.graph_runtime_cuda_graph.create", allow_missing=True):
+        print("Skip because cuda graph runtime is not enabled")
+        return
+    x = relay.var('x', shape=(8, 8))
+    y = relay.var('y', shape=(8, 8))
+    func = relay.Function([x, y], relay.nn.relu(relay.add(relay.exp(x), y)))
+    graph, lib, _ = relay.build(func, target="cuda")
+
+    ctx = tvm.gpu(0)
+    mod = cuda_graph_runtime.create(graph, lib, ctx)
+    for _ in range(3):
+        x_in = np.random.uniform(-1, 1, size=(8, 8)).astype("float32")
+        y_in = np.random.uniform(-1, 1, size=(8, 8)).astype("float32")
+        mod.run(x=x_in, y=y_in)
+        out = mod.get_output(0, tvm.nd.empty((8, 8))).asnumpy()
+        np.testing.assert_allclose(out, np.maximum(np.exp(x_in) + y_in, 0), rtol=1e-5)
+
+    # Changing the data pointers of an input captures the graph again.
+    x_in = np.random.uniform(-1, 1, size=(8, 8)).astype("float32")
+    y_in = np.random.uniform(-1, 1, size=(8, 8)).astype("float32")
+    x_nd = tvm.nd.array(x_in, ctx)
+    mod.module["set_input_zero_copy"]("x", x_nd)
+    mod.set_input("y", y_in)
+    mod.run()
+    out = mod.get_output(0, tvm.nd.empty((8, 8))).asnumpy()
+    np.testing.assert_allclose(out, np.maximum(np.exp(x_in) + y_in, 0), rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_graph_cuda_graph()
@@ -89,6 +89,10 @@ def test_graph_simple():
         mod.run()
         #Verify the tensors are dumped
         assert(len(os.listdir(directory)) > 1)
+        #the timeline runs the graph once more, it is only recorded on request
+        assert not os.path.exists(os.path.join(directory, '_tvmdbg_timeline.json'))
+        mod.collect_timeline = True
+        mod.run()
 
         CHROME_TRACE_FILE_NAME = '_tvmdbg_execution_trace.json'
         assert(os.path.exists(os.path.join(directory, CHROME_TRACE_FILE_NAME)))
@@ -106,10 +110,31 @@ def test_graph_simple():
         assert events[0]["ts"] == 0
         assert events[0]["ph"] == 'B'
 
+        #verify the timeline of the run, with the allocations and the op
+        with open(os.path.join(directory, '_tvmdbg_timeline.json')) as f:
+            timeline = json.load(f)["traceEvents"]
+        allocs = [e for e in timeline if e.get("cat") == "alloc"]
+        assert allocs and all(e["args"]["bytes"] > 0 for e in allocs)
+        ops = [e for e in timeline if e.get("cat") == "op"]
+        assert len(ops) == 1 and ops[0]["name"] == "add" and ops[0]["ph"] == "X"
+        assert ops[0]["tid"] == 0 and ops[0]["dur"] >= 0
+        names = [e for e in timeline if e["ph"] == "M"]
+        assert len(names) == 1 and names[0]["args"]["name"] == "cpu(0)"
+
         #verify the output is correct
         out = mod.get_output(0, tvm.nd.empty((n,)))
         np.testing.assert_equal(out.asnumpy(), a + 1)
 
+        #verify the hardware counters, which may be unavailable on this machine
+        counters = mod.run_individual_counters(2)
+        if counters:
+            assert len(counters) == 2
+            assert counters[0]["instructions"] == 0
+            assert counters[1]["instructions"] > 0
+            mod.collect_counters = True
+            mod.run(x=a)
+            assert os.path.exists(os.path.join(directory, '_tvmdbg_counters.json'))
+
         mod.exit()
         #verify dump root delete after cleanup
         assert(not os.path.exists(directory))
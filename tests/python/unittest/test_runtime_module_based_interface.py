@@ -110,6 +110,78 @@ def test_gpu():
     out = gmod.get_output(0).asnumpy()
     tvm.testing.assert_allclose(out, verify(data), atol=1e-5)
 
+def test_share_params():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    targets = [("llvm", tvm.cpu())]
+    if tvm.runtime.enabled("cuda") and tvm.gpu().exist:
+        targets.append(("cuda", tvm.gpu()))
+    sweep = tvm.get_global_func("runtime.WeightRegistrySweep")
+    for target, ctx in targets:
+        mod, params = relay.testing.synthetic.get_workload()
+        with relay.build_config(opt_level=3):
+            complied_graph_lib = relay.build_module.build(mod, target, params=params)
+        data = np.random.uniform(-1, 1, size=input_shape(mod)).astype("float32")
+        complied_graph_lib.set_share_params()
+        replicas = [graph_runtime.GraphModule(complied_graph_lib['default'](ctx))
+                    for _ in range(3)]
+        if target == "cuda":
+            # one device copy per param, whatever the number of replicas
+            assert sweep() == len(complied_graph_lib.get_params())
+        for gmod in replicas:
+            gmod.set_input("data", data)
+            gmod.run()
+            tvm.testing.assert_allclose(gmod.get_output(0).asnumpy(), verify(data), atol=1e-5)
+
+        # replicas given different inputs compute their own outputs
+        inputs = [np.random.uniform(-1, 1, size=input_shape(mod)).astype("float32")
+                  for _ in replicas]
+        for gmod, x in zip(replicas, inputs):
+            gmod.set_input("data", x)
+        for gmod, x in zip(replicas, inputs):
+            gmod.run()
+            tvm.testing.assert_allclose(gmod.get_output(0).asnumpy(), verify(x), atol=1e-5)
+
+        # setting a param gives the replica a private copy, the others are unchanged
+        name, value = next(iter(complied_graph_lib.get_params().items()))
+        replicas[0].set_input(name, np.zeros(value.shape, value.dtype))
+        np.testing.assert_equal(replicas[0].get_input(name).asnumpy(), 0)
+        np.testing.assert_equal(replicas[1].get_input(name).asnumpy(), value.asnumpy())
+        replicas[1].run()
+        tvm.testing.assert_allclose(replicas[1].get_output(0).asnumpy(), verify(data), atol=1e-5)
+
+        del replicas, gmod
+        assert sweep() == 0
+
+
+def test_params_section():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    from tvm.contrib import util
+    mod, params = relay.testing.synthetic.get_workload()
+    with relay.build_config(opt_level=3):
+        complied_graph_lib = relay.build_module.build(mod, "llvm", params=params)
+    temp = util.tempdir()
+    path_lib = temp.relpath("deploy_lib.so")
+    complied_graph_lib.export_library(path_lib, params_section=True)
+    loaded_lib = tvm.runtime.load_module(path_lib)
+    data = np.random.uniform(-1, 1, size=input_shape(mod)).astype("float32")
+    ctx = tvm.cpu()
+    replicas = [graph_runtime.GraphModule(loaded_lib['default'](ctx)) for _ in range(2)]
+    for gmod in replicas:
+        gmod.set_input("data", data)
+        gmod.run()
+        tvm.testing.assert_allclose(gmod.get_output(0).asnumpy(), verify(data), atol=1e-5)
+
+    # the params are read-only in the library, setting one makes a private copy
+    name, value = next(iter(complied_graph_lib.get_params().items()))
+    replicas[0].set_input(name, np.zeros(value.shape, value.dtype))
+    np.testing.assert_equal(replicas[0].get_input(name).asnumpy(), 0)
+    np.testing.assert_equal(replicas[1].get_input(name).asnumpy(), value.asnumpy())
+
+
 def test_mod_export():
     def verify_cpu_export(obj_format):
         if not tvm.runtime.enabled("llvm"):
@@ -515,6 +587,8 @@ if __name__ == "__main__":
     test_legacy_compatibility()
     test_cpu()
     test_gpu()
+    test_share_params()
+    test_params_section()
     test_mod_export()
     test_remove_package_params()
     test_debug_graph_runtime()
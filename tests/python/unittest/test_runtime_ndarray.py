@@ -78,7 +78,62 @@ def test_dtype():
     assert dtype.type_code == tvm.DataTypeCode.HANDLE
 
 
+def test_cpu_numa_policy():
+    set_numa_policy = tvm.get_global_func("device_api.cpu.set_numa_policy")
+    x = np.random.uniform(size=(256, 1024)).astype("float32")
+    for policy in ["interleave", "local"]:
+        set_numa_policy("data", policy)
+        y = tvm.nd.array(x, ctx=tvm.cpu(0))
+        np.testing.assert_equal(x, y.asnumpy())
+    set_numa_policy("data", "default")
+
+
+def test_nd_view():
+    x = np.arange(4 * 6 * 8).astype("float32").reshape(4, 6, 8)
+    for ctx in ENABLED_CTX_LIST:
+        y = tvm.nd.array(x, ctx=ctx)
+        # a sub-batch
+        v = y.view((2, 6, 8), byte_offset=6 * 8 * 4)
+        np.testing.assert_equal(v.asnumpy(), x[1:3])
+        np.testing.assert_equal(v.copyto(tvm.cpu(0)).asnumpy(), x[1:3])
+        if ctx.device_type != tvm.cpu(0).device_type:
+            continue
+        # a strided slice, x[:, 2:5, ::2]
+        s = y.view((4, 3, 4), byte_offset=2 * 8 * 4, strides=(48, 8, 2))
+        np.testing.assert_equal(s.asnumpy(), x[:, 2:5, ::2])
+        np.testing.assert_equal(s.copyto(tvm.cpu(0)).asnumpy(), x[:, 2:5, ::2])
+        s.copyfrom(np.zeros((4, 3, 4), "float32"))
+        expected = x.copy()
+        expected[:, 2:5, ::2] = 0
+        np.testing.assert_equal(y.asnumpy(), expected)
+        # a view past the end of the array
+        try:
+            y.view((2, 6, 8), byte_offset=3 * 6 * 8 * 4)
+            assert False
+        except tvm.TVMError:
+            pass
+        # a view that does not start on an element
+        try:
+            y.view((2, 6, 8), byte_offset=6 * 8 * 4 + 2)
+            assert False
+        except tvm.TVMError:
+            pass
+
+    # the compiled kernels take a compact view in place
+    n = 32
+    A = te.placeholder((1, n), name="A")
+    B = te.compute((1, n), lambda i, j: A[i, j] + 1, name="B")
+    s = te.create_schedule(B.op)
+    func = tvm.build(s, [A, B], "llvm")
+    a = tvm.nd.array(np.arange(4 * n).astype("float32").reshape(4, n))
+    b = tvm.nd.array(np.zeros((4, n), "float32"))
+    func(a.view((1, n), byte_offset=2 * n * 4), b.view((1, n), byte_offset=n * 4))
+    np.testing.assert_equal(b.asnumpy()[1], a.asnumpy()[2] + 1)
+
+
 if __name__ == "__main__":
     test_nd_create()
+    test_nd_view()
     test_fp16_conversion()
     test_dtype()
+    test_cpu_numa_policy()
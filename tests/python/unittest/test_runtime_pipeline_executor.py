@@ -0,0 +1,49 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+import numpy as np
+from tvm import relay
+from tvm.contrib import graph_runtime, pipeline_executor
+
+
+def test_pipeline_two_stages():
+    if not tvm.runtime.enabled("llvm"):
+        print("Skip because llvm is not enabled")
+        return
+    # stage 0: y = x + 1, stage 1: z = y * x
+    x = relay.var('x', shape=(4, 4))
+    stage0 = relay.Function([x], relay.add(x, relay.const(1.0)))
+    y = relay.var('y', shape=(4, 4))
+    x1 = relay.var('x1', shape=(4, 4))
+    stage1 = relay.Function([y, x1], relay.multiply(y, x1))
+
+    modules = []
+    for func in [stage0, stage1]:
+        graph, lib, _ = relay.build(func, target="llvm")
+        modules.append(graph_runtime.create(graph, lib, tvm.cpu(0)))
+
+    pipe = pipeline_executor.create(
+        modules, [{"x": (-1, 0)}, {"y": (0, 0), "x1": (-1, 0)}], num_inputs=1)
+    data = [np.random.uniform(size=(4, 4)).astype("float32") for _ in range(10)]
+    results = pipe.run([[tvm.nd.array(d)] for d in data])
+    assert len(results) == len(data)
+    for d, out in zip(data, results):
+        np.testing.assert_allclose(out[0].asnumpy(), (d + 1) * d, rtol=1e-6)
+
+
+if __name__ == "__main__":
+    test_pipeline_two_stages()
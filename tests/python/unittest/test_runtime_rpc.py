@@ -87,6 +87,36 @@ def test_rpc_simple():
     assert f2("abc", 11) == "abc:11"
 
 
+def test_rpc_submit():
+    if not tvm.runtime.enabled("rpc"):
+        return
+    @tvm.register_func("rpc.test.submit_addone")
+    def addone(x):
+        return x + 1
+
+    @tvm.register_func("rpc.test.submit_except")
+    def remotethrow(name):
+        raise ValueError("%s" % name)
+
+    server = rpc.Server("localhost", key="x1")
+    client = rpc.connect(server.host, server.port, key="x1")
+    f1 = client.get_function("rpc.test.submit_addone")
+    f2 = client.get_function("rpc.test.submit_except")
+    # more calls in flight than the pending window
+    waits = [client.submit(f1, i) for i in range(40)]
+    werr = client.submit(f2, "abc")
+    wlast = client.submit(f1, 100)
+    # a synchronous call receives the returns submitted before it
+    assert f1(10) == 11
+    assert [w() for w in waits] == list(range(1, 41))
+    with pytest.raises(tvm.error.RPCError):
+        werr()
+    assert wlast() == 101
+    assert wlast() == 101
+    # local functions are called right away
+    assert client.submit(tvm.get_global_func("rpc.test.submit_addone"), 1)() == 2
+
+
 def test_rpc_runtime_string():
     if not tvm.runtime.enabled("rpc"):
         return
@@ -131,6 +161,47 @@ def test_rpc_large_array():
     np.testing.assert_equal(b.asnumpy(), b_np)
 
 
+def test_rpc_bulk_copy():
+    # sizes around the threshold of the direct send and receive of the data
+    server = rpc.Server("localhost")
+    remote = rpc.connect(server.host, server.port)
+    ctx = remote.cpu(0)
+    for n in [4095, 4096, (1 << 20) + 3]:
+        x = np.random.uniform(size=n).astype("float32")
+        y = tvm.nd.array(x, ctx)
+        np.testing.assert_equal(y.asnumpy(), x)
+        # interleave with small copies on the same session
+        z = tvm.nd.array(x[:7], ctx)
+        np.testing.assert_equal(z.asnumpy(), x[:7])
+
+
+def test_rpc_payload_options():
+    if not tvm.runtime.enabled("rpc"):
+        return
+    temp = util.tempdir()
+    cache_dir = temp.relpath("payload_cache")
+    os.environ["TVM_RPC_PAYLOAD_CACHE_DIR"] = cache_dir
+    try:
+        server = rpc.Server("localhost")
+    finally:
+        del os.environ["TVM_RPC_PAYLOAD_CACHE_DIR"]
+    remote = rpc.connect(server.host, server.port)
+    assert remote.set_payload_options(compress=True, cache=True) == "lz4,cache"
+    ctx = remote.cpu(0)
+    compressible = np.zeros(1 << 16, dtype="float32")
+    compressible[::7] = 1
+    incompressible = np.random.uniform(size=(1 << 16) + 1).astype("float32")
+    for x in [compressible, incompressible]:
+        # the second copy is served by the cache of the server
+        for _ in range(2):
+            np.testing.assert_equal(tvm.nd.array(x, ctx).asnumpy(), x)
+    assert len(os.listdir(cache_dir)) == 2
+    # small copies and disabled options keep the plain copy
+    np.testing.assert_equal(tvm.nd.array(compressible[:7], ctx).asnumpy(), compressible[:7])
+    assert remote.set_payload_options(compress=False, cache=False) == ""
+    np.testing.assert_equal(tvm.nd.array(incompressible, ctx).asnumpy(), incompressible)
+
+
 def test_rpc_echo():
     def check(remote):
         fecho = remote.get_function("testing.echo")
@@ -160,6 +231,7 @@ def test_rpc_echo():
     minrpc_exec = temp.relpath("minrpc")
     tvm.rpc.with_minrpc(cc.create_executable)(minrpc_exec, [])
     check(rpc.PopenSession(minrpc_exec))
+    check(rpc.PopenSession(minrpc_exec, shared_memory=True))
     # minrpc on the remote
     server = rpc.Server("localhost")
     client = rpc.connect(
@@ -240,6 +312,17 @@ def test_rpc_remote_module():
         cost = time_f(a, b).mean
         np.testing.assert_equal(b.asnumpy(), a.asnumpy() + 1)
 
+        # the same over shared memory, with arrays larger than the rings
+        remote = tvm.rpc.PopenSession(path_minrpc, shared_memory=True)
+        ctx = remote.cpu(0)
+        f1 = remote.system_lib()
+        a = tvm.nd.array(np.random.uniform(size=102).astype(A.dtype), ctx)
+        b = tvm.nd.array(np.zeros(102, dtype=A.dtype), ctx)
+        f1["myadd"](a, b)
+        np.testing.assert_equal(b.asnumpy(), a.asnumpy() + 1)
+        x = np.random.uniform(size=(3 << 20) + 5).astype("float32")
+        np.testing.assert_equal(tvm.nd.array(x, ctx).asnumpy(), x)
+
         # change to not executable
         os.chmod(path_minrpc, stat.S_IRUSR)
         with pytest.raises(RuntimeError):
@@ -488,3 +571,4 @@ if __name__ == "__main__":
     test_rpc_tracker_register()
     test_rpc_tracker_request()
     test_rpc_large_array()
+    test_rpc_bulk_copy()
@@ -14,6 +14,8 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import json
+
 import numpy as np
 
 import tvm
@@ -36,5 +38,53 @@ def test_basic():
     print("\n{}".format(vm.get_stat()))
     print("\n{}".format(vm.get_stat(False)))
 
+
+def test_timeline():
+    x = relay.var("x", shape=(10, 10))
+    y = relay.add(x, relay.const(np.ones((10, 10), "float32")))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(y)))
+    if not profiler_vm.enabled():
+        return
+    exe = relay.vm.compile(mod, "llvm")
+    vm = profiler_vm.VirtualMachineProfiler(exe, tvm.cpu())
+    vm.invoke("main", [np.random.rand(10, 10).astype("float32")])
+
+    events = json.loads(vm.get_timeline())["traceEvents"]
+    ops = [e for e in events if e["ph"] == "X" and e["cat"] == "op"]
+    assert ops and all(e["dur"] >= 0 for e in ops)
+    assert any(e.get("cat") == "alloc" and e["args"]["bytes"] > 0 for e in events)
+    assert any(e.get("cat") == "copy" for e in events)
+    assert any(e["ph"] == "M" and e["args"]["name"] == "cpu(0)" for e in events)
+
+    vm.reset()
+    assert not json.loads(vm.get_timeline())["traceEvents"]
+
+
+def test_stat_json():
+    x = relay.var("x", shape=(relay.Any(), 10))
+    y = relay.add(x, relay.const(np.ones((1, 10), "float32")))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(y)))
+    if not profiler_vm.enabled():
+        return
+    exe = relay.vm.compile(mod, "llvm")
+    vm = profiler_vm.VirtualMachineProfiler(exe, tvm.cpu())
+    for n in [3, 5]:
+        vm.invoke("main", [np.random.rand(n, 10).astype("float32")])
+
+    stat = vm.get_stat(fmt="json")
+    assert stat["opcodes"]["invoke_packed"]["count"] > 0
+    assert all(op["time_us"] >= 0 for op in stat["opcodes"].values())
+    assert any(p["count"] == 2 for p in stat["packed_funcs"].values())
+    assert sum(site["bytes"] for site in stat["allocs"].values()) > 0
+    assert all(site.startswith("main@") for site in stat["allocs"])
+    assert stat["peak_memory"]["1:0"] > 0
+    assert set(stat["copies"]) == {"host_to_device", "device_to_host"}
+
+    vm.reset()
+    assert not vm.get_stat(fmt="json")["opcodes"]
+
+
 if __name__ == "__main__":
     test_basic()
+    test_timeline()
+    test_stat_json()
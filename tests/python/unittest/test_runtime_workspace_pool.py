@@ -0,0 +1,79 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import json
+
+import numpy as np
+import tvm
+from tvm import te
+
+
+def _build_with_workspace(n):
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] + 1.0, name="B")
+    C = te.compute((n,), lambda i: B[i] * 2.0, name="C")
+    s = te.create_schedule(C.op)
+    # B is too large for the stack, it is allocated from the workspace pool.
+    return tvm.build(s, [A, C], "llvm")
+
+
+def test_workspace_pool_stats():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    n = 4096
+    f = _build_with_workspace(n)
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype("float32"), ctx)
+    c = tvm.nd.empty((n,), "float32", ctx)
+    device_type = ctx.device_type
+
+    def stats():
+        return json.loads(tvm.get_global_func("runtime.WorkspacePoolStats")(device_type))
+
+    reset = tvm.get_global_func("runtime.WorkspacePoolResetStats")
+    set_max_cached = tvm.get_global_func("runtime.WorkspacePoolSetMaxCachedBytes")
+    trim = tvm.get_global_func("runtime.WorkspacePoolTrim")
+
+    reset(device_type)
+    f(a, c)
+    f(a, c)
+    tvm.testing.assert_allclose(c.asnumpy(), (a.asnumpy() + 1.0) * 2.0)
+    res = stats()
+    assert res["hits"] >= 1
+    assert res["hits"] + res["misses"] == 2
+    assert res["outstanding_bytes"] == 0
+    assert res["peak_outstanding_bytes"] >= n * 4
+
+    # a pool does not cache anything under a zero cap
+    set_max_cached(device_type, 0)
+    try:
+        reset(device_type)
+        f(a, c)
+        f(a, c)
+        assert stats()["misses"] == 2
+    finally:
+        set_max_cached(device_type, -1)
+
+    # a trim releases the cache, the next run allocates again
+    f(a, c)
+    trim(device_type)
+    reset(device_type)
+    f(a, c)
+    assert stats()["misses"] == 1
+
+
+if __name__ == "__main__":
+    test_workspace_pool_stats()
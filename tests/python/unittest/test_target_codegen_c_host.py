@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import platform
 import tvm
 from tvm import te
 import numpy as np
@@ -118,7 +119,56 @@ def test_reinterpret():
     check_c()
 
 
+def test_simd():
+    n = 1024
+    A = te.placeholder((n,), name='A')
+    B = te.placeholder((n,), name='B')
+    C = te.compute(A.shape, lambda i: A[i] * B[i] + 1.0, name='C')
+    s = te.create_schedule(C.op)
+    xo, xi = s[C].split(C.op.axis[0], factor=4)
+    s[C].vectorize(xi)
+
+    X = te.placeholder((n,), name='X', dtype="int8")
+    Y = te.compute(X.shape, lambda i: X[i] * X[i], name='Y')
+    sy = te.create_schedule(Y.op)
+    yo, yi = sy[Y].split(Y.op.axis[0], factor=16)
+    sy[Y].vectorize(yi)
+
+    expected = {
+        "neon": ["float32x4_t", "vld1q_f32", "vmulq_f32", "vaddq_f32", "vst1q_f32",
+                 "vmulq_s8"],
+        "mve": ["float32x4_t", "vld1q_f32", "vmulq_f32", "vdupq_n_f32", "vst1q_f32",
+                "vmulq_s8"],
+        # SSE2 has no product of int8 vectors, it is done lane by lane.
+        "sse": ["__m128", "_mm_load_ps", "_mm_mul_ps", "_mm_set1_ps", "_mm_store_ps",
+                "_mm_setr_epi8"],
+    }
+    for simd, intrinsics in expected.items():
+        target = "c -simd=%s" % simd
+        fmul = tvm.build(s, [A, B, C], target, name="fmul")
+        fsquare = tvm.build(sy, [X, Y], target, name="fsquare")
+        source = fmul.get_source() + fsquare.get_source()
+        for intrinsic in intrinsics:
+            assert intrinsic in source, intrinsic
+        assert "restrict" in source
+
+    if platform.machine() not in ["x86_64", "AMD64"]:
+        return
+    fmul = tvm.build(s, [A, B, C], "c -simd=sse", name="fmul")
+    temp = util.tempdir()
+    path_dso = temp.relpath("temp.so")
+    fmul.export_library(path_dso)
+    m = tvm.runtime.load_module(path_dso)
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+    b = tvm.nd.array(np.random.uniform(size=n).astype(B.dtype), ctx)
+    c = tvm.nd.array(np.zeros(n, dtype=C.dtype), ctx)
+    m["fmul"](a, b, c)
+    tvm.testing.assert_allclose(c.asnumpy(), a.asnumpy() * b.asnumpy() + 1.0, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_add()
     test_add_pipeline()
     test_reinterpret()
+    test_simd()
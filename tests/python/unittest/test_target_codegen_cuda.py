@@ -22,6 +22,7 @@ from tvm import topi
 import unittest
 from tvm.contrib.nvcc import have_fp16, have_int8
 from tvm.contrib import nvcc
+from tvm.contrib import util
 
 tx = te.thread_axis("threadIdx.x")
 bx = te.thread_axis("blockIdx.x")
@@ -263,6 +264,8 @@ def test_crossthread_reduction1():
         verify(16)
         verify(32)
         verify(64)
+        verify(256)
+        verify(1024)
 
     check("cuda")
     check("rocm")
@@ -914,6 +917,102 @@ def test_unrolled_vectorization():
     c_np = c_tvm.asnumpy()
     tvm.testing.assert_allclose(c_np, N * np.ones((N, N)))
 
+def test_cuda_mma_ldmatrix():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("skip because cuda is not enabled..")
+        return
+    if float(tvm.gpu(0).compute_version) < 8.0:
+        print("skip because gpu does not support mma.m16n8k16")
+        return
+
+    def mma_ir(A, B, C):
+        # one warp computes C[16, 8] = A[16, 16] * B[16, 8]^T in the mma register layout.
+        ib = tvm.tir.ir_builder.create()
+        tx = te.thread_axis("threadIdx.x")
+        ib.scope_attr(tx, "thread_extent", 32)
+        lane = tx.var
+        group, tid = lane // 4, lane % 4
+        Aptr = ib.buffer_ptr(A)
+        Bptr = ib.buffer_ptr(B)
+        Cptr = ib.buffer_ptr(C)
+        A_shared = ib.allocate("float16", 256, name="A_shared", scope="shared")
+        A_local = ib.allocate("float16", 8, name="A_local", scope="local")
+        B_local = ib.allocate("float16", 4, name="B_local", scope="local")
+        C_local = ib.allocate("float32", 4, name="C_local", scope="local")
+        with ib.for_range(0, 8, name="i") as i:
+            A_shared[lane * 8 + i] = Aptr[lane * 8 + i]
+        ib.emit(tvm.tir.call_intrin("int32", "tir.tvm_storage_sync", "shared"))
+        # thread i gives row i % 8 of the 8x8 matrix i / 8 of A, in the order of the fragment.
+        row = lane % 8 + (lane // 8) % 2 * 8
+        col = lane // 16 * 8
+        ib.emit(tvm.tir.call_intrin("handle", "tir.ptx_ldmatrix", False, 4, "b16",
+                                    A_local.asobject(), 0, A_shared.asobject(), row * 16 + col))
+        with ib.for_range(0, 4, name="i") as i:
+            B_local[i] = Bptr[group * 16 + tid * 2 + i % 2 + i // 2 * 8]
+            C_local[i] = tvm.tir.const(0, "float32")
+        ib.emit(tvm.tir.call_intrin("handle", "tir.ptx_mma", "m16n8k16", "row", "col",
+                                    "fp16", "fp16", "fp32", A_local.asobject(), 0,
+                                    B_local.asobject(), 0, C_local.asobject(), 0))
+        with ib.for_range(0, 4, name="i") as i:
+            Cptr[(group + i // 2 * 8) * 8 + tid * 2 + i % 2] = C_local[i]
+        return ib.get()
+
+    A = te.placeholder((16, 16), name="A", dtype="float16")
+    B = te.placeholder((8, 16), name="B", dtype="float16")
+    C = te.extern((16, 8), [A, B], lambda ins, outs: mma_ir(ins[0], ins[1], outs[0]),
+                  name="mma", dtype="float32")
+    s = te.create_schedule(C.op)
+    f = tvm.build(s, [A, B, C], "cuda")
+    code = f.imported_modules[0].get_source()
+    assert "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32" in code
+    assert "ldmatrix.sync.aligned.m8n8.x4.shared.b16" in code
+
+    ctx = tvm.gpu(0)
+    a_np = np.random.uniform(size=(16, 16)).astype("float16")
+    b_np = np.random.uniform(size=(8, 16)).astype("float16")
+    a = tvm.nd.array(a_np, ctx)
+    b = tvm.nd.array(b_np, ctx)
+    c = tvm.nd.array(np.zeros((16, 8), dtype="float32"), ctx)
+    f(a, b, c)
+    c_np = np.dot(a_np.astype("float32"), b_np.astype("float32").T)
+    tvm.testing.assert_allclose(c.asnumpy(), c_np, rtol=1e-3)
+
+
+@unittest.skipIf(not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"), "skip because cuda is not enabled..")
+def test_cuda_split_kernels():
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] + 1.0, name="B")
+    C = te.compute((n,), lambda i: B[i] * 2.0, name="C")
+    s = te.create_schedule(C.op)
+    for stage in [B, C]:
+        xo, xi = s[stage].split(stage.op.axis[0], factor=64)
+        s[stage].bind(xo, bx)
+        s[stage].bind(xi, tx)
+    with tvm.transform.PassContext(config={"codegen.cuda.split_kernels": True}):
+        func = tvm.build(s, [A, C], "cuda")
+    dev_module = func.imported_modules[0]
+    assert dev_module.get_source("cu").count("extern \"C\" __global__") == 2
+
+    ctx = tvm.gpu(0)
+    a_np = np.random.uniform(size=n).astype(A.dtype)
+
+    def check(f):
+        a = tvm.nd.array(a_np, ctx)
+        c = tvm.nd.array(np.zeros(n, dtype=C.dtype), ctx)
+        f(a, c)
+        tvm.testing.assert_allclose(c.asnumpy(), (a_np + 1.0) * 2.0, rtol=1e-5)
+
+    check(func)
+    # the units survive a round trip through an exported library
+    temp = util.tempdir()
+    path = temp.relpath("split.so")
+    func.export_library(path)
+    loaded = tvm.runtime.load_module(path)
+    loaded.imported_modules[0].get_function("__tvm_cuda_load_kernels")()
+    check(loaded)
+
+
 if __name__ == "__main__":
     test_cuda_vectorize_add()
     test_cuda_multiply_add()
@@ -938,4 +1037,5 @@ if __name__ == "__main__":
     test_vectorized_cooperative_fetching_x()
     test_vectorized_cooperative_fetching_xy()
     test_unrolled_vectorization()
-
+    test_cuda_mma_ldmatrix()
+    test_cuda_split_kernels()
@@ -21,6 +21,7 @@ from tvm.contrib import util, clang
 import numpy as np
 import ctypes
 import math
+import platform
 import re
 
 
@@ -794,6 +795,158 @@ def test_llvm_crt_static_lib():
     module.save('test.o')
 
 
+def test_llvm_vectorize_tail():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    n = 18
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] + 1.0, name='B')
+    s = te.create_schedule(B.op)
+    _, xi = s[B].split(B.op.axis[0], factor=8)
+    s[B].vectorize(xi)
+    f = tvm.build(s, [A, B], "llvm")
+    # the tail guard becomes a mask instead of a scalar loop
+    assert "llvm.masked.store" in f.get_source("ll")
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+    b = tvm.nd.array(np.zeros(n, dtype=B.dtype), ctx)
+    f(a, b)
+    tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() + 1)
+
+
+def test_llvm_parallel_codegen():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    n = 64
+    A = te.placeholder((n,), name='A')
+    funcs = []
+    for i in range(4):
+        B = te.compute((n,), lambda j: A[j] + float(i), name='B')
+        s = te.create_schedule(B.op)
+        funcs.append(tvm.lower(s, [A, B], name="fadd%d" % i))
+    with tvm.transform.PassContext(config={"codegen.llvm.num_threads": 3}):
+        m = tvm.build(funcs, "llvm")
+    temp = util.tempdir()
+    path_dso = temp.relpath("parts.so")
+    m.export_library(path_dso)
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+    for mod in [m, tvm.runtime.load_module(path_dso)]:
+        for i in range(4):
+            b = tvm.nd.array(np.zeros(n, dtype=A.dtype), ctx)
+            mod["fadd%d" % i](a, b)
+            tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() + i)
+
+
+def test_llvm_orc_jit():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    n = 64
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] * 2.0, name='B')
+    s = te.create_schedule(B.op)
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+    # modules of the same target share one JIT
+    for i in range(2):
+        f = tvm.build(s, [A, B], "llvm -jit=orc", name="fmul%d" % i)
+        b = tvm.nd.array(np.zeros(n, dtype=B.dtype), ctx)
+        f(a, b)
+        tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() * 2)
+        del f
+
+
+def test_llvm_isa_variants():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    if platform.machine() not in ["x86_64", "AMD64"]:
+        return
+    target = "llvm -isa-variants=avx512,avx2"
+    n = 1024
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] * 2.0 + 1.0, name='B')
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=16)
+    s[B].vectorize(xi)
+    m = tvm.build(s, [A, B], target, name="fma")
+    ll = m.get_source("ll")
+    assert "fma__avx512" in ll and "fma__avx2" in ll
+    temp = util.tempdir()
+    path_dso = temp.relpath("variants.so")
+    m.export_library(path_dso)
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), ctx)
+    for mod in [m, tvm.runtime.load_module(path_dso)]:
+        b = tvm.nd.array(np.zeros(n, dtype=B.dtype), ctx)
+        mod["fma"](a, b)
+        tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() * 2 + 1, rtol=1e-5)
+
+
+def test_llvm_pgo():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    import json
+    n = 64
+    A = te.placeholder((n,), name='A')
+
+    def relu(ins, outs):
+        ib = tvm.tir.ir_builder.create()
+        a = ib.buffer_ptr(ins[0])
+        b = ib.buffer_ptr(outs[0])
+        with ib.for_range(0, n, name="i") as i:
+            with ib.if_scope(a[i] > 0.0):
+                b[i] = a[i]
+            with ib.else_scope():
+                b[i] = tvm.tir.const(0, A.dtype)
+        return ib.get()
+
+    B = te.extern((n,), [A], relu, name='B', dtype=A.dtype)
+    s = te.create_schedule(B.op)
+    ctx = tvm.cpu(0)
+    a_np = np.random.uniform(-1, 1, size=n).astype(A.dtype)
+    a = tvm.nd.array(a_np, ctx)
+    with tvm.transform.PassContext(config={"codegen.llvm.pgo_instrument": True}):
+        m = tvm.build(s, [A, B], "llvm", name="relu")
+    b = tvm.nd.array(np.zeros(n, dtype=A.dtype), ctx)
+    m["relu"](a, b)
+    temp = util.tempdir()
+    path = temp.relpath("relu.json")
+    m.save_pgo_profile(path)
+    with open(path) as f:
+        profile = json.load(f)
+    # the branch runs n times, taken on the positive inputs
+    assert [v for k, v in profile.items() if k.startswith("relu:if:")] == \
+        [[n, int((a_np > 0).sum())]]
+    assert profile["relu:for:i#0"] == [1, n]
+
+    # rebuild weighted with the profile
+    with tvm.transform.PassContext(config={"tir.pgo_profile": path}):
+        m = tvm.build(s, [A, B], "llvm", name="relu")
+    b = tvm.nd.array(np.zeros(n, dtype=A.dtype), ctx)
+    m["relu"](a, b)
+    tvm.testing.assert_allclose(b.asnumpy(), np.maximum(a_np, 0))
+
+
+def test_llvm_scalable_vectorize():
+    if not tvm.runtime.enabled("llvm"):
+        return
+    n = te.var("n")
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] * 2.0 + 1.0, name='B')
+    s = te.create_schedule(B.op)
+    s[B].vectorize(B.op.axis[0])
+    with tvm.transform.PassContext(config={"tir.scalable_vectorize": True}):
+        f = tvm.build(s, [A, B], "llvm")
+        if tvm.target.codegen.llvm_version_major() >= 14:
+            sve = tvm.build(s, [A, B], "llvm -mtriple=aarch64-linux-gnu -mattr=+sve")
+            assert "vscale" in sve.get_source("ll")
+    ctx = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=37).astype(A.dtype), ctx)
+    b = tvm.nd.array(np.zeros(37, dtype=B.dtype), ctx)
+    f(a, b)
+    tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() * 2 + 1, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_multiple_func()
     test_llvm_large_uintimm()
@@ -818,3 +971,9 @@ if __name__ == "__main__":
     test_llvm_shuffle()
     test_llvm_bf16()
     test_llvm_crt_static_lib()
+    test_llvm_vectorize_tail()
+    test_llvm_parallel_codegen()
+    test_llvm_orc_jit()
+    test_llvm_isa_variants()
+    test_llvm_pgo()
+    test_llvm_scalable_vectorize()
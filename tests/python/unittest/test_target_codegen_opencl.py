@@ -14,7 +14,9 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
+import tvm.testing
 from tvm import te
 
 target = 'opencl'
@@ -123,6 +125,67 @@ def test_opencl_max():
     check_max(ctx, 1, 'float64')
 
 
+def test_opencl_texture():
+    def check_texture(ctx, height, width, dtype):
+        A = te.placeholder((height, width, 4), name='A', dtype=dtype)
+        B = te.compute((height, width, 4), lambda i, j, k: A[i, j, k] + A[i, j, k], name='B')
+        s = te.create_schedule(B.op)
+        i, j, k = s[B].op.axis
+        s[B].bind(i, te.thread_axis("blockIdx.x"))
+        s[B].bind(j, te.thread_axis("threadIdx.x"))
+        s[B].vectorize(k)
+        Ab = tvm.tir.decl_buffer(A.shape, dtype, name='A', scope="global.texture")
+        fun = tvm.build(s, [A, B], target, binds={A: Ab})
+        source = fun.imported_modules[0].get_source()
+        assert "__read_only image2d_t" in source
+        assert "read_image" in source
+
+        a_np = np.random.uniform(size=(height, width, 4)).astype(dtype)
+        a = tvm.nd.empty_texture(height, width, dtype, ctx)
+        a.copyfrom(a_np)
+        b = tvm.nd.empty((height, width, 4), dtype, ctx)
+        fun(a, b)
+        tvm.testing.assert_allclose(b.asnumpy(), a_np + a_np)
+
+    if not tvm.runtime.enabled(target):
+        print("skip because opencl is not enabled..")
+        return
+
+    ctx = tvm.context(target, 0)
+
+    check_texture(ctx, 8, 16, 'float32')
+    check_texture(ctx, 8, 16, 'float16')
+
+
+def test_opencl_profiling():
+    if not tvm.runtime.enabled(target):
+        print("skip because opencl is not enabled..")
+        return
+
+    n = 64
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] + 1, name='B')
+    s = te.create_schedule(B.op)
+    s[B].bind(s[B].op.axis[0], te.thread_axis("threadIdx.x"))
+    fun = tvm.build(s, [A, B], target)
+
+    ctx = tvm.context(target, 0)
+    set_profiling = tvm.get_global_func("device_api.opencl.set_profiling")
+    profiled_time = tvm.get_global_func("device_api.opencl.profiled_time")
+    set_profiling(0, True)
+    # The kernel arguments are only set again when they change.
+    inputs = [np.random.uniform(size=n).astype(A.dtype) for _ in range(2)]
+    arrays = [(tvm.nd.array(x, ctx), tvm.nd.empty((n,), A.dtype, ctx)) for x in inputs]
+    for k in [0, 1, 0]:
+        a, b = arrays[k]
+        fun(a, b)
+        assert profiled_time(0) >= 0
+        tvm.testing.assert_allclose(b.asnumpy(), inputs[k] + 1)
+    set_profiling(0, False)
+
+
 if __name__ == "__main__":
     test_opencl_ternary_expression()
     test_opencl_inf_nan()
+    test_opencl_texture()
+    test_opencl_profiling()
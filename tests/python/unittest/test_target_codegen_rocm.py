@@ -16,6 +16,7 @@
 # under the License.
 import tvm
 from tvm import te
+from tvm import topi
 import numpy as np
 import unittest
 
@@ -129,9 +130,23 @@ def test_rocm_vectorize_add():
     check_rocm("float32", 64, 2)
     check_rocm("float16", 64, 2)
 
+def test_rocm_mfma_dense():
+    target = tvm.target.Target("rocm -mcpu=gfx908")
+    for dtype in ["float16", "int8"]:
+        A = te.placeholder((64, 64), name='A', dtype=dtype)
+        B = te.placeholder((64, 64), name='B', dtype=dtype)
+        with target:
+            C = topi.rocm.dense_mfma(A, B)
+            s = topi.rocm.schedule_dense_mfma(C)
+        stmt = str(tvm.lower(s, [A, B, C], simple_mode=True))
+        assert "tir.mfma" in stmt
+        if tvm.runtime.enabled("rocm"):
+            tvm.build(s, [A, B, C], target)
+
 if __name__ == "__main__":
     test_rocm_cross_thread_reduction()
     test_rocm_inf_nan()
     test_rocm_reduction_binding()
     test_rocm_copy()
     test_rocm_vectorize_add()
+    test_rocm_mfma_dense()
@@ -106,6 +106,55 @@ def test_vulkan_vectorize_add():
     check_vulkan("float16", 64, 2)
 
 
+def test_vulkan_vectorize_tail():
+    if not tvm.vulkan(0).exist or not tvm.runtime.enabled("vulkan"):
+        print("skip because vulkan is not enabled..")
+        return
+    # the tail guard of the vectorized loop becomes masked loads and stores
+    n = 1021
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] + 1.0, name='B')
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=128)
+    xi, vx = s[B].split(xi, factor=4)
+    s[B].bind(xo, bx)
+    s[B].bind(xi, tx)
+    s[B].vectorize(vx)
+    fun = tvm.build(s, [A, B], "vulkan")
+    ctx = tvm.vulkan(0)
+    a = tvm.nd.array(np.random.uniform(size=(n,)).astype(A.dtype), ctx)
+    b = tvm.nd.empty((n,), B.dtype, ctx)
+    fun(a, b)
+    tvm.testing.assert_allclose(b.asnumpy(), a.asnumpy() + 1)
+
+
+def test_vulkan_subgroup_reduce():
+    if not tvm.vulkan(0).exist or not tvm.runtime.enabled("vulkan"):
+        print("skip because vulkan is not enabled..")
+        return
+    warp_size = tvm.vulkan(0).warp_size
+    if warp_size <= 1:
+        print("skip because the device has no subgroup shuffle..")
+        return
+    n, m = 4, warp_size
+    A = te.placeholder((n, m), name='A')
+    k = te.reduce_axis((0, m), name='k')
+    B = te.compute((n,), lambda i: te.sum(A[i, k], axis=k), name='B')
+    s = te.create_schedule(B.op)
+    s[B].bind(B.op.axis[0], bx)
+    s[B].bind(k, tx)
+    target = "vulkan -thread_warp_size=%d" % warp_size
+    fun = tvm.build(s, [A, B], target)
+    assembly = fun.imported_modules[0].get_source()
+    assert "OpGroupNonUniformShuffle" in assembly
+    ctx = tvm.vulkan(0)
+    a_np = np.random.uniform(size=(n, m)).astype(A.dtype)
+    a = tvm.nd.array(a_np, ctx)
+    b = tvm.nd.empty((n,), B.dtype, ctx)
+    fun(a, b)
+    tvm.testing.assert_allclose(b.asnumpy(), a_np.sum(axis=1), rtol=1e-5)
+
+
 def test_vulkan_stress():
     """
     Launch a randomized test with multiple kernels per stream, multiple uses of
@@ -171,4 +220,6 @@ if __name__ == "__main__":
     test_vector_comparison()
     test_vulkan_copy()
     test_vulkan_vectorize_add()
+    test_vulkan_vectorize_tail()
+    test_vulkan_subgroup_reduce()
     test_vulkan_stress()
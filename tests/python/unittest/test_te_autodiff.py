@@ -325,7 +325,29 @@ def test_stride_dilation():
     check_grad(Y, [X])
 
 
+def test_direct_vector_jacobian_product():
+    X = te.placeholder((8, 6), name='X')
+    W = te.placeholder((5, 6), name='W')
+    b = te.placeholder((5,), name='b')
+    k = te.reduce_axis((0, 6), name='k')
+    Y = te.compute((8, 5), lambda i, j: te.sum(X[i, k] * W[j, k], axis=k), name='Y')
+    head = topi.full_like(Y, 1.0)
+    dX, dW = te.gradient(Y, [X, W], head=head)
+    # The adjoints are sums over the loop variable that doesn't index the input
+    assert dX.op.name == "Y.X.grad"
+    assert [ax.dom.extent.value for ax in dX.op.reduce_axis] == [5]
+    assert [ax.dom.extent.value for ax in dW.op.reduce_axis] == [8]
+    check_grad(Y, [X, W])
+
+    Z = te.compute((8, 5), lambda i, j: te.exp(Y[i, j] + b[j]), name='Z')
+    check_grad(Z, [X, W, b])
+
+    T = te.compute((6, 8), lambda i, j: X[j, i] * X[j, i], name='T')
+    check_grad(T, [X])
+
+
 if __name__ == "__main__":
     test_basic_operation()
     test_topi()
     test_stride_dilation()
+    test_direct_vector_jacobian_product()
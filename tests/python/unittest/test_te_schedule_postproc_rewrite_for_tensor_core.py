@@ -20,11 +20,13 @@ from tvm import topi
 import numpy as np
 from tvm.contrib import nvcc
 
-def tensor_core_matmul(warp_tile_m=16, m=64, n=32, l=96):
-    A = te.placeholder((n, l), name='A', dtype='float16')
-    B = te.placeholder((l, m), name='B', dtype='float16')
+def tensor_core_matmul(warp_tile_m=16, m=64, n=32, l=96, dtype='float16'):
+    out_dtype = 'float32' if dtype == 'float16' else 'int32'
+    A = te.placeholder((n, l), name='A', dtype=dtype)
+    B = te.placeholder((l, m), name='B', dtype=dtype)
     k = te.reduce_axis((0, l), name='k')
-    C = te.compute((n, m), lambda i, j: te.sum(A[i, k].astype('float32') * B[k, j].astype('float32'), axis=k))
+    C = te.compute((n, m), lambda i, j: te.sum(A[i, k].astype(out_dtype) *
+                                               B[k, j].astype(out_dtype), axis=k))
     s = te.create_schedule(C.op)
     y, x = s[C].op.axis
     k = s[C].op.reduce_axis[0]
@@ -98,9 +100,12 @@ def tensor_core_matmul(warp_tile_m=16, m=64, n=32, l=96):
     func = tvm.build(s, [A, B, C], 'cuda')
 
     ctx = tvm.gpu(0)
-    a_np = np.random.uniform(size=(n, l)).astype(A.dtype)
-    b_np = np.random.uniform(size=(l, m)).astype(B.dtype)
-    c_np = np.zeros((n, m), dtype=np.float32)
+    if dtype == 'float16':
+        a_np = np.random.uniform(size=(n, l)).astype(A.dtype)
+        b_np = np.random.uniform(size=(l, m)).astype(B.dtype)
+    else:
+        a_np = np.random.randint(-8, 8, size=(n, l)).astype(A.dtype)
+        b_np = np.random.randint(-8, 8, size=(l, m)).astype(B.dtype)
     a = tvm.nd.array(a_np, ctx)
     b = tvm.nd.array(b_np, ctx)
     c = tvm.nd.array(np.zeros((n, m), dtype=C.dtype), ctx)
@@ -108,7 +113,7 @@ def tensor_core_matmul(warp_tile_m=16, m=64, n=32, l=96):
     evaluator = func.time_evaluator(func.entry_name, ctx, number=3)
     print('gemm m=%d n=%d k=%d: %f ms' % (m, n, l, evaluator(a, b, c).mean * 1e3))
 
-    c_np = np.dot(a_np, b_np)
+    c_np = np.dot(a_np.astype(C.dtype), b_np.astype(C.dtype))
     np.testing.assert_allclose(c_np, c.asnumpy(), rtol=1e-3)
 
 def tensor_core_batch_matmul(warp_tile_m=16, m=64, n=32, l=96, batch=2):
@@ -216,6 +221,18 @@ def test_tensor_core_matmul():
     tensor_core_matmul(8) #test with warp_tile 8x32x16
     tensor_core_matmul(32) #test with warp_tile 32x8x16
 
+def test_tensor_core_matmul_int8():
+    if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
+        print("skip because cuda is not enabled..")
+        return
+    if nvcc.parse_compute_version(tvm.gpu(0).compute_version) < (7, 2):
+        print("skip because gpu does not support int8 tensor core")
+        return
+
+    tensor_core_matmul(16, dtype='int8') #test with warp_tile 16x16x16
+    tensor_core_matmul(8, dtype='int8') #test with warp_tile 8x32x16
+    tensor_core_matmul(32, dtype='int8') #test with warp_tile 32x8x16
+
 def test_tensor_core_batch_matmul():
     if not tvm.gpu(0).exist or not tvm.runtime.enabled("cuda"):
         print("skip because cuda is not enabled..")
@@ -228,4 +245,5 @@ def test_tensor_core_batch_matmul():
 
 if __name__ == '__main__':
     test_tensor_core_matmul()
+    test_tensor_core_matmul_int8()
     test_tensor_core_batch_matmul()
@@ -333,8 +333,34 @@ def test_tensorize_tensor_compute_op():
 
 
 
+def test_auto_tensorize():
+    n, m, l = 64, 128, 32
+    factor = 16
+    A = te.placeholder((n, l), name='A')
+    B = te.placeholder((m, l), name='B')
+    k = te.reduce_axis((0, l), name='k')
+    C = te.compute((n, m), lambda i, j:
+                    te.sum(B[j, k] * A[i, k], axis=k), name='C')
+    gemv = intrin_gemv(factor, l)
+    assert tvm.te.schedule.MatchTensorIntrin(C.op, gemv)
+    # The extent of the matched axis must be divisible by the intrinsic's
+    assert not tvm.te.schedule.MatchTensorIntrin(C.op, intrin_gemv(48, l))
+    assert not tvm.te.schedule.MatchTensorIntrin(C.op, intrin_vadd(factor))
+
+    s = te.create_schedule(C.op)
+    assert tvm.te.schedule.AutoTensorize(s, C.op, gemv)
+    x, y = C.op.axis
+    assert len(s[C].leaf_iter_vars) == 4
+    assert s[C].leaf_iter_vars[0] == x
+    assert s[C].iter_var_attrs[s[C].leaf_iter_vars[2]].iter_type == \
+        tvm.tir.IterVar.Tensorized
+    stmt = tvm.lower(s, [A, B, C])["main"].body
+    assert "gemv" in str(stmt)
+
+
 if __name__ == "__main__":
     test_tensorize_vadd()
     test_tensorize_matmul()
     test_tensorize_op()
     test_tensorize_tensor_compute_op()
+    test_auto_tensorize()
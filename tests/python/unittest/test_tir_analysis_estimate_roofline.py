@@ -0,0 +1,56 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def test_matmul():
+    n = 64
+    A = te.placeholder((n, n), name='A')
+    B = te.placeholder((n, n), name='B')
+    k = te.reduce_axis((0, n), name='k')
+    C = te.compute((n, n), lambda i, j: te.sum(A[i, k] * B[k, j], axis=k), name='C')
+    s = te.create_schedule(C.op)
+    mod = tvm.lower(s, [A, B, C])
+
+    roofline = tvm.tir.analysis.estimate_roofline(mod["main"])
+    # a multiply and an add per iteration of the reduction
+    assert roofline["flops"] == 2 * n ** 3
+    # the init store, then loads of C, A, B and a store of C per iteration
+    assert roofline["bytes.global"] == 4 * (n ** 2 + 4 * n ** 3)
+    assert abs(roofline["arithmetic_intensity"] -
+               roofline["flops"] / roofline["bytes.global"]) < 1e-6
+
+
+def test_scopes():
+    n = 1024
+    A = te.placeholder((n,), name='A')
+    B = te.compute((n,), lambda i: A[i] + 1.0, name='B')
+    s = te.create_schedule(B.op)
+    s.cache_read(A, "shared", [B])
+    mod = tvm.lower(s, [A, B])
+
+    roofline = tvm.tir.analysis.estimate_roofline(mod["main"])
+    assert roofline["flops"] == n
+    # A is loaded from global and B stored to it, the copy goes through shared.
+    assert roofline["bytes.global"] == 8 * n
+    assert roofline["bytes.shared"] == 8 * n
+
+
+if __name__ == "__main__":
+    test_matmul()
+    test_scopes()
@@ -182,6 +182,23 @@ def test_buffer_load_store():
     assert not consistent_equal(sy, sz)
 
 
+def test_hash_memo():
+    x = te.var("x")
+    y = te.var("y")
+    func = tvm.tir.PrimFunc([x, y], tvm.tir.Evaluate(x + y))
+    expected = [tvm.ir.structural_hash(func, m) for m in [False, True]]
+    with tvm.ir.StructuralHashMemo():
+        for _ in range(3):
+            assert tvm.ir.structural_hash(func) == expected[0]
+            assert tvm.ir.structural_hash(func, True) == expected[1]
+        # hashes of new objects are still consistent within the scope
+        consistent_equal(func, tvm.tir.PrimFunc([x, y], tvm.tir.Evaluate(x + y)))
+        consistent_equal(x + y, x - y)
+        with tvm.ir.StructuralHashMemo():
+            assert tvm.ir.structural_hash(func) == expected[0]
+    assert tvm.ir.structural_hash(func) == expected[0]
+
+
 if __name__ == "__main__":
     test_exprs()
     test_prim_func()
@@ -190,3 +207,4 @@ if __name__ == "__main__":
     test_env_func()
     test_stmt()
     test_buffer_load_store()
+    test_hash_memo()
@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def lower_transpose(n, tile, swap_threads, guarded=False):
+    A = te.placeholder((n, n), name='A')
+    if guarded:
+        B = te.compute((n, n), lambda i, j: tvm.tir.if_then_else(i < n - 1, A[j, i], 0.0),
+                       name='B')
+    else:
+        B = te.compute((n, n), lambda i, j: A[j, i], name='B')
+    s = te.create_schedule(B.op)
+    i, j = s[B].op.axis
+    io, ii = s[B].split(i, factor=tile)
+    jo, ji = s[B].split(j, factor=tile)
+    s[B].reorder(io, jo, ii, ji)
+    s[B].bind(io, te.thread_axis("blockIdx.y"))
+    s[B].bind(jo, te.thread_axis("blockIdx.x"))
+    if swap_threads:
+        s[B].bind(ii, te.thread_axis("threadIdx.x"))
+        s[B].bind(ji, te.thread_axis("threadIdx.y"))
+    else:
+        s[B].bind(ii, te.thread_axis("threadIdx.y"))
+        s[B].bind(ji, te.thread_axis("threadIdx.x"))
+    return tvm.lower(s, [A, B])
+
+
+def shared_allocs(func):
+    allocs = []
+    def visit(op):
+        if isinstance(op, tvm.tir.AttrStmt) and op.attr_key == "storage_scope" \
+           and op.value.value == "shared":
+            allocs.append(op.body)
+    tvm.tir.stmt_functor.post_order_visit(func.body, visit)
+    return allocs
+
+
+def check(swap_threads, staged_name):
+    mod = lower_transpose(64, 16, swap_threads)
+    assert tvm.tir.analysis.global_coalescing_ratio(mod["main"]) == 0.5
+    mod = tvm.tir.transform.CoalesceGlobalAccess()(mod)
+    assert tvm.tir.analysis.global_coalescing_ratio(mod["main"]) == 1.0
+    allocs = shared_allocs(mod["main"])
+    assert len(allocs) == 1
+    assert allocs[0].buffer_var.name == staged_name
+    # the rows are padded to avoid bank conflicts
+    assert allocs[0].extents[0].value == 16 * 17
+
+
+def test_transposed_load():
+    check(False, "A.shared")
+
+
+def test_transposed_store():
+    check(True, "B.shared")
+
+
+def test_disabled():
+    mod = lower_transpose(64, 16, False)
+    with tvm.transform.PassContext(config={
+            "tir.CoalesceGlobalAccess": {"max_shared_bytes": 0}}):
+        mod = tvm.tir.transform.CoalesceGlobalAccess()(mod)
+    assert not shared_allocs(mod["main"])
+    assert tvm.tir.analysis.global_coalescing_ratio(mod["main"]) == 0.5
+
+
+def test_guarded_load():
+    # the load is only evaluated under its guard, staging it would read out of the guard
+    mod = lower_transpose(64, 16, False, guarded=True)
+    mod = tvm.tir.transform.CoalesceGlobalAccess()(mod)
+    assert not shared_allocs(mod["main"])
+
+
+if __name__ == "__main__":
+    test_transposed_load()
+    test_transposed_store()
+    test_disabled()
+    test_guarded_load()
@@ -62,5 +62,109 @@ def test_double_buffer():
     assert count[0] == 4
 
 
+def count_calls(stmt, name):
+    count = [0]
+    def _count(op):
+        if isinstance(op, tvm.tir.Call) and op.op.same_as(tvm.ir.Op.get(name)):
+            count[0] += 1
+    tvm.tir.stmt_functor.post_order_visit(stmt, _count)
+    return count[0]
+
+
+def test_multi_stage_async():
+    n = 100
+    m = 4
+    tx = te.thread_axis("threadIdx.x")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tx, "thread_extent", 1)
+    with ib.for_range(0, n) as i:
+        B = ib.allocate("float32", m, name="B", scope="shared")
+        with ib.new_scope():
+            ib.scope_attr(B.asobject(), "double_buffer_scope", 1)
+            with ib.for_range(0, m) as j:
+                B[j] = A[i * 4 + j]
+        with ib.for_range(0, m) as j:
+            C[j] = B[j] + 1
+
+    mod = tvm.IRModule({
+        "db" : tvm.tir.PrimFunc([A.asobject(), C.asobject()], ib.get())
+    })
+    opt = tvm.transform.Sequential(
+        [tvm.tir.transform.InjectDoubleBuffer(),
+         tvm.tir.transform.Simplify()])
+    with tvm.transform.PassContext(config={
+        "tir.InjectDoubleBuffer" : {"num_stages" : 3, "use_async_copy" : True}
+    }):
+        mod = opt(mod)
+    stmt = mod["db"].body
+
+    assert isinstance(stmt.body.body, tvm.tir.Allocate)
+    assert stmt.body.body.extents[0].value == 3
+    # two stages are fetched before the loop, then one per iteration of the
+    # loop and of its peeled last iteration, which has nothing left to fetch
+    assert count_calls(stmt, "tir.ptx_commit_group") == 4
+    assert count_calls(stmt, "tir.ptx_wait_group") == 2
+    scopes = []
+    tvm.tir.stmt_functor.post_order_visit(
+        stmt, lambda op: isinstance(op, tvm.tir.AttrStmt) and
+        op.attr_key == "async_scope" and scopes.append(op))
+    assert len(scopes) == 3
+
+
+def test_multi_stage_async_two_buffers():
+    n = 100
+    m = 4
+    tx = te.thread_axis("threadIdx.x")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tx, "thread_extent", 1)
+    with ib.for_range(0, n) as i:
+        B = ib.allocate("float32", m, name="B", scope="shared")
+        D = ib.allocate("float32", m, name="D", scope="shared")
+        with ib.new_scope():
+            ib.scope_attr(B.asobject(), "double_buffer_scope", 1)
+            with ib.for_range(0, m) as j:
+                B[j] = A[i * 4 + j]
+        with ib.new_scope():
+            ib.scope_attr(D.asobject(), "double_buffer_scope", 1)
+            with ib.for_range(0, m) as j:
+                D[j] = A[i * 4 + j + 1]
+        with ib.for_range(0, m) as j:
+            C[j] = B[j] + D[j]
+
+    mod = tvm.IRModule({
+        "db" : tvm.tir.PrimFunc([A.asobject(), C.asobject()], ib.get())
+    })
+    opt = tvm.transform.Sequential(
+        [tvm.tir.transform.InjectDoubleBuffer(),
+         tvm.tir.transform.Simplify()])
+    with tvm.transform.PassContext(config={
+        "tir.InjectDoubleBuffer" : {"num_stages" : 3, "use_async_copy" : True}
+    }):
+        mod = opt(mod)
+    stmt = mod["db"].body
+
+    events = []
+
+    def _record(op):
+        if isinstance(op, tvm.tir.Store) and op.buffer_var.name in ("B", "D"):
+            if not events or events[-1] != op.buffer_var.name:
+                events.append(op.buffer_var.name)
+        elif isinstance(op, tvm.tir.Call) and op.op.name == "tir.ptx_commit_group":
+            events.append("commit")
+        elif isinstance(op, tvm.tir.Call) and op.op.name == "tir.ptx_wait_group":
+            events.append(("wait", op.args[0].value))
+    tvm.tir.stmt_functor.post_order_visit(stmt, _record)
+    # the stages are committed one after the other, then each iteration waits
+    # for its own stage of both buffers, the next stage of both stays in flight
+    assert events[:9] == ["B", "commit", "D", "commit",
+                          "B", "commit", "D", "commit", ("wait", 2)]
+
+
 if __name__ == "__main__":
     test_double_buffer()
+    test_multi_stage_async()
+    test_multi_stage_async_two_buffers()
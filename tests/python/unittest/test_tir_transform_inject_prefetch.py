@@ -0,0 +1,51 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def count_prefetch(stmt):
+    count = [0]
+    def _count(op):
+        if isinstance(op, tvm.tir.Call) and op.op.same_as(tvm.ir.Op.get("tir.prefetch")):
+            count[0] += 1
+    tvm.tir.stmt_functor.post_order_visit(stmt, _count)
+    return count[0]
+
+
+def lower_add(n, config=None):
+    A = te.placeholder((n,), name="A")
+    B = te.placeholder((n,), name="B")
+    C = te.compute((n,), lambda i: A[i] + B[i], name="C")
+    s = te.create_schedule(C.op)
+    with tvm.transform.PassContext(config=config or {}):
+        return tvm.lower(s, [A, B, C], simple_mode=True)["main"].body
+
+
+def test_auto_prefetch():
+    config = {"tir.InjectPrefetch": {"auto_prefetch": True}}
+    assert count_prefetch(lower_add(1024)) == 0
+    stmt = lower_add(1024, config)
+    # A and B are prefetched once per cache line.
+    assert count_prefetch(stmt) == 2
+    assert isinstance(stmt.body[0], tvm.tir.IfThenElse)
+    # Short loops finish before a prefetch would arrive.
+    assert count_prefetch(lower_add(16, config)) == 0
+
+
+if __name__ == "__main__":
+    test_auto_prefetch()
@@ -514,6 +514,40 @@ def test_simple_rfactor():
     assert not tvm.ir.structural_equal(stmt1.body, stmt2.body)
 
 
+def test_cost_bounds():
+    ib = tvm.tir.ir_builder.create()
+    m = te.size_var('m')
+    n = te.size_var('n')
+    with ib.for_range(0, 10, 'i') as i:
+        ib.emit(tvm.tir.Evaluate(tvm.tir.Select(ib.likely(i >= 8), m, n)))
+    stmt = ib.get()
+    stats = tvm.get_global_func("tir.transform.LoopPartitionStats")
+
+    def partition(**config):
+        mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([m, n], stmt))
+        config["partition_const_loop"] = True
+        stats(True)
+        with tvm.transform.PassContext(config={"tir.LoopPartition": config}):
+            mod = tvm.tir.transform.LoopPartition()(mod)
+            body = tvm.tir.transform.Simplify()(mod)["main"].body
+        has_select = any(collect_visit(body, lambda x: isinstance(x, tvm.tir.Select)))
+        return has_select, stats(True)
+
+    # [0, 8) and [8, 10)
+    has_select, result = partition()
+    assert not has_select
+    assert result["versions"] == 1
+
+    # the interior range has 2 of the 10 iterations
+    has_select, result = partition(min_interior_ratio=0.5)
+    assert has_select
+    assert result["partitioned"] == 0 and result["skipped_ratio"] == 1
+
+    has_select, result = partition(max_versions=0)
+    assert has_select
+    assert result["partitioned"] == 0 and result["skipped_versions"] == 1
+
+
 if __name__ == "__main__":
     test_basic()
     test_const_loop()
@@ -535,3 +569,4 @@ if __name__ == "__main__":
     test_double_splitting_with_indivisible_factors()
     test_multilevel_splitting_with_indivisble_factors()
     test_simple_rfactor()
+    test_cost_bounds()
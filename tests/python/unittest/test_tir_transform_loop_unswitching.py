@@ -0,0 +1,79 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def unswitch(stmt, params, max_growth=100):
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc(params, stmt))
+    with tvm.transform.PassContext(config={"tir.LoopUnswitching": {"max_growth": max_growth}}):
+        return tvm.tir.transform.LoopUnswitching()(mod)["main"].body
+
+
+def count_if_then_else(stmt):
+    count = [0]
+    def _count(op):
+        if isinstance(op, tvm.tir.Call) and op.op.same_as(tvm.ir.Op.get("tir.if_then_else")):
+            count[0] += 1
+    tvm.tir.stmt_functor.post_order_visit(stmt, _count)
+    return count[0]
+
+
+def test_invariant_condition():
+    m = te.var("m")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, 16, name="i") as i:
+        with ib.for_range(0, 16, name="j") as j:
+            with ib.if_scope(tvm.tir.all(m > 0, j < m)):
+                A[i * 16 + j] = B[i * 16 + j]
+    stmt = ib.get()
+    params = [m, A.asobject(), B.asobject()]
+
+    ret = unswitch(stmt, params)
+    assert isinstance(ret, tvm.tir.IfThenElse)
+    tvm.ir.assert_structural_equal(ret.condition, m > 0)
+    assert isinstance(ret.then_case, tvm.tir.For)
+    assert isinstance(ret.else_case, tvm.tir.For)
+    # the budget is too small for a copy of the loop
+    ret = unswitch(stmt, params, max_growth=2)
+    assert isinstance(ret, tvm.tir.For)
+
+
+def test_boundary_condition():
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, 16, name="i") as i:
+        with ib.for_range(0, 3, name="k") as k:
+            cond = tvm.tir.all(tvm.tir.likely(1 <= i + k), tvm.tir.likely(i + k < 17))
+            B[i] = B[i] + tvm.tir.if_then_else(cond, A[i + k - 1], 0.0)
+    stmt = ib.get()
+
+    ret = unswitch(stmt, [A.asobject(), B.asobject()])
+    assert isinstance(ret, tvm.tir.For)
+    body = ret.body
+    assert isinstance(body, tvm.tir.IfThenElse)
+    # the interior version reads A without the padding condition
+    assert count_if_then_else(body.then_case) == 0
+    assert count_if_then_else(body.else_case) == 1
+
+
+if __name__ == "__main__":
+    test_invariant_condition()
+    test_boundary_condition()
@@ -0,0 +1,70 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def lower_scale(height, width, vectorize=True):
+    A = te.placeholder((height, width, 4), name='A')
+    B = te.compute((height, width, 4), lambda i, j, k: A[i, j, k] * 2.0, name='B')
+    s = te.create_schedule(B.op)
+    i, j, k = s[B].op.axis
+    s[B].bind(i, te.thread_axis("blockIdx.x"))
+    s[B].bind(j, te.thread_axis("threadIdx.x"))
+    if vectorize:
+        s[B].vectorize(k)
+    Ab = tvm.tir.decl_buffer(A.shape, A.dtype, name='A', scope="global.texture")
+    Bb = tvm.tir.decl_buffer(B.shape, B.dtype, name='B', scope="global.texture")
+    return tvm.lower(s, [A, B], binds={A: Ab, B: Bb})
+
+
+def texture_calls(func, name):
+    calls = []
+    def visit(op):
+        if isinstance(op, tvm.tir.Call) and op.op.same_as(tvm.ir.Op.get(name)):
+            calls.append(op)
+    tvm.tir.stmt_functor.post_order_visit(func.body, visit)
+    return calls
+
+
+def test_lower_texture_access():
+    mod = tvm.tir.transform.LowerTextureAccess()(lower_scale(8, 16))
+    loads = texture_calls(mod["main"], "tir.texture2d_load")
+    stores = texture_calls(mod["main"], "tir.texture2d_store")
+    assert len(loads) == 1 and len(stores) == 1
+    assert loads[0].dtype == "float32x4"
+    # the texel coordinates simplify to the bound threads
+    x, y = loads[0].args[1], loads[0].args[2]
+    assert isinstance(x, tvm.tir.Var) and x.name == "threadIdx.x"
+    assert isinstance(y, tvm.tir.Var) and y.name == "blockIdx.x"
+    def no_load(op):
+        assert not isinstance(op, (tvm.tir.Load, tvm.tir.Store))
+    tvm.tir.stmt_functor.post_order_visit(mod["main"].body, no_load)
+
+
+def test_scalar_access():
+    mod = lower_scale(8, 16, vectorize=False)
+    try:
+        tvm.tir.transform.LowerTextureAccess()(mod)
+        assert False
+    except tvm.error.TVMError:
+        pass
+
+
+if __name__ == "__main__":
+    test_lower_texture_access()
+    test_scalar_access()
@@ -0,0 +1,62 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+
+
+def count_calls(stmt, name):
+    count = [0]
+    def _count(op):
+        if isinstance(op, tvm.tir.Call) and op.op.same_as(tvm.ir.Op.get(name)):
+            count[0] += 1
+    tvm.tir.stmt_functor.post_order_visit(stmt, _count)
+    return count[0]
+
+
+def test_multi_warp_allreduce():
+    n = 4
+    m = 1024
+    A = te.placeholder((n, m), name="A")
+    k = te.reduce_axis((0, m), "k")
+    B = te.compute((n,), lambda i: te.sum(A[i, k], axis=k), name="B")
+    s = te.create_schedule(B.op)
+    ko, _ = s[B].split(B.op.reduce_axis[0], nparts=128)
+    s[B].bind(ko, te.thread_axis("threadIdx.x"))
+    s[B].bind(B.op.axis[0], te.thread_axis("blockIdx.x"))
+
+    cuda_target = tvm.target.create("cuda")
+    mod = tvm.lower(s, [A, B], name="f")
+    mod = tvm.tir.transform.Apply(lambda f: f.with_attr("target", cuda_target))(mod)
+    fdevice = tvm.tir.transform.SplitHostDevice()(mod)["f_kernel0"]
+    mod = tvm.IRModule.from_expr(fdevice)
+    fdevice = tvm.tir.transform.LowerThreadAllreduce()(mod)["f_kernel0"]
+
+    # 4 warps: 5 shuffles within each warp, then 2 across the partial results
+    assert count_calls(fdevice.body, "tir.tvm_warp_shuffle_down") == 7
+    assert count_calls(fdevice.body, "tir.tvm_warp_shuffle") == 1
+    assert count_calls(fdevice.body, "tir.tvm_storage_sync") == 2
+    staging = []
+    def find_staging(op):
+        if isinstance(op, tvm.tir.Allocate) and op.buffer_var.name.startswith("red_buf_staging"):
+            staging.append(op)
+    tvm.tir.stmt_functor.post_order_visit(fdevice.body, find_staging)
+    assert len(staging) == 1
+    assert staging[0].extents[0].value == 4
+
+
+if __name__ == "__main__":
+    test_multi_warp_allreduce()
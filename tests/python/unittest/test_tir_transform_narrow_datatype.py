@@ -68,10 +68,13 @@ def test_basic():
     check(2**16, 2**16, 32, "int32")  # i32 + i32 is not promoted to i64 even if overflow
     # i64 -> i32
     check(const(2, dtype='int64'), const(2, dtype='int64'), 32, "int32")
-    check(const(2**16, dtype='int64'), const(2**16, dtype='int64'), 32, "int64")
+    # the loop vars fit even if the index does not
+    check(const(2**16, dtype='int64'), const(2**16, dtype='int64'), 32, "int32")
+    check(const(2**32, dtype='int64'), const(2, dtype='int64'), 32, "int64")
     # i32 -> i16
     check(2, 2, 16, "int16")
-    check(2**10, 2**10, 16, "int32")
+    check(2**10, 2**10, 16, "int16")
+    check(2**16, 2, 16, "int32")
 
     # symbolic shape
     check(te.size_var(name='m', dtype='int32'), te.size_var(name='n', dtype='int32'), 32, "int32")
@@ -106,12 +109,12 @@ def test_thread_axis():
           target_bits=32, target_dtype='int32')
     check(const(2**30, dtype='int64'),
           const(32, dtype='int64'),
-          target_bits=32, target_dtype='int64')
+          target_bits=32, target_dtype='int32')
     # i32 -> i16
     check(2, 32,
           target_bits=16, target_dtype='int16')
     check(2**14, 32,
-          target_bits=16, target_dtype='int32')
+          target_bits=16, target_dtype='int16')
 
 
 def test_multilanes():
@@ -166,7 +169,7 @@ def test_reduce():
 
 
 def test_slice():
-    def check(m, n, target_bits, target_dtype):
+    def check(m, n, target_bits, target_dtype, index_dtype):
         # The index may overflow in B, while not in A
         ib = tvm.tir.ir_builder.create()
         Ab = tvm.tir.decl_buffer((m, n), name='A')
@@ -180,13 +183,35 @@ def test_slice():
         stmt = lower_stmt([Ab, Bb], stmt, target_bits)
         assert stmt.loop_var.dtype == target_dtype
         assert stmt.body.loop_var.dtype == target_dtype
+        assert stmt.body.body.value.a.index.dtype == index_dtype
 
     # The maximum index is (2**15 * 2**15 - 1) * 2 <= 2**31 - 1
     check(const(2**15, 'int64'), const(2**15, 'int64'),
-          target_bits=32, target_dtype='int32')
-    # The maximum index is (2**15 * 2**15 - 1 + 2**15) * 2 > 2**31 - 1
+          target_bits=32, target_dtype='int32', index_dtype='int32')
+    # The maximum index is (2**15 * 2**15 - 1 + 2**15) * 2 > 2**31 - 1,
+    # only the index into B is computed in int64
     check(const(2**15, 'int64'), const((2**15 + 1), 'int64'),
-          target_bits=32, target_dtype='int64')
+          target_bits=32, target_dtype='int32', index_dtype='int64')
+
+
+def test_wide_index():
+    ib = tvm.tir.ir_builder.create()
+    m = const(2**16, 'int64')
+    n = const(2**16, 'int64')
+    Ab = tvm.tir.decl_buffer((m, n), name='A')
+    A = ib.buffer_ptr(Ab)
+    with ib.for_range(0, m, name='i') as i:
+        with ib.for_range(0, n, name='j') as j:
+            A[i * n + j] = 0.0
+    stmt = lower_stmt([Ab], ib.get(), 32)
+    i = stmt.loop_var
+    j = stmt.body.loop_var
+    assert i.dtype == 'int32' and j.dtype == 'int32'
+    index = stmt.body.body.index
+    # the offset does not fit, it is computed in int64 from the int32 loop vars
+    assert index.dtype == 'int64'
+    assert isinstance(index.a.a, tvm.tir.Cast) and index.a.a.value.same_as(i)
+    assert isinstance(index.b, tvm.tir.Cast) and index.b.value.same_as(j)
 
 
 if __name__ == "__main__":
@@ -195,3 +220,4 @@ if __name__ == "__main__":
     test_multilanes()
     test_reduce()
     test_slice()
+    test_wide_index()
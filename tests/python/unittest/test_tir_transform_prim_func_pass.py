@@ -65,6 +65,27 @@ def test_cow_pass():
     assert mod_hash == mod.__hash__()
     assert func_hash == mod["main"].__hash__()
 
+
+def test_concurrent_pass():
+    funcs = {}
+    for i in range(16):
+        n = te.var("n")
+        A = te.placeholder((n,), name="A")
+        B = te.compute((n,), lambda j: A[j] + (i + 1) * 2 - i, name="B")
+        s = te.create_schedule(B.op)
+        funcs["func%d" % i] = tvm.lower(s, [A, B], name="func%d" % i)["func%d" % i]
+    mod = tvm.IRModule(funcs)
+    seq = tvm.transform.Sequential([tvm.tir.transform.Simplify(),
+                                    tvm.tir.transform.RemoveNoOp()])
+    expected = seq(mod)
+    with tvm.transform.PassContext(config={"tir.num_func_pass_threads": 4}):
+        mod = seq(mod)
+    assert tvm.ir.structural_equal(mod, expected)
+    assert [gv.name_hint for gv in mod.get_global_vars()] == \
+        [gv.name_hint for gv in expected.get_global_vars()]
+
+
 if __name__ == "__main__":
     test_cow_pass()
     test_prim_func_pass()
+    test_concurrent_pass()
@@ -127,9 +127,25 @@ def test_complex_likely_elimination():
     stmt = tvm.lower(s, [data_ph, indices_ph, lengths_ph, Y], simple_mode=True)
     assert('if' not in str(stmt))
 
+
+def test_simplify_memoize():
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    n = te.size_var("n")
+    with ib.for_range(0, n, name="i") as i:
+        with ib.if_scope((i * 4 + 3) // 4 < n):
+            A[(i * 4 + 3) // 4] = 0.0
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], ib.get()))
+    ref = tvm.tir.transform.Simplify()(mod)
+    # the memo of the analyzer does not change the result
+    with tvm.transform.PassContext(config={"arith.memoize": True}):
+        ret = tvm.tir.transform.Simplify()(mod)
+    tvm.ir.assert_structural_equal(ret, ref)
+
 if __name__ == "__main__":
     test_stmt_simplify()
     test_thread_extent_simplify()
     test_if_likely()
     test_basic_likely_elimination()
     test_complex_likely_elimination()
+    test_simplify_memoize()
@@ -543,6 +543,77 @@ def test_large_input():
     tvm.tir.stmt_functor.post_order_visit(stmt, verify)
 
 
+def test_merge_arena():
+    ib = tvm.tir.ir_builder.create()
+    tx = te.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 1)
+    with ib.for_range(0, 64, name="j") as j:
+        A = ib.allocate("float32", 64, name="A", scope="shared")
+        A[j] = 1.0
+    with ib.for_range(0, 64, name="j") as j:
+        B = ib.allocate("int8", 64, name="B", scope="shared")
+        B[j] = A[j].astype("int8")
+    with ib.for_range(0, 64, name="j") as j:
+        C = ib.allocate("int16", 256, name="C", scope="shared")
+        C[j] = B[j].astype("int16")
+    body = ib.get()
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([], body))
+
+    def get_allocs(mod):
+        allocs = []
+        def verify(n):
+            if isinstance(n, tvm.tir.Allocate):
+                allocs.append(n)
+        tvm.tir.stmt_functor.post_order_visit(mod["main"].body, verify)
+        return allocs
+
+    # the free list does not reuse A for the int16 buffer C
+    assert len(get_allocs(tvm.tir.transform.StorageRewrite()(mod))) == 3
+
+    with tvm.transform.PassContext(config={"tir.StorageRewrite": {"merge_arena": True}}):
+        allocs = get_allocs(tvm.tir.transform.StorageRewrite()(mod))
+    # C and A share the arena, B follows C
+    assert len(allocs) == 1
+    assert allocs[0].dtype == "float32"
+    assert allocs[0].extents[0].value == (256 * 16 + 64 * 8) // 32
+
+
+def test_merge_arena_vector_access():
+    ib = tvm.tir.ir_builder.create()
+    tx = te.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 1)
+    A = ib.allocate("float32", 72, name="A", scope="shared")
+    C = ib.allocate("float32", 36, name="C", scope="shared")
+    B = ib.allocate("int8", 64, name="B", scope="shared")
+    with ib.for_range(0, 72, name="j") as j:
+        A[j] = 1.0
+    with ib.for_range(0, 36, name="j") as j:
+        C[j] = 2.0
+    with ib.for_range(0, 2, name="k") as k:
+        ib.emit(tvm.tir.Store(B.asobject(), tvm.tir.Broadcast(tvm.tir.const(1, "int8"), 32),
+                              tvm.tir.Ramp(k * 32, 1, 32)))
+    with ib.for_range(0, 36, name="j") as j:
+        C[j] = C[j] + B[j].astype("float32")
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([], ib.get()))
+
+    with tvm.transform.PassContext(config={"tir.StorageRewrite": {"merge_arena": True}}):
+        body = tvm.tir.transform.StorageRewrite()(mod)["main"].body
+
+    stores = []
+    def visit(n):
+        if isinstance(n, tvm.tir.Store) and n.value.dtype == "int8x32":
+            stores.append(n)
+    tvm.tir.stmt_functor.post_order_visit(body, visit)
+    assert len(stores) == 1
+    # B follows C in the arena, at a multiple of the 256 bits of its vector stores
+    # rather than of the default 128 bits, and its index is counted in int8 elements.
+    analyzer = tvm.arith.Analyzer()
+    index = analyzer.simplify(stores[0].index)
+    assert isinstance(index, tvm.tir.Ramp)
+    offset = tvm.tir.stmt_functor.substitute(index.base, {k: 0})
+    assert analyzer.simplify(offset).value == 1280 // 8
+
+
 if __name__ == "__main__":
     test_storage_share()
     test_alloc_seq()
@@ -560,3 +631,5 @@ if __name__ == "__main__":
     test_reuse_small_buffer()
     test_replace_dataflow()
     test_large_input()
+    test_merge_arena()
+    test_merge_arena_vector_access()
@@ -110,7 +110,87 @@ def test_unroll_single_count_loops():
         ret = tvm.tir.transform.UnrollLoop()(mod)["main"].body
         assert ret == stmt
 
+def test_unroll_and_jam():
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    C = ib.pointer("float32", name="C")
+    with ib.for_range(0, 8, name="i") as i:
+        with ib.for_range(0, 16, name="j") as j:
+            C[i * 16 + j] = A[i * 16 + j] + B[j]
+    stmt = ib.get()
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A.asobject(), B.asobject(), C.asobject()], stmt))
+
+    with tvm.transform.PassContext(config={"tir.UnrollLoop": {"auto_unroll_and_jam": 4}}):
+        ret = tvm.tir.transform.UnrollLoop()(mod)["main"].body
+        assert isinstance(ret, tvm.tir.For)
+        assert ret.extent.value == 2
+        assert ret.body.extent.value == 16
+        assert len(ret.body.body) == 4
+
+    ret = tvm.tir.transform.UnrollLoop()(mod)["main"].body
+    assert ret.extent.value == 8
+
+
+def jam_with_pragma(index):
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tvm.tir.const(0, "int32"), "pragma_unroll_and_jam", 3)
+    with ib.for_range(0, 8, name="i") as i:
+        with ib.for_range(0, 16, name="j") as j:
+            C[index(i, j)] = C[index(i, j)] + A[i * 16 + j]
+    stmt = ib.get()
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A.asobject(), C.asobject()], stmt))
+    return tvm.tir.transform.UnrollLoop()(mod)["main"].body
+
+
+def test_unroll_and_jam_pragma():
+    ret = jam_with_pragma(lambda i, j: i)
+    # the remaining iterations run in a loop of their own
+    assert isinstance(ret, tvm.tir.SeqStmt)
+    assert ret[0].extent.value == 2
+    assert len(ret[0].body.body) == 3
+    assert ret[1].extent.value == 2
+    # C[i + j] is accessed in a different order after jamming
+    ret = jam_with_pragma(lambda i, j: i + j)
+    assert isinstance(ret, tvm.tir.For)
+    assert ret.extent.value == 8
+
+
+def test_unroll_cold_loop():
+    ib = tvm.tir.ir_builder.create()
+    n = te.size_var('n')
+    Ab = tvm.tir.decl_buffer((n, ), "int64")
+    Aptr = ib.buffer_ptr(Ab)
+    with ib.for_range(0, n, name="i") as i:
+        with ib.for_range(0, 8, name="j") as j:
+            Aptr[i * 8 + j] = Aptr[i] + 1
+        with ib.for_range(0, 8, name="j") as j:
+            Aptr[i * 8 + j] = Aptr[i] + 2
+    func = tvm.tir.PrimFunc([Ab], ib.get()).with_attr("global_symbol", "main")
+    mod = tvm.IRModule.from_expr(func)
+
+    from tvm.contrib import util
+    import json
+    temp = util.tempdir()
+    for iterations, unrolled in [(0, False), (24, True)]:
+        path = temp.relpath("profile.json")
+        with open(path, "w") as f:
+            json.dump({"main:for:i#0/j#0": [3, iterations], "main:for:i#0/j#1": [3, 24]}, f)
+        with tvm.transform.PassContext(config={
+                "tir.UnrollLoop": {"auto_max_extent": 8, "explicit_unroll": False},
+                "tir.pgo_profile": path}):
+            ret = tvm.tir.transform.UnrollLoop()(mod)["main"].body
+        # the loop which never iterated is not unrolled, its namesake is
+        assert (ret.body[0].for_type == tvm.tir.For.Unrolled) == unrolled
+        assert ret.body[1].for_type == tvm.tir.For.Unrolled
+
+
 if __name__ == "__main__":
     test_unroll_loop()
     test_unroll_fake_loop()
     test_unroll_single_count_loops()
+    test_unroll_and_jam()
+    test_unroll_and_jam_pragma()
+    test_unroll_cold_loop()
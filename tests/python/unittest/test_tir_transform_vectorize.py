@@ -16,6 +16,7 @@
 # under the License.
 import tvm
 from tvm import te
+import numpy as np
 
 def test_vectorize_loop():
     dtype = 'int64'
@@ -78,7 +79,9 @@ def test_vectorize_with_if():
     assert isinstance(stmt.then_case.index, tvm.tir.Ramp)
     assert isinstance(stmt.then_case.value, tvm.tir.Add)
     assert stmt.then_case.value.dtype == "float32x4"
-    assert isinstance(stmt.else_case, tvm.tir.For)
+    # the vector condition of the inner if masks the store
+    assert isinstance(stmt.else_case, tvm.tir.Store)
+    assert stmt.else_case.predicate.dtype == "uint1x4"
 
 
 def test_vectorize_let():
@@ -107,7 +110,10 @@ def test_vectorize_with_le_cond():
     mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
     stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
 
-    assert isinstance(stmt, tvm.tir.For)
+    assert isinstance(stmt, tvm.tir.Store)
+    assert stmt.value.dtype == "float32x4"
+    assert stmt.predicate.dtype == "uint1x4"
+    assert stmt.value.a.predicate.dtype == "uint1x4"
 
 
 def test_vectorize_with_ge_cond():
@@ -122,7 +128,10 @@ def test_vectorize_with_ge_cond():
     mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
     stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
 
-    assert isinstance(stmt, tvm.tir.For)
+    assert isinstance(stmt, tvm.tir.Store)
+    assert stmt.value.dtype == "float32x4"
+    assert stmt.predicate.dtype == "uint1x4"
+    assert stmt.value.a.predicate.dtype == "uint1x4"
 
 
 def test_vectorize_if_then_else():
@@ -139,7 +148,10 @@ def test_vectorize_if_then_else():
     mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n, x], stmt))
     stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
 
-    assert isinstance(stmt, tvm.tir.For)
+    # each side only loads in the lanes which select it
+    assert isinstance(stmt.value, tvm.tir.Select)
+    assert stmt.value.true_value.a.predicate.dtype == "uint1x4"
+    assert stmt.value.false_value.predicate.dtype == "uint1x4"
 
 
     ib = tvm.tir.ir_builder.create()
@@ -160,6 +172,103 @@ def test_vectorize_if_then_else():
     assert isinstance(stmt.body.value.args[2], tvm.tir.Broadcast)
 
 
+def test_vectorize_masked_else():
+    n = te.var('n')
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, 4, for_type="vectorize") as i:
+        with ib.if_scope(i < n):
+            A[i] = B[i]
+        with ib.else_scope():
+            A[i] = 0.0
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B, n], stmt))
+    stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+
+    assert isinstance(stmt, tvm.tir.SeqStmt)
+    then_case, else_case = stmt[0], stmt[1]
+    assert then_case.value.predicate.dtype == "uint1x4"
+    assert isinstance(else_case.predicate, tvm.tir.Not)
+
+
+def test_vectorize_masked_fallback():
+    n = te.var('n')
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    with ib.for_range(0, 4, for_type="vectorize") as i:
+        with ib.if_scope(i < n):
+            ib.emit(tvm.tir.call_extern("int32", "side_effect", i))
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
+    stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+
+    # a call cannot be masked
+    assert isinstance(stmt, tvm.tir.For)
+
+
+def test_vectorize_scalable():
+    n = te.var('n')
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    with ib.for_range(0, n, for_type="vectorize") as i:
+        A[i] = A[i] + 1.0
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
+    with tvm.transform.PassContext(config={"tir.scalable_vectorize": True}):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+
+    # the loop with a symbolic extent is left to the backend
+    assert isinstance(stmt, tvm.tir.AttrStmt)
+    assert stmt.attr_key == "scalable_vectorize_scope"
+    assert isinstance(stmt.body, tvm.tir.For)
+    assert stmt.body.for_type == tvm.tir.For.Serial
+
+
+def test_vectorize_dp4a():
+    n = 16
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("int8", name="A")
+    B = ib.pointer("int8", name="B")
+    C = ib.pointer("int32", name="C")
+    with ib.for_range(0, n // 4, name="ko") as ko:
+        with ib.for_range(0, 4, for_type="vectorize", name="ki") as ki:
+            C[0] = C[0] + A[ko * 4 + ki].astype("int32") * B[ko * 4 + ki].astype("int32")
+        with ib.for_range(0, 4, for_type="vectorize", name="ki") as ki:
+            # the vectors do not start at a multiple of 4
+            C[1] = C[1] + A[ko * 4 + ki + 1].astype("int32") * B[ko * 4 + ki].astype("int32")
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B, C], stmt))
+    stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    aligned, unaligned = stmt.body
+    assert isinstance(aligned, tvm.tir.Store)
+    assert aligned.value.op.same_as(tvm.ir.Op.get("tir.dp4a"))
+    assert isinstance(unaligned, tvm.tir.For)
+
+    # the default lowering of dp4a on CPU
+    if not tvm.runtime.enabled("llvm"):
+        return
+    k = te.reduce_axis((0, n), name="k")
+    X = te.placeholder((4, n), name="X", dtype="int8")
+    Y = te.placeholder((n,), name="Y", dtype="int8")
+    Z = te.compute((4,), lambda i: te.sum(
+        X[i, k].astype("int32") * Y[k].astype("int32"), axis=k), name="Z")
+    s = te.create_schedule(Z.op)
+    _, ki = s[Z].split(Z.op.reduce_axis[0], factor=4)
+    s[Z].vectorize(ki)
+    assert "tir.dp4a" in str(tvm.lower(s, [X, Y, Z], simple_mode=True))
+    f = tvm.build(s, [X, Y, Z], "llvm")
+    x = np.random.randint(-128, 128, size=(4, n)).astype("int8")
+    y = np.random.randint(-128, 128, size=(n,)).astype("int8")
+    z = tvm.nd.empty((4,), "int32")
+    f(tvm.nd.array(x), tvm.nd.array(y), z)
+    np.testing.assert_equal(z.asnumpy(), x.astype("int32").dot(y.astype("int32")))
+
+
 if __name__ == "__main__":
     test_vectorize_vector()
     test_vectorize_with_if()
@@ -168,3 +277,7 @@ if __name__ == "__main__":
     test_vectorize_with_le_cond()
     test_vectorize_with_ge_cond()
     test_vectorize_let()
+    test_vectorize_masked_else()
+    test_vectorize_masked_fallback()
+    test_vectorize_scalable()
+    test_vectorize_dp4a()
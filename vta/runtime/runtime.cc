@@ -33,7 +33,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -146,6 +148,11 @@ class UopKernel {
    * \param nbytes Number of bytes.
    */
   UopKernel(const char* signature, int nbytes) : signature_(signature, signature + nbytes) {}
+  ~UopKernel() {
+    if (dram_buff_ != nullptr) {
+      VTAMemFree(dram_buff_);
+    }
+  }
   /*!
    * \brief Verify if the signature is correct.
    * \param signature Signature ptr.
@@ -265,6 +272,9 @@ class UopKernel {
   // SRAM location if begin != end
   uint32_t sram_begin_{0};
   uint32_t sram_end_{0};
+  // The micro ops in FPGA readable DRAM, kept across runs
+  void* dram_buff_{nullptr};
+  vta_phy_addr_t dram_phy_addr_{0};
   // The signature used for verification
   std::vector<char> signature_;
   // Internal sequence
@@ -342,12 +352,18 @@ class BaseQueue {
 template <int kMaxBytes, bool kCoherent, bool kAlwaysCache>
 class UopQueue : public BaseQueue<VTAUop> {
  public:
-  void InitSpace() { BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache); }
+  // The kernels are loaded from their own DRAM buffers, the queue needs none.
+  void InitSpace() {
+    coherent_ = kCoherent;
+    always_cache_ = kAlwaysCache;
+    elem_bytes_ = kElemBytes;
+  }
   // Push data to the queue
   template <typename FAutoSync>
   void Push(UopKernel* kernel, FAutoSync fautosync) {
     // if the micro-op is cached in VTA SRAM, skip
     if (kernel->cached()) return;
+    this->CopyToDram(kernel);
     // check if we've exceeded the size of the allocated FPGA readable buffer
     size_t num_op = kernel->size();
     if (dram_buffer_.size() + num_op > kMaxElems) {
@@ -385,15 +401,12 @@ class UopQueue : public BaseQueue<VTAUop> {
   // Flush micro op load instruction
   void FlushUopLoad(VTAMemInsn* insn) {
     if (sram_begin_ != sram_end_) {
-      // Derive offset in FPGA-readable buffer
-      int32_t offset = 0;
-      for (uint32_t i = 0; i < cache_idx_ - 1; ++i) {
-        offset += cache_[i]->size() * kElemBytes;
-      }
+      // The pending range is the kernel pushed last
+      const UopKernel* kernel = cache_[cache_idx_ - 1];
+      CHECK_EQ(kernel->sram_end_ - kernel->sram_begin_, sram_end_ - sram_begin_);
       insn->memory_type = VTA_MEM_ID_UOP;
       insn->sram_base = sram_begin_;
-      // Update cache idx to physical address map
-      insn->dram_base = (fpga_buff_phy_ + offset) / kElemBytes;
+      insn->dram_base = kernel->dram_phy_addr_ / kElemBytes;
       insn->y_size = 1;
       insn->x_size = (sram_end_ - sram_begin_);
       insn->x_stride = (sram_end_ - sram_begin_);
@@ -418,33 +431,25 @@ class UopQueue : public BaseQueue<VTAUop> {
     cache_idx_ = 0;
     BaseQueue<VTAUop>::Reset();
   }
-  void AutoReadBarrier() { ReadBarrier(); }
-  /*! \brief Writer barrier to make sure that data written by CPU is visible to VTA. */
-  void ReadBarrier() {
-    CHECK(fpga_buff_ != nullptr);
-    CHECK(fpga_buff_phy_);
-    // Iterate over caches; allocate buffer in FPGA-readable memory
-    uint32_t buff_size = 0;
-    for (uint32_t i = 0; i < cache_.size(); ++i) {
-      buff_size += cache_[i]->size() * kElemBytes;
-    }
-    CHECK(buff_size <= kMaxBytes);
-    // Move kernel contents to FPGA readable buffer
-    uint32_t offset = 0;
-    for (uint32_t i = 0; i < cache_.size(); ++i) {
-      uint32_t ksize = cache_[i]->size() * kElemBytes;
-      VTAMemCopyFromHost(static_cast<char*>(fpga_buff_) + offset, cache_[i]->data(), ksize);
-      // Update offset
-      offset += ksize;
-    }
+ private:
+  /*!
+   * \brief Copy the micro ops of a kernel to a FPGA readable buffer of its own on its first load.
+   *  The buffer is kept across runs, so the micro ops are not copied again by every run.
+   */
+  void CopyToDram(UopKernel* kernel) {
+    if (kernel->dram_buff_ != nullptr) return;
+    uint32_t nbytes = kernel->size() * kElemBytes;
+    kernel->dram_buff_ = VTAMemAlloc(nbytes, coherent_ || always_cache_);
+    CHECK(kernel->dram_buff_ != nullptr);
+    kernel->dram_phy_addr_ = VTAMemGetPhyAddr(kernel->dram_buff_);
+    VTAMemCopyFromHost(kernel->dram_buff_, kernel->data(), nbytes);
     // Flush if we're using a shared memory system
     // and if interface is non-coherent
     if (!coherent_ && always_cache_) {
-      VTAFlushCache(fpga_buff_, fpga_buff_phy_, offset);
+      VTAFlushCache(kernel->dram_buff_, kernel->dram_phy_addr_, nbytes);
     }
   }
 
- private:
   // Cache pointer
   uint32_t cache_idx_{0};
   // Cached ring, sorted by sram_begin
@@ -483,13 +488,29 @@ enum PipelineStage : int { kNoneStage = 0, kLoadStage = 1, kComputeStage = 2, kS
 template <int kMaxBytes, bool kCoherent, bool kAlwaysCache>
 class InsnQueue : public BaseQueue<VTAGenericInsn> {
  public:
+  ~InsnQueue() {
+    if (back_buff_ != nullptr) {
+      VTAMemFree(back_buff_);
+    }
+  }
   /*! \brief Initialize the space. */
   void InitSpace() {
     BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache);
+    back_buff_ = VTAMemAlloc(kMaxBytes, coherent_ || always_cache_);
+    CHECK(back_buff_ != nullptr);
+    back_buff_phy_ = VTAMemGetPhyAddr(back_buff_);
     // Initialize the stage
     std::fill(pending_pop_prev_, pending_pop_prev_ + 4, 0);
     std::fill(pending_pop_next_, pending_pop_next_ + 4, 0);
   }
+  /*!
+   * \brief Swap the FPGA buffers, the next batch is copied to one while the device reads the
+   *  other.
+   */
+  void SwapBuffer() {
+    std::swap(fpga_buff_, back_buff_);
+    std::swap(fpga_buff_phy_, back_buff_phy_);
+  }
   /*! \return The data pointer. */
   VTAGenericInsn* data() { return dram_buffer_.data(); }
   /*! \return Number of instructions. */
@@ -883,6 +904,9 @@ class InsnQueue : public BaseQueue<VTAGenericInsn> {
   }
 
  private:
+  // The other FPGA buffer
+  void* back_buff_{nullptr};
+  vta_phy_addr_t back_buff_phy_{0};
   // Pending pop of each isntruction queue, qid=0 is not used
   int pending_pop_prev_[4];
   int pending_pop_next_[4];
@@ -901,9 +925,14 @@ class CommandQueue {
     insn_queue_.InitSpace();
     device_ = VTADeviceAlloc();
     CHECK(device_ != nullptr);
+    const char* async_run = std::getenv("VTA_ASYNC_DEVICE_RUN");
+    async_run_ = async_run != nullptr && std::atoi(async_run) != 0;
   }
 
-  ~CommandQueue() { VTADeviceFree(device_); }
+  ~CommandQueue() {
+    this->WaitDeviceRun();
+    VTADeviceFree(device_);
+  }
 
   uint32_t GetElemBytes(uint32_t memory_id) {
     uint32_t elem_bytes = 0;
@@ -992,7 +1021,13 @@ class CommandQueue {
     }
   }
 
-  void Synchronize(uint32_t wait_cycles) {
+  /*!
+   * \brief Run the recorded instructions on the device.
+   * \param wait_cycles The cycles to wait for the device to finish.
+   * \param blocking Whether to return after the device finished, the asynchronous runs
+   *  let the host record the next batch meanwhile.
+   */
+  void Synchronize(uint32_t wait_cycles, bool blocking = true) {
     // Insert dependences to force serialization
     if (debug_flag_ & VTA_DEBUG_FORCE_SERIAL) {
       insn_queue_.RewriteForceSerial();
@@ -1010,8 +1045,7 @@ class CommandQueue {
     CHECK(!insn_queue_.PendingPop());
     // Check if there are no instruction to execute at all
     if (insn_queue_.count() == 0) return;
-    // Synchronization for the queues
-    uop_queue_.AutoReadBarrier();
+    // Synchronization for the queues, the device is not reading this buffer
     insn_queue_.AutoReadBarrier();
     // Dump instructions if debug enabled
     if (debug_flag_ & VTA_DEBUG_DUMP_INSN) {
@@ -1023,12 +1057,23 @@ class CommandQueue {
 
     // Make sure that we don't exceed contiguous physical memory limits
     CHECK(insn_queue_.count() * sizeof(VTAGenericInsn) < VTA_MAX_XFER);
-    int timeout =
-        VTADeviceRun(device_, insn_queue_.dram_phy_addr(), insn_queue_.count(), wait_cycles);
-    CHECK_EQ(timeout, 0);
+    // The device runs one batch at a time
+    this->WaitDeviceRun();
+    VTADeviceHandle device = device_;
+    vta_phy_addr_t insn_phy_addr = insn_queue_.dram_phy_addr();
+    uint32_t insn_count = insn_queue_.count();
+    if (async_run_ && !blocking) {
+      pending_run_ = std::async(std::launch::async, [=]() {
+        return VTADeviceRun(device, insn_phy_addr, insn_count, wait_cycles);
+      });
+    } else {
+      int timeout = VTADeviceRun(device, insn_phy_addr, insn_count, wait_cycles);
+      CHECK_EQ(timeout, 0);
+    }
     // Reset buffers
     uop_queue_.Reset();
     insn_queue_.Reset();
+    insn_queue_.SwapBuffer();
   }
 
   // Get record kernel
@@ -1176,7 +1221,13 @@ class CommandQueue {
     }
   }
   // Auto sync when instruction overflow
-  void AutoSync() { this->Synchronize(1 << 31); }
+  void AutoSync() { this->Synchronize(1 << 31, false); }
+  // Wait for the asynchronous device run
+  void WaitDeviceRun() {
+    if (pending_run_.valid()) {
+      CHECK_EQ(pending_run_.get(), 0);
+    }
+  }
 
   // Internal debug flag
   int debug_flag_{0};
@@ -1188,6 +1239,11 @@ class CommandQueue {
   InsnQueue<VTA_MAX_XFER, kBufferCoherent, kAlwaysCache> insn_queue_;
   // Device handle
   VTADeviceHandle device_{nullptr};
+  // Whether the runs started when the queues overflow are asynchronous, set with
+  // VTA_ASYNC_DEVICE_RUN=1, as not all the device drivers can run on another thread
+  bool async_run_{false};
+  // The asynchronous device run in flight
+  std::future<int> pending_run_;
 };
 
 }  // namespace vta
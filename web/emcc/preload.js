@@ -29,8 +29,9 @@ function __wasmLibInstantiateWasm(imports, successCallback) {
     __wasmLib.successCallback = successCallback;
 }
 
-function __wasmLibStart(wasmInstance) {
-    __wasmLib.successCallback(wasmInstance);
+function __wasmLibStart(wasmInstance, wasmModule) {
+    // The module is sent to the pthread workers of a threaded runtime.
+    __wasmLib.successCallback(wasmInstance, wasmModule);
 }
 
 __wasmLib.start = __wasmLibStart;
@@ -40,6 +40,8 @@
 #include "src/runtime/module.cc"
 #include "src/runtime/ndarray.cc"
 #include "src/runtime/object.cc"
+#include "src/runtime/params_section.cc"
+#include "src/runtime/pinned_staging.cc"
 #include "src/runtime/registry.cc"
 #include "src/runtime/rpc/rpc_channel.cc"
 #include "src/runtime/rpc/rpc_endpoint.cc"
@@ -50,8 +52,16 @@
 #include "src/runtime/system_library.cc"
 #include "src/runtime/workspace_pool.cc"
 
+// The threaded variant runs the parallel loops on the thread pool, over the pthreads of
+// emscripten, which are web workers sharing the memory through a SharedArrayBuffer.
+#if TVM_WASM_THREADS
+#include "src/runtime/thread_pool.cc"
+#include "src/runtime/threading_backend.cc"
+#endif
+
 // --- Implementations of backend and wasm runtime API. ---
 
+#if !TVM_WASM_THREADS
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
   TVMParallelGroupEnv env;
   env.num_task = 1;
@@ -60,6 +70,7 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
 }
 
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) { return 0; }
+#endif
 
 // --- Environment PackedFuncs for testing ---
 namespace tvm {
@@ -35,8 +35,9 @@ export interface LibraryProvider {
   /**
    * Callback function to notify the provider the created instance.
    * @param inst The created instance.
+   * @param mod The module of the instance, which the threads instantiate again.
    */
-  start: (inst: WebAssembly.Instance) => void;
+  start: (inst: WebAssembly.Instance, mod?: WebAssembly.Module) => void;
 }
 
 /**
@@ -36,6 +36,11 @@ export async function detectGPUDevice(): Promise<GPUDevice | undefined> {
   }
 }
 
+/** The granularity of the sizes of the pooled buffers. */
+const kBufferSizeAlign = 256;
+/** The number of dispatches recorded before they are submitted without a sync point. */
+const kMaxPendingDispatches = 256;
+
 interface FunctionInfo {
   name: string;
   arg_types: Array<string>;
@@ -45,16 +50,28 @@ interface FunctionInfo {
 /**
  * WebGPU context
  * Manages all the webgpu resources here.
+ *
+ * The dispatches and copies are recorded into one command encoder, which
+ * is submitted at the next sync point (a readback or sync), so a whole run
+ * of a model takes a single submit. The freed buffers are pooled by size.
  */
 export class WebGPUContext {
   device: GPUDevice;
   memory: Memory;
 
-  //private readBuffer:;
   private bufferTable: Array<GPUBuffer | undefined> = [undefined];
   private bufferTableFreeId: Array<number> = [];
   private pendingRead: Promise<void> = Promise.resolve();
   private numPendingReads = 0;
+  // The commands recorded since the last submit.
+  private pendingEncoder: GPUCommandEncoder | undefined = undefined;
+  private numPendingDispatches = 0;
+  // The upload staging buffers used by the pending commands.
+  private pendingStaging: Array<GPUBuffer> = [];
+  // The freed storage buffers and the idle readback buffers, by size.
+  private bufferPool: Map<number, Array<GPUBuffer>> = new Map();
+  private readbackPool: Map<number, Array<GPUBuffer>> = new Map();
+  private bufferSize: WeakMap<GPUBuffer, number> = new WeakMap();
 
   constructor(memory: Memory, device: GPUDevice) {
     this.memory = memory;
@@ -65,6 +82,7 @@ export class WebGPUContext {
    * Wait for all pending GPU tasks to complete
    */
   async sync(): Promise<void> {
+    this.flush();
     const fence = this.device.defaultQueue.createFence();
     this.device.defaultQueue.signal(fence, 1);
     if (this.numPendingReads != 0) {
@@ -130,8 +148,7 @@ export class WebGPUContext {
     }
 
     const submitShader = (...args: Array<GPUPointer | number>): void => {
-      const commandEncoder = this.device.createCommandEncoder();
-      const compute = commandEncoder.beginComputePass();
+      const compute = this.getCommandEncoder().beginComputePass();
       compute.setPipeline(pipeline);
       const bindGroupEntries: Array<GPUBindGroupEntry> = [];
       assert(args.length == layoutEntries.length + dispatchToDim.length);
@@ -155,8 +172,11 @@ export class WebGPUContext {
       }
       compute.dispatch(wl[0], wl[1], wl[2]);
       compute.endPass();
-      const command = commandEncoder.finish();
-      this.device.defaultQueue.submit([command]);
+      // Let the GPU start on long runs without waiting for the sync point.
+      this.numPendingDispatches += 1;
+      if (this.numPendingDispatches >= kMaxPendingDispatches) {
+        this.flush();
+      }
     };
 
     return submitShader;
@@ -210,12 +230,43 @@ export class WebGPUContext {
 
   }
 
+  /**
+   * Submit the recorded commands.
+   */
+  flush(): void {
+    if (this.pendingEncoder === undefined) return;
+    this.device.defaultQueue.submit([this.pendingEncoder.finish()]);
+    this.pendingEncoder = undefined;
+    this.numPendingDispatches = 0;
+    for (const buffer of this.pendingStaging) {
+      buffer.destroy();
+    }
+    this.pendingStaging = [];
+  }
+
+  /**
+   * Destroy the pooled buffers.
+   */
+  clearBufferPool(): void {
+    for (const pool of [this.bufferPool, this.readbackPool]) {
+      pool.forEach((buffers: Array<GPUBuffer>) => {
+        buffers.forEach((buffer: GPUBuffer) => buffer.destroy());
+      });
+      pool.clear();
+    }
+  }
+
   // DeviceAPI
   private deviceAllocDataSpace(nbytes: number): GPUPointer {
-    const buffer = this.device.createBuffer({
-      size: nbytes,
-      usage: GPUBufferUsage.STORAGE | GPUBufferUsage.COPY_SRC | GPUBufferUsage.COPY_DST,
-    });
+    const size = Math.ceil(nbytes / kBufferSizeAlign) * kBufferSizeAlign;
+    let buffer = this.popBuffer(this.bufferPool, size);
+    if (buffer === undefined) {
+      buffer = this.device.createBuffer({
+        size: size,
+        usage: GPUBufferUsage.STORAGE | GPUBufferUsage.COPY_SRC | GPUBufferUsage.COPY_DST,
+      });
+      this.bufferSize.set(buffer, size);
+    }
     return this.attachToBufferTable(buffer);
   }
 
@@ -225,7 +276,8 @@ export class WebGPUContext {
     this.bufferTable[idx] = undefined;
     assert(buffer !== undefined);
     this.bufferTableFreeId.push(idx);
-    buffer.destroy();
+    // The pending commands may still use the buffer, they run before its next user.
+    this.pushBuffer(this.bufferPool, buffer, this.bufferSize.get(buffer) as number);
   }
 
   private deviceCopyToGPU(
@@ -244,17 +296,14 @@ export class WebGPUContext {
     viewU8.set(this.memory.loadRawBytes(from, nbytes));
     gpuTemp.unmap();
 
-    const copyEncoder = this.device.createCommandEncoder();
-    copyEncoder.copyBufferToBuffer(
+    this.getCommandEncoder().copyBufferToBuffer(
       gpuTemp,
       0,
       this.gpuBufferFromPtr(to),
       toOffset,
       nbytes
     );
-    const copyCommands = copyEncoder.finish();
-    this.device.defaultQueue.submit([copyCommands]);
-    gpuTemp.destroy();
+    this.pendingStaging.push(gpuTemp);
   }
 
   private deviceCopyFromGPU(
@@ -263,28 +312,32 @@ export class WebGPUContext {
     to: Pointer,
     nbytes: number
   ): void {
-    // Perhaps it would be more useful to resuse a staging buffer?
-    const gpuTemp = this.device.createBuffer({
-      size: nbytes,
-      usage: GPUBufferUsage.MAP_READ | GPUBufferUsage.COPY_DST,
-    });
+    const size = Math.ceil(nbytes / kBufferSizeAlign) * kBufferSizeAlign;
+    let gpuTemp = this.popBuffer(this.readbackPool, size);
+    if (gpuTemp === undefined) {
+      gpuTemp = this.device.createBuffer({
+        size: size,
+        usage: GPUBufferUsage.MAP_READ | GPUBufferUsage.COPY_DST,
+      });
+    }
+    const readback = gpuTemp;
 
-    const copyEncoder = this.device.createCommandEncoder();
-    copyEncoder.copyBufferToBuffer(
+    this.getCommandEncoder().copyBufferToBuffer(
       this.gpuBufferFromPtr(from),
       fromOffset,
-      gpuTemp,
+      readback,
       0,
       nbytes
     );
-    const copyCommands = copyEncoder.finish();
-    this.device.defaultQueue.submit([copyCommands]);
+    this.flush();
 
+    // The readback completes asynchronously, sync waits for it.
     this.numPendingReads += 1;
-    const readEvent = gpuTemp.mapReadAsync().then((data: ArrayBuffer) => {
-      this.memory.storeRawBytes(to, new Uint8Array(data));
+    const readEvent = readback.mapReadAsync().then((data: ArrayBuffer) => {
+      this.memory.storeRawBytes(to, new Uint8Array(data, 0, nbytes));
       this.numPendingReads -= 1;
-      gpuTemp.destroy();
+      readback.unmap();
+      this.pushBuffer(this.readbackPool, readback, size);
     });
 
     if (this.numPendingReads == 1) {
@@ -305,16 +358,38 @@ export class WebGPUContext {
     toOffset: number,
     nbytes: number
   ): void {
-    const copyEncoder = this.device.createCommandEncoder();
-    copyEncoder.copyBufferToBuffer(
+    this.getCommandEncoder().copyBufferToBuffer(
       this.gpuBufferFromPtr(from),
       fromOffset,
       this.gpuBufferFromPtr(to),
       toOffset,
       nbytes
     );
-    const copyCommands = copyEncoder.finish();
-    this.device.defaultQueue.submit([copyCommands]);
+  }
+
+  private getCommandEncoder(): GPUCommandEncoder {
+    if (this.pendingEncoder === undefined) {
+      this.pendingEncoder = this.device.createCommandEncoder();
+    }
+    return this.pendingEncoder;
+  }
+
+  private popBuffer(pool: Map<number, Array<GPUBuffer>>, size: number): GPUBuffer | undefined {
+    const buffers = pool.get(size);
+    return buffers === undefined ? undefined : buffers.pop();
+  }
+
+  private pushBuffer(
+    pool: Map<number, Array<GPUBuffer>>,
+    buffer: GPUBuffer,
+    size: number
+  ): void {
+    const buffers = pool.get(size);
+    if (buffers === undefined) {
+      pool.set(size, [buffer]);
+    } else {
+      buffers.push(buffer);
+    }
   }
 
   private gpuBufferFromPtr(ptr: GPUPointer): GPUBuffer {